@@ -15,6 +15,7 @@
 #define LOGGER_H
 
 // Qt
+#include <QAtomicInt>
 #include <QDateTime>
 #include <QDebug>
 #include <QElapsedTimer>
@@ -28,21 +29,77 @@ class Logger;
 CUTELOGGERSHARED_EXPORT Logger *cuteLoggerInstance();
 #define cuteLogger cuteLoggerInstance()
 
+// The levels below this one are compiled out, except Fatal: 0 is Trace and 5 is Fatal.
+#ifndef CUTELOGGER_MIN_LEVEL
+#define CUTELOGGER_MIN_LEVEL 0
+#endif
+
+// Runs the statement after it once, only if the level is logged, so that the
+// message of a record that is not logged is not even formatted.
+#define CUTELOGGER_IF_LOGGABLE(level) \
+    for (Logger *cuteLoggerLogger = (int(level) >= CUTELOGGER_MIN_LEVEL || level == Logger::Fatal) \
+                                        ? cuteLoggerInstance() \
+                                        : nullptr; \
+         cuteLoggerLogger && cuteLoggerLogger->isLoggable(level); \
+         cuteLoggerLogger = nullptr)
+
 #define LOG_TRACE \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Trace, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Trace) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Trace, __FILE__, __LINE__, Q_FUNC_INFO).write
 #define LOG_DEBUG \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Debug) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Debug, __FILE__, __LINE__, Q_FUNC_INFO).write
 #define LOG_INFO \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Info) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO).write
 #define LOG_WARNING \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Warning, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Warning) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Warning, __FILE__, __LINE__, Q_FUNC_INFO).write
 #define LOG_ERROR \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Error, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Error) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Error, __FILE__, __LINE__, Q_FUNC_INFO).write
 #define LOG_FATAL \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Fatal, __FILE__, __LINE__, Q_FUNC_INFO).write
+    CUTELOGGER_IF_LOGGABLE(Logger::Fatal) \
+    CuteMessageLogger(cuteLoggerLogger, Logger::Fatal, __FILE__, __LINE__, Q_FUNC_INFO).write
+
+// Runs the statement after it only for some of the times it is reached, so that
+// a message repeated for every frame does not flood the log. The count of the
+// skipped ones is appended to the next one that is logged.
+#define CUTELOGGER_IF_THROTTLED(intervalMs, everyN) \
+    for (int cuteLoggerSkipped = -1; cuteLoggerSkipped < 0;) \
+        for (qint64 cuteLoggerElapsedMs = 0; \
+             cuteLoggerSkipped < 0 && [&]() { \
+                 static LoggerThrottle cuteLoggerThrottle((intervalMs), (everyN)); \
+                 if (cuteLoggerThrottle.check(cuteLoggerSkipped, cuteLoggerElapsedMs)) \
+                     return true; \
+                 cuteLoggerSkipped = 0; \
+                 return false; \
+             }();)
+
+#define CUTELOGGER_THROTTLED(level, intervalMs, everyN) \
+    CUTELOGGER_IF_LOGGABLE(level) \
+    CUTELOGGER_IF_THROTTLED(intervalMs, everyN) \
+    CuteMessageLogger(cuteLoggerLogger, level, __FILE__, __LINE__, Q_FUNC_INFO) \
+        .skipped(cuteLoggerSkipped, cuteLoggerElapsedMs) \
+        .write
+
+// Logs at most once every intervalMs milliseconds.
+#define LOG_TRACE_THROTTLED(intervalMs) CUTELOGGER_THROTTLED(Logger::Trace, intervalMs, 0)
+#define LOG_DEBUG_THROTTLED(intervalMs) CUTELOGGER_THROTTLED(Logger::Debug, intervalMs, 0)
+#define LOG_INFO_THROTTLED(intervalMs) CUTELOGGER_THROTTLED(Logger::Info, intervalMs, 0)
+#define LOG_WARNING_THROTTLED(intervalMs) CUTELOGGER_THROTTLED(Logger::Warning, intervalMs, 0)
+#define LOG_ERROR_THROTTLED(intervalMs) CUTELOGGER_THROTTLED(Logger::Error, intervalMs, 0)
+
+// Logs the first time and then once every n times.
+#define LOG_TRACE_EVERY_N(n) CUTELOGGER_THROTTLED(Logger::Trace, 0, n)
+#define LOG_DEBUG_EVERY_N(n) CUTELOGGER_THROTTLED(Logger::Debug, 0, n)
+#define LOG_INFO_EVERY_N(n) CUTELOGGER_THROTTLED(Logger::Info, 0, n)
+#define LOG_WARNING_EVERY_N(n) CUTELOGGER_THROTTLED(Logger::Warning, 0, n)
+#define LOG_ERROR_EVERY_N(n) CUTELOGGER_THROTTLED(Logger::Error, 0, n)
 
 #define LOG_CTRACE(category) \
-    CuteMessageLogger(cuteLoggerInstance(), \
+    CUTELOGGER_IF_LOGGABLE(Logger::Trace) \
+    CuteMessageLogger(cuteLoggerLogger, \
                       Logger::Trace, \
                       __FILE__, \
                       __LINE__, \
@@ -50,7 +107,8 @@ CUTELOGGERSHARED_EXPORT Logger *cuteLoggerInstance();
                       category) \
         .write()
 #define LOG_CDEBUG(category) \
-    CuteMessageLogger(cuteLoggerInstance(), \
+    CUTELOGGER_IF_LOGGABLE(Logger::Debug) \
+    CuteMessageLogger(cuteLoggerLogger, \
                       Logger::Debug, \
                       __FILE__, \
                       __LINE__, \
@@ -58,10 +116,17 @@ CUTELOGGERSHARED_EXPORT Logger *cuteLoggerInstance();
                       category) \
         .write()
 #define LOG_CINFO(category) \
-    CuteMessageLogger(cuteLoggerInstance(), Logger::Info, __FILE__, __LINE__, Q_FUNC_INFO, category) \
+    CUTELOGGER_IF_LOGGABLE(Logger::Info) \
+    CuteMessageLogger(cuteLoggerLogger, \
+                      Logger::Info, \
+                      __FILE__, \
+                      __LINE__, \
+                      Q_FUNC_INFO, \
+                      category) \
         .write()
 #define LOG_CWARNING(category) \
-    CuteMessageLogger(cuteLoggerInstance(), \
+    CUTELOGGER_IF_LOGGABLE(Logger::Warning) \
+    CuteMessageLogger(cuteLoggerLogger, \
                       Logger::Warning, \
                       __FILE__, \
                       __LINE__, \
@@ -69,7 +134,8 @@ CUTELOGGERSHARED_EXPORT Logger *cuteLoggerInstance();
                       category) \
         .write()
 #define LOG_CERROR(category) \
-    CuteMessageLogger(cuteLoggerInstance(), \
+    CUTELOGGER_IF_LOGGABLE(Logger::Error) \
+    CuteMessageLogger(cuteLoggerLogger, \
                       Logger::Error, \
                       __FILE__, \
                       __LINE__, \
@@ -77,7 +143,8 @@ CUTELOGGERSHARED_EXPORT Logger *cuteLoggerInstance();
                       category) \
         .write()
 #define LOG_CFATAL(category) \
-    CuteMessageLogger(cuteLoggerInstance(), \
+    CUTELOGGER_IF_LOGGABLE(Logger::Fatal) \
+    CuteMessageLogger(cuteLoggerLogger, \
                       Logger::Fatal, \
                       __FILE__, \
                       __LINE__, \
@@ -205,6 +272,18 @@ public:
 
     void writeAssert(const char *file, int line, const char *function, const char *condition);
 
+    void setMinimumLevel(LogLevel level);
+    LogLevel minimumLevel() const;
+    //! Returns whether records of \a level are written; Fatal records always are.
+    inline bool isLoggable(LogLevel level) const
+    {
+        return level >= m_minimumLevel.loadRelaxed() || level == Fatal;
+    }
+
+    void setAsync(bool async);
+    bool isAsync() const;
+    void flush();
+
 private:
     void write(const QDateTime &timeStamp,
                LogLevel logLevel,
@@ -216,6 +295,7 @@ private:
                bool fromLocalInstance);
     Q_DECLARE_PRIVATE(Logger)
     LoggerPrivate *d_ptr;
+    QAtomicInt m_minimumLevel;
 };
 
 class CUTELOGGERSHARED_EXPORT CuteMessageLogger
@@ -231,6 +311,8 @@ public:
         , m_line(line)
         , m_function(function)
         , m_category(nullptr)
+        , m_skipped(0)
+        , m_elapsedMs(0)
     {}
 
     CuteMessageLogger(Logger *l,
@@ -245,10 +327,19 @@ public:
         , m_line(line)
         , m_function(function)
         , m_category(category)
+        , m_skipped(0)
+        , m_elapsedMs(0)
     {}
 
     ~CuteMessageLogger();
 
+    CuteMessageLogger &skipped(int count, qint64 elapsedMs)
+    {
+        m_skipped = count;
+        m_elapsedMs = elapsedMs;
+        return *this;
+    }
+
     void write(const char *msg, ...)
 #if defined(Q_CC_GNU) && !defined(__INSURE__)
 #if defined(Q_CC_MINGW) && !defined(Q_CC_CLANG)
@@ -270,9 +361,28 @@ private:
     int m_line;
     const char *m_function;
     const char *m_category;
+    int m_skipped;
+    qint64 m_elapsedMs;
     QString m_message;
 };
 
+class CUTELOGGERSHARED_EXPORT LoggerThrottle
+{
+    Q_DISABLE_COPY(LoggerThrottle)
+
+public:
+    LoggerThrottle(int intervalMs, int everyN);
+
+    bool check(int &skipped, qint64 &elapsedMs);
+
+private:
+    const int m_intervalMs;
+    const int m_everyN;
+    QAtomicInteger<qint64> m_lastMs;
+    QAtomicInt m_count;
+    QAtomicInt m_skipped;
+};
+
 class CUTELOGGERSHARED_EXPORT LoggerTimingHelper
 {
     Q_DISABLE_COPY(LoggerTimingHelper)
@@ -29,7 +29,14 @@
 #endif
 
 // STL
+#include <atomic>
 #include <iostream>
+#include <thread>
+
+// The longest time a record waits in the queue of an asynchronous logger
+static const int kFlushIntervalMs = 200;
+// The number of queued records that wakes the writer before the interval
+static const int kMaxPendingRecords = 1000;
 
 /**
  * \file Logger.h
@@ -450,6 +457,19 @@ static void qtLoggerMessageHandler(QtMsgType type, const char *msg);
  * LoggerPrivate class implements the Singleton pattern in a thread-safe way. It contains a static pointer to the
  * global logger instance protected by QReadWriteLock
  */
+struct LogRecord
+{
+    QDateTime timeStamp;
+    Logger::LogLevel logLevel;
+    // The pointers given to write() may not live until the record is written.
+    QByteArray file;
+    int line;
+    QByteArray function;
+    QByteArray category;
+    QString message;
+    LogRecord *next;
+};
+
 class LoggerPrivate
 {
 public:
@@ -459,6 +479,15 @@ public:
     QList<AbstractAppender *> appenders;
     QMutex loggerMutex;
 
+    // The records of an asynchronous logger are pushed onto a lock-free stack
+    // by any thread and taken all at once by the writer thread.
+    std::atomic<LogRecord *> queue{nullptr};
+    std::atomic<int> pendingCount{0};
+    std::atomic<bool> isStopping{false};
+    std::atomic<std::thread *> writer{nullptr};
+    QSemaphore wakeUp;
+    QMutex drainMutex;
+
     QMap<QString, bool> categories;
     QMultiMap<QString, AbstractAppender *> categoryAppenders;
     QStringList noAppendersCategories; //<! Categories without appenders that was already warned about
@@ -541,6 +570,7 @@ static void qtLoggerMessageHandler(QtMsgType type, const char *msg)
  */
 Logger::Logger()
     : d_ptr(new LoggerPrivate)
+    , m_minimumLevel(Trace)
 {
     Q_D(Logger);
     d->writeDefaultCategoryToGlobalInstance = false;
@@ -557,6 +587,7 @@ Logger::Logger()
  */
 Logger::Logger(const QString &defaultCategory, bool writeToGlobalInstance)
     : d_ptr(new LoggerPrivate)
+    , m_minimumLevel(Trace)
 {
     Q_D(Logger);
     d->writeDefaultCategoryToGlobalInstance = writeToGlobalInstance;
@@ -573,6 +604,10 @@ Logger::~Logger()
 {
     Q_D(Logger);
 
+    // Write the queued records
+    setAsync(false);
+    flush();
+
     // Cleanup appenders
     QMutexLocker appendersLocker(&d->loggerMutex);
 #if QT_VERSION >= 0x050e00
@@ -965,6 +1000,32 @@ void Logger::write(const QDateTime &timeStamp,
                    const char *category,
                    const QString &message)
 {
+    Q_D(Logger);
+
+    if (logLevel != Fatal && d->writer.load(std::memory_order_acquire)) {
+        auto record = new LogRecord{timeStamp,
+                                    logLevel,
+                                    QByteArray(file),
+                                    line,
+                                    QByteArray(function),
+                                    QByteArray(category),
+                                    message,
+                                    d->queue.load(std::memory_order_relaxed)};
+        while (!d->queue.compare_exchange_weak(record->next,
+                                               record,
+                                               std::memory_order_release,
+                                               std::memory_order_relaxed)) {
+        }
+        // Batch the records below warnings unless there are many.
+        const int pendingCount = d->pendingCount.fetch_add(1) + 1;
+        if (logLevel >= Warning || pendingCount >= kMaxPendingRecords)
+            d->wakeUp.release();
+        return;
+    }
+    // Write what is queued before a fatal record, which aborts.
+    if (logLevel == Fatal)
+        flush();
+
     write(timeStamp,
           logLevel,
           file,
@@ -992,6 +1053,115 @@ void Logger::write(LogLevel logLevel,
     write(QDateTime::currentDateTime(), logLevel, file, line, function, category, message);
 }
 
+//! Sets the lowest level of the records to be written
+/**
+ * The LOG_TRACE, LOG_DEBUG, etc. macros check this before formatting the message of a record, so that the records
+ * below it cost almost nothing. Records with the Logger::Fatal level are always written. The default is Logger::Trace.
+ *
+ * Define CUTELOGGER_MIN_LEVEL to the number of a level before including Logger.h to compile out the macros below it.
+ *
+ * \sa isLoggable()
+ * \sa AbstractAppender::setDetailsLevel()
+ */
+void Logger::setMinimumLevel(LogLevel level)
+{
+    m_minimumLevel.storeRelaxed(level);
+}
+
+//! Returns the lowest level of the records to be written
+/**
+ * \sa setMinimumLevel()
+ */
+Logger::LogLevel Logger::minimumLevel() const
+{
+    return static_cast<LogLevel>(m_minimumLevel.loadRelaxed());
+}
+
+//! Writes the records to the appenders in a background thread
+/**
+ * When asynchronous, write() queues the record and returns without waiting for the appenders, which a writer thread
+ * calls in batches. A record waits at most a fraction of a second, and a warning or a more severe record is written
+ * right away. A Logger::Fatal record is written synchronously after the queued records.
+ *
+ * Turning it off writes the queued records and stops the thread.
+ *
+ * \sa flush()
+ */
+void Logger::setAsync(bool async)
+{
+    Q_D(Logger);
+
+    if (async == isAsync())
+        return;
+    if (async) {
+        d->isStopping = false;
+        d->writer = new std::thread([this, d]() {
+            while (!d->isStopping) {
+                d->wakeUp.tryAcquire(1, kFlushIntervalMs);
+                d->wakeUp.tryAcquire(d->wakeUp.available());
+                flush();
+            }
+        });
+    } else {
+        std::thread *writer = d->writer.exchange(nullptr);
+        d->isStopping = true;
+        d->wakeUp.release();
+        writer->join();
+        delete writer;
+        flush();
+    }
+}
+
+//! Returns whether the records are written in a background thread
+/**
+ * \sa setAsync()
+ */
+bool Logger::isAsync() const
+{
+    Q_D(const Logger);
+    return d->writer.load() != nullptr;
+}
+
+//! Writes the records queued by an asynchronous logger to the appenders
+/**
+ * \sa setAsync()
+ */
+void Logger::flush()
+{
+    Q_D(Logger);
+
+    QMutexLocker locker(&d->drainMutex);
+    LogRecord *record = d->queue.exchange(nullptr, std::memory_order_acquire);
+    if (!record)
+        return;
+
+    // The stack has the newest record first.
+    LogRecord *oldest = nullptr;
+    int count = 0;
+    while (record) {
+        LogRecord *next = record->next;
+        record->next = oldest;
+        oldest = record;
+        record = next;
+        ++count;
+    }
+    d->pendingCount.fetch_sub(count);
+
+    while (oldest) {
+        write(oldest->timeStamp,
+              oldest->logLevel,
+              oldest->file.constData(),
+              oldest->line,
+              oldest->function.constData(),
+              oldest->category.isNull() ? nullptr : oldest->category.constData(),
+              oldest->message,
+              /* fromLocalInstance = */ false);
+        LogRecord *next = oldest->next;
+        delete oldest;
+        oldest = next;
+    }
+}
+
 //! Writes the assertion
 /**
  * This function writes the assertion record using the write() function.
@@ -1070,9 +1240,59 @@ LoggerTimingHelper::~LoggerTimingHelper()
 
 CuteMessageLogger::~CuteMessageLogger()
 {
+    if (m_skipped > 0)
+        m_message += QString(QLatin1String(" (repeated %1 times in the last %2 s)"))
+                         .arg(m_skipped + 1)
+                         .arg(qMax<qint64>(1, (m_elapsedMs + 500) / 1000));
     m_l->write(m_level, m_file, m_line, m_function, m_category, m_message);
 }
 
+/**
+ * \class LoggerThrottle
+ *
+ * \brief Decides which of the repeats of a record are logged.
+ *
+ * It is used by the LOG_*_THROTTLED and LOG_*_EVERY_N macros through a static instance for each
+ * place they are used, and it may be checked from several threads at once.
+ */
+LoggerThrottle::LoggerThrottle(int intervalMs, int everyN)
+    : m_intervalMs(intervalMs)
+    , m_everyN(qMax(1, everyN))
+    , m_lastMs(-1)
+    , m_count(0)
+    , m_skipped(0)
+{}
+
+/**
+ * Returns true if the record is to be logged, in which case \a skipped is set to how many were
+ * not logged since the previous one and \a elapsedMs to the time since it.
+ */
+bool LoggerThrottle::check(int &skipped, qint64 &elapsedMs)
+{
+    static const QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    const qint64 now = clock.elapsed();
+    const qint64 last = m_lastMs.loadRelaxed();
+    bool isLogged;
+    if (m_intervalMs > 0)
+        isLogged = (last < 0 || now - last >= m_intervalMs)
+                   && m_lastMs.testAndSetRelaxed(last, now);
+    else
+        isLogged = uint(m_count.fetchAndAddRelaxed(1)) % uint(m_everyN) == 0;
+    if (!isLogged) {
+        m_skipped.fetchAndAddRelaxed(1);
+        return false;
+    }
+    if (m_intervalMs <= 0)
+        m_lastMs.storeRelaxed(now);
+    skipped = m_skipped.fetchAndStoreRelaxed(0);
+    elapsedMs = last < 0 ? 0 : now - last;
+    return true;
+}
+
 void CuteMessageLogger::write(const char *msg, ...)
 {
     va_list va;
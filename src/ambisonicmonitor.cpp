@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ambisonicmonitor.h"
+
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+#include <QtMath>
+
+#include <memory>
+
+static const char *kAmbisonicMonitorProperty = "_shotcut:ambisonicMonitor";
+static const int kChannels = 4;
+
+static int getAudio(mlt_frame frame,
+                    void **buffer,
+                    mlt_audio_format *format,
+                    int *frequency,
+                    int *channels,
+                    int *samples)
+{
+    auto filter = static_cast<mlt_filter>(mlt_frame_pop_audio(frame));
+    *format = mlt_audio_f32le;
+    int error = mlt_frame_get_audio(frame, buffer, format, frequency, channels, samples);
+    if (error || *format != mlt_audio_f32le || *channels != kChannels || !*buffer)
+        return error;
+    const double yaw = mlt_properties_get_double(MLT_FILTER_PROPERTIES(filter), "_yaw");
+    AmbisonicMonitor::decode(static_cast<float *>(*buffer), *samples, yaw);
+    return 0;
+}
+
+static mlt_frame process(mlt_filter filter, mlt_frame frame)
+{
+    mlt_frame_push_audio(frame, filter);
+    mlt_frame_push_audio(frame, (void *) getAudio);
+    return frame;
+}
+
+void AmbisonicMonitor::configure(Mlt::Producer &producer, bool isEnabled, double yaw)
+{
+    if (!producer.is_valid())
+        return;
+    std::unique_ptr<Mlt::Filter> filter;
+    for (int i = 0; i < producer.filter_count() && !filter; ++i) {
+        filter.reset(producer.filter(i));
+        if (filter && !filter->get_int(kAmbisonicMonitorProperty))
+            filter.reset();
+    }
+    if (!isEnabled) {
+        if (filter)
+            producer.detach(*filter);
+        return;
+    }
+    if (!filter) {
+        auto mltFilter = mlt_filter_new();
+        if (!mltFilter)
+            return;
+        mltFilter->process = process;
+        filter.reset(new Mlt::Filter(mltFilter));
+        mlt_filter_close(mltFilter);
+        // The XML consumer and the filter models skip the loader filters.
+        filter->set("_loader", 1);
+        filter->set(kShotcutHiddenProperty, 1);
+        filter->set(kAmbisonicMonitorProperty, 1);
+        // Last, so that it decodes the audio after all of the filters.
+        producer.attach(*filter);
+    }
+    filter->set("_yaw", qDegreesToRadians(yaw));
+}
+
+void AmbisonicMonitor::decode(float *buffer, int samples, double yaw)
+{
+    // The ambisonic azimuth turns to the left, and the microphones point 90
+    // degrees to either side of the view. The right one is the opposite of
+    // the left one.
+    const float x = 0.5f * float(qCos(M_PI_2 - yaw));
+    const float y = 0.5f * float(qSin(M_PI_2 - yaw));
+    // One frame per iteration with no dependency between them, which the
+    // compilers vectorize.
+    for (int i = 0; i < samples; ++i) {
+        float *s = buffer + i * kChannels;
+        const float w = 0.5f * s[0];
+        const float side = x * s[3] + y * s[1];
+        s[0] = w + side;
+        s[1] = w - side;
+        s[2] = 0.0f;
+        s[3] = 0.0f;
+    }
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AMBISONICMONITOR_H
+#define AMBISONICMONITOR_H
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class AmbisonicMonitor
+  \brief Decodes first-order ambisonic audio to stereo for the player.
+
+  \threadsafe
+
+  A project with four channels of 360 video usually carries ambisonic
+  audio in the AmbiX format: ACN channel order (W, Y, Z, X) with SN3D
+  normalization. Played as is, the four channels go to the quad speakers as
+  if they were. While the 360 viewport of the player is shown, a hidden
+  filter on the producer decodes them into a pair of virtual cardioid
+  microphones that face left and right of the view direction, in the front
+  channels with the rear ones silent. The export is not affected.
+*/
+
+class AmbisonicMonitor
+{
+public:
+    /*!
+      Decodes the audio of \a producer for a view turned \a yaw degrees to
+      the right when \a isEnabled, or removes the decoder otherwise.
+    */
+    static void configure(Mlt::Producer &producer, bool isEnabled, double yaw);
+    /*!
+      Decodes \a samples interleaved frames of four AmbiX channels in place into
+      the first two with \a yaw in radians.
+    */
+    static void decode(float *buffer, int samples, double yaw);
+
+private:
+    AmbisonicMonitor() {}
+};
+
+#endif // AMBISONICMONITOR_H
@@ -0,0 +1,319 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audiopremix.h"
+
+#include "memorybudget.h"
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+#include <QMutexLocker>
+
+#include <cstring>
+
+static const char *kAudioPremixProperty = "_shotcut:audioPremix";
+static const int kMaxCacheCost = 32 * 1024; // KiB
+// The seconds to mix in the direction of play and in the other one.
+static const double kLeadSeconds = 3.0;
+static const double kTrailSeconds = 1.0;
+// The most that shuttling lengthens the lead.
+static const double kMaxLeadSpeed = 4.0;
+// The frames to mix in ascending order when going backwards.
+static const int kChunkFrames = 12;
+
+static int getAudio(mlt_frame frame,
+                    void **buffer,
+                    mlt_audio_format *format,
+                    int *frequency,
+                    int *channels,
+                    int *samples)
+{
+    // Forward playback at normal speed keeps ahead of itself.
+    const double speed = mlt_properties_get_double(MLT_FRAME_PROPERTIES(frame), "_speed");
+    QByteArray audio;
+    if (speed != 1.0
+        && AudioPremix::singleton().read(mlt_frame_get_position(frame),
+                                         *frequency,
+                                         *channels,
+                                         *samples,
+                                         audio)) {
+        auto data = mlt_pool_alloc(audio.size());
+        std::memcpy(data, audio.constData(), audio.size());
+        mlt_frame_set_audio(frame, data, mlt_audio_f32le, audio.size(), mlt_pool_release);
+        *buffer = data;
+        *format = mlt_audio_f32le;
+        return 0;
+    }
+    return mlt_frame_get_audio(frame, buffer, format, frequency, channels, samples);
+}
+
+static mlt_frame process(mlt_filter, mlt_frame frame)
+{
+    mlt_frame_push_audio(frame, (void *) getAudio);
+    return frame;
+}
+
+AudioPremix::AudioPremix(QObject *parent)
+    : QThread(parent)
+    , m_generation(-1)
+    , m_frequency(0)
+    , m_channels(0)
+    , m_fps(0.0)
+    , m_cacheGeneration(-1)
+    , m_position(0)
+    , m_speed(0.0)
+    , m_isRequested(false)
+    , m_isStopping(false)
+{
+    setObjectName("AudioPremix");
+    m_frames.setMaxCost(kMaxCacheCost);
+    MEMORY.add(
+        "premixed audio",
+        MemoryBudget::FramePriority,
+        [this]() {
+            QMutexLocker locker(&m_mutex);
+            return qint64(m_frames.totalCost()) * 1024;
+        },
+        [this](qint64 bytes) {
+            QMutexLocker locker(&m_mutex);
+            return MemoryBudget::trim(m_frames, bytes);
+        });
+}
+
+AudioPremix::~AudioPremix()
+{
+    stop();
+}
+
+AudioPremix &AudioPremix::singleton()
+{
+    static AudioPremix instance;
+    return instance;
+}
+
+void AudioPremix::attach(Mlt::Producer &producer)
+{
+    if (!producer.is_valid() || producer.type() != mlt_service_tractor_type)
+        return;
+    for (int i = 0; i < producer.filter_count(); ++i) {
+        std::unique_ptr<Mlt::Filter> filter(producer.filter(i));
+        if (filter && filter->get_int(kAudioPremixProperty))
+            return;
+    }
+    auto mltFilter = mlt_filter_new();
+    if (!mltFilter)
+        return;
+    mltFilter->process = process;
+    Mlt::Filter filter(mltFilter);
+    mlt_filter_close(mltFilter);
+    // The XML consumer and the filter models skip the loader filters.
+    filter.set("_loader", 1);
+    filter.set(kShotcutHiddenProperty, 1);
+    filter.set(kAudioPremixProperty, 1);
+    producer.attach(filter);
+    // First, so that the filters of the timeline still apply to the cached mix.
+    producer.move_filter(producer.filter_count() - 1, 0);
+}
+
+void AudioPremix::setProducer(
+    Mlt::Producer *producer, int generation, int frequency, int channels, double fps)
+{
+    // The worker may still be mixing from the old clone, so it is released
+    // by whichever of the two lets go last.
+    std::shared_ptr<Mlt::Producer> old;
+    QMutexLocker locker(&m_mutex);
+    old = m_producer;
+    // Pulling the frames in order reads the audio of each clip once.
+    if (producer)
+        producer->set_speed(1.0);
+    m_producer.reset(producer);
+    m_generation = generation;
+    m_frequency = frequency;
+    m_channels = channels;
+    m_fps = fps;
+    m_isRequested = false;
+}
+
+int AudioPremix::generation()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void AudioPremix::invalidate(int generation)
+{
+    QMutexLocker locker(&m_mutex);
+    if (generation == m_cacheGeneration)
+        return;
+    m_cacheGeneration = generation;
+    m_frames.clear();
+    m_isRequested = false;
+}
+
+void AudioPremix::editProducer(const std::function<void(Mlt::Producer &)> &edit,
+                               int from,
+                               int to,
+                               bool isAudioChanged)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_producer || m_generation != from) {
+        locker.unlock();
+        invalidate(to);
+        return;
+    }
+    edit(*m_producer);
+    m_generation = to;
+    if (isAudioChanged || m_cacheGeneration != from)
+        m_frames.clear();
+    m_cacheGeneration = to;
+    m_isRequested = false;
+}
+
+void AudioPremix::request(int position, double speed)
+{
+    QMutexLocker locker(&m_mutex);
+    m_position = position;
+    m_speed = speed;
+    m_isRequested = m_producer && m_generation == m_cacheGeneration;
+    if (m_isRequested) {
+        if (!isRunning())
+            start(QThread::LowPriority);
+        m_condition.wakeOne();
+    }
+}
+
+void AudioPremix::stop()
+{
+    m_mutex.lock();
+    m_isStopping = true;
+    m_isRequested = false;
+    m_condition.wakeOne();
+    m_mutex.unlock();
+    wait();
+    m_mutex.lock();
+    m_producer.reset();
+    m_generation = -1;
+    m_isStopping = false;
+    m_mutex.unlock();
+}
+
+bool AudioPremix::read(int position, int frequency, int channels, int samples, QByteArray &buffer)
+{
+    QMutexLocker locker(&m_mutex);
+    auto audio = m_frames.object(position);
+    if (!audio || audio->frequency != frequency || audio->channels != channels
+        || audio->samples != samples)
+        return false;
+    buffer = audio->data;
+    return true;
+}
+
+bool AudioPremix::isInterrupted(int generation)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_isRequested || m_isStopping || generation != m_cacheGeneration;
+}
+
+bool AudioPremix::contains(int position)
+{
+    QMutexLocker locker(&m_mutex);
+    return m_frames.contains(position);
+}
+
+void AudioPremix::run()
+{
+    forever {
+        m_mutex.lock();
+        while (!m_isRequested && !m_isStopping)
+            m_condition.wait(&m_mutex);
+        if (m_isStopping) {
+            m_mutex.unlock();
+            break;
+        }
+        m_isRequested = false;
+        auto producer = m_producer;
+        const int generation = m_generation;
+        const int frequency = m_frequency;
+        const int channels = m_channels;
+        const double fps = m_fps;
+        const int position = m_position;
+        const double speed = m_speed;
+        m_mutex.unlock();
+
+        if (!producer || !producer->is_valid() || fps <= 0.0)
+            continue;
+        const int length = producer->get_length();
+        const int lead = qRound(fps * kLeadSeconds * qBound(1.0, qAbs(speed), kMaxLeadSpeed));
+        const int trail = qRound(fps * kTrailSeconds);
+        const bool isReverse = speed < 0.0;
+        const int first = qMax(0, position - (isReverse ? lead : trail));
+        const int last = qMin(length - 1, position + (isReverse ? trail : lead));
+
+        // Mix from the playhead in the direction of play first, backward in
+        // chunks that are each in ascending order.
+        QList<QPair<int, int>> ranges;
+        for (int i = position; i > first; i -= kChunkFrames)
+            ranges << qMakePair(qMax(first, i - kChunkFrames), i - 1);
+        if (isReverse)
+            ranges << qMakePair(position, last);
+        else
+            ranges.prepend(qMakePair(position, last));
+        for (const auto &range : ranges) {
+            bool isSeekNeeded = true;
+            for (int i = range.first; i <= range.second; ++i) {
+                if (isInterrupted(generation))
+                    break;
+                if (contains(i)) {
+                    isSeekNeeded = true;
+                    continue;
+                }
+                if (isSeekNeeded) {
+                    producer->seek(i);
+                    isSeekNeeded = false;
+                }
+                std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
+                if (!frame || !frame->is_valid())
+                    continue;
+                auto format = mlt_audio_f32le;
+                int outFrequency = frequency;
+                int outChannels = channels;
+                int samples = mlt_audio_calculate_frame_samples(fps, frequency, i);
+                const int requested = samples;
+                auto data = frame->get_audio(format, outFrequency, outChannels, samples);
+                // The consumer converts whatever was not mixed as it asks.
+                if (!data || format != mlt_audio_f32le || outFrequency != frequency
+                    || outChannels != channels || samples != requested)
+                    continue;
+                auto audio = new Audio;
+                audio->data = QByteArray(static_cast<const char *>(data),
+                                         samples * channels * int(sizeof(float)));
+                audio->frequency = frequency;
+                audio->channels = channels;
+                audio->samples = samples;
+                QMutexLocker locker(&m_mutex);
+                // An edit made while mixing makes this frame stale.
+                if (generation != m_cacheGeneration) {
+                    delete audio;
+                    continue;
+                }
+                m_frames.insert(i, audio, qMax(1, int(audio->data.size() / 1024)));
+            }
+            if (isInterrupted(generation))
+                break;
+        }
+    }
+}
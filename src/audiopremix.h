@@ -0,0 +1,125 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOPREMIX_H
+#define AUDIOPREMIX_H
+
+#include <QByteArray>
+#include <QCache>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <functional>
+#include <memory>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class AudioPremix
+  \brief Mixes the audio of the timeline around the playhead ahead of time.
+
+  \threadsafe
+
+  While scrubbing or shuttling, every frame the consumer pulls mixes the audio
+  of all of the tracks, which alone can keep a timeline with many tracks from
+  keeping up. The premix renders the mixed audio of the frames around the
+  playhead on its own clone of the tractor and keeps it as interleaved floats.
+  A hidden filter on the tractor of the player returns the cached samples of a
+  frame instead of mixing it when the player is not playing forward at normal
+  speed, and mixes it live otherwise or when it is not cached.
+
+  The cache belongs to one generation of the edits. Any edit invalidates it
+  because the model does not tell which range it changed, and the frames near
+  the playhead are rendered again first.
+*/
+
+class AudioPremix : public QThread
+{
+    Q_OBJECT
+public:
+    static AudioPremix &singleton();
+    ~AudioPremix();
+
+    //! Attaches the filter that plays the cached audio to the tractor \a producer.
+    static void attach(Mlt::Producer &producer);
+
+    /*!
+      Replaces the tractor to render with \a producer and takes ownership of
+      it. The audio is mixed at \a frequency with \a channels for frames of
+      \a fps and kept if \a generation is still current.
+    */
+    void setProducer(Mlt::Producer *producer,
+                     int generation,
+                     int frequency,
+                     int channels,
+                     double fps);
+    int generation();
+    //! Drops the cached audio of the generations before \a generation.
+    void invalidate(int generation);
+    /*!
+      Calls \a edit with the tractor to render and moves it from generation
+      \a from to \a to instead of cloning it again, if it is still current.
+      The cached audio is kept unless \a isAudioChanged.
+    */
+    void editProducer(const std::function<void(Mlt::Producer &)> &edit,
+                      int from,
+                      int to,
+                      bool isAudioChanged);
+    //! Renders the frames around \a position, more of them in the direction of \a speed.
+    void request(int position, double speed);
+    void stop();
+
+    /*!
+      Copies the cached audio of the frame at \a position to \a buffer if it
+      was mixed with \a frequency, \a channels and \a samples.
+    */
+    bool read(int position, int frequency, int channels, int samples, QByteArray &buffer);
+
+private:
+    struct Audio
+    {
+        QByteArray data;
+        int frequency;
+        int channels;
+        int samples;
+    };
+
+    explicit AudioPremix(QObject *parent = nullptr);
+    bool isInterrupted(int generation);
+    bool contains(int position);
+    void run() override;
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::shared_ptr<Mlt::Producer> m_producer;
+    int m_generation;
+    int m_frequency;
+    int m_channels;
+    double m_fps;
+    // The generation of the edits that the cached audio belongs to.
+    int m_cacheGeneration;
+    QCache<int, Audio> m_frames;
+    int m_position;
+    double m_speed;
+    bool m_isRequested;
+    bool m_isStopping;
+};
+
+#endif // AUDIOPREMIX_H
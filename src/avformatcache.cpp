@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "avformatcache.h"
+
+#include "Logger.h"
+#include "executors.h"
+#include "mainwindow.h"
+#include "memorybudget.h"
+#include "mltcontroller.h"
+
+#include <Mlt.h>
+#include <QSet>
+
+#include <memory>
+
+static const int kScheduleDelayMs = 250;
+static const int kMinimumSize = 4;
+// The seconds before and after the playhead whose clips are kept open.
+static const double kWindowSeconds = 10.0;
+// The frames that a decoder keeps for reordering and its threads.
+static const int kDecoderFrames = 8;
+// The share of the memory budget for the open decoders.
+static const int kBudgetDivisor = 4;
+
+AvformatCache::AvformatCache(QObject *parent)
+    : QObject(parent)
+    , m_trackCount(0)
+    , m_position(0)
+    , m_countedPosition(-1)
+    , m_workingSet(0)
+    , m_size(0)
+    , m_resizeCount(0)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kScheduleDelayMs);
+    connect(&m_timer, &QTimer::timeout, this, &AvformatCache::apply);
+}
+
+AvformatCache &AvformatCache::singleton()
+{
+    static AvformatCache instance;
+    return instance;
+}
+
+void AvformatCache::setTrackCount(int count)
+{
+    m_trackCount = count;
+    schedule();
+}
+
+void AvformatCache::setPosition(int position)
+{
+    m_position = position;
+    // Recount only once the window has moved by a quarter.
+    const int window = qRound(MLT.profile().fps() * kWindowSeconds);
+    if (m_countedPosition < 0 || qAbs(position - m_countedPosition) > window / 4)
+        schedule();
+}
+
+void AvformatCache::schedule()
+{
+    if (!m_timer.isActive())
+        m_timer.start();
+}
+
+void AvformatCache::apply()
+{
+    m_countedPosition = m_position;
+    m_workingSet = countWorkingSet();
+
+    // The threads that open media each keep a producer in the cache.
+    const int threads = Executors::pool(Executors::AnalysisExecutor).maxThreadCount()
+                        + Executors::pool(Executors::ThumbnailExecutor).maxThreadCount();
+    // Keep at least the clip under the playhead of every track open.
+    const int minimum = qMax(kMinimumSize, threads + m_trackCount);
+    int size = threads + m_workingSet * 2;
+    const qint64 budget = MEMORY.budget();
+    const qint64 decoderBytes = qint64(MLT.profile().width()) * MLT.profile().height() * 3 / 2
+                                * kDecoderFrames;
+    if (budget > 0 && decoderBytes > 0)
+        size = qMin<qint64>(size, budget / kBudgetDivisor / decoderBytes);
+    size = qMax(minimum, size);
+    if (size == m_size)
+        return;
+    LOG_DEBUG() << "avformat producers" << size << "for" << m_workingSet << "clips";
+    m_size = size;
+    ++m_resizeCount;
+    mlt_service_cache_set_size(nullptr, "producer_avformat", size);
+}
+
+int AvformatCache::countWorkingSet() const
+{
+    auto multitrack = MAIN.multitrack();
+    if (!multitrack || !multitrack->is_valid())
+        return 0;
+    Mlt::Tractor tractor(*multitrack);
+    const int window = qRound(MLT.profile().fps() * kWindowSeconds);
+    const int first = qMax(0, m_position - window);
+    const int last = m_position + window;
+    QSet<mlt_producer> producers;
+    for (int i = 0; i < tractor.count(); ++i) {
+        std::unique_ptr<Mlt::Producer> track(tractor.track(i));
+        if (!track || !track->is_valid())
+            continue;
+        Mlt::Playlist playlist(*track);
+        if (!playlist.is_valid() || playlist.count() <= 0)
+            continue;
+        const int end = playlist.get_clip_index_at(last);
+        for (int j = playlist.get_clip_index_at(first); j <= end && j < playlist.count(); ++j) {
+            if (playlist.is_blank(j))
+                continue;
+            std::unique_ptr<Mlt::ClipInfo> info(playlist.clip_info(j));
+            if (!info || !info->producer)
+                continue;
+            const char *service = info->producer->get("mlt_service");
+            if (service && QString::fromLatin1(service).startsWith("avformat"))
+                producers << info->producer->get_producer();
+        }
+    }
+    // The source player keeps its clip open too.
+    return producers.size() + 1;
+}
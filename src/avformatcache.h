@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AVFORMATCACHE_H
+#define AVFORMATCACHE_H
+
+#include <QObject>
+#include <QTimer>
+
+/*!
+  \class AvformatCache
+  \brief Sizes the cache of open avformat producers to the clips near the playhead.
+
+  MLT keeps the decoders of a limited count of avformat producers open and
+  closes the least recently used one when another opens. Too few for the clips
+  that play together makes them reopen and seek on every pass, and too many
+  keep the decoders and file handles of clips far from the playhead.
+
+  The size follows the working set: the avformat clips of the timeline within
+  a window around the playhead, twice for the clone that renders ahead, plus
+  one for each thread that opens media in the background. Since playing
+  touches the clips near the playhead, the least recently used ones that MLT
+  closes are the ones farther away. The estimated memory of the decoders is
+  kept within a share of the memory budget.
+*/
+
+class AvformatCache : public QObject
+{
+    Q_OBJECT
+public:
+    static AvformatCache &singleton();
+
+    //! Returns the count of producers that the cache keeps open.
+    int size() const { return m_size; }
+    //! Returns the count of avformat clips in the window around the playhead.
+    int workingSet() const { return m_workingSet; }
+    //! Returns how many times the size changed.
+    int resizeCount() const { return m_resizeCount; }
+
+public slots:
+    void setTrackCount(int count);
+    void setPosition(int position);
+    //! Updates the size soon, such as after an edit.
+    void schedule();
+
+private:
+    explicit AvformatCache(QObject *parent = nullptr);
+    void apply();
+    int countWorkingSet() const;
+
+    QTimer m_timer;
+    int m_trackCount;
+    int m_position;
+    // The position at which the working set was last counted.
+    int m_countedPosition;
+    int m_workingSet;
+    int m_size;
+    int m_resizeCount;
+};
+
+#endif // AVFORMATCACHE_H
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "backgroundtask.h"
+
+#include "Logger.h"
+#include "mainwindow.h"
+
+#include <QAction>
+
+// The results that arrive meanwhile are applied together.
+static const int kApplyIntervalMs = 50;
+static const int kProgressIntervalMs = 250;
+
+BackgroundTask::BackgroundTask(const QString &title, QFutureWatcherBase *watcher, QObject *context)
+    : QObject(context)
+    , m_title(title)
+    , m_watcher(watcher)
+{
+    LOG_DEBUG() << "starting" << title;
+    m_watcher->setParent(this);
+    m_applyTimer.setSingleShot(true);
+    m_applyTimer.setInterval(kApplyIntervalMs);
+    connect(&m_applyTimer, &QTimer::timeout, this, &BackgroundTask::applyResults);
+    m_progressTimer.setSingleShot(true);
+    m_progressTimer.setInterval(kProgressIntervalMs);
+    connect(&m_progressTimer, &QTimer::timeout, this, &BackgroundTask::showProgress);
+
+    connect(m_watcher, &QFutureWatcherBase::resultsReadyAt, this, [this]() {
+        if (!m_applyTimer.isActive())
+            m_applyTimer.start();
+    });
+    auto scheduleProgress = [this]() {
+        if (!m_progressTimer.isActive())
+            m_progressTimer.start();
+    };
+    connect(m_watcher, &QFutureWatcherBase::progressRangeChanged, this, scheduleProgress);
+    connect(m_watcher, &QFutureWatcherBase::progressValueChanged, this, scheduleProgress);
+    connect(m_watcher, &QFutureWatcherBase::progressTextChanged, this, scheduleProgress);
+    connect(m_watcher, &QFutureWatcherBase::finished, this, &BackgroundTask::onFinished);
+}
+
+BackgroundTask::~BackgroundTask()
+{
+    if (!m_isFinished)
+        m_watcher->cancel();
+}
+
+bool BackgroundTask::isCanceled() const
+{
+    return m_watcher->isCanceled();
+}
+
+void BackgroundTask::cancel()
+{
+    if (m_watcher->isFinished())
+        return;
+    LOG_INFO() << "canceled" << m_title;
+    m_watcher->cancel();
+}
+
+void BackgroundTask::applyResults()
+{
+    // Apply can open a dialog, whose event loop must not apply the next batch.
+    if (m_isApplying) {
+        m_applyTimer.start();
+        return;
+    }
+    m_isApplying = true;
+    m_apply();
+    m_isApplying = false;
+    if (m_isFinishPending)
+        finish();
+}
+
+void BackgroundTask::showProgress()
+{
+    if (m_watcher->isFinished() || m_watcher->isCanceled())
+        return;
+    auto text = m_title;
+    const auto progress = m_watcher->progressText();
+    if (!progress.isEmpty())
+        text += QStringLiteral(": ") + progress;
+    const int minimum = m_watcher->progressMinimum();
+    const int maximum = m_watcher->progressMaximum();
+    if (maximum > minimum)
+        text += QStringLiteral(" (%1/%2)")
+                    .arg(m_watcher->progressValue() - minimum)
+                    .arg(maximum - minimum);
+    auto action = new QAction(tr("%1 - click to cancel").arg(text));
+    connect(action, &QAction::triggered, this, &BackgroundTask::cancel);
+    m_statusAction = action;
+    MAIN.showStatusMessage(action);
+}
+
+void BackgroundTask::onFinished()
+{
+    if (m_isApplying)
+        m_isFinishPending = true;
+    else
+        finish();
+}
+
+void BackgroundTask::finish()
+{
+    if (m_isFinished)
+        return;
+    m_isFinished = true;
+    m_isFinishPending = false;
+    m_progressTimer.stop();
+    m_applyTimer.stop();
+    m_isApplying = true;
+    m_apply();
+    m_isApplying = false;
+    // Clear the progress unless another message replaced it.
+    if (m_statusAction)
+        MAIN.showStatusMessage(QString(), 0);
+    LOG_DEBUG() << (m_watcher->isCanceled() ? "canceled" : "finished") << m_title;
+    if (m_finished)
+        m_finished(m_watcher->isCanceled());
+    deleteLater();
+}
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BACKGROUNDTASK_H
+#define BACKGROUNDTASK_H
+
+#include "executors.h"
+
+#include <QFutureWatcher>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QPromise>
+#include <QTimer>
+
+#include <functional>
+#include <utility>
+
+class QAction;
+
+/*!
+  \class BackgroundTask
+  \brief Runs a long operation on a worker without blocking the user.
+
+  The work is given a QPromise<T>. It adds its results with addResult(),
+  reports its progress with setProgressRange() and setProgressValueAndText(),
+  and stops early when isCanceled() becomes true. The results are applied on
+  the GUI thread in batches by the \a apply function given to start(), and
+  \a finished is called once the work is done or canceled. Unlike LongUiTask,
+  nothing re-enters the event loop, and the user keeps working meanwhile.
+
+  The progress is shown on the status label of the player, which cancels the
+  task when clicked. The task deletes itself when finished, or with its
+  \a context, which also cancels the work.
+*/
+
+class BackgroundTask : public QObject
+{
+    Q_OBJECT
+
+public:
+    ~BackgroundTask();
+
+    template<class T, class Work>
+    static BackgroundTask *start(const QString &title,
+                                 QObject *context,
+                                 Work &&work,
+                                 std::function<void(const QList<T> &)> apply,
+                                 std::function<void(bool isCanceled)> finished = nullptr)
+    {
+        auto watcher = new QFutureWatcher<T>;
+        auto task = new BackgroundTask(title, watcher, context);
+        task->m_apply = [watcher, apply, applied = 0]() mutable {
+            // The results after a cancel are dropped.
+            if (watcher->isCanceled())
+                return;
+            const int count = watcher->future().resultCount();
+            if (applied >= count)
+                return;
+            QList<T> results;
+            results.reserve(count - applied);
+            for (; applied < count; ++applied)
+                results << watcher->resultAt(applied);
+            apply(results);
+        };
+        task->m_finished = std::move(finished);
+        watcher->setFuture(
+            Executors::run(Executors::InteractiveExecutor, std::forward<Work>(work)));
+        return task;
+    }
+
+    QString title() const { return m_title; }
+    bool isCanceled() const;
+
+public slots:
+    void cancel();
+
+private:
+    BackgroundTask(const QString &title, QFutureWatcherBase *watcher, QObject *context);
+    void applyResults();
+    void showProgress();
+    void onFinished();
+    void finish();
+
+    QString m_title;
+    QFutureWatcherBase *m_watcher;
+    std::function<void()> m_apply;
+    std::function<void(bool)> m_finished;
+    QTimer m_applyTimer;
+    QTimer m_progressTimer;
+    QPointer<QAction> m_statusAction;
+    bool m_isApplying{false};
+    bool m_isFinishPending{false};
+    bool m_isFinished{false};
+};
+
+#endif // BACKGROUNDTASK_H
@@ -0,0 +1,471 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.h"
+
+#include "Logger.h"
+#include "commands/undohelper.h"
+#include "dataqueue.h"
+#include "database.h"
+#include "dialogs/alignmentarray.h"
+#include "mltcontroller.h"
+#include "mltxmlchecker.h"
+#include "models/multitrackmodel.h"
+#include "models/subtitles.h"
+#include "settings.h"
+#include "sharedframe.h"
+#include "widgets/scopes/videohistogramscopewidget.h"
+#include "widgets/scopes/videowaveformscopewidget.h"
+
+#include <Mlt.h>
+#include <QCoreApplication>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QResizeEvent>
+#include <QTemporaryFile>
+#include <QThread>
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <vector>
+
+#ifdef Q_OS_WIN
+#include <windows.h>
+#else
+#include <sys/resource.h>
+#endif
+
+static const int kIterations = 10;
+static const int kTrackCount = 4;
+static const int kClipFrames = 24;
+static const int kSubtitleCount = 100000;
+static const int kHandoffItems = 100000;
+static const int kSubtitleLookups = 100000;
+static const int kAlignmentSize = 1 << 18;
+static const int kThumbnailCount = 100;
+static const QSize kScopeSize(640, 360);
+// The properties of the player consumer that affect how frames are rendered
+static const char *kConsumerProperties[] = {"real_time",
+                                            "mlt_image_format",
+                                            "width",
+                                            "height",
+                                            "progressive",
+                                            "deinterlacer",
+                                            "rescale",
+                                            "channels",
+                                            "channel_layout",
+                                            "frequency",
+                                            "color_trc"};
+
+namespace {
+struct PlaybackStatistics
+{
+    QMutex mutex;
+    QElapsedTimer timer;
+    std::vector<qint64> shown; ///< When each frame was shown in nanoseconds
+    int dropped = 0;
+};
+} // namespace
+
+// Returns the MLT XML of a timeline with clipCount color clips spread over
+// kTrackCount tracks, each clip followed by a blank.
+static QString timelineXml(int clipCount)
+{
+    Mlt::Tractor tractor(MLT.profile());
+    for (int i = 0; i < kTrackCount; ++i) {
+        Mlt::Playlist playlist(MLT.profile());
+        for (int j = i; j < clipCount; j += kTrackCount) {
+            Mlt::Producer clip(MLT.profile(), "color", "#ff000000");
+            playlist.append(clip, 0, kClipFrames - 1);
+            playlist.blank(j % kClipFrames);
+        }
+        tractor.set_track(playlist, i);
+    }
+    return MLT.XML(&tractor);
+}
+
+// Gives the scope a frame and waits until it has drawn it.
+static void refreshScope(ScopeWidget &scope, const SharedFrame &frame)
+{
+    const int refreshes = scope.statistics().refreshes + 1;
+    scope.onNewFrame(frame);
+    while (scope.statistics().refreshes < refreshes) {
+        // A frame that arrives during a refresh is picked up from the event loop.
+        QCoreApplication::processEvents();
+        QThread::yieldCurrentThread();
+    }
+}
+
+// Returns the processor time used by all threads of the process in nanoseconds.
+static qint64 processCpuTime()
+{
+#ifdef Q_OS_WIN
+    FILETIME creation, exit, kernel, user;
+    if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+        return 0;
+    auto toNanoseconds = [](const FILETIME &time) {
+        return ((qint64(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 100;
+    };
+    return toNanoseconds(kernel) + toNanoseconds(user);
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage))
+        return 0;
+    return (qint64(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000
+            + usage.ru_utime.tv_usec + usage.ru_stime.tv_usec)
+           * 1000;
+#endif
+}
+
+static void onFrameShow(mlt_consumer, PlaybackStatistics *statistics, mlt_event_data data)
+{
+    auto frame = Mlt::EventData(data).to_frame();
+    QMutexLocker locker(&statistics->mutex);
+    statistics->shown.push_back(statistics->timer.nsecsElapsed());
+    // The consumer skips rendering frames that are already late.
+    if (!frame.is_valid() || !frame.get_int("rendered"))
+        ++statistics->dropped;
+}
+
+int Benchmark::run()
+{
+    LOG_INFO() << "benchmark starting with" << QThread::idealThreadCount() << "threads";
+    QElapsedTimer timer;
+    timer.start();
+    benchmarkScopes();
+    benchmarkUndo();
+    benchmarkSubtitles();
+    benchmarkAlignment();
+    benchmarkDatabase();
+    benchmarkXmlChecker();
+    benchmarkDataQueue();
+    LOG_INFO() << "benchmark took" << timer.elapsed() << "ms";
+    return EXIT_SUCCESS;
+}
+
+void Benchmark::measure(const QByteArray &name,
+                        int iterations,
+                        const std::function<void()> &function)
+{
+    function();
+    std::vector<qint64> times;
+    times.reserve(iterations);
+    QElapsedTimer timer;
+    for (int i = 0; i < iterations; ++i) {
+        timer.start();
+        function();
+        times.push_back(timer.nsecsElapsed());
+    }
+    std::sort(times.begin(), times.end());
+    LOG_INFO() << "benchmark" << name.constData() << "median" << times[times.size() / 2] / 1000
+               << "us min" << times.front() / 1000 << "us";
+}
+
+void Benchmark::benchmarkScopes()
+{
+    // Measure the kernels at the resolution of the frame.
+    ScopeWidget::setResolution(ShotcutSettings::ScopeResolutionFull);
+    VideoWaveformScopeWidget waveform;
+    VideoHistogramScopeWidget histogram;
+    for (auto scope : std::initializer_list<ScopeWidget *>{&waveform, &histogram}) {
+        // The scope is never shown, so tell it its size.
+        scope->resize(kScopeSize);
+        QResizeEvent event(scope->size(), QSize());
+        QCoreApplication::sendEvent(scope, &event);
+    }
+
+    for (const QSize &size : {QSize(1920, 1080), QSize(3840, 2160)}) {
+        Mlt::Profile profile;
+        profile.set_width(size.width());
+        profile.set_height(size.height());
+        profile.set_progressive(1);
+        profile.set_sample_aspect(1, 1);
+        profile.set_display_aspect(size.width(), size.height());
+        profile.set_frame_rate(25, 1);
+        profile.set_explicit(true);
+        Mlt::Producer producer(profile, "noise");
+        QScopedPointer<Mlt::Frame> mltFrame(producer.get_frame());
+        if (!mltFrame || !mltFrame->is_valid()) {
+            LOG_WARNING() << "benchmark failed to make a" << size << "frame";
+            continue;
+        }
+        mlt_image_format format = mlt_image_yuv420p;
+        int width = size.width();
+        int height = size.height();
+        mltFrame->get_image(format, width, height);
+        const SharedFrame frame(*mltFrame);
+        const QByteArray suffix = QByteArray::number(size.height()) + 'p';
+
+        measure("waveform " + suffix, kIterations, [&]() { refreshScope(waveform, frame); });
+        measure("histogram " + suffix, kIterations, [&]() { refreshScope(histogram, frame); });
+    }
+    ScopeWidget::setResolution(Settings.scopeResolution());
+}
+
+void Benchmark::benchmarkUndo()
+{
+    for (int clipCount : {1000, 10000}) {
+        auto producer = new Mlt::Producer(MLT.profile(),
+                                          "xml-string",
+                                          timelineXml(clipCount).toUtf8().constData());
+        if (MLT.setProducer(producer)) {
+            LOG_WARNING() << "benchmark failed to load a timeline of" << clipCount << "clips";
+            continue;
+        }
+        MultitrackModel model;
+        model.load();
+        const QByteArray name = "undo " + QByteArray::number(clipCount) + " clips";
+        measure(name, kIterations, [&]() {
+            UndoHelper helper(model);
+            helper.recordBeforeState();
+            model.liftClip(0, 0);
+            helper.recordAfterState();
+            helper.undoChanges();
+        });
+        model.close();
+    }
+    MLT.close();
+}
+
+void Benchmark::benchmarkSubtitles()
+{
+    Subtitles::SubtitleVector items;
+    items.reserve(kSubtitleCount);
+    for (int i = 0; i < kSubtitleCount; ++i)
+        items.push_back({i * 2000LL, i * 2000LL + 1500, "Subtitle " + std::to_string(i)});
+    std::string text;
+    Subtitles::writeToSrtString(text, items);
+
+    measure("read SRT", kIterations, [&]() { Subtitles::readFromSrtString(text); });
+
+    std::mt19937 random(1);
+    std::uniform_int_distribution<int64_t> distribution(0, items.back().end);
+    std::vector<int64_t> times(kSubtitleLookups);
+    for (auto &time : times)
+        time = distribution(random);
+    int found = 0;
+    measure("subtitle index for time", kIterations, [&]() {
+        for (auto time : times)
+            found += Subtitles::indexForTime(items, time, 0, 0) >= 0;
+    });
+    Q_UNUSED(found)
+}
+
+void Benchmark::benchmarkAlignment()
+{
+    std::mt19937 random(1);
+    std::normal_distribution<double> distribution;
+    std::vector<double> reference(kAlignmentSize);
+    for (auto &value : reference)
+        value = distribution(random);
+    // The other array is the reference delayed by a second at 48 kHz.
+    std::vector<double> delayed(kAlignmentSize);
+    std::copy(reference.begin(), reference.end() - 48000, delayed.begin() + 48000);
+
+    AlignmentArray to(kAlignmentSize);
+    AlignmentArray from(kAlignmentSize);
+    measure("align audio", kIterations, [&]() {
+        // Setting the values again includes their transform.
+        to.setValues(reference);
+        from.setValues(delayed);
+        int offset = 0;
+        to.calculateOffset(from, &offset);
+    });
+}
+
+void Benchmark::benchmarkDatabase()
+{
+    QImage image(320, 180, QImage::Format_RGB32);
+    image.fill(Qt::darkCyan);
+    QStringList keys;
+    for (int i = 0; i < kThumbnailCount; ++i)
+        keys << QStringLiteral("benchmark %1").arg(i);
+
+    measure("put thumbnails", kIterations, [&]() {
+        for (const auto &key : keys)
+            DB.putThumbnail(key, image);
+    });
+    measure("get thumbnails", kIterations, [&]() {
+        for (const auto &key : keys)
+            DB.getThumbnail(key);
+    });
+}
+
+void Benchmark::benchmarkXmlChecker()
+{
+    QTemporaryFile file(QDir::temp().filePath("shotcut-benchmark-XXXXXX.mlt"));
+    if (!file.open()) {
+        LOG_WARNING() << "benchmark failed to create" << file.fileName();
+        return;
+    }
+    file.write(timelineXml(10000).toUtf8());
+    file.close();
+
+    measure("check XML 10000 clips", kIterations, [&]() {
+        MltXmlChecker checker;
+        checker.check(file.fileName());
+    });
+}
+
+void Benchmark::benchmarkDataQueue()
+{
+    // Hand frames from one thread to another as the scopes do.
+    measure("DataQueue handoff", kIterations, []() {
+        DataQueue<SharedFrame> queue(64, DataQueue<SharedFrame>::OverflowModeWait);
+        std::unique_ptr<QThread> producer(QThread::create([&]() {
+            for (int i = 0; i < kHandoffItems; ++i)
+                queue.push(SharedFrame());
+        }));
+        producer->start();
+        for (int i = 0; i < kHandoffItems; ++i)
+            queue.pop();
+        producer->wait();
+    });
+    measure("SpscRing blocking handoff", kIterations, []() {
+        SpscRing<SharedFrame, 64> ring(true);
+        std::unique_ptr<QThread> producer(QThread::create([&]() {
+            for (int i = 0; i < kHandoffItems; ++i)
+                ring.push(SharedFrame());
+        }));
+        producer->start();
+        SharedFrame frame;
+        for (int i = 0; i < kHandoffItems; ++i)
+            ring.pop(frame);
+        producer->wait();
+    });
+    measure("SpscRing batch handoff", kIterations, []() {
+        SpscRing<SharedFrame, 64> ring;
+        std::unique_ptr<QThread> producer(QThread::create([&]() {
+            for (int i = 0; i < kHandoffItems; ++i) {
+                while (!ring.push(SharedFrame()))
+                    QThread::yieldCurrentThread();
+            }
+        }));
+        producer->start();
+        std::vector<SharedFrame> frames;
+        frames.reserve(ring.capacity());
+        for (int received = 0; received < kHandoffItems;) {
+            frames.clear();
+            const int n = ring.popAll(std::back_inserter(frames));
+            if (n == 0)
+                QThread::yieldCurrentThread();
+            received += n;
+        }
+        producer->wait();
+    });
+}
+
+int Benchmark::runPlayback(const QString &fileName, const QString &range)
+{
+    if (MLT.open(fileName, fileName) || !MLT.producer()) {
+        LOG_ERROR() << "benchmark failed to open" << fileName;
+        return EXIT_FAILURE;
+    }
+    Mlt::Producer *producer = MLT.producer();
+    int in = 0;
+    int out = producer->get_length() - 1;
+    if (!range.isEmpty()) {
+        // The times of the range are in any format MLT accepts, such as 00:10:00.
+        const auto times = range.split('-');
+        if (times.size() != 2) {
+            LOG_ERROR() << "benchmark range is not start-end:" << range;
+            return EXIT_FAILURE;
+        }
+        in = qBound(0, producer->time_to_frames(times[0].toLatin1().constData()), out);
+        out = qBound(in, producer->time_to_frames(times[1].toLatin1().constData()), out);
+    }
+
+    // Render with the settings of the player, but as fast as possible.
+    Mlt::Consumer consumer(MLT.previewProfile(), "null");
+    if (!consumer.is_valid()) {
+        LOG_ERROR() << "benchmark failed to create the consumer";
+        return EXIT_FAILURE;
+    }
+    if (MLT.consumer()) {
+        for (auto name : kConsumerProperties)
+            consumer.pass_property(*MLT.consumer(), name);
+    }
+    consumer.set("real_time", MLT.realTime());
+    consumer.set("terminate_on_pause", 1);
+    std::unique_ptr<Mlt::Producer> cut(producer->cut(in, out));
+    cut->set_speed(1.0);
+    consumer.connect(*cut);
+
+    PlaybackStatistics statistics;
+    statistics.shown.reserve(out - in + 1);
+    std::unique_ptr<Mlt::Event> event(
+        consumer.listen("consumer-frame-show", &statistics, (mlt_listener) onFrameShow));
+    const qint64 cpuStart = processCpuTime();
+    statistics.timer.start();
+    consumer.start();
+    while (!consumer.is_stopped())
+        QThread::msleep(10);
+    const qint64 elapsed = statistics.timer.nsecsElapsed();
+    const qint64 cpuTime = processCpuTime() - cpuStart;
+    consumer.stop();
+
+    QMutexLocker locker(&statistics.mutex);
+    std::vector<qint64> frameTimes;
+    frameTimes.reserve(statistics.shown.size());
+    qint64 previous = 0;
+    for (auto shown : statistics.shown) {
+        frameTimes.push_back(shown - previous);
+        previous = shown;
+    }
+    std::sort(frameTimes.begin(), frameTimes.end());
+    auto percentile = [&](int percent) {
+        if (frameTimes.empty())
+            return 0.0;
+        const size_t index = qMin(frameTimes.size() - 1, frameTimes.size() * percent / 100);
+        return frameTimes[index] / 1000000.0;
+    };
+    QJsonObject frameMs;
+    frameMs["p50"] = percentile(50);
+    frameMs["p90"] = percentile(90);
+    frameMs["p99"] = percentile(99);
+    frameMs["max"] = percentile(100);
+
+    QJsonObject result;
+    result["project"] = fileName;
+    result["in"] = in;
+    result["out"] = out;
+    result["frames"] = int(statistics.shown.size());
+    result["dropped"] = statistics.dropped;
+    result["fps"] = elapsed > 0 ? statistics.shown.size() * 1e9 / elapsed : 0.0;
+    result["profileFps"] = MLT.profile().fps();
+    result["frameMs"] = frameMs;
+    // 100 percent is one core fully busy.
+    result["cpuPercent"] = elapsed > 0 ? 100.0 * cpuTime / elapsed : 0.0;
+    result["cores"] = QThread::idealThreadCount();
+    result["realTime"] = MLT.realTime();
+    result["previewScale"] = Settings.playerPreviewScale();
+    result["width"] = MLT.previewProfile().width();
+    result["height"] = MLT.previewProfile().height();
+    result["gpu"] = Settings.playerGPU();
+    const QByteArray json = QJsonDocument(result).toJson(QJsonDocument::Compact);
+    LOG_INFO() << "benchmark playback" << json.constData();
+    std::fprintf(stdout, "%s\n", json.constData());
+    std::fflush(stdout);
+    return statistics.shown.empty() ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include <QByteArray>
+#include <QString>
+
+#include <functional>
+
+/*!
+  \class Benchmark
+  \brief Times the core data paths on generated data.
+
+  Run with --benchmark, it measures the video scopes on 1080p and 4K frames,
+  recording and undoing a timeline change, reading and searching subtitles,
+  aligning audio, storing and loading thumbnails, and checking a large
+  project. Each case runs once to warm up and then several times, and the
+  median and minimum are logged, so results can be compared between builds
+  on the same machine. The main window is created but never shown.
+
+  With --benchmark-playback, it instead plays a project, or a range of it,
+  with the settings of the player but without waiting for the clock, and
+  prints the frame times, dropped frames and processor use as JSON.
+*/
+
+class Benchmark
+{
+public:
+    //! Runs every case and returns the exit code of the application.
+    static int run();
+    //! Plays the \a range "start-end" of the project \a fileName as fast as possible.
+    static int runPlayback(const QString &fileName, const QString &range);
+
+private:
+    static void measure(const QByteArray &name,
+                        int iterations,
+                        const std::function<void()> &function);
+    static void benchmarkScopes();
+    static void benchmarkUndo();
+    static void benchmarkSubtitles();
+    static void benchmarkAlignment();
+    static void benchmarkDatabase();
+    static void benchmarkXmlChecker();
+    static void benchmarkDataQueue();
+};
+
+#endif // BENCHMARK_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2025 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,6 +22,9 @@
 #include "mainwindow.h"
 #include "mltcontroller.h"
 #include "qmltypes/qmlapplication.h"
+#include "qmltypes/qmlfilter.h"
+
+#include <algorithm>
 
 /**
  * @class FindProducerParser
@@ -362,11 +365,62 @@ bool DisableCommand::mergeWith(const QUndoCommand *other)
     */
 }
 
+/// 返回属性的值，属性不存在时返回空（null）的 QByteArray
+static QByteArray propertyValue(Mlt::Properties &properties, const char *name)
+{
+    const char *value = properties.get(name);
+    return value ? QByteArray(value) : QByteArray();
+}
+
+/**
+ * @brief 比较两组属性，返回其中不同的属性。
+ * @param before 修改前的属性。
+ * @param after 修改后的属性。
+ */
+static PropertyChanges diffProperties(Mlt::Properties &before, Mlt::Properties &after)
+{
+    PropertyChanges changes;
+    // 修改后存在的属性：新增的或值改变的
+    for (int i = 0; i < after.count(); i++) {
+        const char *name = after.get_name(i);
+        const char *value = after.get(i);
+        if (!name || !value)
+            continue;
+        const char *previous = before.get(name);
+        if (!previous || qstrcmp(previous, value))
+            changes << PropertyChange{name, propertyValue(before, name), value};
+    }
+    // 修改后不存在的属性：被清除的
+    for (int i = 0; i < before.count(); i++) {
+        const char *name = before.get_name(i);
+        if (name && before.get(i) && !after.get(name))
+            changes << PropertyChange{name, before.get(i), QByteArray()};
+    }
+    return changes;
+}
+
+/**
+ * @brief 将属性的修改应用到 \a properties 上。
+ * @param isUndo 为 true 时恢复修改前的值，否则应用修改后的值。
+ */
+static void applyChanges(Mlt::Properties &properties, const PropertyChanges &changes, bool isUndo)
+{
+    for (const auto &change : changes) {
+        const auto &value = isUndo ? change.before : change.after;
+        if (value.isNull())
+            properties.clear(change.name.constData());
+        else
+            properties.set(change.name.constData(), value.constData());
+    }
+}
+
 /**
  * @class PasteCommand
  * @brief 撤销/重做“粘贴滤镜”操作的命令。
  *
- * 它通过保存操作前后的 XML 状态来实现撤销。
+ * 第一次 redo 时记录粘贴添加的滤镜和链接，以及粘贴对已有滤镜的修改。
+ * 之后的 undo/redo 只移除或重新附加这些对象并应用差异，而不必再次解析 XML
+ * 或保存整个 Producer 的 XML。
  */
 PasteCommand::PasteCommand(AttachedFiltersModel &model,
                            const QString &filterProducerXml,
@@ -375,10 +429,9 @@ PasteCommand::PasteCommand(AttachedFiltersModel &model,
     , m_model(model)
     , m_xml(filterProducerXml) // 要粘贴的滤镜的 XML
     , m_producerUuid(MLT.ensureHasUuid(*model.producer()))
+    , m_isPasted(false)
 {
     setText(QObject::tr("Paste filters"));
-    // 保存粘贴前的所有滤镜状态到 XML，用于 undo
-    m_beforeXml = MLT.XML(model.producer());
 }
 
 /// 执行“粘贴滤镜”操作
@@ -387,6 +440,44 @@ void PasteCommand::redo()
     LOG_DEBUG() << text();
     Mlt::Producer producer = findProducer(m_producerUuid);
     Q_ASSERT(producer.is_valid());
+    Mlt::Chain chain(producer);
+    const bool isChain = producer.type() == mlt_service_chain_type;
+
+    if (m_isPasted) {
+        // 按位置从小到大重新附加，使每个对象回到粘贴后的位置
+        for (auto &added : m_filters) {
+            producer.attach(added.second);
+            producer.move_filter(producer.filter_count() - 1, added.first);
+        }
+        if (isChain) {
+            for (auto &added : m_links) {
+                chain.attach(added.second);
+                chain.move_link(chain.link_count() - 1, added.first);
+            }
+        }
+        for (auto &changed : m_changes)
+            applyChanges(changed.first, changed.second, false);
+        emit QmlApplication::singleton().filtersPasted(&producer);
+        return;
+    }
+
+    // 记录粘贴前已有的滤镜和链接，以及滤镜属性的临时副本
+    QVector<QPair<Mlt::Filter, Mlt::Properties>> existingFilters;
+    for (int i = 0; i < producer.filter_count(); i++) {
+        QScopedPointer<Mlt::Filter> filter(producer.filter(i));
+        if (filter && filter->is_valid()) {
+            Mlt::Properties properties;
+            properties.inherit(*filter);
+            existingFilters << qMakePair(Mlt::Filter(*filter), properties);
+        }
+    }
+    QVector<mlt_link> existingLinks;
+    for (int i = 0; isChain && i < chain.link_count(); i++) {
+        QScopedPointer<Mlt::Link> link(chain.link(i));
+        if (link && link->is_valid())
+            existingLinks << link->get_link();
+    }
+
     // 从 XML 字符串创建一个临时的 Producer，它包含了所有要粘贴的滤镜
     Mlt::Profile profile(kDefaultMltProfile);
     Mlt::Producer filtersProducer(profile, "xml-string", m_xml.toUtf8().constData());
@@ -394,6 +485,33 @@ void PasteCommand::redo()
         // 使用 MLT 的 pasteFilters 函数将滤镜复制到目标 Producer
         MLT.pasteFilters(&producer, &filtersProducer);
     }
+    m_xml.clear();
+    m_isPasted = true;
+
+    // 找出新增的滤镜和链接
+    for (int i = 0; i < producer.filter_count(); i++) {
+        QScopedPointer<Mlt::Filter> filter(producer.filter(i));
+        if (!filter || !filter->is_valid())
+            continue;
+        auto it = std::find_if(existingFilters.begin(), existingFilters.end(), [&](auto &existing) {
+            return existing.first.get_filter() == filter->get_filter();
+        });
+        if (it == existingFilters.end()) {
+            m_filters << qMakePair(i, Mlt::Filter(*filter));
+        } else {
+            // 已有的滤镜可能被 adjustFilters 调整了入点、出点或淡入淡出
+            auto changes = diffProperties(it->second, *filter);
+            if (!changes.isEmpty())
+                m_changes << qMakePair(it->first, changes);
+        }
+    }
+    for (int i = 0; isChain && i < chain.link_count(); i++) {
+        QScopedPointer<Mlt::Link> link(chain.link(i));
+        if (link && link->is_valid() && !existingLinks.contains(link->get_link()))
+            m_links << qMakePair(i, Mlt::Link(*link));
+    }
+    LOG_DEBUG() << "pasted filters" << m_filters.size() << "links" << m_links.size()
+                << "changed filters" << m_changes.size();
     // 发出信号，通知 QML 界面滤镜已粘贴
     emit QmlApplication::singleton().filtersPasted(&producer);
 }
@@ -404,22 +522,16 @@ void PasteCommand::undo()
     LOG_DEBUG() << text();
     Mlt::Producer producer = findProducer(m_producerUuid);
     Q_ASSERT(producer.is_valid());
-    // 撤销逻辑：先清空所有滤镜，然后恢复到粘贴前的状态
-    // 1. 移除所有滤镜（除了内部加载器和隐藏的滤镜）
-    for (int i = 0; i < producer.filter_count(); i++) {
-        Mlt::Filter *filter = producer.filter(i);
-        if (filter && filter->is_valid() && !filter->get_int("_loader")
-            && !filter->get_int(kShotcutHiddenProperty)) {
-            producer.detach(*filter);
-            i--; // 因为 detach 后索引会变化，所以 i--
-        }
-        delete filter;
-    }
-    // 2. 从保存的 m_beforeXml 中恢复滤镜
-    Mlt::Profile profile(kDefaultMltProfile);
-    Mlt::Producer filtersProducer(profile, "xml-string", m_beforeXml.toUtf8().constData());
-    if (filtersProducer.is_valid() && filtersProducer.filter_count() > 0) {
-        MLT.pasteFilters(&producer, &filtersProducer);
+    // 恢复已有滤镜被修改的属性，然后移除粘贴添加的滤镜和链接
+    for (auto &changed : m_changes)
+        applyChanges(changed.first, changed.second, true);
+    for (auto &added : m_filters)
+        producer.detach(added.second);
+    if (!m_links.isEmpty() && producer.type() == mlt_service_chain_type) {
+        Mlt::Chain chain(producer);
+        // 从后往前移除，使记录的位置保持有效
+        for (int i = m_links.size() - 1; i >= 0; i--)
+            chain.detach(m_links[i].first);
     }
     // 发出信号，通知 QML 界面
     emit QmlApplication::singleton().filtersPasted(&producer);
@@ -429,7 +541,7 @@ void PasteCommand::undo()
  * @class UndoParameterCommand
  * @brief 撤销/重做“修改滤镜参数”操作的命令。
  *
- * 它通过保存修改前后的参数状态来实现撤销。
+ * 它只保存被修改的参数在修改前后的值，而不是参数的两份完整副本。
  */
 UndoParameterCommand::UndoParameterCommand(const QString &name,
                                            FilterController *controller,
@@ -449,11 +561,9 @@ UndoParameterCommand::UndoParameterCommand(const QString &name,
     } else {
         setText(QObject::tr("Change %1 filter: %2").arg(name, desc));
     }
-    // 保存修改前的所有参数
-    m_before.inherit(before);
-    // 保存修改后的所有参数
+    // 比较修改前的状态与当前的参数，只保存不同的参数
     Mlt::Service *service = controller->attachedModel()->getService(m_row);
-    m_after.inherit(*service);
+    m_changes = diffProperties(before, *service);
 }
 
 /**
@@ -462,11 +572,19 @@ UndoParameterCommand::UndoParameterCommand(const QString &name,
  * 当用户连续调整一个参数时（例如拖动滑块），可以调用此方法来更新最终值，
  * 而不是为每个微小的变化都创建一个新的撤销命令。
  */
-void UndoParameterCommand::update(const QString &propertyName)
+void UndoParameterCommand::update(const QString &propertyName, Mlt::Properties &before)
 {
     Mlt::Service *service = m_filterController->attachedModel()->getService(m_row);
-    // 只更新指定的属性，而不是全部覆盖
-    m_after.pass_property(*service, propertyName.toUtf8().constData());
+    const auto name = propertyName.toUtf8();
+    const auto value = propertyValue(*service, name.constData());
+    // 只更新指定的属性：已记录时更新修改后的值，否则从 before 中取修改前的值
+    auto it = std::find_if(m_changes.begin(), m_changes.end(), [&](const PropertyChange &change) {
+        return change.name == name;
+    });
+    if (it != m_changes.end())
+        it->after = value;
+    else
+        m_changes << PropertyChange{name, propertyValue(before, name.constData()), value};
 }
 
 /// 执行“修改参数”操作
@@ -477,13 +595,13 @@ void UndoParameterCommand::redo()
     if (m_firstRedo) {
         m_firstRedo = false;
     } else {
-        // 后续的 redo（即 undo 之后的重做）才需要应用 m_after 的状态
+        // 后续的 redo（即 undo 之后的重做）才需要应用修改后的值
         Mlt::Producer producer = findProducer(m_producerUuid);
         Q_ASSERT(producer.is_valid());
         if (producer.is_valid() && m_filterController) {
             Mlt::Service service = m_filterController->attachedModel()->doGetService(producer,
                                                                                      m_row);
-            service.inherit(m_after);                  // 应用修改后的参数
+            applyChanges(service, m_changes, false);   // 应用修改后的参数
             m_filterController->onUndoOrRedo(service); // 通知控制器更新 UI
         }
     }
@@ -497,7 +615,7 @@ void UndoParameterCommand::undo()
     Q_ASSERT(producer.is_valid());
     if (producer.is_valid() && m_filterController) {
         Mlt::Service service = m_filterController->attachedModel()->doGetService(producer, m_row);
-        service.inherit(m_before);                 // 恢复修改前的参数
+        applyChanges(service, m_changes, true);    // 恢复修改前的参数
         m_filterController->onUndoOrRedo(service); // 通知控制器更新 UI
     }
 }
@@ -516,9 +634,50 @@ bool UndoParameterCommand::mergeWith(const QUndoCommand *other)
     if (that->id() != id() || that->m_row != m_row || that->m_producerUuid != m_producerUuid
         || that->text() != text())
         return false;
-    // 合并：用新命令的“修改后”状态覆盖当前命令的“修改后”状态
-    m_after = that->m_after;
+    // 合并：保留当前命令中最早的修改前的值，用新命令的值作为修改后的值
+    for (const auto &change : that->m_changes) {
+        auto it = std::find_if(m_changes.begin(), m_changes.end(), [&](const PropertyChange &c) {
+            return c.name == change.name;
+        });
+        if (it != m_changes.end())
+            it->after = change.after;
+        else
+            m_changes << change;
+    }
     return true;
 }
 
+AnalyzeResultsCommand::AnalyzeResultsCommand(const QList<Mlt::Filter> &filters,
+                                             const QStringList &results,
+                                             QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_filters(filters)
+    , m_after(results)
+{
+    setText(QObject::tr("analyze %n filter(s)", nullptr, m_filters.size()));
+    for (auto &filter : m_filters)
+        m_before << QString::fromUtf8(filter.get("results"));
+}
+
+void AnalyzeResultsCommand::redo()
+{
+    LOG_DEBUG() << text() << m_filters.size();
+    for (int i = 0; i < m_filters.size(); ++i)
+        AnalyzeDelegate::updateFilter(m_filters[i], m_after[i]);
+    emit MAIN.filterController()->attachedModel()->changed();
+}
+
+void AnalyzeResultsCommand::undo()
+{
+    LOG_DEBUG() << text() << m_filters.size();
+    for (int i = 0; i < m_filters.size(); ++i) {
+        if (m_before[i].isEmpty())
+            m_filters[i].clear("results");
+        else
+            m_filters[i].set("results", m_before[i].toUtf8().constData());
+        m_filters[i].set("reload", 1);
+    }
+    emit MAIN.filterController()->attachedModel()->changed();
+}
+
 } // namespace Filter
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2024 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,11 +20,15 @@
 
 #include "models/attachedfiltersmodel.h"
 
+#include <MltFilter.h>
+#include <MltLink.h>
 #include <MltProducer.h>
 #include <MltService.h>
 #include <QString>
+#include <QStringList>
 #include <QUndoCommand>
 #include <QUuid>
+#include <QVector>
 
 // 前向声明，避免包含完整的头文件
 class QmlMetadata;
@@ -46,8 +50,22 @@ enum {
     UndoIdChangeAddKeyframe,    ///< 添加关键帧命令的 ID
     UndoIdChangeRemoveKeyframe, ///< 删除关键帧命令的 ID
     UndoIdChangeKeyframe,       ///< 修改关键帧命令的 ID (似乎未使用)
+    UndoIdChangeSetKeyframes,   ///< 批量设置关键帧命令的 ID
 };
 
+/**
+ * @brief 一个属性的修改：名称以及修改前和修改后的值。
+ *
+ * 空（null）的值表示该属性不存在。命令只保存这些差异，而不是参数的完整副本。
+ */
+struct PropertyChange
+{
+    QByteArray name;   ///< 属性名称
+    QByteArray before; ///< 修改前的值
+    QByteArray after;  ///< 修改后的值
+};
+typedef QVector<PropertyChange> PropertyChanges;
+
 /**
  * @class AddCommand
  * @brief 封装“添加滤镜”操作的撤销/重做命令。
@@ -222,9 +240,12 @@ public:
 
 private:
     AttachedFiltersModel &m_model; ///< 对滤镜模型的引用。
-    QString m_xml;                 ///< 要粘贴的滤镜的 XML。
-    QString m_beforeXml;           ///< 粘贴前所有滤镜的 XML，用于 undo。
+    QString m_xml;                 ///< 要粘贴的滤镜的 XML，只在第一次 redo 时解析。
     QUuid m_producerUuid;          ///< 目标 Producer 的 UUID。
+    bool m_isPasted;               ///< 是否已经粘贴过（即已记录下面的差异）。
+    QVector<QPair<int, Mlt::Filter>> m_filters; ///< 粘贴添加的滤镜及其位置。
+    QVector<QPair<int, Mlt::Link>> m_links;     ///< 粘贴添加的链接及其位置。
+    QVector<QPair<Mlt::Filter, PropertyChanges>> m_changes; ///< 粘贴对已有滤镜的修改。
 };
 
 /**
@@ -254,8 +275,9 @@ public:
      * @brief 更新命令中的“修改后”状态。
      * 用于在连续调整参数时合并命令，而不是为每次微调都创建新命令。
      * @param propertyName 被更新的参数名称。
+     * @param before 修改前的参数状态，用于该参数第一次被修改时。
      */
-    void update(const QString &propertyName);
+    void update(const QString &propertyName, Mlt::Properties &before);
 
     void redo(); ///< 执行参数修改。
     void undo(); ///< 撤销参数修改。
@@ -267,8 +289,7 @@ protected:
 private:
     int m_row;                            ///< 滤镜所在的行号。
     QUuid m_producerUuid;                 ///< 目标 Producer 的 UUID。
-    Mlt::Properties m_before;             ///< 修改前的参数状态。
-    Mlt::Properties m_after;              ///< 修改后的参数状态。
+    PropertyChanges m_changes;            ///< 被修改的参数及其前后的值。
     FilterController *m_filterController; ///< 滤镜控制器指针。
     bool m_firstRedo;                     ///< 标记是否是第一次调用 redo()。
 };
@@ -361,6 +382,55 @@ private:
     int m_keyframeIndex; ///< 被修改的关键帧的索引。
 };
 
+/**
+ * @class UndoSetKeyframesCommand
+ * @brief 封装“批量设置关键帧”操作的撤销/重做命令。
+ *
+ * 例如应用运动跟踪结果时，一次写入的所有关键帧作为一个撤销步骤。
+ */
+class UndoSetKeyframesCommand : public UndoParameterCommand
+{
+public:
+    UndoSetKeyframesCommand(const QString &name,
+                            FilterController *controller,
+                            int row,
+                            Mlt::Properties &before)
+        : UndoParameterCommand(name, controller, row, before, QObject::tr("set keyframes"))
+    {}
+
+protected:
+    int id() const { return UndoIdChangeSetKeyframes; }         ///< 返回唯一的 ID。
+    bool mergeWith(const QUndoCommand *other) { return false; } ///< 禁止合并，每次批量设置都是独立的操作。
+};
+
+/**
+ * @class AnalyzeResultsCommand
+ * @brief 封装“写入分析结果”操作的撤销/重做命令。
+ *
+ * 一批分析任务全部完成后，所有滤镜的结果作为一个撤销步骤写入。
+ */
+class AnalyzeResultsCommand : public QUndoCommand
+{
+public:
+    /**
+     * @brief 构造函数。
+     * @param filters 要写入结果的滤镜。
+     * @param results 与 filters 一一对应的分析结果。
+     * @param parent 父命令。
+     */
+    AnalyzeResultsCommand(const QList<Mlt::Filter> &filters,
+                          const QStringList &results,
+                          QUndoCommand *parent = 0);
+
+    void redo(); ///< 写入分析结果。
+    void undo(); ///< 恢复之前的结果。
+
+private:
+    QList<Mlt::Filter> m_filters; ///< 要写入结果的滤镜。
+    QStringList m_before;         ///< 写入前的结果，用于 undo。
+    QStringList m_after;          ///< 分析得到的结果。
+};
+
 } // namespace Filter
 
 #endif // FILTERCOMMANDS_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -173,4 +173,32 @@ void ClearCommand::undo()
     m_model.doReplace(m_clearMarkers);
 }
 
+/**
+ * @class ReplaceCommand
+ * @brief 封装“批量替换标记”操作的撤销/重做命令。
+ */
+ReplaceCommand::ReplaceCommand(MarkersModel &model,
+                               const QList<Marker> &oldMarkers,
+                               const QList<Marker> &newMarkers)
+    : QUndoCommand(0)
+    , m_model(model)
+    , m_oldMarkers(oldMarkers)
+    , m_newMarkers(newMarkers)
+{
+    const int count = m_newMarkers.size() - m_oldMarkers.size();
+    setText(QObject::tr("Add %n markers", nullptr, count));
+}
+
+/// 执行“批量替换标记”操作
+void ReplaceCommand::redo()
+{
+    m_model.doReplace(m_newMarkers);
+}
+
+/// 撤销“批量替换标记”操作（即恢复旧的标记列表）
+void ReplaceCommand::undo()
+{
+    m_model.doReplace(m_oldMarkers);
+}
+
 } // namespace Markers
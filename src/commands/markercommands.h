@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2023 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -134,6 +134,32 @@ private:
     QList<Marker> m_clearMarkers; ///< 保存所有被清空的标记列表。
 };
 
+/**
+ * @class ReplaceCommand
+ * @brief 封装“批量替换标记”操作的撤销/重做命令，例如一次添加许多检测到的标记。
+ */
+class ReplaceCommand : public QUndoCommand
+{
+public:
+    /**
+     * @brief 构造函数。
+     * @param model 关联的标记模型。
+     * @param oldMarkers 替换前的全部标记，用于撤销时恢复。
+     * @param newMarkers 替换后的全部标记。
+     */
+    ReplaceCommand(MarkersModel &model,
+                   const QList<Marker> &oldMarkers,
+                   const QList<Marker> &newMarkers);
+
+    void redo(); ///< 执行替换操作，模型只发出一次重置通知。
+    void undo(); ///< 撤销替换操作（即恢复旧的标记列表）。
+
+private:
+    MarkersModel &m_model;      ///< 对标记模型的引用。
+    QList<Marker> m_oldMarkers; ///< 保存替换前的标记列表。
+    QList<Marker> m_newMarkers; ///< 保存替换后的标记列表。
+};
+
 } // namespace Markers
 
 #endif // MARKERCOMMANDS_H
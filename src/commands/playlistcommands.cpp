@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -96,6 +96,55 @@ void InsertCommand::undo()
     m_model.remove(m_row);
 }
 
+/**
+ * @class InsertProducersCommand
+ * @brief 封装“一次插入多个片段”操作的撤销/重做命令。
+ */
+InsertProducersCommand::InsertProducersCommand(PlaylistModel &model,
+                                               const QList<Mlt::Producer> &producers,
+                                               int row,
+                                               QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_model(model)
+    , m_producers(producers)
+    , m_row(row < 0 ? model.rowCount() : row)
+{
+    m_xmls.reserve(m_producers.size());
+    for (auto &producer : m_producers)
+        m_xmls << MLT.XML(&producer);
+    setText(QObject::tr("Add %n playlist items", nullptr, m_xmls.size()));
+}
+
+void InsertProducersCommand::redo()
+{
+    LOG_DEBUG() << "row" << m_row << "count" << m_xmls.size();
+    // 重做时从 XML 重新创建片段
+    if (m_producers.isEmpty()) {
+        for (const auto &xml : std::as_const(m_xmls))
+            m_producers << Mlt::Producer(MLT.profile(), "xml-string", xml.toUtf8().constData());
+    }
+    if (m_row == m_model.rowCount())
+        m_model.appendMany(m_producers);
+    else
+        m_model.insert(m_producers, m_row);
+    // 处理 UUID，逻辑同 AppendCommand
+    for (int i = 0; i < m_producers.size(); ++i) {
+        if (i >= m_uuids.size())
+            m_uuids << MLT.ensureHasUuid(m_producers[i]);
+        else
+            MLT.setUuid(m_producers[i], m_uuids[i]);
+    }
+    m_producers.clear();
+}
+
+void InsertProducersCommand::undo()
+{
+    LOG_DEBUG() << "row" << m_row << "count" << m_xmls.size();
+    // 从后往前移除插入的所有项
+    for (int i = m_xmls.size() - 1; i >= 0; --i)
+        m_model.remove(m_row + i);
+}
+
 /**
  * @class UpdateCommand
  * @brief 封装“更新播放列表项”操作的撤销/重做命令。
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -96,6 +96,39 @@ private:
     QUuid m_uuid;           ///< 保存片段的 UUID。
 };
 
+/**
+ * @class InsertProducersCommand
+ * @brief 封装“一次插入多个片段”操作的撤销/重做命令，例如添加多个文件。
+ *
+ * 第一次执行时直接使用已经打开的 Producer，不再从 XML 重新打开文件；
+ * 之后的重做才从保存的 XML 创建。
+ */
+class InsertProducersCommand : public QUndoCommand
+{
+public:
+    /**
+     * @brief 构造函数。
+     * @param model 关联的播放列表模型。
+     * @param producers 要插入的片段。
+     * @param row 插入的目标行号，-1 表示追加到末尾。
+     * @param parent 父命令。
+     */
+    InsertProducersCommand(PlaylistModel &model,
+                           const QList<Mlt::Producer> &producers,
+                           int row,
+                           QUndoCommand *parent = 0);
+
+    void redo(); ///< 执行插入操作，模型只发出一次插入行的通知。
+    void undo(); ///< 撤销插入操作。
+
+private:
+    PlaylistModel &m_model;            ///< 对播放列表模型的引用。
+    QList<Mlt::Producer> m_producers;  ///< 第一次执行时使用的片段，执行后清空。
+    QStringList m_xmls;                ///< 保存每个片段的 XML。
+    int m_row;                         ///< 实际插入的起始行号。
+    QList<QUuid> m_uuids;              ///< 保存每个片段的 UUID。
+};
+
 /**
  * @class UpdateCommand
  * @brief 封装“更新播放列表项”操作的撤销/重做命令。
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -135,7 +135,7 @@ void AppendCommand::redo()
 {
     LOG_DEBUG() << "trackIndex" << m_trackIndex;
     LongUiTask longTask(QObject::tr("Append to Timeline"));
-    m_undoHelper.recordBeforeState(); // 记录操作前的状态，用于撤销
+    m_undoHelper.recordBeforeState({m_trackIndex}); // 记录操作前的状态，用于撤销
     // 在后台线程中反序列化 XML，避免阻塞 UI
     Mlt::Producer *producer = longTask.runAsync<Mlt::Producer *>(QObject::tr("Preparing"), [=]() {
         return deserializeProducer(m_xml);
@@ -213,7 +213,8 @@ void InsertCommand::redo()
 {
     LOG_DEBUG() << "trackIndex" << m_trackIndex << "position" << m_position;
     int shift = 0; // 记录插入的总时长，用于移动标记
-    m_undoHelper.recordBeforeState();
+    // 波纹所有轨道时会改变其他轨道，所以记录所有轨道
+    m_undoHelper.recordBeforeState(m_rippleAllTracks ? QSet<int>() : QSet<int>{m_trackIndex});
     Mlt::Producer clip(MLT.profile(), "xml-string", m_xml.toUtf8().constData());
     if (!clip.is_valid()) {
         LOG_ERROR() << "Invalid producer";
@@ -293,7 +294,7 @@ OverwriteCommand::OverwriteCommand(MultitrackModel &model,
 void OverwriteCommand::redo()
 {
     LOG_DEBUG() << "trackIndex" << m_trackIndex << "position" << m_position;
-    m_undoHelper.recordBeforeState();
+    m_undoHelper.recordBeforeState({m_trackIndex});
     Mlt::Producer clip(MLT.profile(), "xml-string", m_xml.toUtf8().constData());
     if (m_uuids.empty()) {
         m_uuids = getProducerUuids(&clip);
@@ -349,7 +350,7 @@ LiftCommand::LiftCommand(MultitrackModel &model, int trackIndex, int clipIndex,
 void LiftCommand::redo()
 {
     LOG_DEBUG() << "trackIndex" << m_trackIndex << "clipIndex" << m_clipIndex;
-    m_undoHelper.recordBeforeState();
+    m_undoHelper.recordBeforeState({m_trackIndex});
     m_model.liftClip(m_trackIndex, m_clipIndex); // 调用模型移除片段
     m_undoHelper.recordAfterState();
 }
@@ -430,7 +431,20 @@ void RemoveCommand::redo()
         }
     }
 
-    m_undoHelper.recordBeforeState();
+    QSet<int> tracks{m_trackIndex};
+    QList<MultitrackModel::RippleOffset> offsets;
+    if (m_rippleAllTracks) {
+        // 其他轨道在被移除的范围内只有空白时，只记录空白的偏移
+        auto clipInfo = m_model.getClipInfo(m_trackIndex, m_clipIndex);
+        if (clipInfo)
+            offsets = m_model.rippleOffsets(m_model.unlockedTracks(m_trackIndex),
+                                            clipInfo->start,
+                                            -clipInfo->frame_count,
+                                            &tracks);
+        else
+            tracks.clear();
+    }
+    m_undoHelper.recordBeforeState(tracks, offsets);
     m_model.removeClip(m_trackIndex, m_clipIndex, m_rippleAllTracks); // 调用模型移除片段
     m_undoHelper.recordAfterState();
 }
@@ -680,7 +694,8 @@ void TrimClipInCommand::redo()
         } else {
             m_undoHelper->setHints(UndoHelper::RestoreTracks);
         }
-        m_undoHelper->recordBeforeState();
+        m_undoHelper->recordBeforeState(m_ripple && m_rippleAllTracks ? QSet<int>()
+                                                                      : QSet<int>{m_trackIndex});
         m_model.trimClipIn(m_trackIndex, m_clipIndex, m_delta, m_ripple, m_rippleAllTracks);
         m_undoHelper->recordAfterState();
     } else {
@@ -741,7 +756,8 @@ void TrimClipOutCommand::redo()
         m_undoHelper.reset(new UndoHelper(m_model));
         if (!m_ripple)
             m_undoHelper->setHints(UndoHelper::SkipXML); // 非波纹时可以跳过 XML 保存
-        m_undoHelper->recordBeforeState();
+        m_undoHelper->recordBeforeState(m_ripple && m_rippleAllTracks ? QSet<int>()
+                                                                      : QSet<int>{m_trackIndex});
         // 调用模型执行修剪，并更新可能变化的片段索引
         m_clipIndex
             = m_model.trimClipOut(m_trackIndex, m_clipIndex, m_delta, m_ripple, m_rippleAllTracks);
@@ -794,7 +810,7 @@ void SplitCommand::redo()
     LOG_DEBUG() << "trackIndex" << m_trackIndex[0] << "clipIndex" << m_clipIndex[0] << "position"
                 << m_position;
     MAIN.filterController()->pauseUndoTracking();
-    m_undoHelper.recordBeforeState();
+    m_undoHelper.recordBeforeState(QSet<int>(m_trackIndex.begin(), m_trackIndex.end()));
     // 遍历所有待分割的片段并执行分割
     for (int i = 0; i < m_trackIndex.size(); i++) {
         m_model.splitClip(m_trackIndex[i], m_clipIndex[i], m_position);
@@ -897,7 +913,8 @@ void AddTransitionCommand::redo()
         }
     }
 
-    m_undoHelper.recordBeforeState();
+    m_undoHelper.recordBeforeState(m_ripple && m_rippleAllTracks ? QSet<int>()
+                                                                 : QSet<int>{m_trackIndex});
     // 调用模型添加转场，并获取转场的索引
     m_transitionIndex
         = m_model.addTransition(m_trackIndex, m_clipIndex, m_position, m_ripple, m_rippleAllTracks);
@@ -1421,6 +1438,109 @@ void RemoveTrackCommand::undo()
     }
 }
 
+// 取得轨道的播放列表；索引无效时返回无效的播放列表。
+static Mlt::Playlist trackPlaylist(MultitrackModel &model, int trackIndex)
+{
+    if (!model.tractor() || trackIndex < 0 || trackIndex >= model.trackList().size())
+        return Mlt::Playlist();
+    QScopedPointer<Mlt::Producer> producer(
+        model.tractor()->track(model.trackList().at(trackIndex).mlt_index));
+    if (!producer || !producer->is_valid())
+        return Mlt::Playlist();
+    return Mlt::Playlist(*producer);
+}
+
+// 用保存的播放列表 XML 替换轨道的内容。
+static void replaceTrack(MultitrackModel &model, int trackIndex, const QString &xml)
+{
+    Mlt::Producer producer(MLT.profile(), "xml-string", xml.toUtf8().constData());
+    if (!producer.is_valid() || producer.type() != mlt_service_playlist_type) {
+        LOG_ERROR() << "failed to load the track" << trackIndex;
+        return;
+    }
+    Mlt::Playlist playlist(producer);
+    model.replaceTrack(trackIndex, playlist);
+}
+
+RenderTrackCommand::RenderTrackCommand(MultitrackModel &model,
+                                       int trackIndex,
+                                       Mlt::Producer &clip,
+                                       int position,
+                                       QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_model(model)
+    , m_trackIndex(trackIndex)
+    , m_clipXml(MLT.XML(&clip))
+    , m_position(position)
+{
+    setText(QObject::tr("Render track in place"));
+    auto playlist = trackPlaylist(m_model, m_trackIndex);
+    if (playlist.is_valid())
+        m_xml = MLT.XML(&playlist);
+}
+
+void RenderTrackCommand::redo()
+{
+    LOG_DEBUG() << "trackIndex" << m_trackIndex << "position" << m_position;
+    Mlt::Producer clip(MLT.profile(), "xml-string", m_clipXml.toUtf8().constData());
+    auto track = trackPlaylist(m_model, m_trackIndex);
+    if (!clip.is_valid() || !track.is_valid() || m_xml.isEmpty())
+        return;
+    // 渲染的片段从轨道上第一个片段的位置开始，前面用空白补齐。
+    Mlt::Playlist playlist(MLT.profile());
+    if (m_position > 0)
+        playlist.blank(m_position - 1);
+    playlist.append(clip, clip.get_in(), clip.get_out());
+    m_model.replaceTrack(m_trackIndex, playlist);
+    // 原来的轨道随项目一起保存，但不会被播放。
+    track.set(kTrackRenderedProperty, m_xml.toUtf8().constData());
+}
+
+void RenderTrackCommand::undo()
+{
+    LOG_DEBUG() << "trackIndex" << m_trackIndex;
+    auto track = trackPlaylist(m_model, m_trackIndex);
+    if (!track.is_valid() || m_xml.isEmpty())
+        return;
+    replaceTrack(m_model, m_trackIndex, m_xml);
+    track.Mlt::Properties::clear(kTrackRenderedProperty);
+}
+
+RestoreTrackCommand::RestoreTrackCommand(MultitrackModel &model,
+                                         int trackIndex,
+                                         QUndoCommand *parent)
+    : QUndoCommand(parent)
+    , m_model(model)
+    , m_trackIndex(trackIndex)
+{
+    setText(QObject::tr("Restore rendered track"));
+    auto playlist = trackPlaylist(m_model, m_trackIndex);
+    if (playlist.is_valid()) {
+        m_xml = QString::fromUtf8(playlist.get(kTrackRenderedProperty));
+        m_renderedXml = MLT.XML(&playlist);
+    }
+}
+
+void RestoreTrackCommand::redo()
+{
+    LOG_DEBUG() << "trackIndex" << m_trackIndex;
+    auto track = trackPlaylist(m_model, m_trackIndex);
+    if (!track.is_valid() || m_xml.isEmpty())
+        return;
+    replaceTrack(m_model, m_trackIndex, m_xml);
+    track.Mlt::Properties::clear(kTrackRenderedProperty);
+}
+
+void RestoreTrackCommand::undo()
+{
+    LOG_DEBUG() << "trackIndex" << m_trackIndex;
+    auto track = trackPlaylist(m_model, m_trackIndex);
+    if (!track.is_valid() || m_xml.isEmpty())
+        return;
+    replaceTrack(m_model, m_trackIndex, m_renderedXml);
+    track.set(kTrackRenderedProperty, m_xml.toUtf8().constData());
+}
+
 /**
  * @class MoveTrackCommand
  * @brief “移动轨道”命令
@@ -1757,6 +1877,7 @@ void AlignClipsCommand::redo()
         int start;           // 目标起始位置
     };
     QVector<ClipItem> clipMemory; // 用于临时存储所有待重新放置的片段
+    m_model.beginBatch();         // 所有片段放好之后才通知视图
 
     // 移除所有需要对齐的片段，并记住它们的信息。
     for (auto &alignment : m_alignments) {
@@ -1803,6 +1924,7 @@ void AlignClipsCommand::redo()
         m_model.overwrite(item.track, *item.clip, item.start, false, false);
         delete item.clip; // 释放内存
     }
+    m_model.endBatch();
 
     if (!m_redo) {
         m_redo = true;
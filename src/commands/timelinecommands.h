@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -899,6 +899,50 @@ private:
     QUuid m_uuid;                                    ///< 保存的轨道 UUID
 };
 
+/**
+ * @class RenderTrackCommand
+ * @brief “渲染轨道”命令
+ * 用一个渲染好的片段替换轨道上的所有片段和滤镜，
+ * 并把原来的轨道 XML 隐藏保存在轨道属性中，以便之后恢复。
+ */
+class RenderTrackCommand : public QUndoCommand
+{
+public:
+    RenderTrackCommand(MultitrackModel &model,
+                       int trackIndex,
+                       Mlt::Producer &clip,
+                       int position,
+                       QUndoCommand *parent = 0);
+    void redo() override;
+    void undo() override;
+
+private:
+    MultitrackModel &m_model;
+    int m_trackIndex;
+    QString m_xml;     ///< 原来轨道的 XML
+    QString m_clipXml; ///< 渲染好的片段的 XML
+    int m_position;    ///< 渲染好的片段在轨道上的位置
+};
+
+/**
+ * @class RestoreTrackCommand
+ * @brief “恢复渲染的轨道”命令
+ * 用轨道属性中保存的原来的片段和滤镜替换渲染好的片段。
+ */
+class RestoreTrackCommand : public QUndoCommand
+{
+public:
+    RestoreTrackCommand(MultitrackModel &model, int trackIndex, QUndoCommand *parent = 0);
+    void redo() override;
+    void undo() override;
+
+private:
+    MultitrackModel &m_model;
+    int m_trackIndex;
+    QString m_xml;         ///< 原来轨道的 XML
+    QString m_renderedXml; ///< 渲染后轨道的 XML
+};
+
 /**
  * @class MoveTrackCommand
  * @brief “移动轨道”命令
@@ -19,8 +19,10 @@
 #include "Logger.h"
 #include "mltcontroller.h"
 #include "models/audiolevelstask.h"
+#include "performancecounters.h"
 #include "shotcut_mlt_properties.h"
 
+#include <QCryptographicHash>
 #include <QScopedPointer>
 #include <QUuid>
 
@@ -39,25 +41,158 @@
  * 它通过记录操作前和操作后整个时间线（或受影响轨道）的状态，来计算差异并在撤销时精确恢复。
  */
 
+// 保留 XML 字符串的最近使用的实例数，通常对应撤销栈顶部的几个命令
+static const int kExpandedHelpers = 4;
+
+namespace {
+struct PackedXml
+{
+    QByteArray data; // qCompress 压缩后的 UTF-8 XML
+    int refs = 0;    // 引用它的片段信息数
+};
+} // namespace
+
+// 所有实例共享的压缩 XML，按内容的 SHA-1 索引；只在 GUI 线程使用
+static QHash<QByteArray, PackedXml> &xmlPool()
+{
+    static QHash<QByteArray, PackedXml> pool;
+    return pool;
+}
+
+// 按最近使用排序的实例，最前面的最新
+static QList<UndoHelper *> &recentHelpers()
+{
+    static QList<UndoHelper *> helpers;
+    return helpers;
+}
+
+static void releaseXml(const QByteArray &key)
+{
+    auto &pool = xmlPool();
+    auto it = pool.find(key);
+    if (it != pool.end() && --it->refs <= 0)
+        pool.erase(it);
+}
+
 UndoHelper::UndoHelper(MultitrackModel &model)
     : m_model(model)
     , m_hints(NoHints) // 默认无优化提示
 {}
 
+UndoHelper::~UndoHelper()
+{
+    recentHelpers().removeOne(this);
+    releasePackedXml();
+}
+
+void UndoHelper::makeRecent()
+{
+    expandXml();
+    auto &helpers = recentHelpers();
+    helpers.removeOne(this);
+    helpers.prepend(this);
+    while (helpers.size() > kExpandedHelpers)
+        helpers.takeLast()->compactXml();
+}
+
+void UndoHelper::compactXml()
+{
+    auto &pool = xmlPool();
+    for (auto &info : m_infos) {
+        if (info.xml.isEmpty())
+            continue;
+        const QByteArray utf8 = info.xml.toUtf8();
+        const QByteArray key = QCryptographicHash::hash(utf8, QCryptographicHash::Sha1);
+        auto &packed = pool[key];
+        if (!packed.refs++)
+            packed.data = qCompress(utf8);
+        info.packedKey = key;
+        info.xml.clear();
+    }
+}
+
+void UndoHelper::expandXml()
+{
+    // 相同的 XML 只解压一次，解压后的字符串在片段之间共享
+    QHash<QByteArray, QString> expanded;
+    for (auto &info : m_infos) {
+        if (info.packedKey.isEmpty())
+            continue;
+        auto it = expanded.constFind(info.packedKey);
+        if (it == expanded.constEnd()) {
+            const auto xml = QString::fromUtf8(qUncompress(xmlPool().value(info.packedKey).data));
+            it = expanded.insert(info.packedKey, xml);
+        }
+        info.xml = it.value();
+        releaseXml(info.packedKey);
+        info.packedKey.clear();
+    }
+}
+
+void UndoHelper::releasePackedXml()
+{
+    for (auto &info : m_infos) {
+        if (!info.packedKey.isEmpty()) {
+            releaseXml(info.packedKey);
+            info.packedKey.clear();
+        }
+    }
+}
+
 /**
  * @brief 记录操作前的状态。
  * 遍历所有轨道和片段，将每个片段的详细信息（XML、入出点、位置、组等）存储在内部映射中。
  */
 void UndoHelper::recordBeforeState()
 {
+    recordBeforeState(QSet<int>());
+}
+
+/**
+ * @brief 只记录指定轨道在操作前的状态。
+ * 一次修剪或移动通常只改变一两个轨道，不必遍历整个时间线。
+ */
+void UndoHelper::recordBeforeState(const QSet<int> &tracks)
+{
+    recordBeforeState(tracks, QList<MultitrackModel::RippleOffset>());
+}
+
+/**
+ * @brief 记录指定轨道的状态，其余被波纹的轨道只记录空白的偏移。
+ */
+void UndoHelper::recordBeforeState(const QSet<int> &tracks,
+                                   const QList<MultitrackModel::RippleOffset> &offsets)
+{
+    PerformanceCounters::ScopedTimer timer(PerformanceCounters::UndoRecordNs,
+                                           PerformanceCounters::UndoRecords);
+    Q_ASSERT(offsets.isEmpty() || !tracks.isEmpty());
+    m_tracks = tracks;
+    m_rippleOffsets = offsets;
 #ifdef UNDOHELPER_DEBUG
     debugPrintState("Before state");
 #endif
-    m_state.clear(); // 清空之前的状态
+    releasePackedXml(); // 旧状态的 XML 不再需要，不必解压
+    makeRecent();
+    m_infos.clear(); // 清空之前的状态
+    m_indexes.clear();
     m_clipsAdded.clear();
     m_insertedOrder.clear(); // 清空并重新记录片段的原始顺序
-    // 遍历所有轨道
-    for (int i = 0; i < m_model.trackList().count(); ++i) {
+    m_model.pruneClipXML();  // 释放已不在使用的片段的 XML 缓存
+#ifndef QT_NO_DEBUG
+    // 记录其他轨道的签名，以便在操作后检查它们没有被改变
+    m_otherTracks.clear();
+    if (!m_tracks.isEmpty()) {
+        QSet<int> offsetTracks;
+        for (const auto &offset : std::as_const(m_rippleOffsets))
+            offsetTracks << offset.trackIndex;
+        for (int i = 0; i < m_model.trackList().count(); ++i) {
+            if (!m_tracks.contains(i) && !offsetTracks.contains(i))
+                m_otherTracks[i] = trackSignature(i);
+        }
+    }
+#endif
+    // 遍历所有需要记录的轨道
+    for (int i : recordedTracks()) {
         int mltIndex = m_model.trackList()[i].mlt_index;
         QScopedPointer<Mlt::Producer> trackProducer(m_model.tractor()->track(mltIndex));
         Mlt::Playlist playlist(*trackProducer);
@@ -69,11 +204,19 @@ void UndoHelper::recordBeforeState()
             if (clip->is_blank()) {
                 uid = MLT.ensureHasUuid(*clip); // 空白片段也需要 UUID
             }
-            m_insertedOrder << uid;    // 记录顺序
-            Info &info = m_state[uid]; // 获取或创建该 UUID 对应的信息结构体
-            // 如果没有跳过 XML 的提示，则保存片段的完整 XML
+            // 获取或创建该 UUID 对应的信息结构体
+            auto it = m_indexes.constFind(uid);
+            if (it == m_indexes.constEnd()) {
+                it = m_indexes.insert(uid, m_infos.size());
+                m_infos.append(Info());
+                m_infos.last().uid = uid;
+            }
+            m_insertedOrder << it.value(); // 记录顺序
+            Info &info = m_infos[it.value()];
+            // 如果没有跳过 XML 的提示，则保存片段的完整 XML。
+            // 未改变的片段直接使用上次序列化的结果。
             if (!(m_hints & SkipXML))
-                info.xml = MLT.XML(&clip->parent());
+                info.xml = m_model.clipXML(clip->parent());
             Mlt::ClipInfo clipInfo;
             playlist.clip_info(j, &clipInfo);
             // 记录片段的基本信息
@@ -96,13 +239,24 @@ void UndoHelper::recordBeforeState()
  */
 void UndoHelper::recordAfterState()
 {
+    PerformanceCounters::ScopedTimer timer(PerformanceCounters::UndoRecordNs,
+                                           PerformanceCounters::UndoRecords);
 #ifdef UNDOHELPER_DEBUG
     debugPrintState("After state");
 #endif
-    QList<QUuid> clipsRemoved = m_state.keys(); // 假设所有原始片段都被移除了，然后逐一排除
+    makeRecent();
+    // 假设所有原始片段都被移除了，然后逐一排除
+    QVector<bool> isFound(m_infos.size(), false);
     m_clipsAdded.clear();
-    // 再次遍历所有轨道和片段
-    for (int i = 0; i < m_model.trackList().count(); ++i) {
+#ifndef QT_NO_DEBUG
+    for (auto it = m_otherTracks.constBegin(); it != m_otherTracks.constEnd(); ++it) {
+        Q_ASSERT((it.key() >= m_model.trackList().count()
+                  || trackSignature(it.key()) == it.value())
+                 && "a track outside the recorded tracks was changed");
+    }
+#endif
+    // 再次遍历所有需要记录的轨道和片段
+    for (int i : recordedTracks()) {
         int mltIndex = m_model.trackList()[i].mlt_index;
         QScopedPointer<Mlt::Producer> trackProducer(m_model.tractor()->track(mltIndex));
         Mlt::Playlist playlist(*trackProducer);
@@ -115,12 +269,14 @@ void UndoHelper::recordAfterState()
             }
 
             // 如果一个片段不在之前的状态中，说明它是新添加的
-            if (!m_state.contains(uid)) {
+            auto it = m_indexes.constFind(uid);
+            if (it == m_indexes.constEnd()) {
                 UNDOLOG << "New clip at" << i << j;
                 m_clipsAdded << uid;
                 m_affectedTracks << i; // 记录受影响的轨道
             } else {
-                Info &info = m_state[uid];
+                isFound[it.value()] = true; // 从“已移除”列表中排除
+                Info &info = m_infos[it.value()];
                 info.changes = 0;
                 info.newTrackIndex = i; // 记录新位置
                 info.newClipIndex = j;
@@ -137,8 +293,9 @@ void UndoHelper::recordAfterState()
 
                 // 如果没有跳过 XML，并且片段不是空白，则比较 XML 是否变化
                 if (!(m_hints & SkipXML) && !info.isBlank) {
-                    QString newXml = MLT.XML(&clip->parent());
-                    if (info.xml != newXml) {
+                    // 只有被改变的片段才会重新序列化；未改变的返回同一份数据。
+                    QString newXml = m_model.clipXML(clip->parent());
+                    if (newXml.constData() != info.xml.constData() && info.xml != newXml) {
                         UNDOLOG << "Modified xml:" << uid;
                         info.changes |= XMLModified;
                         m_affectedTracks << i;
@@ -157,14 +314,15 @@ void UndoHelper::recordAfterState()
                     m_affectedTracks << i;
                 }
             }
-            clipsRemoved.removeOne(uid); // 从“已移除”列表中排除
         }
     }
 
     // 剩下的就是真正被移除的片段
-    foreach (QUuid uid, clipsRemoved) {
-        UNDOLOG << "Clip removed:" << uid;
-        auto &info = m_state[uid];
+    for (int i = 0; i < m_infos.size(); ++i) {
+        if (isFound[i])
+            continue;
+        auto &info = m_infos[i];
+        UNDOLOG << "Clip removed:" << info.uid;
         info.changes = Removed;
         m_affectedTracks << info.oldTrackIndex;
     }
@@ -176,13 +334,18 @@ void UndoHelper::recordAfterState()
  */
 void UndoHelper::undoChanges()
 {
+    makeRecent();
 #ifdef UNDOHELPER_DEBUG
     debugPrintState("Before undo");
 #endif
+    // 在恢复所有片段之后才合并发出通知
+    m_model.beginBatch();
     // 如果提示需要恢复整个轨道，则使用更简单高效的方法
     if (m_hints & RestoreTracks) {
         restoreAffectedTracks();
-        emit m_model.modified();
+        undoRippleOffsets();
+        m_model.notifyModified();
+        m_model.endBatch();
 #ifdef UNDOHELPER_DEBUG
         debugPrintState("After undo");
 #endif
@@ -193,8 +356,9 @@ void UndoHelper::undoChanges()
     /* 按照原始片段顺序（m_insertedOrder）处理。
      * 在处理每个片段时，确保它后面的片段已恢复到原始状态，然后再处理下一个。
      */
-    foreach (QUuid uid, m_insertedOrder) {
-        const Info &info = m_state[uid];
+    for (int index : std::as_const(m_insertedOrder)) {
+        const Info &info = m_infos[index];
+        const QUuid &uid = info.uid;
         UNDOLOG << "Handling uid" << uid << "on track" << info.oldTrackIndex << "index"
                 << info.oldClipIndex;
 
@@ -314,15 +478,15 @@ void UndoHelper::undoChanges()
             roles << MultitrackModel::InPointRole;
             roles << MultitrackModel::OutPointRole;
             roles << MultitrackModel::DurationRole;
-            emit m_model.dataChanged(modelIndex, modelIndex, roles);
+            m_model.notifyDataChanged(modelIndex, modelIndex, roles);
             if (clip && clip->is_valid())
                 AudioLevelsTask::start(clip->parent(), &m_model, modelIndex);
         }
     }
 
     /* 最后，再次遍历轨道，移除所有新添加的片段，并清除临时使用的 UUID 属性。 */
-    int trackIndex = 0;
-    foreach (const Track &track, m_model.trackList()) {
+    for (int trackIndex : recordedTracks()) {
+        const Track &track = m_model.trackList().at(trackIndex);
         QScopedPointer<Mlt::Producer> trackProducer(m_model.tractor()->track(track.mlt_index));
         Mlt::Playlist playlist(*trackProducer);
         for (int i = playlist.count() - 1; i >= 0; --i) { // 从后往前删除，避免索引问题
@@ -331,7 +495,7 @@ void UndoHelper::undoChanges()
             if (clip->is_blank()) {
                 uid = MLT.uuid(*clip);
             }
-            if (m_clipsAdded.removeOne(uid)) { // 如果是新添加的片段
+            if (m_clipsAdded.remove(uid)) { // 如果是新添加的片段
                 UNDOLOG << "Removing clip at" << i;
                 m_model.beginRemoveRows(m_model.index(trackIndex), i, i);
                 // 清除混合信息
@@ -345,15 +509,27 @@ void UndoHelper::undoChanges()
                 m_model.endRemoveRows();
             }
         }
-        trackIndex++;
     }
 
-    emit m_model.modified();
+    undoRippleOffsets();
+    m_model.notifyModified();
+    m_model.endBatch();
 #ifdef UNDOHELPER_DEBUG
     debugPrintState("After undo");
 #endif
 }
 
+/**
+ * @brief 撤销空白偏移：删除的空白插回去，插入的空白删掉。
+ */
+void UndoHelper::undoRippleOffsets()
+{
+    QList<MultitrackModel::RippleOffset> inverse;
+    for (auto it = m_rippleOffsets.crbegin(); it != m_rippleOffsets.crend(); ++it)
+        inverse << MultitrackModel::RippleOffset{it->trackIndex, it->position, -it->length};
+    m_model.applyRippleOffsets(inverse);
+}
+
 /**
  * @brief 设置优化提示。
  * 这些提示可以改变 UndoHelper 的行为，例如跳过 XML 记录以提高性能。
@@ -394,6 +570,42 @@ void UndoHelper::debugPrintState(const QString &title)
     LOG_DEBUG() << "}";
 }
 
+/**
+ * @brief 返回需要记录的轨道索引列表。
+ */
+QList<int> UndoHelper::recordedTracks() const
+{
+    QList<int> result;
+    for (int i = 0; i < m_model.trackList().count(); ++i) {
+        if (m_tracks.isEmpty() || m_tracks.contains(i))
+            result << i;
+    }
+    return result;
+}
+
+/**
+ * @brief 调试函数：返回轨道上所有片段的 UUID 和入出点。
+ */
+QString UndoHelper::trackSignature(int trackIndex) const
+{
+    QString result;
+    int mltIndex = m_model.trackList()[trackIndex].mlt_index;
+    QScopedPointer<Mlt::Producer> trackProducer(m_model.tractor()->track(mltIndex));
+    Mlt::Playlist playlist(*trackProducer);
+    for (int j = 0; j < playlist.count(); ++j) {
+        Mlt::ClipInfo info;
+        playlist.clip_info(j, &info);
+        QUuid uid = MLT.uuid(*info.producer);
+        if (info.producer->is_blank() && info.cut)
+            uid = MLT.uuid(*info.cut);
+        result += QStringLiteral("%1 %2 %3;")
+                      .arg(uid.toString())
+                      .arg(info.frame_in)
+                      .arg(info.frame_out);
+    }
+    return result;
+}
+
 /**
  * @brief 恢复受影响的轨道。
  * 一种更简单但更彻底的撤销方法：清空受影响轨道的所有内容，然后根据记录的状态重新填充。
@@ -416,8 +628,8 @@ void UndoHelper::restoreAffectedTracks()
     }
 
     // 第二步：按照原始顺序，将所有属于这些轨道的片段重新添加回去
-    for (const auto &uid : std::as_const(m_insertedOrder)) {
-        const Info &info = m_state[uid];
+    for (int index : std::as_const(m_insertedOrder)) {
+        const Info &info = m_infos[index];
         if (m_affectedTracks.contains(info.oldTrackIndex)) {
             // ... (与 undoChanges 中类似的插入逻辑)
         }
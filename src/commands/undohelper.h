@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,10 +21,13 @@
 #include "models/multitrackmodel.h"
 
 #include <MltPlaylist.h>
+#include <QHash>
 #include <QList>
 #include <QMap>
 #include <QSet>
 #include <QString>
+#include <QUuid>
+#include <QVector>
 
 /**
  * @class UndoHelper
@@ -32,6 +35,8 @@
  * 
  * 这个类通过捕获操作前后的时间线状态，来提供精确的撤销功能。
  * 它记录了每个片段的详细信息，包括其 XML 表示、位置、入出点、组信息等。
+ * 片段的 XML 由 MultitrackModel::clipXML() 缓存，只有被改变的片段才会重新序列化，
+ * 所以一次编辑的开销与受影响的片段数量成正比，而不是整个项目。
  * 
  * 使用流程：
  * 1. 创建 UndoHelper 实例。
@@ -39,6 +44,13 @@
  * 3. 执行时间线修改操作。
  * 4. 调用 `recordAfterState()` 记录操作后的状态。
  * 5. 当需要撤销时，调用 `undoChanges()` 恢复到操作前的状态。
+ *
+ * 如果操作只会改变少数轨道，可以把这些轨道传给 `recordBeforeState()`，
+ * 此时只记录和比较这些轨道。调试版本会断言其他轨道没有被改变。
+ *
+ * 只有最近使用的几个实例保留片段的 XML 字符串。更早的实例把 XML 压缩后
+ * 放入一个按内容哈希共享的池中，相同的 XML 在所有命令之间只存一份，
+ * 再次使用时才解压。
  */
 class UndoHelper
 {
@@ -58,6 +70,7 @@ public:
      * @param model 对多轨道模型的引用，UndoHelper 将通过此模型与时间线交互。
      */
     UndoHelper(MultitrackModel &model);
+    ~UndoHelper();
 
     /**
      * @brief 记录操作前的状态。
@@ -65,6 +78,24 @@ public:
      */
     void recordBeforeState();
 
+    /**
+     * @brief 只记录指定轨道在操作前的状态。
+     * 之后的 `recordAfterState()` 和 `undoChanges()` 也只处理这些轨道。
+     * 波纹所有轨道等会改变其他轨道的操作应使用不带参数的版本。
+     * @param tracks 操作可能改变的轨道索引集合；为空时记录所有轨道。
+     */
+    void recordBeforeState(const QSet<int> &tracks);
+
+    /**
+     * @brief 记录 \a tracks 的状态，并把 \a offsets 中的轨道只记为空白的偏移。
+     * 波纹所有轨道时，其他轨道在该处大多只有空白，撤销时把空白放回去即可，
+     * 不必保存和比较这些轨道上的每个片段。
+     * @param tracks 操作会改变片段的轨道，不能为空。
+     * @param offsets 由 MultitrackModel::rippleOffsets() 计算的空白偏移。
+     */
+    void recordBeforeState(const QSet<int> &tracks,
+                           const QList<MultitrackModel::RippleOffset> &offsets);
+
     /**
      * @brief 记录操作后的状态。
      * 遍历整个时间线，与 `recordBeforeState` 保存的状态进行比较，
@@ -97,12 +128,27 @@ private:
      */
     void debugPrintState(const QString &title);
 
+    /**
+     * @brief 返回需要记录的轨道索引列表，即 `m_tracks` 中有效的轨道，或者所有轨道。
+     */
+    QList<int> recordedTracks() const;
+
+    /**
+     * @brief 调试函数：返回轨道上所有片段的 UUID 和入出点，用于检查轨道是否被改变。
+     */
+    QString trackSignature(int trackIndex) const;
+
     /**
      * @brief 使用“恢复轨道”模式来撤销更改。
      * 当设置了 `RestoreTracks` 提示时，此函数会被 `undoChanges` 调用。
      */
     void restoreAffectedTracks();
 
+    /**
+     * @brief 按相反的顺序反向应用记录的空白偏移。
+     */
+    void undoRippleOffsets();
+
     /**
      * @brief 修复与新插入片段相邻的转场。
      * 当一个片段被重新插入时，它旁边的转场可能仍然引用着旧的片段。
@@ -113,6 +159,20 @@ private:
      */
     void fixTransitions(Mlt::Playlist playlist, int clipIndex, Mlt::Producer clip);
 
+    /**
+     * @brief 标记为最近使用：解压本实例的 XML，并压缩超出数量的较早实例。
+     */
+    void makeRecent();
+
+    /// 把片段的 XML 压缩到共享池中并释放字符串。
+    void compactXml();
+
+    /// 从共享池中恢复片段的 XML 字符串。
+    void expandXml();
+
+    /// 释放本实例在共享池中的引用。
+    void releasePackedXml();
+
     /**
      * @brief 变化标志枚举。
      * 用于位运算，以指示一个片段发生了哪些类型的变化。
@@ -130,12 +190,14 @@ private:
      */
     struct Info
     {
+        QUuid uid;         ///< 片段（或空白）的 UUID。
         int oldTrackIndex; ///< 操作前的轨道索引。
         int oldClipIndex;  ///< 操作前的片段索引。
         int newTrackIndex; ///< 操作后的轨道索引。
         int newClipIndex;  ///< 操作后的片段索引。
         bool isBlank;      ///< 是否为空白。
         QString xml;       ///< 片段的完整 XML 表示（如果未跳过）。
+        QByteArray packedKey; ///< 压缩后的 XML 在共享池中的键；为空时使用 xml。
         int frame_in;      ///< 片段的入点。
         int frame_out;     ///< 片段的出点。
         int in_delta;      ///< 入点的变化量（用于撤销时调整滤镜）。
@@ -159,12 +221,18 @@ private:
         {}
     };
 
-    QMap<QUuid, Info> m_state; ///< 核心数据结构：将片段的 UUID 映射到其信息。
-    QList<QUuid> m_clipsAdded; ///< 在操作中被新添加的片段的 UUID 列表。
-    QList<QUuid> m_insertedOrder; ///< 记录操作前片段的原始插入顺序，用于撤销时恢复顺序。
+    QVector<Info> m_infos; ///< 核心数据结构：所有片段的信息，按首次出现的顺序连续存放。
+    QHash<QUuid, int> m_indexes; ///< 将片段的 UUID 映射到它在 m_infos 中的下标。
+    QSet<QUuid> m_clipsAdded;    ///< 在操作中被新添加的片段的 UUID 集合。
+    QVector<int> m_insertedOrder; ///< 操作前片段的原始顺序（m_infos 的下标），用于撤销时恢复顺序。
     QSet<int> m_affectedTracks; ///< 记录所有受影响的轨道索引。
+    QSet<int> m_tracks; ///< 只记录这些轨道；为空时记录所有轨道。
+    QMap<int, QString> m_otherTracks; ///< 调试版本中未记录的轨道的签名。
+    QList<MultitrackModel::RippleOffset> m_rippleOffsets; ///< 只记为空白偏移的轨道。
     MultitrackModel &m_model;   ///< 对多轨道模型的引用。
     OptimizationHints m_hints;  ///< 当前设置的优化提示。
+
+    Q_DISABLE_COPY(UndoHelper)
 };
 
 #endif // UNDOHELPER_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 #include "filtercontroller.h"
 
 #include "Logger.h"
+#include "filterchainoptimizer.h"
 #include "mltcontroller.h"
 #include "qmltypes/qmlapplication.h"
 #include "qmltypes/qmlfilter.h"
@@ -25,6 +26,7 @@
 #include "qmltypes/qmlutilities.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "startupprofile.h"
 
 #include <QFileDialog>
 #include <QFileInfo>
@@ -33,21 +35,26 @@
 
 #include "mainwindow.h"
 #include <MltLink.h>
+#include <QApplication>
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
+#include <QMessageBox>
 #include <QQmlComponent>
 #include <QQmlEngine>
+#include <QSaveFile>
+#include <QStatusBar>
+#include <QThreadPool>
 #include <QTimerEvent>
-<<<<<<< HEAD extern MainWindow *MAIN; == == == =
-#include <QFileDialog>
-#include <QStandardPaths>
+#include <QtConcurrent/QtConcurrentRun>
 
-#include <QApplication>
-#include <QFileInfo>
-#include <QImage>
-#include <QMessageBox>
-#include <QStatusBar>
+static const char *kFilterMetadataCacheFileName = "filtermetadata.cache";
+// 元数据序列化格式变化时需要递增
+static const qint32 kFilterMetadataCacheVersion = 3;
+// 合并快速连续的片段选择的间隔
+static const int kSelectionIntervalMs = 100;
 
-    /**
+/**
  * @class FilterController
  * @brief 滤镜控制器
  * 
@@ -58,14 +65,33 @@
  * 4. 与撤销/重做系统集成，暂停和恢复滤镜的撤销跟踪。
  * 5. 处理滤镜的添加、移除和更新。
  */
->>>>>>> master
 
-    FilterController::FilterController(QObject *parent)
+FilterController::FilterController(QObject *parent)
     : QObject(parent)
     , m_metadataModel(this) // 元数据模型，存储所有可用滤镜的信息
     , m_attachedModel(this) // 附加滤镜模型，存储当前 Producer 上的滤镜列表
     , m_currentFilterIndex(QmlFilter::NoCurrentFilter) // 初始化时没有选中的滤镜
+    , m_isProducerPending(false)
 {
+    m_selectionTimer.setInterval(kSelectionIntervalMs);
+    m_selectionTimer.setSingleShot(true);
+    connect(&m_selectionTimer, &QTimer::timeout, this, &FilterController::onSelectionTimeout);
+    // 在后台读取元数据缓存，与启动过程的其余部分并行
+    QDir dir = QmlUtilities::qmlDir();
+    dir.cd("filters");
+    const auto language = Settings.language();
+    const auto appDataLocation = Settings.appDataLocation();
+    QThread *mainThread = thread();
+    m_cachedMetadata = QtConcurrent::run([=]() {
+        StartupProfile::Phase phase("filter metadata cache");
+        const auto key = filterMetadataCacheKey(dir, language);
+        MetadataList metadata;
+        readFilterMetadataCache(key, appDataLocation, metadata);
+        // 在工作线程创建的对象必须由该线程移交给主线程
+        for (const auto &item : metadata)
+            item.second->moveToThread(mainThread);
+        return qMakePair(key, metadata);
+    });
     startTimer(0); // 启动一个 0 毫秒的定时器，以便在事件循环启动后立即加载数据
     // 连接附加滤镜模型的信号，以便在其变化时做出响应
     connect(&m_attachedModel, SIGNAL(changed()), this, SLOT(handleAttachedModelChange()));
@@ -85,6 +111,10 @@
             SIGNAL(rowsInserted(const QModelIndex &, int, int)),
             this,
             SLOT(handleAttachedRowsInserted(const QModelIndex &, int, int)));
+    connect(&m_attachedModel,
+            &AttachedFiltersModel::producerReplaced,
+            this,
+            &FilterController::handleAttachedProducerReplaced);
     connect(&m_attachedModel,
             SIGNAL(duplicateAddFailed(int)),
             this,
@@ -92,11 +122,105 @@
 }
 
 /**
- * @brief 从 QML 文件加载所有滤镜的元数据。
+ * @brief 计算滤镜元数据缓存的键。
+ * 键由 Shotcut 版本、MLT 版本、界面语言（qsTr 在创建时翻译）以及每个
+ * meta*.qml 文件的修改时间组成，任何一项变化都会使缓存失效。
+ */
+static QByteArray filterMetadataCacheKey(const QDir &dir, const QString &language)
+{
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(qApp->applicationVersion().toUtf8());
+    hash.addData(mlt_version_get_string());
+    hash.addData(language.toUtf8());
+    foreach (QString dirName,
+             dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Executable)) {
+        QDir subdir = dir;
+        subdir.cd(dirName);
+        const auto files = subdir.entryInfoList(QStringList("meta*.qml"),
+                                                QDir::Files | QDir::NoDotAndDotDot
+                                                    | QDir::Readable);
+        for (const auto &info : files) {
+            hash.addData(QStringLiteral("%1/%2:%3")
+                             .arg(dirName, info.fileName())
+                             .arg(info.lastModified().toMSecsSinceEpoch())
+                             .toUtf8());
+        }
+    }
+    return hash.result().toHex();
+}
+
+/**
+ * @brief 从缓存读取未经检查的元数据，缓存缺失、过期或损坏时返回 false。
+ * 可以在工作线程中调用，不访问设置。
+ */
+static bool readFilterMetadataCache(const QByteArray &key,
+                                    const QString &appDataLocation,
+                                    QList<QPair<QString, QmlMetadata *>> &metadata)
+{
+    QFile file(QDir(appDataLocation).filePath(kFilterMetadataCacheFileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_4);
+    qint32 version = 0;
+    QByteArray cacheKey;
+    qint32 count = 0;
+    stream >> version >> cacheKey >> count;
+    if (stream.status() != QDataStream::Ok || version != kFilterMetadataCacheVersion
+        || cacheKey != key)
+        return false;
+    for (int i = 0; i < count; ++i) {
+        QString dirName;
+        stream >> dirName;
+        auto meta = new QmlMetadata;
+        if (stream.status() != QDataStream::Ok || !meta->load(stream)) {
+            LOG_WARNING() << "the filter metadata cache is corrupt";
+            delete meta;
+            for (const auto &item : metadata)
+                delete item.second;
+            metadata.clear();
+            return false;
+        }
+        metadata << qMakePair(dirName, meta);
+    }
+    LOG_DEBUG() << "read" << count << "filters from the metadata cache";
+    return true;
+}
+
+/**
+ * @brief 在后台线程写入缓存，保存的是 QML 创建后、检查和加载设置之前的元数据。
+ */
+static void writeFilterMetadataCache(const QByteArray &key,
+                                     const QList<QPair<QString, QmlMetadata *>> &metadata)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_4);
+    stream << kFilterMetadataCacheVersion << key << qint32(metadata.size());
+    for (const auto &item : metadata) {
+        stream << item.first;
+        item.second->save(stream);
+    }
+    const auto fileName = QDir(Settings.appDataLocation()).filePath(kFilterMetadataCacheFileName);
+    QThreadPool::globalInstance()->start([=]() {
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(data);
+            if (file.commit())
+                return;
+        }
+        LOG_WARNING() << "failed to write" << fileName;
+    });
+}
+
+/**
+ * @brief 加载所有滤镜的元数据。
  * 这个函数在构造函数中通过定时器调用，以确保在 QML 引擎完全准备好后执行。
+ * 元数据优先从缓存读取；缓存过期时才编译 meta*.qml 文件并重建缓存。
  */
 void FilterController::loadFilterMetadata()
 {
+    StartupProfile::Phase phase("filter metadata");
     // 获取 MLT 中所有可用的滤镜、链接和制作者服务
     QScopedPointer<Mlt::Properties> mltFilters(MLT.repository()->filters());
     QScopedPointer<Mlt::Properties> mltLinks(MLT.repository()->links());
@@ -104,64 +228,83 @@ void FilterController::loadFilterMetadata()
     // 定位到存放滤镜元数据 QML 文件的目录
     QDir dir = QmlUtilities::qmlDir();
     dir.cd("filters");
-    // 遍历每个滤镜的子目录
-    foreach (QString dirName,
-             dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Executable)) {
+    const auto cached = m_cachedMetadata.result();
+    const auto &cacheKey = cached.first;
+    MetadataList metadata = cached.second;
+    if (metadata.isEmpty()) {
+        // 遍历每个滤镜的子目录
+        foreach (QString dirName,
+                 dir.entryList(QDir::AllDirs | QDir::NoDotAndDotDot | QDir::Executable)) {
+            QDir subdir = dir;
+            subdir.cd(dirName);
+            subdir.setFilter(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable);
+            subdir.setNameFilters(QStringList("meta*.qml")); // 查找名为 meta*.qml 的元数据文件
+            foreach (QString fileName, subdir.entryList()) {
+                LOG_DEBUG() << "reading filter metadata" << dirName << fileName;
+                // 使用 QML 引擎创建元数据对象
+                QQmlComponent component(QmlUtilities::sharedEngine(),
+                                        subdir.absoluteFilePath(fileName));
+                QmlMetadata *meta = qobject_cast<QmlMetadata *>(component.create());
+                if (meta)
+                    metadata << qMakePair(dirName, meta);
+                else
+                    LOG_WARNING() << component.errorString(); // 打印 QML 创建错误
+            }
+        }
+        writeFilterMetadataCache(cacheKey, metadata);
+    }
+
+    for (const auto &item : metadata) {
         QDir subdir = dir;
-        subdir.cd(dirName);
-        subdir.setFilter(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable);
-        subdir.setNameFilters(QStringList("meta*.qml")); // 查找名为 meta*.qml 的元数据文件
-        foreach (QString fileName, subdir.entryList()) {
-            LOG_DEBUG() << "reading filter metadata" << dirName << fileName;
-            // 使用 QML 引擎创建元数据对象
-            QQmlComponent component(QmlUtilities::sharedEngine(), subdir.absoluteFilePath(fileName));
-            QmlMetadata *meta = qobject_cast<QmlMetadata *>(component.create());
-            if (meta) {
-                // 检查 MLT 版本兼容性
-                QScopedPointer<Mlt::Properties> mltMetadata(
-                    MLT.repository()->metadata(mlt_service_filter_type,
-                                               meta->mlt_service().toLatin1().constData()));
-                QString version;
-                if (mltMetadata && mltMetadata->is_valid() && mltMetadata->get("version")) {
-                    version = QString::fromLatin1(mltMetadata->get("version"));
-                    if (version.startsWith("lavfi"))
-                        version.remove(0, 5);
-                }
-
-                // 检查 mlt_service 是否在 MLT 中可用，以及特殊依赖（如 glaxnimate）是否存在
-                if (mltFilters->get_data(meta->mlt_service().toLatin1().constData())
-                    && ("maskGlaxnimate" != meta->objectName()
-                        || mltProducers->get_data("glaxnimate"))
-                    && (version.isEmpty() || meta->isMltVersion(version))) {
-                    LOG_DEBUG() << "added filter" << meta->name();
-                    meta->loadSettings(); // 加载滤镜的默认设置
-                    meta->setPath(subdir);
-                    meta->setParent(0);
-                    addMetadata(meta); // 将元数据添加到模型中
-
-                    // 检查关键帧动画是否需要特定版本
-                    if (!version.isEmpty() && meta->keyframes()) {
-                        meta->setProperty("version", version);
-                        meta->keyframes()->checkVersion(version);
-                    }
-                } else if (meta->type() == QmlMetadata::Link
-                           && mltLinks->get_data(meta->mlt_service().toLatin1().constData())) {
-                    // 处理链接类型
-                    LOG_DEBUG() << "added link" << meta->name();
-                    meta->loadSettings();
-                    meta->setPath(subdir);
-                    meta->setParent(0);
-                    addMetadata(meta);
-                }
-
-                // 如果滤镜已弃用，在其名称后添加标记
-                if (meta->isDeprecated())
-                    meta->setName(meta->name() + " " + tr("(DEPRECATED)"));
-            } else if (!meta) {
-                LOG_WARNING() << component.errorString(); // 打印 QML 创建错误
+        subdir.cd(item.first);
+        QmlMetadata *meta = item.second;
+        bool isAdded = false;
+        // 检查 MLT 版本兼容性
+        QScopedPointer<Mlt::Properties> mltMetadata(
+            MLT.repository()->metadata(mlt_service_filter_type,
+                                       meta->mlt_service().toLatin1().constData()));
+        QString version;
+        if (mltMetadata && mltMetadata->is_valid() && mltMetadata->get("version")) {
+            version = QString::fromLatin1(mltMetadata->get("version"));
+            if (version.startsWith("lavfi"))
+                version.remove(0, 5);
+        }
+
+        // 检查 mlt_service 是否在 MLT 中可用，以及特殊依赖（如 glaxnimate）是否存在
+        if (mltFilters->get_data(meta->mlt_service().toLatin1().constData())
+            && ("maskGlaxnimate" != meta->objectName() || mltProducers->get_data("glaxnimate"))
+            && (version.isEmpty() || meta->isMltVersion(version))) {
+            LOG_DEBUG() << "added filter" << meta->name();
+            meta->loadSettings(); // 加载滤镜的默认设置
+            meta->setPath(subdir);
+            meta->setParent(0);
+            addMetadata(meta); // 将元数据添加到模型中
+            isAdded = true;
+
+            // 检查关键帧动画是否需要特定版本
+            if (!version.isEmpty() && meta->keyframes()) {
+                meta->setProperty("version", version);
+                meta->keyframes()->checkVersion(version);
             }
+        } else if (meta->type() == QmlMetadata::Link
+                   && mltLinks->get_data(meta->mlt_service().toLatin1().constData())) {
+            // 处理链接类型
+            LOG_DEBUG() << "added link" << meta->name();
+            meta->loadSettings();
+            meta->setPath(subdir);
+            meta->setParent(0);
+            addMetadata(meta);
+            isAdded = true;
         }
-    };
+
+        if (!isAdded) {
+            delete meta; // 不可用的滤镜不再需要
+            continue;
+        }
+        // 如果滤镜已弃用，在其名称后添加标记
+        if (meta->isDeprecated())
+            meta->setName(meta->name() + " " + tr("(DEPRECATED)"));
+    }
 }
 
 /// ... (其他公共和私有方法的实现，如 metadata, metadataForService, isOutputTrackSelected 等)
@@ -176,6 +319,7 @@ void FilterController::onUndoOrRedo(Mlt::Service &service)
     // 如果撤销/重做影响了当前选中的滤镜，则刷新其 UI
     if (m_currentFilter && m_mltService.is_valid()
         && service.get_service() == m_mltService.get_service()) {
+        m_currentFilter->clearKeyframesCache(); // 撤销/重做直接修改了服务的属性
         emit undoOrRedo();
         // 使用异步调用确保 UI 能正确更新
         QMetaObject::invokeMethod(this,
@@ -203,6 +347,9 @@ void FilterController::timerEvent(QTimerEvent *event)
  */
 void FilterController::setProducer(Mlt::Producer *producer)
 {
+    // 直接设置的 Producer 优先于待处理的选择
+    m_isProducerPending = false;
+    m_pendingProducer.reset();
     m_attachedModel.setProducer(producer); // 通知附加滤镜模型更新其列表
     if (producer && producer->is_valid()) {
         // 根据 Producer 的类型更新元数据模型的可见性掩码
@@ -217,6 +364,27 @@ void FilterController::setProducer(Mlt::Producer *producer)
     }
 }
 
+void FilterController::setSelectedProducer(Mlt::Producer *producer)
+{
+    if (m_selectionTimer.isActive()) {
+        // 间隔内只保留最后一个选择，交给 onSelectionTimeout 处理
+        m_pendingProducer.reset(producer ? new Mlt::Producer(producer) : nullptr);
+        m_isProducerPending = true;
+        return;
+    }
+    setProducer(producer);
+    m_selectionTimer.start();
+}
+
+void FilterController::onSelectionTimeout()
+{
+    if (!m_isProducerPending)
+        return;
+    std::unique_ptr<Mlt::Producer> producer(m_pendingProducer.release());
+    setProducer(producer && producer->is_valid() ? producer.get() : nullptr);
+    m_selectionTimer.start();
+}
+
 /**
  * @brief 设置当前选中的滤镜。
  * @param attachedIndex 在附加滤镜模型中的索引。
@@ -282,6 +450,20 @@ void FilterController::handleAttachedModelAboutToReset()
     setCurrentFilter(QmlFilter::NoCurrentFilter); // 取消选择当前滤镜
 }
 
+/**
+ * @brief 处理附加滤镜模型换成了滤镜相同的另一个 Producer 的信号。
+ *
+ * 模型没有重置，因此保留当前选中的行，并为新 Producer 的滤镜重新创建 QmlFilter。
+ */
+void FilterController::handleAttachedProducerReplaced()
+{
+    if (m_currentFilterIndex <= QmlFilter::NoCurrentFilter)
+        return;
+    int index = m_currentFilterIndex;
+    m_currentFilterIndex = QmlFilter::DeselectCurrentFilter; // 强制更新
+    setCurrentFilter(index);
+}
+
 /**
  * @brief 处理滤镜行被移除后的信号。
  */
@@ -321,6 +503,10 @@ void FilterController::onQmlFilterChanged(const QString &name)
         // 如果是禁用状态改变，更新附加模型中对应项的复选框状态
         QModelIndex index = m_attachedModel.index(m_currentFilterIndex);
         emit m_attachedModel.dataChanged(index, index, QVector<int>() << Qt::CheckStateRole);
+    } else if (m_mltService.is_valid()) {
+        // 参数变为或不再是恒等值时，跳过或恢复渲染该滤镜
+        FilterChainOptimizer::optimize(m_mltService,
+                                       m_attachedModel.getMetadata(m_currentFilterIndex));
     }
     emit filterChanged(&m_mltService); // 通知其他部分滤镜已更改
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -27,6 +27,9 @@
 #include <QFuture>
 #include <QObject>
 #include <QScopedPointer>
+#include <QTimer>
+
+#include <memory>
 
 class QTimerEvent;
 
@@ -165,6 +168,15 @@ public slots:
      */
     void setProducer(Mlt::Producer *producer = 0);
 
+    /**
+     * @brief 设置选中的 Producer，与 setProducer 相同，但快速连续的选择会合并。
+     *
+     * 例如用方向键逐个选择时间线上的片段时，间隔内的选择只保留最后一个，
+     * 使附加滤镜模型和滤镜界面只更新一次。
+     * @param producer 指向 MLT Producer 的指针。
+     */
+    void setSelectedProducer(Mlt::Producer *producer);
+
     /**
      * @brief 设置当前选中的滤镜。
      * @param attachedIndex 在附加滤镜模型中的索引。
@@ -234,6 +246,16 @@ private slots:
      */
     void handleAttachedModelAboutToReset();
 
+    /**
+     * @brief 处理附加滤镜模型换成了滤镜相同的另一个 Producer 的信号。
+     */
+    void handleAttachedProducerReplaced();
+
+    /**
+     * @brief 选择间隔结束时应用最后一个待处理的 Producer。
+     */
+    void onSelectionTimeout();
+
     /**
      * @brief 向元数据模型添加一个新的元数据对象。
      * @param meta 要添加的 QmlMetadata 对象。
@@ -273,6 +295,9 @@ public slots:
     void exportCurrentFrame();
 
 private:
+    /// 子目录名与其中一个滤镜元数据的列表。
+    typedef QList<QPair<QString, QmlMetadata *>> MetadataList;
+
     /**
      * @brief 从文件加载滤镜组合。
      */
@@ -284,12 +309,17 @@ private:
     void loadFilterMetadata();
 
     QFuture<void> m_future; ///< 用于异步加载的 QFuture 对象（在代码中未使用）。
+    /// 在后台读取的缓存键和元数据缓存，缓存无效时列表为空。
+    QFuture<QPair<QByteArray, MetadataList>> m_cachedMetadata;
     QScopedPointer<QmlFilter> m_currentFilter; ///< 当前选中的滤镜对象，使用智能指针管理。
     Mlt::Service m_mltService;                 ///< 当前选中滤镜的 MLT 服务。
     MetadataModel m_metadataModel;             ///< 元数据模型实例。
     MotionTrackerModel m_motionTrackerModel; ///< 运动跟踪模型实例。
     AttachedFiltersModel m_attachedModel;    ///< 附加滤镜模型实例。
     int m_currentFilterIndex;                ///< 当前选中滤镜在附加模型中的索引。
+    QTimer m_selectionTimer;                 ///< 合并快速连续的选择的间隔定时器。
+    std::unique_ptr<Mlt::Producer> m_pendingProducer; ///< 间隔内最后选中的 Producer。
+    bool m_isProducerPending;                ///< 间隔内是否有待处理的选择。
     QImage getCurrentFrameAsImage(int position);
 };
 #endif // FILTERCONTROLLER_H
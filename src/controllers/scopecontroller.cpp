@@ -18,12 +18,17 @@
 
 #include "Logger.h"
 #include "docks/scopedock.h"
+#include "executors.h"
+#include "settings.h"
 #include "widgets/scopes/audioloudnessscopewidget.h"
 #include "widgets/scopes/audiopeakmeterscopewidget.h"
+#include "widgets/scopes/audiospectrogramscopewidget.h"
 #include "widgets/scopes/audiospectrumscopewidget.h"
 #include "widgets/scopes/audiosurroundscopewidget.h"
+#include "widgets/scopes/audiotap.h"
 #include "widgets/scopes/audiovectorscopewidget.h"
 #include "widgets/scopes/audiowaveformscopewidget.h"
+#include "widgets/scopes/gpuscopes.h"
 #include "widgets/scopes/videohistogramscopewidget.h"
 #include "widgets/scopes/videorgbparadescopewidget.h"
 #include "widgets/scopes/videorgbwaveformscopewidget.h"
@@ -31,8 +36,10 @@
 #include "widgets/scopes/videowaveformscopewidget.h"
 #include "widgets/scopes/videozoomscopewidget.h"
 
+#include <QActionGroup>
 #include <QMainWindow>
 #include <QMenu>
+#include <QtConcurrent/QtConcurrent>
 
 /**
  * @class ScopeController
@@ -45,14 +52,17 @@
 
 ScopeController::ScopeController(QMainWindow *mainWindow, QMenu *menu)
     : QObject(mainWindow)
+    , m_isFramePending(false)
 {
     LOG_DEBUG() << "begin";
+    connect(&m_analysis, SIGNAL(finished()), this, SLOT(onAnalysisFinished()));
     // 在指定的菜单中添加一个名为“Scopes”（示波器）的子菜单
     QMenu *scopeMenu = menu->addMenu(tr("Scopes"));
 
     // 使用模板方法创建所有音频示波器的停靠窗口
     createScopeDock<AudioLoudnessScopeWidget>(mainWindow, scopeMenu);  // 音频响度
     createScopeDock<AudioPeakMeterScopeWidget>(mainWindow, scopeMenu); // 音频峰值表
+    createScopeDock<AudioSpectrogramScopeWidget>(mainWindow, scopeMenu); // 音频频谱图（时间-频率）
     createScopeDock<AudioSpectrumScopeWidget>(mainWindow, scopeMenu);  // 音频频谱
     createScopeDock<AudioSurroundScopeWidget>(mainWindow, scopeMenu);  // 环绕声
     createScopeDock<AudioVectorScopeWidget>(mainWindow, scopeMenu);   // 音频矢量图（相位）
@@ -65,6 +75,49 @@ ScopeController::ScopeController(QMainWindow *mainWindow, QMenu *menu)
     createScopeDock<VideoVectorScopeWidget>(mainWindow, scopeMenu);   // 视频矢量图（色度）
     createScopeDock<VideoWaveformScopeWidget>(mainWindow, scopeMenu); // 视频波形（亮度）
     createScopeDock<VideoZoomScopeWidget>(mainWindow, scopeMenu);     // 视频放大镜
+
+    // 视频示波器的分析分辨率：降低分辨率时先用盒式滤波器缩小帧再统计。
+    scopeMenu->addSeparator();
+    QMenu *resolutionMenu = scopeMenu->addMenu(tr("Video Scope Resolution"));
+    auto group = new QActionGroup(this);
+    const QList<QPair<QString, int>> resolutions = {
+        {tr("Full"), ShotcutSettings::ScopeResolutionFull},
+        {tr("Half"), ShotcutSettings::ScopeResolutionHalf},
+        {tr("Quarter"), ShotcutSettings::ScopeResolutionQuarter},
+        {tr("Automatic"), ShotcutSettings::ScopeResolutionAuto},
+    };
+    for (const auto &resolution : resolutions) {
+        QAction *action = resolutionMenu->addAction(resolution.first);
+        action->setCheckable(true);
+        action->setData(resolution.second);
+        action->setChecked(Settings.scopeResolution() == resolution.second);
+        group->addAction(action);
+    }
+    ScopeWidget::setResolution(Settings.scopeResolution());
+    connect(group, &QActionGroup::triggered, this, [](QAction *action) {
+        Settings.setScopeResolution(action->data().toInt());
+        ScopeWidget::setResolution(action->data().toInt());
+    });
+
+    // 使用 OpenGL 视频窗口已上传的纹理在 GPU 上计算波形、矢量图和直方图。
+    QAction *gpuAction = scopeMenu->addAction(tr("Use GPU for Video Scopes"));
+    gpuAction->setCheckable(true);
+    gpuAction->setChecked(Settings.scopeGpu());
+    GpuScopes::setEnabled(Settings.scopeGpu());
+    connect(gpuAction, &QAction::toggled, this, [](bool checked) {
+        Settings.setScopeGpu(checked);
+        GpuScopes::setEnabled(checked);
+    });
+
+    // 在每个示波器上叠加显示刷新耗时、队列深度和丢帧数，用于比较各示波器的开销。
+    QAction *statisticsAction = scopeMenu->addAction(tr("Show Scope Statistics"));
+    statisticsAction->setCheckable(true);
+    statisticsAction->setChecked(Settings.scopeShowStatistics());
+    ScopeWidget::setStatisticsVisible(Settings.scopeShowStatistics());
+    connect(statisticsAction, &QAction::toggled, this, [](bool checked) {
+        Settings.setScopeShowStatistics(checked);
+        ScopeWidget::setStatisticsVisible(checked);
+    });
     LOG_DEBUG() << "end";
 }
 
@@ -96,3 +149,70 @@ void ScopeController::createScopeDock(QMainWindow *mainWindow, QMenu *menu)
     // 5. 将停靠窗口添加到主窗口的右侧停靠区域。
     mainWindow->addDockWidget(Qt::RightDockWidgetArea, scopeDock);
 }
+
+void ScopeController::setScopeActive(ScopeWidget *scope, bool active)
+{
+    m_activeScopes.removeAll(scope);
+    if (active)
+        m_activeScopes << scope;
+    int analyses = 0;
+    for (auto activeScope : m_activeScopes)
+        analyses |= activeScope->gpuAnalyses();
+    GpuScopes::setRequested(analyses);
+}
+
+void ScopeController::onFrameDisplayed(const SharedFrame &frame)
+{
+    // 每帧的音频只转换一次写入共享的环形缓冲区，供所有音频示波器读取。
+    if (!m_activeScopes.isEmpty())
+        AudioTap::singleton().write(frame);
+    emit newFrame(frame);
+    if (imageFormats().isEmpty())
+        return;
+    if (m_analysis.isRunning()) {
+        // 只保留最新的一帧，示波器本身也会丢弃旧帧。
+        m_pendingFrame = frame;
+        m_isFramePending = true;
+        return;
+    }
+    startAnalysis(frame);
+}
+
+QList<mlt_image_format> ScopeController::imageFormats(const SharedFrame &frame) const
+{
+    QList<mlt_image_format> result;
+    for (auto scope : m_activeScopes) {
+        // 已经在 GPU 上计算过的示波器不需要转换图像。
+        if (frame.is_valid() && GpuScopes::hasAnalyses(frame, scope->gpuAnalyses()))
+            continue;
+        for (auto format : scope->imageFormats()) {
+            if (!result.contains(format))
+                result << format;
+        }
+    }
+    return result;
+}
+
+void ScopeController::startAnalysis(const SharedFrame &frame)
+{
+    // SharedFrame 会缓存每种格式的转换结果，因此所有示波器共享这些图像。
+    const auto formats = imageFormats(frame);
+    m_analysisFrame = frame;
+    m_analysis.setFuture(Executors::run(Executors::InteractiveExecutor, [frame, formats]() {
+        if (!frame.is_valid() || !frame.get_image_width() || !frame.get_image_height())
+            return;
+        for (auto format : formats)
+            frame.get_image(format);
+    }));
+}
+
+void ScopeController::onAnalysisFinished()
+{
+    emit newVideoFrame(m_analysisFrame);
+    m_analysisFrame = SharedFrame();
+    if (m_isFramePending) {
+        m_isFramePending = false;
+        startAnalysis(m_pendingFrame);
+        m_pendingFrame = SharedFrame();
+    }
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2016 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  * Author: Brian Matherly <code@brianmatherly.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -21,12 +21,15 @@
 
 #include "sharedframe.h"
 
+#include <QFutureWatcher>
+#include <QList>
 #include <QObject>
 #include <QString>
 
 class QMainWindow;
 class QMenu;
 class QWidget;
+class ScopeWidget;
 
 /**
  * @class ScopeController
@@ -35,6 +38,9 @@ class QWidget;
  * 这个类负责创建和管理应用程序中所有的示波器窗口（也称为“范围”或“Scopes”）。
  * 它通过一个模板方法 `createScopeDock` 来统一创建各种音频和视频示波器的停靠窗口，
  * 并将它们的切换动作添加到菜单中。
+ *
+ * 它还负责一个共享的帧分析阶段：每个显示的帧只为活动视频示波器需要的
+ * 图像格式各转换一次，再分发给所有这些示波器。没有示波器需要的格式不会被转换。
  * 
  * 注意：此类被标记为 `Q_DECL_FINAL`，意味着它不能被继承。
  */
@@ -50,16 +56,37 @@ public:
      */
     ScopeController(QMainWindow *mainWindow, QMenu *menu);
 
+    /**
+     * @brief 设置示波器是否处于活动状态（由 ScopeDock 在显示或隐藏时调用）。
+     * @param scope 示波器 Widget。
+     * @param active 示波器是否正在接收帧。
+     */
+    void setScopeActive(ScopeWidget *scope, bool active);
+
+public slots:
+    /**
+     * @brief 接收播放器显示的每一帧。
+     * @param frame 包含新帧数据的 SharedFrame 对象。
+     *
+     * 帧的音频先写入 AudioTap，然后帧会立即通过 newFrame() 转发。如果有活动的视频示波器，帧会在工作线程中
+     * 转换为它们需要的所有图像格式，然后通过 newVideoFrame() 分发。
+     * 分析进行中到达的帧只保留最新的一帧。
+     */
+    void onFrameDisplayed(const SharedFrame &frame);
+
 signals:
     /**
-     * @brief 当有新的视频帧可用于分析时发射此信号。
+     * @brief 每个显示的帧都会发射此信号，供不读取图像的示波器（例如音频示波器）使用。
      * @param frame 包含新帧数据的 SharedFrame 对象。
-     * 
-     * 注意：在提供的 `.cpp` 实现中，此信号并未被发射。它可能是为未来的功能或
-     * 其他组件（如 ScopeDock）与示波器 Widget 通信而预留的接口。
      */
     void newFrame(const SharedFrame &frame);
 
+    /**
+     * @brief 当帧已转换为活动视频示波器需要的所有图像格式后发射此信号。
+     * @param frame 包含新帧数据的 SharedFrame 对象，其转换后的图像已被缓存。
+     */
+    void newVideoFrame(const SharedFrame &frame);
+
 private:
     /**
      * @brief 模板函数，用于创建一个特定类型的示波器停靠窗口。
@@ -73,6 +100,20 @@ private:
      */
     template<typename ScopeTYPE>
     void createScopeDock(QMainWindow *mainWindow, QMenu *menu);
+
+    /// 返回所有活动示波器需要的图像格式（去重）。
+    /// 如果给出 \a frame，则跳过其 GPU 结果已附加在帧上的示波器。
+    QList<mlt_image_format> imageFormats(const SharedFrame &frame = SharedFrame()) const;
+    void startAnalysis(const SharedFrame &frame);
+
+    QList<ScopeWidget *> m_activeScopes;
+    QFutureWatcher<void> m_analysis;
+    SharedFrame m_analysisFrame;
+    SharedFrame m_pendingFrame;
+    bool m_isFramePending;
+
+private slots:
+    void onAnalysisFinished();
 };
 
 #endif // SCOPECONTROLLER_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2022 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,24 +19,112 @@
 
 #include "Logger.h"
 #include "dialogs/longuitask.h"
+#include "memorybudget.h"
+#include "performancecounters.h"
 #include "settings.h"
+#include "startupprofile.h"
 
-#include <utime.h>
+#include <QDataStream>
+#include <QDateTime>
 #include <QDir>
 #include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QtSql>
 
+#include <algorithm>
+#include <cstring>
+
 static QMutex g_mutex;
 static Database *instance = nullptr;
 static const int kMaxThumbnailCount = 5000;
 static const int kDeleteThumbnailsTimeoutMs = 60000;
+static const char *kPackFileName = "thumbnails.pack";
+static const char *kIndexFileName = "thumbnails.idx";
+static const char *kLegacyFolderName = "thumbnails";
+static const quint32 kPackMagic = 0x53435450;   // "SCTP"
+static const quint32 kRecordMagic = 0x53435452; // "SCTR"
+static const quint32 kIndexMagic = 0x53435449;  // "SCTI"
+static const quint32 kStoreVersion = 1;
+static const quint32 kFlagCompressed = 1;
+static const qint64 kRecordAlignment = 16;
+static const qint64 kMinCompactBytes = 16 * 1024 * 1024;
+static const int kLookupThreadCount = 2;
+
+namespace {
+
+struct PackHeader
+{
+    quint32 magic;
+    quint32 version;
+    quint32 reserved[2];
+};
+
+// Every record is padded to kRecordAlignment so that raw pixel data in the
+// memory map is always suitably aligned for QImage.
+struct RecordHeader
+{
+    quint32 magic;
+    quint32 keySize;
+    quint32 width;
+    quint32 height;
+    quint32 format;
+    quint32 bytesPerLine;
+    quint32 dataSize;
+    quint32 flags;
+};
+
+qint64 alignedSize(qint64 size)
+{
+    return (size + kRecordAlignment - 1) / kRecordAlignment * kRecordAlignment;
+}
+
+qint64 headerSize()
+{
+    return alignedSize(sizeof(PackHeader));
+}
+
+} // namespace
+
+static QString toKey(const QString &s)
+{
+    // This matches the file names used by the legacy per-file cache.
+    QString result = s;
+    return result.replace(':', '-');
+}
 
 Database::Database(QObject *parent)
     : QObject(parent)
+    , m_map(nullptr)
+    , m_mapSize(0)
+    , m_garbageBytes(0)
+    , m_indexDirty(false)
 {
+    m_threadPool.setMaxThreadCount(kLookupThreadCount);
+    setMemoryCacheBudget(qint64(Settings.thumbnailMemoryCacheMB()) * 1024 * 1024);
+    m_memoryBudgetId = MEMORY.add(
+        "thumbnails",
+        MemoryBudget::ThumbnailPriority,
+        [this]() {
+            QMutexLocker locker(&m_cacheMutex);
+            return qint64(m_memoryCache.totalCost()) * 1024;
+        },
+        [this](qint64 bytes) {
+            QMutexLocker locker(&m_cacheMutex);
+            return MemoryBudget::trim(m_memoryCache, bytes);
+        });
     m_deleteTimer.setInterval(kDeleteThumbnailsTimeoutMs);
     connect(&m_deleteTimer, SIGNAL(timeout()), this, SLOT(deleteOldThumbnails()));
-    thumbnailsDir(); // convert from db to filesystem if needed
+    if (appDataDir().exists(kPackFileName)) {
+        // Loading the index of a large store takes a while, so do it in the
+        // background and wait for it only on first use.
+        m_storeOpened = QtConcurrent::run(&m_threadPool, [this]() {
+            StartupProfile::Phase phase("thumbnail store");
+            openStore();
+        });
+    } else {
+        openStore(); // convert from db or files to the pack if needed
+    }
     m_deleteTimer.start();
 }
 
@@ -49,88 +137,510 @@ Database &Database::singleton(QObject *parent)
     return *instance;
 }
 
-static QString toFileName(const QString &s)
+Database::~Database()
 {
-    QString result = s;
-    return result.replace(':', '-') + +".png";
-}
-
-QDir Database::thumbnailsDir()
-{
-    QDir dir(Settings.appDataLocation());
-    const char *subfolder = "thumbnails";
-    if (!dir.cd(subfolder)) {
-        if (dir.mkdir(subfolder)) {
-            dir.cd(subfolder);
-
-            // Convert the DB data to files on the filesystem.
-            LongUiTask longTask(QObject::tr("Converting Thumbnails"));
-            QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
-            QDir appDir(Settings.appDataLocation());
-            QString dbFilePath = appDir.filePath("db.sqlite3");
-            db.setDatabaseName(dbFilePath);
-            if (db.open()) {
-                QSqlQuery query;
-                QImage img;
-                query.setForwardOnly(true);
-                int n = -1;
-                if (query.exec("SELECT COUNT(*) FROM thumbnails;") && query.next()) {
-                    n = query.value(0).toInt();
-                }
-                query.exec(QStringLiteral("SELECT hash, accessed, image FROM thumbnails ORDER BY "
-                                          "accessed DESC LIMIT %1")
-                               .arg(kMaxThumbnailCount));
-                for (int i = 0; query.next(); i++) {
-                    QString fileName = toFileName(query.value(0).toString());
-                    longTask.reportProgress(
-                        QObject::tr(
-                            "Please wait for this one-time update to the thumbnail cache..."),
-                        i,
-                        n);
-                    if (img.loadFromData(query.value(2).toByteArray(), "PNG")) {
-                        img.save(dir.filePath(fileName));
-                        auto accessed = query.value(1).toDateTime();
-                        auto offset = accessed.timeZone().offsetFromUtc(accessed);
-                        struct utimbuf utimes
-                        {
-                            static_cast<time_t>(accessed.toSecsSinceEpoch() + offset),
-                                static_cast<time_t>(accessed.toSecsSinceEpoch() + offset)
-                        };
-                        ::utime(dir.filePath(fileName).toUtf8().constData(), &utimes);
-                    }
+    MEMORY.remove(m_memoryBudgetId);
+    m_threadPool.clear();
+    m_threadPool.waitForDone();
+    waitForStore();
+    QMutexLocker locker(&m_mutex);
+    saveIndex();
+    unmap();
+    m_pack.close();
+    instance = nullptr;
+}
+
+void Database::waitForStore()
+{
+    m_storeOpened.waitForFinished();
+}
+
+QDir Database::appDataDir()
+{
+    return QDir(Settings.appDataLocation());
+}
+
+void Database::openStore()
+{
+    QMutexLocker locker(&m_mutex);
+    QDir dir = appDataDir();
+    bool isNew = !dir.exists(kPackFileName);
+    // The conversions show progress, so they only run on the main thread.
+    const bool isMigrating = isNew;
+
+    m_pack.setFileName(dir.filePath(kPackFileName));
+    if (!m_pack.open(QIODevice::ReadWrite)) {
+        LOG_WARNING() << "failed to open thumbnail store" << m_pack.fileName();
+        return;
+    }
+    PackHeader header;
+    if (!isNew && m_pack.size() >= headerSize()) {
+        m_pack.read(reinterpret_cast<char *>(&header), sizeof(header));
+        if (header.magic != kPackMagic || header.version != kStoreVersion) {
+            LOG_WARNING() << "discarding incompatible thumbnail store";
+            isNew = true;
+        }
+    } else {
+        isNew = true;
+    }
+    if (isNew) {
+        ::memset(&header, 0, sizeof(header));
+        header.magic = kPackMagic;
+        header.version = kStoreVersion;
+        m_pack.resize(0);
+        m_pack.write(reinterpret_cast<const char *>(&header), sizeof(header));
+        m_pack.write(QByteArray(headerSize() - sizeof(header), '\0'));
+        m_pack.flush();
+        QFile::remove(dir.filePath(kIndexFileName));
+
+        // One-time migrations from older cache layouts.
+        if (isMigrating) {
+            if (dir.cd(kLegacyFolderName)) {
+                migrateFromFiles(dir);
+            } else {
+                migrateFromSqlite();
+            }
+        }
+        saveIndex();
+    } else if (!loadIndex()) {
+        LOG_INFO() << "rebuilding thumbnail index";
+        m_index.clear();
+        m_garbageBytes = 0;
+        scanPack(headerSize());
+        saveIndex();
+    }
+}
+
+void Database::migrateFromSqlite()
+{
+    // Convert the DB data to the pack.
+    QDir appDir = appDataDir();
+    QString dbFilePath = appDir.filePath("db.sqlite3");
+    if (!QFile::exists(dbFilePath))
+        return;
+    LongUiTask longTask(QObject::tr("Converting Thumbnails"));
+    {
+        QSqlDatabase db = QSqlDatabase::addDatabase("QSQLITE");
+        db.setDatabaseName(dbFilePath);
+        if (db.open()) {
+            QSqlQuery query;
+            QImage img;
+            query.setForwardOnly(true);
+            int n = -1;
+            if (query.exec("SELECT COUNT(*) FROM thumbnails;") && query.next()) {
+                n = query.value(0).toInt();
+            }
+            query.exec(QStringLiteral("SELECT hash, accessed, image FROM thumbnails ORDER BY "
+                                      "accessed DESC LIMIT %1")
+                           .arg(kMaxThumbnailCount));
+            for (int i = 0; query.next(); i++) {
+                longTask.reportProgress(
+                    QObject::tr("Please wait for this one-time update to the thumbnail cache..."),
+                    i,
+                    n);
+                if (img.loadFromData(query.value(2).toByteArray(), "PNG")) {
+                    auto accessed = query.value(1).toDateTime();
+                    auto offset = accessed.timeZone().offsetFromUtc(accessed);
+                    appendRecord(toKey(query.value(0).toString()),
+                                 img,
+                                 accessed.toSecsSinceEpoch() + offset);
                 }
-                db.close();
-                QSqlDatabase::removeDatabase("QSQLITE");
             }
+            db.close();
         }
     }
-    return dir;
+    QSqlDatabase::removeDatabase("QSQLITE");
+}
+
+void Database::migrateFromFiles(QDir &dir)
+{
+    // Convert the per-key PNG files to the pack.
+    LongUiTask longTask(QObject::tr("Converting Thumbnails"));
+    auto ls = dir.entryInfoList(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Time);
+    int n = qMin<int>(ls.size(), kMaxThumbnailCount);
+    QImage img;
+    for (int i = 0; i < n; i++) {
+        longTask.reportProgress(
+            QObject::tr("Please wait for this one-time update to the thumbnail cache..."), i, n);
+        const auto &info = ls[i];
+        if (info.suffix() == QLatin1String("png") && img.load(info.filePath(), "PNG")) {
+            appendRecord(info.completeBaseName(),
+                         img,
+                         info.lastModified().toSecsSinceEpoch());
+        }
+    }
+    if (!dir.removeRecursively()) {
+        LOG_WARNING() << "failed to remove" << dir.path();
+    }
+}
+
+bool Database::loadIndex()
+{
+    QFile file(appDataDir().filePath(kIndexFileName));
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream in(&file);
+    quint32 magic, version, count;
+    qint64 packSize;
+    in >> magic >> version >> packSize >> m_garbageBytes >> count;
+    if (in.status() != QDataStream::Ok || magic != kIndexMagic || version != kStoreVersion
+        || packSize > m_pack.size() || packSize < headerSize())
+        return false;
+    m_index.reserve(count);
+    for (quint32 i = 0; i < count && in.status() == QDataStream::Ok; i++) {
+        QString key;
+        IndexEntry entry;
+        in >> key >> entry.offset >> entry.size >> entry.accessed;
+        if (entry.offset + entry.size > packSize)
+            return false;
+        m_index.insert(key, entry);
+    }
+    if (in.status() != QDataStream::Ok)
+        return false;
+    // Pick up any records appended after the index was last saved.
+    if (packSize < m_pack.size())
+        scanPack(packSize);
+    return true;
+}
+
+void Database::saveIndex()
+{
+    if (!m_pack.isOpen())
+        return;
+    QSaveFile file(appDataDir().filePath(kIndexFileName));
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING() << "failed to write" << file.fileName();
+        return;
+    }
+    m_pack.flush();
+    QDataStream out(&file);
+    out << kIndexMagic << kStoreVersion << m_pack.size() << m_garbageBytes
+        << quint32(m_index.size());
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it) {
+        out << it.key() << it.value().offset << it.value().size << it.value().accessed;
+    }
+    if (file.commit())
+        m_indexDirty = false;
+}
+
+void Database::scanPack(qint64 from)
+{
+    qint64 end = m_pack.size();
+    if (!ensureMapped(end))
+        return;
+    auto now = QDateTime::currentSecsSinceEpoch();
+    qint64 offset = from;
+    while (offset + qint64(sizeof(RecordHeader)) <= end) {
+        RecordHeader header;
+        ::memcpy(&header, m_map + offset, sizeof(header));
+        qint64 size = alignedSize(sizeof(header) + header.keySize) + alignedSize(header.dataSize);
+        if (header.magic != kRecordMagic || offset + size > end) {
+            // Truncate a partially written record.
+            LOG_WARNING() << "thumbnail store truncated at" << offset;
+            unmap();
+            m_pack.resize(offset);
+            break;
+        }
+        auto key = QString::fromUtf8(reinterpret_cast<const char *>(m_map + offset
+                                                                    + sizeof(header)),
+                                     header.keySize);
+        auto it = m_index.find(key);
+        if (it != m_index.end()) {
+            m_garbageBytes += it->size;
+            it->offset = offset;
+            it->size = size;
+        } else {
+            m_index.insert(key, {offset, quint32(size), now});
+        }
+        offset += size;
+    }
+    m_indexDirty = true;
+}
+
+bool Database::appendRecord(const QString &key, const QImage &image, qint64 accessed)
+{
+    if (!m_pack.isOpen() || image.isNull())
+        return false;
+    QImage img = image;
+    switch (img.format()) {
+    case QImage::Format_ARGB32:
+    case QImage::Format_ARGB32_Premultiplied:
+    case QImage::Format_RGB32:
+    case QImage::Format_RGB888:
+    case QImage::Format_RGBA8888:
+    case QImage::Format_RGBA8888_Premultiplied:
+    case QImage::Format_RGBX8888:
+        break;
+    default:
+        img = img.convertToFormat(img.hasAlphaChannel() ? QImage::Format_ARGB32
+                                                        : QImage::Format_RGB32);
+        break;
+    }
+
+    const QByteArray keyData = key.toUtf8();
+    QByteArray pixels = QByteArray::fromRawData(reinterpret_cast<const char *>(img.constBits()),
+                                                img.sizeInBytes());
+    RecordHeader header;
+    header.magic = kRecordMagic;
+    header.keySize = keyData.size();
+    header.width = img.width();
+    header.height = img.height();
+    header.format = img.format();
+    header.bytesPerLine = img.bytesPerLine();
+    header.flags = 0;
+    // Light compression only when it pays off; raw blocks need no decoding.
+    QByteArray compressed = qCompress(pixels, 1);
+    if (compressed.size() < pixels.size() * 3 / 4) {
+        pixels = compressed;
+        header.flags |= kFlagCompressed;
+    }
+    header.dataSize = pixels.size();
+
+    qint64 offset = m_pack.size();
+    qint64 headSize = alignedSize(sizeof(header) + keyData.size());
+    qint64 size = headSize + alignedSize(pixels.size());
+    QByteArray record(size, '\0');
+    ::memcpy(record.data(), &header, sizeof(header));
+    ::memcpy(record.data() + sizeof(header), keyData.constData(), keyData.size());
+    ::memcpy(record.data() + headSize, pixels.constData(), pixels.size());
+    if (!m_pack.seek(offset) || m_pack.write(record) != size) {
+        LOG_WARNING() << "failed to write thumbnail" << key;
+        m_pack.resize(offset);
+        return false;
+    }
+
+    auto it = m_index.find(key);
+    if (it != m_index.end()) {
+        m_garbageBytes += it->size;
+        *it = {offset, quint32(size), accessed};
+    } else {
+        m_index.insert(key, {offset, quint32(size), accessed});
+    }
+    m_indexDirty = true;
+    return true;
+}
+
+bool Database::ensureMapped(qint64 end)
+{
+    if (m_map && end <= m_mapSize)
+        return true;
+    unmap();
+    m_pack.flush();
+    m_mapSize = m_pack.size();
+    if (m_mapSize > 0)
+        m_map = m_pack.map(0, m_mapSize);
+    if (!m_map) {
+        LOG_WARNING() << "failed to map thumbnail store" << m_pack.errorString();
+        m_mapSize = 0;
+    }
+    return m_map && end <= m_mapSize;
+}
+
+void Database::unmap()
+{
+    if (m_map) {
+        m_pack.unmap(m_map);
+        m_map = nullptr;
+        m_mapSize = 0;
+    }
 }
 
 bool Database::putThumbnail(const QString &hash, const QImage &image)
 {
-    return image.save(thumbnailsDir().filePath(toFileName(hash)));
+    const auto key = toKey(hash);
+    cacheImage(key, image);
+    waitForStore();
+    QMutexLocker locker(&m_mutex);
+    return appendRecord(key, image, QDateTime::currentSecsSinceEpoch());
 }
 
 QImage Database::getThumbnail(const QString &hash)
 {
-    QString filePath = thumbnailsDir().filePath(toFileName(hash));
-    ::utime(filePath.toUtf8().constData(), nullptr);
-    return QImage(filePath);
+    const auto key = toKey(hash);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (auto image = m_memoryCache.object(key)) {
+            QMutexLocker indexLocker(&m_mutex);
+            auto it = m_index.find(key);
+            if (it != m_index.end()) {
+                it->accessed = QDateTime::currentSecsSinceEpoch();
+                m_indexDirty = true;
+            }
+            PerformanceCounters::add(PerformanceCounters::ThumbnailMemoryHits);
+            return *image;
+        }
+    }
+    waitForStore();
+    QImage image;
+    {
+        QMutexLocker locker(&m_mutex);
+        image = readRecord(key);
+    }
+    PerformanceCounters::add(image.isNull() ? PerformanceCounters::ThumbnailMisses
+                                            : PerformanceCounters::ThumbnailDiskHits);
+    cacheImage(key, image);
+    return image;
+}
+
+QImage Database::requestThumbnail(const QString &hash, QObject *context, ThumbnailCallback callback)
+{
+    const auto key = toKey(hash);
+    {
+        QMutexLocker locker(&m_cacheMutex);
+        if (auto image = m_memoryCache.object(key)) {
+            PerformanceCounters::add(PerformanceCounters::ThumbnailMemoryHits);
+            return *image;
+        }
+        auto it = m_pending.find(key);
+        if (it != m_pending.end()) {
+            // Views repaint often; one callback per context is enough.
+            for (const auto &pending : *it) {
+                if (pending.first == context)
+                    return QImage();
+            }
+            it->append(qMakePair(QPointer<QObject>(context), callback));
+            return QImage();
+        }
+        m_pending[key].append(qMakePair(QPointer<QObject>(context), callback));
+    }
+    m_threadPool.start([=]() {
+        QImage image = getThumbnail(hash);
+        QList<QPair<QPointer<QObject>, ThumbnailCallback>> callbacks;
+        {
+            QMutexLocker locker(&m_cacheMutex);
+            callbacks = m_pending.take(key);
+        }
+        for (const auto &pending : callbacks) {
+            if (pending.first) {
+                auto callback = pending.second;
+                QMetaObject::invokeMethod(
+                    pending.first.data(), [=]() { callback(image); }, Qt::QueuedConnection);
+            }
+        }
+    });
+    return QImage();
+}
+
+void Database::setMemoryCacheBudget(qint64 bytes)
+{
+    QMutexLocker locker(&m_cacheMutex);
+    // QCache costs are in KiB to stay well within the range of its cost type.
+    m_memoryCache.setMaxCost(qMax<qint64>(bytes / 1024, 1));
+}
+
+void Database::cacheImage(const QString &key, const QImage &image)
+{
+    if (image.isNull())
+        return;
+    QMutexLocker locker(&m_cacheMutex);
+    m_memoryCache.insert(key, new QImage(image), image.sizeInBytes() / 1024 + 1);
+}
+
+QImage Database::readRecord(const QString &key)
+{
+    auto it = m_index.find(key);
+    if (it == m_index.end() || !ensureMapped(it->offset + it->size))
+        return QImage();
+
+    // LRU accounting is kept in the index instead of file times.
+    it->accessed = QDateTime::currentSecsSinceEpoch();
+    m_indexDirty = true;
+
+    RecordHeader header;
+    const uchar *record = m_map + it->offset;
+    ::memcpy(&header, record, sizeof(header));
+    const uchar *data = record + alignedSize(sizeof(header) + header.keySize);
+    auto format = QImage::Format(header.format);
+    if (header.flags & kFlagCompressed) {
+        QByteArray pixels = qUncompress(data, header.dataSize);
+        if (pixels.size() < qint64(header.bytesPerLine) * header.height)
+            return QImage();
+        return QImage(reinterpret_cast<const uchar *>(pixels.constData()),
+                      header.width,
+                      header.height,
+                      header.bytesPerLine,
+                      format)
+            .copy();
+    }
+    // Copy out of the map since it may be remapped or compacted later.
+    return QImage(data, header.width, header.height, header.bytesPerLine, format).copy();
+}
+
+void Database::compact()
+{
+    QDir dir = appDataDir();
+    QString tmpPath = dir.filePath(QStringLiteral("%1.tmp").arg(kPackFileName));
+    QFile tmp(tmpPath);
+    if (!ensureMapped(m_pack.size()) || !tmp.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_WARNING() << "failed to compact thumbnail store";
+        return;
+    }
+    LOG_DEBUG() << "compacting thumbnail store, reclaiming" << m_garbageBytes << "bytes";
+
+    // Write live records in offset order to keep locality.
+    QList<QPair<qint64, QString>> records;
+    records.reserve(m_index.size());
+    for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it)
+        records << qMakePair(it.value().offset, it.key());
+    std::sort(records.begin(), records.end());
+    QHash<QString, IndexEntry> index;
+    index.reserve(m_index.size());
+    tmp.write(reinterpret_cast<const char *>(m_map), headerSize());
+    for (const auto &record : records) {
+        const QString &key = record.second;
+        IndexEntry entry = m_index.value(key);
+        qint64 offset = tmp.pos();
+        if (tmp.write(reinterpret_cast<const char *>(m_map + entry.offset), entry.size)
+            != entry.size) {
+            LOG_WARNING() << "failed to compact thumbnail store" << tmp.errorString();
+            tmp.close();
+            QFile::remove(tmpPath);
+            return;
+        }
+        entry.offset = offset;
+        index.insert(key, entry);
+    }
+    tmp.close();
+
+    unmap();
+    m_pack.close();
+    QFile::remove(m_pack.fileName());
+    if (!QFile::rename(tmpPath, m_pack.fileName())) {
+        LOG_WARNING() << "failed to replace" << m_pack.fileName();
+        QFile::copy(tmpPath, m_pack.fileName());
+        QFile::remove(tmpPath);
+    }
+    if (m_pack.open(QIODevice::ReadWrite)) {
+        m_index = index;
+    } else {
+        m_index.clear();
+    }
+    m_garbageBytes = 0;
+    m_indexDirty = true;
 }
 
 void Database::deleteOldThumbnails()
 {
     auto result = QtConcurrent::run([=]() {
-        QDir dir = thumbnailsDir();
-        auto ls = dir.entryList(QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDir::Time);
-        if (ls.size() - kMaxThumbnailCount > 0)
-            LOG_DEBUG() << "removing" << ls.size() - kMaxThumbnailCount;
-        for (int i = kMaxThumbnailCount; i < ls.size(); i++) {
-            QString filePath = dir.filePath(ls[i]);
-            if (!QFile::remove(filePath)) {
-                LOG_WARNING() << "failed to delete" << filePath;
+        waitForStore();
+        QMutexLocker locker(&m_mutex);
+        int excess = m_index.size() - kMaxThumbnailCount;
+        if (excess > 0) {
+            LOG_DEBUG() << "removing" << excess;
+            QList<QPair<qint64, QString>> lru;
+            lru.reserve(m_index.size());
+            for (auto it = m_index.constBegin(); it != m_index.constEnd(); ++it)
+                lru << qMakePair(it.value().accessed, it.key());
+            std::partial_sort(lru.begin(), lru.begin() + excess, lru.end());
+            for (int i = 0; i < excess; i++) {
+                m_garbageBytes += m_index.value(lru[i].second).size;
+                m_index.remove(lru[i].second);
             }
+            m_indexDirty = true;
         }
+        if (m_garbageBytes > kMinCompactBytes && m_garbageBytes > m_pack.size() / 2)
+            compact();
+        if (m_indexDirty)
+            saveIndex();
     });
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2021 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,10 +18,19 @@
 #ifndef DATABASE_H
 #define DATABASE_H
 
+#include <QCache>
 #include <QDir>
+#include <QFile>
+#include <QFuture>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
+#include <QPointer>
+#include <QThreadPool>
 #include <QTimer>
 
+#include <functional>
+
 class Database : public QObject
 {
     Q_OBJECT
@@ -29,13 +38,56 @@ class Database : public QObject
 
 public:
     static Database &singleton(QObject *parent = 0);
+    virtual ~Database();
+
+    typedef std::function<void(const QImage &)> ThumbnailCallback;
 
     bool putThumbnail(const QString &hash, const QImage &image);
     QImage getThumbnail(const QString &hash);
+    /// Returns the image immediately if it is already decoded in memory.
+    /// Otherwise, returns a null image and looks it up in the background,
+    /// calling \a callback on the thread of \a context with the result, which
+    /// is null if there is no thumbnail for \a hash.
+    QImage requestThumbnail(const QString &hash, QObject *context, ThumbnailCallback callback);
+    void setMemoryCacheBudget(qint64 bytes);
 
 private:
-    QDir thumbnailsDir();
+    struct IndexEntry
+    {
+        qint64 offset;
+        quint32 size;
+        qint64 accessed;
+    };
+
+    QDir appDataDir();
+    void openStore();
+    void waitForStore();
+    void migrateFromSqlite();
+    void migrateFromFiles(QDir &dir);
+    bool loadIndex();
+    void saveIndex();
+    void scanPack(qint64 from);
+    bool appendRecord(const QString &hash, const QImage &image, qint64 accessed);
+    QImage readRecord(const QString &key);
+    void cacheImage(const QString &key, const QImage &image);
+    bool ensureMapped(qint64 end);
+    void unmap();
+    void compact();
+
     QTimer m_deleteTimer;
+    QMutex m_mutex;
+    QFile m_pack;
+    uchar *m_map;
+    qint64 m_mapSize;
+    QHash<QString, IndexEntry> m_index;
+    qint64 m_garbageBytes;
+    bool m_indexDirty;
+    QMutex m_cacheMutex;
+    QCache<QString, QImage> m_memoryCache;
+    int m_memoryBudgetId;
+    QHash<QString, QList<QPair<QPointer<QObject>, ThumbnailCallback>>> m_pending;
+    QThreadPool m_threadPool;
+    QFuture<void> m_storeOpened;
 
 private slots:
     void deleteOldThumbnails();
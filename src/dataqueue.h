@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  * Author: Brian Matherly <code@brianmatherly.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -19,11 +19,16 @@
 #ifndef DATAQUEUE_H
 #define DATAQUEUE_H
 
+#include <QAtomicInt>
+#include <QAtomicPointer>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QSemaphore>
 #include <QWaitCondition>
 
+#include <array>
 #include <deque>
+#include <utility>
 
 /*!
   \class DataQueue
@@ -159,4 +164,250 @@ int DataQueue<T>::count() const
     return m_queue.size();
 }
 
+/*!
+  \class DataMailbox
+  \brief The DataMailbox passes only the latest item between objects.
+
+  \threadsafe
+
+  DataMailbox holds at most one item. put() replaces an item that has not been
+  taken yet and counts it as dropped, while take() empties the mailbox. Neither
+  blocks or takes a lock because the item is exchanged by pointer. This makes
+  DataMailbox appropriate when the consumer only needs the newest item and
+  must never fall behind the producer, such as a scope showing the last frame.
+*/
+
+template<class T>
+class DataMailbox
+{
+public:
+    //! Constructs an empty DataMailbox.
+    DataMailbox();
+
+    //! Destructs a DataMailbox and any item that was not taken.
+    ~DataMailbox();
+
+    /*!
+      Puts an item in the mailbox.
+
+      Returns false if it replaced an item that was not taken.
+    */
+    bool put(const T &item);
+
+    /*!
+      Takes the item from the mailbox into \a item.
+
+      Returns false and leaves \a item unchanged if the mailbox is empty.
+    */
+    bool take(T &item);
+
+    //! Returns true if there is no item to take.
+    bool isEmpty() const;
+
+    //! Returns the number of items that were replaced before being taken.
+    int dropped() const;
+
+private:
+    Q_DISABLE_COPY(DataMailbox)
+    QAtomicPointer<T> m_item;
+    QAtomicInt m_dropped;
+};
+
+template<class T>
+DataMailbox<T>::DataMailbox()
+    : m_item(nullptr)
+    , m_dropped(0)
+{}
+
+template<class T>
+DataMailbox<T>::~DataMailbox()
+{
+    delete m_item.loadAcquire();
+}
+
+template<class T>
+bool DataMailbox<T>::put(const T &item)
+{
+    T *old = m_item.fetchAndStoreOrdered(new T(item));
+    if (old) {
+        delete old;
+        m_dropped.fetchAndAddRelaxed(1);
+        return false;
+    }
+    return true;
+}
+
+template<class T>
+bool DataMailbox<T>::take(T &item)
+{
+    T *taken = m_item.fetchAndStoreOrdered(nullptr);
+    if (!taken)
+        return false;
+    item = *taken;
+    delete taken;
+    return true;
+}
+
+template<class T>
+bool DataMailbox<T>::isEmpty() const
+{
+    return !m_item.loadRelaxed();
+}
+
+template<class T>
+int DataMailbox<T>::dropped() const
+{
+    return m_dropped.loadRelaxed();
+}
+
+/*!
+  \class SpscRing
+  \brief The SpscRing passes items from one thread to another without a lock.
+
+  \threadsafe
+
+  SpscRing holds up to \a N items, which must be a power of two, in a ring.
+  As long as only one thread pushes and only one thread pops, neither takes a
+  lock: the producer owns the tail and the consumer owns the head, and each is
+  on a cache line of its own so that the threads do not contend for it. Items
+  are moved in and out, and popAll() drains every queued item at once.
+
+  By default push() fails when the ring is full and pop() fails when it is
+  empty. A blocking ring waits on a QSemaphore instead, which only enters the
+  kernel when it has to wait.
+
+  Unlike DataQueue, the producer cannot discard the oldest item, because that
+  would make it a second consumer.
+*/
+
+template<class T, int N>
+class SpscRing
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "the size of a SpscRing must be a power of two");
+
+public:
+    //! Constructs an empty SpscRing that waits if \a isBlocking.
+    explicit SpscRing(bool isBlocking = false);
+
+    /*!
+      Moves an item into the ring.
+
+      Returns false if the ring is full, or waits for room if it is blocking.
+    */
+    bool push(T &&item);
+
+    //! Constructs an item in the ring from \a args as push() does.
+    template<class... Args>
+    bool emplace(Args &&...args);
+
+    /*!
+      Moves the oldest item out of the ring into \a item.
+
+      Returns false if the ring is empty, or waits for an item if it is
+      blocking.
+    */
+    bool pop(T &item);
+
+    /*!
+      Moves every queued item out of the ring into \a out without waiting.
+
+      Returns the number of items.
+    */
+    template<class OutputIt>
+    int popAll(OutputIt out);
+
+    //! Returns the number of items in the ring.
+    int count() const;
+
+    //! Returns the maximum number of items in the ring.
+    static constexpr int capacity() { return N; }
+
+private:
+    Q_DISABLE_COPY(SpscRing)
+
+    struct alignas(64) Index
+    {
+        QAtomicInteger<quint32> value{0};
+    };
+
+    Index m_head; // Written by the consumer
+    Index m_tail; // Written by the producer
+    const bool m_isBlocking;
+    QSemaphore m_free;
+    QSemaphore m_used;
+    std::array<T, N> m_items;
+};
+
+template<class T, int N>
+SpscRing<T, N>::SpscRing(bool isBlocking)
+    : m_isBlocking(isBlocking)
+    , m_free(N)
+    , m_used(0)
+{}
+
+template<class T, int N>
+bool SpscRing<T, N>::push(T &&item)
+{
+    return emplace(std::move(item));
+}
+
+template<class T, int N>
+template<class... Args>
+bool SpscRing<T, N>::emplace(Args &&...args)
+{
+    const quint32 tail = m_tail.value.loadRelaxed();
+    if (m_isBlocking)
+        m_free.acquire();
+    else if (tail - m_head.value.loadAcquire() >= quint32(N))
+        return false;
+    m_items[tail & (N - 1)] = T(std::forward<Args>(args)...);
+    m_tail.value.storeRelease(tail + 1);
+    if (m_isBlocking)
+        m_used.release();
+    return true;
+}
+
+template<class T, int N>
+bool SpscRing<T, N>::pop(T &item)
+{
+    const quint32 head = m_head.value.loadRelaxed();
+    if (m_isBlocking)
+        m_used.acquire();
+    else if (head == m_tail.value.loadAcquire())
+        return false;
+    item = std::move(m_items[head & (N - 1)]);
+    m_head.value.storeRelease(head + 1);
+    if (m_isBlocking)
+        m_free.release();
+    return true;
+}
+
+template<class T, int N>
+template<class OutputIt>
+int SpscRing<T, N>::popAll(OutputIt out)
+{
+    const quint32 head = m_head.value.loadRelaxed();
+    int n = 0;
+    if (m_isBlocking) {
+        // Only this thread acquires, so what is available can be taken.
+        n = m_used.available();
+        if (n == 0 || !m_used.tryAcquire(n))
+            return 0;
+    } else {
+        n = int(m_tail.value.loadAcquire() - head);
+    }
+    for (int i = 0; i < n; ++i)
+        *out++ = std::move(m_items[(head + i) & (N - 1)]);
+    m_head.value.storeRelease(head + n);
+    if (m_isBlocking && n > 0)
+        m_free.release(n);
+    return n;
+}
+
+template<class T, int N>
+int SpscRing<T, N>::count() const
+{
+    return int(m_tail.value.loadAcquire() - m_head.value.loadAcquire());
+}
+
 #endif // DATAQUEUE_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022 Meltytech, LLC
+ * Copyright (c) 2022-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,6 +21,7 @@
 // 引入依赖的头文件（日志、命令、UI组件、业务逻辑等）
 #include "Logger.h"                    // 日志工具类，用于打印调试/错误信息
 #include "commands/timelinecommands.h" // 时间线操作命令类（如对齐剪辑的命令）
+#include "database.h"                  // 缓存数据库（与音频波形共用，缓存对齐特征）
 #include "dialogs/alignmentarray.h"    // 音频对齐数据数组类（存储音频特征值）
 #include "dialogs/longuitask.h"        // 长时间UI任务类（显示处理进度）
 #include "mainwindow.h"                // 主窗口类（访问全局资源如撤销栈）
@@ -36,7 +37,9 @@
 #include <QApplication>
 #include <QCheckBox>
 #include <QComboBox>
+#include <QCryptographicHash>
 #include <QDialogButtonBox>
+#include <QEventLoop>
 #include <QGridLayout>
 #include <QHBoxLayout>
 #include <QHeaderView>
@@ -46,8 +49,13 @@
 #include <QPainter>
 #include <QPushButton>
 #include <QStyledItemDelegate>
+#include <QThread>
+#include <QThreadPool>
 #include <QTreeView>
 
+// 同时读取音频的最大线程数（每个线程解码一个剪辑）
+static const int kMaxReaders = 4;
+
 // 【内部辅助类】AudioReader
 // 【功能】读取单个音频资源的特征数据（如音量平均值），用于后续对齐分析
 class AudioReader : public QObject
@@ -71,6 +79,26 @@ class AudioReader : public QObject
 
     // 【核心方法】：处理音频，计算每帧的音量平均值并存入特征数组
     void process()
+    {
+        // 优先使用缓存的特征值（与音频波形共用缓存），重新对齐时无需再解码
+        std::vector<double> values;
+        if (!readCache(values)) {
+            values = extract();
+            writeCache(values);
+        }
+        emit progressUpdate(100);
+
+        // 将计算好的特征值数组存入外部传入的AlignmentArray
+        m_array->setValues(values);
+    }
+
+signals:
+    // 进度更新信号：参数为当前进度（0-100），用于UI显示
+    void progressUpdate(int);
+
+private:
+    // 解码音频，计算每帧的音量平均值
+    std::vector<double> extract()
     {
         // 1. 创建MLT生产者（从XML描述中加载音频资源）
         // QScopedPointer：智能指针，自动释放生产者对象，避免内存泄漏
@@ -83,6 +111,8 @@ class AudioReader : public QObject
         }
 
         // 3. 获取音频总帧数，初始化特征值数组（存储每帧的音量平均值）
+        // 从头开始顺序读取：每次get_frame()后生产者自动前进一帧，无需逐帧定位
+        producer->seek(0);
         size_t frameCount = producer->get_playtime(); // 音频总帧数
         std::vector<double> values(frameCount);       // 存储每帧特征值
         int progress = 0;                             // 进度值（0-100）
@@ -95,7 +125,7 @@ class AudioReader : public QObject
             mlt_audio_format format = mlt_audio_s16;
 
             // 获取当前帧的音频数据
-            std::unique_ptr<Mlt::Frame> frame(producer->get_frame(i)); // 智能指针管理帧对象
+            std::unique_ptr<Mlt::Frame> frame(producer->get_frame()); // 智能指针管理帧对象
             mlt_position position = mlt_frame_get_position(frame->get_frame()); // 获取帧位置
             // 计算当前帧的采样点数（根据帧率和采样率推导）
             int samples = mlt_audio_calculate_frame_samples(float(producer->get_fps()),
@@ -122,15 +152,41 @@ class AudioReader : public QObject
             }
         }
 
-        // 8. 将计算好的特征值数组存入外部传入的AlignmentArray
-        m_array->setValues(values);
+        return values;
     }
 
-signals:
-    // 进度更新信号：参数为当前进度（0-100），用于UI显示
-    void progressUpdate(int);
+    // 缓存键：由生产者XML和入点/出点决定（滤镜等改变音频时键也会改变）
+    QString cacheKey() const
+    {
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(m_producerXml.toUtf8());
+        hash.addData(QStringLiteral(" %1 %2").arg(m_in).arg(m_out).toUtf8());
+        return QStringLiteral("%1 alignment").arg(QString::fromLatin1(hash.result().toHex()));
+    }
+
+    // 从缓存读取特征值：缓存为一行RGBA8888图像，每个像素保存一个float
+    bool readCache(std::vector<double> &values) const
+    {
+        QImage image = DB.getThumbnail(cacheKey());
+        if (image.isNull() || image.format() != QImage::Format_RGBA8888 || image.height() != 1)
+            return false;
+        const float *data = reinterpret_cast<const float *>(image.constScanLine(0));
+        values.assign(data, data + image.width());
+        LOG_DEBUG() << "using cached alignment features" << values.size();
+        return true;
+    }
+
+    // 将特征值写入缓存
+    void writeCache(const std::vector<double> &values) const
+    {
+        if (values.empty())
+            return;
+        QImage image(int(values.size()), 1, QImage::Format_RGBA8888);
+        float *data = reinterpret_cast<float *>(image.scanLine(0));
+        std::copy(values.begin(), values.end(), data);
+        DB.putThumbnail(cacheKey(), image);
+    }
 
-private:
     QString m_producerXml;   // MLT生产者的XML描述（音频资源信息）
     AlignmentArray *m_array; // 存储音频特征数据的外部数组
     int m_in;                // 音频处理入点（帧位置）
@@ -162,11 +218,12 @@ class ClipAudioReader : public QObject
     // 初始化内部特征数组：与参考轨道数组长度一致
     void init(int maxLength) { m_reader.init(maxLength); }
 
-    // 启动音频处理（异步执行，使用QtConcurrent多线程）
-    void start() { m_future = QtConcurrent::run(&ClipAudioReader::process, this); }
-
-    // 检查处理是否完成（用于主线程等待）
-    bool isFinished() { return m_future.isFinished(); }
+    // 启动音频处理（在pool中异步执行）；reference为参考轨道的读取任务，计算对齐参数前等待其完成
+    void start(QThreadPool *pool, const QFuture<void> &reference)
+    {
+        m_reference = reference;
+        m_future = QtConcurrent::run(pool, &ClipAudioReader::process, this);
+    }
 
     // 核心方法：处理剪辑音频并计算对齐参数
     void process()
@@ -175,6 +232,8 @@ class ClipAudioReader : public QObject
         onReaderProgressUpdate(0);
         // 2. 调用AudioReader处理剪辑音频，生成特征数组（m_clipArray）
         m_reader.process();
+        // 参考轨道与剪辑同时读取，对齐前等待参考轨道的特征数组完成
+        m_reference.waitForFinished();
 
         // 3. 计算对齐参数（偏移量、速度）
         double speed = 1.0; // 速度补偿（默认1.0，无补偿）
@@ -219,6 +278,7 @@ private:
     AudioReader m_reader;             // 音频读取器（处理当前剪辑音频）
     int m_index;                      // 剪辑在列表中的索引
     QFuture<void> m_future;           // 异步任务对象（管理多线程执行）
+    QFuture<void> m_reference;        // 参考轨道的读取任务
     bool m_calculateSpeed;            // （未使用）是否计算速度补偿的标记
 };
 
@@ -597,25 +657,32 @@ void AlignAudioDialog::process()
             clipReader->init(maxLength);
     }
 
-    // 7. 处理参考轨道音频（生成特征数组）
-    trackReader.process();
+    // 7. 在有限的线程池中同时读取参考轨道和所有剪辑；
+    // 参考轨道最先启动，保证它总能占到线程，等待它的剪辑不会死锁
+    QThreadPool pool;
+    pool.setMaxThreadCount(qBound(1, QThread::idealThreadCount(), kMaxReaders));
+    QFuture<void> reference = QtConcurrent::run(&pool, &AudioReader::process, &trackReader);
 
-    // 8. 启动所有剪辑的音频处理（异步多线程执行）
+    // 8. 启动所有剪辑的音频处理（异步多线程执行），完成信号计数
+    QEventLoop loop;
+    int pending = 0;
     for (const auto &clipReader : m_clipReaders) {
-        if (clipReader)
-            clipReader->start();
+        if (clipReader) {
+            ++pending;
+            connect(clipReader, &ClipAudioReader::finished, &loop, [&]() {
+                if (--pending == 0)
+                    loop.quit();
+            });
+            clipReader->start(&pool, reference);
+        }
     }
 
-    // 9. 等待所有剪辑处理完成（主线程循环检查，同时处理UI事件）
+    // 9. 等待所有剪辑处理完成（运行事件循环直到最后一个完成信号，保持界面响应）
+    loop.exec();
+    pool.waitForDone();
     for (const auto &clipReader : m_clipReaders) {
-        if (clipReader) {
-            // 循环等待，直到处理完成（每10ms检查一次，避免阻塞UI）
-            while (!clipReader->isFinished()) {
-                QThread::msleep(10);               // 休眠10ms（减少CPU占用）
-                QCoreApplication::processEvents(); // 处理UI事件（保持界面响应）
-            }
+        if (clipReader)
             clipReader->deleteLater(); // 处理完成后释放读取器
-        }
     }
 
     // 10. 处理完成：释放进度窗口，启用"应用"按钮
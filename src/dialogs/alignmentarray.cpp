@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022 Meltytech, LLC
+ * Copyright (c) 2022-2026 Meltytech, LLC
  *
  * Author: André Caldas de Souza <andrecaldas@unb.br>
  *
@@ -19,9 +19,11 @@
 
 #include "alignmentarray.h" // 包含当前类的头文件
 
-// 引入必要的头文件：Qt调试、线程同步、标准算法、数学函数等
+// 引入必要的头文件：Qt调试、线程同步、并行计算、标准算法、数学函数等
 #include <QDebug>
+#include <QList>
 #include <QMutexLocker> // 用于自动加锁/解锁互斥锁，简化线程同步
+#include <QtConcurrent/QtConcurrentMap>
 
 #include <algorithm> // 标准算法库（如for_each、fill等）
 #include <cmath>     // 数学函数库（如sqrt、abs等）
@@ -29,15 +31,34 @@
 #include <iostream>  // 标准输入输出（调试用）
 #include <numeric>   // 数值算法（如累加等）
 
-// FFTW库的计划（plan）函数不是线程安全的，因此用全局互斥锁保护
-static QMutex s_fftwPlanningMutex;
+// FFTW库的计划（plan）函数不是线程安全的，计划统一由FftPlanCache创建和共享；
+// 执行计划是线程安全的，因此用fftw_execute_dft_r2c()/fftw_execute_dft_c2r()在各自的缓冲区上执行。
+// 音频特征是实数，因此使用实数FFT，频域数据只需保存一半（共轭对称）。
+// 同样大小的计划会被所有剪辑反复执行，因此用FFTW_MEASURE创建，只测量一次。
+static const unsigned kPlanFlags = FFTW_MEASURE;
+// 达到该帧数的序列先在降采样的包络上搜索（约5分钟@25fps），较短的序列直接按原始分辨率计算
+static const size_t kCoarseMinimumSize = 8192;
+// 包络的降采样倍数（每个包络点为连续kDecimation帧的和）
+static const size_t kDecimation = 8;
+// 降采样包络上保留的候选偏移量个数（按原始分辨率逐个细化）
+static const int kCandidateCount = 3;
+
+namespace {
+
+// 一个候选速度的对齐结果（用于并行搜索）
+struct SpeedCandidate
+{
+    double score;
+    int offset;
+};
+
+} // namespace
 
 // ------------------------------ 构造函数与析构函数 ------------------------------
 // 默认构造函数：初始化成员变量
 AlignmentArray::AlignmentArray()
-    : m_forwardBuf(nullptr)  // FFT正向变换缓冲区（复数数组）
-    , m_backwardBuf(nullptr) // FFT反向变换缓冲区（复数数组）
-    , m_autocorrelationMax(std::numeric_limits<double>::min()) // 自相关最大值（初始化为最小值）
+    : m_forwardBuf(nullptr) // FFT正向变换缓冲区（复数数组）
+    , m_energy(0.0)          // 归一化序列的能量（初始为0）
     , m_isTransformed(false) // 标记是否已完成FFT变换（初始未变换）
 {}
 
@@ -48,17 +69,11 @@ AlignmentArray::AlignmentArray(size_t minimum_size)
     init(minimum_size); // 初始化数组大小
 }
 
-// 析构函数：释放FFT相关资源（缓冲区和计划）
+// 析构函数：释放FFT缓冲区（计划由缓存管理，无需销毁）
 AlignmentArray::~AlignmentArray()
 {
-    QMutexLocker locker(&s_fftwPlanningMutex); // 加锁保护FFT资源释放（线程安全）
-    if (m_forwardBuf) {                        // 如果正向缓冲区存在
-        // 释放正向变换缓冲区，销毁正向计划
+    if (m_forwardBuf) { // 如果正向缓冲区存在
         fftw_free(reinterpret_cast<fftw_complex *>(m_forwardBuf));
-        fftw_destroy_plan(m_forwardPlan);
-        // 释放反向变换缓冲区，销毁反向计划
-        fftw_free(reinterpret_cast<fftw_complex *>(m_backwardBuf));
-        fftw_destroy_plan(m_backwardPlan);
     }
 }
 
@@ -68,20 +83,23 @@ void AlignmentArray::init(size_t minimumSize)
 {
     QMutexLocker locker(&m_transformMutex); // 加锁保护变换相关资源（线程安全）
     m_minimumSize = minimumSize;            // 保存最小大小
-    // 计算实际复数数组大小：用于FFT的数组长度（满足线性卷积的最小长度）
-    m_actualComplexSize = (minimumSize * 2) - 1;
+    // 较长的序列在降采样包络上做FFT，FFT大小和内存随之减少为1/kDecimation
+    m_decimation = minimumSize >= kCoarseMinimumSize ? kDecimation : 1;
+    size_t coarseSize = (minimumSize + m_decimation - 1) / m_decimation;
+    // 计算实际FFT数组大小：至少为线性相关所需的最小长度（2N-1），
+    // 并向上取整到只含小质因数的长度，FFTW对这种长度最快
+    m_actualSize = FftPlanCache::fastSize(int((coarseSize * 2) - 1));
+    m_complexSize = m_actualSize / 2 + 1;
 
     // 如果已有缓冲区，先释放旧资源
     if (m_forwardBuf) {
-        QMutexLocker locker(&s_fftwPlanningMutex); // 加锁保护FFT计划操作
         fftw_free(reinterpret_cast<fftw_complex *>(m_forwardBuf));
-        m_forwardBuf = nullptr;           // 置空指针，避免野指针
-        fftw_destroy_plan(m_forwardPlan); // 销毁正向计划
-        // 释放反向缓冲区和计划
-        fftw_free(reinterpret_cast<fftw_complex *>(m_backwardBuf));
-        m_backwardBuf = nullptr;
-        fftw_destroy_plan(m_backwardPlan);
+        m_forwardBuf = nullptr; // 置空指针，避免野指针
+        // 释放对计划的引用（大小可能改变）
+        m_forwardPlan.reset();
+        m_backwardPlan.reset();
     }
+    m_isTransformed = false;
 }
 
 // 设置音频特征数据：保存原始数据并标记未变换状态
@@ -95,60 +113,75 @@ void AlignmentArray::setValues(const std::vector<double> &values)
 // ------------------------------ 音频对齐核心算法 ------------------------------
 // 计算两个音频序列的时间偏移量（不考虑速度变化）
 // 参数：
-// - from：待对齐的音频序列
+// - from：待对齐的音频序列（必须与当前序列的最小大小相同）
 // - offset：输出参数，存储计算出的偏移量（帧单位）
 // 返回值：对齐质量（0-1，值越高对齐越准确）
+// 可以在多个线程中同时调用（每次调用使用各自的缓冲区）
 double AlignmentArray::calculateOffset(AlignmentArray &from, int *offset)
 {
-    // 1. 分配FFT相关资源（用于计算互相关）
-    s_fftwPlanningMutex.lock(); // 加锁保护FFT计划创建
-    // 分配复数缓冲区（用于存储互相关结果）
-    fftw_complex *buf = fftw_alloc_complex(m_actualComplexSize);
-    std::complex<double> *correlationBuf = reinterpret_cast<std::complex<double> *>(buf);
-    // 创建反向FFT计划（用于将频域互相关结果转换回时域）
-    fftw_plan correlationPlan
-        = fftw_plan_dft_1d(m_actualComplexSize, buf, buf, FFTW_BACKWARD, FFTW_ESTIMATE);
-    // 初始化缓冲区（填充0）
-    std::fill(correlationBuf, correlationBuf + m_actualComplexSize, std::complex<double>(0));
-    s_fftwPlanningMutex.unlock(); // 解锁
-
-    // 2. 确保当前序列和待对齐序列都已完成FFT变换（转换到频域）
+    // 1. 确保当前序列和待对齐序列都已完成FFT变换（转换到频域）
     transform();      // 当前序列（参考轨道）执行FFT
     from.transform(); // 待对齐序列执行FFT
+    Q_ASSERT(m_actualSize == from.m_actualSize);
 
-    // 3. 在频域计算互相关：当前序列的频域数据 × 待对齐序列的频域共轭
-    for (size_t i = 0; i < m_actualComplexSize; ++i) {
-        correlationBuf[i] = m_forwardBuf[i] * std::conj(from.m_forwardBuf[i]);
-    }
+    // 2. 分配互相关缓冲区：频域乘积（复数）和时域互相关序列（实数）
+    fftw_complex *spectrum = fftw_alloc_complex(m_complexSize);
+    double *correlation = fftw_alloc_real(m_actualSize);
+    std::complex<double> *spectrumBuf = reinterpret_cast<std::complex<double> *>(spectrum);
 
-    // 4. 执行反向FFT，将频域互相关结果转换回时域（得到互相关序列）
-    fftw_execute(correlationPlan);
+    // 3. 在频域计算包络的互相关：当前序列的频域数据 × 待对齐序列的频域共轭
+    for (size_t i = 0; i < m_complexSize; ++i) {
+        spectrumBuf[i] = m_forwardBuf[i] * std::conj(from.m_forwardBuf[i]);
+    }
 
-    // 5. 寻找互相关最大值对应的偏移量（即最佳对齐位置）
-    double max = 0; // 存储最大互相关值
-    for (size_t i = 0; i < m_actualComplexSize; ++i) {
-        double norm = std::norm(correlationBuf[i]); // 计算复数的模（互相关强度）
-        if (max < norm) {                           // 找到更大值时更新
-            *offset = i;                            // 记录当前索引（临时偏移量）
-            max = norm;                             // 更新最大值
+    // 4. 执行反向FFT，将频域互相关结果转换回时域（得到包络的互相关序列）
+    fftw_execute_dft_c2r(m_backwardPlan.data(), spectrum, correlation);
+
+    // 5. 找出互相关强度最大的几个候选偏移量（互不相邻），并转换为正负方向的偏移
+    QList<int> candidates;
+    for (int n = 0; n < kCandidateCount; ++n) {
+        double max = 0;
+        int best = -1;
+        for (size_t i = 0; i < m_actualSize; ++i) {
+            double norm = correlation[i] * correlation[i]; // 互相关强度（平方，正负相关都计入）
+            if (max < norm) {
+                best = i;
+                max = norm;
+            }
         }
+        if (best < 0)
+            break;
+        // 屏蔽已选的候选及其相邻点，避免下一个候选落在同一个峰上
+        for (int i = best - 1; i <= best + 1; ++i)
+            correlation[(i + m_actualSize) % m_actualSize] = 0;
+        if (2 * best > (int) m_actualSize)
+            best -= (int) m_actualSize; // 当索引超过一半长度时，转换为负偏移
+        candidates << best;
+        if (m_decimation == 1)
+            break; // 未降采样时最大值即为结果，无需细化
     }
 
-    // 6. 调整偏移量符号（将索引转换为实际时间偏移，支持正负方向）
-    if (2 * *offset > (int) m_actualComplexSize) {
-        *offset -= ((int) m_actualComplexSize); // 当索引超过一半长度时，转换为负偏移
+    // 6. 释放临时资源（计划由缓存管理）
+    fftw_free(spectrum);
+    fftw_free(correlation);
+
+    // 7. 在每个候选附近的窗口内按原始分辨率计算互相关，取最大值
+    // 对齐质量为皮尔逊相关系数的平方：互相关² / (参考序列能量 × 待对齐序列能量)
+    double max = 0;
+    *offset = 0;
+    const int radius = m_decimation == 1 ? 0 : (int) m_decimation;
+    for (int candidate : candidates) {
+        const int center = candidate * (int) m_decimation;
+        for (int lag = center - radius; lag <= center + radius; ++lag) {
+            double c = correlate(from, lag);
+            if (max < c * c) {
+                max = c * c;
+                *offset = lag;
+            }
+        }
     }
-
-    // 7. 释放临时资源
-    s_fftwPlanningMutex.lock();
-    fftw_free(correlationBuf);          // 释放互相关缓冲区
-    fftw_destroy_plan(correlationPlan); // 销毁互相关计划
-    s_fftwPlanningMutex.unlock();
-
-    // 8. 归一化对齐质量（皮尔逊相关系数）
-    // 公式：max(互相关) / (sqrt(参考序列自相关最大值) × sqrt(待对齐序列自相关最大值))
-    double correlationCoefficient = sqrt(m_autocorrelationMax) * sqrt(from.m_autocorrelationMax);
-    return max / correlationCoefficient; // 返回归一化后的对齐质量（0-1）
+    double energy = m_energy * from.m_energy;
+    return energy > 0.0 ? max / energy : 0.0; // 返回归一化后的对齐质量（0-1）
 }
 
 // 计算两个音频序列的时间偏移量和速度补偿（考虑速度变化）
@@ -174,91 +207,99 @@ double AlignmentArray::calculateOffsetAndSpeed(AlignmentArray &from,
     int bestOffset = 0;
     double bestScore = calculateOffset(from, &bestOffset);
 
-    // 2. 创建用于拉伸音频的临时数组
-    AlignmentArray stretched(m_minimumSize);
-    // 速度搜索范围（基于初始值±speedRange）
+    // 2. 速度搜索范围（基于初始值±speedRange）
     double speedMin = bestSpeed - speedRange;
     double speedMax = bestSpeed + speedRange;
+    const std::vector<double> &fromValues = from.m_values;
 
     // 3. 多轮搜索：逐步减小步长，精细化速度补偿值
     while (speedStep > (minimumSpeedStep / 10)) { // 步长足够小时停止（比最小步长小10倍）
-        // 在当前速度范围内搜索（以当前步长遍历）
+        // 收集当前速度范围内的候选速度（以当前步长遍历）
+        QList<double> speeds;
         for (double s = speedMin; s <= speedMax; s += speedStep) {
-            if (s == bestSpeed) {
-                continue; // 跳过已计算过的最佳速度
+            if (s != bestSpeed) {
+                speeds << s; // 跳过已计算过的最佳速度
             }
+        }
 
-            // 4. 模拟速度变化：拉伸/压缩待对齐序列的音频特征
+        // 4. 各候选速度相互独立，在线程池中并行计算（每个候选使用自己的拉伸数组）
+        const QList<SpeedCandidate> candidates = QtConcurrent::blockingMapped<
+            QList<SpeedCandidate>>(speeds, [&](double s) {
+            // 模拟速度变化：拉伸/压缩待对齐序列的音频特征
             double factor = 1.0 / s; // 拉伸因子（速度越小，拉伸越长）
             // 计算拉伸后的序列长度
-            size_t stretchedSize = std::floor((double) from.m_values.size() * factor);
+            size_t stretchedSize = std::floor((double) fromValues.size() * factor);
             std::vector<double> strechedValues(stretchedSize); // 存储拉伸后的特征值
 
-            // 5. 最近邻插值：快速实现序列拉伸（简单但高效）
+            // 最近邻插值：快速实现序列拉伸（简单但高效）
             for (size_t i = 0; i < stretchedSize; i++) {
-                // 根据速度计算原序列中的对应索引（四舍五入取最近点）
-                size_t srcIndex = std::round(s * i);
-                strechedValues[i] = from.m_values[srcIndex]; // 复制特征值
+                // 根据速度计算原序列中的对应索引（四舍五入取最近点，不超过末尾）
+                size_t srcIndex = std::min<size_t>(std::round(s * i), fromValues.size() - 1);
+                strechedValues[i] = fromValues[srcIndex]; // 复制特征值
             }
 
-            // 6. 计算拉伸后序列与参考序列的偏移量和对齐质量
-            stretched.setValues(strechedValues);               // 设置拉伸后的特征值
-            double score = calculateOffset(stretched, offset); // 计算对齐质量
+            // 计算拉伸后序列与参考序列的偏移量和对齐质量
+            AlignmentArray stretched(m_minimumSize);
+            stretched.setValues(strechedValues);
+            SpeedCandidate candidate;
+            candidate.score = calculateOffset(stretched, &candidate.offset);
+            return candidate;
+        });
 
-            // 7. 更新最佳参数（如果当前质量更高）
-            if (score > bestScore) {
-                bestScore = score;    // 更新最佳质量
-                bestSpeed = s;        // 更新最佳速度
-                bestOffset = *offset; // 更新最佳偏移量
+        // 5. 按候选顺序更新最佳参数（与逐个计算的结果一致）
+        for (int i = 0; i < candidates.size(); ++i) {
+            if (candidates[i].score > bestScore) {
+                bestScore = candidates[i].score;   // 更新最佳质量
+                bestSpeed = speeds[i];             // 更新最佳速度
+                bestOffset = candidates[i].offset; // 更新最佳偏移量
             }
         }
 
-        // 8. 缩小搜索步长（精细化搜索），并缩小搜索范围（聚焦最佳速度附近）
+        // 6. 缩小搜索步长（精细化搜索），并缩小搜索范围（聚焦最佳速度附近）
         speedStep /= 10;
         speedMin = bestSpeed - (speedStep * 5); // 新范围：最佳速度±5个步长
         speedMax = bestSpeed + (speedStep * 5);
     }
 
-    // 9. 输出最佳参数并返回对齐质量
+    // 7. 输出最佳参数并返回对齐质量
     *speed = bestSpeed;   // 速度补偿值
     *offset = bestOffset; // 时间偏移量
     return bestScore;     // 对齐质量
 }
 
-// 执行FFT变换：将时域音频特征转换为频域，并计算自相关最大值
+// 按原始分辨率计算互相关：sum(当前序列[n + lag] × 待对齐序列[n])
+double AlignmentArray::correlate(const AlignmentArray &from, int lag) const
+{
+    const std::vector<double> &x = m_normalized;
+    const std::vector<double> &y = from.m_normalized;
+    // 只累加两个序列重叠的部分
+    const long long begin = std::max<long long>(0, -lag);
+    const long long end = std::min<long long>((long long) y.size(), (long long) x.size() - lag);
+    double sum = 0.0;
+    for (long long n = begin; n < end; ++n) {
+        sum += x[n + lag] * y[n];
+    }
+    return sum;
+}
+
+// 执行FFT变换：将归一化的时域音频特征降采样为包络并转换为频域
 void AlignmentArray::transform()
 {
     QMutexLocker locker(&m_transformMutex); // 加锁保护变换过程（线程安全）
     if (!m_isTransformed) {                 // 如果尚未变换或数据已更新，执行变换
         // 1. 初始化FFT资源（缓冲区和计划）
         if (!m_forwardBuf) {
-            s_fftwPlanningMutex.lock(); // 加锁保护FFT计划创建（线程安全）
-            fftw_complex *buf = nullptr;
-
-            // 分配正向变换缓冲区并创建计划（时域→频域）
-            buf = fftw_alloc_complex(m_actualComplexSize);
+            // 分配正向变换缓冲区（实数FFT只需一半加一个复数）
+            fftw_complex *buf = fftw_alloc_complex(m_complexSize);
             m_forwardBuf = reinterpret_cast<std::complex<double> *>(buf); // 转换为C++复数指针
-            m_forwardPlan = fftw_plan_dft_1d(m_actualComplexSize,
-                                             buf,
-                                             buf,
-                                             FFTW_FORWARD,
-                                             FFTW_ESTIMATE); // 正向计划
-
-            // 分配反向变换缓冲区并创建计划（频域→时域）
-            buf = fftw_alloc_complex(m_actualComplexSize);
-            m_backwardBuf = reinterpret_cast<std::complex<double> *>(buf);
-            m_backwardPlan = fftw_plan_dft_1d(m_actualComplexSize,
-                                              buf,
-                                              buf,
-                                              FFTW_BACKWARD,
-                                              FFTW_ESTIMATE); // 反向计划
-
-            s_fftwPlanningMutex.unlock(); // 解锁
+            // 获取正向计划（时域→频域）和反向计划（频域→时域，用于互相关）
+            m_forwardPlan = FftPlanCache::realToComplex(m_actualSize, kPlanFlags);
+            m_backwardPlan = FftPlanCache::complexToReal(m_actualSize, kPlanFlags);
         }
 
-        // 2. 初始化缓冲区（填充0）
-        std::fill(m_forwardBuf, m_forwardBuf + m_actualComplexSize, std::complex<double>(0));
-        std::fill(m_backwardBuf, m_backwardBuf + m_actualComplexSize, std::complex<double>(0));
+        // 2. 分配时域输入缓冲区并初始化（填充0）
+        double *input = fftw_alloc_real(m_actualSize);
+        std::fill(input, input + m_actualSize, 0.0);
 
         // 3. 归一化原始音频特征值（减去均值，除以标准差，消除音量差异影响）
         // 3.1 计算均值
@@ -273,31 +314,23 @@ void AlignmentArray::transform()
         });
         double stddev = sqrt(accum / (m_values.size() - 1)); // 标准差（样本标准差）
 
-        // 3.3 填充归一化后的数据到正向缓冲区（仅填充原始数据长度，剩余部分保持0）
-        for (size_t i = 0; i < m_values.size(); i++) {
-            m_forwardBuf[i] = (m_values[i] - mean) / stddev; // 归一化公式
+        // 3.3 保存归一化后的数据并累加能量，同时按块求和得到降采样包络（剩余部分保持0）
+        size_t count = std::min(m_values.size(), m_actualSize * m_decimation);
+        m_normalized.resize(count);
+        m_energy = 0.0;
+        for (size_t i = 0; i < count; i++) {
+            m_normalized[i] = (m_values[i] - mean) / stddev; // 归一化公式
+            m_energy += m_normalized[i] * m_normalized[i];
+            input[i / m_decimation] += m_normalized[i];
         }
 
-        // 4. 执行正向FFT：将时域数据转换为频域
-        fftw_execute(m_forwardPlan);
-
-        // 5. 计算自相关（频域中为功率谱：频域数据×自身共轭）
-        for (size_t i = 0; i < m_actualComplexSize; i++) {
-            m_backwardBuf[i] = m_forwardBuf[i] * std::conj(m_forwardBuf[i]);
-        }
-
-        // 6. 执行反向FFT：将频域自相关结果转换回时域
-        fftw_execute(m_backwardPlan);
-
-        // 7. 寻找自相关最大值（用于后续对齐质量归一化）
-        for (size_t i = 0; i < m_actualComplexSize; i++) {
-            double norm = std::norm(m_backwardBuf[i]); // 计算复数模（自相关强度）
-            if (norm > m_autocorrelationMax) {
-                m_autocorrelationMax = norm; // 更新最大值
-            }
-        }
+        // 4. 执行正向FFT：将包络转换为频域
+        fftw_execute_dft_r2c(m_forwardPlan.data(),
+                             input,
+                             reinterpret_cast<fftw_complex *>(m_forwardBuf));
+        fftw_free(input);
 
-        // 8. 标记变换完成
+        // 5. 标记变换完成
         m_isTransformed = true;
     }
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022 Meltytech, LLC
+ * Copyright (c) 2022-2026 Meltytech, LLC
  *
  * Author: André Caldas de Souza <andrecaldas@unb.br>
  *
@@ -23,18 +23,22 @@
 
 // 引入依赖头文件
 #include <complex> // C++标准复数库，处理FFT复数运算
+#include "fftplancache.h" // 共享的FFTW计划缓存（线程安全）
+
 #include <fftw3.h> // FFTW库头文件，提供快速傅里叶变换功能
 #include <vector>  // C++动态数组，存储音频特征数据
 #include <QMutex>  // Qt互斥锁，用于多线程安全
 
 // 音频对齐数据数组类：用于存储音频特征，通过FFT计算对齐参数（偏移量、速度）
+// 对较长的序列分两级搜索：先用降采样的包络做FFT互相关找出候选偏移量，
+// 再在每个候选附近的小窗口内按原始分辨率直接计算互相关
 class AlignmentArray
 {
 public:
     // 构造函数与析构函数
     AlignmentArray();                    // 默认构造函数：初始化成员变量
     AlignmentArray(size_t minimum_size); // 带参构造函数：指定最小数组大小并初始化
-    virtual ~AlignmentArray(); // 虚析构函数：释放FFT相关资源（避免内存泄漏）
+    virtual ~AlignmentArray(); // 虚析构函数：释放FFT缓冲区（避免内存泄漏）
 
     // 公共成员函数（外部调用接口）
     void init(size_t minimum_size); // 初始化：设置数组大小，释放旧资源
@@ -49,17 +53,21 @@ public:
 
 private:
     // 私有成员函数（内部逻辑实现）
-    void transform(); // 执行FFT变换：时域→频域，计算自相关最大值
+    void transform(); // 执行FFT变换：时域→频域，保存归一化的序列与能量
+    // 按原始分辨率计算偏移量为lag时与from的互相关（时域直接计算）
+    double correlate(const AlignmentArray &from, int lag) const;
 
     // 私有成员变量（数据存储与状态管理）
     std::vector<double> m_values;        // 原始音频特征数据（如每帧音量平均值）
-    fftw_plan m_forwardPlan;             // FFT正向计划（时域→频域）
-    std::complex<double> *m_forwardBuf;  // 正向变换缓冲区（存储频域数据）
-    fftw_plan m_backwardPlan;            // FFT反向计划（频域→时域）
-    std::complex<double> *m_backwardBuf; // 反向变换缓冲区（存储自相关结果）
-    double m_autocorrelationMax;         // 自相关最大值（用于对齐质量归一化）
+    std::vector<double> m_normalized;    // 归一化后的特征数据（减去均值，除以标准差）
+    FftPlanCache::Plan m_forwardPlan;    // 实数到复数的FFT正向计划（时域→频域，来自共享缓存）
+    std::complex<double> *m_forwardBuf;  // 正向变换缓冲区（存储降采样包络的频域数据，m_complexSize个）
+    FftPlanCache::Plan m_backwardPlan;   // 复数到实数的FFT反向计划（频域→时域，来自共享缓存）
+    double m_energy;                     // 归一化序列的能量（零延迟自相关，用于对齐质量归一化）
     size_t m_minimumSize;                // 初始化时指定的最小数组大小
-    size_t m_actualComplexSize;          // 实际FFT复数数组大小（由minimumSize计算）
+    size_t m_decimation;                 // 包络的降采样倍数（较短的序列为1，即不降采样）
+    size_t m_actualSize;                 // 实际FFT实数数组大小（由降采样后的minimumSize计算）
+    size_t m_complexSize;                // 实数FFT的复数结果大小（m_actualSize / 2 + 1）
     bool m_isTransformed;    // 变换状态标记（true=已完成FFT，无需重复执行）
     QMutex m_transformMutex; // 变换互斥锁（保护多线程下的变换操作）
 };
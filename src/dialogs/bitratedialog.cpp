@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2024 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -24,9 +24,7 @@
 
 // 引入Qt基础组件和图表相关头文件
 #include <QDialogButtonBox>
-#include <QJsonObject>
 #include <QPushButton>
-#include <QQueue>
 #include <QScrollArea>
 #include <QVBoxLayout>
 #include <QtCharts/QBarCategoryAxis>
@@ -41,178 +39,170 @@
 // 【静态常量】滑动窗口大小（用于计算平滑平均值，窗口内包含30个数据点）
 static const auto kSlidingWindowSize = 30;
 
+//【加入一个数据包】
+// 按1秒为周期累加比特率，每满1秒汇总一个周期
+void BitrateData::addPacket(double pts, double duration, double size, bool isKey)
+{
+    // 计算当前数据包的比特率（size为字节，转换为Kb：字节×8/1000）
+    size = size * 8.0 / 1000.0;
+
+    // 1. 校准时间（以第一个数据包为起点，计算相对时间）
+    if (pts > 0.0) {
+        m_absoluteTime = pts + qMax(0.0, duration); // 结束时间 = 时间戳 + 时长（确保非负）
+    }
+    if (!m_hasPackets) {
+        m_hasPackets = true;
+        m_firstTime = m_absoluteTime; // 记录第一个数据包的时间（作为基准）
+        minKbps = std::numeric_limits<double>().max();
+    }
+    time = m_absoluteTime - m_firstTime; // 转换为相对时间（从0开始）
+
+    // 2. 累加关键帧/非关键帧的比特率
+    if (isKey) {
+        m_keySubtotal += size;
+    } else {
+        m_interSubtotal += size;
+    }
+    totalKbps += size; // 累加总比特率
+    m_isPeriodOpen = true;
+
+    // 3. 每满1秒汇总一个周期
+    if (time >= (m_previousSecond + 1.0))
+        addPeriod();
+}
+
+//【结束数据】最后一个数据包所在的周期即使不满1秒也汇总
+void BitrateData::finish()
+{
+    if (m_isPeriodOpen)
+        addPeriod();
+}
+
+void BitrateData::addPeriod()
+{
+    // 计算当前周期的总比特率（关键帧+非关键帧）
+    auto kbps = m_interSubtotal + m_keySubtotal;
+    // 更新最小/最大比特率
+    if (kbps < minKbps)
+        minKbps = kbps;
+    if (kbps > maxKbps)
+        maxKbps = kbps;
+
+    // 为每个周期添加柱状图数据（处理跨多秒的情况，如一个数据包占2秒则添加2个柱）
+    int n = qMax(1, int(time - m_previousSecond)); // 周期数（至少1个）
+    for (int j = 0; j < n; ++j) {
+        interKbps.append(m_interSubtotal);
+        keyKbps.append(m_keySubtotal);
+    }
+
+    // 计算滑动平均比特率（用最近kSlidingWindowSize个周期的数据）
+    while (m_window.size() >= kSlidingWindowSize) {
+        m_window.dequeue(); // 窗口满时，移除最早的数据点
+    }
+    m_window.enqueue(kbps); // 添加当前周期的比特率到窗口
+    double sum = 0.0;
+    for (auto &v : m_window)
+        sum += v; // 计算窗口内数据总和
+    // X轴坐标偏移0.5：使曲线与柱状图中心对齐（柱状图中心在整数秒位置）
+    averages.append(QPointF(time - 0.5, sum / m_window.size()));
+
+    // 重置周期计数器，更新当前周期的起始秒数
+    m_interSubtotal = 0.0;
+    m_keySubtotal = 0.0;
+    m_isPeriodOpen = false;
+    m_previousSecond = std::floor(time); // 取当前时间的整数部分（如2.3→2）
+}
+
 //【构造函数：初始化比特率查看对话框】
 // 参数说明：
 // - resource：资源名称（如视频/音频文件路径，用于显示在标题）
 // - fps：帧率（>0表示视频，=0表示音频）
-// - data：比特率数据数组（JSON格式，包含每帧/每段的时间、时长、大小等信息）
+// - data：按秒汇总的比特率数据
 // - parent：父窗口指针
 BitrateDialog::BitrateDialog(const QString &resource,
                              double fps,
-                             const QJsonArray &data,
+                             const BitrateData &data,
                              QWidget *parent)
     : QDialog(parent)
+    , m_resource(resource)
+    , m_interSet(nullptr)
+    , m_periodCount(0)
+    , m_averageCount(0)
 {
     // 1. 对话框基础设置
     setMinimumSize(400, 200);             // 设置最小尺寸
-    setModal(true);                       // 模态对话框（阻塞父窗口操作）
     setWindowTitle(tr("Bitrate Viewer")); // 设置窗口标题（比特率查看器）
     setSizeGripEnabled(true);             // 启用右下角大小调整手柄
 
-    // 2. 初始化统计变量（用于计算比特率相关指标）
-    double time = 0.0;          // 当前累计时间（秒）
-    double maxSize = 0.0;       // 最大数据大小（未实际使用）
-    double firstTime = 0.0;     // 第一个数据点的时间（用于时间偏移校准）
-    double keySubtotal = 0.0;   // 关键帧（I帧）累计比特率（Kb）
-    double interSubtotal = 0.0; // 非关键帧（P/B帧）累计比特率（Kb）
-    double totalKbps = 0.0;     // 总比特率（Kb）
-    double minKbps = std::numeric_limits<double>().max(); // 最小每秒比特率（初始为最大值）
-    double maxKbps = 0.0;                                 // 最大每秒比特率（初始为0）
-    int periodCount = 0;         // 周期计数（每个周期为1秒，用于图表X轴）
-    double previousSecond = 0.0; // 上一个周期的起始秒数（用于划分1秒周期）
-
-    // 3. 初始化图表组件
-    QQueue<double> window; // 滑动窗口队列（存储最近30个周期的比特率）
+    // 2. 初始化图表组件
     auto barSeries = new QStackedBarSeries; // 堆叠柱状图系列（显示I帧和P/B帧比特率）
-    auto averageLine = new QSplineSeries;   // 平滑曲线系列（显示滑动平均比特率）
-    QBarSet *interSet = nullptr;            // 非关键帧（P/B帧）数据组（视频专用）
+    m_averageLine = new QSplineSeries;      // 平滑曲线系列（显示滑动平均比特率）
     // 关键帧（I帧）数据组：视频显示"I"，音频显示"Audio"
-    auto keySet = new QBarSet(fps > 0.0 ? "I" : tr("Audio"));
+    m_keySet = new QBarSet(fps > 0.0 ? "I" : tr("Audio"));
 
-    // 4. 配置柱状图属性
+    // 3. 配置柱状图属性
     barSeries->setBarWidth(1.0); // 设置柱宽为1.0（占满整个周期）
     if (fps > 0.0) {             // 如果是视频（有帧率），添加P/B帧数据组
-        interSet = new QBarSet("P/B");
-        barSeries->append(interSet);
-    }
-    barSeries->append(keySet);           // 添加I帧/音频数据组到柱状图
-    averageLine->setName(tr("Average")); // 设置平均曲线名称
-
-    // 5. 解析比特率数据（遍历JSON数组，计算每个周期的比特率）
-    for (int i = 0; i < data.size(); ++i) {
-        auto o = data[i].toObject();                    // 取当前数据点（JSON对象）
-        auto pts = o["pts_time"].toString().toDouble(); // 当前数据点的时间戳（秒）
-        auto duration = o["duration_time"].toString().toDouble(); // 数据点时长（秒）
-        // 计算当前数据点的比特率（size为字节，转换为Kb：字节×8/1000）
-        auto size = o["size"].toString().toDouble() * 8.0 / 1000.0;
-
-        // 5.1 校准时间（以第一个数据点为起点，计算相对时间）
-        if (pts > 0.0) {
-            time = pts + qMax(0.0, duration); // 累计时间 = 时间戳 + 时长（确保非负）
-        }
-        if (i == 0) {
-            firstTime = time; // 记录第一个数据点的时间（作为基准）
-        }
-        time -= firstTime; // 转换为相对时间（从0开始）
-
-        // 5.2 累加关键帧/非关键帧的比特率
-        if (o["flags"].toString()[0] == 'K') { // 标记为"K"表示关键帧（I帧）
-            keySubtotal += size;
-        } else { // 非关键帧（P/B帧）
-            interSubtotal += size;
-        }
-        totalKbps += size; // 累加总比特率
-
-        // 5.3 按1秒为周期，更新图表数据（每满1秒或到最后一个数据点时执行）
-        if (time >= (previousSecond + 1.0) || (i + 1) == data.size()) {
-            // 计算当前周期的总比特率（关键帧+非关键帧）
-            auto kbps = interSubtotal + keySubtotal;
-            // 更新最小/最大比特率
-            if (kbps < minKbps)
-                minKbps = kbps;
-            if (kbps > maxKbps)
-                maxKbps = kbps;
-
-            // 为每个周期添加柱状图数据（处理跨多秒的情况，如一个数据点占2秒则添加2个柱）
-            int n = qMax(1, int(time - previousSecond)); // 周期数（至少1个）
-            for (int j = 0; j < n; ++j) {
-                if (interSet)
-                    interSet->append(interSubtotal); // 添加P/B帧数据（视频）
-                keySet->append(keySubtotal);         // 添加I帧/音频数据
-                ++periodCount;                       // 递增周期计数
-            }
-
-            // 5.4 计算滑动平均比特率（用最近30个周期的数据）
-            while (window.size() >= kSlidingWindowSize) {
-                window.dequeue(); // 窗口满时，移除最早的数据点
-            }
-            window.enqueue(kbps); // 添加当前周期的比特率到窗口
-            double sum = 0.0;
-            for (auto &v : window)
-                sum += v; // 计算窗口内数据总和
-            // X轴坐标偏移0.5：使曲线与柱状图中心对齐（柱状图中心在整数秒位置）
-            averageLine->append(time - 0.5, sum / window.size());
-
-            // 5.5 重置周期计数器，更新上一个周期的起始秒数
-            interSubtotal = 0.0;
-            keySubtotal = 0.0;
-            previousSecond = std::floor(time); // 取当前时间的整数部分（如2.3→2）
-        }
+        m_interSet = new QBarSet("P/B");
+        barSeries->append(m_interSet);
     }
+    barSeries->append(m_keySet);           // 添加I帧/音频数据组到柱状图
+    m_averageLine->setName(tr("Average")); // 设置平均曲线名称
 
-    // 6. 配置图表（QChart）
-    auto chart = new QChart();
-    chart->addSeries(barSeries);   // 添加柱状图系列
-    chart->addSeries(averageLine); // 添加平均曲线系列
+    // 4. 配置图表（QChart）
+    m_chart = new QChart();
+    m_chart->addSeries(barSeries);     // 添加柱状图系列
+    m_chart->addSeries(m_averageLine); // 添加平均曲线系列
     // 根据配置的主题设置图表主题（深色/浅色）
-    chart->setTheme(Settings.theme() == "dark" ? QChart::ChartThemeDark : QChart::ChartThemeLight);
-    averageLine->setColor(Qt::yellow); // 设置平均曲线颜色为黄色
-    // 设置图表标题：显示资源名称、平均/最小/最大比特率（四舍五入为整数）
-    chart->setTitle(tr("Bitrates for %1 ~~ Avg. %2 Min. %3 Max. %4 Kb/s")
-                        .arg(resource)
-                        .arg(qRound(totalKbps / time))
-                        .arg(qRound(minKbps))
-                        .arg(qRound(maxKbps)));
-
-    // 7. 配置X轴（时间轴，单位：秒）
-    auto axisX = new QValueAxis();
-    chart->addAxis(axisX, Qt::AlignBottom);       // X轴在底部
-    barSeries->attachAxis(axisX);                 // 柱状图关联X轴
-    averageLine->attachAxis(axisX);               // 平均曲线关联X轴
-    axisX->setRange(0.0, time);                   // X轴范围：0到总相对时间
-    axisX->setLabelFormat("%.0f s");              // 标签格式：整数秒（如"5 s"）
-    axisX->setTickType(QValueAxis::TicksDynamic); // 动态生成刻度
-    // 周期数>100时，刻度间隔为10秒；否则为5秒（避免刻度过于密集）
-    axisX->setTickInterval(periodCount > 100 ? 10.0 : 5.0);
-
-    // 8. 配置Y轴（比特率轴，单位：Kb/s）
-    QValueAxis *axisY = new QValueAxis();
-    chart->addAxis(axisY, Qt::AlignLeft); // Y轴在左侧
-    barSeries->attachAxis(axisY);         // 柱状图关联Y轴
-    averageLine->attachAxis(axisY);       // 平均曲线关联Y轴
-    axisY->setRange(0.0, maxKbps);        // Y轴范围：0到最大比特率
-    axisY->setLabelFormat("%.0f Kb/s");   // 标签格式：整数Kb/s（如"1000 Kb/s"）
-
-    // 9. 配置图表图例
-    chart->legend()->setVisible(true);              // 显示图例
-    chart->legend()->setAlignment(Qt::AlignBottom); // 图例在底部
-
-    // 10. 配置图表视图（QChartView）
-    QChartView *chartView = new QChartView(chart);
-    chartView->setRenderHint(QPainter::Antialiasing); // 启用抗锯齿（使图表更清晰）
-
-    // 11. 配置对话框布局
+    m_chart->setTheme(Settings.theme() == "dark" ? QChart::ChartThemeDark
+                                                 : QChart::ChartThemeLight);
+    m_averageLine->setColor(Qt::yellow); // 设置平均曲线颜色为黄色
+
+    // 5. 配置X轴（时间轴，单位：秒）
+    m_axisX = new QValueAxis();
+    m_chart->addAxis(m_axisX, Qt::AlignBottom);     // X轴在底部
+    barSeries->attachAxis(m_axisX);                 // 柱状图关联X轴
+    m_averageLine->attachAxis(m_axisX);             // 平均曲线关联X轴
+    m_axisX->setLabelFormat("%.0f s");              // 标签格式：整数秒（如"5 s"）
+    m_axisX->setTickType(QValueAxis::TicksDynamic); // 动态生成刻度
+
+    // 6. 配置Y轴（比特率轴，单位：Kb/s）
+    m_axisY = new QValueAxis();
+    m_chart->addAxis(m_axisY, Qt::AlignLeft); // Y轴在左侧
+    barSeries->attachAxis(m_axisY);           // 柱状图关联Y轴
+    m_averageLine->attachAxis(m_axisY);       // 平均曲线关联Y轴
+    m_axisY->setLabelFormat("%.0f Kb/s");     // 标签格式：整数Kb/s（如"1000 Kb/s"）
+
+    // 7. 配置图表图例
+    m_chart->legend()->setVisible(true);              // 显示图例
+    m_chart->legend()->setAlignment(Qt::AlignBottom); // 图例在底部
+
+    // 8. 配置图表视图（QChartView）
+    m_chartView = new QChartView(m_chart);
+    m_chartView->setRenderHint(QPainter::Antialiasing); // 启用抗锯齿（使图表更清晰）
+
+    // 9. 配置对话框布局
     setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed); // 水平可扩展，垂直固定
     auto layout = new QVBoxLayout(this);
     layout->setContentsMargins(0, 0, 8, 8); // 布局边距（上0，右8，下8，左0）
     layout->setSpacing(8);                  // 控件间距8像素
     // 添加滚动区域（当图表过宽时可横向滚动）
     auto scrollArea = new QScrollArea(this);
-    scrollArea->setWidget(chartView); // 滚动区域内容为图表视图
+    scrollArea->setWidget(m_chartView); // 滚动区域内容为图表视图
     layout->addWidget(scrollArea);
     // 添加按钮组（保存、关闭）
     auto buttons = new QDialogButtonBox(QDialogButtonBox::Save | QDialogButtonBox::Close, this);
     buttons->button(QDialogButtonBox::Close)->setDefault(true); // "关闭"按钮设为默认
     layout->addWidget(buttons);
 
-    // 12. 连接按钮信号与槽函数
+    // 10. 连接按钮信号与槽函数
     // "保存"按钮：将图表保存为图片（通过SaveImageDialog）
     connect(buttons, &QDialogButtonBox::accepted, this, [=] {
         // 创建与图表视图大小相同的图片（RGB32格式）
-        QImage image(chartView->size(), QImage::Format_RGB32);
+        QImage image(m_chartView->size(), QImage::Format_RGB32);
         QPainter painter(&image);
         painter.setRenderHint(QPainter::Antialiasing); // 抗锯齿绘制
-        chartView->render(&painter);                   // 将图表视图内容绘制到图片
+        m_chartView->render(&painter);                 // 将图表视图内容绘制到图片
         painter.end();
         // 打开保存图片对话框，执行保存
         SaveImageDialog(this, tr("Save Bitrate Graph"), image).exec();
@@ -220,9 +210,46 @@ BitrateDialog::BitrateDialog(const QString &resource,
     // "关闭"按钮：关闭对话框
     connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::reject);
 
-    // 13. 配置图表视图大小
-    chartView->setMinimumWidth(qMax(1010, periodCount * 5)); // 最小宽度：取1010或周期数×5的较大值
-    chartView->setMinimumHeight(520);                        // 最小高度520像素
+    // 11. 填充数据并配置图表视图大小
+    m_chartView->setMinimumHeight(520); // 最小高度520像素
+    updateData(data);
     resize(1024, 576); // 对话框初始大小（1024×576像素）
-    show();            // 显示对话框
+}
+
+//【刷新图表】只追加新增的周期，已显示的数据不再重建
+void BitrateDialog::updateData(const BitrateData &data)
+{
+    // 1. 追加新增周期的柱状图数据
+    QList<double> keyValues;
+    QList<double> interValues;
+    for (int i = m_periodCount; i < data.keyKbps.size(); ++i) {
+        keyValues << data.keyKbps[i];
+        interValues << data.interKbps[i];
+    }
+    m_keySet->append(keyValues); // 添加I帧/音频数据
+    if (m_interSet)
+        m_interSet->append(interValues); // 添加P/B帧数据（视频）
+    m_periodCount = data.keyKbps.size();
+
+    // 2. 追加新增的平均曲线数据点
+    if (m_averageCount < data.averages.size()) {
+        m_averageLine->append(data.averages.mid(m_averageCount));
+        m_averageCount = data.averages.size();
+    }
+
+    // 3. 设置图表标题：显示资源名称、平均/最小/最大比特率（四舍五入为整数）
+    m_chart->setTitle(tr("Bitrates for %1 ~~ Avg. %2 Min. %3 Max. %4 Kb/s")
+                          .arg(m_resource)
+                          .arg(data.time > 0.0 ? qRound(data.totalKbps / data.time) : 0)
+                          .arg(qRound(m_periodCount > 0 ? data.minKbps : 0.0))
+                          .arg(qRound(data.maxKbps)));
+
+    // 4. 更新坐标轴范围
+    m_axisX->setRange(0.0, data.time); // X轴范围：0到总相对时间
+    // 周期数>100时，刻度间隔为10秒；否则为5秒（避免刻度过于密集）
+    m_axisX->setTickInterval(m_periodCount > 100 ? 10.0 : 5.0);
+    m_axisY->setRange(0.0, data.maxKbps); // Y轴范围：0到最大比特率
+
+    // 5. 图表视图宽度随周期数增加：取1010或周期数×5的较大值
+    m_chartView->setMinimumWidth(qMax(1010, m_periodCount * 5));
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,26 +20,80 @@
 #define BITRATEDIALOG_H
 
 // 引入依赖的Qt头文件
-#include <QDialog>    // Qt标准对话框类，BitrateDialog继承自此
-#include <QJsonArray> // Qt的JSON数组类，用于接收比特率数据
-#include <QString>    // Qt字符串类，用于接收资源名称
+#include <QDialog>  // Qt标准对话框类，BitrateDialog继承自此
+#include <QPointF>  // Qt点类，用于平均曲线的数据点
+#include <QQueue>   // Qt队列类，用于滑动窗口
+#include <QString>  // Qt字符串类，用于接收资源名称
+#include <QVector>  // Qt向量类，用于按秒存储比特率
+
+class QBarSet;
+class QChart;
+class QChartView;
+class QSplineSeries;
+class QValueAxis;
+
+// 比特率数据类：逐个接收数据包，按1秒为周期汇总比特率
+// 数据包随ffprobe的输出逐行加入，无需保存全部数据包
+class BitrateData
+{
+public:
+    // 加入一个数据包：pts和duration单位为秒，size单位为字节，isKey表示关键帧
+    void addPacket(double pts, double duration, double size, bool isKey);
+    // 结束数据：将最后一个未满1秒的周期加入汇总
+    void finish();
+
+    QVector<double> keyKbps;   // 每个周期关键帧（I帧）或音频的比特率（Kb）
+    QVector<double> interKbps; // 每个周期非关键帧（P/B帧）的比特率（Kb）
+    QVector<QPointF> averages; // 滑动平均比特率曲线的数据点
+    double time = 0.0;         // 当前累计相对时间（秒）
+    double totalKbps = 0.0;    // 总比特率（Kb）
+    double minKbps = 0.0;      // 最小每秒比特率
+    double maxKbps = 0.0;      // 最大每秒比特率
+
+private:
+    void addPeriod();
+
+    bool m_hasPackets = false;     // 是否已收到数据包
+    bool m_isPeriodOpen = false;   // 当前周期是否有未汇总的数据包
+    double m_firstTime = 0.0;      // 第一个数据包的时间（用于时间偏移校准）
+    double m_absoluteTime = 0.0;   // 最近一个数据包的结束时间
+    double m_keySubtotal = 0.0;    // 当前周期关键帧累计比特率（Kb）
+    double m_interSubtotal = 0.0;  // 当前周期非关键帧累计比特率（Kb）
+    double m_previousSecond = 0.0; // 当前周期的起始秒数
+    QQueue<double> m_window;       // 滑动窗口队列（存储最近的周期比特率）
+};
 
 // 比特率查看对话框类：用于展示音频/视频文件的比特率变化图表
 class BitrateDialog : public QDialog
 {
-    Q_OBJECT // Qt元对象系统宏，支持信号槽等Qt特性（此处虽未显式用信号槽，符合类设计规范）
-
-        public :
-        // 构造函数：初始化比特率查看对话框
-        // 参数说明：
-        // - resource：待查看的资源名称（如音频/视频文件路径，用于图表标题）
-        // - fps：帧率（>0表示视频，=0表示音频，用于区分图表数据类型）
-        // - data：比特率原始数据（JSON数组格式，包含每帧/每段的时间、时长、大小等信息）
-        // - parent：父窗口指针（默认nullptr，用于Qt对象树管理）
-        explicit BitrateDialog(const QString &resource,
-                               double fps,
-                               const QJsonArray &data,
-                               QWidget *parent = nullptr);
+    Q_OBJECT // Qt元对象系统宏，支持信号槽等Qt特性
+
+public:
+    // 构造函数：初始化比特率查看对话框
+    // 参数说明：
+    // - resource：待查看的资源名称（如音频/视频文件路径，用于图表标题）
+    // - fps：帧率（>0表示视频，=0表示音频，用于区分图表数据类型）
+    // - data：按秒汇总的比特率数据（可以仍在增长，随后用updateData()刷新）
+    // - parent：父窗口指针（默认nullptr，用于Qt对象树管理）
+    explicit BitrateDialog(const QString &resource,
+                           double fps,
+                           const BitrateData &data,
+                           QWidget *parent = nullptr);
+
+    // 刷新图表：只追加上次刷新之后新增的周期，并更新坐标轴和标题
+    void updateData(const BitrateData &data);
+
+private:
+    QString m_resource;
+    QBarSet *m_keySet;
+    QBarSet *m_interSet;
+    QSplineSeries *m_averageLine;
+    QChart *m_chart;
+    QValueAxis *m_axisX;
+    QValueAxis *m_axisY;
+    QChartView *m_chartView;
+    int m_periodCount;  // 已显示的周期数
+    int m_averageCount; // 已显示的平均曲线数据点数
 };
 
 // 结束头文件保护宏
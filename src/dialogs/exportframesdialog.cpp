@@ -0,0 +1,290 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "exportframesdialog.h"
+
+#include "docks/timelinedock.h"
+#include "mainwindow.h"
+#include "mltcontroller.h"
+#include "models/markersmodel.h"
+#include "models/multitrackmodel.h"
+#include "qmltypes/qmlapplication.h"
+#include "settings.h"
+#include "util.h"
+
+#include <MltProducer.h>
+#include <QComboBox>
+#include <QDialogButtonBox>
+#include <QDir>
+#include <QDoubleSpinBox>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QImageWriter>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QPushButton>
+#include <QRegularExpression>
+#include <QSet>
+#include <QStandardItemModel>
+
+#include <algorithm>
+
+enum {
+    SOURCE_MARKERS = 0,
+    SOURCE_CLIPS,
+    SOURCE_STRIDE,
+};
+
+static QString fileNameField(QString text)
+{
+    static const QRegularExpression invalid(QStringLiteral("[\\\\/:*?\"<>|\\s]+"));
+    return text.replace(invalid, "_");
+}
+
+ExportFramesDialog::ExportFramesDialog(Mlt::Producer *producer, bool isTimeline, QWidget *parent)
+    : QDialog(parent)
+    , m_producer(producer)
+{
+    int row = 0;
+    setWindowTitle(tr("Export Frames"));
+    setWindowModality(QmlApplication::dialogModality());
+
+    QGridLayout *glayout = new QGridLayout();
+    glayout->setHorizontalSpacing(4);
+    glayout->setVerticalSpacing(2);
+
+    glayout->addWidget(new QLabel(tr("Frames")), row, 0, Qt::AlignRight);
+    m_source = new QComboBox();
+    m_source->addItem(tr("At each marker"), SOURCE_MARKERS);
+    m_source->addItem(tr("At the start of each selected clip or clip of the current track"),
+                      SOURCE_CLIPS);
+    m_source->addItem(tr("At a regular interval"), SOURCE_STRIDE);
+    const bool hasMarkers = isTimeline
+                            && MAIN.timelineDock()->markersModel()->getMarkers().size() > 0;
+    auto model = qobject_cast<QStandardItemModel *>(m_source->model());
+    if (model) {
+        model->item(SOURCE_MARKERS)->setEnabled(hasMarkers);
+        model->item(SOURCE_CLIPS)->setEnabled(isTimeline);
+    }
+    m_source->setCurrentIndex(hasMarkers ? SOURCE_MARKERS
+                                         : (isTimeline ? SOURCE_CLIPS : SOURCE_STRIDE));
+    connect(m_source,
+            QOverload<int>::of(&QComboBox::activated),
+            this,
+            &ExportFramesDialog::rebuildList);
+    glayout->addWidget(m_source, row++, 1, Qt::AlignLeft);
+
+    glayout->addWidget(new QLabel(tr("Interval")), row, 0, Qt::AlignRight);
+    m_stride = new QDoubleSpinBox();
+    m_stride->setRange(0.1, 3600.0);
+    m_stride->setDecimals(1);
+    m_stride->setValue(10.0);
+    m_stride->setSuffix(tr(" s"));
+    connect(m_stride,
+            QOverload<double>::of(&QDoubleSpinBox::valueChanged),
+            this,
+            &ExportFramesDialog::rebuildList);
+    glayout->addWidget(m_stride, row++, 1, Qt::AlignLeft);
+
+    glayout->addWidget(new QLabel(tr("Directory")), row, 0, Qt::AlignRight);
+    QHBoxLayout *dirHbox = new QHBoxLayout();
+    m_dir = new QLineEdit(QDir::toNativeSeparators(Settings.savePath()));
+    m_dir->setReadOnly(true);
+    QPushButton *browseButton = new QPushButton(this);
+    browseButton->setIcon(
+        QIcon::fromTheme("document-open", QIcon(":/icons/oxygen/32x32/actions/document-open.png")));
+    connect(browseButton, &QAbstractButton::clicked, this, &ExportFramesDialog::browse);
+    dirHbox->addWidget(m_dir);
+    dirHbox->addWidget(browseButton);
+    glayout->addLayout(dirHbox, row++, 1, Qt::AlignLeft);
+
+    glayout->addWidget(new QLabel(tr("Prefix")), row, 0, Qt::AlignRight);
+    m_prefix = new QLineEdit(tr("frame"));
+    connect(m_prefix, &QLineEdit::textChanged, this, &ExportFramesDialog::rebuildList);
+    glayout->addWidget(m_prefix, row++, 1, Qt::AlignLeft);
+
+    glayout->addWidget(new QLabel(tr("Format")), row, 0, Qt::AlignRight);
+    m_format = new QComboBox();
+    m_format->addItem(tr("PNG"), "png");
+    m_format->addItem(tr("JPEG"), "jpg");
+    m_format->addItem(tr("TIFF"), "tif");
+    m_format->addItem(tr("WebP"), "webp");
+    // OpenEXR needs the image format plugin that is not always installed.
+    if (QImageWriter::supportedImageFormats().contains("exr"))
+        m_format->addItem(tr("OpenEXR"), "exr");
+    const auto suffix = Settings.exportFrameSuffix().mid(1).toLower();
+    for (int i = 0; i < m_format->count(); ++i) {
+        if (m_format->itemData(i).toString() == suffix
+            || (suffix == "jpeg" && m_format->itemData(i).toString() == "jpg"))
+            m_format->setCurrentIndex(i);
+    }
+    connect(m_format,
+            QOverload<int>::of(&QComboBox::activated),
+            this,
+            &ExportFramesDialog::rebuildList);
+    glayout->addWidget(m_format, row++, 1, Qt::AlignLeft);
+
+    m_errorIcon = new QLabel();
+    QIcon icon = QIcon(":/icons/oxygen/32x32/status/task-reject.png");
+    m_errorIcon->setPixmap(icon.pixmap(QSize(24, 24)));
+    glayout->addWidget(m_errorIcon, row, 0, Qt::AlignRight);
+    m_errorText = new QLabel();
+    glayout->addWidget(m_errorText, row++, 1, Qt::AlignLeft);
+
+    m_list = new QListWidget();
+    m_list->setSelectionMode(QAbstractItemView::NoSelection);
+    m_list->setIconSize(QSize(16, 16));
+    glayout->addWidget(m_list, row++, 0, 1, 2);
+
+    m_buttonBox = new QDialogButtonBox(QDialogButtonBox::Ok | QDialogButtonBox::Cancel);
+    glayout->addWidget(m_buttonBox, row++, 0, 1, 2);
+    connect(m_buttonBox, &QDialogButtonBox::accepted, this, &ExportFramesDialog::accept);
+    connect(m_buttonBox, &QDialogButtonBox::rejected, this, &QDialog::reject);
+
+    glayout->setColumnMinimumWidth(1,
+                                   fontMetrics().horizontalAdvance(m_dir->text())
+                                       + browseButton->width());
+    setLayout(glayout);
+    setModal(true);
+    rebuildList();
+    resize(500, 400);
+}
+
+void ExportFramesDialog::accept()
+{
+    Settings.setSavePath(QDir::fromNativeSeparators(m_dir->text()));
+    Settings.setExportFrameSuffix(QStringLiteral(".") + m_format->currentData().toString());
+    QDialog::accept();
+}
+
+QList<ExportFramesDialog::Position> ExportFramesDialog::positions() const
+{
+    QList<Position> result;
+    switch (m_source->currentData().toInt()) {
+    case SOURCE_MARKERS:
+        for (const auto &marker : MAIN.timelineDock()->markersModel()->getMarkers())
+            result << Position{marker.start, marker.text};
+        break;
+    case SOURCE_CLIPS: {
+        auto timeline = MAIN.timelineDock();
+        auto model = timeline->model();
+        QList<QPoint> clips;
+        for (const auto &clip : timeline->selection()) {
+            if (!timeline->isBlank(clip.y(), clip.x()))
+                clips << clip;
+        }
+        if (clips.isEmpty()) {
+            const int track = timeline->currentTrack();
+            const int count = model->rowCount(model->index(track));
+            for (int i = 0; i < count; ++i)
+                clips << QPoint(i, track);
+        }
+        for (const auto &clip : clips) {
+            const auto index = model->index(clip.x(), 0, model->index(clip.y()));
+            if (!index.isValid() || index.data(MultitrackModel::IsBlankRole).toBool()
+                || index.data(MultitrackModel::IsTransitionRole).toBool())
+                continue;
+            result << Position{index.data(MultitrackModel::StartRole).toInt(),
+                               index.data(MultitrackModel::NameRole).toString()};
+        }
+        break;
+    }
+    case SOURCE_STRIDE: {
+        if (!m_producer || !m_producer->is_valid())
+            break;
+        const int stride = qMax(1, qRound(m_stride->value() * MLT.profile().fps()));
+        for (int position = 0; position < m_producer->get_length(); position += stride)
+            result << Position{position, QString()};
+        break;
+    }
+    }
+    std::stable_sort(result.begin(), result.end(), [](const Position &a, const Position &b) {
+        return a.position < b.position;
+    });
+    return result;
+}
+
+void ExportFramesDialog::rebuildList()
+{
+    m_stride->setEnabled(m_source->currentData().toInt() == SOURCE_STRIDE);
+    m_frames.clear();
+    m_list->clear();
+
+    const auto list = positions();
+    const int digits = QString::number(list.size()).size();
+    const QString directory = QDir::fromNativeSeparators(m_dir->text());
+    const QString extension = m_format->currentData().toString();
+    QSet<QString> names;
+    QString error;
+    for (int i = 0; i < list.size(); ++i) {
+        QString name = list[i].name;
+        if (name.isEmpty() && m_producer) {
+            name = QString::fromLatin1(m_producer->frames_to_time(list[i].position, mlt_time_clock));
+            name.replace('.', '_');
+        }
+        QStringList fields;
+        if (!m_prefix->text().isEmpty())
+            fields << m_prefix->text();
+        fields << QStringLiteral("%1").arg(i + 1, digits, 10, QChar('0'));
+        if (!name.isEmpty())
+            fields << fileNameField(name);
+        const QString filePath = directory + '/' + fields.join('-') + '.' + extension;
+        m_frames << FrameExportJob::Frame{list[i].position, filePath};
+
+        QListWidgetItem *item = new QListWidgetItem(QDir::toNativeSeparators(filePath), m_list);
+        QString itemError;
+        if (QFileInfo::exists(filePath))
+            itemError = tr("File Exists: %1").arg(QDir::toNativeSeparators(filePath));
+        else if (names.contains(filePath))
+            itemError = tr("Duplicate File Name: %1").arg(QFileInfo(filePath).fileName());
+        names.insert(filePath);
+        if (itemError.isEmpty()) {
+            item->setIcon(QIcon(":/icons/oxygen/32x32/status/task-complete.png"));
+        } else {
+            item->setIcon(QIcon(":/icons/oxygen/32x32/status/task-reject.png"));
+            item->setToolTip(itemError);
+            if (error.isEmpty())
+                error = itemError;
+        }
+    }
+    if (m_frames.isEmpty())
+        error = tr("There are no frames at these positions");
+    else if (!QDir(directory).exists())
+        error = tr("Directory does not exist: %1").arg(m_dir->text());
+
+    m_errorText->setText(error);
+    m_errorText->setVisible(!error.isEmpty());
+    m_errorIcon->setVisible(!error.isEmpty());
+    m_buttonBox->button(QDialogButtonBox::Ok)->setEnabled(error.isEmpty());
+    m_buttonBox->button(QDialogButtonBox::Ok)->setToolTip(tr("Fix file name errors before export."));
+}
+
+void ExportFramesDialog::browse()
+{
+    QString directory = QDir::toNativeSeparators(
+        QFileDialog::getExistingDirectory(this,
+                                          tr("Export Directory"),
+                                          m_dir->text(),
+                                          Util::getFileDialogOptions()));
+    if (!directory.isEmpty()) {
+        m_dir->setText(directory);
+        rebuildList();
+    }
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXPORTFRAMESDIALOG_H
+#define EXPORTFRAMESDIALOG_H
+
+#include "jobs/frameexportjob.h"
+
+#include <QDialog>
+#include <QList>
+
+class QComboBox;
+class QDialogButtonBox;
+class QDoubleSpinBox;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class ExportFramesDialog
+  \brief Chooses the positions and file names of a batch of exported frames.
+
+  The positions are the markers or the clips of the timeline, or a stride
+  through \a producer. Each file is named with the prefix, its index and the
+  name of its marker or clip, or its time.
+*/
+
+class ExportFramesDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit ExportFramesDialog(Mlt::Producer *producer, bool isTimeline, QWidget *parent = 0);
+    QList<FrameExportJob::Frame> frames() const { return m_frames; }
+
+public slots:
+    void accept() override;
+
+private slots:
+    void rebuildList();
+    void browse();
+
+private:
+    struct Position
+    {
+        int position;
+        QString name;
+    };
+
+    QList<Position> positions() const;
+
+    Mlt::Producer *m_producer;
+    QComboBox *m_source;
+    QDoubleSpinBox *m_stride;
+    QLineEdit *m_dir;
+    QLineEdit *m_prefix;
+    QComboBox *m_format;
+    QLabel *m_errorIcon;
+    QLabel *m_errorText;
+    QListWidget *m_list;
+    QDialogButtonBox *m_buttonBox;
+    QList<FrameExportJob::Frame> m_frames;
+};
+
+#endif // EXPORTFRAMESDIALOG_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024-2025 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,6 +20,8 @@
 #include "Logger.h"
 #include "dialogs/filedownloaddialog.h"
 #include "docks/timelinedock.h"
+#include "jobqueue.h"
+#include "jobs/downloadjob.h"
 #include "mainwindow.h"
 #include "models/extensionmodel.h"
 #include "qmltypes/qmlapplication.h"
@@ -348,6 +350,7 @@ void TranscribeAudioDialog::onModelRowClicked(const QModelIndex &index)
         if (result == QMessageBox::Yes) {
             downloadModel(index.row());
         }
+        return;
     }
     setCurrentModel(index.row());
     updateWhisperStatus();
@@ -398,10 +401,7 @@ void TranscribeAudioDialog::showEvent(QShowEvent *event)
     int result = qDialog.exec();
     if (result == QMessageBox::Yes) {
         refreshModels(false);
-        int index = m_model.getStandardIndex();
-        downloadModel(index);
-        setCurrentModel(index);
-        updateWhisperStatus();
+        downloadModel(m_model.getStandardIndex());
     }
 }
 
@@ -434,10 +434,24 @@ void TranscribeAudioDialog::refreshModels(bool report)
 
 void TranscribeAudioDialog::downloadModel(int index)
 {
-    FileDownloadDialog dlDialog(tr("Download Model"), this);
-    dlDialog.setSrc(m_model.url(index));
-    dlDialog.setDst(m_model.localPath(index));
-    dlDialog.start();
+    const QString path = m_model.localPath(index);
+    if (JOBS.targetIsInProgress(path)) {
+        MAIN.showStatusMessage(tr("%1 is already downloading").arg(m_model.getName(index)));
+        return;
+    }
+    // The model downloads in the background and is chosen once it is there.
+    auto job = new DownloadJob(m_model.url(index), path, m_model.checksum(index));
+    connect(job, &AbstractJob::finished, this, [this, path](AbstractJob *, bool isSuccess) {
+        if (!isSuccess)
+            return;
+        m_table->viewport()->update();
+        QModelIndex modelIndex = m_model.getIndexForPath(path);
+        if (modelIndex.isValid())
+            setCurrentModel(modelIndex.row());
+        updateWhisperStatus();
+    });
+    JOBS.add(job);
+    MAIN.showStatusMessage(tr("Downloading %1 in the background").arg(m_model.getName(index)));
 }
 
 void TranscribeAudioDialog::setCurrentModel(int index)
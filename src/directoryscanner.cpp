@@ -0,0 +1,257 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "directoryscanner.h"
+
+#include "Logger.h"
+#include "executors.h"
+#include "util.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QDirIterator>
+#include <QHash>
+#include <QMutex>
+#include <QThread>
+
+#include <algorithm>
+#include <atomic>
+
+static const int kWaitMs = 50;
+
+struct DirectoryScanner::State
+{
+    QMutex mutex;
+    DirectoryScanner *scanner{nullptr};
+    std::atomic<int> pending{0};
+    std::atomic<bool> isCanceled{false};
+};
+
+DirectoryScanner::DirectoryScanner(QObject *parent)
+    : QObject(parent)
+    , m_isFinished(true)
+{}
+
+DirectoryScanner::~DirectoryScanner()
+{
+    if (m_state) {
+        m_state->isCanceled = true;
+        // The tasks still running only report to a scanner that exists.
+        QMutexLocker locker(&m_state->mutex);
+        m_state->scanner = nullptr;
+    }
+}
+
+void DirectoryScanner::start(const QStringList &dirPaths)
+{
+    cancel();
+    m_files.clear();
+    m_isFinished = dirPaths.isEmpty();
+    if (m_isFinished) {
+        emit finished();
+        return;
+    }
+    m_state = std::make_shared<State>();
+    m_state->scanner = this;
+    m_state->pending = dirPaths.size();
+    for (const auto &path : dirPaths) {
+        auto state = m_state;
+        Executors::start(Executors::InteractiveExecutor, [=]() { scan(state, path); });
+    }
+}
+
+void DirectoryScanner::cancel()
+{
+    if (!m_state)
+        return;
+    m_state->isCanceled = true;
+    {
+        QMutexLocker locker(&m_state->mutex);
+        m_state->scanner = nullptr;
+    }
+    m_state.reset();
+    m_isFinished = true;
+}
+
+QStringList DirectoryScanner::files() const
+{
+    auto result = m_files;
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+void DirectoryScanner::scan(std::shared_ptr<State> state, const QString &dirPath)
+{
+    QList<QFileInfo> files;
+    if (!state->isCanceled) {
+        QDirIterator it(dirPath,
+                        QDir::Files | QDir::Dirs | QDir::NoDotAndDotDot | QDir::Readable
+                            | QDir::NoSymLinks);
+        while (it.hasNext() && !state->isCanceled) {
+            it.next();
+            const auto info = it.fileInfo();
+            if (info.isDir()) {
+                state->pending++;
+                const auto path = info.filePath();
+                Executors::start(Executors::InteractiveExecutor, [=]() { scan(state, path); });
+            } else if (isMediaFile(info)) {
+                files << info;
+            }
+        }
+    }
+    const bool isLast = --state->pending == 0;
+    QMutexLocker locker(&state->mutex);
+    if (!state->scanner)
+        return;
+    QMetaObject::invokeMethod(
+        state->scanner,
+        [=]() {
+            // The scanner may have been restarted.
+            auto scanner = state->scanner;
+            if (!scanner || scanner->m_state != state)
+                return;
+            if (!files.isEmpty()) {
+                for (const auto &info : files)
+                    scanner->m_files << info.filePath();
+                emit scanner->filesFound(dirPath, files);
+            }
+            if (isLast) {
+                LOG_DEBUG() << "found" << scanner->m_files.size() << "files";
+                scanner->m_isFinished = true;
+                emit scanner->finished();
+            }
+        },
+        Qt::QueuedConnection);
+}
+
+const QSet<QString> &DirectoryScanner::audioExtensions()
+{
+    static const QSet<QString> extensions{
+        QLatin1String("m4a"),
+        QLatin1String("wav"),
+        QLatin1String("mp3"),
+        QLatin1String("ac3"),
+        QLatin1String("flac"),
+        QLatin1String("oga"),
+        QLatin1String("opus"),
+        QLatin1String("wma"),
+        QLatin1String("mka"),
+    };
+    return extensions;
+}
+
+const QSet<QString> &DirectoryScanner::imageExtensions()
+{
+    static const QSet<QString> extensions{
+        QLatin1String("jpg"),
+        QLatin1String("jpeg"),
+        QLatin1String("png"),
+        QLatin1String("bmp"),
+        QLatin1String("tif"),
+        QLatin1String("tiff"),
+        QLatin1String("svg"),
+        QLatin1String("webp"),
+        QLatin1String("gif"),
+        QLatin1String("tga"),
+    };
+    return extensions;
+}
+
+const QSet<QString> &DirectoryScanner::videoExtensions()
+{
+    static const QSet<QString> extensions{
+        QLatin1String("mp4"),
+        QLatin1String("m4v"),
+        QLatin1String("avi"),
+        QLatin1String("mpg"),
+        QLatin1String("mpeg"),
+        QLatin1String("ts"),
+        QLatin1String("mts"),
+        QLatin1String("m2ts"),
+        QLatin1String("mkv"),
+        QLatin1String("ogv"),
+        QLatin1String("webm"),
+        QLatin1String("dv"),
+        QLatin1String("lrv"),
+        QLatin1String("360"),
+        QLatin1String("flv"),
+        QLatin1String("wmv"),
+    };
+    return extensions;
+}
+
+const QSet<QString> &DirectoryScanner::otherExtensions()
+{
+    static const QSet<QString> extensions{
+        QLatin1String("mlt"),   QLatin1String("xml"), QLatin1String("txt"),      QLatin1String("pdf"),
+        QLatin1String("doc"),   QLatin1String("gpx"), QLatin1String("rawr"),     QLatin1String("stab"),
+        QLatin1String("srt"),   QLatin1String("so"),  QLatin1String("dll"),      QLatin1String("exe"),
+        QLatin1String("zip"),   QLatin1String("edl"), QLatin1String("kdenlive"), QLatin1String("osp"),
+        QLatin1String("blend"), QLatin1String("swf"), QLatin1String("cube"),     QLatin1String("json"),
+    };
+    return extensions;
+}
+
+bool DirectoryScanner::isMediaFile(const QFileInfo &info)
+{
+    // Files of an unknown type may still be media and are probed when opened.
+    const auto ext = info.suffix().toLower();
+    if (audioExtensions().contains(ext) || imageExtensions().contains(ext)
+        || videoExtensions().contains(ext))
+        return true;
+    return !info.isHidden() && !otherExtensions().contains(ext);
+}
+
+QList<QUrl> DirectoryScanner::expandDirectories(const QList<QUrl> &urls,
+                                                std::function<void(int)> progress)
+{
+    // The folders by their path in the URLs
+    QHash<QString, QString> dirPaths;
+    for (auto url : urls) {
+        const auto path = Util::removeFileScheme(url, false);
+        if (QFileInfo(path).isDir())
+            dirPaths.insert(path, QDir::cleanPath(QDir::fromNativeSeparators(path)));
+    }
+    if (dirPaths.isEmpty())
+        return urls;
+
+    DirectoryScanner scanner;
+    scanner.start(dirPaths.values());
+    while (!scanner.isFinished()) {
+        if (progress)
+            progress(scanner.fileCount());
+        QCoreApplication::processEvents();
+        QThread::msleep(kWaitMs);
+    }
+    // Keep the order of the URLs with each folder in place of its files.
+    const auto files = scanner.files();
+    QList<QUrl> result;
+    for (auto url : urls) {
+        const auto path = Util::removeFileScheme(url, false);
+        if (!dirPaths.contains(path)) {
+            result << url;
+            continue;
+        }
+        auto prefix = dirPaths.value(path);
+        if (!prefix.endsWith('/'))
+            prefix += '/';
+        auto it = std::lower_bound(files.cbegin(), files.cend(), prefix);
+        for (; it != files.cend() && it->startsWith(prefix); ++it)
+            result << *it;
+    }
+    return result;
+}
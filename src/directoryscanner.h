@@ -0,0 +1,84 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DIRECTORYSCANNER_H
+#define DIRECTORYSCANNER_H
+
+#include <QFileInfo>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QUrl>
+
+#include <functional>
+#include <memory>
+
+/*!
+  \class DirectoryScanner
+  \brief Lists the files of folders and their subfolders in the background.
+
+  Each folder is listed by a task of its own on the interactive executor, which
+  starts a task for every subfolder it finds. The files whose extension is
+  known not to be media are skipped while listing. The files of each folder are
+  given to the GUI thread with filesFound() as soon as the folder is listed.
+*/
+
+class DirectoryScanner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit DirectoryScanner(QObject *parent = nullptr);
+    ~DirectoryScanner();
+
+    //! Starts listing the files in \a dirPaths and their subfolders.
+    void start(const QStringList &dirPaths);
+    //! Stops listing. The folders being listed are still reported.
+    void cancel();
+    bool isFinished() const { return m_isFinished; }
+    //! Returns the files reported so far, sorted by path.
+    QStringList files() const;
+    int fileCount() const { return m_files.size(); }
+
+    static const QSet<QString> &audioExtensions();
+    static const QSet<QString> &imageExtensions();
+    static const QSet<QString> &videoExtensions();
+    //! Returns the extensions of files Shotcut can open that are not media.
+    static const QSet<QString> &otherExtensions();
+    //! Returns false for the files whose extension is known not to be media.
+    static bool isMediaFile(const QFileInfo &info);
+
+    //! Replaces the folders in \a urls with the files found in them and their
+    //! subfolders, calling \a progress with the count so far while waiting.
+    static QList<QUrl> expandDirectories(const QList<QUrl> &urls,
+                                         std::function<void(int)> progress);
+
+signals:
+    void filesFound(const QString &dirPath, const QList<QFileInfo> &files);
+    void finished();
+
+private:
+    struct State;
+    static void scan(std::shared_ptr<State> state, const QString &dirPath);
+
+    std::shared_ptr<State> m_state;
+    QStringList m_files;
+    bool m_isFinished;
+};
+
+#endif // DIRECTORYSCANNER_H
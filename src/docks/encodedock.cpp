@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,33 +19,68 @@
 #include "ui_encodedock.h"
 
 #include "Logger.h"
+#include "commands/filtercommands.h"
+#include "controllers/filtercontroller.h"
 #include "dialogs/addencodepresetdialog.h"
 #include "dialogs/listselectiondialog.h"
+#include "dialogs/longuitask.h"
 #include "dialogs/multifileexportdialog.h"
 #include "findanalysisfilterparser.h"
 #include "jobqueue.h"
 #include "jobs/encodejob.h"
+#include "jobs/ffmpegjob.h"
 #include "mainwindow.h"
 #include "mltcontroller.h"
 #include "models/markersmodel.h"
+#include "proxymanager.h"
 #include "qmltypes/qmlfilter.h"
+#include "qmltypes/qmlmetadata.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
 #include "util.h"
 
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDirIterator>
 #include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
 #include <QProcess>
 #include <QRegularExpression>
+#include <QSaveFile>
+#include <QThreadPool>
 #include <QTimer>
 #include <QtMath>
 #include <QtWidgets>
 #include <QtXml>
 
+#include <algorithm>
+#include <memory>
+
 // formulas to map absolute value ranges to percentages as int
 #define TO_ABSOLUTE(min, max, rel) qRound(float(min) + float((max) - (min)) * float(rel) / 100.0f)
 #define TO_RELATIVE(min, max, abs) qRound(100.0f * float((abs) - (min)) / float((max) - (min)))
 static const int kOpenCaptureFileDelayMs = 1500;
 static const int kCustomPresetFileNameRole = Qt::UserRole + 1;
+static const int kPresetExtensionRole = Qt::UserRole + 2;
+static const int kPresetCodecsRole = Qt::UserRole + 3;
+static const char *kStockPresetPrefix = "consumer/avformat/";
+static const char *kPresetCatalogFileName = "encodepresets.cache";
+// Increment when the fields of the preset catalog change.
+static const qint32 kPresetCatalogVersion = 1;
+static const int kAutoEncoderThreads = 8;
+// Each export holds its own decoders and frames in memory.
+static const int kMaxBatchConcurrency = 8;
+static const char *kExportCacheSubfolder = "exportcache";
+static const char *kPassLogSuffix = "_2pass.log";
+static const char *kLoudnessSuffix = ".loudness";
+static const int kExportCacheDays = 30;
+static const int kLadderRungs = 4;
+static const int kLadderSegmentSeconds = 4;
+static const int kLadderAudioBitrate = 128000;
+// Enough for H.264 at typical web quality, so 1080p at 30 fps gets 5 Mb/s.
+static const double kLadderBitsPerPixel = 0.08;
 #ifdef Q_OS_WIN
 static const QString kNullTarget = "nul";
 #else
@@ -73,14 +108,320 @@ static bool isHardwareEncoder(const QString &vcodec)
            || vcodec.endsWith("_videotoolbox");
 }
 
+// How many encoding sessions the drivers usually allow at once
+static int hardwareEncoderSessions(const QString &vcodec)
+{
+    if (vcodec.endsWith("_nvenc"))
+        return 3;
+    if (vcodec.endsWith("_mf"))
+        return 1;
+    return 2;
+}
+
+static QDir exportCacheDir()
+{
+    QDir dir(Settings.appDataLocation());
+    if (!dir.cd(kExportCacheSubfolder)) {
+        if (dir.mkdir(kExportCacheSubfolder))
+            dir.cd(kExportCacheSubfolder);
+    }
+    return dir;
+}
+
+// Forgets the cached statistics and results that were not used for a while.
+static void pruneExportCache(QDir &dir)
+{
+    const auto expired = QDateTime::currentDateTime().addDays(-kExportCacheDays);
+    for (const auto &info : dir.entryInfoList(QDir::Files)) {
+        if (info.lastModified() < expired)
+            QFile::remove(info.absoluteFilePath());
+    }
+}
+
+static QString md5(const QString &text)
+{
+    return QString::fromLatin1(
+        QCryptographicHash::hash(text.toUtf8(), QCryptographicHash::Md5).toHex());
+}
+
+// The statistics of a first pass only depend on the producer and the video
+// parameters, so the audio, container, metadata and file names are left out.
+static QString passLogKey(const QString &xml, const QString &target, const QString &from)
+{
+    QDomDocument dom;
+    if (!dom.setContent(xml))
+        return QString();
+    QDomNodeList consumers = dom.elementsByTagName("consumer");
+    if (consumers.length() != 1)
+        return QString();
+    QDomElement consumerNode = consumers.at(0).toElement();
+    const QString stats = QString(target).replace(":", "\\:") + kPassLogSuffix;
+    QStringList parameters;
+    QDomNamedNodeMap attributes = consumerNode.attributes();
+    for (int i = 0; i < attributes.length(); ++i) {
+        const auto name = attributes.item(i).nodeName();
+        if (name == "target" || name == "f" || name == "passlogfile" || name == "real_time"
+            || name == "threads" || name == "strict" || name == "movflags" || name == "an"
+            || name == "acodec" || name == "ab" || name == "aq" || name == "channels"
+            || name == "frequency" || name == "channel_layout" || name.startsWith("meta.")
+            || name.startsWith("subtitle."))
+            continue;
+        parameters << name + '=' + attributes.item(i).nodeValue().remove(stats);
+    }
+    parameters.sort();
+    consumerNode.parentNode().removeChild(consumerNode);
+    return md5(dom.toString(0) + parameters.join('\n') + from);
+}
+
+// Copies the statistics files that were cached for \a key next to \a target.
+static bool restorePassLog(const QString &key, const QString &target)
+{
+    if (key.isEmpty())
+        return false;
+    QDir dir = exportCacheDir();
+    const auto files = dir.entryInfoList(QStringList() << key + '*', QDir::Files);
+    if (files.isEmpty())
+        return false;
+    for (const auto &info : files) {
+        const auto destination = target + kPassLogSuffix + info.fileName().mid(key.size());
+        QFile::remove(destination);
+        if (!QFile::copy(info.absoluteFilePath(), destination)) {
+            LOG_WARNING() << "failed to restore the first pass statistics" << destination;
+            return false;
+        }
+        // Touching the file keeps it in the cache.
+        QFile file(info.absoluteFilePath());
+        if (file.open(QIODevice::ReadWrite))
+            file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    }
+    return true;
+}
+
+// Caches every statistics file that the encoder wrote for \a target.
+static void storePassLog(const QString &key, const QString &target)
+{
+    if (key.isEmpty())
+        return;
+    QDir dir = exportCacheDir();
+    pruneExportCache(dir);
+    const QFileInfo base(target + kPassLogSuffix);
+    const auto files = base.dir().entryInfoList(QStringList() << base.fileName() + '*',
+                                                QDir::Files);
+    for (const auto &info : files) {
+        const auto destination = dir.filePath(key + info.fileName().mid(base.fileName().size()));
+        QFile::remove(destination);
+        if (!QFile::copy(info.absoluteFilePath(), destination))
+            LOG_WARNING() << "failed to cache the first pass statistics" << destination;
+    }
+}
+
+static QString loudnessKey(Mlt::Filter &filter)
+{
+    Mlt::Service service(mlt_service(filter.get_data("service")));
+    if (!service.is_valid())
+        return QString();
+    return md5(MLT.XML(&service));
+}
+
+static QString cachedLoudness(const QString &key)
+{
+    QFile file(exportCacheDir().filePath(key + kLoudnessSuffix));
+    if (key.isEmpty() || !file.open(QIODevice::ReadWrite))
+        return QString();
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return QString::fromUtf8(file.readAll());
+}
+
+static void storeLoudness(const QString &key, const QString &results)
+{
+    if (key.isEmpty() || results.isEmpty())
+        return;
+    QDir dir = exportCacheDir();
+    pruneExportCache(dir);
+    QSaveFile file(dir.filePath(key + kLoudnessSuffix));
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(results.toUtf8());
+        file.commit();
+    }
+}
+
+namespace {
+
+// What the presets tree shows of a stock preset
+struct PresetEntry
+{
+    QString id;   // The name in the MLT repository, such as consumer/avformat/x
+    QString name; // The name shown with its categories separated by slashes
+    QString note;
+    QString extension;
+    QString codecs; // The format and codecs, to search for them
+};
+
+} // namespace
+
+static QString presetsPath()
+{
+    const char *path = mlt_environment("MLT_PRESETS_PATH");
+    return path ? QString::fromUtf8(path) : QString();
+}
+
+// The catalog is stale when Shotcut, MLT or any of the stock preset files change.
+// The names also depend on which profiles are installed. Returns an empty key
+// if the presets are not in a folder that can be checked.
+static QByteArray presetCatalogKey()
+{
+    const QDir dir(presetsPath());
+    if (presetsPath().isEmpty() || !dir.exists(kStockPresetPrefix))
+        return QByteArray();
+    QStringList files;
+    QDirIterator it(dir.filePath(kStockPresetPrefix),
+                    QDir::Files | QDir::Readable,
+                    QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        files << QStringLiteral("%1:%2")
+                     .arg(dir.relativeFilePath(it.filePath()))
+                     .arg(it.fileInfo().lastModified().toMSecsSinceEpoch());
+    }
+    files.sort();
+    QCryptographicHash hash(QCryptographicHash::Md5);
+    hash.addData(qApp->applicationVersion().toUtf8());
+    hash.addData(mlt_version_get_string());
+    if (const char *profiles = mlt_environment("MLT_PROFILES_PATH")) {
+        const QFileInfo info(QString::fromUtf8(profiles));
+        hash.addData(QByteArray::number(info.lastModified().toMSecsSinceEpoch()));
+    }
+    hash.addData(files.join('\n').toUtf8());
+    return hash.result().toHex();
+}
+
+static bool readPresetCatalog(const QByteArray &key, QList<PresetEntry> &entries)
+{
+    QFile file(QDir(Settings.appDataLocation()).filePath(kPresetCatalogFileName));
+    if (key.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return false;
+    QDataStream stream(&file);
+    stream.setVersion(QDataStream::Qt_6_4);
+    qint32 version = 0;
+    QByteArray cacheKey;
+    qint32 count = 0;
+    stream >> version >> cacheKey >> count;
+    if (stream.status() != QDataStream::Ok || version != kPresetCatalogVersion
+        || cacheKey != key)
+        return false;
+    for (int i = 0; i < count; ++i) {
+        PresetEntry entry;
+        stream >> entry.id >> entry.name >> entry.note >> entry.extension >> entry.codecs;
+        if (stream.status() != QDataStream::Ok) {
+            LOG_WARNING() << "the export preset catalog is corrupt";
+            entries.clear();
+            return false;
+        }
+        entries << entry;
+    }
+    LOG_DEBUG() << "read" << count << "export presets from the catalog";
+    return true;
+}
+
+static void writePresetCatalog(const QByteArray &key, const QList<PresetEntry> &entries)
+{
+    QByteArray data;
+    QDataStream stream(&data, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_4);
+    stream << kPresetCatalogVersion << key << qint32(entries.size());
+    for (const auto &entry : entries)
+        stream << entry.id << entry.name << entry.note << entry.extension << entry.codecs;
+    const auto fileName = QDir(Settings.appDataLocation()).filePath(kPresetCatalogFileName);
+    QThreadPool::globalInstance()->start([=]() {
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(data);
+            if (file.commit())
+                return;
+        }
+        LOG_WARNING() << "failed to write" << fileName;
+    });
+}
+
+static QList<PresetEntry> buildPresetCatalog(Mlt::Properties *presets, Mlt::Properties *profiles)
+{
+    QList<PresetEntry> entries;
+    const QString prefix(kStockPresetPrefix);
+    if (!presets || !presets->is_valid())
+        return entries;
+    for (int j = 0; j < presets->count(); j++) {
+        QString name(presets->get_name(j));
+        if (!name.startsWith(prefix))
+            continue;
+        Mlt::Properties preset((mlt_properties) presets->get_data(name.toLatin1().constData()));
+        if (preset.get_int("meta.preset.hidden"))
+            continue;
+        PresetEntry entry;
+        entry.id = name;
+        if (preset.get("meta.preset.name"))
+            name = QString::fromUtf8(preset.get("meta.preset.name"));
+        else {
+            // use relative path and filename
+            name.remove(0, prefix.length());
+            QStringList textParts = name.split('/');
+            if (textParts.count() > 1) {
+                // if the path is a profile name, then change it to "preset (profile)"
+                QString profile = textParts.at(0);
+                textParts.removeFirst();
+                if (profiles && profiles->get_data(profile.toLatin1().constData()))
+                    name = QStringLiteral("%1 (%2)").arg(textParts.join('/'), profile);
+            }
+        }
+        entry.name = name;
+        if (preset.property_exists("meta.preset.note"))
+            entry.note = QString::fromUtf8(preset.get("meta.preset.note"));
+        if (preset.property_exists("meta.preset.extension"))
+            entry.extension = QString::fromLatin1(preset.get("meta.preset.extension"));
+        QStringList codecs;
+        for (auto field : {"f", "vcodec", "acodec"}) {
+            if (preset.get(field))
+                codecs << QString::fromLatin1(preset.get(field));
+        }
+        entry.codecs = codecs.join(' ');
+        entries << entry;
+    }
+    return entries;
+}
+
+// Until the codec lists are loaded, the combos only hold the names that presets chose.
+static void addProvisionalItem(QComboBox *combo, const QString &text)
+{
+    if (!text.isEmpty() && combo->findText(text) == -1)
+        combo->addItem(text);
+}
+
+// Replaces the items after the default item of \a combo by the sorted \a names and
+// returns whether its current item is still there.
+static bool replaceComboItems(QComboBox *combo, QStringList names)
+{
+    const auto current = combo->currentIndex() > 0 ? combo->currentText() : QString();
+    names.removeDuplicates();
+    names.sort();
+    combo->blockSignals(true);
+    while (combo->count() > 1)
+        combo->removeItem(1);
+    combo->addItems(names);
+    const int index = current.isEmpty() ? 0 : combo->findText(current);
+    combo->setCurrentIndex(qMax(0, index));
+    combo->blockSignals(false);
+    return index >= 0;
+}
+
 EncodeDock::EncodeDock(QWidget *parent)
     : QDockWidget(parent)
     , ui(new Ui::EncodeDock)
-    , m_presets(Mlt::Repository::presets())
+    , m_presets(nullptr)
     , m_immediateJob(0)
-    , m_profiles(Mlt::Profile::list())
+    , m_profiles(nullptr)
     , m_isDefaultSettings(true)
     , m_fps(0.0)
+    , m_segmentCount(0)
+    , m_isCodecListsLoaded(false)
 {
     LOG_DEBUG() << "begin";
     initSpecialCodecLists();
@@ -101,12 +442,18 @@ EncodeDock::EncodeDock(QWidget *parent)
     // On 32-bit process, limit multi-threading to mitigate running out of memory.
     ui->parallelCheckbox->setChecked(false);
     ui->parallelCheckbox->setHidden(true);
+    ui->segmentedCheckbox->setChecked(false);
+    ui->segmentedCheckbox->setHidden(true);
 #else
+    ui->segmentedCheckbox->setChecked(Settings.encodeSegmentedExport());
     ui->parallelCheckbox->setChecked(Settings.encodeParallelProcessing());
     ui->videoCodecThreadsSpinner->setMaximum(QThread::idealThreadCount());
 #endif
     if (QThread::idealThreadCount() < 3)
         ui->parallelCheckbox->setHidden(true);
+    ui->smartRenderCheckbox->setChecked(Settings.encodeSmartRender());
+    ui->streamingLadderCheckbox->setChecked(Settings.encodeStreamingLadder());
+    ui->intraCacheCheckbox->setChecked(Settings.encodeUseIntraCache());
     toggleViewAction()->setIcon(windowIcon());
 
     connect(ui->videoBitrateCombo,
@@ -123,41 +470,12 @@ EncodeDock::EncodeDock(QWidget *parent)
     ui->presetsTree->setModel(&m_presetsModel);
     loadPresets();
 
-    // populate the combos
-    Mlt::Consumer c(MLT.profile(), "avformat");
-    c.set("f", "list");
-    c.set("acodec", "list");
-    c.set("vcodec", "list");
-    c.start();
-    c.stop();
-
-    Mlt::Properties *p = new Mlt::Properties(c.get_data("f"));
+    // The formats and codecs of avformat are listed when the dock is first shown.
     ui->formatCombo->blockSignals(true);
-    for (int i = 0; i < p->count(); i++) {
-        if (ui->formatCombo->findText(p->get(i)) == -1)
-            ui->formatCombo->addItem(p->get(i));
-    }
-    delete p;
-    ui->formatCombo->model()->sort(0);
-    ui->formatCombo->insertItem(0, tr("Automatic from extension"));
+    ui->formatCombo->addItem(tr("Automatic from extension"));
     ui->formatCombo->blockSignals(false);
-
-    p = new Mlt::Properties(c.get_data("acodec"));
-    for (int i = 0; i < p->count(); i++)
-        ui->audioCodecCombo->addItem(p->get(i));
-    delete p;
-    ui->audioCodecCombo->model()->sort(0);
-    ui->audioCodecCombo->insertItem(0, tr("Default for format"));
-
-    p = new Mlt::Properties(c.get_data("vcodec"));
-    for (int i = 0; i < p->count(); i++) {
-        if (qstrcmp("nvenc", p->get(i))               // redundant codec names nvenc_...
-            && qstrcmp("wrapped_avframe", p->get(i))) // not usable
-            ui->videoCodecCombo->addItem(p->get(i));
-    }
-    delete p;
-    ui->videoCodecCombo->model()->sort(0);
-    ui->videoCodecCombo->insertItem(0, tr("Default for format"));
+    ui->audioCodecCombo->addItem(tr("Default for format"));
+    ui->videoCodecCombo->addItem(tr("Default for format"));
 
     ui->hwencodeCheckBox->setChecked(Settings.encodeUseHardware()
                                      && !Settings.encodeHardware().isEmpty());
@@ -222,6 +540,14 @@ void EncodeDock::loadPresetFromProperties(Mlt::Properties &preset)
         if (Util::convertNumericString(value, decimalPoint))
             preset.set(name.toUtf8().constData(), value.toUtf8().constData());
 
+        if (!m_isCodecListsLoaded) {
+            if (name == "f")
+                addProvisionalItem(ui->formatCombo, value);
+            else if (name == "acodec")
+                addProvisionalItem(ui->audioCodecCombo, value);
+            else if (name == "vcodec")
+                addProvisionalItem(ui->videoCodecCombo, vcodec);
+        }
         if (name == "f") {
             for (int j = 0; j < ui->formatCombo->count(); j++)
                 if (ui->formatCombo->itemText(j) == value) {
@@ -551,67 +877,108 @@ void EncodeDock::loadPresets()
     parentItem = grandParentItem;
     sourceModel->invisibleRootItem()->appendRow(parentItem);
     parentItem->appendRow(new QStandardItem(tr("Default")));
-    QString prefix("consumer/avformat/");
-    if (m_presets && m_presets->is_valid()) {
-        for (int j = 0; j < m_presets->count(); j++) {
-            QString name(m_presets->get_name(j));
-            if (name.startsWith(prefix)) {
-                Mlt::Properties preset(
-                    (mlt_properties) m_presets->get_data(name.toLatin1().constData()));
-                if (preset.get_int("meta.preset.hidden"))
-                    continue;
-                if (preset.get("meta.preset.name"))
-                    name = QString::fromUtf8(preset.get("meta.preset.name"));
-                else {
-                    // use relative path and filename
-                    name.remove(0, prefix.length());
-                    QStringList textParts = name.split('/');
-                    if (textParts.count() > 1) {
-                        // if the path is a profile name, then change it to "preset (profile)"
-                        QString profile = textParts.at(0);
-                        textParts.removeFirst();
-                        if (m_profiles->get_data(profile.toLatin1().constData()))
-                            name = QStringLiteral("%1 (%2)").arg(textParts.join('/'), profile);
-                    }
-                }
-                // Create a category node if the name includes a slash.
-                QStringList nameParts = name.split('/');
-                if (nameParts.count() > 1) {
-                    // See if there is already a category node with this name.
-                    int row;
-                    for (row = 0; row < grandParentItem->rowCount(); row++) {
-                        if (grandParentItem->child(row)->text() == nameParts[0]) {
-                            // There is already a category node; use it.
-                            parentItem = grandParentItem->child(row);
-                            break;
-                        }
-                    }
-                    if (row == grandParentItem->rowCount()) {
-                        // There is no category node yet; create it.
-                        parentItem = new QStandardItem(nameParts[0]);
-                        grandParentItem->appendRow(parentItem);
-                    }
-                    // Remove the category from the name.
-                    nameParts.removeFirst();
-                } else {
-                    parentItem = grandParentItem;
+    const auto key = presetCatalogKey();
+    QList<PresetEntry> entries;
+    if (!readPresetCatalog(key, entries)) {
+        entries = buildPresetCatalog(presets(), profiles());
+        if (!key.isEmpty())
+            writePresetCatalog(key, entries);
+    }
+    for (const auto &entry : entries) {
+        // Create a category node if the name includes a slash.
+        QStringList nameParts = entry.name.split('/');
+        if (nameParts.count() > 1) {
+            // See if there is already a category node with this name.
+            int row;
+            for (row = 0; row < grandParentItem->rowCount(); row++) {
+                if (grandParentItem->child(row)->text() == nameParts[0]) {
+                    // There is already a category node; use it.
+                    parentItem = grandParentItem->child(row);
+                    break;
                 }
-                QStandardItem *item = new QStandardItem(nameParts.join('/'));
-                item->setData(QString(m_presets->get_name(j)));
-                if (preset.property_exists("meta.preset.note"))
-                    item->setToolTip(QStringLiteral("<p>%1</p>")
-                                         .arg(QString::fromUtf8(preset.get("meta.preset.note"))));
-                if (preset.property_exists("meta.preset.extension"))
-                    item->setData(QString::fromLatin1(preset.get("meta.preset.extension")),
-                                  Qt::UserRole + 2);
-                parentItem->appendRow(item);
             }
+            if (row == grandParentItem->rowCount()) {
+                // There is no category node yet; create it.
+                parentItem = new QStandardItem(nameParts[0]);
+                grandParentItem->appendRow(parentItem);
+            }
+            // Remove the category from the name.
+            nameParts.removeFirst();
+        } else {
+            parentItem = grandParentItem;
         }
+        QStandardItem *item = new QStandardItem(nameParts.join('/'));
+        item->setData(entry.id);
+        if (!entry.note.isNull())
+            item->setToolTip(QStringLiteral("<p>%1</p>").arg(entry.note));
+        if (!entry.extension.isNull())
+            item->setData(entry.extension, kPresetExtensionRole);
+        item->setData(entry.codecs, kPresetCodecsRole);
+        parentItem->appendRow(item);
     }
     m_presetsModel.sort(0);
     ui->presetsTree->expandAll();
 }
 
+void EncodeDock::loadCodecLists()
+{
+    if (m_isCodecListsLoaded)
+        return;
+    m_isCodecListsLoaded = true;
+    LOG_DEBUG() << "begin";
+    Mlt::Consumer c(MLT.profile(), "avformat");
+    c.set("f", "list");
+    c.set("acodec", "list");
+    c.set("vcodec", "list");
+    c.start();
+    c.stop();
+
+    QStringList names;
+    Mlt::Properties formats((mlt_properties) c.get_data("f"));
+    for (int i = 0; i < formats.count(); i++)
+        names << formats.get(i);
+    if (!replaceComboItems(ui->formatCombo, names))
+        on_formatCombo_currentIndexChanged(0);
+
+    names.clear();
+    Mlt::Properties acodecs((mlt_properties) c.get_data("acodec"));
+    for (int i = 0; i < acodecs.count(); i++)
+        names << acodecs.get(i);
+    if (!replaceComboItems(ui->audioCodecCombo, names))
+        on_audioCodecCombo_currentIndexChanged(0);
+
+    names.clear();
+    Mlt::Properties vcodecs((mlt_properties) c.get_data("vcodec"));
+    for (int i = 0; i < vcodecs.count(); i++) {
+        if (qstrcmp("nvenc", vcodecs.get(i))               // redundant codec names nvenc_...
+            && qstrcmp("wrapped_avframe", vcodecs.get(i))) // not usable
+            names << vcodecs.get(i);
+    }
+    if (!replaceComboItems(ui->videoCodecCombo, names))
+        on_videoCodecCombo_currentIndexChanged(0);
+    LOG_DEBUG() << "end";
+}
+
+Mlt::Properties *EncodeDock::presets()
+{
+    if (!m_presets)
+        m_presets = Mlt::Repository::presets();
+    return m_presets;
+}
+
+Mlt::Properties *EncodeDock::profiles()
+{
+    if (!m_profiles)
+        m_profiles = Mlt::Profile::list();
+    return m_profiles;
+}
+
+void EncodeDock::showEvent(QShowEvent *event)
+{
+    loadCodecLists();
+    QDockWidget::showEvent(event);
+}
+
 template<typename T>
 static void setIfNotSet(Mlt::Properties *properties, const char *name, T value)
 {
@@ -1416,17 +1783,15 @@ MeltJob *EncodeDock::createMeltJob(Mlt::Producer *service,
     MLT.saveXML(fileName, service, false /* without relative paths */, tmp, isProxy);
     tmp->close();
 
-    // parse xml
+    // Read the file once and check the bytes before parsing them. Building a
+    // string from the document only for the check took as long as the parse.
     QFile f1(fileName);
     f1.open(QIODevice::ReadOnly);
-    QXmlStreamReader xmlReader(&f1);
-    QDomDocument dom(fileName);
-    dom.setContent(&xmlReader, false);
+    const QByteArray xml = f1.readAll();
     f1.close();
 
     // Check if the target file is a member of the project.
-    QString xml = dom.toString(0);
-    if (xml.contains(QDir::fromNativeSeparators(target))) {
+    if (xml.contains(QDir::fromNativeSeparators(target).toUtf8())) {
         QMessageBox::warning(this,
                              caption,
                              tr("You cannot write to a file that is in your project.\n"
@@ -1434,11 +1799,20 @@ MeltJob *EncodeDock::createMeltJob(Mlt::Producer *service,
         return nullptr;
     }
 
+    // parse xml
+    QXmlStreamReader xmlReader(xml);
+    QDomDocument dom(fileName);
+    dom.setContent(&xmlReader, false);
+
     // Add autoclose to playlists.
     QDomNodeList playlists = dom.elementsByTagName("playlist");
     for (auto i = 0; i < playlists.length(); ++i)
         playlists.item(i).toElement().setAttribute("autoclose", 1);
 
+    // The speed changes come from the sources unless the user opts in.
+    if (!isProxy && ui->intraCacheCheckbox->isChecked())
+        ProxyManager::applyIntraCache(dom);
+
     MeltJob *job = convertReframe(service, tmp, mytarget, realtime, pass, priority);
 
     if (!job) {
@@ -1459,6 +1833,10 @@ MeltJob *EncodeDock::createMeltJob(Mlt::Producer *service,
         delete tmp;
     }
 
+    if (!ui->disableVideoCheckbox->isChecked()
+        && isHardwareEncoder(ui->videoCodecCombo->currentText()))
+        job->setResourceClass(AbstractJob::GpuEncodeResource);
+
     const auto &from = ui->fromCombo->currentData().toString();
     if (MAIN.isMultitrackValid() && from.startsWith("marker:")) {
         bool ok = false;
@@ -1522,8 +1900,32 @@ void EncodeDock::enqueueAnalysis()
         // Look in the producer for all filters requiring analysis.
         FindAnalysisFilterParser parser;
         parser.start(*producer);
+
+        // Loudness results of unchanged audio are reused from an earlier export.
+        QList<Mlt::Filter> filters;
+        QList<Mlt::Filter> cachedFilters;
+        QStringList cachedResults;
+        QHash<QString, QString> loudnessKeys;
+        foreach (Mlt::Filter filter, parser.filters()) {
+            QString key;
+            if (!::qstrcmp("loudness", filter.get("mlt_service"))) {
+                key = loudnessKey(filter);
+                const auto results = cachedLoudness(key);
+                if (!results.isEmpty()) {
+                    cachedFilters << filter;
+                    cachedResults << results;
+                    continue;
+                }
+            }
+            filters << filter;
+        }
+        if (!cachedFilters.isEmpty()) {
+            LOG_INFO() << "reusing the loudness results of" << cachedFilters.size() << "filters";
+            MAIN.undoStack()->push(new Filter::AnalyzeResultsCommand(cachedFilters, cachedResults));
+        }
+
         // If there are Filters show a dialog.
-        if (parser.filters().size() > 0) {
+        if (filters.size() > 0) {
             QMessageBox
                 dialog(QMessageBox::Question,
                        windowTitle(),
@@ -1535,18 +1937,53 @@ void EncodeDock::enqueueAnalysis()
             dialog.setEscapeButton(QMessageBox::No);
             dialog.setWindowModality(QmlApplication::dialogModality());
             if (QMessageBox::Yes == dialog.exec()) {
-                // If dialog accepted enqueue jobs.
-                foreach (Mlt::Filter filter, parser.filters()) {
+                // If dialog accepted enqueue jobs, whose results are written together.
+                auto batch = new AnalyzeBatch(this);
+                foreach (Mlt::Filter filter, filters) {
                     QScopedPointer<QmlMetadata> meta(new QmlMetadata);
                     QmlFilter qmlFilter(filter, meta.data());
                     bool isAudio = !::qstrcmp("loudness", filter.get("mlt_service"));
-                    qmlFilter.analyze(isAudio, false);
+                    const auto key = isAudio ? loudnessKey(filter) : QString();
+                    qmlFilter.analyze(isAudio, false, batch);
+                    // The analysis tags the filter to find it again with the results.
+                    if (!key.isEmpty())
+                        loudnessKeys[QString::fromLatin1(filter.get(kShotcutHashProperty))] = key;
+                }
+                if (!loudnessKeys.isEmpty()) {
+                    connect(batch,
+                            &AnalyzeBatch::finished,
+                            this,
+                            [loudnessKeys](const QList<Mlt::Filter> &filters,
+                                           const QStringList &results) {
+                                for (int i = 0; i < filters.size(); ++i) {
+                                    Mlt::Filter filter(filters[i]);
+                                    const auto key = loudnessKeys.value(
+                                        QString::fromLatin1(filter.get(kShotcutHashProperty)));
+                                    storeLoudness(key, results.value(i));
+                                }
+                            });
                 }
             }
         }
     }
 }
 
+AbstractJob *EncodeDock::enqueueFirstPass(MeltJob *job, const QString &target)
+{
+    const auto key = passLogKey(job->xml(), target, ui->fromCombo->currentData().toString());
+    if (restorePassLog(key, target)) {
+        LOG_INFO() << "reusing the first pass statistics for" << target;
+        delete job;
+        return nullptr;
+    }
+    connect(job, &AbstractJob::finished, this, [key, target](AbstractJob *, bool isSuccess) {
+        if (isSuccess)
+            storePassLog(key, target);
+    });
+    JOBS.add(job);
+    return job;
+}
+
 void EncodeDock::enqueueMelt(const QStringList &targets, int realtime)
 {
     Mlt::Producer *service = fromProducer(true);
@@ -1565,6 +2002,8 @@ void EncodeDock::enqueueMelt(const QStringList &targets, int realtime)
         auto playlist = MAIN.binPlaylist();
         if (playlist && playlist->is_valid() && playlist->count() > 0) {
             int n = playlist->count();
+            const int concurrency = batchConcurrency(realtime, n);
+            LOG_INFO() << "exporting" << n << "files with up to" << concurrency << "at once";
             for (int i = 0; i < n; i++) {
                 QScopedPointer<Mlt::ClipInfo> info(playlist->clip_info(i));
                 if (!info)
@@ -1575,26 +2014,668 @@ void EncodeDock::enqueueMelt(const QStringList &targets, int realtime)
                 producer->set_in_and_out(info->frame_in, info->frame_out);
                 MeltJob *job = createMeltJob(producer.data(), targets[i], realtime, pass);
                 if (job) {
-                    JOBS.add(job);
+                    job->setConcurrency(concurrency);
                     if (pass) {
+                        auto firstPass = enqueueFirstPass(job, targets[i]);
                         job = createMeltJob(producer.data(), targets[i], realtime, 2);
-                        if (job)
+                        if (job) {
+                            job->setConcurrency(concurrency);
+                            if (firstPass)
+                                job->addDependency(firstPass);
                             JOBS.add(job);
+                        }
+                    } else {
+                        JOBS.add(job);
                     }
                 }
             }
         }
     } else {
         MeltJob *job = createMeltJob(service, targets[0], realtime, pass);
+        if (job && !pass && ui->streamingLadderCheckbox->isChecked()
+            && enqueueStreamingLadder(job, targets[0]))
+            return;
+        if (job && !pass && ui->smartRenderCheckbox->isChecked()
+            && enqueueSmartRender(job, service, targets[0]))
+            return;
+        if (job && !pass && ui->segmentedCheckbox->isChecked()
+            && enqueueSegments(job, service, targets[0]))
+            return;
         if (job) {
-            JOBS.add(job);
             if (pass) {
+                auto firstPass = enqueueFirstPass(job, targets[0]);
                 job = createMeltJob(service, targets[0], realtime, 2);
-                if (job)
+                if (job) {
+                    if (firstPass)
+                        job->addDependency(firstPass);
                     JOBS.add(job);
+                }
+            } else {
+                JOBS.add(job);
+            }
+        }
+    }
+}
+
+bool EncodeDock::parseSplitExport(MeltJob *job,
+                                  const QString &target,
+                                  QDomDocument &dom,
+                                  QDomElement &consumerNode)
+{
+    if (ui->disableVideoCheckbox->isChecked() || !dom.setContent(job->xml()))
+        return false;
+    QDomNodeList consumers = dom.elementsByTagName("consumer");
+    if (consumers.length() != 1)
+        return false;
+    consumerNode = consumers.at(0).toElement();
+    if (consumerNode.attribute("f") == "image2"
+        || QDir::fromNativeSeparators(consumerNode.attribute("target"))
+               != QDir::fromNativeSeparators(target))
+        return false;
+    // Subtitle streams cannot always be copied into the target format.
+    QDomNamedNodeMap attributes = consumerNode.attributes();
+    for (int i = 0; i < attributes.length(); ++i) {
+        if (attributes.item(i).nodeName().startsWith("subtitle."))
+            return false;
+    }
+    return true;
+}
+
+static void consumerFrameRate(const QDomElement &consumerNode, int &fpsNum, int &fpsDen)
+{
+    fpsNum = consumerNode.hasAttribute("frame_rate_num")
+                 ? consumerNode.attribute("frame_rate_num").toInt()
+                 : MLT.profile().frame_rate_num();
+    fpsDen = consumerNode.hasAttribute("frame_rate_den")
+                 ? consumerNode.attribute("frame_rate_den").toInt()
+                 : MLT.profile().frame_rate_den();
+}
+
+bool EncodeDock::enqueuePieces(MeltJob *job,
+                               QDomDocument &dom,
+                               QDomElement &consumerNode,
+                               const QString &target,
+                               int in,
+                               int out,
+                               const QList<ExportPiece> &pieces,
+                               const QString &pieceFormat)
+{
+    auto listFile = Util::writableTemporaryFile(target, "shotcut-XXXXXX.txt");
+    if (!listFile->open()) {
+        LOG_ERROR() << "failed to open temporary file" << listFile->fileName();
+        delete listFile;
+        return false;
+    }
+    int fpsNum, fpsDen;
+    consumerFrameRate(consumerNode, fpsNum, fpsDen);
+    QStringList concatArgs{"-f", "concat", "-safe", "0", "-i", listFile->fileName()};
+    QStringList files;
+    QList<AbstractJob *> jobs;
+    const auto format = consumerNode.attribute("f");
+    const auto movflags = consumerNode.attribute("movflags");
+    consumerNode.setAttribute("f", "matroska");
+    consumerNode.removeAttribute("movflags");
+
+    // Render the audio once so there is no seam at the piece boundaries.
+    const bool hasAudio = !ui->disableAudioCheckbox->isChecked();
+    if (hasAudio) {
+        const auto audioFile = target + ".audio.mkv";
+        consumerNode.setAttribute("target", audioFile);
+        consumerNode.setAttribute("video_off", 1);
+        auto audioJob = new MeltJob(audioFile, dom.toString(2), fpsNum, fpsDen);
+        audioJob->setLabel(tr("%1 audio").arg(job->label()));
+        audioJob->setInAndOut(in, out);
+        // Audio alone is light and should not keep a piece from an encode slot.
+        audioJob->setResourceClass(AbstractJob::DiskResource);
+        jobs << audioJob;
+        files << audioFile;
+        concatArgs << "-i" << audioFile;
+        consumerNode.removeAttribute("video_off");
+    }
+    consumerNode.setAttribute("f", pieceFormat);
+    consumerNode.setAttribute("audio_off", 1);
+    const QString extension = pieceFormat == "mpegts" ? "ts" : "mkv";
+    // Every few pieces go to the render nodes, in proportion to their number.
+    const int localSlots = JobQueue::jobSlots(job->resourceClass());
+    const int nodeCount = job->resourceClass() == AbstractJob::GpuEncodeResource
+                              ? 0
+                              : Settings.jobRenderNodes().size();
+    for (int i = 0; i < pieces.size(); ++i) {
+        const auto &piece = pieces[i];
+        const auto pieceFile = QStringLiteral("%1.segment%2.%3").arg(target).arg(i + 1).arg(extension);
+        AbstractJob *pieceJob;
+        if (piece.resource.isEmpty()) {
+            consumerNode.setAttribute("target", pieceFile);
+            auto meltJob = new MeltJob(pieceFile, dom.toString(2), fpsNum, fpsDen);
+            meltJob->setInAndOut(piece.in, piece.out);
+            meltJob->setUseMultiConsumer(job->useMultiConsumer());
+            meltJob->setResourceClass(job->resourceClass());
+            if (i % (localSlots + nodeCount) >= localSlots) {
+                meltJob->setRemote();
+                meltJob->setResourceClass(AbstractJob::RemoteRenderResource);
+            }
+            pieceJob = meltJob;
+        } else {
+            // Seek to the key frame and copy as many packets as there are frames.
+            QStringList args{"-ss",
+                             QString::number(piece.start, 'f', 6),
+                             "-i",
+                             piece.resource,
+                             "-map",
+                             "0:v:0",
+                             "-frames:v",
+                             QString::number(piece.out - piece.in + 1),
+                             "-c",
+                             "copy",
+                             "-avoid_negative_ts",
+                             "make_zero",
+                             "-f",
+                             pieceFormat,
+                             "-y",
+                             pieceFile};
+            pieceJob = new FfmpegJob(QDir::toNativeSeparators(pieceFile), args, false);
+            pieceJob->setResourceClass(AbstractJob::DiskResource);
+        }
+        pieceJob->setLabel(tr("%1 segment %2").arg(job->label()).arg(i + 1));
+        jobs << pieceJob;
+        files << pieceFile;
+        QString path = QFileInfo(pieceFile).absoluteFilePath();
+        listFile->write(QStringLiteral("file '%1'\n").arg(path.replace("'", "'\\''")).toUtf8());
+    }
+    listFile->close();
+
+    // Join the pieces without encoding them again.
+    concatArgs << "-map" << "0:v";
+    if (hasAudio)
+        concatArgs << "-map" << "1:a";
+    concatArgs << "-c" << "copy";
+    if (!movflags.isEmpty())
+        concatArgs << "-movflags" << movflags;
+    if (!format.isEmpty())
+        concatArgs << "-f" << format;
+    concatArgs << "-y" << target;
+    auto concatJob = new FfmpegJob(QDir::toNativeSeparators(target), concatArgs, false);
+    concatJob->setLabel(job->label());
+    concatJob->setTarget(target);
+    concatJob->setResourceClass(AbstractJob::DiskResource);
+    listFile->setParent(concatJob);
+    for (auto pieceJob : jobs)
+        concatJob->addDependency(pieceJob);
+    connect(concatJob, &AbstractJob::finished, this, [files]() {
+        for (const auto &file : files)
+            QFile::remove(file);
+    });
+    delete job;
+
+    for (auto pieceJob : jobs)
+        JOBS.add(pieceJob);
+    JOBS.add(concatJob);
+    return true;
+}
+
+bool EncodeDock::enqueueSegments(MeltJob *job, Mlt::Producer *service, const QString &target)
+{
+    // Each encode slot of the job queue and each render node exports one segment.
+    int segmentCount = m_segmentCount;
+    if (segmentCount <= 0) {
+        segmentCount = JobQueue::jobSlots(job->resourceClass());
+        if (job->resourceClass() != AbstractJob::GpuEncodeResource)
+            segmentCount += Settings.jobRenderNodes().size();
+    }
+    if (segmentCount < 2)
+        return false;
+    QDomDocument dom;
+    QDomElement consumerNode;
+    if (!parseSplitExport(job, target, dom, consumerNode))
+        return false;
+
+    // Start each segment on a GOP boundary to keep the key frame interval.
+    const int in = qMax(0, job->in());
+    const int out = job->out() > -1 ? job->out() : service->get_playtime() - 1;
+    const int length = out - in + 1;
+    const int gop = qMax(1, consumerNode.attribute("g").toInt());
+    segmentCount = qMin(segmentCount, length / gop);
+    if (segmentCount < 2)
+        return false;
+    const int segmentLength = (length / segmentCount + gop - 1) / gop * gop;
+    LOG_INFO() << "exporting" << target << "in segments of" << segmentLength << "frames";
+
+    QList<ExportPiece> pieces;
+    for (int segmentIn = in; segmentIn <= out; segmentIn += segmentLength)
+        pieces << ExportPiece{segmentIn, qMin(out, segmentIn + segmentLength - 1), QString(), 0.0};
+    return enqueuePieces(job, dom, consumerNode, target, in, out, pieces, "matroska");
+}
+
+namespace {
+
+//! One resolution and bitrate of an adaptive streaming ladder.
+struct LadderRendition
+{
+    int width;
+    int height;
+    int bitrate;
+    QString playlist;
+};
+
+} // namespace
+
+//! Returns the CODECS attribute of an HLS variant, which players use to skip
+//! the ones they cannot decode.
+static QString hlsCodecs(bool isHevc, int height)
+{
+    QString video;
+    if (isHevc)
+        video = height > 1080 ? "hvc1.1.6.L150.90" : "hvc1.1.6.L120.90";
+    else
+        video = height > 1080 ? "avc1.640033" : (height > 480 ? "avc1.640028" : "avc1.64001f");
+    return video + ",mp4a.40.2";
+}
+
+bool EncodeDock::enqueueStreamingLadder(MeltJob *job, const QString &target)
+{
+    QDomDocument dom;
+    QDomElement consumerNode;
+    if (!parseSplitExport(job, target, dom, consumerNode))
+        return false;
+    int fpsNum, fpsDen;
+    consumerFrameRate(consumerNode, fpsNum, fpsDen);
+    const double fps = double(fpsNum) / qMax(1, fpsDen);
+    const int topHeight = consumerNode.attribute("height", QString::number(MLT.profile().height()))
+                              .toInt();
+    const double aspect = consumerNode.hasAttribute("aspect")
+                              ? consumerNode.attribute("aspect").toDouble()
+                              : MLT.profile().dar();
+    if (topHeight < 2 || aspect <= 0.0)
+        return false;
+
+    // HEVC is only allowed in fragmented MP4 segments.
+    const auto vcodec = consumerNode.attribute("vcodec");
+    const bool isTs = consumerNode.attribute("f") == "mpegts";
+    const bool isHevc = !isTs && (vcodec == "libx265" || vcodec.startsWith("hevc_"));
+    QString encoder = isHevc ? "libx265" : "libx264";
+    if (ui->hwencodeCheckBox->isChecked()) {
+        for (const auto &hw : Settings.encodeHardware()) {
+            if (hw.startsWith(isHevc ? "hevc_" : "h264_")) {
+                encoder = hw;
+                break;
             }
         }
     }
+
+    // The top rung has the size of the export, the others common smaller sizes.
+    QList<int> heights{topHeight};
+    for (const int height : {1080, 720, 480, 360}) {
+        if (height < topHeight && heights.size() < kLadderRungs)
+            heights << height;
+    }
+    const QFileInfo info(target);
+    const auto baseName = info.completeBaseName();
+    const auto master = info.dir().filePath(baseName + ".m3u8");
+    const int gop = qMax(1, qRound(fps * kLadderSegmentSeconds / 2.0));
+    QList<LadderRendition> renditions;
+    for (const int height : heights) {
+        const int width = qRound(height * aspect / 2.0) * 2;
+        const int bitrate = qRound(width * height * fps * kLadderBitsPerPixel);
+        renditions << LadderRendition{width,
+                                      height,
+                                      bitrate,
+                                      QStringLiteral("%1_%2p.m3u8").arg(baseName).arg(height)};
+    }
+    LOG_INFO() << "exporting" << renditions.size() << "renditions of" << master << "with"
+               << encoder;
+
+    // Each rendition is a consumer of the multi consumer, which renders the
+    // frames once and scales them for each one.
+    static const QStringList rateControl{"vb",
+                                         "vbufsize",
+                                         "vminrate",
+                                         "vmaxrate",
+                                         "crf",
+                                         "qscale",
+                                         "vq",
+                                         "vqp",
+                                         "vglobal_quality",
+                                         "cq",
+                                         "qmin",
+                                         "qmax",
+                                         "rc",
+                                         "vbr",
+                                         "vtune",
+                                         "x265-params",
+                                         "svtav1-params",
+                                         "movflags",
+                                         "pass",
+                                         "passlogfile"};
+    for (const auto &name : rateControl)
+        consumerNode.removeAttribute(name);
+    consumerNode.setAttribute("vcodec", encoder);
+    consumerNode.setAttribute("f", "hls");
+    consumerNode.setAttribute("hls_time", kLadderSegmentSeconds);
+    consumerNode.setAttribute("hls_playlist_type", "vod");
+    consumerNode.setAttribute("hls_flags", "independent_segments");
+    consumerNode.setAttribute("hls_segment_type", isTs ? "mpegts" : "fmp4");
+    // Fixed key frames, so every rendition switches at the same frames.
+    consumerNode.setAttribute("g", gop);
+    consumerNode.setAttribute("keyint_min", gop);
+    consumerNode.setAttribute("sc_threshold", 0);
+    if (encoder.endsWith("_nvenc"))
+        consumerNode.setAttribute("no-scenecut", 1);
+    else if (encoder == "libx265")
+        consumerNode.setAttribute("x265-params",
+                                  QStringLiteral("keyint=%1:min-keyint=%1:scenecut=0").arg(gop));
+    if (!ui->disableAudioCheckbox->isChecked()) {
+        consumerNode.setAttribute("acodec", "aac");
+        consumerNode.setAttribute("ab", kLadderAudioBitrate);
+    }
+    const auto parent = consumerNode.parentNode();
+    for (const auto &rendition : renditions) {
+        QDomElement node = consumerNode.cloneNode().toElement();
+        const auto name = QFileInfo(rendition.playlist).completeBaseName();
+        node.setAttribute("target", info.dir().filePath(rendition.playlist));
+        node.setAttribute("width", rendition.width);
+        node.setAttribute("height", rendition.height);
+        node.setAttribute("vb", rendition.bitrate);
+        node.setAttribute("vmaxrate", rendition.bitrate * 3 / 2);
+        node.setAttribute("vbufsize", rendition.bitrate * 2);
+        node.setAttribute("hls_segment_filename",
+                          info.dir().filePath(name + (isTs ? "_%05d.ts" : "_%05d.m4s")));
+        if (!isTs)
+            node.setAttribute("hls_fmp4_init_filename", name + "_init.mp4");
+        parent.insertBefore(node, consumerNode);
+    }
+    parent.removeChild(consumerNode);
+
+    auto ladderJob = new EncodeJob(QDir::toNativeSeparators(master),
+                                   dom.toString(2),
+                                   fpsNum,
+                                   fpsDen,
+                                   Settings.jobPriority());
+    ladderJob->setUseMultiConsumer();
+    ladderJob->setInAndOut(job->in(), job->out());
+    ladderJob->setTarget(master);
+    if (isHardwareEncoder(encoder))
+        ladderJob->setResourceClass(AbstractJob::GpuEncodeResource);
+    const bool hasAudio = !ui->disableAudioCheckbox->isChecked();
+    connect(ladderJob,
+            &AbstractJob::finished,
+            this,
+            [master, renditions, isTs, isHevc, hasAudio, fps](AbstractJob *, bool isSuccess) {
+                if (!isSuccess)
+                    return;
+                // The muxer writes the variant playlists, and this lists them.
+                QStringList lines{"#EXTM3U",
+                                  QStringLiteral("#EXT-X-VERSION:%1").arg(isTs ? 3 : 7),
+                                  "#EXT-X-INDEPENDENT-SEGMENTS"};
+                for (const auto &rendition : renditions) {
+                    const int audio = hasAudio ? kLadderAudioBitrate : 0;
+                    auto codecs = hlsCodecs(isHevc, rendition.height);
+                    if (!hasAudio)
+                        codecs = codecs.section(',', 0, 0);
+                    lines << QStringLiteral("#EXT-X-STREAM-INF:BANDWIDTH=%1,AVERAGE-BANDWIDTH=%2,"
+                                            "RESOLUTION=%3x%4,FRAME-RATE=%5,CODECS=\"%6\"")
+                                 .arg(rendition.bitrate * 3 / 2 + audio)
+                                 .arg(rendition.bitrate + audio)
+                                 .arg(rendition.width)
+                                 .arg(rendition.height)
+                                 .arg(fps, 0, 'f', 3)
+                                 .arg(codecs);
+                    lines << rendition.playlist;
+                }
+                QSaveFile file(master);
+                if (file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+                    file.write(lines.join('\n').toUtf8() + '\n');
+                    file.commit();
+                } else {
+                    LOG_ERROR() << "failed to write the master playlist" << master;
+                }
+            });
+    ladderJob->setLabel(job->label());
+    delete job;
+    JOBS.add(ladderJob);
+    return true;
+}
+
+namespace {
+
+//! A range of a timeline clip that might be copied from its source file.
+struct SmartRenderClip
+{
+    QString resource;
+    int position; // The timeline frame of the first frame
+    int in;       // The source frame at position
+    int count;
+};
+
+} // namespace
+
+//! Returns the codec name FFmpeg gives the output of \a vcodec, if it can be copied.
+static QString smartRenderCodec(const QString &vcodec)
+{
+    if (vcodec == "libx264" || vcodec.startsWith("h264_"))
+        return "h264";
+    if (vcodec == "libx265" || vcodec.startsWith("hevc_"))
+        return "hevc";
+    if (vcodec.startsWith("prores"))
+        return "prores";
+    if (vcodec == "dnxhd")
+        return "dnxhd";
+    return QString();
+}
+
+static bool hasVideoFilters(Mlt::Service &service)
+{
+    for (int i = 0; i < service.filter_count(); ++i) {
+        std::unique_ptr<Mlt::Filter> filter(service.filter(i));
+        if (!filter || !filter->is_valid() || filter->get_int("_loader") || filter->get_int("disable"))
+            continue;
+        auto meta = MAIN.filterController()->metadataForService(filter.get());
+        if (!meta || !meta->isAudio())
+            return true;
+    }
+    return false;
+}
+
+static bool canCopyClip(Mlt::ClipInfo &info,
+                        const QDomElement &consumerNode,
+                        const QString &codec,
+                        int fpsNum,
+                        int fpsDen)
+{
+    Mlt::Producer &producer = *info.producer;
+    if (!QString::fromUtf8(producer.get("mlt_service")).startsWith("avformat")
+        || producer.get_int(kIsProxyProperty) || hasVideoFilters(producer)
+        || hasVideoFilters(*info.cut))
+        return false;
+    // Links such as time remapping change the frames.
+    if (producer.type() == mlt_service_chain_type) {
+        Mlt::Chain chain(producer);
+        for (int i = 0; i < chain.link_count(); ++i) {
+            std::unique_ptr<Mlt::Link> link(chain.link(i));
+            if (link && link->is_valid() && !link->get_int("_loader"))
+                return false;
+        }
+    }
+    const int index = producer.get_int("video_index");
+    if (index < 0)
+        return false;
+    const auto key = QStringLiteral("meta.media.%1.codec.").arg(index);
+    const auto pixFmt = consumerNode.attribute("pix_fmt");
+    auto &profile = MLT.profile();
+    return QString::fromUtf8(producer.get((key + "name").toLatin1().constData())) == codec
+           && (pixFmt.isEmpty()
+               || QString::fromUtf8(producer.get((key + "pix_fmt").toLatin1().constData()))
+                      == pixFmt)
+           && producer.get_int("meta.media.width")
+                  == consumerNode.attribute("width", QString::number(profile.width())).toInt()
+           && producer.get_int("meta.media.height")
+                  == consumerNode.attribute("height", QString::number(profile.height())).toInt()
+           && producer.get_int("meta.media.progressive")
+                  == consumerNode.attribute("progressive", QString::number(profile.progressive()))
+                         .toInt()
+           && qint64(producer.get_int("meta.media.frame_rate_num")) * fpsDen
+                  == qint64(fpsNum) * producer.get_int("meta.media.frame_rate_den");
+}
+
+//! Returns the sorted source frames of the key frames near the range of \a clip.
+static QList<int> probeKeyFrames(const SmartRenderClip &clip, double fps)
+{
+    QList<int> result;
+    QFileInfo ffprobePath(qApp->applicationDirPath(), "ffprobe");
+    QProcess proc;
+    proc.start(ffprobePath.absoluteFilePath(),
+               {"-v", "error", "-show_entries", "format=start_time", "-of", "json", clip.resource});
+    if (!proc.waitForFinished() || proc.exitCode()) {
+        LOG_WARNING() << "failed to probe" << clip.resource;
+        return result;
+    }
+    auto format = QJsonDocument::fromJson(proc.readAllStandardOutput()).object()["format"];
+    const double startTime = format.toObject()["start_time"].toString().toDouble();
+
+    // The interval is given in stream time and reaches past both ends of the clip.
+    const double from = qMax(0.0, startTime + clip.in / fps - 1.0);
+    const double duration = clip.count / fps + 2.0;
+    proc.start(ffprobePath.absoluteFilePath(),
+               {"-v",
+                "error",
+                "-select_streams",
+                "v:0",
+                "-show_entries",
+                "packet=pts_time,flags",
+                "-read_intervals",
+                QStringLiteral("%1%+%2").arg(from, 0, 'f', 3).arg(duration, 0, 'f', 3),
+                "-of",
+                "json",
+                clip.resource});
+    if (!proc.waitForFinished(-1) || proc.exitCode()) {
+        LOG_WARNING() << "failed to probe the key frames of" << clip.resource;
+        return result;
+    }
+    const auto packets = QJsonDocument::fromJson(proc.readAllStandardOutput())
+                             .object()["packets"]
+                             .toArray();
+    for (const auto &value : packets) {
+        const auto packet = value.toObject();
+        if (packet["flags"].toString().startsWith('K') && packet.contains("pts_time"))
+            result << qRound((packet["pts_time"].toString().toDouble() - startTime) * fps);
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+bool EncodeDock::enqueueSmartRender(MeltJob *job, Mlt::Producer *service, const QString &target)
+{
+    auto tractor = MAIN.multitrack();
+    if (!tractor || service != tractor || job->useMultiConsumer())
+        return false;
+    QDomDocument dom;
+    QDomElement consumerNode;
+    if (!parseSplitExport(job, target, dom, consumerNode))
+        return false;
+    const auto codec = smartRenderCodec(consumerNode.attribute("vcodec"));
+    if (codec.isEmpty() || hasVideoFilters(*tractor))
+        return false;
+    const int in = qMax(0, job->in());
+    const int out = job->out() > -1 ? job->out() : service->get_playtime() - 1;
+    int fpsNum, fpsDen;
+    consumerFrameRate(consumerNode, fpsNum, fpsDen);
+    const double fps = double(fpsNum) / fpsDen;
+
+    // Only one video track may make the picture for its frames to be copied.
+    std::unique_ptr<Mlt::Playlist> videoTrack;
+    for (int i = 0; i < tractor->count(); ++i) {
+        std::unique_ptr<Mlt::Producer> track(tractor->track(i));
+        if (!track || !track->is_valid() || track->get_int(kAudioTrackProperty)
+            || (track->get_int("hide") & 1))
+            continue;
+        const auto id = QString::fromUtf8(track->get("id"));
+        if (id == kBackgroundTrackId || id == kRenderPreviewTrackId)
+            continue;
+        std::unique_ptr<Mlt::Playlist> playlist(new Mlt::Playlist(*track));
+        bool isEmpty = true;
+        for (int j = 0; j < playlist->count() && isEmpty; ++j)
+            isEmpty = playlist->is_blank(j);
+        if (isEmpty)
+            continue;
+        if (videoTrack || hasVideoFilters(*playlist))
+            return false;
+        videoTrack = std::move(playlist);
+    }
+    if (!videoTrack)
+        return false;
+
+    QList<SmartRenderClip> clips;
+    for (int i = 0; i < videoTrack->count(); ++i) {
+        if (videoTrack->is_blank(i))
+            continue;
+        std::unique_ptr<Mlt::ClipInfo> info(videoTrack->clip_info(i));
+        if (!info || !info->producer || !info->cut)
+            continue;
+        const int start = qMax(in, info->start);
+        const int end = qMin(out + 1, info->start + info->frame_count);
+        if (end - start < qCeil(fps) || !canCopyClip(*info, consumerNode, codec, fpsNum, fpsDen))
+            continue;
+        clips << SmartRenderClip{Util::GetFilenameFromProducer(info->producer),
+                                 start,
+                                 info->frame_in + start - info->start,
+                                 end - start};
+    }
+    if (clips.isEmpty())
+        return false;
+
+    QList<QList<int>> keyFrames;
+    {
+        LongUiTask longTask(tr("Smart Render"));
+        keyFrames = longTask.runAsync<QList<QList<int>>>(tr("Finding key frames..."),
+                                                         [clips, fps]() {
+                                                             QList<QList<int>> result;
+                                                             for (const auto &clip : clips)
+                                                                 result << probeKeyFrames(clip, fps);
+                                                             return result;
+                                                         });
+    }
+
+    // Copy each clip from its first key frame up to its last one and render the rest.
+    QList<ExportPiece> pieces;
+    int position = in;
+    int copiedFrames = 0;
+    for (int i = 0; i < clips.size(); ++i) {
+        const auto &clip = clips[i];
+        const auto &frames = keyFrames[i];
+        auto first = std::lower_bound(frames.cbegin(), frames.cend(), clip.in);
+        auto last = std::upper_bound(frames.cbegin(), frames.cend(), clip.in + clip.count);
+        if (first == frames.cend() || last == frames.cbegin())
+            continue;
+        const int from = *first;
+        const int to = *(last - 1);
+        if (to - from < qCeil(fps))
+            continue;
+        const int copyIn = clip.position + from - clip.in;
+        const int copyOut = clip.position + to - clip.in - 1;
+        if (copyIn > position)
+            pieces << ExportPiece{position, copyIn - 1, QString(), 0.0};
+        // Aim half a frame past the key frame so that rounding cannot seek before it.
+        pieces << ExportPiece{copyIn, copyOut, clip.resource, (from + 0.5) / fps};
+        copiedFrames += copyOut - copyIn + 1;
+        position = copyOut + 1;
+    }
+    if (!copiedFrames)
+        return false;
+    if (position <= out)
+        pieces << ExportPiece{position, out, QString(), 0.0};
+    LOG_INFO() << "smart rendering" << target << "copying" << copiedFrames << "of"
+               << (out - in + 1) << "frames";
+
+    // MPEG-TS repeats the parameter sets at each key frame, which lets pieces
+    // from different encoders be joined.
+    const bool isAnnexB = codec == "h264" || codec == "hevc";
+    return enqueuePieces(job,
+                         dom,
+                         consumerNode,
+                         target,
+                         in,
+                         out,
+                         pieces,
+                         isAnnexB ? "mpegts" : "matroska");
 }
 
 void EncodeDock::encode(const QString &target)
@@ -1814,8 +2895,15 @@ void EncodeDock::on_presetsTree_clicked(const QModelIndex &index)
                 preset->load(dir.absoluteFilePath(name).toLatin1().constData());
         } else {
             ui->removePresetButton->setEnabled(false);
-            preset = new Mlt::Properties(
-                (mlt_properties) m_presets->get_data(name.toLatin1().constData()));
+            // Load only the selected preset unless the repository is already loaded.
+            const QString fileName = QDir(presetsPath()).filePath(name);
+            if (!m_presets && !presetsPath().isEmpty() && QFileInfo::exists(fileName)) {
+                preset = new Mlt::Properties();
+                preset->load(fileName.toUtf8().constData());
+            } else {
+                preset = new Mlt::Properties(
+                    (mlt_properties) presets()->get_data(name.toLatin1().constData()));
+            }
         }
         if (preset->is_valid()) {
             QStringList textParts = name.split('/');
@@ -1824,7 +2912,7 @@ void EncodeDock::on_presetsTree_clicked(const QModelIndex &index)
             if (textParts.count() > 3) {
                 // textParts = ['consumer', 'avformat', profile, preset].
                 QString folder = textParts.at(2);
-                if (m_profiles->get_data(folder.toLatin1().constData())) {
+                if (profiles()->get_data(folder.toLatin1().constData())) {
                     // only set these fields if the folder is a profile
                     Mlt::Profile p(folder.toLatin1().constData());
                     ui->widthSpinner->setValue(p.width());
@@ -1873,6 +2961,12 @@ void EncodeDock::on_encodeButton_clicked()
 
     MLT.pause();
 
+    const auto presets = selectedPresets();
+    if (seekable && presets.size() > 1 && ui->fromCombo->currentData().toString() != "batch") {
+        enqueuePresets(presets);
+        return;
+    }
+
     QString directory = Settings.encodePath();
     auto projectBaseName = QFileInfo(MAIN.fileName()).completeBaseName();
     QString caption = seekable ? tr("Export Video/Audio") : tr("Capture File");
@@ -1933,13 +3027,8 @@ void EncodeDock::on_encodeButton_clicked()
     if (seekable) {
         MLT.purgeMemoryPool();
         // Batch encode
-        int threadCount = QThread::idealThreadCount();
-        if (threadCount > 2 && ui->parallelCheckbox->isChecked())
-            threadCount = qMin(threadCount - 1, 4);
-        else
-            threadCount = 1;
         enqueueAnalysis();
-        enqueueMelt(m_outputFilenames, Settings.playerGPU() ? -1 : -threadCount);
+        enqueueMelt(m_outputFilenames, exportRealtime());
     } else if (MLT.producer()->get_int(kBackgroundCaptureProperty)) {
         // Capture in background
         ui->dualPassCheckbox->setChecked(false);
@@ -1976,6 +3065,183 @@ void EncodeDock::on_encodeButton_clicked()
     }
 }
 
+int EncodeDock::exportRealtime() const
+{
+    int threadCount = QThread::idealThreadCount();
+    if (threadCount > 2 && ui->parallelCheckbox->isChecked())
+        threadCount = qMin(threadCount - 1, 4);
+    else
+        threadCount = 1;
+    return Settings.playerGPU() ? -1 : -threadCount;
+}
+
+int EncodeDock::batchConcurrency(int realtime, int count) const
+{
+    const auto vcodec = ui->videoCodecCombo->currentText();
+    const bool isVideo = !ui->disableVideoCheckbox->isChecked();
+    int result;
+    if (isVideo && isHardwareEncoder(vcodec)) {
+        result = qMax(Settings.jobGpuEncodeSlots(), hardwareEncoderSessions(vcodec));
+    } else {
+        // Each job renders with its realtime threads and encodes with the codec
+        // threads, and an encoder with automatic threads keeps about eight busy.
+        int encoderThreads = isVideo ? ui->videoCodecThreadsSpinner->value() : 1;
+        if (encoderThreads <= 0)
+            encoderThreads = kAutoEncoderThreads;
+        const int jobThreads = qAbs(realtime) + encoderThreads;
+        result = qMax(Settings.jobCpuEncodeSlots(), QThread::idealThreadCount() / jobThreads);
+    }
+    return qBound(1, qMin(result, kMaxBatchConcurrency), qMax(1, count));
+}
+
+bool EncodeDock::selectPreset(const QString &name)
+{
+    // The presets are in categories, and the custom ones in one more level of folders.
+    QList<QModelIndex> parents{QModelIndex()};
+    while (!parents.isEmpty()) {
+        const auto parent = parents.takeFirst();
+        for (int i = 0; i < m_presetsModel.rowCount(parent); ++i) {
+            const auto index = m_presetsModel.index(i, 0, parent);
+            if (m_presetsModel.hasChildren(index)) {
+                parents << index;
+            } else if (parent.isValid()
+                       && !m_presetsModel.data(index).toString().compare(name,
+                                                                         Qt::CaseInsensitive)) {
+                on_presetsTree_clicked(index);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool EncodeDock::exportTimeline(const QString &target, int segments)
+{
+    const int from = ui->fromCombo->findData("timeline");
+    if (from < 0)
+        return false;
+    ui->fromCombo->setCurrentIndex(from);
+    Mlt::Producer *service = fromProducer();
+    if (!service || !service->is_valid() || !MLT.isSeekable(service))
+        return false;
+    QString fileName = target;
+    if (!m_extension.isEmpty() && QFileInfo(fileName).suffix().isEmpty())
+        fileName += '.' + m_extension;
+    m_outputFilenames = QStringList(fileName);
+
+    // Analysis filters need a dialog, so they export with what they have.
+    MLT.purgeMemoryPool();
+    const bool segmented = ui->segmentedCheckbox->isChecked();
+    if (segments > 0)
+        ui->segmentedCheckbox->setChecked(segments > 1);
+    m_segmentCount = segments;
+    enqueueMelt(m_outputFilenames, exportRealtime());
+    m_segmentCount = 0;
+    ui->segmentedCheckbox->setChecked(segmented);
+    return true;
+}
+
+QModelIndexList EncodeDock::selectedPresets() const
+{
+    QModelIndexList result;
+    for (const auto &index : ui->presetsTree->selectionModel()->selectedIndexes()) {
+        // Skip the category items.
+        if (index.parent().isValid() && !m_presetsModel.hasChildren(index))
+            result << index;
+    }
+    return result;
+}
+
+void EncodeDock::enqueuePresets(const QModelIndexList &presets)
+{
+    Mlt::Producer *service = fromProducer(true);
+    if (!service)
+        return;
+    QString directory = Settings.encodePath();
+    if (!MAIN.fileName().isEmpty())
+        directory += "/" + QFileInfo(MAIN.fileName()).completeBaseName();
+    QString baseName = QFileDialog::getSaveFileName(this,
+                                                    tr("Export %n Presets", nullptr, presets.size()),
+                                                    directory,
+                                                    tr("Determined by Export (*)"),
+                                                    nullptr,
+                                                    Util::getFileDialogOptions());
+    if (baseName.isEmpty())
+        return;
+    QFileInfo fi(baseName);
+    Settings.setEncodePath(fi.path());
+    baseName = fi.dir().filePath(fi.completeBaseName());
+    if (Util::warnIfLowDiskSpace(baseName)) {
+        MAIN.showStatusMessage(tr("Export canceled"));
+        return;
+    }
+    MLT.purgeMemoryPool();
+    enqueueAnalysis();
+
+    // Make a consumer for each preset from the settings it puts into the dock,
+    // and then put back the settings of the dock.
+    std::unique_ptr<Mlt::Properties> properties{collectProperties(0, true)};
+    const int realtime = exportRealtime();
+    static const QRegularExpression kInvalidChars("[^\\w\\-]+");
+    std::unique_ptr<MeltJob> firstJob;
+    QDomDocument dom;
+    QStringList targets;
+    QStringList labels;
+    bool isHardware = false;
+    for (const auto &index : presets) {
+        on_presetsTree_clicked(index);
+        if (ui->formatCombo->currentText() == "image2")
+            continue;
+        auto presetName = m_presetsModel.data(index).toString().replace(kInvalidChars, "_");
+        while (presetName.endsWith('_'))
+            presetName.chop(1);
+        auto target = QStringLiteral("%1-%2").arg(baseName, presetName);
+        if (!m_extension.isEmpty())
+            target += '.' + m_extension;
+        std::unique_ptr<MeltJob> job(createMeltJob(service, target, realtime));
+        if (!job)
+            continue;
+        QDomDocument jobDom;
+        if (!jobDom.setContent(job->xml()))
+            continue;
+        QDomNodeList consumers = jobDom.elementsByTagName("consumer");
+        if (consumers.length() != 1)
+            continue;
+        if (!firstJob) {
+            dom = jobDom;
+            firstJob = std::move(job);
+        } else {
+            QDomNodeList existing = dom.elementsByTagName("consumer");
+            dom.documentElement().insertAfter(dom.importNode(consumers.at(0), true),
+                                              existing.at(existing.length() - 1));
+            isHardware = isHardware || job->resourceClass() == AbstractJob::GpuEncodeResource;
+        }
+        targets << target;
+        labels << QFileInfo(target).fileName();
+    }
+    resetOptions();
+    if (properties && properties->is_valid())
+        loadPresetFromProperties(*properties);
+    if (!firstJob)
+        return;
+
+    // The multi consumer renders each frame once for all of the encoders.
+    int fpsNum, fpsDen;
+    consumerFrameRate(dom.elementsByTagName("consumer").at(0).toElement(), fpsNum, fpsDen);
+    auto job = new EncodeJob(QDir::toNativeSeparators(targets.first()),
+                             dom.toString(2),
+                             fpsNum,
+                             fpsDen,
+                             Settings.jobPriority());
+    job->setLabel(labels.join(", "));
+    job->setInAndOut(firstJob->in(), firstJob->out());
+    job->setUseMultiConsumer(true);
+    job->setResourceClass(isHardware ? AbstractJob::GpuEncodeResource
+                                     : firstJob->resourceClass());
+    LOG_INFO() << "exporting" << targets.size() << "presets in one job:" << targets;
+    JOBS.add(job);
+}
+
 void EncodeDock::onAudioChannelsChanged()
 {
     setAudioChannels(MLT.audioChannels());
@@ -2320,7 +3586,8 @@ bool PresetsProxyModel::filterAcceptsRow(int source_row, const QModelIndex &sour
 
     const auto s = sourceModel()->data(index).toString()
                    + sourceModel()->data(index, Qt::ToolTipRole).toString()
-                   + sourceModel()->data(index, Qt::UserRole + 2).toString();
+                   + sourceModel()->data(index, kPresetExtensionRole).toString()
+                   + sourceModel()->data(index, kPresetCodecsRole).toString();
     return s.contains(filterRegularExpression());
 }
 
@@ -2599,6 +3866,26 @@ void EncodeDock::on_parallelCheckbox_clicked(bool checked)
     Settings.setEncodeParallelProcessing(checked);
 }
 
+void EncodeDock::on_segmentedCheckbox_clicked(bool checked)
+{
+    Settings.setEncodeSegmentedExport(checked);
+}
+
+void EncodeDock::on_smartRenderCheckbox_clicked(bool checked)
+{
+    Settings.setEncodeSmartRender(checked);
+}
+
+void EncodeDock::on_streamingLadderCheckbox_clicked(bool checked)
+{
+    Settings.setEncodeStreamingLadder(checked);
+}
+
+void EncodeDock::on_intraCacheCheckbox_clicked(bool checked)
+{
+    Settings.setEncodeUseIntraCache(checked);
+}
+
 bool EncodeDock::detectHardwareEncoders()
 {
     MAIN.showStatusMessage(tr("Detecting hardware encoders..."));
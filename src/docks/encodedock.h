@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2024 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -56,6 +56,17 @@ public:
 
     void loadPresetFromProperties(Mlt::Properties &);
     bool isExportInProgress() const;
+    //! Loads the preset whose name is \a name, ignoring case, and returns whether it exists.
+    bool selectPreset(const QString &name);
+    /*!
+      Queues the jobs to export the timeline to \a target without any dialog
+      and returns whether it did. More than one \a segments exports that many
+      segments in parallel.
+    */
+    bool exportTimeline(const QString &target, int segments = 0);
+
+protected:
+    void showEvent(QShowEvent *event) override;
 
 signals:
     void captureStateChanged(bool);
@@ -131,6 +142,12 @@ private slots:
 
     void on_parallelCheckbox_clicked(bool checked);
 
+    void on_segmentedCheckbox_clicked(bool checked);
+
+    void on_smartRenderCheckbox_clicked(bool checked);
+    void on_streamingLadderCheckbox_clicked(bool checked);
+    void on_intraCacheCheckbox_clicked(bool checked);
+
     void on_resolutionComboBox_activated(int arg1);
 
     void on_reframeButton_clicked();
@@ -152,6 +169,14 @@ private:
         AudioChannels4,
         AudioChannels6,
     };
+    //! A range of the export that one job renders, or copies from resource.
+    struct ExportPiece
+    {
+        int in;
+        int out;
+        QString resource;
+        double start; // The time in seconds of the first frame in resource
+    };
     Ui::EncodeDock *ui;
     Mlt::Properties *m_presets;
     QScopedPointer<MeltJob> m_immediateJob;
@@ -161,11 +186,17 @@ private:
     QStringList m_outputFilenames;
     bool m_isDefaultSettings;
     double m_fps;
+    int m_segmentCount; // 0 for one segment per encode slot
+    bool m_isCodecListsLoaded;
     QStringList m_intraOnlyCodecs;
     QStringList m_losslessVideoCodecs;
     QStringList m_losslessAudioCodecs;
 
     void loadPresets();
+    //! Loads the formats and codecs of avformat into the combos the first time it is called.
+    void loadCodecLists();
+    Mlt::Properties *presets();
+    Mlt::Properties *profiles();
     Mlt::Properties *collectProperties(int realtime, bool includeProfile = false);
     void collectProperties(QDomElement &node, int realtime);
     void setSubtitleProperties(QDomElement &node, Mlt::Producer *service);
@@ -185,6 +216,29 @@ private:
     void runMelt(const QString &target, int realtime = -1);
     void enqueueAnalysis();
     void enqueueMelt(const QStringList &targets, int realtime);
+    //! Returns the job that the second pass waits for, or null when the statistics
+    //! of an identical first pass were restored from the cache instead.
+    AbstractJob *enqueueFirstPass(MeltJob *job, const QString &target);
+    bool parseSplitExport(MeltJob *job,
+                          const QString &target,
+                          QDomDocument &dom,
+                          QDomElement &consumerNode);
+    bool enqueuePieces(MeltJob *job,
+                       QDomDocument &dom,
+                       QDomElement &consumerNode,
+                       const QString &target,
+                       int in,
+                       int out,
+                       const QList<ExportPiece> &pieces,
+                       const QString &pieceFormat);
+    bool enqueueSegments(MeltJob *job, Mlt::Producer *service, const QString &target);
+    bool enqueueSmartRender(MeltJob *job, Mlt::Producer *service, const QString &target);
+    bool enqueueStreamingLadder(MeltJob *job, const QString &target);
+    int exportRealtime() const;
+    //! Returns how many of \a count exports of the current preset can run at once.
+    int batchConcurrency(int realtime, int count) const;
+    QModelIndexList selectedPresets() const;
+    void enqueuePresets(const QModelIndexList &presets);
     void encode(const QString &target);
     void resetOptions();
     Mlt::Producer *fromProducer(bool usePlaylistBin = false) const;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024-2025 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,10 +22,15 @@
 #include "actions.h"
 #include "database.h"
 #include "dialogs/listselectiondialog.h"
+#include "directoryscanner.h"
+#include "executors.h"
 #include "mainwindow.h"
 #include "models/playlistmodel.h"
+#include "probecache.h"
 #include "qmltypes/qmlapplication.h"
 #include "settings.h"
+#include "thumbnaildecoderpool.h"
+#include "thumbnailscheduler.h"
 #include "util.h"
 #include "widgets/docktoolbar.h"
 #include "widgets/lineeditclear.h"
@@ -49,74 +54,41 @@
 #include <QProcess>
 #include <QPushButton>
 #include <QRunnable>
+#include <QSaveFile>
 #include <QSortFilterProxyModel>
 #include <QStandardPaths>
 #include <QStyledItemDelegate>
 #include <QThreadPool>
+#include <QTime>
 #include <QToolButton>
 
+#include <memory>
+
 static const auto kTilePaddingPx = 10;
 static const auto kTreeViewWidthPx = 150;
 static const auto kDetailedMode = QLatin1String("detailed");
 static const auto kIconsMode = QLatin1String("icons");
 static const auto kTiledMode = QLatin1String("tiled");
-static const QSet<QString> kAudioExtensions{
-    QLatin1String("m4a"),
-    QLatin1String("wav"),
-    QLatin1String("mp3"),
-    QLatin1String("ac3"),
-    QLatin1String("flac"),
-    QLatin1String("oga"),
-    QLatin1String("opus"),
-    QLatin1String("wma"),
-    QLatin1String("mka"),
-};
-static const QSet<QString> kImageExtensions{
-    QLatin1String("jpg"),
-    QLatin1String("jpeg"),
-    QLatin1String("png"),
-    QLatin1String("bmp"),
-    QLatin1String("tif"),
-    QLatin1String("tiff"),
-    QLatin1String("svg"),
-    QLatin1String("webp"),
-    QLatin1String("gif"),
-    QLatin1String("tga"),
-};
-static const QSet<QString> kOtherExtensions{
-    QLatin1String("mlt"),   QLatin1String("xml"), QLatin1String("txt"),      QLatin1String("pdf"),
-    QLatin1String("doc"),   QLatin1String("gpx"), QLatin1String("rawr"),     QLatin1String("stab"),
-    QLatin1String("srt"),   QLatin1String("so"),  QLatin1String("dll"),      QLatin1String("exe"),
-    QLatin1String("zip"),   QLatin1String("edl"), QLatin1String("kdenlive"), QLatin1String("osp"),
-    QLatin1String("blend"), QLatin1String("swf"), QLatin1String("cube"),     QLatin1String("json"),
-};
-static const QSet<QString> kVideoExtensions{
-    QLatin1String("mp4"),
-    QLatin1String("m4v"),
-    QLatin1String("avi"),
-    QLatin1String("mpg"),
-    QLatin1String("mpeg"),
-    QLatin1String("ts"),
-    QLatin1String("mts"),
-    QLatin1String("m2ts"),
-    QLatin1String("mkv"),
-    QLatin1String("ogv"),
-    QLatin1String("webm"),
-    QLatin1String("dv"),
-    QLatin1String("lrv"),
-    QLatin1String("360"),
-    QLatin1String("flv"),
-    QLatin1String("wmv"),
-};
+static const auto kCacheDirName = QLatin1String("files");
+static const auto kCacheFileHeader = QByteArrayLiteral("shotcut files 1\t");
+static const int kCacheFieldCount = 8;
+static const int kSaveCacheDelayMs = 3000;
+static const QSet<QString> &kAudioExtensions = DirectoryScanner::audioExtensions();
+static const QSet<QString> &kImageExtensions = DirectoryScanner::imageExtensions();
+static const QSet<QString> &kOtherExtensions = DirectoryScanner::otherExtensions();
+static const QSet<QString> &kVideoExtensions = DirectoryScanner::videoExtensions();
 
 static void cacheMediaType(FilesModel *model,
                            const QString &filePath,
-                           int mediaType,
+                           const FilesDock::CacheItem &item,
                            const QModelIndex &index);
 static void cacheThumbnail(FilesModel *model,
                            const QString &filePath,
                            QImage &image,
                            const QModelIndex &index);
+static void cachePlaceholderThumbnail(FilesModel *model,
+                                      const QString &filePath,
+                                      const QModelIndex &index);
 
 class FilesMediaTypeTask : public QRunnable
 {
@@ -136,24 +108,41 @@ public:
     void run()
     {
         static Mlt::Profile profile{"atsc_720p_60"};
-        Mlt::Producer producer(profile, m_filePath.toUtf8().constData());
-        auto mediaType = PlaylistModel::Other;
-        if (producer.is_valid()) {
-            if (MLT.isImageProducer(&producer)) {
-                mediaType = PlaylistModel::Image;
-            } else {
-                auto service = QString::fromLatin1(producer.get("mlt_service"));
-                if (service.startsWith(QLatin1String("avformat"))) {
-                    if (producer.get_int("video_index") > -1
-                        && Util::getSuggestedFrameRate(&producer) != 90000)
-                        mediaType = PlaylistModel::Video;
-                    else if (producer.get_int("audio_index") > -1)
-                        mediaType = PlaylistModel::Audio;
+        // A probed file need not be opened again.
+        std::unique_ptr<Mlt::Producer> producer(PROBES.open(profile, m_filePath));
+        if (!producer) {
+            producer.reset(new Mlt::Producer(profile, m_filePath.toUtf8().constData()));
+            PROBES.insert(*producer);
+        }
+        FilesDock::CacheItem item;
+        item.mediaType = PlaylistModel::Other;
+        item.durationMs = 0;
+        if (producer->is_valid()) {
+            auto service = QString::fromLatin1(producer->get("mlt_service"));
+            if (MLT.isImageProducer(producer.get())) {
+                item.mediaType = PlaylistModel::Image;
+            } else if (service.startsWith(QLatin1String("avformat"))) {
+                const auto videoIndex = producer->get_int("video_index");
+                const auto audioIndex = producer->get_int("audio_index");
+                if (videoIndex > -1 && Util::getSuggestedFrameRate(producer.get()) != 90000)
+                    item.mediaType = PlaylistModel::Video;
+                else if (audioIndex > -1)
+                    item.mediaType = PlaylistModel::Audio;
+                if (item.mediaType != PlaylistModel::Other) {
+                    const auto streamIndex = item.mediaType == PlaylistModel::Video ? videoIndex
+                                                                                    : audioIndex;
+                    const auto key = QStringLiteral("meta.media.%1.codec.name").arg(streamIndex);
+                    item.codec = QString::fromLatin1(producer->get(key.toLatin1().constData()));
+                    item.durationMs = qRound(producer->get_length() * 1000.0 / profile.fps());
                 }
             }
+            if (item.mediaType == PlaylistModel::Video || item.mediaType == PlaylistModel::Image) {
+                item.width = producer->get_int("meta.media.width");
+                item.height = producer->get_int("meta.media.height");
+            }
         }
-        LOG_DEBUG() << "Mlt::Producer" << m_filePath << mediaType;
-        cacheMediaType(m_model, m_filePath, mediaType, m_index);
+        LOG_DEBUG() << "Mlt::Producer" << m_filePath << item.mediaType;
+        cacheMediaType(m_model, m_filePath, item, m_index);
     }
 };
 
@@ -179,7 +168,7 @@ public:
     }
 
 private:
-    bool isValidService(Mlt::Producer &producer) const
+    static bool isValidService(Mlt::Producer &producer)
     {
         if (producer.is_valid()) {
             auto service = QString::fromLatin1(producer.get("mlt_service"));
@@ -193,23 +182,20 @@ public:
     void run()
     {
         LOG_DEBUG() << "Mlt::Producer" << m_filePath;
-        QImage image;
-        static Mlt::Profile profile{"atsc_720p_60"};
-        Mlt::Producer producer(profile, "abnormal", m_filePath.toUtf8().constData());
-        if (isValidService(producer)) {
-            Mlt::Filter scaler(profile, "swscale");
-            Mlt::Filter padder(profile, "resize");
-            Mlt::Filter converter(profile, "avcolor_space");
-            producer.attach(scaler);
-            producer.attach(padder);
-            producer.attach(converter);
-
-            auto width = PlaylistModel::THUMBNAIL_WIDTH * 2;
-            auto height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
-            image = MLT.image(producer, 0, width, height);
-        }
+        auto width = PlaylistModel::THUMBNAIL_WIDTH * 2;
+        auto height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
+        auto image = ThumbnailDecoderPool::singleton().image(QStringLiteral("abnormal"),
+                                                             m_filePath,
+                                                             0,
+                                                             width,
+                                                             height,
+                                                             ThumbnailDecoderPool::AccurateSeek,
+                                                             isValidService);
         if (!image.isNull()) {
             cacheThumbnail(m_model, m_filePath, image, m_index);
+        } else {
+            // Cache a placeholder to not try again.
+            cachePlaceholderThumbnail(m_model, m_filePath, m_index);
         }
     }
 };
@@ -222,6 +208,7 @@ public:
         MediaTypeRole,
         MediaTypeStringRole,
         ThumbnailRole,
+        CodecRole,
     };
 
     explicit FilesModel(FilesDock *parent = nullptr)
@@ -245,8 +232,22 @@ public:
             return names[i];
         }
         switch (role) {
-        case Qt::ToolTipRole:
-            return QDir::toNativeSeparators(info.filePath());
+        case Qt::ToolTipRole: {
+            auto result = QDir::toNativeSeparators(info.filePath());
+            if (isDir)
+                return result;
+            const auto item = m_dock->getCacheItem(info);
+            if (item.durationMs > 0)
+                result += QStringLiteral("\n")
+                          + QTime::fromMSecsSinceStartOfDay(item.durationMs).toString("hh:mm:ss.zzz");
+            if (item.width > 0 && item.height > 0)
+                result += QStringLiteral("\n%1x%2").arg(item.width).arg(item.height);
+            if (!item.codec.isEmpty())
+                result += QStringLiteral("\n") + item.codec;
+            return result;
+        }
+        case CodecRole:
+            return isDir ? QString() : m_dock->getCacheItem(info).codec;
         case DateRole:
             return info.lastModified();
         case MediaTypeRole:
@@ -254,14 +255,25 @@ public:
         case ThumbnailRole: {
             const auto path = info.filePath();
             const auto thumbnailKey = FilesThumbnailTask::cacheKey(path);
-            auto image = DB.getThumbnail(thumbnailKey);
-            if (image.isNull()) {
-                ::cacheThumbnail(const_cast<FilesModel *>(this), path, image, index);
-                if (!path.endsWith(QStringLiteral(".mlt"), Qt::CaseInsensitive)
-                    && !info.isShortcut())
-                    QThreadPool::globalInstance()->start(
-                        new FilesThumbnailTask(const_cast<FilesModel *>(this), path, index));
-            }
+            const auto isShortcut = info.isShortcut();
+            const QPersistentModelIndex persistentIndex(index);
+            auto model = const_cast<FilesModel *>(this);
+            auto image = DB.requestThumbnail(thumbnailKey, model, [=](const QImage &image) {
+                if (!persistentIndex.isValid())
+                    return;
+                if (image.isNull()) {
+                    if (path.endsWith(QStringLiteral(".mlt"), Qt::CaseInsensitive) || isShortcut) {
+                        QImage placeholder;
+                        ::cacheThumbnail(model, path, placeholder, persistentIndex);
+                    } else {
+                        model->updateThumbnails(persistentIndex, true);
+                    }
+                } else {
+                    emit model->dataChanged(persistentIndex, persistentIndex);
+                }
+            });
+            if (image.isNull())
+                image = placeholderThumbnail(index);
             return image;
         }
         default:
@@ -271,12 +283,21 @@ public:
         return QFileSystemModel::data(index, role);
     }
 
-    void updateThumbnails(const QModelIndex &index)
+    void updateThumbnails(const QModelIndex &index, bool isCancellable = false)
     {
         const auto path = filePath(index);
-        if (!path.endsWith(QStringLiteral(".mlt"), Qt::CaseInsensitive))
-            QThreadPool::globalInstance()->start(
-                new FilesThumbnailTask(const_cast<FilesModel *>(this), path, index));
+        if (path.endsWith(QStringLiteral(".mlt"), Qt::CaseInsensitive))
+            return;
+        const QPersistentModelIndex persistentIndex(index);
+        auto model = this;
+        ThumbnailScheduler::singleton().request(
+            FilesThumbnailTask::cacheKey(path),
+            [=]() {
+                if (persistentIndex.isValid())
+                    FilesThumbnailTask(model, path, persistentIndex).run();
+            },
+            this,
+            isCancellable);
     }
 
 private:
@@ -284,57 +305,63 @@ private:
 
     int mediaType(const QModelIndex &index) const
     {
-        auto path = filePath(index);
-        auto mediaType = m_dock->getCacheMediaType(path);
+        const auto info = fileInfo(index);
+        auto item = m_dock->getCacheItem(info);
 
-        if (mediaType < 0) {
-            const auto info = QFileInfo(path);
+        if (item.mediaType < 0) {
+            const auto path = info.filePath();
             const auto ext = info.suffix().toLower();
             if (info.isDir() || kOtherExtensions.contains(ext)) {
-                m_dock->setCacheMediaType(path, mediaType);
+                m_dock->setCacheMediaType(path, PlaylistModel::Other);
                 return PlaylistModel::Other;
             }
-            if (kAudioExtensions.contains(ext)) {
-                m_dock->setCacheMediaType(path, mediaType);
-                return PlaylistModel::Audio;
-            }
-            if (kImageExtensions.contains(ext)) {
-                m_dock->setCacheMediaType(path, mediaType);
-                return PlaylistModel::Image;
-            }
-            if (kVideoExtensions.contains(ext)) {
-                m_dock->setCacheMediaType(path, mediaType);
-                return PlaylistModel::Video;
-            }
-            mediaType = PlaylistModel::Pending;
-            m_dock->setCacheMediaType(path, mediaType);
-            QThreadPool::globalInstance()->start(
-                new FilesMediaTypeTask(const_cast<FilesModel *>(this), path, index));
+            if (kAudioExtensions.contains(ext))
+                item.mediaType = PlaylistModel::Audio;
+            else if (kImageExtensions.contains(ext))
+                item.mediaType = PlaylistModel::Image;
+            else if (kVideoExtensions.contains(ext))
+                item.mediaType = PlaylistModel::Video;
+            // Get the details, and the type if the extension is unknown, in the
+            // background, after the files whose type is pending.
+            const auto priority = item.mediaType < 0 ? 0 : -1;
+            if (item.mediaType < 0)
+                item.mediaType = PlaylistModel::Pending;
+            m_dock->setCacheMediaType(path, item.mediaType);
+            auto task = new FilesMediaTypeTask(const_cast<FilesModel *>(this), path, index);
+            Executors::start(Executors::AnalysisExecutor, task, priority);
         }
 
-        return mediaType;
+        return item.mediaType;
     }
 
 public:
-    void cacheMediaType(const QString &filePath, int mediaType, const QModelIndex &index)
+    void cacheMediaType(const QString &filePath,
+                        const FilesDock::CacheItem &item,
+                        const QModelIndex &index)
     {
-        m_dock->setCacheMediaType(filePath, mediaType);
+        m_dock->setCacheItem(QFileInfo(filePath), item);
         emit dataChanged(index, index);
     }
 
+    QImage placeholderThumbnail(const QModelIndex &index) const
+    {
+        QImage image(64, 64, QImage::Format_ARGB32);
+        image.fill(Qt::transparent);
+        if (index.isValid()) {
+            const auto pixmap = QFileSystemModel::data(index, Qt::DecorationRole)
+                                    .value<QIcon>()
+                                    .pixmap({16, 16}, m_dock->devicePixelRatioF());
+            QPainter painter(&image);
+            QIcon(pixmap).paint(&painter, image.rect());
+        }
+        return image;
+    }
+
     void cacheThumbnail(const QString &filePath, QImage &image, const QModelIndex &index)
     {
         bool updateModel = !image.isNull();
         if (image.isNull()) {
-            image = QImage(64, 64, QImage::Format_ARGB32);
-            image.fill(Qt::transparent);
-            if (index.isValid()) {
-                const auto pixmap = QFileSystemModel::data(index, Qt::DecorationRole)
-                                        .value<QIcon>()
-                                        .pixmap({16, 16}, m_dock->devicePixelRatioF());
-                QPainter painter(&image);
-                QIcon(pixmap).paint(&painter, image.rect());
-            }
+            image = placeholderThumbnail(index);
         }
         auto key = FilesThumbnailTask::cacheKey(filePath);
         DB.putThumbnail(key, image);
@@ -345,10 +372,10 @@ public:
 
 static void cacheMediaType(FilesModel *model,
                            const QString &filePath,
-                           int mediaType,
+                           const FilesDock::CacheItem &item,
                            const QModelIndex &index)
 {
-    model->cacheMediaType(filePath, mediaType, index);
+    model->cacheMediaType(filePath, item, index);
 }
 
 static void cacheThumbnail(FilesModel *model,
@@ -359,6 +386,21 @@ static void cacheThumbnail(FilesModel *model,
     model->cacheThumbnail(filePath, image, index);
 }
 
+static void cachePlaceholderThumbnail(FilesModel *model,
+                                      const QString &filePath,
+                                      const QModelIndex &index)
+{
+    // The placeholder is drawn from an icon, which needs the GUI thread.
+    const QPersistentModelIndex persistentIndex(index);
+    QMetaObject::invokeMethod(
+        model,
+        [=]() {
+            QImage placeholder;
+            model->cacheThumbnail(filePath, placeholder, persistentIndex);
+        },
+        Qt::QueuedConnection);
+}
+
 class FilesTileDelegate : public QStyledItemDelegate
 {
     Q_OBJECT
@@ -461,10 +503,11 @@ protected:
                 return false;
         }
 
-        // Text search
+        // Text search, including the codec if known
         return index.data(QFileSystemModel::FileNameRole)
-            .toString()
-            .contains(filterRegularExpression());
+                   .toString()
+                   .contains(filterRegularExpression())
+               || index.data(FilesModel::CodecRole).toString().contains(filterRegularExpression());
     }
 
     bool lessThan(const QModelIndex &left, const QModelIndex &right) const override
@@ -547,6 +590,9 @@ FilesDock::FilesDock(QWidget *parent)
     m_filesModel->setOption(QFileSystemModel::DontUseCustomDirectoryIcons);
     m_filesModel->setFilter(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
     m_filesModel->setReadOnly(true);
+    m_scanner = new DirectoryScanner(this);
+    connect(m_scanner, &DirectoryScanner::filesFound, this, &FilesDock::onSubfolderFilesFound);
+    loadCacheDirectory(QDir::fromNativeSeparators(Settings.filesCurrentDir()));
     m_filesModel->setRootPath(Settings.filesCurrentDir());
     ui->locationsCombo->setToolTip(Settings.filesCurrentDir());
     m_filesProxyModel = new FilesProxyModel(this);
@@ -678,6 +724,7 @@ FilesDock::FilesDock(QWidget *parent)
     m_searchField->setPlaceholderText(tr("search"));
     connect(m_searchField, &QLineEdit::textChanged, this, [=](const QString &search) {
         m_filesProxyModel->setFilterFixedString(search);
+        searchSubfolders();
         if (search.isEmpty()) {
             changeFilesDirectory(
                 m_filesProxyModel->mapFromSource(m_filesModel->index(m_filesModel->rootPath())));
@@ -754,27 +801,197 @@ FilesDock::FilesDock(QWidget *parent)
     }
     Actions.loadFromMenu(m_mainMenu);
 
+    m_saveCacheTimer.setSingleShot(true);
+    m_saveCacheTimer.setInterval(kSaveCacheDelayMs);
+    connect(&m_saveCacheTimer, &QTimer::timeout, this, &FilesDock::saveCacheDirectories);
+
     LOG_DEBUG() << "end";
 }
 
 FilesDock::~FilesDock()
 {
+    saveCacheDirectories();
     delete ui;
 }
 
+static QString cacheFilePath(const QString &dirPath)
+{
+    const auto hash = QCryptographicHash::hash(dirPath.toUtf8(), QCryptographicHash::Sha1);
+    QDir dir(Settings.appDataLocation());
+    return dir.filePath(QStringLiteral("%1/%2.txt").arg(kCacheDirName, hash.toHex()));
+}
+
 int FilesDock::getCacheMediaType(const QString &key)
 {
+    const QFileInfo info(key);
     QMutexLocker<QMutex> m_lock(&m_cacheMutex);
-    auto x = m_cache.find(key);
-    if (x == m_cache.end())
+    auto dir = m_cache.constFind(info.path());
+    if (dir == m_cache.constEnd())
+        return -1;
+    auto x = dir->constFind(info.fileName());
+    if (x == dir->constEnd())
         return -1;
     return x.value().mediaType;
 }
 
 void FilesDock::setCacheMediaType(const QString &key, int mediaType)
+{
+    const QFileInfo info(key);
+    QMutexLocker<QMutex> m_lock(&m_cacheMutex);
+    m_cache[info.path()][info.fileName()].mediaType = mediaType;
+}
+
+FilesDock::CacheItem FilesDock::getCacheItem(const QFileInfo &info)
 {
     QMutexLocker<QMutex> m_lock(&m_cacheMutex);
-    m_cache[key].mediaType = mediaType;
+    auto dir = m_cache.find(info.path());
+    if (dir == m_cache.end())
+        return CacheItem();
+    auto x = dir->find(info.fileName());
+    if (x == dir->end())
+        return CacheItem();
+    // An item loaded from a folder cache is only valid for the same file.
+    if (x->size >= 0
+        && (x->size != info.size() || x->lastModified != info.lastModified().toMSecsSinceEpoch())) {
+        dir->erase(x);
+        return CacheItem();
+    }
+    return x.value();
+}
+
+void FilesDock::setCacheItem(const QFileInfo &info, const CacheItem &item)
+{
+    {
+        QMutexLocker<QMutex> m_lock(&m_cacheMutex);
+        auto &x = m_cache[info.path()][info.fileName()];
+        x = item;
+        x.size = info.size();
+        x.lastModified = info.lastModified().toMSecsSinceEpoch();
+        m_dirtyCacheDirs << info.path();
+    }
+    // This may be called from a worker thread.
+    QMetaObject::invokeMethod(
+        this, [this]() { m_saveCacheTimer.start(); }, Qt::QueuedConnection);
+}
+
+void FilesDock::loadCacheDirectory(const QString &path)
+{
+    QMutexLocker<QMutex> m_lock(&m_cacheMutex);
+    if (m_cache.contains(path) || path.isEmpty())
+        return;
+    auto &items = m_cache[path];
+    QFile file(cacheFilePath(path));
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    // The first line names the folder in case two hash the same.
+    if (file.readLine() != kCacheFileHeader + path.toUtf8() + '\n')
+        return;
+    const auto lines = file.readAll().split('\n');
+    items.reserve(lines.size());
+    for (const auto &line : lines) {
+        const auto fields = line.split('\t');
+        if (fields.size() != kCacheFieldCount)
+            continue;
+        CacheItem item;
+        item.size = fields[1].toLongLong();
+        item.lastModified = fields[2].toLongLong();
+        item.mediaType = fields[3].toInt();
+        item.durationMs = fields[4].toInt();
+        item.width = fields[5].toInt();
+        item.height = fields[6].toInt();
+        item.codec = QString::fromUtf8(fields[7]);
+        items.insert(QString::fromUtf8(fields[0]), item);
+    }
+    LOG_DEBUG() << "loaded" << items.size() << "items for" << path;
+}
+
+void FilesDock::saveCacheDirectories()
+{
+    QMutexLocker<QMutex> m_lock(&m_cacheMutex);
+    for (const auto &path : std::as_const(m_dirtyCacheDirs)) {
+        const auto items = m_cache.value(path);
+        QByteArray data = kCacheFileHeader + path.toUtf8() + '\n';
+        for (auto it = items.constBegin(); it != items.constEnd(); ++it) {
+            // Skip the pending and the checked by extension only.
+            const auto &item = it.value();
+            if (item.size < 0 || item.mediaType < 0 || item.mediaType == PlaylistModel::Pending
+                || it.key().contains('\t') || it.key().contains('\n'))
+                continue;
+            data += it.key().toUtf8() + '\t' + QByteArray::number(item.size) + '\t'
+                    + QByteArray::number(item.lastModified) + '\t'
+                    + QByteArray::number(item.mediaType) + '\t'
+                    + QByteArray::number(item.durationMs) + '\t' + QByteArray::number(item.width)
+                    + '\t' + QByteArray::number(item.height) + '\t'
+                    + item.codec.toUtf8().replace('\t', ' ') + '\n';
+        }
+        const auto fileName = cacheFilePath(path);
+        QDir().mkpath(QFileInfo(fileName).path());
+        QSaveFile file(fileName);
+        if (file.open(QIODevice::WriteOnly)) {
+            file.write(data);
+            if (!file.commit())
+                LOG_WARNING() << "failed to save" << fileName;
+        }
+    }
+    m_dirtyCacheDirs.clear();
+}
+
+void FilesDock::searchSubfolders()
+{
+    const auto search = m_searchField->text();
+    const auto root = QDir::fromNativeSeparators(m_filesModel->rootPath());
+    if (search.isEmpty() || root.isEmpty())
+        return;
+    // The subfolders are listed once per folder and kept for the next searches.
+    if (root != m_scannedRoot) {
+        m_scannedRoot = root;
+        m_scannedFiles.clear();
+        m_fetchedDirs.clear();
+        m_scanner->start({root});
+        return;
+    }
+    for (auto it = m_scannedFiles.constBegin(); it != m_scannedFiles.constEnd(); ++it)
+        fetchIfMatching(it.key(), it.value());
+}
+
+void FilesDock::onSubfolderFilesFound(const QString &dirPath, const QList<QFileInfo> &files)
+{
+    auto &names = m_scannedFiles[dirPath];
+    names.reserve(files.size());
+    for (const auto &info : files)
+        names << info.fileName();
+    loadCacheDirectory(dirPath);
+    fetchIfMatching(dirPath, names);
+}
+
+void FilesDock::fetchIfMatching(const QString &dirPath, const QStringList &fileNames)
+{
+    if (m_fetchedDirs.contains(dirPath))
+        return;
+    const auto search = m_searchField->text();
+    if (search.isEmpty())
+        return;
+    bool isMatching = false;
+    {
+        // Match as FilesProxyModel does, including the cached codec.
+        QMutexLocker<QMutex> m_lock(&m_cacheMutex);
+        const auto items = m_cache.constFind(dirPath);
+        for (const auto &name : fileNames) {
+            if (name.contains(search, Qt::CaseInsensitive)
+                || (items != m_cache.constEnd()
+                    && items->value(name).codec.contains(search, Qt::CaseInsensitive))) {
+                isMatching = true;
+                break;
+            }
+        }
+    }
+    if (!isMatching)
+        return;
+    // The recursive filter only sees the folders that the model has loaded.
+    m_fetchedDirs << dirPath;
+    const auto index = m_filesModel->index(dirPath);
+    if (index.isValid() && m_filesModel->canFetchMore(index))
+        m_filesModel->fetchMore(index);
 }
 
 void FilesDock::setupActions()
@@ -1125,8 +1342,12 @@ void FilesDock::changeDirectory(const QString &filePath, bool updateLocation)
         const auto ls = QStandardPaths::standardLocations(QStandardPaths::HomeLocation);
         path = ls.first();
     }
+    loadCacheDirectory(QDir::fromNativeSeparators(path));
+    // The thumbnails of the previous folder are no longer visible.
+    ThumbnailScheduler::singleton().cancel(m_filesModel);
     index = m_filesModel->setRootPath(path);
     Settings.setFilesCurrentDir(path);
+    searchSubfolders();
     path = QDir::toNativeSeparators(path);
     ui->locationsCombo->setToolTip(path);
     if (updateLocation && path != ui->locationsCombo->currentText())
@@ -1152,6 +1373,7 @@ void FilesDock::changeFilesDirectory(const QModelIndex &index)
     ui->locationsCombo->setCurrentText(path);
     ui->locationsCombo->setToolTip(path);
     m_view->scrollToTop();
+    searchSubfolders();
 }
 
 void FilesDock::viewCustomContextMenuRequested(const QPoint &pos)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024-2025 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include <QFileSystemModel>
 #include <QHash>
 #include <QMutex>
+#include <QSet>
 #include <QTimer>
 #include <QUndoCommand>
 
@@ -38,6 +39,7 @@ class FilesProxyModel;
 class QSortFilterProxyModel;
 class LineEditClear;
 class QLabel;
+class DirectoryScanner;
 
 class FilesDock : public QDockWidget
 {
@@ -50,10 +52,20 @@ public:
     struct CacheItem
     {
         int mediaType{-1}; // -1 = unknown
+        qint64 size{-1};
+        qint64 lastModified{0};
+        int durationMs{-1}; // -1 = not probed
+        int width{0};
+        int height{0};
+        QString codec;
     };
 
     int getCacheMediaType(const QString &key);
     void setCacheMediaType(const QString &key, int mediaType);
+    //! Returns the cached item for the file, or one with no media type if the file changed.
+    CacheItem getCacheItem(const QFileInfo &info);
+    //! Caches the media type and details of a file and saves them with its folder.
+    void setCacheItem(const QFileInfo &info, const CacheItem &item);
 
 signals:
     void selectionChanged();
@@ -93,6 +105,11 @@ private:
     QString firstSelectedFilePath();
     QString firstSelectedMediaType();
     void openClip(const QString &filePath);
+    void loadCacheDirectory(const QString &path);
+    void saveCacheDirectories();
+    void searchSubfolders();
+    void onSubfolderFilesFound(const QString &dirPath, const QList<QFileInfo> &files);
+    void fetchIfMatching(const QString &dirPath, const QStringList &fileNames);
 
     Ui::FilesDock *ui;
     QAbstractItemView *m_view;
@@ -102,9 +119,17 @@ private:
     QItemSelectionModel *m_selectionModel;
     QMenu *m_mainMenu;
     FilesProxyModel *m_filesProxyModel;
-    QHash<QString, CacheItem> m_cache;
+    // The cached items are grouped by folder and then keyed by file name.
+    QHash<QString, QHash<QString, CacheItem>> m_cache;
+    QSet<QString> m_dirtyCacheDirs;
+    QTimer m_saveCacheTimer;
     QMutex m_cacheMutex;
     LineEditClear *m_searchField;
+    DirectoryScanner *m_scanner;
+    // The files found in the subfolders of m_scannedRoot for the search
+    QString m_scannedRoot;
+    QHash<QString, QStringList> m_scannedFiles;
+    QSet<QString> m_fetchedDirs;
     QLabel *m_label;
 };
 
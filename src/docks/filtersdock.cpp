@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -48,6 +48,8 @@ FiltersDock::FiltersDock(MetadataModel *metadataModel,
                          QWidget *parent)
     : QDockWidget(tr("Filters"), parent)
     , m_qview(QmlUtilities::sharedEngine(), this)
+    , m_componentCache(QmlUtilities::sharedEngine())
+    , m_metadataModel(metadataModel)
 {
     LOG_DEBUG() << "begin";
     setObjectName("FiltersDock");
@@ -72,6 +74,7 @@ FiltersDock::FiltersDock(MetadataModel *metadataModel,
     m_qview.rootContext()->setContextProperty("subtitlesModel", subtitlesModel);
     m_qview.rootContext()->setContextProperty("attachedfiltersmodel", attachedModel);
     m_qview.rootContext()->setContextProperty("producer", &m_producer);
+    m_qview.rootContext()->setContextProperty("componentCache", &m_componentCache);
     connect(&m_producer, SIGNAL(seeked(int)), SIGNAL(seeked(int)));
     connect(this, SIGNAL(producerInChanged(int)), &m_producer, SIGNAL(inChanged(int)));
     connect(this, SIGNAL(producerOutChanged(int)), &m_producer, SIGNAL(outChanged(int)));
@@ -197,6 +200,10 @@ void FiltersDock::load()
     m_qview.quickWindow()->setColor(palette().window().color());
     QUrl source = QUrl::fromLocalFile(viewPath.absoluteFilePath("filterview.qml"));
     m_qview.setSource(source);
+    if (!m_isPreloaded) {
+        m_isPreloaded = true;
+        QTimer::singleShot(0, this, &FiltersDock::preloadFavorites);
+    }
 
     QObject::connect(m_qview.rootObject(),
                      SIGNAL(currentFilterRequested(int)),
@@ -206,6 +213,20 @@ void FiltersDock::load()
                      SLOT(showCopyFilterMenu()));
 }
 
+void FiltersDock::preloadFavorites()
+{
+    // The favorites are the filters most likely to be opened first.
+    QList<QUrl> urls;
+    for (int i = 0; i < m_metadataModel->sourceRowCount(); ++i) {
+        auto meta = m_metadataModel->getFromSource(i);
+        if (meta && meta->isFavorite() && !meta->isHidden() && meta->type() == QmlMetadata::Filter
+            && !meta->qmlFileName().isEmpty())
+            urls << meta->qmlFilePath();
+    }
+    LOG_DEBUG() << "preloading" << urls.size() << "filter user interfaces";
+    m_componentCache.preload(urls);
+}
+
 void FiltersDock::setupActions()
 {
     QIcon icon;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 #ifndef FILTERSDOCK_H
 #define FILTERSDOCK_H
 
+#include "qmltypes/qmlcomponentcache.h"
 #include "qmltypes/qmlproducer.h"
 #include "sharedframe.h"
 
@@ -67,8 +68,12 @@ protected:
 
 private:
     void setupActions();
+    void preloadFavorites();
     QQuickWidget m_qview;
     QmlProducer m_producer;
+    QmlComponentCache m_componentCache;
+    MetadataModel *m_metadataModel;
+    bool m_isPreloaded{false};
     unsigned loadTries{0};
 };
 
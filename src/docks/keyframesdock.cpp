@@ -46,7 +46,7 @@ static QmlFilter m_emptyQmlFilter;
 
 KeyframesDock::KeyframesDock(QmlProducer *qmlProducer, QWidget *parent)
     : QDockWidget(tr("Keyframes"), parent)
-    , m_qview(QmlUtilities::sharedEngine(), this)
+    , m_qview(QmlUtilities::sharedEngine(), Settings.timelineThreadedRendering(), this)
     , m_qmlProducer(qmlProducer)
 {
     LOG_DEBUG() << "begin";
@@ -186,10 +186,10 @@ KeyframesDock::KeyframesDock(QmlProducer *qmlProducer, QWidget *parent)
 
     vboxLayout->setMenuBar(toolbar);
 
-    m_qview.setFocusPolicy(Qt::StrongFocus);
+    m_qview.widget()->setFocusPolicy(Qt::StrongFocus);
     m_qview.quickWindow()->setPersistentSceneGraph(false);
 #ifndef Q_OS_MAC
-    m_qview.setAttribute(Qt::WA_AcceptTouchEvents);
+    m_qview.widget()->setAttribute(Qt::WA_AcceptTouchEvents);
 #endif
     setWidget(&m_qview);
 
@@ -201,7 +201,7 @@ KeyframesDock::KeyframesDock(QmlProducer *qmlProducer, QWidget *parent)
     m_qview.setClearColor(palette().window().color());
     m_qview.quickWindow()->setPersistentSceneGraph(false);
 #ifndef Q_OS_MAC
-    m_qview.setAttribute(Qt::WA_AcceptTouchEvents);
+    m_qview.widget()->setAttribute(Qt::WA_AcceptTouchEvents);
 #endif
     setCurrentFilter(0, 0);
     connect(this, SIGNAL(visibilityChanged(bool)), this, SLOT(load(bool)));
@@ -20,9 +20,9 @@
 
 #include "models/keyframesmodel.h"
 #include "qmltypes/qmlfilter.h"
+#include "widgets/quickviewhost.h"
 
 #include <QDockWidget>
-#include <QQuickWidget>
 #include <QScopedPointer>
 
 class QmlFilter;
@@ -77,7 +77,7 @@ private slots:
 
 private:
     void setupActions();
-    QQuickWidget m_qview;
+    QuickViewHost m_qview;
     KeyframesModel m_model;
     QmlMetadata *m_metadata;
     QmlFilter *m_filter;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2024 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,7 +20,9 @@
 #include "Logger.h"
 #include "actions.h"
 #include "mainwindow.h"
+#include "mltcontroller.h"
 #include "models/markersmodel.h"
+#include "models/scenedetecttask.h"
 #include "settings.h"
 #include "util.h"
 #include "widgets/docktoolbar.h"
@@ -161,8 +163,10 @@ MarkersDock::MarkersDock(QWidget *parent)
     mainMenu->addAction(Actions["timelineNextMarkerAction"]);
     mainMenu->addAction(Actions["timelineDeleteMarkerAction"]);
     mainMenu->addAction(Actions["timelineMarkSelectedClipAction"]);
+    mainMenu->addAction(Actions["timelineMarkBeatsAction"]);
     mainMenu->addAction(Actions["timelineCycleMarkerColorAction"]);
     mainMenu->addAction(tr("Remove All Markers"), this, SLOT(onRemoveAllRequested()));
+    mainMenu->addAction(tr("Detect Scenes and Silence"), this, SLOT(onDetectScenesRequested()));
     QAction *action;
     QMenu *columnsMenu = new QMenu(tr("Columns"), this);
     action = columnsMenu->addAction(tr("Color"), this, SLOT(onColorColumnToggled(bool)));
@@ -353,6 +357,15 @@ void MarkersDock::onRemoveAllRequested()
     m_model->clear();
 }
 
+void MarkersDock::onDetectScenesRequested()
+{
+    if (!m_model || !MAIN.isMultitrackValid()) {
+        MAIN.showStatusMessage(tr("Add a clip to the timeline to detect scenes."));
+        return;
+    }
+    SceneDetectTask::start(MLT.XML(MAIN.multitrack()), m_model);
+}
+
 void MarkersDock::onSearchChanged()
 {
     if (m_proxyModel) {
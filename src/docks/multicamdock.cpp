@@ -0,0 +1,426 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "multicamdock.h"
+
+#include "Logger.h"
+#include "commands/timelinecommands.h"
+#include "executors.h"
+#include "mainwindow.h"
+#include "mltcontroller.h"
+#include "models/multitrackmodel.h"
+#include "proxymanager.h"
+#include "shotcut_mlt_properties.h"
+#include "thumbnaildecoderpool.h"
+#include "util.h"
+#include "widgets/docktoolbar.h"
+
+#include <QAction>
+#include <QComboBox>
+#include <QElapsedTimer>
+#include <QGridLayout>
+#include <QKeyEvent>
+#include <QLabel>
+#include <QPainter>
+#include <QUndoCommand>
+#include <QVBoxLayout>
+#include <QtMath>
+
+#include <functional>
+
+static const int kTileWidth = 320;
+static const int kMaxAngles = 9;
+// The share of the frame time of the decoding threads for the back angles.
+static const double kBackAngleBudget = 0.5;
+
+class MulticamTile : public QWidget
+{
+public:
+    MulticamTile(const QString &title, std::function<void()> onClicked, QWidget *parent)
+        : QWidget(parent)
+        , m_title(title)
+        , m_onClicked(onClicked)
+        , m_isLive(false)
+    {
+        setMinimumSize(kTileWidth / 2, kTileWidth / 4);
+        setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+        setCursor(Qt::PointingHandCursor);
+    }
+
+    void setTitle(const QString &title)
+    {
+        m_title = title;
+        update();
+    }
+
+    void setImage(const QImage &image)
+    {
+        m_image = image;
+        update();
+    }
+
+    void setLive(bool live)
+    {
+        m_isLive = live;
+        update();
+    }
+
+protected:
+    void paintEvent(QPaintEvent *) override
+    {
+        QPainter painter(this);
+        painter.fillRect(rect(), Qt::black);
+        if (!m_image.isNull()) {
+            const QSize size = m_image.size().scaled(this->size(), Qt::KeepAspectRatio);
+            const QRect target(QPoint((width() - size.width()) / 2,
+                                      (height() - size.height()) / 2),
+                               size);
+            painter.setRenderHint(QPainter::SmoothPixmapTransform);
+            painter.drawImage(target, m_image);
+        }
+        const QRect textRect = rect().adjusted(6, 4, -6, -4);
+        painter.setPen(Qt::black);
+        painter.drawText(textRect.translated(1, 1), Qt::AlignLeft | Qt::AlignTop, m_title);
+        painter.setPen(Qt::white);
+        painter.drawText(textRect, Qt::AlignLeft | Qt::AlignTop, m_title);
+        if (m_isLive) {
+            painter.setPen(QPen(Qt::red, 3));
+            painter.drawRect(rect().adjusted(1, 1, -2, -2));
+        }
+    }
+
+    void mousePressEvent(QMouseEvent *) override
+    {
+        if (m_onClicked)
+            m_onClicked();
+    }
+
+private:
+    QString m_title;
+    std::function<void()> m_onClicked;
+    QImage m_image;
+    bool m_isLive;
+};
+
+MulticamDock::MulticamDock(MultitrackModel *model, QWidget *parent)
+    : QDockWidget(tr("Multicam"), parent)
+    , m_model(model)
+    , m_liveAngle(0)
+    , m_nextBackAngle(0)
+    , m_position(0)
+    , m_generation(0)
+    , m_skippedFrames(0)
+{
+    LOG_DEBUG() << "begin";
+    setObjectName("MulticamDock");
+    QIcon icon = QIcon::fromTheme("view-grid", QIcon(":/icons/oxygen/32x32/actions/view-grid.png"));
+    setWindowIcon(icon);
+    toggleViewAction()->setIcon(windowIcon());
+
+    auto container = new QWidget;
+    auto vboxLayout = new QVBoxLayout(container);
+    vboxLayout->setContentsMargins(0, 0, 0, 0);
+    auto grid = new QWidget;
+    m_gridLayout = new QGridLayout(grid);
+    m_gridLayout->setContentsMargins(2, 2, 2, 2);
+    m_gridLayout->setSpacing(2);
+    vboxLayout->addWidget(grid, 1);
+
+    DockToolBar *toolbar = new DockToolBar(tr("Multicam Controls"));
+    toolbar->setAreaHint(Qt::BottomToolBarArea);
+    m_recordAction = toolbar->addAction(
+        QIcon::fromTheme("media-record", QIcon(":/icons/oxygen/32x32/actions/media-record.png")),
+        tr("Record Cuts"));
+    m_recordAction->setToolTip(
+        tr("Record switching the angles while playing, and add the cuts to the target track"));
+    m_recordAction->setCheckable(true);
+    connect(m_recordAction, &QAction::toggled, this, &MulticamDock::setRecording);
+    toolbar->addWidget(new QLabel(tr("Target")));
+    m_targetCombo = new QComboBox;
+    m_targetCombo->setToolTip(tr("The track that receives the cuts, which is not an angle"));
+    connect(m_targetCombo, &QComboBox::activated, this, &MulticamDock::rebuildAngles);
+    toolbar->addWidget(m_targetCombo);
+    m_statusLabel = new QLabel;
+    toolbar->addWidget(m_statusLabel);
+    vboxLayout->addWidget(toolbar);
+    setWidget(container);
+
+    connect(m_model, &MultitrackModel::created, this, &MulticamDock::rebuildAngles);
+    connect(m_model, &MultitrackModel::closed, this, &MulticamDock::rebuildAngles);
+    connect(m_model, &MultitrackModel::modified, this, &MulticamDock::rebuildAngles);
+    connect(m_model, &QAbstractItemModel::modelReset, this, &MulticamDock::rebuildAngles);
+    connect(this, &QDockWidget::visibilityChanged, this, &MulticamDock::onVisibilityChanged);
+    LOG_DEBUG() << "end";
+}
+
+void MulticamDock::setPosition(int position)
+{
+    m_position = position;
+    if (!isVisible() || m_angles.isEmpty() || !m_model->tractor())
+        return;
+
+    // The live angle gets every frame.
+    if (!m_angles[m_liveAngle].isBusy)
+        decode(m_liveAngle, position, true);
+
+    // The back angles take turns within the budget and skip while busy.
+    const int threads = Executors::statistics(Executors::InteractiveExecutor).maxThreads;
+    const double budget = 1000.0 / MLT.profile().fps() * qMax(1, threads) * kBackAngleBudget;
+    double spent = 0.0;
+    int next = -1;
+    for (int n = 0; n < m_angles.size(); ++n) {
+        const int i = (m_nextBackAngle + n) % m_angles.size();
+        if (i == m_liveAngle)
+            continue;
+        const auto &angle = m_angles[i];
+        if (angle.isBusy || (spent > 0.0 && spent + angle.averageMs > budget)
+            || !decode(i, position, false)) {
+            ++m_skippedFrames;
+            continue;
+        }
+        spent += m_angles[i].averageMs;
+        next = i + 1;
+    }
+    if (next >= 0)
+        m_nextBackAngle = next % m_angles.size();
+    updateStatus();
+}
+
+void MulticamDock::keyPressEvent(QKeyEvent *event)
+{
+    if (event->key() >= Qt::Key_1 && event->key() <= Qt::Key_9
+        && !(event->modifiers() & ~Qt::KeypadModifier)) {
+        switchAngle(event->key() - Qt::Key_1);
+        event->accept();
+        return;
+    }
+    QDockWidget::keyPressEvent(event);
+}
+
+void MulticamDock::rebuildAngles()
+{
+    QList<int> videoTracks;
+    for (int i = 0; i < m_model->trackList().size(); ++i) {
+        if (m_model->trackList().at(i).type == VideoTrackType)
+            videoTracks << i;
+    }
+    int target = m_targetCombo->currentData().toInt();
+    if (videoTracks != m_videoTracks || m_targetCombo->count() != videoTracks.size()) {
+        m_videoTracks = videoTracks;
+        m_targetCombo->clear();
+        for (int i : videoTracks)
+            m_targetCombo->addItem(m_model->getTrackName(i), i);
+        // The top track is the usual place to cut to.
+        const int index = m_targetCombo->findData(target);
+        m_targetCombo->setCurrentIndex(index >= 0 ? index : 0);
+        target = m_targetCombo->currentData().toInt();
+    }
+    QList<int> angleTracks;
+    for (int i : std::as_const(videoTracks)) {
+        if (i != target && angleTracks.size() < kMaxAngles)
+            angleTracks << i;
+    }
+    QList<int> currentTracks;
+    for (const auto &angle : std::as_const(m_angles))
+        currentTracks << angle.trackIndex;
+    if (angleTracks == currentTracks) {
+        for (int i = 0; i < m_angles.size(); ++i) {
+            const auto name = m_model->getTrackName(m_angles[i].trackIndex);
+            m_angles[i].tile->setTitle(QStringLiteral("%1  %2").arg(i + 1).arg(name));
+        }
+        return;
+    }
+
+    // Results of the old angles are dropped.
+    ++m_generation;
+    for (const auto &angle : std::as_const(m_angles))
+        delete angle.tile;
+    m_angles.clear();
+    const int columns = qCeil(qSqrt(angleTracks.size()));
+    for (int i = 0; i < angleTracks.size(); ++i) {
+        auto title = QStringLiteral("%1  %2").arg(i + 1).arg(m_model->getTrackName(angleTracks[i]));
+        auto tile = new MulticamTile(title, [this, i]() { switchAngle(i); }, this);
+        m_gridLayout->addWidget(tile, i / columns, i % columns);
+        m_angles << Angle{angleTracks[i], tile, false, 0.0};
+    }
+    m_liveAngle = qBound(0, m_liveAngle, qMax(0, m_angles.size() - 1));
+    m_nextBackAngle = 0;
+    if (!m_angles.isEmpty())
+        m_angles[m_liveAngle].tile->setLive(true);
+    LOG_DEBUG() << "angles" << angleTracks << "target" << target;
+    setPosition(m_position);
+}
+
+void MulticamDock::onVisibilityChanged(bool visible)
+{
+    if (visible) {
+        rebuildAngles();
+        setPosition(m_position);
+    }
+}
+
+void MulticamDock::setRecording(bool recording)
+{
+    if (recording) {
+        if (m_angles.isEmpty()) {
+            m_recordAction->setChecked(false);
+            return;
+        }
+        m_cuts = {Cut{m_position, m_angles[m_liveAngle].trackIndex}};
+        m_targetCombo->setEnabled(false);
+    } else {
+        m_cuts << Cut{m_position, -1};
+        applyCuts();
+        m_cuts.clear();
+        m_targetCombo->setEnabled(true);
+    }
+    updateStatus();
+}
+
+void MulticamDock::switchAngle(int angle)
+{
+    if (angle < 0 || angle >= m_angles.size() || angle == m_liveAngle)
+        return;
+    m_angles[m_liveAngle].tile->setLive(false);
+    m_liveAngle = angle;
+    m_angles[m_liveAngle].tile->setLive(true);
+    if (m_recordAction->isChecked()) {
+        // Switching after going back replaces the cuts from there on.
+        while (!m_cuts.isEmpty() && m_cuts.last().position >= m_position)
+            m_cuts.removeLast();
+        m_cuts << Cut{m_position, m_angles[angle].trackIndex};
+        updateStatus();
+    }
+    if (!m_angles[angle].isBusy)
+        decode(angle, m_position, true);
+}
+
+bool MulticamDock::decode(int angleIndex, int position, bool isLive)
+{
+    auto &angle = m_angles[angleIndex];
+    const int clipIndex = m_model->clipIndex(angle.trackIndex, position);
+    auto info = m_model->getClipInfo(angle.trackIndex, clipIndex);
+    if (!info || !info->cut || info->cut->is_blank()
+        || position >= info->start + info->frame_count) {
+        angle.tile->setImage(QImage());
+        return true;
+    }
+    QString service = QString::fromUtf8(info->producer->get("mlt_service"));
+    QString resource = QString::fromUtf8(info->producer->get("resource"));
+    if (!info->producer->get_int(kIsProxyProperty)) {
+        // Decode a proxy that exists even when the project does not use them.
+        const auto proxy = ProxyManager::existingFile(Util::getHash(*info->producer),
+                                                      ProxyManager::videoFilenameExtension(),
+                                                      MLT.projectFolder());
+        if (!proxy.isEmpty()) {
+            service = QStringLiteral("avformat-novalidate");
+            resource = proxy;
+        }
+    }
+    const int frameNumber = info->frame_in + position - info->start;
+    const int width = kTileWidth;
+    const int height = qRound(kTileWidth / MLT.profile().dar()) & ~1;
+    const int generation = m_generation;
+    auto task = [=]() {
+        QElapsedTimer timer;
+        timer.start();
+        const auto image = ThumbnailDecoderPool::singleton().image(service,
+                                                                   resource,
+                                                                   frameNumber,
+                                                                   width,
+                                                                   height);
+        const double ms = timer.nsecsElapsed() / 1000000.0;
+        QMetaObject::invokeMethod(
+            this,
+            [=]() { onDecoded(generation, angleIndex, image, ms); },
+            Qt::QueuedConnection);
+    };
+    if (isLive) {
+        Executors::start(Executors::InteractiveExecutor, task, 1);
+    } else if (!Executors::tryStart(Executors::InteractiveExecutor, task)) {
+        return false;
+    }
+    angle.isBusy = true;
+    return true;
+}
+
+void MulticamDock::onDecoded(int generation, int angleIndex, const QImage &image, double ms)
+{
+    if (generation != m_generation || angleIndex >= m_angles.size())
+        return;
+    auto &angle = m_angles[angleIndex];
+    angle.isBusy = false;
+    angle.averageMs = angle.averageMs > 0.0 ? angle.averageMs * 0.8 + ms * 0.2 : ms;
+    if (!image.isNull())
+        angle.tile->setImage(image);
+}
+
+void MulticamDock::applyCuts()
+{
+    const int target = m_targetCombo->currentData().toInt();
+    if (m_cuts.size() < 2 || target < 0 || target >= m_model->trackList().size())
+        return;
+    auto command = new QUndoCommand(tr("Record multicam cuts"));
+    int count = 0;
+    for (int i = 0; i + 1 < m_cuts.size(); ++i) {
+        const int start = m_cuts[i].position;
+        const int end = m_cuts[i + 1].position;
+        const int trackIndex = m_cuts[i].trackIndex;
+        if (end <= start || trackIndex < 0 || trackIndex >= m_model->trackList().size())
+            continue;
+        // A cut can span several clips of its angle.
+        for (int clipIndex : m_model->clipsInRange(trackIndex, start, end)) {
+            auto info = m_model->getClipInfo(trackIndex, clipIndex);
+            if (!info || !info->cut || info->cut->is_blank())
+                continue;
+            const int from = qMax(start, info->start);
+            const int to = qMin(end, info->start + info->frame_count);
+            if (to <= from)
+                continue;
+            const int in = info->frame_in + from - info->start;
+            QString xml = MLT.XML(info->producer);
+            Mlt::Producer producer(MLT.profile(), "xml-string", xml.toUtf8().constData());
+            producer.set_in_and_out(in, in + to - from - 1);
+            new Timeline::OverwriteCommand(*m_model,
+                                           target,
+                                           from,
+                                           MLT.XML(&producer),
+                                           false,
+                                           command);
+            ++count;
+        }
+    }
+    LOG_INFO() << "adding" << count << "clips for" << m_cuts.size() - 1 << "cuts to track"
+               << target;
+    if (count > 0) {
+        m_model->beginBatch();
+        MAIN.undoStack()->push(command);
+        m_model->endBatch();
+    } else {
+        delete command;
+    }
+}
+
+void MulticamDock::updateStatus()
+{
+    if (m_recordAction->isChecked())
+        m_statusLabel->setText(tr("Recording %n cut(s)", nullptr, m_cuts.size()));
+    else if (m_skippedFrames > 0)
+        m_statusLabel->setText(tr("%1 back angle frames skipped").arg(m_skippedFrames));
+    else
+        m_statusLabel->clear();
+}
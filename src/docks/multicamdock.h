@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MULTICAMDOCK_H
+#define MULTICAMDOCK_H
+
+#include <QDockWidget>
+#include <QImage>
+#include <QList>
+
+class MultitrackModel;
+class MulticamTile;
+class QAction;
+class QComboBox;
+class QGridLayout;
+class QLabel;
+
+/*!
+  \class MulticamDock
+  \brief Shows the video tracks of the timeline as camera angles in a grid.
+
+  The angles are expected to be synchronized already, for example with
+  Align to Reference Track. Each angle is decoded at the size of its tile,
+  from its proxy when there is one, on the interactive executor. The live
+  angle is decoded for every frame. The other angles share a budget of
+  about half of the frame time of the decoding threads, taken in turn, and
+  an angle whose last frame is not done yet skips the frame.
+
+  While recording, clicking a tile or pressing its number switches the live
+  angle at the playhead. When the recording stops, the cuts are copied from
+  the angles to the target track with one undo command.
+*/
+
+class MulticamDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit MulticamDock(MultitrackModel *model, QWidget *parent = 0);
+
+public slots:
+    void setPosition(int position);
+
+protected:
+    void keyPressEvent(QKeyEvent *event) override;
+
+private slots:
+    void rebuildAngles();
+    void onVisibilityChanged(bool visible);
+    void setRecording(bool recording);
+
+private:
+    struct Angle
+    {
+        int trackIndex;
+        MulticamTile *tile;
+        bool isBusy;
+        double averageMs; ///< Moving average of the decode time
+    };
+    struct Cut
+    {
+        int position;
+        int trackIndex;
+    };
+
+    void switchAngle(int angle);
+    bool decode(int angle, int position, bool isLive);
+    void onDecoded(int generation, int angle, const QImage &image, double ms);
+    void applyCuts();
+    void updateStatus();
+
+    MultitrackModel *m_model;
+    QComboBox *m_targetCombo;
+    QAction *m_recordAction;
+    QGridLayout *m_gridLayout;
+    QLabel *m_statusLabel;
+    QList<Angle> m_angles;
+    QList<int> m_videoTracks;
+    QList<Cut> m_cuts;
+    int m_liveAngle;
+    int m_nextBackAngle;
+    int m_position;
+    int m_generation;
+    int m_skippedFrames;
+};
+
+#endif // MULTICAMDOCK_H
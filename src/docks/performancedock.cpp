@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "performancedock.h"
+
+#include "Logger.h"
+#include "avformatcache.h"
+#include "mltcontroller.h"
+#include "models/audiolevelstask.h"
+#include "performancecounters.h"
+#include "videowidget.h"
+
+#include <QFormLayout>
+#include <QIcon>
+#include <QLabel>
+#include <QScrollArea>
+
+static const int kUpdateIntervalMs = 1000;
+
+PerformanceDock::PerformanceDock(QWidget *parent)
+    : QDockWidget(tr("Performance"), parent)
+    , m_layout(nullptr)
+    , m_values{}
+    , m_executorValues{}
+    , m_presentedFrames(0)
+    , m_droppedFrames(0)
+{
+    LOG_DEBUG() << "begin";
+    setObjectName("PerformanceDock");
+    QIcon icon = QIcon::fromTheme("view-list-details",
+                                  QIcon(":/icons/oxygen/32x32/actions/view-list-details.png"));
+    setWindowIcon(icon);
+    toggleViewAction()->setIcon(windowIcon());
+
+    auto container = new QWidget;
+    m_layout = new QFormLayout(container);
+    addRow(PresentedRow, tr("Presented"));
+    addRow(DecodedRow, tr("Decoded"));
+    addRow(DroppedRow, tr("Dropped / late"));
+    for (int i = 0; i < Executors::ExecutorCount; ++i) {
+        m_executorValues[i] = new QLabel;
+        m_executorValues[i]->setTextInteractionFlags(Qt::TextSelectableByMouse);
+        m_layout->addRow(Executors::name(Executors::Executor(i)), m_executorValues[i]);
+    }
+    addRow(AudioLevelsRow, tr("Audio levels tasks"));
+    addRow(AvformatRow, tr("Open media"));
+    if (PerformanceCounters::isEnabled) {
+        addRow(ThumbnailRow, tr("Thumbnail cache"));
+        addRow(MemoryPoolRow, tr("Memory pool purges"));
+        addRow(UndoRow, tr("Undo records"));
+    }
+    auto scrollArea = new QScrollArea;
+    scrollArea->setFrameShape(QFrame::NoFrame);
+    scrollArea->setWidgetResizable(true);
+    scrollArea->setWidget(container);
+    setWidget(scrollArea);
+
+    m_timer.setInterval(kUpdateIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &PerformanceDock::updateCounters);
+    connect(this, &QDockWidget::visibilityChanged, this, &PerformanceDock::onVisibilityChanged);
+    LOG_DEBUG() << "end";
+}
+
+void PerformanceDock::onVisibilityChanged(bool visible)
+{
+    if (visible) {
+        m_elapsed.invalidate();
+        updateCounters();
+        m_timer.start();
+    } else {
+        m_timer.stop();
+    }
+}
+
+void PerformanceDock::updateCounters()
+{
+    auto videoWidget = qobject_cast<Mlt::VideoWidget *>(MLT.videoWidget());
+    const int presented = videoWidget ? videoWidget->presentedFrames() : 0;
+    const int dropped = videoWidget ? videoWidget->droppedFrames() : 0;
+    const int late = videoWidget ? videoWidget->lateFrames() : 0;
+    if (m_elapsed.isValid() && m_elapsed.elapsed() > 0) {
+        // The counts restart with the consumer.
+        const double seconds = m_elapsed.restart() / 1000.0;
+        const int presentedDelta = qMax(0, presented - m_presentedFrames);
+        const int droppedDelta = qMax(0, dropped - m_droppedFrames);
+        m_values[PresentedRow]->setText(tr("%1 fps").arg(presentedDelta / seconds, 0, 'f', 1));
+        m_values[DecodedRow]->setText(
+            tr("%1 fps").arg((presentedDelta + droppedDelta) / seconds, 0, 'f', 1));
+    } else {
+        m_elapsed.start();
+    }
+    m_presentedFrames = presented;
+    m_droppedFrames = dropped;
+    m_values[DroppedRow]->setText(QStringLiteral("%1 / %2").arg(dropped).arg(late));
+
+    // Qt does not tell how many runnables wait in the queue.
+    for (int i = 0; i < Executors::ExecutorCount; ++i) {
+        const auto stats = Executors::statistics(Executors::Executor(i));
+        m_executorValues[i]->setText(tr("%1 of %2 threads active, %3 started")
+                                         .arg(stats.active)
+                                         .arg(stats.maxThreads)
+                                         .arg(stats.started));
+    }
+    m_values[AudioLevelsRow]->setText(QString::number(AudioLevelsTask::pendingCount()));
+    const auto &avformat = AvformatCache::singleton();
+    m_values[AvformatRow]->setText(tr("%1 kept for %2 clips near the playhead, %3 resizes")
+                                       .arg(avformat.size())
+                                       .arg(avformat.workingSet())
+                                       .arg(avformat.resizeCount()));
+
+    if (PerformanceCounters::isEnabled) {
+        using namespace PerformanceCounters;
+        const qint64 hits = value(ThumbnailMemoryHits) + value(ThumbnailDiskHits);
+        const qint64 lookups = hits + value(ThumbnailMisses);
+        m_values[ThumbnailRow]->setText(
+            tr("%1% of %2 lookups, %3 generated")
+                .arg(lookups ? 100.0 * hits / lookups : 0.0, 0, 'f', 1)
+                .arg(lookups)
+                .arg(value(ThumbnailsGenerated)));
+        m_values[MemoryPoolRow]->setText(QString::number(value(MemoryPoolPurges)));
+        const qint64 records = value(UndoRecords);
+        m_values[UndoRow]->setText(
+            tr("%1, %2 ms average")
+                .arg(records)
+                .arg(records ? value(UndoRecordNs) / 1e6 / records : 0.0, 0, 'f', 2));
+    }
+}
+
+void PerformanceDock::addRow(Row row, const QString &label)
+{
+    m_values[row] = new QLabel;
+    m_values[row]->setTextInteractionFlags(Qt::TextSelectableByMouse);
+    m_layout->addRow(label, m_values[row]);
+}
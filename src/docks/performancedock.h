@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERFORMANCEDOCK_H
+#define PERFORMANCEDOCK_H
+
+#include "executors.h"
+
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QObject>
+#include <QTimer>
+
+class QFormLayout;
+class QLabel;
+
+/*!
+  \class PerformanceDock
+  \brief Shows live counters of playback, caches and background work.
+
+  The counters are read once a second only while the dock is visible. The
+  rates are over the last second, and the counts since Shotcut started. The
+  rows that come from PerformanceCounters are left out when those are not
+  built.
+*/
+
+class PerformanceDock : public QDockWidget
+{
+    Q_OBJECT
+
+public:
+    explicit PerformanceDock(QWidget *parent = 0);
+
+private slots:
+    void onVisibilityChanged(bool visible);
+    void updateCounters();
+
+private:
+    enum Row {
+        PresentedRow,
+        DecodedRow,
+        DroppedRow,
+        AudioLevelsRow,
+        AvformatRow,
+        ThumbnailRow,
+        MemoryPoolRow,
+        UndoRow,
+        RowCount
+    };
+
+    void addRow(Row row, const QString &label);
+
+    QFormLayout *m_layout;
+    QLabel *m_values[RowCount];
+    QLabel *m_executorValues[Executors::ExecutorCount];
+    QTimer m_timer;
+    QElapsedTimer m_elapsed;
+    int m_presentedFrames;
+    int m_droppedFrames;
+};
+
+#endif // PERFORMANCEDOCK_H
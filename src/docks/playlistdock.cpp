@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,12 +19,15 @@
 
 #include "Logger.h"
 #include "actions.h"
+#include "backgroundtask.h"
 #include "commands/playlistcommands.h"
 #include "dialogs/durationdialog.h"
 #include "dialogs/filedatedialog.h"
 #include "dialogs/longuitask.h"
 #include "dialogs/resourcedialog.h"
 #include "dialogs/slideshowgeneratordialog.h"
+#include "directoryscanner.h"
+#include "docks/timelinedock.h"
 #include "mainwindow.h"
 #include "proxymanager.h"
 #include "qmltypes/qmlapplication.h"
@@ -38,7 +41,6 @@
 #include "widgets/playlistlistview.h"
 #include "widgets/playlisttable.h"
 
-#include <set>
 #include <QActionGroup>
 #include <QClipboard>
 #include <QDebug>
@@ -51,10 +53,15 @@
 #include <QLabel>
 #include <QMenu>
 #include <QPainter>
+#include <QPointer>
 #include <QPushButton>
 #include <QSortFilterProxyModel>
 #include <QStyledItemDelegate>
+#include <QThreadPool>
 #include <QToolButton>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <memory>
 
 static const auto kInOutChangedTimeoutMs = 100;
 static const auto kTilePaddingPx = 10;
@@ -149,26 +156,20 @@ private:
 class ProducerHashesParser : public Mlt::Parser
 {
 private:
-    std::vector<std::string> m_hashes;
+    QStringList m_hashes;
 
 public:
     ProducerHashesParser()
         : Mlt::Parser()
     {}
 
-    std::vector<std::string> &hashes()
-    {
-        std::sort(m_hashes.begin(), m_hashes.end());
-        std::set<std::string> unique(m_hashes.begin(), m_hashes.end());
-        std::copy(unique.begin(), unique.end(), std::back_inserter(m_hashes));
-        return m_hashes;
-    }
+    QSet<QString> hashes() const { return QSet<QString>(m_hashes.begin(), m_hashes.end()); }
 
     int on_start_filter(Mlt::Filter *) { return 0; }
     int on_start_producer(Mlt::Producer *producer)
     {
         if (producer->is_cut())
-            m_hashes.push_back(Util::getHash(producer->parent()).toStdString());
+            m_hashes << Util::getHash(producer->parent());
         return 0;
     }
     int on_end_producer(Mlt::Producer *) { return 0; }
@@ -202,18 +203,14 @@ public:
 
         // Duplicates
         m_functors.push_back([this](int row, const QModelIndex &index) {
-            // m_hashes contains the duplicates
-            auto clip = MAIN.playlist()->get_clip(row);
-            if (clip && clip->is_valid()) {
-                auto hash = Util::getHash(clip->parent()).toStdString();
-                return std::find(m_hashes.begin(), m_hashes.end(), hash) != m_hashes.end();
-            }
-            return false;
+            // m_hashCounts counts the clips in the playlist for each hash
+            auto hash = hashForRow(row);
+            return !hash.isNull() && m_hashCounts.value(hash) > 1;
         });
 
         // Not in a Bin
         m_functors.push_back([this](int row, const QModelIndex &index) {
-            auto clip = MAIN.playlist()->get_clip(row);
+            std::unique_ptr<Mlt::Producer> clip(MAIN.playlist()->get_clip(row));
             if (clip && clip->is_valid()) {
                 return QString::fromUtf8(clip->parent().get(kShotcutBinsProperty)).isEmpty();
             }
@@ -223,12 +220,43 @@ public:
         // Not In Timeline
         m_functors.push_back([this](int row, const QModelIndex &index) {
             // m_hashes contains the unique hashes in the timeline
-            auto clip = MAIN.playlist()->get_clip(row);
-            if (clip && clip->is_valid()) {
-                auto hash = Util::getHash(clip->parent()).toStdString();
-                return std::find(m_hashes.begin(), m_hashes.end(), hash) == m_hashes.end();
+            auto hash = hashForRow(row);
+            return !hash.isNull() && !m_hashes.contains(hash);
+        });
+    }
+
+    void setSourceModel(QAbstractItemModel *model) override
+    {
+        if (sourceModel())
+            sourceModel()->disconnect(this);
+        QSortFilterProxyModel::setSourceModel(model);
+        if (!model)
+            return;
+        // Keep the duplicate counts up to date from the changed rows only.
+        connect(model,
+                &QAbstractItemModel::rowsInserted,
+                this,
+                [this](const QModelIndex &, int first, int last) {
+                    if (m_smartBin == PlaylistDock::SmartBinDuplicates
+                        && countHashes(first, last, 1))
+                        invalidateFilter();
+                });
+        connect(model,
+                &QAbstractItemModel::rowsAboutToBeRemoved,
+                this,
+                [this](const QModelIndex &, int first, int last) {
+                    if (m_smartBin == PlaylistDock::SmartBinDuplicates)
+                        m_isFilterDirty = countHashes(first, last, -1) || m_isFilterDirty;
+                });
+        connect(model, &QAbstractItemModel::rowsRemoved, this, [this]() {
+            if (m_isFilterDirty) {
+                m_isFilterDirty = false;
+                invalidateFilter();
             }
-            return false;
+        });
+        connect(model, &QAbstractItemModel::modelReset, this, [this]() {
+            if (m_smartBin == PlaylistDock::SmartBinDuplicates)
+                setSmartBin(m_smartBin);
         });
     }
 
@@ -253,22 +281,14 @@ public:
 
         switch (bin) {
         case PlaylistDock::SmartBinDuplicates: {
-            int n = MAIN.playlist()->count();
-            std::vector<std::string> hashes;
-            for (int i = 0; i < n; ++i) {
-                auto clip = MAIN.playlist()->get_clip(i);
-                if (clip && clip->is_valid())
-                    hashes.push_back(Util::getHash(clip->parent()).toStdString());
-            }
-            std::sort(hashes.begin(), hashes.end());
-            std::set<std::string> unique(hashes.begin(), hashes.end());
-            m_hashes.clear();
-            std::set_difference(hashes.begin(),
-                                hashes.end(),
-                                unique.begin(),
-                                unique.end(),
-                                std::back_inserter(m_hashes));
-            LOG_INFO() << "Duplicates smart bin found" << m_hashes.size() << "items";
+            m_hashCounts.clear();
+            m_isFilterDirty = false;
+            if (MAIN.playlist())
+                countHashes(0, MAIN.playlist()->count() - 1, 1);
+            auto n = std::count_if(m_hashCounts.cbegin(), m_hashCounts.cend(), [](int count) {
+                return count > 1;
+            });
+            LOG_INFO() << "Duplicates smart bin found" << n << "items";
             break;
         }
         case PlaylistDock::SmartBinNotInTimeline: {
@@ -289,6 +309,15 @@ public:
 
     enum PlaylistDock::SmartBin smartBin() const { return m_smartBin; }
 
+    //! Adds the \a hashes of clips added to the timeline to the Not In Timeline smart bin.
+    void addTimelineHashes(const QSet<QString> &hashes)
+    {
+        if (m_smartBin != PlaylistDock::SmartBinNotInTimeline || m_hashes.contains(hashes))
+            return;
+        m_hashes.unite(hashes);
+        invalidateFilter();
+    }
+
     static QString smartBinName(int index)
     {
         QString names[] = {tr("All"), tr("Duplicates"), tr("Not In a Bin"), tr("Not In Timeline")};
@@ -325,7 +354,38 @@ private:
     QString m_bin;
     enum PlaylistDock::SmartBin m_smartBin{PlaylistDock::SmartBinNone};
     std::vector<std::function<bool(int row, const QModelIndex &index)>> m_functors;
-    std::vector<std::string> m_hashes;
+    QSet<QString> m_hashes;
+    QHash<QString, int> m_hashCounts;
+    bool m_isFilterDirty{false};
+
+    static QString hashForRow(int row)
+    {
+        std::unique_ptr<Mlt::Producer> clip(MAIN.playlist() ? MAIN.playlist()->get_clip(row)
+                                                            : nullptr);
+        if (clip && clip->is_valid())
+            return Util::getHash(clip->parent());
+        return QString();
+    }
+
+    // Adds delta to the counts of the hashes of the rows from first to last and
+    // returns whether a clip became or stopped being a duplicate.
+    bool countHashes(int first, int last, int delta)
+    {
+        bool isChanged = false;
+        for (int row = first; row <= last; ++row) {
+            auto hash = hashForRow(row);
+            if (hash.isNull())
+                continue;
+            int &count = m_hashCounts[hash];
+            const bool wasDuplicate = count > 1;
+            count += delta;
+            if (count <= 0)
+                m_hashCounts.remove(hash);
+            else if (wasDuplicate != (count > 1))
+                isChanged = true;
+        }
+        return isChanged;
+    }
 };
 
 PlaylistDock::PlaylistDock(QWidget *parent)
@@ -1301,46 +1361,150 @@ void PlaylistDock::moveClipDown()
     }
 }
 
+namespace {
+
+// Files opened in parallel on local and on network storage
+static const int kProbeThreads = 8;
+static const int kNetworkProbeThreads = 2;
+// Clips added to the model at once
+static const int kInsertBatchSize = 50;
+
+struct ProbedFile
+{
+    QString path;
+    bool isOpenFailed{false};
+    Mlt::Producer producer;
+};
+
+struct AddFilesState
+{
+    ~AddFilesState() { delete dialog; }
+
+    QPointer<ResourceDialog> dialog;
+    QList<Mlt::Producer> batch;
+    int insertNextAt{-1};
+    bool first{true};
+    bool resetIndex{true};
+};
+
+// Opens a file in a worker thread and computes its hash and thumbnails while at it.
+ProbedFile probeFile(const QString &path)
+{
+    ProbedFile result;
+    result.path = path;
+    if (MLT.checkFile(path)) {
+        result.isOpenFailed = true;
+    } else if (!path.endsWith(".mlt") && !path.endsWith(".xml")) {
+        // MLT XML is opened in the main thread because it may use the profile.
+        result.producer = Mlt::Producer(MLT.profile(), path.toUtf8().constData());
+        if (result.producer.is_valid()) {
+            // Reuse the open producer and its hash for the thumbnails.
+            Util::getHash(result.producer);
+            PlaylistModel::prefetchThumbnails(result.producer);
+        } else
+            result.isOpenFailed = true;
+    }
+    return result;
+}
+
+} // namespace
+
 void PlaylistDock::addFiles(int row, const QList<QUrl> &urls)
 {
-    auto resetIndex = true;
-    ResourceDialog dialog(this);
-    LongUiTask longTask(tr("Add Files"));
-    int insertNextAt = row;
-    bool first = true;
-    QStringList fileNames = Util::sortedFileList(Util::expandDirectories(urls));
-    qsizetype i = 0, count = fileNames.size();
-    for (auto &path : fileNames) {
-        if (MAIN.isSourceClipMyProject(path))
-            continue;
-        longTask.reportProgress(Util::baseName(path), i++, count);
-        if (MLT.checkFile(path)) {
-            emit showStatusMessage(tr("Failed to open ").append(path));
-            continue;
+    // The state of the files being added, which are applied as they are opened
+    auto state = std::make_shared<AddFilesState>();
+    state->dialog = new ResourceDialog(this);
+    state->insertNextAt = row;
+
+    auto addBatch = [this, state]() {
+        if (state->batch.isEmpty())
+            return;
+        // The playlist may have changed while the files were opening.
+        if (state->insertNextAt > m_model.rowCount())
+            state->insertNextAt = -1;
+        MAIN.undoStack()->push(
+            new Playlist::InsertProducersCommand(m_model, state->batch, state->insertNextAt));
+        if (state->insertNextAt >= 0)
+            state->insertNextAt += state->batch.size();
+        state->batch.clear();
+    };
+
+    auto addToBatch = [state](Mlt::Producer *producer) {
+        if (state->first) {
+            // Do not share the producer of the player with the playlist.
+            const auto xml = MLT.XML(producer).toUtf8();
+            state->batch << Mlt::Producer(MLT.profile(), "xml-string", xml.constData());
+        } else {
+            state->batch << Mlt::Producer(producer);
         }
-        Mlt::Producer p;
-        if (path.endsWith(".mlt") || path.endsWith(".xml")) {
-            p = Util::openMltVirtualClip(path);
-            if (p.is_valid()) {
-                first = false;
-            } else {
+    };
+
+    // Open the files in parallel but add them in order.
+    auto work = [urls](QPromise<ProbedFile> &promise) {
+        int searched = 0;
+        const auto expanded = DirectoryScanner::expandDirectories(urls, [&](int count) {
+            if (count > searched) {
+                searched = count;
+                const auto text = tr("Searching folders: %n file(s)", nullptr, count);
+                promise.setProgressValueAndText(count, text);
+            }
+        });
+        const auto fileNames = Util::sortedFileList(expanded);
+        const qsizetype count = fileNames.size();
+        promise.setProgressRange(searched, searched + count);
+
+        QThreadPool pool;
+        pool.setMaxThreadCount(!fileNames.isEmpty() && Util::isNetworkStorage(fileNames.first())
+                                   ? kNetworkProbeThreads
+                                   : qMin(kProbeThreads, QThread::idealThreadCount()));
+        QList<QFuture<ProbedFile>> futures;
+        futures.reserve(count);
+        for (const auto &path : fileNames)
+            futures << QtConcurrent::run(&pool, probeFile, path);
+        for (qsizetype i = 0; i < count && !promise.isCanceled(); ++i) {
+            promise.setProgressValueAndText(searched + i + 1, Util::baseName(fileNames[i]));
+            auto &future = futures[i];
+            future.waitForFinished();
+            promise.addResult(future.result());
+            future = QFuture<ProbedFile>();
+        }
+        // Skip the files that have not started opening.
+        pool.clear();
+    };
+
+    auto apply = [=](const QList<ProbedFile> &files) {
+        for (const auto &probed : files) {
+            const auto &path = probed.path;
+            if (MAIN.isSourceClipMyProject(path))
+                continue;
+            if (probed.isOpenFailed) {
                 emit showStatusMessage(tr("Failed to open ").append(path));
                 continue;
             }
-        } else {
-            p = Mlt::Producer(MLT.profile(), path.toUtf8().constData());
-        }
-        if (p.is_valid()) {
+            Mlt::Producer p;
+            if (path.endsWith(".mlt") || path.endsWith(".xml")) {
+                p = Util::openMltVirtualClip(path);
+                if (p.is_valid()) {
+                    state->first = false;
+                } else {
+                    emit showStatusMessage(tr("Failed to open ").append(path));
+                    continue;
+                }
+            } else {
+                p = probed.producer;
+            }
+            if (!p.is_valid())
+                continue;
             Mlt::Producer *producer = &p;
-            if (first) {
-                first = false;
+            if (state->first) {
+                state->first = false;
                 if (!MLT.producer() || !MLT.producer()->is_valid()) {
                     Mlt::Properties properties;
                     properties.set(kShotcutSkipConvertProperty, 1);
                     MAIN.open(path, &properties, false);
                     if (MLT.producer() && MLT.producer()->is_valid()) {
                         producer = MLT.producer();
-                        first = true;
+                        state->first = true;
                     }
                 }
             }
@@ -1357,52 +1521,54 @@ void PlaylistDock::addFiles(int row, const QList<QUrl> &urls)
             if (!MLT.isLiveProducer(producer) || producer->get_int(kShotcutVirtualClip)) {
                 ProxyManager::generateIfNotExists(*producer);
                 assignToBin(*producer);
-                if (row == -1)
-                    MAIN.undoStack()->push(new Playlist::AppendCommand(m_model, MLT.XML(producer)));
-                else
-                    MAIN.undoStack()->push(
-                        new Playlist::InsertCommand(m_model, MLT.XML(producer), insertNextAt++));
+                addToBatch(producer);
             } else {
-                LongUiTask::cancel();
+                addBatch();
                 DurationDialog durationDialog(this);
                 durationDialog.setDuration(MLT.profile().fps() * 5);
                 if (durationDialog.exec() == QDialog::Accepted) {
                     producer->set_in_and_out(0, durationDialog.duration() - 1);
                     assignToBin(*producer);
-                    if (row == -1)
-                        MAIN.undoStack()->push(
-                            new Playlist::AppendCommand(m_model, MLT.XML(producer)));
-                    else
-                        MAIN.undoStack()->push(
-                            new Playlist::InsertCommand(m_model, MLT.XML(producer), insertNextAt++));
+                    addToBatch(producer);
                 } else {
+                    delete producer;
                     continue;
                 }
             }
-            if (first) {
-                first = false;
+            if (state->first || state->batch.size() >= kInsertBatchSize)
+                addBatch();
+            if (state->first) {
+                state->first = false;
                 setIndex(0);
-                resetIndex = false;
+                state->resetIndex = false;
             }
-            dialog.add(producer);
+            if (state->dialog)
+                state->dialog->add(producer);
             delete producer;
         }
-    }
-    if (Settings.showConvertClipDialog() && dialog.producerCount() > 1 && dialog.hasTroubleClips()) {
-        dialog.selectTroubleClips();
-        dialog.setWindowTitle(tr("Dropped Files"));
-        longTask.cancel();
-        dialog.exec();
-    } else if (Settings.showConvertClipDialog() && dialog.producerCount() == 1) {
-        Mlt::Producer producer = dialog.producer(0);
-        QString convertAdvice = Util::getConversionAdvice(&producer);
-        if (!convertAdvice.isEmpty()) {
-            longTask.cancel();
-            Util::offerSingleFileConversion(convertAdvice, &producer, this);
+    };
+
+    auto finished = [=](bool) {
+        addBatch();
+        auto &dialog = state->dialog;
+        if (!dialog) {
+            return;
+        } else if (Settings.showConvertClipDialog() && dialog->producerCount() > 1
+                   && dialog->hasTroubleClips()) {
+            dialog->selectTroubleClips();
+            dialog->setWindowTitle(tr("Dropped Files"));
+            dialog->exec();
+        } else if (Settings.showConvertClipDialog() && dialog->producerCount() == 1) {
+            Mlt::Producer producer = dialog->producer(0);
+            QString convertAdvice = Util::getConversionAdvice(&producer);
+            if (!convertAdvice.isEmpty())
+                Util::offerSingleFileConversion(convertAdvice, &producer, this);
         }
-    }
-    if (resetIndex)
-        resetPlaylistIndex();
+        if (state->resetIndex)
+            resetPlaylistIndex();
+    };
+
+    BackgroundTask::start<ProbedFile>(tr("Add Files"), this, work, apply, finished);
 }
 
 void PlaylistDock::loadBins()
@@ -1754,6 +1920,35 @@ void PlaylistDock::refreshTimelineSmartBins()
     }
 }
 
+void PlaylistDock::onTimelineRowsInserted(const QModelIndex &parent, int first, int last)
+{
+    auto items = ui->treeWidget->selectedItems();
+    if (items.isEmpty() || SmartBinNotInTimeline != items.first()->data(0, Qt::UserRole).toInt())
+        return;
+    if (!parent.isValid()) {
+        // Tracks were added.
+        refreshTimelineSmartBins();
+        return;
+    }
+    // Only look at the clips that were added.
+    QSet<QString> hashes;
+    auto model = MAIN.timelineDock()->model();
+    for (int i = first; i <= last; ++i) {
+        auto info = model->getClipInfo(parent.row(), i);
+        if (!info || !info->producer || !info->producer->is_valid())
+            continue;
+        if (info->producer->type() != mlt_service_producer_type
+            && info->producer->type() != mlt_service_chain_type) {
+            // A nested timeline may contain many clips.
+            refreshTimelineSmartBins();
+            return;
+        }
+        if (!info->cut || !info->cut->is_blank())
+            hashes << Util::getHash(*info->producer);
+    }
+    m_proxyModel->addTimelineHashes(hashes);
+}
+
 void PlaylistDock::onDropped(const QMimeData *data, int row)
 {
     if (data && data->hasUrls()) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -101,6 +101,7 @@ public slots:
     void onPlaylistCleared();
     void onPlaylistClosed();
     void refreshTimelineSmartBins();
+    void onTimelineRowsInserted(const QModelIndex &parent, int first, int last);
 
 private slots:
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2024 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,13 +19,17 @@
 #include "ui_recentdock.h"
 
 #include "Logger.h"
+#include "projectarchive.h"
 #include "settings.h"
 #include "util.h"
 
 #include <QAction>
+#include <QCursor>
 #include <QDir>
+#include <QHelpEvent>
 #include <QKeyEvent>
 #include <QMenu>
+#include <QToolTip>
 
 static const int MaxItems = 200;
 
@@ -66,6 +70,15 @@ RecentDock::RecentDock(QWidget *parent)
     m_proxyModel.setSourceModel(&m_model);
     m_proxyModel.setFilterCaseSensitivity(Qt::CaseInsensitive);
     ui->listWidget->setModel(&m_proxyModel);
+    ui->listWidget->viewport()->installEventFilter(this);
+
+    // Check the entries only when they are shown, and never in the foreground.
+    connect(&RECENT_FILES, &RecentFileCache::stateChanged, this, &RecentDock::onStateChanged);
+    connect(&RECENT_FILES, &RecentFileCache::previewChanged, this, &RecentDock::onPreviewChanged);
+    connect(this, &QDockWidget::visibilityChanged, this, [this](bool visible) {
+        if (visible)
+            RECENT_FILES.validate(m_recent);
+    });
     LOG_DEBUG() << "end";
 }
 
@@ -87,11 +100,12 @@ void RecentDock::add(const QString &s)
     QStandardItem *item = new QStandardItem(name);
     item->setToolTip(QDir::toNativeSeparators(s));
     m_model.insertRow(0, item);
+    setItemState(item, RECENT_FILES.state(filePath));
     m_recent.prepend(filePath);
     while (m_recent.count() > MaxItems)
         m_recent.removeLast();
     Settings.setRecent(m_recent);
-    if (filePath.endsWith(".mlt")) {
+    if (filePath.endsWith(".mlt") || ProjectArchive::isArchive(filePath)) {
         auto projects = Settings.projects();
         projects.removeOne(filePath);
         projects.prepend(filePath);
@@ -133,6 +147,47 @@ void RecentDock::keyPressEvent(QKeyEvent *event)
     }
 }
 
+bool RecentDock::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->listWidget->viewport() && event->type() == QEvent::ToolTip) {
+        auto helpEvent = static_cast<QHelpEvent *>(event);
+        auto index = ui->listWidget->indexAt(helpEvent->pos());
+        if (index.isValid()) {
+            m_toolTipPath = QDir::fromNativeSeparators(index.data(Qt::ToolTipRole).toString());
+            QToolTip::showText(helpEvent->globalPos(),
+                               RECENT_FILES.toolTip(m_toolTipPath),
+                               ui->listWidget->viewport(),
+                               ui->listWidget->visualRect(index));
+            return true;
+        }
+    }
+    return QDockWidget::eventFilter(watched, event);
+}
+
+void RecentDock::setItemState(QStandardItem *item, RecentFileCache::State state)
+{
+    if (state == RecentFileCache::Missing || state == RecentFileCache::Unreachable)
+        item->setForeground(palette().brush(QPalette::Disabled, QPalette::Text));
+    else
+        item->setData(QVariant(), Qt::ForegroundRole);
+}
+
+void RecentDock::onStateChanged(const QString &path, RecentFileCache::State state)
+{
+    const auto toolTip = QDir::toNativeSeparators(path);
+    for (int row = 0; row < m_model.rowCount(); ++row) {
+        auto item = m_model.item(row);
+        if (item->toolTip() == toolTip)
+            setItemState(item, state);
+    }
+}
+
+void RecentDock::onPreviewChanged(const QString &path)
+{
+    if (path == m_toolTipPath && QToolTip::isVisible())
+        QToolTip::showText(QCursor::pos(), RECENT_FILES.toolTip(path), ui->listWidget->viewport());
+}
+
 void RecentDock::on_lineEdit_textChanged(const QString &search)
 {
     m_proxyModel.setFilterFixedString(search);
@@ -146,7 +201,7 @@ void RecentDock::on_actionDelete_triggered()
         m_recent.removeAt(row);
         Settings.setRecent(m_recent);
         m_model.removeRow(row);
-        if (url.endsWith(".mlt")) {
+        if (url.endsWith(".mlt") || ProjectArchive::isArchive(url)) {
             auto ls = Settings.projects();
             if (ls.removeAll(url) > 0)
                 Settings.setProjects(ls);
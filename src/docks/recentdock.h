@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2020 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,8 @@
 #ifndef RECENTDOCK_H
 #define RECENTDOCK_H
 
+#include "recentfilecache.h"
+
 #include <QDockWidget>
 #include <QSortFilterProxyModel>
 #include <QStandardItemModel>
@@ -45,18 +47,24 @@ public slots:
 
 protected:
     void keyPressEvent(QKeyEvent *event);
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private:
     Ui::RecentDock *ui;
     QStringList m_recent;
     QStandardItemModel m_model;
     QSortFilterProxyModel m_proxyModel;
+    QString m_toolTipPath;
+
+    void setItemState(QStandardItem *item, RecentFileCache::State state);
 
 private slots:
     void on_listWidget_activated(const QModelIndex &i);
     void on_lineEdit_textChanged(const QString &search);
     void on_actionDelete_triggered();
     void on_listWidget_customContextMenuRequested(const QPoint &pos);
+    void onStateChanged(const QString &path, RecentFileCache::State state);
+    void onPreviewChanged(const QString &path);
 };
 
 #endif // RECENTDOCK_H
@@ -55,16 +55,20 @@ void ScopeDock::resizeEvent(QResizeEvent *e)
 
 void ScopeDock::onActionToggled(bool checked)
 {
+    // Video scopes get frames after their image formats have been converted.
+    const char *signal = m_scopeWidget->imageFormats().isEmpty()
+                             ? SIGNAL(newFrame(const SharedFrame &))
+                             : SIGNAL(newVideoFrame(const SharedFrame &));
+    m_scopeController->setScopeActive(m_scopeWidget, checked);
     if (checked) {
-        connect(m_scopeController,
-                SIGNAL(newFrame(const SharedFrame &)),
-                m_scopeWidget,
-                SLOT(onNewFrame(const SharedFrame &)));
+        connect(m_scopeController, signal, m_scopeWidget, SLOT(onNewFrame(const SharedFrame &)));
         MLT.refreshConsumer();
     } else {
-        disconnect(m_scopeController,
-                   SIGNAL(newFrame(const SharedFrame &)),
-                   m_scopeWidget,
-                   SLOT(onNewFrame(const SharedFrame &)));
+        disconnect(m_scopeController, signal, m_scopeWidget, SLOT(onNewFrame(const SharedFrame &)));
+        const ScopeWidget::Statistics stats = m_scopeWidget->statistics();
+        LOG_INFO() << objectName() << "refreshes" << stats.refreshes << "average refresh us"
+                   << stats.averageRefreshUs << "max refresh us" << stats.maxRefreshUs
+                   << "queue depth" << stats.queueDepth << "dropped frames" << stats.droppedFrames
+                   << "refresh latency ms" << stats.latencyMs;
     }
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024-2025 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -48,19 +48,29 @@
 #include <QItemSelection>
 #include <QItemSelectionModel>
 #include <QLabel>
+#include <QLineEdit>
 #include <QMenu>
 #include <QMessageBox>
 #include <QProcess>
 #include <QStandardPaths>
 #include <QTextDocumentFragment>
 #include <QTextEdit>
+#include <QThread>
 #include <QToolButton>
 #include <QTreeView>
 #include <QVBoxLayout>
 #include <QtWidgets/QScrollArea>
 
+#include <algorithm>
+
 #define DEFAULT_ITEM_DURATION (2 * 1000)
 
+// The longest audio transcribed by one job, which also bounds how long it
+// takes for the first subtitles to appear
+static const qint64 kMaxChunkMs = 10 * 60 * 1000;
+// The shortest chunk, since whisper needs context and loads its model per job
+static const qint64 kMinChunkMs = 2 * 60 * 1000;
+
 static int64_t positionToMs(mlt_position position)
 {
     auto seconds = position / MLT.profile().fps();
@@ -85,6 +95,7 @@ static QList<Subtitles::SubtitleItem> readSrtFile(const QString &path,
     }
 
     // Convert the items to the return list
+    items.reserve(srtItems.size());
     Subtitles::SubtitleItem item;
     for (int i = 0; i < srtItems.size(); i++) {
         // Clean up the lines
@@ -174,6 +185,18 @@ SubtitlesDock::SubtitlesDock(QWidget *parent)
 
     vboxLayout->addLayout(tracksLayout);
 
+    QHBoxLayout *searchLayout = new QHBoxLayout();
+    m_searchEdit = new QLineEdit();
+    m_searchEdit->setPlaceholderText(tr("Search"));
+    m_searchEdit->setToolTip(tr("Find the subtitles with these words. Press Enter for the next."));
+    m_searchEdit->setClearButtonEnabled(true);
+    connect(m_searchEdit, &QLineEdit::textChanged, this, [&]() { onSearchRequested(false); });
+    connect(m_searchEdit, &QLineEdit::returnPressed, this, [&]() { onSearchRequested(true); });
+    searchLayout->addWidget(m_searchEdit);
+    m_searchLabel = new QLabel();
+    searchLayout->addWidget(m_searchLabel);
+    vboxLayout->addLayout(searchLayout);
+
     m_treeView = new QTreeView();
     vboxLayout->addWidget(m_treeView, 1);
 
@@ -473,6 +496,8 @@ void SubtitlesDock::setModel(SubtitlesModel *model, SubtitlesSelectionModel *sel
     m_selectionModel = selectionModel;
     m_treeView->setModel(m_model);
     m_treeView->setSelectionModel(m_selectionModel);
+    // Spares measuring every row of a long track.
+    m_treeView->setUniformRowHeights(true);
     m_treeView->header()->setStretchLastSection(false);
     m_treeView->header()->setSectionResizeMode(0, QHeaderView::Stretch);
     m_treeView->setSelectionMode(QAbstractItemView::ContiguousSelection);
@@ -512,16 +537,30 @@ void SubtitlesDock::importSrtFromFile(const QString &srtPath,
                                       bool includeNonspoken)
 {
     QList<Subtitles::SubtitleItem> items = readSrtFile(srtPath, 0, includeNonspoken);
+    // The chunks of a transcription are merged into the track of the first one.
+    int trackIndex = -1;
+    const QList<SubtitlesModel::SubtitleTrack> tracks = m_model->getTracks();
+    for (int i = 0; i < tracks.size(); i++) {
+        if (tracks[i].name == trackName) {
+            trackIndex = i;
+            break;
+        }
+    }
     if (items.size() == 0) {
-        MAIN.showStatusMessage(QObject::tr("No subtitles found to import"));
+        if (trackIndex < 0) {
+            MAIN.showStatusMessage(QObject::tr("No subtitles found to import"));
+        }
         return;
     }
 
-    SubtitlesModel::SubtitleTrack track;
-    track.name = trackName;
-    track.lang = lang;
-
-    m_model->importSubtitlesToNewTrack(track, items);
+    if (trackIndex >= 0) {
+        m_model->importSubtitles(trackIndex, items[0].start, items);
+    } else {
+        SubtitlesModel::SubtitleTrack track;
+        track.name = trackName;
+        track.lang = lang;
+        m_model->importSubtitlesToNewTrack(track, items);
+    }
 
     MAIN.showStatusMessage(QObject::tr("Imported %1 subtitle item(s)", nullptr, items.size()));
 }
@@ -886,6 +925,34 @@ void SubtitlesDock::onItemDoubleClicked(const QModelIndex &index)
     }
 }
 
+void SubtitlesDock::onSearchRequested(bool next)
+{
+    m_searchLabel->clear();
+    int trackIndex = m_trackCombo->currentIndex();
+    QString text = m_searchEdit->text();
+    if (!m_model || trackIndex < 0 || text.trimmed().isEmpty()) {
+        return;
+    }
+    const QList<int> results = m_model->findItems(trackIndex, text);
+    if (results.isEmpty()) {
+        m_searchLabel->setText(tr("No matches"));
+        return;
+    }
+    // Go to the first match from the current item onward.
+    QModelIndex current = m_treeView->currentIndex();
+    int currentItem = current.isValid() && current.parent().isValid() ? current.row() : -1;
+    auto it = next ? std::upper_bound(results.cbegin(), results.cend(), currentItem)
+                   : std::lower_bound(results.cbegin(), results.cend(), currentItem);
+    if (it == results.cend()) {
+        it = results.cbegin();
+    }
+    int itemIndex = *it;
+    m_searchLabel->setText(tr("%1 of %2").arg(it - results.cbegin() + 1).arg(results.size()));
+    setCurrentItem(trackIndex, itemIndex);
+    const Subtitles::SubtitleItem &item = m_model->getItem(trackIndex, itemIndex);
+    emit seekRequested((int) msToPosition(item.start));
+}
+
 void SubtitlesDock::resizeEvent(QResizeEvent *e)
 {
     QDockWidget::resizeEvent(e);
@@ -1314,35 +1381,53 @@ void SubtitlesDock::speechToText()
     tmpWav->setParent(wavJob);
     JOBS.add(wavJob);
 
-    // Create a temporary srt file
-    QTemporaryFile *tmpSrt = Util::writableTemporaryFile(tmpLocation, "shotcut-XXXXXX.srt");
-    if (!tmpSrt->open()) {
-        LOG_ERROR() << "Failed to open temporary file" << tmpSrt->fileName();
-        return;
-    }
-    tmpWav->close();
-
-    // Run speech transcription on the wav file
-    jobName = tr("Speech to Text");
-    WhisperJob *whisperJob = new WhisperJob(jobName,
-                                            tmpWav->fileName(),
-                                            tmpSrt->fileName(),
-                                            dialog.language(),
-                                            dialog.translate(),
-                                            dialog.maxLineLength());
     // Ensure the language code is 3 character (part 2)
     QString langCode = dialog.language();
     QLocale::Language lang = QLocale::codeToLanguage(langCode);
     if (lang != QLocale::AnyLanguage) {
         langCode = QLocale::languageToCode(lang, QLocale::ISO639Part2);
     }
-    whisperJob->setPostJobAction(new ImportSrtPostJobAction(tmpSrt->fileName(),
-                                                            dialog.name(),
-                                                            langCode,
-                                                            dialog.includeNonspoken(),
-                                                            this));
-    tmpSrt->setParent(whisperJob);
-    JOBS.add(whisperJob);
+
+    // Split long audio into chunks that are transcribed in parallel, as many at
+    // once as there are job slots, and imported as each one finishes.
+    const int jobSlots = JobQueue::jobSlots(AbstractJob::CpuEncodeResource);
+    const qint64 msDuration = qint64(MAIN.multitrack()->get_length()) * 1000
+                              * MLT.profile().frame_rate_den() / MLT.profile().frame_rate_num();
+    int chunkCount = qMax<qint64>(jobSlots, (msDuration + kMaxChunkMs - 1) / kMaxChunkMs);
+    chunkCount = qBound<qint64>(1, msDuration / kMinChunkMs, chunkCount);
+    const int threadCount = qMax(1, (QThread::idealThreadCount() - 1) / qMin(jobSlots, chunkCount));
+
+    for (int i = 0; i < chunkCount; ++i) {
+        // Create a temporary srt file
+        QTemporaryFile *tmpSrt = Util::writableTemporaryFile(tmpLocation, "shotcut-XXXXXX.srt");
+        if (!tmpSrt->open()) {
+            LOG_ERROR() << "Failed to open temporary file" << tmpSrt->fileName();
+            return;
+        }
+        tmpSrt->close();
+
+        // Run speech transcription on the wav file
+        jobName = chunkCount > 1 ? tr("Speech to Text %1/%2").arg(i + 1).arg(chunkCount)
+                                 : tr("Speech to Text");
+        WhisperJob *whisperJob = new WhisperJob(jobName,
+                                                tmpWav->fileName(),
+                                                tmpSrt->fileName(),
+                                                dialog.language(),
+                                                dialog.translate(),
+                                                dialog.maxLineLength());
+        if (chunkCount > 1) {
+            whisperJob->setChunk(i, chunkCount);
+            whisperJob->setThreadCount(threadCount);
+        }
+        whisperJob->setPostJobAction(new ImportSrtPostJobAction(tmpSrt->fileName(),
+                                                                dialog.name(),
+                                                                langCode,
+                                                                dialog.includeNonspoken(),
+                                                                this));
+        tmpSrt->setParent(whisperJob);
+        whisperJob->addDependency(wavJob);
+        JOBS.add(whisperJob);
+    }
 }
 
 void SubtitlesDock::textToSpeech()
@@ -1367,13 +1452,22 @@ void SubtitlesDock::textToSpeech()
         if (outFile.isEmpty())
             return;
         QFileInfo outInfo(outFile);
-        auto srtFile = new QTemporaryFile(outInfo.dir().filePath("XXXXXX.srt"));
-        if (!srtFile->open()) {
-            LOG_ERROR() << "Failed to create temp srt file" << srtFile->fileName();
-            srtFile->deleteLater();
-            return;
+        // The whole track is voiced in one run from its subtitles, which are
+        // kept beside the audio as its cue list when that name is free.
+        const auto cueFile = outInfo.dir().filePath(outInfo.completeBaseName() + ".srt");
+        QFile *srtFile = nullptr;
+        if (QFile::exists(cueFile)) {
+            auto tmpFile = new QTemporaryFile(outInfo.dir().filePath("XXXXXX.srt"));
+            if (!tmpFile->open()) {
+                LOG_ERROR() << "Failed to create temp srt file" << tmpFile->fileName();
+                tmpFile->deleteLater();
+                return;
+            }
+            tmpFile->close();
+            srtFile = tmpFile;
+        } else {
+            srtFile = new QFile(cueFile);
         }
-        srtFile->close();
         m_model->exportSubtitles(srtFile->fileName(), trackIndex);
 
         // Export current track subtitles to SRT.
@@ -1383,7 +1477,9 @@ void SubtitlesDock::textToSpeech()
         auto job = new KokorodokiJob(srtFile->fileName(), outFile, lang, voice, spd);
 
         srtFile->setParent(job); // auto-delete with job
-        job->setPostJobAction(new OpenPostJobAction(outFile, outFile, QString()));
+        // The subtitle times are from the start of the timeline.
+        job->setPostJobAction(
+            new AudioTrackPostJobAction(outFile, m_model->getTrack(trackIndex).name, 0));
         JOBS.add(job);
     });
 }
@@ -26,6 +26,7 @@ class SubtitlesSelectionModel;
 class QComboBox;
 class QItemSelection;
 class QLabel;
+class QLineEdit;
 class QTextEdit;
 class QTreeView;
 class SpeechDialog;
@@ -75,6 +76,7 @@ private:
     void importSubtitles();
     void exportSubtitles();
     void onItemDoubleClicked(const QModelIndex &index);
+    void onSearchRequested(bool next);
     void resizeTextWidgets();
     void updateTextWidgets();
     void setCurrentItem(int trackIndex, int itemIndex);
@@ -93,6 +95,8 @@ private:
     SubtitlesSelectionModel *m_selectionModel;
     QLabel *m_addToTimelineLabel;
     QComboBox *m_trackCombo;
+    QLineEdit *m_searchEdit;
+    QLabel *m_searchLabel;
     QTreeView *m_treeView;
     QTextEdit *m_text;
     QTextEdit *m_prev;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -26,9 +26,11 @@
 #include "dialogs/editmarkerdialog.h"
 #include "dialogs/longuitask.h"
 #include "dialogs/resourcedialog.h"
+#include "jobqueue.h"
 #include "jobs/meltjob.h"
 #include "mainwindow.h"
 #include "models/audiolevelstask.h"
+#include "models/beatdetector.h"
 #include "models/multitrackmodel.h"
 #include "proxymanager.h"
 #include "qmltypes/qmlapplication.h"
@@ -37,6 +39,7 @@
 #include "qmltypes/thumbnailprovider.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "timelineclipboard.h"
 #include "util.h"
 #include "widgets/blipproducerwidget.h"
 #include "widgets/colorbarswidget.h"
@@ -52,6 +55,10 @@
 #include <QActionGroup>
 #include <QClipboard>
 #include <QDialogButtonBox>
+#include <QDir>
+#include <QDomDocument>
+#include <QFile>
+#include <QFileInfo>
 #include <QGuiApplication>
 #include <QMenu>
 #include <QProgressBar>
@@ -63,17 +70,24 @@
 #include <QToolButton>
 #include <QVBoxLayout>
 #include <QWidgetAction>
+#include <QtMath>
 #include <qlistwidget.h>
 
+#include <algorithm>
+
 static const char *kFileUrlProtocol = "file://";
 static const char *kFilesUrlDelimiter = ",file://";
 static const int kRecordingTimerIntervalMs = 1000;
+static const char *kRenderTrackUuidProperty = "renderTrackUuid";
+static const char *kRenderTrackXmlProperty = "renderTrackXml";
+static const char *kRenderTrackStartProperty = "renderTrackStart";
 
 TimelineDock::TimelineDock(QWidget *parent)
     : QDockWidget(parent)
-    , m_quickView(QmlUtilities::sharedEngine(), this)
+    , m_quickView(QmlUtilities::sharedEngine(), Settings.timelineThreadedRendering(), this)
     , m_subtitlesModel()
     , m_subtitlesSelectionModel(&m_subtitlesModel)
+    , m_renderPreview(m_model)
 {
     LOG_DEBUG() << "begin";
     m_selection.selectedTrack = -1;
@@ -103,6 +117,8 @@ TimelineDock::TimelineDock(QWidget *parent)
     trackOperationsMenu->addAction(Actions["timelineToggleTrackLockedAction"]);
     trackOperationsMenu->addAction(Actions["timelineToggleTrackMuteAction"]);
     trackOperationsMenu->addAction(Actions["timelineToggleTrackBlendingAction"]);
+    trackOperationsMenu->addAction(Actions["timelineRenderTrackAction"]);
+    trackOperationsMenu->addAction(Actions["timelineRestoreTrackAction"]);
     m_mainMenu->addMenu(trackOperationsMenu);
     QMenu *trackHeightMenu = new QMenu(tr("Track Height"), this);
     trackHeightMenu->addAction(Actions["timelineTracksShorterAction"]);
@@ -144,6 +160,8 @@ TimelineDock::TimelineDock(QWidget *parent)
     viewMenu->addAction(Actions["timelineZoomInAction"]);
     viewMenu->addAction(Actions["timelineZoomFitAction"]);
     viewMenu->addAction(Actions["timelinePropertiesAction"]);
+    viewMenu->addAction(Actions["timelineRenderPreviewAction"]);
+    viewMenu->addAction(Actions["timelineClearRenderPreviewAction"]);
     m_mainMenu->addMenu(viewMenu);
     QMenu *markerMenu = new QMenu(tr("Marker"), this);
     markerMenu->addAction(Actions["timelineMarkerAction"]);
@@ -151,6 +169,7 @@ TimelineDock::TimelineDock(QWidget *parent)
     markerMenu->addAction(Actions["timelineNextMarkerAction"]);
     markerMenu->addAction(Actions["timelineDeleteMarkerAction"]);
     markerMenu->addAction(Actions["timelineMarkSelectedClipAction"]);
+    markerMenu->addAction(Actions["timelineMarkBeatsAction"]);
     markerMenu->addAction(Actions["timelineCycleMarkerColorAction"]);
     m_mainMenu->addMenu(markerMenu);
     Actions.loadFromMenu(m_mainMenu);
@@ -267,7 +286,7 @@ TimelineDock::TimelineDock(QWidget *parent)
     m_quickView.setClearColor(palette().window().color());
     m_quickView.quickWindow()->setPersistentSceneGraph(false);
 #ifndef Q_OS_MAC
-    m_quickView.setAttribute(Qt::WA_AcceptTouchEvents);
+    m_quickView.widget()->setAttribute(Qt::WA_AcceptTouchEvents);
 #endif
 
     m_selectionSignalTimer.setSingleShot(true);
@@ -277,7 +296,7 @@ TimelineDock::TimelineDock(QWidget *parent)
         emitSelectedFromSelection();
     });
 
-    connect(&m_quickView, &QQuickWidget::statusChanged, this, [&]() {
+    connect(&m_quickView, &QuickViewHost::statusChanged, this, [&]() {
         if (m_quickView.status() == QQuickWidget::Ready) {
             connect(m_quickView.rootObject(), SIGNAL(clipClicked()), this, SIGNAL(clipClicked()));
             connect(m_quickView.rootObject(),
@@ -347,6 +366,24 @@ TimelineDock::TimelineDock(QWidget *parent)
     connect(this, SIGNAL(topLevelChanged(bool)), this, SLOT(onTopLevelChanged(bool)));
     connect(this, SIGNAL(warnTrackLocked(int)), SLOT(onWarnTrackLocked()));
     connect(&m_markersModel, SIGNAL(rangesChanged()), this, SIGNAL(markerRangesChanged()));
+    auto invalidateSnapIndex = [this]() { m_isSnapIndexValid = false; };
+    connect(&m_model, &MultitrackModel::modified, this, invalidateSnapIndex);
+    connect(&m_model, &MultitrackModel::modelReset, this, invalidateSnapIndex);
+    connect(&m_model, &MultitrackModel::dataChanged, this, invalidateSnapIndex);
+    connect(&m_model,
+            &MultitrackModel::dataChanged,
+            this,
+            [this](const QModelIndex &topLeft, const QModelIndex &, const QList<int> &roles) {
+                // The beats of a clip are ready with the last update of its waveform.
+                if (m_beatMarkersIndex.isValid() && topLeft == m_beatMarkersIndex
+                    && roles.contains(MultitrackModel::AudioLevelsRole)) {
+                    auto info = m_model.getClipInfo(topLeft.parent().row(), topLeft.row());
+                    if (info && !AudioLevelsTask::onsets(*info->producer).isEmpty())
+                        createBeatMarkers(topLeft.parent().row(), topLeft.row());
+                }
+            });
+    connect(&m_markersModel, &MarkersModel::modified, this, invalidateSnapIndex);
+    connect(&m_markersModel, &MarkersModel::modelReset, this, invalidateSnapIndex);
 
     connect(this, &QDockWidget::visibilityChanged, this, [&](bool visible) {
         if (visible) {
@@ -503,6 +540,29 @@ void TimelineDock::setupActions()
     });
     Actions.add("timelineToggleTrackBlendingAction", action);
 
+    action = new QAction(tr("Render Track in Place"), this);
+    action->setToolTip(
+        tr("Render the selected track with its filters to one clip to play it in real time"));
+    connect(action, &QAction::triggered, this, [&]() {
+        if (!isMultitrackValid())
+            return;
+        show();
+        raise();
+        renderTrack(currentTrack());
+    });
+    Actions.add("timelineRenderTrackAction", action);
+
+    action = new QAction(tr("Restore Rendered Track"), this);
+    action->setToolTip(tr("Bring back the clips and filters of a track rendered in place"));
+    connect(action, &QAction::triggered, this, [&]() {
+        if (!isMultitrackValid())
+            return;
+        show();
+        raise();
+        restoreTrack(currentTrack());
+    });
+    Actions.add("timelineRestoreTrackAction", action);
+
     action = new QAction(tr("Make Tracks Shorter"), this);
     action->setShortcut(QKeySequence(Qt::CTRL | Qt::Key_Minus));
     connect(action, &QAction::triggered, this, [&]() {
@@ -1047,6 +1107,21 @@ void TimelineDock::setupActions()
     });
     Actions.add("timelineMarkSelectedClipAction", action);
 
+    action = new QAction(tr("Create Markers at Beats of Selected Clip"), this);
+    connect(action, &QAction::triggered, this, [&]() {
+        if (!isMultitrackValid())
+            return;
+        auto selected = selection();
+        if (selected.isEmpty()) {
+            emit showStatusMessage(tr("Select a clip with audio in the timeline to mark its beats"));
+            return;
+        }
+        show();
+        raise();
+        createBeatMarkers(selected.first().y(), selected.first().x());
+    });
+    Actions.add("timelineMarkBeatsAction", action);
+
     action = new QAction(tr("Rectangle Selection"), this);
     action->setCheckable(true);
     action->setChecked(Settings.timelineRectangleSelect());
@@ -1181,22 +1256,6 @@ void TimelineDock::setupActions()
     });
     Actions.add("timelineShowWaveformsAction", action);
 
-    action = new QAction(tr("Use Higher Performance Waveforms"), this);
-    action->setCheckable(true);
-    action->setChecked(Settings.timelineFramebufferWaveform());
-    connect(action, &QAction::triggered, this, [&](bool checked) {
-        Settings.setTimelineFramebufferWaveform(checked);
-        if (!isVisible() || !m_quickView.rootObject())
-            return;
-        if (Settings.timelineFramebufferWaveform()) {
-            m_model.reload();
-        }
-    });
-    connect(&Settings, &ShotcutSettings::timelineFramebufferWaveformChanged, action, [=]() {
-        action->setChecked(Settings.timelineFramebufferWaveform());
-    });
-    Actions.add("timelinePerformanceWaveformsAction", action);
-
     action = new QAction(tr("Show Video Thumbnails"), this);
     action->setCheckable(true);
     action->setChecked(Settings.timelineShowThumbnails());
@@ -1208,6 +1267,46 @@ void TimelineDock::setupActions()
     });
     Actions.add("timelineShowThumbnailsAction", action);
 
+    action = new QAction(tr("Video Thumbnails as Filmstrip"), this);
+    action->setToolTip(tr("Fill each video clip with thumbnails spaced evenly across it"));
+    action->setCheckable(true);
+    action->setChecked(Settings.timelineThumbnailStrip());
+    action->setEnabled(Settings.timelineShowThumbnails());
+    connect(action, &QAction::triggered, this, [&](bool checked) {
+        Settings.setTimelineThumbnailStrip(checked);
+    });
+    connect(&Settings, &ShotcutSettings::timelineThumbnailStripChanged, action, [=]() {
+        action->setChecked(Settings.timelineThumbnailStrip());
+    });
+    connect(&Settings, &ShotcutSettings::timelineShowThumbnailsChanged, action, [=]() {
+        action->setEnabled(Settings.timelineShowThumbnails());
+    });
+    Actions.add("timelineThumbnailStripAction", action);
+
+    action = new QAction(tr("Fast Thumbnails (Nearest Keyframe)"), this);
+    action->setToolTip(tr("Use the nearest keyframe for video thumbnails, which is much faster "
+                          "but less accurate"));
+    action->setCheckable(true);
+    action->setChecked(Settings.thumbnailsFastSeek());
+    connect(action, &QAction::triggered, this, [&](bool checked) {
+        Settings.setThumbnailsFastSeek(checked);
+    });
+    connect(&Settings, &ShotcutSettings::thumbnailsFastSeekChanged, action, [=]() {
+        action->setChecked(Settings.thumbnailsFastSeek());
+    });
+    Actions.add("timelineFastThumbnailsAction", action);
+
+    action = new QAction(tr("Threaded Rendering"), this);
+    action->setToolTip(tr("Draw the timeline and keyframes in windows of their own on a render "
+                          "thread so that a busy repaint does not hold up the mouse and keyboard"));
+    action->setCheckable(true);
+    action->setChecked(Settings.timelineThreadedRendering());
+    connect(action, &QAction::triggered, this, [&](bool checked) {
+        Settings.setTimelineThreadedRendering(checked);
+        emit showStatusMessage(tr("You must restart Shotcut to change the timeline rendering."));
+    });
+    Actions.add("timelineThreadedRenderingAction", action);
+
     action = new QAction(tr("No"), this);
     action->setCheckable(true);
     action->setChecked(ShotcutSettings::TimelineScrolling::NoScrolling
@@ -1416,6 +1515,30 @@ void TimelineDock::setupActions()
     action->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_H));
     connect(action, &QAction::triggered, this, [&] { freezeFrame(); });
     Actions.add("timelineFreezeFrameAction", action);
+
+    action = new QAction(tr("Render Preview"), this);
+    action->setToolTip(tr("Render the selected clips in the background to play them in real time"));
+    connect(action, &QAction::triggered, this, [&]() {
+        if (!isMultitrackValid())
+            return;
+        int start, end;
+        getSelectionRange(&start, &end);
+        if (start > -1 && end > start)
+            m_renderPreview.addZone(start, end);
+        if (m_renderPreview.zones().isEmpty())
+            emit showStatusMessage(tr("Select the clips to render a preview of them"));
+        else
+            m_renderPreview.renderAll();
+    });
+    Actions.add("timelineRenderPreviewAction", action);
+
+    action = new QAction(tr("Clear Render Previews"), this);
+    connect(action, &QAction::triggered, this, [&]() {
+        if (!isMultitrackValid())
+            return;
+        m_renderPreview.clearZones();
+    });
+    Actions.add("timelineClearRenderPreviewAction", action);
     action->setEnabled(false);
     connect(this, &TimelineDock::selectionChanged, action, [=]() {
         bool enabled = true;
@@ -1479,8 +1602,9 @@ void TimelineDock::setupActions()
             }
         }
         if (enabled) {
-            auto s = QGuiApplication::clipboard()->text();
-            enabled = s.contains(kShotcutFiltersClipboard);
+            // Copied clips are not filters, so this does not serialize them.
+            enabled = !TimelineClipboard::isOwner()
+                      && QGuiApplication::clipboard()->text().contains(kShotcutFiltersClipboard);
         }
         action->setEnabled(enabled);
     });
@@ -1663,14 +1787,9 @@ int TimelineDock::clipIndexAtPosition(int trackIndex, int position)
     if (trackIndex < 0)
         trackIndex = currentTrack();
     if (trackIndex >= 0 && trackIndex < m_model.trackList().size()) {
-        int i = m_model.trackList().at(trackIndex).mlt_index;
-        QScopedPointer<Mlt::Producer> track(m_model.tractor()->track(i));
-        if (track) {
-            Mlt::Playlist playlist(*track);
-            result = playlist.get_clip_index_at(position);
-            if (result >= playlist.count())
-                result = -1;
-        }
+        result = m_model.clipIndex(trackIndex, position);
+        if (result >= m_model.rowCount(m_model.index(trackIndex)))
+            result = -1;
     }
     return result;
 }
@@ -2085,6 +2204,155 @@ void TimelineDock::removeTrack()
     }
 }
 
+void TimelineDock::renderTrack(int trackIndex)
+{
+    if (trackIndex < 0 || trackIndex >= m_model.trackList().size())
+        return;
+    const Track &t = m_model.trackList().at(trackIndex);
+    QScopedPointer<Mlt::Producer> producer(m_model.tractor()->track(t.mlt_index));
+    if (!producer || !producer->is_valid())
+        return;
+    Mlt::Playlist playlist(*producer);
+    if (playlist.get(kTrackRenderedProperty)) {
+        emit showStatusMessage(tr("This track is already rendered"));
+        return;
+    }
+    int start = -1;
+    for (int i = 0; i < playlist.count() && start < 0; ++i) {
+        if (!playlist.is_blank(i))
+            start = playlist.clip_start(i);
+    }
+    const int end = playlist.get_playtime() - 1;
+    if (start < 0 || end < start) {
+        emit showStatusMessage(tr("There is nothing on this track to render"));
+        return;
+    }
+
+    // Render from the original sources instead of the proxies.
+    QString xml = MLT.XML(&playlist, true);
+    if (!ProxyManager::filterXML(xml, QString())) {
+        emit showStatusMessage(tr("Unable to render the track"));
+        return;
+    }
+    QDomDocument dom;
+    if (!dom.setContent(xml)) {
+        LOG_WARNING() << "failed to parse the track XML to render it";
+        return;
+    }
+
+    QString directory = Settings.savePath();
+    QString baseName = QStringLiteral("track");
+    if (!MAIN.fileName().isEmpty()) {
+        QFileInfo info(MAIN.fileName());
+        directory = info.absolutePath();
+        baseName = info.completeBaseName();
+    }
+    const QString trackName
+        = m_model.getTrackName(trackIndex).simplified().replace(' ', '_').replace('/', '_');
+    const bool isAudio = t.type == AudioTrackType;
+    const QString target = Util::getNextFile(
+        QDir(directory).filePath(QStringLiteral("%1-%2-.%3")
+                                     .arg(baseName, trackName, isAudio ? "mka" : "mov")));
+
+    // Every frame is a key frame, so the clip is as cheap to seek and trim
+    // as the clips it replaces. Tracks above the bottom keep their alpha
+    // channel because they are still blended onto the tracks below.
+    QDomElement consumerNode = dom.createElement("consumer");
+    QDomNodeList profiles = dom.elementsByTagName("profile");
+    if (profiles.isEmpty())
+        dom.documentElement().insertAfter(consumerNode, dom.documentElement());
+    else
+        dom.documentElement().insertAfter(consumerNode, profiles.at(profiles.length() - 1));
+    consumerNode.setAttribute("mlt_service", "avformat");
+    consumerNode.setAttribute("target", target);
+    if (isAudio) {
+        consumerNode.setAttribute("f", "matroska");
+        consumerNode.setAttribute("vn", 1);
+        consumerNode.setAttribute("acodec", "pcm_s24le");
+    } else {
+        consumerNode.setAttribute("f", "mov");
+        consumerNode.setAttribute("vcodec", "prores_ks");
+        if (trackIndex == m_model.bottomVideoTrackIndex()) {
+            consumerNode.setAttribute("vprofile", "hq");
+            consumerNode.setAttribute("pix_fmt", "yuv422p10le");
+        } else {
+            consumerNode.setAttribute("vprofile", "4444");
+            consumerNode.setAttribute("pix_fmt", "yuva444p10le");
+            consumerNode.setAttribute("mlt_image_format", "rgba");
+        }
+        consumerNode.setAttribute("acodec", "pcm_s16le");
+    }
+    consumerNode.setAttribute("channels", MLT.audioChannels());
+    consumerNode.setAttribute("real_time", -qMax(1, QThread::idealThreadCount()));
+
+    auto job = new MeltJob(target,
+                           dom.toString(2),
+                           MLT.profile().frame_rate_num(),
+                           MLT.profile().frame_rate_den());
+    job->setInAndOut(start, end);
+    job->setLabel(tr("Render track %1").arg(m_model.getTrackName(trackIndex)));
+    job->setProperty(kRenderTrackUuidProperty, MLT.ensureHasUuid(playlist));
+    job->setProperty(kRenderTrackXmlProperty, MLT.XML(&playlist));
+    job->setProperty(kRenderTrackStartProperty, start);
+    connect(job, &AbstractJob::finished, this, &TimelineDock::onRenderTrackFinished);
+    JOBS.add(job);
+}
+
+void TimelineDock::onRenderTrackFinished(AbstractJob *job, bool isSuccess)
+{
+    const auto target = job->objectName();
+    if (!isSuccess || !isMultitrackValid()) {
+        QFile::remove(target);
+        return;
+    }
+    // Find the track again because it may have moved while it rendered.
+    const auto uuid = job->property(kRenderTrackUuidProperty).toUuid();
+    int trackIndex = -1;
+    for (int i = 0; i < m_model.trackList().size() && trackIndex < 0; ++i) {
+        QScopedPointer<Mlt::Producer> track(
+            m_model.tractor()->track(m_model.trackList().at(i).mlt_index));
+        if (track && track->is_valid() && MLT.uuid(*track) == uuid)
+            trackIndex = i;
+    }
+    if (trackIndex < 0) {
+        emit showStatusMessage(tr("The track was removed while it rendered: %1")
+                                   .arg(QDir::toNativeSeparators(target)));
+        return;
+    }
+    QScopedPointer<Mlt::Producer> producer(
+        m_model.tractor()->track(m_model.trackList().at(trackIndex).mlt_index));
+    Mlt::Playlist playlist(*producer);
+    // Keep the file but do not swap in a render that no longer matches the track.
+    if (playlist.get(kTrackRenderedProperty)
+        || MLT.XML(&playlist) != job->property(kRenderTrackXmlProperty).toString()) {
+        emit showStatusMessage(tr("The track changed while it rendered: %1")
+                                   .arg(QDir::toNativeSeparators(target)));
+        return;
+    }
+    const int start = job->property(kRenderTrackStartProperty).toInt();
+    Mlt::Producer clip(MLT.profile(), "avformat", target.toUtf8().constData());
+    if (!clip.is_valid()) {
+        LOG_WARNING() << "failed to open the rendered track" << target;
+        return;
+    }
+    clip.set_in_and_out(0, playlist.get_playtime() - start - 1);
+    MLT.setUuid(clip, QUuid::createUuid());
+    MAIN.undoStack()->push(new Timeline::RenderTrackCommand(m_model, trackIndex, clip, start));
+}
+
+void TimelineDock::restoreTrack(int trackIndex)
+{
+    if (trackIndex < 0 || trackIndex >= m_model.trackList().size())
+        return;
+    QScopedPointer<Mlt::Producer> producer(
+        m_model.tractor()->track(m_model.trackList().at(trackIndex).mlt_index));
+    if (!producer || !producer->is_valid() || !producer->get(kTrackRenderedProperty)) {
+        emit showStatusMessage(tr("This track is not rendered"));
+        return;
+    }
+    MAIN.undoStack()->push(new Timeline::RestoreTrackCommand(m_model, trackIndex));
+}
+
 void TimelineDock::moveTrack(int fromTrackIndex, int toTrackIndex)
 {
     const TrackList &trackList = m_model.trackList();
@@ -2306,7 +2574,9 @@ void TimelineDock::applyCopiedFiltersToSelectdClips()
             command->addClip(i.y(), i.x());
         }
     }
+    m_model.beginBatch();
     MAIN.undoStack()->push(command);
+    m_model.endBatch();
 }
 
 void TimelineDock::onShowFrame(const SharedFrame &frame)
@@ -2332,6 +2602,49 @@ static bool isSystemClipboardValid(const QString &xml)
     return MLT.isMltXml(xml) && MAIN.isClipboardNewer() && !xml.contains(kShotcutFiltersClipboard);
 }
 
+static bool isMultipleClips(Mlt::Producer &producer)
+{
+    return producer.is_valid() && producer.type() == mlt_service_tractor_type
+           && producer.get_int(kShotcutXmlProperty);
+}
+
+// Returns the MLT XML of a clip in the tracks on the clipboard.
+static QString clipXML(Mlt::ClipInfo &info)
+{
+    // The producer can be in the timeline when it was copied, so its points are put back.
+    Mlt::Producer clip(info.producer);
+    const int in = clip.get_in();
+    const int out = clip.get_out();
+    clip.set_in_and_out(info.frame_in, info.frame_out);
+    const auto xml = MLT.XML(&clip);
+    clip.set_in_and_out(in, out);
+    return xml;
+}
+
+// Returns the clips on the clipboard if they are newer than the source clip. The
+// clips copied in this process are used without parsing, and \a xml is only made
+// for a single clip. Otherwise \a xml is the MLT XML that the clips are parsed from.
+static Mlt::Producer clipboardProducer(QString &xml)
+{
+    if (TimelineClipboard::isOwner()) {
+        if (!MAIN.isClipboardNewer())
+            return Mlt::Producer();
+        auto producer = TimelineClipboard::producer();
+        if (!isMultipleClips(producer))
+            xml = TimelineClipboard::xml();
+        return producer;
+    }
+    xml = QGuiApplication::clipboard()->text();
+    if (!isSystemClipboardValid(xml)) {
+        xml.clear();
+        return Mlt::Producer();
+    }
+    if (!Settings.proxyEnabled()) {
+        ProxyManager::filterXML(xml, "");
+    }
+    return Mlt::Producer(MLT.profile(), "xml-string", xml.toUtf8().constData());
+}
+
 void TimelineDock::append(int trackIndex)
 {
     if (trackIndex < 0)
@@ -2343,19 +2656,13 @@ void TimelineDock::append(int trackIndex)
     if (MAIN.isSourceClipMyProject())
         return;
 
-    // Use MLT XML on the clipboard if it exists and is newer than source clip.
-    QString xmlToUse = QGuiApplication::clipboard()->text();
-    if (isSystemClipboardValid(xmlToUse)) {
-        if (!Settings.proxyEnabled()) {
-            ProxyManager::filterXML(xmlToUse, "");
-        }
-    } else {
-        xmlToUse.clear();
-    }
+    // Use the clips on the clipboard if they exist and are newer than source clip.
+    QString xmlToUse;
+    Mlt::Producer clipboard = clipboardProducer(xmlToUse);
 
-    if (MLT.isSeekableClip() || MLT.savedProducer() || !xmlToUse.isEmpty()) {
+    if (MLT.isSeekableClip() || MLT.savedProducer() || clipboard.is_valid()) {
         Mlt::Producer producer;
-        if (xmlToUse.isEmpty()) {
+        if (!clipboard.is_valid()) {
             Mlt::Producer producer(MLT.isClip() ? MLT.producer() : MLT.savedProducer());
             if (MLT.isLiveProducer(&producer)) {
                 LongUiTask::cancel();
@@ -2371,17 +2678,16 @@ void TimelineDock::append(int trackIndex)
             }
             xmlToUse = MLT.XML(&producer);
         } else {
-            producer = Mlt::Producer(MLT.profile(), "xml-string", xmlToUse.toUtf8().constData());
+            producer = clipboard;
         }
-        if (xmlToUse.isEmpty()) {
+        if (xmlToUse.isEmpty() && !isMultipleClips(producer)) {
             return;
         }
 
         // Insert multiple if the XML is a <tractor> with child <property name="shotcut">1</property>
         // No need to create a track in an empty timeline.
         // This can be a macro of QUndoCommands.
-        if (producer.is_valid() && producer.type() == mlt_service_tractor_type
-            && producer.get_int(kShotcutXmlProperty)) {
+        if (isMultipleClips(producer)) {
             Mlt::Tractor tractor(producer);
             Mlt::ClipInfo info;
             MAIN.undoStack()->beginMacro(tr("Append multiple to timeline"));
@@ -2399,13 +2705,11 @@ void TimelineDock::append(int trackIndex)
                     for (int mltClipIndex = 0; mltClipIndex < playlist.count(); mltClipIndex++) {
                         if (!playlist.is_blank(mltClipIndex)) {
                             playlist.clip_info(mltClipIndex, &info);
-                            Mlt::Producer clip(info.producer);
-                            clip.set_in_and_out(info.frame_in, info.frame_out);
                             bool lastClip = mltTrackIndex == tractor.count() - 1
                                             && mltClipIndex == playlist.count() - 1;
                             MAIN.undoStack()->push(new Timeline::AppendCommand(m_model,
                                                                                trackIndex,
-                                                                               MLT.XML(&clip),
+                                                                               clipXML(info),
                                                                                false,
                                                                                lastClip));
                         }
@@ -2650,7 +2954,7 @@ void TimelineDock::copy(int trackIndex, int clipIndex)
             p.seek(info->frame_in);
             p.set_in_and_out(info->frame_in, info->frame_out);
             MLT.setSavedProducer(&p);
-            QGuiApplication::clipboard()->setText(MLT.XML(&p));
+            TimelineClipboard::set(p);
             emit clipCopied();
         }
     } else {
@@ -2706,8 +3010,8 @@ void TimelineDock::copy(int trackIndex, int clipIndex)
                 }
             }
         }
-        // Put XML in clipboard
-        QGuiApplication::clipboard()->setText(MLT.XML(&tractor));
+        // The tracks refer to the clips and are only serialized if read as text.
+        TimelineClipboard::set(tractor);
     }
 }
 
@@ -3018,6 +3322,45 @@ void TimelineDock::createOrEditSelectionMarker()
     }
 }
 
+void TimelineDock::createBeatMarkers(int trackIndex, int clipIndex)
+{
+    m_beatMarkersIndex = QPersistentModelIndex();
+    auto info = m_model.getClipInfo(trackIndex, clipIndex);
+    if (!info || !info->producer || !info->producer->is_valid() || !info->cut
+        || info->cut->is_blank() || info->producer->get_length() <= 0) {
+        emit showStatusMessage(tr("Select a clip with audio in the timeline to mark its beats"));
+        return;
+    }
+    const auto onsets = AudioLevelsTask::onsets(*info->producer);
+    if (onsets.isEmpty()) {
+        // The beats are measured while the waveform is generated.
+        m_beatMarkersIndex = m_model.index(clipIndex, 0, m_model.index(trackIndex));
+        AudioLevelsTask::start(*info->producer, &m_model, m_beatMarkersIndex, false, true);
+        emit showStatusMessage(tr("Detecting beats..."));
+        return;
+    }
+
+    // The onsets are measured at the frame rate of the waveform.
+    const double scale = double(info->producer->get_length()) / onsets.size();
+    QList<Markers::Marker> markers;
+    for (auto beat : BeatDetector::findBeats(onsets, MLT.profile().fps() / scale)) {
+        const int frame = qRound(beat * scale);
+        if (frame < info->frame_in || frame > info->frame_out)
+            continue;
+        const int position = info->start + frame - info->frame_in;
+        if (m_markersModel.markerIndexForPosition(position) >= 0)
+            continue;
+        Markers::Marker marker;
+        marker.text = tr("Beat %1").arg(markers.size() + 1);
+        marker.color = Settings.markerColor();
+        marker.start = position;
+        marker.end = position;
+        markers << marker;
+    }
+    m_markersModel.appendMarkers(markers);
+    emit showStatusMessage(tr("Added %n markers at the beats", nullptr, markers.size()));
+}
+
 void TimelineDock::createMarker()
 {
     if (!m_model.trackList().count() || MLT.producer()->get_length() <= 1)
@@ -3513,6 +3856,79 @@ bool TimelineDock::trimClipIn(
     return true;
 }
 
+bool TimelineDock::isTrimClipInValid(
+    int trackIndex, int clipIndex, int delta, bool ripple, bool roll)
+{
+    // This mirrors the checks of trimClipIn() without changing the model.
+    if (!ripple && !roll
+        && (m_model.addTransitionByTrimInValid(trackIndex, clipIndex, delta)
+            || m_model.removeTransitionByTrimInValid(trackIndex, clipIndex, delta)
+            || m_model.trimTransitionOutValid(trackIndex, clipIndex, delta)))
+        return true;
+    return m_model.trimClipInValid(trackIndex, clipIndex, delta, ripple || roll);
+}
+
+bool TimelineDock::isTrimClipOutValid(
+    int trackIndex, int clipIndex, int delta, bool ripple, bool roll)
+{
+    // This mirrors the checks of trimClipOut() without changing the model.
+    if (!ripple && !roll
+        && (m_model.addTransitionByTrimOutValid(trackIndex, clipIndex, delta)
+            || m_model.removeTransitionByTrimOutValid(trackIndex, clipIndex, delta)
+            || m_model.trimTransitionInValid(trackIndex, clipIndex, delta)))
+        return true;
+    return m_model.trimClipOutValid(trackIndex, clipIndex, delta, ripple || roll);
+}
+
+int TimelineDock::snapTrimFrame(int frame, double tolerance, int trackIndex, int clipIndex)
+{
+    if (!m_isSnapIndexValid) {
+        // Collect the edges of all clips and markers once per change of the
+        // timeline instead of walking the QML items on every mouse move.
+        m_snapEdges.clear();
+        for (int i = 0; i < m_model.trackList().size(); ++i) {
+            QScopedPointer<Mlt::Producer> track(
+                m_model.tractor()->track(m_model.trackList().at(i).mlt_index));
+            if (!track)
+                continue;
+            Mlt::Playlist playlist(*track);
+            for (int j = 0; j < playlist.count(); ++j) {
+                if (playlist.is_blank(j))
+                    continue;
+                const int start = playlist.clip_start(j);
+                m_snapEdges.push_back({start, i, j});
+                m_snapEdges.push_back({start + playlist.clip_length(j), i, j});
+            }
+        }
+        for (const auto &marker : m_markersModel.getMarkers()) {
+            m_snapEdges.push_back({marker.start, -1, -1});
+            if (marker.end != marker.start)
+                m_snapEdges.push_back({marker.end, -1, -1});
+        }
+        std::sort(m_snapEdges.begin(),
+                  m_snapEdges.end(),
+                  [](const SnapEdge &a, const SnapEdge &b) { return a.frame < b.frame; });
+        m_isSnapIndexValid = true;
+    }
+
+    const int from = qFloor(frame - tolerance);
+    auto it = std::lower_bound(m_snapEdges.cbegin(),
+                               m_snapEdges.cend(),
+                               from,
+                               [](const SnapEdge &edge, int value) { return edge.frame < value; });
+    int result = frame;
+    double distance = tolerance;
+    for (; it != m_snapEdges.cend() && it->frame <= frame + tolerance; ++it) {
+        if (it->trackIndex == trackIndex && it->clipIndex == clipIndex)
+            continue;
+        if (qAbs(it->frame - frame) < distance) {
+            distance = qAbs(it->frame - frame);
+            result = it->frame;
+        }
+    }
+    return result;
+}
+
 bool TimelineDock::trimClipOut(int trackIndex, int clipIndex, int delta, bool ripple, bool roll)
 {
     emit trimStarted();
@@ -3615,19 +4031,13 @@ void TimelineDock::insert(int trackIndex, int position, const QString &xml, bool
     if (xml.contains(MAIN.fileName()) && MAIN.isSourceClipMyProject())
         return;
 
-    // Use MLT XML on the clipboard if it exists and is newer than source clip.
-    QString xmlToUse = QGuiApplication::clipboard()->text();
-    if (isSystemClipboardValid(xmlToUse)) {
-        if (!Settings.proxyEnabled()) {
-            ProxyManager::filterXML(xmlToUse, "");
-        }
-    } else {
-        xmlToUse.clear();
-    }
+    // Use the clips on the clipboard if they exist and are newer than source clip.
+    QString xmlToUse;
+    Mlt::Producer clipboard = clipboardProducer(xmlToUse);
 
-    if (MLT.isSeekableClip() || MLT.savedProducer() || !xml.isEmpty() || !xmlToUse.isEmpty()) {
+    if (MLT.isSeekableClip() || MLT.savedProducer() || !xml.isEmpty() || clipboard.is_valid()) {
         Mlt::Producer producer;
-        if (xmlToUse.isEmpty() && xml.isEmpty()) {
+        if (!clipboard.is_valid() && xml.isEmpty()) {
             Mlt::Producer producer(MLT.isClip() ? MLT.producer() : MLT.savedProducer());
             if (MLT.isLiveProducer(&producer)) {
                 LongUiTask::cancel();
@@ -3645,9 +4055,9 @@ void TimelineDock::insert(int trackIndex, int position, const QString &xml, bool
         } else if (!xml.isEmpty()) {
             xmlToUse = xml;
         } else {
-            producer = Mlt::Producer(MLT.profile(), "xml-string", xmlToUse.toUtf8().constData());
+            producer = clipboard;
         }
-        if (xmlToUse.isEmpty()) {
+        if (xmlToUse.isEmpty() && !isMultipleClips(producer)) {
             return;
         }
         if (position < 0) {
@@ -3657,8 +4067,7 @@ void TimelineDock::insert(int trackIndex, int position, const QString &xml, bool
         // Insert multiple if the XML is a <tractor> with child <property name="shotcut">1</property>
         // No need to create a track in an empty timeline.
         // This can be a macro of QUndoCommands.
-        if (producer.is_valid() && producer.type() == mlt_service_tractor_type
-            && producer.get_int(kShotcutXmlProperty)) {
+        if (isMultipleClips(producer)) {
             Mlt::Tractor tractor(producer);
             Mlt::ClipInfo info;
             MAIN.undoStack()->beginMacro(tr("Insert multiple into timeline"));
@@ -3676,15 +4085,13 @@ void TimelineDock::insert(int trackIndex, int position, const QString &xml, bool
                     for (int mltClipIndex = 0; mltClipIndex < playlist.count(); mltClipIndex++) {
                         if (!playlist.is_blank(mltClipIndex)) {
                             playlist.clip_info(mltClipIndex, &info);
-                            Mlt::Producer clip(info.producer);
-                            clip.set_in_and_out(info.frame_in, info.frame_out);
                             bool lastClip = mltTrackIndex == tractor.count() - 1
                                             && mltClipIndex == playlist.count() - 1;
                             MAIN.undoStack()->push(new Timeline::InsertCommand(m_model,
                                                                                m_markersModel,
                                                                                trackIndex,
                                                                                position + info.start,
-                                                                               MLT.XML(&clip),
+                                                                               clipXML(info),
                                                                                lastClip));
                         }
                     }
@@ -3749,19 +4156,13 @@ void TimelineDock::overwrite(int trackIndex, int position, const QString &xml, b
     if (xml.contains(MAIN.fileName()) && MAIN.isSourceClipMyProject())
         return;
 
-    // Use MLT XML on the clipboard if it exists and is newer than source clip.
-    QString xmlToUse = QGuiApplication::clipboard()->text();
-    if (isSystemClipboardValid(xmlToUse)) {
-        if (!Settings.proxyEnabled()) {
-            ProxyManager::filterXML(xmlToUse, "");
-        }
-    } else {
-        xmlToUse.clear();
-    }
+    // Use the clips on the clipboard if they exist and are newer than source clip.
+    QString xmlToUse;
+    Mlt::Producer clipboard = clipboardProducer(xmlToUse);
 
-    if (MLT.isSeekableClip() || MLT.savedProducer() || !xml.isEmpty() || !xmlToUse.isEmpty()) {
+    if (MLT.isSeekableClip() || MLT.savedProducer() || !xml.isEmpty() || clipboard.is_valid()) {
         Mlt::Producer producer;
-        if (xmlToUse.isEmpty() && xml.isEmpty()) {
+        if (!clipboard.is_valid() && xml.isEmpty()) {
             Mlt::Producer producer(MLT.isClip() ? MLT.producer() : MLT.savedProducer());
             if (MLT.isLiveProducer(&producer)) {
                 LongUiTask::cancel();
@@ -3791,7 +4192,7 @@ void TimelineDock::overwrite(int trackIndex, int position, const QString &xml, b
                 xmlToUse = xml;
             }
         } else {
-            producer = Mlt::Producer(MLT.profile(), "xml-string", xmlToUse.toUtf8().constData());
+            producer = clipboard;
         }
         if (position < 0) {
             position = qMax(m_position, 0);
@@ -3800,8 +4201,7 @@ void TimelineDock::overwrite(int trackIndex, int position, const QString &xml, b
         // Overwrite multiple if the XML is a <tractor> with child <property name="shotcut">1</property>
         // No need to create a track in an empty timeline.
         // This can be a macro of QUndoCommands.
-        if (producer.is_valid() && producer.type() == mlt_service_tractor_type
-            && producer.get_int(kShotcutXmlProperty)) {
+        if (isMultipleClips(producer)) {
             Mlt::Tractor tractor(producer);
             Mlt::ClipInfo info;
             MAIN.undoStack()->beginMacro(tr("Overwrite multiple onto timeline"));
@@ -3819,13 +4219,11 @@ void TimelineDock::overwrite(int trackIndex, int position, const QString &xml, b
                     for (int mltClipIndex = 0; mltClipIndex < playlist.count(); mltClipIndex++) {
                         if (!playlist.is_blank(mltClipIndex)) {
                             playlist.clip_info(mltClipIndex, &info);
-                            Mlt::Producer clip(info.producer);
-                            clip.set_in_and_out(info.frame_in, info.frame_out);
                             MAIN.undoStack()->push(
                                 new Timeline::OverwriteCommand(m_model,
                                                                trackIndex,
                                                                position + info.start,
-                                                               MLT.XML(&clip),
+                                                               clipXML(info),
                                                                false));
                         }
                     }
@@ -3955,22 +4353,7 @@ void TimelineDock::seekPreviousEdit()
     if (!m_model.tractor())
         return;
 
-    int newPosition = -1;
-    int n = m_model.tractor()->count();
-    for (int i = 0; i < n; i++) {
-        QScopedPointer<Mlt::Producer> track(m_model.tractor()->track(i));
-        if (track) {
-            Mlt::Playlist playlist(*track);
-            // Skip empty tracks (tracks with only one blank clip)
-            if (isEmptyTrack(playlist))
-                continue;
-            int clipIndex = playlist.get_clip_index_at(m_position);
-            if (clipIndex >= 0 && m_position == playlist.clip_start(clipIndex))
-                --clipIndex;
-            if (clipIndex >= 0)
-                newPosition = qMax(newPosition, playlist.clip_start(clipIndex));
-        }
-    }
+    int newPosition = m_model.previousEdit(m_position);
     if (newPosition != m_position)
         setPosition(newPosition);
 }
@@ -3982,24 +4365,8 @@ void TimelineDock::seekNextEdit()
     if (!m_model.tractor())
         return;
 
-    int newPosition = std::numeric_limits<int>::max();
-    int n = m_model.tractor()->count();
-    for (int i = 0; i < n; i++) {
-        QScopedPointer<Mlt::Producer> track(m_model.tractor()->track(i));
-        if (track) {
-            Mlt::Playlist playlist(*track);
-            // Skip empty tracks (tracks with only one blank clip)
-            if (isEmptyTrack(playlist))
-                continue;
-            int clipIndex = playlist.get_clip_index_at(m_position) + 1;
-            if (clipIndex < playlist.count())
-                newPosition = qMin(newPosition, playlist.clip_start(clipIndex));
-            else if (clipIndex == playlist.count())
-                newPosition = qMin(newPosition,
-                                   playlist.clip_start(clipIndex) + playlist.clip_length(clipIndex));
-        }
-    }
-    if (newPosition != m_position)
+    int newPosition = m_model.nextEdit(m_position);
+    if (newPosition >= 0 && newPosition != m_position)
         setPosition(newPosition);
 }
 
@@ -4084,7 +4451,7 @@ void TimelineDock::load(bool force)
         QDir sourcePath = QmlUtilities::qmlDir();
         sourcePath.cd("views");
         sourcePath.cd("timeline");
-        m_quickView.setFocusPolicy(isFloating() ? Qt::NoFocus : Qt::StrongFocus);
+        m_quickView.widget()->setFocusPolicy(isFloating() ? Qt::NoFocus : Qt::StrongFocus);
         m_quickView.setSource(QUrl::fromLocalFile(sourcePath.filePath("timeline.qml")));
         if (force && Settings.timelineShowWaveforms())
             m_model.reload();
@@ -4097,7 +4464,7 @@ void TimelineDock::load(bool force)
 
 void TimelineDock::onTopLevelChanged(bool floating)
 {
-    m_quickView.setFocusPolicy(floating ? Qt::NoFocus : Qt::StrongFocus);
+    m_quickView.widget()->setFocusPolicy(floating ? Qt::NoFocus : Qt::StrongFocus);
 }
 
 void TimelineDock::onTransitionAdded(int trackIndex, int clipIndex, int position, bool ripple)
@@ -4247,14 +4614,26 @@ public:
     int on_end_link(Mlt::Link *) { return 0; }
 };
 
-void TimelineDock::replaceClipsWithHash(const QString &hash, Mlt::Producer &producer)
+void TimelineDock::replaceClipsWithHash(const QString &hash,
+                                        Mlt::Producer &producer,
+                                        bool isTimewarpOnly)
 {
     FindProducersByHashParser parser(hash);
     parser.start(*model()->tractor());
-    auto n = parser.producers().size();
-    if (n > 1)
-        MAIN.undoStack()->beginMacro(tr("Replace %n timeline clips", nullptr, n));
+    QList<Mlt::Producer> clips;
     for (auto &clip : parser.producers()) {
+        // An intra-frame cache only stands in for the timewarp clips without a proxy.
+        Mlt::Producer parent = clip.parent();
+        if (!isTimewarpOnly
+            || (Util::ProducerIsTimewarp(&parent) && !parent.get_int(kIsProxyProperty)))
+            clips << clip;
+    }
+    auto n = clips.size();
+    if (n > 1) {
+        MAIN.undoStack()->beginMacro(tr("Replace %n timeline clips", nullptr, n));
+        m_model.beginBatch();
+    }
+    for (auto &clip : clips) {
         int trackIndex = -1;
         int clipIndex = -1;
         // lookup the current track and clip index by UUID
@@ -4295,8 +4674,10 @@ void TimelineDock::replaceClipsWithHash(const QString &hash, Mlt::Producer &prod
             }
         }
     }
-    if (n > 1)
+    if (n > 1) {
+        m_model.endBatch();
         MAIN.undoStack()->endMacro();
+    }
 }
 
 void TimelineDock::recordAudio()
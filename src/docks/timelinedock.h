@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -23,14 +23,17 @@
 #include "models/multitrackmodel.h"
 #include "models/subtitlesmodel.h"
 #include "models/subtitlesselectionmodel.h"
+#include "renderpreview.h"
 #include "sharedframe.h"
+#include "widgets/quickviewhost.h"
 
 #include <QApplication>
 #include <QDateTime>
 #include <QDockWidget>
-#include <QQuickWidget>
 #include <QTimer>
 
+#include <vector>
+
 namespace Timeline {
 class UpdateCommand;
 class TrimCommand;
@@ -59,6 +62,7 @@ public:
     MarkersModel *markersModel() { return &m_markersModel; }
     SubtitlesModel *subtitlesModel() { return &m_subtitlesModel; }
     SubtitlesSelectionModel *subtitlesSelectionModel() { return &m_subtitlesSelectionModel; }
+    RenderPreview *renderPreview() { return &m_renderPreview; }
     int position() const { return m_position; }
     void setPosition(int position);
     Mlt::Producer producerForClip(int trackIndex, int clipIndex);
@@ -88,7 +92,9 @@ public:
     Q_INVOKABLE bool isFloating() const { return QDockWidget::isFloating(); }
     Q_INVOKABLE static void openProperties();
     void emitSelectedChanged(const QVector<int> &roles);
-    void replaceClipsWithHash(const QString &hash, Mlt::Producer &producer);
+    void replaceClipsWithHash(const QString &hash,
+                              Mlt::Producer &producer,
+                              bool isTimewarpOnly = false);
     Q_INVOKABLE void recordAudio();
     Q_INVOKABLE void stopRecording();
     bool isRecording() const { return m_isRecording; }
@@ -158,6 +164,9 @@ public slots:
     bool trimClipIn(
         int trackIndex, int clipIndex, int oldClipIndex, int delta, bool ripple, bool roll);
     bool trimClipOut(int trackIndex, int clipIndex, int delta, bool ripple, bool roll);
+    bool isTrimClipInValid(int trackIndex, int clipIndex, int delta, bool ripple, bool roll);
+    bool isTrimClipOutValid(int trackIndex, int clipIndex, int delta, bool ripple, bool roll);
+    int snapTrimFrame(int frame, double tolerance, int trackIndex, int clipIndex);
     void insert(int trackIndex, int position = -1, const QString &xml = QString(), bool seek = true);
     void overwrite(int trackIndex,
                    int position = -1,
@@ -175,6 +184,8 @@ public slots:
     void insertAudioTrack();
     void insertVideoTrack();
     void removeTrack();
+    void renderTrack(int trackIndex);
+    void restoreTrack(int trackIndex);
     void moveTrack(int fromTrackIndex, int toTrackIndex);
     void moveTrackUp();
     void moveTrackDown();
@@ -193,6 +204,8 @@ public slots:
     void replace(int trackIndex, int clipIndex, const QString &xml = QString());
     void createOrEditMarker();
     void createOrEditSelectionMarker();
+    //! Adds the markers in one change, waiting for the waveform of the clip if needed.
+    void createBeatMarkers(int trackIndex, int clipIndex);
     void createMarker();
     void editMarker(int markerIndex);
     void deleteMarker(int markerIndex = -1);
@@ -231,11 +244,13 @@ private:
     void freezeFrame();
     void addGenerator(QWidget *widget);
 
-    QQuickWidget m_quickView;
+    QuickViewHost m_quickView;
     MultitrackModel m_model;
     MarkersModel m_markersModel;
+    QPersistentModelIndex m_beatMarkersIndex;
     SubtitlesModel m_subtitlesModel;
     SubtitlesSelectionModel m_subtitlesSelectionModel;
+    RenderPreview m_renderPreview;
     int m_position{-1};
     std::unique_ptr<Timeline::UpdateCommand> m_updateCommand;
     bool m_ignoreNextPositionChange{false};
@@ -265,6 +280,14 @@ private:
     QMenu *m_clipMenu{nullptr};
     int m_loopStart{-1};
     int m_loopEnd{-1};
+    struct SnapEdge
+    {
+        int frame;
+        int trackIndex;
+        int clipIndex; // -1 for a marker
+    };
+    std::vector<SnapEdge> m_snapEdges; // Sorted by frame, built on demand
+    bool m_isSnapIndexValid{false};
 
 private slots:
     void load(bool force);
@@ -276,6 +299,7 @@ private slots:
     void onRecordStarted();
     void updateRecording();
     void onRecordFinished(AbstractJob *, bool);
+    void onRenderTrackFinished(AbstractJob *job, bool isSuccess);
     void onWarnTrackLocked();
     void onTimelineRightClicked();
     void onClipRightClicked();
@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "executors.h"
+
+#include "Logger.h"
+
+#include <QCoreApplication>
+#include <QThread>
+
+#include <atomic>
+
+static const int kMaxAnalysisThreads = 4;
+static const int kMaxThumbnailThreads = 4;
+
+namespace {
+struct ExecutorPools
+{
+    QThreadPool pools[Executors::ExecutorCount];
+    std::atomic<int> started[Executors::ExecutorCount] = {};
+
+    ExecutorPools()
+    {
+        const int cores = QThread::idealThreadCount();
+        pools[Executors::InteractiveExecutor].setMaxThreadCount(qMax(1, cores));
+        pools[Executors::InteractiveExecutor].setThreadPriority(QThread::NormalPriority);
+        pools[Executors::AnalysisExecutor].setMaxThreadCount(qBound(1, cores, kMaxAnalysisThreads));
+        pools[Executors::AnalysisExecutor].setThreadPriority(QThread::LowPriority);
+        pools[Executors::ThumbnailExecutor].setMaxThreadCount(
+            qBound(1, cores / 2, kMaxThumbnailThreads));
+        pools[Executors::ThumbnailExecutor].setThreadPriority(QThread::LowPriority);
+        for (int i = 0; i < Executors::ExecutorCount; ++i) {
+            pools[i].setObjectName(Executors::name(Executors::Executor(i)));
+            LOG_DEBUG() << pools[i].objectName() << "threads" << pools[i].maxThreadCount();
+        }
+    }
+};
+} // namespace
+
+static ExecutorPools &executorPools()
+{
+    static ExecutorPools pools;
+    return pools;
+}
+
+QThreadPool &Executors::pool(Executor executor)
+{
+    return executorPools().pools[executor];
+}
+
+QString Executors::name(Executor executor)
+{
+    switch (executor) {
+    case InteractiveExecutor:
+        return QCoreApplication::translate("Executors", "Interactive");
+    case AnalysisExecutor:
+        return QCoreApplication::translate("Executors", "Media analysis");
+    case ThumbnailExecutor:
+        return QCoreApplication::translate("Executors", "Thumbnails");
+    default:
+        return QString();
+    }
+}
+
+Executors::Statistics Executors::statistics(Executor executor)
+{
+    Statistics result;
+    auto &pools = executorPools();
+    result.started = pools.started[executor].load(std::memory_order_relaxed);
+    result.active = pools.pools[executor].activeThreadCount();
+    result.maxThreads = pools.pools[executor].maxThreadCount();
+    return result;
+}
+
+void Executors::start(Executor executor, QRunnable *runnable, int priority)
+{
+    countStarted(executor);
+    pool(executor).start(runnable, priority);
+}
+
+void Executors::start(Executor executor, std::function<void()> function, int priority)
+{
+    countStarted(executor);
+    pool(executor).start(std::move(function), priority);
+}
+
+bool Executors::tryStart(Executor executor, std::function<void()> function)
+{
+    if (!pool(executor).tryStart(std::move(function)))
+        return false;
+    countStarted(executor);
+    return true;
+}
+
+void Executors::clear()
+{
+    for (auto &pool : executorPools().pools)
+        pool.clear();
+}
+
+void Executors::countStarted(Executor executor)
+{
+    executorPools().started[executor].fetch_add(1, std::memory_order_relaxed);
+}
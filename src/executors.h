@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EXECUTORS_H
+#define EXECUTORS_H
+
+#include <QString>
+#include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <functional>
+#include <utility>
+
+/*!
+  \class Executors
+  \brief Separates the background work into thread pools by workload.
+
+  \threadsafe
+
+  Work the user is waiting to see, such as scope refreshes, runs on the
+  interactive pool at normal priority with a thread per core. Long media
+  analysis, such as audio levels, scene detection and probing, runs on the
+  analysis pool at low priority with at most four threads. Thumbnails have a
+  pool of their own in between. A burst of one class therefore cannot starve
+  the others. The global pool remains for small one-off tasks.
+*/
+
+class Executors
+{
+public:
+    enum Executor { InteractiveExecutor, AnalysisExecutor, ThumbnailExecutor, ExecutorCount };
+
+    struct Statistics
+    {
+        int started = 0; ///< Tasks started since Shotcut started
+        int active = 0;  ///< Threads running a task now
+        int maxThreads = 0;
+    };
+
+    static QThreadPool &pool(Executor executor);
+    static QString name(Executor executor);
+    static Statistics statistics(Executor executor);
+
+    static void start(Executor executor, QRunnable *runnable, int priority = 0);
+    static void start(Executor executor, std::function<void()> function, int priority = 0);
+    //! Starts \a function only if a thread is free and returns whether it did.
+    static bool tryStart(Executor executor, std::function<void()> function);
+
+    //! Runs \a function with QtConcurrent on the pool of \a executor.
+    template<class Function, class... Args>
+    static auto run(Executor executor, Function &&function, Args &&...args)
+    {
+        countStarted(executor);
+        return QtConcurrent::run(&pool(executor),
+                                 std::forward<Function>(function),
+                                 std::forward<Args>(args)...);
+    }
+
+    //! Drops the tasks that have not started in every pool.
+    static void clear();
+
+private:
+    static void countStarted(Executor executor);
+};
+
+#endif // EXECUTORS_H
@@ -0,0 +1,139 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "fftplancache.h"
+
+#include "Logger.h"
+
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+
+static const int kMaxPlans = 16;
+// Keys for real plans that are neither FFTW_FORWARD nor FFTW_BACKWARD.
+static const int kRealToComplex = 0;
+static const int kComplexToReal = 2;
+
+namespace {
+
+struct CachedPlan
+{
+    int size;
+    int kind;
+    unsigned flags;
+    FftPlanCache::Plan plan;
+};
+
+// The FFTW planner is not thread safe, so every plan is made and destroyed
+// while holding this. It is never deleted because plans held by other static
+// objects may be released after it would have been destroyed at exit.
+QMutex &planningMutex()
+{
+    static QMutex *mutex = new QMutex;
+    return *mutex;
+}
+
+// The most recently used plan is first.
+QList<CachedPlan> &cachedPlans()
+{
+    static QList<CachedPlan> *plans = new QList<CachedPlan>;
+    return *plans;
+}
+
+void destroyPlan(fftw_plan plan)
+{
+    QMutexLocker locker(&planningMutex());
+    fftw_destroy_plan(plan);
+}
+
+FftPlanCache::Plan plan(int size, int kind, unsigned flags)
+{
+    if (size <= 0)
+        return FftPlanCache::Plan();
+
+    // Declared before the locker so that evicted plans are released after
+    // unlocking, since destroying one takes the lock again.
+    QList<CachedPlan> evicted;
+    QMutexLocker locker(&planningMutex());
+    auto &plans = cachedPlans();
+    for (int i = 0; i < plans.size(); ++i) {
+        if (plans[i].size == size && plans[i].kind == kind && plans[i].flags == flags) {
+            if (i > 0)
+                plans.move(i, 0);
+            return plans.first().plan;
+        }
+    }
+
+    fftw_plan p = nullptr;
+    if (kind == kRealToComplex) {
+        double *in = fftw_alloc_real(size);
+        fftw_complex *out = fftw_alloc_complex(size / 2 + 1);
+        p = fftw_plan_dft_r2c_1d(size, in, out, flags);
+        fftw_free(in);
+        fftw_free(out);
+    } else if (kind == kComplexToReal) {
+        fftw_complex *in = fftw_alloc_complex(size / 2 + 1);
+        double *out = fftw_alloc_real(size);
+        p = fftw_plan_dft_c2r_1d(size, in, out, flags);
+        fftw_free(in);
+        fftw_free(out);
+    } else {
+        fftw_complex *buf = fftw_alloc_complex(size);
+        p = fftw_plan_dft_1d(size, buf, buf, kind, flags);
+        fftw_free(buf);
+    }
+    if (!p) {
+        LOG_WARNING() << "failed to plan an FFT of size" << size;
+        return FftPlanCache::Plan();
+    }
+    plans.prepend({size, kind, flags, FftPlanCache::Plan(p, destroyPlan)});
+    while (plans.size() > kMaxPlans)
+        evicted << plans.takeLast();
+    return plans.first().plan;
+}
+
+} // namespace
+
+FftPlanCache::Plan FftPlanCache::realToComplex(int size, unsigned flags)
+{
+    return plan(size, kRealToComplex, flags);
+}
+
+FftPlanCache::Plan FftPlanCache::complexToReal(int size, unsigned flags)
+{
+    return plan(size, kComplexToReal, flags);
+}
+
+FftPlanCache::Plan FftPlanCache::complex(int size, int sign, unsigned flags)
+{
+    Q_ASSERT(sign == FFTW_FORWARD || sign == FFTW_BACKWARD);
+    return plan(size, sign, flags);
+}
+
+int FftPlanCache::fastSize(int minimum)
+{
+    // FFTW is fastest for sizes whose prime factors are all small.
+    for (int size = qMax(1, minimum);; ++size) {
+        int n = size;
+        for (int factor : {2, 3, 5, 7}) {
+            while (n % factor == 0)
+                n /= factor;
+        }
+        if (n == 1)
+            return size;
+    }
+}
@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FFTPLANCACHE_H
+#define FFTPLANCACHE_H
+
+#include <QSharedPointer>
+
+#include <fftw3.h>
+
+/*!
+  \class FftPlanCache
+  \brief The FftPlanCache shares FFTW plans between all users of FFTW.
+
+  \threadsafe
+
+  Creating and destroying FFTW plans is not thread safe, but executing them
+  is. The cache is the only place that plans are made, under one lock, and it
+  hands out the same plan to everyone who asks for the same transform.
+
+  Plans are made on scratch arrays and must be executed with the new-array
+  functions, such as fftw_execute_dft_r2c() and fftw_execute_dft(), on arrays
+  allocated with fftw_malloc() or the fftw_alloc functions. Complex plans are
+  in place, so the same array must be passed as input and output. Complex to
+  real plans overwrite their input.
+
+  Plans are made with FFTW_ESTIMATE unless other \a flags are given. Use
+  FFTW_MEASURE for a large transform that is executed many times; measuring
+  takes a while, so it is only done once per size and the result is shared.
+
+  The most recently used plans are kept. A plan that has fallen out of the
+  cache stays valid until its last Plan is released.
+*/
+
+class FftPlanCache
+{
+public:
+    typedef QSharedPointer<fftw_plan_s> Plan;
+
+    //! Returns a plan from \a size reals to \a size / 2 + 1 complex values.
+    static Plan realToComplex(int size, unsigned flags = FFTW_ESTIMATE);
+    //! Returns a plan from \a size / 2 + 1 complex values to \a size reals.
+    static Plan complexToReal(int size, unsigned flags = FFTW_ESTIMATE);
+    //! Returns an in-place complex plan where \a sign is FFTW_FORWARD or FFTW_BACKWARD.
+    static Plan complex(int size, int sign, unsigned flags = FFTW_ESTIMATE);
+    //! Returns the smallest size of at least \a minimum that FFTW transforms quickly.
+    static int fastSize(int minimum);
+};
+
+#endif // FFTPLANCACHE_H
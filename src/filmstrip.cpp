@@ -0,0 +1,165 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filmstrip.h"
+
+#include "Logger.h"
+#include "database.h"
+#include "memorybudget.h"
+#include "mltcontroller.h"
+#include "shotcut_mlt_properties.h"
+#include "thumbnaildecoderpool.h"
+#include "thumbnailscheduler.h"
+
+#include <MltProducer.h>
+#include <QCryptographicHash>
+#include <QPainter>
+#include <QtMath>
+
+static const int kGridColumns = 10;
+static const int kMaxCacheCost = 32 * 1024; // KiB
+
+static QString cacheKey(Mlt::Producer &producer, const QSize &size)
+{
+    const auto dimensions = QStringLiteral("%1x%2").arg(size.width()).arg(size.height());
+    QString hash = producer.get(kShotcutHashProperty);
+    if (hash.isEmpty()) {
+        const auto key = QStringLiteral("%1 %2 %3")
+                             .arg(producer.get("mlt_service"))
+                             .arg(producer.get("resource"))
+                             .arg(producer.get_length());
+        hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex();
+    }
+    return QStringLiteral("%1 filmstrip %2 %3")
+        .arg(hash)
+        .arg(Filmstrip::kFrameCount)
+        .arg(dimensions);
+}
+
+Filmstrip::Filmstrip(QObject *parent)
+    : QObject(parent)
+{
+    m_strips.setMaxCost(kMaxCacheCost);
+    MEMORY.add(
+        "filmstrips",
+        MemoryBudget::ThumbnailPriority,
+        [this]() { return qint64(m_strips.totalCost()) * 1024; },
+        [this](qint64 bytes) { return MemoryBudget::trim(m_strips, bytes); });
+}
+
+Filmstrip &Filmstrip::singleton()
+{
+    static Filmstrip instance;
+    return instance;
+}
+
+QImage Filmstrip::frame(Mlt::Producer &producer, int position)
+{
+    const int length = producer.is_valid() ? producer.get_length() : 0;
+    // Still images, generators and projects do not have frames worth showing.
+    if (length <= 1 || !MLT.isFileProducer(&producer) || !MLT.isSeekable(&producer)
+        || (MLT.isImageProducer(&producer) && !producer.get_int(kShotcutSequenceProperty)))
+        return QImage();
+    const QSize size(kFrameWidth, qRound(kFrameWidth / MLT.profile().dar()) & ~1);
+    const auto key = cacheKey(producer, size);
+
+    if (auto strip = m_strips.object(key)) {
+        const int index = qBound(0, int(qint64(position) * kFrameCount / length), kFrameCount - 1);
+        const int width = strip->width() / kGridColumns;
+        const int height = strip->height() / (kFrameCount / kGridColumns);
+        return strip->copy((index % kGridColumns) * width,
+                           (index / kGridColumns) * height,
+                           width,
+                           height);
+    }
+    if (m_pending.contains(key))
+        return QImage();
+
+    // Look in the thumbnail store before rendering it.
+    m_pending.insert(key);
+    Mlt::Producer copy(producer);
+    auto image = DB.requestThumbnail(key, this, [=](const QImage &image) mutable {
+        if (!image.isNull()) {
+            onLoaded(key, image);
+        } else {
+            m_pending.remove(key);
+            render(key, copy, size);
+        }
+    });
+    if (!image.isNull()) {
+        onLoaded(key, image);
+        return frame(producer, position);
+    }
+    return QImage();
+}
+
+void Filmstrip::render(const QString &key, Mlt::Producer &producer, const QSize &size)
+{
+    // Take the frames from the middle of each interval in the fps of the pool.
+    auto &pool = ThumbnailDecoderPool::singleton();
+    const double factor = pool.profile().fps() / MLT.profile().fps();
+    const double interval = double(producer.get_length()) / kFrameCount;
+    QList<int> frameNumbers;
+    for (int i = 0; i < kFrameCount; ++i)
+        frameNumbers << qRound(qFloor(interval * (i + 0.5)) * factor);
+    const QString service = producer.get("mlt_service");
+    const QString resource = producer.get("resource");
+
+    // The scheduler keeps one request for the key and drops it when it is
+    // too old, in which case hovering again asks for it again.
+    ThumbnailScheduler::singleton().request(
+        key,
+        [=]() {
+            const auto images = ThumbnailDecoderPool::singleton()
+                                    .images(service,
+                                            resource,
+                                            frameNumbers,
+                                            size.width(),
+                                            size.height(),
+                                            ThumbnailDecoderPool::FastSeek);
+            QImage strip(size.width() * kGridColumns,
+                         size.height() * (kFrameCount / kGridColumns),
+                         QImage::Format_RGB32);
+            strip.fill(Qt::black);
+            QPainter painter(&strip);
+            for (int i = 0; i < images.size(); ++i) {
+                if (images[i].isNull())
+                    continue;
+                const auto image = images[i].scaled(size,
+                                                    Qt::KeepAspectRatio,
+                                                    Qt::SmoothTransformation);
+                painter.drawImage((i % kGridColumns) * size.width()
+                                      + (size.width() - image.width()) / 2,
+                                  (i / kGridColumns) * size.height()
+                                      + (size.height() - image.height()) / 2,
+                                  image);
+            }
+            painter.end();
+            LOG_DEBUG() << "rendered filmstrip" << resource;
+            DB.putThumbnail(key, strip);
+            QMetaObject::invokeMethod(
+                this, [=]() { onLoaded(key, strip); }, Qt::QueuedConnection);
+        },
+        this);
+}
+
+void Filmstrip::onLoaded(const QString &key, const QImage &image)
+{
+    m_pending.remove(key);
+    m_strips.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+    emit ready();
+}
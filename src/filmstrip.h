@@ -0,0 +1,74 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILMSTRIP_H
+#define FILMSTRIP_H
+
+#include <QCache>
+#include <QImage>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class Filmstrip
+  \brief Keeps small frames spread over each clip for previews on hover.
+
+  A filmstrip is kFrameCount frames kFrameWidth pixels wide taken at even
+  intervals over the whole length of a clip. The frames are rendered once by
+  the thumbnail decoder pool on the thumbnail scheduler and laid out in a
+  grid in one image, which is kept in the thumbnail store and in memory.
+  Hovering the scrub bar or a playlist item then only copies a frame out
+  of memory instead of decoding one for every move of the mouse.
+
+  Only the GUI thread uses this.
+*/
+
+class Filmstrip : public QObject
+{
+    Q_OBJECT
+
+public:
+    static const int kFrameCount = 100;
+    static const int kFrameWidth = 160;
+
+    static Filmstrip &singleton();
+
+    /*!
+      Returns the frame of \a producer nearest to \a position if its
+      filmstrip is in memory. Otherwise, it returns a null image and loads or
+      renders the filmstrip, emitting ready() when it is available.
+    */
+    QImage frame(Mlt::Producer &producer, int position);
+
+signals:
+    void ready();
+
+private:
+    explicit Filmstrip(QObject *parent = nullptr);
+    void render(const QString &key, Mlt::Producer &producer, const QSize &size);
+    void onLoaded(const QString &key, const QImage &image);
+
+    QCache<QString, QImage> m_strips; ///< Costs in KiB
+    QSet<QString> m_pending;
+};
+
+#endif // FILMSTRIP_H
@@ -0,0 +1,184 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "filterchainoptimizer.h"
+
+#include "Logger.h"
+#include "controllers/filtercontroller.h"
+#include "mainwindow.h"
+#include "qmltypes/qmlmetadata.h"
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+#include <QDomDocument>
+
+#include <memory>
+
+static const char *kHighBitDepthRequest = "rgba64";
+
+void FilterChainOptimizer::optimize(Mlt::Producer &producer)
+{
+    if (!producer.is_valid())
+        return;
+    const int count = producer.filter_count();
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<Mlt::Filter> filter(producer.filter(i));
+        if (filter && filter->is_valid() && !filter->get_int("_loader")
+            && !filter->get_int(kShotcutHiddenProperty)) {
+            optimize(*filter, MAIN.filterController()->metadataForService(filter.get()));
+        }
+    }
+}
+
+bool FilterChainOptimizer::optimize(Mlt::Service &filter, const QmlMetadata *meta)
+{
+    const bool isSkipped = filter.get_int(kShotcutIdentityProperty);
+    // Leave a filter the user disabled alone.
+    if (!isSkipped && filter.get_int("disable"))
+        return false;
+    const bool skip = isIdentity(filter, meta);
+    if (skip == isSkipped)
+        return false;
+    if (skip) {
+        filter.set(kShotcutIdentityProperty, 1);
+        filter.set("disable", 1);
+    } else {
+        filter.clear(kShotcutIdentityProperty);
+        filter.set("disable", 0);
+    }
+    LOG_DEBUG() << (skip ? "skipping" : "no longer skipping") << filter.get("mlt_service");
+    return true;
+}
+
+bool FilterChainOptimizer::isDisabled(Mlt::Service &filter)
+{
+    return filter.get_int("disable") && !filter.get_int(kShotcutIdentityProperty);
+}
+
+bool FilterChainOptimizer::isIdentity(Mlt::Service &filter, const QmlMetadata *meta)
+{
+    if (!meta || meta->identity().isEmpty())
+        return false;
+    const auto identity = meta->identity();
+    for (auto it = identity.constBegin(); it != identity.constEnd(); ++it) {
+        const QString value = QString::fromUtf8(filter.get(it.key().toUtf8().constData()));
+        // An unset property has the default of the MLT service, which may differ,
+        // and a keyframed one contains '='.
+        if (value.isEmpty() || value.contains('='))
+            return false;
+        bool isNumber = false;
+        const double expected = it.value().toDouble(&isNumber);
+        if (isNumber && it.value().typeId() != QMetaType::QString) {
+            bool ok = false;
+            const double actual = value.toDouble(&ok);
+            if (!ok || !qFuzzyCompare(1.0 + actual, 1.0 + expected))
+                return false;
+        } else if (value != it.value().toString()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FilterChainOptimizer::filterXML(QString &xml)
+{
+    if (!xml.contains(QLatin1String(kShotcutIdentityProperty)))
+        return false;
+    QDomDocument dom;
+    if (!dom.setContent(xml))
+        return false;
+
+    bool isFiltered = false;
+    QDomNodeList filters = dom.elementsByTagName("filter");
+    for (int i = 0; i < filters.length(); ++i) {
+        QDomElement filter = filters.at(i).toElement();
+        QDomNodeList properties = filter.elementsByTagName("property");
+        QDomElement identity;
+        QDomElement disable;
+        for (int j = 0; j < properties.length(); ++j) {
+            QDomElement property = properties.at(j).toElement();
+            if (property.parentNode() != filter)
+                continue;
+            if (property.attribute("name") == kShotcutIdentityProperty)
+                identity = property;
+            else if (property.attribute("name") == "disable")
+                disable = property;
+        }
+        if (identity.isNull())
+            continue;
+        filter.removeChild(identity);
+        if (!disable.isNull())
+            filter.removeChild(disable);
+        isFiltered = true;
+    }
+    if (isFiltered)
+        xml = dom.toString(2);
+    return isFiltered;
+}
+
+QList<FilterChainOptimizer::ImageFormatRun> FilterChainOptimizer::planImageFormats(
+    Mlt::Producer &producer, const QString &format)
+{
+    QList<ImageFormatRun> runs;
+    if (!producer.is_valid())
+        return runs;
+    // The request goes from the last filter to the first.
+    QString request = format;
+    for (int i = producer.filter_count() - 1; i >= 0; i--) {
+        std::unique_ptr<Mlt::Filter> filter(producer.filter(i));
+        if (!filter || !filter->is_valid() || filter->get_int("_loader")
+            || filter->get_int(kShotcutHiddenProperty) || filter->get_int("disable"))
+            continue;
+        auto meta = MAIN.filterController()->metadataForService(filter.get());
+        if (meta && meta->isAudio())
+            continue;
+        const auto formats = imageFormats(*filter, meta);
+        if (!formats.isEmpty() && !formats.contains(request))
+            request = formats.first();
+        if (!runs.isEmpty() && runs.first().format == request)
+            runs.first().first = i;
+        else
+            runs.prepend(ImageFormatRun{i, i, request});
+    }
+    return runs;
+}
+
+bool FilterChainOptimizer::isEightBitOutput(Mlt::Producer &producer)
+{
+    const auto runs = planImageFormats(producer, kHighBitDepthRequest);
+    if (runs.isEmpty())
+        return false;
+    LOG_DEBUG() << producer.get("resource") << "converts" << runs.size() - 1
+                << "times between its filters and ends in" << runs.last().format;
+    return !isHighBitDepth(runs.last().format);
+}
+
+QStringList FilterChainOptimizer::imageFormats(Mlt::Service &filter, const QmlMetadata *meta)
+{
+    if (meta && !meta->imageFormats().isEmpty())
+        return meta->imageFormats();
+    // The frei0r API has only 8-bit RGBA.
+    if (QString::fromLatin1(filter.get("mlt_service")).startsWith("frei0r."))
+        return {"rgba"};
+    return {};
+}
+
+bool FilterChainOptimizer::isHighBitDepth(const QString &format)
+{
+    return format == "rgba64" || format == "yuv420p10" || format == "yuv444p10"
+           || format == "yuv422p16";
+}
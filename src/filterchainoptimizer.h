@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FILTERCHAINOPTIMIZER_H
+#define FILTERCHAINOPTIMIZER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+class QmlMetadata;
+namespace Mlt {
+class Producer;
+class Service;
+} // namespace Mlt
+
+/*!
+  \class FilterChainOptimizer
+  \brief Skips the attached filters that do not change the frame.
+
+  A filter whose properties all have the identity values of its metadata, such
+  as a gain of 0 dB, still costs an image or audio conversion and a pass over
+  every frame. It is disabled for rendering but shown as enabled, and it is
+  enabled again as soon as one of those properties changes. The MLT XML of the
+  project keeps it enabled, so it is skipped again when the clip is loaded.
+
+  It also plans the image formats of the filters. MLT asks each filter for the
+  format the next one wants, and a filter that cannot process it converts. A
+  run of filters that shares a format needs no conversion, so the plan is the
+  list of those runs, and a chain that ends in an 8-bit run has nothing to gain
+  from a 10-bit output.
+*/
+
+class FilterChainOptimizer
+{
+public:
+    //! Updates whether each filter attached to \a producer is skipped.
+    static void optimize(Mlt::Producer &producer);
+    //! Updates whether \a filter is skipped and returns true if that changed.
+    static bool optimize(Mlt::Service &filter, const QmlMetadata *meta);
+    //! Returns whether the user disabled \a filter, as opposed to it being skipped.
+    static bool isDisabled(Mlt::Service &filter);
+    //! Enables the skipped filters in the MLT \a xml; returns false if there were none.
+    static bool filterXML(QString &xml);
+
+    struct ImageFormatRun
+    {
+        int first; ///< The MLT index of the first filter
+        int last;
+        QString format;
+    };
+    /*!
+      Returns the runs of the video filters of \a producer that process the same
+      image format when the consumer asks for \a format, in MLT order.
+    */
+    static QList<ImageFormatRun> planImageFormats(Mlt::Producer &producer,
+                                                  const QString &format);
+    //! Returns whether the video filters of \a producer leave the frame in 8-bit.
+    static bool isEightBitOutput(Mlt::Producer &producer);
+    //! Returns the image formats \a filter processes without converting; empty for any.
+    static QStringList imageFormats(Mlt::Service &filter, const QmlMetadata *meta);
+    static bool isHighBitDepth(const QString &format);
+
+private:
+    static bool isIdentity(Mlt::Service &filter, const QmlMetadata *meta);
+};
+
+#endif // FILTERCHAINOPTIMIZER_H
@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frameprefetcher.h"
+
+#include "Logger.h"
+
+#include <Mlt.h>
+
+FramePrefetcher::FramePrefetcher(QObject *parent)
+    : QThread(parent)
+    , m_format(mlt_image_yuv420p)
+    , m_width(0)
+    , m_height(0)
+    , m_generation(-1)
+    , m_position(0)
+    , m_behind(0)
+    , m_ahead(0)
+    , m_isRequested(false)
+    , m_isStopping(false)
+{
+    setObjectName("FramePrefetcher");
+}
+
+FramePrefetcher::~FramePrefetcher()
+{
+    stop();
+}
+
+void FramePrefetcher::setProducer(Mlt::Producer *producer,
+                                  int generation,
+                                  mlt_image_format format,
+                                  int width,
+                                  int height,
+                                  Mlt::Properties &consumerProperties)
+{
+    // The worker may still be rendering from the old clone, so it is released
+    // by whichever of the two lets go last.
+    std::shared_ptr<Mlt::Producer> old;
+    QMutexLocker locker(&m_mutex);
+    old = m_producer;
+    if (producer)
+        producer->set_speed(0);
+    m_producer.reset(producer);
+    m_generation = generation;
+    m_format = format;
+    m_width = width;
+    m_height = height;
+    m_consumerProperties = Mlt::Properties();
+    m_consumerProperties.inherit(consumerProperties);
+    m_isRequested = false;
+}
+
+int FramePrefetcher::generation()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_generation;
+}
+
+void FramePrefetcher::editProducer(const std::function<void(Mlt::Producer &)> &edit,
+                                   int from,
+                                   int to)
+{
+    QMutexLocker locker(&m_mutex);
+    if (!m_producer || m_generation != from)
+        return;
+    edit(*m_producer);
+    // The frames that are rendering belong to the previous generation.
+    m_generation = to;
+    m_isRequested = false;
+}
+
+void FramePrefetcher::request(int position, int behind, int ahead)
+{
+    QMutexLocker locker(&m_mutex);
+    m_position = position;
+    m_behind = qMax(0, behind);
+    m_ahead = qMax(0, ahead);
+    m_isRequested = m_producer && (m_behind + m_ahead) > 0;
+    if (m_isRequested) {
+        if (!isRunning())
+            start(QThread::LowPriority);
+        m_condition.wakeOne();
+    }
+}
+
+void FramePrefetcher::cancel()
+{
+    QMutexLocker locker(&m_mutex);
+    m_isRequested = false;
+}
+
+void FramePrefetcher::stop()
+{
+    m_mutex.lock();
+    m_isStopping = true;
+    m_isRequested = false;
+    m_condition.wakeOne();
+    m_mutex.unlock();
+    wait();
+    m_mutex.lock();
+    m_producer.reset();
+    m_isStopping = false;
+    m_mutex.unlock();
+}
+
+bool FramePrefetcher::isInterrupted()
+{
+    QMutexLocker locker(&m_mutex);
+    return m_isRequested || m_isStopping;
+}
+
+void FramePrefetcher::run()
+{
+    int doneGeneration = -1;
+    forever {
+        m_mutex.lock();
+        while (!m_isRequested && !m_isStopping)
+            m_condition.wait(&m_mutex);
+        if (m_isStopping) {
+            m_mutex.unlock();
+            break;
+        }
+        m_isRequested = false;
+        auto producer = m_producer;
+        Mlt::Properties consumerProperties;
+        consumerProperties.inherit(m_consumerProperties);
+        const auto format = m_format;
+        const int width = m_width;
+        const int height = m_height;
+        const int generation = m_generation;
+        const int first = qMax(0, m_position - m_behind);
+        const int last = m_position + m_ahead;
+        const int position = m_position;
+        m_mutex.unlock();
+
+        if (!producer || !producer->is_valid())
+            continue;
+        if (generation != doneGeneration) {
+            m_done.clear();
+            doneGeneration = generation;
+        }
+        const int length = producer->get_length();
+        for (int i = first; i <= last && i < length; ++i) {
+            // The frame at the playhead is already in the cache.
+            if (i == position || m_done.contains(i))
+                continue;
+            if (isInterrupted())
+                break;
+            producer->seek(i);
+            std::unique_ptr<Mlt::Frame> frame(producer->get_frame());
+            if (!frame || !frame->is_valid())
+                continue;
+            frame->inherit(consumerProperties);
+            mlt_image_format imageFormat = format;
+            int w = width;
+            int h = height;
+            if (!frame->get_image(imageFormat, w, h))
+                continue;
+            SharedFrame shared(*frame);
+            // Keep the converted image with the frame like a displayed one.
+            shared.get_image(format);
+            m_done << i;
+            emit framePrefetched(shared, i, generation);
+        }
+    }
+}
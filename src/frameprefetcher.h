@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEPREFETCHER_H
+#define FRAMEPREFETCHER_H
+
+#include "sharedframe.h"
+
+#include <MltProperties.h>
+#include <QMutex>
+#include <QSet>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <functional>
+#include <memory>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class FramePrefetcher
+  \brief Renders the frames around the playhead ahead of time.
+
+  \threadsafe
+
+  The consumer only prefills frames ahead of forward playback, so stepping
+  backwards and playing in reverse seek and render every frame. The prefetcher
+  renders a window of frames behind and ahead of the playhead on its own clone
+  of the producer and emits them for the video widget to keep in its frame
+  cache. The window is rendered in ascending order, which decodes long-GOP
+  media once for the whole window instead of once per frame.
+
+  A new request replaces the one in progress. The frames of a clone keep the
+  generation it was given, so frames rendered from an older clone can be
+  ignored.
+*/
+
+class FramePrefetcher : public QThread
+{
+    Q_OBJECT
+public:
+    explicit FramePrefetcher(QObject *parent = nullptr);
+    ~FramePrefetcher();
+
+    /*!
+      Replaces the producer to render with \a producer and takes ownership of
+      it. The images are rendered in \a format and \a width by \a height with
+      \a consumerProperties set on every frame.
+    */
+    void setProducer(Mlt::Producer *producer,
+                     int generation,
+                     mlt_image_format format,
+                     int width,
+                     int height,
+                     Mlt::Properties &consumerProperties);
+    int generation();
+    /*!
+      Calls \a edit with the producer to render and moves it from generation
+      \a from to \a to instead of cloning it again, if it is still current.
+    */
+    void editProducer(const std::function<void(Mlt::Producer &)> &edit, int from, int to);
+    /// Renders the frames from \a position - \a behind to \a position + \a ahead.
+    void request(int position, int behind, int ahead);
+    void cancel();
+    void stop();
+
+signals:
+    void framePrefetched(const SharedFrame &frame, int position, int generation);
+
+protected:
+    void run() override;
+
+private:
+    bool isInterrupted();
+
+    QMutex m_mutex;
+    QWaitCondition m_condition;
+    std::shared_ptr<Mlt::Producer> m_producer;
+    Mlt::Properties m_consumerProperties;
+    mlt_image_format m_format;
+    int m_width;
+    int m_height;
+    int m_generation;
+    int m_position;
+    int m_behind;
+    int m_ahead;
+    bool m_isRequested;
+    bool m_isStopping;
+    // Positions rendered from the current producer; only the worker uses it.
+    QSet<int> m_done;
+};
+
+#endif // FRAMEPREFETCHER_H
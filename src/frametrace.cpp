@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frametrace.h"
+
+#include "Logger.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QThread>
+
+static const int kEventCount = 1 << 16;
+
+namespace {
+
+struct Event
+{
+    // The index of the event plus one once it is written, or 0 while it is.
+    std::atomic<quint64> sequence{0};
+    std::atomic<const char *> name{nullptr};
+    std::atomic<qint64> start{0};
+    std::atomic<qint64> duration{0}; // Negative for an instant event
+    std::atomic<int> position{-1};
+    std::atomic<int> thread{0};
+};
+
+} // namespace
+
+std::atomic<bool> FrameTrace::s_isEnabled{false};
+// Allocated the first time tracing is enabled and never freed, so that a
+// thread still recording never writes to freed memory.
+static std::atomic<Event *> s_events{nullptr};
+static std::atomic<quint64> s_nextEvent{0};
+static std::atomic<int> s_threadCount{0};
+static QElapsedTimer s_timer;
+// Only touched once per thread.
+static QMutex s_threadMutex;
+static QHash<int, QString> s_threadNames;
+static thread_local int t_thread = 0;
+
+static int currentThread()
+{
+    if (!t_thread) {
+        t_thread = s_threadCount.fetch_add(1, std::memory_order_relaxed) + 1;
+        QString name = QThread::currentThread()->objectName();
+        if (QCoreApplication::instance()
+            && QThread::currentThread() == QCoreApplication::instance()->thread())
+            name = QStringLiteral("Main");
+        else if (name.isEmpty())
+            name = QStringLiteral("Thread %1").arg(t_thread);
+        QMutexLocker locker(&s_threadMutex);
+        s_threadNames.insert(t_thread, name);
+    }
+    return t_thread;
+}
+
+FrameTrace::Scope::Scope(const char *name, int position)
+    : m_name(name)
+    , m_position(position)
+    , m_start(FrameTrace::isEnabled() ? FrameTrace::now() : -1)
+{}
+
+FrameTrace::Scope::~Scope()
+{
+    if (m_start >= 0)
+        FrameTrace::complete(m_name, m_start, m_position);
+}
+
+void FrameTrace::setEnabled(bool enabled)
+{
+    if (enabled && !s_events.load(std::memory_order_acquire)) {
+        s_timer.start();
+        s_events.store(new Event[kEventCount], std::memory_order_release);
+    }
+    s_isEnabled.store(enabled, std::memory_order_release);
+    LOG_INFO() << "frame trace" << (enabled ? "enabled" : "disabled");
+}
+
+void FrameTrace::instant(const char *name, int position)
+{
+    if (isEnabled())
+        record(name, now(), -1, position);
+}
+
+void FrameTrace::complete(const char *name, qint64 start, int position)
+{
+    if (isEnabled())
+        record(name, start, now() - start, position);
+}
+
+qint64 FrameTrace::now()
+{
+    return s_timer.isValid() ? s_timer.nsecsElapsed() / 1000 : 0;
+}
+
+void FrameTrace::clear()
+{
+    auto events = s_events.load(std::memory_order_acquire);
+    if (!events)
+        return;
+    for (int i = 0; i < kEventCount; ++i)
+        events[i].sequence.store(0, std::memory_order_release);
+}
+
+void FrameTrace::record(const char *name, qint64 start, qint64 duration, int position)
+{
+    auto events = s_events.load(std::memory_order_acquire);
+    if (!events)
+        return;
+    const quint64 index = s_nextEvent.fetch_add(1, std::memory_order_relaxed);
+    Event &event = events[index % kEventCount];
+    event.sequence.store(0, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    event.name.store(name, std::memory_order_relaxed);
+    event.start.store(start, std::memory_order_relaxed);
+    event.duration.store(duration, std::memory_order_relaxed);
+    event.position.store(position, std::memory_order_relaxed);
+    event.thread.store(currentThread(), std::memory_order_relaxed);
+    event.sequence.store(index + 1, std::memory_order_release);
+}
+
+bool FrameTrace::save(const QString &fileName)
+{
+    QJsonArray traceEvents;
+    {
+        QMutexLocker locker(&s_threadMutex);
+        for (auto it = s_threadNames.constBegin(); it != s_threadNames.constEnd(); ++it) {
+            traceEvents.append(QJsonObject{{"name", "thread_name"},
+                                           {"ph", "M"},
+                                           {"pid", 1},
+                                           {"tid", it.key()},
+                                           {"args", QJsonObject{{"name", it.value()}}}});
+        }
+    }
+    auto events = s_events.load(std::memory_order_acquire);
+    const quint64 next = s_nextEvent.load(std::memory_order_acquire);
+    const quint64 first = next > quint64(kEventCount) ? next - kEventCount : 0;
+    for (quint64 index = first; events && index < next; ++index) {
+        const Event &event = events[index % kEventCount];
+        // Skip a slot that is being written or was overwritten while reading.
+        const quint64 sequence = event.sequence.load(std::memory_order_acquire);
+        const char *name = event.name.load(std::memory_order_relaxed);
+        const qint64 start = event.start.load(std::memory_order_relaxed);
+        const qint64 duration = event.duration.load(std::memory_order_relaxed);
+        const int position = event.position.load(std::memory_order_relaxed);
+        const int thread = event.thread.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (sequence != index + 1 || event.sequence.load(std::memory_order_relaxed) != sequence
+            || !name)
+            continue;
+        QJsonObject object{{"name", QString::fromLatin1(name)},
+                           {"cat", "player"},
+                           {"pid", 1},
+                           {"tid", thread},
+                           {"ts", start}};
+        if (duration < 0) {
+            object.insert("ph", "i");
+            object.insert("s", "t");
+        } else {
+            object.insert("ph", "X");
+            object.insert("dur", duration);
+        }
+        if (position >= 0)
+            object.insert("args", QJsonObject{{"position", position}});
+        traceEvents.append(object);
+    }
+
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        LOG_WARNING() << "failed to write" << fileName;
+        return false;
+    }
+    QJsonObject root{{"traceEvents", traceEvents}, {"displayTimeUnit", "ms"}};
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    LOG_INFO() << "saved" << traceEvents.size() << "trace events to" << fileName;
+    return true;
+}
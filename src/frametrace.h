@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMETRACE_H
+#define FRAMETRACE_H
+
+#include <QString>
+#include <QtGlobal>
+
+#include <atomic>
+
+/*!
+  \class FrameTrace
+  \brief Records the timing of frames through the player pipeline.
+
+  \threadsafe
+
+  While enabled, the instrumented steps of the player write an event into a
+  fixed ring of slots, which any thread can do without taking a lock. When the
+  ring is full, the oldest events are overwritten. save() writes the events in
+  the Chrome trace event format, which chrome://tracing and Perfetto open.
+
+  Event names must be string literals, since only the pointer is kept. When
+  disabled, an instrumentation point costs one relaxed atomic load.
+*/
+
+class FrameTrace
+{
+public:
+    //! Records the duration of the enclosing scope as an event.
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name, int position = -1);
+        ~Scope();
+
+    private:
+        const char *m_name;
+        int m_position;
+        qint64 m_start;
+    };
+
+    static bool isEnabled() { return s_isEnabled.load(std::memory_order_relaxed); }
+    static void setEnabled(bool enabled);
+    //! Records an event without a duration.
+    static void instant(const char *name, int position = -1);
+    //! Records an event that began at \a start microseconds and ends now.
+    static void complete(const char *name, qint64 start, int position = -1);
+    //! Returns the microseconds since tracing was first enabled.
+    static qint64 now();
+    static void clear();
+    //! Writes the recorded events as Chrome trace JSON to \a fileName.
+    static bool save(const QString &fileName);
+
+private:
+    static void record(const char *name, qint64 start, qint64 duration, int position);
+
+    static std::atomic<bool> s_isEnabled;
+};
+
+#endif // FRAMETRACE_H
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "glthumbnailrenderer.h"
+
+#include "Logger.h"
+#include "mltcontroller.h"
+#include "settings.h"
+
+#include <Mlt.h>
+#include <QCoreApplication>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QThread>
+
+#include <memory>
+
+static const int kMaxWorkers = 2;
+
+class GlThumbnailRenderer::Worker : public QThread
+{
+public:
+    Worker()
+        : QThread(nullptr)
+        , m_context(new QOpenGLContext)
+        , m_surface(new QOffscreenSurface)
+    {
+        // Like RenderThread, the surface must be created on the GUI thread.
+        QSurfaceFormat format;
+        format.setProfile(QSurfaceFormat::CoreProfile);
+        format.setMajorVersion(3);
+        format.setMinorVersion(2);
+        format.setDepthBufferSize(0);
+        format.setStencilBufferSize(0);
+        m_context->setFormat(format);
+        m_context->create();
+        m_context->moveToThread(this);
+        m_surface->setFormat(format);
+        m_surface->create();
+        m_receiver.moveToThread(this);
+        setObjectName("GlThumbnailRenderer");
+        start(QThread::LowPriority);
+    }
+
+    ~Worker()
+    {
+        quit();
+        wait();
+        m_surface->destroy();
+    }
+
+    bool isValid() const { return m_context->isValid() && m_surface->isValid(); }
+
+    /// Runs \a task on this thread with the context current and waits for it.
+    void execute(std::function<void()> task)
+    {
+        QMetaObject::invokeMethod(&m_receiver, task, Qt::BlockingQueuedConnection);
+    }
+
+protected:
+    void run() override
+    {
+        if (!m_context->makeCurrent(m_surface.get())) {
+            LOG_WARNING() << "failed to make the thumbnail context current";
+            return;
+        }
+        exec();
+        m_context->doneCurrent();
+    }
+
+private:
+    std::unique_ptr<QOpenGLContext> m_context;
+    std::unique_ptr<QOffscreenSurface> m_surface;
+    QObject m_receiver;
+};
+
+GlThumbnailRenderer &GlThumbnailRenderer::singleton()
+{
+    static GlThumbnailRenderer instance;
+    return instance;
+}
+
+bool GlThumbnailRenderer::isRequired(const QString &service)
+{
+    return Settings.playerGPU() && (service.startsWith("xml") || service == "consumer");
+}
+
+QList<QImage> GlThumbnailRenderer::images(Mlt::Profile &profile,
+                                          const QString &service,
+                                          const QString &resource,
+                                          const QList<int> &frameNumbers,
+                                          int width,
+                                          int height,
+                                          bool isFastSeek,
+                                          Validator validator)
+{
+    QList<QImage> result;
+    for (int i = 0; i < frameNumbers.size(); ++i)
+        result << QImage();
+    // The player removes the manager when the GPU does not support Movit.
+    if (frameNumbers.isEmpty()
+        || !mlt_properties_get_data(mlt_global_properties(), "glslManager", nullptr))
+        return result;
+
+    auto worker = acquire();
+    if (!worker)
+        return result;
+    const auto name = service.startsWith("xml") ? QString("xml") : service;
+    worker->execute([&]() {
+        LOG_DEBUG() << name << resource;
+        // The producer and its textures are closed on the thread of the context.
+        Mlt::Producer producer(profile, name.toUtf8().constData(), resource.toUtf8().constData());
+        if (!producer.is_valid() || (validator && !validator(producer)))
+            return;
+        for (int i = 0; i < frameNumbers.size(); ++i)
+            result[i] = MLT.image(producer, frameNumbers[i], width, height, isFastSeek);
+    });
+    release(worker);
+    return result;
+}
+
+GlThumbnailRenderer::Worker *GlThumbnailRenderer::acquire()
+{
+    QMutexLocker locker(&m_mutex);
+    while (m_idle.isEmpty() && m_workerCount >= kMaxWorkers)
+        m_released.wait(&m_mutex);
+    if (!m_idle.isEmpty())
+        return m_idle.takeLast();
+    ++m_workerCount;
+    locker.unlock();
+
+    Worker *worker = nullptr;
+    auto app = QCoreApplication::instance();
+    if (app) {
+        QMetaObject::invokeMethod(
+            app,
+            [&]() { worker = new Worker; },
+            QThread::currentThread() == app->thread() ? Qt::DirectConnection
+                                                      : Qt::BlockingQueuedConnection);
+    }
+    if (worker && !worker->isValid()) {
+        LOG_WARNING() << "failed to create an OpenGL context for thumbnails";
+        delete worker;
+        worker = nullptr;
+    }
+    if (!worker) {
+        locker.relock();
+        --m_workerCount;
+        m_released.wakeOne();
+    }
+    return worker;
+}
+
+void GlThumbnailRenderer::release(Worker *worker)
+{
+    QMutexLocker locker(&m_mutex);
+    m_idle << worker;
+    m_released.wakeOne();
+}
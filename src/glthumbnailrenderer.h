@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GLTHUMBNAILRENDERER_H
+#define GLTHUMBNAILRENDERER_H
+
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace Mlt {
+class Producer;
+class Profile;
+} // namespace Mlt
+
+/*!
+  \class GlThumbnailRenderer
+  \brief Renders the thumbnails of producers that need the GPU.
+
+  \threadsafe
+
+  In GPU mode a nested project or consumer producer has Movit filters that
+  only render with a current OpenGL context, so the thumbnail decoders, which
+  run on plain worker threads without a context, cannot open them. Each worker
+  here is a thread that owns an offscreen context, as the player's render
+  thread does. The callers wait for a free worker, which opens the producer,
+  renders the frames at the thumbnail size and closes it again. The number of
+  workers is bounded and they are kept and reused for later requests.
+*/
+
+class GlThumbnailRenderer
+{
+public:
+    typedef std::function<bool(Mlt::Producer &)> Validator;
+
+    static GlThumbnailRenderer &singleton();
+
+    /// Returns whether the thumbnails of \a service must be rendered here.
+    static bool isRequired(const QString &service);
+
+    /// Renders \a frameNumbers in order. The images are null on failure.
+    QList<QImage> images(Mlt::Profile &profile,
+                         const QString &service,
+                         const QString &resource,
+                         const QList<int> &frameNumbers,
+                         int width,
+                         int height,
+                         bool isFastSeek,
+                         Validator validator = nullptr);
+
+private:
+    class Worker;
+
+    GlThumbnailRenderer() = default;
+    Worker *acquire();
+    void release(Worker *worker);
+
+    QMutex m_mutex;
+    QWaitCondition m_released;
+    QList<Worker *> m_idle;
+    int m_workerCount{0};
+};
+
+#endif // GLTHUMBNAILRENDERER_H
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "headlessexport.h"
+
+#include "Logger.h"
+#include "docks/encodedock.h"
+#include "jobqueue.h"
+#include "mainwindow.h"
+#include "mltcontroller.h"
+
+#include <QEventLoop>
+#include <QFileInfo>
+
+#include <cstdio>
+
+int HeadlessExport::run(const QString &project,
+                        const QString &preset,
+                        const QString &target,
+                        int segments)
+{
+    if (preset.isEmpty() || target.isEmpty() || segments < 0) {
+        LOG_ERROR() << "export needs a preset, a target and a positive number of segments";
+        return InvalidArguments;
+    }
+    if (!MAIN.open(project, nullptr, false, true) || !MAIN.multitrack()) {
+        LOG_ERROR() << "export failed to open" << project;
+        return OpenFailed;
+    }
+    auto encodeDock = MAIN.encodeDock();
+    if (!encodeDock->selectPreset(preset)) {
+        LOG_ERROR() << "export preset not found:" << preset;
+        return PresetNotFound;
+    }
+
+    // Only wait for the jobs of the export, not for proxies or other work from opening.
+    const int firstJob = JOBS.jobs().size();
+    if (!encodeDock->exportTimeline(QFileInfo(target).absoluteFilePath(), segments)) {
+        LOG_ERROR() << "export failed to make the jobs for" << target;
+        return ExportFailed;
+    }
+    const auto jobs = JOBS.jobs().mid(firstJob);
+    if (jobs.isEmpty())
+        return ExportFailed;
+
+    QEventLoop loop;
+    int remaining = jobs.size();
+    bool isSuccess = true;
+    for (auto job : jobs) {
+        QObject::connect(job,
+                         &AbstractJob::progressUpdated,
+                         &loop,
+                         [=](QStandardItem *, int percent) {
+                             std::fprintf(stdout,
+                                          "%d\t%s\n",
+                                          percent,
+                                          job->label().toUtf8().constData());
+                             std::fflush(stdout);
+                         });
+        QObject::connect(job, &AbstractJob::finished, &loop, [&, job](AbstractJob *, bool success) {
+            std::fprintf(stdout, "%d\t%s\n", success ? 100 : -1, job->label().toUtf8().constData());
+            std::fflush(stdout);
+            if (!success) {
+                // The jobs that depend on it would never start.
+                isSuccess = false;
+                for (auto other : jobs) {
+                    if (other != job && !other->isFinished())
+                        other->stop();
+                }
+                loop.quit();
+            } else if (--remaining == 0) {
+                loop.quit();
+            }
+        });
+    }
+    loop.exec();
+    if (!isSuccess) {
+        LOG_ERROR() << "export failed:" << target;
+        return ExportFailed;
+    }
+    LOG_INFO() << "exported" << target;
+    return Success;
+}
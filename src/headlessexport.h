@@ -0,0 +1,53 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef HEADLESSEXPORT_H
+#define HEADLESSEXPORT_H
+
+#include <QString>
+
+/*!
+  \class HeadlessExport
+  \brief Exports a project from the command line.
+
+  Run with --export, --preset and --out, it opens the project, loads the
+  export preset into the export panel and queues the same jobs as the Export
+  button would, including dual pass, hardware encoders and segments. The main
+  window is created but never shown, so it runs on a server with
+  QT_QPA_PLATFORM=offscreen. The progress of each job is printed to the
+  standard output as a percent and the job label, separated by a tab.
+*/
+
+class HeadlessExport
+{
+public:
+    enum ExitCode {
+        Success = 0,
+        InvalidArguments = 2,
+        OpenFailed,
+        PresetNotFound,
+        ExportFailed,
+    };
+
+    //! Exports \a project with the preset \a preset to \a target and returns the exit code.
+    static int run(const QString &project,
+                   const QString &preset,
+                   const QString &target,
+                   int segments);
+};
+
+#endif // HEADLESSEXPORT_H
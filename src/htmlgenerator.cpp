@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,13 +19,14 @@
 #include "Logger.h"
 #include "settings.h"
 
-#include <QDir>
 #include <QFile>
 #include <QJsonArray>
 #include <QJsonDocument>
 #include <QNetworkReply>
 #include <QUrl>
 
+static const int kCaptureLogIntervalMs = 1000;
+
 HtmlGenerator::HtmlGenerator(QObject *parent)
     : QObject(parent)
     , m_webSocket(new QWebSocket(QString(), QWebSocketProtocol::VersionLatest, this))
@@ -36,10 +37,12 @@ HtmlGenerator::HtmlGenerator(QObject *parent)
     connect(m_webSocket, &QWebSocket::connected, this, &HtmlGenerator::onWebSocketConnected);
     connect(m_webSocket, &QWebSocket::textMessageReceived, this, &HtmlGenerator::onMessageReceived);
     connect(m_webSocket, &QWebSocket::disconnected, this, &HtmlGenerator::onWebSocketDisconnected);
+    m_decodePool.setMaxThreadCount(1);
 }
 
 HtmlGenerator::~HtmlGenerator()
 {
+    m_decodePool.waitForDone();
     if (m_chromeProcess && m_chromeProcess->state() == QProcess::Running) {
         m_chromeProcess->terminate();
         m_chromeProcess->waitForFinished(2000);
@@ -54,6 +57,17 @@ void HtmlGenerator::setAnimationParameters(double fps, int duration)
     m_animationMode = (fps > 0 && duration > 0);
 }
 
+void HtmlGenerator::setFrameRange(int first, int count)
+{
+    m_firstFrame = qMax(0, first);
+    m_frameLimit = count;
+}
+
+int HtmlGenerator::frameCount(double fps, int duration)
+{
+    return fps > 0 ? static_cast<int>(std::ceil(duration * fps / 1000.0)) : 0;
+}
+
 void HtmlGenerator::launchBrowser(const QString &executablePath,
                                   const QString &url,
                                   const QSize &viewport,
@@ -65,7 +79,7 @@ void HtmlGenerator::launchBrowser(const QString &executablePath,
 
     // Start browser with appropriate arguments
     QStringList arguments;
-    arguments << "--remote-debugging-port=9222"
+    arguments << QString("--remote-debugging-port=%1").arg(m_port)
               << "--headless=new"
               << "--disable-gpu"
               << "--no-sandbox"
@@ -102,7 +116,7 @@ void HtmlGenerator::launchBrowser(const QString &executablePath,
 void HtmlGenerator::connectToBrowser()
 {
     // Get the list of pages from Chrome
-    QNetworkRequest request(QUrl("http://localhost:9222/json/list"));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/json/list").arg(m_port)));
     QNetworkReply *reply = m_networkManager->get(request);
 
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
@@ -139,7 +153,7 @@ void HtmlGenerator::connectToBrowser()
 
 void HtmlGenerator::createNewPage()
 {
-    QNetworkRequest request(QUrl("http://localhost:9222/json/new"));
+    QNetworkRequest request(QUrl(QString("http://localhost:%1/json/new").arg(m_port)));
     auto *reply = m_networkManager->get(request);
 
     connect(reply, &QNetworkReply::finished, this, [this, reply]() {
@@ -203,7 +217,10 @@ void HtmlGenerator::onMessageReceived(const QString &message)
 
     if (obj.contains("method")) {
         const auto method = obj["method"].toString();
-        if (method == "Page.loadEventFired") {
+        if (method == "Emulation.virtualTimeBudgetExpired") {
+            if (m_animationMode && !m_pendingScreenshot && m_currentFrame < m_endFrame)
+                requestAnimationScreenshot();
+        } else if (method == "Page.loadEventFired") {
             LOG_DEBUG() << "Page loaded, starting capture";
             if (m_animationMode) {
                 startAnimationCapture();
@@ -221,6 +238,14 @@ void HtmlGenerator::onMessageReceived(const QString &message)
             }
         }
     } else if (obj.contains("error")) {
+        if (m_isVirtualTime && obj["id"].toInt() == m_virtualTimeMessageId) {
+            // Capture in real time with a browser that does not support virtual time.
+            LOG_WARNING() << "virtual time is not supported; capturing in real time";
+            m_isVirtualTime = false;
+            if (m_animationElapsed.isValid() && !m_pendingScreenshot)
+                captureAnimationFrame();
+            return;
+        }
         LOG_ERROR() << "Error received:" << QJsonDocument(obj["error"].toObject()).toJson();
     }
 }
@@ -250,25 +275,28 @@ void HtmlGenerator::onChromeProcessError(QProcess::ProcessError error)
 
 void HtmlGenerator::startAnimationCapture()
 {
-    // Create output directory
-    const QDir outputDir(m_outputPath);
-    if (!outputDir.exists()) {
-        if (!outputDir.mkpath(".")) {
-            LOG_ERROR() << "Failed to create output directory:" << m_outputPath;
-            return;
-        }
-    }
+    if (m_animationElapsed.isValid())
+        return;
 
     // Calculate animation parameters
-    const auto frameInterval = 1000.0 / m_fps; // milliseconds per frame
-    m_totalFrames = static_cast<int>(std::ceil(m_duration / frameInterval));
-    m_currentFrame = 0;
-
-    LOG_DEBUG() << QString("Capturing %1 frames at %2 fps over %3ms...")
+    m_totalFrames = frameCount(m_fps, m_duration);
+    m_currentFrame = qBound(0, m_firstFrame, m_totalFrames);
+    m_endFrame = m_frameLimit < 0 ? m_totalFrames
+                                  : qMin(m_totalFrames, m_currentFrame + m_frameLimit);
+
+    LOG_DEBUG() << QString("Capturing frames %1 to %2 of %3 at %4 fps over %5ms...")
+                       .arg(m_currentFrame)
+                       .arg(m_endFrame - 1)
                        .arg(m_totalFrames)
                        .arg(m_fps)
                        .arg(m_duration);
 
+    // Stop the clock of the page so that it only advances one frame at a time,
+    // which is much faster than waiting in real time.
+    QJsonObject params;
+    params["policy"] = "pause";
+    m_virtualTimeMessageId = sendCommand("Emulation.setVirtualTimePolicy", params);
+
     // Start timing
     m_animationElapsed.start();
 
@@ -278,11 +306,45 @@ void HtmlGenerator::startAnimationCapture()
 
 void HtmlGenerator::captureAnimationFrame()
 {
-    if (m_currentFrame >= m_totalFrames) {
+    if (m_currentFrame >= m_endFrame) {
         completeAnimationCapture();
         return;
     }
 
+    const auto frameInterval = 1000.0 / m_fps;
+    if (m_isVirtualTime) {
+        if (m_currentFrame > 0) {
+            // The first frame of a range that does not start the animation
+            // skips ahead to it. The screenshot is requested when the budget
+            // expires.
+            const int frames = m_currentFrame == m_firstFrame ? m_firstFrame : 1;
+            QJsonObject params;
+            params["policy"] = "advance";
+            params["budget"] = frames * frameInterval;
+            m_virtualTimeMessageId = sendCommand("Emulation.setVirtualTimePolicy", params);
+        } else {
+            requestAnimationScreenshot();
+        }
+        return;
+    }
+
+    // Calculate when the next frame should be captured
+    const auto targetTime = static_cast<qint64>(m_currentFrame * frameInterval);
+    const auto currentTime = m_animationElapsed.elapsed();
+
+    int delay = std::max(0LL, targetTime - currentTime);
+    if (delay == 0) {
+        if (m_currentFrame > m_firstFrame)
+            LOG_DEBUG() << "frame duration" << frameInterval << "delay"
+                        << targetTime - currentTime << "ms";
+        requestAnimationScreenshot();
+    } else {
+        QTimer::singleShot(delay, this, &HtmlGenerator::requestAnimationScreenshot);
+    }
+}
+
+void HtmlGenerator::requestAnimationScreenshot()
+{
     // LOG_DEBUG() << "Taking screenshot...";
     m_pendingScreenshot = true;
 
@@ -297,48 +359,32 @@ void HtmlGenerator::handleAnimationFrame(const QJsonObject &result)
 {
     m_pendingScreenshot = false;
 
+    // The encoder decodes the PNG; only the base64 is decoded here, in order.
     const auto base64Data = result["data"].toString();
-    const auto imageData = QByteArray::fromBase64(base64Data.toUtf8());
-
-    // Save frame with zero-padded filename
-    const auto frameNumber = QString("%1").arg(m_currentFrame, 4, 10, QLatin1Char('0'));
-    const auto filename = QDir(m_outputPath).filePath(QString("frame_%1.png").arg(frameNumber));
-
-    QFile file(filename);
-    if (file.open(QIODevice::WriteOnly)) {
-        file.write(imageData);
-        file.close();
-        LOG_DEBUG() << "Captured frame" << (m_currentFrame + 1) << "/" << m_totalFrames;
-        emit progressUpdate(float(m_currentFrame + 1) / m_totalFrames);
-    } else {
-        LOG_ERROR() << "Failed to save frame:" << file.errorString();
-        return;
-    }
+    m_decodePool.start([this, base64Data]() {
+        const auto imageData = QByteArray::fromBase64(base64Data.toLatin1());
+        QMetaObject::invokeMethod(
+            this, [this, imageData]() { emit frameReady(imageData); }, Qt::QueuedConnection);
+    });
+    LOG_DEBUG_THROTTLED(kCaptureLogIntervalMs)
+        << "Captured frame" << (m_currentFrame + 1) << "/" << m_totalFrames;
+    emit progressUpdate(float(m_currentFrame + 1 - m_firstFrame)
+                        / qMax(1, m_endFrame - m_firstFrame));
 
     m_currentFrame++;
 
     // Schedule next frame
-    if (m_currentFrame < m_totalFrames) {
-        // Calculate when the next frame should be captured
-        const auto frameInterval = 1000.0 / m_fps;
-        const auto targetTime = static_cast<qint64>(m_currentFrame * frameInterval);
-        const auto currentTime = m_animationElapsed.elapsed();
-
-        int delay = std::max(0LL, targetTime - currentTime);
-        if (delay == 0)
-            LOG_DEBUG() << "frame duration" << frameInterval << "delay" << targetTime - currentTime
-                        << "ms";
-        QTimer::singleShot(delay, this, &HtmlGenerator::captureAnimationFrame);
-    } else {
-        completeAnimationCapture();
-    }
+    captureAnimationFrame();
 }
 
 void HtmlGenerator::completeAnimationCapture()
 {
+    if (m_screenshotCompleted)
+        return;
     m_screenshotCompleted = true;
 
-    LOG_DEBUG() << QString("Animation frames saved to %1/").arg(m_outputPath);
+    LOG_DEBUG() << "Captured" << m_endFrame - m_firstFrame << "animation frames in"
+                << m_animationElapsed.elapsed() << "ms";
 
     // Close the browser and exit
     m_webSocket->close();
@@ -346,12 +392,20 @@ void HtmlGenerator::completeAnimationCapture()
         m_chromeProcess->terminate();
     }
 
-    // Emit signal indicating animation frames are ready
-    emit imageReady(m_outputPath);
+    // Emit signal indicating animation frames are ready after the last one
+    m_decodePool.start([this]() {
+        QMetaObject::invokeMethod(
+            this, [this]() { emit imageReady(m_outputPath); }, Qt::QueuedConnection);
+    });
 }
 
 void HtmlGenerator::takeScreenshot()
 {
+    if (m_animationMode) {
+        // The page load event did not fire.
+        startAnimationCapture();
+        return;
+    }
     if (m_pendingScreenshot) {
         LOG_DEBUG() << "Screenshot already pending, skipping";
         return;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,6 +25,7 @@
 #include <QProcess>
 #include <QSize>
 #include <QTemporaryDir>
+#include <QThreadPool>
 #include <QTimer>
 #include <QWebSocket>
 
@@ -36,6 +37,11 @@ public:
     ~HtmlGenerator();
 
     void setAnimationParameters(double fps, int duration);
+    //! Captures only \a count frames of the animation starting at \a first.
+    void setFrameRange(int first, int count);
+    //! Sets the remote debugging port, which must differ for each browser at once.
+    void setDebuggingPort(int port) { m_port = port; }
+    static int frameCount(double fps, int duration);
     void launchBrowser(const QString &executablePath,
                        const QString &url,
                        const QSize &viewport,
@@ -44,6 +50,8 @@ public:
 signals:
     void progressUpdate(float);
     void imageReady(QString outputPath);
+    //! Emitted in order with each PNG image of an animation.
+    void frameReady(const QByteArray &png);
 
 private slots:
     void connectToBrowser();
@@ -55,6 +63,7 @@ private slots:
     void onChromeProcessError(QProcess::ProcessError error);
     void startAnimationCapture();
     void captureAnimationFrame();
+    void requestAnimationScreenshot();
     void handleAnimationFrame(const QJsonObject &result);
     void completeAnimationCapture();
     void takeScreenshot();
@@ -80,8 +89,17 @@ private:
     int m_duration = 0;
     int m_currentFrame = 0;
     int m_totalFrames = 0;
+    int m_firstFrame = 0;
+    int m_endFrame = 0;
+    int m_frameLimit = -1;
+    int m_port = 9222;
     QTimer *m_animationTimer = nullptr;
     QElapsedTimer m_animationElapsed;
+    // Whether the page clock only advances by one frame before each capture
+    bool m_isVirtualTime = true;
+    int m_virtualTimeMessageId = 0;
+    // Decodes the frames in order off the GUI thread
+    QThreadPool m_decodePool;
 };
 
 #endif // HTMLGENERATOR_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,16 +18,39 @@
 #include "jobqueue.h"
 
 #include "Logger.h"
+#include "settings.h"
+#include "util.h"
 
 #include <QtWidgets>
 #if defined(Q_OS_WIN) && (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 #include "windowstools.h"
 #endif
 
+static const int kIdleDelayMs = 2000;
+static const int kPowerCheckIntervalMs = 60000;
+static const int kProgressIntervalMs = 250;
+// How many successful jobs stay in the model before the oldest are archived
+static const int kLiveSucceededJobs = 50;
+
 JobQueue::JobQueue(QObject *parent)
     : QStandardItemModel(0, COLUMN_COUNT, parent)
     , m_paused(false)
-{}
+    , m_isPlaying(false)
+    , m_isThrottled(false)
+    , m_idleTimer(new QTimer(this))
+    , m_powerTimer(new QTimer(this))
+    , m_progressTimer(new QTimer(this))
+{
+    m_idleTimer->setSingleShot(true);
+    m_idleTimer->setInterval(kIdleDelayMs);
+    connect(m_idleTimer, &QTimer::timeout, this, &JobQueue::onIdle);
+    m_powerTimer->setInterval(kPowerCheckIntervalMs);
+    connect(m_powerTimer, &QTimer::timeout, this, &JobQueue::checkPower);
+    // Coalesce the progress of many jobs into one update of the model.
+    m_progressTimer->setSingleShot(true);
+    m_progressTimer->setInterval(kProgressIntervalMs);
+    connect(m_progressTimer, &QTimer::timeout, this, &JobQueue::flushProgress);
+}
 
 JobQueue &JobQueue::singleton(QObject *parent)
 {
@@ -41,12 +64,11 @@ void JobQueue::cleanup()
 {
     QMutexLocker locker(&m_mutex);
     foreach (AbstractJob *job, m_jobs) {
-        if (job->state() == QProcess::Running) {
+        if (job->state() == QProcess::Running)
             job->stop();
-            break;
-        }
     }
     qDeleteAll(m_jobs);
+    qDeleteAll(m_archived);
 }
 
 AbstractJob *JobQueue::add(AbstractJob *job)
@@ -71,10 +93,20 @@ AbstractJob *JobQueue::add(AbstractJob *job)
     connect(job,
             SIGNAL(finished(AbstractJob *, bool, QString)),
             SLOT(onFinished(AbstractJob *, bool, QString)));
+    connect(job, &QProcess::stateChanged, this, [=](QProcess::ProcessState state) {
+        onJobStateChanged(job, state);
+    });
     m_mutex.lock();
     m_jobs.append(job);
     m_mutex.unlock();
+    if (!job->target().isEmpty())
+        m_targets.insert(job->target(), job);
+    m_pending[job->resourceClass()].append(job);
     emit jobAdded();
+    if (!m_powerTimer->isActive()) {
+        checkPower();
+        m_powerTimer->start();
+    }
     startNextJob();
 
     return job;
@@ -83,8 +115,24 @@ AbstractJob *JobQueue::add(AbstractJob *job)
 void JobQueue::onProgressUpdated(QStandardItem *standardItem, int percent)
 {
     if (standardItem) {
-        AbstractJob *job = m_jobs.at(standardItem->row());
+        AbstractJob *job = m_jobs.value(standardItem->row());
         if (job) {
+            m_progress.insert(job, percent);
+            if (!m_progressTimer->isActive())
+                m_progressTimer->start();
+        }
+    }
+}
+
+void JobQueue::flushProgress()
+{
+    int lastPercent = 0;
+    for (auto it = m_progress.constBegin(); it != m_progress.constEnd(); ++it) {
+        AbstractJob *job = it.key();
+        const int percent = it.value();
+        QStandardItem *standardItem = job->standardItem();
+        lastPercent = percent;
+        if (standardItem) {
             QString remaining("--:--:--");
             QIcon icon(":/icons/oxygen/32x32/actions/run-build.png");
             if (job->paused()) {
@@ -93,7 +141,7 @@ void JobQueue::onProgressUpdated(QStandardItem *standardItem, int percent)
             } else if (percent > 0) {
                 auto time = job->estimateRemaining(percent);
                 if (QTime(0, 0).secsTo(time) == 0)
-                    return;
+                    continue;
                 if (percent > 2)
                     remaining = time.toString();
                 remaining = QStringLiteral("%1% (%2)").arg(percent).arg(remaining);
@@ -106,13 +154,17 @@ void JobQueue::onProgressUpdated(QStandardItem *standardItem, int percent)
                 standardItem->setIcon(icon);
         }
     }
+    m_progress.clear();
 #if defined(Q_OS_WIN) && (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-    WindowsTaskbarButton::getInstance().setProgress(percent);
+    WindowsTaskbarButton::getInstance().setProgress(lastPercent);
 #endif
 }
 
 void JobQueue::onFinished(AbstractJob *job, bool isSuccess, QString time)
 {
+    // A pending progress update must not overwrite the result.
+    m_progress.remove(job);
+    m_targets.remove(job->target(), job);
     QStandardItem *item = job->standardItem();
     if (item) {
         QIcon icon;
@@ -143,28 +195,151 @@ void JobQueue::onFinished(AbstractJob *job, bool isSuccess, QString time)
     WindowsTaskbarButton::getInstance().resetProgress();
 #endif
 
+    if (isSuccess && m_jobs.contains(job) && !m_succeeded.contains(job)) {
+        m_succeeded.append(job);
+        archiveFinished();
+    }
     startNextJob();
 }
 
+void JobQueue::onJobStateChanged(AbstractJob *job, QProcess::ProcessState state)
+{
+    if (state == QProcess::NotRunning) {
+        m_running.remove(job);
+    } else {
+        m_running.insert(job);
+        // A job that runs again, such as on retry, is in progress again.
+        m_succeeded.removeOne(job);
+        if (!job->target().isEmpty() && !m_targets.contains(job->target(), job))
+            m_targets.insert(job->target(), job);
+    }
+}
+
+void JobQueue::archiveFinished()
+{
+    while (m_succeeded.size() > kLiveSucceededJobs) {
+        auto job = m_succeeded.takeFirst();
+        QMutexLocker locker(&m_mutex);
+        const auto row = m_jobs.indexOf(job);
+        if (row < 0)
+            continue;
+        // Keep the job object for those that still refer to it.
+        m_jobs.removeAt(row);
+        locker.unlock();
+        removeRow(row);
+        job->setStandardItem(nullptr);
+        m_archived.append(job);
+        LOG_DEBUG() << "archived" << job->label();
+    }
+}
+
+void JobQueue::unindex(AbstractJob *job)
+{
+    m_targets.remove(job->target(), job);
+    m_pending[job->resourceClass()].removeOne(job);
+    m_running.remove(job);
+    m_succeeded.removeOne(job);
+    m_progress.remove(job);
+}
+
 void JobQueue::startNextJob()
 {
     if (m_paused)
         return;
-    QMutexLocker locker(&m_mutex);
-    if (!m_jobs.isEmpty()) {
-        foreach (AbstractJob *job, m_jobs) {
-            // if there is already a job started or running, then exit
-            if (job->ran() && job->state() != QProcess::NotRunning)
-                break;
-            // otherwise, start first non-started job and exit
-            if (!job->ran()) {
+    int running[AbstractJob::ResourceClassCount] = {};
+    for (auto job : std::as_const(m_running)) {
+        if (job->ran())
+            ++running[job->resourceClass()];
+    }
+    // Start pending jobs in order while their resource class has a free slot.
+    for (int resourceClass = 0; resourceClass < AbstractJob::ResourceClassCount; ++resourceClass) {
+        auto &pending = m_pending[resourceClass];
+        auto &count = running[resourceClass];
+        int classSlots = jobSlots(AbstractJob::ResourceClass(resourceClass));
+        for (auto it = pending.begin(); it != pending.end();) {
+            auto job = *it;
+            if (job->ran()) {
+                // Started from the Jobs dock
+                it = pending.erase(it);
+                continue;
+            }
+            int slots = job->concurrency() > 0 ? job->concurrency() : classSlots;
+            // Run fewer jobs at once on battery power or when the system is hot.
+            if (m_isThrottled && resourceClass != AbstractJob::RemoteRenderResource)
+                slots = qMax(1, slots / 2);
+            if (count < slots && job->isReady() && !(m_isPlaying && job->isBackground())) {
+                it = pending.erase(it);
                 job->start();
-                break;
+                ++count;
+            } else {
+                ++it;
             }
         }
     }
 }
 
+int JobQueue::jobSlots(AbstractJob::ResourceClass resourceClass)
+{
+    switch (resourceClass) {
+    case AbstractJob::GpuEncodeResource:
+        return Settings.jobGpuEncodeSlots();
+    case AbstractJob::DiskResource:
+        return Settings.jobDiskSlots();
+    case AbstractJob::NetworkResource:
+        return Settings.jobNetworkSlots();
+    case AbstractJob::RemoteRenderResource:
+        // Without nodes, a job of this class renders locally.
+        return qMax(1, int(Settings.jobRenderNodes().size()));
+    default:
+        return Settings.jobCpuEncodeSlots();
+    }
+}
+
+void JobQueue::setPlaying(bool isPlaying)
+{
+    if (isPlaying) {
+        m_idleTimer->stop();
+        if (m_isPlaying)
+            return;
+        m_isPlaying = true;
+        for (auto job : m_jobs) {
+            if (job->isBackground() && job->state() == QProcess::Running && !job->paused()) {
+                LOG_DEBUG() << "suspending" << job->label() << "during playback";
+                job->pause();
+                m_suspended << job;
+            }
+        }
+    } else if (m_isPlaying && !m_idleTimer->isActive()) {
+        m_idleTimer->start();
+    }
+}
+
+void JobQueue::onIdle()
+{
+    m_isPlaying = false;
+    for (auto &job : m_suspended) {
+        if (job && job->state() == QProcess::Running && job->paused())
+            job->resume();
+    }
+    m_suspended.clear();
+    startNextJob();
+}
+
+void JobQueue::checkPower()
+{
+    if (!hasIncomplete()) {
+        m_powerTimer->stop();
+        return;
+    }
+    const bool isThrottled = Util::isOnBatteryPower() || Util::isThermallyThrottled();
+    if (isThrottled != m_isThrottled) {
+        LOG_INFO() << (isThrottled ? "throttling" : "unthrottling") << "jobs";
+        m_isThrottled = isThrottled;
+        if (!isThrottled)
+            startNextJob();
+    }
+}
+
 AbstractJob *JobQueue::jobFromIndex(const QModelIndex &index) const
 {
     return m_jobs.at(index.row());
@@ -178,10 +353,8 @@ void JobQueue::pause()
 void JobQueue::pauseCurrent()
 {
     for (auto job : m_jobs) {
-        if (job->state() == QProcess::Running) {
+        if (job->state() == QProcess::Running)
             job->pause();
-            break;
-        }
     }
 }
 
@@ -194,10 +367,8 @@ void JobQueue::resume()
 void JobQueue::resumeCurrent()
 {
     for (auto job : m_jobs) {
-        if (job->state() == QProcess::Running) {
+        if (job->state() == QProcess::Running && job->paused())
             job->resume();
-            break;
-        }
     }
 }
 
@@ -223,6 +394,7 @@ void JobQueue::remove(const QModelIndex &index)
 
     AbstractJob *job = m_jobs.at(row);
     m_jobs.removeOne(job);
+    unindex(job);
     delete job;
 
     m_mutex.unlock();
@@ -236,20 +408,23 @@ void JobQueue::removeFinished()
         if (job->isFinished()) {
             removeRow(row);
             m_jobs.removeOne(job);
+            unindex(job);
             delete job;
         } else {
             ++row;
         }
     }
+    qDeleteAll(m_archived);
+    m_archived.clear();
 }
 
 bool JobQueue::targetIsInProgress(const QString &target)
 {
-    if (!m_jobs.isEmpty() && !target.isEmpty()) {
-        foreach (AbstractJob *job, m_jobs) {
-            if (!job->isFinished() && job->target() == target) {
+    if (!target.isEmpty()) {
+        for (auto it = m_targets.constFind(target); it != m_targets.constEnd() && it.key() == target;
+             ++it) {
+            if (!(*it)->isFinished())
                 return true;
-            }
         }
     }
     return false;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2024 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,9 +20,15 @@
 
 #include "jobs/abstractjob.h"
 
+#include <QHash>
+#include <QMultiHash>
 #include <QMutex>
+#include <QPointer>
+#include <QSet>
 #include <QStandardItemModel>
 
+class QTimer;
+
 class JobQueue : public QStandardItemModel
 {
     Q_OBJECT
@@ -47,6 +53,13 @@ public:
     void removeFinished();
     QList<AbstractJob *> jobs() const { return m_jobs; }
     bool targetIsInProgress(const QString &target);
+    //! Returns how many jobs of \a resourceClass may run at once.
+    static int jobSlots(AbstractJob::ResourceClass resourceClass);
+    /*!
+      Suspends the background jobs while \a isPlaying and resumes them once
+      the player has been idle for a moment.
+    */
+    void setPlaying(bool isPlaying);
 
 signals:
     void jobAdded();
@@ -56,9 +69,30 @@ public slots:
     void onFinished(AbstractJob *job, bool isSuccess, QString time);
 
 private:
+    void onIdle();
+    void checkPower();
+    void onJobStateChanged(AbstractJob *job, QProcess::ProcessState state);
+    void flushProgress();
+    void archiveFinished();
+    void unindex(AbstractJob *job);
+
     QList<AbstractJob *> m_jobs;
     QMutex m_mutex; // protects m_jobs
+    // The indexes below are only used on the main thread.
+    QMultiHash<QString, AbstractJob *> m_targets; ///< The unfinished jobs by target
+    QList<AbstractJob *> m_pending[AbstractJob::ResourceClassCount];
+    QSet<AbstractJob *> m_running;
+    QList<AbstractJob *> m_succeeded; ///< The successful jobs in the live model, oldest first
+    QList<AbstractJob *> m_archived;  ///< The successful jobs moved out of the live model
+    QHash<AbstractJob *, int> m_progress;
+    QTimer *m_progressTimer;
     bool m_paused;
+    bool m_isPlaying;
+    bool m_isThrottled;
+    QTimer *m_idleTimer;
+    QTimer *m_powerTimer;
+    // The background jobs that were paused when playback started
+    QList<QPointer<AbstractJob>> m_suspended;
 };
 
 #define JOBS JobQueue::singleton()
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,6 +19,7 @@
 
 #include "Logger.h"
 #include "postjobaction.h"
+#include "util.h"
 
 #include <QAction>
 #include <QApplication>
@@ -30,6 +31,10 @@
 #include <signal.h>
 #endif
 
+static const int kLogMemorySize = 1024 * 1024;           // 字符
+static const qint64 kLogFileMaxSize = 100 * 1024 * 1024; // 字节
+static const int kProgressIntervalMs = 250;
+
 /**
  * @class AbstractJob
  * @brief 后台任务的抽象基类。
@@ -41,13 +46,19 @@
 
 AbstractJob::AbstractJob(const QString &name, QThread::Priority priority)
     : QProcess(0)
-    , m_item(0)            ///< 在任务列表中显示的 QStandardItem
-    , m_ran(false)         ///< 标记任务是否已启动
-    , m_killed(false)      ///< 标记任务是否被用户停止
-    , m_label(name)        ///< 任务的标签/名称
-    , m_startingPercent(0) ///< 用于估算剩余时间的起始百分比
-    , m_priority(priority) ///< 任务进程的优先级
-    , m_isPaused(false)    ///< 标记任务是否处于暂停状态
+    , m_item(0)                          ///< 在任务列表中显示的 QStandardItem
+    , m_ran(false)                       ///< 标记任务是否已启动
+    , m_killed(false)                    ///< 标记任务是否被用户停止
+    , m_label(name)                      ///< 任务的标签/名称
+    , m_startingPercent(0)               ///< 用于估算剩余时间的起始百分比
+    , m_priority(priority)               ///< 任务进程的优先级
+    , m_isPaused(false)                  ///< 标记任务是否处于暂停状态
+    , m_resourceClass(CpuEncodeResource) ///< 任务主要占用的资源类别
+    , m_isBackground(false)              ///< 是否为播放时让路的后台任务
+    , m_concurrency(0)                   ///< 同类任务可同时运行的数量，0 表示按设置
+    , m_progressTimer(new QTimer(this))  ///< 限制进度更新频率的定时器
+    , m_progress(0)                      ///< 最近一次报告的进度
+    , m_isProgressPending(false)         ///< 是否有尚未发出的进度
 {
     setObjectName(name);
     // 连接 QProcess 的信号到本类的槽函数
@@ -76,6 +87,18 @@ AbstractJob::AbstractJob(const QString &name, QThread::Priority priority)
     connect(this, &AbstractJob::finished, this, [this]() {
         m_actionPause->setEnabled(false);
         m_actionResume->setEnabled(false);
+        m_progressTimer->stop();
+        m_isProgressPending = false;
+    });
+    // 在两次更新之间报告的进度只在间隔结束时发出最后一个
+    m_progressTimer->setSingleShot(true);
+    m_progressTimer->setInterval(kProgressIntervalMs);
+    connect(m_progressTimer, &QTimer::timeout, this, [this]() {
+        if (m_isProgressPending && state() == QProcess::Running) {
+            m_isProgressPending = false;
+            emit progressUpdated(m_item, m_progress);
+            m_progressTimer->start();
+        }
     });
 }
 
@@ -94,15 +117,73 @@ void AbstractJob::start()
 
 /// ... (其他简单的 getter/setter 方法)
 
+/**
+ * @brief 检查任务所依赖的任务是否都已结束。
+ * @return 如果可以启动本任务，则返回 true。已删除的依赖任务视为已结束。
+ */
+bool AbstractJob::isReady() const
+{
+    for (const auto &job : m_dependencies) {
+        if (job && !job->isFinished())
+            return false;
+    }
+    return true;
+}
+
 /**
  * @brief 将字符串追加到任务日志中。
  * @param s 要追加的字符串。
  */
 void AbstractJob::appendToLog(const QString &s)
 {
-    // 限制日志大小，防止占用过多内存
-    if (m_log.size() < 100 * 1024 * 1024 /* 100 MiB */) {
-        m_log.append(s);
+    m_log.append(s);
+    // 内存中只保留最近的日志，较早的部分写入临时文件
+    if (m_log.size() > kLogMemorySize) {
+        if (!m_logFile) {
+            m_logFile.reset(Util::writableTemporaryFile(QString(), "shotcut-XXXXXX.log"));
+            if (!m_logFile->open())
+                LOG_WARNING() << "failed to open the job log file" << m_logFile->fileName();
+        }
+        const auto n = m_log.size() - kLogMemorySize / 2;
+        // 限制文件大小，防止占用过多磁盘空间
+        if (m_logFile->isOpen() && m_logFile->size() < kLogFileMaxSize)
+            m_logFile->write(m_log.left(n).toUtf8());
+        m_log.remove(0, n);
+    }
+}
+
+/**
+ * @brief 获取任务日志。
+ * @return 写入临时文件的日志加上内存中最近的日志。
+ */
+QString AbstractJob::log() const
+{
+    if (!m_logFile || !m_logFile->isOpen())
+        return m_log;
+    m_logFile->flush();
+    QFile file(m_logFile->fileName());
+    if (!file.open(QIODevice::ReadOnly))
+        return m_log;
+    QString result = QString::fromUtf8(file.readAll());
+    if (file.size() >= kLogFileMaxSize)
+        result.append(QStringLiteral("...\n"));
+    return result + m_log;
+}
+
+/**
+ * @brief 报告任务进度。
+ * 进度信号最多每 kProgressIntervalMs 毫秒发出一次，以免频繁更新界面。
+ * @param percent 当前的进度百分比。
+ */
+void AbstractJob::setProgress(int percent)
+{
+    m_progress = percent;
+    if (m_progressTimer->isActive()) {
+        m_isProgressPending = true;
+    } else {
+        m_isProgressPending = false;
+        emit progressUpdated(m_item, percent);
+        m_progressTimer->start();
     }
 }
 
@@ -187,6 +268,7 @@ void AbstractJob::stop()
 void AbstractJob::pause()
 {
     m_isPaused = true;
+    m_isProgressPending = false;
     m_actionPause->setEnabled(false);
     m_actionResume->setEnabled(true);
 
@@ -216,24 +298,22 @@ void AbstractJob::resume()
     emit progressUpdated(m_item, 0); // 恢复进度显示
 }
 
-<<<<<<< HEAD
+void AbstractJob::setKilled(bool killed)
+{
+    m_killed = killed;
+}
+
 /**
  * @brief 当进程结束时调用。
  * @param exitCode 进程的退出码。
  * @param exitStatus 进程的退出状态（正常退出或崩溃）。
  */
-== == == = void AbstractJob::setKilled(bool killed)
-{
-    m_killed = killed;
-}
-
->>>>>>> 99569656ee5a8cd97959b39f6f18bbcc6014139d
 void AbstractJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     const QTime &time = QTime::fromMSecsSinceStartOfDay(m_totalTime.elapsed());
     // 读取进程剩余的输出
     if (isOpen()) {
-        m_log.append(readAll());
+        appendToLog(readAll());
     }
     // 根据退出状态和码执行相应操作
     if (exitStatus == QProcess::NormalExit && exitCode == 0 && !m_killed) {
@@ -242,18 +322,18 @@ void AbstractJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
             m_postJobAction->doAction(); // 执行后置操作
         }
         LOG_INFO() << "job succeeeded";
-        m_log.append(QStringLiteral("Completed successfully in %1\n").arg(time.toString()));
+        appendToLog(QStringLiteral("Completed successfully in %1\n").arg(time.toString()));
         emit progressUpdated(m_item, 100);
         emit finished(this, true); // 发出成功信号
     } else if (m_killed) {
         // 任务被用户停止
         LOG_INFO() << "job stopped";
-        m_log.append(QStringLiteral("Stopped by user at %1\n").arg(time.toString()));
+        appendToLog(QStringLiteral("Stopped by user at %1\n").arg(time.toString()));
         emit finished(this, false); // 发出失败信号
     } else {
         // 任务失败
         LOG_INFO() << "job failed with" << exitCode;
-        m_log.append(QStringLiteral("Failed with exit code %1\n").arg(exitCode));
+        appendToLog(QStringLiteral("Failed with exit code %1\n").arg(exitCode));
         emit finished(this, false); // 发出失败信号
     }
     m_isPaused = false;
@@ -264,12 +344,8 @@ void AbstractJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
  */
 void AbstractJob::onReadyRead()
 {
-    QString msg;
-    // 循环读取所有可用行
-    do {
-        msg = readLine();
-        appendToLog(msg);
-    } while (!msg.isEmpty());
+    // 一次读取所有可用的输出
+    appendToLog(QString::fromUtf8(readAll()));
 }
 
 /**
@@ -303,15 +379,8 @@ void AbstractJob::onStarted()
  */
 void AbstractJob::onProgressUpdated(QStandardItem *, int percent)
 {
-<<<<<<< HEAD
     // 在首次报告大于 0 的百分比时，启动估算计时器
     if (percent > 0 && (percent == 1 || m_startingPercent < 0)) {
-        == == == =
-            // Start timer on first reported percentage > 0.
-            if (percent == 1 || m_startingPercent < 0)
-        {
->>>>>>> 99569656ee5a8cd97959b39f6f18bbcc6014139d
-            m_estimateTime.restart();
-            m_startingPercent = percent;
-        }
+        m_estimateTime.restart();
+        m_startingPercent = percent;
     }
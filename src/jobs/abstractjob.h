@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -24,16 +24,29 @@
 #include <QElapsedTimer>
 #include <QList>
 #include <QModelIndex>
+#include <QPointer>
 #include <QProcess>
+#include <QTemporaryFile>
 #include <QThread>
 
 class QAction;
 class QStandardItem;
+class QTimer;
 
 class AbstractJob : public QProcess
 {
     Q_OBJECT
 public:
+    //! The resource a job mostly uses; each has its own number of job slots.
+    enum ResourceClass {
+        CpuEncodeResource,
+        GpuEncodeResource,
+        DiskResource,
+        NetworkResource,
+        RemoteRenderResource, ///< One slot per render node in the settings
+        ResourceClassCount
+    };
+
     explicit AbstractJob(const QString &name, QThread::Priority priority = Settings.jobPriority());
     virtual ~AbstractJob() {}
 
@@ -54,6 +67,20 @@ public:
     bool paused() const;
     void setTarget(const QString &target) { m_target = target; }
     QString target() { return m_target; }
+    ResourceClass resourceClass() const { return m_resourceClass; }
+    void setResourceClass(ResourceClass resourceClass) { m_resourceClass = resourceClass; }
+    //! Background jobs wait while the player plays so that it does not stutter.
+    bool isBackground() const { return m_isBackground; }
+    void setBackground(bool isBackground = true) { m_isBackground = isBackground; }
+    /*!
+      Lets up to \a concurrency jobs of its resource class run while this one
+      starts, instead of the slots in the settings when it is 0.
+    */
+    int concurrency() const { return m_concurrency; }
+    void setConcurrency(int concurrency) { m_concurrency = concurrency; }
+    //! Keeps this job from starting until \a job has finished.
+    void addDependency(AbstractJob *job) { m_dependencies << job; }
+    bool isReady() const;
 
 public slots:
     void start(const QString &program, const QStringList &arguments);
@@ -68,6 +95,8 @@ signals:
 
 protected:
     void setKilled(bool = true);
+    //! Emits progressUpdated() at most a few times per second.
+    void setProgress(int percent);
     QList<QAction *> m_standardActions;
     QList<QAction *> m_successActions;
     QStandardItem *m_item;
@@ -84,6 +113,7 @@ private:
     bool m_ran;
     bool m_killed;
     QString m_log;
+    QScopedPointer<QTemporaryFile> m_logFile;
     QString m_label;
     QElapsedTimer m_estimateTime;
     int m_startingPercent;
@@ -94,6 +124,13 @@ private:
     QAction *m_actionResume;
     bool m_isPaused;
     QString m_target;
+    ResourceClass m_resourceClass;
+    bool m_isBackground;
+    int m_concurrency;
+    QList<QPointer<AbstractJob>> m_dependencies;
+    QTimer *m_progressTimer;
+    int m_progress;
+    bool m_isProgressPending;
 };
 
 #endif // ABSTRACTJOB_H
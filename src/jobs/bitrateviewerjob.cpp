@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,14 +18,13 @@
 #include "bitrateviewerjob.h"
 
 #include "Logger.h"
-#include "dialogs/bitratedialog.h"
 #include "mainwindow.h"
 #include "util.h"
 
-#include <QJsonDocument>
-#include <QJsonObject>
 #include <QString>
 
+static const int kUpdateIntervalMs = 1000;
+
 BitrateViewerJob::BitrateViewerJob(const QString &name, const QStringList &args, double fps)
     : FfprobeJob(name, args)
     , m_resource(args.last())
@@ -39,26 +38,76 @@ BitrateViewerJob::BitrateViewerJob(const QString &name, const QStringList &args,
 
 BitrateViewerJob::~BitrateViewerJob() {}
 
+void BitrateViewerJob::start()
+{
+    // Show the bitrates as they are read.
+    m_dialog = new BitrateDialog(Util::baseName(m_resource), m_fps, m_data, &MAIN);
+    m_dialog->setAttribute(Qt::WA_DeleteOnClose);
+    m_dialog->show();
+    connect(&m_updateTimer, &QTimer::timeout, this, &BitrateViewerJob::updateDialog);
+    m_updateTimer.start(kUpdateIntervalMs);
+    FfprobeJob::start();
+}
+
 void BitrateViewerJob::onFinished(int exitCode, ExitStatus exitStatus)
 {
+    readPackets(true);
+    m_updateTimer.stop();
     AbstractJob::onFinished(exitCode, exitStatus);
     if (exitStatus == QProcess::NormalExit && exitCode == 0) {
-        QJsonParseError error;
-        auto s = log();
-        s = s.left(s.lastIndexOf('}') + 1);
-        auto doc = QJsonDocument::fromJson(s.toUtf8(), &error);
-        if (QJsonParseError::NoError == error.error && doc.isObject()) {
-            auto v = doc.object().value("packets");
-            if (v.isArray()) {
-                m_data = v.toArray();
-                onOpenTriggered();
+        m_data.finish();
+        if (m_dialog)
+            updateDialog();
+        else
+            onOpenTriggered();
+    }
+}
+
+void BitrateViewerJob::onReadyRead()
+{
+    readPackets(false);
+}
+
+void BitrateViewerJob::readPackets(bool isFinished)
+{
+    // Each line is one packet like "pts_time=0.040000|duration_time=0.040000|size=1234|flags=K__".
+    while (canReadLine() || (isFinished && bytesAvailable() > 0)) {
+        const auto line = readLine().trimmed();
+        double pts = 0.0;
+        double duration = 0.0;
+        double size = 0.0;
+        bool isKey = false;
+        bool isPacket = false;
+        for (const auto &field : line.split('|')) {
+            const auto separator = field.indexOf('=');
+            if (separator < 0)
+                continue;
+            const auto key = field.left(separator);
+            const auto value = field.mid(separator + 1);
+            if (key == "pts_time") {
+                pts = value.toDouble();
+                isPacket = true;
+            } else if (key == "duration_time") {
+                duration = value.toDouble();
+            } else if (key == "size") {
+                size = value.toDouble();
+            } else if (key == "flags") {
+                isKey = value.startsWith('K');
             }
-        } else {
-            LOG_ERROR() << "JSON parsing error:" << error.errorString();
         }
+        if (isPacket)
+            m_data.addPacket(pts, duration, size, isKey);
+        else if (!line.isEmpty())
+            appendToLog(QString::fromUtf8(line) + '\n');
     }
 }
 
+void BitrateViewerJob::updateDialog()
+{
+    if (m_dialog)
+        m_dialog->updateData(m_data);
+}
+
 void BitrateViewerJob::onOpenTriggered()
 {
     BitrateDialog dialog(Util::baseName(m_resource), m_fps, m_data, &MAIN);
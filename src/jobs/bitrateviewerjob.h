@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 202-2025 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,9 +18,11 @@
 #ifndef BITRATEVIEWERJOB_H
 #define BITRATEVIEWERJOB_H
 
+#include "dialogs/bitratedialog.h"
 #include "ffprobejob.h"
 
-#include <QJsonArray>
+#include <QPointer>
+#include <QTimer>
 
 class BitrateViewerJob : public FfprobeJob
 {
@@ -28,15 +30,22 @@ class BitrateViewerJob : public FfprobeJob
 public:
     BitrateViewerJob(const QString &name, const QStringList &args, double fps);
     virtual ~BitrateViewerJob();
+    void start() override;
 
 private slots:
     void onFinished(int exitCode, QProcess::ExitStatus exitStatus) override;
+    void onReadyRead() override;
     void onOpenTriggered();
+    void updateDialog();
 
 private:
+    void readPackets(bool isFinished);
+
     QString m_resource;
     double m_fps{0.0};
-    QJsonArray m_data;
+    BitrateData m_data;
+    QPointer<BitrateDialog> m_dialog;
+    QTimer m_updateTimer;
 };
 
 #endif // BITRATEVIEWERJOB_H
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "copyjob.h"
+
+#include "Logger.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QtConcurrent/QtConcurrentRun>
+
+static const qint64 kChunkSize = 8 * 1024 * 1024;
+
+CopyJob::CopyJob(const QString &srcFilePath, const QString &destFilePath)
+    : AbstractJob(tr("Copy %1").arg(QFileInfo(srcFilePath).fileName()))
+    , m_srcFilePath(srcFilePath)
+    , m_destFilePath(destFilePath)
+{
+    setTarget(destFilePath);
+    setResourceClass(DiskResource);
+    connect(&m_watcher, &QFutureWatcher<QString>::finished, this, &CopyJob::onCopyFinished);
+}
+
+CopyJob::~CopyJob()
+{
+    m_isStopping = true;
+    m_watcher.waitForFinished();
+}
+
+void CopyJob::start()
+{
+    AbstractJob::start();
+    m_isStopping = false;
+    LOG_INFO() << "Copy Source" << m_srcFilePath;
+    LOG_INFO() << "Copy Destination" << m_destFilePath;
+    appendToLog(QStringLiteral("Copying \"%1\"\n").arg(m_srcFilePath));
+    m_watcher.setFuture(QtConcurrent::run([this]() { return copy(); }));
+}
+
+void CopyJob::stop()
+{
+    AbstractJob::stop();
+    m_isStopping = true;
+}
+
+QString CopyJob::copy()
+{
+    QFile src(m_srcFilePath);
+    if (!src.open(QIODevice::ReadOnly))
+        return QStringLiteral("Unable to open \"%1\" to read").arg(m_srcFilePath);
+    QFile dst(tmpPath());
+    if (!dst.open(QIODevice::WriteOnly))
+        return QStringLiteral("Unable to open \"%1\" to write").arg(tmpPath());
+    const qint64 length = src.size();
+    qint64 copied = 0;
+    while (!src.atEnd()) {
+        if (m_isStopping)
+            return QStringLiteral("Stopped");
+        const QByteArray data = src.read(kChunkSize);
+        if (data.isEmpty())
+            return QStringLiteral("Failed to read \"%1\": %2")
+                .arg(m_srcFilePath, src.errorString());
+        if (dst.write(data) != data.size())
+            return QStringLiteral("Failed to write \"%1\": %2").arg(tmpPath(), dst.errorString());
+        copied += data.size();
+        if (length > 0) {
+            const int percent = qMin<qint64>(99, copied * 100 / length);
+            QMetaObject::invokeMethod(
+                this, [=]() { setProgress(percent); }, Qt::QueuedConnection);
+        }
+    }
+    return QString();
+}
+
+void CopyJob::onCopyFinished()
+{
+    const auto error = m_watcher.result();
+    if (!error.isEmpty() || stopped()) {
+        if (!stopped()) {
+            LOG_ERROR() << error;
+            appendToLog(error + '\n');
+        }
+        QFile::remove(tmpPath());
+        onFinished(1);
+        return;
+    }
+    QFile::remove(m_destFilePath);
+    if (!QFile::rename(tmpPath(), m_destFilePath)) {
+        appendToLog(QStringLiteral("Failed to rename \"%1\"\n").arg(tmpPath()));
+        QFile::remove(tmpPath());
+        onFinished(1);
+        return;
+    }
+    onFinished(0);
+}
@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef COPYJOB_H
+#define COPYJOB_H
+
+#include "abstractjob.h"
+
+#include <QFutureWatcher>
+
+#include <atomic>
+
+/*!
+  \class CopyJob
+  \brief Copies a file in the background.
+
+  The file is read on a worker thread so that a slow network share does not
+  stall the user interface. It is written to "<file>.tmp" and takes its final
+  name only when the copy is complete.
+*/
+
+class CopyJob : public AbstractJob
+{
+    Q_OBJECT
+public:
+    CopyJob(const QString &srcFilePath, const QString &destFilePath);
+    virtual ~CopyJob();
+    void start();
+    void stop();
+
+private slots:
+    void onCopyFinished();
+
+private:
+    QString copy();
+    QString tmpPath() const { return m_destFilePath + ".tmp"; }
+
+    QString m_srcFilePath;
+    QString m_destFilePath;
+    QFutureWatcher<QString> m_watcher;
+    std::atomic<bool> m_isStopping{false};
+};
+
+#endif // COPYJOB_H
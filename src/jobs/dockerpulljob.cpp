@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -27,6 +27,7 @@ DockerPullJob::DockerPullJob(const QString &imageRef, QThread::Priority priority
     , m_imageRef(imageRef)
 {
     setTarget(imageRef);
+    setResourceClass(NetworkResource);
 
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
     auto env = QProcessEnvironment::systemEnvironment();
@@ -0,0 +1,479 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "downloadjob.h"
+
+#include "Logger.h"
+#include "mainwindow.h"
+#include "qmltypes/qmlapplication.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMessageBox>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QSaveFile>
+
+static const int kMaxConnections = 4;
+// A range smaller than this is not worth a connection of its own.
+static const qint64 kMinRangeSize = 16 * 1024 * 1024;
+static const int kMaxRetries = 5;
+static const int kRetryDelayMs = 2000;
+static const int kTransferTimeoutMs = 15000;
+static const int kSaveStateIntervalMs = 2000;
+// How much already written data is hashed per event loop iteration
+static const qint64 kHashSliceSize = 4 * 1024 * 1024;
+
+DownloadJob::DownloadJob(const QString &url, const QString &destFilePath, const QString &sha256)
+    : AbstractJob(tr("Download %1").arg(QFileInfo(destFilePath).fileName()))
+    , m_url(url)
+    , m_destFilePath(destFilePath)
+    , m_sha256(QByteArray::fromHex(sha256.toLatin1()))
+    , m_network(new QNetworkAccessManager(this))
+    , m_headReply(nullptr)
+    , m_length(-1)
+    , m_hash(QCryptographicHash::Sha256)
+    , m_hashed(0)
+    , m_hashFile(nullptr)
+    , m_isHashPending(false)
+    , m_isFailed(false)
+    , m_isRunning(false)
+    , m_isIgnoringSslErrors(false)
+{
+    setTarget(destFilePath);
+    setResourceClass(NetworkResource);
+    m_saveTimer.setInterval(kSaveStateIntervalMs);
+    connect(&m_saveTimer, &QTimer::timeout, this, &DownloadJob::saveState);
+}
+
+DownloadJob::~DownloadJob()
+{
+    LOG_DEBUG() << "DownloadJob destroyed";
+}
+
+void DownloadJob::start()
+{
+    AbstractJob::start();
+    m_ranges.clear();
+    m_length = -1;
+    m_validator.clear();
+    m_hash.reset();
+    m_hashed = 0;
+    m_isHashPending = false;
+    m_isFailed = false;
+    m_isRunning = true;
+    LOG_INFO() << "Download Source" << m_url.toString();
+    LOG_INFO() << "Download Destination" << m_destFilePath;
+    appendToLog(QStringLiteral("Downloading \"%1\"\n").arg(m_url.toString()));
+    startHead();
+}
+
+void DownloadJob::stop()
+{
+    AbstractJob::stop();
+    if (m_headReply) {
+        m_headReply->abort();
+        return;
+    }
+    for (auto &range : m_ranges) {
+        if (range.reply)
+            range.reply->abort();
+    }
+    finish();
+}
+
+void DownloadJob::startHead()
+{
+    QNetworkRequest request(m_url);
+    request.setTransferTimeout(kTransferTimeoutMs);
+    m_headReply = m_network->head(request);
+    connect(m_headReply, &QNetworkReply::finished, this, &DownloadJob::onHeadFinished);
+    connect(m_headReply, &QNetworkReply::sslErrors, this, &DownloadJob::onSslErrors);
+}
+
+void DownloadJob::onHeadFinished()
+{
+    QNetworkReply *reply = m_headReply;
+    m_headReply = nullptr;
+    reply->deleteLater();
+    if (stopped()) {
+        finish();
+        return;
+    }
+    const auto status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute);
+    if (reply->error() != QNetworkReply::NoError && !status.isValid()) {
+        if (reply->error() == QNetworkReply::UnknownNetworkError && m_url.scheme() == "https") {
+            appendToLog(QStringLiteral("%1, trying http\n").arg(reply->errorString()));
+            m_url.setScheme("http");
+            startHead();
+        } else {
+            fail(reply->errorString());
+        }
+        return;
+    }
+    bool acceptsRanges = false;
+    if (reply->error() == QNetworkReply::NoError) {
+        // Ask for the ranges where the redirects led.
+        m_url = reply->url();
+        m_length = reply->header(QNetworkRequest::ContentLengthHeader).toLongLong();
+        acceptsRanges = reply->rawHeader("Accept-Ranges").trimmed() == "bytes";
+        m_validator = reply->rawHeader("ETag");
+        if (m_validator.isEmpty())
+            m_validator = reply->rawHeader("Last-Modified");
+    } else {
+        // Some servers refuse HEAD; the download itself reports a real error.
+        appendToLog(QStringLiteral("HEAD failed: %1\n").arg(reply->errorString()));
+    }
+    planRanges(acceptsRanges);
+}
+
+void DownloadJob::planRanges(bool acceptsRanges)
+{
+    if (acceptsRanges && m_length > 0) {
+        if (loadState()) {
+            qint64 received = 0;
+            for (const auto &range : m_ranges)
+                received += range.received;
+            appendToLog(QStringLiteral("Resuming at %1 of %2 bytes\n").arg(received).arg(m_length));
+        } else {
+            QFile file(tmpPath());
+            if (!file.open(QIODevice::WriteOnly) || !file.resize(m_length)) {
+                fail(QStringLiteral("Unable to open \"%1\" to write").arg(tmpPath()));
+                return;
+            }
+            file.close();
+            const int count = qBound<qint64>(1, m_length / kMinRangeSize, kMaxConnections);
+            for (int i = 0; i < count; ++i) {
+                Range range;
+                range.start = m_length * i / count;
+                range.end = m_length * (i + 1) / count;
+                m_ranges << range;
+            }
+            saveState();
+        }
+        appendToLog(QStringLiteral("Using %1 connections\n").arg(m_ranges.size()));
+    } else {
+        // It cannot resume, so start over with one request.
+        QFile::remove(statePath());
+        m_ranges << Range();
+    }
+    m_saveTimer.start();
+    for (int i = 0; i < m_ranges.size() && !m_isFailed; ++i)
+        startRange(i);
+    // Hash what an earlier attempt left.
+    hashAvailable();
+}
+
+bool DownloadJob::loadState()
+{
+    QFile file(statePath());
+    if (!file.open(QIODevice::ReadOnly) || QFileInfo(tmpPath()).size() != m_length)
+        return false;
+    const auto state = QJsonDocument::fromJson(file.readAll()).object();
+    if (state.value("length").toInteger() != m_length
+        || state.value("validator").toString().toLatin1() != m_validator)
+        return false;
+    QList<Range> ranges;
+    qint64 next = 0;
+    for (const auto &value : state.value("ranges").toArray()) {
+        const auto array = value.toArray();
+        Range range;
+        range.start = array.at(0).toInteger();
+        range.end = array.at(1).toInteger();
+        range.received = array.at(2).toInteger();
+        if (range.start != next || range.end <= range.start || range.received < 0
+            || range.received > range.size())
+            return false;
+        next = range.end;
+        ranges << range;
+    }
+    if (next != m_length)
+        return false;
+    m_ranges = ranges;
+    return true;
+}
+
+void DownloadJob::saveState()
+{
+    if (m_length <= 0 || m_ranges.isEmpty() || m_ranges.first().end < 0)
+        return;
+    QJsonArray ranges;
+    for (const auto &range : m_ranges)
+        ranges.append(QJsonArray{range.start, range.end, range.received});
+    QJsonObject state;
+    state["url"] = m_url.toString();
+    state["length"] = m_length;
+    state["validator"] = QString::fromLatin1(m_validator);
+    state["ranges"] = ranges;
+    QSaveFile file(statePath());
+    if (file.open(QIODevice::WriteOnly)) {
+        file.write(QJsonDocument(state).toJson(QJsonDocument::Compact));
+        file.commit();
+    }
+}
+
+void DownloadJob::startRange(int index)
+{
+    auto &range = m_ranges[index];
+    if (range.isDone() || m_isFailed)
+        return;
+    if (!range.file) {
+        range.file = new QFile(tmpPath(), this);
+        // Without a size it is written from the start; otherwise in place.
+        const auto mode = range.end < 0 ? QIODevice::WriteOnly
+                                        : QIODevice::ReadWrite | QIODevice::Unbuffered;
+        if (!range.file->open(mode)) {
+            fail(QStringLiteral("Unable to open \"%1\" to write").arg(tmpPath()));
+            return;
+        }
+    }
+    range.file->seek(range.start + range.received);
+
+    QNetworkRequest request(m_url);
+    request.setTransferTimeout(kTransferTimeoutMs);
+    if (range.end >= 0) {
+        request.setRawHeader("Range",
+                             QStringLiteral("bytes=%1-%2")
+                                 .arg(range.start + range.received)
+                                 .arg(range.end - 1)
+                                 .toLatin1());
+        // HTTP/2 would carry all of the ranges on one TCP stream.
+        request.setAttribute(QNetworkRequest::Http2AllowedAttribute, false);
+    }
+    range.reply = m_network->get(request);
+    connect(range.reply, &QNetworkReply::readyRead, this, [this, index]() { onRangeReadyRead(index); });
+    connect(range.reply, &QNetworkReply::finished, this, [this, index]() { onRangeFinished(index); });
+    connect(range.reply, &QNetworkReply::sslErrors, this, &DownloadJob::onSslErrors);
+}
+
+void DownloadJob::onRangeReadyRead(int index)
+{
+    auto &range = m_ranges[index];
+    if (!range.reply || m_isFailed)
+        return;
+    if (range.end >= 0
+        && range.reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 206) {
+        // The server sent the whole file instead of the range.
+        QFile::remove(statePath());
+        fail(QStringLiteral("The server did not return the requested range"));
+        return;
+    }
+    const QByteArray data = range.reply->readAll();
+    if (range.end >= 0 && range.received + data.size() > range.size()) {
+        fail(QStringLiteral("The server returned more than the requested range"));
+        return;
+    }
+    if (range.file->write(data) != data.size()) {
+        fail(QStringLiteral("Failed to write \"%1\": %2").arg(tmpPath(), range.file->errorString()));
+        return;
+    }
+    if (!m_sha256.isEmpty() && !m_isHashPending && m_hashed == range.start + range.received) {
+        m_hash.addData(data);
+        m_hashed += data.size();
+    }
+    range.received += data.size();
+    updateProgress();
+}
+
+void DownloadJob::onRangeFinished(int index)
+{
+    auto &range = m_ranges[index];
+    QNetworkReply *reply = range.reply;
+    if (!reply)
+        return;
+    onRangeReadyRead(index);
+    range.reply = nullptr;
+    reply->deleteLater();
+    if (stopped() || m_isFailed) {
+        finish();
+        return;
+    }
+    if (reply->error() == QNetworkReply::NoError) {
+        if (range.end < 0) {
+            range.end = range.received;
+        } else if (!range.isDone()) {
+            fail(QStringLiteral("The connection closed before the end of the range"));
+            return;
+        }
+        range.file->close();
+        hashAvailable();
+    } else if (range.end >= 0 && range.retries < kMaxRetries
+               && !reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).isValid()) {
+        // A dropped connection resumes from its last byte.
+        ++range.retries;
+        range.isWaiting = true;
+        appendToLog(QStringLiteral("%1, retrying from byte %2\n")
+                        .arg(reply->errorString())
+                        .arg(range.start + range.received));
+        QTimer::singleShot(kRetryDelayMs * range.retries, this, [this, index]() {
+            m_ranges[index].isWaiting = false;
+            if (stopped() || m_isFailed)
+                finish();
+            else
+                startRange(index);
+        });
+    } else {
+        fail(reply->errorString());
+    }
+}
+
+qint64 DownloadJob::contiguousLength() const
+{
+    for (const auto &range : m_ranges) {
+        if (!range.isDone())
+            return range.start + range.received;
+    }
+    return m_ranges.isEmpty() ? 0 : m_ranges.last().end;
+}
+
+void DownloadJob::hashAvailable()
+{
+    m_isHashPending = false;
+    if (m_sha256.isEmpty() || m_isFailed)
+        return;
+    const qint64 available = contiguousLength();
+    if (m_hashed < available) {
+        if (!m_hashFile) {
+            m_hashFile = new QFile(tmpPath(), this);
+            m_hashFile->open(QIODevice::ReadOnly);
+        }
+        m_hashFile->seek(m_hashed);
+        const QByteArray data = m_hashFile->read(qMin(kHashSliceSize, available - m_hashed));
+        if (data.isEmpty()) {
+            fail(QStringLiteral("Failed to read \"%1\" to verify it").arg(tmpPath()));
+            return;
+        }
+        m_hash.addData(data);
+        m_hashed += data.size();
+        if (m_hashed < available) {
+            m_isHashPending = true;
+            QTimer::singleShot(0, this, &DownloadJob::hashAvailable);
+            return;
+        }
+    }
+    finish();
+}
+
+void DownloadJob::updateProgress()
+{
+    if (m_length <= 0)
+        return;
+    qint64 received = 0;
+    for (const auto &range : m_ranges)
+        received += range.received;
+    setProgress(qMin<qint64>(99, received * 100 / m_length));
+}
+
+void DownloadJob::finish()
+{
+    if (!m_isRunning || m_headReply || m_isHashPending)
+        return;
+    for (const auto &range : m_ranges) {
+        if (range.isActive())
+            return;
+    }
+    bool isComplete = !m_ranges.isEmpty();
+    for (const auto &range : m_ranges)
+        isComplete = isComplete && range.isDone();
+    const bool isSuccess = isComplete && !stopped() && !m_isFailed;
+    if (isSuccess && !m_sha256.isEmpty() && m_hashed < contiguousLength()) {
+        // Verify the rest of what the other connections wrote.
+        hashAvailable();
+        return;
+    }
+    m_isRunning = false;
+    m_saveTimer.stop();
+    for (auto &range : m_ranges) {
+        delete range.file;
+        range.file = nullptr;
+    }
+    delete m_hashFile;
+    m_hashFile = nullptr;
+
+    if (!isSuccess) {
+        // Keep what arrived for the next attempt when it can resume.
+        if (QFile::exists(statePath()))
+            saveState();
+        else
+            QFile::remove(tmpPath());
+        onFinished(1);
+        return;
+    }
+    if (!m_sha256.isEmpty()) {
+        if (m_hash.result() != m_sha256) {
+            appendToLog(QStringLiteral("The checksum %1 does not match %2\n")
+                            .arg(QString::fromLatin1(m_hash.result().toHex()),
+                                 QString::fromLatin1(m_sha256.toHex())));
+            QFile::remove(tmpPath());
+            QFile::remove(statePath());
+            onFinished(1);
+            return;
+        }
+        appendToLog(QStringLiteral("The checksum matches\n"));
+    }
+    QFile::remove(m_destFilePath);
+    if (!QFile::rename(tmpPath(), m_destFilePath)) {
+        appendToLog(QStringLiteral("Failed to rename \"%1\"\n").arg(tmpPath()));
+        onFinished(1);
+        return;
+    }
+    QFile::remove(statePath());
+    onFinished(0);
+}
+
+void DownloadJob::fail(const QString &message)
+{
+    LOG_ERROR() << message;
+    appendToLog(message + '\n');
+    m_isFailed = true;
+    m_isHashPending = false;
+    for (auto &range : m_ranges) {
+        if (range.reply)
+            range.reply->abort();
+    }
+    finish();
+}
+
+void DownloadJob::onSslErrors(const QList<QSslError> &errors)
+{
+    auto reply = qobject_cast<QNetworkReply *>(sender());
+    LOG_ERROR() << "SSL Errors" << errors;
+    if (!reply)
+        return;
+    if (!m_isIgnoringSslErrors && reply == m_headReply) {
+        // Ask once; the ranges come from the same server.
+        QString message = tr("The following SSL errors were encountered:");
+        for (const auto &error : errors)
+            message += QStringLiteral("\n") + error.errorString();
+        message += tr("\nAttempt to ignore SSL errors?");
+        QMessageBox dialog(QMessageBox::Question,
+                           label(),
+                           message,
+                           QMessageBox::No | QMessageBox::Yes,
+                           &MAIN);
+        dialog.setDefaultButton(QMessageBox::Yes);
+        dialog.setEscapeButton(QMessageBox::No);
+        dialog.setWindowModality(QmlApplication::dialogModality());
+        m_isIgnoringSslErrors = dialog.exec() == QMessageBox::Yes;
+    }
+    if (m_isIgnoringSslErrors)
+        reply->ignoreSslErrors(errors);
+}
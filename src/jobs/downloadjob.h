@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef DOWNLOADJOB_H
+#define DOWNLOADJOB_H
+
+#include "abstractjob.h"
+
+#include <QCryptographicHash>
+#include <QList>
+#include <QSslError>
+#include <QTimer>
+#include <QUrl>
+
+class QFile;
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/*!
+  \class DownloadJob
+  \brief Downloads a large file in the background over several connections.
+
+  When the server accepts byte ranges, the file is split into a few ranges
+  that are fetched at once into "<file>.tmp", and how much of each range has
+  arrived is saved beside it in "<file>.tmp.parts". A download that is
+  stopped or fails therefore resumes where it left off the next time, and a
+  connection that drops is retried from its last byte. A server without
+  ranges gets one plain request.
+
+  When a SHA-256 is given, the data is hashed in file order while it
+  arrives: the first range is hashed from the network, and the bytes of the
+  later ranges are read back from the file once the hash reaches them. The
+  file only takes its final name when the checksum matches.
+*/
+
+class DownloadJob : public AbstractJob
+{
+    Q_OBJECT
+public:
+    DownloadJob(const QString &url, const QString &destFilePath, const QString &sha256 = QString());
+    virtual ~DownloadJob();
+    void start();
+    void stop();
+
+private slots:
+    void onHeadFinished();
+    void onSslErrors(const QList<QSslError> &errors);
+    void saveState();
+
+private:
+    struct Range
+    {
+        qint64 start = 0;
+        qint64 end = -1; ///< Exclusive, or -1 when the size is unknown
+        qint64 received = 0;
+        int retries = 0;
+        bool isWaiting = false; ///< Waiting to retry after an error
+        QNetworkReply *reply = nullptr;
+        QFile *file = nullptr;
+        qint64 size() const { return end - start; }
+        bool isDone() const { return end >= 0 && received >= size(); }
+        bool isActive() const { return reply || isWaiting; }
+    };
+
+    void startHead();
+    void planRanges(bool acceptsRanges);
+    bool loadState();
+    void startRange(int index);
+    void onRangeReadyRead(int index);
+    void onRangeFinished(int index);
+    qint64 contiguousLength() const;
+    void hashAvailable();
+    void updateProgress();
+    void finish();
+    void fail(const QString &message);
+    QString tmpPath() const { return m_destFilePath + ".tmp"; }
+    QString statePath() const { return m_destFilePath + ".tmp.parts"; }
+
+    QUrl m_url;
+    QString m_destFilePath;
+    QByteArray m_sha256;
+    QNetworkAccessManager *m_network;
+    QNetworkReply *m_headReply;
+    QList<Range> m_ranges;
+    qint64 m_length;
+    QByteArray m_validator; ///< The ETag or Last-Modified of the file
+    QCryptographicHash m_hash;
+    qint64 m_hashed;
+    QFile *m_hashFile;
+    bool m_isHashPending;
+    bool m_isFailed;
+    bool m_isRunning;
+    bool m_isIgnoringSslErrors;
+    QTimer m_saveTimer;
+};
+
+#endif // DOWNLOADJOB_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -34,6 +34,7 @@
 #include <QDomDocument>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QInputDialog>
 #include <QJSEngine>
 #include <QTemporaryFile>
 #include <QTextStream>
@@ -41,6 +42,10 @@
 
 #include "Logger.h"
 
+#include <memory>
+
+static const int kMinQualitySegmentSeconds = 60;
+
 EncodeJob::EncodeJob(const QString &name,
                      const QString &xml,
                      int frameRateNum,
@@ -97,6 +102,21 @@ void EncodeJob::onVideoQualityTriggered()
         if (Util::warnIfNotWritable(reportPath, &MAIN, caption))
             return;
 
+        bool ok = false;
+        const int sampleSeconds
+            = QInputDialog::getInt(&MAIN,
+                                   caption,
+                                   tr("Measure one second in every this many seconds\n"
+                                      "(1 measures every frame):"),
+                                   Settings.encodeQualitySampleSeconds(),
+                                   1,
+                                   3600,
+                                   1,
+                                   &ok);
+        if (!ok)
+            return;
+        Settings.setEncodeQualitySampleSeconds(sampleSeconds);
+
         // Get temp file for the new XML.
         QScopedPointer<QTemporaryFile> tmp(Util::writableTemporaryFile(reportPath));
         tmp->open();
@@ -107,8 +127,23 @@ void EncodeJob::onVideoQualityTriggered()
         Mlt::Producer encoded(MLT.profile(), objectName().toUtf8().constData());
         Mlt::Transition vqm(MLT.profile(), "vqm");
         if (original.is_valid() && encoded.is_valid() && vqm.is_valid()) {
-            tractor.set_track(original, 0);
-            tractor.set_track(encoded, 1);
+            Mlt::Playlist originalSamples(MLT.profile());
+            Mlt::Playlist encodedSamples(MLT.profile());
+            if (sampleSeconds > 1) {
+                // Compare the same second at the start of each interval.
+                const int length = qMin(original.get_playtime(), encoded.get_playtime());
+                const int sampleLength = qMax(1, qRound(MLT.profile().fps()));
+                for (int i = 0; i < length; i += sampleLength * sampleSeconds) {
+                    const int out = qMin(length, i + sampleLength) - 1;
+                    originalSamples.append(original, i, out);
+                    encodedSamples.append(encoded, i, out);
+                }
+                tractor.set_track(originalSamples, 0);
+                tractor.set_track(encodedSamples, 1);
+            } else {
+                tractor.set_track(original, 0);
+                tractor.set_track(encoded, 1);
+            }
             tractor.plant_transition(vqm);
             vqm.set("render", 0);
             MLT.saveXML(tmp->fileName(), &tractor, false /* without relative paths */, tmp.data());
@@ -131,12 +166,45 @@ void EncodeJob::onVideoQualityTriggered()
             consumerNode.setAttribute("real_time", -1);
             consumerNode.setAttribute("terminate_on_pause", 1);
 
-            // Create job and add it to the queue.
-            JOBS.add(new VideoQualityJob(objectName(),
-                                         dom.toString(2),
-                                         reportPath,
-                                         MLT.profile().frame_rate_num(),
-                                         MLT.profile().frame_rate_den()));
+            // Measure long files in segments at the same time and merge the reports.
+            const int length = tractor.get_playtime();
+            const int segmentCount
+                = qBound(1,
+                         length / qMax(1, qRound(MLT.profile().fps() * kMinQualitySegmentSeconds)),
+                         JobQueue::jobSlots(AbstractJob::CpuEncodeResource));
+            if (segmentCount < 2) {
+                JOBS.add(new VideoQualityJob(objectName(),
+                                             dom.toString(2),
+                                             reportPath,
+                                             MLT.profile().frame_rate_num(),
+                                             MLT.profile().frame_rate_den()));
+                return;
+            }
+            const QString xml = dom.toString(2);
+            const int segmentLength = (length + segmentCount - 1) / segmentCount;
+            QStringList partPaths;
+            QList<VideoQualityJob *> jobs;
+            for (int i = 0; i < segmentCount; ++i) {
+                const auto partPath = QStringLiteral("%1.part%2").arg(reportPath).arg(i + 1);
+                auto job = new VideoQualityJob(objectName(),
+                                               xml,
+                                               reportPath,
+                                               MLT.profile().frame_rate_num(),
+                                               MLT.profile().frame_rate_den(),
+                                               partPath);
+                job->setLabel(tr("Measure %1 segment %2").arg(objectName()).arg(i + 1));
+                job->setInAndOut(i * segmentLength, qMin(length, (i + 1) * segmentLength) - 1);
+                partPaths << partPath;
+                jobs << job;
+            }
+            auto remaining = std::make_shared<int>(segmentCount);
+            for (auto job : jobs) {
+                connect(job, &AbstractJob::finished, &MAIN, [=]() {
+                    if (--*remaining == 0)
+                        VideoQualityJob::mergeReports(partPaths, reportPath);
+                });
+                JOBS.add(job);
+            }
         }
     }
 }
@@ -267,6 +335,7 @@ void EncodeJob::onEmbedChapters()
                          << "-y" << filePath;
                     auto job = new FfmpegJob(filePath, args, false);
                     job->setLabel(filePath);
+                    job->setResourceClass(DiskResource);
                     tempFile->setParent(job);
                     JOBS.add(job);
                 }
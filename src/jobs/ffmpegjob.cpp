@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022 Meltytech, LLC
+ * Copyright (c) 2016-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -46,6 +46,7 @@ FfmpegJob::FfmpegJob(const QString &name,
     m_successActions << action;
     m_args.append(args);
     setLabel(tr("Check %1").arg(Util::baseName(name)));
+    connect(this, &QProcess::readyReadStandardOutput, this, &FfmpegJob::onProgressReady);
 }
 
 FfmpegJob::~FfmpegJob()
@@ -60,8 +61,12 @@ void FfmpegJob::start()
     QString shotcutPath = qApp->applicationDirPath();
     QFileInfo ffmpegPath(shotcutPath, "ffmpeg");
     setReadChannel(QProcess::StandardError);
-    LOG_DEBUG() << ffmpegPath.absoluteFilePath() + " " + m_args.join(' ');
-    AbstractJob::start(ffmpegPath.absoluteFilePath(), m_args);
+    // Report the progress as key=value lines on stdout instead of the stats
+    // line in the log.
+    QStringList args{"-nostats", "-progress", "pipe:1"};
+    args << m_args;
+    LOG_DEBUG() << ffmpegPath.absoluteFilePath() + " " + args.join(' ');
+    AbstractJob::start(ffmpegPath.absoluteFilePath(), args);
 }
 
 void FfmpegJob::stop()
@@ -96,26 +101,43 @@ static double timeToSeconds(QString time)
 
 void FfmpegJob::onReadyRead()
 {
-    QString msg;
-    do {
-        msg = readLine();
-        if (!msg.startsWith("frame=") && (!msg.trimmed().isEmpty())) {
-            appendToLog(msg);
-        }
+    QString log;
+    while (canReadLine()) {
+        QString msg = readLine();
+        if (msg.trimmed().isEmpty())
+            continue;
+        log.append(msg);
         if (m_duration == 0 && msg.contains("Duration:")) {
             msg = msg.mid(msg.indexOf("Duration:") + 9);
             msg = msg.left(msg.indexOf(','));
             m_duration = timeToSeconds(msg);
             emit progressUpdated(m_item, 0);
-        } else if (m_duration != 0 && msg.startsWith("frame=")) {
-            msg = msg.mid(msg.indexOf("time=") + 6);
-            msg = msg.left(msg.indexOf(" bitrate"));
-            double time = timeToSeconds(msg);
-            int percent = qRound(time * 100.0 / m_duration);
-            if (percent != m_previousPercent) {
-                emit progressUpdated(m_item, percent);
-                m_previousPercent = percent;
-            }
         }
-    } while (!msg.isEmpty());
+    }
+    if (!log.isEmpty())
+        appendToLog(log);
+}
+
+void FfmpegJob::onProgressReady()
+{
+    m_progressBuffer.append(readAllStandardOutput());
+    int start = 0;
+    for (int end = m_progressBuffer.indexOf('\n'); end > -1;
+         start = end + 1, end = m_progressBuffer.indexOf('\n', start)) {
+        static const QByteArray key("out_time_us=");
+        if (m_duration <= 0 || m_progressBuffer.mid(start, key.size()) != key)
+            continue;
+        bool ok = false;
+        const auto time = m_progressBuffer.mid(start + key.size(), end - start - key.size())
+                              .trimmed()
+                              .toLongLong(&ok);
+        if (!ok)
+            continue;
+        int percent = qRound(time / 10000.0 / m_duration);
+        if (percent != m_previousPercent) {
+            setProgress(percent);
+            m_previousPercent = percent;
+        }
+    }
+    m_progressBuffer.remove(0, start);
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2016-2022 Meltytech, LLC
+ * Copyright (c) 2016-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -39,12 +39,14 @@ public slots:
 private slots:
     void onOpenTriggered();
     void onReadyRead();
+    void onProgressReady();
 
 private:
     QStringList m_args;
     double m_duration;
     int m_previousPercent;
     bool m_isOpenLog;
+    QByteArray m_progressBuffer;
 };
 
 #endif // FFMPEGJOB_H
@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frameexportjob.h"
+
+#include "Logger.h"
+#include "executors.h"
+#include "mltcontroller.h"
+#include "util.h"
+
+#include <QAction>
+#include <QApplication>
+#include <QFileInfo>
+#include <QImage>
+#include <QPointer>
+
+#include <algorithm>
+
+static bool saveFrame(const QImage &image, const QString &filePath, QString &log)
+{
+    const bool isWebp = QFileInfo(filePath).suffix().toLower() == "webp";
+    if (image.isNull()) {
+        log = QStringLiteral("Failed to render \"%1\"\n").arg(filePath);
+        return false;
+    }
+    if (!image.save(filePath, nullptr, isWebp ? 80 : -1)) {
+        log = QStringLiteral("Failed to save \"%1\"\n").arg(filePath);
+        return false;
+    }
+    log = QStringLiteral("Saved \"%1\"\n").arg(filePath);
+    return true;
+}
+
+FrameExportJob::FrameExportJob(const QString &xml, const QList<Frame> &frames)
+    : AbstractJob(tr("Export %n frames", nullptr, frames.size()))
+    , m_xml(xml)
+    , m_frames(frames)
+    , m_finished(0)
+    , m_isFailed(false)
+    , m_isStopped(std::make_shared<std::atomic<bool>>(false))
+{
+    // Visit the positions in order so that the decoders read forward.
+    std::stable_sort(m_frames.begin(), m_frames.end(), [](const Frame &a, const Frame &b) {
+        return a.position < b.position;
+    });
+    if (!m_frames.isEmpty())
+        setTarget(m_frames.first().filePath);
+
+    QAction *action = new QAction(tr("Show In Folder"), this);
+    action->setToolTip(tr("Show In Folder"));
+    connect(action, &QAction::triggered, this, &FrameExportJob::onShowFolderTriggered);
+    m_successActions << action;
+}
+
+FrameExportJob::~FrameExportJob()
+{
+    LOG_DEBUG() << "FrameExportJob destroyed";
+}
+
+void FrameExportJob::start()
+{
+    AbstractJob::start();
+    m_finished = 0;
+    m_isFailed = false;
+    m_isStopped->store(false);
+    if (m_frames.isEmpty()) {
+        onFinished(0);
+        return;
+    }
+
+    const Mlt::Profile &project = MLT.profile();
+    const int frameRateNum = project.frame_rate_num();
+    const int frameRateDen = project.frame_rate_den();
+    const int width = project.width();
+    const int height = project.height();
+    const int progressive = project.progressive();
+    const int sarNum = project.sample_aspect_num();
+    const int sarDen = project.sample_aspect_den();
+    const int darNum = project.display_aspect_num();
+    const int darDen = project.display_aspect_den();
+    const int colorspace = project.colorspace();
+    // Save square pixels like the Export Frame dialog does.
+    const int imageWidth = qRound(height * project.dar());
+    const auto xml = m_xml;
+    const auto frames = m_frames;
+    auto isStopped = m_isStopped;
+    QPointer<FrameExportJob> job(this);
+
+    Executors::start(Executors::AnalysisExecutor, [=]() {
+        auto report = [job](bool isSuccess, const QString &log) {
+            QMetaObject::invokeMethod(
+                qApp,
+                [=]() {
+                    if (job)
+                        job->onFrameFinished(isSuccess, log);
+                },
+                Qt::QueuedConnection);
+        };
+        Mlt::Profile profile;
+        profile.set_frame_rate(frameRateNum, frameRateDen);
+        profile.set_width(width);
+        profile.set_height(height);
+        profile.set_progressive(progressive);
+        profile.set_sample_aspect(sarNum, sarDen);
+        profile.set_display_aspect(darNum, darDen);
+        profile.set_colorspace(colorspace);
+        profile.set_explicit(true);
+        Mlt::Producer producer(profile, "xml-string", xml.toUtf8().constData());
+        const bool isValid = producer.is_valid();
+        if (!isValid)
+            LOG_ERROR() << "failed to load the producer to export frames";
+
+        for (const auto &frame : frames) {
+            if (isStopped->load() || !isValid) {
+                report(false, QString());
+                continue;
+            }
+            QImage image = MLT.image(producer, frame.position, imageWidth, height);
+            const auto filePath = frame.filePath;
+            auto encode = [=]() {
+                QString log;
+                const bool isSuccess = saveFrame(image, filePath, log);
+                report(isSuccess, log);
+            };
+            // Encode here when the pool is busy so that frames do not pile up.
+            if (!Executors::tryStart(Executors::AnalysisExecutor, encode))
+                encode();
+        }
+    });
+}
+
+void FrameExportJob::stop()
+{
+    m_isStopped->store(true);
+    AbstractJob::stop();
+}
+
+void FrameExportJob::onFrameFinished(bool isSuccess, const QString &log)
+{
+    if (!log.isEmpty())
+        appendToLog(log);
+    if (!isSuccess)
+        m_isFailed = true;
+    ++m_finished;
+    if (m_finished < m_frames.size()) {
+        setProgress(m_finished * 100 / m_frames.size());
+    } else {
+        LOG_DEBUG() << "exported" << m_frames.size() << "frames" << (m_isFailed ? "with errors" : "");
+        onFinished(m_isFailed ? 1 : 0);
+    }
+}
+
+void FrameExportJob::onShowFolderTriggered()
+{
+    Util::showInFolder(target());
+}
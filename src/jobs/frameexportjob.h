@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef FRAMEEXPORTJOB_H
+#define FRAMEEXPORTJOB_H
+
+#include "abstractjob.h"
+
+#include <QList>
+#include <QString>
+
+#include <atomic>
+#include <memory>
+
+/*!
+  \class FrameExportJob
+  \brief Saves the frames at many positions of a producer as image files.
+
+  One copy of the producer is loaded from \a xml on the analysis pool and
+  visits the positions in order, so that the decoders mostly read forward
+  instead of seeking for every frame. Each rendered frame is encoded on
+  another thread of the pool when one is free, or else by the thread that
+  rendered it, which also keeps the number of frames in memory small. The
+  format comes from the extension of each file.
+*/
+
+class FrameExportJob : public AbstractJob
+{
+    Q_OBJECT
+public:
+    struct Frame
+    {
+        int position;
+        QString filePath;
+    };
+
+    FrameExportJob(const QString &xml, const QList<Frame> &frames);
+    virtual ~FrameExportJob();
+    void start();
+    void stop();
+
+private slots:
+    void onFrameFinished(bool isSuccess, const QString &log);
+    void onShowFolderTriggered();
+
+private:
+    QString m_xml;
+    QList<Frame> m_frames;
+    int m_finished;
+    bool m_isFailed;
+    std::shared_ptr<std::atomic<bool>> m_isStopped;
+};
+
+#endif // FRAMEEXPORTJOB_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2022 Meltytech, LLC
+ * Copyright (c) 2022-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -31,6 +31,7 @@ GoPro2GpxJob::GoPro2GpxJob(const QString &name, const QStringList &args)
     : AbstractJob(name)
 {
     m_args.append(args);
+    setResourceClass(DiskResource);
     setLabel(QStringLiteral("%1 %2").arg(tr("Export GPX"), Util::baseName(name)));
 }
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 #include "htmlgeneratorjob.h"
 
 #include "Logger.h"
+#include "jobqueue.h"
 #include "mainwindow.h"
 #include "mltcontroller.h"
 #include "settings.h"
@@ -32,6 +33,10 @@
 #include <QStandardPaths>
 #include <QTemporaryFile>
 
+// Do not start another browser for fewer frames than this.
+static const int kMinShardFrames = 30;
+static const int kDebuggingPort = 9222;
+
 static double fps()
 {
     return std::min(15.0, MLT.profile().fps());
@@ -46,8 +51,7 @@ HtmlGeneratorJob::HtmlGeneratorJob(const QString &name,
     , m_html(html)
     , m_outputPath(outputPath)
     , m_duration(duration)
-    , m_generator(nullptr)
-    , m_isGeneratingFrames(true)
+    , m_currentShard(0)
     , m_previousPercent(0)
 {
     setTarget(outputPath);
@@ -84,51 +88,46 @@ void HtmlGeneratorJob::start()
     htmlFile.flush();
     htmlFile.close();
 
-    // Create HTML generator for animation
-    m_generator = new HtmlGenerator(this);
-
-    // Set animation parameters: fps, duration in milliseconds
-    m_generator->setAnimationParameters(fps(), m_duration);
-
-    connect(m_generator,
-            &HtmlGenerator::imageReady,
-            this,
-            &HtmlGeneratorJob::onAnimationFramesReady);
-    connect(m_generator,
-            &HtmlGenerator::progressUpdate,
-            this,
-            &HtmlGeneratorJob::onHtmlGeneratorProgress);
+    // Create an HTML generator for each range of frames, one per encode slot of
+    // the job queue, each with its own browser.
+    const int totalFrames = HtmlGenerator::frameCount(fps(), m_duration);
+    const int shardCount = qBound(1,
+                                  JobQueue::jobSlots(resourceClass()),
+                                  qMax(1, totalFrames / kMinShardFrames));
+    const int shardLength = (totalFrames + shardCount - 1) / shardCount;
+    m_shards.clear();
+    m_currentShard = 0;
+    for (int i = 0; i == 0 || i * shardLength < totalFrames; ++i) {
+        Shard shard;
+        shard.generator = new HtmlGenerator(this);
+        shard.first = i * shardLength;
+        // Set animation parameters: fps, duration in milliseconds
+        shard.generator->setAnimationParameters(fps(), m_duration);
+        shard.generator->setFrameRange(shard.first, shardLength);
+        shard.generator->setDebuggingPort(kDebuggingPort + i);
+        connect(shard.generator, &HtmlGenerator::frameReady, this, [=](const QByteArray &png) {
+            onShardFrameReady(i, png);
+        });
+        connect(shard.generator, &HtmlGenerator::imageReady, this, [=]() {
+            onShardFinished(i);
+        });
+        m_shards << shard;
+    }
 
     const QString url("file://" + m_htmlFilePath);
     const QSize size(qRound(MLT.profile().width() * MLT.profile().sar()), MLT.profile().height());
 
-    // Start the animation capture
-    AbstractJob::start();
-    m_isGeneratingFrames = true;
-
-    m_generator->launchBrowser(Settings.chromiumPath(), url, size, m_tempDir->path());
-
-    LOG_DEBUG() << "Started HTML animation generation:" << url;
-}
-
-void HtmlGeneratorJob::onAnimationFramesReady()
-{
-    LOG_DEBUG() << "Animation frames ready, starting FFmpeg conversion";
-    m_isGeneratingFrames = false;
-    emit progressUpdated(m_item, 80); // Frames generation is done
-
-    // Clean up the generator
-    if (m_generator) {
-        m_generator->deleteLater();
-        m_generator = nullptr;
-    }
-
-    // Now start FFmpeg process
+    // Start FFmpeg first to encode the frames as they are piped in.
     const auto shotcutPath = qApp->applicationDirPath();
     const QFileInfo ffmpegPath(shotcutPath, "ffmpeg");
 
     QStringList args;
-    args << "-r" << QString::number(fps()) << "-i" << m_tempDir->path() + "/frame_%04d.png"
+    args << "-f"
+         << "image2pipe"
+         << "-framerate" << QString::number(fps()) << "-codec:v"
+         << "png"
+         << "-i"
+         << "pipe:0"
          << "-codec:v"
          << "utvideo"
          << "-pix_fmt"
@@ -137,17 +136,67 @@ void HtmlGeneratorJob::onAnimationFramesReady()
 
     setReadChannel(QProcess::StandardError);
     LOG_DEBUG() << ffmpegPath.absoluteFilePath() + " " + args.join(' ');
-
-    // Start FFmpeg process (this will call AbstractJob::start with program and args)
     AbstractJob::start(ffmpegPath.absoluteFilePath(), args);
+
+    // Start the animation capture
+    for (const auto &shard : std::as_const(m_shards))
+        shard.generator->launchBrowser(Settings.chromiumPath(), url, size, m_tempDir->path());
+
+    LOG_DEBUG() << "Started HTML animation generation:" << url << "in" << m_shards.size()
+                << "ranges";
 }
 
-void HtmlGeneratorJob::onReadyRead()
+void HtmlGeneratorJob::onShardFrameReady(int index, const QByteArray &png)
 {
-    if (m_isGeneratingFrames) {
-        return; // Don't process FFmpeg output during frame generation
+    auto &shard = m_shards[index];
+    if (index == m_currentShard) {
+        if (state() == QProcess::Running)
+            write(png);
+    } else {
+        // Keep the frame until the ranges before this one are piped.
+        QFile file(shardFramePath(shard.first + shard.received));
+        if (!file.open(QIODevice::WriteOnly) || file.write(png) != png.size())
+            LOG_ERROR() << "Failed to save frame:" << file.errorString();
     }
+    ++shard.received;
+}
+
+void HtmlGeneratorJob::onShardFinished(int index)
+{
+    auto &shard = m_shards[index];
+    shard.isDone = true;
+    // Clean up the generator
+    if (shard.generator) {
+        shard.generator->deleteLater();
+        shard.generator = nullptr;
+    }
+
+    while (m_currentShard < m_shards.size() && m_shards[m_currentShard].isDone) {
+        if (++m_currentShard == m_shards.size())
+            break;
+        // Pipe the frames that the next range captured while waiting.
+        const auto &next = m_shards[m_currentShard];
+        for (int i = 0; i < next.received; ++i) {
+            QFile file(shardFramePath(next.first + i));
+            if (file.open(QIODevice::ReadOnly) && state() == QProcess::Running)
+                write(file.readAll());
+            file.remove();
+        }
+    }
+    if (m_currentShard == m_shards.size()) {
+        LOG_DEBUG() << "Animation frames ready, finishing FFmpeg conversion";
+        // FFmpeg finishes when its input ends.
+        closeWriteChannel();
+    }
+}
 
+QString HtmlGeneratorJob::shardFramePath(int frame) const
+{
+    return QDir(m_tempDir->path()).filePath(QString("frame_%1.png").arg(frame, 5, 10, QChar('0')));
+}
+
+void HtmlGeneratorJob::onReadyRead()
+{
     // Process FFmpeg output for progress reporting
     QString msg;
     do {
@@ -163,8 +212,8 @@ void HtmlGeneratorJob::onReadyRead()
             const auto match = frameRegex.match(msg);
             if (match.hasMatch()) {
                 int currentFrame = match.captured(1).toInt();
-                int totalFrames = qRound((m_duration / 1000.0) * fps());
-                int percent = 80 + qRound((currentFrame * 80.0) / totalFrames); // 80-100%
+                int totalFrames = qMax(1, qRound((m_duration / 1000.0) * fps()));
+                int percent = qMin(99, qRound((currentFrame * 100.0) / totalFrames));
                 if (percent != m_previousPercent) {
                     emit progressUpdated(m_item, percent);
                     m_previousPercent = percent;
@@ -174,15 +223,6 @@ void HtmlGeneratorJob::onReadyRead()
     } while (!msg.isEmpty());
 }
 
-void HtmlGeneratorJob::onHtmlGeneratorProgress(float progress)
-{
-    if (m_isGeneratingFrames) {
-        // Map 0.0-1.0 to 0-80%
-        const auto percent = qRound(progress * 80.0);
-        emit progressUpdated(m_item, percent);
-    }
-}
-
 void HtmlGeneratorJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
     AbstractJob::onFinished(exitCode, exitStatus);
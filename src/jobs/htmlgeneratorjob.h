@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -40,18 +40,30 @@ protected slots:
     void onReadyRead() override;
 
 private slots:
-    void onAnimationFramesReady();
-    void onHtmlGeneratorProgress(float progress);
     void onOpenTriggered();
 
 private:
+    // A range of frames captured by its own browser
+    struct Shard
+    {
+        HtmlGenerator *generator = nullptr; // owned via parent QObject
+        int first = 0;
+        int received = 0;
+        bool isDone = false;
+    };
+
+    void onShardFrameReady(int index, const QByteArray &png);
+    void onShardFinished(int index);
+    QString shardFramePath(int frame) const;
+
     QString m_html;
     QString m_outputPath;
     int m_duration;
-    HtmlGenerator *m_generator; // owned via parent QObject
+    QList<Shard> m_shards;
+    // The shard whose frames are piped into FFmpeg as they are captured
+    int m_currentShard;
     std::unique_ptr<QTemporaryDir> m_tempDir;
     QString m_htmlFilePath;
-    bool m_isGeneratingFrames;
     int m_previousPercent;
 };
 
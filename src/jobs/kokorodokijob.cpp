@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -48,6 +48,7 @@ KokorodokiJob::KokorodokiJob(const QString &inputFile,
     , m_speed(speed)
 {
     setTarget(outputFile);
+    setResourceClass(NetworkResource);
     QAction *action = new QAction(tr("Open"), this);
     action->setData("Open");
     connect(action, &QAction::triggered, this, [this]() { onOpenTriggered(); });
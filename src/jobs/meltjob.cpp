@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,7 +19,10 @@
 
 #include "Logger.h"
 #include "dialogs/textviewerdialog.h"
+#include "jobqueue.h"
 #include "mainwindow.h"
+#include "mltcontroller.h"
+#include "settings.h"
 #include "util.h"
 
 #include <QAction>
@@ -29,8 +32,21 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QIODevice>
+#include <QSet>
 #include <QTimer>
 
+// The render nodes that run a job now
+static QSet<QString> &busyNodes()
+{
+    static QSet<QString> nodes;
+    return nodes;
+}
+
+static QString shellQuote(QString s)
+{
+    return "'" + s.replace("'", "'\\''") + "'";
+}
+
 MeltJob::MeltJob(const QString &name,
                  const QString &xml,
                  int frameRateNum,
@@ -147,15 +163,38 @@ void MeltJob::start()
     if (m_out > -1) {
         args << QStringLiteral("out=%1").arg(m_out);
     }
+    if (m_isRemote) {
+        for (const auto &node : Settings.jobRenderNodes()) {
+            if (!busyNodes().contains(node) && !m_failedNodes.contains(node)) {
+                m_node = node;
+                break;
+            }
+        }
+    }
+    showNode();
+    if (!m_node.isEmpty()) {
+        // ssh passes one command line to the shell of the node.
+        busyNodes().insert(m_node);
+        QStringList command{"melt"};
+        for (const auto &arg : std::as_const(args))
+            command << shellQuote(arg);
+        LOG_DEBUG() << m_node << command.join(' ');
+        appendToLog(QStringLiteral("Rendering on %1\n").arg(m_node));
+        AbstractJob::start("ssh", {"-o", "BatchMode=yes", m_node, command.join(' ')});
+        return;
+    }
     LOG_DEBUG() << meltPath.absoluteFilePath() + " " + args.join(' ');
-#ifndef Q_OS_MAC
     QProcessEnvironment env = QProcessEnvironment::systemEnvironment();
+#ifndef Q_OS_MAC
     // These environment variables fix rich text rendering for high DPI
     // fractional or otherwise.
     env.insert("QT_AUTO_SCREEN_SCALE_FACTOR", "1");
     env.insert("QT_SCALE_FACTOR_ROUNDING_POLICY", "PassThrough");
-    setProcessEnvironment(env);
 #endif
+    // Hardware decoding is only for the player.
+    env.remove(MLT_HWACCEL_NAME);
+    env.remove(MLT_HWACCEL_DEVICE_NAME);
+    setProcessEnvironment(env);
 #ifdef Q_OS_WIN
     if (m_isStreaming)
         args << "-getc";
@@ -198,33 +237,57 @@ void MeltJob::onViewXmlTriggered()
     dialog.exec();
 }
 
+void MeltJob::showNode()
+{
+    if (!m_item || !m_item->model())
+        return;
+    auto item = m_item->model()->item(m_item->row(), JobQueue::COLUMN_OUTPUT);
+    if (item)
+        item->setText(m_node.isEmpty() ? label() : tr("%1 on %2").arg(label(), m_node));
+}
+
 void MeltJob::onReadyRead()
 {
-    QString msg;
-    do {
-        msg = readLine();
-        int index = msg.indexOf("Frame:");
+    // melt writes a progress line per frame, so parse the bytes and append
+    // the other lines to the log at once.
+    QByteArray log;
+    while (canReadLine()) {
+        const QByteArray line = readLine();
+        int index = line.indexOf("Frame:");
         if (index > -1) {
             index += 6;
-            int comma = msg.indexOf(',', index);
-            m_currentFrame = msg.mid(index, comma - index).toInt();
+            int comma = line.indexOf(',', index);
+            m_currentFrame = line.mid(index, comma - index).trimmed().toInt();
         }
-        index = msg.indexOf("percentage:");
+        index = line.indexOf("percentage:");
         if (index > -1) {
-            int percent = msg.mid(index + 11).toInt();
+            int percent = line.mid(index + 11).trimmed().toInt();
             if (percent > 0 && percent != m_previousPercent) {
-                emit progressUpdated(m_item, percent);
-                QCoreApplication::processEvents();
+                setProgress(percent);
                 m_previousPercent = percent;
             }
         } else {
-            appendToLog(msg);
+            log.append(line);
         }
-    } while (!msg.isEmpty());
+    }
+    if (!log.isEmpty())
+        appendToLog(QString::fromUtf8(log));
 }
 
 void MeltJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 {
+    if (!m_node.isEmpty()) {
+        busyNodes().remove(m_node);
+        if ((exitStatus != QProcess::NormalExit || exitCode != 0) && !stopped()) {
+            LOG_WARNING() << "render node" << m_node << "failed with" << exitCode;
+            appendToLog(QStringLiteral("Failed on %1, trying again\n").arg(m_node));
+            m_failedNodes << m_node;
+            m_node.clear();
+            start();
+            return;
+        }
+        m_node.clear();
+    }
     AbstractJob::onFinished(exitCode, exitStatus);
     if (exitStatus != QProcess::NormalExit && exitCode != 0 && !stopped()) {
         Mlt::Producer producer(m_profile, "colour:");
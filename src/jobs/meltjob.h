@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -44,6 +44,16 @@ public:
     void setIsStreaming(bool streaming);
     void setUseMultiConsumer(bool multi = true);
     void setInAndOut(int in, int out);
+    int in() const { return m_in; }
+    int out() const { return m_out; }
+    bool useMultiConsumer() const { return m_useMultiConsumer; }
+    /*!
+      Renders on a free node of the render nodes setting over SSH. A node must
+      have melt and the same paths to the files. A failed render is tried
+      again on another node and at last locally.
+    */
+    void setRemote(bool remote = true) { m_isRemote = remote; }
+    bool isRemote() const { return m_isRemote; }
 
 public slots:
     void start() override;
@@ -68,6 +78,11 @@ private:
     bool m_useMultiConsumer;
     int m_in{-1};
     int m_out{-1};
+    bool m_isRemote{false};
+    QString m_node;
+    QStringList m_failedNodes;
+
+    void showNode();
 };
 
 #endif // MELTJOB_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2024 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,10 +20,15 @@
 #include "Logger.h"
 #include "docks/playlistdock.h"
 #include "docks/subtitlesdock.h"
+#include "docks/timelinedock.h"
 #include "mainwindow.h"
+#include "mltcontroller.h"
+#include "proxymanager.h"
 #include "shotcut_mlt_properties.h"
 
+#include <QDir>
 #include <QFile>
+#include <QUndoStack>
 
 // For file time functions in FilePropertiesPostJobAction::doAction();
 #include <sys/stat.h>
@@ -59,6 +64,12 @@ void OpenPostJobAction::doAction()
     MAIN.playlistDock()->onAppendCutActionTriggered();
 }
 
+void OpenReplayPostJobAction::doAction()
+{
+    QDir(m_replayPath).removeRecursively();
+    MAIN.open(m_dstFile);
+}
+
 void ReplaceOnePostJobAction::doAction()
 {
     FilePropertiesPostJobAction::doAction();
@@ -109,6 +120,50 @@ void ProxyReplacePostJobAction::doAction()
     }
 }
 
+void IntraCacheReplacePostJobAction::doAction()
+{
+    FilePropertiesPostJobAction::doAction();
+    QFileInfo info(m_dstFile);
+    QString newFileName = info.path() + "/" + info.baseName() + "." + info.suffix();
+    QFile::remove(newFileName);
+    if (!QFile::rename(m_dstFile, newFileName)) {
+        LOG_WARNING() << "failed to rename" << m_dstFile << "as" << newFileName;
+        QFile::remove(m_dstFile);
+        return;
+    }
+    Mlt::Producer newProducer(MLT.profile(), newFileName.toUtf8().constData());
+    if (newProducer.is_valid()) {
+        Mlt::Producer *producer = MLT.setupNewProducer(&newProducer);
+        producer->set(kIsProxyProperty, 1);
+        producer->set(kIntraCacheProperty, 1);
+        producer->set(kOriginalResourceProperty, m_srcFile.toUtf8().constData());
+        // Only the timewarp clips use the cache, and only the timeline has them in bulk.
+        if (MAIN.isMultitrackValid())
+            MAIN.timelineDock()->replaceClipsWithHash(m_hash, *producer, true);
+        delete producer;
+    } else {
+        LOG_WARNING() << "intra-frame cache file is invalid" << newFileName;
+        QFile::remove(newFileName);
+    }
+}
+
+void MediaCacheReplacePostJobAction::doAction()
+{
+    Mlt::Producer newProducer(MLT.profile(), m_dstFile.toUtf8().constData());
+    if (newProducer.is_valid()) {
+        Mlt::Producer *producer = MLT.setupNewProducer(&newProducer);
+        producer->set(kIsProxyProperty, 1);
+        producer->set(kMediaCacheProperty, 1);
+        producer->set(kOriginalResourceProperty, m_srcFile.toUtf8().constData());
+        MAIN.replaceAllByHash(m_hash, *producer, true);
+        delete producer;
+        ProxyManager::trimMediaCache(m_dstFile);
+    } else {
+        LOG_WARNING() << "media cache file is invalid" << m_dstFile;
+        QFile::remove(m_dstFile);
+    }
+}
+
 void ProxyFinalizePostJobAction::doAction()
 {
     FilePropertiesPostJobAction::doAction();
@@ -124,3 +179,23 @@ void ImportSrtPostJobAction::doAction()
 {
     m_dock->importSrtFromFile(m_srtFile, m_trackName, m_lang, m_includeNonspoken);
 }
+
+void AudioTrackPostJobAction::doAction()
+{
+    Mlt::Producer producer(MLT.profile(), m_fileName.toUtf8().constData());
+    if (!producer.is_valid()) {
+        LOG_ERROR() << "failed to open" << m_fileName;
+        return;
+    }
+    if (!MAIN.multitrack()) {
+        MAIN.open(m_fileName);
+        return;
+    }
+    auto timeline = MAIN.timelineDock();
+    MAIN.undoStack()->beginMacro(QObject::tr("Add %1 to the timeline").arg(m_trackName));
+    const int trackIndex = timeline->addAudioTrack();
+    if (!m_trackName.isEmpty())
+        timeline->setTrackName(trackIndex, m_trackName);
+    timeline->overwrite(trackIndex, m_position, MLT.XML(&producer), false);
+    MAIN.undoStack()->endMacro();
+}
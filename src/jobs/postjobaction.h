@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2024 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -58,6 +58,21 @@ private:
     QString m_fileNameToRemove;
 };
 
+class OpenReplayPostJobAction : public PostJobAction
+{
+public:
+    OpenReplayPostJobAction(const QString &dstFile, const QString &replayPath)
+        : m_dstFile(dstFile)
+        , m_replayPath(replayPath)
+    {}
+    virtual ~OpenReplayPostJobAction() {}
+    void doAction();
+
+private:
+    QString m_dstFile;
+    QString m_replayPath;
+};
+
 class ReplaceOnePostJobAction : public FilePropertiesPostJobAction
 {
 public:
@@ -109,6 +124,43 @@ private:
     QString m_hash;
 };
 
+class IntraCacheReplacePostJobAction : public FilePropertiesPostJobAction
+{
+public:
+    IntraCacheReplacePostJobAction(const QString &srcFile,
+                                   const QString &dstFile,
+                                   const QString &srcHash)
+        : FilePropertiesPostJobAction(srcFile, dstFile)
+        , m_srcFile(srcFile)
+        , m_dstFile(dstFile)
+        , m_hash(srcHash)
+    {}
+    void doAction();
+
+private:
+    QString m_srcFile;
+    QString m_dstFile;
+    QString m_hash;
+};
+
+class MediaCacheReplacePostJobAction : public PostJobAction
+{
+public:
+    MediaCacheReplacePostJobAction(const QString &srcFile,
+                                   const QString &dstFile,
+                                   const QString &srcHash)
+        : m_srcFile(srcFile)
+        , m_dstFile(dstFile)
+        , m_hash(srcHash)
+    {}
+    void doAction();
+
+private:
+    QString m_srcFile;
+    QString m_dstFile;
+    QString m_hash;
+};
+
 class ProxyFinalizePostJobAction : public FilePropertiesPostJobAction
 {
 public:
@@ -149,4 +201,25 @@ protected:
     SubtitlesDock *m_dock;
 };
 
+/*!
+  Puts an audio file on a new audio track of the timeline at \a position in
+  one undo step, or opens it when there is no timeline.
+*/
+class AudioTrackPostJobAction : public PostJobAction
+{
+public:
+    AudioTrackPostJobAction(const QString &fileName, const QString &trackName, int position)
+        : m_fileName(fileName)
+        , m_trackName(trackName)
+        , m_position(position)
+    {}
+    virtual ~AudioTrackPostJobAction() {}
+    void doAction();
+
+protected:
+    const QString m_fileName;
+    const QString m_trackName;
+    const int m_position;
+};
+
 #endif // POSTJOBACTION_H
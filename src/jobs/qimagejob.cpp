@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2022 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,53 +17,172 @@
 
 #include "qimagejob.h"
 
+#include "Logger.h"
+#include "database.h"
+#include "executors.h"
+#include "models/playlistmodel.h"
+#include "postjobaction.h"
 #include "util.h"
 
+#include <QApplication>
+#include <QFile>
 #include <QImage>
 #include <QImageReader>
-#include <QRunnable>
-#include <QtConcurrent/QtConcurrent>
+#include <QPainter>
+#include <QPointer>
 
-QImageJob::QImageJob(const QString &destFilePath, const QString &srcFilePath, const int height)
-    : AbstractJob(srcFilePath)
-    , m_srcFilePath(srcFilePath)
-    , m_destFilePath(destFilePath)
+static QImage readScaled(QImageReader &reader, int height)
+{
+    // Asking for the size up front lets the JPEG reader scale in the DCT.
+    QSize size = reader.size();
+    if (size.isValid() && height > 0) {
+        const bool isTransposed = reader.transformation() & QImageIOHandler::TransformationRotate90;
+        const int displayHeight = isTransposed ? size.width() : size.height();
+        if (displayHeight > height) {
+            const qreal scale = qreal(height) / displayHeight;
+            reader.setScaledSize(QSize(qMax(1, qRound(size.width() * scale)),
+                                       qMax(1, qRound(size.height() * scale))));
+        }
+    }
+    QImage image = reader.read();
+    if (!image.isNull() && image.height() != height)
+        image = image.scaledToHeight(height, Qt::SmoothTransformation);
+    return image;
+}
+
+static QImage makeThumbnail(const QImage &image)
+{
+    // Like the thumbnail decoders, letterbox into the thumbnail size.
+    const int width = PlaylistModel::THUMBNAIL_WIDTH * 2;
+    const int height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
+    QImage result(width, height, QImage::Format_RGB32);
+    result.fill(Qt::black);
+    const QImage scaled = image.scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    QPainter painter(&result);
+    painter.drawImage((width - scaled.width()) / 2, (height - scaled.height()) / 2, scaled);
+    return result;
+}
+
+QImageJob::QImageJob(const int height)
+    : AbstractJob(QString())
     , m_height(height)
+    , m_finished(0)
+    , m_isFailed(false)
+    , m_isStopped(std::make_shared<std::atomic<bool>>(false))
 {
-    setTarget(destFilePath);
-    setLabel(tr("Make proxy for %1").arg(Util::baseName(srcFilePath)));
+    setResourceClass(DiskResource);
+}
+
+QImageJob::QImageJob(const QString &destFilePath, const QString &srcFilePath, const int height)
+    : QImageJob(height)
+{
+    addImage(destFilePath, srcFilePath);
 }
 
 QImageJob::~QImageJob()
 {
-    if (m_destFilePath.contains("proxies") && m_destFilePath.contains(".pending.")) {
-        QFile::remove(m_destFilePath);
+    for (const auto &image : m_images) {
+        if (image.destFilePath.contains("proxies") && image.destFilePath.contains(".pending.")) {
+            QFile::remove(image.destFilePath);
+        }
     }
 }
 
+void QImageJob::addImage(const QString &destFilePath,
+                         const QString &srcFilePath,
+                         PostJobAction *action,
+                         const QString &thumbnailKey)
+{
+    Image image;
+    image.srcFilePath = srcFilePath;
+    image.destFilePath = destFilePath;
+    image.action.reset(action);
+    image.thumbnailKey = thumbnailKey;
+    m_images << image;
+    if (target().isEmpty())
+        setTarget(destFilePath);
+    updateLabel();
+}
+
+void QImageJob::updateLabel()
+{
+    if (m_images.size() == 1)
+        setLabel(tr("Make proxy for %1").arg(Util::baseName(m_images.first().srcFilePath)));
+    else
+        setLabel(tr("Make proxies for %n images", nullptr, m_images.size()));
+}
+
 void QImageJob::start()
 {
     AbstractJob::start();
-    auto result = QtConcurrent::run([=]() {
-        appendToLog(QStringLiteral("Reading source image \"%1\"\n").arg(m_srcFilePath));
-        QImageReader reader;
-        reader.setAutoTransform(true);
-        reader.setDecideFormatFromContent(true);
-        reader.setFileName(m_srcFilePath);
-        QImage image(reader.read());
-        if (!image.isNull()) {
-            image = image.scaledToHeight(m_height, Qt::SmoothTransformation);
-            if (image.save(m_destFilePath)) {
-                appendToLog(
-                    QStringLiteral("Successfully saved image as \"%1\"\n").arg(m_destFilePath));
-                QMetaObject::invokeMethod(this, "onFinished", Qt::QueuedConnection, Q_ARG(int, 0));
-            } else {
-                appendToLog(QStringLiteral("Failed to save image as \"%1\"\n").arg(m_destFilePath));
-                QMetaObject::invokeMethod(this, "onFinished", Qt::QueuedConnection, Q_ARG(int, 1));
+    m_finished = 0;
+    m_isFailed = false;
+    m_isStopped->store(false);
+    QPointer<QImageJob> job(this);
+    for (int i = 0; i < m_images.size(); ++i) {
+        const auto src = m_images[i].srcFilePath;
+        const auto dest = m_images[i].destFilePath;
+        const bool isThumbnail = !m_images[i].thumbnailKey.isEmpty();
+        const int height = m_height;
+        auto isStopped = m_isStopped;
+        Executors::start(Executors::AnalysisExecutor, [=]() {
+            QString log;
+            bool isSuccess = false;
+            QImage thumbnail;
+            if (!isStopped->load()) {
+                log += QStringLiteral("Reading source image \"%1\"\n").arg(src);
+                QImageReader reader;
+                reader.setAutoTransform(true);
+                reader.setDecideFormatFromContent(true);
+                reader.setFileName(src);
+                QImage image = readScaled(reader, height);
+                if (image.isNull()) {
+                    log += QStringLiteral("Failed to read source image \"%1\"\n").arg(src);
+                } else if (image.save(dest)) {
+                    log += QStringLiteral("Successfully saved image as \"%1\"\n").arg(dest);
+                    isSuccess = true;
+                    if (isThumbnail)
+                        thumbnail = makeThumbnail(image);
+                } else {
+                    log += QStringLiteral("Failed to save image as \"%1\"\n").arg(dest);
+                }
             }
-        } else {
-            appendToLog(QStringLiteral("Failed to read source image \"%1\"\n").arg(m_srcFilePath));
-            QMetaObject::invokeMethod(this, "onFinished", Qt::QueuedConnection, Q_ARG(int, 1));
-        }
-    });
+            QMetaObject::invokeMethod(
+                qApp,
+                [=]() {
+                    if (!job)
+                        return;
+                    if (!thumbnail.isNull())
+                        DB.putThumbnail(job->m_images[i].thumbnailKey, thumbnail);
+                    job->onImageFinished(i, isSuccess, log);
+                },
+                Qt::QueuedConnection);
+        });
+    }
+}
+
+void QImageJob::stop()
+{
+    m_isStopped->store(true);
+    AbstractJob::stop();
+}
+
+void QImageJob::onImageFinished(int index, bool isSuccess, const QString &log)
+{
+    appendToLog(log);
+    auto &image = m_images[index];
+    if (isSuccess && !stopped()) {
+        image.isDone = true;
+        if (image.action)
+            image.action->doAction();
+    } else {
+        m_isFailed = true;
+    }
+    ++m_finished;
+    if (m_finished < m_images.size()) {
+        setProgress(m_finished * 100 / m_images.size());
+    } else {
+        LOG_DEBUG() << "made" << m_images.size() << "images" << (m_isFailed ? "with errors" : "");
+        onFinished(m_isFailed ? 1 : 0);
+    }
 }
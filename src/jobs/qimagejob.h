@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,21 +20,60 @@
 
 #include "abstractjob.h"
 
+#include <QList>
 #include <QSize>
 
+#include <atomic>
+#include <memory>
+
+/*!
+  \class QImageJob
+  \brief Scales one or a batch of still images to a height.
+
+  The images are decoded in parallel on the analysis pool. Each is asked of
+  the reader at about the final size, so that the JPEG reader decodes it at
+  1/2, 1/4 or 1/8 scale in the DCT rather than at full size. The action of
+  each image runs as soon as it is saved, and an image with a thumbnail key
+  also puts its thumbnail in the database from the same decode.
+*/
+
 class QImageJob : public AbstractJob
 {
     Q_OBJECT
 public:
+    //! Makes an empty batch to which addImage() adds the images.
+    explicit QImageJob(const int height);
     QImageJob(const QString &destFilePath, const QString &srcFilePath, const int height);
     virtual ~QImageJob();
+    //! Adds an image to a job that has not started; the job owns \a action.
+    void addImage(const QString &destFilePath,
+                  const QString &srcFilePath,
+                  PostJobAction *action = nullptr,
+                  const QString &thumbnailKey = QString());
+    int count() const { return m_images.size(); }
     void start();
-    void execute();
+    void stop();
+
+private slots:
+    void onImageFinished(int index, bool isSuccess, const QString &log);
 
 private:
-    QString m_srcFilePath;
-    QString m_destFilePath;
+    struct Image
+    {
+        QString srcFilePath;
+        QString destFilePath;
+        std::shared_ptr<PostJobAction> action;
+        QString thumbnailKey;
+        bool isDone = false;
+    };
+
+    void updateLabel();
+
+    QList<Image> m_images;
     int m_height;
+    int m_finished;
+    bool m_isFailed;
+    std::shared_ptr<std::atomic<bool>> m_isStopped;
 };
 
 #endif // QIMAGEJOB_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -38,6 +38,12 @@
 #include <QDBusPendingReply>
 #endif
 
+// The recording is split in segments of this length to only keep the last ones.
+static const int kReplaySegmentSeconds = 10;
+static const char *kReplayListFileName = "segments.ffconcat";
+// Screen areas larger than this use the fastest software preset.
+static const int kLargeCapturePixels = 1920 * 1080;
+
 ScreenCaptureJob::ScreenCaptureJob(const QString &name,
                                    const QString &filename,
                                    const QRect &captureRect,
@@ -90,6 +96,9 @@ void ScreenCaptureJob::start()
     }
 #endif
     QString vcodec("libx264");
+    // A larger queue keeps the capture from dropping frames while the encoder is busy.
+    args << "-thread_queue_size"
+         << "1024";
     args << "-f"
 #ifdef Q_OS_WIN
          << "gdigrab";
@@ -100,6 +109,8 @@ void ScreenCaptureJob::start()
     args << "-i"
          << "desktop";
     if (m_recordAudio) {
+        args << "-thread_queue_size"
+             << "1024";
         args << "-f"
              << "dshow";
         args << "-i"
@@ -124,6 +135,8 @@ void ScreenCaptureJob::start()
     args << "-i"
          << ":0.0";
     if (m_recordAudio) {
+        args << "-thread_queue_size"
+             << "1024";
         args << "-f"
              << "pulse";
         args << "-i" << Settings.audioInput();
@@ -149,8 +162,9 @@ void ScreenCaptureJob::start()
                  << "vaapi=vaapi0:";
             args << "-filter_hw_device"
                  << "vaapi0";
+            // Upload the captured RGB and convert it on the GPU.
             args << "-vf"
-                 << "format=nv12,hwupload";
+                 << "hwupload,scale_vaapi=format=nv12";
             args << "-quality"
                  << "1";
             args << "-rc_mode"
@@ -161,7 +175,8 @@ void ScreenCaptureJob::start()
         args << "-crf"
              << "18";
         args << "-preset"
-             << "veryfast";
+             << (qint64(m_rect.width()) * m_rect.height() > kLargeCapturePixels ? "ultrafast"
+                                                                                 : "veryfast");
         args << "-tune"
              << "film";
         args << "-pix_fmt"
@@ -186,7 +201,10 @@ void ScreenCaptureJob::start()
          << "bt709";
     args << "-colorspace"
          << "bt709";
-    args << "-y" << m_filename;
+    if (Settings.screenCaptureReplay())
+        appendReplayOutput(args);
+    else
+        args << "-y" << m_filename;
     QString shotcutPath = qApp->applicationDirPath();
     QFileInfo ffmpegPath(shotcutPath, "ffmpeg");
     setReadChannel(QProcess::StandardError);
@@ -271,6 +289,7 @@ void ScreenCaptureJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
 
                 FfmpegJob *remuxJob = new FfmpegJob(m_filename, args, false);
                 remuxJob->setLabel(tr("Remux %1").arg(fileInfo.fileName()));
+                remuxJob->setResourceClass(DiskResource);
                 remuxJob->setPostJobAction(
                     new OpenPostJobAction(inputFileName, m_filename, inputFileName));
                 JOBS.add(remuxJob);
@@ -287,6 +306,13 @@ void ScreenCaptureJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
         exitStatus = QProcess::NormalExit;
     }
 #endif
+    if (!m_replayPath.isEmpty()) {
+        // The concatenated segments open when done.
+        m_isAutoOpen = false;
+        AbstractJob::onFinished(exitCode, exitStatus);
+        concatReplay();
+        return;
+    }
     AbstractJob::onFinished(exitCode, exitStatus);
 
     if (m_isAutoOpen && exitCode == 0 && QFileInfo::exists(m_filename)) {
@@ -296,6 +322,64 @@ void ScreenCaptureJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
     }
 }
 
+void ScreenCaptureJob::appendReplayOutput(QStringList &args)
+{
+    // Write rolling segments next to the file and keep a list of the last ones,
+    // so that the disk only holds a little more than the replay length.
+    const QFileInfo fileInfo(m_filename);
+    m_replayPath = fileInfo.path() + "/" + fileInfo.completeBaseName() + "-replay";
+    QDir replayDir(m_replayPath);
+    replayDir.removeRecursively();
+    replayDir.mkpath(".");
+    const int segmentCount = Settings.screenCaptureReplayMinutes() * 60 / kReplaySegmentSeconds
+                             + 1;
+    LOG_INFO() << "keeping the last" << segmentCount << "segments in" << m_replayPath;
+
+    if (m_recordAudio) {
+        args << "-codec:a"
+             << "aac";
+    }
+    args << "-f"
+         << "segment";
+    args << "-segment_time" << QString::number(kReplaySegmentSeconds);
+    args << "-segment_format"
+         << "matroska";
+    args << "-reset_timestamps"
+         << "1";
+    args << "-segment_list" << replayDir.filePath(kReplayListFileName);
+    args << "-segment_list_type"
+         << "ffconcat";
+    args << "-segment_list_size" << QString::number(segmentCount);
+    // The segment being written is not in the list yet, so do not reuse a listed one.
+    args << "-segment_wrap" << QString::number(segmentCount + 1);
+    args << "-y" << replayDir.filePath("segment-%03d.mkv");
+}
+
+void ScreenCaptureJob::concatReplay()
+{
+    const QString listFileName = QDir(m_replayPath).filePath(kReplayListFileName);
+    if (!QFileInfo::exists(listFileName)) {
+        LOG_WARNING() << "no replay segments in" << m_replayPath;
+        QDir(m_replayPath).removeRecursively();
+        return;
+    }
+    QStringList args;
+    args << "-f"
+         << "concat";
+    args << "-safe"
+         << "0";
+    args << "-i" << listFileName;
+    args << "-c"
+         << "copy";
+    args << "-y" << m_filename;
+
+    FfmpegJob *concatJob = new FfmpegJob(m_filename, args, false);
+    concatJob->setLabel(tr("Save Replay %1").arg(QFileInfo(m_filename).fileName()));
+    concatJob->setResourceClass(DiskResource);
+    concatJob->setPostJobAction(new OpenReplayPostJobAction(m_filename, m_replayPath));
+    JOBS.add(concatJob);
+}
+
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
 bool ScreenCaptureJob::startWaylandRecording()
 {
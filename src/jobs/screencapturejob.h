@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -47,6 +47,8 @@ private slots:
 #endif
 
 private:
+    void appendReplayOutput(QStringList &args);
+    void concatReplay();
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
     enum DBusService { None, GNOME, KDE };
     bool startWaylandRecording();
@@ -59,6 +61,8 @@ private:
     bool m_isAutoOpen;
     bool m_recordAudio;
     QTimer m_progressTimer;
+    // The folder of the segments that keep the end of the recording
+    QString m_replayPath;
 #if defined(Q_OS_UNIX) && !defined(Q_OS_MAC)
     DBusService m_dbusService = DBusService::None;
 #endif
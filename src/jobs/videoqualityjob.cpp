@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2024 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,6 +17,7 @@
 
 #include "videoqualityjob.h"
 
+#include "Logger.h"
 #include "dialogs/textviewerdialog.h"
 #include "mainwindow.h"
 
@@ -25,14 +26,19 @@
 #include <QDomDocument>
 #include <QFile>
 #include <QFileInfo>
+#include <QMap>
+#include <QRegularExpression>
 #include <QTextStream>
 #include <QUrl>
 
+#include <cmath>
+
 VideoQualityJob::VideoQualityJob(const QString &name,
                                  const QString &xml,
                                  const QString &reportPath,
                                  int frameRateNum,
-                                 int frameRateDen)
+                                 int frameRateDen,
+                                 const QString &outputPath)
     : MeltJob(name, xml, frameRateNum, frameRateDen)
     , m_reportPath(reportPath)
 {
@@ -55,7 +61,66 @@ VideoQualityJob::VideoQualityJob(const QString &name,
     m_successActions << action;
 
     setLabel(tr("Measure %1").arg(objectName()));
-    setStandardOutputFile(reportPath);
+    // A segment of a measurement writes its own part of the report.
+    setStandardOutputFile(outputPath.isEmpty() ? reportPath : outputPath);
+}
+
+bool VideoQualityJob::mergeReports(const QStringList &partPaths, const QString &reportPath)
+{
+    // The vqm transition prints a frame number and then the Y, Cb and Cr
+    // PSNR and SSIM of each frame.
+    static const QRegularExpression kSeparators("[\\s|]+");
+    static const int kValueCount = 6;
+    QString header;
+    QMap<int, QString> lines;
+    double sums[kValueCount] = {};
+    int counts[kValueCount] = {};
+    for (const auto &path : partPaths) {
+        QFile part(path);
+        if (!part.open(QIODevice::ReadOnly | QIODevice::Text)) {
+            LOG_WARNING() << "failed to read" << path;
+            continue;
+        }
+        while (!part.atEnd()) {
+            const auto line = QString::fromUtf8(part.readLine()).trimmed();
+            const auto fields = line.split(kSeparators, Qt::SkipEmptyParts);
+            bool isFrame = false;
+            const int frame = fields.isEmpty() ? 0 : fields[0].toInt(&isFrame);
+            if (!isFrame || fields.size() <= kValueCount) {
+                if (header.isEmpty() && !line.isEmpty())
+                    header = line;
+                continue;
+            }
+            lines.insert(frame, line);
+            for (int i = 0; i < kValueCount; ++i) {
+                const double value = fields[i + 1].toDouble();
+                if (std::isfinite(value)) {
+                    sums[i] += value;
+                    ++counts[i];
+                }
+            }
+        }
+        part.close();
+        QFile::remove(path);
+    }
+
+    QFile report(reportPath);
+    if (!report.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        LOG_ERROR() << "failed to write" << reportPath;
+        return false;
+    }
+    QTextStream stream(&report);
+    if (!header.isEmpty())
+        stream << header << "\n";
+    for (const auto &line : lines)
+        stream << line << "\n";
+    stream << "\naverage";
+    for (int i = 0; i < kValueCount; ++i) {
+        const double average = counts[i] ? sums[i] / counts[i] : 0.0;
+        stream << ' ' << QString::number(average, 'f', i % 2 ? 3 : 2);
+    }
+    stream << "\n" << lines.size() << " frames measured\n";
+    return true;
 }
 
 void VideoQualityJob::onOpenTiggered()
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2018 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -28,7 +28,15 @@ public:
                     const QString &xml,
                     const QString &reportPath,
                     int frameRateNum,
-                    int frameRateDen);
+                    int frameRateDen,
+                    const QString &outputPath = QString());
+
+    /*!
+      Joins the frame lines of the reports in \a partPaths in frame order and
+      appends their averages, writes them to \a reportPath, and removes the
+      parts.
+    */
+    static bool mergeReports(const QStringList &partPaths, const QString &reportPath);
 
 private slots:
     void onOpenTiggered();
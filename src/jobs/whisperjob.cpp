@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,12 +20,148 @@
 #include "Logger.h"
 #include "dialogs/textviewerdialog.h"
 #include "mainwindow.h"
+#include "models/subtitles.h"
+#include "util.h"
+#include "whisperserver.h"
 
 #include <QApplication>
 #include <QDir>
 #include <QFileInfo>
 #include <QThread>
 #include <QTimer>
+#include <QVector>
+#include <QtEndian>
+
+#include <cstring>
+
+// A chunk boundary moves to the quietest moment within this distance.
+static const int kSilenceSearchMs = 30000;
+// The length of the frames whose energy is compared to find silence
+static const int kSilenceFrameMs = 30;
+// The number of frames averaged, so that a pause between words is preferred
+// over a single quiet frame.
+static const int kSilenceFrameCount = 10;
+
+namespace {
+
+// The 16-bit PCM audio in a WAV file
+struct WavInfo
+{
+    qint64 dataOffset = 0;
+    qint64 sampleCount = 0;
+    int sampleRate = 0;
+    int channels = 0;
+};
+
+} // namespace
+
+static bool readWavInfo(QFile &file, WavInfo &info)
+{
+    const QByteArray header = file.read(12);
+    if (header.size() < 12 || !header.startsWith("RIFF") || header.mid(8, 4) != "WAVE")
+        return false;
+    int bitsPerSample = 0;
+    for (;;) {
+        const QByteArray chunk = file.read(8);
+        if (chunk.size() < 8)
+            return false;
+        const qint64 size = qFromLittleEndian<quint32>(chunk.constData() + 4);
+        if (chunk.startsWith("fmt ")) {
+            const QByteArray format = file.read(size);
+            if (format.size() < 16 || qFromLittleEndian<quint16>(format.constData()) != 1)
+                return false;
+            info.channels = qFromLittleEndian<quint16>(format.constData() + 2);
+            info.sampleRate = qFromLittleEndian<quint32>(format.constData() + 4);
+            bitsPerSample = qFromLittleEndian<quint16>(format.constData() + 14);
+        } else if (chunk.startsWith("data")) {
+            if (bitsPerSample != 16 || info.channels < 1 || info.sampleRate < 1)
+                return false;
+            info.dataOffset = file.pos();
+            // The size is not final if the file was not closed properly.
+            const qint64 available = file.size() - info.dataOffset;
+            info.sampleCount = qMin(size, available) / (2 * info.channels);
+            return true;
+        } else if (!file.seek(file.pos() + size)) {
+            return false;
+        }
+        // Chunks are padded to an even size.
+        if (size & 1)
+            file.seek(file.pos() + 1);
+    }
+}
+
+// Returns the sample near \a sample where the audio is quietest.
+static qint64 findSilence(QFile &file, const WavInfo &info, qint64 sample)
+{
+    const qint64 frameSize = qint64(info.sampleRate) * kSilenceFrameMs / 1000;
+    const qint64 radius = qint64(info.sampleRate) * kSilenceSearchMs / 1000;
+    const qint64 first = qMax<qint64>(0, sample - radius);
+    const qint64 last = qMin(info.sampleCount, sample + radius);
+    const int frameCount = (last - first) / frameSize;
+    if (frameCount < kSilenceFrameCount)
+        return sample;
+    const qint64 bytesPerSample = 2 * info.channels;
+    if (!file.seek(info.dataOffset + first * bytesPerSample))
+        return sample;
+    const QByteArray data = file.read(frameCount * frameSize * bytesPerSample);
+    const auto samples = reinterpret_cast<const qint16 *>(data.constData());
+    const qint64 valueCount = data.size() / 2;
+
+    QVector<double> energy(frameCount);
+    for (int i = 0; i < frameCount; ++i) {
+        double sum = 0.0;
+        const qint64 end = qMin(valueCount, (i + 1) * frameSize * info.channels);
+        for (qint64 j = i * frameSize * info.channels; j < end; ++j) {
+            const double value = qFromLittleEndian(samples[j]);
+            sum += value * value;
+        }
+        energy[i] = sum;
+    }
+    double window = 0.0;
+    for (int i = 0; i < kSilenceFrameCount; ++i)
+        window += energy[i];
+    double best = window;
+    int bestFrame = 0;
+    for (int i = kSilenceFrameCount; i < frameCount; ++i) {
+        window += energy[i] - energy[i - kSilenceFrameCount];
+        if (window < best) {
+            best = window;
+            bestFrame = i - kSilenceFrameCount + 1;
+        }
+    }
+    return first + (bestFrame + kSilenceFrameCount / 2) * frameSize;
+}
+
+static bool writeWav(QFile &in, const WavInfo &info, qint64 from, qint64 to, QFile &out)
+{
+    const qint64 bytesPerSample = 2 * info.channels;
+    const quint32 dataSize = (to - from) * bytesPerSample;
+    char header[44];
+    memcpy(header, "RIFF", 4);
+    qToLittleEndian<quint32>(36 + dataSize, header + 4);
+    memcpy(header + 8, "WAVEfmt ", 8);
+    qToLittleEndian<quint32>(16, header + 16);
+    qToLittleEndian<quint16>(1, header + 20);
+    qToLittleEndian<quint16>(info.channels, header + 22);
+    qToLittleEndian<quint32>(info.sampleRate, header + 24);
+    qToLittleEndian<quint32>(info.sampleRate * bytesPerSample, header + 28);
+    qToLittleEndian<quint16>(bytesPerSample, header + 32);
+    qToLittleEndian<quint16>(16, header + 34);
+    memcpy(header + 36, "data", 4);
+    qToLittleEndian<quint32>(dataSize, header + 40);
+    if (out.write(header, sizeof(header)) != sizeof(header))
+        return false;
+    if (!in.seek(info.dataOffset + from * bytesPerSample))
+        return false;
+    qint64 remaining = dataSize;
+    while (remaining > 0) {
+        const QByteArray data = in.read(qMin<qint64>(remaining, 4 * 1024 * 1024));
+        if (data.isEmpty() || out.write(data) != data.size())
+            return false;
+        remaining -= data.size();
+    }
+    return true;
+}
 
 WhisperJob::WhisperJob(const QString &name,
                        const QString &iWavFile,
@@ -41,6 +177,13 @@ WhisperJob::WhisperJob(const QString &name,
     , m_translate(translate)
     , m_maxLength(maxLength)
     , m_previousPercent(0)
+    , m_chunkIndex(0)
+    , m_chunkCount(1)
+    , m_threadCount(0)
+    , m_chunkWavFile(nullptr)
+    , m_msChunkStart(0)
+    , m_msChunkEnd(-1)
+    , m_requestId(-1)
 {
     setTarget(oSrtFile);
 }
@@ -48,6 +191,18 @@ WhisperJob::WhisperJob(const QString &name,
 WhisperJob::~WhisperJob()
 {
     LOG_DEBUG() << "begin";
+    if (m_requestId >= 0) {
+        // Without the id, the callback does not touch this job.
+        const int id = m_requestId;
+        m_requestId = -1;
+        WHISPER.cancel(id);
+    }
+}
+
+void WhisperJob::setChunk(int index, int count)
+{
+    m_chunkIndex = index;
+    m_chunkCount = qMax(1, count);
 }
 
 void WhisperJob::start()
@@ -55,12 +210,38 @@ void WhisperJob::start()
     QString whisperPath = Settings.whisperExe();
     auto modelPath = Settings.whisperModel();
 
+    QString wavFile = m_iWavFile;
+    if (m_chunkCount > 1) {
+        if (!extractChunk()) {
+            AbstractJob::start();
+            appendToLog(QStringLiteral("Error: failed to read the audio chunk from %1\n")
+                            .arg(m_iWavFile));
+            QTimer::singleShot(0, this, [=]() { emit finished(this, false); });
+            return;
+        }
+        wavFile = m_chunkWavFile->fileName();
+    }
+
+    const bool isServer = !WhisperServer::program().isEmpty();
+#if QT_POINTER_SIZE == 4
+    // Limit to 1 rendering thread on 32-bit process to reduce memory usage.
+    auto threadCount = 1;
+#else
+    // The server runs one request at a time, so it gets all of the threads.
+    auto threadCount = m_threadCount > 0 && !isServer ? m_threadCount
+                                                      : qMax(1, QThread::idealThreadCount() - 1);
+#endif
+    if (isServer) {
+        startOnServer(wavFile, modelPath, threadCount);
+        return;
+    }
+
     setReadChannel(QProcess::StandardOutput);
     setProcessChannelMode(QProcess::MergedChannels);
     QString of = m_oSrtFile;
     of.remove(".srt");
     QStringList args;
-    args << "-f" << m_iWavFile;
+    args << "-f" << wavFile;
     args << "-m" << modelPath;
     args << "-l" << m_lang;
     if (m_translate) {
@@ -71,13 +252,6 @@ void WhisperJob::start()
     args << "-pp";
     args << "-ml" << QString::number(m_maxLength);
     args << "-sow";
-
-#if QT_POINTER_SIZE == 4
-    // Limit to 1 rendering thread on 32-bit process to reduce memory usage.
-    auto threadCount = 1;
-#else
-    auto threadCount = qMax(1, QThread::idealThreadCount() - 1);
-#endif
     args << "-t" << QString::number(threadCount);
 
     LOG_DEBUG() << whisperPath + " " + args.join(' ');
@@ -85,6 +259,46 @@ void WhisperJob::start()
     emit progressUpdated(m_item, 0);
 }
 
+void WhisperJob::stop()
+{
+    AbstractJob::stop();
+    if (m_requestId >= 0)
+        WHISPER.cancel(m_requestId);
+}
+
+void WhisperJob::startOnServer(const QString &wavFile, const QString &modelPath, int threadCount)
+{
+    AbstractJob::start();
+    WhisperServer::Fields fields;
+    fields << qMakePair(QStringLiteral("response_format"), QStringLiteral("srt"));
+    fields << qMakePair(QStringLiteral("language"), m_lang);
+    fields << qMakePair(QStringLiteral("translate"),
+                        QString::fromLatin1(m_translate ? "true" : "false"));
+    fields << qMakePair(QStringLiteral("max_len"), QString::number(m_maxLength));
+    fields << qMakePair(QStringLiteral("split_on_word"), QStringLiteral("true"));
+    appendToLog(QStringLiteral("Transcribing \"%1\" with the whisper server\n").arg(wavFile));
+    m_requestId = WHISPER.transcribe(
+        wavFile,
+        modelPath,
+        threadCount,
+        fields,
+        this,
+        [this](bool isSuccess, const QByteArray &srt, const QString &log) {
+            if (m_requestId < 0)
+                return;
+            m_requestId = -1;
+            appendToLog(log);
+            if (isSuccess && !stopped()) {
+                QFile file(m_oSrtFile);
+                if (!file.open(QIODevice::WriteOnly) || file.write(srt) != srt.size()) {
+                    appendToLog(QStringLiteral("Error: failed to write %1\n").arg(m_oSrtFile));
+                    isSuccess = false;
+                }
+            }
+            onFinished(isSuccess ? 0 : 1);
+        });
+}
+
 void WhisperJob::onViewSrtTriggered()
 {
     QFile srtFile(m_oSrtFile);
@@ -116,3 +330,66 @@ void WhisperJob::onReadyRead()
         }
     } while (!msg.isEmpty());
 }
+
+void WhisperJob::onFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    // Shift the subtitles before the post job action imports them.
+    if (m_chunkWavFile && exitStatus == QProcess::NormalExit && exitCode == 0 && !stopped()
+        && !shiftSrt()) {
+        appendToLog(QStringLiteral("Error: failed to update %1\n").arg(m_oSrtFile));
+        exitCode = 1;
+    }
+    delete m_chunkWavFile;
+    m_chunkWavFile = nullptr;
+    AbstractJob::onFinished(exitCode, exitStatus);
+}
+
+bool WhisperJob::extractChunk()
+{
+    QFile file(m_iWavFile);
+    WavInfo info;
+    if (!file.open(QIODevice::ReadOnly) || !readWavInfo(file, info))
+        return false;
+    // Each boundary depends only on the audio and not on the neighboring chunk,
+    // so adjacent chunks agree on where they meet.
+    auto boundary = [&](int index) -> qint64 {
+        if (index <= 0)
+            return 0;
+        if (index >= m_chunkCount)
+            return info.sampleCount;
+        return findSilence(file, info, info.sampleCount * index / m_chunkCount);
+    };
+    const qint64 from = boundary(m_chunkIndex);
+    const qint64 to = boundary(m_chunkIndex + 1);
+    if (to <= from)
+        return false;
+    m_msChunkStart = from * 1000 / info.sampleRate;
+    m_msChunkEnd = to * 1000 / info.sampleRate;
+
+    delete m_chunkWavFile;
+    m_chunkWavFile = Util::writableTemporaryFile(QFileInfo(m_iWavFile).path() + "/",
+                                                 "shotcut-XXXXXX.wav");
+    m_chunkWavFile->setParent(this);
+    if (!m_chunkWavFile->open() || !writeWav(file, info, from, to, *m_chunkWavFile))
+        return false;
+    m_chunkWavFile->close();
+    LOG_DEBUG() << "chunk" << m_chunkIndex + 1 << "of" << m_chunkCount << "from" << m_msChunkStart
+                << "to" << m_msChunkEnd << "ms";
+    return true;
+}
+
+bool WhisperJob::shiftSrt()
+{
+    const std::string path = m_oSrtFile.toUtf8().toStdString();
+    Subtitles::SubtitleVector items = Subtitles::readFromSrtFile(path);
+    Subtitles::SubtitleVector shifted;
+    shifted.reserve(items.size());
+    for (auto &item : items) {
+        item.start += m_msChunkStart;
+        // Keep the subtitles of a chunk from overlapping the next one.
+        item.end = qMin(item.end + m_msChunkStart, m_msChunkEnd);
+        if (item.end > item.start)
+            shifted.push_back(std::move(item));
+    }
+    return Subtitles::writeToSrtFile(path, shifted);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -35,20 +35,44 @@ public:
                QThread::Priority priority = Settings.jobPriority());
     virtual ~WhisperJob();
 
+    /*!
+      Transcribes only chunk \a index of \a count equal parts of the audio.
+      Each part is moved to the quietest moment near its nominal boundary so
+      that speech is not cut, and the subtitles are shifted to the time of the
+      part in the whole audio.
+    */
+    void setChunk(int index, int count);
+    //! Sets the number of whisper threads, or 0 for all but one core.
+    void setThreadCount(int threadCount) { m_threadCount = threadCount; }
+
 public slots:
     void start();
+    void stop();
     void onViewSrtTriggered();
 
 protected slots:
     void onReadyRead();
+    void onFinished(int exitCode, QProcess::ExitStatus exitStatus = QProcess::NormalExit);
 
 private:
+    //! Sends the audio to the shared whisper server instead of starting whisper-cli.
+    void startOnServer(const QString &wavFile, const QString &modelPath, int threadCount);
+    bool extractChunk();
+    bool shiftSrt();
+
     const QString m_iWavFile;
     const QString m_oSrtFile;
     const QString m_lang;
     const bool m_translate;
     const int m_maxLength;
     int m_previousPercent;
+    int m_chunkIndex;
+    int m_chunkCount;
+    int m_threadCount;
+    QTemporaryFile *m_chunkWavFile;
+    qint64 m_msChunkStart;
+    qint64 m_msChunkEnd;
+    int m_requestId;
 };
 
 #endif // WHISPERJOB_H
@@ -0,0 +1,268 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "whisperserver.h"
+
+#include "Logger.h"
+#include "settings.h"
+
+#include <QApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QHostAddress>
+#include <QHttpMultiPart>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QTcpServer>
+#include <QUrl>
+
+static const int kIdleTimeoutMs = 5 * 60 * 1000;
+// The tail of the server output that is kept to explain a failure
+static const int kMaxLogSize = 16 * 1024;
+
+WhisperServer::WhisperServer(QObject *parent)
+    : QObject(parent)
+    , m_network(new QNetworkAccessManager(this))
+    , m_reply(nullptr)
+    , m_threadCount(0)
+    , m_port(0)
+    , m_nextId(0)
+    , m_isReady(false)
+{
+    m_current.id = -1;
+    m_process.setProcessChannelMode(QProcess::MergedChannels);
+    connect(&m_process, &QProcess::readyRead, this, &WhisperServer::onReadyRead);
+    connect(&m_process, &QProcess::finished, this, &WhisperServer::onProcessFinished);
+    connect(&m_process, &QProcess::errorOccurred, this, [this](QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            onProcessFinished(-1, QProcess::CrashExit);
+    });
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(kIdleTimeoutMs);
+    connect(&m_idleTimer, &QTimer::timeout, this, [this]() {
+        if (!m_reply && m_queue.isEmpty()) {
+            LOG_INFO() << "stopping the idle whisper server";
+            stopServer();
+        }
+    });
+}
+
+WhisperServer &WhisperServer::singleton()
+{
+    // The application deletes it, which ends the server.
+    static WhisperServer *instance = new WhisperServer(qApp);
+    return *instance;
+}
+
+QString WhisperServer::program()
+{
+    QFileInfo cli(Settings.whisperExe());
+#if defined(Q_OS_WIN)
+    auto exe = "whisper-server.exe";
+#else
+    auto exe = "whisper-server";
+#endif
+    QFileInfo server(cli.dir(), exe);
+    return server.isExecutable() ? server.absoluteFilePath() : QString();
+}
+
+int WhisperServer::transcribe(const QString &wavFile,
+                              const QString &model,
+                              int threadCount,
+                              const Fields &fields,
+                              QObject *context,
+                              Callback callback)
+{
+    Request request;
+    request.id = m_nextId++;
+    request.wavFile = wavFile;
+    request.model = model;
+    request.threadCount = threadCount;
+    request.fields = fields;
+    request.context = context;
+    request.callback = callback;
+    m_queue << request;
+    startNext();
+    return request.id;
+}
+
+void WhisperServer::cancel(int id)
+{
+    for (int i = 0; i < m_queue.size(); ++i) {
+        if (m_queue[i].id == id) {
+            auto request = m_queue.takeAt(i);
+            finish(request, false, QByteArray(), QStringLiteral("Canceled\n"));
+            return;
+        }
+    }
+    if (m_reply && m_current.id == id)
+        m_reply->abort();
+}
+
+void WhisperServer::startNext()
+{
+    if (m_reply || m_queue.isEmpty())
+        return;
+    const auto &next = m_queue.first();
+    if (m_process.state() == QProcess::NotRunning) {
+        if (!startServer(next)) {
+            auto queue = m_queue;
+            m_queue.clear();
+            for (auto &request : queue)
+                finish(request, false, QByteArray(), "Error: failed to start whisper-server\n");
+        }
+        return;
+    }
+    // Wait for the server to listen, or for it to exit if it has another model.
+    if (!m_isReady)
+        return;
+    if (next.model != m_model || next.threadCount != m_threadCount) {
+        stopServer();
+        return;
+    }
+
+    m_idleTimer.stop();
+    m_current = m_queue.takeFirst();
+    auto file = new QFile(m_current.wavFile);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        finish(m_current,
+               false,
+               QByteArray(),
+               QStringLiteral("Error: failed to read %1\n").arg(m_current.wavFile));
+        startNext();
+        return;
+    }
+    auto multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    QHttpPart filePart;
+    filePart.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QStringLiteral("form-data; name=\"file\"; filename=\"%1\"")
+                           .arg(QFileInfo(m_current.wavFile).fileName()));
+    filePart.setBodyDevice(file);
+    file->setParent(multiPart);
+    multiPart->append(filePart);
+    for (const auto &field : m_current.fields) {
+        QHttpPart part;
+        part.setHeader(QNetworkRequest::ContentDispositionHeader,
+                       QStringLiteral("form-data; name=\"%1\"").arg(field.first));
+        part.setBody(field.second.toUtf8());
+        multiPart->append(part);
+    }
+    QNetworkRequest request(QUrl(QStringLiteral("http://127.0.0.1:%1/inference").arg(m_port)));
+    m_reply = m_network->post(request, multiPart);
+    multiPart->setParent(m_reply);
+    connect(m_reply, &QNetworkReply::finished, this, &WhisperServer::onReplyFinished);
+}
+
+bool WhisperServer::startServer(const Request &request)
+{
+    const auto program = WhisperServer::program();
+    if (program.isEmpty())
+        return false;
+    // Let the system choose a free port.
+    QTcpServer probe;
+    if (!probe.listen(QHostAddress::LocalHost, 0))
+        return false;
+    m_port = probe.serverPort();
+    probe.close();
+
+    m_model = request.model;
+    m_threadCount = request.threadCount;
+    m_isReady = false;
+    m_log.clear();
+    QStringList args;
+    args << "-m" << m_model;
+    args << "-t" << QString::number(m_threadCount);
+    args << "--host"
+         << "127.0.0.1";
+    args << "--port" << QString::number(m_port);
+    LOG_DEBUG() << program + " " + args.join(' ');
+    m_process.start(program, args);
+    return true;
+}
+
+void WhisperServer::stopServer()
+{
+    // The server keeps nothing that must be saved.
+    m_process.kill();
+}
+
+void WhisperServer::finish(Request &request,
+                           bool isSuccess,
+                           const QByteArray &data,
+                           const QString &log)
+{
+    auto callback = std::move(request.callback);
+    request.callback = nullptr;
+    if (request.context && callback)
+        callback(isSuccess, data, log);
+}
+
+void WhisperServer::onReadyRead()
+{
+    m_log.append(QString::fromUtf8(m_process.readAll()));
+    if (m_log.size() > kMaxLogSize)
+        m_log = m_log.right(kMaxLogSize);
+    if (!m_isReady && m_log.contains("listening")) {
+        LOG_INFO() << "whisper server is listening on port" << m_port;
+        m_isReady = true;
+        startNext();
+    }
+}
+
+void WhisperServer::onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus)
+{
+    LOG_INFO() << "whisper server exited with" << exitCode << exitStatus;
+    const bool wasReady = m_isReady;
+    m_isReady = false;
+    m_idleTimer.stop();
+    if (wasReady) {
+        // A request that was sent fails by its reply.
+        startNext();
+    } else {
+        // It could not load the model, so the requests waiting for it fail.
+        const auto log = QStringLiteral("Error: whisper-server exited\n") + m_log;
+        auto queue = m_queue;
+        m_queue.clear();
+        for (auto &request : queue)
+            finish(request, false, QByteArray(), log);
+    }
+}
+
+void WhisperServer::onReplyFinished()
+{
+    QNetworkReply *reply = m_reply;
+    m_reply = nullptr;
+    reply->deleteLater();
+    auto data = reply->readAll();
+    bool isSuccess = reply->error() == QNetworkReply::NoError;
+    QString log;
+    if (!isSuccess) {
+        log = QStringLiteral("Error: %1\n").arg(reply->errorString());
+    } else if (data.trimmed().startsWith("{\"error\"")) {
+        // The server reports a failed inference as JSON.
+        log = QString::fromUtf8(data) + '\n';
+        isSuccess = false;
+    }
+    finish(m_current, isSuccess, data, log);
+    m_current.id = -1;
+    if (m_queue.isEmpty())
+        m_idleTimer.start();
+    startNext();
+}
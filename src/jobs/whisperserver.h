@@ -0,0 +1,113 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WHISPERSERVER_H
+#define WHISPERSERVER_H
+
+#include <QList>
+#include <QObject>
+#include <QPair>
+#include <QPointer>
+#include <QProcess>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+/*!
+  \class WhisperServer
+  \brief Keeps one whisper.cpp server running to transcribe many files.
+
+  whisper-cli loads the model, which can be gigabytes, for every file it
+  transcribes. When whisper-server is beside it, the server is started on the
+  loopback interface with the first request and keeps the model loaded for
+  the next ones. The requests are sent one at a time since the server runs
+  them in turn anyway. The server exits after a few idle minutes, and is
+  started again when the model changes.
+*/
+
+class WhisperServer : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef QList<QPair<QString, QString>> Fields;
+    //! Receives whether it succeeded, the response, and what to log.
+    typedef std::function<void(bool, const QByteArray &, const QString &)> Callback;
+
+    static WhisperServer &singleton();
+    //! Returns the server program beside whisper-cli, or empty when there is none.
+    static QString program();
+
+    /*!
+      Queues the transcription of \a wavFile with the form \a fields and returns
+      its id. The \a callback runs once on the GUI thread unless \a context is
+      deleted before.
+    */
+    int transcribe(const QString &wavFile,
+                   const QString &model,
+                   int threadCount,
+                   const Fields &fields,
+                   QObject *context,
+                   Callback callback);
+    //! Ends a request; its callback runs with a failure if it has not already.
+    void cancel(int id);
+
+private slots:
+    void onReadyRead();
+    void onProcessFinished(int exitCode, QProcess::ExitStatus exitStatus);
+    void onReplyFinished();
+
+private:
+    explicit WhisperServer(QObject *parent = 0);
+
+    struct Request
+    {
+        int id;
+        QString wavFile;
+        QString model;
+        int threadCount;
+        Fields fields;
+        QPointer<QObject> context;
+        Callback callback;
+    };
+
+    void startNext();
+    bool startServer(const Request &request);
+    void stopServer();
+    void finish(Request &request, bool isSuccess, const QByteArray &data, const QString &log);
+
+    QProcess m_process;
+    QNetworkAccessManager *m_network;
+    QList<Request> m_queue;
+    Request m_current;
+    QNetworkReply *m_reply;
+    QTimer m_idleTimer;
+    QString m_model;
+    int m_threadCount;
+    int m_port;
+    int m_nextId;
+    bool m_isReady;
+    QString m_log;
+};
+
+#define WHISPER WhisperServer::singleton()
+
+#endif // WHISPERSERVER_H
@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "loopsplicer.h"
+
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+
+#include <memory>
+
+static const char *kLoopSplicerProperty = "_shotcut:loopSplicer";
+
+static mlt_frame process(mlt_filter filter, mlt_frame frame)
+{
+    auto properties = MLT_FILTER_PROPERTIES(filter);
+    auto producer = static_cast<mlt_producer>(
+        mlt_properties_get_data(properties, "_producer", nullptr));
+    const int start = mlt_properties_get_int(properties, "_start");
+    const int end = mlt_properties_get_int(properties, "_end");
+    // The producer has already moved on to the frame after this one.
+    if (producer && end > start + 1 && mlt_producer_get_speed(producer) > 0.0
+        && mlt_frame_get_position(frame) >= end - 1)
+        mlt_producer_seek(producer, start);
+    return frame;
+}
+
+bool LoopSplicer::setRange(Mlt::Producer &producer, int start, int end)
+{
+    if (!producer.is_valid())
+        return false;
+    std::unique_ptr<Mlt::Filter> filter;
+    for (int i = 0; i < producer.filter_count() && !filter; ++i) {
+        filter.reset(producer.filter(i));
+        if (filter && !filter->get_int(kLoopSplicerProperty))
+            filter.reset();
+    }
+    if (end < 0 || end <= start + 1) {
+        if (filter)
+            producer.detach(*filter);
+        return false;
+    }
+    if (!filter) {
+        auto mltFilter = mlt_filter_new();
+        if (!mltFilter)
+            return false;
+        mltFilter->process = process;
+        filter.reset(new Mlt::Filter(mltFilter));
+        mlt_filter_close(mltFilter);
+        // The XML consumer and the filter models skip the loader filters.
+        filter->set("_loader", 1);
+        filter->set(kShotcutHiddenProperty, 1);
+        filter->set(kLoopSplicerProperty, 1);
+        // The producer owns its filters, so it outlives this one.
+        filter->set("_producer", producer.get_producer(), 0);
+        producer.attach(*filter);
+    }
+    filter->set("_start", start);
+    filter->set("_end", end);
+    return true;
+}
@@ -0,0 +1,54 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef LOOPSPLICER_H
+#define LOOPSPLICER_H
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class LoopSplicer
+  \brief Plays a loop range without emptying the consumer at its end.
+
+  \threadsafe
+
+  Seeking back when the last frame of the loop is displayed purges the frames
+  that the consumer has already read past it, and the player waits while the
+  decoders seek and refill it. Instead, a hidden filter on the producer seeks
+  it back to the start of the loop as soon as the consumer reads the last
+  frame of the loop. The frames from the start of the loop then follow in the
+  queue of the consumer, which plays the frames before the end while the
+  decoders seek.
+*/
+
+class LoopSplicer
+{
+public:
+    /*!
+      Loops \a producer from \a end back to \a start while playing forward,
+      or stops looping it when \a end is negative. Returns whether the
+      producer loops by itself.
+    */
+    static bool setRange(Mlt::Producer &producer, int start, int end);
+
+private:
+    LoopSplicer() {}
+};
+
+#endif // LOOPSPLICER_H
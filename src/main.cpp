@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2024 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,8 +18,12 @@
 #include "ConsoleAppender.h"
 #include "FileAppender.h"
 #include "Logger.h"
+#include "benchmark.h"
+#include "headlessexport.h"
 #include "mainwindow.h"
+#include "mltcontroller.h"
 #include "settings.h"
+#include "startupprofile.h"
 
 #include <framework/mlt_log.h>
 #include <QCommandLineParser>
@@ -31,6 +35,8 @@
 #include <QtGlobal>
 #include <QtWidgets>
 
+#include <memory>
+
 #ifdef Q_OS_MAC
 #include "macos.h"
 #endif
@@ -74,6 +80,8 @@ static void mlt_log_handler(void *service, int mlt_level, const char *format, va
         cuteLoggerLevel = Logger::Warning;
         break;
     }
+    if (!cuteLogger->isLoggable(cuteLoggerLevel))
+        return;
     QString message;
     mlt_properties properties = service ? MLT_SERVICE_PROPERTIES((mlt_service) service) : NULL;
     if (properties) {
@@ -111,6 +119,13 @@ public:
     QTranslator shotcutTranslator;
     QStringList resourceArg;
     bool isFullScreen;
+    bool isBenchmark{false};
+    QString benchmarkPlaybackArg;
+    QString benchmarkRangeArg;
+    QString exportProjectArg;
+    QString exportPresetArg;
+    QString exportTargetArg;
+    int exportSegmentsArg{0};
     QString appDirArg;
 
     Application(int &argc, char **argv)
@@ -169,6 +184,47 @@ public:
                                              QCoreApplication::translate("main",
                                                                          "Clear Recent on Exit"));
         parser.addOption(clearRecentOption);
+        QCommandLineOption profileStartupOption(
+            "profile-startup",
+            QCoreApplication::translate("main", "Log the duration of each phase of startup."));
+        parser.addOption(profileStartupOption);
+        QCommandLineOption benchmarkOption(
+            "benchmark",
+            QCoreApplication::translate("main", "Log the speed of core operations and quit."));
+        parser.addOption(benchmarkOption);
+        QCommandLineOption benchmarkPlaybackOption(
+            "benchmark-playback",
+            QCoreApplication::translate("main",
+                                        "Play a project as fast as possible, print the speed as "
+                                        "JSON and quit."),
+            QCoreApplication::translate("main", "project"));
+        parser.addOption(benchmarkPlaybackOption);
+        QCommandLineOption rangeOption(
+            "range",
+            QCoreApplication::translate("main",
+                                        "The part of the project to play, like 00:10:00-00:12:00."),
+            QCoreApplication::translate("main", "start-end"));
+        parser.addOption(rangeOption);
+        QCommandLineOption exportOption(
+            "export",
+            QCoreApplication::translate("main",
+                                        "Export a project without showing a window and quit."),
+            QCoreApplication::translate("main", "project"));
+        parser.addOption(exportOption);
+        QCommandLineOption presetOption("preset",
+                                        QCoreApplication::translate("main",
+                                                                    "The export preset to use."),
+                                        QCoreApplication::translate("main", "name"));
+        parser.addOption(presetOption);
+        QCommandLineOption outOption("out",
+                                     QCoreApplication::translate("main", "The file to export."),
+                                     QCoreApplication::translate("main", "file"));
+        parser.addOption(outOption);
+        QCommandLineOption segmentsOption(
+            "segments",
+            QCoreApplication::translate("main", "How many segments to export in parallel."),
+            QCoreApplication::translate("main", "number"));
+        parser.addOption(segmentsOption);
         QCommandLineOption appDataOption(
             "appdata",
             QCoreApplication::translate("main", "The directory for app configuration and data."),
@@ -232,6 +288,25 @@ public:
 #endif
         setProperty("noupgrade", parser.isSet(noupgradeOption));
         setProperty("clearRecent", parser.isSet(clearRecentOption));
+        StartupProfile::setEnabled(parser.isSet(profileStartupOption));
+        isBenchmark = parser.isSet(benchmarkOption);
+        if (parser.isSet(benchmarkPlaybackOption)) {
+            benchmarkPlaybackArg = QFileInfo(QDir::currentPath(),
+                                             parser.value(benchmarkPlaybackOption))
+                                       .filePath();
+            benchmarkRangeArg = parser.value(rangeOption);
+        }
+        if (parser.isSet(exportOption)) {
+            exportProjectArg = QFileInfo(QDir::currentPath(), parser.value(exportOption))
+                                   .filePath();
+            exportPresetArg = parser.value(presetOption);
+            exportTargetArg = parser.value(outOption);
+            bool ok = true;
+            if (parser.isSet(segmentsOption))
+                exportSegmentsArg = parser.value(segmentsOption).toInt(&ok);
+            if (!ok)
+                exportSegmentsArg = -1;
+        }
         if (!parser.value(appDataOption).isEmpty()) {
             appDirArg = parser.value(appDataOption);
             ShotcutSettings::setAppDataForSession(appDirArg);
@@ -266,6 +341,10 @@ public:
 #else
         mlt_log_set_level(MLT_LOG_INFO);
 #endif
+        // The appenders drop trace records, so do not format them.
+        cuteLogger->setMinimumLevel(fileAppender->detailsLevel());
+        // Do not make worker and render threads wait on the log file.
+        cuteLogger->setAsync(true);
         mlt_log_set_callback(mlt_log_handler);
         cuteLogger->logToGlobalInstance("qml", true);
 
@@ -330,6 +409,7 @@ protected:
 
 int main(int argc, char **argv)
 {
+    StartupProfile::start();
 #if defined(Q_OS_WIN) && defined(QT_DEBUG) && !defined(__ARM_ARCH)
     ExcHndlInit();
 #endif
@@ -405,11 +485,15 @@ int main(int argc, char **argv)
     QCoreApplication::setAttribute(Qt::AA_DontCreateNativeWidgetSiblings);
 #endif
 
+    auto applicationPhase = std::make_unique<StartupProfile::Phase>("application");
     Application a(argc, argv);
+    applicationPhase.reset();
     int result = EXIT_SUCCESS;
 #ifdef Q_OS_WIN
     if (::qEnvironmentVariableIsSet("QSG_RHI_BACKEND")) {
 #endif
+        // Scan the MLT plugins while the rest of startup proceeds.
+        Mlt::Controller::initRepository();
         QSplashScreen splash(QPixmap(":/icons/shotcut-logo-320x320.png"));
 
         // Log some basic info.
@@ -427,57 +511,84 @@ int main(int argc, char **argv)
         LOG_INFO() << "install dir =" << a.applicationDirPath();
         Settings.log();
 
-        // Expire old items from the qmlcache
-        splash.showMessage(QCoreApplication::translate("main", "Expiring cache..."),
-                           Qt::AlignRight | Qt::AlignVCenter);
-        splash.show();
+        if (a.exportProjectArg.isEmpty())
+            splash.show();
         a.processEvents();
-        auto dir = QDir(
-            QStandardPaths::standardLocations(QStandardPaths::CacheLocation).constFirst());
-        if (dir.exists() && dir.cd("qmlcache")) {
-            auto ls = dir.entryList(QDir::Files | QDir::Readable | QDir::NoDotAndDotDot, QDir::Time);
-            if (qMax(0, ls.size() - kMaxCacheCount) > 0) {
-                LOG_INFO() << "removing" << qMax(0, ls.size() - kMaxCacheCount) << "from"
-                           << dir.path();
-            }
-            for (int i = kMaxCacheCount; i < ls.size(); i++) {
-                QString filePath = dir.filePath(ls[i]);
-                if (!QFile::remove(filePath)) {
-                    LOG_WARNING() << "failed to delete" << filePath;
+
+        // Expire old items from the qmlcache in the background.
+        QThreadPool::globalInstance()->start([]() {
+            StartupProfile::Phase phase("expire qmlcache");
+            auto dir = QDir(
+                QStandardPaths::standardLocations(QStandardPaths::CacheLocation).constFirst());
+            if (dir.exists() && dir.cd("qmlcache")) {
+                auto ls = dir.entryList(QDir::Files | QDir::Readable | QDir::NoDotAndDotDot,
+                                        QDir::Time);
+                if (qMax(0, ls.size() - kMaxCacheCount) > 0) {
+                    LOG_INFO() << "removing" << qMax(0, ls.size() - kMaxCacheCount) << "from"
+                               << dir.path();
                 }
-                if (i % 1000 == 0) {
-                    a.processEvents();
+                for (int i = kMaxCacheCount; i < ls.size(); i++) {
+                    QString filePath = dir.filePath(ls[i]);
+                    if (!QFile::remove(filePath)) {
+                        LOG_WARNING() << "failed to delete" << filePath;
+                    }
                 }
             }
-        }
+        });
 
         splash.showMessage(QCoreApplication::translate("main", "Loading plugins..."),
                            Qt::AlignRight | Qt::AlignVCenter);
         a.processEvents();
 
         a.setProperty("system-style", a.style()->objectName());
-        MainWindow::changeTheme(Settings.theme());
-        QQuickStyle::setStyle("Fusion");
+        {
+            StartupProfile::Phase phase("theme");
+            MainWindow::changeTheme(Settings.theme());
+            QQuickStyle::setStyle("Fusion");
+        }
 
-        a.mainWindow = &MAIN;
+        {
+            StartupProfile::Phase phase("main window");
+            a.mainWindow = &MAIN;
+        }
+        if (a.isBenchmark || !a.benchmarkPlaybackArg.isEmpty()) {
+            splash.close();
+            if (!a.benchmarkPlaybackArg.isEmpty())
+                return Benchmark::runPlayback(a.benchmarkPlaybackArg, a.benchmarkRangeArg);
+            return Benchmark::run();
+        }
+        if (!a.exportProjectArg.isEmpty()) {
+            return HeadlessExport::run(a.exportProjectArg,
+                                       a.exportPresetArg,
+                                       a.exportTargetArg,
+                                       a.exportSegmentsArg);
+        }
         if (!a.appDirArg.isEmpty())
             a.mainWindow->hideSetDataDirectory();
 #if defined(Q_OS_WIN) || defined(Q_OS_MAC)
         a.mainWindow->setProperty("windowOpacity", 0.0);
 #endif
-        a.mainWindow->show();
-        a.processEvents();
-        a.mainWindow->setFullScreen(a.isFullScreen);
-        splash.finish(a.mainWindow);
-
-        if (!a.resourceArg.isEmpty()) {
-            QStringList ls;
-            for (auto &s : a.resourceArg)
-                ls << QFileInfo(QDir::currentPath(), s).filePath();
-            a.mainWindow->openMultiple(ls);
-        } else {
-            a.mainWindow->open(a.mainWindow->untitledFileName());
+        {
+            StartupProfile::Phase phase("show");
+            a.mainWindow->show();
+            a.processEvents();
+            a.mainWindow->setFullScreen(a.isFullScreen);
+            splash.finish(a.mainWindow);
+        }
+
+        {
+            StartupProfile::Phase phase("open");
+            if (!a.resourceArg.isEmpty()) {
+                QStringList ls;
+                for (auto &s : a.resourceArg)
+                    ls << QFileInfo(QDir::currentPath(), s).filePath();
+                a.mainWindow->openMultiple(ls);
+            } else {
+                a.mainWindow->open(a.mainWindow->untitledFileName());
+            }
         }
+        // The first pass of the event loop is when the window becomes interactive.
+        QTimer::singleShot(0, &a, []() { StartupProfile::finish(); });
 
         result = a.exec();
 
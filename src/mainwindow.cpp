@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,6 +21,7 @@
 #include "Logger.h"
 #include "actions.h"
 #include "autosavefile.h"
+#include "avformatcache.h"
 #include "commands/playlistcommands.h"
 #include "controllers/filtercontroller.h"
 #include "controllers/scopecontroller.h"
@@ -28,6 +29,7 @@
 #include "defaultlayouts.h"
 #include "dialogs/actionsdialog.h"
 #include "dialogs/customprofiledialog.h"
+#include "dialogs/exportframesdialog.h"
 #include "dialogs/listselectiondialog.h"
 #include "dialogs/longuitask.h"
 #include "dialogs/resourcedialog.h"
@@ -35,6 +37,7 @@
 #include "dialogs/systemsyncdialog.h"
 #include "dialogs/textviewerdialog.h"
 #include "dialogs/unlinkedfilesdialog.h"
+#include "directoryscanner.h"
 #include "docks/encodedock.h"
 #include "docks/filesdock.h"
 #include "docks/filtersdock.h"
@@ -42,25 +45,38 @@
 #include "docks/jobsdock.h"
 #include "docks/keyframesdock.h"
 #include "docks/markersdock.h"
+#include "docks/multicamdock.h"
 #include "docks/notesdock.h"
+#include "docks/performancedock.h"
 #include "docks/playlistdock.h"
 #include "docks/recentdock.h"
 #include "docks/subtitlesdock.h"
 #include "docks/timelinedock.h"
+#include "executors.h"
+#include "frametrace.h"
 #include "jobqueue.h"
+#include "jobs/frameexportjob.h"
 #include "jobs/screencapturejob.h"
+#include "memorybudget.h"
 #include "models/audiolevelstask.h"
 #include "models/keyframesmodel.h"
 #include "models/motiontrackermodel.h"
+#include "models/scenedetecttask.h"
 #include "openotherdialog.h"
 #include "player.h"
+#include "projectarchive.h"
 #include "proxymanager.h"
 #include "qmltypes/qmlapplication.h"
 #include "qmltypes/qmlprofile.h"
 #include "qmltypes/qmlutilities.h"
 #include "screencapture/screencapture.h"
+#include "sequencereadahead.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "startupprofile.h"
+#include "thumbnaildecoderpool.h"
+#include "timelineclipboard.h"
+#include "titlecache.h"
 #include "util.h"
 #include "videowidget.h"
 #include "widgets/alsawidget.h"
@@ -88,6 +104,7 @@
 #include "widgets/toneproducerwidget.h"
 #include "widgets/trackpropertieswidget.h"
 #include "widgets/video4linuxwidget.h"
+#include "warmupscheduler.h"
 #if defined(Q_OS_WIN) && (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
 #include "windowstools.h"
 #endif
@@ -96,6 +113,8 @@
 #include <QClipboard>
 #include <QDirIterator>
 #include <QFileDialog>
+#include <QFontDatabase>
+#include <QFutureWatcher>
 #include <QImageReader>
 #include <QJSEngine>
 #include <QJsonDocument>
@@ -199,7 +218,10 @@ MainWindow::MainWindow()
     setupAndConnectUndoStack();
 
     // Add the player widget.
-    setupAndConnectPlayerWidget();
+    {
+        StartupProfile::Phase phase("player widget");
+        setupAndConnectPlayerWidget();
+    }
 
     setupSettingsMenu();
     setupOpenOtherMenu();
@@ -216,13 +238,22 @@ MainWindow::MainWindow()
 #endif
         delete ui->actionUpgrade;
 
-    setupAndConnectDocks();
+    {
+        StartupProfile::Phase phase("docks");
+        setupAndConnectDocks();
+    }
     setupMenuFile();
     setupMenuView();
     connectVideoWidgetSignals();
-    readWindowSettings();
-    setupActions();
-    setupLayoutSwitcher();
+    {
+        StartupProfile::Phase phase("layout");
+        readWindowSettings();
+    }
+    {
+        StartupProfile::Phase phase("actions");
+        setupActions();
+        setupLayoutSwitcher();
+    }
 
     setFocus();
     setCurrentFile("");
@@ -240,6 +271,12 @@ MainWindow::MainWindow()
     QThreadPool::globalInstance()->setThreadPriority(QThread::LowPriority);
     QImageReader::setAllocationLimit(1024);
 
+    // Warm up the font list the text editors need.
+    QThreadPool::globalInstance()->start([]() {
+        StartupProfile::Phase phase("font families");
+        QFontDatabase::families();
+    });
+
     ProxyManager::removePending();
 
     LOG_DEBUG() << "end";
@@ -299,6 +336,7 @@ void MainWindow::setupAndConnectUndoStack()
     ui->actionRedo->setToolTip(redoAction->toolTip());
     connect(m_undoStack, SIGNAL(canUndoChanged(bool)), ui->actionUndo, SLOT(setEnabled(bool)));
     connect(m_undoStack, SIGNAL(canRedoChanged(bool)), ui->actionRedo, SLOT(setEnabled(bool)));
+    connect(m_undoStack, &QUndoStack::indexChanged, this, [this]() { ++m_modifiedCount; });
 }
 
 void MainWindow::setupAndConnectPlayerWidget()
@@ -347,6 +385,7 @@ void MainWindow::setupAndConnectPlayerWidget()
     ui->menuPlayer->addAction(Actions["playerSetOutAction"]);
     ui->menuPlayer->addAction(Actions["playerSetPositionAction"]);
     ui->menuPlayer->addAction(Actions["playerToggleVui"]);
+    ui->menuPlayer->addAction(Actions["playerViewport360Action"]);
     ui->menuPlayer->addAction(Actions["playerSwitchSourceProgramAction"]);
 }
 
@@ -527,10 +566,14 @@ void MainWindow::setupAndConnectDocks()
     connect(m_timelineDock->model(), SIGNAL(created()), SLOT(onMultitrackCreated()));
     connect(m_timelineDock->model(), SIGNAL(closed()), SLOT(onMultitrackClosed()));
     connect(m_timelineDock->model(), SIGNAL(modified()), SLOT(onMultitrackModified()));
+    connect(m_timelineDock->model(),
+            &MultitrackModel::trackStateChanged,
+            this,
+            &MainWindow::markModified);
     connect(m_timelineDock->model(),
             &QAbstractItemModel::rowsInserted,
             m_playlistDock,
-            &PlaylistDock::refreshTimelineSmartBins);
+            &PlaylistDock::onTimelineRowsInserted);
     connect(m_timelineDock->model(),
             &QAbstractItemModel::rowsRemoved,
             m_playlistDock,
@@ -538,6 +581,29 @@ void MainWindow::setupAndConnectDocks()
     connect(m_timelineDock->model(), SIGNAL(durationChanged()), SLOT(onMultitrackDurationChanged()));
     connect(m_timelineDock, SIGNAL(clipOpened(Mlt::Producer *)), SLOT(openCut(Mlt::Producer *)));
     connect(m_timelineDock->model(), &MultitrackModel::seeked, this, &MainWindow::seekTimeline);
+    // The number of video tracks may change the proxy tier.
+    connect(m_timelineDock->model(), &MultitrackModel::created, this, &ProxyManager::updateTier);
+    // The open media follows the clips near the playhead.
+    connect(m_timelineDock->model(),
+            &MultitrackModel::modified,
+            &AvformatCache::singleton(),
+            &AvformatCache::schedule);
+    connect(m_timelineDock,
+            &TimelineDock::positionChanged,
+            &AvformatCache::singleton(),
+            &AvformatCache::setPosition);
+    // The thumbnails and waveforms fill from the playhead while the user is idle.
+    auto &warmup = WarmupScheduler::singleton();
+    warmup.setModel(m_timelineDock->model());
+    connect(m_timelineDock->model(), &MultitrackModel::created, &warmup, &WarmupScheduler::reset);
+    connect(m_timelineDock->model(),
+            &MultitrackModel::modified,
+            &warmup,
+            &WarmupScheduler::schedule);
+    connect(m_timelineDock, &TimelineDock::positionChanged, &warmup, &WarmupScheduler::setPosition);
+    connect(m_player, &Player::played, &warmup, &WarmupScheduler::pause);
+    connect(m_player, &Player::paused, &warmup, &WarmupScheduler::schedule);
+    connect(m_player, &Player::stopped, &warmup, &WarmupScheduler::schedule);
     connect(m_timelineDock->markersModel(), SIGNAL(modified()), SLOT(onMultitrackModified()));
     connect(m_timelineDock,
             SIGNAL(selected(Mlt::Producer *)),
@@ -553,6 +619,12 @@ void MainWindow::setupAndConnectDocks()
     connect(m_player, SIGNAL(previousSought()), m_timelineDock, SLOT(seekPreviousEdit()));
     connect(m_player, SIGNAL(nextSought()), m_timelineDock, SLOT(seekNextEdit()));
     connect(m_player, SIGNAL(loopChanged(int, int)), m_timelineDock, SLOT(onLoopChanged(int, int)));
+    connect(m_player, &Player::played, m_timelineDock->renderPreview(), &RenderPreview::install);
+    connect(m_player, &Player::paused, m_timelineDock->renderPreview(), &RenderPreview::uninstall);
+    connect(m_player, &Player::stopped, m_timelineDock->renderPreview(), &RenderPreview::uninstall);
+    connect(m_player, &Player::played, this, []() { JOBS.setPlaying(true); });
+    connect(m_player, &Player::paused, this, []() { JOBS.setPlaying(false); });
+    connect(m_player, &Player::stopped, this, []() { JOBS.setPlaying(false); });
     connect(m_timelineDock,
             SIGNAL(isRecordingChanged(bool)),
             m_player,
@@ -576,6 +648,9 @@ void MainWindow::setupAndConnectDocks()
     ui->menuTimeline->addAction(Actions["timelineRectangleSelectAction"]);
     ui->menuTimeline->addAction(Actions["timelineShowWaveformsAction"]);
     ui->menuTimeline->addAction(Actions["timelineShowThumbnailsAction"]);
+    ui->menuTimeline->addAction(Actions["timelineThumbnailStripAction"]);
+    ui->menuTimeline->addAction(Actions["timelineFastThumbnailsAction"]);
+    ui->menuTimeline->addAction(Actions["timelineThreadedRenderingAction"]);
     auto submenu = ui->menuTimeline->addMenu(tr("Scrolling"));
     auto *group = new QActionGroup(this);
     submenu->addAction(Actions["timelineScrollingCenterPlayhead"]);
@@ -629,6 +704,25 @@ void MainWindow::setupAndConnectDocks()
             SIGNAL(addedOrRemoved(Mlt::Producer *)),
             m_timelineDock->model(),
             SLOT(filterAddedOrRemoved(Mlt::Producer *)));
+    // Look for the titles that do not change after the filters or the timeline change.
+    connect(m_filterController->attachedModel(),
+            &AttachedFiltersModel::addedOrRemoved,
+            &TitleCache::singleton(),
+            &TitleCache::schedule);
+    connect(m_timelineDock->model(),
+            &MultitrackModel::modified,
+            &TitleCache::singleton(),
+            &TitleCache::schedule);
+    connect(this, &MainWindow::producerOpened, &TitleCache::singleton(), &TitleCache::schedule);
+    // Decode the image sequences of the player ahead of the consumer.
+    connect(m_timelineDock->model(),
+            &MultitrackModel::modified,
+            &SequenceReadAhead::singleton(),
+            &SequenceReadAhead::schedule);
+    connect(this,
+            &MainWindow::producerOpened,
+            &SequenceReadAhead::singleton(),
+            &SequenceReadAhead::schedule);
     connect(&QmlApplication::singleton(),
             SIGNAL(filtersPasted(Mlt::Producer *)),
             m_timelineDock->model(),
@@ -650,7 +744,7 @@ void MainWindow::setupAndConnectDocks()
     connect(m_timelineDock,
             SIGNAL(selected(Mlt::Producer *)),
             m_filterController,
-            SLOT(setProducer(Mlt::Producer *)));
+            SLOT(setSelectedProducer(Mlt::Producer *)));
     connect(m_player, SIGNAL(seeked(int)), m_filtersDock, SLOT(onSeeked(int)), Qt::QueuedConnection);
     connect(m_filtersDock, SIGNAL(seeked(int)), SLOT(seekKeyframes(int)));
     connect(MLT.videoWidget(),
@@ -834,6 +928,18 @@ void MainWindow::setupAndConnectDocks()
             SLOT(onJobsDockTriggered(bool)));
     connect(ui->actionJobs, SIGNAL(triggered()), this, SLOT(onJobsDockTriggered()));
 
+    m_performanceDock = new PerformanceDock(this);
+    m_performanceDock->hide();
+    ui->menuView->addAction(m_performanceDock->toggleViewAction());
+
+    m_multicamDock = new MulticamDock(m_timelineDock->model(), this);
+    m_multicamDock->hide();
+    ui->menuView->addAction(m_multicamDock->toggleViewAction());
+    connect(m_timelineDock,
+            &TimelineDock::positionChanged,
+            m_multicamDock,
+            &MulticamDock::setPosition);
+
     m_notesDock = new NotesDock(this);
     m_notesDock->hide();
     m_notesDock->toggleViewAction()->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_3));
@@ -886,6 +992,8 @@ void MainWindow::setupAndConnectDocks()
     addDockWidget(Qt::RightDockWidgetArea, m_historyDock);
     addDockWidget(Qt::LeftDockWidgetArea, m_encodeDock);
     addDockWidget(Qt::RightDockWidgetArea, m_jobsDock);
+    addDockWidget(Qt::RightDockWidgetArea, m_performanceDock);
+    addDockWidget(Qt::RightDockWidgetArea, m_multicamDock);
     addDockWidget(Qt::LeftDockWidgetArea, m_notesDock);
     addDockWidget(Qt::LeftDockWidgetArea, m_subtitlesDock);
     addDockWidget(Qt::RightDockWidgetArea, m_filesDock);
@@ -900,6 +1008,8 @@ void MainWindow::setupAndConnectDocks()
     tabifyDockWidget(m_recentDock, m_filesDock);
     tabifyDockWidget(m_filesDock, m_historyDock);
     tabifyDockWidget(m_historyDock, m_jobsDock);
+    tabifyDockWidget(m_jobsDock, m_performanceDock);
+    tabifyDockWidget(m_performanceDock, m_multicamDock);
     tabifyDockWidget(m_keyframesDock, m_timelineDock);
     m_recentDock->raise();
     resetDockCorners();
@@ -956,6 +1066,10 @@ void MainWindow::connectVideoWidgetSignals()
             &PlaylistDock::onPlayerDragStarted);
     connect(videoWidget, &Mlt::VideoWidget::seekTo, m_player, &Player::seek);
     connect(videoWidget, &Mlt::VideoWidget::gpuNotSupported, this, &MainWindow::onGpuNotSupported);
+    connect(videoWidget, &Mlt::VideoWidget::previewScaleAdapted, this, [=](int scale) {
+        if (scale > 0)
+            showStatusMessage(tr("Playback is slow; preview scaling lowered to %1p").arg(scale));
+    });
     connect(videoWidget->quickWindow(),
             &QQuickWindow::sceneGraphInitialized,
             videoWidget,
@@ -983,12 +1097,16 @@ void MainWindow::connectVideoWidgetSignals()
     connect(videoWidget,
             &Mlt::VideoWidget::frameDisplayed,
             m_scopeController,
-            &ScopeController::newFrame);
+            &ScopeController::onFrameDisplayed);
     connect(m_filterController,
             &FilterController::currentFilterChanged,
             videoWidget,
             &Mlt::VideoWidget::setCurrentFilter);
     connect(m_player, &Player::toggleVuiRequested, videoWidget, &Mlt::VideoWidget::toggleVuiDisplay);
+    connect(Actions["playerViewport360Action"],
+            &QAction::toggled,
+            videoWidget,
+            &Mlt::VideoWidget::setViewport360Enabled);
 }
 
 void MainWindow::onFocusWindowChanged(QWindow *) const
@@ -1184,6 +1302,42 @@ void MainWindow::setupSettingsMenu()
     });
 #endif
 
+    // A smaller device buffer makes scrubbing and playback start respond
+    // sooner, and a larger one avoids dropouts on a busy system.
+    auto latencyMenu = new QMenu(tr("Audio Latency"));
+    ui->menuPlayerSettings->insertMenu(ui->actionSync, latencyMenu);
+    group = new QActionGroup(this);
+    group->addAction(latencyMenu->addAction(tr("Default")))->setData(0);
+    for (auto ms : {10, 20, 40, 80, 160})
+        group->addAction(latencyMenu->addAction(tr("%1 ms").arg(ms)))->setData(ms);
+    for (auto a : group->actions()) {
+        a->setCheckable(true);
+        if (a->data().toInt() == Settings.playerAudioLatencyMs())
+            a->setChecked(true);
+    }
+    connect(group, &QActionGroup::triggered, this, [](QAction *action) {
+        Settings.setPlayerAudioLatencyMs(action->data().toInt());
+        MLT.consumerChanged();
+    });
+
+    // Render the video tracks of a timeline frame on threads of their own
+    // before they are composited. GPU mode does not use them.
+    auto trackThreadsMenu = new QMenu(tr("Track Rendering Threads"));
+    ui->menuPlayerSettings->insertMenu(ui->actionSync, trackThreadsMenu);
+    group = new QActionGroup(this);
+    group->addAction(trackThreadsMenu->addAction(tr("Off")))->setData(0);
+    for (auto threads : {2, 4, 8})
+        group->addAction(trackThreadsMenu->addAction(QString::number(threads)))->setData(threads);
+    for (auto a : group->actions()) {
+        a->setCheckable(true);
+        if (a->data().toInt() == Settings.playerTrackThreads())
+            a->setChecked(true);
+    }
+    connect(group, &QActionGroup::triggered, this, [](QAction *action) {
+        Settings.setPlayerTrackThreads(action->data().toInt());
+        MLT.consumerChanged();
+    });
+
     group = new QActionGroup(this);
     ui->actionBackupManually->setData(0);
     group->addAction(ui->actionBackupManually);
@@ -1208,6 +1362,55 @@ void MainWindow::setupSettingsMenu()
     m_previewScaleGroup->addAction(ui->actionPreview720);
     m_previewScaleGroup->addAction(ui->actionPreview1080);
     ui->menuPreviewScaling->addAction(ui->actionPreview1080);
+    ui->menuPreviewScaling->addSeparator();
+    auto adaptiveAction = new QAction(tr("Lower When Playback Is Slow"), this);
+    adaptiveAction->setCheckable(true);
+    adaptiveAction->setChecked(Settings.playerPreviewScaleAdaptive());
+    adaptiveAction->setToolTip(
+        tr("Use a lower preview scale while playing when frames are dropped"));
+    connect(adaptiveAction, &QAction::triggered, this, [](bool checked) {
+        Settings.setPlayerPreviewScaleAdaptive(checked);
+    });
+    ui->menuPreviewScaling->addAction(adaptiveAction);
+
+    auto hardwareDecodeAction = new QAction(tr("Hardware Decoder"), this);
+    hardwareDecodeAction->setCheckable(true);
+    hardwareDecodeAction->setChecked(Settings.playerHardwareDecode());
+    hardwareDecodeAction->setToolTip(
+        tr("Decode video on the GPU for playback; applies to files opened afterwards"));
+    connect(hardwareDecodeAction, &QAction::triggered, this, [](bool checked) {
+        Settings.setPlayerHardwareDecode(checked);
+        Mlt::Controller::updateHardwareDecoding();
+    });
+    ui->menuPlayerSettings->insertAction(ui->menuDeinterlacer->menuAction(), hardwareDecodeAction);
+
+    // Frame timing traces are for attaching to performance bug reports.
+    auto traceAction = new QAction(tr("Record Frame Timing"), this);
+    traceAction->setCheckable(true);
+    connect(traceAction, &QAction::triggered, this, [](bool checked) {
+        if (checked)
+            FrameTrace::clear();
+        FrameTrace::setEnabled(checked);
+    });
+    auto saveTraceAction = new QAction(tr("Save Frame Timing..."), this);
+    connect(saveTraceAction, &QAction::triggered, this, [this]() {
+        QString fileName = Settings.savePath() + "/%1.json";
+        fileName = QFileDialog::getSaveFileName(this,
+                                                tr("Save Frame Timing"),
+                                                fileName.arg(tr("frame-timing")),
+                                                tr("Chrome Trace Files (*.json)"),
+                                                nullptr,
+                                                Util::getFileDialogOptions());
+        if (fileName.isEmpty())
+            return;
+        if (!fileName.endsWith(".json", Qt::CaseInsensitive))
+            fileName += ".json";
+        if (!FrameTrace::save(fileName))
+            showStatusMessage(tr("Failed to save %1").arg(fileName));
+    });
+    ui->menuHelp->insertAction(ui->actionAbout_Shotcut, traceAction);
+    ui->menuHelp->insertAction(ui->actionAbout_Shotcut, saveTraceAction);
+    ui->menuHelp->insertSeparator(ui->actionAbout_Shotcut);
 
     group = new QActionGroup(this);
     group->addAction(ui->actionTimeFrames);
@@ -1579,6 +1782,8 @@ void MainWindow::setupSettingsMenu()
     ui->actionUseProxy->setChecked(Settings.proxyEnabled());
     ui->actionProxyUseProjectFolder->setChecked(Settings.proxyUseProjectFolder());
     ui->actionProxyUseHardware->setChecked(Settings.proxyUseHardware());
+    ui->actionProxyIntraCache->setChecked(Settings.proxyIntraCache());
+    ui->actionProxyMediaCache->setChecked(Settings.proxyMediaCache());
 
     LOG_DEBUG() << "end";
 }
@@ -1756,11 +1961,8 @@ bool MainWindow::saveRepairedXmlFile(MltXmlChecker &checker, QString &fileName)
         QFile repaired(filename);
         repaired.open(QIODevice::WriteOnly);
         LOG_INFO() << "repaired MLT XML file name" << repaired.fileName();
-        if (checker.tempFile().exists()) {
-            checker.tempFile().open();
-            QByteArray xml = checker.tempFile().readAll();
-            checker.tempFile().close();
-
+        QByteArray xml = checker.xml();
+        if (!xml.isEmpty()) {
             if (Settings.proxyEnabled()) {
                 auto s = QString::fromUtf8(xml);
                 if (ProxyManager::filterXML(s, QDir::fromNativeSeparators(fi.absolutePath()))) {
@@ -1858,12 +2060,24 @@ void MainWindow::doAutosave()
 {
     QMutexLocker locker(&m_autosaveMutex);
     if (m_autosaveFile) {
+        // The window stays modified until the project is saved, so skip
+        // rewriting the whole project when nothing changed since last time.
+        const int count = m_modifiedCount.load();
+        if (m_lastAutosaveFile.toStrongRef() == m_autosaveFile && m_lastAutosaveCount == count
+            && QFile::exists(m_autosaveFile->fileName())) {
+            LOG_DEBUG() << "autosave skipped; nothing changed";
+            return;
+        }
         bool success = false;
         if (m_autosaveFile->isOpen() || m_autosaveFile->open(QIODevice::ReadWrite)) {
             m_autosaveFile->close();
             success = saveXML(m_autosaveFile->fileName(), false /* without relative paths */);
             m_autosaveFile->open(QIODevice::ReadWrite);
         }
+        if (success) {
+            m_lastAutosaveFile = m_autosaveFile;
+            m_lastAutosaveCount = count;
+        }
         if (!success) {
             LOG_ERROR() << "failed to open autosave file for writing" << m_autosaveFile->fileName();
         }
@@ -1995,6 +2209,7 @@ void MainWindow::setPreviewScale(int scale)
         break;
     }
     MLT.setPreviewScale(scale);
+    ProxyManager::updateTier();
     if (!m_externalGroup->checkedAction()->data().toString().isEmpty()) {
         // DeckLink external monitor
         MLT.consumerChanged();
@@ -2107,6 +2322,7 @@ void MainWindow::onAutosaveTimeout()
     }
     if (Settings.warnLowMemory()) {
         if (Util::isMemoryLow()) {
+            MEMORY.reclaim();
             MLT.pause();
             JOBS.pauseCurrent();
             dialog->show();
@@ -2131,7 +2347,7 @@ bool MainWindow::open(QString url, const Mlt::Properties *properties, bool play,
         url = pwd.filePath(url);
         info.setFile(url);
     }
-    if (url.endsWith(".mlt") || url.endsWith(".xml")) {
+    if (url.endsWith(".mlt") || url.endsWith(".xml") || ProjectArchive::isArchive(url)) {
         if (url != untitledFileName()) {
             showStatusMessage(tr("Opening %1").arg(url));
             QCoreApplication::processEvents();
@@ -2196,7 +2412,7 @@ bool MainWindow::open(QString url, const Mlt::Properties *properties, bool play,
             && m_profileGroup->checkedAction()->data().toString().isEmpty())
             MLT.profile().set_explicit(false);
     }
-    QString urlToOpen = checker.isUpdated() ? checker.tempFile().fileName() : url;
+    QString urlToOpen = checker.isUpdated() ? checker.tempFileName() : url;
     if (!MLT.open(QDir::fromNativeSeparators(urlToOpen),
                   QDir::fromNativeSeparators(url),
                   skipConvert)
@@ -2210,7 +2426,7 @@ bool MainWindow::open(QString url, const Mlt::Properties *properties, bool play,
         Mlt::Filter filter(MLT.profile(), "color_transform");
         if (filter.is_valid())
             setProcessingMode(MLT.processingMode());
-        if (url.endsWith(".mlt") || url.endsWith(".xml")) {
+        if (url.endsWith(".mlt") || url.endsWith(".xml") || ProjectArchive::isArchive(url)) {
             if (MLT.producer()->get_int(kShotcutProjectFolder)) {
                 MLT.setProjectFolder(info.absolutePath());
                 ProxyManager::removePending();
@@ -2257,7 +2473,16 @@ void MainWindow::openMultiple(const QStringList &paths)
 void MainWindow::openMultiple(const QList<QUrl> &urls)
 {
     if (urls.size() > 1) {
-        m_multipleFiles = Util::sortedFileList(Util::expandDirectories(urls));
+        QList<QUrl> expanded;
+        {
+            LongUiTask longTask(tr("Open Files"));
+            expanded = DirectoryScanner::expandDirectories(urls, [&](int count) {
+                longTask.reportProgress(tr("Searching folders: %n file(s)", nullptr, count), 0, 0);
+            });
+        }
+        m_multipleFiles = Util::sortedFileList(expanded);
+        if (m_multipleFiles.isEmpty())
+            return;
         open(m_multipleFiles.first(), nullptr, true, true);
     } else if (urls.size() > 0) {
         QUrl url = urls.first();
@@ -2277,7 +2502,7 @@ void MainWindow::openVideo()
     QStringList filenames = QFileDialog::getOpenFileNames(this,
                                                           tr("Open File"),
                                                           path,
-                                                          tr("All Files (*);;MLT XML (*.mlt)"),
+                                                          tr("All Files (*);;MLT XML (*.mlt *.mltz)"),
                                                           nullptr,
                                                           Util::getFileDialogOptions());
 
@@ -2604,12 +2829,13 @@ void MainWindow::setupActions()
             dialog.setEscapeButton(QMessageBox::No);
             dialog.setWindowModality(QmlApplication::dialogModality());
             if (QMessageBox::Yes == dialog.exec()) {
-                // If dialog accepted enqueue jobs.
+                // If dialog accepted enqueue jobs, whose results are written together.
+                auto batch = new AnalyzeBatch(this);
                 foreach (Mlt::Filter filter, parser.filters()) {
                     QScopedPointer<QmlMetadata> meta(new QmlMetadata);
                     QmlFilter qmlFilter(filter, meta.data());
                     bool isAudio = !::qstrcmp("loudness", filter.get("mlt_service"));
-                    qmlFilter.analyze(isAudio, false);
+                    qmlFilter.analyze(isAudio, false, batch);
                 }
             }
         } else {
@@ -3063,6 +3289,14 @@ bool MainWindow::eventFilter(QObject *target, QEvent *event)
     return QMainWindow::eventFilter(target, event);
 }
 
+// Compares UUIDs rather than serializing the whole current producer, which
+// may be the timeline, to see whether the player is dropped onto itself.
+static bool isDragFromPlayer(const QMimeData *mimeData)
+{
+    return MLT.producer() && MLT.producer()->is_valid()
+           && mimeData->data(Mlt::PlayerMimeType) == MLT.uuid(*MLT.producer()).toByteArray();
+}
+
 void MainWindow::dragEnterEvent(QDragEnterEvent *event)
 {
     // Simulate the player firing a dragStarted event to make the playlist close
@@ -3095,8 +3329,7 @@ void MainWindow::dropEvent(QDropEvent *event)
         const auto &urls = mimeData->urls();
         QTimer::singleShot(0, this, [=]() { openMultiple(urls); });
         event->acceptProposedAction();
-    } else if (mimeData->hasFormat(Mlt::XmlMimeType)
-               && MLT.XML() != mimeData->data(Mlt::XmlMimeType)) {
+    } else if (mimeData->hasFormat(Mlt::XmlMimeType) && !isDragFromPlayer(mimeData)) {
         m_playlistDock->onOpenActionTriggered();
         event->acceptProposedAction();
     }
@@ -3105,6 +3338,7 @@ void MainWindow::dropEvent(QDropEvent *event)
 void MainWindow::closeEvent(QCloseEvent *event)
 {
     m_timelineDock->stopRecording();
+    m_saveFuture.waitForFinished();
     if (continueJobsRunning() && continueModified()) {
         LOG_DEBUG() << "begin";
         JOBS.cleanup();
@@ -3122,7 +3356,10 @@ void MainWindow::closeEvent(QCloseEvent *event)
                 onMultitrackClosed();
         }
         QThreadPool::globalInstance()->clear();
+        Executors::clear();
         AudioLevelsTask::closeAll();
+        SceneDetectTask::closeAll();
+        ThumbnailDecoderPool::singleton().clear();
         event->accept();
         emit aboutToShutDown();
         if (m_exitCode == EXIT_SUCCESS) {
@@ -3216,6 +3453,9 @@ void MainWindow::onProducerOpened(bool withReopen)
             m_player->switchToTab(Player::ProjectTabIndex);
             m_timelineDock->selectMultitrack();
             m_timelineDock->setSelection();
+            if (Settings.proxyMediaCache())
+                ProxyManager::generateMediaCacheIfNotExistsAll(*multitrack(),
+                                                               m_player->position());
         }
     }
     if (MLT.isClip()) {
@@ -3252,16 +3492,26 @@ bool MainWindow::on_actionSave_triggered()
         if (Util::warnIfNotWritable(m_currentFile, this, tr("Save XML")))
             return false;
         backupPeriodically();
-        bool success = saveXML(m_currentFile);
+        // Do not let two writes of the same file overlap.
+        m_saveFuture.waitForFinished();
+        saveXML(m_currentFile, true, &m_saveFuture);
         QMutexLocker locker(&m_autosaveMutex);
         m_autosaveFile.reset(new AutoSaveFile(m_currentFile));
         setCurrentFile(m_currentFile);
         setWindowModified(false);
-        if (success) {
-            showStatusMessage(tr("Saved %1").arg(m_currentFile));
-        } else {
-            showSaveError();
-        }
+        showStatusMessage(tr("Saving %1...").arg(m_currentFile));
+        auto watcher = new QFutureWatcher<bool>(this);
+        const auto filename = m_currentFile;
+        connect(watcher, &QFutureWatcherBase::finished, this, [=]() {
+            if (watcher->result()) {
+                showStatusMessage(tr("Saved %1").arg(filename));
+            } else {
+                markModified();
+                showSaveError();
+            }
+            watcher->deleteLater();
+        });
+        watcher->setFuture(m_saveFuture);
         m_undoStack->setClean();
         return true;
     }
@@ -3273,17 +3523,23 @@ bool MainWindow::on_actionSave_As_triggered()
     if (!m_currentFile.isEmpty())
         path = m_currentFile;
     QString caption = tr("Save XML");
+    const QString compressedFilter = tr("Compressed MLT XML (*.mltz)");
+    QString selectedFilter = ProjectArchive::isArchive(path) ? compressedFilter : QString();
     QString filename = QFileDialog::getSaveFileName(this,
                                                     caption,
                                                     path,
-                                                    tr("MLT XML (*.mlt)"),
-                                                    nullptr,
+                                                    tr("MLT XML (*.mlt)") + ";;" + compressedFilter,
+                                                    &selectedFilter,
                                                     Util::getFileDialogOptions());
     if (!filename.isEmpty()) {
         QFileInfo fi(filename);
         Settings.setSavePath(fi.path());
-        if (fi.suffix() != "mlt")
+        if (selectedFilter == compressedFilter) {
+            if (!ProjectArchive::isArchive(filename))
+                filename += QStringLiteral(".") + ProjectArchive::suffix();
+        } else if (fi.suffix() != "mlt") {
             filename += ".mlt";
+        }
 
         if (Util::warnIfNotWritable(filename, this, caption))
             return false;
@@ -3599,7 +3855,7 @@ void MainWindow::onPlaylistLoaded()
 void MainWindow::onPlaylistCleared()
 {
     m_player->onTabBarClicked(Player::SourceTabIndex);
-    setWindowModified(true);
+    markModified();
 }
 
 void MainWindow::onPlaylistClosed()
@@ -3620,7 +3876,7 @@ void MainWindow::onPlaylistClosed()
 
 void MainWindow::onPlaylistModified()
 {
-    setWindowModified(true);
+    markModified();
     if (MLT.producer() && playlist()
         && (void *) MLT.producer()->get_producer() == (void *) playlist()->get_playlist())
         m_player->onDurationChanged();
@@ -3653,7 +3909,7 @@ void MainWindow::onMultitrackClosed()
 
 void MainWindow::onMultitrackModified()
 {
-    setWindowModified(true);
+    markModified();
 
     // Reflect this playlist info onto the producer for keyframes dock.
     if (!m_timelineDock->selection().isEmpty()) {
@@ -3702,18 +3958,18 @@ void MainWindow::onMultitrackDurationChanged()
 
 void MainWindow::onNoteModified()
 {
-    setWindowModified(true);
+    markModified();
 }
 
 void MainWindow::onSubtitleModified()
 {
-    setWindowModified(true);
+    markModified();
 }
 
 void MainWindow::onCutModified()
 {
     if (!playlist() && !multitrack()) {
-        setWindowModified(true);
+        markModified();
     }
     if (playlist()) {
         emit m_playlistDock->enableUpdate(true);
@@ -3721,9 +3977,15 @@ void MainWindow::onCutModified()
     sourceUpdated();
 }
 
-void MainWindow::onProducerModified()
+void MainWindow::markModified()
 {
     setWindowModified(true);
+    ++m_modifiedCount;
+}
+
+void MainWindow::onProducerModified()
+{
+    markModified();
     sourceUpdated();
     MLT.refreshConsumer();
 }
@@ -3731,7 +3993,7 @@ void MainWindow::onProducerModified()
 void MainWindow::onFilterModelChanged()
 {
     MLT.refreshConsumer();
-    setWindowModified(true);
+    markModified();
     sourceUpdated();
     if (playlist()) {
         emit m_playlistDock->enableUpdate(true);
@@ -3777,28 +4039,37 @@ void MainWindow::on_actionForum_triggered()
 
 bool MainWindow::saveXML(const QString &filename, bool withRelativePaths)
 {
-    bool result;
+    return saveXML(filename, withRelativePaths, nullptr);
+}
+
+// When future is set, only the serialization runs here and the file is
+// written on a worker thread, whose result is given in future.
+bool MainWindow::saveXML(const QString &filename, bool withRelativePaths, QFuture<bool> *future)
+{
     QString notes = m_notesDock->getText();
+    auto save = [&](Mlt::Service *service) {
+        if (future) {
+            *future = MLT.saveXMLAsync(filename, service, withRelativePaths, notes);
+            return true;
+        }
+        return MLT.saveXML(filename, service, withRelativePaths, nullptr, false, notes);
+    };
+    bool result;
     if (m_timelineDock->model()->rowCount() > 0) {
-        result = MLT.saveXML(filename, multitrack(), withRelativePaths, nullptr, false, notes);
+        result = save(multitrack());
     } else if (m_playlistDock->model()->rowCount() > 0 && MLT.producer()
                && MLT.producer()->is_valid()) {
         int in = MLT.producer()->get_in();
         int out = MLT.producer()->get_out();
         MLT.producer()->set_in_and_out(0, MLT.producer()->get_length() - 1);
-        result = MLT.saveXML(filename, playlist(), withRelativePaths, nullptr, false, notes);
+        result = save(playlist());
         MLT.producer()->set_in_and_out(in, out);
     } else if (MLT.producer() && MLT.producer()->is_valid()) {
-        result = MLT.saveXML(filename,
-                             (MLT.isMultitrack() || MLT.isPlaylist()) ? MLT.savedProducer() : 0,
-                             withRelativePaths,
-                             nullptr,
-                             false,
-                             notes);
+        result = save((MLT.isMultitrack() || MLT.isPlaylist()) ? MLT.savedProducer() : 0);
     } else {
         // Save an empty playlist, which is accepted by both MLT and Shotcut.
         Mlt::Playlist playlist(MLT.profile());
-        result = MLT.saveXML(filename, &playlist, withRelativePaths, nullptr, false, notes);
+        result = save(&playlist);
     }
     return result;
 }
@@ -4265,6 +4536,9 @@ void MainWindow::processMultipleFiles()
         m_playlistDock->show();
         m_playlistDock->raise();
         ResourceDialog dialog(this);
+        // Add all of the files to the playlist at once.
+        QList<Mlt::Producer> producers;
+        producers.reserve(count);
         for (int i = 0; i < count; i++) {
             QString filename = multipleFiles.takeFirst();
             LOG_DEBUG() << filename;
@@ -4280,14 +4554,15 @@ void MainWindow::processMultipleFiles()
                 Mlt::Producer *producer = MLT.setupNewProducer(&p);
                 ProxyManager::generateIfNotExists(*producer);
                 producer->set(kShotcutSkipConvertProperty, true);
-                undoStack()->push(
-                    new Playlist::AppendCommand(*m_playlistDock->model(), MLT.XML(producer), false));
+                producers << Mlt::Producer(producer);
                 m_recentDock->add(filename.toUtf8().constData());
                 dialog.add(producer);
                 delete producer;
             }
         }
-        emit m_playlistDock->model()->modified();
+        if (!producers.isEmpty())
+            undoStack()->push(
+                new Playlist::InsertProducersCommand(*m_playlistDock->model(), producers, -1));
         if (Settings.showConvertClipDialog() && dialog.hasTroubleClips()) {
             dialog.selectTroubleClips();
             dialog.setWindowTitle(tr("Opened Files"));
@@ -5072,6 +5347,25 @@ void MainWindow::on_actionExportFrame_triggered()
     MLT.refreshConsumer();
 }
 
+void MainWindow::on_actionExportFrames_triggered()
+{
+    if (!MLT.producer() || !MLT.producer()->is_valid())
+        return;
+    // Markers and clips are positions on the timeline.
+    const bool isTimeline = isMultitrackValid();
+    Mlt::Producer *producer = isTimeline ? multitrack() : MLT.producer();
+    ExportFramesDialog dialog(producer, isTimeline, this);
+    if (dialog.exec() != QDialog::Accepted)
+        return;
+    // Render from the original sources instead of the proxies.
+    QString xml = MLT.XML(producer);
+    if (!ProxyManager::filterXML(xml, QString())) {
+        showStatusMessage(tr("Unable to export frames."));
+        return;
+    }
+    JOBS.add(new FrameExportJob(xml, dialog.frames()));
+}
+
 void MainWindow::onVideoWidgetImageReady()
 {
     auto *videoWidget = qobject_cast<Mlt::VideoWidget *>(MLT.videoWidget());
@@ -5968,11 +6262,12 @@ void MainWindow::on_actionUseProxy_triggered(bool checked)
                     dialog.setDefaultButton(QMessageBox::Yes);
                     dialog.setEscapeButton(QMessageBox::No);
                     if (dialog.exec() == QMessageBox::Yes) {
-                        Mlt::Producer producer(playlist());
+                        // The timeline is what plays now, so queue its clips first.
+                        Mlt::Producer producer(multitrack());
                         if (producer.is_valid()) {
-                            ProxyManager::generateIfNotExistsAll(producer);
+                            ProxyManager::generateIfNotExistsAll(producer, position);
                         }
-                        producer = multitrack();
+                        producer = playlist();
                         if (producer.is_valid()) {
                             ProxyManager::generateIfNotExistsAll(producer);
                         }
@@ -6058,6 +6353,25 @@ void MainWindow::on_actionProxyUseHardware_triggered(bool checked)
     Settings.setProxyUseHardware(ui->actionProxyUseHardware->isChecked());
 }
 
+void MainWindow::on_actionProxyIntraCache_triggered(bool checked)
+{
+    Settings.setProxyIntraCache(checked);
+}
+
+void MainWindow::on_actionProxyMediaCache_triggered(bool checked)
+{
+    Settings.setProxyMediaCache(checked);
+    if (checked) {
+        // The timeline is what plays now, so queue its clips first.
+        Mlt::Producer producer(multitrack());
+        if (producer.is_valid())
+            ProxyManager::generateMediaCacheIfNotExistsAll(producer, m_player->position());
+        producer = playlist();
+        if (producer.is_valid())
+            ProxyManager::generateMediaCacheIfNotExistsAll(producer);
+    }
+}
+
 void MainWindow::on_actionProxyConfigureHardware_triggered()
 {
     m_encodeDock->on_hwencodeButton_clicked();
@@ -6140,6 +6454,11 @@ void MainWindow::clearCurrentLayout()
 
 void MainWindow::onClipboardChanged()
 {
+    // Reading the clips copied from the timeline as text would serialize them.
+    if (TimelineClipboard::isOwner()) {
+        m_clipboardUpdatedAt = QDateTime::currentDateTime();
+        return;
+    }
     auto s = QGuiApplication::clipboard()->text();
     if (MLT.isMltXml(s) && !s.contains(kShotcutFiltersClipboard)) {
         m_clipboardUpdatedAt = QDateTime::currentDateTime();
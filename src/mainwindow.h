@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include "mltxmlchecker.h"
 
 #include <QDateTime>
+#include <QFuture>
 #include <QMainWindow>
 #include <QMutex>
 #include <QNetworkAccessManager>
@@ -29,6 +30,9 @@
 #include <QSharedPointer>
 #include <QTimer>
 #include <QUrl>
+#include <QWeakPointer>
+
+#include <atomic>
 
 #define EXIT_RESTART (42)
 #define EXIT_RESET (43)
@@ -53,6 +57,8 @@ class QNetworkReply;
 class KeyframesDock;
 class MarkersDock;
 class NotesDock;
+class PerformanceDock;
+class MulticamDock;
 class SubtitlesDock;
 class ScreenCapture;
 
@@ -73,6 +79,7 @@ public:
     static void changeTheme(const QString &theme);
     PlaylistDock *playlistDock() const { return m_playlistDock; }
     TimelineDock *timelineDock() const { return m_timelineDock; }
+    EncodeDock *encodeDock() const { return m_encodeDock; }
     FilterController *filterController() const { return m_filterController; }
     Mlt::Playlist *playlist() const;
     bool isPlaylistValid() const;
@@ -136,6 +143,8 @@ protected:
 
 private:
     void connectFocusSignals();
+    void markModified();
+    bool saveXML(const QString &filename, bool withRelativePaths, QFuture<bool> *future);
     void registerDebugCallback();
     void connectUISignals();
     void setupAndConnectUndoStack();
@@ -209,6 +218,13 @@ private:
     QActionGroup *m_languagesGroup;
     QSharedPointer<AutoSaveFile> m_autosaveFile;
     QMutex m_autosaveMutex;
+    // Counts the changes to the project; read by the autosave thread.
+    std::atomic<int> m_modifiedCount{0};
+    // The file and change count of the last autosave, guarded by m_autosaveMutex.
+    QWeakPointer<AutoSaveFile> m_lastAutosaveFile;
+    int m_lastAutosaveCount{-1};
+    // The file write of the last Save, which runs on a worker thread.
+    QFuture<bool> m_saveFuture;
     QTimer m_autosaveTimer;
     int m_exitCode;
     QScopedPointer<QAction> m_statusBarAction;
@@ -219,6 +235,8 @@ private:
     QDateTime m_sourceUpdatedAt;
     MarkersDock *m_markersDock;
     NotesDock *m_notesDock;
+    PerformanceDock *m_performanceDock;
+    MulticamDock *m_multicamDock;
     SubtitlesDock *m_subtitlesDock;
     std::unique_ptr<QWidget> m_producerWidget;
     FilesDock *m_filesDock;
@@ -353,6 +371,7 @@ private slots:
     void onClipCopied();
     void on_actionExportEDL_triggered();
     void on_actionExportFrame_triggered();
+    void on_actionExportFrames_triggered();
     void onVideoWidgetImageReady();
     void on_actionAppDataSet_triggered();
     void on_actionAppDataShow_triggered();
@@ -396,6 +415,8 @@ private slots:
     void on_actionProxyUseProjectFolder_triggered(bool checked);
     void on_actionProxyUseHardware_triggered(bool checked);
     void on_actionProxyConfigureHardware_triggered();
+    void on_actionProxyIntraCache_triggered(bool checked);
+    void on_actionProxyMediaCache_triggered(bool checked);
     void updateLayoutSwitcher();
     void clearCurrentLayout();
     void onClipboardChanged();
@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memorybudget.h"
+
+#include "Logger.h"
+#include "settings.h"
+
+#include <QCoreApplication>
+
+#include <algorithm>
+#include <limits>
+
+static const int kCheckIntervalMs = 5000;
+
+MemoryBudget::MemoryBudget(QObject *parent)
+    : QObject(parent)
+    , m_nextId(0)
+    , m_budget(qint64(Settings.memoryBudgetMB()) * 1024 * 1024)
+    , m_timer(this)
+{
+    m_timer.setInterval(kCheckIntervalMs);
+    connect(&m_timer, &QTimer::timeout, this, &MemoryBudget::enforce);
+}
+
+MemoryBudget &MemoryBudget::singleton()
+{
+    // The caches of other singletons remove themselves at exit, so this is never deleted.
+    static MemoryBudget *instance = nullptr;
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!instance) {
+        // The first cache may register from any thread.
+        instance = new MemoryBudget;
+        instance->moveToThread(QCoreApplication::instance()->thread());
+        QMetaObject::invokeMethod(
+            instance, []() { instance->m_timer.start(); }, Qt::QueuedConnection);
+    }
+    return *instance;
+}
+
+int MemoryBudget::add(const QString &name,
+                      Priority priority,
+                      UsageFunction usage,
+                      EvictFunction evict)
+{
+    QMutexLocker locker(&m_mutex);
+    m_caches << Cache{m_nextId, name, priority, usage, evict};
+    std::stable_sort(m_caches.begin(), m_caches.end(), [](const Cache &a, const Cache &b) {
+        return a.priority < b.priority;
+    });
+    return m_nextId++;
+}
+
+void MemoryBudget::remove(int id)
+{
+    QMutexLocker locker(&m_mutex);
+    m_caches.removeIf([=](const Cache &cache) { return cache.id == id; });
+}
+
+qint64 MemoryBudget::budget() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_budget;
+}
+
+void MemoryBudget::setBudget(qint64 bytes)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_budget = bytes;
+    }
+    QMetaObject::invokeMethod(this, &MemoryBudget::enforce, Qt::QueuedConnection);
+}
+
+qint64 MemoryBudget::usage() const
+{
+    qint64 result = 0;
+    for (const auto &cache : caches())
+        result += cache.usage();
+    return result;
+}
+
+void MemoryBudget::reclaim()
+{
+    const qint64 freed = evict(std::numeric_limits<qint64>::max());
+    LOG_INFO() << "freed" << freed / 1024 / 1024 << "MiB from the caches";
+}
+
+void MemoryBudget::enforce()
+{
+    const qint64 budget = this->budget();
+    if (budget <= 0)
+        return;
+    const qint64 excess = usage() - budget;
+    if (excess > 0) {
+        const qint64 freed = evict(excess);
+        LOG_DEBUG() << "over the memory budget by" << excess / 1024 << "KiB, freed"
+                    << freed / 1024 << "KiB";
+    }
+}
+
+qint64 MemoryBudget::evict(qint64 bytes)
+{
+    // Without the lock, so that a callback may register or remove a cache.
+    qint64 freed = 0;
+    for (const auto &cache : caches()) {
+        if (freed >= bytes)
+            break;
+        const qint64 bytesFreed = cache.evict(bytes - freed);
+        LOG_DEBUG() << cache.name << "freed" << bytesFreed / 1024 << "KiB";
+        freed += bytesFreed;
+    }
+    return freed;
+}
+
+QList<MemoryBudget::Cache> MemoryBudget::caches() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_caches;
+}
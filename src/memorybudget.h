@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORYBUDGET_H
+#define MEMORYBUDGET_H
+
+#include <QCache>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QString>
+#include <QTimer>
+
+#include <functional>
+
+/*!
+  \class MemoryBudget
+  \brief Keeps the caches of Shotcut together under one memory cap.
+
+  \threadsafe
+
+  Each cache registers how to measure its size and how to evict from it. A
+  timer compares their total with the budget from the settings, and when it
+  is over, it evicts the difference from the caches in priority order, the
+  cheapest to rebuild first. When the system is low on memory, reclaim()
+  evicts as much as every cache can give. The callbacks are called on the
+  GUI thread and must lock whatever the cache shares with other threads.
+*/
+
+class MemoryBudget : public QObject
+{
+    Q_OBJECT
+    explicit MemoryBudget(QObject *parent = 0);
+
+public:
+    //! The order in which caches are evicted, lowest first.
+    enum Priority { ThumbnailPriority, FramePriority, PoolPriority };
+
+    typedef std::function<qint64()> UsageFunction;
+    //! Evicts about the given bytes and returns how many were freed.
+    typedef std::function<qint64(qint64)> EvictFunction;
+
+    static MemoryBudget &singleton();
+
+    //! Registers a cache and returns the id with which to remove it.
+    int add(const QString &name, Priority priority, UsageFunction usage, EvictFunction evict);
+    void remove(int id);
+    qint64 budget() const;
+    void setBudget(qint64 bytes);
+    //! Returns the total size of the caches in bytes.
+    qint64 usage() const;
+    //! Evicts as much as possible, for when the system is low on memory.
+    void reclaim();
+
+    //! Evicts about \a bytes from a cache whose costs are in KiB and returns how many.
+    template<class Key, class T>
+    static qint64 trim(QCache<Key, T> &cache, qint64 bytes)
+    {
+        const qint64 before = cache.totalCost();
+        const qint64 maxCost = cache.maxCost();
+        cache.setMaxCost(qMax<qint64>(0, before - (bytes + 1023) / 1024));
+        cache.setMaxCost(maxCost);
+        return (before - cache.totalCost()) * 1024;
+    }
+
+private slots:
+    void enforce();
+
+private:
+    struct Cache
+    {
+        int id;
+        QString name;
+        Priority priority;
+        UsageFunction usage;
+        EvictFunction evict;
+    };
+
+    qint64 evict(qint64 bytes);
+    QList<Cache> caches() const;
+
+    mutable QMutex m_mutex;
+    QList<Cache> m_caches;
+    int m_nextId;
+    qint64 m_budget;
+    QTimer m_timer;
+};
+
+#define MEMORY MemoryBudget::singleton()
+
+#endif // MEMORYBUDGET_H
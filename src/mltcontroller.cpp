@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,12 +18,20 @@
 #include "mltcontroller.h"
 
 #include "Logger.h"
+#include "avformatcache.h"
 #include "controllers/filtercontroller.h"
+#include "filterchainoptimizer.h"
 #include "mainwindow.h"
+#include "memorybudget.h"
+#include "performancecounters.h"
+#include "probecache.h"
+#include "projectarchive.h"
 #include "proxymanager.h"
 #include "qmltypes/qmlmetadata.h"
+#include "renderpreview.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "startupprofile.h"
 #include "util.h"
 #if defined(Q_OS_WIN)
 #include "widgets/d3dvideowidget.h"
@@ -41,8 +49,8 @@
 #include <QPalette>
 #include <QProcess>
 #include <QSaveFile>
-#include <QTextStream>
 #include <QThreadPool>
+#include <QtConcurrent/QtConcurrentRun>
 #include <QUuid>
 #include <QWidget>
 
@@ -54,21 +62,37 @@ namespace Mlt {
 
 static const int kThumbnailOutSeekFactor = 5;
 static Controller *instance = nullptr;
+static QFuture<Repository *> g_repository;
 const QString XmlMimeType("application/vnd.mlt+xml");
+const QString PlayerMimeType("application/x-shotcut-player");
 static const char *kMltXmlPropertyName = "string";
 
+static void deleteFrame(void *frame)
+{
+    delete static_cast<Mlt::Frame *>(frame);
+}
+
 Controller::Controller()
     : m_profile(kDefaultMltProfile)
     , m_previewProfile(kDefaultMltProfile)
     , m_blockRefresh(false)
 {
     LOG_DEBUG() << "begin";
-    ::qputenv("MLT_REPOSITORY_DENY", "libmltqt:libmltglaxnimate");
-    m_repo = Mlt::Factory::init();
+    initRepository();
+    m_repo = g_repository.result();
     m_processingMode = Settings.processingMode();
     resetLocale();
     initFiltersClipboard();
     updateAvformatCaching(0);
+    // The size of the pool is unknown, so it is only purged as the last resort.
+    MEMORY.add(
+        "MLT memory pool",
+        MemoryBudget::PoolPriority,
+        []() { return qint64(0); },
+        [this](qint64) {
+            purgeMemoryPool();
+            return qint64(0);
+        });
     LOG_DEBUG() << "end";
 }
 
@@ -151,6 +175,7 @@ int Controller::open(const QString &url, const QString &urlToSave, bool skipConv
         }
         updatePreviewProfile();
         setPreviewScale(Settings.playerPreviewScale());
+        PROBES.insert(*newProducer);
         if (url.endsWith(".mlt")) {
             // Load the number of audio channels being used when this project was created.
             int channels = newProducer->get_int(kShotcutProjectAudioChannels);
@@ -472,6 +497,12 @@ void Controller::refreshConsumer(bool scrubAudio)
     }
 }
 
+void Controller::refreshTrack(int changes, const std::function<void(Mlt::Producer &)> &)
+{
+    if (changes & TrackVideoChange)
+        refreshConsumer();
+}
+
 bool Controller::saveXML(const QString &filename,
                          Service *service,
                          bool withRelativePaths,
@@ -481,70 +512,111 @@ bool Controller::saveXML(const QString &filename,
 {
     QMutexLocker locker(&m_saveXmlMutex);
     QFileInfo fi(filename);
+    // The Shotcut rule for paths in MLT XML is forward slashes as created by QFileDialog and QmlFile.
+    QString root = withRelativePaths ? QDir::fromNativeSeparators(fi.absolutePath()) : "";
+    auto xml = serializeXML(filename, service, root, proxy, projectNote);
+    if (proxy || xml.isEmpty())
+        return false;
+    return writeXML(xml, filename, root, tempFile);
+}
+
+QFuture<bool> Controller::saveXMLAsync(const QString &filename,
+                                       Service *service,
+                                       bool withRelativePaths,
+                                       QString projectNote)
+{
+    QMutexLocker locker(&m_saveXmlMutex);
+    QFileInfo fi(filename);
+    QString root = withRelativePaths ? QDir::fromNativeSeparators(fi.absolutePath()) : "";
+    // The consumer must traverse the services while nothing edits them, but
+    // the XML is plain text once serialized.
+    auto xml = serializeXML(filename, service, root, false, projectNote);
+    if (xml.isEmpty())
+        return QtConcurrent::run([]() { return false; });
+    return QtConcurrent::run(&Controller::writeXML, xml, filename, root, nullptr);
+}
+
+QString Controller::serializeXML(const QString &filename,
+                                 Service *service,
+                                 const QString &root,
+                                 bool proxy,
+                                 const QString &projectNote)
+{
     Consumer c(profile(), "xml", proxy ? filename.toUtf8().constData() : kMltXmlPropertyName);
     Service s(service ? service->get_service() : m_producer->get_service());
-    if (s.is_valid()) {
-        // The Shotcut rule for paths in MLT XML is forward slashes as created by QFileDialog and QmlFile.
-        QString root = withRelativePaths ? QDir::fromNativeSeparators(fi.absolutePath()) : "";
-        s.set(kShotcutProjectAudioChannels, m_audioChannels);
-        s.set(kShotcutProjectFolder, m_projectFolder.isEmpty() ? 0 : 1);
-        s.set(kShotcutProjectProcessingMode,
-              Settings.processingModeStr(Settings.processingMode()).toUtf8().constData());
-        if (!projectNote.isEmpty()) {
-            s.set(kShotcutProjectNote, projectNote.toUtf8().constData());
-        } else {
-            s.clear(kShotcutProjectNote);
-        }
-        int ignore = s.get_int("ignore_points");
-        if (ignore)
-            s.set("ignore_points", 0);
-        c.set("time_format", "clock");
-        c.set("store", "shotcut");
-        c.set("root", root.toUtf8().constData());
-        c.set("no_root", 1);
-        c.set("title",
-              QStringLiteral("Shotcut version ").append(SHOTCUT_VERSION).toUtf8().constData());
-
-        // Save the consumer of this service so it can be restored.
-        auto saveConsumer = mlt_service_consumer(s.consumer()->get_service());
-        c.connect(s);
-        c.start();
-        if (ignore)
-            s.set("ignore_points", ignore);
-        auto xml = QString::fromUtf8(c.get(kMltXmlPropertyName));
-        // Restore the consumer that was previously on this service
-        mlt_service_set_consumer(s.get_service(), saveConsumer);
-
-        if (!proxy && ProxyManager::filterXML(xml, root)) { // also verifies
-            if (tempFile) {
-                QTextStream stream(tempFile);
-                stream.setEncoding(QStringConverter::Utf8);
-                stream << xml;
-                if (tempFile->error() != QFileDevice::NoError) {
-                    LOG_ERROR() << "error while writing MLT XML file" << tempFile->fileName() << ":"
-                                << tempFile->errorString();
-                    return false;
-                }
-            } else {
-                QSaveFile file(filename);
-                file.setDirectWriteFallback(true);
-                if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
-                    LOG_ERROR() << "failed to open MLT XML file for writing" << filename;
-                    return false;
-                }
-                QTextStream stream(&file);
-                stream.setEncoding(QStringConverter::Utf8);
-                stream << xml;
-                if (file.error() != QFileDevice::NoError) {
-                    LOG_ERROR() << "error while writing MLT XML file" << filename << ":"
-                                << file.errorString();
-                    return false;
-                }
-                return file.commit();
-            }
+    if (!s.is_valid())
+        return QString();
+    s.set(kShotcutProjectAudioChannels, m_audioChannels);
+    s.set(kShotcutProjectFolder, m_projectFolder.isEmpty() ? 0 : 1);
+    s.set(kShotcutProjectProcessingMode,
+          Settings.processingModeStr(Settings.processingMode()).toUtf8().constData());
+    if (!projectNote.isEmpty()) {
+        s.set(kShotcutProjectNote, projectNote.toUtf8().constData());
+    } else {
+        s.clear(kShotcutProjectNote);
+    }
+    int ignore = s.get_int("ignore_points");
+    if (ignore)
+        s.set("ignore_points", 0);
+    c.set("time_format", "clock");
+    c.set("store", "shotcut");
+    c.set("root", root.toUtf8().constData());
+    c.set("no_root", 1);
+    c.set("title", QStringLiteral("Shotcut version ").append(SHOTCUT_VERSION).toUtf8().constData());
+
+    // Save the consumer of this service so it can be restored.
+    auto saveConsumer = mlt_service_consumer(s.consumer()->get_service());
+    c.connect(s);
+    c.start();
+    if (ignore)
+        s.set("ignore_points", ignore);
+    auto xml = QString::fromUtf8(c.get(kMltXmlPropertyName));
+    // Restore the consumer that was previously on this service
+    mlt_service_set_consumer(s.get_service(), saveConsumer);
+    return xml;
+}
+
+bool Controller::writeXML(QString xml,
+                          const QString &filename,
+                          const QString &root,
+                          QTemporaryFile *tempFile)
+{
+    RenderPreview::filterXML(xml);
+    FilterChainOptimizer::filterXML(xml);
+    if (tempFile) {
+        // The proxies are replaced while the XML is written so that the document is not
+        // copied again.
+        const auto start = tempFile->pos();
+        if (!ProxyManager::filterXML(xml, root, tempFile)) { // also verifies
+            if (tempFile->error() != QFileDevice::NoError)
+                LOG_ERROR() << "error while writing MLT XML file" << tempFile->fileName() << ":"
+                            << tempFile->errorString();
+            tempFile->resize(start);
+            tempFile->seek(start);
+            return false;
         }
+        return tempFile->flush();
     }
-    return false;
+    if (ProjectArchive::isArchive(filename)) {
+        if (!ProxyManager::filterXML(xml, root)) // also verifies
+            return false;
+        return ProjectArchive::write(filename, xml);
+    }
+    QSaveFile file(filename);
+    file.setDirectWriteFallback(true);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR() << "failed to open MLT XML file for writing" << filename;
+        return false;
+    }
+    if (!ProxyManager::filterXML(xml, root, &file)) { // also verifies
+        if (file.error() != QFileDevice::NoError)
+            LOG_ERROR() << "error while writing MLT XML file" << filename << ":"
+                        << file.errorString();
+        // Leaves the previous file as it was.
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
 }
 
 QString Controller::XML(Service *service, bool withProfile, bool withMetadata)
@@ -573,7 +645,10 @@ QString Controller::XML(Service *service, bool withProfile, bool withMetadata)
         s.set("ignore_points", ignore);
     // Restore the consumer that was previously on this service
     mlt_service_set_consumer(s.get_service(), saveConsumer);
-    return QString::fromUtf8(c.get(kMltXmlPropertyName));
+    auto xml = QString::fromUtf8(c.get(kMltXmlPropertyName));
+    RenderPreview::filterXML(xml);
+    FilterChainOptimizer::filterXML(xml);
+    return xml;
 }
 
 int Controller::consumerChanged()
@@ -645,6 +720,20 @@ void Controller::setProcessingMode(ShotcutSettings::ProcessingMode mode)
     }
 }
 
+void Controller::updateChainImageFormat()
+{
+    if (!m_consumer || !m_producer || !m_producer->is_valid())
+        return;
+    if (m_processingMode != ShotcutSettings::Native10Cpu
+        && m_processingMode != ShotcutSettings::Linear10Cpu)
+        return;
+    const bool isEightBit = isClip() && FilterChainOptimizer::isEightBitOutput(*m_producer);
+    if (isEightBit != m_isEightBitChain) {
+        LOG_DEBUG() << "the filters now end in" << (isEightBit ? "8-bit" : "10-bit");
+        consumerChanged();
+    }
+}
+
 QString Controller::resource() const
 {
     QString resource;
@@ -925,9 +1014,15 @@ QImage Controller::image(Mlt::Frame *frame, int width, int height)
         mlt_image_format format = mlt_image_rgba;
         const uchar *image = frame->get_image(format, width, height);
         if (image) {
-            QImage temp(width, height, QImage::Format_ARGB32);
-            memcpy(temp.scanLine(0), image, size_t(width * height * 4));
-            result = temp.rgbSwapped();
+            // Wrap the frame's buffer without copying. The image holds a reference
+            // to the frame until it is destroyed and detaches if it is modified.
+            result = QImage(image,
+                            width,
+                            height,
+                            width * 4,
+                            QImage::Format_RGBA8888,
+                            deleteFrame,
+                            new Mlt::Frame(*frame));
         }
     } else {
         result = QImage(width, height, QImage::Format_ARGB32);
@@ -936,10 +1031,16 @@ QImage Controller::image(Mlt::Frame *frame, int width, int height)
     return result;
 }
 
-QImage Controller::image(Producer &producer, int frameNumber, int width, int height)
+QImage Controller::image(
+    Producer &producer, int frameNumber, int width, int height, bool isFastSeek)
 {
     QImage result;
-    if (frameNumber > producer.get_length() - kThumbnailOutSeekFactor) {
+    if (isFastSeek) {
+        // Accept whatever frame the decoder lands on without extra decoding.
+        producer.seek(qBound(0, frameNumber, producer.get_length() - 1));
+        QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+        result = image(frame.data(), width, height);
+    } else if (frameNumber > producer.get_length() - kThumbnailOutSeekFactor) {
         producer.seek(frameNumber - kThumbnailOutSeekFactor - 1);
         for (int i = 0; i < kThumbnailOutSeekFactor; ++i) {
             QScopedPointer<Mlt::Frame> frame(producer.get_frame());
@@ -952,13 +1053,46 @@ QImage Controller::image(Producer &producer, int frameNumber, int width, int hei
         QScopedPointer<Mlt::Frame> frame(producer.get_frame());
         result = image(frame.data(), width, height);
     }
+    // Thumbnails usually outlive the producer, and a frame may reference
+    // caches owned by its producer, so detach with a single copy.
+    result.detach();
     return result;
 }
 
 void Controller::updateAvformatCaching(int trackCount)
 {
-    int i = QThreadPool::globalInstance()->maxThreadCount() + trackCount * 2;
-    mlt_service_cache_set_size(nullptr, "producer_avformat", qMax(4, i));
+    AvformatCache::singleton().setTrackCount(trackCount);
+}
+
+void Controller::initRepository()
+{
+    if (g_repository.isValid())
+        return;
+    ::qputenv("MLT_REPOSITORY_DENY", "libmltqt:libmltglaxnimate");
+    updateHardwareDecoding();
+    g_repository = QtConcurrent::run([]() {
+        StartupProfile::Phase phase("MLT repository");
+        return Mlt::Factory::init();
+    });
+}
+
+void Controller::updateHardwareDecoding()
+{
+    // The avformat producer takes its default hwaccel from the environment.
+    if (Settings.playerHardwareDecode()) {
+#if defined(Q_OS_WIN)
+        ::qputenv(MLT_HWACCEL_NAME, "d3d11va");
+#elif defined(Q_OS_MAC)
+        ::qputenv(MLT_HWACCEL_NAME, "videotoolbox");
+#else
+        ::qputenv(MLT_HWACCEL_NAME, "vaapi");
+        ::qputenv(MLT_HWACCEL_DEVICE_NAME, "/dev/dri/renderD128");
+#endif
+    } else {
+        ::qunsetenv(MLT_HWACCEL_NAME);
+        ::qunsetenv(MLT_HWACCEL_DEVICE_NAME);
+    }
+    LOG_INFO() << "hardware decoding" << qgetenv(MLT_HWACCEL_NAME);
 }
 
 bool Controller::isAudioFilter(const QString &name)
@@ -1140,7 +1274,7 @@ void Controller::copyFilters(Producer &fromProducer,
                 continue;
             }
 
-            if (filterIndex == FILTER_INDEX_ENABLED && fromFilter->get_int("disable")) {
+            if (filterIndex == FILTER_INDEX_ENABLED && FilterChainOptimizer::isDisabled(*fromFilter)) {
                 continue;
             }
 
@@ -1164,6 +1298,7 @@ void Controller::copyFilters(Producer &fromProducer,
             if (toFilter.is_valid()) {
                 toFilter.inherit(*fromFilter);
                 toFilter.clear("disable");
+                toFilter.clear(kShotcutIdentityProperty);
                 // Force any 2-pass filters to require re-analysis
                 toFilter.clear("results");
                 toProducer.attach(toFilter);
@@ -1713,6 +1848,7 @@ void Controller::updatePreviewProfile()
 
 void Controller::purgeMemoryPool()
 {
+    PerformanceCounters::add(PerformanceCounters::MemoryPoolPurges);
     ::mlt_pool_purge();
 }
 
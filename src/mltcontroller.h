@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -23,6 +23,7 @@
 #include "settings.h"
 
 #include <Mlt.h>
+#include <QFuture>
 #include <QImage>
 #include <QMutex>
 #include <QScopedPointer>
@@ -30,8 +31,12 @@
 #include <QTemporaryFile>
 #include <QUuid>
 
+#include <functional>
+
 #define MLT_LC_CATEGORY LC_ALL
 #define MLT_LC_NAME "LC_ALL"
+#define MLT_HWACCEL_NAME "MLT_AVFORMAT_HWACCEL"
+#define MLT_HWACCEL_DEVICE_NAME "MLT_AVFORMAT_HWACCEL_DEVICE"
 
 #define kAudioIndexProperty "astream"
 #define kVideoIndexProperty "vstream"
@@ -40,6 +45,8 @@ namespace Mlt {
 
 const int kMaxImageDurationSecs = 3600 * 4;
 extern const QString XmlMimeType;
+//! Holds the UUID of the producer in a drag that started in the player.
+extern const QString PlayerMimeType;
 
 class TransportControl : public TransportControllable
 {
@@ -92,17 +99,36 @@ public:
     void onWindowResize();
     virtual void seek(int position);
     virtual void refreshConsumer(bool scrubAudio = false);
+    //! What an edit of the state of a track changes in the output
+    enum TrackChange { TrackVideoChange = 1, TrackAudioChange = 2 };
+    /*!
+      Refreshes after the state of a track, such as mute or hide, was set in
+      place on the producer. \a edit makes the same change to a copy of the
+      producer. \a changes is a combination of TrackChange.
+    */
+    virtual void refreshTrack(int changes, const std::function<void(Mlt::Producer &)> &edit);
     bool saveXML(const QString &filename,
                  Service *service = nullptr,
                  bool withRelativePaths = true,
                  QTemporaryFile *tempFile = nullptr,
                  bool proxy = false,
                  QString projectNote = QString());
+    /*!
+      Serializes \a service on the calling thread like saveXML() but filters
+      and writes the XML to \a filename on a worker thread. The future is true
+      when the file was written.
+    */
+    QFuture<bool> saveXMLAsync(const QString &filename,
+                               Service *service = nullptr,
+                               bool withRelativePaths = true,
+                               QString projectNote = QString());
     QString XML(Service *service = nullptr, bool withProfile = false, bool withMetadata = true);
     int consumerChanged();
     void setProfile(const QString &profile_name);
     void setAudioChannels(int audioChannels);
     void setProcessingMode(ShotcutSettings::ProcessingMode mode);
+    //! Restarts the consumer if the filters of the clip now end in another bit depth.
+    void updateChainImageFormat();
     QString resource() const;
     bool isSeekable(Mlt::Producer *p = nullptr) const;
     int maxFrameCount() const;
@@ -124,9 +150,20 @@ public:
     void fixLengthProperties(Service &service);
     void reload(const QString &xml);
     void resetURL();
+    /// The returned image shares the frame's RGBA buffer and keeps a reference
+    /// to the frame; it must not outlive the producer of the frame.
     QImage image(Frame *frame, int width, int height);
-    QImage image(Mlt::Producer &producer, int frameNumber, int width, int height);
+    QImage image(
+        Mlt::Producer &producer, int frameNumber, int width, int height, bool isFastSeek = false);
     void updateAvformatCaching(int trackCount);
+    //! Makes avformat producers opened from now on decode video on the GPU or not.
+    static void updateHardwareDecoding();
+    /*!
+      Starts scanning the MLT plugins on a worker thread so that the scan
+      overlaps the rest of startup. The controller waits for it when it is
+      created and starts it if nobody did.
+    */
+    static void initRepository();
     bool isAudioFilter(const QString &name);
     int realTime() const;
     void setImageDurationFromDefault(Service *service) const;
@@ -192,6 +229,8 @@ protected:
     Mlt::Repository *m_repo;
     QScopedPointer<Mlt::Producer> m_producer;
     QScopedPointer<Mlt::FilteredConsumer> m_consumer;
+    //! Whether the consumer outputs 8-bit because the filters of the clip end in 8-bit
+    bool m_isEightBitChain{false};
 
 private:
     Mlt::Profile m_profile;
@@ -207,6 +246,16 @@ private:
     unsigned m_skipJackEvents{0};
     QString m_projectFolder;
     QMutex m_saveXmlMutex;
+
+    QString serializeXML(const QString &filename,
+                         Service *service,
+                         const QString &root,
+                         bool proxy,
+                         const QString &projectNote);
+    static bool writeXML(QString xml,
+                         const QString &filename,
+                         const QString &root,
+                         QTemporaryFile *tempFile);
     bool m_blockRefresh;
 
     static void on_jack_started(mlt_properties owner, void *object, mlt_event_data data);
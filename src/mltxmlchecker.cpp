@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,6 +19,8 @@
 
 #include "Logger.h"
 #include "mltcontroller.h"
+#include "probecache.h"
+#include "projectarchive.h"
 #include "proxymanager.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
@@ -30,6 +32,7 @@
 #include <QRegularExpression>
 #include <QUrl>
 
+#include <algorithm>
 #include <clocale>
 #include <utime.h>
 
@@ -73,12 +76,29 @@ QXmlStreamReader::Error MltXmlChecker::check(const QString &fileName)
     LOG_DEBUG() << "begin";
 
     QFile file(fileName);
-    m_tempFile.reset(new QTemporaryFile(QFileInfo(fileName).dir().filePath("shotcut-XXXXXX.mlt")));
-    if (file.open(QIODevice::ReadOnly | QIODevice::Text) && m_tempFile->open()) {
-        m_tempFile->resize(0);
+    QByteArray data;
+    QBuffer input(&data);
+    m_tempFile.reset();
+    m_buffer.close();
+    m_buffer.setData(QByteArray());
+    // Read the file in one go, which is much faster on network storage, and
+    // write the corrected copy to memory.
+    bool isOpen = file.open(QIODevice::ReadOnly);
+    if (isOpen) {
+        data = file.readAll();
+        file.close();
+        // MLT reads only plain XML, so a compressed project opens from the
+        // corrected copy.
+        if (ProjectArchive::isArchive(fileName)) {
+            data = ProjectArchive::read(fileName);
+            m_isUpdated = true;
+        }
+    }
+    if (isOpen && input.open(QIODevice::ReadOnly) && m_buffer.open(QIODevice::WriteOnly)) {
+        m_buffer.buffer().reserve(data.size() + data.size() / 8);
         m_fileInfo = QFileInfo(fileName);
-        m_xml.setDevice(&file);
-        m_newXml.setDevice(m_tempFile.data());
+        m_xml.setDevice(&input);
+        m_newXml.setDevice(&m_buffer);
         m_newXml.setAutoFormatting(true);
         m_newXml.setAutoFormattingIndent(2);
         if (m_xml.readNextStartElement()) {
@@ -107,6 +127,8 @@ QXmlStreamReader::Error MltXmlChecker::check(const QString &fileName)
                     }
                 }
                 if (!checkMltVersion()) {
+                    m_buffer.close();
+                    m_xml.setDevice(nullptr);
                     return QXmlStreamReader::CustomError;
                 }
 
@@ -119,22 +141,38 @@ QXmlStreamReader::Error MltXmlChecker::check(const QString &fileName)
             }
         }
     }
-    LOG_DEBUG() << m_tempFile->fileName();
-    if (m_tempFile->isOpen()) {
-        m_tempFile->close();
+    if (m_buffer.isOpen()) {
+        m_buffer.close();
 
         // Useful for debugging
-        //        m_tempFile->open();
-        //        LOG_DEBUG() << m_tempFile->readAll().constData();
-        //        m_tempFile->close();
+        //        LOG_DEBUG() << m_buffer.data().constData();
+    }
+    // The reader must not keep the local buffer, and that clears its error.
+    auto error = m_xml.error();
+    m_errorString = m_xml.errorString();
+    m_xml.setDevice(nullptr);
+    LOG_DEBUG() << "end" << m_errorString;
+    return error;
+}
+
+QString MltXmlChecker::tempFileName()
+{
+    if (!m_tempFile) {
+        m_tempFile.reset(new QTemporaryFile(m_fileInfo.dir().filePath("shotcut-XXXXXX.mlt")));
+        if (m_tempFile->open()) {
+            m_tempFile->write(m_buffer.data());
+            m_tempFile->close();
+        } else {
+            LOG_WARNING() << "failed to create" << m_tempFile->fileTemplate();
+        }
+        LOG_DEBUG() << m_tempFile->fileName();
     }
-    LOG_DEBUG() << "end" << m_xml.errorString();
-    return m_xml.error();
+    return m_tempFile->fileName();
 }
 
 QString MltXmlChecker::errorString() const
 {
-    return m_xml.errorString();
+    return m_errorString;
 }
 
 void MltXmlChecker::readMlt()
@@ -249,15 +287,36 @@ void MltXmlChecker::processProperties()
         bool proxyEnabled = Settings.proxyEnabled();
         if (proxyEnabled)
             checkForProxy(mlt_service, newProperties);
+        if (Settings.proxyMediaCache())
+            checkForMediaCache(mlt_service, newProperties);
 
         // Second pass: amend property values.
         bool relinkMismatch = !m_resource.hash.isEmpty() && !m_resource.newHash.isEmpty()
                               && m_resource.hash != m_resource.newHash;
+        // A file producer that already knows its length need not open the
+        // file until it renders a frame, and the avformat cache closes it
+        // again when too many are open. Re-linked files are probed again.
+        bool isDeferrable = (mlt_class == "producer" || mlt_class == "chain")
+                            && m_resource.newHash.isEmpty() && m_resource.info.exists();
+        if (isDeferrable) {
+            isDeferrable = std::any_of(newProperties.cbegin(),
+                                       newProperties.cend(),
+                                       [](const MltProperty &p) { return p.first == "length"; });
+        }
+        // The project does not save what avformat probed, but the probe cache may have it.
+        ProbeCache::Properties probed;
+        if (isDeferrable && mlt_service.startsWith("avformat") && !m_resource.isProxy
+            && !m_resource.notProxyMeta) {
+            probed = PROBES.properties(m_resource.info.absoluteFilePath());
+        }
         m_properties = newProperties;
         newProperties.clear();
         foreach (MltProperty p, m_properties) {
             // Fix some properties if re-linked file.
-            if (p.first == kShotcutHashProperty) {
+            if (p.first == "mlt_service") {
+                if (isDeferrable && p.second == "avformat")
+                    p.second = "avformat-novalidate";
+            } else if (p.first == kShotcutHashProperty) {
                 if (!m_resource.newHash.isEmpty())
                     p.second = m_resource.newHash;
             } else if (p.first == kShotcutCaptionProperty) {
@@ -288,7 +347,10 @@ void MltXmlChecker::processProperties()
 
             if (!p.second.isEmpty())
                 newProperties << MltProperty(p.first, p.second);
+            probed.remove(p.first);
         }
+        for (auto it = probed.constBegin(); it != probed.constEnd(); ++it)
+            newProperties << MltProperty(it.key(), it.value());
     }
 
     // Write all of the properties.
@@ -648,7 +710,7 @@ void MltXmlChecker::replaceWebVfxChoppyFilter(QString &mlt_service,
                         pathName = pathName.mid(plain.size());
                     }
                     if (QFileInfo(pathName).isRelative()) {
-                        QDir projectDir(QFileInfo(m_tempFile->fileName()).dir());
+                        QDir projectDir(m_fileInfo.dir());
                         pathName = projectDir.filePath(pathName);
                     }
                     QFile file(pathName);
@@ -729,20 +791,14 @@ void MltXmlChecker::checkForProxy(const QString &mlt_service,
             }
         }
 
-        QDir proxyDir(Settings.proxyFolder());
-        QDir projectDir(QFileInfo(m_tempFile->fileName()).dir());
-        QString fileName = hash + ProxyManager::videoFilenameExtension();
-        projectDir.cd("proxies");
-        if (proxyDir.exists(fileName) || projectDir.exists(fileName)) {
-            ::utime(proxyDir.filePath(fileName).toUtf8().constData(), nullptr);
-            ::utime(projectDir.filePath(fileName).toUtf8().constData(), nullptr);
+        const QString fileName = ProxyManager::existingFile(hash,
+                                                            ProxyManager::videoFilenameExtension(),
+                                                            m_fileInfo.absolutePath());
+        if (!fileName.isEmpty()) {
+            ::utime(fileName.toUtf8().constData(), nullptr);
             for (auto &p : properties) {
                 if (p.first == "resource") {
-                    if (projectDir.exists(fileName)) {
-                        p.second = projectDir.filePath(fileName);
-                    } else {
-                        p.second = proxyDir.filePath(fileName);
-                    }
+                    p.second = fileName;
                     if (isTimewarp) {
                         p.second = QStringLiteral("%1:%2").arg(speed, p.second);
                     }
@@ -771,20 +827,14 @@ void MltXmlChecker::checkForProxy(const QString &mlt_service,
                 return;
             }
         }
-        QDir proxyDir(Settings.proxyFolder());
-        QDir projectDir(QFileInfo(m_tempFile->fileName()).dir());
-        QString fileName = hash + ProxyManager::imageFilenameExtension();
-        projectDir.cd("proxies");
-        if (proxyDir.exists(fileName) || projectDir.exists(fileName)) {
-            ::utime(proxyDir.filePath(fileName).toUtf8().constData(), nullptr);
-            ::utime(projectDir.filePath(fileName).toUtf8().constData(), nullptr);
+        const QString fileName = ProxyManager::existingFile(hash,
+                                                            ProxyManager::imageFilenameExtension(),
+                                                            m_fileInfo.absolutePath());
+        if (!fileName.isEmpty()) {
+            ::utime(fileName.toUtf8().constData(), nullptr);
             for (auto &p : properties) {
                 if (p.first == "resource") {
-                    if (projectDir.exists(fileName)) {
-                        p.second = projectDir.filePath(fileName);
-                    } else {
-                        p.second = proxyDir.filePath(fileName);
-                    }
+                    p.second = fileName;
                     break;
                 }
             }
@@ -797,6 +847,45 @@ void MltXmlChecker::checkForProxy(const QString &mlt_service,
     }
 }
 
+void MltXmlChecker::checkForMediaCache(const QString &mlt_service,
+                                       QVector<MltXmlChecker::MltProperty> &properties)
+{
+    if (!mlt_service.startsWith("avformat"))
+        return;
+    QString resource;
+    for (auto &p : properties) {
+        if (p.first == "resource") {
+            resource = p.second;
+            if (!isNetworkResource(resource)) {
+                QFileInfo info(resource);
+                if (info.isRelative())
+                    info.setFile(m_fileInfo.canonicalPath(), resource);
+                resource = info.filePath();
+            }
+        } else if ((p.first == kIsProxyProperty || p.first == kDisableProxyProperty)
+                   && p.second == "1") {
+            // A proxy is already smaller than the copy.
+            return;
+        }
+    }
+    if (!ProxyManager::isRemote(resource))
+        return;
+    const QString fileName = ProxyManager::mediaCacheFile(resource);
+    if (!QFile::exists(fileName))
+        return;
+    ::utime(fileName.toUtf8().constData(), nullptr);
+    for (auto &p : properties) {
+        if (p.first == "resource") {
+            p.second = fileName;
+            break;
+        }
+    }
+    properties << MltProperty(kIsProxyProperty, "1");
+    properties << MltProperty(kMediaCacheProperty, "1");
+    properties << MltProperty(kOriginalResourceProperty, resource);
+    m_isUpdated = true;
+}
+
 bool MltXmlChecker::checkMltVersion()
 {
     if (m_mltVersion.majorVersion() > 7) {
@@ -18,6 +18,7 @@
 #ifndef MLTXMLCHECKER_H
 #define MLTXMLCHECKER_H
 
+#include <QBuffer>
 #include <QFileInfo>
 #include <QPair>
 #include <QStandardItemModel>
@@ -45,7 +46,11 @@ public:
     bool hasEffects() const { return m_hasEffects; }
     bool isCorrected() const { return m_isCorrected; }
     bool isUpdated() const { return m_isUpdated; }
-    QTemporaryFile &tempFile() const { return *m_tempFile; }
+    //! Returns the corrected XML of the last check, which is kept in memory.
+    const QByteArray &xml() const { return m_buffer.data(); }
+    //! Writes the corrected XML to a temporary file beside the checked file,
+    //! once per check, and returns its name.
+    QString tempFileName();
     QStandardItemModel &unlinkedFilesModel() { return m_unlinkedFilesModel; }
     QString shotcutVersion() const { return m_shotcutVersion; }
 
@@ -70,6 +75,7 @@ private:
     void replaceWebVfxCropFilters(QString &mlt_service, QVector<MltProperty> &properties);
     void replaceWebVfxChoppyFilter(QString &mlt_service, QVector<MltProperty> &properties);
     void checkForProxy(const QString &mlt_service, QVector<MltProperty> &properties);
+    void checkForMediaCache(const QString &mlt_service, QVector<MltProperty> &properties);
     bool checkMltVersion();
 
     QXmlStreamReader m_xml;
@@ -80,6 +86,8 @@ private:
     bool m_isCorrected;
     bool m_isUpdated;
     QChar m_decimalPoint;
+    QBuffer m_buffer;
+    QString m_errorString;
     QScopedPointer<QTemporaryFile> m_tempFile;
     bool m_numericValueChanged;
     QFileInfo m_fileInfo;
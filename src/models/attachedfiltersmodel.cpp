@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,6 +20,7 @@
 #include "Logger.h"
 #include "commands/filtercommands.h"
 #include "controllers/filtercontroller.h"
+#include "filterchainoptimizer.h"
 #include "mainwindow.h"
 #include "mltcontroller.h"
 #include "qmltypes/qmlapplication.h"
@@ -125,7 +126,16 @@ static int mltLinkIndex(Mlt::Producer *producer, int row)
 AttachedFiltersModel::AttachedFiltersModel(QObject *parent)
     : QAbstractListModel(parent)
     , m_dropRow(-1)
-{}
+{
+    // Connected first so that a filter is skipped before the change refreshes the player.
+    connect(this, &AttachedFiltersModel::changed, this, [this]() {
+        if (!m_producer)
+            return;
+        FilterChainOptimizer::optimize(*m_producer);
+        if (isSourceClip())
+            MLT.updateChainImageFormat();
+    });
+}
 
 Mlt::Service *AttachedFiltersModel::getService(int row) const
 {
@@ -224,7 +234,7 @@ QVariant AttachedFiltersModel::data(const QModelIndex &index, int role) const
     case Qt::CheckStateRole: {
         Mlt::Service *service = getService(index.row());
         QVariant result = Qt::Unchecked;
-        if (service && service->is_valid() && !service->get_int("disable"))
+        if (service && service->is_valid() && !FilterChainOptimizer::isDisabled(*service))
             result = Qt::Checked;
         delete service;
         return result;
@@ -262,7 +272,7 @@ bool AttachedFiltersModel::setData(const QModelIndex &index, const QVariant &, i
     int mltIndex = mltFilterIndex(m_producer.data(), index.row());
     Mlt::Filter *filter = m_producer->filter(mltIndex);
     if (filter && filter->is_valid()) {
-        bool disabled = filter->get_int("disable");
+        bool disabled = FilterChainOptimizer::isDisabled(*filter);
         if (isSourceClip()) {
             doSetDisabled(*m_producer.data(), index.row(), !disabled);
         } else {
@@ -282,6 +292,7 @@ void AttachedFiltersModel::doSetDisabled(Mlt::Producer &producer, int row, bool
     Mlt::Filter *filter = producer.filter(mltIndex);
     if (filter->is_valid()) {
         filter->set("disable", disabled);
+        filter->clear(kShotcutIdentityProperty);
         emit changed();
         if (isProducerLoaded(producer)) {
             Q_ASSERT(row >= 0);
@@ -751,52 +762,81 @@ void AttachedFiltersModel::pasteFilters()
 
 void AttachedFiltersModel::reset(Mlt::Producer *producer)
 {
-    beginResetModel();
-    m_event.reset();
+    QScopedPointer<Mlt::Producer> newProducer;
     if (producer && producer->is_valid())
-        m_producer.reset(new Mlt::Producer(producer));
+        newProducer.reset(new Mlt::Producer(producer));
     else if (MLT.isClip() && !MLT.isClosedClip())
-        m_producer.reset(new Mlt::Producer(MLT.producer()));
+        newProducer.reset(new Mlt::Producer(MLT.producer()));
+    MetadataList metaList;
+    if (newProducer && newProducer->is_valid())
+        metaList = metadataList(*newProducer);
+
+    // Stepping through clips that have the same filters only replaces the
+    // services behind the rows, which keeps the delegates of the view.
+    if (m_producer && m_producer->is_valid() && newProducer && newProducer->is_valid()
+        && !metaList.isEmpty() && metaList == m_metaList) {
+        m_event.reset();
+        m_producer.swap(newProducer);
+        listen();
+        emit dataChanged(index(0), index(m_metaList.size() - 1));
+        emit trackTitleChanged();
+        emit isProducerSelectedChanged();
+        emit supportsLinksChanged();
+        emit producerReplaced();
+        return;
+    }
+
+    beginResetModel();
+    m_event.reset();
+    m_producer.swap(newProducer);
+    m_metaList = metaList;
+    if (m_producer && m_producer->is_valid())
+        listen();
     else
         m_producer.reset();
-    m_metaList.clear();
+    endResetModel();
+    emit trackTitleChanged();
+    emit isProducerSelectedChanged();
+    emit supportsLinksChanged();
+}
 
-    if (m_producer && m_producer->is_valid()) {
-        Mlt::Event *event = m_producer->listen("service-changed",
-                                               this,
-                                               (mlt_listener) AttachedFiltersModel::producerChanged);
-        m_event.reset(event);
-        int count = 0;
-        if (m_producer->type() == mlt_service_chain_type) {
-            Mlt::Chain chain(*m_producer.data());
-            count = chain.link_count();
-            for (int i = 0; i < count; i++) {
-                Mlt::Link *link = chain.link(i);
-                if (link && link->is_valid()) {
-                    if (!link->get_int("_loader")) {
-                        QmlMetadata *newMeta = MAIN.filterController()->metadataForService(link);
-                        m_metaList.append(newMeta);
-                    }
+AttachedFiltersModel::MetadataList AttachedFiltersModel::metadataList(Mlt::Producer &producer)
+{
+    MetadataList result;
+    if (producer.type() == mlt_service_chain_type) {
+        Mlt::Chain chain(producer);
+        int count = chain.link_count();
+        for (int i = 0; i < count; i++) {
+            Mlt::Link *link = chain.link(i);
+            if (link && link->is_valid()) {
+                if (!link->get_int("_loader")) {
+                    QmlMetadata *newMeta = MAIN.filterController()->metadataForService(link);
+                    result.append(newMeta);
                 }
-                delete link;
             }
+            delete link;
         }
-        count = m_producer->filter_count();
-        for (int i = 0; i < count; i++) {
-            Mlt::Filter *filter = m_producer->filter(i);
-            if (filter && filter->is_valid() && !filter->get_int("_loader")
-                && !filter->get_int(kShotcutHiddenProperty)) {
-                QmlMetadata *newMeta = MAIN.filterController()->metadataForService(filter);
-                m_metaList.append(newMeta);
-            }
-            delete filter;
+    }
+    int count = producer.filter_count();
+    for (int i = 0; i < count; i++) {
+        Mlt::Filter *filter = producer.filter(i);
+        if (filter && filter->is_valid() && !filter->get_int("_loader")
+            && !filter->get_int(kShotcutHiddenProperty)) {
+            QmlMetadata *newMeta = MAIN.filterController()->metadataForService(filter);
+            result.append(newMeta);
+            FilterChainOptimizer::optimize(*filter, newMeta);
         }
+        delete filter;
     }
+    return result;
+}
 
-    endResetModel();
-    emit trackTitleChanged();
-    emit isProducerSelectedChanged();
-    emit supportsLinksChanged();
+void AttachedFiltersModel::listen()
+{
+    Mlt::Event *event = m_producer->listen("service-changed",
+                                           this,
+                                           (mlt_listener) AttachedFiltersModel::producerChanged);
+    m_event.reset(event);
 }
 
 Mlt::Producer AttachedFiltersModel::getFilterSetProducer(QmlMetadata *meta)
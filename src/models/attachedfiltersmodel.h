@@ -79,6 +79,8 @@ signals:
     void supportsLinksChanged();
     void addedOrRemoved(Mlt::Producer *);
     void requestConvert(QString, bool set709Convert, bool withSubClip);
+    //! Emitted instead of a model reset when the new producer has the same filters.
+    void producerReplaced();
 
 public slots:
     int add(QmlMetadata *meta);
@@ -100,6 +102,9 @@ private:
     QScopedPointer<Mlt::Event> m_event;
     typedef QList<QmlMetadata *> MetadataList;
     MetadataList m_metaList;
+
+    MetadataList metadataList(Mlt::Producer &producer);
+    void listen();
 };
 
 #endif // ATTACHEDFILTERSMODEL_H
@@ -0,0 +1,266 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audiolevels.h"
+
+#include <QtMath>
+
+#include <cstring>
+
+class AudioLevelsData : public QSharedData
+{
+public:
+    AudioLevelsData(int channels)
+        : channels(channels)
+        , used(0)
+    {}
+    int channels;
+    // The number of values written; copies never read beyond their own size.
+    int used;
+    QVector<quint8> values;
+};
+
+AudioLevels::AudioLevels()
+    : m_size(0)
+{}
+
+AudioLevels::AudioLevels(int channels, int reserveFrames)
+    : d(new AudioLevelsData(qMax(1, channels)))
+    , m_size(0)
+{
+    d->values.resize(qMax(0, reserveFrames) * d->channels);
+}
+
+AudioLevels::AudioLevels(int channels, const QVector<quint8> &values)
+    : d(new AudioLevelsData(qMax(1, channels)))
+    , m_size(values.size())
+{
+    d->values = values;
+    d->used = m_size;
+}
+
+AudioLevels::AudioLevels(const AudioLevels &other)
+    : d(other.d)
+    , m_size(other.m_size)
+    , m_pyramid(other.m_pyramid)
+    , m_prioritizer(other.m_prioritizer)
+{}
+
+AudioLevels::~AudioLevels() {}
+
+AudioLevels &AudioLevels::operator=(const AudioLevels &other)
+{
+    d = other.d;
+    m_size = other.m_size;
+    m_pyramid = other.m_pyramid;
+    m_prioritizer = other.m_prioritizer;
+    return *this;
+}
+
+int AudioLevels::channels() const
+{
+    return d ? d->channels : 0;
+}
+
+int AudioLevels::frameCount() const
+{
+    return d ? m_size / d->channels : 0;
+}
+
+quint8 AudioLevels::at(int index) const
+{
+    Q_ASSERT(index >= 0 && index < m_size);
+    return d->values.constData()[index];
+}
+
+const quint8 *AudioLevels::constData() const
+{
+    return d ? d->values.constData() : nullptr;
+}
+
+void AudioLevels::append(quint8 value)
+{
+    if (!d)
+        d = new AudioLevelsData(1);
+    if (m_size != d->used) {
+        // Another copy has appended since this one was made.
+        detach(qMax(m_size * 2, 1024));
+    } else if (m_size >= d->values.size()) {
+        if (d->ref.loadRelaxed() > 1) {
+            // Others are reading the buffer, so it cannot be reallocated.
+            detach(qMax(m_size * 2, 1024));
+        } else {
+            d->values.resize(qMax(m_size * 2, 1024));
+        }
+    }
+    d->values.data()[m_size++] = value;
+    d->used = m_size;
+    m_pyramid.reset();
+}
+
+void AudioLevels::detach(int capacity)
+{
+    auto data = new AudioLevelsData(d->channels);
+    data->values.resize(qMax(capacity, m_size));
+    if (m_size > 0)
+        ::memcpy(data->values.data(), d->values.constData(), m_size);
+    data->used = m_size;
+    d = data;
+}
+
+void AudioLevels::buildPyramid()
+{
+    const int channels = this->channels();
+    int frames = frameCount();
+    auto pyramid = new Pyramid;
+    const quint8 *peak = constData();
+    const quint8 *minimum = peak;
+    const quint8 *rms = peak;
+    while (frames > 1) {
+        const int buckets = (frames + 1) / 2;
+        QVector<quint8> peakLevel(buckets * channels);
+        QVector<quint8> minimumLevel(buckets * channels);
+        QVector<quint8> rmsLevel(buckets * channels);
+        for (int b = 0; b < buckets; ++b) {
+            const int a = 2 * b * channels;
+            // An odd frame at the end is its own bucket.
+            const int z = (2 * b + 1 < frames) ? a + channels : a;
+            for (int c = 0; c < channels; ++c) {
+                const int i = b * channels + c;
+                peakLevel[i] = qMax(peak[a + c], peak[z + c]);
+                minimumLevel[i] = qMin(minimum[a + c], minimum[z + c]);
+                const qreal r1 = rms[a + c];
+                const qreal r2 = rms[z + c];
+                rmsLevel[i] = quint8(qMin(255.0, qSqrt((r1 * r1 + r2 * r2) / 2.0)));
+            }
+        }
+        pyramid->peak << peakLevel;
+        pyramid->minimum << minimumLevel;
+        pyramid->rms << rmsLevel;
+        peak = pyramid->peak.last().constData();
+        minimum = pyramid->minimum.last().constData();
+        rms = pyramid->rms.last().constData();
+        frames = buckets;
+    }
+    m_pyramid.reset(pyramid);
+}
+
+quint8 AudioLevels::summary(int fromFrame, int toFrame, Statistic statistic) const
+{
+    const int channels = this->channels();
+    const int frames = frameCount();
+    if (frames <= 0)
+        return 0;
+    fromFrame = qBound(0, fromFrame, frames - 1);
+    toFrame = qBound(fromFrame + 1, toFrame, frames);
+
+    // Choose the coarsest level whose buckets are no wider than the range.
+    int level = 0;
+    if (m_pyramid) {
+        while (level < m_pyramid->peak.size() && (2 << level) <= toFrame - fromFrame)
+            ++level;
+    }
+    const quint8 *values = constData();
+    if (level > 0) {
+        switch (statistic) {
+        case Peak:
+            values = m_pyramid->peak[level - 1].constData();
+            break;
+        case Minimum:
+            values = m_pyramid->minimum[level - 1].constData();
+            break;
+        case Rms:
+            values = m_pyramid->rms[level - 1].constData();
+            break;
+        }
+    }
+    const int first = fromFrame >> level;
+    const int last = (toFrame - 1) >> level;
+    int result = (statistic == Minimum) ? 255 : 0;
+    qreal sumOfSquares = 0.0;
+    for (int b = first; b <= last; ++b) {
+        for (int c = 0; c < channels; ++c) {
+            const int value = values[b * channels + c];
+            switch (statistic) {
+            case Peak:
+                result = qMax(result, value);
+                break;
+            case Minimum:
+                result = qMin(result, value);
+                break;
+            case Rms:
+                sumOfSquares += value * value;
+                break;
+            }
+        }
+    }
+    if (statistic == Rms)
+        result = qRound(qSqrt(sumOfSquares / ((last - first + 1) * channels)));
+    return quint8(qMin(255, result));
+}
+
+void AudioLevels::prioritize(int fromFrame, int toFrame) const
+{
+    if (m_prioritizer)
+        m_prioritizer(fromFrame, toFrame);
+}
+
+QImage AudioLevels::toImage() const
+{
+    // Pack 4 values per pixel, one row per channel.
+    const int channels = qMax(1, this->channels());
+    const int count = m_size;
+    QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
+    if (image.isNull())
+        return image;
+    const int n = image.width() * image.height();
+    const quint8 *values = constData();
+    const int last = values[count - 1];
+    for (int i = 0; i < n; i++) {
+        const int j = 4 * i;
+        QRgb p;
+        if ((j + 3) < count) {
+            p = qRgba(values[j], values[j + 1], values[j + 2], values[j + 3]);
+        } else {
+            int r = (j + 0) < count ? values[j + 0] : last;
+            int g = (j + 1) < count ? values[j + 1] : last;
+            int b = (j + 2) < count ? values[j + 2] : last;
+            p = qRgba(r, g, b, last);
+        }
+        reinterpret_cast<QRgb *>(image.scanLine(i % channels))[i / channels] = p;
+    }
+    return image;
+}
+
+AudioLevels AudioLevels::fromImage(const QImage &image, int channels)
+{
+    const int n = image.width() * image.height();
+    AudioLevels levels(channels, n * 4 / qMax(1, channels));
+    // A 1x1 image is a marker for a producer without audio.
+    if (n <= 1)
+        return levels;
+    const QImage argb = image.convertToFormat(QImage::Format_ARGB32);
+    channels = levels.channels();
+    for (int i = 0; i < n; i++) {
+        QRgb p = reinterpret_cast<const QRgb *>(argb.constScanLine(i % channels))[i / channels];
+        levels.append(qRed(p));
+        levels.append(qGreen(p));
+        levels.append(qBlue(p));
+        levels.append(qAlpha(p));
+    }
+    return levels;
+}
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOLEVELS_H
+#define AUDIOLEVELS_H
+
+#include <QExplicitlySharedDataPointer>
+#include <QImage>
+#include <QMetaType>
+#include <QSharedPointer>
+#include <QVector>
+
+#include <functional>
+
+class AudioLevelsData;
+
+/*!
+  \class AudioLevels
+  \brief The AudioLevels provides a compact, shared buffer of audio levels.
+
+  \reentrant
+
+  AudioLevels holds one 8-bit level per channel per frame, channels
+  interleaved. Copies are cheap because they share the same buffer, and each
+  copy sees only the values that existed when it was made. This makes it
+  possible for a generator thread to keep appending while it publishes
+  snapshots to other threads without copying what was already published.
+
+  Only the most recent copy that appended a value may append again without
+  detaching; any other copy makes its own buffer first.
+
+  A copy may also carry a pyramid of min, max and RMS levels where each level
+  halves the resolution of the one below it. This lets a view summarize any
+  range of frames by reading only a few values at the level that matches its
+  zoom instead of sampling the full-resolution levels.
+
+  While levels are still being generated, a snapshot may have gaps. Such a
+  snapshot reports isGenerating() and a view can ask the generator to do the
+  frames it is showing next with prioritize().
+*/
+
+class AudioLevels
+{
+public:
+    AudioLevels();
+    typedef std::function<void(int, int)> Prioritizer;
+
+    explicit AudioLevels(int channels, int reserveFrames = 0);
+    /// Shares \a values, which are frames times \a channels levels.
+    AudioLevels(int channels, const QVector<quint8> &values);
+    AudioLevels(const AudioLevels &other);
+    ~AudioLevels();
+    AudioLevels &operator=(const AudioLevels &other);
+
+    bool isEmpty() const { return m_size == 0; }
+    int channels() const;
+    /// Returns the number of values, which is frames times channels.
+    int size() const { return m_size; }
+    int frameCount() const;
+    quint8 at(int index) const;
+    const quint8 *constData() const;
+    quint8 last() const { return at(m_size - 1); }
+
+    void append(quint8 value);
+
+    enum Statistic { Peak, Minimum, Rms };
+    /// Builds the pyramid for the values currently in this copy.
+    void buildPyramid();
+    bool hasPyramid() const { return !m_pyramid.isNull(); }
+    /// Returns a statistic across all channels for the frames in the range
+    /// [\a fromFrame, \a toFrame) using the pyramid when available.
+    quint8 summary(int fromFrame, int toFrame, Statistic statistic = Peak) const;
+
+    void setPrioritizer(Prioritizer prioritizer) { m_prioritizer = prioritizer; }
+    bool isGenerating() const { return bool(m_prioritizer); }
+    /// Asks the generator to do the frames in [\a fromFrame, \a toFrame) next.
+    void prioritize(int fromFrame, int toFrame) const;
+
+    /// Converts to and from the RGBA image format used by the thumbnail cache.
+    QImage toImage() const;
+    static AudioLevels fromImage(const QImage &image, int channels);
+
+private:
+    struct Pyramid
+    {
+        // Index 0 is half the resolution of the frames; every level has
+        // channels interleaved.
+        QVector<QVector<quint8>> peak;
+        QVector<QVector<quint8>> minimum;
+        QVector<QVector<quint8>> rms;
+    };
+
+    void detach(int capacity);
+
+    QExplicitlySharedDataPointer<AudioLevelsData> d;
+    int m_size;
+    QSharedPointer<const Pyramid> m_pyramid;
+    Prioritizer m_prioritizer;
+};
+
+Q_DECLARE_METATYPE(AudioLevels)
+
+#endif // AUDIOLEVELS_H
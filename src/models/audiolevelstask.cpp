@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,7 +18,9 @@
 #include "audiolevelstask.h"
 
 #include "Logger.h"
+#include "beatdetector.h"
 #include "database.h"
+#include "executors.h"
 #include "mainwindow.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
@@ -28,18 +30,300 @@
 #include <QElapsedTimer>
 #include <QImage>
 #include <QMutex>
-#include <QRgb>
+#include <QSharedPointer>
 #include <QString>
 #include <QThreadPool>
 #include <QTime>
-#include <QVariantList>
+#include <QWaitCondition>
+
+#include <cmath>
+#include <cstring>
+
+static const int kChunkSeconds = 30;
+static const int kMaxWorkers = 4;
+static const int kMaxPriorityRanges = 16;
+static const int kUpdateIntervalMs = 3 * 1000;
 
 static QList<AudioLevelsTask *> tasksList;
 static QMutex tasksListMutex;
 
-static void deleteQVariantList(QVariantList *list)
+/*!
+  \class AudioLevelsScheduler
+  \brief Hands out time ranges of one file to the threads generating its levels.
+
+  Ranges are given out in order except that ranges a view asked for with
+  AudioLevels::prioritize() go first, most recent request first. Finished
+  ranges are merged into one buffer from which snapshots are made, and their
+  beat onsets into another.
+*/
+class AudioLevelsScheduler : public QEnableSharedFromThis<AudioLevelsScheduler>
+{
+public:
+    AudioLevelsScheduler(int channels, int frameCount, int chunkFrames)
+        : m_channels(channels)
+        , m_frameCount(frameCount)
+        , m_chunkFrames(chunkFrames)
+        , m_values(frameCount * channels, 0)
+        , m_onsets(frameCount, 0)
+        , m_states((frameCount + chunkFrames - 1) / chunkFrames, Pending)
+        , m_next(0)
+        , m_remaining(m_states.size())
+        , m_workers(0)
+    {
+        m_updateTime.start();
+    }
+
+    int channels() const { return m_channels; }
+    int frameCount() const { return m_frameCount; }
+    int chunkFrames() const { return m_chunkFrames; }
+    int chunkCount() const { return m_states.size(); }
+
+    /// Returns the next chunk to decode or -1 when none are left.
+    int takeChunk()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (!m_priority.isEmpty()) {
+            const auto range = m_priority.last();
+            for (int c = range.first / m_chunkFrames; c <= range.second / m_chunkFrames; ++c) {
+                if (c >= 0 && c < m_states.size() && m_states[c] == Pending) {
+                    m_states[c] = Taken;
+                    return c;
+                }
+            }
+            m_priority.removeLast();
+        }
+        for (; m_next < m_states.size(); ++m_next) {
+            if (m_states[m_next] == Pending) {
+                m_states[m_next] = Taken;
+                return m_next++;
+            }
+        }
+        return -1;
+    }
+
+    /// Merges a decoded chunk and returns whether it is time for an update.
+    bool finish(int chunk, const QVector<quint8> &values, const QVector<quint8> &onsets)
+    {
+        QMutexLocker locker(&m_mutex);
+        const int offset = chunk * m_chunkFrames * m_channels;
+        const int count = qMin(values.size(), m_values.size() - offset);
+        if (count > 0)
+            ::memcpy(m_values.data() + offset, values.constData(), count);
+        const int onsetOffset = chunk * m_chunkFrames;
+        const int onsetCount = qMin(onsets.size(), m_onsets.size() - onsetOffset);
+        if (onsetCount > 0)
+            ::memcpy(m_onsets.data() + onsetOffset, onsets.constData(), onsetCount);
+        m_states[chunk] = Done;
+        --m_remaining;
+        if (m_remaining > 0 && m_updateTime.elapsed() > kUpdateIntervalMs) {
+            m_updateTime.restart();
+            return true;
+        }
+        return false;
+    }
+
+    void prioritize(int fromFrame, int toFrame)
+    {
+        QMutexLocker locker(&m_mutex);
+        const auto range = qMakePair(qMax(0, fromFrame), qMin(toFrame, m_frameCount) - 1);
+        m_priority.removeAll(range);
+        m_priority << range;
+        while (m_priority.size() > kMaxPriorityRanges)
+            m_priority.removeFirst();
+    }
+
+    /// Returns a snapshot of the merged levels. Copies made while chunks are
+    /// still outstanding can ask for ranges to be done next.
+    AudioLevels levels()
+    {
+        QMutexLocker locker(&m_mutex);
+        // This shares the buffer until the next chunk is merged.
+        AudioLevels result(m_channels, m_values);
+        if (m_remaining > 0) {
+            QWeakPointer<AudioLevelsScheduler> weak(sharedFromThis());
+            result.setPrioritizer([=](int fromFrame, int toFrame) {
+                if (auto scheduler = weak.toStrongRef())
+                    scheduler->prioritize(fromFrame, toFrame);
+            });
+        }
+        return result;
+    }
+
+    QVector<quint8> onsets()
+    {
+        QMutexLocker locker(&m_mutex);
+        return m_onsets;
+    }
+
+    void addWorker()
+    {
+        QMutexLocker locker(&m_mutex);
+        ++m_workers;
+    }
+
+    void removeWorker()
+    {
+        QMutexLocker locker(&m_mutex);
+        --m_workers;
+        m_workerDone.wakeAll();
+    }
+
+    void waitForWorkers()
+    {
+        QMutexLocker locker(&m_mutex);
+        while (m_workers > 0)
+            m_workerDone.wait(&m_mutex);
+    }
+
+private:
+    enum State : char { Pending, Taken, Done };
+
+    QMutex m_mutex;
+    QWaitCondition m_workerDone;
+    const int m_channels;
+    const int m_frameCount;
+    const int m_chunkFrames;
+    QVector<quint8> m_values;
+    QVector<quint8> m_onsets;
+    QVector<State> m_states;
+    QList<QPair<int, int>> m_priority;
+    int m_next;
+    int m_remaining;
+    int m_workers;
+    QElapsedTimer m_updateTime;
+};
+
+static void deleteAudioLevels(AudioLevels *levels)
+{
+    delete levels;
+}
+
+static void deleteOnsets(QVector<quint8> *onsets)
+{
+    delete onsets;
+}
+
+// The first pixel of the image is the number of onsets and each of the others
+// packs four of them, like the scene scores.
+static QImage onsetsToImage(const QVector<quint8> &onsets)
+{
+    const quint32 count = onsets.size();
+    QImage image(1 + (count + 3) / 4, 1, QImage::Format_RGBA8888);
+    if (count > 0 && !image.isNull()) {
+        image.fill(0);
+        ::memcpy(image.scanLine(0), &count, sizeof(count));
+        ::memcpy(image.scanLine(0) + 4, onsets.constData(), count);
+    }
+    return image;
+}
+
+static QVector<quint8> onsetsFromImage(const QImage &image)
+{
+    QVector<quint8> onsets;
+    if (image.height() == 1 && image.format() == QImage::Format_RGBA8888) {
+        quint32 count = 0;
+        ::memcpy(&count, image.constScanLine(0), sizeof(count));
+        if (count > 0 && count <= 4 * quint32(image.width() - 1)) {
+            onsets.resize(count);
+            ::memcpy(onsets.data(), image.constScanLine(0) + 4, count);
+        }
+    }
+    return onsets;
+}
+
+// IEC standard dB scaling, the same as the audiolevel filter uses.
+static double IEC_Scale(double dB)
 {
-    delete list;
+    double fScale = 1.0;
+    if (dB < -70.0)
+        fScale = 0.0;
+    else if (dB < -60.0)
+        fScale = (dB + 70.0) * 0.0025;
+    else if (dB < -50.0)
+        fScale = (dB + 60.0) * 0.005 + 0.025;
+    else if (dB < -40.0)
+        fScale = (dB + 50.0) * 0.0075 + 0.075;
+    else if (dB < -30.0)
+        fScale = (dB + 40.0) * 0.015 + 0.15;
+    else if (dB < -20.0)
+        fScale = (dB + 30.0) * 0.02 + 0.3;
+    else if (dB < -0.001 || dB > 0.001)
+        fScale = (dB + 20.0) * 0.025 + 0.5;
+    return fScale;
+}
+
+struct SampleLevels
+{
+    float peak;
+    float rms;
+};
+
+// Measures one channel of \a count samples that are \a stride apart.
+template<typename T>
+static SampleLevels measureSamples(const T *samples, int count, int stride, float scale)
+{
+    // Independent accumulators break the dependency between iterations so
+    // that the compiler can keep several lanes in flight.
+    float peak[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    float sum[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int k = 0; k < 4; ++k) {
+            const float v = float(samples[(i + k) * stride]) * scale;
+            peak[k] = qMax(peak[k], qAbs(v));
+            sum[k] += v * v;
+        }
+    }
+    for (; i < count; ++i) {
+        const float v = float(samples[i * stride]) * scale;
+        peak[0] = qMax(peak[0], qAbs(v));
+        sum[0] += v * v;
+    }
+    SampleLevels result;
+    result.peak = qMax(qMax(peak[0], peak[1]), qMax(peak[2], peak[3]));
+    result.rms = count > 0 ? std::sqrt((sum[0] + sum[1] + sum[2] + sum[3]) / count) : 0.0f;
+    return result;
+}
+
+// Returns false if \a format is not one that can be measured directly.
+static bool measureAudio(const void *buffer,
+                         mlt_audio_format format,
+                         int channels,
+                         int samples,
+                         int channel,
+                         SampleLevels &levels)
+{
+    switch (format) {
+    case mlt_audio_s16:
+        levels = measureSamples(static_cast<const int16_t *>(buffer) + channel,
+                                samples,
+                                channels,
+                                1.0f / 32768.0f);
+        return true;
+    case mlt_audio_s32le:
+        levels = measureSamples(static_cast<const int32_t *>(buffer) + channel,
+                                samples,
+                                channels,
+                                1.0f / 2147483648.0f);
+        return true;
+    case mlt_audio_s32:
+        levels = measureSamples(static_cast<const int32_t *>(buffer) + channel * samples,
+                                samples,
+                                1,
+                                1.0f / 2147483648.0f);
+        return true;
+    case mlt_audio_f32le:
+        levels = measureSamples(static_cast<const float *>(buffer) + channel, samples, channels, 1.0f);
+        return true;
+    case mlt_audio_float:
+        levels = measureSamples(static_cast<const float *>(buffer) + channel * samples,
+                                samples,
+                                1,
+                                1.0f);
+        return true;
+    default:
+        return false;
+    }
 }
 
 AudioLevelsTask::AudioLevelsTask(Mlt::Producer &producer, QObject *object, const QModelIndex &index)
@@ -47,6 +331,7 @@ AudioLevelsTask::AudioLevelsTask(Mlt::Producer &producer, QObject *object, const
     , m_object(object)
     , m_isCanceled(false)
     , m_isForce(false)
+    , m_isOnsetsRequired(false)
 {
     m_producers << ProducerAndIndex(new Mlt::Producer(producer), index);
 }
@@ -60,9 +345,10 @@ AudioLevelsTask::~AudioLevelsTask()
 void AudioLevelsTask::start(Mlt::Producer &producer,
                             QObject *object,
                             const QModelIndex &index,
-                            bool force)
+                            bool force,
+                            bool withOnsets)
 {
-    if (Settings.timelineShowWaveforms() && producer.is_valid()
+    if ((Settings.timelineShowWaveforms() || withOnsets) && producer.is_valid()
         && producer.get_length() < qRound(MLT.profile().fps() * 24 * 3600)) {
         QString serviceName = producer.get("mlt_service");
         if (serviceName == "pixbuf" || serviceName == "qimage" || serviceName == "webvfx"
@@ -81,14 +367,16 @@ void AudioLevelsTask::start(Mlt::Producer &producer,
                 delete task;
                 task = 0;
                 t->m_producers << ProducerAndIndex(new Mlt::Producer(producer), index);
+                t->m_isOnsetsRequired |= withOnsets;
                 break;
             }
         }
         if (task) {
             // Otherwise, start a new audio levels generation thread.
             task->m_isForce = force;
+            task->m_isOnsetsRequired = withOnsets;
             tasksList << task;
-            QThreadPool::globalInstance()->start(task);
+            Executors::start(Executors::AnalysisExecutor, task);
         }
         tasksListMutex.unlock();
     }
@@ -106,6 +394,12 @@ void AudioLevelsTask::closeAll()
     tasksListMutex.unlock();
 }
 
+int AudioLevelsTask::pendingCount()
+{
+    QMutexLocker locker(&tasksListMutex);
+    return tasksList.size();
+}
+
 bool AudioLevelsTask::operator==(AudioLevelsTask &b)
 {
     if (!m_producers.isEmpty() && !b.m_producers.isEmpty()) {
@@ -120,29 +414,143 @@ bool AudioLevelsTask::operator==(AudioLevelsTask &b)
 
 Mlt::Producer *AudioLevelsTask::tempProducer()
 {
-    if (!m_tempProducer) {
-        Mlt::Producer *producer = m_producers.first().first;
-        QString service = producer->get("mlt_service");
-        if (service == "avformat-novalidate")
-            service = "avformat";
-        else if (service.startsWith("xml"))
-            service = "xml-nogl";
-        m_tempProducer.reset(
-            new Mlt::Producer(m_profile, service.toUtf8().constData(), producer->get("resource")));
-        if (m_tempProducer->is_valid()) {
-            Mlt::Filter channels(m_profile, "audiochannels");
-            Mlt::Filter converter(m_profile, "audioconvert");
-            Mlt::Filter levels(m_profile, "audiolevel");
-            m_tempProducer->attach(channels);
-            m_tempProducer->attach(converter);
-            m_tempProducer->attach(levels);
-            if (producer->get("audio_index")) {
-                m_tempProducer->pass_property(*producer, "audio_index");
+    if (!m_tempProducer)
+        m_tempProducer.reset(newTempProducer());
+    return m_tempProducer.data();
+}
+
+Mlt::Producer *AudioLevelsTask::newTempProducer()
+{
+    Mlt::Producer *producer = m_producers.first().first;
+    QString service = producer->get("mlt_service");
+    if (service == "avformat-novalidate")
+        service = "avformat";
+    else if (service.startsWith("xml"))
+        service = "xml-nogl";
+    auto result = new Mlt::Producer(m_profile,
+                                    service.toUtf8().constData(),
+                                    producer->get("resource"));
+    if (result->is_valid()) {
+        // Levels are measured here from the decoded samples. The converter
+        // only runs if the decoder's native format cannot be measured.
+        Mlt::Filter converter(m_profile, "audioconvert");
+        result->attach(converter);
+        if (producer->get("audio_index")) {
+            result->pass_property(*producer, "audio_index");
+        }
+        result->set("video_index", -1);
+    }
+    return result;
+}
+
+AudioLevels AudioLevelsTask::generate(int channels, QVector<quint8> &onsets)
+{
+    if (!tempProducer()->is_valid())
+        return AudioLevels();
+    const int n = tempProducer()->get_playtime();
+    const int chunkFrames = qMax(1, qRound(m_profile.fps() * kChunkSeconds));
+    auto scheduler = QSharedPointer<AudioLevelsScheduler>::create(channels, n, chunkFrames);
+
+    // Other threads help with files that are cheap to open again and seek,
+    // but only when the pool has an idle thread, so that this never waits
+    // on work that cannot start.
+    if (QString(tempProducer()->get("mlt_service")).startsWith("avformat")) {
+        const int workers = qMin(kMaxWorkers, scheduler->chunkCount());
+        for (int i = 1; i < workers; ++i) {
+            scheduler->addWorker();
+            auto helper = [this, scheduler]() {
+                QScopedPointer<Mlt::Producer> producer(newTempProducer());
+                if (producer->is_valid())
+                    generateChunks(*producer, *scheduler);
+                scheduler->removeWorker();
+            };
+            if (!Executors::tryStart(Executors::AnalysisExecutor, helper)) {
+                scheduler->removeWorker();
+                break;
             }
-            m_tempProducer->set("video_index", -1);
         }
     }
-    return m_tempProducer.data();
+    generateChunks(*tempProducer(), *scheduler);
+    scheduler->waitForWorkers();
+    onsets = scheduler->onsets();
+    return scheduler->levels();
+}
+
+void AudioLevelsTask::generateChunks(Mlt::Producer &producer, AudioLevelsScheduler &scheduler)
+{
+    const int channels = scheduler.channels();
+    // Start with the native format to avoid a conversion.
+    mlt_audio_format requestedFormat = mlt_audio_none;
+    // The onsets of the beats are measured from the same decoded samples.
+    BeatDetector detector;
+    int chunk;
+    while (!m_isCanceled && (chunk = scheduler.takeChunk()) >= 0) {
+        const int from = chunk * scheduler.chunkFrames();
+        const int to = qMin(from + scheduler.chunkFrames(), scheduler.frameCount());
+        QVector<quint8> values;
+        values.reserve((to - from) * channels);
+        QVector<quint8> onsets;
+        onsets.reserve(to - from);
+        if (producer.position() != from)
+            producer.seek(from);
+        detector.reset();
+        // for each frame
+        for (int i = from; i < to && !m_isCanceled; i++) {
+            Mlt::Frame *frame = producer.get_frame();
+            bool isMeasured = false;
+            quint8 onset = 0;
+            if (frame && frame->is_valid() && !frame->get_int("test_audio")) {
+                mlt_audio_format format = requestedFormat;
+                int frequency = 48000;
+                int frameChannels = channels;
+                int samples = mlt_audio_calculate_frame_samples(m_producers.first().first->get_fps(),
+                                                                frequency,
+                                                                i);
+                const void *buffer = frame->get_audio(format, frequency, frameChannels, samples);
+                SampleLevels levels;
+                if (buffer && frameChannels > 0
+                    && measureAudio(buffer, format, frameChannels, samples, 0, levels)) {
+                    // for each channel
+                    for (int channel = 0; channel < channels; channel++) {
+                        // Mono is shown on every channel.
+                        if (channel > 0 && channel < frameChannels)
+                            measureAudio(buffer, format, frameChannels, samples, channel, levels);
+                        const double level = levels.rms > 0.0f
+                                                 ? IEC_Scale(20.0 * std::log10(levels.rms))
+                                                 : 0.0;
+                        // Convert real to uint for caching as image.
+                        // Scale by 0.9 because values may exceed 1.0 to indicate clipping.
+                        values << quint8(qMin(255, int(256 * qMin(level * 0.9, 1.0))));
+                    }
+                    onset = detector.addFrame(buffer, format, frequency, frameChannels, samples);
+                    isMeasured = true;
+                } else if (buffer && requestedFormat == mlt_audio_none) {
+                    LOG_DEBUG() << "converting audio format" << mlt_audio_format_name(format)
+                                << "for audio levels";
+                    requestedFormat = mlt_audio_s16;
+                }
+            }
+            if (!isMeasured) {
+                // Repeat the previous frame, which is this channel of the last one.
+                for (int channel = 0; channel < channels; channel++) {
+                    const quint8 previous = values.isEmpty() ? 0 : values[values.size() - channels];
+                    values << previous;
+                }
+            }
+            onsets << onset;
+            delete frame;
+        }
+        if (m_isCanceled)
+            break;
+        // Incrementally update the audio levels every few seconds.
+        if (scheduler.finish(chunk, values, onsets))
+            publish(scheduler.levels());
+    }
+}
+
+QString AudioLevelsTask::onsetsCacheKey()
+{
+    return cacheKey() + QStringLiteral(" onsets");
 }
 
 QString AudioLevelsTask::cacheKey()
@@ -171,16 +579,14 @@ QString AudioLevelsTask::cacheKey()
 
 void AudioLevelsTask::run()
 {
-    // 2 channels interleaved of uchar values
-    QVariantList levels;
+    // TODO: use project channel count
+    const int channels = 2;
+    AudioLevels levels;
+    QVector<quint8> onsets;
     QImage image = DB.getThumbnail(cacheKey());
-    if (image.isNull() || m_isForce) {
-        const char *key[2] = {"meta.media.audio_level.0", "meta.media.audio_level.1"};
-        QElapsedTimer updateTime;
-        updateTime.start();
-        // TODO: use project channel count
-        int channels = 2;
-
+    if (!image.isNull() && !m_isForce)
+        onsets = onsetsFromImage(DB.getThumbnail(onsetsCacheKey()));
+    if (image.isNull() || m_isForce || (m_isOnsetsRequired && onsets.isEmpty())) {
         auto message = QStringLiteral("%1 %2").arg(QObject::tr("generating audio waveforms for"),
                                                    Util::baseName(tempProducer()->get("resource"),
                                                                   true));
@@ -190,70 +596,11 @@ void AudioLevelsTask::run()
             LOG_DEBUG() << message;
         }
 
-        // for each frame
-        int n = tempProducer()->get_playtime();
-        for (int i = 0; i < n && !m_isCanceled; i++) {
-            Mlt::Frame *frame = tempProducer()->get_frame();
-            if (frame && frame->is_valid() && !frame->get_int("test_audio")) {
-                mlt_audio_format format = mlt_audio_s16;
-                int frequency = 48000;
-                int samples = mlt_audio_calculate_frame_samples(m_producers.first().first->get_fps(),
-                                                                frequency,
-                                                                i);
-                frame->get_audio(format, frequency, channels, samples);
-                // for each channel
-                for (int channel = 0; channel < channels; channel++)
-                    // Convert real to uint for caching as image.
-                    // Scale by 0.9 because values may exceed 1.0 to indicate clipping.
-                    levels << 256 * qMin(frame->get_double(key[channel]) * 0.9, 1.0);
-            } else if (!levels.isEmpty()) {
-                for (int channel = 0; channel < channels; channel++)
-                    levels << levels.last();
-            }
-            delete frame;
-
-            // Incrementally update the audio levels every 3 seconds.
-            if (updateTime.elapsed() > 3 * 1000 && !m_isCanceled) {
-                updateTime.restart();
-                foreach (ProducerAndIndex p, m_producers) {
-                    QVariantList *levelsCopy = new QVariantList(levels);
-                    p.first->lock();
-                    p.first->set(kAudioLevelsProperty,
-                                 levelsCopy,
-                                 0,
-                                 (mlt_destructor) deleteQVariantList);
-                    p.first->unlock();
-                    if (-1
-                        != m_object->metaObject()->indexOfMethod(
-                            "audioLevelsReady(QPersistentModelIndex)"))
-                        QMetaObject::invokeMethod(m_object,
-                                                  "audioLevelsReady",
-                                                  Q_ARG(const QPersistentModelIndex &, p.second));
-                }
-            }
-        }
+        levels = generate(channels, onsets);
         if (!m_isCanceled) {
+            DB.putThumbnail(onsetsCacheKey(), onsetsToImage(onsets));
             // Put into an image for caching.
-            int count = levels.size();
-            QImage image((count + 3) / 4 / channels, channels, QImage::Format_ARGB32);
-            n = image.width() * image.height();
-            for (int i = 0; i < n; i++) {
-                QRgb p;
-                if ((4 * i + 3) < count) {
-                    p = qRgba(levels.at(4 * i).toInt(),
-                              levels.at(4 * i + 1).toInt(),
-                              levels.at(4 * i + 2).toInt(),
-                              levels.at(4 * i + 3).toInt());
-                } else {
-                    int last = levels.last().toInt();
-                    int r = (4 * i + 0) < count ? levels.at(4 * i + 0).toInt() : last;
-                    int g = (4 * i + 1) < count ? levels.at(4 * i + 1).toInt() : last;
-                    int b = (4 * i + 2) < count ? levels.at(4 * i + 2).toInt() : last;
-                    int a = last;
-                    p = qRgba(r, g, b, a);
-                }
-                image.setPixel(i / 2, i % channels, p);
-            }
+            QImage image = levels.toImage();
             if (!image.isNull()) {
                 DB.putThumbnail(cacheKey(), image);
             } else {
@@ -261,6 +608,7 @@ void AudioLevelsTask::run()
                 // which is used to prevent QImage::isNull() from being true and continually trying
                 // to regenerate audio levels for this file.
                 QImage image(1, 1, QImage::Format_ARGB32);
+                image.fill(0);
                 DB.putThumbnail(cacheKey(), image);
             }
         }
@@ -271,15 +619,7 @@ void AudioLevelsTask::run()
                                   Q_ARG(QString, message));
     } else if (!m_isCanceled && !image.isNull()) {
         // convert cached image
-        int channels = 2;
-        int n = image.width() * image.height();
-        for (int i = 0; n > 1 && i < n; i++) {
-            QRgb p = image.pixel(i / 2, i % channels);
-            levels << qRed(p);
-            levels << qGreen(p);
-            levels << qBlue(p);
-            levels << qAlpha(p);
-        }
+        levels = AudioLevels::fromImage(image, channels);
     }
 
     // Remove ourself from the global list of audio tasks.
@@ -293,16 +633,58 @@ void AudioLevelsTask::run()
     tasksListMutex.unlock();
 
     if (levels.size() > 0 && !m_isCanceled) {
-        foreach (ProducerAndIndex p, m_producers) {
-            QVariantList *levelsCopy = new QVariantList(levels);
-            p.first->lock();
-            p.first->set(kAudioLevelsProperty, levelsCopy, 0, (mlt_destructor) deleteQVariantList);
-            p.first->unlock();
-            if (-1
-                != m_object->metaObject()->indexOfMethod("audioLevelsReady(QPersistentModelIndex)"))
-                QMetaObject::invokeMethod(m_object,
-                                          "audioLevelsReady",
-                                          Q_ARG(const QPersistentModelIndex &, p.second));
+        publish(levels, onsets);
+    }
+}
+
+void AudioLevelsTask::publish(const AudioLevels &levels, const QVector<quint8> &onsets)
+{
+    // Build the zoom pyramid here so the timeline never has to.
+    AudioLevels snapshot(levels);
+    snapshot.buildPyramid();
+    // Every producer gets a cheap copy that shares the same buffer.
+    foreach (ProducerAndIndex p, m_producers) {
+        p.first->lock();
+        p.first->set(kAudioLevelsProperty,
+                     new AudioLevels(snapshot),
+                     0,
+                     (mlt_destructor) deleteAudioLevels);
+        if (!onsets.isEmpty()) {
+            p.first->set(kAudioOnsetsProperty,
+                         new QVector<quint8>(onsets),
+                         0,
+                         (mlt_destructor) deleteOnsets);
         }
+        p.first->unlock();
+        if (-1 != m_object->metaObject()->indexOfMethod("audioLevelsReady(QPersistentModelIndex)"))
+            QMetaObject::invokeMethod(m_object,
+                                      "audioLevelsReady",
+                                      Q_ARG(const QPersistentModelIndex &, p.second));
+    }
+}
+
+AudioLevels AudioLevelsTask::levels(Mlt::Producer &producer)
+{
+    AudioLevels result;
+    if (producer.is_valid()) {
+        producer.lock();
+        auto levels = static_cast<AudioLevels *>(producer.get_data(kAudioLevelsProperty));
+        if (levels)
+            result = *levels;
+        producer.unlock();
+    }
+    return result;
+}
+
+QVector<quint8> AudioLevelsTask::onsets(Mlt::Producer &producer)
+{
+    QVector<quint8> result;
+    if (producer.is_valid()) {
+        producer.lock();
+        auto onsets = static_cast<QVector<quint8> *>(producer.get_data(kAudioOnsetsProperty));
+        if (onsets)
+            result = *onsets;
+        producer.unlock();
     }
+    return result;
 }
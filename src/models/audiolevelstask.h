@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2018 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  * Author: Dan Dennedy <dan@dennedy.org>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -19,6 +19,7 @@
 #ifndef AUDIOLEVELSTASK_H
 #define AUDIOLEVELSTASK_H
 
+#include "audiolevels.h"
 #include "multitrackmodel.h"
 
 #include <MltProducer.h>
@@ -26,17 +27,28 @@
 #include <QList>
 #include <QPersistentModelIndex>
 #include <QRunnable>
+#include <QVector>
+
+class AudioLevelsScheduler;
 
 class AudioLevelsTask : public QRunnable
 {
 public:
     AudioLevelsTask(Mlt::Producer &producer, QObject *object, const QModelIndex &index);
     virtual ~AudioLevelsTask();
+    /// Also measures the beat onsets if \a withOnsets, even without waveforms.
     static void start(Mlt::Producer &producer,
                       QObject *object,
                       const QModelIndex &index,
-                      bool force = false);
+                      bool force = false,
+                      bool withOnsets = false);
     static void closeAll();
+    /// Returns the number of tasks that are queued or running.
+    static int pendingCount();
+    /// Returns the audio levels stored on \a producer, if any.
+    static AudioLevels levels(Mlt::Producer &producer);
+    /// Returns the beat onset level of each frame stored on \a producer, if any.
+    static QVector<quint8> onsets(Mlt::Producer &producer);
     bool operator==(AudioLevelsTask &b);
 
 protected:
@@ -44,7 +56,12 @@ protected:
 
 private:
     Mlt::Producer *tempProducer();
+    Mlt::Producer *newTempProducer();
+    AudioLevels generate(int channels, QVector<quint8> &onsets);
+    void generateChunks(Mlt::Producer &producer, AudioLevelsScheduler &scheduler);
     QString cacheKey();
+    QString onsetsCacheKey();
+    void publish(const AudioLevels &levels, const QVector<quint8> &onsets = QVector<quint8>());
 
     QObject *m_object;
     typedef QPair<Mlt::Producer *, QPersistentModelIndex> ProducerAndIndex;
@@ -52,6 +69,7 @@ private:
     QScopedPointer<Mlt::Producer> m_tempProducer;
     bool m_isCanceled;
     bool m_isForce;
+    bool m_isOnsetsRequired;
     Mlt::Profile m_profile;
 };
 
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "beatdetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+// About 21 ms for each window at 48 kHz, half of which overlaps the next one
+static const int kFftSize = 1024;
+static const int kHopSize = kFftSize / 2;
+// The band of the kick drums and the bass
+static const double kLowHz = 40.0;
+static const double kHighHz = 250.0;
+// A beat is this many standard deviations above the power of the second before it.
+static const double kHistorySeconds = 1.0;
+static const double kSensitivity = 1.5;
+// At most 240 beats per minute
+static const double kMinBeatSeconds = 0.25;
+static const double kMinDb = -60.0;
+
+// Maps -100 to 0 dB onto 0 to 255.
+static quint8 dbToLevel(double db)
+{
+    return quint8(qBound(0, qRound((db + 100.0) * 2.55), 255));
+}
+
+static double levelToPower(quint8 level)
+{
+    return level > 0 ? std::pow(10.0, (level / 2.55 - 100.0) / 10.0) : 0.0;
+}
+
+// Mixes \a count samples of \a channels into \a mono. Interleaved samples have
+// a \a sampleStride of \a channels and planar ones a \a channelStride of \a count.
+template<typename T>
+static void mix(const T *samples,
+                int count,
+                int channels,
+                int sampleStride,
+                int channelStride,
+                float scale,
+                float *mono)
+{
+    const float gain = scale / channels;
+    for (int i = 0; i < count; ++i) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; ++c)
+            sum += float(samples[i * sampleStride + c * channelStride]);
+        mono[i] = sum * gain;
+    }
+}
+
+BeatDetector::BeatDetector()
+    : m_fftInput(fftw_alloc_real(kFftSize))
+    , m_fftOutput(fftw_alloc_complex(kFftSize / 2 + 1))
+    , m_fftPlan(FftPlanCache::realToComplex(kFftSize))
+    , m_hann(kFftSize)
+{
+    for (int i = 0; i < kFftSize; ++i)
+        m_hann[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / (kFftSize - 1)));
+    m_samples.reserve(2 * kFftSize);
+}
+
+BeatDetector::~BeatDetector()
+{
+    fftw_free(m_fftInput);
+    fftw_free(m_fftOutput);
+}
+
+void BeatDetector::reset()
+{
+    m_samples.clear();
+}
+
+quint8 BeatDetector::addFrame(const void *buffer,
+                              mlt_audio_format format,
+                              int frequency,
+                              int channels,
+                              int samples)
+{
+    if (!buffer || !m_fftPlan || channels <= 0 || samples <= 0 || frequency <= 0)
+        return 0;
+    const int offset = m_samples.size();
+    m_samples.resize(offset + samples);
+    float *mono = m_samples.data() + offset;
+    switch (format) {
+    case mlt_audio_s16:
+        mix(static_cast<const int16_t *>(buffer),
+            samples,
+            channels,
+            channels,
+            1,
+            1.0f / 32768.0f,
+            mono);
+        break;
+    case mlt_audio_s32le:
+        mix(static_cast<const int32_t *>(buffer),
+            samples,
+            channels,
+            channels,
+            1,
+            1.0f / 2147483648.0f,
+            mono);
+        break;
+    case mlt_audio_s32:
+        mix(static_cast<const int32_t *>(buffer),
+            samples,
+            channels,
+            1,
+            samples,
+            1.0f / 2147483648.0f,
+            mono);
+        break;
+    case mlt_audio_f32le:
+        mix(static_cast<const float *>(buffer), samples, channels, channels, 1, 1.0f, mono);
+        break;
+    case mlt_audio_float:
+        mix(static_cast<const float *>(buffer), samples, channels, 1, samples, 1.0f, mono);
+        break;
+    default:
+        m_samples.resize(offset);
+        return 0;
+    }
+
+    double power = 0.0;
+    int start = 0;
+    for (; m_samples.size() - start >= kFftSize; start += kHopSize)
+        power = qMax(power, bandPower(m_samples.constData() + start, frequency));
+    m_samples.remove(0, start);
+    return power > 0.0 ? dbToLevel(10.0 * std::log10(power)) : 0;
+}
+
+double BeatDetector::bandPower(const float *samples, int frequency)
+{
+    for (int i = 0; i < kFftSize; ++i)
+        m_fftInput[i] = samples[i] * m_hann[i];
+    fftw_execute_dft_r2c(m_fftPlan.data(), m_fftInput, m_fftOutput);
+    const int low = qBound(1, qRound(kLowHz * kFftSize / frequency), kFftSize / 2);
+    const int high = qBound(low, qRound(kHighHz * kFftSize / frequency), kFftSize / 2);
+    double sum = 0.0;
+    for (int i = low; i <= high; ++i) {
+        const double re = m_fftOutput[i][0];
+        const double im = m_fftOutput[i][1];
+        sum += re * re + im * im;
+    }
+    // A full scale sine in the band is about -12 dB after the Hann window.
+    return sum / (double(kFftSize) * kFftSize);
+}
+
+QList<int> BeatDetector::findBeats(const QVector<quint8> &onsets, double fps)
+{
+    QList<int> beats;
+    const int n = onsets.size();
+    if (n < 3 || fps <= 0.0)
+        return beats;
+    QVector<double> power(n);
+    // The running sums make the mean and variance of the history O(1) per frame.
+    QVector<double> sums(n + 1, 0.0);
+    QVector<double> squares(n + 1, 0.0);
+    for (int i = 0; i < n; ++i) {
+        power[i] = levelToPower(onsets[i]);
+        sums[i + 1] = sums[i] + power[i];
+        squares[i + 1] = squares[i] + power[i] * power[i];
+    }
+    const int history = qMax(2, qRound(fps * kHistorySeconds));
+    const int minBeatFrames = qMax(1, qRound(fps * kMinBeatSeconds));
+    const quint8 minLevel = dbToLevel(kMinDb);
+    int last = -minBeatFrames;
+    for (int i = 1; i + 1 < n; ++i) {
+        if (onsets[i] < minLevel || i - last < minBeatFrames)
+            continue;
+        // Only the peak of a rise counts.
+        if (power[i] <= power[i - 1] || power[i] < power[i + 1])
+            continue;
+        const int from = qMax(0, i - history);
+        const int count = i - from;
+        const double mean = (sums[i] - sums[from]) / count;
+        const double variance = qMax(0.0, (squares[i] - squares[from]) / count - mean * mean);
+        if (power[i] > mean + kSensitivity * std::sqrt(variance)) {
+            beats << i;
+            last = i;
+        }
+    }
+    return beats;
+}
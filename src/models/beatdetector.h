@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BEATDETECTOR_H
+#define BEATDETECTOR_H
+
+#include "fftplancache.h"
+
+#include <framework/mlt_types.h>
+#include <QList>
+#include <QVector>
+
+/*!
+  \class BeatDetector
+  \brief Measures how strongly each frame of a file's audio starts a beat.
+
+  The samples of each frame are mixed to mono and cut into overlapping
+  windows. The power of the low band of each window, where the kick drums
+  and the bass are, is measured with a real FFT, and a frame gets the
+  strongest power of the windows that end in it as a level from 0 to 255.
+  This makes the onsets of a file small enough to cache with its audio levels.
+
+  Each thread that decodes a part of a file has its own detector. The beats
+  are found afterwards from the onsets of the whole file, so the history that
+  a threshold needs can reach back into the part before.
+*/
+
+class BeatDetector
+{
+public:
+    BeatDetector();
+    ~BeatDetector();
+    //! Forgets the samples of the previous frames, for example after a seek.
+    void reset();
+    //! Returns the onset level of the next frame; 0 if \a format is not supported.
+    quint8 addFrame(const void *buffer,
+                    mlt_audio_format format,
+                    int frequency,
+                    int channels,
+                    int samples);
+    //! Returns the indices of the frames in \a onsets that start a beat.
+    static QList<int> findBeats(const QVector<quint8> &onsets, double fps);
+
+private:
+    Q_DISABLE_COPY(BeatDetector)
+    double bandPower(const float *samples, int frequency);
+
+    double *m_fftInput;
+    fftw_complex *m_fftOutput;
+    FftPlanCache::Plan m_fftPlan;
+    QVector<double> m_hann;
+    QVector<float> m_samples;
+};
+
+#endif // BEATDETECTOR_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2024 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -26,6 +26,8 @@
 #include <QRegularExpression>
 #include <QTimer>
 
+#include <algorithm>
+
 static const quintptr NO_PARENT_ID = quintptr(-1);
 
 KeyframesModel::KeyframesModel(QObject *parent)
@@ -61,15 +63,16 @@ QVariant KeyframesModel::data(const QModelIndex &index, int role) const
         // keyframes
         if (m_filter && index.internalId() < quintptr(m_propertyNames.count())) {
             QString name = m_propertyNames[index.internalId()];
-            Mlt::Animation animation = m_filter->getAnimation(name);
-            if (animation.is_valid()) {
-                int position = const_cast<Mlt::Animation &>(animation).key_get_frame(index.row());
+            const auto keyframes = m_filter->keyframes(name);
+            if (index.row() < keyframes.size()) {
+                const auto &keyframe = keyframes[index.row()];
+                int position = keyframe.frame;
                 if (position >= 0) {
                     switch (role) {
                     case Qt::DisplayRole:
                     case NameRole: {
                         QString type = tr("Linear");
-                        switch (const_cast<Mlt::Animation &>(animation).key_get_type(index.row())) {
+                        switch (keyframe.type) {
                         case mlt_keyframe_discrete:
                             type = tr("Hold");
                             break;
@@ -171,7 +174,7 @@ QVariant KeyframesModel::data(const QModelIndex &index, int role) const
                         default:
                             break;
                         }
-                        double value = m_filter->getDouble(name, position);
+                        double value = keyframe.value;
                         QString units = m_metadata->keyframes()
                                             ->parameter(m_metadataIndex[index.internalId()])
                                             ->units();
@@ -184,36 +187,32 @@ QVariant KeyframesModel::data(const QModelIndex &index, int role) const
                     case FrameNumberRole:
                         return position;
                     case KeyframeTypeRole:
-                        if (index.row() >= animation.key_count() - 1) {
+                        if (index.row() >= keyframes.size() - 1) {
                             return DiscreteInterpolation;
                         }
-                        return const_cast<Mlt::Animation &>(animation).key_get_type(index.row());
+                        return keyframe.type;
                     case PrevKeyframeTypeRole:
                         if (index.row() <= 0) {
                             return DiscreteInterpolation;
                         }
-                        return const_cast<Mlt::Animation &>(animation).key_get_type(index.row() - 1);
+                        return keyframes[index.row() - 1].type;
                     case NumericValueRole:
-                        return m_filter->getDouble(name, position);
+                        return keyframe.value;
                     case MinimumFrameRole: {
                         int result = 0;
-                        if (animation.previous_key(position - 1, result)) {
-                            // first Keyframe
-                            result = 0;
-                        } else {
-                            result += 1;
+                        if (index.row() > 0) {
+                            result = keyframes[index.row() - 1].frame + 1;
                         }
-
                         //                        LOG_DEBUG() << "keyframeIndex" << index.row() << "minimumFrame" << result;
                         return result;
                     }
                     case MaximumFrameRole: {
                         int result = 0;
-                        if (animation.next_key(position + 1, result)) {
+                        if (index.row() < keyframes.size() - 1) {
+                            result = keyframes[index.row() + 1].frame - 1;
+                        } else {
                             // Last Keyframe
                             result = m_filter->producer().get_out();
-                        } else {
-                            result -= 1;
                         }
                         //                        LOG_DEBUG() << "keyframeIndex" << index.row() << "maximumFrame" << result;
                         return result;
@@ -259,17 +258,11 @@ QVariant KeyframesModel::data(const QModelIndex &index, int role) const
         case LowestValueRole: {
             QmlKeyframesParameter *param = m_metadata->keyframes()->parameter(
                 m_metadataIndex[index.row()]);
-            Mlt::Animation animation = m_filter->getAnimation(param->property());
             double min = std::numeric_limits<double>::max();
-            if (animation.is_valid()) {
-                for (int i = 0; i < animation.key_count(); i++) {
-                    int frame = animation.key_get_frame(i);
-                    if (frame >= 0) {
-                        double value = m_filter->getDouble(param->property(), frame);
-                        if (value < min)
-                            min = value;
-                    }
-                }
+            const auto keyframes = m_filter->keyframes(param->property());
+            for (const auto &keyframe : keyframes) {
+                if (keyframe.frame >= 0 && keyframe.value < min)
+                    min = keyframe.value;
             }
             if (min == std::numeric_limits<double>::max())
                 min = 0;
@@ -278,17 +271,11 @@ QVariant KeyframesModel::data(const QModelIndex &index, int role) const
         case HighestValueRole: {
             QmlKeyframesParameter *param = m_metadata->keyframes()->parameter(
                 m_metadataIndex[index.row()]);
-            Mlt::Animation animation = m_filter->getAnimation(param->property());
             double max = std::numeric_limits<double>::lowest();
-            if (animation.is_valid()) {
-                for (int i = 0; i < animation.key_count(); i++) {
-                    int frame = animation.key_get_frame(i);
-                    if (frame >= 0) {
-                        double value = m_filter->getDouble(param->property(), frame);
-                        if (value > max)
-                            max = value;
-                    }
-                }
+            const auto keyframes = m_filter->keyframes(param->property());
+            for (const auto &keyframe : keyframes) {
+                if (keyframe.frame >= 0 && keyframe.value > max)
+                    max = keyframe.value;
             }
             if (max == std::numeric_limits<double>::lowest())
                 max = 0;
@@ -1019,6 +1006,62 @@ int KeyframesModel::keyframeCount(int index) const
         return 0;
 }
 
+static bool isBefore(const QmlFilter::Keyframe &keyframe, double frame)
+{
+    return keyframe.frame < frame;
+}
+
+int KeyframesModel::keyframeLowerBound(int parameterIndex, int position) const
+{
+    if (!m_filter || parameterIndex < 0 || parameterIndex >= m_propertyNames.count())
+        return 0;
+    const auto keyframes = m_filter->keyframes(m_propertyNames[parameterIndex]);
+    return std::lower_bound(keyframes.cbegin(), keyframes.cend(), double(position), isBefore)
+           - keyframes.cbegin();
+}
+
+int KeyframesModel::keyframeInterpolation(int parameterIndex, int keyframeIndex) const
+{
+    return data(index(keyframeIndex, 0, index(parameterIndex)), KeyframeTypeRole).toInt();
+}
+
+QVector<QPointF> KeyframesModel::curve(int parameterIndex,
+                                       double from,
+                                       double to,
+                                       double step) const
+{
+    QVector<QPointF> points;
+    if (!m_filter || parameterIndex < 0 || parameterIndex >= m_propertyNames.count())
+        return points;
+    const auto &name = m_propertyNames[parameterIndex];
+    const auto keyframes = m_filter->keyframes(name);
+    if (keyframes.isEmpty() || to < from)
+        return points;
+    // MLT only interpolates at whole frames.
+    step = qMax(1.0, step);
+    // The samples between keyframes come from MLT, so every interpolation looks as it
+    // renders. The keyframes in between are points too so that holds stay square.
+    auto key = std::lower_bound(keyframes.cbegin(), keyframes.cend(), from, isBefore);
+    points.reserve(int((to - from) / step) + 2);
+    for (double frame = from;; frame = qMin(frame + step, to)) {
+        const auto start = key;
+        while (key != keyframes.cend() && key->frame <= frame)
+            ++key;
+        // Too many keyframes for one sample are drawn by the samples alone.
+        if (key - start <= 2) {
+            for (auto it = start; it != key; ++it) {
+                if (it != keyframes.cbegin() && (it - 1)->type == mlt_keyframe_discrete)
+                    points << QPointF(it->frame, (it - 1)->value);
+                points << QPointF(it->frame, it->value);
+            }
+        }
+        points << QPointF(frame, m_filter->getDouble(name, qMax(0, int(frame))));
+        if (frame >= to)
+            break;
+    }
+    return points;
+}
+
 void KeyframesModel::updateNeighborsMinMax(int parameterIndex, int keyframeIndex)
 {
     QModelIndex modelIndex;
@@ -21,7 +21,9 @@
 #include <MltAnimation.h>
 #include <MltProperties.h>
 #include <QAbstractItemModel>
+#include <QPointF>
 #include <QString>
+#include <QVector>
 
 class QmlMetadata;
 class QmlFilter;
@@ -120,6 +122,12 @@ public:
     Q_INVOKABLE bool simpleKeyframesInUse();
     Q_INVOKABLE void removeSimpleKeyframes();
     int keyframeCount(int index) const;
+    /// Returns the index of the first keyframe at or after the filter frame \a position.
+    Q_INVOKABLE int keyframeLowerBound(int parameterIndex, int position) const;
+    Q_INVOKABLE int keyframeInterpolation(int parameterIndex, int keyframeIndex) const;
+    /// Returns the points of the curve from the filter frame \a from to \a to as
+    /// frames and values, sampled every \a step frames.
+    QVector<QPointF> curve(int parameterIndex, double from, double to, double step) const;
 
 signals:
     void loaded();
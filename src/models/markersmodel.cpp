@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2024 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -69,6 +69,9 @@ void MarkersModel::load(Mlt::Producer *producer)
     beginResetModel();
     m_producer = producer;
     m_keys.clear();
+    m_positions.clear();
+    m_starts.clear();
+    m_ends.clear();
     if (m_producer) {
         Mlt::Properties *markerList = m_producer->get_props(kShotcutMarkersProperty);
         if (markerList && markerList->is_valid()) {
@@ -81,6 +84,7 @@ void MarkersModel::load(Mlt::Producer *producer)
                     m_keys << intKey;
                     Markers::Marker marker;
                     propertiesToMarker(markerProperties, marker, producer);
+                    indexMarker(intKey, marker);
                     updateRecentColors(marker.color);
                 }
                 delete markerProperties;
@@ -88,6 +92,7 @@ void MarkersModel::load(Mlt::Producer *producer)
         }
         delete markerList;
     }
+    updateKeyRows();
     endResetModel();
 }
 
@@ -143,7 +148,9 @@ void MarkersModel::doRemove(int markerIndex)
     auto marker = getMarker(markerIndex);
     beginRemoveRows(QModelIndex(), modelIndex.row(), modelIndex.row());
     markersListProperties->clear(qUtf8Printable(QString::number(m_keys[modelIndex.row()])));
+    unindexMarker(m_keys[modelIndex.row()]);
     m_keys.removeAt(modelIndex.row());
+    updateKeyRows();
     endRemoveRows();
     if (marker.end > marker.start)
         emit rangesChanged();
@@ -184,6 +191,8 @@ void MarkersModel::doInsert(int markerIndex, const Markers::Marker &marker)
     int key = uniqueKey();
     markersListProperties->set(qUtf8Printable(QString::number(key)), markerProperties);
     m_keys.insert(modelIndex.row(), key);
+    updateKeyRows();
+    indexMarker(key, marker);
     endInsertRows();
     updateRecentColors(marker.color);
     if (marker.end > marker.start)
@@ -203,6 +212,21 @@ void MarkersModel::append(const Markers::Marker &marker)
     MAIN.undoStack()->push(command);
 }
 
+void MarkersModel::appendMarkers(const QList<Markers::Marker> &markers)
+{
+    if (!m_producer) {
+        LOG_ERROR() << "No producer";
+        return;
+    }
+    if (markers.isEmpty())
+        return;
+    const QList<Markers::Marker> oldMarkers = getMarkers();
+    Markers::ReplaceCommand *command = new Markers::ReplaceCommand(*this,
+                                                                   oldMarkers,
+                                                                   oldMarkers + markers);
+    MAIN.undoStack()->push(command);
+}
+
 void MarkersModel::doAppend(const Markers::Marker &marker)
 {
     if (!m_producer) {
@@ -225,6 +249,8 @@ void MarkersModel::doAppend(const Markers::Marker &marker)
     int key = uniqueKey();
     markersListProperties->set(qUtf8Printable(QString::number(key)), markerProperties);
     m_keys.append(key);
+    m_keyRows.insert(key, count);
+    indexMarker(key, marker);
     updateRecentColors(marker.color);
     endInsertRows();
     if (marker.end > marker.start)
@@ -270,6 +296,8 @@ void MarkersModel::doUpdate(int markerIndex, const Markers::Marker &marker)
 
     markerToProperties(marker, markerProperties, m_producer);
     delete markerProperties;
+    unindexMarker(m_keys[markerIndex]);
+    indexMarker(m_keys[markerIndex], marker);
     updateRecentColors(marker.color);
 
     emit dataChanged(startIndex,
@@ -293,6 +321,10 @@ void MarkersModel::doClear()
 
     beginResetModel();
     m_keys.clear();
+    m_keyRows.clear();
+    m_positions.clear();
+    m_starts.clear();
+    m_ends.clear();
     static_cast<Mlt::Properties *>(m_producer)->clear(kShotcutMarkersProperty);
     endResetModel();
     emit modified();
@@ -308,6 +340,10 @@ void MarkersModel::doReplace(QList<Markers::Marker> &markers)
 
     beginResetModel();
     m_keys.clear();
+    m_positions.clear();
+    m_starts.clear();
+    m_ends.clear();
+    m_keys.reserve(markers.size());
     Mlt::Properties *markersListProperties = new Mlt::Properties;
     m_producer->set(kShotcutMarkersProperty, *markersListProperties);
     for (int i = 0; i < markers.size(); i++) {
@@ -315,8 +351,10 @@ void MarkersModel::doReplace(QList<Markers::Marker> &markers)
         markerToProperties(markers[i], &markerProperties, m_producer);
         markersListProperties->set(qUtf8Printable(QString::number(i)), markerProperties);
         m_keys << i;
+        indexMarker(i, markers[i]);
         m_recentColors.insert(markers[i].color.rgb(), markers[i].color.name());
     }
+    updateKeyRows();
     endResetModel();
     delete markersListProperties;
     emit modified();
@@ -334,27 +372,32 @@ void MarkersModel::doShift(int shiftPosition, int shiftAmount)
     int maxIndex = -1;
     QScopedPointer<Mlt::Properties> markerList(m_producer->get_props(kShotcutMarkersProperty));
     if (markerList && markerList->is_valid()) {
-        for (const auto i : std::as_const(m_keys)) {
+        // Only the markers that start at or after the position move.
+        QList<int> keys;
+        for (auto it = m_starts.lowerBound(shiftPosition); it != m_starts.end(); ++it)
+            keys << it.value();
+        for (const auto key : std::as_const(keys)) {
             QScopedPointer<Mlt::Properties> markerProperties(
-                markerList->get_props(qUtf8Printable(QString::number(i))));
+                markerList->get_props(qUtf8Printable(QString::number(key))));
             if (markerProperties && markerProperties->is_valid()) {
                 Markers::Marker marker;
                 propertiesToMarker(markerProperties.data(), marker, m_producer);
-                if (marker.start >= shiftPosition) {
-                    marker.start += shiftAmount;
-                    marker.end += shiftAmount;
-                    markerToProperties(marker, markerProperties.data(), m_producer);
-                    int markerIndex = m_keys[i];
-                    if (minIndex == -1 || markerIndex < minIndex)
-                        minIndex = markerIndex;
-                    if (maxIndex == -1 || markerIndex > maxIndex)
-                        maxIndex = markerIndex;
-                }
+                unindexMarker(key);
+                marker.start += shiftAmount;
+                marker.end += shiftAmount;
+                markerToProperties(marker, markerProperties.data(), m_producer);
+                indexMarker(key, marker);
+                int markerIndex = keyIndex(key);
+                if (minIndex == -1 || markerIndex < minIndex)
+                    minIndex = markerIndex;
+                if (maxIndex == -1 || markerIndex > maxIndex)
+                    maxIndex = markerIndex;
             }
         }
     }
 
     if (minIndex != -1) {
+        // Notify the rows that changed with one range.
         QModelIndex startIndex = index(minIndex, COLUMN_START);
         QModelIndex endIndex = index(maxIndex, COLUMN_END);
         emit dataChanged(startIndex,
@@ -441,20 +484,13 @@ int MarkersModel::markerCount() const
 
 int MarkersModel::keyIndex(int key) const
 {
-    int index = -1;
-    for (int i = 0; i < m_keys.size(); i++) {
-        if (m_keys[i] == key) {
-            index = i;
-            break;
-        }
-    }
-    return index;
+    return m_keyRows.value(key, -1);
 }
 
 int MarkersModel::uniqueKey() const
 {
     int key = 0;
-    while (keyIndex(key) >= 0) {
+    while (m_keyRows.contains(key)) {
         key++;
     }
     return key;
@@ -462,36 +498,30 @@ int MarkersModel::uniqueKey() const
 
 int MarkersModel::markerIndexForPosition(int position)
 {
-    QScopedPointer<Mlt::Properties> markerList(m_producer->get_props(kShotcutMarkersProperty));
-    if (markerList && markerList->is_valid()) {
-        for (const auto i : std::as_const(m_keys)) {
-            QScopedPointer<Mlt::Properties> marker(
-                markerList->get_props(qUtf8Printable(QString::number(i))));
-            if (marker && marker->is_valid()) {
-                if (position == m_producer->time_to_frames(marker->get("start"))
-                    || position == m_producer->time_to_frames(marker->get("end")))
-                    return keyIndex(i);
-            }
+    // Return the first marker in the list that starts or ends at the position.
+    int markerIndex = -1;
+    for (const auto *positions : {&m_starts, &m_ends}) {
+        for (auto it = positions->constFind(position);
+             it != positions->constEnd() && it.key() == position;
+             ++it) {
+            const int row = keyIndex(it.value());
+            if (markerIndex == -1 || row < markerIndex)
+                markerIndex = row;
         }
     }
-    return -1;
+    return markerIndex;
 }
 
 int MarkersModel::markerIndexForRange(int start, int end)
 {
-    QScopedPointer<Mlt::Properties> markerList(m_producer->get_props(kShotcutMarkersProperty));
-    if (markerList && markerList->is_valid()) {
-        for (const auto i : std::as_const(m_keys)) {
-            QScopedPointer<Mlt::Properties> marker(
-                markerList->get_props(qUtf8Printable(QString::number(i))));
-            if (marker && marker->is_valid()) {
-                if (start == m_producer->time_to_frames(marker->get("start"))
-                    && end == m_producer->time_to_frames(marker->get("end")))
-                    return keyIndex(i);
-            }
-        }
+    int markerIndex = -1;
+    for (auto it = m_starts.constFind(start); it != m_starts.constEnd() && it.key() == start;
+         ++it) {
+        const int row = keyIndex(it.value());
+        if ((markerIndex == -1 || row < markerIndex) && m_ends.contains(end, it.value()))
+            markerIndex = row;
     }
-    return -1;
+    return markerIndex;
 }
 
 int MarkersModel::rangeMarkerIndexForPosition(int position)
@@ -519,24 +549,10 @@ int MarkersModel::nextMarkerPosition(int position)
         LOG_ERROR() << "No producer";
         return nextPosition;
     }
-    QScopedPointer<Mlt::Properties> markerList(m_producer->get_props(kShotcutMarkersProperty));
-    if (markerList && markerList->is_valid()) {
-        for (const auto i : std::as_const(m_keys)) {
-            QScopedPointer<Mlt::Properties> marker(
-                markerList->get_props(qUtf8Printable(QString::number(i))));
-            if (marker && marker->is_valid()) {
-                int markerPosition = m_producer->time_to_frames(marker->get("start"));
-                if (markerPosition > position
-                    && (nextPosition == -1 || markerPosition < nextPosition)) {
-                    nextPosition = markerPosition;
-                }
-                markerPosition = m_producer->time_to_frames(marker->get("end"));
-                if (markerPosition > position
-                    && (nextPosition == -1 || markerPosition < nextPosition)) {
-                    nextPosition = markerPosition;
-                }
-            }
-        }
+    for (const auto *positions : {&m_starts, &m_ends}) {
+        auto it = positions->upperBound(position);
+        if (it != positions->constEnd() && (nextPosition == -1 || it.key() < nextPosition))
+            nextPosition = it.key();
     }
     return nextPosition;
 }
@@ -548,23 +564,12 @@ int MarkersModel::prevMarkerPosition(int position)
         LOG_ERROR() << "No producer";
         return prevPosition;
     }
-    QScopedPointer<Mlt::Properties> markerList(m_producer->get_props(kShotcutMarkersProperty));
-    if (markerList && markerList->is_valid()) {
-        for (const auto i : std::as_const(m_keys)) {
-            QScopedPointer<Mlt::Properties> marker(
-                markerList->get_props(qUtf8Printable(QString::number(i))));
-            if (marker && marker->is_valid()) {
-                int markerPosition = m_producer->time_to_frames(marker->get("start"));
-                if (markerPosition < position
-                    && (prevPosition == -1 || markerPosition > prevPosition)) {
-                    prevPosition = markerPosition;
-                }
-                markerPosition = m_producer->time_to_frames(marker->get("end"));
-                if (markerPosition < position
-                    && (prevPosition == -1 || markerPosition > prevPosition)) {
-                    prevPosition = markerPosition;
-                }
-            }
+    for (const auto *positions : {&m_starts, &m_ends}) {
+        auto it = positions->lowerBound(position);
+        if (it != positions->constBegin()) {
+            --it;
+            if (prevPosition == -1 || it.key() > prevPosition)
+                prevPosition = it.key();
         }
     }
     return prevPosition;
@@ -666,6 +671,31 @@ void MarkersModel::updateRecentColors(const QColor &color)
     emit recentColorsChanged();
 }
 
+void MarkersModel::indexMarker(int key, const Markers::Marker &marker)
+{
+    m_positions.insert(key, qMakePair(marker.start, marker.end));
+    m_starts.insert(marker.start, key);
+    m_ends.insert(marker.end, key);
+}
+
+void MarkersModel::unindexMarker(int key)
+{
+    auto it = m_positions.find(key);
+    if (it == m_positions.end())
+        return;
+    m_starts.remove(it->first, key);
+    m_ends.remove(it->second, key);
+    m_positions.erase(it);
+}
+
+void MarkersModel::updateKeyRows()
+{
+    m_keyRows.clear();
+    m_keyRows.reserve(m_keys.size());
+    for (int i = 0; i < m_keys.size(); i++)
+        m_keyRows.insert(m_keys[i], i);
+}
+
 int MarkersModel::rowCount(const QModelIndex &parent) const
 {
     Q_UNUSED(parent)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2021-2023 Meltytech, LLC
+ * Copyright (c) 2021-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,6 +21,8 @@
 #include <MltProducer.h>
 #include <QAbstractItemModel>
 #include <QColor>
+#include <QHash>
+#include <QMultiMap>
 #include <QString>
 
 namespace Markers {
@@ -83,6 +85,8 @@ signals:
 public slots:
     void remove(int markerIndex);
     void append(const Markers::Marker &marker);
+    //! Appends \a markers as one undoable change that resets the model once.
+    void appendMarkers(const QList<Markers::Marker> &markers);
     void update(int markerIndex, const Markers::Marker &marker);
     void move(int markerIndex, int start, int end);
     void setColor(int markerIndex, const QColor &color);
@@ -103,9 +107,19 @@ private:
     int keyIndex(int key) const;
     Mlt::Properties *getMarkerProperties(int markerIndex);
     void updateRecentColors(const QColor &color);
+    void indexMarker(int key, const Markers::Marker &marker);
+    void unindexMarker(int key);
+    void updateKeyRows();
 
     Mlt::Producer *m_producer;
     QList<int> m_keys;
+    // The row of each key
+    QHash<int, int> m_keyRows;
+    // The start and end of each key as they were indexed
+    QHash<int, QPair<int, int>> m_positions;
+    // The keys of the markers sorted by their start and end positions
+    QMultiMap<int, int> m_starts;
+    QMultiMap<int, int> m_ends;
     QMap<QRgb, QString> m_recentColors;
 };
 
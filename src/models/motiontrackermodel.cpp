@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,6 +25,10 @@
 #include <Mlt.h>
 #include <QUuid>
 
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+
 // This is hard-coded for now (minimum viable product).
 static const int KEYFRAME_INTERVAL_FRAMES = 5;
 
@@ -113,7 +117,7 @@ QString MotionTrackerModel::add(const QString &name, const QString &data)
     if (!m_data.contains(key)) {
         auto row = rowCount();
         beginInsertRows(QModelIndex(), row, row);
-        m_data[key] = {name, data, KEYFRAME_INTERVAL_FRAMES};
+        m_data[key] = {name, parseTrackingData(data), KEYFRAME_INTERVAL_FRAMES};
         LOG_DEBUG() << key << m_data[key].name;
         endInsertRows();
         return key;
@@ -126,7 +130,8 @@ void MotionTrackerModel::updateData(const QString &key, const QString &data)
     auto keys = m_data.keys();
     auto row = keys.indexOf(key);
     if (row >= 0) {
-        m_data[key].trackingData = data;
+        m_data[key].trackingItems = parseTrackingData(data);
+        m_data[key].trackingData.clear();
         auto i = createIndex(row, 0);
         emit dataChanged(i, i, {TrackingDataRole});
     }
@@ -202,9 +207,7 @@ void MotionTrackerModel::reset(QmlFilter *filter, const QString &property, int r
 {
     auto key = keyForRow(row);
     if (!key.isEmpty() && filter && filter->service().is_valid() && !property.isEmpty()) {
-        auto data = trackingData(key);
-
-        if (!data.isEmpty()) {
+        if (!trackingData(key).empty()) {
             // Use a shotcut property to backup current values
             if (filter->get(kBackupProperty).isEmpty()) {
                 filter->set(kBackupProperty, filter->get(property));
@@ -215,45 +218,51 @@ void MotionTrackerModel::reset(QmlFilter *filter, const QString &property, int r
     }
 }
 
-QList<MotionTrackerModel::TrackingItem> MotionTrackerModel::trackingData(const QString &key) const
+const std::vector<MotionTrackerModel::TrackingItem> &MotionTrackerModel::trackingData(
+    const QString &key) const
 {
-    QList<TrackingItem> result;
-    auto s = m_data.value(key, {}).trackingData;
-    auto l = s.split(';');
-    bool ok{false};
-    Mlt::Properties props;
-
-    for (const auto &i : l) {
-        auto pair = i.split("~=");
-        if (pair.size() == 2) {
-            auto frame = pair.at(0).toInt(&ok);
-            props.set("", pair.at(1).toLatin1().constData());
-            auto rect = props.get_rect("");
-            if (ok) {
-                result << TrackingItem{frame, QRectF(rect.x, rect.y, rect.w, rect.h)};
-            }
-        }
-    }
-    return result;
+    static const std::vector<TrackingItem> empty;
+    auto it = m_data.constFind(key);
+    return it == m_data.constEnd() ? empty : it->trackingItems;
 }
 
 QList<QRectF> MotionTrackerModel::trackingData(int row) const
 {
-    auto key = keyForRow(row);
     QList<QRectF> result;
-    if (!key.isEmpty() && m_data.contains(key)) {
-        for (const auto &a : trackingData(key)) {
-            result << a.rect;
-        }
+    const auto &items = trackingData(keyForRow(row));
+    result.reserve(items.size());
+    for (const auto &a : items) {
+        result << a.rect;
     }
     return result;
 }
 
+QRectF MotionTrackerModel::trackingRect(const QString &key, int frame) const
+{
+    const auto &items = trackingData(key);
+    if (items.empty())
+        return QRectF();
+    auto it = std::upper_bound(items.cbegin(),
+                               items.cend(),
+                               frame,
+                               [](int frame, const TrackingItem &item) {
+                                   return frame < item.frame;
+                               });
+    if (it != items.cbegin())
+        --it;
+    return it->rect;
+}
+
+QRectF MotionTrackerModel::trackingRect(int row, int frame) const
+{
+    return trackingRect(keyForRow(row), frame);
+}
+
 int MotionTrackerModel::keyframeIntervalFrames(int row) const
 {
     auto key = keyForRow(row);
     if (!key.isEmpty() && m_data.contains(key))
-        return m_data.value(key).intervalFrames;
+        return m_data.constFind(key)->intervalFrames;
     return KEYFRAME_INTERVAL_FRAMES;
 }
 
@@ -276,9 +285,13 @@ QVariant MotionTrackerModel::data(const QModelIndex &index, int role) const
     if (!key.isEmpty()) {
         switch (role) {
         case Qt::DisplayRole:
-            return m_data.value(key).name;
-        case TrackingDataRole:
-            return m_data.value(key).trackingData;
+            return m_data.constFind(key)->name;
+        case TrackingDataRole: {
+            const auto &item = *m_data.constFind(key);
+            if (item.trackingData.isEmpty() && !item.trackingItems.empty())
+                item.trackingData = serializeTrackingData(item.trackingItems);
+            return item.trackingData;
+        }
         default:
             break;
         }
@@ -297,7 +310,8 @@ bool MotionTrackerModel::setData(const QModelIndex &index, const QVariant &value
                 emit dataChanged(index, index, {role});
                 break;
             case TrackingDataRole:
-                m_data[key].trackingData = value.toString();
+                m_data[key].trackingItems = parseTrackingData(value.toString());
+                m_data[key].trackingData.clear();
                 emit dataChanged(index, index, {role});
                 break;
             default:
@@ -324,3 +338,70 @@ void MotionTrackerModel::undo(QmlFilter *filter, const QString &propertyName)
         filter->resetProperty(kBackupProperty);
     }
 }
+
+// Parses the "frame~=rect;..." results of the opencv.tracker filter.
+std::vector<MotionTrackerModel::TrackingItem> MotionTrackerModel::parseTrackingData(
+    const QString &data)
+{
+    std::vector<TrackingItem> result;
+    const auto bytes = data.toLatin1();
+    Mlt::Properties props;
+    for (const auto &item : bytes.split(';')) {
+        const auto separator = item.indexOf("~=");
+        if (separator < 0)
+            continue;
+        bool ok = false;
+        const auto frame = item.left(separator).toInt(&ok);
+        if (!ok)
+            continue;
+        const char *value = item.constData() + separator + 2;
+        double values[4] = {0.0, 0.0, 0.0, 0.0};
+        if (std::strchr(value, '%')) {
+            // Let MLT handle the relative values.
+            props.set("", value);
+            const auto rect = props.get_rect("");
+            values[0] = rect.x;
+            values[1] = rect.y;
+            values[2] = rect.w;
+            values[3] = rect.h;
+        } else {
+            // Like mlt_property_get_rect(), read the numbers between any delimiters.
+            const char *p = value;
+            for (int i = 0; i < 4 && *p; ++i) {
+                char *end = nullptr;
+                values[i] = std::strtod(p, &end);
+                if (end == p)
+                    break;
+                p = *end ? end + 1 : end;
+            }
+        }
+        result.push_back({frame, QRectF(values[0], values[1], values[2], values[3])});
+    }
+    if (!std::is_sorted(result.cbegin(),
+                        result.cend(),
+                        [](const TrackingItem &a, const TrackingItem &b) {
+                            return a.frame < b.frame;
+                        })) {
+        std::stable_sort(result.begin(),
+                         result.end(),
+                         [](const TrackingItem &a, const TrackingItem &b) {
+                             return a.frame < b.frame;
+                         });
+    }
+    return result;
+}
+
+QString MotionTrackerModel::serializeTrackingData(const std::vector<TrackingItem> &items)
+{
+    QStringList list;
+    list.reserve(items.size());
+    for (const auto &item : items) {
+        list << QStringLiteral("%1~=%2 %3 %4 %5")
+                    .arg(item.frame)
+                    .arg(item.rect.x(), 0, 'g', 10)
+                    .arg(item.rect.y(), 0, 'g', 10)
+                    .arg(item.rect.width(), 0, 'g', 10)
+                    .arg(item.rect.height(), 0, 'g', 10);
+    }
+    return list.join(';');
+}
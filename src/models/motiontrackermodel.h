@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -25,6 +25,8 @@
 #include <QRectF>
 #include <QString>
 
+#include <vector>
+
 class QmlFilter;
 namespace Mlt {
 class Service;
@@ -54,8 +56,12 @@ public:
     QString keyForRow(int row) const;
     QString keyForFilter(Mlt::Service *service);
     Q_INVOKABLE void reset(QmlFilter *filter, const QString &property, int row);
-    QList<TrackingItem> trackingData(const QString &key) const;
+    //! Returns the tracking results of \a key ordered by frame.
+    const std::vector<TrackingItem> &trackingData(const QString &key) const;
     Q_INVOKABLE QList<QRectF> trackingData(int row) const;
+    //! Returns the tracked rectangle at or before \a frame.
+    QRectF trackingRect(const QString &key, int frame) const;
+    Q_INVOKABLE QRectF trackingRect(int row, int frame) const;
     Q_INVOKABLE int keyframeIntervalFrames(int row) const;
 
     int rowCount(const QModelIndex &parent = QModelIndex()) const override;
@@ -82,10 +88,15 @@ private:
     struct Item
     {
         QString name;
-        QString trackingData;
+        std::vector<TrackingItem> trackingItems;
         int intervalFrames;
+        // The MLT string of trackingItems, made when first needed
+        mutable QString trackingData;
     };
 
+    static std::vector<TrackingItem> parseTrackingData(const QString &data);
+    static QString serializeTrackingData(const std::vector<TrackingItem> &items);
+
     QMap<QString, Item> m_data; // key is a UUID
 };
 
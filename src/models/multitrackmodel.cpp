@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -26,16 +26,22 @@
 #include "mltcontroller.h"
 #include "proxymanager.h"
 #include "qmltypes/qmlmetadata.h"
+#include "scenedetecttask.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "trackprefetcher.h"
 #include "util.h"
 
+#include <MltChain.h>
+#include <MltLink.h>
 #include <QApplication>
 #include <QMessageBox>
 #include <QScopedPointer>
 #include <QTimer>
 #include <qmath.h>
 
+#include <algorithm>
+
 static const quintptr NO_PARENT_ID = quintptr(-1);
 static const char *kShotcutDefaultTransition = "lumaMix";
 
@@ -48,10 +54,41 @@ MultitrackModel::MultitrackModel(QObject *parent)
     connect(this, SIGNAL(modified()), SLOT(adjustTrackFilters()));
     connect(this, SIGNAL(reloadRequested()), SLOT(reload()), Qt::QueuedConnection);
     connect(this, &MultitrackModel::created, this, &MultitrackModel::scaleFactorChanged);
+
+    // The edits of the model signal what they changed in the clips. Those that
+    // only change the playlist are caught by onPlaylistChanged().
+    connect(this, &QAbstractItemModel::dataChanged, this, [this](const QModelIndex &topLeft) {
+        invalidateClipIndex(topLeft.parent());
+    });
+    connect(this, &QAbstractItemModel::rowsInserted, this, &MultitrackModel::invalidateClipIndex);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &MultitrackModel::invalidateClipIndex);
+    connect(this, &QAbstractItemModel::rowsMoved, this, [this]() {
+        invalidateClipIndex(QModelIndex());
+    });
+    connect(this, &QAbstractItemModel::rowsInserted, this, &MultitrackModel::onBatchRowsChanged);
+    connect(this, &QAbstractItemModel::rowsRemoved, this, &MultitrackModel::onBatchRowsChanged);
+    connect(this,
+            &QAbstractItemModel::rowsMoved,
+            this,
+            [this](const QModelIndex &parent, int, int, const QModelIndex &destination) {
+                onBatchRowsChanged(parent);
+                onBatchRowsChanged(destination);
+            });
+    connect(this, &QAbstractItemModel::modelAboutToBeReset, this, [this]() {
+        invalidateClipIndex(QModelIndex());
+        m_clipXML.clear();
+        // The views read everything again after a reset.
+        m_batchRanges.clear();
+    });
+    connect(this, &QAbstractItemModel::layoutChanged, this, [this]() {
+        invalidateClipIndex(QModelIndex());
+    });
 }
 
 MultitrackModel::~MultitrackModel()
 {
+    m_clipIndexes.clear();
+    m_clipXML.clear();
     delete m_tractor;
     m_tractor = 0;
 }
@@ -89,6 +126,37 @@ QVariant MultitrackModel::data(const QModelIndex &index, int role) const
         return QVariant();
     if (index.parent().isValid()) {
         // Get data for a clip.
+        const int row = index.row();
+        const ClipIndex *clips = cachedClips(index.internalId());
+        if (clips && row < clips->start.size()) {
+            switch (role) {
+            case NameRole:
+                return clips->name.at(row);
+            case ResourceRole:
+            case Qt::DisplayRole:
+                return clips->resource.at(row);
+            case ServiceRole:
+                if (clips->service.at(row).isNull())
+                    return QVariant();
+                return clips->service.at(row);
+            case IsBlankRole:
+                return bool(clips->flags.at(row) & ClipIndex::IsBlank);
+            case StartRole:
+                return clips->start.at(row);
+            case DurationRole:
+                return clips->duration.at(row);
+            case InPointRole:
+                return clips->in.at(row);
+            case OutPointRole:
+                return clips->out.at(row);
+            case FramerateRole:
+                return clips->fps.at(row);
+            case IsTransitionRole:
+                return bool(clips->flags.at(row) & ClipIndex::IsTransition);
+            default:
+                break;
+            }
+        }
         int i = m_trackList.at(index.internalId()).mlt_index;
         QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
         if (track) {
@@ -97,26 +165,8 @@ QVariant MultitrackModel::data(const QModelIndex &index, int role) const
             QScopedPointer<Mlt::ClipInfo> info(playlist.clip_info(index.row()));
             if (info)
                 switch (role) {
-                case NameRole: {
-                    QString result;
-                    if (info->producer && info->producer->is_valid()) {
-                        result = info->producer->get(kShotcutCaptionProperty);
-                        if (result.isNull()) {
-                            result = Util::baseName(ProxyManager::resource(*info->producer));
-                            if (!::qstrcmp(info->producer->get("mlt_service"), "timewarp")) {
-                                double speed = ::fabs(info->producer->get_double("warp_speed"));
-                                result = QStringLiteral("%1 (%2x)").arg(result).arg(speed);
-                            }
-                        }
-                        if (result == "<producer>") {
-                            result = QString::fromUtf8(info->producer->get("mlt_service"));
-                        }
-                        if (info->producer->get_int(kIsProxyProperty)) {
-                            result.append("\n" + tr("(PROXY)"));
-                        }
-                    }
-                    return result;
-                }
+                case NameRole:
+                    return clipName(info->producer);
                 case CommentRole: {
                     QString result;
                     if (info->producer && info->producer->is_valid()) {
@@ -153,12 +203,9 @@ QVariant MultitrackModel::data(const QModelIndex &index, int role) const
                 case AudioLevelsRole: {
                     QVariant result;
                     if (info->producer && info->producer->is_valid()) {
-                        info->producer->lock();
-                        if (info->producer->get_data(kAudioLevelsProperty)) {
-                            result = QVariant::fromValue(
-                                *((QVariantList *) info->producer->get_data(kAudioLevelsProperty)));
-                        }
-                        info->producer->unlock();
+                        auto levels = AudioLevelsTask::levels(*info->producer);
+                        if (!levels.isEmpty())
+                            result = QVariant::fromValue(levels);
                     }
                     return result;
                 }
@@ -367,10 +414,46 @@ void MultitrackModel::setTrackName(int row, const QString &value)
             QModelIndex modelIndex = index(row, 0);
             QVector<int> roles;
             roles << NameRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyModified();
+        }
+    }
+}
+
+// Returns the transition of \a name that composites the track \a trackIndex of \a tractor.
+static Mlt::Transition *findTransition(Mlt::Service &tractor, const QString &name, int trackIndex)
+{
+    QScopedPointer<Mlt::Service> service(tractor.producer());
+    while (service && service->is_valid()) {
+        if (service->type() == mlt_service_transition_type) {
+            Mlt::Transition t((mlt_transition) service->get_service());
+            if (name == t.get("mlt_service") && t.get_b_track() == trackIndex)
+                return new Mlt::Transition(t);
         }
+        service.reset(service->producer());
     }
+    return nullptr;
+}
+
+static Mlt::Transition *findVideoBlendTransition(Mlt::Service &tractor, int trackIndex)
+{
+    auto transition = findTransition(tractor, "qtblend", trackIndex);
+    if (!transition)
+        transition = findTransition(tractor, "movit.overlay", trackIndex);
+    if (!transition)
+        transition = findTransition(tractor, "frei0r.cairoblend", trackIndex);
+    return transition;
+}
+
+// Sets the hide flags of the track \a mltIndex of \a producer if it is a tractor.
+static void setTrackHide(Mlt::Producer &producer, int mltIndex, int hide)
+{
+    if (producer.type() != mlt_service_tractor_type)
+        return;
+    Mlt::Tractor tractor(producer);
+    QScopedPointer<Mlt::Producer> track(tractor.track(mltIndex));
+    if (track && track->is_valid())
+        track->set("hide", hide);
 }
 
 void MultitrackModel::setTrackMute(int row, bool mute)
@@ -383,14 +466,16 @@ void MultitrackModel::setTrackMute(int row, bool mute)
             if (mute)
                 hide |= 2;
             else
-                hide ^= 2;
+                hide &= ~2;
             track->set("hide", hide);
+            refreshTrack(Mlt::Controller::TrackAudioChange,
+                         [=](Mlt::Producer &producer) { setTrackHide(producer, i, hide); });
 
             QModelIndex modelIndex = index(row, 0);
             QVector<int> roles;
             roles << IsMuteRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyTrackStateChanged(row, true);
         }
     }
 }
@@ -405,15 +490,16 @@ void MultitrackModel::setTrackHidden(int row, bool hidden)
             if (hidden)
                 hide |= 1;
             else
-                hide ^= 1;
+                hide &= ~1;
             track->set("hide", hide);
-            MLT.refreshConsumer();
+            refreshTrack(Mlt::Controller::TrackVideoChange,
+                         [=](Mlt::Producer &producer) { setTrackHide(producer, i, hide); });
 
             QModelIndex modelIndex = index(row, 0);
             QVector<int> roles;
             roles << IsHiddenRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyTrackStateChanged(row, true);
         }
     }
 }
@@ -426,13 +512,17 @@ void MultitrackModel::setTrackComposite(int row, bool composite)
         if (transition && transition->is_valid()) {
             transition->set("disable", !composite);
         }
-        MLT.refreshConsumer();
+        refreshTrack(Mlt::Controller::TrackVideoChange, [=](Mlt::Producer &producer) {
+            QScopedPointer<Mlt::Transition> transition(findVideoBlendTransition(producer, i));
+            if (transition && transition->is_valid())
+                transition->set("disable", !composite);
+        });
 
         QModelIndex modelIndex = index(row, 0);
         QVector<int> roles;
         roles << IsCompositeRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
-        emit modified();
+        notifyDataChanged(modelIndex, modelIndex, roles);
+        notifyTrackStateChanged(row, true);
     }
 }
 
@@ -446,8 +536,8 @@ void MultitrackModel::setTrackLock(int row, bool lock)
         QModelIndex modelIndex = index(row, 0);
         QVector<int> roles;
         roles << IsLockedRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
-        emit modified();
+        notifyDataChanged(modelIndex, modelIndex, roles);
+        notifyTrackStateChanged(row, false);
     }
 }
 
@@ -538,7 +628,7 @@ int MultitrackModel::trimClipIn(
         QVector<int> roles;
         roles << DurationRole;
         roles << InPointRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
+        notifyDataChanged(modelIndex, modelIndex, roles);
         AudioLevelsTask::start(*info->producer, this, modelIndex);
 
         if (!ripple) {
@@ -558,7 +648,7 @@ int MultitrackModel::trimClipIn(
                     QModelIndex index = createIndex(clipIndex - 1, 0, i);
                     QVector<int> roles;
                     roles << DurationRole;
-                    emit dataChanged(index, index, roles);
+                    notifyDataChanged(index, index, roles);
                 }
             } else if (delta > 0) {
                 //            LOG_DEBUG() << "add blank on left duration" << delta - 1;
@@ -576,16 +666,9 @@ int MultitrackModel::trimClipIn(
             track_b->set_in_and_out(track_b->get_in() + delta, track_b->get_out() + delta);
             playlist.unblock();
         }
-        emit modified();
-    }
-    if (delta > 0) {
-        foreach (int idx, otherTracksToRipple) {
-            Q_ASSERT(otherTracksPosition != -1);
-            removeRegion(idx, otherTracksPosition, delta);
-        }
-    } else {
-        insertOrAdjustBlankAt(otherTracksToRipple, otherTracksPosition, -delta);
+        notifyModified();
     }
+    this->ripple(otherTracksToRipple, otherTracksPosition, -delta);
     return result;
 }
 
@@ -595,8 +678,8 @@ void MultitrackModel::notifyClipIn(int trackIndex, int clipIndex)
         QModelIndex index = createIndex(clipIndex, 0, trackIndex);
         QVector<int> roles;
         roles << AudioLevelsRole;
-        emit dataChanged(index, index, roles);
-        MLT.refreshConsumer();
+        notifyDataChanged(index, index, roles);
+        refreshConsumer();
     }
     m_isMakingTransition = false;
 }
@@ -635,7 +718,7 @@ void MultitrackModel::setTrackHeight(int height)
         Settings.setTimelineTrackHeight(qBound(10, height, 150));
         m_tractor->set(kTrackHeightProperty, Settings.timelineTrackHeight());
         emit trackHeightChanged();
-        emit modified();
+        notifyModified();
     }
 }
 
@@ -651,7 +734,7 @@ void MultitrackModel::setTrackHeaderWidth(int width)
     if (m_tractor) {
         m_tractor->set(kTrackHeaderWidthProperty, width);
         emit trackHeaderWidthChanged();
-        emit modified();
+        notifyModified();
     }
 }
 
@@ -730,7 +813,7 @@ int MultitrackModel::trimClipOut(
                     QModelIndex index = createIndex(clipIndex + 1, 0, i);
                     QVector<int> roles;
                     roles << DurationRole;
-                    emit dataChanged(index, index, roles);
+                    notifyDataChanged(index, index, roles);
                 }
             } else if (delta > 0 && (clipIndex + 1) < playlist.count()) {
                 // Add blank to right.
@@ -758,18 +841,13 @@ int MultitrackModel::trimClipOut(
         QVector<int> roles;
         roles << DurationRole;
         roles << OutPointRole;
-        emit dataChanged(index, index, roles);
+        notifyDataChanged(index, index, roles);
         AudioLevelsTask::start(*info->producer, this, index);
-        emit modified();
-    }
-    if (delta > 0) {
-        foreach (int idx, otherTracksToRipple) {
-            Q_ASSERT(otherTracksPosition != -1);
-            removeRegion(idx, otherTracksPosition - delta, delta);
-        }
-    } else {
-        insertOrAdjustBlankAt(otherTracksToRipple, otherTracksPosition, -delta);
+        notifyModified();
     }
+    this->ripple(otherTracksToRipple,
+                 delta > 0 ? otherTracksPosition - delta : otherTracksPosition,
+                 -delta);
     return result;
 }
 
@@ -779,8 +857,8 @@ void MultitrackModel::notifyClipOut(int trackIndex, int clipIndex)
         QModelIndex index = createIndex(clipIndex, 0, trackIndex);
         QVector<int> roles;
         roles << AudioLevelsRole;
-        emit dataChanged(index, index, roles);
-        MLT.refreshConsumer();
+        notifyDataChanged(index, index, roles);
+        refreshConsumer();
     }
     m_isMakingTransition = false;
 }
@@ -810,34 +888,23 @@ bool MultitrackModel::moveClip(
                 if ((clipIndex + 1) < playlist.count() && position >= playlist.get_playtime()) {
                     // Clip relocated to end of playlist.
                     moveClipToEnd(playlist, toTrack, clipIndex, position, ripple, rippleAllTracks);
-                    emit modified();
+                    notifyModified();
                 } else if (fromTrack == toTrack && targetIndex >= clipIndex) {
                     // Push the clips.
                     int clipStart = playlist.clip_start(clipIndex);
                     int duration = position - clipStart;
-                    QList<int> trackList;
-                    trackList << fromTrack;
-                    if (rippleAllTracks) {
-                        for (int i = 0; i < m_trackList.count(); ++i) {
-                            if (i == fromTrack)
-                                continue;
-                            int mltIndex = m_trackList.at(i).mlt_index;
-                            QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-                            if (otherTrack && otherTrack->get_int(kTrackLockProperty))
-                                continue;
-                            trackList << i;
-                        }
-                    }
-                    insertOrAdjustBlankAt(trackList, clipStart, duration);
+                    insertOrAdjustBlankAt({fromTrack}, clipStart, duration);
+                    if (rippleAllTracks)
+                        this->ripple(unlockedTracks(fromTrack), clipStart, duration);
                     consolidateBlanks(playlist, fromTrack);
-                    emit modified();
+                    notifyModified();
                 } else if (fromTrack == toTrack
                            && (playlist.is_blank_at(position) || targetIndex == clipIndex)
                            && (playlist.is_blank_at(position + length - 1)
                                || targetIndexEnd == clipIndex)) {
                     // Reposition the clip within its current blank spot.
                     moveClipInBlank(playlist, toTrack, clipIndex, position, ripple, rippleAllTracks);
-                    emit modified();
+                    notifyModified();
                 } else {
                     int clipPlaytime = clip.get_playtime();
                     int clipStart = playlist.clip_start(clipIndex);
@@ -852,19 +919,7 @@ bool MultitrackModel::moveClip(
 
                     // Ripple delete on all unlocked tracks.
                     if (clipPlaytime > 0 && rippleAllTracks)
-                        for (int j = 0; j < m_trackList.count(); ++j) {
-                            if (j == fromTrack)
-                                continue;
-
-                            int mltIndex = m_trackList.at(j).mlt_index;
-                            QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-                            if (otherTrack) {
-                                if (otherTrack->get_int(kTrackLockProperty))
-                                    continue;
-
-                                removeRegion(j, clipStart, clipPlaytime);
-                            }
-                        }
+                        this->ripple(unlockedTracks(fromTrack), clipStart, -clipPlaytime);
                     consolidateBlanks(playlist, fromTrack);
 
                     // Insert clip
@@ -881,7 +936,7 @@ bool MultitrackModel::moveClip(
                 roles << ServiceRole;
                 roles << IsBlankRole;
                 roles << IsTransitionRole;
-                emit dataChanged(index, index, roles);
+                notifyDataChanged(index, index, roles);
 
                 consolidateBlanks(playlist, fromTrack);
 
@@ -889,7 +944,7 @@ bool MultitrackModel::moveClip(
                 if (position + clip.get_playtime() >= 0)
                     overwrite(toTrack, clip, position, false /* seek */);
                 else
-                    emit modified();
+                    notifyModified();
             }
         }
         result = true;
@@ -942,7 +997,7 @@ int MultitrackModel::overwriteClip(int trackIndex, Mlt::Producer &clip, int posi
                 QModelIndex modelIndex = createIndex(targetIndex, 0, trackIndex);
                 QVector<int> roles;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
                 AudioLevelsTask::start(clip.parent(), this, modelIndex);
                 ++targetIndex;
             } else if (position < 0) {
@@ -952,7 +1007,7 @@ int MultitrackModel::overwriteClip(int trackIndex, Mlt::Producer &clip, int posi
                 QVector<int> roles;
                 roles << InPointRole;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
             }
 
             // Adjust clip on right.
@@ -964,7 +1019,7 @@ int MultitrackModel::overwriteClip(int trackIndex, Mlt::Producer &clip, int posi
                 // Notify clip on right was adjusted.
                 QVector<int> roles;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
                 AudioLevelsTask::start(clip.parent(), this, modelIndex);
             } else {
                 //                LOG_DEBUG() << "remove item on right";
@@ -985,7 +1040,7 @@ int MultitrackModel::overwriteClip(int trackIndex, Mlt::Producer &clip, int posi
         if (result >= 0) {
             QModelIndex index = createIndex(result, 0, trackIndex);
             AudioLevelsTask::start(clip.parent(), this, index);
-            emit modified();
+            notifyModified();
             if (seek)
                 emit seeked(playlist.clip_start(result) + playlist.clip_length(result));
         }
@@ -1053,7 +1108,7 @@ QString MultitrackModel::overwrite(
                 QVector<int> roles;
                 roles << InPointRole;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
             }
 
             int length = clip.get_playtime();
@@ -1083,7 +1138,7 @@ QString MultitrackModel::overwrite(
         AudioLevelsTask::start(clip.parent(), this, index);
         if (notify) {
             emit overWritten(trackIndex, targetIndex);
-            emit modified();
+            notifyModified();
             emit seeked(playlist.clip_start(targetIndex) + playlist.clip_length(targetIndex), seek);
         }
     }
@@ -1133,13 +1188,13 @@ int MultitrackModel::insertClip(
                 QModelIndex modelIndex = createIndex(targetIndex, 0, trackIndex);
                 QVector<int> roles;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
                 AudioLevelsTask::start(clip.parent(), this, modelIndex);
                 ++targetIndex;
 
                 // Notify item on right was adjusted.
                 modelIndex = createIndex(targetIndex, 0, trackIndex);
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
                 AudioLevelsTask::start(clip.parent(), this, modelIndex);
             } else if (position < 0) {
                 clip.set_in_and_out(clip.get_in() - position, clip.get_out());
@@ -1149,7 +1204,7 @@ int MultitrackModel::insertClip(
                 QVector<int> roles;
                 roles << InPointRole;
                 roles << DurationRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
             }
 
             // Insert clip between split blanks.
@@ -1168,26 +1223,14 @@ int MultitrackModel::insertClip(
         if (result >= 0) {
             if (rippleAllTracks) {
                 //fill in/expand blanks in all the other tracks
-                QList<int> tracksToInsertBlankInto;
-                for (int j = 0; j < m_trackList.count(); ++j) {
-                    if (j == trackIndex)
-                        continue;
-                    int mltIndex = m_trackList.at(j).mlt_index;
-                    QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-                    if (otherTrack->get_int(kTrackLockProperty))
-                        continue;
-
-                    tracksToInsertBlankInto << j;
-                }
-                if (!tracksToInsertBlankInto.isEmpty())
-                    insertOrAdjustBlankAt(tracksToInsertBlankInto, position, clipPlaytime);
+                ripple(unlockedTracks(trackIndex), position, clipPlaytime);
             }
 
             QModelIndex index = createIndex(result, 0, trackIndex);
             AudioLevelsTask::start(clip.parent(), this, index);
             if (notify) {
                 emit inserted(trackIndex, result);
-                emit modified();
+                notifyModified();
                 emit seeked(playlist.clip_start(result) + playlist.clip_length(result), seek);
             }
         }
@@ -1218,7 +1261,7 @@ int MultitrackModel::appendClip(int trackIndex, Mlt::Producer &clip, bool seek,
         AudioLevelsTask::start(clip.parent(), this, index);
         if (notify) {
             emit appended(trackIndex, i);
-            emit modified();
+            notifyModified();
             emit seeked(playlist.clip_start(i) + playlist.clip_length(i), seek);
         }
         return i;
@@ -1258,21 +1301,9 @@ void MultitrackModel::removeClip(int trackIndex, int clipIndex, bool rippleAllTr
 
             // Ripple all unlocked tracks.
             if (clipPlaytime > 0 && rippleAllTracks)
-                for (int j = 0; j < m_trackList.count(); ++j) {
-                    if (j == trackIndex)
-                        continue;
-
-                    int mltIndex = m_trackList.at(j).mlt_index;
-                    QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-                    if (otherTrack) {
-                        if (otherTrack->get_int(kTrackLockProperty))
-                            continue;
-
-                        removeRegion(j, clipStart, clipPlaytime);
-                    }
-                }
+                ripple(unlockedTracks(trackIndex), clipStart, -clipPlaytime);
             consolidateBlanks(playlist, trackIndex);
-            emit modified();
+            notifyModified();
         }
     }
 }
@@ -1301,11 +1332,11 @@ void MultitrackModel::liftClip(int trackIndex, int clipIndex)
             roles << ServiceRole;
             roles << IsBlankRole;
             roles << IsTransitionRole;
-            emit dataChanged(index, index, roles);
+            notifyDataChanged(index, index, roles);
 
             consolidateBlanks(playlist, trackIndex);
 
-            emit modified();
+            notifyModified();
         }
     }
 }
@@ -1385,14 +1416,14 @@ void MultitrackModel::splitClip(int trackIndex, int clipIndex, int position)
         roles << DurationRole;
         roles << InPointRole;
         roles << FadeInRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
+        notifyDataChanged(modelIndex, modelIndex, roles);
 
         if (!playlist.is_blank(clipIndex + 1)) {
             AudioLevelsTask::start(*info->producer, this, modelIndex);
             MLT.adjustClipFilters(*info->producer, in, filterOut, duration, 0, duration);
         }
 
-        emit modified();
+        notifyModified();
     }
 }
 
@@ -1430,7 +1461,7 @@ void MultitrackModel::joinClips(int trackIndex, int clipIndex)
         roles << DurationRole;
         roles << OutPointRole;
         roles << FadeOutRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
+        notifyDataChanged(modelIndex, modelIndex, roles);
         AudioLevelsTask::start(clip->parent(), this, modelIndex);
 
         clearMixReferences(trackIndex, clipIndex + 1);
@@ -1441,7 +1472,7 @@ void MultitrackModel::joinClips(int trackIndex, int clipIndex)
 
         MLT.adjustClipFilters(clip->parent(), in, out, 0, delta, 0);
 
-        emit modified();
+        notifyModified();
     }
 }
 
@@ -1476,8 +1507,8 @@ void MultitrackModel::changeGain(int trackIndex, int clipIndex, double gain)
                 QModelIndex modelIndex = createIndex(clipIndex, 0, trackIndex);
                 QVector<int> roles;
                 roles << GainRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
-                emit modified();
+                notifyDataChanged(modelIndex, modelIndex, roles);
+                notifyModified();
             }
         }
     }
@@ -1615,8 +1646,8 @@ void MultitrackModel::fadeIn(int trackIndex, int clipIndex, int duration)
                 QModelIndex modelIndex = createIndex(clipIndex, 0, trackIndex);
                 QVector<int> roles;
                 roles << FadeInRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
-                emit modified();
+                notifyDataChanged(modelIndex, modelIndex, roles);
+                notifyModified();
             }
         }
     }
@@ -1741,8 +1772,8 @@ void MultitrackModel::fadeOut(int trackIndex, int clipIndex, int duration)
                 QModelIndex modelIndex = createIndex(clipIndex, 0, trackIndex);
                 QVector<int> roles;
                 roles << FadeOutRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
-                emit modified();
+                notifyDataChanged(modelIndex, modelIndex, roles);
+                notifyModified();
             }
         }
     }
@@ -1842,15 +1873,15 @@ int MultitrackModel::addTransition(
             roles << StartRole;
             roles << OutPointRole;
             roles << DurationRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
+            notifyDataChanged(modelIndex, modelIndex, roles);
             modelIndex = createIndex(targetIndex + 2, 0, trackIndex);
             roles.clear();
             roles << StartRole;
             roles << InPointRole;
             roles << DurationRole;
             roles << AudioLevelsRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyModified();
             return targetIndex + 1;
         }
     }
@@ -1900,12 +1931,12 @@ void MultitrackModel::removeTransition(int trackIndex, int clipIndex)
         QVector<int> roles;
         roles << OutPointRole;
         roles << DurationRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
+        notifyDataChanged(modelIndex, modelIndex, roles);
         modelIndex = createIndex(clipIndex + 1, 0, trackIndex);
         roles << InPointRole;
         roles << DurationRole;
-        emit dataChanged(modelIndex, modelIndex, roles);
-        emit modified();
+        notifyDataChanged(modelIndex, modelIndex, roles);
+        notifyModified();
     }
 }
 
@@ -2018,10 +2049,10 @@ void MultitrackModel::trimTransitionIn(int trackIndex, int clipIndex, int delta,
         roles << InPointRole;
         roles << OutPointRole;
         roles << DurationRole;
-        emit dataChanged(createIndex(clipIndex, 0, trackIndex),
-                         createIndex(clipIndex + 1, 0, trackIndex),
-                         roles);
-        emit modified();
+        notifyDataChanged(createIndex(clipIndex, 0, trackIndex),
+                          createIndex(clipIndex + 1, 0, trackIndex),
+                          roles);
+        notifyModified();
     }
 }
 
@@ -2104,17 +2135,17 @@ void MultitrackModel::trimTransitionOut(int trackIndex, int clipIndex, int delta
         QVector<int> roles;
         roles << OutPointRole;
         roles << DurationRole;
-        emit dataChanged(createIndex(clipIndex - 1, 0, trackIndex),
-                         createIndex(clipIndex - 1, 0, trackIndex),
-                         roles);
+        notifyDataChanged(createIndex(clipIndex - 1, 0, trackIndex),
+                          createIndex(clipIndex - 1, 0, trackIndex),
+                          roles);
         roles.clear();
         roles << InPointRole;
         roles << OutPointRole;
         roles << DurationRole;
-        emit dataChanged(createIndex(clipIndex, 0, trackIndex),
-                         createIndex(clipIndex, 0, trackIndex),
-                         roles);
-        emit modified();
+        notifyDataChanged(createIndex(clipIndex, 0, trackIndex),
+                          createIndex(clipIndex, 0, trackIndex),
+                          roles);
+        notifyModified();
     }
 }
 
@@ -2191,8 +2222,8 @@ int MultitrackModel::addTransitionByTrimIn(int trackIndex, int clipIndex, int de
             QVector<int> roles;
             roles << OutPointRole;
             roles << DurationRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyModified();
             m_isMakingTransition = true;
             clipIndex += 1;
         } else if (m_isMakingTransition) {
@@ -2279,8 +2310,8 @@ void MultitrackModel::addTransitionByTrimOut(int trackIndex, int clipIndex, int
             QVector<int> roles;
             roles << InPointRole;
             roles << DurationRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
-            emit modified();
+            notifyDataChanged(modelIndex, modelIndex, roles);
+            notifyModified();
             m_isMakingTransition = true;
         } else if (m_isMakingTransition) {
             // Adjust a transition addition already in progress.
@@ -2352,7 +2383,7 @@ void MultitrackModel::filterAddedOrRemoved(Mlt::Producer *producer)
             roles << FadeInRole;
             roles << FadeOutRole;
             roles << IsFilteredRole;
-            emit dataChanged(modelIndex, modelIndex, roles);
+            notifyDataChanged(modelIndex, modelIndex, roles);
         }
     } else
         for (int i = 0; i < m_trackList.size(); i++) {
@@ -2362,7 +2393,7 @@ void MultitrackModel::filterAddedOrRemoved(Mlt::Producer *producer)
                 QModelIndex modelIndex = index(i, 0);
                 QVector<int> roles;
                 roles << IsFilteredRole;
-                emit dataChanged(modelIndex, modelIndex, roles);
+                notifyDataChanged(modelIndex, modelIndex, roles);
                 break;
             }
         }
@@ -2388,7 +2419,7 @@ void MultitrackModel::onFilterChanged(Mlt::Service *filter)
                 else if (!qstrcmp("audioGain", name))
                     roles << GainRole;
                 if (roles.length())
-                    emit dataChanged(modelIndex, modelIndex, roles);
+                    notifyDataChanged(modelIndex, modelIndex, roles);
             }
         }
     }
@@ -2416,7 +2447,7 @@ void MultitrackModel::moveClipToEnd(Mlt::Playlist &playlist,
             QModelIndex index = createIndex(clipIndex - 1, 0, trackIndex);
             QVector<int> roles;
             roles << DurationRole;
-            emit dataChanged(index, index, roles);
+            notifyDataChanged(index, index, roles);
         } else if ((clipIndex + 1) < n && playlist.is_blank(clipIndex + 1)) {
             // If there was a blank on the right adjust it.
             int duration = playlist.clip_length(clipIndex + 1) + playlist.clip_length(clipIndex);
@@ -2426,7 +2457,7 @@ void MultitrackModel::moveClipToEnd(Mlt::Playlist &playlist,
             QModelIndex index = createIndex(clipIndex + 1, 0, trackIndex);
             QVector<int> roles;
             roles << DurationRole;
-            emit dataChanged(index, index, roles);
+            notifyDataChanged(index, index, roles);
         } else {
             // Add new blank
             beginInsertRows(index(trackIndex), clipIndex, clipIndex);
@@ -2453,19 +2484,7 @@ void MultitrackModel::moveClipToEnd(Mlt::Playlist &playlist,
 
     // Ripple all unlocked tracks.
     if (clipPlaytime > 0 && ripple && rippleAllTracks)
-        for (int j = 0; j < m_trackList.count(); ++j) {
-            if (j == trackIndex)
-                continue;
-
-            int mltIndex = m_trackList.at(j).mlt_index;
-            QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-            if (otherTrack) {
-                if (otherTrack->get_int(kTrackLockProperty))
-                    continue;
-
-                removeRegion(j, clipStart, clipPlaytime);
-            }
-        }
+        this->ripple(unlockedTracks(trackIndex), clipStart, -clipPlaytime);
 }
 
 void MultitrackModel::moveClipInBlank(Mlt::Playlist &playlist,
@@ -2490,7 +2509,7 @@ void MultitrackModel::moveClipInBlank(Mlt::Playlist &playlist,
             QModelIndex index = createIndex(clipIndex - 1, 0, trackIndex);
             QVector<int> roles;
             roles << DurationRole;
-            emit dataChanged(index, index, roles);
+            notifyDataChanged(index, index, roles);
         } else {
             //            LOG_DEBUG() << "remove blank on left";
             int i = clipIndex - 1;
@@ -2520,7 +2539,7 @@ void MultitrackModel::moveClipInBlank(Mlt::Playlist &playlist,
             QModelIndex index = createIndex(clipIndex + 1, 0, trackIndex);
             QVector<int> roles;
             roles << DurationRole;
-            emit dataChanged(index, index, roles);
+            notifyDataChanged(index, index, roles);
         } else {
             //            LOG_DEBUG() << "remove blank on right";
             int i = clipIndex + 1;
@@ -2539,21 +2558,10 @@ void MultitrackModel::moveClipInBlank(Mlt::Playlist &playlist,
 
     // Ripple all unlocked tracks.
     if (clipPlaytime > 0 && ripple && rippleAllTracks) {
-        QList<int> otherTracksToRipple;
-        for (int i = 0; i < m_trackList.count(); ++i) {
-            if (i == trackIndex)
-                continue;
-            int mltIndex = m_trackList.at(i).mlt_index;
-            QScopedPointer<Mlt::Producer> otherTrack(m_tractor->track(mltIndex));
-            if (otherTrack && otherTrack->get_int(kTrackLockProperty))
-                continue;
-            otherTracksToRipple << i;
-        }
         if (position < clipStart) {
-            foreach (int idx, otherTracksToRipple)
-                removeRegion(idx, position, clipStart - position);
+            this->ripple(unlockedTracks(trackIndex), position, position - clipStart);
         } else {
-            insertOrAdjustBlankAt(otherTracksToRipple, clipStart, position - clipStart);
+            this->ripple(unlockedTracks(trackIndex), clipStart, position - clipStart);
             consolidateBlanks(playlist, trackIndex);
         }
     }
@@ -2568,7 +2576,7 @@ void MultitrackModel::consolidateBlanks(Mlt::Playlist &playlist, int trackIndex)
             QModelIndex idx = createIndex(i - 1, 0, trackIndex);
             QVector<int> roles;
             roles << DurationRole;
-            emit dataChanged(idx, idx, roles);
+            notifyDataChanged(idx, idx, roles);
             beginRemoveRows(index(trackIndex), i, i);
             playlist.remove(i--);
             endRemoveRows();
@@ -2608,7 +2616,7 @@ void MultitrackModel::audioLevelsReady(const QPersistentModelIndex &index)
 {
     QVector<int> roles;
     roles << AudioLevelsRole;
-    emit dataChanged(index, index, roles);
+    notifyDataChanged(index, index, roles);
 }
 
 bool MultitrackModel::createIfNeeded()
@@ -2706,12 +2714,7 @@ bool MultitrackModel::warnIfInvalid(Mlt::Service &service)
 
 Mlt::Transition *MultitrackModel::getVideoBlendTransition(int trackIndex) const
 {
-    auto transition = getTransition("qtblend", trackIndex);
-    if (!transition)
-        transition = getTransition("movit.overlay", trackIndex);
-    if (!transition)
-        transition = getTransition("frei0r.cairoblend", trackIndex);
-    return transition;
+    return findVideoBlendTransition(*m_tractor, trackIndex);
 }
 
 int MultitrackModel::bottomVideoTrackMltIndex() const
@@ -2890,7 +2893,7 @@ int MultitrackModel::addAudioTrack()
         addBackgroundTrack();
         addAudioTrack();
         emit created();
-        emit modified();
+        notifyModified();
         return 0;
     }
 
@@ -2928,7 +2931,7 @@ int MultitrackModel::addAudioTrack()
     beginInsertRows(QModelIndex(), m_trackList.count(), m_trackList.count());
     m_trackList.append(t);
     endInsertRows();
-    emit modified();
+    notifyModified();
     return m_trackList.count() - 1;
 }
 
@@ -2992,7 +2995,8 @@ int MultitrackModel::addVideoTrack()
     beginInsertRows(QModelIndex(), 0, 0);
     m_trackList.prepend(t);
     endInsertRows();
-    emit modified();
+    TrackPrefetcher::attach(*m_tractor);
+    notifyModified();
     return 0;
 }
 
@@ -3044,9 +3048,9 @@ void MultitrackModel::removeTrack(int trackIndex)
                     QScopedPointer<Mlt::Transition> transition(getVideoBlendTransition(1));
                     if (transition && transition->is_valid())
                         transition->set("disable", 1);
-                    emit dataChanged(modelIndex,
-                                     modelIndex,
-                                     QVector<int>() << IsBottomVideoRole << IsCompositeRole);
+                    notifyDataChanged(modelIndex,
+                                      modelIndex,
+                                      QVector<int>() << IsBottomVideoRole << IsCompositeRole);
                 }
 
                 // Rename default track names.
@@ -3057,7 +3061,7 @@ void MultitrackModel::removeTrack(int trackIndex)
                 if (mltTrack && mltTrack->get(kTrackNameProperty) == trackName) {
                     trackName = trackNameTemplate.arg(m_trackList[row].number + 1);
                     mltTrack->set(kTrackNameProperty, trackName.toUtf8().constData());
-                    emit dataChanged(modelIndex, modelIndex, QVector<int>() << NameRole);
+                    notifyDataChanged(modelIndex, modelIndex, QVector<int>() << NameRole);
                 }
             }
             ++row;
@@ -3066,7 +3070,7 @@ void MultitrackModel::removeTrack(int trackIndex)
         MLT.updateAvformatCaching(m_tractor->count());
         //        foreach (Track t, m_trackList) LOG_DEBUG() << (t.type == VideoTrackType?"Video":"Audio") << "track number" << t.number << "mlt_index" << t.mlt_index;
     }
-    emit modified();
+    notifyModified();
 }
 
 void MultitrackModel::retainPlaylist()
@@ -3116,18 +3120,24 @@ void MultitrackModel::removeRegion(int trackIndex, int position, int length)
                 ++clipIndex;
             }
 
-            while (length > 0) {
-                if (playlist.clip_length(clipIndex) > length) {
-                    splitClip(trackIndex, clipIndex, position + length);
-                }
-                length -= playlist.clip_length(clipIndex);
-                if (clipIndex < playlist.count()) {
+            if (length > 0) {
+                // Split the last clip at the end of the region, and then
+                // remove all of the rows of the region at once.
+                int lastIndex = playlist.get_clip_index_at(position + length - 1);
+                if (playlist.clip_start(lastIndex) + playlist.clip_length(lastIndex)
+                    > position + length)
+                    splitClip(trackIndex, lastIndex, position + length);
+                lastIndex = qMin(lastIndex, playlist.count() - 1);
+                for (int j = clipIndex; j <= lastIndex; ++j) {
                     // Shotcut does not like the behavior of remove() on a
                     // transition (MLT mix clip). So, we null mlt_mix to prevent it.
-                    clearMixReferences(trackIndex, clipIndex);
-                    emit removing(playlist.get_clip(clipIndex));
-                    beginRemoveRows(index(trackIndex), clipIndex, clipIndex);
-                    playlist.remove(clipIndex);
+                    clearMixReferences(trackIndex, j);
+                    emit removing(playlist.get_clip(j));
+                }
+                if (clipIndex <= lastIndex) {
+                    beginRemoveRows(index(trackIndex), clipIndex, lastIndex);
+                    for (int j = lastIndex; j >= clipIndex; --j)
+                        playlist.remove(j);
                     endRemoveRows();
                 }
             }
@@ -3207,7 +3217,7 @@ void MultitrackModel::insertTrack(int trackIndex, TrackType type)
                     trackName = trackNameTemplate.arg(t.number + 1);
                     mltTrack->set(kTrackNameProperty, trackName.toUtf8().constData());
                     QModelIndex modelIndex = index(row, 0);
-                    emit dataChanged(modelIndex, modelIndex, QVector<int>() << NameRole);
+                    notifyDataChanged(modelIndex, modelIndex, QVector<int>() << NameRole);
                 }
                 ++m_trackList[row].number;
             }
@@ -3304,7 +3314,9 @@ void MultitrackModel::insertTrack(int trackIndex, TrackType type)
     m_trackList.insert(trackIndex, t);
     refreshVideoBlendTransitions();
     endInsertRows();
-    emit modified();
+    if (type == VideoTrackType)
+        TrackPrefetcher::attach(*m_tractor);
+    notifyModified();
     //    foreach (Track t, m_trackList) LOG_DEBUG() << (t.type == VideoTrackType?"Video":"Audio") << "track number" << t.number << "mlt_index" << t.mlt_index;
 }
 
@@ -3422,11 +3434,11 @@ void MultitrackModel::moveTrack(int fromTrackIndex, int toTrackIndex)
     refreshTrackList();
 
     endMoveRows();
-    emit dataChanged(index(0),
-                     index(m_trackList.size() - 1),
-                     QVector<int>() << IsTopVideoRole << IsBottomVideoRole << IsTopAudioRole
-                                    << IsBottomAudioRole << IsCompositeRole << NameRole);
-    emit modified();
+    notifyDataChanged(index(0),
+                      index(m_trackList.size() - 1),
+                      QVector<int>() << IsTopVideoRole << IsBottomVideoRole << IsTopAudioRole
+                                     << IsBottomAudioRole << IsCompositeRole << NameRole);
+    notifyModified();
 }
 
 void MultitrackModel::insertOrAdjustBlankAt(QList<int> tracks, int position, int length)
@@ -3442,7 +3454,7 @@ void MultitrackModel::insertOrAdjustBlankAt(QList<int> tracks, int position, int
             if (trackPlaylist.is_blank(idx)) {
                 trackPlaylist.resize_clip(idx, 0, trackPlaylist.clip_length(idx) + length - 1);
                 QModelIndex modelIndex = createIndex(idx, 0, trackIndex);
-                emit dataChanged(modelIndex, modelIndex, QVector<int>() << DurationRole);
+                notifyDataChanged(modelIndex, modelIndex, QVector<int>() << DurationRole);
                 continue;
             }
 
@@ -3451,7 +3463,7 @@ void MultitrackModel::insertOrAdjustBlankAt(QList<int> tracks, int position, int
             if (trackPlaylist.is_blank(idx)) {
                 trackPlaylist.resize_clip(idx, 0, trackPlaylist.clip_length(idx) + length - 1);
                 QModelIndex modelIndex = createIndex(idx, 0, trackIndex);
-                emit dataChanged(modelIndex, modelIndex, QVector<int>() << DurationRole);
+                notifyDataChanged(modelIndex, modelIndex, QVector<int>() << DurationRole);
             } else if (length > 0) {
                 int insertBlankAtIdx = idx;
                 if (trackPlaylist.clip_start(idx) < position) {
@@ -3468,6 +3480,115 @@ void MultitrackModel::insertOrAdjustBlankAt(QList<int> tracks, int position, int
     }
 }
 
+QList<int> MultitrackModel::unlockedTracks(int trackIndex) const
+{
+    QList<int> result;
+    for (int i = 0; i < m_trackList.count(); ++i) {
+        if (i == trackIndex)
+            continue;
+        QScopedPointer<Mlt::Producer> track(m_tractor->track(m_trackList.at(i).mlt_index));
+        if (track && !track->get_int(kTrackLockProperty))
+            result << i;
+    }
+    return result;
+}
+
+QList<MultitrackModel::RippleOffset> MultitrackModel::rippleOffsets(const QList<int> &tracks,
+                                                                    int position,
+                                                                    int length,
+                                                                    QSet<int> *contentTracks) const
+{
+    QList<RippleOffset> result;
+    for (int trackIndex : tracks) {
+        QScopedPointer<Mlt::Producer> track(
+            m_tractor->track(m_trackList.at(trackIndex).mlt_index));
+        if (!track || !length)
+            continue;
+        Mlt::Playlist playlist(*track);
+        const int playtime = playlist.get_playtime();
+        if (length > 0) {
+            // Nothing after the end of the track needs to move.
+            if (position >= playtime)
+                continue;
+            const int clipIndex = playlist.get_clip_index_at(position);
+            if (playlist.is_blank(clipIndex) || playlist.clip_start(clipIndex) == position
+                || (position > 0 && playlist.is_blank_at(position - 1)))
+                result << RippleOffset{trackIndex, position, length};
+            else if (contentTracks)
+                contentTracks->insert(trackIndex);
+        } else {
+            const int end = qMin(position - length, playtime);
+            if (position >= end)
+                continue;
+            // The blanks are consolidated, so blank frames are in one blank.
+            const int clipIndex = playlist.get_clip_index_at(position);
+            if (playlist.is_blank(clipIndex)
+                && playlist.clip_start(clipIndex) + playlist.clip_length(clipIndex) >= end)
+                result << RippleOffset{trackIndex, position, position - end};
+            else if (contentTracks)
+                contentTracks->insert(trackIndex);
+        }
+    }
+    return result;
+}
+
+void MultitrackModel::applyRippleOffsets(const QList<RippleOffset> &offsets)
+{
+    for (const auto &offset : offsets) {
+        QScopedPointer<Mlt::Producer> track(
+            m_tractor->track(m_trackList.at(offset.trackIndex).mlt_index));
+        if (!track || !offset.length)
+            continue;
+        Mlt::Playlist playlist(*track);
+        if (offset.length > 0 && offset.position >= playlist.get_playtime()) {
+            // Undoing the removal of a blank at the end.
+            const int n = playlist.count();
+            beginInsertRows(index(offset.trackIndex), n, n);
+            playlist.blank(offset.length - 1);
+            endInsertRows();
+        } else if (offset.length > 0) {
+            insertOrAdjustBlankAt({offset.trackIndex}, offset.position, offset.length);
+        } else {
+            const int clipIndex = playlist.get_clip_index_at(offset.position);
+            Q_ASSERT(playlist.is_blank(clipIndex));
+            const int length = playlist.clip_length(clipIndex) + offset.length;
+            if (length > 0) {
+                playlist.resize_clip(clipIndex, 0, length - 1);
+                QModelIndex modelIndex = createIndex(clipIndex, 0, offset.trackIndex);
+                notifyDataChanged(modelIndex, modelIndex, QVector<int>() << DurationRole);
+            } else {
+                beginRemoveRows(index(offset.trackIndex), clipIndex, clipIndex);
+                playlist.remove(clipIndex);
+                endRemoveRows();
+            }
+        }
+    }
+}
+
+void MultitrackModel::ripple(const QList<int> &tracks, int position, int length)
+{
+    if (tracks.isEmpty() || !length)
+        return;
+    // Work out every track before changing any so that the view and the
+    // consumer are only told once, and most tracks only resize a blank.
+    QSet<int> contentTracks;
+    const auto offsets = rippleOffsets(tracks, position, length, &contentTracks);
+    beginBatch();
+    applyRippleOffsets(offsets);
+    for (int trackIndex : tracks) {
+        if (!contentTracks.contains(trackIndex))
+            continue;
+        if (length < 0)
+            removeRegion(trackIndex, position, -length);
+        else
+            insertOrAdjustBlankAt({trackIndex}, position, length);
+    }
+    LOG_DEBUG() << "rippled" << offsets.size() << "tracks by offset and" << contentTracks.size()
+                << "tracks with clips";
+    notifyModified();
+    endBatch();
+}
+
 bool MultitrackModel::mergeClipWithNext(int trackIndex, int clipIndex, bool dryrun)
 {
     int i = m_trackList.at(trackIndex).mlt_index;
@@ -3495,12 +3616,12 @@ bool MultitrackModel::mergeClipWithNext(int trackIndex, int clipIndex, bool dryr
     QVector<int> roles;
     roles << FadeInRole;
     roles << FadeOutRole;
-    emit dataChanged(modelIndex, modelIndex, roles);
+    notifyDataChanged(modelIndex, modelIndex, roles);
 
     liftClip(trackIndex, clipIndex + 1);
     trimClipOut(trackIndex, clipIndex, -clip2.frame_count, false, false);
 
-    emit modified();
+    notifyModified();
     return true;
 }
 
@@ -3672,6 +3793,7 @@ void MultitrackModel::close()
         return;
     emit aboutToClose();
     AudioLevelsTask::closeAll();
+    SceneDetectTask::closeAll();
     beginResetModel();
     delete m_tractor;
     m_tractor = nullptr;
@@ -3684,6 +3806,16 @@ void MultitrackModel::close()
 
 int MultitrackModel::clipIndex(int trackIndex, int position)
 {
+    // The clips of a playlist are contiguous, so their starts are sorted.
+    if (const ClipIndex *clips = cachedClips(trackIndex)) {
+        const auto &start = clips->start;
+        if (start.isEmpty())
+            return 0;
+        if (position >= start.last() + clips->duration.last())
+            return start.size();
+        const auto it = std::upper_bound(start.constBegin(), start.constEnd(), position);
+        return qMax(0, int(it - start.constBegin()) - 1);
+    }
     int i = m_trackList.at(trackIndex).mlt_index;
     QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
     if (track) {
@@ -3693,6 +3825,65 @@ int MultitrackModel::clipIndex(int trackIndex, int position)
     return -1; // error
 }
 
+int MultitrackModel::nextEdit(int position) const
+{
+    int result = -1;
+    for (int i = 0; i < m_trackList.size(); ++i) {
+        const ClipIndex *clips = cachedClips(i);
+        // Skip empty tracks (tracks with only one blank clip)
+        if (!clips || clips->start.isEmpty()
+            || (clips->start.size() == 1 && (clips->flags.first() & ClipIndex::IsBlank)))
+            continue;
+        const auto &start = clips->start;
+        const auto it = std::upper_bound(start.constBegin(), start.constEnd(), position);
+        int edit = start.last() + clips->duration.last();
+        if (it != start.constEnd())
+            edit = *it;
+        else if (edit <= position)
+            continue;
+        if (result < 0 || edit < result)
+            result = edit;
+    }
+    return result;
+}
+
+int MultitrackModel::previousEdit(int position) const
+{
+    int result = -1;
+    for (int i = 0; i < m_trackList.size(); ++i) {
+        const ClipIndex *clips = cachedClips(i);
+        if (!clips || clips->start.isEmpty()
+            || (clips->start.size() == 1 && (clips->flags.first() & ClipIndex::IsBlank)))
+            continue;
+        const auto &start = clips->start;
+        int edit = start.last() + clips->duration.last();
+        if (edit >= position) {
+            const auto it = std::lower_bound(start.constBegin(), start.constEnd(), position);
+            if (it == start.constBegin())
+                continue;
+            edit = *(it - 1);
+        }
+        result = qMax(result, edit);
+    }
+    return result;
+}
+
+QList<int> MultitrackModel::clipsInRange(int trackIndex, int start, int end) const
+{
+    QList<int> result;
+    const ClipIndex *clips = cachedClips(trackIndex);
+    if (!clips || end <= start)
+        return result;
+    const auto &starts = clips->start;
+    auto it = std::upper_bound(starts.constBegin(), starts.constEnd(), start);
+    int i = qMax(0, int(it - starts.constBegin()) - 1);
+    for (; i < starts.size() && starts.at(i) < end; ++i) {
+        if (starts.at(i) + clips->duration.at(i) > start)
+            result << i;
+    }
+    return result;
+}
+
 void MultitrackModel::refreshTrackList()
 {
     int n = m_tractor->count();
@@ -3708,7 +3899,7 @@ void MultitrackModel::refreshTrackList()
         QString trackId = track->get("id");
         if (trackId == "black_track")
             isKdenlive = true;
-        else if (trackId == kBackgroundTrackId)
+        else if (trackId == kBackgroundTrackId || trackId == kRenderPreviewTrackId)
             continue;
         else if (!track->get(kShotcutPlaylistProperty) && !track->get(kAudioTrackProperty)) {
             int hide = track->get_int("hide");
@@ -3745,7 +3936,8 @@ void MultitrackModel::refreshTrackList()
         else if (isKdenlive && trackId == "playlist1")
             // In Kdenlive, playlist1 is a special audio mixdown track.
             continue;
-        else if (trackId == kPlaylistTrackId || trackId == kLegacyPlaylistTrackId)
+        else if (trackId == kPlaylistTrackId || trackId == kLegacyPlaylistTrackId
+                 || trackId == kRenderPreviewTrackId)
             continue;
         else if (!track->get(kShotcutPlaylistProperty) && !track->get(kVideoTrackProperty)) {
             int hide = track->get_int("hide");
@@ -3766,6 +3958,367 @@ void MultitrackModel::refreshTrackList()
     }
 }
 
+const MultitrackModel::ClipIndex *MultitrackModel::cachedClips(int trackIndex) const
+{
+    if (!m_tractor || trackIndex < 0 || trackIndex >= m_trackList.size())
+        return nullptr;
+    // This does not allocate a wrapper or a reference like Tractor::track().
+    mlt_producer track = mlt_multitrack_track(mlt_tractor_multitrack(m_tractor->get_tractor()),
+                                              m_trackList.at(trackIndex).mlt_index);
+    if (!track || mlt_service_identify(MLT_PRODUCER_SERVICE(track)) != mlt_service_playlist_type)
+        return nullptr;
+    auto playlistPointer = static_cast<mlt_playlist>(track->child);
+    ClipIndex &clips = m_clipIndexes[MLT_PRODUCER_PROPERTIES(track)];
+    // A new playlist may have the address of one that was closed.
+    if (clips.isValid && clips.start.size() == mlt_playlist_count(playlistPointer))
+        return &clips;
+
+    Mlt::Playlist playlist(playlistPointer);
+    if (!clips.listener) {
+        clips.listener.reset(playlist.listen("producer-changed",
+                                             const_cast<MultitrackModel *>(this),
+                                             (mlt_listener) onPlaylistChanged));
+    }
+    const int n = playlist.count();
+    clips.start.resize(n);
+    clips.duration.resize(n);
+    clips.in.resize(n);
+    clips.out.resize(n);
+    clips.fps.resize(n);
+    clips.flags.resize(n);
+    clips.name.clear();
+    clips.resource.clear();
+    clips.service.clear();
+    for (int i = 0; i < n; ++i) {
+        std::unique_ptr<Mlt::ClipInfo> info(playlist.clip_info(i));
+        if (!info) {
+            clips.start[i] = clips.duration[i] = clips.in[i] = clips.out[i] = 0;
+            clips.fps[i] = 0.0;
+            clips.flags[i] = 0;
+            clips.name << QString();
+            clips.resource << QString();
+            clips.service << QString();
+            continue;
+        }
+        clips.start[i] = info->start;
+        clips.duration[i] = info->frame_count;
+        clips.in[i] = info->frame_in;
+        clips.out[i] = info->frame_out;
+        clips.fps[i] = info->fps;
+        clips.flags[i] = (playlist.is_blank(i) ? ClipIndex::IsBlank : 0)
+                         | (isTransition(playlist, i) ? ClipIndex::IsTransition : 0);
+        clips.name << clipName(info->producer);
+        const bool isValid = info->producer && info->producer->is_valid();
+        QString resource = QString::fromUtf8(info->resource);
+        if (resource == "<producer>" && isValid && info->producer->get("mlt_service"))
+            resource = QString::fromUtf8(info->producer->get("mlt_service"));
+        clips.resource << resource;
+        clips.service << (isValid ? QString::fromUtf8(info->producer->get("mlt_service"))
+                                  : QString());
+    }
+    clips.isValid = true;
+    return &clips;
+}
+
+void MultitrackModel::invalidateClipIndex(const QModelIndex &parent)
+{
+    if (!parent.isValid() || !m_tractor || parent.row() >= m_trackList.size()) {
+        // The tracks changed.
+        m_clipIndexes.clear();
+        return;
+    }
+    mlt_producer track = mlt_multitrack_track(mlt_tractor_multitrack(m_tractor->get_tractor()),
+                                              m_trackList.at(parent.row()).mlt_index);
+    if (track) {
+        auto it = m_clipIndexes.find(MLT_PRODUCER_PROPERTIES(track));
+        if (it != m_clipIndexes.end())
+            it->isValid = false;
+    }
+}
+
+void MultitrackModel::onPlaylistChanged(mlt_properties owner,
+                                        MultitrackModel *self,
+                                        mlt_event_data)
+{
+    auto it = self->m_clipIndexes.find(owner);
+    if (it != self->m_clipIndexes.end())
+        it->isValid = false;
+}
+
+QString MultitrackModel::clipName(Mlt::Producer *producer) const
+{
+    QString result;
+    if (producer && producer->is_valid()) {
+        result = producer->get(kShotcutCaptionProperty);
+        if (result.isNull()) {
+            result = Util::baseName(ProxyManager::resource(*producer));
+            if (!::qstrcmp(producer->get("mlt_service"), "timewarp")) {
+                double speed = ::fabs(producer->get_double("warp_speed"));
+                result = QStringLiteral("%1 (%2x)").arg(result).arg(speed);
+            }
+        }
+        if (result == "<producer>") {
+            result = QString::fromUtf8(producer->get("mlt_service"));
+        }
+        if (producer->get_int(kIsProxyProperty)) {
+            result.append("\n" + tr("(PROXY)"));
+        }
+    }
+    return result;
+}
+
+QString MultitrackModel::clipXML(Mlt::Producer &producer)
+{
+    if (!producer.is_valid())
+        return QString();
+    // The tracks of a transition and other nested services are not watched.
+    const auto type = producer.type();
+    if (type != mlt_service_producer_type && type != mlt_service_chain_type)
+        return MLT.XML(&producer);
+    const int filterCount = producer.filter_count();
+    const int linkCount = (type == mlt_service_chain_type) ? Mlt::Chain(producer).link_count() : 0;
+    auto &clip = m_clipXML[producer.get_properties()];
+    if (clip && !clip->isDirty.load(std::memory_order_acquire) && clip->filterCount == filterCount
+        && clip->linkCount == linkCount)
+        return clip->xml;
+
+    clip = std::make_shared<ClipXML>(producer);
+    clip->xml = MLT.XML(&producer);
+    clip->filterCount = filterCount;
+    clip->linkCount = linkCount;
+    // Listen after serializing, which may set and restore properties.
+    auto listen = [&](Mlt::Properties &properties, const char *event) {
+        if (auto listener = properties.listen(event,
+                                              clip.get(),
+                                              (mlt_listener) onClipPropertyChanged))
+            clip->listeners.emplace_back(listener);
+    };
+    listen(producer, "property-changed");
+    listen(producer, "service-changed");
+    for (int i = 0; i < filterCount; ++i) {
+        std::unique_ptr<Mlt::Filter> filter(producer.filter(i));
+        if (filter && filter->is_valid())
+            listen(*filter, "property-changed");
+    }
+    if (linkCount > 0) {
+        Mlt::Chain chain(producer);
+        for (int i = 0; i < linkCount; ++i) {
+            std::unique_ptr<Mlt::Link> link(chain.link(i));
+            if (link && link->is_valid())
+                listen(*link, "property-changed");
+        }
+    }
+    return clip->xml;
+}
+
+void MultitrackModel::pruneClipXML()
+{
+    for (auto it = m_clipXML.begin(); it != m_clipXML.end();) {
+        // Only the cache holds a reference.
+        if (!it.value() || it.value()->producer.ref_count() <= 1)
+            it = m_clipXML.erase(it);
+        else
+            ++it;
+    }
+}
+
+void MultitrackModel::onClipPropertyChanged(mlt_properties, ClipXML *clip, mlt_event_data data)
+{
+    // Properties that begin with an underscore are not serialized.
+    const char *name = Mlt::EventData(data).to_string();
+    if (!name || name[0] != '_')
+        clip->isDirty.store(true, std::memory_order_release);
+}
+
+void MultitrackModel::beginBatch()
+{
+    ++m_batchDepth;
+}
+
+void MultitrackModel::endBatch()
+{
+    Q_ASSERT(m_batchDepth > 0);
+    if (m_batchDepth <= 0 || --m_batchDepth > 0)
+        return;
+    const auto ranges = m_batchRanges;
+    m_batchRanges.clear();
+    for (auto it = ranges.constBegin(); it != ranges.constEnd(); ++it) {
+        const QModelIndex parent = it.key() < 0 ? QModelIndex() : index(it.key());
+        if (it.key() >= 0 && !parent.isValid())
+            continue;
+        const int count = rowCount(parent);
+        int first = it.value().isWholeParent ? 0 : it.value().first;
+        int last = it.value().isWholeParent ? count - 1 : qMin(it.value().last, count - 1);
+        if (first > last)
+            continue;
+        emit dataChanged(index(first, 0, parent), index(last, 0, parent), it.value().roles);
+    }
+    if (m_isBatchModified) {
+        m_isBatchModified = false;
+        emit modified();
+    }
+    if (m_isBatchRefresh) {
+        m_isBatchRefresh = false;
+        MLT.refreshConsumer();
+    }
+}
+
+void MultitrackModel::notifyDataChanged(const QModelIndex &topLeft,
+                                        const QModelIndex &bottomRight,
+                                        const QVector<int> &roles)
+{
+    if (!m_batchDepth) {
+        emit dataChanged(topLeft, bottomRight, roles);
+        return;
+    }
+    if (!topLeft.isValid() || !bottomRight.isValid())
+        return;
+    // data() must not serve the cached values before the batch ends.
+    invalidateClipIndex(topLeft.parent());
+    const int key = topLeft.parent().isValid() ? topLeft.parent().row() : -1;
+    const bool isNew = !m_batchRanges.contains(key);
+    BatchRange &range = m_batchRanges[key];
+    if (isNew) {
+        range.first = topLeft.row();
+        range.last = bottomRight.row();
+        range.roles = roles;
+        return;
+    }
+    range.first = qMin(range.first, topLeft.row());
+    range.last = qMax(range.last, bottomRight.row());
+    if (roles.isEmpty() || range.roles.isEmpty()) {
+        range.roles.clear();
+    } else {
+        for (int role : roles) {
+            if (!range.roles.contains(role))
+                range.roles << role;
+        }
+    }
+}
+
+void MultitrackModel::notifyModified()
+{
+    if (m_batchDepth)
+        m_isBatchModified = true;
+    else
+        emit modified();
+}
+
+void MultitrackModel::refreshConsumer()
+{
+    if (m_batchDepth)
+        m_isBatchRefresh = true;
+    else
+        MLT.refreshConsumer();
+}
+
+void MultitrackModel::refreshTrack(int changes,
+                                   const std::function<void(Mlt::Producer &)> &edit)
+{
+    if (m_batchDepth)
+        m_isBatchRefresh = true;
+    else if (MLT.isMultitrack())
+        MLT.refreshTrack(changes, edit);
+}
+
+void MultitrackModel::notifyTrackStateChanged(int trackIndex, bool isOutputChanged)
+{
+    // The structure and the duration did not change.
+    if (m_batchDepth)
+        m_isBatchModified = true;
+    else
+        emit trackStateChanged(trackIndex, isOutputChanged);
+}
+
+void MultitrackModel::onBatchRowsChanged(const QModelIndex &parent)
+{
+    // The rows recorded before no longer match, so notify about all of them.
+    if (m_batchDepth) {
+        const int key = parent.isValid() ? parent.row() : -1;
+        auto it = m_batchRanges.find(key);
+        if (it != m_batchRanges.end())
+            it->isWholeParent = true;
+    }
+}
+
+void MultitrackModel::insertRenderPreviewTrack(Mlt::Playlist &playlist)
+{
+    removeRenderPreviewTrack();
+    playlist.set("id", kRenderPreviewTrackId);
+    // No transitions are planted, so this topmost track replaces all of the others.
+    m_tractor->set_track(playlist, m_tractor->count());
+}
+
+void MultitrackModel::removeRenderPreviewTrack()
+{
+    if (!m_tractor)
+        return;
+    for (int i = m_tractor->count() - 1; i >= 0; --i) {
+        QScopedPointer<Mlt::Producer> track(m_tractor->track(i));
+        if (track && !qstrcmp(track->get("id"), kRenderPreviewTrackId)) {
+            m_tractor->remove_track(i);
+            // Tracks added while it was installed are above it.
+            for (int row = 0; row < m_trackList.size(); ++row) {
+                if (m_trackList[row].mlt_index > i)
+                    --m_trackList[row].mlt_index;
+            }
+            return;
+        }
+    }
+}
+
+void MultitrackModel::replaceTrack(int trackIndex, Mlt::Playlist &playlist)
+{
+    if (!m_tractor || trackIndex < 0 || trackIndex >= m_trackList.size())
+        return;
+    QScopedPointer<Mlt::Producer> producer(m_tractor->track(m_trackList.at(trackIndex).mlt_index));
+    if (!producer || !producer->is_valid())
+        return;
+    Mlt::Playlist track(*producer);
+    for (int i = 0; i < track.count(); ++i) {
+        if (!track.is_blank(i))
+            emit removing(track.get_clip(i));
+    }
+    if (track.count() > 0) {
+        beginRemoveRows(index(trackIndex), 0, track.count() - 1);
+        track.clear();
+        endRemoveRows();
+    }
+    if (playlist.count() > 0) {
+        beginInsertRows(index(trackIndex), 0, playlist.count() - 1);
+        for (int i = 0; i < playlist.count(); ++i) {
+            QScopedPointer<Mlt::Producer> clip(playlist.get_clip(i));
+            if (playlist.is_blank(i)) {
+                track.blank(clip->get_playtime() - 1);
+            } else {
+                Mlt::Producer parent(clip->parent());
+                if (parent.type() == mlt_service_tractor_type)
+                    parent.set("mlt_type", "mlt_producer");
+                track.append(parent, clip->get_in(), clip->get_out());
+            }
+        }
+        endInsertRows();
+    }
+
+    // The filters of the track go with its clips.
+    for (int i = track.filter_count() - 1; i >= 0; --i) {
+        QScopedPointer<Mlt::Filter> filter(track.filter(i));
+        if (filter && filter->is_valid() && !filter->get_int("_loader"))
+            track.detach(*filter);
+    }
+    MLT.copyFilters(playlist, track);
+
+    for (int i = 0; i < track.count(); ++i) {
+        QScopedPointer<Mlt::Producer> clip(track.get_clip(i));
+        if (clip && clip->is_valid() && !clip->is_blank() && clip->get_int("audio_index") > -1)
+            AudioLevelsTask::start(clip->parent(), this, createIndex(i, 0, trackIndex));
+    }
+    QModelIndex modelIndex = index(trackIndex);
+    notifyDataChanged(modelIndex, modelIndex, QVector<int>() << IsFilteredRole);
+    adjustTrackFilters();
+    notifyModified();
+}
+
 void MultitrackModel::getAudioLevels()
 {
     for (int trackIx = 0; trackIx < m_trackList.size(); trackIx++) {
@@ -3858,16 +4411,7 @@ void MultitrackModel::convertOldDoc()
 
 Mlt::Transition *MultitrackModel::getTransition(const QString &name, int trackIndex) const
 {
-    QScopedPointer<Mlt::Service> service(m_tractor->producer());
-    while (service && service->is_valid()) {
-        if (service->type() == mlt_service_transition_type) {
-            Mlt::Transition t((mlt_transition) service->get_service());
-            if (name == t.get("mlt_service") && t.get_b_track() == trackIndex)
-                return new Mlt::Transition(t);
-        }
-        service.reset(service->producer());
-    }
-    return nullptr;
+    return findTransition(*m_tractor, name, trackIndex);
 }
 
 Mlt::Filter *MultitrackModel::getFilter(const QString &name, int trackIndex) const
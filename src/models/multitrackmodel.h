@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,13 +18,22 @@
 #ifndef MULTITRACKMODEL_H
 #define MULTITRACKMODEL_H
 
+#include <MltEvent.h>
 #include <MltPlaylist.h>
 #include <MltTractor.h>
 #include <QAbstractItemModel>
+#include <QHash>
 #include <QList>
+#include <QMap>
+#include <QSet>
 #include <QString>
+#include <QStringList>
+#include <QVector>
 
+#include <atomic>
+#include <functional>
 #include <memory>
+#include <vector>
 
 typedef enum {
     PlaylistTrackType = 0,
@@ -109,6 +118,14 @@ public:
     void load();
     void close();
     int clipIndex(int trackIndex, int position);
+    //! Returns the first clip boundary after \a position on any track that is
+    //! not empty, or -1. The end of a track counts as a boundary.
+    int nextEdit(int position) const;
+    //! Returns the last clip boundary before \a position, or -1.
+    int previousEdit(int position) const;
+    //! Returns the indexes of the clips of the track that overlap the frames
+    //! from \a start up to but not including \a end.
+    QList<int> clipsInRange(int trackIndex, int start, int end) const;
     bool trimClipInValid(int trackIndex, int clipIndex, int delta, bool ripple);
     bool trimClipOutValid(int trackIndex, int clipIndex, int delta, bool ripple);
     int trackHeight() const;
@@ -121,6 +138,26 @@ public:
     void insertTrack(int trackIndex, TrackType type = VideoTrackType);
     void moveTrack(int fromTrackIndex, int toTrackIndex);
     void insertOrAdjustBlankAt(QList<int> tracks, int position, int length);
+    //! The change of one track by a ripple: \a length blank frames inserted
+    //! at \a position when positive, or removed from there when negative.
+    struct RippleOffset
+    {
+        int trackIndex;
+        int position;
+        int length;
+    };
+    //! Returns the tracks other than \a trackIndex that are not locked.
+    QList<int> unlockedTracks(int trackIndex) const;
+    //! Returns the offsets that ripple \a tracks by \a length frames at
+    //! \a position. A track is only an offset when the ripple does not cut
+    //! into its clips; the others are added to \a contentTracks.
+    QList<RippleOffset> rippleOffsets(const QList<int> &tracks,
+                                      int position,
+                                      int length,
+                                      QSet<int> *contentTracks = nullptr) const;
+    //! Ripples \a tracks by \a length frames at \a position in one batch,
+    //! adjusting at most one blank of the tracks that are offsets.
+    void ripple(const QList<int> &tracks, int position, int length);
     bool mergeClipWithNext(int trackIndex, int clipIndex, bool dryrun);
     std::unique_ptr<Mlt::ClipInfo> findClipByUuid(const QUuid &uuid,
                                                   int &trackIndex,
@@ -131,12 +168,34 @@ public:
     int mltIndexForTrack(int trackIndex) const;
     bool checkForEmptyTracks(int trackIndex);
     QString trackTransitionService();
+    void insertRenderPreviewTrack(Mlt::Playlist &playlist);
+    void removeRenderPreviewTrack();
+    //! Swaps the clips, blanks and filters of the track for those of \a playlist.
+    void replaceTrack(int trackIndex, Mlt::Playlist &playlist);
+    //! Returns the XML of the clip \a producer, which is only serialized
+    //! again after it or one of its filters or links changed.
+    QString clipXML(Mlt::Producer &producer);
+    //! Forgets the XML of the producers that nothing else uses anymore.
+    void pruneClipXML();
+    //! Holds back the change notifications of the edits until endBatch().
+    //! Batches nest; the notifications are sent when the outermost one ends.
+    void beginBatch();
+    //! Sends the held notifications, with the changes of each track merged
+    //! into one range, followed by a single modified() and consumer refresh.
+    void endBatch();
+    bool isBatching() const { return m_batchDepth > 0; }
 
 signals:
     void created();
     void aboutToClose();
     void closed();
     void modified();
+    /*!
+      Emitted instead of modified() when only the mute, hide, composite or
+      lock of a track changed, which leaves the clips and the duration alone.
+      \a isOutputChanged is false for the lock.
+    */
+    void trackStateChanged(int trackIndex, bool isOutputChanged);
     void seeked(int position, bool seekPlayer = true);
     void trackHeightChanged();
     void trackHeaderWidthChanged();
@@ -202,9 +261,63 @@ public slots:
     void replace(int trackIndex, int clipIndex, Mlt::Producer &clip, bool copyFilters = true);
 
 private:
+    //! The values that data() reads most for every clip of a track.
+    struct ClipIndex
+    {
+        enum Flag { IsBlank = 1, IsTransition = 2 };
+        bool isValid = false;
+        QVector<int> start;
+        QVector<int> duration;
+        QVector<int> in;
+        QVector<int> out;
+        QVector<double> fps;
+        QVector<quint8> flags;
+        QStringList name;
+        QStringList resource;
+        QStringList service;
+        // Stops listening to the playlist when released.
+        std::shared_ptr<Mlt::Event> listener;
+    };
+
+    //! The last XML of a clip and the listeners that mark it out of date.
+    struct ClipXML
+    {
+        explicit ClipXML(Mlt::Producer &p)
+            : producer(p)
+        {}
+        // Holds a reference so that no other producer gets this address.
+        Mlt::Producer producer;
+        QString xml;
+        int filterCount = 0;
+        int linkCount = 0;
+        // Set by any thread that changes a property.
+        std::atomic<bool> isDirty{false};
+        // Released first so the listeners stop before the rest is freed.
+        std::vector<std::unique_ptr<Mlt::Event>> listeners;
+    };
+
     Mlt::Tractor *m_tractor;
     TrackList m_trackList;
     bool m_isMakingTransition;
+    QHash<mlt_properties, std::shared_ptr<ClipXML>> m_clipXML;
+    // By the playlist of the track, rebuilt when it is next read after a change.
+    mutable QHash<mlt_properties, ClipIndex> m_clipIndexes;
+
+    //! The rows of one parent changed during a batch.
+    struct BatchRange
+    {
+        int first = -1;
+        int last = -1;
+        // Empty for all roles.
+        QVector<int> roles;
+        // Rows were inserted, removed or moved after the range was recorded.
+        bool isWholeParent = false;
+    };
+    int m_batchDepth = 0;
+    // By the track index of the parent, or -1 for the tracks themselves.
+    QMap<int, BatchRange> m_batchRanges;
+    bool m_isBatchModified = false;
+    bool m_isBatchRefresh = false;
 
     void moveClipToEnd(Mlt::Playlist &playlist,
                        int trackIndex,
@@ -231,6 +344,7 @@ private:
     void retainPlaylist();
     void loadPlaylist();
     void removeRegion(int trackIndex, int position, int length);
+    void applyRippleOffsets(const QList<RippleOffset> &offsets);
     void clearMixReferences(int trackIndex, int clipIndex);
     bool isFiltered(Mlt::Producer *producer = 0) const;
     int getDuration();
@@ -240,6 +354,19 @@ private:
     void refreshVideoBlendTransitions();
     int bottomVideoTrackMltIndex() const;
     bool hasEmptyTrack(TrackType trackType) const;
+    const ClipIndex *cachedClips(int trackIndex) const;
+    void invalidateClipIndex(const QModelIndex &parent);
+    QString clipName(Mlt::Producer *producer) const;
+    static void onPlaylistChanged(mlt_properties owner, MultitrackModel *self, mlt_event_data);
+    static void onClipPropertyChanged(mlt_properties owner, ClipXML *clip, mlt_event_data data);
+    void notifyDataChanged(const QModelIndex &topLeft,
+                           const QModelIndex &bottomRight,
+                           const QVector<int> &roles = QVector<int>());
+    void notifyModified();
+    void refreshConsumer();
+    void refreshTrack(int changes, const std::function<void(Mlt::Producer &)> &edit);
+    void notifyTrackStateChanged(int trackIndex, bool isOutputChanged);
+    void onBatchRowsChanged(const QModelIndex &parent);
 
     friend class UndoHelper;
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,10 +19,13 @@
 
 #include "Logger.h"
 #include "database.h"
+#include "executors.h"
 #include "mainwindow.h"
 #include "proxymanager.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
+#include "thumbnaildecoderpool.h"
+#include "thumbnailscheduler.h"
 #include "util.h"
 
 #include <QApplication>
@@ -33,21 +36,47 @@
 #include <QImage>
 #include <QPainter>
 #include <QPalette>
+#include <QRunnable>
 #include <QScopedPointer>
-#include <QThreadPool>
 #include <QUrl>
 
+#include <algorithm>
+#include <memory>
+#include <numeric>
+
 static void deleteQImage(QImage *image)
 {
     delete image;
 }
 
+static QString thumbnailCacheKey(Mlt::Producer &producer, int frameNumber)
+{
+    QString time = producer.frames_to_time(frameNumber, mlt_time_clock);
+    // Reduce the precision to centiseconds to increase chance for cache hit
+    // without much loss of accuracy.
+    time = time.left(time.size() - 1);
+    QString key;
+    QString resource = producer.get(kShotcutHashProperty);
+    if (resource.isEmpty()) {
+        key = QStringLiteral("%1 %2 %3")
+                  .arg(producer.get("mlt_service"))
+                  .arg(producer.get("resource"))
+                  .arg(time);
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(key.toUtf8());
+        key = hash.result().toHex();
+    } else {
+        key = QStringLiteral("%1 %2").arg(resource).arg(time);
+    }
+    if (ThumbnailDecoderPool::isFastSeek(ThumbnailDecoderPool::DefaultSeek))
+        key += QStringLiteral(" fast");
+    return key;
+}
+
 class UpdateThumbnailTask : public QRunnable
 {
     PlaylistModel *m_model;
     Mlt::Producer m_producer;
-    Mlt::Profile m_profile;
-    Mlt::Producer *m_tempProducer;
     int m_in;
     int m_out;
     int m_row;
@@ -59,67 +88,25 @@ public:
         : QRunnable()
         , m_model(model)
         , m_producer(producer)
-        , m_profile("atsc_720p_60")
-        , m_tempProducer(0)
         , m_in(in)
         , m_out(out)
         , m_row(row)
         , m_force(force)
     {}
 
-    ~UpdateThumbnailTask() { delete m_tempProducer; }
-
-    Mlt::Producer *tempProducer()
+    /// Queues this task on the thumbnail scheduler, which takes ownership.
+    void start()
     {
-        if (!m_tempProducer) {
-            QString service = m_producer.get("mlt_service");
-            if (service == "avformat-novalidate")
-                service = "avformat";
-            else if (service.startsWith("xml"))
-                service = "xml-nogl";
-            if (service == "count") {
-                m_tempProducer = new Mlt::Producer(m_profile,
-                                                   service.toUtf8().constData(),
-                                                   "loader-nogl");
-            } else if (!Settings.playerGPU() || (service != "xml-nogl" && service != "consumer")) {
-                LOG_DEBUG() << service << m_producer.get("resource");
-                m_tempProducer = new Mlt::Producer(m_profile,
-                                                   service.toUtf8().constData(),
-                                                   m_producer.get("resource"));
-            }
-            if (m_tempProducer && m_tempProducer->is_valid()) {
-                Mlt::Filter scaler(m_profile, "swscale");
-                Mlt::Filter padder(m_profile, "resize");
-                Mlt::Filter converter(m_profile, "avcolor_space");
-                m_tempProducer->attach(scaler);
-                m_tempProducer->attach(padder);
-                m_tempProducer->attach(converter);
-            }
-        }
-        return m_tempProducer;
+        std::shared_ptr<UpdateThumbnailTask> task(this);
+        ThumbnailScheduler::singleton().request(QStringLiteral("playlist %1 %2")
+                                                    .arg(quintptr(m_model))
+                                                    .arg(m_row),
+                                                [task]() { task->run(); },
+                                                m_model,
+                                                false);
     }
 
-    QString cacheKey(int frameNumber)
-    {
-        QString time = m_producer.frames_to_time(frameNumber, mlt_time_clock);
-        // Reduce the precision to centiseconds to increase chance for cache hit
-        // without much loss of accuracy.
-        time = time.left(time.size() - 1);
-        QString key;
-        QString resource = m_producer.get(kShotcutHashProperty);
-        if (resource.isEmpty()) {
-            key = QStringLiteral("%1 %2 %3")
-                      .arg(m_producer.get("mlt_service"))
-                      .arg(m_producer.get("resource"))
-                      .arg(time);
-            QCryptographicHash hash(QCryptographicHash::Sha1);
-            hash.addData(key.toUtf8());
-            key = hash.result().toHex();
-        } else {
-            key = QStringLiteral("%1 %2").arg(resource).arg(time);
-        }
-        return key;
-    }
+    QString cacheKey(int frameNumber) { return thumbnailCacheKey(m_producer, frameNumber); }
 
     void run()
     {
@@ -127,57 +114,62 @@ public:
         if (setting == "hidden")
             return;
 
-        // Scale the in and out point frame numbers to this member profile's fps.
-        int inPoint = qRound(m_in / MLT.profile().fps() * m_profile.fps());
-        int outPoint = qRound(m_out / MLT.profile().fps() * m_profile.fps());
-
-        QImage image = DB.getThumbnail(cacheKey(inPoint));
-        if (m_force || image.isNull()) {
-            image = makeThumbnail(inPoint);
-            m_producer.set(kThumbnailInProperty,
-                           new QImage(image),
-                           0,
-                           (mlt_destructor) deleteQImage,
-                           NULL);
-            DB.putThumbnail(cacheKey(inPoint), image);
-        } else {
-            m_producer.set(kThumbnailInProperty,
-                           new QImage(image),
+        // Scale the in and out point frame numbers to the thumbnail profile's fps.
+        double fps = ThumbnailDecoderPool::singleton().profile().fps();
+        int inPoint = qRound(m_in / MLT.profile().fps() * fps);
+        int outPoint = qRound(m_out / MLT.profile().fps() * fps);
+        bool isOutNeeded = setting == "tall" || setting == "wide";
+
+        QImage inImage = m_force ? QImage() : DB.getThumbnail(cacheKey(inPoint));
+        QImage outImage;
+        if (isOutNeeded && !m_force)
+            outImage = DB.getThumbnail(cacheKey(outPoint));
+
+        // Render the missing in and out frames in one pass on a shared decoder.
+        QList<int> frameNumbers;
+        if (inImage.isNull())
+            frameNumbers << inPoint;
+        if (isOutNeeded && outImage.isNull())
+            frameNumbers << outPoint;
+        if (!frameNumbers.isEmpty()) {
+            auto images = makeThumbnails(frameNumbers);
+            if (inImage.isNull()) {
+                inImage = images.takeFirst();
+                DB.putThumbnail(cacheKey(inPoint), inImage);
+            }
+            if (isOutNeeded && outImage.isNull()) {
+                outImage = images.value(0);
+                DB.putThumbnail(cacheKey(outPoint), outImage);
+            }
+        }
+        m_producer.set(kThumbnailInProperty,
+                       new QImage(inImage),
+                       0,
+                       (mlt_destructor) deleteQImage,
+                       NULL);
+        if (isOutNeeded) {
+            m_producer.set(kThumbnailOutProperty,
+                           new QImage(outImage),
                            0,
                            (mlt_destructor) deleteQImage,
                            NULL);
         }
-        if (setting == "tall" || setting == "wide") {
-            image = DB.getThumbnail(cacheKey(outPoint));
-            if (m_force || image.isNull()) {
-                image = makeThumbnail(outPoint);
-                m_producer.set(kThumbnailOutProperty,
-                               new QImage(image),
-                               0,
-                               (mlt_destructor) deleteQImage,
-                               NULL);
-                DB.putThumbnail(cacheKey(outPoint), image);
-            } else {
-                m_producer.set(kThumbnailOutProperty,
-                               new QImage(image),
-                               0,
-                               (mlt_destructor) deleteQImage,
-                               NULL);
-            }
-        }
         m_model->showThumbnail(m_row);
     }
 
-    QImage makeThumbnail(int frameNumber)
+    QList<QImage> makeThumbnails(const QList<int> &frameNumbers)
     {
         int height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
         int width = PlaylistModel::THUMBNAIL_WIDTH * 2;
-        auto producer = tempProducer();
-        if (producer && producer->is_valid()) {
-            return MLT.image(*tempProducer(), frameNumber, width, height);
-        } else {
-            return QImage();
-        }
+        auto images = ThumbnailDecoderPool::singleton().images(m_producer.get("mlt_service"),
+                                                               m_producer.get("resource"),
+                                                               frameNumbers,
+                                                               width,
+                                                               height,
+                                                               ThumbnailDecoderPool::DefaultSeek);
+        while (images.size() < frameNumbers.size())
+            images << QImage();
+        return images;
     }
 };
 
@@ -192,6 +184,32 @@ PlaylistModel::PlaylistModel(QObject *parent)
             &QAbstractItemModel::rowsAboutToBeRemoved,
             this,
             &PlaylistModel::onRowsAboutToBeRemoved);
+    // Keep the sort keys in step with the rows.
+    connect(this,
+            &QAbstractItemModel::rowsInserted,
+            this,
+            [this](const QModelIndex &, int first, int last) {
+                if (first <= int(m_sortKeys.size()))
+                    m_sortKeys.insert(m_sortKeys.begin() + first, last - first + 1, SortKey());
+                else
+                    m_sortKeys.clear();
+            });
+    connect(this,
+            &QAbstractItemModel::rowsRemoved,
+            this,
+            [this](const QModelIndex &, int first, int last) {
+                if (last < int(m_sortKeys.size()))
+                    m_sortKeys.erase(m_sortKeys.begin() + first, m_sortKeys.begin() + last + 1);
+                else
+                    m_sortKeys.clear();
+            });
+    connect(this, &QAbstractItemModel::modelReset, this, [this]() { m_sortKeys.clear(); });
+    connect(this,
+            &QAbstractItemModel::dataChanged,
+            this,
+            [this](const QModelIndex &topLeft, const QModelIndex &bottomRight) {
+                invalidateSortKeys(topLeft.row(), bottomRight.row());
+            });
 }
 
 PlaylistModel::~PlaylistModel()
@@ -575,41 +593,109 @@ void PlaylistModel::sort(int column, Qt::SortOrder order)
     if (!m_playlist)
         return;
 
-    int index = 0;
     int count = rowCount();
-    if (count < 2)
+    if (count < 2 || column < 0 || column >= COLUMN_COUNT)
         return;
 
-    // Create a list mapping values to their original index.
-    QVector<QPair<QString, int>> indexMap(count);
-    for (index = 0; index < count; index++) {
-        QModelIndex modelIndex = createIndex(index, column);
-        QString key = data(modelIndex, Qt::DisplayRole).toString().toLower();
-        indexMap[index] = qMakePair(key, index);
+    if (int(m_sortKeys.size()) != count) {
+        m_sortKeys.clear();
+        m_sortKeys.resize(count);
     }
-    // Sort the list.
-    std::sort(indexMap.begin(), indexMap.end());
-
-    // Move the sorted indexes into a list to be used to reorder the playlist.
+    QCollator collator;
+    collator.setCaseSensitivity(Qt::CaseInsensitive);
+    collator.setNumericMode(true);
+    for (int row = 0; row < count; ++row)
+        updateSortKey(m_sortKeys[row], row, column, collator);
+
+    // Sort the rows, keeping the current order of equal rows so that sorting by
+    // one column and then another sorts by both.
     QVector<int> indexList(count);
-    QVector<QPair<QString, int>>::iterator itr = indexMap.begin();
-    index = 0;
-    while (itr != indexMap.end()) {
-        if (order == Qt::AscendingOrder) {
-            indexList[index] = itr->second;
-        } else {
-            indexList[count - index - 1] = itr->second;
-        }
-        index++;
-        itr++;
+    std::iota(indexList.begin(), indexList.end(), 0);
+    const bool isText = m_sortKeys[0].texts[column].has_value();
+    auto compare = [&](int a, int b) {
+        if (order == Qt::DescendingOrder)
+            std::swap(a, b);
+        const SortKey &first = m_sortKeys[a];
+        const SortKey &second = m_sortKeys[b];
+        if (isText)
+            return first.texts[column]->compare(*second.texts[column]) < 0;
+        return first.numbers[column] < second.numbers[column];
+    };
+    std::stable_sort(indexList.begin(), indexList.end(), compare);
+
+    QVector<int> newRows(count);
+    bool isChanged = false;
+    for (int row = 0; row < count; ++row) {
+        newRows[indexList[row]] = row;
+        isChanged = isChanged || indexList[row] != row;
     }
+    if (!isChanged)
+        return;
 
+    emit layoutAboutToBeChanged({}, QAbstractItemModel::VerticalSortHint);
     m_playlist->reorder(indexList.data());
-
-    emit dataChanged(createIndex(0, 0), createIndex(rowCount(), columnCount()));
+    std::vector<SortKey> sortKeys(count);
+    for (int row = 0; row < count; ++row)
+        sortKeys[row] = std::move(m_sortKeys[indexList[row]]);
+    m_sortKeys = std::move(sortKeys);
+    const auto oldIndexes = persistentIndexList();
+    QModelIndexList newIndexes;
+    newIndexes.reserve(oldIndexes.size());
+    for (const auto &index : oldIndexes)
+        newIndexes << createIndex(newRows[index.row()], index.column());
+    changePersistentIndexList(oldIndexes, newIndexes);
+    emit layoutChanged({}, QAbstractItemModel::VerticalSortHint);
     emit modified();
 }
 
+void PlaylistModel::updateSortKey(SortKey &key,
+                                  int row,
+                                  int column,
+                                  const QCollator &collator) const
+{
+    if (key.validColumns & (1u << column))
+        return;
+    key.validColumns |= 1u << column;
+    key.numbers[column] = row;
+    key.texts[column].reset();
+    switch (column) {
+    case COLUMN_IN:
+    case COLUMN_DURATION:
+    case COLUMN_START:
+    case COLUMN_DATE: {
+        QScopedPointer<Mlt::ClipInfo> info(m_playlist->clip_info(row));
+        if (!info || !info->producer || !info->producer->is_valid())
+            break;
+        if (column == COLUMN_IN)
+            key.numbers[column] = info->frame_in;
+        else if (column == COLUMN_DURATION)
+            key.numbers[column] = info->frame_count;
+        else if (column == COLUMN_START)
+            key.numbers[column] = info->start;
+        else
+            key.numbers[column] = info->producer->get_creation_time();
+        break;
+    }
+    case COLUMN_RESOURCE:
+    case COLUMN_MEDIA_TYPE:
+    case COLUMN_COMMENT:
+    case COLUMN_BIN:
+        key.texts[column] = collator.sortKey(
+            data(createIndex(row, column), Qt::DisplayRole).toString());
+        break;
+    default:
+        // The index and the thumbnail keep the current order.
+        break;
+    }
+}
+
+void PlaylistModel::invalidateSortKeys(int first, int last)
+{
+    last = qMin(last, int(m_sortKeys.size()) - 1);
+    for (int row = qMax(0, first); row <= last; ++row)
+        m_sortKeys[row].validColumns = 0;
+}
+
 QStringList PlaylistModel::mimeTypes() const
 {
     QStringList ls = QAbstractTableModel::mimeTypes();
@@ -740,6 +826,46 @@ void PlaylistModel::load()
     emit loaded();
 }
 
+void PlaylistModel::prefetchThumbnails(Mlt::Producer &producer)
+{
+    const QString setting = Settings.playlistThumbnails();
+    if (setting == "hidden" || !producer.is_valid() || producer.get_int("video_index") < 0
+        || !QString(producer.get("mlt_service")).startsWith("avformat"))
+        return;
+
+    // The keys depend on the hash and profile of the producer, so make them here.
+    double fps = ThumbnailDecoderPool::singleton().profile().fps();
+    QList<int> frameNumbers;
+    frameNumbers << qRound(producer.get_in() / MLT.profile().fps() * fps);
+    if (setting == "tall" || setting == "wide")
+        frameNumbers << qRound(producer.get_out() / MLT.profile().fps() * fps);
+    QStringList keys;
+    for (auto frameNumber : std::as_const(frameNumbers))
+        keys << thumbnailCacheKey(producer, frameNumber);
+    const QString service = producer.get("mlt_service");
+    const QString resource = producer.get("resource");
+
+    Executors::start(Executors::ThumbnailExecutor, [=]() {
+        QList<int> missing;
+        for (int i = 0; i < keys.size(); ++i) {
+            if (DB.getThumbnail(keys[i]).isNull())
+                missing << frameNumbers[i];
+        }
+        if (missing.isEmpty())
+            return;
+        auto images = ThumbnailDecoderPool::singleton().images(service,
+                                                               resource,
+                                                               missing,
+                                                               THUMBNAIL_WIDTH * 2,
+                                                               THUMBNAIL_HEIGHT * 2,
+                                                               ThumbnailDecoderPool::DefaultSeek);
+        for (int i = 0; i < images.size(); ++i) {
+            if (!images[i].isNull())
+                DB.putThumbnail(keys[frameNumbers.indexOf(missing[i])], images[i]);
+        }
+    });
+}
+
 void PlaylistModel::append(Mlt::Producer &producer, bool emitModified)
 {
     createIfNeeded();
@@ -747,7 +873,7 @@ void PlaylistModel::append(Mlt::Producer &producer, bool emitModified)
     int in = producer.get_in();
     int out = producer.get_out();
     producer.set_in_and_out(0, producer.get_length() - 1);
-    QThreadPool::globalInstance()->start(new UpdateThumbnailTask(this, producer, in, out, count), 1);
+    (new UpdateThumbnailTask(this, producer, in, out, count))->start();
     beginInsertRows(QModelIndex(), count, count);
     m_playlist->append(producer, in, out);
     endInsertRows();
@@ -761,13 +887,40 @@ void PlaylistModel::insert(Mlt::Producer &producer, int row)
     int in = producer.get_in();
     int out = producer.get_out();
     producer.set_in_and_out(0, producer.get_length() - 1);
-    QThreadPool::globalInstance()->start(new UpdateThumbnailTask(this, producer, in, out, row), 1);
+    (new UpdateThumbnailTask(this, producer, in, out, row))->start();
     beginInsertRows(QModelIndex(), row, row);
     m_playlist->insert(producer, row, in, out);
     endInsertRows();
     emit modified();
 }
 
+void PlaylistModel::appendMany(QList<Mlt::Producer> &producers, bool emitModified)
+{
+    insert(producers, -1, emitModified);
+}
+
+void PlaylistModel::insert(QList<Mlt::Producer> &producers, int row, bool emitModified)
+{
+    if (producers.isEmpty())
+        return;
+    createIfNeeded();
+    const int count = m_playlist->count();
+    if (row < 0 || row > count)
+        row = count;
+    beginInsertRows(QModelIndex(), row, row + producers.size() - 1);
+    for (int i = 0; i < producers.size(); ++i) {
+        Mlt::Producer &producer = producers[i];
+        int in = producer.get_in();
+        int out = producer.get_out();
+        producer.set_in_and_out(0, producer.get_length() - 1);
+        (new UpdateThumbnailTask(this, producer, in, out, row + i))->start();
+        m_playlist->insert(producer, row + i, in, out);
+    }
+    endInsertRows();
+    if (emitModified)
+        emit modified();
+}
+
 void PlaylistModel::remove(int row)
 {
     if (!m_playlist)
@@ -788,7 +941,7 @@ void PlaylistModel::update(int row, Mlt::Producer &producer, bool copyFilters)
     int in = producer.get_in();
     int out = producer.get_out();
     producer.set_in_and_out(0, producer.get_length() - 1);
-    QThreadPool::globalInstance()->start(new UpdateThumbnailTask(this, producer, in, out, row), 1);
+    (new UpdateThumbnailTask(this, producer, in, out, row))->start();
     if (copyFilters) {
         Mlt::Producer oldClip(m_playlist->get_clip(row));
         Q_ASSERT(oldClip.is_valid());
@@ -808,13 +961,9 @@ void PlaylistModel::updateThumbnails(int row)
     QScopedPointer<Mlt::ClipInfo> info(m_playlist->clip_info(row));
     if (!info || !info->producer->is_valid())
         return;
-    QThreadPool::globalInstance()->start(new UpdateThumbnailTask(this,
-                                                                 *info->producer,
-                                                                 info->frame_in,
-                                                                 info->frame_out,
-                                                                 row,
-                                                                 true /* force */),
-                                         1);
+    (new UpdateThumbnailTask(
+         this, *info->producer, info->frame_in, info->frame_out, row, true /* force */))
+        ->start();
 }
 
 void PlaylistModel::appendBlank(int frames)
@@ -889,12 +1038,12 @@ void PlaylistModel::refreshThumbnails()
         for (int i = 0; i < m_playlist->count(); i++) {
             Mlt::ClipInfo *info = m_playlist->clip_info(i);
             if (info && info->producer && info->producer->is_valid()) {
-                QThreadPool::globalInstance()->start(new UpdateThumbnailTask(this,
-                                                                             *info->producer,
-                                                                             info->frame_in,
-                                                                             info->frame_out,
-                                                                             i),
-                                                     1);
+                auto task = new UpdateThumbnailTask(this,
+                                                    *info->producer,
+                                                    info->frame_in,
+                                                    info->frame_out,
+                                                    i);
+                task->start();
             }
             delete info;
         }
@@ -942,8 +1091,7 @@ void PlaylistModel::setInOut(int row, int in, int out)
             outChanged = info->frame_out != out;
         }
         m_playlist->resize_clip(row, in, out);
-        QThreadPool::globalInstance()
-            ->start(new UpdateThumbnailTask(this, *info->producer, in, out, row), 1);
+        (new UpdateThumbnailTask(this, *info->producer, in, out, row))->start();
         emit dataChanged(createIndex(row, COLUMN_IN), createIndex(row, COLUMN_START));
         emit modified();
         if (inChanged)
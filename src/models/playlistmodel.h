@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2024 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,9 +20,13 @@
 
 #include <MltPlaylist.h>
 #include <QAbstractTableModel>
+#include <QCollator>
 #include <QMimeData>
 #include <QStringList>
 
+#include <optional>
+#include <vector>
+
 class PlaylistModel : public QAbstractTableModel
 {
     Q_OBJECT
@@ -67,6 +71,10 @@ public:
     static const int THUMBNAIL_WIDTH = 80;
     static const int THUMBNAIL_HEIGHT = 45;
 
+    /// Renders the in and out thumbnails of a newly opened producer into the
+    /// thumbnail cache in the background, before the clip reaches a playlist.
+    static void prefetchThumbnails(Mlt::Producer &producer);
+
     explicit PlaylistModel(QObject *parent = 0);
     ~PlaylistModel();
     int rowCount(const QModelIndex &parent = QModelIndex()) const;
@@ -120,6 +128,10 @@ public slots:
     void load();
     void append(Mlt::Producer &, bool emitModified = true);
     void insert(Mlt::Producer &, int row);
+    //! Appends \a producers as one change of rows and emits modified() once at most.
+    void appendMany(QList<Mlt::Producer> &producers, bool emitModified = true);
+    //! Inserts \a producers at \a row, or appends them if it is -1, as one change of rows.
+    void insert(QList<Mlt::Producer> &producers, int row, bool emitModified = true);
     void remove(int row);
     void update(int row, Mlt::Producer &producer, bool copyFilters = false);
     void updateThumbnails(int row);
@@ -129,10 +141,23 @@ public slots:
     void move(int from, int to);
 
 private:
+    // The values compared by sort(), computed at most once per row and column
+    // until the row changes
+    struct SortKey
+    {
+        quint32 validColumns{0};
+        qint64 numbers[COLUMN_COUNT]{};
+        std::optional<QCollatorSortKey> texts[COLUMN_COUNT];
+    };
+
+    void updateSortKey(SortKey &key, int row, int column, const QCollator &collator) const;
+    void invalidateSortKeys(int first, int last);
+
     Mlt::Playlist *m_playlist;
     int m_dropRow;
     ViewMode m_mode;
     QList<int> m_rowsRemoved;
+    std::vector<SortKey> m_sortKeys;
 
 private slots:
     void onRowsAboutToBeRemoved(const QModelIndex &parent, int first, int last);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2024 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,6 +22,9 @@
 #include "util.h"
 
 #include <Mlt.h>
+#include <QCoreApplication>
+
+#include <numeric>
 
 class ProducerFinder : public Mlt::Parser
 {
@@ -129,6 +132,54 @@ QString appendLocation(QString &currentLocations, const QString &location)
     }
 }
 
+static QString videoDescription(Mlt::Producer *producer)
+{
+    QString result;
+    int width = producer->get_int("meta.media.width");
+    int height = producer->get_int("meta.media.height");
+    if (producer->get_int("video_index") >= 0) {
+        double frame_rate_num = producer->get_double("meta.media.frame_rate_num");
+        double frame_rate_den = producer->get_double("meta.media.frame_rate_den");
+        if (width && height && frame_rate_num && frame_rate_den
+            && (frame_rate_num / frame_rate_den) < 1000) {
+            int index = producer->get_int("video_index");
+            QString key = QStringLiteral("meta.media.%1.codec.name").arg(index);
+            QString codec(producer->get(key.toLatin1().constData()));
+            double frame_rate = frame_rate_num / frame_rate_den;
+            result = QCoreApplication::translate("ResourceModel", "%1 %2x%3 %4fps")
+                         .arg(codec)
+                         .arg(width)
+                         .arg(height)
+                         .arg(QLocale().toString(frame_rate, 'f', 2));
+        }
+    }
+    if (result.isNull() && width > 0 && height > 0) {
+        result = QString(QObject::tr("%1x%2")).arg(width).arg(height);
+    }
+    return result;
+}
+
+static QString audioDescription(Mlt::Producer *producer)
+{
+    QString result;
+    if (producer->get_int("audio_index") >= 0) {
+        int index = producer->get_int("audio_index");
+        QString key = QStringLiteral("meta.media.%1.codec.name").arg(index);
+        QString codec(producer->get(key.toLatin1().constData()));
+        if (!codec.isEmpty()) {
+            key = QStringLiteral("meta.media.%1.codec.channels").arg(index);
+            int channels(producer->get_int(key.toLatin1().constData()));
+            key = QStringLiteral("meta.media.%1.codec.sample_rate").arg(index);
+            QString sampleRate(producer->get(key.toLatin1().constData()));
+            result = QStringLiteral("%1 %2ch %3KHz")
+                         .arg(codec)
+                         .arg(channels)
+                         .arg(sampleRate.toDouble() / 1000);
+        }
+    }
+    return result;
+}
+
 ResourceModel::ResourceModel(QObject *parent)
     : QAbstractItemModel(parent)
 {}
@@ -143,12 +194,21 @@ void ResourceModel::search(Mlt::Producer *producer)
     ProducerFinder parser(this);
     beginResetModel();
     parser.start(*producer);
-    std::sort(m_producers.begin(), m_producers.end(), [&](Mlt::Producer &a, Mlt::Producer &b) {
-        return Util::GetFilenameFromProducer(&a, true).compare(Util::GetFilenameFromProducer(&b,
-                                                                                             true),
-                                                               Qt::CaseInsensitive)
-               < 0;
+    QList<int> order(m_producers.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return m_entries[a].path.compare(m_entries[b].path, Qt::CaseInsensitive) < 0;
     });
+    QList<Mlt::Producer> producers;
+    QList<Entry> entries;
+    m_rows.clear();
+    for (auto i : order) {
+        m_rows.insert(m_entries[i].hash, producers.size());
+        producers << m_producers[i];
+        entries << m_entries[i];
+    }
+    m_producers = producers;
+    m_entries = entries;
     endResetModel();
 }
 
@@ -156,28 +216,36 @@ void ResourceModel::add(Mlt::Producer *producer, const QString &location)
 {
     if (producer->is_blank()) {
         // Do not add
-    } else if (producer->is_cut()) {
-        Mlt::Producer parent = producer->parent();
-        QString hash = Util::getHash(parent);
-        if (!hash.isEmpty()) {
-            if (!exists(hash)) {
-                beginInsertRows(QModelIndex(), m_producers.size(), m_producers.size());
-                m_producers.append(parent);
-                endInsertRows();
-            }
-            m_locations[hash] = appendLocation(m_locations[hash], location);
-        }
-    } else {
-        QString hash = Util::getHash(*producer);
-        if (!hash.isEmpty()) {
-            if (!exists(hash)) {
-                beginInsertRows(QModelIndex(), m_producers.size(), m_producers.size());
-                m_producers.append(*producer);
-                endInsertRows();
-            }
-            m_locations[hash] = appendLocation(m_locations[hash], location);
-        }
+        return;
     }
+    Mlt::Producer resource = producer->is_cut() ? producer->parent() : *producer;
+    QString hash = Util::getHash(resource);
+    if (hash.isEmpty())
+        return;
+    if (!exists(hash)) {
+        beginInsertRows(QModelIndex(), m_producers.size(), m_producers.size());
+        m_rows.insert(hash, m_producers.size());
+        m_producers.append(resource);
+        m_entries.append(makeEntry(resource, hash));
+        endInsertRows();
+    }
+    m_locations[hash] = appendLocation(m_locations[hash], location);
+}
+
+ResourceModel::Entry ResourceModel::makeEntry(Mlt::Producer &producer, const QString &hash)
+{
+    // Reading the file and many properties per cell made repaints of a large project slow.
+    Entry entry;
+    entry.hash = hash;
+    entry.path = Util::GetFilenameFromProducer(&producer, true);
+    QFileInfo info(entry.path);
+    entry.name = info.fileName();
+    double size = (double) info.size() / (double) (1024 * 1024);
+    entry.size = tr("%1MB").arg(QLocale().toString(size, 'f', 2));
+    entry.video = videoDescription(&producer);
+    entry.audio = audioDescription(&producer);
+    entry.advice = Util::getConversionAdvice(&producer);
+    return entry;
 }
 
 QList<Mlt::Producer> ResourceModel::getProducers(const QModelIndexList &indices)
@@ -194,12 +262,7 @@ QList<Mlt::Producer> ResourceModel::getProducers(const QModelIndexList &indices)
 
 bool ResourceModel::exists(const QString &hash)
 {
-    for (int i = 0; i < m_producers.count(); ++i) {
-        if (Util::getHash(m_producers[i]) == hash) {
-            return true;
-        }
-    }
-    return false;
+    return m_rows.contains(hash);
 }
 
 int ResourceModel::producerCount()
@@ -247,67 +310,26 @@ QVariant ResourceModel::data(const QModelIndex &index, int role) const
         return result;
     }
 
-    Mlt::Producer *producer = const_cast<Mlt::Producer *>(&m_producers[index.row()]);
+    const Entry &entry = m_entries[index.row()];
     switch (role) {
     case Qt::DisplayRole:
         switch (index.column()) {
         case COLUMN_INFO:
             break;
-        case COLUMN_NAME: {
-            QString path = Util::GetFilenameFromProducer(producer, true);
-            QFileInfo info(path);
-            result = info.fileName();
+        case COLUMN_NAME:
+            result = entry.name;
             break;
-        }
-        case COLUMN_SIZE: {
-            QString path = Util::GetFilenameFromProducer(producer, true);
-            QFileInfo info(path);
-            double size = (double) info.size() / (double) (1024 * 1024);
-            result = tr("%1MB").arg(QLocale().toString(size, 'f', 2));
+        case COLUMN_SIZE:
+            result = entry.size;
             break;
-        }
-        case COLUMN_VID_DESCRIPTION: {
-            int width = producer->get_int("meta.media.width");
-            int height = producer->get_int("meta.media.height");
-            if (producer->get_int("video_index") >= 0) {
-                double frame_rate_num = producer->get_double("meta.media.frame_rate_num");
-                double frame_rate_den = producer->get_double("meta.media.frame_rate_den");
-                if (width && height && frame_rate_num && frame_rate_den
-                    && (frame_rate_num / frame_rate_den) < 1000) {
-                    int index = producer->get_int("video_index");
-                    QString key = QStringLiteral("meta.media.%1.codec.name").arg(index);
-                    QString codec(producer->get(key.toLatin1().constData()));
-                    double frame_rate = frame_rate_num / frame_rate_den;
-                    result = tr("%1 %2x%3 %4fps")
-                                 .arg(codec)
-                                 .arg(width)
-                                 .arg(height)
-                                 .arg(QLocale().toString(frame_rate, 'f', 2));
-                }
-            }
-            if (result.isNull() && width > 0 && height > 0) {
-                result = QString(QObject::tr("%1x%2")).arg(width).arg(height);
-            }
+        case COLUMN_VID_DESCRIPTION:
+            if (!entry.video.isEmpty())
+                result = entry.video;
             break;
-        }
-        case COLUMN_AUD_DESCRIPTION: {
-            if (producer->get_int("audio_index") >= 0) {
-                int index = producer->get_int("audio_index");
-                QString key = QStringLiteral("meta.media.%1.codec.name").arg(index);
-                QString codec(producer->get(key.toLatin1().constData()));
-                if (!codec.isEmpty()) {
-                    key = QStringLiteral("meta.media.%1.codec.channels").arg(index);
-                    int channels(producer->get_int(key.toLatin1().constData()));
-                    key = QStringLiteral("meta.media.%1.codec.sample_rate").arg(index);
-                    QString sampleRate(producer->get(key.toLatin1().constData()));
-                    result = QStringLiteral("%1 %2ch %3KHz")
-                                 .arg(codec)
-                                 .arg(channels)
-                                 .arg(sampleRate.toDouble() / 1000);
-                }
-            }
+        case COLUMN_AUD_DESCRIPTION:
+            if (!entry.audio.isEmpty())
+                result = entry.audio;
             break;
-        }
         default:
             LOG_ERROR() << "Invalid DisplayRole Column" << index.row() << index.column()
                         << roleNames()[role] << role;
@@ -317,19 +339,17 @@ QVariant ResourceModel::data(const QModelIndex &index, int role) const
     case Qt::ToolTipRole:
         switch (index.column()) {
         case COLUMN_INFO:
-            result = Util::getConversionAdvice(producer);
+            result = entry.advice;
             break;
         case COLUMN_NAME:
         case COLUMN_VID_DESCRIPTION:
         case COLUMN_AUD_DESCRIPTION:
         case COLUMN_SIZE: {
-            QString filename = Util::GetFilenameFromProducer(producer, true);
-            QString hash = Util::getHash(*producer);
-            QString locations = m_locations[hash];
+            QString locations = m_locations[entry.hash];
             if (locations.isEmpty()) {
-                result = filename;
+                result = entry.path;
             } else {
-                result = filename + "\n" + locations;
+                result = entry.path + "\n" + locations;
             }
             break;
         }
@@ -359,7 +379,7 @@ QVariant ResourceModel::data(const QModelIndex &index, int role) const
     case Qt::DecorationRole:
         switch (index.column()) {
         case COLUMN_INFO:
-            if (!Util::getConversionAdvice(producer).isEmpty()) {
+            if (!entry.advice.isEmpty()) {
                 result = QIcon(":/icons/oxygen/32x32/status/task-attempt.png");
             } else {
                 result = QIcon(":/icons/oxygen/32x32/status/task-complete.png");
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2024 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -20,6 +20,7 @@
 
 #include <MltProducer.h>
 #include <QAbstractItemModel>
+#include <QHash>
 
 class ResourceModel : public QAbstractItemModel
 {
@@ -52,7 +53,23 @@ public:
     QModelIndex parent(const QModelIndex &index) const;
 
 private:
+    //! The text of a row, read once when the resource is added
+    struct Entry
+    {
+        QString hash;
+        QString path;
+        QString name;
+        QString size;
+        QString video;
+        QString audio;
+        QString advice;
+    };
+
+    Entry makeEntry(Mlt::Producer &producer, const QString &hash);
+
     QList<Mlt::Producer> m_producers;
+    QList<Entry> m_entries;
+    QHash<QString, int> m_rows; // the row of each hash
     QMap<QString, QString> m_locations;
 };
 
@@ -0,0 +1,316 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "scenedetecttask.h"
+
+#include "Logger.h"
+#include "database.h"
+#include "executors.h"
+#include "mainwindow.h"
+#include "mltcontroller.h"
+#include "util.h"
+
+#include <MltFrame.h>
+#include <MltProducer.h>
+#include <QCryptographicHash>
+#include <QElapsedTimer>
+#include <QImage>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+
+// The width of the decoded images
+static const int kWidth = 160;
+static const int kHistogramBins = 16;
+// The scene score, from 0 to 255, above which a frame starts a scene
+static const int kSceneThreshold = 90;
+static const double kMinSceneSeconds = 1.0;
+static const double kSilenceDb = -50.0;
+static const double kMinSilenceSeconds = 2.0;
+static const int kFrequency = 48000;
+static const int kChannels = 2;
+static const int kProgressIntervalMs = 5 * 1000;
+static const QColor kSceneColor(0x00, 0x99, 0xff);
+static const QColor kSilenceColor(0x80, 0x80, 0x80);
+
+static std::atomic<bool> s_isRunning{false};
+static std::atomic<bool> s_isCanceled{false};
+
+// The loops below are simple enough for the compiler to vectorize.
+
+static void histogram(const uint8_t *rgb, int pixelCount, int *bins)
+{
+    const int shift = 8 - int(std::log2(kHistogramBins));
+    int *red = bins;
+    int *green = bins + kHistogramBins;
+    int *blue = bins + 2 * kHistogramBins;
+    std::fill(bins, bins + 3 * kHistogramBins, 0);
+    for (int i = 0; i < pixelCount; ++i, rgb += 3) {
+        ++red[rgb[0] >> shift];
+        ++green[rgb[1] >> shift];
+        ++blue[rgb[2] >> shift];
+    }
+}
+
+static int histogramDifference(const int *a, const int *b, int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; ++i)
+        sum += std::abs(a[i] - b[i]);
+    return sum;
+}
+
+static float meanSquare(const float *samples, int count)
+{
+    // Separate sums let the additions run in parallel.
+    float sums[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    int i = 0;
+    for (; i + 4 <= count; i += 4) {
+        for (int j = 0; j < 4; ++j)
+            sums[j] += samples[i + j] * samples[i + j];
+    }
+    for (; i < count; ++i)
+        sums[0] += samples[i] * samples[i];
+    return count > 0 ? (sums[0] + sums[1] + sums[2] + sums[3]) / count : 0.0f;
+}
+
+// Maps -100 to 0 dB onto 0 to 255.
+static quint8 dbToLevel(double db)
+{
+    return quint8(qBound(0, qRound((db + 100.0) * 2.55), 255));
+}
+
+SceneDetectTask::SceneDetectTask(const QString &xml, MarkersModel *model)
+    : QRunnable()
+    , m_xml(xml)
+    , m_model(model)
+{
+    const Mlt::Profile &profile = MLT.profile();
+    m_profile.set_frame_rate(profile.frame_rate_num(), profile.frame_rate_den());
+    m_profile.set_width(kWidth);
+    m_profile.set_height(Util::coerceMultiple(kWidth * profile.display_aspect_den()
+                                              / qMax(1, profile.display_aspect_num())));
+    m_profile.set_progressive(1);
+    m_profile.set_sample_aspect(1, 1);
+    m_profile.set_display_aspect(m_profile.width(), m_profile.height());
+    m_profile.set_explicit(true);
+}
+
+SceneDetectTask::~SceneDetectTask() {}
+
+void SceneDetectTask::start(const QString &xml, MarkersModel *model)
+{
+    bool expected = false;
+    if (!s_isRunning.compare_exchange_strong(expected, true)) {
+        MAIN.showStatusMessage(QObject::tr("Already detecting scenes and silence"));
+        return;
+    }
+    s_isCanceled = false;
+    MAIN.showStatusMessage(QObject::tr("Detecting scenes and silence..."));
+    Executors::start(Executors::AnalysisExecutor, new SceneDetectTask(xml, model));
+}
+
+bool SceneDetectTask::isRunning()
+{
+    return s_isRunning;
+}
+
+void SceneDetectTask::closeAll()
+{
+    s_isCanceled = true;
+}
+
+void SceneDetectTask::run()
+{
+    QVector<quint8> scores;
+    QVector<quint8> levels;
+    const QString key = cacheKey();
+    QImage image = DB.getThumbnail(key);
+    if (image.height() == 2 && image.format() == QImage::Format_RGBA8888) {
+        // Each pixel packs four frames after a first one with the frame count.
+        // The first row is the scene scores and the second the audio levels.
+        quint32 count = 0;
+        memcpy(&count, image.constScanLine(0), sizeof(count));
+        if (count > 0 && count <= 4 * quint32(image.width() - 1)) {
+            scores.resize(count);
+            levels.resize(count);
+            memcpy(scores.data(), image.constScanLine(0) + 4, count);
+            memcpy(levels.data(), image.constScanLine(1) + 4, count);
+        }
+    }
+    if (scores.isEmpty()) {
+        if (!analyze(scores, levels) || s_isCanceled) {
+            s_isRunning = false;
+            return;
+        }
+        const quint32 count = scores.size();
+        QImage image(1 + (count + 3) / 4, 2, QImage::Format_RGBA8888);
+        if (count > 0 && !image.isNull()) {
+            image.fill(0);
+            for (int row = 0; row < 2; ++row)
+                memcpy(image.scanLine(row), &count, sizeof(count));
+            memcpy(image.scanLine(0) + 4, scores.constData(), count);
+            memcpy(image.scanLine(1) + 4, levels.constData(), count);
+            DB.putThumbnail(key, image);
+        }
+    }
+
+    const QList<Markers::Marker> markers = findMarkers(scores, levels);
+    const QPointer<MarkersModel> model = m_model;
+    QMetaObject::invokeMethod(
+        &MAIN,
+        [model, markers]() {
+            s_isRunning = false;
+            if (!model || s_isCanceled)
+                return;
+            QList<Markers::Marker> newMarkers;
+            for (const auto &marker : markers) {
+                if (model->markerIndexForRange(marker.start, marker.end) < 0)
+                    newMarkers << marker;
+            }
+            model->appendMarkers(newMarkers);
+            MAIN.showStatusMessage(
+                QObject::tr("Added %n markers for scenes and silence", nullptr, newMarkers.size()));
+        },
+        Qt::QueuedConnection);
+}
+
+bool SceneDetectTask::analyze(QVector<quint8> &scores, QVector<quint8> &levels)
+{
+    Mlt::Producer producer(m_profile, "xml-string", m_xml.toUtf8().constData());
+    if (!producer.is_valid()) {
+        LOG_ERROR() << "failed to load the timeline for scene detection";
+        return false;
+    }
+    const int n = producer.get_length();
+    const int width = m_profile.width();
+    const int height = m_profile.height();
+    const int binCount = 3 * kHistogramBins;
+    QVector<int> previous(binCount);
+    QVector<int> current(binCount);
+    bool hasPrevious = false;
+    scores.reserve(n);
+    levels.reserve(n);
+    QElapsedTimer timer;
+    timer.start();
+
+    for (int i = 0; i < n && !s_isCanceled; ++i) {
+        QScopedPointer<Mlt::Frame> frame(producer.get_frame());
+        quint8 score = 0;
+        quint8 level = 0;
+        if (frame && frame->is_valid()) {
+            frame->set("consumer.rescale", "nearest");
+            frame->set("consumer.deinterlacer", "onefield");
+            mlt_image_format format = mlt_image_rgb;
+            int w = width;
+            int h = height;
+            auto image = static_cast<const uint8_t *>(frame->get_image(format, w, h));
+            if (image && format == mlt_image_rgb) {
+                histogram(image, w * h, current.data());
+                if (hasPrevious) {
+                    // The difference is at most twice the pixel count for each
+                    // of the three channels.
+                    const int difference = histogramDifference(current.constData(),
+                                                               previous.constData(),
+                                                               binCount);
+                    score = quint8(qMin<qint64>(255, qint64(255) * difference / (6 * w * h)));
+                }
+                std::swap(current, previous);
+                hasPrevious = true;
+            }
+
+            mlt_audio_format audioFormat = mlt_audio_f32le;
+            int frequency = kFrequency;
+            int channels = kChannels;
+            int samples = mlt_audio_calculate_frame_samples(m_profile.fps(), frequency, i);
+            auto audio = static_cast<const float *>(
+                frame->get_audio(audioFormat, frequency, channels, samples));
+            if (audio && audioFormat == mlt_audio_f32le && !frame->get_int("test_audio")) {
+                const float power = meanSquare(audio, samples * channels);
+                level = power > 0.0f ? dbToLevel(10.0 * std::log10(power)) : 0;
+            }
+        }
+        scores << score;
+        levels << level;
+        if (timer.elapsed() > kProgressIntervalMs) {
+            timer.restart();
+            const auto message = QObject::tr("Detecting scenes and silence... %1%")
+                                     .arg(100 * i / qMax(1, n));
+            QMetaObject::invokeMethod(&MAIN,
+                                      "showStatusMessage",
+                                      Qt::QueuedConnection,
+                                      Q_ARG(QString, message));
+        }
+    }
+    return !s_isCanceled;
+}
+
+QList<Markers::Marker> SceneDetectTask::findMarkers(const QVector<quint8> &scores,
+                                                    const QVector<quint8> &levels) const
+{
+    QList<Markers::Marker> markers;
+    const int minSceneFrames = qMax(1, qRound(m_profile.fps() * kMinSceneSeconds));
+    int lastScene = 0;
+    for (int i = 1; i < scores.size(); ++i) {
+        if (scores[i] >= kSceneThreshold && i - lastScene >= minSceneFrames) {
+            Markers::Marker marker;
+            marker.text = QObject::tr("Scene %1").arg(markers.size() + 2);
+            marker.start = marker.end = i;
+            marker.color = kSceneColor;
+            markers << marker;
+            lastScene = i;
+        }
+    }
+
+    const int minSilenceFrames = qMax(1, qRound(m_profile.fps() * kMinSilenceSeconds));
+    const quint8 silence = dbToLevel(kSilenceDb);
+    for (int i = 0; i < levels.size();) {
+        if (levels[i] > silence) {
+            ++i;
+            continue;
+        }
+        int end = i;
+        while (end + 1 < levels.size() && levels[end + 1] <= silence)
+            ++end;
+        if (end - i + 1 >= minSilenceFrames) {
+            Markers::Marker marker;
+            marker.text = QObject::tr("Silence");
+            marker.start = i;
+            marker.end = end;
+            marker.color = kSilenceColor;
+            markers << marker;
+        }
+        i = end + 1;
+    }
+
+    std::stable_sort(markers.begin(),
+                     markers.end(),
+                     [](const Markers::Marker &a, const Markers::Marker &b) {
+                         return a.start < b.start;
+                     });
+    return markers;
+}
+
+QString SceneDetectTask::cacheKey() const
+{
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(m_xml.toUtf8());
+    return QStringLiteral("%1 scenes").arg(QString(hash.result().toHex()));
+}
@@ -0,0 +1,70 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SCENEDETECTTASK_H
+#define SCENEDETECTTASK_H
+
+#include "markersmodel.h"
+
+#include <MltProfile.h>
+#include <QList>
+#include <QPointer>
+#include <QRunnable>
+#include <QString>
+#include <QVector>
+
+/*!
+  \class SceneDetectTask
+  \brief Adds markers at the scene changes and silences of the timeline.
+
+  The timeline is decoded once at a small size in a background thread. Every
+  frame gets a scene score, which is how much its color histogram differs from
+  the one of the previous frame, and an audio level. Both are cached in the
+  thumbnail database next to the audio levels, so detecting again on the same
+  timeline does not decode it again.
+
+  A frame whose score is above a threshold starts a scene and gets a marker,
+  and a long enough run of quiet frames gets a range marker. The markers are
+  added to the model as one undoable change, skipping those that already
+  exist.
+*/
+
+class SceneDetectTask : public QRunnable
+{
+public:
+    SceneDetectTask(const QString &xml, MarkersModel *model);
+    virtual ~SceneDetectTask();
+    //! Starts detecting on the MLT \a xml of the timeline unless already running.
+    static void start(const QString &xml, MarkersModel *model);
+    static bool isRunning();
+    static void closeAll();
+
+protected:
+    void run();
+
+private:
+    bool analyze(QVector<quint8> &scores, QVector<quint8> &levels);
+    QList<Markers::Marker> findMarkers(const QVector<quint8> &scores,
+                                       const QVector<quint8> &levels) const;
+    QString cacheKey() const;
+
+    const QString m_xml;
+    QPointer<MarkersModel> m_model;
+    Mlt::Profile m_profile;
+};
+
+#endif // SCENEDETECTTASK_H
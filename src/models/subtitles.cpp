@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,7 +17,9 @@
 
 #include "subtitles.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <sstream>
@@ -40,7 +42,51 @@ static wchar_t *utf8ToWide(const char *strUtf8)
 }
 #endif /* ifdef _WIN32 */
 
-static Subtitles::SubtitleVector readFromSrtStream(std::istream &stream)
+// A rough size of one item in an SRT file, used to reserve the items up front.
+static const size_t kEstimatedItemSize = 48;
+
+static void skipSpaces(const char *&p, const char *end)
+{
+    while (p < end && (*p == ' ' || *p == '\t'))
+        ++p;
+}
+
+static bool readNumber(const char *&p, const char *end, int &value)
+{
+    skipSpaces(p, end);
+    const char *start = p;
+    value = 0;
+    while (p < end && *p >= '0' && *p <= '9')
+        value = value * 10 + (*p++ - '0');
+    return p > start;
+}
+
+// Parses a time as "hh:mm:ss,mmm". A period is also accepted before the
+// milliseconds as in WebVTT.
+static bool readSrtTime(const char *&p, const char *end, int64_t &ms)
+{
+    int hours, minutes, seconds, miliseconds;
+    if (!readNumber(p, end, hours) || p >= end || *p++ != ':' || !readNumber(p, end, minutes)
+        || p >= end || *p++ != ':' || !readNumber(p, end, seconds) || p >= end
+        || (*p != ',' && *p != '.') || !readNumber(++p, end, miliseconds))
+        return false;
+    ms = (((((int64_t(hours) * 60) + minutes) * 60) + seconds) * 1000) + miliseconds;
+    return true;
+}
+
+static bool readSrtTimes(const char *p, const char *end, Subtitles::SubtitleItem &item)
+{
+    if (!readSrtTime(p, end, item.start))
+        return false;
+    skipSpaces(p, end);
+    if (end - p < 3 || p[0] != '-' || p[1] != '-' || p[2] != '>')
+        return false;
+    p += 3;
+    return readSrtTime(p, end, item.end);
+}
+
+// Parses the SRT text in place, one line at a time, without copying the lines.
+static Subtitles::SubtitleVector readFromSrtBuffer(const char *data, size_t size)
 {
     enum {
         STATE_SEEKING_NUM,
@@ -48,18 +94,25 @@ static Subtitles::SubtitleVector readFromSrtStream(std::istream &stream)
         STATE_READING_TEXT,
     };
 
-    std::string line;
-    std::string text;
     int state = STATE_SEEKING_NUM;
     Subtitles::SubtitleItem item;
     Subtitles::SubtitleVector ret;
+    ret.reserve(size / kEstimatedItemSize + 1);
+
+    const char *end = data + size;
+    for (const char *line = data; line < end;) {
+        const char *lineEnd = static_cast<const char *>(std::memchr(line, '\n', end - line));
+        const char *next = lineEnd ? lineEnd + 1 : end;
+        if (!lineEnd)
+            lineEnd = end;
+        if (lineEnd > line && lineEnd[-1] == '\r')
+            --lineEnd;
 
-    while (std::getline(stream, line)) {
         switch (state) {
         case STATE_SEEKING_NUM: {
             state = STATE_READING_TIME;
-            for (char &c : line) {
-                if (!std::isdigit(c)) {
+            for (const char *c = line; c < lineEnd; ++c) {
+                if (!std::isdigit(static_cast<unsigned char>(*c))) {
                     // Bad line. Keep seeking
                     state = STATE_SEEKING_NUM;
                     break;
@@ -69,45 +122,34 @@ static Subtitles::SubtitleVector readFromSrtStream(std::istream &stream)
         }
 
         case STATE_READING_TIME: {
-            int sHours, sMinutes, sSeconds, sMiliseconds, eHours, eMinutes, eSeconds, eMiliseconds;
-            const int ret = std::sscanf(line.c_str(),
-                                        "%d:%d:%d,%d --> %d:%d:%d,%d",
-                                        &sHours,
-                                        &sMinutes,
-                                        &sSeconds,
-                                        &sMiliseconds,
-                                        &eHours,
-                                        &eMinutes,
-                                        &eSeconds,
-                                        &eMiliseconds);
-            if (ret != 8) {
+            if (!readSrtTimes(line, lineEnd, item)) {
                 state = STATE_SEEKING_NUM;
                 break;
             }
-            item.start = (((((sHours * 60) + sMinutes) * 60) + sSeconds) * 1000) + sMiliseconds;
-            item.end = (((((eHours * 60) + eMinutes) * 60) + eSeconds) * 1000) + eMiliseconds;
             item.text.clear();
             state = STATE_READING_TEXT;
             break;
         }
 
         case STATE_READING_TEXT: {
-            if (!line.empty()) {
+            if (lineEnd > line) {
                 if (!item.text.empty()) {
                     item.text += "\n";
                 }
-                item.text += line;
+                item.text.append(line, lineEnd - line);
             } else {
-                ret.push_back(item);
+                ret.push_back(std::move(item));
+                item = Subtitles::SubtitleItem();
                 state = STATE_SEEKING_NUM;
             }
             break;
         }
         }
+        line = next;
     }
 
     if (state == STATE_READING_TEXT) {
-        ret.push_back(item);
+        ret.push_back(std::move(item));
     }
 
     return ret;
@@ -130,29 +172,45 @@ static bool writeToSrtStream(std::ostream &stream, const Subtitles::SubtitleVect
         return true;
     }
     int i = 1;
-    for (auto item : items) {
+    for (const auto &item : items) {
         stream << i << "\n";
-        stream << msToSrtTime(item.start) << " --> " << msToSrtTime(item.end) << "\n";
-        stream << item.text;
-        if (!item.text.empty() && item.text.back() != '\n') {
-            stream << "\n";
-        }
-        stream << "\n";
+        stream << Subtitles::toSrtItemText(item);
         i++;
     }
     return true;
 }
 
+std::string Subtitles::toSrtItemText(const SubtitleItem &item)
+{
+    std::string text = msToSrtTime(item.start) + " --> " + msToSrtTime(item.end) + "\n";
+    text += item.text;
+    if (!item.text.empty() && item.text.back() != '\n') {
+        text += "\n";
+    }
+    text += "\n";
+    return text;
+}
+
 Subtitles::SubtitleVector Subtitles::readFromSrtFile(const std::string &path)
 {
 #ifdef _WIN32
     wchar_t *wpath = utf8ToWide(path.c_str());
-    std::ifstream fileStream(wpath);
+    std::ifstream fileStream(wpath, std::ios::in | std::ios::binary);
     free(wpath);
 #else
-    std::ifstream fileStream(path);
+    std::ifstream fileStream(path, std::ios::in | std::ios::binary);
 #endif
-    return readFromSrtStream(fileStream);
+    // Read the whole file with one read and parse it in place.
+    std::string data;
+    if (fileStream.seekg(0, std::ios::end)) {
+        const std::streamoff size = fileStream.tellg();
+        if (size > 0 && fileStream.seekg(0, std::ios::beg)) {
+            data.resize(size_t(size));
+            fileStream.read(&data[0], size);
+            data.resize(size_t(fileStream.gcount()));
+        }
+    }
+    return readFromSrtBuffer(data.data(), data.size());
 }
 
 bool Subtitles::writeToSrtFile(const std::string &path, const SubtitleVector &items)
@@ -172,8 +230,7 @@ bool Subtitles::writeToSrtFile(const std::string &path, const SubtitleVector &it
 
 Subtitles::SubtitleVector Subtitles::readFromSrtString(const std::string &text)
 {
-    std::istringstream textStream(text);
-    return readFromSrtStream(textStream);
+    return readFromSrtBuffer(text.data(), text.size());
 }
 
 bool Subtitles::writeToSrtString(std::string &text, const Subtitles::SubtitleVector &items)
@@ -212,15 +269,16 @@ int Subtitles::indexForTime(const Subtitles::SubtitleVector &items,
         // See if this is the next subtitle
         index = searchStart + 1;
     } else {
-        // Perform a full search from the beginning
-        int i = 0;
-        for (i = 0; i < count; i++) {
-            if ((items[i].start - msMargin) <= msTime && items[i].end >= msTime) {
-                index = i;
-                break;
-            } else if (items[i].end > msTime) {
-                break;
-            }
+        // Binary search for the first item that ends at or after the time,
+        // since subtitles are sorted and do not overlap.
+        auto it = std::lower_bound(items.cbegin(),
+                                   items.cend(),
+                                   msTime,
+                                   [](const SubtitleItem &item, int64_t time) {
+                                       return item.end < time;
+                                   });
+        if (it != items.cend() && (it->start - msMargin) <= msTime) {
+            index = it - items.cbegin();
         }
     }
     return index;
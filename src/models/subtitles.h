@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -37,6 +37,9 @@ SubtitleVector readFromSrtFile(const std::string &path);
 bool writeToSrtFile(const std::string &path, const SubtitleVector &items);
 SubtitleVector readFromSrtString(const std::string &text);
 bool writeToSrtString(std::string &text, const SubtitleVector &items);
+// Returns the SRT text of an item without its number, so that the text of a
+// track can be rebuilt from cached items without formatting each one again.
+std::string toSrtItemText(const SubtitleItem &item);
 int indexForTime(const SubtitleVector &items, int64_t msTime, int searchStart, int msMargin);
 } // namespace Subtitles
 
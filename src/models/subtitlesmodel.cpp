@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -26,12 +26,25 @@
 
 #include <QTimer>
 
+#include <algorithm>
 #include <cmath>
+#include <iterator>
+#include <limits>
 
 static const quintptr NO_PARENT_ID = quintptr(-1);
 
 enum Columns { COLUMN_TEXT = 0, COLUMN_START, COLUMN_END, COLUMN_DURATION, COLUMN_COUNT };
 
+static bool startsBefore(const Subtitles::SubtitleItem &item, int64_t msTime)
+{
+    return item.start < msTime;
+}
+
+static bool startsAfter(int64_t msTime, const Subtitles::SubtitleItem &item)
+{
+    return msTime < item.start;
+}
+
 SubtitlesModel::SubtitlesModel(QObject *parent)
     : QAbstractItemModel(parent)
     , m_producer(nullptr)
@@ -65,6 +78,9 @@ void SubtitlesModel::load(Mlt::Producer *producer)
     beginResetModel();
     m_producer = producer;
     m_items.clear();
+    m_maxEnds.clear();
+    m_srtTexts.clear();
+    m_wordIndexes.clear();
     m_tracks.clear();
     if (m_producer) {
         for (int i = 0; i < producer->filter_count(); i++) {
@@ -80,7 +96,20 @@ void SubtitlesModel::load(Mlt::Producer *producer)
                 m_tracks.push_back(track);
                 m_items.resize(m_tracks.size());
                 Subtitles::SubtitleVector items = Subtitles::readFromSrtString(filter->get("text"));
-                m_items[m_items.size() - 1] = QList(items.cbegin(), items.cend());
+                m_srtTexts.resize(m_tracks.size());
+                m_srtTexts.last().reserve(items.size());
+                for (const auto &item : items) {
+                    m_srtTexts.last().append(Subtitles::toSrtItemText(item));
+                }
+                m_items[m_items.size() - 1] = QList(std::make_move_iterator(items.begin()),
+                                                    std::make_move_iterator(items.end()));
+                m_maxEnds.resize(m_tracks.size());
+                updateMaxEnds(m_items.size() - 1);
+                m_wordIndexes.resize(m_tracks.size());
+                const auto &trackItems = m_items.last();
+                for (int j = 0; j < trackItems.size(); j++) {
+                    m_wordIndexes.last().add(j, QString::fromStdString(trackItems[j].text));
+                }
             }
         }
     }
@@ -174,10 +203,19 @@ void SubtitlesModel::commitToFeed(int trackIndex)
         }
         if (filter->get("mlt_service") == QStringLiteral("subtitle_feed")) {
             if (feedFilterIndex == trackIndex) {
-                Subtitles::SubtitleVector items(m_items[trackIndex].constBegin(),
-                                                m_items[trackIndex].constEnd());
+                // Join the cached text of the items with their numbers.
+                const auto &srtTexts = m_srtTexts[trackIndex];
+                size_t size = 0;
+                for (const auto &itemText : srtTexts) {
+                    size += itemText.size() + 8;
+                }
                 std::string text;
-                Subtitles::writeToSrtString(text, items);
+                text.reserve(size);
+                for (int i = 0; i < srtTexts.size(); i++) {
+                    text += std::to_string(i + 1);
+                    text += '\n';
+                    text += srtTexts[i];
+                }
                 filter->set("text", text.c_str());
                 break;
             }
@@ -251,46 +289,56 @@ QModelIndex SubtitlesModel::itemModelIndex(int trackIndex, int itemIndex) const
 
 int SubtitlesModel::itemIndexAtTime(int trackIndex, int64_t msTime) const
 {
-    int ret = -1;
-    for (int i = 0; i < m_items[trackIndex].size(); i++) {
-        if (m_items[trackIndex][i].start <= msTime && m_items[trackIndex][i].end >= msTime) {
-            ret = i;
-            break;
-        } else if (m_items[trackIndex][i].start > msTime) {
-            break;
-        }
-    }
-    return ret;
+    const auto &items = m_items[trackIndex];
+    const auto &maxEnds = m_maxEnds[trackIndex];
+    // Only the items that start at or before the time can contain it.
+    int startCount = std::upper_bound(items.cbegin(), items.cend(), msTime, startsAfter)
+                     - items.cbegin();
+    // The first of those that ends at or after the time is the first to have
+    // a maximum end at or after the time.
+    int i = std::lower_bound(maxEnds.cbegin(), maxEnds.cbegin() + startCount, msTime)
+            - maxEnds.cbegin();
+    return i < startCount ? i : -1;
 }
 
 int SubtitlesModel::itemIndexBeforeTime(int trackIndex, int64_t msTime) const
 {
-    int ret = -1;
-    int itemCount = m_items[trackIndex].size();
-    for (int i = 0; i < itemCount; i++) {
-        if (m_items[trackIndex][i].start >= msTime) {
-            ret = i - 1;
-            break;
-        }
+    const auto &items = m_items[trackIndex];
+    int itemCount = items.size();
+    int i = std::lower_bound(items.cbegin(), items.cend(), msTime, startsBefore) - items.cbegin();
+    if (i < itemCount) {
+        return i - 1;
     }
-    if (ret == -1 && m_items[trackIndex].size() > 0
-        && m_items[trackIndex][itemCount - 1].end < msTime) {
-        ret = itemCount - 1;
+    if (itemCount > 0 && items[itemCount - 1].end < msTime) {
+        return itemCount - 1;
     }
-    return ret;
+    return -1;
 }
 
 int SubtitlesModel::itemIndexAfterTime(int trackIndex, int64_t msTime) const
 {
-    int ret = -1;
-    int itemCount = m_items[trackIndex].size();
-    for (int i = 0; i < itemCount; i++) {
-        if (m_items[trackIndex][i].start > msTime) {
-            ret = i;
-            break;
-        }
+    const auto &items = m_items[trackIndex];
+    int i = std::upper_bound(items.cbegin(), items.cend(), msTime, startsAfter) - items.cbegin();
+    return i < items.size() ? i : -1;
+}
+
+int SubtitlesModel::itemIndexEndingAfterTime(int trackIndex, int64_t msTime) const
+{
+    if (trackIndex < 0 || trackIndex >= m_items.size()) {
+        return 0;
     }
-    return ret;
+    // All of the items before the first maximum end at or after the time end
+    // before it.
+    const auto &maxEnds = m_maxEnds[trackIndex];
+    return std::lower_bound(maxEnds.cbegin(), maxEnds.cend(), msTime) - maxEnds.cbegin();
+}
+
+QList<int> SubtitlesModel::findItems(int trackIndex, const QString &text) const
+{
+    if (trackIndex < 0 || trackIndex >= m_wordIndexes.size()) {
+        return QList<int>();
+    }
+    return m_wordIndexes[trackIndex].find(text);
 }
 
 const Subtitles::SubtitleItem &SubtitlesModel::getItem(int trackIndex, int itemIndex) const
@@ -505,6 +553,9 @@ void SubtitlesModel::doInsertTrack(const SubtitlesModel::SubtitleTrack &track, i
     beginInsertRows(QModelIndex(), trackIndex, trackIndex);
     m_tracks.insert(trackIndex, track);
     m_items.insert(trackIndex, QList<Subtitles::SubtitleItem>());
+    m_maxEnds.insert(trackIndex, QList<int64_t>());
+    m_srtTexts.insert(trackIndex, QList<std::string>());
+    m_wordIndexes.insert(trackIndex, SubtitleWordIndex());
     // Feed filters should be after all normalizers and before any user filters
     int filterIndex = m_producer->filter_count();
     for (int i = 0; i < m_producer->filter_count(); i++) {
@@ -537,6 +588,9 @@ void SubtitlesModel::doRemoveTrack(int trackIndex)
     beginRemoveRows(QModelIndex(), trackIndex, trackIndex);
     m_tracks.remove(trackIndex);
     m_items.remove(trackIndex);
+    m_maxEnds.remove(trackIndex);
+    m_srtTexts.remove(trackIndex);
+    m_wordIndexes.remove(trackIndex);
     int feedFilterIndex = 0;
     for (int i = 0; i < m_producer->filter_count(); i++) {
         QScopedPointer<Mlt::Filter> filter(m_producer->filter(i));
@@ -620,7 +674,14 @@ void SubtitlesModel::doRemoveSubtitleItems(int trackIndex,
         return;
     }
     beginRemoveRows(index(trackIndex), startIndex, endIndex);
+    auto &wordIndex = m_wordIndexes[trackIndex];
+    for (int i = startIndex; i <= endIndex; i++) {
+        wordIndex.remove(i, QString::fromStdString(m_items[trackIndex][i].text));
+    }
+    wordIndex.removeItems(startIndex, endIndex - startIndex + 1);
     m_items[trackIndex].remove(startIndex, endIndex - startIndex + 1);
+    updateMaxEnds(trackIndex, startIndex);
+    m_srtTexts[trackIndex].remove(startIndex, endIndex - startIndex + 1);
     requestFeedCommit(trackIndex);
     endRemoveRows();
 }
@@ -635,13 +696,9 @@ void SubtitlesModel::doInsertSubtitleItems(int trackIndex,
     }
     int oldSize = m_items[trackIndex].size();
     // Find the insert index
-    int insertIndex = oldSize;
-    for (int i = 0; i < oldSize; i++) {
-        if (m_items[trackIndex][i].start >= subtitles[0].start) {
-            insertIndex = i;
-            break;
-        }
-    }
+    const auto &items = m_items[trackIndex];
+    int insertIndex = std::lower_bound(items.cbegin(), items.cend(), subtitles[0].start, startsBefore)
+                      - items.cbegin();
     QModelIndex parent = index(trackIndex);
     beginInsertRows(parent, insertIndex, insertIndex + subtitles.size() - 1);
     // Resize the list to fit the new items
@@ -653,9 +710,14 @@ void SubtitlesModel::doInsertSubtitleItems(int trackIndex,
         }
     }
     // Put in the new items
+    auto &wordIndex = m_wordIndexes[trackIndex];
+    wordIndex.insertItems(insertIndex, subtitles.size());
     for (int i = 0; i < subtitles.size(); i++) {
         m_items[trackIndex][insertIndex + i] = subtitles[i];
+        m_srtTexts[trackIndex].insert(insertIndex + i, Subtitles::toSrtItemText(subtitles[i]));
+        wordIndex.add(insertIndex + i, QString::fromStdString(subtitles[i].text));
     }
+    updateMaxEnds(trackIndex, insertIndex);
     requestFeedCommit(trackIndex);
     endInsertRows();
 }
@@ -667,7 +729,11 @@ void SubtitlesModel::doSetText(int trackIndex, int itemIndex, const QString &tex
         return;
     }
     if (itemIndex >= 0 && itemIndex < m_items[trackIndex].size()) {
+        auto &wordIndex = m_wordIndexes[trackIndex];
+        wordIndex.remove(itemIndex, QString::fromStdString(m_items[trackIndex][itemIndex].text));
+        wordIndex.add(itemIndex, text);
         m_items[trackIndex][itemIndex].text = text.toStdString();
+        updateSrtText(trackIndex, itemIndex);
         requestFeedCommit(trackIndex);
         QModelIndex parent = index(trackIndex);
         emit dataChanged(index(itemIndex, COLUMN_TEXT, parent),
@@ -686,6 +752,8 @@ void SubtitlesModel::doSetTime(int trackIndex, int itemIndex, int64_t startTime,
     if (itemIndex >= 0 && itemIndex < m_items[trackIndex].size()) {
         m_items[trackIndex][itemIndex].start = startTime;
         m_items[trackIndex][itemIndex].end = endTime;
+        updateMaxEnds(trackIndex, itemIndex);
+        updateSrtText(trackIndex, itemIndex);
         requestFeedCommit(trackIndex);
         QModelIndex parent = index(trackIndex);
         emit dataChanged(index(itemIndex, COLUMN_START, parent),
@@ -695,6 +763,25 @@ void SubtitlesModel::doSetTime(int trackIndex, int itemIndex, int64_t startTime,
     }
 }
 
+void SubtitlesModel::updateMaxEnds(int trackIndex, int fromItemIndex)
+{
+    // Only the maximums from the first changed item onward can change.
+    const auto &items = m_items[trackIndex];
+    auto &maxEnds = m_maxEnds[trackIndex];
+    maxEnds.resize(items.size());
+    int64_t maxEnd = fromItemIndex > 0 ? maxEnds[fromItemIndex - 1]
+                                       : std::numeric_limits<int64_t>::min();
+    for (int i = qMax(0, fromItemIndex); i < items.size(); i++) {
+        maxEnd = std::max(maxEnd, items[i].end);
+        maxEnds[i] = maxEnd;
+    }
+}
+
+void SubtitlesModel::updateSrtText(int trackIndex, int itemIndex)
+{
+    m_srtTexts[trackIndex][itemIndex] = Subtitles::toSrtItemText(m_items[trackIndex][itemIndex]);
+}
+
 int SubtitlesModel::rowCount(const QModelIndex &parent) const
 {
     int count = 0;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,6 +19,7 @@
 #define SUBTITLESMODEL_H
 
 #include "models/subtitles.h"
+#include "models/subtitlewordindex.h"
 
 #include <MltProducer.h>
 #include <QAbstractItemModel>
@@ -74,7 +75,12 @@ public:
     QModelIndex itemModelIndex(int trackIndex, int itemIndex) const;
     int itemIndexAtTime(int trackIndex, int64_t msTime) const;
     int itemIndexBeforeTime(int trackIndex, int64_t msTime) const;
-    int itemIndexAfterTime(int trackIndex, int64_t msTime) const;
+    Q_INVOKABLE int itemIndexAfterTime(int trackIndex, int64_t msTime) const;
+    // Returns the index of the first item that ends at or after the time, or
+    // the item count if none do.
+    Q_INVOKABLE int itemIndexEndingAfterTime(int trackIndex, int64_t msTime) const;
+    // Returns the indexes of the items with all of the words of the text.
+    QList<int> findItems(int trackIndex, const QString &text) const;
     const Subtitles::SubtitleItem &getItem(int trackIndex, int itemIndex) const;
     void importSubtitles(int trackIndex, int64_t msTime, QList<Subtitles::SubtitleItem> &items);
     void importSubtitlesToNewTrack(SubtitlesModel::SubtitleTrack &track,
@@ -118,9 +124,19 @@ protected:
 private:
     void requestFeedCommit(int trackIndex);
     void commitToFeed(int trackIndex);
+    void updateMaxEnds(int trackIndex, int fromItemIndex = 0);
+    void updateSrtText(int trackIndex, int itemIndex);
     Mlt::Producer *m_producer;
     QList<SubtitlesModel::SubtitleTrack> m_tracks;
     QList<QList<Subtitles::SubtitleItem>> m_items;
+    // For each item, the latest end of it and the items before it. Items are
+    // sorted by start, so this finds the first item that overlaps a time with
+    // a binary search even if items overlap.
+    QList<QList<int64_t>> m_maxEnds;
+    // The SRT text of each item, kept up to date with the items so that a
+    // commit only joins them instead of formatting the whole track.
+    QList<QList<std::string>> m_srtTexts;
+    QList<SubtitleWordIndex> m_wordIndexes;
     QTimer *m_commitTimer;
     int m_commitTrack;
 };
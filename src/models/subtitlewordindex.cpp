@@ -0,0 +1,118 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "subtitlewordindex.h"
+
+#include <QRegularExpression>
+
+#include <algorithm>
+#include <iterator>
+
+static void insertSorted(QList<int> &list, int value)
+{
+    auto it = std::lower_bound(list.begin(), list.end(), value);
+    if (it == list.end() || *it != value)
+        list.insert(it, value);
+}
+
+static QList<int> intersect(const QList<int> &a, const QList<int> &b)
+{
+    QList<int> result;
+    std::set_intersection(a.cbegin(), a.cend(), b.cbegin(), b.cend(), std::back_inserter(result));
+    return result;
+}
+
+void SubtitleWordIndex::clear()
+{
+    m_items.clear();
+}
+
+void SubtitleWordIndex::add(int itemIndex, const QString &text)
+{
+    for (const auto &word : words(text))
+        insertSorted(m_items[word], itemIndex);
+}
+
+void SubtitleWordIndex::remove(int itemIndex, const QString &text)
+{
+    for (const auto &word : words(text)) {
+        auto it = m_items.find(word);
+        if (it == m_items.end())
+            continue;
+        auto found = std::lower_bound(it->begin(), it->end(), itemIndex);
+        if (found != it->end() && *found == itemIndex)
+            it->erase(found);
+        if (it->isEmpty())
+            m_items.erase(it);
+    }
+}
+
+void SubtitleWordIndex::insertItems(int itemIndex, int count)
+{
+    shift(itemIndex, count);
+}
+
+void SubtitleWordIndex::removeItems(int itemIndex, int count)
+{
+    shift(itemIndex + count, -count);
+}
+
+QList<int> SubtitleWordIndex::find(const QString &text) const
+{
+    const auto list = words(text);
+    if (list.isEmpty())
+        return QList<int>();
+
+    // The last word is matched as a prefix so that results follow the typing.
+    const auto &prefix = list.last();
+    QList<int> result;
+    for (auto it = m_items.lowerBound(prefix); it != m_items.cend() && it.key().startsWith(prefix);
+         ++it) {
+        QList<int> merged;
+        std::set_union(result.cbegin(),
+                       result.cend(),
+                       it->cbegin(),
+                       it->cend(),
+                       std::back_inserter(merged));
+        result.swap(merged);
+    }
+    for (int i = 0; i < list.size() - 1 && !result.isEmpty(); ++i) {
+        auto it = m_items.constFind(list[i]);
+        if (it == m_items.cend())
+            return QList<int>();
+        result = intersect(result, *it);
+    }
+    return result;
+}
+
+QStringList SubtitleWordIndex::words(const QString &text)
+{
+    static const QRegularExpression kSeparator("[^\\w']+",
+                                               QRegularExpression::UseUnicodePropertiesOption);
+    auto list = text.toCaseFolded().split(kSeparator, Qt::SkipEmptyParts);
+    list.removeDuplicates();
+    return list;
+}
+
+void SubtitleWordIndex::shift(int itemIndex, int delta)
+{
+    for (auto &list : m_items) {
+        auto it = std::lower_bound(list.begin(), list.end(), itemIndex);
+        for (; it != list.end(); ++it)
+            *it += delta;
+    }
+}
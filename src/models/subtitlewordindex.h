@@ -0,0 +1,58 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SUBTITLEWORDINDEX_H
+#define SUBTITLEWORDINDEX_H
+
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+/*!
+  \class SubtitleWordIndex
+  \brief Maps the words of the subtitle items of a track to the items that have them.
+
+  The index is kept in step with the items as they are edited, inserted and
+  removed so that a search does not need to go over all of the text.
+*/
+
+class SubtitleWordIndex
+{
+public:
+    void clear();
+    //! Adds the words of \a text for the item at \a itemIndex.
+    void add(int itemIndex, const QString &text);
+    //! Removes the words of \a text, the current text of the item at \a itemIndex.
+    void remove(int itemIndex, const QString &text);
+    //! Shifts the items from \a itemIndex on to make room for \a count items.
+    void insertItems(int itemIndex, int count);
+    //! Removes \a count items from \a itemIndex, whose words must already be removed.
+    void removeItems(int itemIndex, int count);
+    //! Returns the sorted indexes of the items that have all of the words of
+    //! \a text. The last word may be incomplete.
+    QList<int> find(const QString &text) const;
+
+    static QStringList words(const QString &text);
+
+private:
+    void shift(int itemIndex, int delta);
+
+    QMap<QString, QList<int>> m_items;
+};
+
+#endif // SUBTITLEWORDINDEX_H
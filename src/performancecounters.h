@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PERFORMANCECOUNTERS_H
+#define PERFORMANCECOUNTERS_H
+
+#include <QElapsedTimer>
+#include <QtGlobal>
+
+#include <atomic>
+
+/*!
+  \namespace PerformanceCounters
+  \brief Counts internal events for the Performance dock.
+
+  \threadsafe
+
+  Each counter is a relaxed atomic, so counting costs about as much as an
+  increment. Building without SHOTCUT_PERFORMANCE_COUNTERS (the CMake option
+  PERFORMANCE_COUNTERS) turns every function here into an empty inline one,
+  which the compiler removes, and value() always returns 0.
+*/
+
+namespace PerformanceCounters {
+
+enum Counter {
+    ThumbnailMemoryHits,
+    ThumbnailDiskHits,
+    ThumbnailMisses,
+    ThumbnailsGenerated,
+    MemoryPoolPurges,
+    UndoRecords,
+    UndoRecordNs,
+    CounterCount
+};
+
+#ifdef SHOTCUT_PERFORMANCE_COUNTERS
+
+constexpr bool isEnabled = true;
+
+inline std::atomic<qint64> &counter(Counter id)
+{
+    static std::atomic<qint64> counters[CounterCount] = {};
+    return counters[id];
+}
+
+inline void add(Counter id, qint64 amount = 1)
+{
+    counter(id).fetch_add(amount, std::memory_order_relaxed);
+}
+
+inline qint64 value(Counter id)
+{
+    return counter(id).load(std::memory_order_relaxed);
+}
+
+//! Adds the duration of the enclosing scope to one counter and 1 to another.
+class ScopedTimer
+{
+public:
+    ScopedTimer(Counter nanoseconds, Counter count)
+        : m_nanoseconds(nanoseconds)
+        , m_count(count)
+    {
+        m_timer.start();
+    }
+    ~ScopedTimer()
+    {
+        add(m_nanoseconds, m_timer.nsecsElapsed());
+        add(m_count);
+    }
+
+private:
+    Counter m_nanoseconds;
+    Counter m_count;
+    QElapsedTimer m_timer;
+};
+
+#else
+
+constexpr bool isEnabled = false;
+
+inline void add(Counter, qint64 = 1) {}
+
+inline qint64 value(Counter)
+{
+    return 0;
+}
+
+class ScopedTimer
+{
+public:
+    ScopedTimer(Counter, Counter) {}
+};
+
+#endif // SHOTCUT_PERFORMANCE_COUNTERS
+
+} // namespace PerformanceCounters
+
+#endif // PERFORMANCECOUNTERS_H
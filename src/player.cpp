@@ -20,6 +20,7 @@
 #include "Logger.h"
 #include "actions.h"
 #include "dialogs/durationdialog.h"
+#include "loopsplicer.h"
 #include "mainwindow.h"
 #include "proxymanager.h"
 #include "scrubbar.h"
@@ -771,6 +772,11 @@ void Player::setupActions()
     action->setShortcut(QKeySequence(Qt::CTRL | Qt::SHIFT | Qt::Key_Q));
     connect(action, &QAction::triggered, this, [&]() { emit toggleVuiRequested(); });
     Actions.add("playerToggleVui", action, tr("Player"));
+
+    action = new QAction(tr("360 Viewport"), this);
+    action->setCheckable(true);
+    action->setToolTip(tr("Preview a view of 360 video that you can drag and zoom with the wheel"));
+    Actions.add("playerViewport360Action", action, tr("Player"));
 }
 
 void Player::setIn(int pos)
@@ -885,6 +891,7 @@ void Player::reset()
     m_durationLabel->setText(blankTime());
     m_scrubber->setDisabled(true);
     m_scrubber->setScale(1);
+    m_scrubber->setPreviewProducer(nullptr);
     m_positionSpinner->setValue(0);
     m_positionSpinner->setDisabled(true);
     Actions["playerPlayPauseAction"]->setDisabled(true);
@@ -907,6 +914,7 @@ void Player::onProducerOpened(bool play)
     MLT.producer()->set("ignore_points", 1);
     m_scrubber->setFramerate(MLT.profile().fps());
     m_scrubber->setScale(m_duration);
+    m_scrubber->setPreviewProducer(MLT.isClip() ? MLT.producer() : nullptr);
     if (!MLT.isPlaylist())
         m_scrubber->setMarkers(QList<int>());
     m_inPointLabel->setText(blankTime());
@@ -1012,8 +1020,12 @@ void Player::onFrameDisplayed(const SharedFrame &frame)
         }
     }
     if (loop) {
-        MLT.producer()->seek(m_loopStart);
-        MLT.consumer()->purge();
+        // Playing forward, the producer has already looped without emptying the consumer.
+        if (MLT.producer()->get_producer() != m_splicedProducer
+            || MLT.producer()->get_speed() <= 0.0) {
+            MLT.producer()->seek(m_loopStart);
+            MLT.consumer()->purge();
+        }
     } else if (position >= m_duration - 1) {
         emit endOfStream();
     }
@@ -1184,7 +1196,14 @@ void Player::setLoopRange(int start, int end)
 {
     m_loopStart = start;
     m_loopEnd = end;
-    if (Actions["playerLoopAction"]->isChecked()) {
+    const bool isLooping = Actions["playerLoopAction"]->isChecked();
+    m_splicedProducer = nullptr;
+    if (MLT.producer() && MLT.producer()->is_valid()
+        && LoopSplicer::setRange(*MLT.producer(),
+                                 isLooping ? m_loopStart : -1,
+                                 isLooping ? m_loopEnd : -1))
+        m_splicedProducer = MLT.producer()->get_producer();
+    if (isLooping) {
         m_scrubber->setLoopRange(m_loopStart, m_loopEnd);
         emit loopChanged(m_loopStart, m_loopEnd);
     } else {
@@ -169,6 +169,8 @@ private:
     NewProjectFolder *m_projectWidget;
     int m_loopStart;
     int m_loopEnd;
+    // The producer that loops by itself, or null.
+    mlt_producer m_splicedProducer{nullptr};
     DockToolBar *m_currentDurationToolBar;
     DockToolBar *m_controlsToolBar;
     DockToolBar *m_optionsToolBar;
@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "probecache.h"
+
+#include "Logger.h"
+#include "executors.h"
+#include "settings.h"
+#include "util.h"
+
+#include <Mlt.h>
+#include <QDateTime>
+#include <QDir>
+
+#include <cmath>
+
+static const char *kProbeCacheFileName = "probes.txt";
+static const qint64 kRevalidateSeconds = 30 * 24 * 60 * 60;
+static const char *kRevalidateProfile = "atsc_720p_60";
+
+// The properties avformat sets from the headers besides the meta ones
+static const QStringList kProbedProperties{"seekable", "video_index", "audio_index"};
+
+ProbeCache &ProbeCache::singleton()
+{
+    static ProbeCache instance;
+    return instance;
+}
+
+ProbeCache::Properties ProbeCache::properties(const QString &path)
+{
+    Entry entry;
+    return find(path, entry) ? entry.properties : Properties();
+}
+
+void ProbeCache::insert(Mlt::Producer &producer)
+{
+    if (!producer.is_valid() || qstrcmp(producer.get("mlt_service"), "avformat"))
+        return;
+    const auto path = QString::fromUtf8(producer.get("resource"));
+    const auto key = Util::fileFingerprint(path);
+    if (key.isEmpty() || key.contains('\t') || key.contains('\n'))
+        return;
+    Entry entry{QDateTime::currentSecsSinceEpoch(), 0.0, {}};
+    if (producer.get_fps() > 0.0)
+        entry.duration = producer.get_length() / producer.get_fps();
+    for (int i = 0; i < producer.count(); i++) {
+        const auto name = QString::fromUtf8(producer.get_name(i));
+        if (name.startsWith("meta.") || kProbedProperties.contains(name))
+            entry.properties.insert(name, QString::fromUtf8(producer.get(i)));
+    }
+    if (entry.properties.isEmpty())
+        return;
+
+    QMutexLocker locker(&m_mutex);
+    load();
+    const auto it = m_entries.constFind(key);
+    if (it != m_entries.constEnd()) {
+        if (it->properties == entry.properties
+            && entry.time - it->time < kRevalidateSeconds / 2)
+            return;
+        if (it->properties != entry.properties)
+            LOG_INFO() << "the probe of" << path << "changed";
+    }
+    m_entries.insert(key, entry);
+    write(key, entry);
+}
+
+bool ProbeCache::apply(const QString &path, Mlt::Properties &properties, double fps)
+{
+    Entry entry;
+    if (!find(path, entry))
+        return false;
+    for (auto it = entry.properties.constBegin(); it != entry.properties.constEnd(); ++it) {
+        const auto name = it.key().toUtf8();
+        if (!properties.property_exists(name.constData()))
+            properties.set(name.constData(), it.value().toUtf8().constData());
+    }
+    if (fps > 0.0 && entry.duration > 0.0) {
+        const int length = qMax(1, int(std::ceil(entry.duration * fps - 0.5)));
+        properties.set("length", length);
+        properties.set("out", length - 1);
+    }
+    return true;
+}
+
+Mlt::Producer *ProbeCache::open(Mlt::Profile &profile, const QString &path)
+{
+    Entry entry;
+    if (!find(path, entry) || entry.duration <= 0.0)
+        return nullptr;
+    auto producer = new Mlt::Producer(profile, "avformat-novalidate", path.toUtf8().constData());
+    if (!producer->is_valid() || !apply(path, *producer, profile.fps())) {
+        delete producer;
+        return nullptr;
+    }
+    return producer;
+}
+
+bool ProbeCache::find(const QString &path, Entry &entry)
+{
+    const auto key = Util::fileFingerprint(path);
+    if (key.isEmpty())
+        return false;
+    QMutexLocker locker(&m_mutex);
+    load();
+    const auto it = m_entries.constFind(key);
+    if (it == m_entries.constEnd())
+        return false;
+    entry = it.value();
+    // Trust the entry now and check it while the file is in use.
+    if (QDateTime::currentSecsSinceEpoch() - entry.time > kRevalidateSeconds)
+        revalidate(path, key);
+    return true;
+}
+
+void ProbeCache::load()
+{
+    if (m_isLoaded)
+        return;
+    m_isLoaded = true;
+    const QByteArray header = QByteArray("MLT ") + mlt_version_get_string();
+    m_file.setFileName(QDir(Settings.appDataLocation()).filePath(kProbeCacheFileName));
+    bool isCurrent = false;
+    int lineCount = 0;
+    if (m_file.open(QIODevice::ReadOnly)) {
+        // Another version of MLT or FFmpeg may probe differently.
+        isCurrent = m_file.readLine().trimmed() == header;
+        while (isCurrent && !m_file.atEnd()) {
+            const auto line = m_file.readLine();
+            ++lineCount;
+            if (!line.endsWith('\n'))
+                break;
+            const auto fields = line.chopped(1).split('\t');
+            if (fields.size() < 3)
+                continue;
+            Entry entry{fields[1].toLongLong(), fields[2].toDouble(), {}};
+            for (int i = 3; i < fields.size(); ++i) {
+                const auto equals = fields[i].indexOf('=');
+                if (equals > 0) {
+                    entry.properties.insert(QString::fromUtf8(fields[i].left(equals)),
+                                            QString::fromUtf8(QByteArray::fromPercentEncoding(
+                                                fields[i].mid(equals + 1))));
+                }
+            }
+            m_entries.insert(QString::fromUtf8(fields[0]), entry);
+        }
+        m_file.close();
+    }
+    // Rewrite the file when it is stale or most of its lines repeat a key.
+    if (!isCurrent || lineCount > 2 * m_entries.size() + 1000) {
+        if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            m_file.write(header + '\n');
+            for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+                write(it.key(), it.value());
+            m_file.close();
+        }
+    }
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+        LOG_WARNING() << "failed to open" << m_file.fileName();
+}
+
+void ProbeCache::write(const QString &key, const Entry &entry)
+{
+    if (!m_file.isOpen())
+        return;
+    QByteArray line = key.toUtf8() + '\t' + QByteArray::number(entry.time) + '\t'
+                      + QByteArray::number(entry.duration, 'g', 12);
+    for (auto it = entry.properties.constBegin(); it != entry.properties.constEnd(); ++it)
+        line += '\t' + it.key().toUtf8() + '=' + it.value().toUtf8().toPercentEncoding();
+    m_file.write(line + '\n');
+    m_file.flush();
+}
+
+void ProbeCache::revalidate(const QString &path, const QString &key)
+{
+    if (m_revalidating.contains(key))
+        return;
+    m_revalidating.insert(key);
+    Executors::start(Executors::AnalysisExecutor, [path]() {
+        Mlt::Profile profile(kRevalidateProfile);
+        Mlt::Producer producer(profile, "avformat", path.toUtf8().constData());
+        PROBES.insert(producer);
+    });
+}
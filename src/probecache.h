@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROBECACHE_H
+#define PROBECACHE_H
+
+#include <QFile>
+#include <QHash>
+#include <QMap>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+namespace Mlt {
+class Producer;
+class Profile;
+class Properties;
+} // namespace Mlt
+
+/*!
+  \class ProbeCache
+  \brief Remembers what avformat probed of each media file.
+
+  \threadsafe
+
+  Opening a file with avformat reads its headers and analyzes its streams,
+  which dominates loading a project from slow storage. The cache keeps the
+  length, the stream indices, and the meta.media properties of each file by
+  its fingerprint in a file in the app data folder. A hit makes an
+  avformat-novalidate producer, which opens the file only when it renders.
+  An entry older than a month is probed again in the background, and the
+  cache starts over with another version of MLT.
+*/
+
+class ProbeCache
+{
+public:
+    typedef QMap<QString, QString> Properties;
+
+    static ProbeCache &singleton();
+
+    //! Returns the cached properties of the file at \a path, or none on a miss.
+    Properties properties(const QString &path);
+    //! Stores what the avformat \a producer probed of its file.
+    void insert(Mlt::Producer &producer);
+    /*!
+      Sets the cached properties that \a properties lacks and returns false on
+      a miss. With \a fps, it also sets the length and out point.
+    */
+    bool apply(const QString &path, Mlt::Properties &properties, double fps = 0.0);
+    //! Returns an avformat-novalidate producer for \a path, or nullptr on a miss.
+    Mlt::Producer *open(Mlt::Profile &profile, const QString &path);
+
+private:
+    ProbeCache() = default;
+    struct Entry
+    {
+        qint64 time;     ///< When the file was probed, in seconds since the epoch
+        double duration; ///< In seconds, since the length depends on the profile
+        Properties properties;
+    };
+
+    bool find(const QString &path, Entry &entry);
+    void load();
+    void write(const QString &key, const Entry &entry);
+    void revalidate(const QString &path, const QString &key);
+
+    QMutex m_mutex;
+    QHash<QString, Entry> m_entries;
+    QSet<QString> m_revalidating;
+    QFile m_file;
+    bool m_isLoaded{false};
+};
+
+#define PROBES ProbeCache::singleton()
+
+#endif // PROBECACHE_H
@@ -0,0 +1,323 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "projectarchive.h"
+
+#include "Logger.h"
+#include "shotcut_mlt_properties.h"
+
+#include <QBuffer>
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QtConcurrent/QtConcurrentMap>
+
+#include <numeric>
+#include <vector>
+
+static const char kMagic[] = "SCMZ";
+static const quint32 kVersion = 1;
+// Smaller chunks are reused more often, and bigger ones compress better.
+static const int kMinChunkSize = 64 * 1024;
+
+namespace {
+
+enum ChunkType : quint8 {
+    XmlChunk = 0,
+    IndexChunk = 1,
+};
+
+struct Chunk
+{
+    quint8 type;
+    quint64 offset;
+    quint32 size;
+    quint32 rawSize;
+    QByteArray sha1;
+};
+
+} // namespace
+
+static bool readTable(QIODevice &device, QList<Chunk> &chunks)
+{
+    QDataStream stream(&device);
+    stream.setVersion(QDataStream::Qt_6_0);
+    char magic[4];
+    quint32 version = 0;
+    quint32 count = 0;
+    if (stream.readRawData(magic, 4) != 4 || qstrncmp(magic, kMagic, 4))
+        return false;
+    stream >> version >> count;
+    if (version != kVersion || stream.status() != QDataStream::Ok)
+        return false;
+    for (quint32 i = 0; i < count; ++i) {
+        Chunk chunk;
+        chunk.sha1.resize(20);
+        stream >> chunk.type >> chunk.offset >> chunk.size >> chunk.rawSize;
+        stream.readRawData(chunk.sha1.data(), chunk.sha1.size());
+        chunks << chunk;
+    }
+    return stream.status() == QDataStream::Ok;
+}
+
+static QByteArray chunkData(const QByteArray &file, const Chunk &chunk)
+{
+    if (chunk.offset + chunk.size > quint64(file.size()))
+        return QByteArray();
+    return file.mid(chunk.offset, chunk.size);
+}
+
+static QByteArray sha1(const QByteArray &data)
+{
+    return QCryptographicHash::hash(data, QCryptographicHash::Sha1);
+}
+
+// Splits the XML where a top level element starts, which the MLT XML of
+// Shotcut indents by two spaces, so that an edit only changes its own chunk.
+static QList<QByteArray> splitXml(const QByteArray &xml)
+{
+    QList<QByteArray> result;
+    qsizetype start = 0;
+    qsizetype pos = 0;
+    while ((pos = xml.indexOf("\n  <", pos)) >= 0) {
+        const char next = pos + 4 < xml.size() ? xml.at(pos + 4) : '/';
+        if (next != '/' && pos + 1 - start >= kMinChunkSize) {
+            result << xml.mid(start, pos + 1 - start);
+            start = pos + 1;
+        }
+        pos += 4;
+    }
+    result << xml.mid(start);
+    return result;
+}
+
+QJsonObject ProjectArchive::index(const QByteArray &xml)
+{
+    QJsonArray producers;
+    QJsonArray playlists;
+    QJsonArray tractors;
+    QJsonObject producer;
+    QJsonObject playlist;
+    QJsonArray entries;
+    QJsonObject tractor;
+    QJsonArray tracks;
+    QXmlStreamReader reader(xml);
+    while (!reader.atEnd()) {
+        reader.readNext();
+        const auto name = reader.name();
+        if (reader.isStartElement()) {
+            const auto id = reader.attributes().value("id").toString();
+            if (name == QLatin1String("producer") || name == QLatin1String("chain")) {
+                producer = QJsonObject{{"id", id}};
+            } else if (name == QLatin1String("playlist")) {
+                playlist = QJsonObject{{"id", id}};
+                entries = QJsonArray();
+            } else if (name == QLatin1String("tractor")) {
+                tractor = QJsonObject{
+                    {"id", id},
+                    {"in", reader.attributes().value("in").toString()},
+                    {"out", reader.attributes().value("out").toString()},
+                };
+                tracks = QJsonArray();
+            } else if (name == QLatin1String("entry")) {
+                entries.append(QJsonObject{
+                    {"producer", reader.attributes().value("producer").toString()},
+                    {"in", reader.attributes().value("in").toString()},
+                    {"out", reader.attributes().value("out").toString()},
+                });
+            } else if (name == QLatin1String("blank")) {
+                entries.append(
+                    QJsonObject{{"blank", reader.attributes().value("length").toString()}});
+            } else if (name == QLatin1String("track")) {
+                tracks.append(reader.attributes().value("producer").toString());
+            } else if (name == QLatin1String("property") && !producer.isEmpty()) {
+                const auto property = reader.attributes().value("name").toString();
+                if (property == "resource" || property == "mlt_service"
+                    || property == kShotcutHashProperty || property == kShotcutCaptionProperty)
+                    producer[property] = reader.readElementText();
+            }
+        } else if (reader.isEndElement()) {
+            if ((name == QLatin1String("producer") || name == QLatin1String("chain"))
+                && !producer.isEmpty()) {
+                producers.append(producer);
+                producer = QJsonObject();
+            } else if (name == QLatin1String("playlist")) {
+                playlist["entries"] = entries;
+                playlists.append(playlist);
+            } else if (name == QLatin1String("tractor")) {
+                tractor["tracks"] = tracks;
+                tractors.append(tractor);
+            }
+        }
+    }
+    if (reader.hasError())
+        LOG_WARNING() << "failed to index the project:" << reader.errorString();
+    return QJsonObject{
+        {"producers", producers},
+        {"playlists", playlists},
+        {"tractors", tractors},
+    };
+}
+
+bool ProjectArchive::isArchive(const QString &fileName)
+{
+    return fileName.endsWith(QStringLiteral(".") + suffix(), Qt::CaseInsensitive);
+}
+
+QByteArray ProjectArchive::read(const QString &fileName)
+{
+    // Read the file in one go, which is much faster on network storage.
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        LOG_ERROR() << "failed to open" << fileName;
+        return QByteArray();
+    }
+    const QByteArray data = file.readAll();
+    file.close();
+    QList<Chunk> chunks;
+    QBuffer buffer(const_cast<QByteArray *>(&data));
+    if (!buffer.open(QIODevice::ReadOnly) || !readTable(buffer, chunks)) {
+        LOG_ERROR() << "not a compressed project" << fileName;
+        return QByteArray();
+    }
+
+    std::vector<Chunk> xmlChunks;
+    for (const auto &chunk : std::as_const(chunks)) {
+        if (chunk.type == XmlChunk)
+            xmlChunks.push_back(chunk);
+    }
+    const auto pieces = QtConcurrent::blockingMapped<QList<QByteArray>>(
+        xmlChunks, [&data](const Chunk &chunk) {
+            auto piece = qUncompress(chunkData(data, chunk));
+            if (piece.size() != qsizetype(chunk.rawSize) || sha1(piece) != chunk.sha1)
+                return QByteArray();
+            return piece;
+        });
+    QByteArray xml;
+    xml.reserve(std::accumulate(xmlChunks.begin(),
+                                xmlChunks.end(),
+                                qsizetype(0),
+                                [](qsizetype sum, const Chunk &chunk) {
+                                    return sum + chunk.rawSize;
+                                }));
+    for (size_t i = 0; i < xmlChunks.size(); ++i) {
+        if (pieces[i].isEmpty() && xmlChunks[i].rawSize > 0) {
+            LOG_ERROR() << "corrupt chunk" << i << "in" << fileName;
+            return QByteArray();
+        }
+        xml += pieces[i];
+    }
+    return xml;
+}
+
+QJsonObject ProjectArchive::readIndex(const QString &fileName)
+{
+    QFile file(fileName);
+    QList<Chunk> chunks;
+    if (!file.open(QIODevice::ReadOnly) || !readTable(file, chunks))
+        return QJsonObject();
+    for (const auto &chunk : std::as_const(chunks)) {
+        if (chunk.type == IndexChunk && file.seek(chunk.offset)) {
+            const auto json = qUncompress(file.read(chunk.size));
+            return QJsonDocument::fromJson(json).object();
+        }
+    }
+    return QJsonObject();
+}
+
+bool ProjectArchive::write(const QString &fileName, const QString &xml)
+{
+    const auto utf8 = xml.toUtf8();
+    const auto pieces = splitXml(utf8);
+
+    // Reuse the compressed data of the chunks that the file already has.
+    QHash<QByteArray, QByteArray> previous;
+    {
+        QFile file(fileName);
+        QList<Chunk> chunks;
+        if (file.open(QIODevice::ReadOnly) && readTable(file, chunks)) {
+            const QByteArray data = file.readAll();
+            const qint64 tableEnd = file.size() - data.size();
+            for (auto chunk : std::as_const(chunks)) {
+                if (chunk.type != XmlChunk || chunk.offset < quint64(tableEnd))
+                    continue;
+                chunk.offset -= tableEnd;
+                previous.insert(chunk.sha1, chunkData(data, chunk));
+            }
+        }
+    }
+
+    struct Piece
+    {
+        QByteArray raw;
+        QByteArray sha1;
+        QByteArray compressed;
+    };
+    std::vector<Piece> chunks;
+    chunks.reserve(pieces.size() + 1);
+    int reused = 0;
+    for (const auto &raw : pieces) {
+        Piece piece{raw, sha1(raw), QByteArray()};
+        piece.compressed = previous.value(piece.sha1);
+        if (!piece.compressed.isEmpty())
+            ++reused;
+        chunks.push_back(piece);
+    }
+    QtConcurrent::blockingMap(chunks, [](Piece &piece) {
+        if (piece.compressed.isEmpty())
+            piece.compressed = qCompress(piece.raw);
+    });
+    const auto json = QJsonDocument(index(utf8)).toJson(QJsonDocument::Compact);
+    chunks.push_back(Piece{json, sha1(json), qCompress(json)});
+
+    QByteArray output;
+    QDataStream stream(&output, QIODevice::WriteOnly);
+    stream.setVersion(QDataStream::Qt_6_0);
+    stream.writeRawData(kMagic, 4);
+    stream << kVersion << quint32(chunks.size());
+    // Each entry of the table has a type, an offset, two sizes and a hash.
+    quint64 offset = 12 + chunks.size() * (1 + 8 + 4 + 4 + 20);
+    for (size_t i = 0; i < chunks.size(); ++i) {
+        const auto &piece = chunks[i];
+        const quint8 type = i + 1 < chunks.size() ? XmlChunk : IndexChunk;
+        stream << type << offset << quint32(piece.compressed.size()) << quint32(piece.raw.size());
+        stream.writeRawData(piece.sha1.constData(), piece.sha1.size());
+        offset += piece.compressed.size();
+    }
+    for (const auto &piece : chunks)
+        stream.writeRawData(piece.compressed.constData(), piece.compressed.size());
+    LOG_DEBUG() << "writing" << pieces.size() << "chunks and reusing" << reused << "of them";
+
+    QSaveFile file(fileName);
+    file.setDirectWriteFallback(true);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        LOG_ERROR() << "failed to open compressed project for writing" << fileName;
+        return false;
+    }
+    if (file.write(output) != output.size()) {
+        LOG_ERROR() << "error while writing compressed project" << fileName << ":"
+                    << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+    return file.commit();
+}
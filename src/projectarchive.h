@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROJECTARCHIVE_H
+#define PROJECTARCHIVE_H
+
+#include <QByteArray>
+#include <QJsonObject>
+#include <QString>
+
+/*!
+  \class ProjectArchive
+  \brief Reads and writes the compressed project file (.mltz).
+
+  The file holds the MLT XML of a project in compressed chunks that are split
+  at the top level elements, so that one edit changes few of them. A save
+  reuses the compressed data of the chunks that did not change, and a load
+  decompresses the chunks on all cores. An index of the producers and the
+  playlist entries is kept in a chunk of its own, which readIndex() returns
+  without decompressing the XML. The uncompressed .mlt stays the format to
+  exchange projects with other MLT applications.
+*/
+
+class ProjectArchive
+{
+public:
+    static const char *suffix() { return "mltz"; }
+    static bool isArchive(const QString &fileName);
+    //! Returns the UTF-8 XML of the project, or an empty array on error.
+    static QByteArray read(const QString &fileName);
+    //! Returns the index of the producers and playlists without reading the XML.
+    static QJsonObject readIndex(const QString &fileName);
+    //! Returns the index of the producers, playlists and tractors in \a xml.
+    static QJsonObject index(const QByteArray &xml);
+    static bool write(const QString &fileName, const QString &xml);
+};
+
+#endif // PROJECTARCHIVE_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2025 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,20 +19,35 @@
 
 #include "Logger.h"
 #include "jobqueue.h"
+#include "jobs/copyjob.h"
+#include "jobs/downloadjob.h"
 #include "jobs/ffmpegjob.h"
 #include "jobs/qimagejob.h"
+#include "mainwindow.h"
 #include "mltcontroller.h"
+#include "qmltypes/thumbnailprovider.h"
 #include "settings.h"
 #include "shotcut_mlt_properties.h"
 #include "util.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDomDocument>
 #include <QFile>
+#include <QHash>
 #include <QImageReader>
 #include <QObject>
+#include <QSet>
+#include <QTimer>
+#include <QUrl>
 #include <QVector>
 #include <QXmlStreamReader>
 #include <QXmlStreamWriter>
 
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <utime.h>
 
 static const char *kProxySubfolder = "proxies";
@@ -42,8 +57,25 @@ static const char *kDJIProxyVideoExtension = ".LRF";
 static const char *kProxyPendingVideoExtension = ".pending.mp4";
 static const char *kProxyImageExtension = ".jpg";
 static const char *kProxyPendingImageExtension = ".pending.jpg";
+// The intra-frame caches of the timewarp sources keep the full resolution.
+static const char *kIntraCacheSuffix = "-intra";
+static const char *kIntraCacheExtension = ".mkv";
+static const char *kIntraCachePendingExtension = ".pending.mkv";
+static const char *kMediaCacheSubfolder = "media-cache";
+static const QStringList kRemoteSchemes = {"http", "https", "ftp", "sftp", "smb"};
 static const float kProxyResolutionRatio = 1.3f;
 static const int kFallbackProxyResolution = 540;
+// The heights of the proxies, each made when a preview first needs it
+static const QList<int> kProxyTiers = {270, 540, 1080};
+// A tier serves the preview heights up to a third more than its own.
+static const float kProxyTierCoverage = 0.75f;
+// Beyond this many visible video tracks, the preview uses the next lower tier.
+static const int kManyVideoTracks = 4;
+static std::atomic<int> proxyTier{0};
+// A pending file whose modification time is older than the lease belongs to a
+// job that no longer runs, here or on another computer sharing the folder.
+static const int kPendingLeaseSeconds = 2 * 60;
+static const int kPendingHeartbeatMs = 30 * 1000;
 static const QStringList kPixFmtsWithAlpha
     = {"pal8",         "argb",         "rgba",         "abgr",         "bgra",
        "yuva420p",     "yuva422p",     "yuva444p",     "yuva420p9be",  "yuva420p9le",
@@ -56,6 +88,80 @@ static const QStringList kPixFmtsWithAlpha
        "gbrap10le",    "gbrap10be",    "gbrapf32be",   "gbrapf32le",   "yuva422p12be",
        "yuva422p12le", "yuva444p12be", "yuva444p12le"};
 
+static bool isLeaseHeld(const QString &fileName)
+{
+    QFileInfo info(fileName);
+    return info.exists()
+           && info.lastModified().secsTo(QDateTime::currentDateTime()) < kPendingLeaseSeconds;
+}
+
+// Keeps the leases of the pending proxy jobs in the queue fresh.
+static void startHeartbeat()
+{
+    static QTimer *timer = nullptr;
+    if (timer)
+        return;
+    timer = new QTimer(&JOBS);
+    QObject::connect(timer, &QTimer::timeout, []() {
+        for (auto job : JOBS.jobs()) {
+            const auto target = job->target();
+            if (!job->isFinished() && target.contains(".pending."))
+                ::utime(target.toUtf8().constData(), nullptr);
+        }
+    });
+    timer->start(kPendingHeartbeatMs);
+}
+
+// Creates the pending file unless another job holds its lease.
+static bool acquirePending(const QString &fileName)
+{
+    QFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly)) {
+        if (isLeaseHeld(fileName)) {
+            LOG_INFO() << "another job is making" << fileName;
+            return false;
+        }
+        LOG_INFO() << "taking over the expired" << fileName;
+        QFile::remove(fileName);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::NewOnly))
+            return false;
+    }
+    file.close();
+    startHeartbeat();
+    return true;
+}
+
+static int baseTier()
+{
+    const int height = Settings.playerPreviewScale() ? Settings.playerPreviewScale()
+                                                     : kFallbackProxyResolution;
+    for (int tier : kProxyTiers) {
+        if (tier >= qRound(kProxyTierCoverage * height))
+            return tier;
+    }
+    return kProxyTiers.last();
+}
+
+static int visibleVideoTrackCount()
+{
+    int count = 0;
+    auto multitrack = MAIN.multitrack();
+    if (multitrack && multitrack->is_valid()) {
+        Mlt::Tractor tractor(*multitrack);
+        for (int i = 0; i < tractor.count(); ++i) {
+            std::unique_ptr<Mlt::Producer> track(tractor.track(i));
+            if (track && track->get(kVideoTrackProperty) && !(track->get_int("hide") & 1))
+                ++count;
+        }
+    }
+    return count;
+}
+
+static QString tierSuffix(int tier)
+{
+    return QStringLiteral("-%1p").arg(tier);
+}
+
 QDir ProxyManager::dir()
 {
     // Use project folder + "/proxies" if using project folder and enabled
@@ -89,11 +195,12 @@ void ProxyManager::generateVideoProxy(Mlt::Producer &producer,
                                       const QPoint &aspectRatio,
                                       bool replace)
 {
-    // Always regenerate per preview scaling or 540 if not specified
+    // Always regenerate at the tier of the preview scaling
     QString resource = ProxyManager::resource(producer);
     QStringList args;
     QString hash = Util::getHash(producer);
-    QString fileName = ProxyManager::dir().filePath(hash + kProxyPendingVideoExtension);
+    QString fileName = ProxyManager::dir().filePath(hash + tierSuffix(resolution())
+                                                    + kProxyPendingVideoExtension);
     QString filters;
     auto hwCodecs = Settings.encodeHardware();
     QString hwFilters;
@@ -103,15 +210,18 @@ void ProxyManager::generateVideoProxy(Mlt::Producer &producer,
         return;
     }
 
-    // Touch file to make it in progress
-    QFile file(fileName);
-    file.open(QIODevice::WriteOnly);
-    file.resize(0);
-    file.close();
+    // Create the file to make it in progress
+    if (!acquirePending(fileName))
+        return;
 
     args << "-loglevel"
          << "verbose";
     args << "-noautorotate";
+    if (Settings.proxyUseHardware()) {
+        // Decode on the GPU when it supports the codec, else in software.
+        args << "-hwaccel"
+             << "auto";
+    }
     args << "-i" << resource;
     args << "-max_muxing_queue_size"
          << "9999";
@@ -343,7 +453,8 @@ void ProxyManager::generateVideoProxy(Mlt::Producer &producer,
                  << "nv12";
         }
     }
-    if (!args.contains("-codec:v")) {
+    const bool isHardwareEncoder = args.contains("-codec:v");
+    if (!isHardwareEncoder) {
         args << "-codec:v"
              << "libx264";
         args << "-preset"
@@ -362,6 +473,9 @@ void ProxyManager::generateVideoProxy(Mlt::Producer &producer,
     FfmpegJob *job = new FfmpegJob(fileName, args, true);
     job->setLabel(QObject::tr("Make proxy for %1").arg(Util::baseName(resource)));
     job->setTarget(fileName);
+    if (isHardwareEncoder)
+        job->setResourceClass(AbstractJob::GpuEncodeResource);
+    job->setBackground();
     if (replace) {
         job->setPostJobAction(new ProxyReplacePostJobAction(resource, fileName, hash));
     } else {
@@ -370,30 +484,106 @@ void ProxyManager::generateVideoProxy(Mlt::Producer &producer,
     JOBS.add(job);
 }
 
-void ProxyManager::generateImageProxy(Mlt::Producer &producer, bool replace)
+void ProxyManager::generateIntraCache(Mlt::Producer &producer, bool replace)
 {
-    // Always regenerate per preview scaling or 540 if not specified
     QString resource = ProxyManager::resource(producer);
     QString hash = Util::getHash(producer);
-    QString fileName = ProxyManager::dir().filePath(hash + kProxyPendingImageExtension);
+    QString fileName = ProxyManager::dir().filePath(hash + kIntraCacheSuffix
+                                                    + kIntraCachePendingExtension);
 
-    // Touch file to make it in progress
-    QFile file(fileName);
-    file.open(QIODevice::WriteOnly);
-    file.resize(0);
-    file.close();
+    // Create the file to make it in progress
+    if (JOBS.targetIsInProgress(fileName) || !acquirePending(fileName))
+        return;
 
-    AbstractJob *job = new QImageJob(fileName, resource, resolution());
+    // Every frame is a key frame so that a timewarp, above all a reverse one,
+    // decodes only the frame it shows instead of seeking back to a key frame.
+    QStringList args;
+    args << "-loglevel"
+         << "verbose";
+    args << "-noautorotate";
+    args << "-i" << resource;
+    args << "-max_muxing_queue_size"
+         << "9999";
+    args << "-map"
+         << "0:V?"
+         << "-map"
+         << "0:a?";
+    args << "-map_metadata"
+         << "0"
+         << "-ignore_unknown";
+    args << "-f"
+         << "matroska"
+         << "-codec:a"
+         << "pcm_s16le";
+    args << "-codec:v"
+         << "libx264";
+    args << "-preset"
+         << "veryfast";
+    args << "-crf"
+         << "15";
+    args << "-g"
+         << "1"
+         << "-bf"
+         << "0";
+    args << "-y" << fileName;
+
+    FfmpegJob *job = new FfmpegJob(fileName, args, true);
+    job->setLabel(QObject::tr("Make intra-frame cache for %1").arg(Util::baseName(resource)));
+    job->setTarget(fileName);
+    job->setBackground();
     if (replace) {
-        job->setPostJobAction(new ProxyReplacePostJobAction(resource, fileName, hash));
+        job->setPostJobAction(new IntraCacheReplacePostJobAction(resource, fileName, hash));
     } else {
         job->setPostJobAction(new ProxyFinalizePostJobAction(resource, fileName));
     }
     JOBS.add(job);
 }
 
+void ProxyManager::generateImageProxy(Mlt::Producer &producer, bool replace)
+{
+    // Always regenerate at the tier of the preview scaling
+    QString resource = ProxyManager::resource(producer);
+    QString hash = Util::getHash(producer);
+    QString fileName = ProxyManager::dir().filePath(hash + tierSuffix(resolution())
+                                                    + kProxyPendingImageExtension);
+
+    // Create the file to make it in progress
+    if (JOBS.targetIsInProgress(fileName) || !acquirePending(fileName))
+        return;
+
+    PostJobAction *action = nullptr;
+    if (replace) {
+        action = new ProxyReplacePostJobAction(resource, fileName, hash);
+    } else {
+        action = new ProxyFinalizePostJobAction(resource, fileName);
+    }
+    // The same decode gives the thumbnail of the first frame.
+    const auto thumbnailKey
+        = ThumbnailProvider::cacheKey(producer, producer.get("mlt_service"), resource, hash, 0);
+
+    // The images asked for in one turn of the event loop, such as a folder, make one job.
+    static QImageJob *batch = nullptr;
+    if (!batch) {
+        batch = new QImageJob(resolution());
+        batch->setBackground();
+        QTimer::singleShot(0, []() {
+            JOBS.add(batch);
+            batch = nullptr;
+        });
+    }
+    batch->addImage(fileName, resource, action, thumbnailKey);
+}
+
 typedef QPair<QString, QString> MltProperty;
 
+static void writeProperty(QXmlStreamWriter &newXml, const QString &name, const QString &value)
+{
+    newXml.writeStartElement("property");
+    newXml.writeAttribute("name", name);
+    newXml.writeCharacters(value);
+    newXml.writeEndElement();
+}
+
 static void processProperties(QXmlStreamWriter &newXml,
                               QVector<MltProperty> &properties,
                               const QString &root)
@@ -416,48 +606,35 @@ static void processProperties(QXmlStreamWriter &newXml,
             speed = p.second;
         }
     }
-    QVector<MltProperty> newProperties;
-    QVector<MltProperty> &propertiesRef = properties;
-    if (isProxy) {
-        // Filter the properties
-        for (const auto &p : properties) {
+    // Convert to relative
+    if (isProxy && !root.isEmpty() && newResource.startsWith(root))
+        newResource = newResource.mid(root.size());
+    // Write all of the property elements
+    for (const auto &p : properties) {
+        if (!isProxy) {
+            writeProperty(newXml, p.first, p.second);
+        } else if (p.first == "resource") {
             // Replace the resource property if proxy
-            if (p.first == "resource") {
-                // Convert to relative
-                if (!root.isEmpty() && newResource.startsWith(root)) {
-                    newResource = newResource.mid(root.size());
-                }
-                if (service == "timewarp") {
-                    newProperties << MltProperty(p.first,
-                                                 QStringLiteral("%1:%2").arg(speed, newResource));
-                } else {
-                    newProperties << MltProperty(p.first, newResource);
-                }
-            } else if (p.first == "warp_resource") {
-                newProperties << MltProperty(p.first, newResource);
-            } else if (p.first != kIsProxyProperty && p.first != kOriginalResourceProperty) {
-                // Remove special proxy and original resource properties
-                newProperties << MltProperty(p.first, p.second);
-            }
+            if (service == "timewarp")
+                writeProperty(newXml, p.first, QStringLiteral("%1:%2").arg(speed, newResource));
+            else
+                writeProperty(newXml, p.first, newResource);
+        } else if (p.first == "warp_resource") {
+            writeProperty(newXml, p.first, newResource);
+        } else if (p.first != kIsProxyProperty && p.first != kOriginalResourceProperty
+                   && p.first != kIntraCacheProperty && p.first != kMediaCacheProperty) {
+            // Remove special proxy and original resource properties
+            writeProperty(newXml, p.first, p.second);
         }
-        propertiesRef = newProperties;
-    }
-    // Write all of the property elements
-    for (const auto &p : propertiesRef) {
-        newXml.writeStartElement("property");
-        newXml.writeAttribute("name", p.first);
-        newXml.writeCharacters(p.second);
-        newXml.writeEndElement();
     }
-    // Reset the saved properties
+    // Reset the saved properties but keep their storage for the next element
     properties.clear();
 }
 
-bool ProxyManager::filterXML(QString &xmlString, QString root)
+// Copies the document from \a xml to \a newXml as it reads it. Only the properties of
+// the current element are held at once.
+static bool filterXML(QXmlStreamReader &xml, QXmlStreamWriter &newXml, QString root)
 {
-    QString output;
-    QXmlStreamReader xml(xmlString);
-    QXmlStreamWriter newXml(&output);
     bool isPropertyElement = false;
     QVector<MltProperty> properties;
 
@@ -467,9 +644,6 @@ bool ProxyManager::filterXML(QString &xmlString, QString root)
         root.append('/');
     }
 
-    newXml.setAutoFormatting(true);
-    newXml.setAutoFormattingIndent(2);
-
     while (!xml.atEnd()) {
         switch (xml.readNext()) {
         case QXmlStreamReader::Characters:
@@ -495,9 +669,8 @@ bool ProxyManager::filterXML(QString &xmlString, QString root)
         case QXmlStreamReader::EndDocument:
             newXml.writeEndDocument();
             break;
-        case QXmlStreamReader::StartElement: {
-            const QString element = xml.name().toString();
-            if (element == "property") {
+        case QXmlStreamReader::StartElement:
+            if (xml.name() == QLatin1String("property")) {
                 // Save each property element but do not output yet
                 const QString name = xml.attributes().value("name").toString();
                 properties << MltProperty(name, xml.readElementText());
@@ -507,16 +680,15 @@ bool ProxyManager::filterXML(QString &xmlString, QString root)
                 isPropertyElement = false;
                 processProperties(newXml, properties, root);
                 // Write the new start element
-                newXml.writeStartElement(xml.namespaceUri().toString(), element);
+                newXml.writeStartElement(xml.namespaceUri().toString(), xml.name().toString());
                 for (const auto &a : xml.attributes()) {
                     newXml.writeAttribute(a);
                 }
             }
             break;
-        }
         case QXmlStreamReader::EndElement:
             // At the end of a non-property element
-            if (xml.name().toString() != "property") {
+            if (xml.name() != QLatin1String("property")) {
                 processProperties(newXml, properties, root);
                 newXml.writeEndElement();
             }
@@ -525,23 +697,40 @@ bool ProxyManager::filterXML(QString &xmlString, QString root)
             break;
         }
     }
+    if (xml.hasError()) {
+        LOG_WARNING() << "failed to parse the MLT XML:" << xml.errorString() << "at line"
+                      << xml.lineNumber();
+        return false;
+    }
+    return !newXml.hasError();
+}
+
+bool ProxyManager::filterXML(QString &xmlString, QString root)
+{
+    QString output;
+    QXmlStreamReader xml(xmlString);
+    QXmlStreamWriter newXml(&output);
+
+    if (!::filterXML(xml, newXml, root))
+        return false;
 
     // Useful for debugging
     //    LOG_DEBUG() << output;
 
-    if (!xml.hasError()) {
-        xmlString = output;
-        return true;
-    }
-    return false;
+    xmlString = output;
+    return true;
+}
+
+bool ProxyManager::filterXML(const QString &xmlString, QString root, QIODevice *device)
+{
+    QXmlStreamReader xml(xmlString);
+    QXmlStreamWriter newXml(device);
+    return ::filterXML(xml, newXml, root);
 }
 
 bool ProxyManager::fileExists(Mlt::Producer &producer)
 {
-    QDir proxyDir(Settings.proxyFolder());
-    QDir projectDir(MLT.projectFolder());
     QString service = QString::fromLatin1(producer.get("mlt_service"));
-    QString fileName;
     if (service.startsWith("avformat")) {
         if (QFile::exists(GoProProxyFilePath(producer.get("resource")))) {
             return true;
@@ -549,14 +738,117 @@ bool ProxyManager::fileExists(Mlt::Producer &producer)
         if (QFile::exists(DJIProxyFilePath(producer.get("resource")))) {
             return true;
         }
-        fileName = Util::getHash(producer) + kProxyVideoExtension;
+        return !existingFile(Util::getHash(producer), kProxyVideoExtension, MLT.projectFolder())
+                    .isEmpty();
     } else if (isValidImage(producer)) {
-        fileName = Util::getHash(producer) + kProxyImageExtension;
-    } else {
-        return false;
+        return !existingFile(Util::getHash(producer), kProxyImageExtension, MLT.projectFolder())
+                    .isEmpty();
+    }
+    return false;
+}
+
+QStringList ProxyManager::fileNames(const QString &hash, const QString &extension)
+{
+    // The tier of the preview, the proxy from before the tiers, then the
+    // nearest tiers, the higher first.
+    const int tier = resolution();
+    QStringList result{hash + tierSuffix(tier) + extension, hash + extension};
+    auto tiers = kProxyTiers;
+    std::sort(tiers.begin(), tiers.end(), [=](int a, int b) {
+        return qAbs(a - tier) != qAbs(b - tier) ? qAbs(a - tier) < qAbs(b - tier) : a > b;
+    });
+    for (int other : tiers) {
+        if (other != tier)
+            result << hash + tierSuffix(other) + extension;
+    }
+    return result;
+}
+
+QString ProxyManager::existingFile(const QString &hash,
+                                   const QString &extension,
+                                   const QString &projectFolder)
+{
+    QDir projectDir(projectFolder);
+    const bool hasProjectDir = !projectFolder.isEmpty() && projectDir.cd(kProxySubfolder);
+    const QDir proxyDir(Settings.proxyFolder());
+    for (const auto &fileName : fileNames(hash, extension)) {
+        if (hasProjectDir && projectDir.exists(fileName))
+            return projectDir.filePath(fileName);
+        if (proxyDir.exists(fileName))
+            return proxyDir.filePath(fileName);
+    }
+    return QString();
+}
+
+QString ProxyManager::existingIntraCacheFile(const QString &hash, const QString &projectFolder)
+{
+    const QString fileName = hash + kIntraCacheSuffix + kIntraCacheExtension;
+    QDir projectDir(projectFolder);
+    if (!projectFolder.isEmpty() && projectDir.cd(kProxySubfolder) && projectDir.exists(fileName))
+        return projectDir.filePath(fileName);
+    const QDir proxyDir(Settings.proxyFolder());
+    if (proxyDir.exists(fileName))
+        return proxyDir.filePath(fileName);
+    return QString();
+}
+
+void ProxyManager::applyIntraCache(QDomDocument &dom)
+{
+    for (const auto tag : {"producer", "chain"}) {
+        const auto elements = dom.elementsByTagName(tag);
+        for (int i = 0; i < elements.length(); ++i) {
+            QHash<QString, QDomElement> properties;
+            for (auto e = elements.item(i).firstChildElement("property"); !e.isNull();
+                 e = e.nextSiblingElement("property")) {
+                properties.insert(e.attribute("name"), e);
+            }
+            if (properties.value("mlt_service").text() != "timewarp"
+                || !properties.contains("warp_speed") || !properties.contains("warp_resource"))
+                continue;
+            const auto fileName
+                = existingIntraCacheFile(properties.value(kShotcutHashProperty).text(),
+                                         MLT.projectFolder());
+            if (fileName.isEmpty())
+                continue;
+            auto replaceText = [&](const QString &name, const QString &text) {
+                auto element = properties.value(name);
+                while (element.hasChildNodes())
+                    element.removeChild(element.firstChild());
+                element.appendChild(dom.createTextNode(text));
+            };
+            LOG_DEBUG() << "exporting" << properties.value("warp_resource").text() << "from"
+                        << fileName;
+            replaceText("warp_resource", fileName);
+            if (properties.contains("resource")) {
+                replaceText("resource",
+                            QStringLiteral("%1:%2").arg(properties.value("warp_speed").text(),
+                                                        fileName));
+            }
+        }
+    }
+}
+
+bool ProxyManager::isTierFile(const QString &fileName)
+{
+    const auto suffix = tierSuffix(resolution());
+    const QFileInfo info(fileName);
+    return info.completeBaseName().endsWith(suffix);
+}
+
+void ProxyManager::removeFiles(const QString &hash, bool isImage)
+{
+    QDir dir = ProxyManager::dir();
+    const QString extension = isImage ? kProxyImageExtension : kProxyVideoExtension;
+    const QString pending = isImage ? kProxyPendingImageExtension : kProxyPendingVideoExtension;
+    QStringList fileNames{hash + extension, hash + pending};
+    for (int tier : kProxyTiers)
+        fileNames << hash + tierSuffix(tier) + extension << hash + tierSuffix(tier) + pending;
+    for (const auto &fileName : std::as_const(fileNames)) {
+        if (dir.exists(fileName)) {
+            LOG_DEBUG() << "removing" << dir.filePath(fileName);
+            dir.remove(fileName);
+        }
     }
-    return (projectDir.cd(kProxySubfolder) && projectDir.exists(fileName))
-           || proxyDir.exists(fileName);
 }
 
 bool ProxyManager::filePending(Mlt::Producer &producer)
@@ -566,14 +858,16 @@ bool ProxyManager::filePending(Mlt::Producer &producer)
     QString service = QString::fromLatin1(producer.get("mlt_service"));
     QString fileName;
     if (service.startsWith("avformat")) {
-        fileName = Util::getHash(producer) + kProxyPendingVideoExtension;
+        fileName = Util::getHash(producer) + tierSuffix(resolution())
+                   + kProxyPendingVideoExtension;
     } else if (isValidImage(producer)) {
-        fileName = Util::getHash(producer) + kProxyPendingImageExtension;
+        fileName = Util::getHash(producer) + tierSuffix(resolution())
+                   + kProxyPendingImageExtension;
     } else {
         return false;
     }
-    return (projectDir.cd(kProxySubfolder) && projectDir.exists(fileName))
-           || proxyDir.exists(fileName);
+    return (projectDir.cd(kProxySubfolder) && isLeaseHeld(projectDir.filePath(fileName)))
+           || isLeaseHeld(proxyDir.filePath(fileName));
 }
 
 bool ProxyManager::isValidImage(Mlt::Producer &producer)
@@ -622,17 +916,20 @@ bool ProxyManager::isValidVideo(Mlt::Producer producer)
 // Returns true if the producer exists and was updated with proxy info
 bool ProxyManager::generateIfNotExists(Mlt::Producer &producer, bool replace)
 {
+    if (producer.is_valid() && Util::ProducerIsTimewarp(&producer))
+        return generateIntraCacheIfNotExists(producer, replace);
     if (Settings.proxyEnabled() && producer.is_valid() && !producer.get_int(kDisableProxyProperty)
         && !producer.get_int(kIsProxyProperty)) {
         if (ProxyManager::fileExists(producer)) {
             QString service = QString::fromLatin1(producer.get("mlt_service"));
-            QDir projectDir(MLT.projectFolder());
-            QString fileName = Util::getHash(producer) + kProxyVideoExtension;
-            QDir proxyDir(Settings.proxyFolder());
+            QString fileName;
             if (service.startsWith("avformat")) {
+                fileName = existingFile(Util::getHash(producer),
+                                        kProxyVideoExtension,
+                                        MLT.projectFolder());
                 auto gopro = GoProProxyFilePath(producer.get("resource"));
                 auto dji = DJIProxyFilePath(producer.get("resource"));
-                if (!projectDir.exists(fileName) && !proxyDir.exists(fileName)) {
+                if (fileName.isEmpty()) {
                     if (QFile::exists(gopro)) {
                         producer.set(kIsProxyProperty, 1);
                         producer.set(kMetaProxyProperty, 1);
@@ -648,50 +945,91 @@ bool ProxyManager::generateIfNotExists(Mlt::Producer &producer, bool replace)
                     }
                 }
             } else if (isValidImage(producer)) {
-                fileName = Util::getHash(producer) + kProxyImageExtension;
-            } else {
-                return false;
+                fileName = existingFile(Util::getHash(producer),
+                                        kProxyImageExtension,
+                                        MLT.projectFolder());
             }
+            if (fileName.isEmpty())
+                return generateMediaCacheIfNotExists(producer);
+            // Use another tier until the one for the preview is made.
+            if (!isTierFile(fileName))
+                generate(producer, replace);
             producer.set(kIsProxyProperty, 1);
             producer.set(kMetaProxyProperty, 1);
             producer.set(kOriginalResourceProperty, producer.get("resource"));
-            if (projectDir.exists(fileName)) {
-                ::utime(projectDir.filePath(fileName).toUtf8().constData(), nullptr);
-                producer.set("resource", projectDir.filePath(fileName).toUtf8().constData());
-            } else {
-                ::utime(proxyDir.filePath(fileName).toUtf8().constData(), nullptr);
-                producer.set("resource", proxyDir.filePath(fileName).toUtf8().constData());
-            }
+            ::utime(fileName.toUtf8().constData(), nullptr);
+            producer.set("resource", fileName.toUtf8().constData());
             return true;
-        } else if (!filePending(producer)) {
-            if (isValidVideo(producer)) {
-                // Tag this producer so we do not try to generate proxy again in this session
-                delete producer.get_frame();
-                auto threshold = qRound(kProxyResolutionRatio * resolution());
-                LOG_DEBUG() << producer.get_int("meta.media.width") << "x"
-                            << producer.get_int("meta.media.height") << "threshold" << threshold;
-                if (producer.get_int("meta.media.width") > threshold
-                    && producer.get_int("meta.media.height") > threshold) {
-                    ProxyManager::generateVideoProxy(producer,
-                                                     MLT.fullRange(producer),
-                                                     Automatic,
-                                                     QPoint(),
-                                                     replace);
-                }
-            } else if (isValidImage(producer)) {
-                // Tag this producer so we do not try to generate proxy again in this session
-                delete producer.get_frame();
-                auto threshold = qRound(kProxyResolutionRatio * resolution());
-                LOG_DEBUG() << producer.get_int("meta.media.width") << "x"
-                            << producer.get_int("meta.media.height") << "threshold" << threshold;
-                if (producer.get_int("meta.media.width") > threshold
-                    && producer.get_int("meta.media.height") > threshold) {
-                    ProxyManager::generateImageProxy(producer, replace);
-                }
-            }
+        }
+        generate(producer, replace);
+    }
+    return generateMediaCacheIfNotExists(producer);
+}
+
+bool ProxyManager::generateIntraCacheIfNotExists(Mlt::Producer &producer, bool replace)
+{
+    // A timewarp of a proxy is already fast since every proxy frame is a key frame.
+    if (!Settings.proxyIntraCache() || producer.get_int(kDisableProxyProperty)
+        || producer.get_int(kIsProxyProperty) || !producer.get("warp_resource"))
+        return false;
+    const QString hash = Util::getHash(producer);
+    const QString fileName = existingIntraCacheFile(hash, MLT.projectFolder());
+    if (fileName.isEmpty()) {
+        QDir proxyDir(Settings.proxyFolder());
+        QDir projectDir(MLT.projectFolder());
+        const QString pending = hash + kIntraCacheSuffix + kIntraCachePendingExtension;
+        if ((!MLT.projectFolder().isEmpty() && projectDir.cd(kProxySubfolder)
+             && isLeaseHeld(projectDir.filePath(pending)))
+            || isLeaseHeld(proxyDir.filePath(pending)))
+            return false;
+        Mlt::Producer original(MLT.profile(), producer.get("warp_resource"));
+        if (isValidVideo(original)) {
+            // Keep the hash so that the replacement finds the clips.
+            original.set(kShotcutHashProperty, hash.toUtf8().constData());
+            generateIntraCache(original, replace);
+        }
+        return false;
+    }
+    const auto resource = QStringLiteral("%1:%2").arg(producer.get("warp_speed"), fileName);
+    producer.set(kIsProxyProperty, 1);
+    producer.set(kMetaProxyProperty, 1);
+    producer.set(kIntraCacheProperty, 1);
+    producer.set(kOriginalResourceProperty, producer.get("warp_resource"));
+    ::utime(fileName.toUtf8().constData(), nullptr);
+    producer.set("resource", resource.toUtf8().constData());
+    producer.set("warp_resource", fileName.toUtf8().constData());
+    return true;
+}
+
+void ProxyManager::generate(Mlt::Producer &producer, bool replace)
+{
+    if (filePending(producer))
+        return;
+    if (isValidVideo(producer)) {
+        // Tag this producer so we do not try to generate proxy again in this session
+        delete producer.get_frame();
+        auto threshold = qRound(kProxyResolutionRatio * resolution());
+        LOG_DEBUG() << producer.get_int("meta.media.width") << "x"
+                    << producer.get_int("meta.media.height") << "threshold" << threshold;
+        if (producer.get_int("meta.media.width") > threshold
+            && producer.get_int("meta.media.height") > threshold) {
+            ProxyManager::generateVideoProxy(producer,
+                                             MLT.fullRange(producer),
+                                             Automatic,
+                                             QPoint(),
+                                             replace);
+        }
+    } else if (isValidImage(producer)) {
+        // Tag this producer so we do not try to generate proxy again in this session
+        delete producer.get_frame();
+        auto threshold = qRound(kProxyResolutionRatio * resolution());
+        LOG_DEBUG() << producer.get_int("meta.media.width") << "x"
+                    << producer.get_int("meta.media.height") << "threshold" << threshold;
+        if (producer.get_int("meta.media.width") > threshold
+            && producer.get_int("meta.media.height") > threshold) {
+            ProxyManager::generateImageProxy(producer, replace);
         }
     }
-    return false;
 }
 
 const char *ProxyManager::videoFilenameExtension()
@@ -716,7 +1054,8 @@ const char *ProxyManager::pendingImageExtension()
 
 int ProxyManager::resolution()
 {
-    return Settings.playerPreviewScale() ? Settings.playerPreviewScale() : kFallbackProxyResolution;
+    const int tier = proxyTier.load(std::memory_order_relaxed);
+    return tier ? tier : baseTier();
 }
 
 class FindNonProxyProducersParser : public Mlt::Parser
@@ -724,10 +1063,12 @@ class FindNonProxyProducersParser : public Mlt::Parser
 private:
     QString m_hash;
     QList<Mlt::Producer> m_producers;
+    bool m_withProxies;
 
 public:
-    FindNonProxyProducersParser()
+    explicit FindNonProxyProducersParser(bool withProxies = false)
         : Mlt::Parser()
+        , m_withProxies(withProxies)
     {}
 
     QList<Mlt::Producer> &producers() { return m_producers; }
@@ -735,7 +1076,7 @@ public:
     int on_start_filter(Mlt::Filter *) { return 0; }
     int on_start_producer(Mlt::Producer *producer)
     {
-        if (!producer->parent().get_int(kIsProxyProperty))
+        if (m_withProxies || !producer->parent().get_int(kIsProxyProperty))
             m_producers << Mlt::Producer(producer);
         return 0;
     }
@@ -753,7 +1094,7 @@ public:
     int on_end_transition(Mlt::Transition *) { return 0; }
     int on_start_chain(Mlt::Chain *chain)
     {
-        if (!chain->parent().get_int(kIsProxyProperty))
+        if (m_withProxies || !chain->parent().get_int(kIsProxyProperty))
             m_producers << Mlt::Producer(chain);
         return 0;
     }
@@ -762,15 +1103,226 @@ public:
     int on_end_link(Mlt::Link *) { return 0; }
 };
 
-void ProxyManager::generateIfNotExistsAll(Mlt::Producer &producer)
+void ProxyManager::updateTier()
+{
+    int tier = baseTier();
+    // Many tracks decode at once, so each gets fewer pixels.
+    const int index = kProxyTiers.indexOf(tier);
+    if (index > 0 && visibleVideoTrackCount() > kManyVideoTracks)
+        tier = kProxyTiers[index - 1];
+    if (proxyTier.exchange(tier) == tier)
+        return;
+    LOG_INFO() << "proxy tier" << tier;
+    if (!Settings.proxyEnabled() || !MLT.producer() || !MLT.producer()->is_valid())
+        return;
+
+    // Switch the proxies to the new tier, or make it for those without it.
+    FindNonProxyProducersParser parser(true);
+    if (MAIN.multitrack() && MAIN.multitrack()->is_valid())
+        parser.start(*MAIN.multitrack());
+    else
+        parser.start(*MLT.producer());
+    QSet<QString> hashes;
+    for (auto &clip : parser.producers()) {
+        Mlt::Producer parent = clip.parent();
+        if (!parent.get_int(kIsProxyProperty) || !parent.get(kOriginalResourceProperty))
+            continue;
+        const auto hash = Util::getHash(parent);
+        if (hashes.contains(hash))
+            continue;
+        hashes.insert(hash);
+        const auto service = QString::fromLatin1(parent.get("mlt_service"));
+        const bool isImage = service == "qimage" || service == "pixbuf";
+        if (!isImage && !service.startsWith("avformat"))
+            continue;
+        const auto fileName = existingFile(hash,
+                                           isImage ? kProxyImageExtension : kProxyVideoExtension,
+                                           MLT.projectFolder());
+        const auto resource = QString::fromUtf8(parent.get(kOriginalResourceProperty));
+        if (isTierFile(fileName)) {
+            if (fileName == QString::fromUtf8(parent.get("resource")))
+                continue;
+            Mlt::Producer newProducer(MLT.profile(), fileName.toUtf8().constData());
+            if (newProducer.is_valid()) {
+                Mlt::Producer *producer = MLT.setupNewProducer(&newProducer);
+                producer->set(kIsProxyProperty, 1);
+                producer->set(kOriginalResourceProperty, resource.toUtf8().constData());
+                MAIN.replaceAllByHash(hash, *producer, true);
+                delete producer;
+            }
+        } else {
+            Mlt::Producer original(MLT.profile(), resource.toUtf8().constData());
+            if (original.is_valid()) {
+                original.set(kShotcutHashProperty, hash.toUtf8().constData());
+                generate(original, true);
+            }
+        }
+    }
+}
+
+// Sorts the clips of a timeline by their distance from the position.
+static void sortByDistance(Mlt::Producer &producer, QList<Mlt::Producer> &producers, int position)
+{
+    if (position < 0 || producer.type() != mlt_service_tractor_type)
+        return;
+    QHash<QString, int> distances;
+    Mlt::Tractor tractor(producer);
+    for (int i = 0; i < tractor.count(); ++i) {
+        std::unique_ptr<Mlt::Producer> track(tractor.track(i));
+        if (!track || !track->is_valid())
+            continue;
+        Mlt::Playlist playlist(*track);
+        for (int j = 0; j < playlist.count(); ++j) {
+            std::unique_ptr<Mlt::ClipInfo> info(playlist.clip_info(j));
+            if (!info || !info->producer || playlist.is_blank(j))
+                continue;
+            const int end = info->start + info->frame_count;
+            const int distance = position < info->start ? info->start - position
+                                 : position >= end      ? position - end + 1
+                                                        : 0;
+            const QString resource = ProxyManager::resource(*info->producer);
+            auto it = distances.find(resource);
+            if (it == distances.end())
+                distances.insert(resource, distance);
+            else if (distance < it.value())
+                it.value() = distance;
+        }
+    }
+    std::stable_sort(producers.begin(),
+                     producers.end(),
+                     [&](Mlt::Producer &a, Mlt::Producer &b) {
+                         Mlt::Producer parentA = a.parent();
+                         Mlt::Producer parentB = b.parent();
+                         return distances.value(ProxyManager::resource(parentA),
+                                                std::numeric_limits<int>::max())
+                                < distances.value(ProxyManager::resource(parentB),
+                                                  std::numeric_limits<int>::max());
+                     });
+}
+
+void ProxyManager::generateIfNotExistsAll(Mlt::Producer &producer, int position)
 {
     FindNonProxyProducersParser parser;
     parser.start(producer);
-    for (auto &clip : parser.producers()) {
+    auto &producers = parser.producers();
+    sortByDistance(producer, producers, position);
+    for (auto &clip : producers) {
         generateIfNotExists(clip, false /* replace */);
     }
 }
 
+bool ProxyManager::isRemote(const QString &resource)
+{
+    const QUrl url(resource);
+    if (kRemoteSchemes.contains(url.scheme().toLower()))
+        return true;
+    return !resource.isEmpty() && QFileInfo(resource).isAbsolute()
+           && Util::isNetworkStorage(resource);
+}
+
+QDir ProxyManager::mediaCacheDir()
+{
+    QDir dir(Settings.appDataLocation());
+    if (!dir.cd(kMediaCacheSubfolder)) {
+        if (dir.mkpath(kMediaCacheSubfolder))
+            dir.cd(kMediaCacheSubfolder);
+    }
+    return dir;
+}
+
+QString ProxyManager::mediaCacheFile(const QString &resource)
+{
+    // Keep the suffix so that MLT picks the same producer for the copy.
+    const QUrl url(resource);
+    const auto suffix = QFileInfo(url.scheme().size() > 1 ? url.path() : resource).suffix();
+    auto name = QString::fromLatin1(
+        QCryptographicHash::hash(resource.toUtf8(), QCryptographicHash::Sha1).toHex());
+    if (!suffix.isEmpty())
+        name += '.' + suffix;
+    return mediaCacheDir().filePath(name);
+}
+
+void ProxyManager::generateMediaCache(Mlt::Producer &producer)
+{
+    const QString resource = QString::fromUtf8(producer.get("resource"));
+    const QString fileName = mediaCacheFile(resource);
+    if (JOBS.targetIsInProgress(fileName))
+        return;
+    AbstractJob *job = nullptr;
+    if (QFileInfo(resource).isAbsolute())
+        job = new CopyJob(resource, fileName);
+    else
+        job = new DownloadJob(resource, fileName);
+    job->setLabel(QObject::tr("Cache %1").arg(Util::baseName(resource)));
+    job->setBackground();
+    job->setPostJobAction(
+        new MediaCacheReplacePostJobAction(resource, fileName, Util::getHash(producer)));
+    JOBS.add(job);
+}
+
+bool ProxyManager::generateMediaCacheIfNotExists(Mlt::Producer &producer)
+{
+    if (!Settings.proxyMediaCache() || !producer.is_valid()
+        || producer.get_int(kDisableProxyProperty) || producer.get_int(kIsProxyProperty)
+        || !QString::fromLatin1(producer.get("mlt_service")).startsWith("avformat"))
+        return false;
+    const QString resource = QString::fromUtf8(producer.get("resource"));
+    if (!isRemote(resource))
+        return false;
+    const QString fileName = mediaCacheFile(resource);
+    if (!QFile::exists(fileName)) {
+        generateMediaCache(producer);
+        return false;
+    }
+    producer.set(kIsProxyProperty, 1);
+    producer.set(kMediaCacheProperty, 1);
+    producer.set(kOriginalResourceProperty, resource.toUtf8().constData());
+    // The modification time orders the copies for trimMediaCache().
+    ::utime(fileName.toUtf8().constData(), nullptr);
+    producer.set("resource", fileName.toUtf8().constData());
+    return true;
+}
+
+void ProxyManager::generateMediaCacheIfNotExistsAll(Mlt::Producer &producer, int position)
+{
+    if (!Settings.proxyMediaCache())
+        return;
+    FindNonProxyProducersParser parser;
+    parser.start(producer);
+    auto &producers = parser.producers();
+    sortByDistance(producer, producers, position);
+    for (auto &clip : producers) {
+        Mlt::Producer parent = clip.parent();
+        const QString resource = QString::fromUtf8(parent.get("resource"));
+        if (!parent.get_int(kDisableProxyProperty)
+            && QString::fromLatin1(parent.get("mlt_service")).startsWith("avformat")
+            && isRemote(resource) && !QFile::exists(mediaCacheFile(resource)))
+            generateMediaCache(parent);
+    }
+}
+
+void ProxyManager::trimMediaCache(const QString &fileNameToKeep)
+{
+    const qint64 limit = qint64(Settings.proxyMediaCacheGB()) * 1024 * 1024 * 1024;
+    // The oldest first
+    const auto infos = mediaCacheDir().entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+    qint64 total = 0;
+    for (const auto &info : infos)
+        total += info.size();
+    for (const auto &info : infos) {
+        if (total <= limit)
+            break;
+        // Skip the copies being made.
+        if (info.fileName().contains(".tmp") || info.filePath() == fileNameToKeep)
+            continue;
+        const auto size = info.size();
+        if (QFile::remove(info.filePath())) {
+            LOG_INFO() << "removed from the media cache" << info.filePath();
+            total -= size;
+        }
+    }
+}
+
 bool ProxyManager::removePending()
 {
     bool foundAny = false;
@@ -784,8 +1336,12 @@ bool ProxyManager::removePending()
         dir.setNameFilters(QStringList() << "*.pending.*");
         dir.setFilter(QDir::Files | QDir::NoDotAndDotDot | QDir::Writable);
         for (const auto &s : dir.entryList()) {
-            LOG_INFO() << "removing" << dir.filePath(s);
-            foundAny |= QFile::remove(dir.filePath(s));
+            // Keep what a job here or on another computer is still making.
+            const auto fileName = dir.filePath(s);
+            if (JOBS.targetIsInProgress(fileName) || isLeaseHeld(fileName))
+                continue;
+            LOG_INFO() << "removing" << fileName;
+            foundAny |= QFile::remove(fileName);
         }
     }
     //TODO if any pending remove, let user know and offer to regenerate?
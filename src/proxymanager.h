@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2021 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,16 +21,42 @@
 #include <QDir>
 #include <QPoint>
 #include <QString>
+#include <QStringList>
+
+class QDomDocument;
+class QIODevice;
 
 namespace Mlt {
 class Producer;
 class Service;
 } // namespace Mlt
 
+/*!
+  \class ProxyManager
+  \brief Makes the proxies of media files and swaps them in and out.
+
+  Video and image proxies come in tiers of 270, 540 and 1080 lines, named
+  with the tier after the hash. The tier follows the preview scaling and
+  drops one step when many video tracks are visible. When only another tier
+  exists, it is used while the one for the preview is made in the background.
+
+  Timewarp producers, above all reverse ones, seek back to a key frame for
+  almost every frame of a long GOP source. Those without a proxy get an
+  intra-frame cache of their source at full resolution instead, which stands
+  in for the source during playback. Export uses the source unless the user
+  opts in to the cache.
+
+  Media on a web server or a network share can be copied to a local media
+  cache with a size limit, removing the files used least recently first. The
+  copy stands in for the original like a proxy, with the same resolution.
+*/
+
 class ProxyManager
 {
 private:
     ProxyManager(){};
+    static void generate(Mlt::Producer &producer, bool replace);
+    static void generateMediaCache(Mlt::Producer &producer);
 
 public:
     enum ScanMode { Automatic, Progressive, InterlacedTopFieldFirst, InterlacedBottomFieldFirst };
@@ -42,19 +68,60 @@ public:
                                    ScanMode scanMode = Automatic,
                                    const QPoint &aspectRatio = QPoint(),
                                    bool replace = true);
+    //! Queues the intra-frame cache of the source \a producer of a timewarp.
+    static void generateIntraCache(Mlt::Producer &producer, bool replace = true);
+    //! Queues an image proxy; those queued in one turn of the event loop make one job.
     static void generateImageProxy(Mlt::Producer &producer, bool replace = true);
+    //! Replaces the proxies in \a xml with their original resources; false if it is invalid.
     static bool filterXML(QString &xml, QString root);
+    /*!
+      Like filterXML() above but encodes the result as UTF-8 into \a device as it
+      parses \a xml instead of building a second copy of the document. Returns false
+      if \a xml is invalid or the writing failed; \a device may then hold a part of it.
+    */
+    static bool filterXML(const QString &xml, QString root, QIODevice *device);
     static bool fileExists(Mlt::Producer &producer);
+    //! Returns the proxy file names of \a hash to look for, the best first.
+    static QStringList fileNames(const QString &hash, const QString &extension);
+    //! Returns the path of the best proxy of \a hash that exists, or empty if none.
+    static QString existingFile(const QString &hash,
+                                const QString &extension,
+                                const QString &projectFolder);
+    //! Returns the path of the intra-frame cache of \a hash, or empty if none.
+    static QString existingIntraCacheFile(const QString &hash, const QString &projectFolder);
+    //! Points the timewarp producers of an export at their intra-frame caches.
+    static void applyIntraCache(QDomDocument &dom);
+    //! Returns whether \a fileName is a proxy of the tier for the preview.
+    static bool isTierFile(const QString &fileName);
+    //! Removes the proxies of \a hash in every tier and those being made.
+    static void removeFiles(const QString &hash, bool isImage);
     static bool filePending(Mlt::Producer &producer);
     static bool isValidImage(Mlt::Producer &producer);
     static bool isValidVideo(Mlt::Producer producer);
     static bool generateIfNotExists(Mlt::Producer &producer, bool replace = true);
+    //! Returns true if the timewarp \a producer now uses its intra-frame cache.
+    static bool generateIntraCacheIfNotExists(Mlt::Producer &producer, bool replace = true);
     static const char *videoFilenameExtension();
     static const char *pendingVideoExtension();
     static const char *imageFilenameExtension();
     static const char *pendingImageExtension();
+    //! Returns the height of the proxy tier for the preview.
     static int resolution();
-    static void generateIfNotExistsAll(Mlt::Producer &producer);
+    //! Selects the tier again and switches the proxies of the project to it.
+    static void updateTier();
+    //! Queues the missing proxies, those nearest \a position on a timeline first.
+    static void generateIfNotExistsAll(Mlt::Producer &producer, int position = -1);
+    //! Returns whether \a resource is a URL or on a network share.
+    static bool isRemote(const QString &resource);
+    static QDir mediaCacheDir();
+    //! Returns the path of the local copy of \a resource, whether or not it exists.
+    static QString mediaCacheFile(const QString &resource);
+    //! Returns true if the remote \a producer now uses its local copy.
+    static bool generateMediaCacheIfNotExists(Mlt::Producer &producer);
+    //! Queues the missing local copies, those nearest \a position on a timeline first.
+    static void generateMediaCacheIfNotExistsAll(Mlt::Producer &producer, int position = -1);
+    //! Removes the local copies used least recently until the cache fits its size.
+    static void trimMediaCache(const QString &fileNameToKeep = QString());
     static bool removePending();
     static QString GoProProxyFilePath(const QString &resource);
     static QString DJIProxyFilePath(const QString &resource);
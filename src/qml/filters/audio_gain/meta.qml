@@ -11,6 +11,9 @@ Metadata {
     qml: "ui.qml"
     icon: 'qrc:///icons/oxygen/32x32/status/audio-volume-high.png'
     isFavorite: true
+    identity: {
+        "level": 0
+    }
 
     keyframes {
         allowAnimateIn: true
@@ -9,6 +9,9 @@ Metadata {
     qml: "ui.qml"
     icon: 'icon.webp'
     isFavorite: true
+    identity: {
+        "level": 1
+    }
     gpuAlt: "movit.opacity"
 
     keyframes {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2023 Meltytech, LLC
+ * Copyright (c) 2019-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -173,7 +173,6 @@ Shotcut.KeyframableFilter {
 
     function applyTracking(motionTrackerRow, frame) {
         const data = motionTrackerModel.trackingData(motionTrackerRow);
-        let previous = null;
         let interval = motionTrackerModel.keyframeIntervalFrames(motionTrackerRow);
         let interpolation = Shotcut.KeyframesModel.SmoothNaturalInterpolation;
         filter.blockSignals = true;
@@ -193,31 +192,44 @@ Shotcut.KeyframableFilter {
                 });
             }
         }
+        // The keyframes are written together, so offset from the first position.
+        let first = null;
+        const properties = [corner1xProperty, corner1yProperty, corner2xProperty, corner2yProperty, corner3xProperty, corner3yProperty, corner4xProperty, corner4yProperty];
+        let keyframes = properties.map(() => []);
+        let cornerKeyframes = cornerProperties.map(() => []);
         data.forEach(i => {
             let xCorners = [filter.getDouble(corner1xProperty, frame), filter.getDouble(corner2xProperty, frame), filter.getDouble(corner3xProperty, frame), filter.getDouble(corner4xProperty, frame)];
             let yCorners = [filter.getDouble(corner1yProperty, frame), filter.getDouble(corner2yProperty, frame), filter.getDouble(corner3yProperty, frame), filter.getDouble(corner4yProperty, frame)];
-            let x = 0;
-            let y = 0;
-            if (previous !== null) {
-                x = (i.x - previous.x) / profile.width / 3;
-                y = (i.y - previous.y) / profile.height / 3;
-            }
+            if (first === null)
+                first = i;
+            let x = (i.x - first.x) / profile.width / 3;
+            let y = (i.y - first.y) / profile.height / 3;
             for (let j in xCorners) {
                 xCorners[j] += x;
                 yCorners[j] += y;
-                filter.set(cornerProperties[j], Qt.rect(xCorners[j], yCorners[j], 0, 0), frame);
+                cornerKeyframes[j].push({
+                        "position": frame,
+                        "value": Qt.rect(xCorners[j], yCorners[j], 0, 0)
+                    });
+                keyframes[2 * j].push({
+                        "position": frame,
+                        "value": xCorners[j],
+                        "type": interpolation
+                    });
+                keyframes[2 * j + 1].push({
+                        "position": frame,
+                        "value": yCorners[j],
+                        "type": interpolation
+                    });
             }
-            filter.set(corner1xProperty, xCorners[0], frame, interpolation);
-            filter.set(corner1yProperty, yCorners[0], frame, interpolation);
-            filter.set(corner2xProperty, xCorners[1], frame, interpolation);
-            filter.set(corner2yProperty, yCorners[1], frame, interpolation);
-            filter.set(corner3xProperty, xCorners[2], frame, interpolation);
-            filter.set(corner3yProperty, yCorners[2], frame, interpolation);
-            filter.set(corner4xProperty, xCorners[3], frame, interpolation);
-            filter.set(corner4yProperty, yCorners[3], frame, interpolation);
-            previous = i;
             frame += interval;
         });
+        filter.startUndoParameterCommand(qsTr('Apply tracking'));
+        for (let j in cornerProperties)
+            filter.setKeyframes(cornerProperties[j], cornerKeyframes[j]);
+        for (let j in properties)
+            filter.setKeyframes(properties[j], keyframes[j]);
+        filter.endUndoCommand();
         filter.blockSignals = false;
         filter.changed();
         filter.animateInChanged();
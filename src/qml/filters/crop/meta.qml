@@ -11,4 +11,11 @@ Metadata {
     gpuAlt: "movit.crop"
     allowMultiple: false
     isClipOnly: true
+    identity: {
+        "left": 0,
+        "right": 0,
+        "top": 0,
+        "bottom": 0,
+        "center": 0
+    }
 }
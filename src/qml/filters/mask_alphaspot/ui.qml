@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2017-2023 Meltytech, LLC
+ * Copyright (c) 2017-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -205,7 +205,6 @@ Item {
 
     function applyTracking(motionTrackerRow, operation, frame) {
         const data = motionTrackerModel.trackingData(motionTrackerRow);
-        let previous = null;
         let interval = motionTrackerModel.keyframeIntervalFrames(motionTrackerRow);
         let interpolation = Shotcut.KeyframesModel.SmoothNaturalInterpolation;
         filter.blockSignals = true;
@@ -227,43 +226,49 @@ Item {
                 filter.set(rectProperty, filter.getRect('shotcut:backup.rect'));
             }
         }
-        filterRect = filter.getRect(rectProperty, frame);
+        // The keyframes are written together, so offset from the first position.
+        let first = null;
+        const startRect = filter.getRect(rectProperty, frame);
+        const properties = [paramHorizontal, paramVertical, paramWidth, paramHeight, rectProperty];
+        let keyframes = properties.map(() => []);
+        const addKeyframe = (property, value) => {
+            keyframes[properties.indexOf(property)].push({
+                    "position": frame,
+                    "value": value,
+                    "type": interpolation
+                });
+        };
         data.forEach(i => {
             let current = Qt.rect(filter.getDouble(paramHorizontal, frame), filter.getDouble(paramVertical, frame), filter.getDouble(paramWidth, frame), filter.getDouble(paramHeight, frame));
-            let x = 0;
-            let y = 0;
-            if (previous !== null) {
-                x = i.x - previous.x;
-                y = i.y - previous.y;
-            }
+            if (first === null)
+                first = i;
+            let x = i.x - first.x;
+            let y = i.y - first.y;
             switch (operation) {
             case 'relativePos':
                 current.x += x / profile.width;
                 current.y += y / profile.height;
-                filter.set(paramHorizontal, current.x, frame, interpolation);
-                filter.set(paramVertical, current.y, frame, interpolation);
-                filterRect.x += x;
-                filterRect.y += y;
-                filter.set(rectProperty, filterRect, frame, interpolation);
+                addKeyframe(paramHorizontal, current.x);
+                addKeyframe(paramVertical, current.y);
+                filterRect = Qt.rect(startRect.x + x, startRect.y + y, startRect.width, startRect.height);
+                addKeyframe(rectProperty, filterRect);
                 break;
             case 'offsetPos':
                 current.x -= x / profile.width;
                 current.y -= y / profile.height;
-                filter.set(paramHorizontal, current.x, frame, interpolation);
-                filter.set(paramVertical, current.y, frame, interpolation);
-                filterRect.x -= x;
-                filterRect.y -= y;
-                filter.set(rectProperty, filterRect, frame, interpolation);
+                addKeyframe(paramHorizontal, current.x);
+                addKeyframe(paramVertical, current.y);
+                filterRect = Qt.rect(startRect.x - x, startRect.y - y, startRect.width, startRect.height);
+                addKeyframe(rectProperty, filterRect);
                 break;
             case 'absPos':
                 current.x = (i.x + i.width / 2) / profile.width;
                 current.y = (i.y + i.height / 2) / profile.height;
                 interpolation = Shotcut.KeyframesModel.LinearInterpolation;
-                filter.set(paramHorizontal, current.x, frame, interpolation);
-                filter.set(paramVertical, current.y, frame, interpolation);
-                filterRect.x = i.x + i.width / 2 - filterRect.width / 2;
-                filterRect.y = i.y + i.height / 2 - filterRect.height / 2;
-                filter.set(rectProperty, filterRect, frame, interpolation);
+                addKeyframe(paramHorizontal, current.x);
+                addKeyframe(paramVertical, current.y);
+                filterRect = Qt.rect(i.x + i.width / 2 - startRect.width / 2, i.y + i.height / 2 - startRect.height / 2, startRect.width, startRect.height);
+                addKeyframe(rectProperty, filterRect);
                 break;
             case 'absSizePos':
                 current.x = (i.x + i.width / 2) / profile.width;
@@ -271,17 +276,22 @@ Item {
                 current.width = i.width / profile.width / 2;
                 current.height = i.height / profile.height / 2;
                 interpolation = Shotcut.KeyframesModel.LinearInterpolation;
-                filter.set(paramHorizontal, current.x, frame, interpolation);
-                filter.set(paramVertical, current.y, frame, interpolation);
-                filter.set(paramWidth, current.width, frame, interpolation);
-                filter.set(paramHeight, current.height, frame, interpolation);
+                addKeyframe(paramHorizontal, current.x);
+                addKeyframe(paramVertical, current.y);
+                addKeyframe(paramWidth, current.width);
+                addKeyframe(paramHeight, current.height);
                 filterRect = i;
-                filter.set(rectProperty, filterRect, frame, interpolation);
+                addKeyframe(rectProperty, filterRect);
                 break;
             }
-            previous = i;
             frame += interval;
         });
+        filter.startUndoParameterCommand(qsTr('Apply tracking'));
+        for (let j in properties) {
+            if (keyframes[j].length > 0)
+                filter.setKeyframes(properties[j], keyframes[j]);
+        }
+        filter.endUndoCommand();
         filter.blockSignals = false;
         filter.changed();
         filter.animateInChanged();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -88,18 +88,17 @@ Shotcut.KeyframableFilter {
     function applyTracking(motionTrackerRow, operation, frame) {
         motionTrackerModel.reset(filter, rectProperty, motionTrackerRow);
         const data = motionTrackerModel.trackingData(motionTrackerRow);
-        let previous = null;
+        let first = null;
         let interval = motionTrackerModel.keyframeIntervalFrames(motionTrackerRow);
         let interpolation = Shotcut.KeyframesModel.SmoothNaturalInterpolation;
-        filter.blockSignals = true;
+        let keyframes = [];
         data.forEach(i => {
+            // The keyframes are written together, so offset from the first position.
             let current = filter.getRect(rectProperty, frame);
-            let x = 0;
-            let y = 0;
-            if (previous !== null) {
-                x = i.x - previous.x;
-                y = i.y - previous.y;
-            }
+            if (first === null)
+                first = i;
+            let x = i.x - first.x;
+            let y = i.y - first.y;
             switch (operation) {
             case 'relativePos':
                 current.x += x;
@@ -117,20 +116,21 @@ Shotcut.KeyframableFilter {
             case 'absSizePos':
                 current.x = i.x;
                 current.y = i.y;
-                if (previous === null) {
-                    current.width = i.width;
-                    current.height = i.height;
-                }
+                current.width = first.width;
+                current.height = first.height;
                 interpolation = Shotcut.KeyframesModel.LinearInterpolation;
                 break;
             }
-            previous = i;
             current.x = Math.min(Math.max(current.x, 0), profile.width - current.width);
             current.y = Math.min(Math.max(current.y, 0), profile.height - current.height);
-            filter.set(rectProperty, current, frame, interpolation);
+            keyframes.push({
+                    "position": frame,
+                    "value": current,
+                    "type": interpolation
+                });
             frame += interval;
         });
-        filter.blockSignals = false;
+        filter.setKeyframes(rectProperty, keyframes);
         parameters.reload();
     }
 
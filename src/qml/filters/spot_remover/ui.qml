@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2023 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -85,18 +85,17 @@ Item {
     function applyTracking(motionTrackerRow, operation, frame) {
         motionTrackerModel.reset(filter, rectProperty, motionTrackerRow);
         const data = motionTrackerModel.trackingData(motionTrackerRow);
-        let previous = null;
+        let first = null;
         let interval = motionTrackerModel.keyframeIntervalFrames(motionTrackerRow);
         let interpolation = Shotcut.KeyframesModel.SmoothNaturalInterpolation;
-        filter.blockSignals = true;
+        let keyframes = [];
         data.forEach(i => {
+            // The keyframes are written together, so offset from the first position.
             let current = filter.getRect(rectProperty, frame);
-            let x = 0;
-            let y = 0;
-            if (previous !== null) {
-                x = i.x - previous.x;
-                y = i.y - previous.y;
-            }
+            if (first === null)
+                first = i;
+            let x = i.x - first.x;
+            let y = i.y - first.y;
             switch (operation) {
             case 'relativePos':
                 current.x += x;
@@ -119,11 +118,14 @@ Item {
                 interpolation = Shotcut.KeyframesModel.LinearInterpolation;
                 break;
             }
-            previous = i;
-            filter.set(rectProperty, current, frame, interpolation);
+            keyframes.push({
+                    "position": frame,
+                    "value": current,
+                    "type": interpolation
+                });
             frame += interval;
         });
-        filter.blockSignals = false;
+        filter.setKeyframes(rectProperty, keyframes);
         parameters.reload();
     }
 
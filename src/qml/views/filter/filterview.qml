@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -33,14 +33,14 @@ Rectangle {
             filterConfig.item.width = 1;
             filterConfig.item.height = 1;
         }
-        filterConfig.source = "";
+        filterConfig.sourceComponent = null;
     }
 
     function setCurrentFilter(index) {
         clearCurrentFilter();
         attachedFilters.setCurrentFilter(index);
         selectedIndex = index;
-        filterConfig.source = metadata ? metadata.qmlFilePath : "";
+        filterConfig.sourceComponent = metadata ? componentCache.component(metadata.qmlFilePath) : null;
     }
 
     function openFilterMenu() {
@@ -214,13 +214,9 @@ Rectangle {
                             var trackHeight = parameter.height;
                             var interpolation = 1;
                             // Get the interpolation from the previous keyframe if any.
-                            for (var j = 0; j < parameter.getKeyframeCount(); j++) {
-                                var k = parameter.getKeyframe(j);
-                                if (k.position - (filter.in - producer.in) < position)
-                                    interpolation = k.interpolation;
-                                else
-                                    break;
-                            }
+                            var previous = parameters.keyframeLowerBound(i, position) - 1;
+                            if (previous >= 0)
+                                interpolation = parameters.keyframeInterpolation(i, previous);
                             // If click position is within range.
                             if (position >= 0 && position < filter.duration && point.y > 0 && point.y < trackHeight) {
                                 // Determine the value to set.
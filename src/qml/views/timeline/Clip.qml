@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -47,7 +47,12 @@ Rectangle {
     property string audioIndex: ''
     property int group: -1
     property bool isTrackMute: false
+    property int trimInGhost: 0 // Frames trimmed while dragging, applied on release
+    property int trimOutGhost: 0
     property bool elided: (width < 15) || (x + width < tracksFlickable.contentX) || (x > tracksFlickable.contentX + tracksFlickable.width) || (y + height < 0) || (y > tracksFlickable.contentY + tracksFlickable.contentHeight)
+    // Becomes true the first time the clip is in view and stays true, so that
+    // thumbnails and waveforms are not made for clips that were never seen.
+    property bool wasInView: !elided
     property color clipColor: isBlank ? 'transparent' : isTransition ? 'mediumpurple' : isAudio ? 'darkseagreen' : root.shotcutBlue
 
     signal clicked(var clip, var mouse)
@@ -69,24 +74,33 @@ Rectangle {
     }
 
     function generateWaveform(force) {
-        if (!waveform.visible && !force)
+        if (!wasInView || (!waveform.visible && !force))
             return;
 
         // This is needed to make the model have the correct count.
         // Model as a property expression is not working in all cases.
         waveformRepeater.model = Math.ceil(clipRoot.width / waveform.maxWidth);
-        for (var i = 0; i < waveformRepeater.count; i++)
-            waveformRepeater.itemAt(0).update();
+        // Only the tiles on screen build their geometry.
+        for (var i = 0; i < waveformRepeater.count; i++) {
+            var tile = waveformRepeater.itemAt(i);
+            if (tile.active)
+                tile.update();
+        }
     }
 
     function updateThumbnails() {
         var s = inThumbnail.source.toString();
-        if (s.substring(s.length - 1) !== '!') {
+        if (s.length && s.substring(s.length - 1) !== '!') {
             inThumbnail.source = s + '!';
             resetThumbnailsSourceTimer.restart();
         }
+        s = thumbnailStrip.source.toString();
+        if (s.length && s.substring(s.length - 1) !== '!') {
+            thumbnailStrip.source = s + '!';
+            resetThumbnailsSourceTimer.restart();
+        }
         s = outThumbnail.source.toString();
-        if (s.substring(s.length - 1) !== '!') {
+        if (s.length && s.substring(s.length - 1) !== '!') {
             outThumbnail.source = s + '!';
             resetThumbnailsSourceTimer.restart();
         }
@@ -99,6 +113,13 @@ Rectangle {
             return 'image://thumbnail/' + hash + '/' + mltService + '/' + clipResource + '#' + time;
     }
 
+    function stripPath(count) {
+        if (isAudio || isBlank || isTransition)
+            return '';
+        else
+            return 'image://thumbnail/strip/' + count + '/' + hash + '/' + mltService + '/' + clipResource + '#' + inPoint + '-' + outPoint;
+    }
+
     border.color: (selected || Drag.active || trackIndex != originalTrackIndex) ? group < 0 ? 'red' : 'white' : 'black'
     border.width: isBlank && !selected ? 0 : 1
     clip: true
@@ -106,6 +127,10 @@ Rectangle {
     Drag.proposedAction: Qt.MoveAction
     opacity: Drag.active ? 0.5 : 1
     onAudioLevelsChanged: generateWaveform(false)
+    onElidedChanged: {
+        if (!elided)
+            wasInView = true;
+    }
     states: [
         State {
             name: 'normal'
@@ -275,7 +300,7 @@ Rectangle {
     Image {
         id: outThumbnail
 
-        visible: !elided && !isBlank && settings.timelineShowThumbnails && parent.height > 20 && x > inThumbnail.width
+        visible: !elided && !isBlank && settings.timelineShowThumbnails && !settings.timelineThumbnailStrip && parent.height > 20 && x > inThumbnail.width
         anchors.right: parent.right
         anchors.top: parent.top
         anchors.topMargin: parent.border.width
@@ -284,13 +309,13 @@ Rectangle {
         anchors.bottomMargin: parent.height / 2
         width: height * 16 / 9
         fillMode: Image.PreserveAspectFit
-        source: imagePath(outPoint)
+        source: (wasInView && !settings.timelineThumbnailStrip) ? imagePath(outPoint) : ''
     }
 
     Image {
         id: inThumbnail
 
-        visible: !elided && !isBlank && settings.timelineShowThumbnails && parent.height > 20
+        visible: !elided && !isBlank && settings.timelineShowThumbnails && !settings.timelineThumbnailStrip && parent.height > 20
         anchors.left: parent.left
         anchors.top: parent.top
         anchors.topMargin: parent.border.width
@@ -299,7 +324,24 @@ Rectangle {
         anchors.bottomMargin: parent.height / 2
         width: height * 16 / 9
         fillMode: Image.PreserveAspectFit
-        source: imagePath(inPoint)
+        source: (wasInView && !settings.timelineThumbnailStrip) ? imagePath(inPoint) : ''
+    }
+
+    Image {
+        id: thumbnailStrip
+
+        // One image of evenly spaced thumbnails, about as many as fit unscaled.
+        readonly property int count: Math.max(1, Math.round(width / Math.max(1, height * 16 / 9)))
+
+        visible: !elided && !isBlank && settings.timelineShowThumbnails && settings.timelineThumbnailStrip && parent.height > 20
+        anchors.left: parent.left
+        anchors.right: parent.right
+        anchors.top: parent.top
+        anchors.margins: parent.border.width
+        anchors.bottom: parent.bottom
+        anchors.bottomMargin: parent.height / 2
+        fillMode: Image.Stretch
+        source: (wasInView && settings.timelineShowThumbnails && settings.timelineThumbnailStrip) ? stripPath(count) : ''
     }
 
     Shotcut.TimelineTransition {
@@ -326,7 +368,7 @@ Rectangle {
         Repeater {
             id: waveformRepeater
 
-            model: Math.ceil(clipRoot.width / waveform.maxWidth)
+            model: wasInView ? Math.ceil(clipRoot.width / waveform.maxWidth) : 0
 
             Shotcut.TimelineWaveform {
 
@@ -771,9 +813,12 @@ Rectangle {
             var s = inThumbnail.source.toString();
             if (s.substring(s.length - 1) === '!')
                 inThumbnail.source = s.substring(0, s.length - 1);
-            s = inThumbnail.source.toString();
+            s = outThumbnail.source.toString();
             if (s.substring(s.length - 1) === '!')
-                inThumbnail.source = s.substring(0, s.length - 1);
+                outThumbnail.source = s.substring(0, s.length - 1);
+            s = thumbnailStrip.source.toString();
+            if (s.substring(s.length - 1) === '!')
+                thumbnailStrip.source = s.substring(0, s.length - 1);
         }
     }
 
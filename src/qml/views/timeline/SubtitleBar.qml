@@ -20,13 +20,55 @@ Item {
     id: subtitlebar
 
     property real timeScale: 1
+    property real visibleX: 0
+    property real visibleWidth: 0
+    // Changes when subtitle delegates are created or destroyed.
+    property int delegateRevision: 0
 
     height: 24
 
+    // Returns the delegate of the item at the row if it exists.
+    function subtitleAt(row) {
+        for (var i = 0; i < subtitlesRepeater.count; i++) {
+            var subtitle = subtitlesRepeater.itemAt(i);
+            if (subtitle && subtitle.itemIndex === row)
+                return subtitle;
+        }
+        return null;
+    }
+
+    // Only the items within a view width of the visible area get delegates.
+    function updateVisibleItems() {
+        var items = subtitlesDelegateModel.items;
+        var trackIndex = subtitlesSelectionModel.selectedTrack();
+        if (trackIndex < 0 || items.count === 0 || timeScale <= 0)
+            return;
+        var msPerPixel = 1000.0 / profile.fps / timeScale;
+        var msLeft = Math.floor((visibleX - visibleWidth) * msPerPixel);
+        var msRight = Math.ceil((visibleX + 2 * visibleWidth) * msPerPixel);
+        var first = subtitlesModel.itemIndexEndingAfterTime(trackIndex, msLeft);
+        var last = subtitlesModel.itemIndexAfterTime(trackIndex, msRight);
+        if (last < 0)
+            last = items.count;
+        last = Math.max(first, Math.min(last, items.count));
+        if (first > 0)
+            items.removeGroups(0, first, "visible");
+        if (last < items.count)
+            items.removeGroups(last, items.count - last, "visible");
+        if (last > first)
+            items.addGroups(first, last - first, "visible");
+    }
+
+    onTimeScaleChanged: updateVisibleItems()
+    onVisibleXChanged: updateVisibleItems()
+    onVisibleWidthChanged: updateVisibleItems()
+
     function startDrag() {
         var selectedItems = subtitlesSelectionModel.selectedItems;
         for (var i = 0; i < selectedItems.length; i++) {
-            var subtitle = subtitlesRepeater.itemAt(selectedItems[i]);
+            var subtitle = subtitleAt(selectedItems[i]);
+            if (!subtitle)
+                continue;
             subtitle.dragInProgress = true;
             subtitle.x = subtitle.calculatedX;
             subtitle.z += subtitlesModel.itemCount(subtitlesSelectionModel.selectedTrack());
@@ -36,7 +78,9 @@ Item {
     function setDragDelta(delta) {
         var selectedItems = subtitlesSelectionModel.selectedItems;
         for (var i = 0; i < selectedItems.length; i++) {
-            var subtitle = subtitlesRepeater.itemAt(selectedItems[i]);
+            var subtitle = subtitleAt(selectedItems[i]);
+            if (!subtitle)
+                continue;
             subtitle.x = subtitle.calculatedX + delta;
         }
     }
@@ -44,7 +88,9 @@ Item {
     function endDrag() {
         var selectedItems = subtitlesSelectionModel.selectedItems;
         for (var i = 0; i < selectedItems.length; i++) {
-            var subtitle = subtitlesRepeater.itemAt(selectedItems[i]);
+            var subtitle = subtitleAt(selectedItems[i]);
+            if (!subtitle)
+                continue;
             subtitle.dragInProgress = false;
             subtitle.z -= subtitlesModel.itemCount(subtitlesSelectionModel.selectedTrack());
         }
@@ -57,12 +103,12 @@ Item {
         }
         var groupStart = -1;
         for (var i = 0; i < selectedRows.length; i++) {
-            var subtitle = subtitlesRepeater.itemAt(selectedRows[i].row);
-            if (groupStart == -1 || subtitle.calculatedX < groupStart) {
-                groupStart = subtitle.calculatedX;
+            // The item may be outside of the view and not have a delegate.
+            var startFrame = subtitlesDelegateModel.items.get(selectedRows[i].row).model.startFrame;
+            if (groupStart == -1 || startFrame < groupStart) {
+                groupStart = startFrame;
             }
         }
-        groupStart = groupStart / timeScale;
         var newStart = (groupStart + deltaFrames) * 1000.0 / profile.fps;
         if (subtitlesModel.validateMove(selectedRows, newStart)) {
             var trackIndex = subtitlesSelectionModel.selectedTrack();
@@ -86,10 +132,23 @@ Item {
         target: subtitlesSelectionModel
     }
 
+    Connections {
+        function onDataChanged() {
+            Qt.callLater(subtitlebar.updateVisibleItems);
+        }
+
+        target: subtitlesModel
+    }
+
     DelegateModel {
         id: subtitlesDelegateModel
 
         model: subtitlesModel
+        filterOnGroup: "visible"
+        groups: DelegateModelGroup {
+            name: "visible"
+        }
+        items.onChanged: Qt.callLater(subtitlebar.updateVisibleItems)
 
         onRootIndexChanged: {
             if (rootIndex != subtitlesSelectionModel.selectedTrackModelIndex) {
@@ -98,12 +157,16 @@ Item {
         }
 
         delegate: Subtitle {
+            property int itemIndex: index
+
             timeScale: subtitlebar.timeScale
 
             onDragStarted: subtitlebar.startDrag()
             onDragMoved: delta => subtitlebar.setDragDelta(delta)
             onDragEnded: subtitlebar.endDrag()
             onMoveRequested: deltaFrames => subtitlebar.moveItems(deltaFrames)
+            Component.onCompleted: subtitlebar.delegateRevision++
+            Component.onDestruction: subtitlebar.delegateRevision++
         }
     }
 
@@ -116,7 +179,7 @@ Item {
         id: subtitlesSelectionRepeater
 
         Rectangle {
-            property var subtitle: subtitlesRepeater.itemAt(modelData)
+            property var subtitle: subtitlebar.delegateRevision >= 0 ? subtitlebar.subtitleAt(modelData) : null
 
             x: subtitle ? subtitle.x : 0
             y: subtitle ? subtitle.y : 0
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2020 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -86,108 +86,34 @@ function snapClip(clip, repeater) {
     }
 }
 
-function snapTrimIn(clip, delta, timeline, trackIndex) {
-    var x = clip.x + delta * timeScale
+function snapTrimIn(clip, total, trackIndex) {
+    // The clip is not changed while trimming, so snap its ghost edge.
+    var x = clip.x + total * timeScale
     var cursorX = tracksFlickable.contentX + cursor.x
-    if (delta < 0) {
-        // Snap to other clips on the same track.
-        for (var i = 0; i < repeater.count; i++) {
-            if (i === clip.DelegateModel.itemsIndex || repeater.itemAt(i).isBlank || repeater.itemAt(i).isTransition)
-                continue
-            var itemLeft = repeater.itemAt(i).x
-            var itemRight = itemLeft + repeater.itemAt(i).width
-            if (x > itemLeft - SNAP_TRIM && x < itemLeft + SNAP_TRIM)
-                return Math.round((itemLeft - clip.x) / timeScale)
-            else if (x > itemRight - SNAP_TRIM && x < itemRight + SNAP_TRIM)
-                return Math.round((itemRight - clip.x) / timeScale)
-        }
-    }
-    // Snap to clips on other tracks.
-    for (var j = 0; j < timeline.trackCount; j++) {
-        if (j !== trackIndex) {
-            var track = timeline.trackAt(j)
-            for (i = 0; i < track.clipCount; i++) {
-                var item = track.clipAt(i)
-                if (item.isBlank)
-                    continue
-                itemLeft = item.x
-                itemRight = itemLeft + item.width
-                if (x > itemLeft - SNAP_TRIM && x < itemLeft + SNAP_TRIM)
-                    return Math.round((itemLeft - clip.x) / timeScale)
-                else if (x > itemRight - SNAP_TRIM && x < itemRight + SNAP_TRIM)
-                    return Math.round((itemRight - clip.x) / timeScale)
-            }
-        }
-    }
-    // Snap to markers
-    var frame = Math.round(x / timeScale)
-    var prevMarkerX = Math.round(markers.prevMarkerPosition(frame) * timeScale)
-    if (x < prevMarkerX + SNAP_TRIM) {
-        return Math.round((prevMarkerX - clip.x) / timeScale)
-    }
-    var nextMarkerX = Math.round(markers.nextMarkerPosition(frame) * timeScale)
-    if (nextMarkerX > 0 && x > nextMarkerX - SNAP_TRIM) {
-        return Math.round((nextMarkerX - clip.x) / timeScale)
-    }
+    var clipFrame = Math.round(clip.x / timeScale)
     if (x > -SNAP_TRIM && x < SNAP_TRIM) {
         // Snap around origin.
-        return Math.round(-clip.x / timeScale)
+        return -clipFrame
     } else if (x > cursorX - SNAP_TRIM && x < cursorX + SNAP_TRIM) {
         // Snap around cursor/playhead.
-        return Math.round((cursorX - clip.x) / timeScale)
+        return Math.round(cursorX / timeScale) - clipFrame
     }
-    return delta
+    // Snap to clips on all tracks and markers.
+    var frame = clipFrame + total
+    return timeline.snapTrimFrame(frame, SNAP_TRIM / timeScale, trackIndex, clip.DelegateModel.itemsIndex) - clipFrame
 }
 
-function snapTrimOut(clip, delta, timeline, trackIndex) {
-    var rightEdge = clip.x + clip.width
-    var x = rightEdge - delta * timeScale
+function snapTrimOut(clip, total, trackIndex) {
+    var rightFrame = Math.round((clip.x + clip.width) / timeScale)
+    var x = (rightFrame - total) * timeScale
     var cursorX = tracksFlickable.contentX + cursor.x
-    if (delta < 0) {
-        // Snap to other clips.
-        for (var i = 0; i < repeater.count; i++) {
-            if (i === clip.DelegateModel.itemsIndex || repeater.itemAt(i).isBlank || repeater.itemAt(i).isTransition)
-                continue
-            var itemLeft = repeater.itemAt(i).x
-            var itemRight = itemLeft + repeater.itemAt(i).width
-            if (x > itemLeft - SNAP_TRIM && x < itemLeft + SNAP_TRIM)
-                return Math.round((rightEdge - itemLeft) / timeScale)
-            else if (x > itemRight - SNAP_TRIM && x < itemRight + SNAP_TRIM)
-                return Math.round((rightEdge - itemRight) / timeScale)
-        }
-    }
-    // Snap to clips on other tracks.
-    for (var j = 0; j < timeline.trackCount; j++) {
-        if (j !== trackIndex) {
-            var track = timeline.trackAt(j)
-            for (i = 0; i < track.clipCount; i++) {
-                var item = track.clipAt(i)
-                if (item.isBlank)
-                    continue
-                itemLeft = item.x
-                itemRight = itemLeft + item.width
-                if (x > itemLeft - SNAP_TRIM && x < itemLeft + SNAP_TRIM)
-                    return Math.round((rightEdge - itemLeft) / timeScale)
-                else if (x > itemRight - SNAP_TRIM && x < itemRight + SNAP_TRIM)
-                    return Math.round((rightEdge - itemRight) / timeScale)
-            }
-        }
-    }
-    // Snap to markers
-    var frame = Math.round(x / timeScale)
-    var prevMarkerX = Math.round(markers.prevMarkerPosition(frame) * timeScale)
-    if (x < prevMarkerX + SNAP_TRIM) {
-        return Math.round((rightEdge - prevMarkerX) / timeScale)
-    }
-    var nextMarkerX = Math.round(markers.nextMarkerPosition(frame) * timeScale)
-    if (nextMarkerX > 0 && x > nextMarkerX - SNAP_TRIM) {
-        return Math.round((rightEdge - nextMarkerX) / timeScale)
-    }
     if (x > cursorX - SNAP_TRIM && x < cursorX + SNAP_TRIM) {
         // Snap around cursor/playhead.
-        return Math.round((rightEdge - cursorX) / timeScale)
+        return rightFrame - Math.round(cursorX / timeScale)
     }
-    return delta
+    // Snap to clips on all tracks and markers.
+    var frame = rightFrame - total
+    return rightFrame - timeline.snapTrimFrame(frame, SNAP_TRIM / timeScale, trackIndex, clip.DelegateModel.itemsIndex)
 }
 
 function snapDrop(pos, repeater) {
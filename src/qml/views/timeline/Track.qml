@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -30,6 +30,8 @@ Rectangle {
     property bool isLocked: false
     property alias clipCount: repeater.count
     property bool isMute: false
+    property bool trimRipple: false
+    property bool trimRoll: false
 
     signal clipClicked(var clip, var track, var mouse)
     signal clipRightClicked(var clip, var track, var mouse)
@@ -65,6 +67,21 @@ Rectangle {
         return repeater.itemAt(index);
     }
 
+    // Seeking is expensive, so scrub at most once per interval while dragging.
+    function scrubTo(position) {
+        root.stopScrolling = false;
+        scrubTimer.position = position;
+        if (!scrubTimer.running)
+            scrubTimer.start();
+    }
+
+    function trimBubble(total, duration) {
+        // Show amount trimmed as a time in a "bubble" help.
+        var s = application.timeFromFrames(Math.abs(total));
+        s = '%1%2 = %3'.arg((total < 0) ? '-' : (total > 0) ? '+' : '').arg(s.substring(3)).arg(application.timeFromFrames(duration));
+        bubbleHelp.show(s);
+    }
+
     color: 'transparent'
     width: clipRow.width
     onIsMuteChanged: {
@@ -136,10 +153,8 @@ Rectangle {
                 }
             }
             onDragged: (clip, mouse) => {
-                if (settings.timelineDragScrub) {
-                    root.stopScrolling = false;
-                    timeline.position = Math.round(clip.x / timeScale);
-                }
+                if (settings.timelineDragScrub)
+                    trackRoot.scrubTo(Math.round(clip.x / timeScale));
                 // Snap if Alt key is not down.
                 if (!(mouse.modifiers & Qt.AltModifier) && settings.timelineSnap)
                     trackRoot.checkSnap(clip);
@@ -157,30 +172,31 @@ Rectangle {
                 s = ((delta < 0) ? '-' : (delta > 0) ? '+' : '') + s;
                 bubbleHelp.show(s);
             }
+            // Trimming only moves a ghost of the edge, and the model is
+            // trimmed once on release. clip.originalX has the total delta.
             onTrimmingIn: (clip, delta, mouse) => {
-                const originalDelta = delta;
-                const roll = mouse.modifiers & Qt.ControlModifier;
-                const ripple = !roll && (settings.timelineRipple || (mouse.modifiers & Qt.ShiftModifier));
-                if (settings.timelineDragScrub) {
-                    root.stopScrolling = false;
-                    timeline.position = Math.round(clip.x / timeScale) + (delta > 0 ? 1 : 0);
-                } else if (!(mouse.modifiers & Qt.AltModifier) && settings.timelineSnap && !ripple) {
-                    delta = Logic.snapTrimIn(clip, delta, root, trackRoot.DelegateModel.itemsIndex);
-                }
-                if (delta !== 0) {
-                    if (timeline.trimClipIn(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex, clip.originalClipIndex, delta, ripple, roll)) {
-                        // Show amount trimmed as a time in a "bubble" help.
-                        var s = application.timeFromFrames(Math.abs(clip.originalX));
-                        s = '%1%2 = %3'.arg((clip.originalX < 0) ? '-' : (clip.originalX > 0) ? '+' : '').arg(s.substring(3)).arg(application.timeFromFrames(clipDuration));
-                        bubbleHelp.show(s);
-                    } else {
-                        clip.originalX -= originalDelta;
-                    }
+                const trackIndex = trackRoot.DelegateModel.itemsIndex;
+                trackRoot.trimRoll = mouse.modifiers & Qt.ControlModifier;
+                trackRoot.trimRipple = !trackRoot.trimRoll && (settings.timelineRipple || (mouse.modifiers & Qt.ShiftModifier));
+                var total = clip.originalX;
+                if (!settings.timelineDragScrub && !(mouse.modifiers & Qt.AltModifier) && settings.timelineSnap && !trackRoot.trimRipple)
+                    total = Logic.snapTrimIn(clip, total, trackIndex);
+                if (total === 0 || timeline.isTrimClipInValid(trackIndex, clip.DelegateModel.itemsIndex, total, trackRoot.trimRipple, trackRoot.trimRoll)) {
+                    clip.trimInGhost = total;
+                    trimGhost.target = clip;
+                    if (settings.timelineDragScrub)
+                        trackRoot.scrubTo(Math.round(clip.x / timeScale) + total + (delta > 0 ? 1 : 0));
+                    trackRoot.trimBubble(total, clip.clipDuration - total);
                 } else {
-                    clip.originalX -= originalDelta;
+                    clip.originalX -= delta;
                 }
             }
             onTrimmedIn: clip => {
+                const total = clip.trimInGhost;
+                clip.trimInGhost = 0;
+                trimGhost.target = null;
+                if (total !== 0)
+                    timeline.trimClipIn(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex, clip.originalClipIndex, total, trackRoot.trimRipple, trackRoot.trimRoll);
                 multitrack.notifyClipIn(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex);
                 // Notify out point of clip A changed when trimming to add a transition.
                 if (clip.DelegateModel.itemsIndex > 1 && repeater.itemAt(clip.DelegateModel.itemsIndex - 1).isTransition)
@@ -189,29 +205,28 @@ Rectangle {
                 timeline.commitTrimCommand();
             }
             onTrimmingOut: (clip, delta, mouse) => {
-                const originalDelta = delta;
-                const roll = mouse.modifiers & Qt.ControlModifier;
-                const ripple = !roll && (settings.timelineRipple || (mouse.modifiers & Qt.ShiftModifier));
-                if (settings.timelineDragScrub) {
-                    root.stopScrolling = false;
-                    timeline.position = Math.round((clip.x + clip.width) / timeScale) - (delta > 0 ? 2 : 0);
-                } else if (!(mouse.modifiers & Qt.AltModifier) && settings.timelineSnap && !ripple) {
-                    delta = Logic.snapTrimOut(clip, delta, root, trackRoot.DelegateModel.itemsIndex);
-                }
-                if (delta !== 0) {
-                    if (timeline.trimClipOut(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex, delta, ripple, roll)) {
-                        // Show amount trimmed as a time in a "bubble" help.
-                        var s = application.timeFromFrames(Math.abs(clip.originalX));
-                        s = '%1%2 = %3'.arg((clip.originalX < 0) ? '+' : (clip.originalX > 0) ? '-' : '').arg(s.substring(3)).arg(application.timeFromFrames(clipDuration));
-                        bubbleHelp.show(s);
-                    } else {
-                        clip.originalX -= originalDelta;
-                    }
+                const trackIndex = trackRoot.DelegateModel.itemsIndex;
+                trackRoot.trimRoll = mouse.modifiers & Qt.ControlModifier;
+                trackRoot.trimRipple = !trackRoot.trimRoll && (settings.timelineRipple || (mouse.modifiers & Qt.ShiftModifier));
+                var total = clip.originalX;
+                if (!settings.timelineDragScrub && !(mouse.modifiers & Qt.AltModifier) && settings.timelineSnap && !trackRoot.trimRipple)
+                    total = Logic.snapTrimOut(clip, total, trackIndex);
+                if (total === 0 || timeline.isTrimClipOutValid(trackIndex, clip.DelegateModel.itemsIndex, total, trackRoot.trimRipple, trackRoot.trimRoll)) {
+                    clip.trimOutGhost = total;
+                    trimGhost.target = clip;
+                    if (settings.timelineDragScrub)
+                        trackRoot.scrubTo(Math.round((clip.x + clip.width) / timeScale) - total - (delta > 0 ? 2 : 0));
+                    trackRoot.trimBubble(-total, clip.clipDuration - total);
                 } else {
-                    clip.originalX -= originalDelta;
+                    clip.originalX -= delta;
                 }
             }
             onTrimmedOut: clip => {
+                const total = clip.trimOutGhost;
+                clip.trimOutGhost = 0;
+                trimGhost.target = null;
+                if (total !== 0)
+                    timeline.trimClipOut(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex, total, trackRoot.trimRipple, trackRoot.trimRoll);
                 multitrack.notifyClipOut(trackRoot.DelegateModel.itemsIndex, clip.DelegateModel.itemsIndex);
                 // Notify in point of clip B changed when trimming to add a transition.
                 if (clip.DelegateModel.itemsIndex + 2 < repeater.count && repeater.itemAt(clip.DelegateModel.itemsIndex + 1).isTransition)
@@ -264,4 +279,29 @@ Rectangle {
             model: trackModel
         }
     }
+
+    // The outline of the clip being trimmed at its new edges.
+    Rectangle {
+        id: trimGhost
+
+        property var target: null
+
+        visible: target !== null
+        x: target ? target.x + target.trimInGhost * timeScale : 0
+        width: target ? Math.max(1, target.width - (target.trimInGhost + target.trimOutGhost) * timeScale) : 0
+        height: trackRoot.height
+        color: 'transparent'
+        border.color: activePalette.highlight
+        border.width: 2
+        z: 1
+    }
+
+    Timer {
+        id: scrubTimer
+
+        property int position
+
+        interval: 50
+        onTriggered: timeline.position = position
+    }
 }
@@ -531,6 +531,8 @@ Rectangle {
                         anchors.top: ruler.bottom
                         height: subtitlesModel.trackCount > 0 ? 24 : 0
                         timeScale: multitrack.scaleFactor
+                        visibleX: tracksFlickable.contentX
+                        visibleWidth: tracksFlickable.width
                     }
                 }
 
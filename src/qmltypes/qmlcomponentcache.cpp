@@ -0,0 +1,79 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "qmlcomponentcache.h"
+
+#include "Logger.h"
+
+#include <QQmlComponent>
+#include <QQmlEngine>
+
+static const int kComponentCacheSize = 24;
+
+QmlComponentCache::QmlComponentCache(QQmlEngine *engine, QObject *parent)
+    : QObject(parent)
+    , m_engine(engine)
+{}
+
+QQmlComponent *QmlComponentCache::component(const QUrl &url)
+{
+    if (url.isEmpty())
+        return nullptr;
+    auto component = m_components.value(url);
+    if (component) {
+        m_recent.removeOne(url);
+        m_recent.prepend(url);
+    } else {
+        component = insert(url, false);
+    }
+    if (component->isError())
+        LOG_WARNING() << component->errorString();
+    return component;
+}
+
+void QmlComponentCache::preload(const QList<QUrl> &urls)
+{
+    for (const auto &url : urls) {
+        // Leave room for the files used since.
+        if (m_components.size() >= kComponentCacheSize / 2)
+            break;
+        if (!url.isEmpty() && !m_components.contains(url))
+            insert(url, true);
+    }
+}
+
+QQmlComponent *QmlComponentCache::insert(const QUrl &url, bool isAsynchronous)
+{
+    while (m_recent.size() >= kComponentCacheSize) {
+        // A Loader may still be creating an item from the one released.
+        auto last = m_components.take(m_recent.takeLast());
+        if (last)
+            last->deleteLater();
+    }
+    auto component = new QQmlComponent(m_engine,
+                                       url,
+                                       isAsynchronous ? QQmlComponent::Asynchronous
+                                                      : QQmlComponent::PreferSynchronous,
+                                       this);
+    QQmlEngine::setObjectOwnership(component, QQmlEngine::CppOwnership);
+    m_components.insert(url, component);
+    if (isAsynchronous)
+        m_recent.append(url);
+    else
+        m_recent.prepend(url);
+    return component;
+}
@@ -0,0 +1,60 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QMLCOMPONENTCACHE_H
+#define QMLCOMPONENTCACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QUrl>
+
+class QQmlComponent;
+class QQmlEngine;
+
+/*!
+  \class QmlComponentCache
+  \brief Keeps the recently used filter user interfaces compiled.
+
+  A Loader given a source URL compiles the file again once the engine has
+  trimmed its unused types, which is noticeable for large panels such as text
+  or color grading. The cache holds the components of the most recently used
+  files so that selecting one of their filters only creates the item.
+  preload() compiles files on the loader thread of the engine ahead of use.
+*/
+
+class QmlComponentCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit QmlComponentCache(QQmlEngine *engine, QObject *parent = nullptr);
+
+    //! Returns the component for \a url, compiling it if it is not cached.
+    Q_INVOKABLE QQmlComponent *component(const QUrl &url);
+    //! Compiles the files at \a urls in the background.
+    void preload(const QList<QUrl> &urls);
+
+private:
+    QQmlComponent *insert(const QUrl &url, bool isAsynchronous);
+
+    QQmlEngine *m_engine;
+    QHash<QUrl, QQmlComponent *> m_components;
+    // Most recently used first.
+    QList<QUrl> m_recent;
+};
+
+#endif // QMLCOMPONENTCACHE_H
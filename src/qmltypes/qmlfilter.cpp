@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -31,13 +31,128 @@
 
 #include <MltProducer.h>
 #include <QClipboard>
+#include <QDataStream>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
 #include <QGuiApplication>
 #include <QIODevice>
+#include <QSaveFile>
 #include <QTemporaryFile>
 #include <QtXml>
 
+#include <algorithm>
+#include <memory>
+
+// The index of a preset folder is kept in a folder of this name beside it.
+static const char *kPresetIndexFolder = ".index";
+static const qint32 kPresetIndexVersion = 1;
+// A stabilization is split into segments of at least this length.
+static const int kMinAnalyzeSegmentSeconds = 120;
+
+namespace {
+
+struct PresetIndex
+{
+    // The modification time of the preset folder that the names are from.
+    qint64 modified = -1;
+    QStringList names;
+};
+
+} // namespace
+
+// Shared by the filters of each service; only used on the main thread.
+static QHash<QString, PresetIndex> s_presetIndexes;
+
+static QString presetIndexPath(const QDir &presetsDir, const QString &service)
+{
+    return presetsDir.filePath(QStringLiteral("%1/%2").arg(kPresetIndexFolder, service));
+}
+
+static qint64 presetFolderModified(const QDir &dir)
+{
+    return QFileInfo(dir.absolutePath()).lastModified().toMSecsSinceEpoch();
+}
+
+static QString presetName(const QString &fileName)
+{
+    if (fileName == QUrl::toPercentEncoding(QUrl::fromPercentEncoding(fileName.toUtf8())))
+        return QUrl::fromPercentEncoding(fileName.toUtf8());
+    return fileName;
+}
+
+static void writePresetIndex(QDir presetsDir, const QString &service, const PresetIndex &index)
+{
+    if (!presetsDir.mkpath(kPresetIndexFolder))
+        return;
+    QSaveFile file(presetIndexPath(presetsDir, service));
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+    QDataStream stream(&file);
+    stream << kPresetIndexVersion << index.modified << index.names;
+    if (!file.commit())
+        LOG_WARNING() << "failed to write" << file.fileName();
+}
+
+/*!
+  Returns the names of the presets of \a service without listing its folder
+  when the folder has not changed since its index was written.
+*/
+static const QStringList *presetNames(const QString &service)
+{
+    QDir dir(Settings.appDataLocation());
+    if (!dir.cd("presets") || !dir.exists(service))
+        return nullptr;
+    QDir presetDir(dir.filePath(service));
+    const qint64 modified = presetFolderModified(presetDir);
+    auto &index = s_presetIndexes[service];
+    if (index.modified == modified)
+        return &index.names;
+
+    QFile file(presetIndexPath(dir, service));
+    if (file.open(QIODevice::ReadOnly)) {
+        QDataStream stream(&file);
+        qint32 version = 0;
+        PresetIndex fromFile;
+        stream >> version >> fromFile.modified >> fromFile.names;
+        if (stream.status() == QDataStream::Ok && version == kPresetIndexVersion
+            && fromFile.modified == modified) {
+            index = fromFile;
+            return &index.names;
+        }
+    }
+
+    index.modified = modified;
+    index.names.clear();
+    for (const auto &s : presetDir.entryList(QDir::Files | QDir::Readable))
+        index.names << presetName(s);
+    writePresetIndex(dir, service, index);
+    return &index.names;
+}
+
+//! Updates the index of \a service after one of its presets was written or removed.
+static void updatePresetIndex(const QString &service, const QString &name, bool isRemoved)
+{
+    QDir dir(Settings.appDataLocation());
+    if (!dir.cd("presets") || !dir.exists(service))
+        return;
+    auto it = s_presetIndexes.find(service);
+    // Without a current index, the next presetNames() lists the folder.
+    if (it == s_presetIndexes.end() || it->modified < 0)
+        return;
+    if (isRemoved) {
+        it->names.removeOne(name);
+    } else if (!it->names.contains(name)) {
+        it->names << name;
+        // In the order of the file names, as QDir lists them.
+        std::sort(it->names.begin(), it->names.end(), [](const QString &a, const QString &b) {
+            return QUrl::toPercentEncoding(a) < QUrl::toPercentEncoding(b);
+        });
+    }
+    it->modified = presetFolderModified(QDir(dir.filePath(service)));
+    writePresetIndex(dir, service, *it);
+}
+
 QmlFilter::QmlFilter()
     : QObject(nullptr)
     , m_metadata(nullptr)
@@ -48,6 +163,7 @@ QmlFilter::QmlFilter()
 {
     connect(this, SIGNAL(inChanged(int)), this, SIGNAL(durationChanged()));
     connect(this, SIGNAL(outChanged(int)), this, SIGNAL(durationChanged()));
+    connect(this, SIGNAL(changed(QString)), this, SLOT(clearKeyframesCache(QString)));
 }
 
 QmlFilter::QmlFilter(Mlt::Service &mltService, const QmlMetadata *metadata, QObject *parent)
@@ -68,6 +184,7 @@ QmlFilter::QmlFilter(Mlt::Service &mltService, const QmlMetadata *metadata, QObj
         m_producer = Mlt::Producer(
             mlt_producer(m_service.is_valid() ? m_service.get_data("chain") : 0));
     }
+    connect(this, SIGNAL(changed(QString)), this, SLOT(clearKeyframesCache(QString)));
 }
 
 QmlFilter::~QmlFilter() {}
@@ -352,24 +469,71 @@ void QmlFilter::set(QString name, const QRectF &rect, int position, mlt_keyframe
     set(name, rect.x(), rect.y(), rect.width(), rect.height(), 1.0, position, keyframeType);
 }
 
+void QmlFilter::setKeyframes(const QString &name, const QVector<KeyframeValue> &keyframes)
+{
+    if (!m_service.is_valid() || keyframes.isEmpty())
+        return;
+    const auto property = name.toUtf8();
+    const int length = duration();
+    const auto typeId = keyframes.first().value.typeId();
+    const bool isRect = typeId == QMetaType::QRectF || typeId == QMetaType::QRect;
+    startUndoSetKeyframesCommand();
+    if (isRect && getAnimation(name).key_count() < 1) {
+        // Clear the string value when setting animation for the first time
+        m_service.clear(property.constData());
+    }
+    for (const auto &keyframe : keyframes) {
+        Mlt::Animation animation(m_service.get_animation(property.constData()));
+        auto type = getKeyframeType(animation, keyframe.position, keyframe.type);
+        switch (keyframe.value.typeId()) {
+        case QMetaType::QRectF:
+        case QMetaType::QRect: {
+            const auto r = keyframe.value.toRectF();
+            mlt_rect rect = {r.x(), r.y(), r.width(), r.height(), 1.0};
+            m_service.anim_set(property.constData(), rect, keyframe.position, length, type);
+            break;
+        }
+        case QMetaType::QColor:
+            m_service.anim_set(property.constData(),
+                               Util::mltColorFromQColor(keyframe.value.value<QColor>()),
+                               keyframe.position,
+                               length);
+            break;
+        default:
+            m_service.anim_set(property.constData(),
+                               keyframe.value.toDouble(),
+                               keyframe.position,
+                               length,
+                               type);
+            break;
+        }
+    }
+    // Callers often block signals while they work.
+    clearKeyframesCache(name);
+    emit changed(name);
+    updateUndoCommand(name);
+    endUndoCommand();
+}
+
+void QmlFilter::setKeyframes(const QString &name, const QVariantList &keyframes)
+{
+    QVector<KeyframeValue> values;
+    values.reserve(keyframes.size());
+    for (const auto &item : keyframes) {
+        const auto map = item.toMap();
+        values << KeyframeValue{map.value("position").toInt(),
+                                map.value("value"),
+                                mlt_keyframe_type(map.value("type", -1).toInt())};
+    }
+    setKeyframes(name, values);
+}
+
 void QmlFilter::loadPresets()
 {
     m_presets.clear();
-    QDir dir(Settings.appDataLocation());
-    if (dir.cd("presets")) {
-        QStringList entries = dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot | QDir::Executable);
-        foreach (QString s, entries) {
-            if (s == objectNameOrService() && dir.cd(s)) {
-                m_presets.append("");
-                for (auto &s : dir.entryList(QDir::Files | QDir::Readable)) {
-                    if (s == QUrl::toPercentEncoding(QUrl::fromPercentEncoding(s.toUtf8())))
-                        m_presets << QUrl::fromPercentEncoding(s.toUtf8());
-                    else
-                        m_presets << s;
-                }
-                break;
-            }
-        }
+    if (auto names = presetNames(objectNameOrService())) {
+        m_presets.append("");
+        m_presets << *names;
     }
     emit presetsChanged();
 }
@@ -404,6 +568,7 @@ int QmlFilter::savePreset(const QStringList &propertyNames, const QString &name)
     }
     yamlFile.write(yaml.toUtf8());
     yamlFile.close();
+    updatePresetIndex(objectNameOrService(), presetName(preset), false);
     loadPresets();
     return m_presets.indexOf(name);
 }
@@ -414,12 +579,56 @@ void QmlFilter::deletePreset(const QString &name)
     if (dir.cd("presets") && dir.cd(objectNameOrService())) {
         if (!QFile(dir.filePath(QUrl::toPercentEncoding(name))).remove())
             QFile(dir.filePath(name)).remove();
+        updatePresetIndex(objectNameOrService(), name, true);
     }
     m_presets.removeOne(name);
     emit presetsChanged();
 }
 
+// Returns the element of the filter tagged with \a uuid in the job XML.
+static QDomElement findFilterNode(QDomDocument &dom, const QUuid &uuid)
+{
+    QDomNodeList filters = dom.elementsByTagName("filter");
+    for (int i = 0; i < filters.size(); i++) {
+        QDomElement filterNode = filters.at(i).toElement();
+        QDomNodeList properties = filterNode.elementsByTagName("property");
+        for (int j = 0; j < properties.size(); j++) {
+            QDomElement propertyNode = properties.at(j).toElement();
+            if (propertyNode.attribute("name") == kShotcutHashProperty
+                && propertyNode.text() == uuid.toString())
+                return filterNode;
+        }
+    }
+    return QDomElement();
+}
+
+static void setXmlProperty(QDomDocument &dom,
+                           QDomElement &node,
+                           const QString &name,
+                           const QString &value)
+{
+    QDomNodeList properties = node.elementsByTagName("property");
+    QDomElement propertyNode;
+    for (int i = 0; i < properties.size() && propertyNode.isNull(); i++) {
+        if (properties.at(i).toElement().attribute("name") == name)
+            propertyNode = properties.at(i).toElement();
+    }
+    if (propertyNode.isNull()) {
+        propertyNode = dom.createElement("property");
+        propertyNode.setAttribute("name", name);
+        node.appendChild(propertyNode);
+    }
+    while (propertyNode.hasChildNodes())
+        propertyNode.removeChild(propertyNode.firstChild());
+    propertyNode.appendChild(dom.createTextNode(value));
+}
+
 void QmlFilter::analyze(bool isAudio, bool deferJob)
+{
+    analyze(isAudio, deferJob, nullptr);
+}
+
+void QmlFilter::analyze(bool isAudio, bool deferJob, AnalyzeBatch *batch)
 {
     // Analyze is only supported for filters, not links.
     if (m_service.type() != mlt_service_filter_type)
@@ -470,6 +679,7 @@ void QmlFilter::analyze(bool isAudio, bool deferJob)
     // Write the job XML
     MLT.saveXML(tmp->fileName(), &service, false /* without relative paths */, tmp.data());
     tmp->close();
+    const int length = service.get_int("out") - service.get_int("in") + 1;
 
     if (!MLT.isSeekableClip()) {
         service.set("in", in);
@@ -484,6 +694,7 @@ void QmlFilter::analyze(bool isAudio, bool deferJob)
     QScopedPointer<QTemporaryFile> tmpTarget(Util::writableTemporaryFile(filename));
     tmpTarget->open();
     tmpTarget->close();
+    const QString targetPath = tmpTarget->fileName();
 
     // parse xml
     QFile f1(tmp->fileName());
@@ -507,16 +718,42 @@ void QmlFilter::analyze(bool isAudio, bool deferJob)
         consumerNode.setAttribute("audio_off", 1);
     consumerNode.setAttribute("resource", tmpTarget->fileName());
 
-    AbstractJob *job = new MeltJob(tmpTarget->fileName(),
-                                   dom.toString(2),
-                                   MLT.profile().frame_rate_num(),
-                                   MLT.profile().frame_rate_den());
-    if (job) {
-        AnalyzeDelegate *delegate = new AnalyzeDelegate(mltFilter);
-        connect(job, &AbstractJob::finished, delegate, &AnalyzeDelegate::onAnalyzeFinished);
-        connect(job, &AbstractJob::finished, this, &QmlFilter::analyzeFinished);
-        job->setLabel(tr("Analyze %1").arg(Util::baseName(ProxyManager::resource(service))));
+    // An audio analysis does not need to decode the video of its clips.
+    if (isAudio) {
+        for (const auto &tag : {"producer", "chain"}) {
+            QDomNodeList nodes = dom.elementsByTagName(tag);
+            for (int i = 0; i < nodes.length(); ++i) {
+                QDomElement node = nodes.at(i).toElement();
+                QDomElement videoIndex;
+                bool isAvformat = false;
+                QDomNodeList properties = node.elementsByTagName("property");
+                for (int j = 0; j < properties.length(); ++j) {
+                    QDomElement property = properties.at(j).toElement();
+                    if (property.parentNode() != node)
+                        continue;
+                    if (property.attribute("name") == "mlt_service")
+                        isAvformat = property.text().startsWith("avformat");
+                    else if (property.attribute("name") == "video_index")
+                        videoIndex = property;
+                }
+                if (!isAvformat)
+                    continue;
+                if (videoIndex.isNull()) {
+                    videoIndex = dom.createElement("property");
+                    videoIndex.setAttribute("name", "video_index");
+                    node.appendChild(videoIndex);
+                }
+                while (videoIndex.hasChildNodes())
+                    videoIndex.removeChild(videoIndex.firstChild());
+                videoIndex.appendChild(dom.createTextNode("-1"));
+            }
+        }
+    }
 
+    const auto label = tr("Analyze %1").arg(Util::baseName(ProxyManager::resource(service)));
+    AnalyzeDelegate *delegate = new AnalyzeDelegate(mltFilter, batch);
+    QPointer<QmlFilter> self(this);
+    auto addJob = [=](AbstractJob *job) {
         // Touch the target .stab file. This prevents multiple jobs from trying
         // to write the same file.
         if (!filename.isEmpty() && !QFile::exists(filename)) {
@@ -526,10 +763,93 @@ void QmlFilter::analyze(bool isAudio, bool deferJob)
             file.write("");
         }
         if (deferJob) {
-            QTimer::singleShot(0, this, [=]() { JOBS.add(job); });
+            QTimer::singleShot(0, delegate, [=]() { JOBS.add(job); });
         } else {
             JOBS.add(job);
         }
+    };
+    auto addWholeJob = [=](const QString &xml) {
+        AbstractJob *job = new MeltJob(targetPath,
+                                       xml,
+                                       MLT.profile().frame_rate_num(),
+                                       MLT.profile().frame_rate_den());
+        connect(job, &AbstractJob::finished, delegate, &AnalyzeDelegate::onAnalyzeFinished);
+        if (self)
+            connect(job, &AbstractJob::finished, self.data(), &QmlFilter::analyzeFinished);
+        job->setLabel(label);
+        job->setBackground();
+        addJob(job);
+    };
+
+    // Stabilize a long clip in segments at the same time and stitch their motions.
+    const int segmentCount
+        = qBound(1,
+                 length / qMax(1, qRound(MLT.profile().fps() * kMinAnalyzeSegmentSeconds)),
+                 JobQueue::jobSlots(AbstractJob::CpuEncodeResource));
+    QDomElement filterNode = isAudio || filename.isEmpty()
+                                     || qstrcmp(mltFilter.get("mlt_service"), "vidstab")
+                                 ? QDomElement()
+                                 : findFilterNode(dom, uuid);
+    if (segmentCount < 2 || filterNode.isNull()) {
+        addWholeJob(dom.toString(2));
+        return;
+    }
+    const QString wholeXml = dom.toString(2);
+    const int filterIn = filterNode.attribute("in", "0").toInt();
+    const int segmentLength = (length + segmentCount - 1) / segmentCount;
+    QStringList partPaths;
+    QList<int> starts;
+    QList<MeltJob *> jobs;
+    for (int i = 0; i < segmentCount; ++i) {
+        // Each segment but the first starts a frame early for the motion into its first frame.
+        const int start = qMax(0, i * segmentLength - 1);
+        const int end = qMin(length, (i + 1) * segmentLength) - 1;
+        const auto partPath = QStringLiteral("%1.part%2").arg(filename).arg(i + 1);
+        filterNode.setAttribute("in", filterIn + start);
+        filterNode.setAttribute("out", filterIn + end);
+        setXmlProperty(dom, filterNode, "filename", partPath);
+        consumerNode.setAttribute("resource", partPath + ".mlt");
+        auto job = new MeltJob(partPath + ".mlt",
+                               dom.toString(2),
+                               MLT.profile().frame_rate_num(),
+                               MLT.profile().frame_rate_den());
+        job->setLabel(tr("%1 segment %2").arg(label).arg(i + 1));
+        job->setBackground();
+        job->setInAndOut(start, end);
+        partPaths << partPath;
+        starts << start;
+        jobs << job;
+    }
+    auto remaining = std::make_shared<int>(segmentCount);
+    auto isFailed = std::make_shared<bool>(false);
+    for (auto job : jobs) {
+        connect(job, &AbstractJob::finished, delegate, [=](AbstractJob *part, bool isSuccess) {
+            *isFailed = *isFailed || !isSuccess;
+            QFile::remove(part->objectName());
+            if (--*remaining > 0)
+                return;
+            const bool isStitched = !*isFailed
+                                    && AnalyzeDelegate::stitchMotions(partPaths, starts, filename);
+            for (const auto &path : partPaths)
+                QFile::remove(path);
+            if (isStitched) {
+                delegate->applyResults(filename);
+                if (self)
+                    emit self->analyzeFinished(true);
+            } else if (!*isFailed) {
+                // The motions are in a format that cannot be joined.
+                LOG_WARNING() << "analyzing" << filename << "without segments";
+                addWholeJob(wholeXml);
+            } else {
+                QFile file(filename);
+                if (file.exists() && file.size() == 0)
+                    file.remove();
+                delegate->applyResults(QString());
+                if (self)
+                    emit self->analyzeFinished(false);
+            }
+        });
+        addJob(job);
     }
 }
 
@@ -621,6 +941,7 @@ void QmlFilter::setAnimateIn(int value)
                     }
                     m_service.clear(qUtf8Printable(name));
                     m_service.set(qUtf8Printable(name), qUtf8Printable(value));
+                    clearKeyframesCache(name);
                 }
             }
         }
@@ -650,6 +971,7 @@ void QmlFilter::setAnimateOut(int value)
                     value = m_service.anim_get(qUtf8Printable(name), 0);
                     m_service.clear(qUtf8Printable(name));
                     m_service.set(qUtf8Printable(name), qUtf8Printable(value));
+                    clearKeyframesCache(name);
                 }
             }
         }
@@ -693,6 +1015,41 @@ Mlt::Animation QmlFilter::getAnimation(const QString &name)
     return Mlt::Animation();
 }
 
+QVector<QmlFilter::Keyframe> QmlFilter::keyframes(const QString &name)
+{
+    Mlt::Animation animation = getAnimation(name);
+    auto it = m_keyframesCache.constFind(name);
+    // Setting the property as a string replaces its animation, so also check that
+    // in case it was changed without a signal.
+    if (it != m_keyframesCache.constEnd() && it->animation == animation.get_animation()
+        && it->keyframes.size() == animation.key_count())
+        return it->keyframes;
+
+    KeyframesCacheEntry entry;
+    entry.animation = animation.get_animation();
+    if (animation.is_valid()) {
+        const int count = animation.key_count();
+        entry.keyframes.reserve(count);
+        for (int i = 0; i < count; i++) {
+            Keyframe keyframe;
+            keyframe.frame = animation.key_get_frame(i);
+            keyframe.type = animation.key_get_type(i);
+            keyframe.value = keyframe.frame >= 0 ? getDouble(name, keyframe.frame) : 0.0;
+            entry.keyframes << keyframe;
+        }
+    }
+    m_keyframesCache.insert(name, entry);
+    return entry.keyframes;
+}
+
+void QmlFilter::clearKeyframesCache(const QString &name)
+{
+    if (name.isEmpty())
+        m_keyframesCache.clear();
+    else
+        m_keyframesCache.remove(name);
+}
+
 int QmlFilter::keyframeCount(const QString &name)
 {
     return getAnimation(name).key_count();
@@ -885,6 +1242,24 @@ void QmlFilter::startUndoModifyKeyframeCommand(int paramIndex, int keyframeIndex
     MAIN.undoStack()->push(command);
 }
 
+void QmlFilter::startUndoSetKeyframesCommand()
+{
+    if (!m_previousState.count()) {
+        //        LOG_DEBUG() << "Undo tracking has not started yet";
+        return;
+    }
+    m_changeInProgress++;
+    if (m_changeInProgress > 1) {
+        //        LOG_DEBUG() << "Nested change command" << m_changeInProgress;
+        return;
+    }
+    auto command = new Filter::UndoSetKeyframesCommand(m_metadata->name(),
+                                                       MAIN.filterController(),
+                                                       MAIN.filterController()->currentIndex(),
+                                                       m_previousState);
+    MAIN.undoStack()->push(command);
+}
+
 void QmlFilter::updateUndoCommand(const QString &name)
 {
     if (!m_previousState.count()) {
@@ -900,7 +1275,7 @@ void QmlFilter::updateUndoCommand(const QString &name)
         const_cast<QUndoCommand *>(lastCommand));
     if (command) {
         // Update the change that is already in progress
-        command->update(name);
+        command->update(name, m_previousState);
     } else {
         LOG_ERROR() << "Unable to find command in progress";
         return;
@@ -952,6 +1327,7 @@ void QmlFilter::setKeyFrameType(const QString &name, int keyIndex, int type)
 {
     Mlt::Animation animation = getAnimation(name);
     animation.key_set_type(keyIndex, (mlt_keyframe_type) type);
+    clearKeyframesCache(name);
 }
 
 int QmlFilter::getNextKeyframePosition(const QString &name, int position)
@@ -1028,13 +1404,19 @@ void QmlFilter::pasteParameters(const QStringList &propertyNames)
     for (const auto &name : propertyNames) {
         if (producer.property_exists(name.toUtf8().constData())) {
             LOG_DEBUG() << name << "=" << producer.get(name.toUtf8().constData());
+            // Record all of the pasted properties as one undo command.
+            if (!isChanged)
+                startUndoParameterCommand(tr("paste parameters"));
             m_service.pass_property(producer, name.toUtf8().constData());
             isChanged = true;
             emit changed(name);
+            updateUndoCommand(name);
         }
     }
-    if (isChanged)
+    if (isChanged) {
+        endUndoCommand();
         emit changed();
+    }
 }
 
 void QmlFilter::crop(const QRectF &rect)
@@ -1042,10 +1424,14 @@ void QmlFilter::crop(const QRectF &rect)
     MAIN.cropSource(rect);
 }
 
-AnalyzeDelegate::AnalyzeDelegate(Mlt::Filter &filter)
+AnalyzeDelegate::AnalyzeDelegate(Mlt::Filter &filter, AnalyzeBatch *batch)
     : QObject(nullptr)
     , m_uuid(filter.get(kShotcutHashProperty))
-{}
+    , m_batch(batch)
+{
+    if (m_batch)
+        m_batch->addJob();
+}
 
 class FindFilterParser : public Mlt::Parser
 {
@@ -1147,47 +1533,109 @@ void AnalyzeDelegate::onAnalyzeFinished(AbstractJob *job, bool isSuccess)
 {
     QString fileName = job->objectName();
 
-    if (isSuccess) {
-        QString results = resultsFromXml(fileName);
-        if (!results.isEmpty()) {
-            // look for filters by UUID in each pending export job.
-            foreach (AbstractJob *job, JOBS.jobs()) {
-                if (!job->ran() && typeid(*job) == typeid(EncodeJob)) {
-                    updateJob(dynamic_cast<EncodeJob *>(job), results);
-                }
-            }
-
-            // Locate filters in memory by UUID.
-            if (MAIN.isMultitrackValid()) {
-                FindFilterParser graphParser(m_uuid);
-                graphParser.start(*MAIN.multitrack());
-                foreach (Mlt::Filter filter, graphParser.filters())
-                    updateFilter(filter, results);
-            }
-            if (MAIN.playlist() && MAIN.playlist()->count() > 0) {
-                FindFilterParser graphParser(m_uuid);
-                graphParser.start(*MAIN.playlist());
-                foreach (Mlt::Filter filter, graphParser.filters())
-                    updateFilter(filter, results);
-            }
-            Mlt::Producer producer(MLT.isClip() ? MLT.producer() : MLT.savedProducer());
-            if (producer.is_valid()) {
-                FindFilterParser graphParser(m_uuid);
-                graphParser.start(producer);
-                foreach (Mlt::Filter filter, graphParser.filters())
-                    updateFilter(filter, results);
-            }
-            emit MAIN.filterController()->attachedModel()->changed();
-        }
-    } else if (!job->property("filename").isNull()) {
+    if (!isSuccess && !job->property("filename").isNull()) {
         QFile file(job->property("filename").toString());
         if (file.exists() && file.size() == 0)
             file.remove();
     }
+    applyResults(isSuccess ? resultsFromXml(fileName) : QString());
     QFile::remove(fileName);
+}
+
+void AnalyzeDelegate::applyResults(const QString &results)
+{
+    if (!results.isEmpty()) {
+        // look for filters by UUID in each pending export job.
+        foreach (AbstractJob *job, JOBS.jobs()) {
+            if (!job->ran() && typeid(*job) == typeid(EncodeJob)) {
+                updateJob(dynamic_cast<EncodeJob *>(job), results);
+            }
+        }
+
+        // Locate filters in memory by UUID.
+        QList<Mlt::Filter> filters;
+        if (MAIN.isMultitrackValid()) {
+            FindFilterParser graphParser(m_uuid);
+            graphParser.start(*MAIN.multitrack());
+            filters << graphParser.filters();
+        }
+        if (MAIN.playlist() && MAIN.playlist()->count() > 0) {
+            FindFilterParser graphParser(m_uuid);
+            graphParser.start(*MAIN.playlist());
+            filters << graphParser.filters();
+        }
+        Mlt::Producer producer(MLT.isClip() ? MLT.producer() : MLT.savedProducer());
+        if (producer.is_valid()) {
+            FindFilterParser graphParser(m_uuid);
+            graphParser.start(producer);
+            filters << graphParser.filters();
+        }
+        if (m_batch) {
+            m_batch->finishJob(filters, results);
+            m_batch.clear();
+        } else {
+            for (auto &filter : filters)
+                updateFilter(filter, results);
+            emit MAIN.filterController()->attachedModel()->changed();
+        }
+    }
+    if (m_batch)
+        m_batch->finishJob(QList<Mlt::Filter>(), QString());
     deleteLater();
 }
 
+bool AnalyzeDelegate::stitchMotions(const QStringList &partPaths,
+                                    const QList<int> &starts,
+                                    const QString &fileName)
+{
+    // vid.stab writes a header and then a line of local motions per frame:
+    // "Frame <number> (List ...)".
+    static const QByteArray kFramePrefix("Frame ");
+    QByteArray stitched;
+    int firstNumber = -1;
+    for (int i = 0; i < partPaths.size(); ++i) {
+        QFile file(partPaths[i]);
+        if (!file.open(QIODevice::ReadOnly) || !file.peek(8).startsWith("VID.STAB")) {
+            LOG_WARNING() << "cannot stitch the motions in" << partPaths[i];
+            return false;
+        }
+        int partFirstNumber = -1;
+        while (!file.atEnd()) {
+            const auto line = file.readLine();
+            if (!line.startsWith(kFramePrefix)) {
+                if (i == 0)
+                    stitched += line;
+                continue;
+            }
+            const int space = line.indexOf(' ', kFramePrefix.size());
+            bool ok = false;
+            const auto digits = line.mid(kFramePrefix.size(), space - kFramePrefix.size());
+            const int number = digits.toInt(&ok);
+            if (!ok || space < 0)
+                return false;
+            if (partFirstNumber < 0)
+                partFirstNumber = number;
+            if (firstNumber < 0)
+                firstNumber = number;
+            // The first frame of the later segments overlaps the previous one.
+            const int frame = starts[i] + number - partFirstNumber;
+            if (i > 0 && frame == starts[i])
+                continue;
+            stitched += kFramePrefix + QByteArray::number(firstNumber + frame) + line.mid(space);
+        }
+        if (partFirstNumber < 0)
+            return false;
+    }
+    QSaveFile file(fileName);
+    if (!file.open(QIODevice::WriteOnly) || file.write(stitched) != stitched.size()
+        || !file.commit()) {
+        LOG_WARNING() << "failed to write" << fileName;
+        return false;
+    }
+    LOG_INFO() << "stitched" << partPaths.size() << "segments of motions into" << fileName;
+    return true;
+}
+
 QString AnalyzeDelegate::resultsFromXml(const QString &fileName)
 {
     // parse the xml
@@ -1251,3 +1699,28 @@ void AnalyzeDelegate::updateFilter(Mlt::Filter &filter, const QString &results)
         }
     }
 }
+
+AnalyzeBatch::AnalyzeBatch(QObject *parent)
+    : QObject(parent)
+    , m_pending(0)
+{}
+
+void AnalyzeBatch::addJob()
+{
+    ++m_pending;
+}
+
+void AnalyzeBatch::finishJob(const QList<Mlt::Filter> &filters, const QString &results)
+{
+    for (const auto &filter : filters) {
+        m_filters << filter;
+        m_results << results;
+    }
+    if (--m_pending > 0)
+        return;
+    LOG_INFO() << "analysis batch finished with results for" << m_filters.size() << "filters";
+    emit finished(m_filters, m_results);
+    if (!m_filters.isEmpty())
+        MAIN.undoStack()->push(new Filter::AnalyzeResultsCommand(m_filters, m_results));
+    deleteLater();
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,16 +22,21 @@
 #include "shotcut_mlt_properties.h"
 
 #include <MltAnimation.h>
+#include <MltFilter.h>
 #include <MltProducer.h>
 #include <MltService.h>
 #include <QColor>
+#include <QHash>
 #include <QObject>
+#include <QPointer>
 #include <QRectF>
 #include <QString>
 #include <QUuid>
 #include <QVariant>
+#include <QVector>
 
 class AbstractJob;
+class AnalyzeBatch;
 class EncodeJob;
 class QUndoCommand;
 class FilterController;
@@ -98,6 +103,17 @@ public:
                          int position = -1,
                          mlt_keyframe_type keyframeType = mlt_keyframe_type(-1));
     Q_INVOKABLE void setGradient(QString name, const QStringList &gradient);
+    struct KeyframeValue
+    {
+        int position;
+        QVariant value; ///< a number, rectangle or color
+        mlt_keyframe_type type;
+    };
+    /// Sets many keyframes of \a name at once with a single change
+    /// notification and undo command.
+    void setKeyframes(const QString &name, const QVector<KeyframeValue> &keyframes);
+    /// Takes a list of objects with position, value and optional type.
+    Q_INVOKABLE void setKeyframes(const QString &name, const QVariantList &keyframes);
     QString path() const { return m_path; }
     Q_INVOKABLE void loadPresets();
     QStringList presets() const { return m_presets; }
@@ -105,6 +121,8 @@ public:
     Q_INVOKABLE int savePreset(const QStringList &propertyNames, const QString &name = QString());
     Q_INVOKABLE void deletePreset(const QString &name);
     Q_INVOKABLE void analyze(bool isAudio = false, bool deferJob = true);
+    //! Adds the analysis job to \a batch, which writes the results of all its jobs at once.
+    void analyze(bool isAudio, bool deferJob, AnalyzeBatch *batch);
     Q_INVOKABLE static int framesFromTime(const QString &time);
     Q_INVOKABLE void getHash();
     Mlt::Producer &producer() { return m_producer; }
@@ -120,6 +138,15 @@ public:
     Q_INVOKABLE void resetProperty(const QString &name);
     Q_INVOKABLE void clearSimpleAnimation(const QString &name);
     Mlt::Animation getAnimation(const QString &name);
+    struct Keyframe
+    {
+        int frame;
+        mlt_keyframe_type type;
+        double value;
+    };
+    /// Returns the keyframes of the property \a name, which are read once and
+    /// kept until the property changes so that views can look up any row.
+    QVector<Keyframe> keyframes(const QString &name);
     Q_INVOKABLE int keyframeCount(const QString &name);
     mlt_keyframe_type getKeyframeType(Mlt::Animation &animation,
                                       int position,
@@ -146,11 +173,14 @@ public:
     void startUndoAddKeyframeCommand();
     void startUndoRemoveKeyframeCommand();
     void startUndoModifyKeyframeCommand(int paramIndex, int keyframeIndex);
+    void startUndoSetKeyframesCommand();
     void updateUndoCommand(const QString &name);
     Q_INVOKABLE void endUndoCommand();
 
 public slots:
     void preset(const QString &name);
+    /// Forgets the keyframes read for \a name, or for all properties if empty.
+    void clearKeyframesCache(const QString &name = QString());
 
 signals:
     void presetsChanged();
@@ -173,6 +203,12 @@ private:
     QStringList m_presets;
     Mlt::Properties m_previousState;
     int m_changeInProgress;
+    struct KeyframesCacheEntry
+    {
+        mlt_animation animation;
+        QVector<Keyframe> keyframes;
+    };
+    QHash<QString, KeyframesCacheEntry> m_keyframesCache;
 
     int keyframeIndex(Mlt::Animation &animation, int position);
 };
@@ -181,17 +217,55 @@ class AnalyzeDelegate : public QObject
 {
     Q_OBJECT
 public:
-    explicit AnalyzeDelegate(Mlt::Filter &filter);
+    explicit AnalyzeDelegate(Mlt::Filter &filter, AnalyzeBatch *batch = nullptr);
+    static void updateFilter(Mlt::Filter &filter, const QString &results);
+    //! Writes \a results to the filters and deletes itself; empty results mean a failure.
+    void applyResults(const QString &results);
+    /*!
+      Joins the vid.stab motion files of consecutive segments that start at
+      the frames in \a starts into \a fileName. The segments after the first
+      start a frame before the end of the previous one.
+    */
+    static bool stitchMotions(const QStringList &partPaths,
+                              const QList<int> &starts,
+                              const QString &fileName);
 
 public slots:
     void onAnalyzeFinished(AbstractJob *job, bool isSuccess);
 
 private:
     QString resultsFromXml(const QString &fileName);
-    void updateFilter(Mlt::Filter &filter, const QString &results);
     void updateJob(EncodeJob *job, const QString &results);
 
     QUuid m_uuid;
+    QPointer<AnalyzeBatch> m_batch;
+};
+
+/*!
+  \class AnalyzeBatch
+  \brief Collects the results of many analysis jobs into one undo command.
+
+  The jobs run concurrently in the slots of the job queue. Once the last one
+  has finished, the results of all of them are written to their filters and
+  the player is refreshed once, so that the whole batch is undone as one step.
+  It deletes itself after that.
+*/
+
+class AnalyzeBatch : public QObject
+{
+    Q_OBJECT
+public:
+    explicit AnalyzeBatch(QObject *parent = nullptr);
+    void addJob();
+    void finishJob(const QList<Mlt::Filter> &filters, const QString &results);
+
+signals:
+    void finished(const QList<Mlt::Filter> &filters, const QStringList &results);
+
+private:
+    int m_pending;
+    QList<Mlt::Filter> m_filters;
+    QStringList m_results;
 };
 
 #endif // FILTER_H
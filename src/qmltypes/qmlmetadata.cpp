@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -175,6 +175,31 @@ void QmlMetadata::setIsOutputOnly(bool isOutputOnly)
     m_isOutputOnly = isOutputOnly;
 }
 
+void QmlMetadata::save(QDataStream &stream) const
+{
+    stream << objectName() << qint32(m_type) << m_name << m_mlt_service << m_needsGPU
+           << m_qmlFileName << m_vuiFileName << m_isAudio << m_isHidden << m_isFavorite
+           << m_gpuAlt << m_allowMultiple << m_isClipOnly << m_isTrackOnly << m_isOutputOnly
+           << m_isGpuCompatible << m_isDeprecated << m_minimumVersion << m_keywords << m_icon
+           << m_seekReverse << m_identity << m_imageFormats;
+    m_keyframes.save(stream);
+}
+
+bool QmlMetadata::load(QDataStream &stream)
+{
+    QString name;
+    qint32 type;
+    stream >> name >> type >> m_name >> m_mlt_service >> m_needsGPU >> m_qmlFileName
+        >> m_vuiFileName >> m_isAudio >> m_isHidden >> m_isFavorite >> m_gpuAlt >> m_allowMultiple
+        >> m_isClipOnly >> m_isTrackOnly >> m_isOutputOnly >> m_isGpuCompatible >> m_isDeprecated
+        >> m_minimumVersion >> m_keywords >> m_icon >> m_seekReverse >> m_identity
+        >> m_imageFormats;
+    setObjectName(name);
+    m_type = PluginType(type);
+    m_keyframes.load(stream);
+    return stream.status() == QDataStream::Ok;
+}
+
 bool QmlMetadata::isMltVersion(const QString &version)
 {
     if (!m_minimumVersion.isEmpty()) {
@@ -217,6 +242,28 @@ void QmlKeyframesMetadata::setDisabled()
     m_enabled = m_allowAnimateIn = m_allowAnimateOut = false;
 }
 
+void QmlKeyframesMetadata::save(QDataStream &stream) const
+{
+    stream << m_allowTrim << m_allowAnimateIn << m_allowAnimateOut << m_simpleProperties
+           << m_minimumVersion << m_enabled << m_allowOvershoot << qint32(m_parameters.size());
+    for (const auto parameter : m_parameters)
+        parameter->save(stream);
+}
+
+void QmlKeyframesMetadata::load(QDataStream &stream)
+{
+    qint32 count = 0;
+    stream >> m_allowTrim >> m_allowAnimateIn >> m_allowAnimateOut >> m_simpleProperties
+        >> m_minimumVersion >> m_enabled >> m_allowOvershoot >> count;
+    qDeleteAll(m_parameters);
+    m_parameters.clear();
+    for (int i = 0; i < count && stream.status() == QDataStream::Ok; ++i) {
+        auto parameter = new QmlKeyframesParameter(this);
+        parameter->load(stream);
+        m_parameters << parameter;
+    }
+}
+
 QmlKeyframesParameter::QmlKeyframesParameter(QObject *parent)
     : QObject(parent)
     , m_isCurve(false)
@@ -227,3 +274,18 @@ QmlKeyframesParameter::QmlKeyframesParameter(QObject *parent)
     , m_rangeType(MinMax)
     , m_isColor(false)
 {}
+
+void QmlKeyframesParameter::save(QDataStream &stream) const
+{
+    stream << qint32(m_rangeType) << m_name << m_property << m_gangedProperties
+           << m_gangedRectProperties << m_isCurve << m_minimum << m_maximum << m_units
+           << m_isRectangle << m_isColor;
+}
+
+void QmlKeyframesParameter::load(QDataStream &stream)
+{
+    qint32 rangeType;
+    stream >> rangeType >> m_name >> m_property >> m_gangedProperties >> m_gangedRectProperties
+        >> m_isCurve >> m_minimum >> m_maximum >> m_units >> m_isRectangle >> m_isColor;
+    m_rangeType = RangeType(rangeType);
+}
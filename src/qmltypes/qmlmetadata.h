@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,11 +18,13 @@
 #ifndef QMLMETADATA_H
 #define QMLMETADATA_H
 
+#include <QDataStream>
 #include <QDir>
 #include <QObject>
 #include <QQmlListProperty>
 #include <QString>
 #include <QUrl>
+#include <QVariantMap>
 
 class QmlKeyframesParameter : public QObject
 {
@@ -58,6 +60,8 @@ public:
     bool isRectangle() const { return m_isRectangle; }
     RangeType rangeType() const { return m_rangeType; }
     bool isColor() const { return m_isColor; }
+    void save(QDataStream &stream) const;
+    void load(QDataStream &stream);
 
 signals:
     void changed();
@@ -106,6 +110,8 @@ public:
     Q_INVOKABLE QmlKeyframesParameter *parameter(const QString &propertyName) const;
     void checkVersion(const QString &version);
     void setDisabled();
+    void save(QDataStream &stream) const;
+    void load(QDataStream &stream);
 
 signals:
     void changed();
@@ -147,6 +153,10 @@ class QmlMetadata : public QObject
     Q_PROPERTY(QString keywords MEMBER m_keywords NOTIFY changed)
     Q_PROPERTY(QString icon READ iconFilePath WRITE setIconFileName NOTIFY changed)
     Q_PROPERTY(bool seekReverse MEMBER m_seekReverse NOTIFY changed)
+    /// identity maps the properties of a filter to the values at which it does not change the frame.
+    Q_PROPERTY(QVariantMap identity MEMBER m_identity NOTIFY changed)
+    /// imageFormats lists the MLT image formats the filter processes without converting, best first.
+    Q_PROPERTY(QStringList imageFormats MEMBER m_imageFormats NOTIFY changed)
 
 public:
     enum PluginType {
@@ -211,6 +221,12 @@ public:
     bool isMltVersion(const QString &version);
     QString keywords() const { return m_keywords; }
     bool seekReverse() const { return m_seekReverse; }
+    QVariantMap identity() const { return m_identity; }
+    QStringList imageFormats() const { return m_imageFormats; }
+    //! Writes what the metadata file sets so that load() can skip compiling it.
+    void save(QDataStream &stream) const;
+    //! Returns false if \a stream does not hold what save() wrote.
+    bool load(QDataStream &stream);
 
 signals:
     void changed();
@@ -238,6 +254,8 @@ private:
     QString m_keywords;
     QString m_icon;
     bool m_seekReverse;
+    QVariantMap m_identity;
+    QStringList m_imageFormats;
 };
 
 #endif // QMLMETADATA_H
@@ -98,8 +98,9 @@ QVariant QmlProducer::audioLevels()
 {
     if (!m_producer.is_valid())
         return QVariant();
-    if (m_producer.get_data(kAudioLevelsProperty))
-        return QVariant::fromValue(*((QVariantList *) m_producer.get_data(kAudioLevelsProperty)));
+    auto levels = AudioLevelsTask::levels(m_producer);
+    if (!levels.isEmpty())
+        return QVariant::fromValue(levels);
     else
         return QVariant();
 }
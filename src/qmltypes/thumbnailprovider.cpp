@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2023 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -21,11 +21,18 @@
 #include "database.h"
 #include "mltcontroller.h"
 #include "models/playlistmodel.h"
+#include "performancecounters.h"
 #include "settings.h"
+#include "thumbnaildecoderpool.h"
 #include "util.h"
 
 #include <QCryptographicHash>
+#include <QPainter>
 #include <QQuickImageProvider>
+#include <QtMath>
+
+static const QLatin1String kStripPrefix("strip/");
+static const int kMaxStripCount = 64;
 
 ThumbnailProvider::ThumbnailProvider()
     : QQuickImageProvider(QQmlImageProviderBase::Image,
@@ -38,6 +45,7 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
     QImage result;
 
     // id is [hash]/mlt_service/resource#frameNumber[!]
+    // or strip/count/[hash]/mlt_service/resource#in-out[!] for a filmstrip
     // optional trailing '!' means to force update
     int index = id.lastIndexOf('#');
 
@@ -46,37 +54,44 @@ QImage ThumbnailProvider::requestImage(const QString &id, QSize *size, const QSi
         bool force = id.endsWith('!');
         if (force)
             myId = id.left(id.size() - 1);
+        int stripCount = 0;
+        if (myId.startsWith(kStripPrefix)) {
+            stripCount = qBound(1, myId.section('/', 1, 1).toInt(), kMaxStripCount);
+            myId = myId.section('/', 2);
+            index = myId.lastIndexOf('#');
+        }
         QString hash = myId.section('/', 0, 0);
         QString service = myId.section('/', 1, 1);
         QString resource = myId.section('/', 2);
-        int frameNumber = myId.mid(index + 1).toInt();
+        QString frames = myId.mid(index + 1);
+        int frameNumber = frames.section('-', 0, 0).toInt();
         Mlt::Properties properties;
 
-        // Scale the frameNumber to ThumbnailProvider profile's fps.
-        frameNumber = qRound(frameNumber / MLT.profile().fps() * m_profile.fps());
-
         resource = resource.left(resource.lastIndexOf('#'));
         resource = Util::removeQueryString(resource);
         properties.set("_profile", m_profile.get_profile(), 0);
 
-        QString key = cacheKey(properties, service, resource, hash, frameNumber);
-        result = DB.getThumbnail(key);
-        if (force || result.isNull()) {
-            if (service == "avformat-novalidate")
-                service = "avformat";
-            else if (service.startsWith("xml"))
-                service = "xml-nogl";
-            Mlt::Producer producer;
-            if (service == "count") {
-                producer = Mlt::Producer(m_profile, service.toUtf8().constData(), "loader-nogl");
-            } else if (!Settings.playerGPU() || (service != "xml-nogl" && service != "consumer")) {
-                producer = Mlt::Producer(m_profile,
-                                         service.toUtf8().constData(),
-                                         resource.toUtf8().constData());
-            }
-            if (producer.is_valid()) {
-                result = makeThumbnail(producer, frameNumber, requestedSize);
-                DB.putThumbnail(key, result);
+        if (stripCount > 0) {
+            int out = frames.section('-', 1, 1).toInt();
+            result = makeStrip(properties,
+                               service,
+                               resource,
+                               hash,
+                               frameNumber,
+                               out,
+                               stripCount,
+                               force);
+        } else {
+            // Scale the frameNumber to ThumbnailProvider profile's fps.
+            frameNumber = qRound(frameNumber / MLT.profile().fps() * m_profile.fps());
+
+            QString key = cacheKey(properties, service, resource, hash, frameNumber);
+            result = DB.getThumbnail(key);
+            if (force || result.isNull()) {
+                result = makeThumbnail(service, resource, frameNumber, requestedSize);
+                PerformanceCounters::add(PerformanceCounters::ThumbnailsGenerated);
+                if (!result.isNull())
+                    DB.putThumbnail(key, result);
             }
         }
     }
@@ -108,16 +123,16 @@ QString ThumbnailProvider::cacheKey(Mlt::Properties &properties,
     } else {
         key = QStringLiteral("%1 %2").arg(hash).arg(time);
     }
+    if (ThumbnailDecoderPool::isFastSeek(ThumbnailDecoderPool::DefaultSeek))
+        key += QStringLiteral(" fast");
     return key;
 }
 
-QImage ThumbnailProvider::makeThumbnail(Mlt::Producer &producer,
+QImage ThumbnailProvider::makeThumbnail(const QString &service,
+                                        const QString &resource,
                                         int frameNumber,
                                         const QSize &requestedSize)
 {
-    Mlt::Filter scaler(m_profile, "swscale");
-    Mlt::Filter padder(m_profile, "resize");
-    Mlt::Filter converter(m_profile, "avcolor_space");
     int height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
     int width = PlaylistModel::THUMBNAIL_WIDTH * 2;
 
@@ -126,8 +141,68 @@ QImage ThumbnailProvider::makeThumbnail(Mlt::Producer &producer,
         height = requestedSize.height();
     }
 
-    producer.attach(scaler);
-    producer.attach(padder);
-    producer.attach(converter);
-    return MLT.image(producer, frameNumber, width, height);
+    return ThumbnailDecoderPool::singleton()
+        .image(service, resource, frameNumber, width, height, ThumbnailDecoderPool::DefaultSeek);
+}
+
+// Renders the frames that are not cached in one pass on a shared decoder and
+// lays them out side by side, so that a clip needs one request and texture.
+QImage ThumbnailProvider::makeStrip(Mlt::Properties &properties,
+                                    const QString &service,
+                                    const QString &resource,
+                                    const QString &hash,
+                                    int in,
+                                    int out,
+                                    int count,
+                                    bool force)
+{
+    const int height = PlaylistModel::THUMBNAIL_HEIGHT * 2;
+    const int width = PlaylistModel::THUMBNAIL_WIDTH * 2;
+    const double duration = qMax(1, out - in + 1);
+
+    // Each thumbnail shows the frame at its left edge.
+    QList<int> frameNumbers;
+    QStringList keys;
+    QList<QImage> images;
+    QList<int> missing;
+    for (int i = 0; i < count; ++i) {
+        int frameNumber = in + qFloor(duration * i / count);
+        frameNumber = qRound(frameNumber / MLT.profile().fps() * m_profile.fps());
+        frameNumbers << frameNumber;
+        keys << cacheKey(properties, service, resource, hash, frameNumber);
+        images << (force ? QImage() : DB.getThumbnail(keys.last()));
+        if (images.last().isNull())
+            missing << frameNumber;
+    }
+    if (!missing.isEmpty()) {
+        auto rendered = ThumbnailDecoderPool::singleton()
+                            .images(service,
+                                    resource,
+                                    missing,
+                                    width,
+                                    height,
+                                    ThumbnailDecoderPool::DefaultSeek);
+        PerformanceCounters::add(PerformanceCounters::ThumbnailsGenerated, missing.size());
+        for (int i = 0, j = 0; i < count && j < rendered.size(); ++i) {
+            if (!images[i].isNull() || frameNumbers[i] != missing[j])
+                continue;
+            images[i] = rendered[j++];
+            if (!images[i].isNull())
+                DB.putThumbnail(keys[i], images[i]);
+        }
+    }
+
+    QImage result(width * count, height, QImage::Format_ARGB32_Premultiplied);
+    result.fill(Qt::transparent);
+    QPainter painter(&result);
+    for (int i = 0; i < count; ++i) {
+        if (images[i].isNull())
+            continue;
+        const auto image
+            = images[i].scaled(width, height, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+        painter.drawImage(i * width + (width - image.width()) / 2,
+                          (height - image.height()) / 2,
+                          image);
+    }
+    return result;
 }
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2016 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  * Author: Dan Dennedy <dan@dennedy.org>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -28,14 +28,26 @@ class ThumbnailProvider : public QQuickImageProvider
 public:
     explicit ThumbnailProvider();
     QImage requestImage(const QString &id, QSize *size, const QSize &requestedSize);
+    //! Returns the key of a thumbnail in the database.
+    static QString cacheKey(Mlt::Properties &properties,
+                            const QString &service,
+                            const QString &resource,
+                            const QString &hash,
+                            int frameNumber);
 
 private:
-    QString cacheKey(Mlt::Properties &properties,
+    QImage makeThumbnail(const QString &service,
+                         const QString &resource,
+                         int frameNumber,
+                         const QSize &requestedSize);
+    QImage makeStrip(Mlt::Properties &properties,
                      const QString &service,
                      const QString &resource,
                      const QString &hash,
-                     int frameNumber);
-    QImage makeThumbnail(Mlt::Producer &, int frameNumber, const QSize &requestedSize);
+                     int in,
+                     int out,
+                     int count,
+                     bool force);
     Mlt::Profile m_profile;
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2020 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,13 +19,19 @@
 
 #include "Logger.h"
 #include "mltcontroller.h"
-#include "settings.h"
+#include "models/audiolevels.h"
+#include "models/keyframesmodel.h"
 
 #include <QLinearGradient>
 #include <QPainter>
 #include <QPainterPath>
 #include <QPalette>
+#include <QPointer>
+#include <QQuickItem>
 #include <QQuickPaintedItem>
+#include <QSGFlatColorMaterial>
+#include <QSGGeometryNode>
+#include <QtMath>
 
 class TimelineTransition : public QQuickPaintedItem
 {
@@ -89,10 +95,10 @@ public:
     }
 };
 
-class TimelineWaveform : public QQuickPaintedItem
+class TimelineWaveform : public QQuickItem
 {
     Q_OBJECT
-    Q_PROPERTY(QVariant levels MEMBER m_audioLevels NOTIFY propertyChanged)
+    Q_PROPERTY(QVariant levels READ levels WRITE setLevels NOTIFY propertyChanged)
     Q_PROPERTY(QColor fillColor MEMBER m_color NOTIFY propertyChanged)
     Q_PROPERTY(int inPoint MEMBER m_inPoint NOTIFY inPointChanged)
     Q_PROPERTY(int outPoint MEMBER m_outPoint NOTIFY outPointChanged)
@@ -101,46 +107,54 @@ class TimelineWaveform : public QQuickPaintedItem
 public:
     TimelineWaveform()
     {
-        setAntialiasing(false);
-        setOpaquePainting(true);
-        if (Settings.timelineFramebufferWaveform())
-            setRenderTarget(QQuickPaintedItem::FramebufferObject);
+        setFlag(QQuickItem::ItemHasContents);
         connect(this, SIGNAL(propertyChanged()), this, SLOT(update()));
+        connect(this, SIGNAL(inPointChanged()), this, SLOT(invalidateGeometry()));
+        connect(this, SIGNAL(outPointChanged()), this, SLOT(invalidateGeometry()));
+        connect(this, SIGNAL(propertyChanged()), this, SLOT(prioritizeVisible()));
+        connect(this, SIGNAL(inPointChanged()), this, SLOT(prioritizeVisible()));
+        connect(this, SIGNAL(outPointChanged()), this, SLOT(prioritizeVisible()));
     }
 
-    void paint(QPainter *painter)
+    QVariant levels() const { return m_audioLevels; }
+    void setLevels(const QVariant &levels)
     {
-        if (!m_isActive)
-            return;
-        QVariantList data = m_audioLevels.toList();
-        if (data.isEmpty())
-            return;
-
-        // In and out points are # frames at current fps,
-        // but audio levels are created at 25 fps.
-        // Scale in and out point to 25 fps.
-        const int inPoint = qRound(m_inPoint / MLT.profile().fps() * 25.0);
-        const int outPoint = qRound(m_outPoint / MLT.profile().fps() * 25.0);
-        const qreal indicesPrPixel = qreal(outPoint - inPoint) / width();
-
-        //        LOG_DEBUG() << "In/out points" << inPoint << "/" << outPoint;
+        m_audioLevels = levels;
+        m_isGeometryDirty = true;
+        emit propertyChanged();
+    }
 
-        QPainterPath path;
-        path.moveTo(-1, height());
-        int i = 0;
-        for (; i < width(); ++i) {
-            int idx = inPoint + int(i * indicesPrPixel);
-            if ((idx < 0) || (idx + 2 >= data.length()))
-                break;
-            qreal level = qMax(data.at(idx).toReal(), data.at(idx + 1).toReal()) / 256;
-            path.lineTo(i, height() - level * height());
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
+    {
+        // The fill is a triangle strip between the bottom edge and the levels
+        // with the outline as a child line strip. Both stay on the GPU until
+        // the levels, in and out points, or size change.
+        auto fillNode = static_cast<QSGGeometryNode *>(oldNode);
+        if (!fillNode) {
+            fillNode = createNode(QSGGeometry::DrawTriangleStrip);
+            fillNode->appendChildNode(createNode(QSGGeometry::DrawLineStrip));
+            m_isGeometryDirty = true;
         }
-        path.lineTo(i, height());
-        painter->fillPath(path, m_color.lighter());
+        auto lineNode = static_cast<QSGGeometryNode *>(fillNode->firstChild());
+        setColor(fillNode, m_color.lighter());
+        setColor(lineNode, m_color.darker());
+        if (m_isActive && m_isGeometryDirty) {
+            updateGeometry(fillNode->geometry(), lineNode->geometry());
+            fillNode->markDirty(QSGNode::DirtyGeometry);
+            lineNode->markDirty(QSGNode::DirtyGeometry);
+            m_isGeometryDirty = false;
+        }
+        return fillNode;
+    }
 
-        QPen pen(painter->pen());
-        pen.setColor(m_color.darker());
-        painter->strokePath(path, pen);
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override
+    {
+        if (newGeometry.size() != oldGeometry.size()) {
+            m_isGeometryDirty = true;
+            update();
+        }
+        QQuickItem::geometryChange(newGeometry, oldGeometry);
     }
 
 signals:
@@ -148,12 +162,233 @@ signals:
     void inPointChanged();
     void outPointChanged();
 
+private slots:
+    void invalidateGeometry()
+    {
+        m_isGeometryDirty = true;
+        update();
+    }
+
+    void prioritizeVisible()
+    {
+        // Ask for what is on screen first while the levels are generated.
+        if (!m_isActive)
+            return;
+        const auto data = m_audioLevels.value<AudioLevels>();
+        if (data.isGenerating()) {
+            int inFrame, outFrame;
+            frameRange(data, inFrame, outFrame);
+            data.prioritize(inFrame, outFrame);
+        }
+    }
+
 private:
+    void frameRange(const AudioLevels &data, int &inFrame, int &outFrame) const
+    {
+        // In and out points are # values (frames times channels) at current fps,
+        // but audio levels are created at 25 fps.
+        // Scale in and out point to 25 fps frames.
+        const qreal scale = 25.0 / MLT.profile().fps() / qMax(1, data.channels());
+        inFrame = qRound(m_inPoint * scale);
+        outFrame = qRound(m_outPoint * scale);
+    }
+
+    static QSGGeometryNode *createNode(unsigned int drawingMode)
+    {
+        auto node = new QSGGeometryNode;
+        auto geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+        geometry->setDrawingMode(drawingMode);
+        geometry->setLineWidth(1);
+        node->setGeometry(geometry);
+        node->setFlag(QSGNode::OwnsGeometry);
+        node->setMaterial(new QSGFlatColorMaterial);
+        node->setFlag(QSGNode::OwnsMaterial);
+        return node;
+    }
+
+    static void setColor(QSGGeometryNode *node, const QColor &color)
+    {
+        auto material = static_cast<QSGFlatColorMaterial *>(node->material());
+        if (material->color() != color) {
+            material->setColor(color);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+    }
+
+    void updateGeometry(QSGGeometry *fill, QSGGeometry *line) const
+    {
+        QVector<float> levels;
+        const auto data = m_audioLevels.value<AudioLevels>();
+        if (!data.isEmpty() && width() > 0) {
+            int inFrame, outFrame;
+            frameRange(data, inFrame, outFrame);
+            // This follows the timeline zoom; with the pyramid each pixel reads
+            // only a few values however far out it is zoomed.
+            const qreal framesPerPixel = qreal(outFrame - inFrame) / width();
+            levels.reserve(qCeil(width()));
+            for (int i = 0; i < width(); ++i) {
+                const int from = inFrame + int(i * framesPerPixel);
+                const int to = inFrame + int((i + 1) * framesPerPixel);
+                if ((from < 0) || (from >= data.frameCount()))
+                    break;
+                levels << data.summary(from, qMax(from + 1, to)) / 256.0f;
+            }
+        }
+
+        const float h = height();
+        fill->allocate(2 * levels.size());
+        line->allocate(levels.size());
+        auto fillVertices = fill->vertexDataAsPoint2D();
+        auto lineVertices = line->vertexDataAsPoint2D();
+        for (int i = 0; i < levels.size(); ++i) {
+            const float y = h - levels[i] * h;
+            fillVertices[2 * i].set(i, h);
+            fillVertices[2 * i + 1].set(i, y);
+            lineVertices[i].set(i, y);
+        }
+    }
+
     QVariant m_audioLevels;
     int m_inPoint;
     int m_outPoint;
     QColor m_color;
     bool m_isActive{true};
+    bool m_isGeometryDirty{true};
+};
+
+class KeyframeCurve : public QQuickItem
+{
+    Q_OBJECT
+    Q_PROPERTY(KeyframesModel *model READ model WRITE setModel NOTIFY modelChanged)
+    Q_PROPERTY(int parameterIndex MEMBER m_parameterIndex NOTIFY propertyChanged)
+    Q_PROPERTY(double minimum MEMBER m_minimum NOTIFY propertyChanged)
+    Q_PROPERTY(double maximum MEMBER m_maximum NOTIFY propertyChanged)
+    // Pixels per frame
+    Q_PROPERTY(double timeScale MEMBER m_timeScale NOTIFY propertyChanged)
+    // The frame at x = 0, relative to the filter
+    Q_PROPERTY(int startFrame MEMBER m_startFrame NOTIFY propertyChanged)
+    // The height of a keyframe, which is centered on the value
+    Q_PROPERTY(double margin MEMBER m_margin NOTIFY propertyChanged)
+    Q_PROPERTY(double visibleX MEMBER m_visibleX NOTIFY propertyChanged)
+    Q_PROPERTY(double visibleWidth MEMBER m_visibleWidth NOTIFY propertyChanged)
+    Q_PROPERTY(QColor color MEMBER m_color NOTIFY colorChanged)
+
+public:
+    KeyframeCurve()
+    {
+        setFlag(QQuickItem::ItemHasContents);
+        connect(this, SIGNAL(propertyChanged()), this, SLOT(invalidateGeometry()));
+        connect(this, SIGNAL(colorChanged()), this, SLOT(update()));
+    }
+
+    KeyframesModel *model() const { return m_model; }
+    void setModel(KeyframesModel *model)
+    {
+        if (m_model == model)
+            return;
+        if (m_model)
+            disconnect(m_model, nullptr, this, nullptr);
+        m_model = model;
+        if (m_model) {
+            connect(m_model, SIGNAL(dataChanged(QModelIndex, QModelIndex, QList<int>)),
+                    this, SLOT(invalidateGeometry()));
+            connect(m_model, SIGNAL(modelReset()), this, SLOT(invalidateGeometry()));
+            connect(m_model, SIGNAL(rowsInserted(QModelIndex, int, int)),
+                    this, SLOT(invalidateGeometry()));
+            connect(m_model, SIGNAL(rowsRemoved(QModelIndex, int, int)),
+                    this, SLOT(invalidateGeometry()));
+        }
+        invalidateGeometry();
+        emit modelChanged();
+    }
+
+protected:
+    QSGNode *updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *) override
+    {
+        // Only the visible part of the curve is sampled, one point per pixel
+        // or frame, whichever is farther apart.
+        auto node = static_cast<QSGGeometryNode *>(oldNode);
+        if (!node) {
+            node = new QSGGeometryNode;
+            auto geometry = new QSGGeometry(QSGGeometry::defaultAttributes_Point2D(), 0);
+            geometry->setDrawingMode(QSGGeometry::DrawLineStrip);
+            geometry->setLineWidth(1);
+            node->setGeometry(geometry);
+            node->setFlag(QSGNode::OwnsGeometry);
+            node->setMaterial(new QSGFlatColorMaterial);
+            node->setFlag(QSGNode::OwnsMaterial);
+            m_isGeometryDirty = true;
+        }
+        auto material = static_cast<QSGFlatColorMaterial *>(node->material());
+        if (material->color() != m_color) {
+            material->setColor(m_color);
+            node->markDirty(QSGNode::DirtyMaterial);
+        }
+        if (m_isGeometryDirty) {
+            updateGeometry(node->geometry());
+            node->markDirty(QSGNode::DirtyGeometry);
+            m_isGeometryDirty = false;
+        }
+        return node;
+    }
+
+    void geometryChange(const QRectF &newGeometry, const QRectF &oldGeometry) override
+    {
+        if (newGeometry.size() != oldGeometry.size())
+            invalidateGeometry();
+        QQuickItem::geometryChange(newGeometry, oldGeometry);
+    }
+
+signals:
+    void modelChanged();
+    void propertyChanged();
+    void colorChanged();
+
+private slots:
+    void invalidateGeometry()
+    {
+        m_isGeometryDirty = true;
+        update();
+    }
+
+private:
+    void updateGeometry(QSGGeometry *geometry) const
+    {
+        QVector<QPointF> points;
+        const double left = qMax(0.0, m_visibleX);
+        const double right = m_visibleWidth > 0.0 ? qMin(width(), m_visibleX + m_visibleWidth)
+                                                  : width();
+        if (m_model && m_timeScale > 0.0 && right > left) {
+            points = m_model->curve(m_parameterIndex,
+                                    left / m_timeScale - m_startFrame,
+                                    right / m_timeScale - m_startFrame,
+                                    1.0 / m_timeScale);
+        }
+        // This matches how a keyframe is placed on its track.
+        const double middle = height() / 2.0;
+        const double range = m_maximum - m_minimum;
+        geometry->allocate(points.size());
+        auto vertices = geometry->vertexDataAsPoint2D();
+        for (int i = 0; i < points.size(); ++i) {
+            const double y = range != 0.0 ? middle
+                                                + (0.5 - (points[i].y() - m_minimum) / range)
+                                                      * (height() - m_margin)
+                                          : middle;
+            vertices[i].set((points[i].x() + m_startFrame) * m_timeScale, y);
+        }
+    }
+
+    QPointer<KeyframesModel> m_model;
+    int m_parameterIndex{0};
+    double m_minimum{0.0};
+    double m_maximum{1.0};
+    double m_timeScale{1.0};
+    int m_startFrame{0};
+    double m_margin{0.0};
+    double m_visibleX{0.0};
+    double m_visibleWidth{0.0};
+    QColor m_color;
+    bool m_isGeometryDirty{true};
 };
 
 class MarkerStart : public QQuickPaintedItem
@@ -221,6 +456,7 @@ void registerTimelineItems()
     qmlRegisterType<TimelinePlayhead>("Shotcut.Controls", 1, 0, "TimelinePlayhead");
     qmlRegisterType<TimelineTriangle>("Shotcut.Controls", 1, 0, "TimelineTriangle");
     qmlRegisterType<TimelineWaveform>("Shotcut.Controls", 1, 0, "TimelineWaveform");
+    qmlRegisterType<KeyframeCurve>("Shotcut.Controls", 1, 0, "KeyframeCurve");
     qmlRegisterType<MarkerStart>("Shotcut.Controls", 1, 0, "MarkerStart");
     qmlRegisterType<MarkerEnd>("Shotcut.Controls", 1, 0, "MarkerEnd");
 }
@@ -0,0 +1,271 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "recentfilecache.h"
+
+#include "Logger.h"
+#include "database.h"
+#include "projectarchive.h"
+#include "shotcut_mlt_properties.h"
+#include "thumbnaildecoderpool.h"
+
+#include <QBuffer>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QThreadPool>
+#include <QTime>
+#include <QTimer>
+
+static const int kVolumeTimeoutMs = 2000;
+static const qint64 kValiditySecs = 60;
+static const qint64 kMaxPreviewFileSize = 32 * 1024 * 1024;
+static const int kThumbnailHeight = 72;
+
+static bool isProject(const QString &path)
+{
+    return path.endsWith(".mlt") || ProjectArchive::isArchive(path);
+}
+
+// Returns the seconds of an MLT clock time like 00:01:02.500.
+static double seconds(const QString &time)
+{
+    const auto parts = time.split(':');
+    if (parts.size() != 3)
+        return 0.0;
+    return parts[0].toInt() * 3600.0 + parts[1].toInt() * 60.0 + parts[2].toDouble();
+}
+
+static bool makePreview(const QJsonObject &index, RecentFileCache::Preview &preview)
+{
+    const auto tractors = index["tractors"].toArray();
+    if (tractors.isEmpty())
+        return false;
+    // The XML consumer writes the root tractor last.
+    const auto tractor = tractors.last().toObject();
+    preview.duration = qMax(0.0,
+                            seconds(tractor["out"].toString()) - seconds(tractor["in"].toString()));
+
+    QHash<QString, QString> hashes;
+    for (const auto &value : index["producers"].toArray()) {
+        const auto producer = value.toObject();
+        hashes.insert(producer["id"].toString(), producer[kShotcutHashProperty].toString());
+    }
+    QHash<QString, QJsonArray> playlists;
+    for (const auto &value : index["playlists"].toArray()) {
+        const auto playlist = value.toObject();
+        playlists.insert(playlist["id"].toString(), playlist["entries"].toArray());
+    }
+    preview.trackCount = 0;
+    for (const auto &value : tractor["tracks"].toArray()) {
+        const auto id = value.toString();
+        if (id == "background")
+            continue;
+        ++preview.trackCount;
+        if (!preview.thumbnail.isNull())
+            continue;
+        // Use the thumbnail of the first clip if the cache already has it.
+        for (const auto &entryValue : playlists.value(id)) {
+            const auto entry = entryValue.toObject();
+            const auto hash = hashes.value(entry["producer"].toString());
+            if (entry.contains("blank") || hash.isEmpty())
+                continue;
+            auto time = entry["in"].toString();
+            auto key = QStringLiteral("%1 %2").arg(hash, time.left(time.size() - 1));
+            if (ThumbnailDecoderPool::isFastSeek(ThumbnailDecoderPool::DefaultSeek))
+                key += QStringLiteral(" fast");
+            const auto image = DB.getThumbnail(key);
+            if (!image.isNull())
+                preview.thumbnail = image.scaledToHeight(kThumbnailHeight, Qt::SmoothTransformation);
+            break;
+        }
+    }
+    return true;
+}
+
+RecentFileCache &RecentFileCache::singleton()
+{
+    static RecentFileCache instance;
+    return instance;
+}
+
+RecentFileCache::RecentFileCache(QObject *parent)
+    : QObject(parent)
+    // The pool is never deleted because that would wait for a hung check.
+    , m_pool(new QThreadPool)
+{
+    m_pool->setMaxThreadCount(8);
+    m_pool->setExpiryTimeout(10000);
+}
+
+RecentFileCache::State RecentFileCache::state(const QString &path)
+{
+    auto it = m_entries.constFind(path);
+    if (it == m_entries.constEnd()
+        || QDateTime::currentSecsSinceEpoch() - it->checked > kValiditySecs) {
+        enqueue(path);
+        it = m_entries.constFind(path);
+    }
+    return it == m_entries.constEnd() ? Unknown : it->state;
+}
+
+void RecentFileCache::validate(const QStringList &paths)
+{
+    for (const auto &path : paths) {
+        if (!path.isEmpty())
+            state(path);
+    }
+}
+
+QString RecentFileCache::toolTip(const QString &path)
+{
+    const auto text = QDir::toNativeSeparators(path).toHtmlEscaped();
+    const auto entry = m_entries.value(path);
+    state(path);
+    switch (entry.state) {
+    case Missing:
+        return QStringLiteral("<p>%1</p><p>%2</p>").arg(text, tr("The file does not exist."));
+    case Unreachable:
+        return QStringLiteral("<p>%1</p><p>%2</p>")
+            .arg(text, tr("The drive or network share is not responding."));
+    default:
+        break;
+    }
+    if (!entry.hasPreview)
+        return QStringLiteral("<p>%1</p>").arg(text);
+
+    QString result = QStringLiteral("<p>%1</p><p>%2<br>%3</p>")
+                         .arg(text,
+                              tr("Duration: %1")
+                                  .arg(QTime(0, 0)
+                                           .addMSecs(qRound64(entry.preview.duration * 1000.0))
+                                           .toString("hh:mm:ss")),
+                              tr("%n track(s)", nullptr, entry.preview.trackCount));
+    if (!entry.preview.thumbnail.isNull()) {
+        QByteArray png;
+        QBuffer buffer(&png);
+        buffer.open(QIODevice::WriteOnly);
+        entry.preview.thumbnail.save(&buffer, "PNG");
+        result += QStringLiteral("<img src=\"data:image/png;base64,%1\">")
+                      .arg(QString::fromLatin1(png.toBase64()));
+    }
+    return result;
+}
+
+// The storage of a path is not known without touching it, so this takes the
+// share of a UNC path, the drive of a Windows path, or else the first two
+// folders, like /Volumes/Media or /mnt/nas.
+QString RecentFileCache::volume(const QString &path)
+{
+    if (path.startsWith("//"))
+        return QStringLiteral("//") + path.mid(2).section('/', 0, 1);
+    if (path.size() >= 2 && path[1] == ':')
+        return path.left(2).toUpper();
+    return path.section('/', 0, 2);
+}
+
+RecentFileCache::Result RecentFileCache::inspect(const QString &path)
+{
+    Result result{QFileInfo::exists(path), false, Preview{0.0, 0, QImage()}};
+    if (result.exists && isProject(path)) {
+        QJsonObject index;
+        if (ProjectArchive::isArchive(path)) {
+            index = ProjectArchive::readIndex(path);
+        } else {
+            QFile file(path);
+            if (file.size() <= kMaxPreviewFileSize && file.open(QIODevice::ReadOnly))
+                index = ProjectArchive::index(file.readAll());
+        }
+        result.hasPreview = makePreview(index, result.preview);
+    }
+    return result;
+}
+
+void RecentFileCache::enqueue(const QString &path)
+{
+    const auto key = volume(path);
+    auto &v = m_volumes[key];
+    if (v.isUnreachable) {
+        setState(path, Unreachable);
+        return;
+    }
+    if (v.current == path || v.queue.contains(path))
+        return;
+    v.queue << path;
+    startNext(key);
+}
+
+void RecentFileCache::startNext(const QString &volumeKey)
+{
+    auto &v = m_volumes[volumeKey];
+    if (v.isBusy || v.queue.isEmpty())
+        return;
+    v.current = v.queue.takeFirst();
+    v.isBusy = true;
+    const int generation = ++v.generation;
+    const auto path = v.current;
+    m_pool->start([=]() {
+        const auto result = inspect(path);
+        QMetaObject::invokeMethod(
+            this, [=]() { onInspected(volumeKey, path, result); }, Qt::QueuedConnection);
+    });
+    QTimer::singleShot(kVolumeTimeoutMs, this, [=]() { onTimeout(volumeKey, generation); });
+}
+
+void RecentFileCache::onTimeout(const QString &volumeKey, int generation)
+{
+    auto &v = m_volumes[volumeKey];
+    if (!v.isBusy || v.generation != generation || v.isUnreachable)
+        return;
+    LOG_WARNING() << "not responding" << volumeKey;
+    v.isUnreachable = true;
+    const auto paths = QStringList(v.current) + v.queue;
+    v.queue.clear();
+    for (const auto &path : paths)
+        setState(path, Unreachable);
+}
+
+void RecentFileCache::onInspected(const QString &volumeKey,
+                                  const QString &path,
+                                  const Result &result)
+{
+    auto &v = m_volumes[volumeKey];
+    v.isBusy = false;
+    v.current.clear();
+    if (v.isUnreachable) {
+        LOG_INFO() << "responding again" << volumeKey;
+        v.isUnreachable = false;
+    }
+    auto &entry = m_entries[path];
+    entry.hasPreview = result.hasPreview;
+    entry.preview = result.preview;
+    setState(path, result.exists ? Available : Missing);
+    if (result.hasPreview)
+        emit previewChanged(path);
+    startNext(volumeKey);
+}
+
+void RecentFileCache::setState(const QString &path, State state)
+{
+    auto &entry = m_entries[path];
+    const bool isChanged = entry.state != state;
+    entry.state = state;
+    entry.checked = QDateTime::currentSecsSinceEpoch();
+    if (isChanged)
+        emit stateChanged(path, state);
+}
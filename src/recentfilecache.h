@@ -0,0 +1,108 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RECENTFILECACHE_H
+#define RECENTFILECACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QObject>
+#include <QString>
+#include <QStringList>
+
+class QThreadPool;
+
+/*!
+  \class RecentFileCache
+  \brief Checks in the background whether the recent files still exist.
+
+  Touching a file on an unmounted or sleeping network share can block for a
+  long time, so the checks run on threads of their own, one at a time per
+  volume. A volume that does not answer within a timeout is reported as
+  unreachable together with the files queued behind it, and it is not
+  touched again until the pending check returns. The results are kept for a
+  minute. Projects also get a preview of their duration, track count and a
+  thumbnail from the thumbnail cache, which is read from the project index.
+*/
+
+class RecentFileCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum State { Unknown, Available, Missing, Unreachable };
+
+    struct Preview
+    {
+        double duration; ///< In seconds
+        int trackCount;
+        QImage thumbnail;
+    };
+
+    static RecentFileCache &singleton();
+
+    //! Returns the last known state of \a path and checks it again when stale.
+    State state(const QString &path);
+    void validate(const QStringList &paths);
+    //! Returns the rich text tool tip of \a path with its preview when known.
+    QString toolTip(const QString &path);
+
+signals:
+    void stateChanged(const QString &path, RecentFileCache::State state);
+    void previewChanged(const QString &path);
+
+private:
+    explicit RecentFileCache(QObject *parent = nullptr);
+
+    struct Entry
+    {
+        State state{Unknown};
+        qint64 checked{0}; ///< In seconds since the epoch
+        bool hasPreview{false};
+        Preview preview{};
+    };
+    struct Volume
+    {
+        QStringList queue;
+        QString current;
+        int generation{0};
+        bool isBusy{false};
+        bool isUnreachable{false};
+    };
+    struct Result
+    {
+        bool exists;
+        bool hasPreview;
+        Preview preview;
+    };
+
+    static QString volume(const QString &path);
+    static Result inspect(const QString &path);
+    void enqueue(const QString &path);
+    void startNext(const QString &volumeKey);
+    void onTimeout(const QString &volumeKey, int generation);
+    void onInspected(const QString &volumeKey, const QString &path, const Result &result);
+    void setState(const QString &path, State state);
+
+    QThreadPool *m_pool;
+    QHash<QString, Entry> m_entries;
+    QHash<QString, Volume> m_volumes;
+};
+
+#define RECENT_FILES RecentFileCache::singleton()
+
+#endif // RECENTFILECACHE_H
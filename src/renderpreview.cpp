@@ -0,0 +1,306 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "renderpreview.h"
+
+#include "Logger.h"
+#include "jobqueue.h"
+#include "jobs/meltjob.h"
+#include "mltcontroller.h"
+#include "models/multitrackmodel.h"
+#include "settings.h"
+#include "shotcut_mlt_properties.h"
+
+#include <QCryptographicHash>
+#include <QDomDocument>
+#include <QFile>
+#include <QRegularExpression>
+#include <QThread>
+
+#include <algorithm>
+
+static const char *kRenderPreviewSubfolder = "previews";
+static const char *kRenderPreviewExtension = ".mkv";
+static const char *kRenderPreviewPendingExtension = ".pending.mkv";
+static const char *kRenderPreviewFileProperty = "renderPreviewFile";
+
+RenderPreview::RenderPreview(MultitrackModel &model, QObject *parent)
+    : QObject(parent)
+    , m_model(model)
+    , m_isInstalled(false)
+{
+    // The track must be gone before the timeline changes or is closed.
+    connect(&m_model, &MultitrackModel::modified, this, &RenderPreview::onModified);
+    connect(&m_model,
+            &MultitrackModel::trackStateChanged,
+            this,
+            [this](int, bool isOutputChanged) {
+                if (isOutputChanged)
+                    onModified();
+            });
+    connect(&m_model, &MultitrackModel::aboutToClose, this, &RenderPreview::uninstall);
+    connect(&m_model, &MultitrackModel::closed, this, [this]() { m_timelineHash.clear(); });
+}
+
+QDir RenderPreview::dir()
+{
+    QDir dir(Settings.appDataLocation());
+    if (!dir.cd(kRenderPreviewSubfolder)) {
+        if (dir.mkdir(kRenderPreviewSubfolder))
+            dir.cd(kRenderPreviewSubfolder);
+    }
+    return dir;
+}
+
+bool RenderPreview::filterXML(QString &xml)
+{
+    if (!xml.contains(QLatin1String(kRenderPreviewTrackId)))
+        return false;
+    QDomDocument dom;
+    if (!dom.setContent(xml))
+        return false;
+
+    // Remove the track, its playlist, and the producers of the rendered files.
+    bool isFiltered = false;
+    QSet<QString> producers;
+    QDomNodeList playlists = dom.elementsByTagName("playlist");
+    for (int i = playlists.length() - 1; i >= 0; --i) {
+        QDomElement playlist = playlists.at(i).toElement();
+        if (playlist.attribute("id") != kRenderPreviewTrackId)
+            continue;
+        QDomNodeList entries = playlist.elementsByTagName("entry");
+        for (int j = 0; j < entries.length(); ++j)
+            producers << entries.at(j).toElement().attribute("producer");
+        playlist.parentNode().removeChild(playlist);
+        isFiltered = true;
+    }
+    if (!isFiltered)
+        return false;
+    QDomNodeList tracks = dom.elementsByTagName("track");
+    for (int i = tracks.length() - 1; i >= 0; --i) {
+        QDomElement track = tracks.at(i).toElement();
+        if (track.attribute("producer") == kRenderPreviewTrackId)
+            track.parentNode().removeChild(track);
+    }
+    for (const auto &tag : {"producer", "chain"}) {
+        QDomNodeList nodes = dom.elementsByTagName(tag);
+        for (int i = nodes.length() - 1; i >= 0; --i) {
+            QDomElement node = nodes.at(i).toElement();
+            if (producers.contains(node.attribute("id")))
+                node.parentNode().removeChild(node);
+        }
+    }
+    xml = dom.toString(2);
+    return true;
+}
+
+QList<RenderPreview::Zone> RenderPreview::zones() const
+{
+    QList<Zone> result;
+    if (!m_model.tractor())
+        return result;
+    const auto value = QString::fromUtf8(m_model.tractor()->get(kRenderPreviewZonesProperty));
+    for (const auto &range : value.split(';', Qt::SkipEmptyParts)) {
+        const auto parts = range.split('-');
+        if (parts.size() != 2)
+            continue;
+        Zone zone{parts[0].toInt(), parts[1].toInt()};
+        if (zone.end > zone.start)
+            result << zone;
+    }
+    return result;
+}
+
+void RenderPreview::setZones(const QList<Zone> &zones)
+{
+    QStringList ranges;
+    for (const auto &zone : zones)
+        ranges << QStringLiteral("%1-%2").arg(zone.start).arg(zone.end);
+    if (ranges.isEmpty())
+        m_model.tractor()->clear(kRenderPreviewZonesProperty);
+    else
+        m_model.tractor()->set(kRenderPreviewZonesProperty, ranges.join(';').toUtf8().constData());
+}
+
+void RenderPreview::addZone(int start, int end)
+{
+    if (!m_model.tractor() || end <= start)
+        return;
+    auto list = zones();
+    Zone added{start, end};
+    QList<Zone> result;
+    for (const auto &zone : list) {
+        if (zone.end < added.start || zone.start > added.end) {
+            result << zone;
+        } else {
+            added.start = qMin(added.start, zone.start);
+            added.end = qMax(added.end, zone.end);
+        }
+    }
+    result << added;
+    std::sort(result.begin(), result.end(), [](const Zone &a, const Zone &b) {
+        return a.start < b.start;
+    });
+    setZones(result);
+}
+
+void RenderPreview::clearZones()
+{
+    uninstall();
+    if (m_model.tractor())
+        setZones(QList<Zone>());
+}
+
+QString RenderPreview::hash(const Zone &zone)
+{
+    if (m_timelineHash.isEmpty()) {
+        // Timeline view settings and the zones themselves do not change the output.
+        static const QRegularExpression ignored(
+            QStringLiteral("<property name=\"(%1|%2|%3|%4)\">[^<]*</property>")
+                .arg(kTimelineScaleProperty,
+                     kTrackHeightProperty,
+                     kTrackHeaderWidthProperty,
+                     kRenderPreviewZonesProperty));
+        auto xml = MLT.XML(m_model.tractor(), true);
+        xml.remove(ignored);
+        m_timelineHash = QString::fromLatin1(
+            QCryptographicHash::hash(xml.toUtf8(), QCryptographicHash::Md5).toHex());
+    }
+    const auto key = QStringLiteral("%1:%2:%3").arg(m_timelineHash).arg(zone.start).arg(zone.end);
+    return QString::fromLatin1(
+        QCryptographicHash::hash(key.toLatin1(), QCryptographicHash::Md5).toHex());
+}
+
+QString RenderPreview::filePath(const Zone &zone, bool pending)
+{
+    return dir().filePath(hash(zone)
+                          + (pending ? kRenderPreviewPendingExtension : kRenderPreviewExtension));
+}
+
+bool RenderPreview::isReady(const Zone &zone)
+{
+    return QFile::exists(filePath(zone));
+}
+
+void RenderPreview::renderAll()
+{
+    if (!m_model.tractor())
+        return;
+    const auto list = zones();
+    if (list.isEmpty())
+        return;
+    QString xml;
+    for (const auto &zone : list) {
+        const auto pending = filePath(zone, true);
+        if (isReady(zone) || m_pending.contains(pending) || QFile::exists(pending))
+            continue;
+        if (xml.isEmpty())
+            xml = MLT.XML(m_model.tractor(), true);
+        QDomDocument dom;
+        if (!dom.setContent(xml)) {
+            LOG_WARNING() << "failed to parse the timeline XML for a render preview";
+            return;
+        }
+
+        // Every frame is a key frame, so seeking within the file is cheap.
+        QDomElement consumerNode = dom.createElement("consumer");
+        QDomNodeList profiles = dom.elementsByTagName("profile");
+        if (profiles.isEmpty())
+            dom.documentElement().insertAfter(consumerNode, dom.documentElement());
+        else
+            dom.documentElement().insertAfter(consumerNode, profiles.at(profiles.length() - 1));
+        consumerNode.setAttribute("mlt_service", "avformat");
+        consumerNode.setAttribute("target", pending);
+        consumerNode.setAttribute("f", "matroska");
+        consumerNode.setAttribute("vcodec", "mjpeg");
+        consumerNode.setAttribute("qscale", 2);
+        consumerNode.setAttribute("pix_fmt", "yuvj422p");
+        consumerNode.setAttribute("acodec", "pcm_s16le");
+        consumerNode.setAttribute("channels", MLT.audioChannels());
+        consumerNode.setAttribute("real_time", -qMax(1, QThread::idealThreadCount() / 2));
+
+        auto job = new MeltJob(pending,
+                               dom.toString(2),
+                               MLT.profile().frame_rate_num(),
+                               MLT.profile().frame_rate_den());
+        job->setInAndOut(zone.start, zone.end - 1);
+        job->setLabel(tr("Render preview %1")
+                          .arg(QString::fromLatin1(
+                              m_model.tractor()->frames_to_time(zone.start, mlt_time_clock))));
+        job->setProperty(kRenderPreviewFileProperty, filePath(zone));
+        job->setBackground();
+        connect(job, &AbstractJob::finished, this, &RenderPreview::onJobFinished);
+        m_pending << pending;
+        JOBS.add(job);
+    }
+}
+
+void RenderPreview::install()
+{
+    if (m_isInstalled || !m_model.tractor() || !MLT.isMultitrack())
+        return;
+    const auto list = zones();
+    if (list.isEmpty())
+        return;
+
+    Mlt::Playlist playlist(MLT.profile());
+    int position = 0;
+    for (const auto &zone : list) {
+        if (zone.start < position || !isReady(zone))
+            continue;
+        Mlt::Producer clip(MLT.profile(), "avformat", filePath(zone).toUtf8().constData());
+        if (!clip.is_valid())
+            continue;
+        if (zone.start > position)
+            playlist.blank(zone.start - position - 1);
+        playlist.append(clip, 0, zone.end - zone.start - 1);
+        position = zone.end;
+    }
+    if (playlist.count() > 0) {
+        LOG_DEBUG() << "installing" << playlist.count() << "render preview clips";
+        m_model.insertRenderPreviewTrack(playlist);
+        m_isInstalled = true;
+    }
+}
+
+void RenderPreview::uninstall()
+{
+    if (m_isInstalled) {
+        m_model.removeRenderPreviewTrack();
+        m_isInstalled = false;
+    }
+}
+
+void RenderPreview::onModified()
+{
+    uninstall();
+    m_timelineHash.clear();
+}
+
+void RenderPreview::onJobFinished(AbstractJob *job, bool isSuccess)
+{
+    const auto pending = job->objectName();
+    m_pending.remove(pending);
+    if (isSuccess) {
+        const auto target = job->property(kRenderPreviewFileProperty).toString();
+        QFile::remove(target);
+        if (!QFile::rename(pending, target))
+            LOG_WARNING() << "failed to rename" << pending << "to" << target;
+    } else {
+        QFile::remove(pending);
+    }
+}
@@ -0,0 +1,93 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RENDERPREVIEW_H
+#define RENDERPREVIEW_H
+
+#include <QDir>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QString>
+
+class AbstractJob;
+class MultitrackModel;
+
+/*!
+  \class RenderPreview
+  \brief The RenderPreview renders sections of the timeline in the background
+  so that they play in real time.
+
+  A render preview zone is a range of timeline frames. Each zone is rendered by
+  a melt job into an intra-frame file whose name is a hash of the timeline XML
+  and the range, so a file is only ever used for the exact timeline it was
+  rendered from. The zones are kept in a property of the tractor and saved with
+  the project.
+
+  While the timeline plays, the zones that have a file are placed on a hidden
+  track above all of the others. The tractor takes the frames of the topmost
+  track that is not blank, so the stacked tracks below a zone are not rendered.
+  The track is removed when playback pauses or stops and before the timeline
+  changes, and it is never written to the project because filterXML() removes
+  it from serialized XML.
+*/
+
+class RenderPreview : public QObject
+{
+    Q_OBJECT
+public:
+    struct Zone
+    {
+        int start; ///< The first frame
+        int end;   ///< One past the last frame
+    };
+
+    explicit RenderPreview(MultitrackModel &model, QObject *parent = nullptr);
+
+    static QDir dir();
+    /// Removes the render preview track from MLT \a xml and returns whether it did.
+    static bool filterXML(QString &xml);
+
+    QList<Zone> zones() const;
+    /// Adds a zone for the frames [\a start, \a end) and merges it with the zones it overlaps.
+    void addZone(int start, int end);
+    void clearZones();
+    /// Starts a job for every zone that does not have a file for the current timeline.
+    void renderAll();
+    bool isReady(const Zone &zone);
+    bool isInstalled() const { return m_isInstalled; }
+
+public slots:
+    void install();
+    void uninstall();
+
+private slots:
+    void onModified();
+    void onJobFinished(AbstractJob *job, bool isSuccess);
+
+private:
+    void setZones(const QList<Zone> &zones);
+    QString hash(const Zone &zone);
+    QString filePath(const Zone &zone, bool pending = false);
+
+    MultitrackModel &m_model;
+    QString m_timelineHash;
+    QSet<QString> m_pending;
+    bool m_isInstalled;
+};
+
+#endif // RENDERPREVIEW_H
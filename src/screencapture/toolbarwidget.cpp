@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -17,6 +17,8 @@
 
 #include "toolbarwidget.h"
 #include "screencapture.h"
+#include "settings.h"
+
 #include <QCheckBox>
 #include <QDebug>
 #include <QGuiApplication>
@@ -65,6 +67,12 @@ ScreenCaptureToolbar::ScreenCaptureToolbar(bool isRecordingMode, QWidget *parent
     // Create checkboxes
     m_minimizeCheckbox = new QCheckBox(tr("Minimize Shotcut"), this);
     m_audioCheckbox = new QCheckBox(tr("Record Audio"), this);
+    m_replayCheckbox = new QCheckBox(tr("Keep Only Last %n Minute(s)",
+                                        nullptr,
+                                        Settings.screenCaptureReplayMinutes()),
+                                     this);
+    m_replayCheckbox->setToolTip(
+        tr("Record continuously and save only the end of the recording when stopped"));
 
     // Style checkboxes
     QString checkboxStyle = "QCheckBox {"
@@ -89,8 +97,13 @@ ScreenCaptureToolbar::ScreenCaptureToolbar(bool isRecordingMode, QWidget *parent
 
     m_minimizeCheckbox->setStyleSheet(checkboxStyle);
     m_audioCheckbox->setStyleSheet(checkboxStyle);
+    m_replayCheckbox->setStyleSheet(checkboxStyle);
     m_minimizeCheckbox->setChecked(true); // Default to minimize
     m_audioCheckbox->setChecked(true);    // Default to record audio
+    m_replayCheckbox->setChecked(Settings.screenCaptureReplay());
+    connect(m_replayCheckbox, &QCheckBox::toggled, this, [](bool checked) {
+        Settings.setScreenCaptureReplay(checked);
+    });
 
     // Create layout
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -137,6 +150,17 @@ ScreenCaptureToolbar::ScreenCaptureToolbar(bool isRecordingMode, QWidget *parent
     } else {
         m_audioCheckbox->hide();
     }
+    // Only the FFmpeg recording can keep the end of the recording.
+#ifdef Q_OS_WIN
+    const bool withReplayCheckbox = false;
+#else
+    const bool withReplayCheckbox = m_isRecordingMode && !ScreenCapture::isWayland();
+#endif
+    if (withReplayCheckbox) {
+        checkboxLayout->addWidget(m_replayCheckbox);
+    } else {
+        m_replayCheckbox->hide();
+    }
     mainLayout->addLayout(checkboxLayout);
 
     // Position at top center of screen
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2025 Meltytech, LLC
+ * Copyright (c) 2025-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -50,6 +50,7 @@ private:
     QPushButton *m_windowButton;
     QCheckBox *m_minimizeCheckbox;
     QCheckBox *m_audioCheckbox;
+    QCheckBox *m_replayCheckbox;
 };
 
 #endif // TOOLBARWIDGET_H
@@ -17,6 +17,7 @@
 
 #include "scrubbar.h"
 
+#include "filmstrip.h"
 #include "mltcontroller.h"
 #include "settings.h"
 
@@ -41,9 +42,18 @@ ScrubBar::ScrubBar(QWidget *parent)
     , m_timecodeWidth(0)
     , m_loopStart(-1)
     , m_loopEnd(-1)
+    , m_preview(new QLabel(this, Qt::ToolTip | Qt::FramelessWindowHint))
+    , m_previewPosition(-1)
 {
     setMouseTracking(true);
     setMinimumHeight(fontMetrics().height() + selectionSize);
+    m_preview->setAttribute(Qt::WA_ShowWithoutActivating);
+    m_preview->setAttribute(Qt::WA_TransparentForMouseEvents);
+    // Show the frame under the mouse once its filmstrip has been rendered.
+    connect(&Filmstrip::singleton(), &Filmstrip::ready, this, [this]() {
+        if (m_previewPosition >= 0 && underMouse())
+            showPreview(m_previewPoint, m_previewPosition);
+    });
 }
 
 void ScrubBar::setScale(int maximum)
@@ -118,8 +128,16 @@ void ScrubBar::setLoopRange(int start, int end)
     updatePixmap();
 }
 
+void ScrubBar::setPreviewProducer(Mlt::Producer *producer)
+{
+    m_previewProducer = producer ? Mlt::Producer(*producer) : Mlt::Producer();
+    m_previewPosition = -1;
+    m_preview->hide();
+}
+
 void ScrubBar::mousePressEvent(QMouseEvent *event)
 {
+    m_preview->hide();
     int x = event->position().x() - m_margin;
     int in = m_in * m_scale;
     int out = m_out * m_scale;
@@ -178,12 +196,53 @@ void ScrubBar::mouseMoveEvent(QMouseEvent *event)
             emit paused(pos);
         emit seeked(pos);
     } else if (event->buttons() == Qt::NoButton && MLT.producer()) {
-        QString text = QString::fromLatin1(
-            MLT.producer()->frames_to_time(pos, Settings.timeFormat()));
-        QToolTip::showText(event->globalPosition().toPoint(), text);
+        if (!showPreview(event->globalPosition().toPoint(), pos)) {
+            QString text = QString::fromLatin1(
+                MLT.producer()->frames_to_time(pos, Settings.timeFormat()));
+            QToolTip::showText(event->globalPosition().toPoint(), text);
+        }
     }
 }
 
+void ScrubBar::leaveEvent(QEvent *event)
+{
+    m_previewPosition = -1;
+    m_preview->hide();
+    QWidget::leaveEvent(event);
+}
+
+// Shows the frame at \a position from the filmstrip with its time above the
+// mouse and returns whether the filmstrip has it.
+bool ScrubBar::showPreview(const QPoint &globalPoint, int position)
+{
+    m_previewPoint = globalPoint;
+    m_previewPosition = m_previewProducer.is_valid() ? position : -1;
+    auto image = m_previewProducer.is_valid()
+                     ? Filmstrip::singleton().frame(m_previewProducer, position)
+                     : QImage();
+    if (image.isNull() || !MLT.producer()) {
+        m_preview->hide();
+        return false;
+    }
+    QToolTip::hideText();
+    const auto text = QString::fromLatin1(
+        MLT.producer()->frames_to_time(position, Settings.timeFormat()));
+    // The font of the scrub bar is scaled for its pixmap.
+    const int textHeight = m_preview->fontMetrics().height();
+    const QRect band(0, image.height() - textHeight, image.width(), textHeight);
+    QPainter p(&image);
+    p.setFont(m_preview->font());
+    p.fillRect(band, QColor(0, 0, 0, 160));
+    p.setPen(Qt::white);
+    p.drawText(band, Qt::AlignCenter, text);
+    p.end();
+    m_preview->setPixmap(QPixmap::fromImage(image));
+    m_preview->adjustSize();
+    m_preview->move(globalPoint - QPoint(m_preview->width() / 2, m_preview->height() + 8));
+    m_preview->show();
+    return true;
+}
+
 bool ScrubBar::onSeek(int value)
 {
     if (m_activeControl != CONTROL_HEAD)
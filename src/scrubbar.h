@@ -18,8 +18,11 @@
 #ifndef SCRUBBAR_H
 #define SCRUBBAR_H
 
+#include <MltProducer.h>
 #include <QWidget>
 
+class QLabel;
+
 class ScrubBar : public QWidget
 {
     Q_OBJECT
@@ -41,6 +44,8 @@ public:
     QList<int> markers() const { return m_markers; }
     void setMargin(int margin) { m_margin = margin; }
     void setLoopRange(int start, int end);
+    //! Shows the frames of the filmstrip of \a producer on hover, or none if null.
+    void setPreviewProducer(Mlt::Producer *producer);
 
 signals:
     void paused(int);
@@ -55,6 +60,7 @@ protected:
     virtual void paintEvent(QPaintEvent *e);
     virtual void resizeEvent(QResizeEvent *);
     virtual bool event(QEvent *event);
+    virtual void leaveEvent(QEvent *event);
 
 private:
     int m_cursorPosition;
@@ -73,8 +79,13 @@ private:
     QList<int> m_markers;
     int m_loopStart;
     int m_loopEnd;
+    Mlt::Producer m_previewProducer;
+    QLabel *m_preview;
+    int m_previewPosition;
+    QPoint m_previewPoint;
 
     void updatePixmap();
+    bool showPreview(const QPoint &globalPoint, int position);
 };
 
 #endif // SCRUBBAR_H
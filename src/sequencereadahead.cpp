@@ -0,0 +1,455 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sequencereadahead.h"
+
+#include "Logger.h"
+#include "mainwindow.h"
+#include "mltcontroller.h"
+#include "settings.h"
+#include "shotcut_mlt_properties.h"
+#include "util.h"
+
+#include <Mlt.h>
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QRegularExpression>
+#include <QSemaphore>
+#include <QSet>
+#include <QThreadPool>
+#include <QtMath>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+static const char *kSequenceReadAheadProperty = "_shotcut:sequenceReadAhead";
+static const int kScheduleDelayMs = 500;
+// The images read ahead of the playhead at normal speed.
+static const int kReadAheadImages = 8;
+static const int kMaxSpeedFactor = 4;
+static const int kReadSize = 4 * 1024 * 1024;
+
+namespace {
+
+struct Sequence
+{
+    QMutex mutex;
+    mlt_profile profile{nullptr};
+    QByteArray service;
+    QByteArray resource; ///< What the clones open, with the first number
+    QString pattern;     ///< The path of the files with a printf-style number
+    int begin{0};
+    int ttl{1};
+    int length{0};
+    QList<mlt_producer> clones; ///< The idle clones
+    // The state of the reads, which only process() changes.
+    int position{-1};
+    QSet<int> read;
+    std::shared_ptr<std::atomic<int>> generation{std::make_shared<std::atomic<int>>(0)};
+
+    ~Sequence()
+    {
+        for (auto clone : clones)
+            mlt_producer_close(clone);
+    }
+};
+
+struct Decode
+{
+    mlt_frame worker{nullptr};
+    QSemaphore done;
+    int error{1};
+    uint8_t *image{nullptr};
+    mlt_image_format format{mlt_image_rgba};
+    int width{0};
+    int height{0};
+};
+
+class SequenceParser : public Mlt::Parser
+{
+public:
+    QList<Mlt::Producer> &producers() { return m_producers; }
+
+    int on_start_producer(Mlt::Producer *producer)
+    {
+        if (MLT.isImageProducer(producer) && producer->get_int(kShotcutSequenceProperty)) {
+            // The filter goes on the parent, which renders the frames of the cuts.
+            if (producer->is_cut())
+                m_producers << Mlt::Producer(producer->parent());
+            else
+                m_producers << Mlt::Producer(*producer);
+        }
+        return 0;
+    }
+    int on_start_filter(Mlt::Filter *) { return 0; }
+    int on_end_producer(Mlt::Producer *) { return 0; }
+    int on_start_playlist(Mlt::Playlist *) { return 0; }
+    int on_end_playlist(Mlt::Playlist *) { return 0; }
+    int on_start_tractor(Mlt::Tractor *) { return 0; }
+    int on_end_tractor(Mlt::Tractor *) { return 0; }
+    int on_start_multitrack(Mlt::Multitrack *) { return 0; }
+    int on_end_multitrack(Mlt::Multitrack *) { return 0; }
+    int on_start_track() { return 0; }
+    int on_end_track() { return 0; }
+    int on_end_filter(Mlt::Filter *) { return 0; }
+    int on_start_transition(Mlt::Transition *) { return 0; }
+    int on_end_transition(Mlt::Transition *) { return 0; }
+    int on_start_chain(Mlt::Chain *) { return 0; }
+    int on_end_chain(Mlt::Chain *) { return 0; }
+    int on_start_link(Mlt::Link *) { return 0; }
+    int on_end_link(Mlt::Link *) { return 0; }
+
+private:
+    QList<Mlt::Producer> m_producers;
+};
+
+} // namespace
+
+// The pools are never deleted because the frames may outlive the app.
+static QThreadPool &decodePool()
+{
+    static auto instance = [] {
+        auto pool = new QThreadPool;
+        pool->setMaxThreadCount(qBound(2, QThread::idealThreadCount() / 2, 8));
+        return pool;
+    }();
+    return *instance;
+}
+
+static QThreadPool &readPool()
+{
+    static auto instance = [] {
+        auto pool = new QThreadPool;
+        pool->setMaxThreadCount(2);
+        return pool;
+    }();
+    return *instance;
+}
+
+static Sequence *sequenceOf(mlt_filter filter)
+{
+    return static_cast<Sequence *>(mlt_properties_get_data(MLT_FILTER_PROPERTIES(filter),
+                                                           kSequenceReadAheadProperty,
+                                                           nullptr));
+}
+
+static void closeSequence(void *data)
+{
+    delete static_cast<Sequence *>(data);
+}
+
+static void closeDecode(void *data)
+{
+    auto decode = static_cast<Decode *>(data);
+    decode->done.acquire();
+    if (decode->worker)
+        mlt_frame_close(decode->worker);
+    delete decode;
+}
+
+// Returns the path of the image \a index of \a pattern, such as img%04d.png.
+static QString imagePath(const QString &pattern, int index)
+{
+    static const QRegularExpression re("%(0?)(\\d*)d");
+    const auto match = re.match(pattern);
+    if (!match.hasMatch())
+        return QString();
+    const auto number = QString::number(index).rightJustified(match.captured(2).toInt(),
+                                                               match.captured(1).isEmpty()
+                                                                   ? QChar(' ')
+                                                                   : QChar('0'));
+    return QString(pattern).replace(match.capturedStart(), match.capturedLength(), number);
+}
+
+// Reads the file to keep it in the disk cache for the decoder.
+static void readFile(const QString &path,
+                     const std::shared_ptr<std::atomic<int>> &generation,
+                     int current)
+{
+    if (*generation != current)
+        return;
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+    static thread_local QByteArray buffer(kReadSize, Qt::Uninitialized);
+    while (*generation == current && file.read(buffer.data(), buffer.size()) > 0) {
+    }
+}
+
+static void readAhead(Sequence *sequence, int position, double speed)
+{
+    // Stepping while paused reads one image at a time anyway.
+    if (speed == 0.0)
+        return;
+    QMutexLocker locker(&sequence->mutex);
+    if (sequence->pattern.isEmpty())
+        return;
+    const int direction = speed < 0.0 ? -1 : 1;
+    const int depth = kReadAheadImages * qBound(1, qCeil(qAbs(speed)), kMaxSpeedFactor);
+    const int index = sequence->begin + position / sequence->ttl;
+    const int last = sequence->begin + qMax(0, sequence->length - 1) / sequence->ttl;
+    const int previous = sequence->begin + sequence->position / sequence->ttl;
+    if (sequence->position < 0 || qAbs(index - previous) > depth) {
+        // A seek cancels the reads that are still queued.
+        ++*sequence->generation;
+        sequence->read.clear();
+    }
+    sequence->position = position;
+    // Forget the images behind so that they are read again when looping.
+    for (auto it = sequence->read.begin(); it != sequence->read.end();) {
+        if ((*it - index) * direction <= 0)
+            it = sequence->read.erase(it);
+        else
+            ++it;
+    }
+    const auto generation = sequence->generation;
+    const int current = generation->load();
+    for (int i = 1; i <= depth; ++i) {
+        const int next = index + i * direction;
+        if (next < sequence->begin || next > last || sequence->read.contains(next))
+            continue;
+        sequence->read.insert(next);
+        const auto path = imagePath(sequence->pattern, next);
+        readPool().start([=]() { readFile(path, generation, current); });
+    }
+}
+
+static mlt_producer acquireClone(Sequence *sequence)
+{
+    QMutexLocker locker(&sequence->mutex);
+    if (!sequence->clones.isEmpty())
+        return sequence->clones.takeLast();
+    const auto service = sequence->service;
+    const auto resource = sequence->resource;
+    const int ttl = sequence->ttl;
+    const int length = sequence->length;
+    locker.unlock();
+
+    // The clone has no normalizing filters; those of the player apply to its image.
+    auto clone = mlt_factory_producer(sequence->profile, service.constData(), resource.constData());
+    if (clone) {
+        auto properties = MLT_PRODUCER_PROPERTIES(clone);
+        mlt_properties_set_int(properties, "ttl", ttl);
+        mlt_properties_set_int(properties, "length", length);
+        mlt_properties_set_int(properties, "out", length - 1);
+    } else {
+        LOG_WARNING() << "failed to open the image sequence" << resource;
+    }
+    return clone;
+}
+
+static void releaseClone(Sequence *sequence, mlt_producer clone, const QByteArray &resource)
+{
+    QMutexLocker locker(&sequence->mutex);
+    // The sequence may have changed while it was decoding.
+    if (resource == sequence->resource) {
+        sequence->clones << clone;
+    } else {
+        locker.unlock();
+        mlt_producer_close(clone);
+    }
+}
+
+// Copies what decoding set on the worker frame, such as the size and the
+// format, but not the state of the frame of the player such as its speed.
+static void copyResults(mlt_properties dst, mlt_properties src)
+{
+    const int n = mlt_properties_count(src);
+    for (int i = 0; i < n; ++i) {
+        const char *name = mlt_properties_get_name(src, i);
+        const char *value = mlt_properties_get_value(src, i);
+        if (name && value && name[0] != '_' && std::strncmp(name, "consumer.", 9))
+            mlt_properties_set(dst, name, value);
+    }
+}
+
+static int getImage(mlt_frame frame,
+                    uint8_t **image,
+                    mlt_image_format *format,
+                    int *width,
+                    int *height,
+                    int writable)
+{
+    auto decode = static_cast<Decode *>(mlt_frame_pop_service(frame));
+    decode->done.acquire();
+    decode->done.release();
+    // Let the producer decode it if the worker could not.
+    if (decode->error)
+        return mlt_frame_get_image(frame, image, format, width, height, writable);
+
+    // The worker frame keeps owning the image and the alpha.
+    copyResults(MLT_FRAME_PROPERTIES(frame), MLT_FRAME_PROPERTIES(decode->worker));
+    mlt_frame_set_image(frame, decode->image, 0, nullptr);
+    int alphaSize = 0;
+    if (auto alpha = mlt_frame_get_alpha_size(decode->worker, &alphaSize))
+        mlt_frame_set_alpha(frame, alpha, alphaSize, nullptr);
+    *image = decode->image;
+    *format = decode->format;
+    *width = decode->width;
+    *height = decode->height;
+    return 0;
+}
+
+static void decodeImage(Sequence *sequence, Decode *decode, int position)
+{
+    QMutexLocker locker(&sequence->mutex);
+    const auto resource = sequence->resource;
+    locker.unlock();
+    auto clone = acquireClone(sequence);
+    if (!clone)
+        return;
+    mlt_producer_seek(clone, position);
+    if (!mlt_service_get_frame(MLT_PRODUCER_SERVICE(clone), &decode->worker, 0)
+        && decode->worker) {
+        // Decode at the size of the file; the player scales it.
+        auto properties = MLT_FRAME_PROPERTIES(decode->worker);
+        decode->width = mlt_properties_get_int(properties, "meta.media.width");
+        decode->height = mlt_properties_get_int(properties, "meta.media.height");
+        decode->error = mlt_frame_get_image(decode->worker,
+                                            &decode->image,
+                                            &decode->format,
+                                            &decode->width,
+                                            &decode->height,
+                                            0);
+    }
+    releaseClone(sequence, clone, resource);
+}
+
+static mlt_frame process(mlt_filter filter, mlt_frame frame)
+{
+    auto sequence = sequenceOf(filter);
+    if (!sequence || mlt_frame_is_test_card(frame))
+        return frame;
+    const int position = mlt_frame_get_position(frame);
+    readAhead(sequence,
+              position,
+              mlt_properties_get_double(MLT_FRAME_PROPERTIES(frame), "_speed"));
+
+    // Above the image of the producer, which is only used if the worker fails.
+    auto decode = new Decode;
+    mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame),
+                            kSequenceReadAheadProperty,
+                            decode,
+                            0,
+                            closeDecode,
+                            nullptr);
+    mlt_frame_push_service(frame, decode);
+    mlt_frame_push_get_image(frame, getImage);
+
+    mlt_properties_inc_ref(MLT_FRAME_PROPERTIES(frame));
+    mlt_properties_inc_ref(MLT_FILTER_PROPERTIES(filter));
+    decodePool().start([=]() {
+        // Only the worker holds the frame when the consumer dropped it, as on a seek.
+        if (mlt_properties_ref_count(MLT_FRAME_PROPERTIES(frame)) > 1)
+            decodeImage(sequence, decode, position);
+        decode->done.release();
+        mlt_frame_close(frame);
+        mlt_filter_close(filter);
+    });
+    return frame;
+}
+
+SequenceReadAhead::SequenceReadAhead(QObject *parent)
+    : QObject(parent)
+{
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kScheduleDelayMs);
+    connect(&m_timer, &QTimer::timeout, this, qOverload<>(&SequenceReadAhead::apply));
+}
+
+SequenceReadAhead &SequenceReadAhead::singleton()
+{
+    static SequenceReadAhead instance;
+    return instance;
+}
+
+void SequenceReadAhead::schedule()
+{
+    m_timer.start();
+}
+
+void SequenceReadAhead::apply()
+{
+    if (Settings.playerGPU())
+        return;
+    if (MLT.producer() && MLT.producer()->is_valid())
+        apply(*MLT.producer());
+    auto multitrack = MAIN.multitrack();
+    if (multitrack && multitrack->is_valid()
+        && (!MLT.producer() || multitrack->get_producer() != MLT.producer()->get_producer()))
+        apply(*multitrack);
+}
+
+void SequenceReadAhead::apply(Mlt::Producer &producer)
+{
+    SequenceParser parser;
+    parser.start(producer);
+
+    for (auto &sequenceProducer : parser.producers()) {
+        Sequence *sequence = nullptr;
+        for (int i = 0; i < sequenceProducer.filter_count() && !sequence; ++i) {
+            std::unique_ptr<Mlt::Filter> filter(sequenceProducer.filter(i));
+            if (filter && filter->is_valid())
+                sequence = sequenceOf(filter->get_filter());
+        }
+        if (!sequence) {
+            auto mltFilter = mlt_filter_new();
+            if (!mltFilter)
+                continue;
+            mltFilter->process = process;
+            Mlt::Filter filter(mltFilter);
+            mlt_filter_close(mltFilter);
+            sequence = new Sequence;
+            // The XML consumer and the filter models skip the loader filters.
+            filter.set("_loader", 1);
+            filter.set(kShotcutHiddenProperty, 1);
+            filter.set(kSequenceReadAheadProperty, sequence, 0, closeSequence);
+            sequenceProducer.attach(filter);
+            // First, so that the image it decodes goes through the other filters.
+            sequenceProducer.move_filter(sequenceProducer.filter_count() - 1, 0);
+            LOG_DEBUG() << "reading ahead" << sequenceProducer.get("resource");
+        }
+
+        const QString service = sequenceProducer.get("mlt_service");
+        QString path = Util::removeQueryString(QString::fromUtf8(sequenceProducer.get("resource")));
+        if (path.startsWith(service + ':'))
+            path.remove(0, service.size() + 1);
+        const int begin = sequenceProducer.get_int("begin");
+        auto resource = path.toUtf8();
+        if (sequenceProducer.get("begin"))
+            resource += "?begin=" + QByteArray::number(begin);
+        QList<mlt_producer> closed;
+        {
+            QMutexLocker locker(&sequence->mutex);
+            if (sequence->resource != resource) {
+                closed = sequence->clones;
+                sequence->clones.clear();
+            }
+            sequence->profile = mlt_service_profile(sequenceProducer.get_service());
+            sequence->service = service.toUtf8();
+            sequence->resource = resource;
+            sequence->pattern = path;
+            sequence->begin = begin;
+            sequence->ttl = qMax(1, sequenceProducer.get_int("ttl"));
+            sequence->length = sequenceProducer.get_length();
+        }
+        for (auto clone : closed)
+            mlt_producer_close(clone);
+    }
+}
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef SEQUENCEREADAHEAD_H
+#define SEQUENCEREADAHEAD_H
+
+#include <QObject>
+#include <QTimer>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class SequenceReadAhead
+  \brief Decodes the images of image sequences ahead of the consumer.
+
+  The qimage and pixbuf producers read and decode the file of a frame when
+  its image is requested on the rendering thread, and they hold a lock while
+  doing so. Large EXR, DPX or TIFF sequences then play at the speed of one
+  thread reading and decoding one file at a time.
+
+  A hidden filter on each sequence producer starts decoding the image of a
+  frame on a bounded pool as soon as the consumer pulls the frame, which it
+  does ahead of the playhead in the direction of play. Each worker decodes on
+  a clone of the producer of its own, so that several images decode at once;
+  the frames in the consumer queue are the cache. Further ahead, the files of
+  the next images are read in large sequential reads to prime the disk cache,
+  more of them the faster it plays. A frame that the consumer dropped, as on
+  a seek, is not decoded, and a seek cancels the reads still queued.
+
+  GPU mode is left alone because converting the images there needs the
+  OpenGL context of the consumer thread.
+*/
+
+class SequenceReadAhead : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SequenceReadAhead &singleton();
+
+public slots:
+    //! Looks for the image sequences of the player again after a short delay.
+    void schedule();
+
+private slots:
+    void apply();
+
+private:
+    explicit SequenceReadAhead(QObject *parent = nullptr);
+    void apply(Mlt::Producer &producer);
+
+    QTimer m_timer;
+};
+
+#endif // SEQUENCEREADAHEAD_H
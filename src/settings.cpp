@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 #include "settings.h"
 
 #include "Logger.h"
+#include "projectarchive.h"
 #include "qmltypes/qmlapplication.h"
 
 #include <QApplication>
@@ -39,6 +40,16 @@ static QString appDataForSession;
 static const int kMaximumTrackHeight = 125;
 static const QString kRecentKey("recent");
 static const QString kProjectsKey("projects");
+static const char *kPlaylistThumbnails[] = {"hidden", "small", "large", "wide", "tall"};
+
+static int playlistThumbnailsIndex(const QString &s)
+{
+    for (int i = 0; i < int(sizeof(kPlaylistThumbnails) / sizeof(kPlaylistThumbnails[0])); ++i) {
+        if (s == QLatin1String(kPlaylistThumbnails[i]))
+            return i;
+    }
+    return -1;
+}
 
 namespace {
 struct ModeMap
@@ -78,6 +89,7 @@ ShotcutSettings::ShotcutSettings()
 {
     migrateLayout();
     migrateRecent();
+    cacheValues();
 }
 
 ShotcutSettings::ShotcutSettings(const QString &appDataLocation)
@@ -88,6 +100,24 @@ ShotcutSettings::ShotcutSettings(const QString &appDataLocation)
 {
     migrateLayout();
     migrateRecent();
+    cacheValues();
+}
+
+void ShotcutSettings::cacheValues()
+{
+    bool gpu = false;
+    if (settings.contains("processingMode")) {
+        ProcessingMode mode = (ProcessingMode) settings.value("processingMode").toInt();
+        gpu = mode == Linear10GpuCpu;
+    } else if (settings.contains("player/gpu2")) {
+        // Legacy GPU Mode
+        gpu = settings.value("player/gpu2").toBool();
+    }
+    m_playerGPU.store(gpu);
+    m_timelineShowWaveforms.store(settings.value("timeline/waveforms", true).toBool());
+    m_thumbnailsFastSeek.store(settings.value("thumbnails/fastSeek", false).toBool());
+    m_playlistThumbnails.store(
+        playlistThumbnailsIndex(settings.value("playlist/thumbnails", "small").toString()));
 }
 
 void ShotcutSettings::migrateRecent()
@@ -209,7 +239,7 @@ QStringList ShotcutSettings::projects()
     auto ls = m_recent.value(kProjectsKey).toStringList();
     if (ls.isEmpty()) {
         for (auto &r : recent()) {
-            if (r.endsWith(".mlt"))
+            if (r.endsWith(".mlt") || ProjectArchive::isArchive(r))
                 ls << r;
         }
         // Prevent entering this block repeatedly
@@ -252,6 +282,58 @@ void ShotcutSettings::setJobPriority(const QString &s)
     settings.setValue("jobPriority", s);
 }
 
+int ShotcutSettings::jobCpuEncodeSlots() const
+{
+    // Encoders use many threads each, so only a large machine gains from more.
+    const auto defaultSlots = qBound(1, QThread::idealThreadCount() / 8, 4);
+    return qMax(1, settings.value("jobs/cpuEncodeSlots", defaultSlots).toInt());
+}
+
+void ShotcutSettings::setJobCpuEncodeSlots(int n)
+{
+    settings.setValue("jobs/cpuEncodeSlots", n);
+}
+
+int ShotcutSettings::jobGpuEncodeSlots() const
+{
+    return qMax(1, settings.value("jobs/gpuEncodeSlots", 1).toInt());
+}
+
+void ShotcutSettings::setJobGpuEncodeSlots(int n)
+{
+    settings.setValue("jobs/gpuEncodeSlots", n);
+}
+
+int ShotcutSettings::jobDiskSlots() const
+{
+    return qMax(1, settings.value("jobs/diskSlots", 2).toInt());
+}
+
+void ShotcutSettings::setJobDiskSlots(int n)
+{
+    settings.setValue("jobs/diskSlots", n);
+}
+
+int ShotcutSettings::jobNetworkSlots() const
+{
+    return qMax(1, settings.value("jobs/networkSlots", 1).toInt());
+}
+
+void ShotcutSettings::setJobNetworkSlots(int n)
+{
+    settings.setValue("jobs/networkSlots", n);
+}
+
+QStringList ShotcutSettings::jobRenderNodes() const
+{
+    return settings.value("jobs/renderNodes").toStringList();
+}
+
+void ShotcutSettings::setJobRenderNodes(const QStringList &nodes)
+{
+    settings.setValue("jobs/renderNodes", nodes);
+}
+
 bool ShotcutSettings::showTitleBars() const
 {
     return settings.value("titleBars", true).toBool();
@@ -551,6 +633,7 @@ ShotcutSettings::ProcessingMode ShotcutSettings::processingMode()
 void ShotcutSettings::setProcessingMode(ProcessingMode mode)
 {
     settings.setValue("processingMode", mode);
+    m_playerGPU.store(mode == Linear10GpuCpu);
     emit playerGpuChanged();
 }
 
@@ -594,6 +677,56 @@ void ShotcutSettings::setEncodeParallelProcessing(bool b)
     settings.setValue("encode/parallelProcessing", b);
 }
 
+bool ShotcutSettings::encodeSegmentedExport() const
+{
+    return settings.value("encode/segmentedExport", false).toBool();
+}
+
+void ShotcutSettings::setEncodeSegmentedExport(bool b)
+{
+    settings.setValue("encode/segmentedExport", b);
+}
+
+bool ShotcutSettings::encodeSmartRender() const
+{
+    return settings.value("encode/smartRender", false).toBool();
+}
+
+void ShotcutSettings::setEncodeSmartRender(bool b)
+{
+    settings.setValue("encode/smartRender", b);
+}
+
+bool ShotcutSettings::encodeUseIntraCache() const
+{
+    return settings.value("encode/useIntraCache", false).toBool();
+}
+
+void ShotcutSettings::setEncodeUseIntraCache(bool b)
+{
+    settings.setValue("encode/useIntraCache", b);
+}
+
+bool ShotcutSettings::encodeStreamingLadder() const
+{
+    return settings.value("encode/streamingLadder", false).toBool();
+}
+
+void ShotcutSettings::setEncodeStreamingLadder(bool b)
+{
+    settings.setValue("encode/streamingLadder", b);
+}
+
+int ShotcutSettings::encodeQualitySampleSeconds() const
+{
+    return settings.value("encode/qualitySampleSeconds", 1).toInt();
+}
+
+void ShotcutSettings::setEncodeQualitySampleSeconds(int seconds)
+{
+    settings.setValue("encode/qualitySampleSeconds", seconds);
+}
+
 int ShotcutSettings::playerAudioChannels() const
 {
     return settings.value("player/audioChannels", 2).toInt();
@@ -649,14 +782,7 @@ void ShotcutSettings::setPlayerInterpolation(const QString &s)
 bool ShotcutSettings::playerGPU() const
 {
     // This is the legacy function for the old GPU mode.
-    if (settings.contains("processingMode")) {
-        ProcessingMode mode = (ProcessingMode) settings.value("processingMode").toInt();
-        return mode == Linear10GpuCpu;
-    } else if (settings.contains("player/gpu2")) {
-        // Legacy GPU Mode
-        return settings.value("player/gpu2").toBool();
-    }
-    return false;
+    return m_playerGPU.load(std::memory_order_relaxed);
 }
 
 bool ShotcutSettings::playerWarnGPU() const
@@ -729,6 +855,26 @@ void ShotcutSettings::setPlayerRealtime(bool b)
     settings.setValue("player/realtime", b);
 }
 
+int ShotcutSettings::playerFrameQueueDepth() const
+{
+    return settings.value("player/frameQueueDepth", 3).toInt();
+}
+
+void ShotcutSettings::setPlayerFrameQueueDepth(int depth)
+{
+    settings.setValue("player/frameQueueDepth", depth);
+}
+
+int ShotcutSettings::playerFrameCacheSize() const
+{
+    return settings.value("player/frameCacheSize", 256).toInt();
+}
+
+void ShotcutSettings::setPlayerFrameCacheSize(int megabytes)
+{
+    settings.setValue("player/frameCacheSize", megabytes);
+}
+
 bool ShotcutSettings::playerScrubAudio() const
 {
     return settings.value("player/scrubAudio", true).toBool();
@@ -769,6 +915,26 @@ void ShotcutSettings::setPlayerPreviewScale(int i)
     settings.setValue("player/previewScale", i);
 }
 
+bool ShotcutSettings::playerPreviewScaleAdaptive() const
+{
+    return settings.value("player/previewScaleAdaptive", false).toBool();
+}
+
+void ShotcutSettings::setPlayerPreviewScaleAdaptive(bool b)
+{
+    settings.setValue("player/previewScaleAdaptive", b);
+}
+
+bool ShotcutSettings::playerHardwareDecode() const
+{
+    return settings.value("player/hardwareDecode", false).toBool();
+}
+
+void ShotcutSettings::setPlayerHardwareDecode(bool b)
+{
+    settings.setValue("player/hardwareDecode", b);
+}
+
 int ShotcutSettings::playerVideoDelayMs() const
 {
     return settings.value("player/videoDelayMs", 0).toInt();
@@ -779,6 +945,26 @@ void ShotcutSettings::setPlayerVideoDelayMs(int i)
     settings.setValue("player/videoDelayMs", i);
 }
 
+int ShotcutSettings::playerAudioLatencyMs() const
+{
+    return settings.value("player/audioLatencyMs", 0).toInt();
+}
+
+void ShotcutSettings::setPlayerAudioLatencyMs(int ms)
+{
+    settings.setValue("player/audioLatencyMs", ms);
+}
+
+int ShotcutSettings::playerTrackThreads() const
+{
+    return settings.value("player/trackThreads", 0).toInt();
+}
+
+void ShotcutSettings::setPlayerTrackThreads(int threads)
+{
+    settings.setValue("player/trackThreads", threads);
+}
+
 double ShotcutSettings::playerJumpSeconds() const
 {
     return settings.value("player/jumpSeconds", 60.0).toDouble();
@@ -820,12 +1006,16 @@ void ShotcutSettings::setPlayerPauseAfterSeek(bool b)
 
 QString ShotcutSettings::playlistThumbnails() const
 {
+    const int index = m_playlistThumbnails.load(std::memory_order_relaxed);
+    if (index >= 0)
+        return QLatin1String(kPlaylistThumbnails[index]);
     return settings.value("playlist/thumbnails", "small").toString();
 }
 
 void ShotcutSettings::setPlaylistThumbnails(const QString &s)
 {
     settings.setValue("playlist/thumbnails", s);
+    m_playlistThumbnails.store(playlistThumbnailsIndex(s));
     emit playlistThumbnailsChanged();
 }
 
@@ -862,12 +1052,13 @@ void ShotcutSettings::setTimelineDragScrub(bool b)
 
 bool ShotcutSettings::timelineShowWaveforms() const
 {
-    return settings.value("timeline/waveforms", true).toBool();
+    return m_timelineShowWaveforms.load(std::memory_order_relaxed);
 }
 
 void ShotcutSettings::setTimelineShowWaveforms(bool b)
 {
     settings.setValue("timeline/waveforms", b);
+    m_timelineShowWaveforms.store(b);
     emit timelineShowWaveformsChanged();
 }
 
@@ -882,6 +1073,17 @@ void ShotcutSettings::setTimelineShowThumbnails(bool b)
     emit timelineShowThumbnailsChanged();
 }
 
+bool ShotcutSettings::timelineThumbnailStrip() const
+{
+    return settings.value("timeline/thumbnailStrip", false).toBool();
+}
+
+void ShotcutSettings::setTimelineThumbnailStrip(bool b)
+{
+    settings.setValue("timeline/thumbnailStrip", b);
+    emit timelineThumbnailStripChanged();
+}
+
 bool ShotcutSettings::timelineRipple() const
 {
     return settings.value("timeline/ripple", false).toBool();
@@ -1038,6 +1240,16 @@ void ShotcutSettings::setTimelineAdjustGain(bool b)
     emit timelineAdjustGainChanged();
 }
 
+bool ShotcutSettings::timelineThreadedRendering() const
+{
+    return settings.value("timeline/threadedRendering", false).toBool();
+}
+
+void ShotcutSettings::setTimelineThreadedRendering(bool b)
+{
+    settings.setValue("timeline/threadedRendering", b);
+}
+
 QString ShotcutSettings::filterFavorite(const QString &filterName)
 {
     return settings.value("filter/favorite/" + filterName, "").toString();
@@ -1134,6 +1346,36 @@ void ShotcutSettings::setLoudnessScopeShowMeter(const QString &meter, bool b)
     settings.setValue("scope/loudness/" + meter, b);
 }
 
+int ShotcutSettings::scopeResolution() const
+{
+    return settings.value("scope/resolution", 1).toInt();
+}
+
+void ShotcutSettings::setScopeResolution(int factor)
+{
+    settings.setValue("scope/resolution", factor);
+}
+
+bool ShotcutSettings::scopeGpu() const
+{
+    return settings.value("scope/gpu", false).toBool();
+}
+
+void ShotcutSettings::setScopeGpu(bool b)
+{
+    settings.setValue("scope/gpu", b);
+}
+
+bool ShotcutSettings::scopeShowStatistics() const
+{
+    return settings.value("scope/showStatistics", false).toBool();
+}
+
+void ShotcutSettings::setScopeShowStatistics(bool b)
+{
+    settings.setValue("scope/showStatistics", b);
+}
+
 void ShotcutSettings::setMarkerColor(const QColor &color)
 {
     settings.setValue("markers/color", color.name());
@@ -1445,6 +1687,68 @@ void ShotcutSettings::setProxyUseHardware(bool b)
     settings.setValue("proxy/useHardware", b);
 }
 
+bool ShotcutSettings::proxyIntraCache() const
+{
+    return settings.value("proxy/intraCache", true).toBool();
+}
+
+void ShotcutSettings::setProxyIntraCache(bool b)
+{
+    settings.setValue("proxy/intraCache", b);
+}
+
+bool ShotcutSettings::proxyMediaCache() const
+{
+    return settings.value("proxy/mediaCache", false).toBool();
+}
+
+void ShotcutSettings::setProxyMediaCache(bool b)
+{
+    settings.setValue("proxy/mediaCache", b);
+}
+
+int ShotcutSettings::proxyMediaCacheGB() const
+{
+    return settings.value("proxy/mediaCacheGB", 50).toInt();
+}
+
+void ShotcutSettings::setProxyMediaCacheGB(int gigabytes)
+{
+    settings.setValue("proxy/mediaCacheGB", gigabytes);
+}
+
+int ShotcutSettings::thumbnailMemoryCacheMB() const
+{
+    return settings.value("thumbnails/memoryCacheMB", 64).toInt();
+}
+
+void ShotcutSettings::setThumbnailMemoryCacheMB(int megabytes)
+{
+    settings.setValue("thumbnails/memoryCacheMB", megabytes);
+}
+
+int ShotcutSettings::memoryBudgetMB() const
+{
+    return settings.value("memoryBudgetMB", 1024).toInt();
+}
+
+void ShotcutSettings::setMemoryBudgetMB(int megabytes)
+{
+    settings.setValue("memoryBudgetMB", megabytes);
+}
+
+bool ShotcutSettings::thumbnailsFastSeek() const
+{
+    return m_thumbnailsFastSeek.load(std::memory_order_relaxed);
+}
+
+void ShotcutSettings::setThumbnailsFastSeek(bool b)
+{
+    settings.setValue("thumbnails/fastSeek", b);
+    m_thumbnailsFastSeek.store(b);
+    emit thumbnailsFastSeekChanged();
+}
+
 void ShotcutSettings::clearShortcuts(const QString &name)
 {
     QString key = "shortcuts/" + name;
@@ -1775,3 +2079,18 @@ void ShotcutSettings::setScreenRecorderPath(const QString &path)
 {
     settings.setValue("screenRecorderPath", path);
 }
+
+bool ShotcutSettings::screenCaptureReplay() const
+{
+    return settings.value("screenCapture/replay", false).toBool();
+}
+
+void ShotcutSettings::setScreenCaptureReplay(bool b)
+{
+    settings.setValue("screenCapture/replay", b);
+}
+
+int ShotcutSettings::screenCaptureReplayMinutes() const
+{
+    return qMax(1, settings.value("screenCapture/replayMinutes", 5).toInt());
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2024 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -26,6 +26,8 @@
 #include <QStringList>
 #include <QThread>
 
+#include <atomic>
+
 class ShotcutSettings : public QObject
 {
     Q_OBJECT
@@ -35,6 +37,8 @@ class ShotcutSettings : public QObject
                    NOTIFY timelineShowWaveformsChanged)
     Q_PROPERTY(bool timelineShowThumbnails READ timelineShowThumbnails WRITE
                    setTimelineShowThumbnails NOTIFY timelineShowThumbnailsChanged)
+    Q_PROPERTY(bool timelineThumbnailStrip READ timelineThumbnailStrip WRITE
+                   setTimelineThumbnailStrip NOTIFY timelineThumbnailStripChanged)
     Q_PROPERTY(bool timelineRipple READ timelineRipple WRITE setTimelineRipple NOTIFY
                    timelineRippleChanged)
     Q_PROPERTY(bool timelineRippleAllTracks READ timelineRippleAllTracks WRITE
@@ -82,6 +86,12 @@ public:
     static const qsizetype MaxPath{32767};
     enum TimelineScrolling { NoScrolling, CenterPlayhead, PageScrolling, SmoothScrolling };
     enum ProcessingMode { Native8Cpu, Linear8Cpu, Native10Cpu, Linear10Cpu, Linear10GpuCpu };
+    enum ScopeResolution {
+        ScopeResolutionAuto = 0,
+        ScopeResolutionFull = 1,
+        ScopeResolutionHalf = 2,
+        ScopeResolutionQuarter = 4
+    };
 
     static ShotcutSettings &singleton();
     void log();
@@ -103,6 +113,17 @@ public:
     void setTheme(const QString &);
     QThread::Priority jobPriority() const;
     void setJobPriority(const QString &);
+    int jobCpuEncodeSlots() const;
+    void setJobCpuEncodeSlots(int);
+    int jobGpuEncodeSlots() const;
+    void setJobGpuEncodeSlots(int);
+    int jobDiskSlots() const;
+    void setJobDiskSlots(int);
+    int jobNetworkSlots() const;
+    void setJobNetworkSlots(int);
+    //! The SSH destinations that render export segments, each with melt and the shared storage.
+    QStringList jobRenderNodes() const;
+    void setJobRenderNodes(const QStringList &);
     bool showTitleBars() const;
     void setShowTitleBars(bool);
     bool showToolBar() const;
@@ -145,6 +166,16 @@ public:
     void setShowConvertClipDialog(bool);
     bool encodeParallelProcessing() const;
     void setEncodeParallelProcessing(bool);
+    bool encodeSegmentedExport() const;
+    void setEncodeSegmentedExport(bool);
+    bool encodeSmartRender() const;
+    void setEncodeSmartRender(bool);
+    bool encodeStreamingLadder() const;
+    void setEncodeStreamingLadder(bool);
+    bool encodeUseIntraCache() const;
+    void setEncodeUseIntraCache(bool);
+    int encodeQualitySampleSeconds() const;
+    void setEncodeQualitySampleSeconds(int);
 
     // player
     int playerAudioChannels() const;
@@ -171,6 +202,10 @@ public:
     void setPlayerProgressive(bool);
     bool playerRealtime() const;
     void setPlayerRealtime(bool);
+    int playerFrameQueueDepth() const;
+    void setPlayerFrameQueueDepth(int);
+    int playerFrameCacheSize() const;
+    void setPlayerFrameCacheSize(int megabytes);
     bool playerScrubAudio() const;
     void setPlayerScrubAudio(bool);
     int playerVolume() const;
@@ -179,8 +214,16 @@ public:
     void setPlayerZoom(float);
     int playerPreviewScale() const;
     void setPlayerPreviewScale(int);
+    bool playerPreviewScaleAdaptive() const;
+    void setPlayerPreviewScaleAdaptive(bool);
+    bool playerHardwareDecode() const;
+    void setPlayerHardwareDecode(bool);
     int playerVideoDelayMs() const;
     void setPlayerVideoDelayMs(int);
+    int playerAudioLatencyMs() const;
+    void setPlayerAudioLatencyMs(int);
+    int playerTrackThreads() const;
+    void setPlayerTrackThreads(int);
     double playerJumpSeconds() const;
     void setPlayerJumpSeconds(double);
     QString playerAudioDriver() const;
@@ -203,6 +246,8 @@ public:
     void setTimelineShowWaveforms(bool);
     bool timelineShowThumbnails() const;
     void setTimelineShowThumbnails(bool);
+    bool timelineThumbnailStrip() const;
+    void setTimelineThumbnailStrip(bool);
     bool timelineRipple() const;
     void setTimelineRipple(bool);
     bool timelineRippleAllTracks() const;
@@ -231,6 +276,8 @@ public:
     void setTimelineRectangleSelect(bool);
     bool timelineAdjustGain() const;
     void setTimelineAdjustGain(bool);
+    bool timelineThreadedRendering() const;
+    void setTimelineThreadedRendering(bool);
 
     // filter
     QString filterFavorite(const QString &filterName);
@@ -253,6 +300,13 @@ public:
     // scope
     bool loudnessScopeShowMeter(const QString &meter) const;
     void setLoudnessScopeShowMeter(const QString &meter, bool b);
+    /// Returns the decimation factor for video scopes or ScopeResolutionAuto.
+    int scopeResolution() const;
+    void setScopeResolution(int);
+    bool scopeGpu() const;
+    void setScopeGpu(bool);
+    bool scopeShowStatistics() const;
+    void setScopeShowStatistics(bool);
 
     // Markers
     void setMarkerColor(const QColor &color);
@@ -316,6 +370,9 @@ public:
     void setChromiumPath(const QString &path);
     QString screenRecorderPath() const;
     void setScreenRecorderPath(const QString &path);
+    bool screenCaptureReplay() const;
+    void setScreenCaptureReplay(bool b);
+    int screenCaptureReplayMinutes() const;
 
     // proxy
     bool proxyEnabled() const;
@@ -326,6 +383,22 @@ public:
     void setProxyUseProjectFolder(bool);
     bool proxyUseHardware() const;
     void setProxyUseHardware(bool);
+    bool proxyIntraCache() const;
+    void setProxyIntraCache(bool);
+    bool proxyMediaCache() const;
+    void setProxyMediaCache(bool);
+    /// Returns the size limit of the local copies of remote media in GiB.
+    int proxyMediaCacheGB() const;
+    void setProxyMediaCacheGB(int);
+
+    // thumbnails
+    int thumbnailMemoryCacheMB() const;
+    void setThumbnailMemoryCacheMB(int);
+    /// Returns the combined size of the caches in MiB, or 0 for no limit.
+    int memoryBudgetMB() const;
+    void setMemoryBudgetMB(int);
+    bool thumbnailsFastSeek() const;
+    void setThumbnailsFastSeek(bool);
 
     // Shortcuts
     void clearShortcuts(const QString &name);
@@ -404,6 +477,7 @@ signals:
     void timelineDragScrubChanged();
     void timelineShowWaveformsChanged();
     void timelineShowThumbnailsChanged();
+    void timelineThumbnailStripChanged();
     void timelineRippleChanged();
     void timelineRippleAllTracksChanged();
     void timelineRippleMarkersChanged();
@@ -429,16 +503,24 @@ signals:
     void timeFormatChanged();
     void keyframesDragScrubChanged();
     void timelineAdjustGainChanged();
+    void thumbnailsFastSeekChanged();
 
 private:
     explicit ShotcutSettings();
     explicit ShotcutSettings(const QString &appDataLocation);
     void migrateRecent();
     void migrateLayout();
+    void cacheValues();
 
     QSettings settings;
     QString m_appDataLocation;
     QSettings m_recent;
+    // Read per frame or per clip, often from worker threads, so these are
+    // kept in memory by their setters instead of looked up in QSettings.
+    std::atomic<bool> m_playerGPU{false};
+    std::atomic<bool> m_timelineShowWaveforms{true};
+    std::atomic<bool> m_thumbnailsFastSeek{false};
+    std::atomic<int> m_playlistThumbnails{-1};
 };
 
 #define Settings ShotcutSettings::singleton()
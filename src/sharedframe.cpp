@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2023 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  * Author: Brian Matherly <code@brianmatherly.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -17,24 +17,78 @@
  */
 #include "sharedframe.h"
 
+#include "frametrace.h"
+
+#include <QHash>
+
+#include <atomic>
 #include <mutex>
 
+static const char *kRepackedImageProperty = "_shotcut:repackedImage";
+
 void destroyFrame(void *p)
 {
     delete static_cast<Mlt::Frame *>(p);
 }
 
+// Repacks packed 4:2:2 into planar 4:2:0, averaging the chroma of each pair of
+// rows. When monitoring on a DeckLink card the frames are 4:2:2 for the card,
+// and the preview needs 4:2:0. The color space and range stay the same, so a
+// plain repack in one pass over memory does what a conversion through MLT
+// would, with no scaler set up per frame.
+static void repackYuv422ToYuv420p(const uint8_t *src, int width, int height, uint8_t *dst)
+{
+    uint8_t *planes[4] = {nullptr, nullptr, nullptr, nullptr};
+    int strides[4] = {0, 0, 0, 0};
+    mlt_image_format_planes(mlt_image_yuv420p, width, height, dst, planes, strides);
+    const int srcStride = width * 2;
+    const int pairs = width / 2;
+    for (int row = 0; row < height; ++row) {
+        const uint8_t *in = src + row * srcStride;
+        uint8_t *y = planes[0] + row * strides[0];
+        for (int i = 0; i < pairs; ++i) {
+            y[2 * i] = in[4 * i];
+            y[2 * i + 1] = in[4 * i + 2];
+        }
+    }
+    for (int row = 0; row < height / 2; ++row) {
+        const uint8_t *in0 = src + 2 * row * srcStride;
+        const uint8_t *in1 = in0 + srcStride;
+        uint8_t *u = planes[1] + row * strides[1];
+        uint8_t *v = planes[2] + row * strides[2];
+        for (int i = 0; i < pairs; ++i) {
+            u[i] = (in0[4 * i + 1] + in1[4 * i + 1] + 1) / 2;
+            v[i] = (in0[4 * i + 3] + in1[4 * i + 3] + 1) / 2;
+        }
+    }
+}
+
 class FrameData : public QSharedData
 {
 public:
     FrameData()
-        : f(nullptr){};
+        : f(nullptr)
+    {
+        clearImages();
+    };
     FrameData(Mlt::Frame &frame)
-        : f(frame){};
+        : f(frame)
+    {
+        clearImages();
+    };
     ~FrameData(){};
 
+    void clearImages()
+    {
+        for (auto &image : images)
+            image.store(nullptr, std::memory_order_relaxed);
+    }
+
     Mlt::Frame f;
     std::mutex m;
+    QHash<QByteArray, QVariant> analyses;
+    // The image in each format, set once under the mutex and never replaced.
+    std::atomic<const uint8_t *> images[mlt_image_invalid];
 
 private:
     Q_DISABLE_COPY(FrameData)
@@ -174,26 +228,54 @@ int SharedFrame::get_image_height() const
 
 const uint8_t *SharedFrame::get_image(mlt_image_format format) const
 {
+    if (!is_valid())
+        return nullptr;
     mlt_image_format native_format = get_image_format();
     int width = get_image_width();
     int height = get_image_height();
-    uint8_t *image = nullptr;
 
     if (format == mlt_image_none) {
         format = native_format;
     }
+    if (format <= mlt_image_none || format >= mlt_image_invalid)
+        return nullptr;
+
+    // Convert to non-const so that the cache can be accessed/modified while
+    // under lock.
+    FrameData *nonConstData = const_cast<FrameData *>(d.data());
+
+    // An image is never replaced once it exists, so it can be read without
+    // the lock.
+    const uint8_t *image = nonConstData->images[format].load(std::memory_order_acquire);
+    if (image)
+        return image;
+
+    std::lock_guard<std::mutex> lock(nonConstData->m);
+    image = nonConstData->images[format].load(std::memory_order_relaxed);
+    if (image)
+        return image;
+    FrameTrace::Scope trace("SharedFrame::get_image", get_position());
 
     if (format == native_format) {
         // Native format is requested. Return frame image.
-        image = (uint8_t *) d->f.get_image(format, width, height, 0);
+        image = (uint8_t *) nonConstData->f.get_image(format, width, height, 0);
+    } else if (native_format == mlt_image_yuv422 && format == mlt_image_yuv420p && width % 2 == 0
+               && width > 0 && height > 0) {
+        const uint8_t *source = nonConstData->images[native_format].load(std::memory_order_relaxed);
+        if (!source) {
+            source = (uint8_t *) nonConstData->f.get_image(native_format, width, height, 0);
+            nonConstData->images[native_format].store(source, std::memory_order_release);
+        }
+        if (source) {
+            const int size = mlt_image_format_size(format, width, height, nullptr);
+            auto buffer = static_cast<uint8_t *>(mlt_pool_alloc(size));
+            repackYuv422ToYuv420p(source, width, height, buffer);
+            nonConstData->f.set(kRepackedImageProperty, buffer, size, mlt_pool_release);
+            image = buffer;
+        }
     } else {
         // Non-native format is requested. Return a cached converted image.
         const char *formatName = mlt_image_format_name(format);
-        // Convert to non-const so that the cache can be accessed/modified while
-        // under lock.
-        FrameData *nonConstData = const_cast<FrameData *>(d.data());
-
-        nonConstData->m.lock();
 
         Mlt::Frame *cacheFrame = static_cast<Mlt::Frame *>(nonConstData->f.get_data(formatName));
         if (cacheFrame == nullptr) {
@@ -216,12 +298,36 @@ const uint8_t *SharedFrame::get_image(mlt_image_format format) const
         // Get the image from the cache frame.
         // This will cause a conversion if it was just created.
         image = (uint8_t *) cacheFrame->get_image(format, width, height, 0);
-
-        nonConstData->m.unlock();
     }
+    nonConstData->images[format].store(image, std::memory_order_release);
     return image;
 }
 
+SharedFrame::ImageView SharedFrame::get_image_view(mlt_image_format format) const
+{
+    ImageView view;
+    const uint8_t *image = get_image(format);
+    if (!image)
+        return view;
+    view.format = (format == mlt_image_none) ? get_image_format() : format;
+    view.width = get_image_width();
+    view.height = get_image_height();
+    uint8_t *planes[4] = {nullptr, nullptr, nullptr, nullptr};
+    int strides[4] = {0, 0, 0, 0};
+    mlt_image_format_planes(view.format,
+                            view.width,
+                            view.height,
+                            const_cast<uint8_t *>(image),
+                            planes,
+                            strides);
+    for (int i = 0; i < 4 && planes[i]; ++i) {
+        view.planes[i] = planes[i];
+        view.strides[i] = strides[i];
+        view.planeCount = i + 1;
+    }
+    return view;
+}
+
 mlt_audio_format SharedFrame::get_audio_format() const
 {
     return (mlt_audio_format) d->f.get_int("audio_format");
@@ -255,3 +361,18 @@ Mlt::Producer *SharedFrame::get_original_producer()
 {
     return d->f.get_original_producer();
 }
+
+void SharedFrame::set_analysis(const char *name, const QVariant &value) const
+{
+    // The analyses are not frame data, so they may change under lock.
+    FrameData *nonConstData = const_cast<FrameData *>(d.data());
+    std::lock_guard<std::mutex> lock(nonConstData->m);
+    nonConstData->analyses.insert(name, value);
+}
+
+QVariant SharedFrame::get_analysis(const char *name) const
+{
+    FrameData *nonConstData = const_cast<FrameData *>(d.data());
+    std::lock_guard<std::mutex> lock(nonConstData->m);
+    return nonConstData->analyses.value(name);
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  * Author: Brian Matherly <code@brianmatherly.com>
  *
  * This program is free software: you can redistribute it and/or modify
@@ -22,6 +22,7 @@
 #include <MltFrame.h>
 #include <QExplicitlySharedDataPointer>
 #include <QObject>
+#include <QVariant>
 
 #include <stdint.h>
 
@@ -43,12 +44,31 @@ class FrameData;
   the frame data (e.g. to resize the image), then the object must call clone()
   to receive it's own non-const copy of the frame.
 
+  Copies share their data through an atomic reference count, so passing a
+  frame to many consumers never copies or locks anything. An image converted
+  to another format is kept with the frame, so each format is converted only
+  once no matter how many consumers ask for it. After that, get_image() and
+  get_image_view() return it without taking a lock.
+
   TODO: Consider providing a similar class in Mlt++.
 */
 
 class SharedFrame
 {
 public:
+    //! A read-only view of the planes of an image owned by the frame.
+    struct ImageView
+    {
+        mlt_image_format format = mlt_image_none;
+        int width = 0;
+        int height = 0;
+        int planeCount = 0;
+        const uint8_t *planes[4] = {nullptr, nullptr, nullptr, nullptr};
+        int strides[4] = {0, 0, 0, 0}; ///< Bytes per row of each plane
+
+        bool isValid() const { return planeCount > 0; }
+    };
+
     SharedFrame();
     SharedFrame(Mlt::Frame &frame);
     SharedFrame(const SharedFrame &other);
@@ -65,12 +85,19 @@ public:
     int get_image_width() const;
     int get_image_height() const;
     const uint8_t *get_image(mlt_image_format format) const;
+    /// Returns the planes of the image in \a format. They remain valid as
+    /// long as any copy of this frame exists.
+    ImageView get_image_view(mlt_image_format format) const;
     mlt_audio_format get_audio_format() const;
     int get_audio_channels() const;
     int get_audio_frequency() const;
     int get_audio_samples() const;
     const int16_t *get_audio() const;
     Mlt::Producer *get_original_producer();
+    /// Attaches a result computed from the image, such as a scope rendered on
+    /// the GPU, so that every copy of this frame can read it.
+    void set_analysis(const char *name, const QVariant &value) const;
+    QVariant get_analysis(const char *name) const;
 
 private:
     QExplicitlySharedDataPointer<FrameData> d;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2013-2025 Meltytech, LLC
+ * Copyright (c) 2013-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -37,15 +37,18 @@
 #define kShotcutProducerProperty "shotcut:producer"
 #define kShotcutVirtualClip "shotcut:virtual"
 #define kTimelineScaleProperty "shotcut:scaleFactor"
+#define kRenderPreviewZonesProperty "shotcut:renderPreviewZones"
 #define kTrackHeightProperty "shotcut:trackHeight"
 #define kTrackHeaderWidthProperty "shotcut:trackHeaderWidth"
 #define kTrackNameProperty "shotcut:name"
 #define kTrackLockProperty "shotcut:lock"
+#define kTrackRenderedProperty "shotcut:rendered"
 #define kVideoTrackProperty "shotcut:video"
 #define kShotcutCaptionProperty "shotcut:caption"
 #define kShotcutDetailProperty "shotcut:detail"
 #define kShotcutHashProperty "shotcut:hash"
 #define kShotcutHiddenProperty "shotcut:hidden"
+#define kShotcutIdentityProperty "shotcut:identity"
 #define kShotcutSkipConvertProperty "shotcut:skipConvert"
 #define kShotcutAnimInProperty "shotcut:animIn"
 #define kShotcutAnimOutProperty "shotcut:animOut"
@@ -83,10 +86,12 @@
 #define kBackgroundTrackId "background"
 #define kLegacyPlaylistTrackId "main bin"
 #define kPlaylistTrackId "main_bin"
+#define kRenderPreviewTrackId "render_preview"
 
 /* Internal only */
 
 #define kAudioLevelsProperty "_shotcut:audio-levels"
+#define kAudioOnsetsProperty "_shotcut:audio-onsets"
 #define kBackgroundCaptureProperty "_shotcut:bgcapture"
 #define kPlaylistIndexProperty "_shotcut:playlistIndex"
 #define kPlaylistStartProperty "_shotcut:playlistStart"
@@ -102,6 +107,10 @@
 #define kNewFilterProperty "_shotcut:newFilter"
 #define kShotcutFiltersClipboard "shotcut:filtersClipboard"
 #define kIsProxyProperty "shotcut:proxy"
+// A proxy that is an intra-frame copy of the source of a timewarp producer
+#define kIntraCacheProperty "shotcut:intraCache"
+// A proxy that is a local copy of remote media
+#define kMediaCacheProperty "shotcut:mediaCache"
 #define kPrivateProducerProperty "_shotcut:producer"
 
 #define kDefaultMltProfile "atsc_1080p_25"
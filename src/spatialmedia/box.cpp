@@ -18,8 +18,10 @@
 
 // 【文件说明】：MP4文件原子（Box）操作工具
 // 【功能】：加载MPEG4文件并操作文件结构中的原子（基本数据单元）
+#include <algorithm>
 #include <iostream>
 #include <string.h>
+#include <vector>
 
 #include "box.h"
 #include "constants.h"
@@ -125,7 +127,7 @@ uint64_t Box::readUint64(std::fstream &fs)
 }
 
 // 【功能】：向文件流写入8位无符号整数
-void Box::writeUint8(std::fstream &fs, uint8_t iVal)
+void Box::writeUint8(std::ostream &fs, uint8_t iVal)
 {
     union {
         uint8_t iVal;
@@ -136,7 +138,7 @@ void Box::writeUint8(std::fstream &fs, uint8_t iVal)
 }
 
 // 【功能】：向文件流写入16位有符号整数
-void Box::writeInt16(std::fstream &fs, int16_t iVal)
+void Box::writeInt16(std::ostream &fs, int16_t iVal)
 {
     union {
         int16_t iVal;
@@ -147,7 +149,7 @@ void Box::writeInt16(std::fstream &fs, int16_t iVal)
 }
 
 // 【功能】：向文件流写入32位有符号整数
-void Box::writeInt32(std::fstream &fs, int32_t iVal)
+void Box::writeInt32(std::ostream &fs, int32_t iVal)
 {
     union {
         int32_t iVal;
@@ -158,7 +160,7 @@ void Box::writeInt32(std::fstream &fs, int32_t iVal)
 }
 
 // 【功能】：向文件流写入32位无符号整数
-void Box::writeUint32(std::fstream &fs, uint32_t iVal)
+void Box::writeUint32(std::ostream &fs, uint32_t iVal)
 {
     union {
         uint32_t iVal;
@@ -169,7 +171,7 @@ void Box::writeUint32(std::fstream &fs, uint32_t iVal)
 }
 
 // 【功能】：向文件流写入64位无符号整数
-void Box::writeUint64(std::fstream &fs, uint64_t iVal)
+void Box::writeUint64(std::ostream &fs, uint64_t iVal)
 {
     union {
         uint64_t iVal;
@@ -191,7 +193,7 @@ const char *Box::name()
 // 【核心功能】：从文件流加载Box对象
 // 【参数】：fs - 文件流，iPos - 起始位置，iEnd - 结束位置
 // 【返回值】：成功加载的Box对象指针，失败返回NULL
-Box *Box::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
+Box *Box::load(std::fstream &fs, uint64_t iPos, uint64_t iEnd)
 {
     // 加载位于MP4文件中指定位置的原子
     uint32_t iHeaderSize = 0;
@@ -249,14 +251,14 @@ void Box::clear(std::vector<Box *> &list)
 }
 
 // 【功能】：获取内容数据在文件中的起始位置
-int32_t Box::content_start()
+uint64_t Box::content_start()
 {
     return m_iPosition + m_iHeaderSize;
 }
 
 // 【功能】：保存Box内容到输出文件流
 // 【参数】：fsIn - 输入文件流，fsOut - 输出文件流，iDelta - 索引更新量
-void Box::save(std::fstream &fsIn, std::fstream &fsOut, int32_t iDelta)
+void Box::save(std::fstream &fsIn, std::ostream &fsOut, int64_t iDelta)
 {
     // 保存Box内容，优先使用设置的内容数据
 
@@ -296,7 +298,7 @@ void Box::set(uint8_t *pNewContents, uint32_t iSize)
 }
 
 // 【功能】：计算Box总大小（头部 + 内容）
-int32_t Box::size()
+uint64_t Box::size()
 {
     return m_iHeaderSize + m_iContentSize;
 }
@@ -310,28 +312,25 @@ void Box::print_structure(const char *pIndent)
 }
 
 // 【功能】：从输入流复制数据到输出流
-// 【说明】：为避免32位系统内存限制，使用64MB分块复制
-void Box::tag_copy(std::fstream &fsIn, std::fstream &fsOut, int32_t iSize)
+// 【说明】：使用固定大小的缓冲区分块复制（mdat可能有几十GB，不能一次读入内存）
+void Box::tag_copy(std::fstream &fsIn, std::ostream &fsOut, uint64_t iSize)
 {
-    int32_t block_size = 64 * 1024 * 1024; // 64MB分块大小
-    m_pContents = new uint8_t[block_size + 1];
+    const uint64_t block_size = 4 * 1024 * 1024; // 4MB分块大小
+    std::vector<char> buffer(std::min(iSize, block_size));
 
     // 分块复制数据
-    while (iSize > block_size) {
-        fsIn.read((char *) m_pContents, block_size);
-        fsOut.write((char *) m_pContents, block_size);
-        iSize -= block_size;
+    while (iSize > 0 && fsIn && fsOut) {
+        const std::streamsize n = std::min(iSize, block_size);
+        fsIn.read(buffer.data(), n);
+        fsOut.write(buffer.data(), fsIn.gcount());
+        iSize -= n;
     }
-
-    // 复制剩余数据
-    fsIn.read((char *) m_pContents, iSize);
-    fsOut.write((char *) m_pContents, iSize);
 }
 
 // 【功能】：复制和更新索引表（用于STCO/CO64原子）
 // 【参数】：bBigMode - 大端序64位模式，iDelta - 索引偏移量
 void Box::index_copy(
-    std::fstream &fsIn, std::fstream &fsOut, Box *pBox, bool bBigMode, int32_t iDelta)
+    std::fstream &fsIn, std::ostream &fsOut, Box *pBox, bool bBigMode, int64_t iDelta)
 {
     std::fstream &fs = fsIn;
 
@@ -350,17 +349,19 @@ void Box::index_copy(
     writeUint32(fsOut, iHeader);
     writeUint32(fsOut, iValues);
 
-    // 根据模式复制和更新索引值
+    // 一次读入整个索引表，在内存中更新索引值后一次写出
     if (bBigMode) {
-        for (auto i = 0U; i < iValues; i++) {
-            uint64_t iVal = readUint64(fsIn) + iDelta; // 更新索引值
-            writeUint64(fsOut, iVal);
-        }
+        std::vector<uint64_t> values(iValues);
+        fs.read((char *) values.data(), values.size() * sizeof(uint64_t));
+        for (auto &iVal : values)
+            iVal = htobe64(be64toh(iVal) + iDelta); // 更新索引值
+        fsOut.write((const char *) values.data(), values.size() * sizeof(uint64_t));
     } else {
-        for (auto i = 0U; i < iValues; i++) {
-            uint32_t iVal = readUint32(fsIn) + iDelta; // 更新索引值
-            writeUint32(fsOut, iVal);
-        }
+        std::vector<uint32_t> values(iValues);
+        fs.read((char *) values.data(), values.size() * sizeof(uint32_t));
+        for (auto &iVal : values)
+            iVal = htobe32(uint32_t(be32toh(iVal) + iDelta)); // 更新索引值
+        fsOut.write((const char *) values.data(), values.size() * sizeof(uint32_t));
     }
 }
 
@@ -389,7 +390,7 @@ uint64_t Box::uint64FromCont(int32_t &iIDX)
 }
 
 // 【功能】：从内存内容复制和更新索引表
-void Box::index_copy_from_contents(std::fstream &fsOut, Box *pBox, bool bBigMode, int32_t iDelta)
+void Box::index_copy_from_contents(std::ostream &fsOut, Box *pBox, bool bBigMode, int64_t iDelta)
 {
     (void) pBox; // 未使用参数
     int32_t iIDX = 0;
@@ -417,13 +418,13 @@ void Box::index_copy_from_contents(std::fstream &fsOut, Box *pBox, bool bBigMode
 }
 
 // 【功能】：STCO原子复制（32位块偏移）
-void Box::stco_copy(std::fstream &fsIn, std::fstream &fsOut, Box *pBox, int32_t iDelta)
+void Box::stco_copy(std::fstream &fsIn, std::ostream &fsOut, Box *pBox, int64_t iDelta)
 {
     index_copy(fsIn, fsOut, pBox, false, iDelta); // 32位模式
 }
 
 // 【功能】：CO64原子复制（64位块偏移）
-void Box::co64_copy(std::fstream &fsIn, std::fstream &fsOut, Box *pBox, int32_t iDelta)
+void Box::co64_copy(std::fstream &fsIn, std::ostream &fsOut, Box *pBox, int64_t iDelta)
 {
     index_copy(fsIn, fsOut, pBox, true, iDelta); // 64位模式
 }
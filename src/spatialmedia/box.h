@@ -20,6 +20,7 @@
 // 【文件说明】：MP4文件原子（Box）操作工具头文件
 // 【功能】：定义MPEG4文件原子的数据结构和操作接口
 #include <fstream>
+#include <ostream>
 #include <stdint.h>
 #include <vector>
 
@@ -37,22 +38,22 @@ public:
     virtual int32_t type();
 
     // 【静态方法】：原子管理和文件操作
-    static Box *load(std::fstream &, uint32_t, uint32_t); // 从文件加载原子
+    static Box *load(std::fstream &, uint64_t, uint64_t); // 从文件加载原子
     static void clear(std::vector<Box *> &);              // 清理原子列表
 
     // 【原子内容操作】
-    int content_start();                                        // 获取内容起始位置
-    virtual void save(std::fstream &, std::fstream &, int32_t); // 保存原子到文件
+    uint64_t content_start();                                   // 获取内容起始位置
+    virtual void save(std::fstream &, std::ostream &, int64_t); // 保存原子到输出流
     void set(uint8_t *, uint32_t);                              // 设置原子内容数据
-    int size();                                                 // 计算原子总大小
+    uint64_t size();                                            // 计算原子总大小
     const char *name();                                         // 获取原子名称
     virtual void print_structure(const char *);                 // 打印原子结构（调试）
 
     // 【数据复制方法】
-    void tag_copy(std::fstream &, std::fstream &, int32_t);                // 普通数据复制
-    void index_copy(std::fstream &, std::fstream &, Box *, bool, int32_t); // 索引表复制
-    void stco_copy(std::fstream &, std::fstream &, Box *, int32_t);        // STCO原子复制
-    void co64_copy(std::fstream &, std::fstream &, Box *, int32_t);        // CO64原子复制
+    static void tag_copy(std::fstream &, std::ostream &, uint64_t);        // 普通数据复制（分块缓冲）
+    void index_copy(std::fstream &, std::ostream &, Box *, bool, int64_t); // 索引表复制
+    void stco_copy(std::fstream &, std::ostream &, Box *, int64_t);        // STCO原子复制
+    void co64_copy(std::fstream &, std::ostream &, Box *, int64_t);        // CO64原子复制
 
 public:
     // 【静态读取方法】：从文件流读取各种数据类型（大端序）
@@ -65,11 +66,11 @@ public:
     static double readDouble(std::fstream &fs);   // 读取双精度浮点数
 
     // 【静态写入方法】：向文件流写入各种数据类型（转换为大端序）
-    static void writeInt16(std::fstream &fs, int16_t);   // 写入16位有符号整数
-    static void writeInt32(std::fstream &fs, int32_t);   // 写入32位有符号整数
-    static void writeUint8(std::fstream &fs, uint8_t);   // 写入8位无符号整数
-    static void writeUint32(std::fstream &fs, uint32_t); // 写入32位无符号整数
-    static void writeUint64(std::fstream &fs, uint64_t); // 写入64位无符号整数
+    static void writeInt16(std::ostream &fs, int16_t);   // 写入16位有符号整数
+    static void writeInt32(std::ostream &fs, int32_t);   // 写入32位有符号整数
+    static void writeUint8(std::ostream &fs, uint8_t);   // 写入8位无符号整数
+    static void writeUint32(std::ostream &fs, uint32_t); // 写入32位无符号整数
+    static void writeUint64(std::ostream &fs, uint64_t); // 写入64位无符号整数
 
     int32_t m_iType; // 【公有成员】：原子类型标识
 
@@ -79,13 +80,13 @@ private:
     uint64_t uint64FromCont(int32_t &iIDX); // 从内容数据读取64位无符号整数
 
     // 【私有方法】：从内存内容复制索引表
-    void index_copy_from_contents(std::fstream &fsOut, Box *pBox, bool bBigMode, int32_t iDelta);
+    void index_copy_from_contents(std::ostream &fsOut, Box *pBox, bool bBigMode, int64_t iDelta);
 
 public:
     // 【原子数据结构成员】
     char m_name[4];          // 原子名称（4字节ASCII码）
-    uint32_t m_iPosition;    // 原子在文件中的起始位置
+    uint64_t m_iPosition;    // 原子在文件中的起始位置（64位，支持4GB以上的文件）
     uint32_t m_iHeaderSize;  // 头部大小（8或16字节）
-    uint32_t m_iContentSize; // 内容数据大小
+    uint64_t m_iContentSize; // 内容数据大小（mdat可能超过4GB）
     uint8_t *m_pContents;    // 内容数据指针（动态分配）
 };
@@ -79,6 +79,7 @@ static const char *TRAK_TYPE_VIDE = "vide"; // 视频轨道类型
 static const char *TAG_STCO = "stco"; // 32位块偏移表（Chunk Offset）
 static const char *TAG_CO64 = "co64"; // 64位块偏移表（Chunk Offset 64）
 static const char *TAG_FREE = "free"; // 空闲空间原子
+static const char *TAG_SKIP = "skip"; // 空闲空间原子（free的别名）
 static const char *TAG_MDAT = "mdat"; // 媒体数据原子（Media Data）
 static const char *TAG_XML = "xml ";  // XML元数据原子
 static const char *TAG_HDLR = "hdlr"; // 处理器引用原子（Handler Reference）
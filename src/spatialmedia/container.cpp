@@ -41,11 +41,11 @@ Container::~Container()
 
 // 【核心功能】：从文件流加载容器原子
 // 【说明】：容器原子可以包含其他原子，形成层次结构
-Box *Container::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
+Box *Container::load(std::fstream &fs, uint64_t iPos, uint64_t iEnd)
 {
     fs.seekg(iPos);                  // 定位到指定位置
     uint32_t iHeaderSize = 8;        // 默认头部大小8字节
-    uint32_t iSize = readUint32(fs); // 读取原子大小
+    uint64_t iSize = readUint32(fs); // 读取原子大小
     char name[4];
     fs.read(name, 4); // 读取原子名称
 
@@ -74,7 +74,7 @@ Box *Container::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
 
     // 处理扩展大小格式（当size=1时）
     if (iSize == 1) {
-        iSize = (uint32_t) readUint64(fs); // 读取64位实际大小
+        iSize = readUint64(fs); // 读取64位实际大小
         iHeaderSize = 16;                  // 扩展头部大小16字节
     }
 
@@ -99,7 +99,7 @@ Box *Container::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
         iPadding = 8; // STSD原子基础填充
 
     // 检查音频样本描述格式，设置相应的填充大小
-    uint32_t iCurrentPos = 0;
+    uint64_t iCurrentPos = 0;
     int16_t iSampleDescVersion = 0;
     iArrSize = (int32_t) (sizeof(constants::SOUND_SAMPLE_DESCRIPTIONS)
                           / sizeof(constants::SOUND_SAMPLE_DESCRIPTIONS[0]));
@@ -153,7 +153,7 @@ Box *Container::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
 
 // 【功能】：从文件流加载多个原子
 // 【说明】：在指定范围内连续加载原子，直到达到结束位置
-std::vector<Box *> Container::load_multiple(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
+std::vector<Box *> Container::load_multiple(std::fstream &fs, uint64_t iPos, uint64_t iEnd)
 {
     std::vector<Box *> list, empty;
 
@@ -194,8 +194,8 @@ void Container::resize()
 void Container::print_structure(const char *pIndent)
 {
     // 打印当前容器的基本信息
-    uint32_t iSize1 = m_iHeaderSize;
-    uint32_t iSize2 = m_iContentSize;
+    uint64_t iSize1 = m_iHeaderSize;
+    uint64_t iSize2 = m_iContentSize;
     std::cout << "{" << pIndent << "} {" << name() << "} [{" << iSize1 << "}, {" << iSize2 << "}]"
               << std::endl;
 
@@ -303,7 +303,7 @@ bool Container::merge(Box *pElem)
 
 // 【功能】：保存容器到输出文件流
 // 【说明】：递归保存容器及其所有子原子
-void Container::save(std::fstream &fsIn, std::fstream &fsOut, int32_t iDelta)
+void Container::save(std::fstream &fsIn, std::ostream &fsOut, int64_t iDelta)
 {
     // 写入容器头部
     if (m_iHeaderSize == 16) {
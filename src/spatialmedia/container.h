@@ -39,10 +39,10 @@ public:
 
     // 【静态方法】：容器加载操作
     // 【功能】：从文件流加载容器原子（支持递归加载子原子）
-    static Box *load(std::fstream &, uint32_t iPos, uint32_t iEnd);
+    static Box *load(std::fstream &, uint64_t iPos, uint64_t iEnd);
 
     // 【功能】：从文件流连续加载多个原子
-    static std::vector<Box *> load_multiple(std::fstream &, uint32_t iPos, uint32_t iEnd);
+    static std::vector<Box *> load_multiple(std::fstream &, uint64_t iPos, uint64_t iEnd);
 
     // 【容器管理方法】
 
@@ -62,7 +62,7 @@ public:
     bool merge(Box *);
 
     // 【功能】：保存容器到输出文件流（递归保存所有子原子）
-    virtual void save(std::fstream &, std::fstream &, int32_t);
+    virtual void save(std::fstream &, std::ostream &, int64_t);
 
 public:
     // 【公有成员】：容器特定属性
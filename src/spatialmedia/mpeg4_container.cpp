@@ -17,8 +17,10 @@
  ****************************************************************************/
 
 #include <iostream>
+#include <sstream>
 #include <stdlib.h>
 #include <string.h>
+#include <vector>
 
 #include "mpeg4_container.h"
 
@@ -30,6 +32,7 @@ Mpeg4Container::Mpeg4Container()
     m_pFirstMDatBox = NULL;
     m_pFTYPBox = NULL;
     m_iFirstMDatPos = 0;
+    m_iMoovSpace = 0;
 }
 
 Mpeg4Container::~Mpeg4Container() {}
@@ -38,7 +41,7 @@ Mpeg4Container *Mpeg4Container::load(std::fstream &fsIn) //, uint32_t /* iPos */
 {
     // Load the mpeg4 file structure of a file.
     //  fsIn.seekg ( 0, 2 );
-    int32_t iSize = fsIn.tellg();
+    uint64_t iSize = fsIn.tellg();
     std::vector<Box *> list = load_multiple(fsIn, 0, iSize);
 
     if (list.empty()) {
@@ -72,6 +75,20 @@ Mpeg4Container *Mpeg4Container::load(std::fstream &fsIn) //, uint32_t /* iPos */
     }
     pNewBox->m_iFirstMDatPos = pNewBox->m_pFirstMDatBox->m_iPosition; //m_iFirstMDatPos;
     pNewBox->m_iFirstMDatPos += pNewBox->m_pFirstMDatBox->m_iHeaderSize;
+    // The moov box may grow into a free box right after it. If moov is the
+    // last box, it can grow without moving anything.
+    for (size_t i = 0; i < list.size(); i++) {
+        if (list[i] != pNewBox->m_pMoovBox)
+            continue;
+        if (i + 1 < list.size()) {
+            pNewBox->m_iMoovSpace = list[i]->size();
+            Box *pNext = list[i + 1];
+            if (memcmp(pNext->m_name, constants::TAG_FREE, 4) == 0
+                || memcmp(pNext->m_name, constants::TAG_SKIP, 4) == 0)
+                pNewBox->m_iMoovSpace += pNext->size();
+        }
+        break;
+    }
     pNewBox->m_iContentSize = 0;
     it = pNewBox->m_listContents.begin();
     while (it != pNewBox->m_listContents.end()) {
@@ -105,11 +122,11 @@ void Mpeg4Container::print_structure(const char *pIndent)
     }
 }
 
-void Mpeg4Container::save(std::fstream &fsIn, std::fstream &fsOut, int32_t)
+void Mpeg4Container::save(std::fstream &fsIn, std::ostream &fsOut, int64_t)
 {
     // Save mpeg4 filecontent to file.
     resize();
-    uint32_t iNewPos = 0;
+    uint64_t iNewPos = 0;
     std::vector<Box *>::iterator it = m_listContents.begin();
     while (it != m_listContents.end()) {
         Box *pBox = *it++;
@@ -119,10 +136,46 @@ void Mpeg4Container::save(std::fstream &fsIn, std::fstream &fsOut, int32_t)
         }
         iNewPos += pBox->size();
     }
-    uint32_t iDelta = iNewPos - m_iFirstMDatPos;
+    int64_t iDelta = int64_t(iNewPos) - int64_t(m_iFirstMDatPos);
     it = m_listContents.begin();
     while (it != m_listContents.end()) {
         Box *pBox = *it++;
         pBox->save(fsIn, fsOut, iDelta);
     }
 }
+
+bool Mpeg4Container::canSaveInPlace()
+{
+    resize();
+    if (!m_iMoovSpace)
+        return true;
+    const uint64_t iSize = m_pMoovBox->size();
+    if (iSize > m_iMoovSpace)
+        return false;
+    // The rest must be covered by a free box, which needs at least a header.
+    const uint64_t iRemaining = m_iMoovSpace - iSize;
+    return iRemaining == 0 || (iRemaining >= 8 && iRemaining <= UINT32_MAX);
+}
+
+bool Mpeg4Container::saveInPlace(std::fstream &fsIn, std::fstream &fs)
+{
+    // Patch the moov box without moving mdat, so the chunk offsets stay valid.
+    if (!canSaveInPlace())
+        return false;
+    Container *pMoov = (Container *) m_pMoovBox;
+    // Build the new moov first because its children are read from the file.
+    std::ostringstream moov;
+    pMoov->save(fsIn, moov, 0);
+    const std::string data = moov.str();
+    const uint64_t iRemaining = m_iMoovSpace ? m_iMoovSpace - data.size() : 0;
+    fs.seekp(pMoov->m_iPosition);
+    fs.write(data.data(), data.size());
+    if (iRemaining > 0) {
+        writeUint32(fs, uint32_t(iRemaining));
+        fs.write(constants::TAG_FREE, 4);
+        std::vector<char> zeros(iRemaining - 8, 0);
+        fs.write(zeros.data(), zeros.size());
+    }
+    fs.flush();
+    return bool(fs);
+}
@@ -35,12 +35,22 @@ public:
 
     void merge(Box *);
     virtual void print_structure(const char *p = "");
-    virtual void save(std::fstream &, std::fstream &, int32_t);
+    virtual void save(std::fstream &, std::ostream &, int64_t);
+    // Returns whether saveInPlace() can write the moov box: the new moov box
+    // must fit in the space of the old one and a free box that follows it, or
+    // the moov box must be the last box.
+    bool canSaveInPlace();
+    // Rewrites only the moov box of the file open in fs, which must be the
+    // loaded file or a copy of it, so mdat is neither copied nor moved.
+    // Returns false without writing anything if canSaveInPlace() is false.
+    bool saveInPlace(std::fstream &fsIn, std::fstream &fs);
 
 public:
     Box *m_pMoovBox;
     Box *m_pFreeBox;
     Box *m_pFTYPBox;
     Mpeg4Container *m_pFirstMDatBox;
-    uint32_t m_iFirstMDatPos;
+    uint64_t m_iFirstMDatPos;
+    // The bytes available to the moov box where it is, or 0 if it is the last box.
+    uint64_t m_iMoovSpace;
 };
@@ -1,7 +1,7 @@
 /*****************************************************************************
  * 
  * Copyright 2016 Varol Okan. All rights reserved.
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  * 
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -54,21 +54,20 @@ SA3DBox::SA3DBox()
 SA3DBox::~SA3DBox() {}
 
 // Loads the SA3D box located at position pos in a mp4 file.
-Box *SA3DBox::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
+Box *SA3DBox::load(std::fstream &fs, uint64_t iPos, uint64_t iEnd)
 {
     SA3DBox *pNewBox = NULL;
-    if (iPos < 0)
-        iPos = fs.tellg();
-
     char name[4];
 
     fs.seekg(iPos);
-    uint32_t iSize = readUint32(fs);
+    uint32_t iHeaderSize = 8;
+    uint64_t iSize = readUint32(fs);
     fs.read(name, 4);
     // Test if iSize == 1
     // Added for 360Tube to have load and save in-sync.
     if (iSize == 1) {
-        iSize = (int32_t) readUint64(fs);
+        iSize = readUint64(fs);
+        iHeaderSize = 16;
     }
 
     if (0 != memcmp(name, constants::TAG_SA3D, sizeof(*constants::TAG_SA3D))) {
@@ -83,7 +82,8 @@ Box *SA3DBox::load(std::fstream &fs, uint32_t iPos, uint32_t iEnd)
 
     pNewBox = new SA3DBox();
     pNewBox->m_iPosition = iPos;
-    pNewBox->m_iContentSize = iSize - pNewBox->m_iHeaderSize;
+    pNewBox->m_iHeaderSize = iHeaderSize;
+    pNewBox->m_iContentSize = iSize - iHeaderSize;
     pNewBox->m_iVersion = readUint8(fs);
     pNewBox->m_iAmbisonicType = readUint8(fs);
     pNewBox->m_iAmbisonicOrder = readUint32(fs);
@@ -133,7 +133,7 @@ Box *SA3DBox::create(int32_t iNumChannels)
     return pNewBox;
 }
 
-void SA3DBox::save(std::fstream &fsIn, std::fstream &fsOut, int32_t)
+void SA3DBox::save(std::fstream &fsIn, std::ostream &fsOut, int64_t)
 {
     (void) fsIn; // unused
     //char tmp, name[4];
@@ -2,7 +2,7 @@
 /*****************************************************************************
  * 
  * Copyright 2016 Varol Okan. All rights reserved.
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -41,11 +41,11 @@ public:
     virtual ~SA3DBox();
 
     // Loads the SA3D box located at position pos in a mp4 file.
-    static Box *load(std::fstream &fs, uint32_t iPos, uint32_t iEnd);
+    static Box *load(std::fstream &fs, uint64_t iPos, uint64_t iEnd);
 
     static Box *create(int32_t iNumChannels);
 
-    virtual void save(std::fstream &fsIn, std::fstream &fsOut, int32_t);
+    virtual void save(std::fstream &fsIn, std::ostream &fsOut, int64_t);
     const char *ambisonic_type_name();
     const char *ambisonic_channel_ordering_name();
     const char *ambisonic_normalization_name();
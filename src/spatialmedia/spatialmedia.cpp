@@ -1,7 +1,7 @@
 /*****************************************************************************
  *
  * Copyright 2016 Varol Okan. All rights reserved.
- * Copyright (c) 2020-2024 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -22,8 +22,11 @@
 #include "sa3d.h"
 
 #include "Logger.h"
+#include <QFile>
+#include <QFileInfo>
 #include <fstream>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <stdint.h>
 
@@ -255,7 +258,7 @@ static bool mpeg4_add_spherical(Mpeg4Container *pMPEG4,
                         continue;
 
                     char name[4];
-                    int iPos = pMDIA->content_start() + 8;
+                    uint64_t iPos = pMDIA->content_start() + 8;
                     inFile.seekg(iPos);
                     inFile.read(name, 4);
                     if (memcmp(name, constants::TRAK_TYPE_VIDE, 4) == 0) {
@@ -283,7 +286,7 @@ bool SpatialMedia::injectSpherical(const std::string &strInFile, const std::stri
                     << "\" does not exist or do not have permission.";
         return false;
     }
-    Mpeg4Container *pMPEG4 = Mpeg4Container::load(inFile);
+    std::unique_ptr<Mpeg4Container> pMPEG4(Mpeg4Container::load(inFile));
     if (!pMPEG4) {
         LOG_ERROR() << "Error, file could not be opened.";
         return false;
@@ -296,18 +299,61 @@ bool SpatialMedia::injectSpherical(const std::string &strInFile, const std::stri
     std::string xml = SPHERICAL_XML_HEADER + SPHERICAL_XML_CONTENTS + stereo_xml
                       + SPHERICAL_XML_FOOTER;
     ;
-    bool bRet = mpeg4_add_spherical(pMPEG4, inFile, xml);
+    bool bRet = mpeg4_add_spherical(pMPEG4.get(), inFile, xml);
     if (!bRet) {
         LOG_ERROR() << "Error failed to insert spherical data";
     }
-    LOG_INFO() << "Saved spatial media metadata";
 
-    std::fstream outFile(strOutFile.c_str(), std::ios::out | std::ios::binary);
-    if (!outFile.is_open()) {
-        LOG_ERROR() << "Error file: \"" << strOutFile.c_str()
-                    << "\" could not create or do not have permission.";
-        return false;
+    const QString inPath = QString::fromStdString(strInFile);
+    const QString outPath = QString::fromStdString(strOutFile);
+    const bool isSameFile = QFileInfo(inPath) == QFileInfo(outPath);
+
+    // Patch the moov box of the file or of a copy of it, which the file
+    // system can clone or copy without passing mdat through this process.
+    if (pMPEG4->canSaveInPlace()) {
+        if (!isSameFile) {
+            QFile::remove(outPath);
+            if (!QFile::copy(inPath, outPath)) {
+                LOG_ERROR() << "Error file: \"" << strOutFile.c_str()
+                            << "\" could not create or do not have permission.";
+                return false;
+            }
+        }
+        std::fstream outFile(strOutFile.c_str(), std::ios::in | std::ios::out | std::ios::binary);
+        if (outFile.is_open() && pMPEG4->saveInPlace(inFile, outFile)) {
+            LOG_INFO() << "Saved spatial media metadata in place";
+            return true;
+        }
+        LOG_WARNING() << "failed to save spatial media metadata in place";
+        if (isSameFile)
+            return false;
     }
-    pMPEG4->save(inFile, outFile, 0);
+
+    // Otherwise, rewrite the whole file with mdat moved and its offsets updated.
+    // Writing to the file being read is not possible, so use a temporary file.
+    const std::string strTempFile = isSameFile ? strOutFile + ".tmp" : strOutFile;
+    {
+        std::fstream outFile(strTempFile.c_str(),
+                             std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!outFile.is_open()) {
+            LOG_ERROR() << "Error file: \"" << strTempFile.c_str()
+                        << "\" could not create or do not have permission.";
+            return false;
+        }
+        pMPEG4->save(inFile, outFile, 0);
+        if (!outFile) {
+            LOG_ERROR() << "Error writing file: \"" << strTempFile.c_str() << "\"";
+            return false;
+        }
+    }
+    if (isSameFile) {
+        inFile.close();
+        const QString tempPath = QString::fromStdString(strTempFile);
+        if (!QFile::remove(inPath) || !QFile::rename(tempPath, inPath)) {
+            LOG_ERROR() << "Error replacing file: \"" << strInFile.c_str() << "\"";
+            return false;
+        }
+    }
+    LOG_INFO() << "Saved spatial media metadata";
     return true;
 }
@@ -1,7 +1,7 @@
 /*****************************************************************************
  *
  * Copyright 2016 Varol Okan. All rights reserved.
- * Copyright (c) 2020 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * Licensed under the Apache License, Version 2.0 (the "License");
  * you may not use this file except in compliance with the License.
@@ -28,6 +28,8 @@ private:
     SpatialMedia(){};
 
 public:
+    // Writes inFile with spherical metadata to outFile, which may be inFile.
+    // Only the moov box is written when it fits where it is.
     static bool injectSpherical(const std::string &inFile, const std::string &outFile);
 };
 
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "startupprofile.h"
+
+#include "Logger.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+#include <algorithm>
+
+namespace {
+
+struct Record
+{
+    const char *name;
+    qint64 start;
+    qint64 end;
+    bool isMainThread;
+};
+
+} // namespace
+
+static QElapsedTimer s_timer;
+static QMutex s_mutex;
+static QList<Record> s_records;
+static bool s_isEnabled = false;
+static bool s_isFinished = false;
+static Qt::HANDLE s_mainThread = nullptr;
+
+StartupProfile::Phase::Phase(const char *name)
+    : m_name(name)
+    , m_start(s_timer.isValid() ? s_timer.nsecsElapsed() : -1)
+{}
+
+StartupProfile::Phase::~Phase()
+{
+    if (m_start >= 0)
+        StartupProfile::record(m_name, m_start, s_timer.nsecsElapsed());
+}
+
+void StartupProfile::start()
+{
+    s_mainThread = QThread::currentThreadId();
+    s_timer.start();
+}
+
+bool StartupProfile::isEnabled()
+{
+    QMutexLocker locker(&s_mutex);
+    return s_isEnabled;
+}
+
+void StartupProfile::setEnabled(bool enabled)
+{
+    QMutexLocker locker(&s_mutex);
+    s_isEnabled = enabled;
+}
+
+void StartupProfile::finish()
+{
+    QMutexLocker locker(&s_mutex);
+    if (s_isFinished || !s_timer.isValid())
+        return;
+    s_isFinished = true;
+    if (!s_isEnabled) {
+        s_records.clear();
+        return;
+    }
+    const qint64 total = s_timer.nsecsElapsed();
+    std::sort(s_records.begin(), s_records.end(), [](const Record &a, const Record &b) {
+        return a.start < b.start;
+    });
+    for (const auto &r : std::as_const(s_records)) {
+        LOG_INFO() << "startup phase" << r.name << "at" << r.start / 1000000 << "ms took"
+                   << (r.end - r.start) / 1000000 << "ms" << (r.isMainThread ? "" : "(background)");
+    }
+    LOG_INFO() << "startup took" << total / 1000000 << "ms to interactive";
+    s_records.clear();
+}
+
+void StartupProfile::record(const char *name, qint64 start, qint64 end)
+{
+    QMutexLocker locker(&s_mutex);
+    if (!s_isFinished) {
+        s_records << Record{name, start, end, QThread::currentThreadId() == s_mainThread};
+    } else if (s_isEnabled) {
+        // A background phase that outlasted startup
+        LOG_INFO() << "startup phase" << name << "at" << start / 1000000 << "ms took"
+                   << (end - start) / 1000000 << "ms (background)";
+    }
+}
@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef STARTUPPROFILE_H
+#define STARTUPPROFILE_H
+
+#include <QtGlobal>
+
+/*!
+  \class StartupProfile
+  \brief Times the phases of startup up to the first idle event loop.
+
+  \threadsafe
+
+  Phases are always recorded since there are only a few dozen, but they are
+  only logged when profiling is enabled with --profile-startup. Phases that
+  run on a worker thread overlap the ones on the main thread, so the sum of
+  the durations may exceed the total, and one that ends after startup is
+  logged when it ends. Phase names must be string literals.
+*/
+
+class StartupProfile
+{
+public:
+    //! Records the duration of the enclosing scope as a phase.
+    class Phase
+    {
+    public:
+        explicit Phase(const char *name);
+        ~Phase();
+
+    private:
+        const char *m_name;
+        qint64 m_start;
+    };
+
+    //! Starts the clock; call it first in main().
+    static void start();
+    static bool isEnabled();
+    static void setEnabled(bool enabled);
+    //! Logs the phases and the total time if enabled, once.
+    static void finish();
+
+private:
+    static void record(const char *name, qint64 start, qint64 end);
+};
+
+#endif // STARTUPPROFILE_H
@@ -0,0 +1,286 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnaildecoderpool.h"
+
+#include "Logger.h"
+#include "glthumbnailrenderer.h"
+#include "mltcontroller.h"
+#include "settings.h"
+
+#include <MltFilter.h>
+#include <MltProducer.h>
+#include <QCoreApplication>
+#include <QDateTime>
+
+#include <algorithm>
+
+static const int kMaxDecoders = 8;
+static const int kIdleTimeoutMs = 30000;
+
+static QMutex g_mutex;
+static ThumbnailDecoderPool *instance = nullptr;
+
+ThumbnailDecoderPool &ThumbnailDecoderPool::singleton()
+{
+    QMutexLocker locker(&g_mutex);
+    if (!instance) {
+        instance = new ThumbnailDecoderPool;
+    }
+    return *instance;
+}
+
+ThumbnailDecoderPool::ThumbnailDecoderPool()
+    : QObject()
+    , m_profile("atsc_720p_60")
+    , m_idleTimer(this)
+{
+    m_idleTimer.setInterval(kIdleTimeoutMs / 3);
+    connect(&m_idleTimer, SIGNAL(timeout()), this, SLOT(onIdleTimeout()));
+    // The first use is usually from a worker thread, but the timer needs an
+    // event loop.
+    if (QCoreApplication::instance()) {
+        moveToThread(QCoreApplication::instance()->thread());
+        QMetaObject::invokeMethod(&m_idleTimer, "start", Qt::QueuedConnection);
+    }
+}
+
+ThumbnailDecoderPool::~ThumbnailDecoderPool()
+{
+    clear();
+}
+
+QImage ThumbnailDecoderPool::image(const QString &service,
+                                   const QString &resource,
+                                   int frameNumber,
+                                   int width,
+                                   int height,
+                                   SeekMode mode,
+                                   Validator validator)
+{
+    return images(service, resource, {frameNumber}, width, height, mode, validator).value(0);
+}
+
+QList<QImage> ThumbnailDecoderPool::images(const QString &service,
+                                           const QString &resource,
+                                           const QList<int> &frameNumbers,
+                                           int width,
+                                           int height,
+                                           SeekMode mode,
+                                           Validator validator)
+{
+    QList<QImage> result;
+    if (frameNumbers.isEmpty())
+        return result;
+    for (int i = 0; i < frameNumbers.size(); ++i)
+        result << QImage();
+
+    // Nested projects in GPU mode need a decoder with an OpenGL context.
+    if (GlThumbnailRenderer::isRequired(service)) {
+        QList<int> order = frameNumbers;
+        std::sort(order.begin(), order.end());
+        const auto images = GlThumbnailRenderer::singleton()
+                                .images(m_profile,
+                                        service,
+                                        resource,
+                                        order,
+                                        width,
+                                        height,
+                                        isFastSeek(mode),
+                                        validator);
+        for (int i = 0; i < frameNumbers.size(); ++i)
+            result[i] = images.value(order.indexOf(frameNumbers[i]));
+        return result;
+    }
+
+    QList<int> order;
+    for (int i = 0; i < frameNumbers.size(); ++i)
+        order << i;
+    std::sort(order.begin(), order.end(), [&](int a, int b) {
+        return frameNumbers[a] < frameNumbers[b];
+    });
+
+    // Fast and accurate decoders are configured differently and kept apart.
+    const bool isFast = isFastSeek(mode);
+    const auto key = QStringLiteral("%1 %2 %3").arg(isFast ? "fast" : "exact", service, resource);
+    auto decoder = acquire(key, service, resource, frameNumbers[order.first()], isFast, validator);
+    if (!decoder)
+        return result;
+    int position = decoder->position;
+    bool isMissing = false;
+    const bool isValid = decoder->producer;
+    if (isValid) {
+        for (auto i : order) {
+            result[i] = MLT.image(*decoder->producer, frameNumbers[i], width, height, isFast);
+            position = frameNumbers[i];
+            isMissing = isMissing || result[i].isNull();
+        }
+    }
+    release(decoder, position);
+
+    // There may be no keyframe after the requested frame near the end.
+    if (isFast && isMissing && isValid) {
+        QList<int> missing;
+        for (int i = 0; i < result.size(); ++i) {
+            if (result[i].isNull())
+                missing << frameNumbers[i];
+        }
+        auto images = this->images(service,
+                                   resource,
+                                   missing,
+                                   width,
+                                   height,
+                                   AccurateSeek,
+                                   validator);
+        for (int i = 0, j = 0; i < result.size(); ++i) {
+            if (result[i].isNull())
+                result[i] = images.value(j++);
+        }
+    }
+    return result;
+}
+
+bool ThumbnailDecoderPool::isFastSeek(SeekMode mode)
+{
+    return mode == FastSeek || (mode == DefaultSeek && Settings.thumbnailsFastSeek());
+}
+
+void ThumbnailDecoderPool::clear()
+{
+    QMutexLocker locker(&m_mutex);
+    evict(0, 0);
+}
+
+ThumbnailDecoderPool::Decoder *ThumbnailDecoderPool::acquire(const QString &key,
+                                                            const QString &service,
+                                                            const QString &resource,
+                                                            int frameNumber,
+                                                            bool isFast,
+                                                            Validator validator)
+{
+    QMutexLocker locker(&m_mutex);
+    auto decoder = m_decoders.value(key);
+    if (!decoder) {
+        evict(kIdleTimeoutMs, kMaxDecoders - 1);
+        decoder = new Decoder{nullptr, true, 0, 0, {}};
+        m_decoders.insert(key, decoder);
+        // Open without holding the pool lock; others wait for the decoder.
+        locker.unlock();
+        auto producer = createProducer(service, resource, isFast);
+        if (producer && (!producer->is_valid() || (validator && !validator(*producer)))) {
+            delete producer;
+            producer = nullptr;
+        }
+        locker.relock();
+        decoder->producer = producer;
+        return decoder;
+    }
+
+    decoder->waiting << frameNumber;
+    while (decoder->isBusy || nextFrame(decoder) != frameNumber)
+        m_released.wait(&m_mutex);
+    decoder->waiting.removeOne(frameNumber);
+    decoder->isBusy = true;
+    return decoder;
+}
+
+void ThumbnailDecoderPool::release(Decoder *decoder, int position)
+{
+    QMutexLocker locker(&m_mutex);
+    decoder->isBusy = false;
+    decoder->position = position;
+    decoder->lastUsed = QDateTime::currentMSecsSinceEpoch();
+    m_released.wakeAll();
+}
+
+int ThumbnailDecoderPool::nextFrame(const Decoder *decoder) const
+{
+    // Prefer the closest frame ahead of the current position, then wrap.
+    int ahead = -1;
+    int lowest = -1;
+    for (auto frame : decoder->waiting) {
+        if (frame >= decoder->position && (ahead < 0 || frame < ahead))
+            ahead = frame;
+        if (lowest < 0 || frame < lowest)
+            lowest = frame;
+    }
+    return ahead >= 0 ? ahead : lowest;
+}
+
+void ThumbnailDecoderPool::evict(qint64 idleMs, int maxCount)
+{
+    // The caller must hold m_mutex.
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+    QList<QPair<qint64, QString>> idle;
+    for (auto it = m_decoders.constBegin(); it != m_decoders.constEnd(); ++it) {
+        auto decoder = it.value();
+        if (!decoder->isBusy && decoder->waiting.isEmpty())
+            idle << qMakePair(decoder->lastUsed, it.key());
+    }
+    std::sort(idle.begin(), idle.end());
+    int count = m_decoders.size();
+    for (const auto &item : idle) {
+        if (count <= maxCount && now - item.first < idleMs)
+            break;
+        auto decoder = m_decoders.take(item.second);
+        delete decoder->producer;
+        delete decoder;
+        --count;
+    }
+}
+
+Mlt::Producer *ThumbnailDecoderPool::createProducer(const QString &service,
+                                                    const QString &resource,
+                                                    bool isFast)
+{
+    QString name = service;
+    if (name == "avformat-novalidate")
+        name = "avformat";
+    else if (name.startsWith("xml"))
+        name = "xml-nogl";
+    Mlt::Producer *producer = nullptr;
+    if (name == "count") {
+        producer = new Mlt::Producer(m_profile, name.toUtf8().constData(), "loader-nogl");
+    } else if (!Settings.playerGPU() || (name != "xml-nogl" && name != "consumer")) {
+        LOG_DEBUG() << name << resource;
+        producer = new Mlt::Producer(m_profile,
+                                     name.toUtf8().constData(),
+                                     resource.toUtf8().constData());
+    }
+    if (producer && producer->is_valid()) {
+        if (isFast && QString::fromLatin1(producer->get("mlt_service")).startsWith("avformat")) {
+            // These are passed to the decoder as AVOptions when it opens. Only
+            // keyframes are decoded after a seek, so the first keyframe at or
+            // after the requested frame is returned.
+            producer->set("skip_frame", "nokey");
+            producer->set("skip_loop_filter", "all");
+        }
+        Mlt::Filter scaler(m_profile, "swscale");
+        Mlt::Filter padder(m_profile, "resize");
+        Mlt::Filter converter(m_profile, "avcolor_space");
+        producer->attach(scaler);
+        producer->attach(padder);
+        producer->attach(converter);
+    }
+    return producer;
+}
+
+void ThumbnailDecoderPool::onIdleTimeout()
+{
+    QMutexLocker locker(&m_mutex);
+    evict(kIdleTimeoutMs, kMaxDecoders);
+}
@@ -0,0 +1,121 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILDECODERPOOL_H
+#define THUMBNAILDECODERPOOL_H
+
+#include <MltProfile.h>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+#include <QWaitCondition>
+
+#include <functional>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class ThumbnailDecoderPool
+  \brief Keeps warm producers for thumbnail generation keyed by resource.
+
+  \threadsafe
+
+  Opening and probing a producer is often much more expensive than decoding
+  one frame, especially for long-GOP media. The pool keeps one open producer
+  per service and resource so that the in and out thumbnails of a playlist
+  item and all of the timeline thumbnails for the same file share a decoder.
+  When several threads want the same decoder, they are served in frame order
+  from the current position to keep seeks short. Idle decoders are closed
+  after a timeout and the least recently used are closed when over the cap.
+*/
+
+class ThumbnailDecoderPool : public QObject
+{
+    Q_OBJECT
+
+public:
+    typedef std::function<bool(Mlt::Producer &)> Validator;
+    enum SeekMode {
+        AccurateSeek, ///< Decode the exact frame requested
+        FastSeek,     ///< Accept the nearest following keyframe
+        DefaultSeek   ///< Use the thumbnails fast seek setting
+    };
+
+    static ThumbnailDecoderPool &singleton();
+    ~ThumbnailDecoderPool();
+
+    Mlt::Profile &profile() { return m_profile; }
+
+    QImage image(const QString &service,
+                 const QString &resource,
+                 int frameNumber,
+                 int width,
+                 int height,
+                 SeekMode mode = AccurateSeek,
+                 Validator validator = nullptr);
+    /// Renders several frames from one decoder in ascending frame order.
+    /// The results are in the same order as \a frameNumbers.
+    QList<QImage> images(const QString &service,
+                         const QString &resource,
+                         const QList<int> &frameNumbers,
+                         int width,
+                         int height,
+                         SeekMode mode = AccurateSeek,
+                         Validator validator = nullptr);
+    static bool isFastSeek(SeekMode mode);
+
+public slots:
+    void clear();
+
+private:
+    struct Decoder
+    {
+        Mlt::Producer *producer;
+        bool isBusy;
+        int position;
+        qint64 lastUsed;
+        QList<int> waiting;
+    };
+
+    explicit ThumbnailDecoderPool();
+    Decoder *acquire(const QString &key,
+                     const QString &service,
+                     const QString &resource,
+                     int frameNumber,
+                     bool isFast,
+                     Validator validator);
+    void release(Decoder *decoder, int position);
+    Mlt::Producer *createProducer(const QString &service, const QString &resource, bool isFast);
+    int nextFrame(const Decoder *decoder) const;
+    void evict(qint64 idleMs, int maxCount);
+
+    Mlt::Profile m_profile;
+    QMutex m_mutex;
+    QWaitCondition m_released;
+    QHash<QString, Decoder *> m_decoders;
+    QTimer m_idleTimer;
+
+private slots:
+    void onIdleTimeout();
+};
+
+#endif // THUMBNAILDECODERPOOL_H
@@ -0,0 +1,117 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "thumbnailscheduler.h"
+
+#include "Logger.h"
+#include "executors.h"
+
+#include <QMutexLocker>
+#include <QThread>
+
+// More than a screen full of items in the largest view
+static const int kMaxCancellable = 300;
+
+ThumbnailScheduler &ThumbnailScheduler::singleton()
+{
+    static ThumbnailScheduler instance;
+    return instance;
+}
+
+ThumbnailScheduler::ThumbnailScheduler()
+    : m_pool(Executors::pool(Executors::ThumbnailExecutor))
+{}
+
+void ThumbnailScheduler::request(const QString &key,
+                                 Task task,
+                                 const void *group,
+                                 bool isCancellable)
+{
+    QMutexLocker locker(&m_mutex);
+    if (isCancellable && m_running.contains(key))
+        return;
+    auto it = m_queued.find(key);
+    if (it != m_queued.end()) {
+        // Keep one request for the key, now the newest.
+        auto entry = it.value();
+        if (entry->isCancellable && !isCancellable)
+            --m_cancellableCount;
+        entry->task = std::move(task);
+        entry->group = group;
+        entry->isCancellable = entry->isCancellable && isCancellable;
+        m_queue.splice(m_queue.begin(), m_queue, entry);
+    } else {
+        m_queue.push_front({key, std::move(task), group, isCancellable});
+        m_queued.insert(key, m_queue.begin());
+        if (isCancellable)
+            ++m_cancellableCount;
+    }
+
+    // Drop the oldest requests nobody has asked for again.
+    for (auto entry = std::prev(m_queue.end());
+         m_cancellableCount > kMaxCancellable && entry != m_queue.begin();) {
+        auto previous = std::prev(entry);
+        if (entry->isCancellable) {
+            m_queued.remove(entry->key);
+            m_queue.erase(entry);
+            --m_cancellableCount;
+        }
+        entry = previous;
+    }
+
+    if (m_workerCount < m_pool.maxThreadCount()) {
+        ++m_workerCount;
+        Executors::start(Executors::ThumbnailExecutor, [this]() { runQueue(); });
+    }
+}
+
+void ThumbnailScheduler::cancel(const void *group)
+{
+    QMutexLocker locker(&m_mutex);
+    int n = 0;
+    for (auto entry = m_queue.begin(); entry != m_queue.end();) {
+        if (entry->group == group && entry->isCancellable) {
+            m_queued.remove(entry->key);
+            entry = m_queue.erase(entry);
+            --m_cancellableCount;
+            ++n;
+        } else {
+            ++entry;
+        }
+    }
+    if (n)
+        LOG_DEBUG() << "canceled" << n << "thumbnails";
+}
+
+void ThumbnailScheduler::runQueue()
+{
+    QMutexLocker locker(&m_mutex);
+    while (!m_queue.empty()) {
+        auto entry = std::move(m_queue.front());
+        m_queue.pop_front();
+        m_queued.remove(entry.key);
+        if (entry.isCancellable) {
+            --m_cancellableCount;
+            m_running.insert(entry.key);
+        }
+        locker.unlock();
+        entry.task();
+        locker.relock();
+        m_running.remove(entry.key);
+    }
+    --m_workerCount;
+}
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef THUMBNAILSCHEDULER_H
+#define THUMBNAILSCHEDULER_H
+
+#include <QHash>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+#include <QThreadPool>
+
+#include <functional>
+#include <list>
+
+/*!
+  \class ThumbnailScheduler
+  \brief Runs thumbnail tasks on their own threads, newest first.
+
+  \threadsafe
+
+  Views ask for the thumbnails of the items they paint, so the most recent
+  requests are the visible ones. The tasks run in last in, first out order on
+  the thumbnail executor, which does not compete with the pools used for
+  audio levels and scopes. A request for a key that is already queued
+  replaces that task and moves it to the front instead of adding another.
+
+  A cancellable request may be dropped: the oldest ones are dropped when too
+  many are queued, as happens when scrolling quickly through a big folder, and
+  cancel() drops those of a group, such as the files of the previous folder.
+  Their views ask again when they paint those items.
+*/
+
+class ThumbnailScheduler
+{
+public:
+    typedef std::function<void()> Task;
+
+    static ThumbnailScheduler &singleton();
+
+    /// Queues \a task unless a cancellable task for \a key is already running.
+    void request(const QString &key, Task task, const void *group, bool isCancellable = true);
+    /// Drops the queued cancellable tasks of \a group.
+    void cancel(const void *group);
+
+private:
+    ThumbnailScheduler();
+    void runQueue();
+
+    struct Entry
+    {
+        QString key;
+        Task task;
+        const void *group;
+        bool isCancellable;
+    };
+
+    QMutex m_mutex;
+    QThreadPool &m_pool;
+    // The front is the newest.
+    std::list<Entry> m_queue;
+    QHash<QString, std::list<Entry>::iterator> m_queued;
+    QSet<QString> m_running;
+    int m_cancellableCount{0};
+    int m_workerCount{0};
+};
+
+#endif // THUMBNAILSCHEDULER_H
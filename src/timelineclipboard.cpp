@@ -0,0 +1,92 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timelineclipboard.h"
+
+#include "Logger.h"
+#include "mltcontroller.h"
+
+#include <QClipboard>
+#include <QGuiApplication>
+#include <QMimeData>
+#include <QPointer>
+
+namespace {
+
+class MimeData : public QMimeData
+{
+public:
+    explicit MimeData(Mlt::Producer &producer)
+        : m_producer(producer)
+    {}
+
+    Mlt::Producer producer() const { return m_producer; }
+
+    QString xml() const
+    {
+        if (m_xml.isNull()) {
+            LOG_DEBUG() << "serializing the clipboard";
+            m_xml = MLT.XML(&m_producer);
+        }
+        return m_xml;
+    }
+
+    QStringList formats() const override { return {QStringLiteral("text/plain")}; }
+
+    bool hasFormat(const QString &mimeType) const override
+    {
+        return mimeType == QLatin1String("text/plain");
+    }
+
+protected:
+    QVariant retrieveData(const QString &mimeType, QMetaType type) const override
+    {
+        if (mimeType == QLatin1String("text/plain"))
+            return xml();
+        return QMimeData::retrieveData(mimeType, type);
+    }
+
+private:
+    mutable Mlt::Producer m_producer;
+    mutable QString m_xml;
+};
+
+} // namespace
+
+// The clipboard deletes the data when it is replaced.
+static QPointer<MimeData> s_mimeData;
+
+void TimelineClipboard::set(Mlt::Producer &producer)
+{
+    s_mimeData = new MimeData(producer);
+    QGuiApplication::clipboard()->setMimeData(s_mimeData);
+}
+
+bool TimelineClipboard::isOwner()
+{
+    return s_mimeData && QGuiApplication::clipboard()->mimeData() == s_mimeData.data();
+}
+
+Mlt::Producer TimelineClipboard::producer()
+{
+    return isOwner() ? s_mimeData->producer() : Mlt::Producer();
+}
+
+QString TimelineClipboard::xml()
+{
+    return isOwner() ? s_mimeData->xml() : QString();
+}
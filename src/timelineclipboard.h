@@ -0,0 +1,51 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TIMELINECLIPBOARD_H
+#define TIMELINECLIPBOARD_H
+
+#include <MltProducer.h>
+#include <QString>
+
+/*!
+  \class TimelineClipboard
+  \brief Puts the clips copied from the timeline on the clipboard without serializing them.
+
+  The clipboard holds references to the copied producers, which for several
+  clips are in the tracks of a tractor whose blanks keep their positions
+  relative to each other. Pasting in this process uses those producers as they
+  are. The MLT XML text is only made when something reads the clipboard as text,
+  such as another application or another instance of Shotcut.
+
+  Like the clip of the Source player, the clips are copied as they are at the
+  time they are pasted or read.
+*/
+
+class TimelineClipboard
+{
+public:
+    //! Puts \a producer, a clip or a tractor of clips, on the clipboard.
+    static void set(Mlt::Producer &producer);
+    //! Returns whether the clipboard still holds the clips last set in this process.
+    static bool isOwner();
+    //! Returns the clips on the clipboard, or an invalid producer if not isOwner().
+    static Mlt::Producer producer();
+    //! Returns the MLT XML of the clips on the clipboard, made on the first call.
+    static QString xml();
+};
+
+#endif // TIMELINECLIPBOARD_H
@@ -0,0 +1,365 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "titlecache.h"
+
+#include "Logger.h"
+#include "mainwindow.h"
+#include "memorybudget.h"
+#include "mltcontroller.h"
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+#include <QCryptographicHash>
+#include <QMutexLocker>
+#include <QPainter>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+
+static const char *kTitleCacheProperty = "_shotcut:titleCache";
+static const int kScheduleDelayMs = 500;
+static const int kMaxCacheCost = 64 * 1024; // KiB
+// The parameters that the text filters can keyframe.
+static const char *kKeyframeProperties[] = {"geometry",
+                                            "fgcolour",
+                                            "olcolour",
+                                            "bgcolour",
+                                            "opacity"};
+
+namespace {
+
+struct Title
+{
+    mlt_frame (*process)(mlt_filter, mlt_frame){nullptr};
+    QMutex mutex;
+    QByteArray key;
+    QImage image;
+    std::atomic<bool> isReady{false};
+};
+
+class TextFilterParser : public Mlt::Parser
+{
+public:
+    QList<Mlt::Filter> &filters() { return m_filters; }
+
+    int on_start_filter(Mlt::Filter *filter)
+    {
+        const char *service = filter->get("mlt_service");
+        if (service && (!qstrcmp(service, "qtext") || !qstrcmp(service, "dynamictext")))
+            m_filters << Mlt::Filter(*filter);
+        return 0;
+    }
+    int on_start_producer(Mlt::Producer *) { return 0; }
+    int on_end_producer(Mlt::Producer *) { return 0; }
+    int on_start_playlist(Mlt::Playlist *) { return 0; }
+    int on_end_playlist(Mlt::Playlist *) { return 0; }
+    int on_start_tractor(Mlt::Tractor *) { return 0; }
+    int on_end_tractor(Mlt::Tractor *) { return 0; }
+    int on_start_multitrack(Mlt::Multitrack *) { return 0; }
+    int on_end_multitrack(Mlt::Multitrack *) { return 0; }
+    int on_start_track() { return 0; }
+    int on_end_track() { return 0; }
+    int on_end_filter(Mlt::Filter *) { return 0; }
+    int on_start_transition(Mlt::Transition *) { return 0; }
+    int on_end_transition(Mlt::Transition *) { return 0; }
+    int on_start_chain(Mlt::Chain *) { return 0; }
+    int on_end_chain(Mlt::Chain *) { return 0; }
+    int on_start_link(Mlt::Link *) { return 0; }
+    int on_end_link(Mlt::Link *) { return 0; }
+
+private:
+    QList<Mlt::Filter> m_filters;
+};
+
+} // namespace
+
+static Title *titleOf(mlt_filter filter)
+{
+    return static_cast<Title *>(
+        mlt_properties_get_data(MLT_FILTER_PROPERTIES(filter), kTitleCacheProperty, nullptr));
+}
+
+static QImage imageOf(Title *title)
+{
+    QMutexLocker locker(&title->mutex);
+    return title->image;
+}
+
+static void closeTitle(void *data)
+{
+    delete static_cast<Title *>(data);
+}
+
+static int cachedGetImage(mlt_frame frame,
+                          uint8_t **image,
+                          mlt_image_format *format,
+                          int *width,
+                          int *height,
+                          int /* writable */)
+{
+    auto filter = static_cast<mlt_filter>(mlt_frame_pop_service(frame));
+    *format = (*format == mlt_image_rgba64) ? mlt_image_rgba64 : mlt_image_rgba;
+    int error = mlt_frame_get_image(frame, image, format, width, height, 1);
+    if (error)
+        return error;
+
+    // The title may have been edited since the frame was processed.
+    auto title = titleOf(filter);
+    const auto overlay = title ? imageOf(title) : QImage();
+    if (overlay.isNull())
+        return 0;
+    QImage target(*image,
+                  *width,
+                  *height,
+                  *format == mlt_image_rgba64 ? QImage::Format_RGBA64 : QImage::Format_RGBA8888);
+    QPainter painter(&target);
+    painter.setRenderHint(QPainter::SmoothPixmapTransform);
+    painter.drawImage(QRect(0, 0, *width, *height), overlay);
+    return 0;
+}
+
+static mlt_frame cachedProcess(mlt_filter filter, mlt_frame frame)
+{
+    auto title = titleOf(filter);
+    if (!title)
+        return frame;
+    if (!title->isReady)
+        return title->process(filter, frame);
+    mlt_frame_push_service(frame, filter);
+    mlt_frame_push_get_image(frame, cachedGetImage);
+    return frame;
+}
+
+static void onPropertyChanged(mlt_properties, void *object, mlt_event_data data)
+{
+    auto name = Mlt::EventData(data).to_string();
+    if (!name || name[0] == '_')
+        return;
+    auto title = static_cast<Title *>(object);
+    title->isReady = false;
+    {
+        // Keeps a render that is still running from bringing the old title back.
+        QMutexLocker locker(&title->mutex);
+        title->key.clear();
+    }
+    QMetaObject::invokeMethod(&TitleCache::singleton(),
+                              &TitleCache::schedule,
+                              Qt::QueuedConnection);
+}
+
+// Returns the properties that the output of the filter depends on.
+static Mlt::Properties snapshot(Mlt::Filter &filter)
+{
+    static const char *kSkipped[] = {"in", "out", "mlt_service", "mlt_type"};
+    Mlt::Properties properties;
+    for (int i = 0; i < filter.count(); ++i) {
+        const char *name = filter.get_name(i);
+        const char *value = filter.get(i);
+        if (!name || !value || name[0] == '_')
+            continue;
+        if (std::any_of(std::begin(kSkipped), std::end(kSkipped), [=](const char *skipped) {
+                return !qstrcmp(name, skipped);
+            }))
+            continue;
+        properties.set(name, value);
+    }
+    return properties;
+}
+
+static int keyCount(const char *value, double fps)
+{
+    auto animation = mlt_animation_new();
+    mlt_animation_parse(animation, value, 0, fps, nullptr);
+    const int count = mlt_animation_key_count(animation);
+    mlt_animation_close(animation);
+    return count;
+}
+
+TitleCache::TitleCache(QObject *parent)
+    : QObject(parent)
+{
+    m_images.setMaxCost(kMaxCacheCost);
+    MEMORY.add(
+        "title images",
+        MemoryBudget::FramePriority,
+        [this]() {
+            QMutexLocker locker(&m_mutex);
+            return qint64(m_images.totalCost()) * 1024;
+        },
+        [this](qint64 bytes) {
+            QMutexLocker locker(&m_mutex);
+            return MemoryBudget::trim(m_images, bytes);
+        });
+    m_timer.setSingleShot(true);
+    m_timer.setInterval(kScheduleDelayMs);
+    connect(&m_timer, &QTimer::timeout, this, qOverload<>(&TitleCache::apply));
+}
+
+TitleCache &TitleCache::singleton()
+{
+    static TitleCache instance;
+    return instance;
+}
+
+bool TitleCache::isStatic(Mlt::Filter &filter)
+{
+    if (filter.get_int("typewriter"))
+        return false;
+    if (filter.time_to_frames(filter.get(kShotcutAnimInProperty)) > 0
+        || filter.time_to_frames(filter.get(kShotcutAnimOutProperty)) > 0)
+        return false;
+    // Keywords such as #timecode# change with the frame.
+    if (!qstrcmp(filter.get("mlt_service"), "dynamictext")
+        && QString::fromUtf8(filter.get("argument")).contains('#'))
+        return false;
+    const double fps = MLT.profile().fps();
+    for (auto name : kKeyframeProperties) {
+        const char *value = filter.get(name);
+        // Only the animation strings have keyframe positions.
+        if (value && std::strchr(value, '=') && keyCount(value, fps) > 1)
+            return false;
+    }
+    return true;
+}
+
+void TitleCache::schedule()
+{
+    m_timer.start();
+}
+
+void TitleCache::apply()
+{
+    if (MLT.producer() && MLT.producer()->is_valid())
+        apply(*MLT.producer());
+    auto multitrack = MAIN.multitrack();
+    if (multitrack && multitrack->is_valid()
+        && (!MLT.producer() || multitrack->get_producer() != MLT.producer()->get_producer()))
+        apply(*multitrack);
+}
+
+void TitleCache::apply(Mlt::Producer &producer)
+{
+    TextFilterParser parser;
+    parser.start(producer);
+    const auto size = QByteArray::number(MLT.profile().width()) + 'x'
+                      + QByteArray::number(MLT.profile().height());
+
+    for (auto &filter : parser.filters()) {
+        auto title = titleOf(filter.get_filter());
+        if (!title) {
+            title = new Title;
+            title->process = filter.get_filter()->process;
+            filter.set(kTitleCacheProperty, title, 0, closeTitle);
+            delete filter.listen("property-changed", title, (mlt_listener) onPropertyChanged);
+            filter.get_filter()->process = cachedProcess;
+        }
+        if (!isStatic(filter)) {
+            title->isReady = false;
+            continue;
+        }
+
+        auto properties = snapshot(filter);
+        QStringList names;
+        for (int i = 0; i < properties.count(); ++i)
+            names << QString::fromUtf8(properties.get_name(i));
+        names.sort();
+        QCryptographicHash hash(QCryptographicHash::Sha1);
+        hash.addData(QByteArray(filter.get("mlt_service")));
+        hash.addData(size);
+        for (const auto &name : names) {
+            hash.addData(name.toUtf8());
+            hash.addData(QByteArray(properties.get(qUtf8Printable(name))));
+        }
+        const auto key = hash.result();
+        if (title->isReady && title->key == key)
+            continue;
+
+        QImage image;
+        {
+            QMutexLocker locker(&m_mutex);
+            if (auto cached = m_images.object(key))
+                image = *cached;
+        }
+        {
+            QMutexLocker locker(&title->mutex);
+            title->key = key;
+            title->image = image;
+        }
+        title->isReady = !image.isNull();
+        if (title->isReady)
+            continue;
+        auto &waiting = m_waiting[key];
+        waiting << filter;
+        if (waiting.size() == 1) {
+            properties.set("mlt_service", filter.get("mlt_service"));
+            render(properties, key);
+        }
+    }
+}
+
+void TitleCache::render(Mlt::Properties &properties, const QByteArray &key)
+{
+    QThreadPool::globalInstance()->start([=]() {
+        Mlt::Properties copy(properties);
+        Mlt::Producer color(MLT.profile(), "color", "#00000000");
+        Mlt::Filter text(MLT.profile(), copy.get("mlt_service"));
+        QImage image;
+        if (color.is_valid() && text.is_valid()) {
+            text.inherit(copy);
+            color.attach(text);
+            std::unique_ptr<Mlt::Frame> frame(color.get_frame());
+            mlt_image_format format = mlt_image_rgba;
+            int width = MLT.profile().width();
+            int height = MLT.profile().height();
+            auto data = frame ? frame->get_image(format, width, height) : nullptr;
+            if (data && format == mlt_image_rgba) {
+                image = QImage(data, width, height, QImage::Format_RGBA8888)
+                            .convertToFormat(QImage::Format_RGBA8888_Premultiplied);
+            }
+        }
+        if (image.isNull())
+            LOG_WARNING() << "failed to render title" << copy.get("mlt_service");
+        QMetaObject::invokeMethod(
+            this, [=]() { onRendered(key, image); }, Qt::QueuedConnection);
+    });
+}
+
+void TitleCache::onRendered(const QByteArray &key, const QImage &image)
+{
+    const auto filters = m_waiting.take(key);
+    if (image.isNull())
+        return;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_images.insert(key, new QImage(image), qMax(1, int(image.sizeInBytes() / 1024)));
+    }
+    for (auto filter : filters) {
+        auto title = titleOf(filter.get_filter());
+        if (!title)
+            continue;
+        QMutexLocker locker(&title->mutex);
+        // The title changed while it was rendering.
+        if (title->key != key)
+            continue;
+        title->image = image;
+        title->isReady = true;
+    }
+}
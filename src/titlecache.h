@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TITLECACHE_H
+#define TITLECACHE_H
+
+#include <MltFilter.h>
+#include <QByteArray>
+#include <QCache>
+#include <QHash>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QTimer>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class TitleCache
+  \brief Draws the text filters that do not change from a rendered image.
+
+  MLT lays out and paints the text of the qtext and dynamictext filters on
+  every frame, even when the title is the same for the whole clip. A title is
+  static when it has no animation in or out, no keyframes in the parameters
+  that the filter UI animates, no typewriter effect and no keywords to
+  expand. Such a title is rendered once onto a transparent frame of the
+  profile into a premultiplied image, keyed by a hash of its properties and
+  the profile, so that identical titles share one image.
+
+  While the image is ready, the filter composites the image instead of
+  running its own process function. Changing a property of the filter puts
+  the original function back at once, and the title is looked at again when
+  the edits settle. Nothing of this is saved with the project.
+*/
+
+class TitleCache : public QObject
+{
+    Q_OBJECT
+
+public:
+    static TitleCache &singleton();
+    //! Returns whether the text \a filter looks the same on every frame.
+    static bool isStatic(Mlt::Filter &filter);
+
+public slots:
+    //! Looks for the static titles of the player again after a short delay.
+    void schedule();
+
+private slots:
+    void apply();
+
+private:
+    explicit TitleCache(QObject *parent = nullptr);
+    void apply(Mlt::Producer &producer);
+    void render(Mlt::Properties &properties, const QByteArray &key);
+    void onRendered(const QByteArray &key, const QImage &image);
+
+    QTimer m_timer;
+    QMutex m_mutex;
+    QCache<QByteArray, QImage> m_images; ///< Costs in KiB
+    QHash<QByteArray, QList<Mlt::Filter>> m_waiting;
+};
+
+#endif // TITLECACHE_H
@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "trackprefetcher.h"
+
+#include "Logger.h"
+#include "settings.h"
+#include "shotcut_mlt_properties.h"
+
+#include <Mlt.h>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <utility>
+
+static const char *kTrackPrefetchProperty = "_shotcut:trackPrefetch";
+static std::atomic<int> prefetchFormat{mlt_image_rgba};
+static std::atomic<int> prefetchWidth{0};
+static std::atomic<int> prefetchHeight{0};
+
+namespace {
+
+struct Prefetch
+{
+    mlt_frame worker{nullptr};
+    QSemaphore done;
+    int error{1};
+    uint8_t *image{nullptr};
+    mlt_image_format format{mlt_image_none};
+    int width{0};
+    int height{0};
+};
+
+} // namespace
+
+static QThreadPool &pool()
+{
+    // The pool is never deleted because the frames may outlive the app.
+    static auto instance = new QThreadPool;
+    return *instance;
+}
+
+// The worker frame borrows the data of the track frame, which it must outlive.
+static void shareProperties(mlt_properties dst, mlt_properties src)
+{
+    const int n = mlt_properties_count(src);
+    for (int i = 0; i < n; ++i) {
+        const char *name = mlt_properties_get_name(src, i);
+        int size = 0;
+        void *data = mlt_properties_get_data_at(src, i, &size);
+        if (data)
+            mlt_properties_set_data(dst, name, data, size, nullptr, nullptr);
+        else
+            mlt_properties_set(dst, name, mlt_properties_get_value(src, i));
+    }
+}
+
+// Copies what rendering set on the worker frame, such as the metadata and the
+// scan mode, but not the consumer properties that may be newer on the track frame.
+static void copyResults(mlt_properties dst, mlt_properties src)
+{
+    const int n = mlt_properties_count(src);
+    for (int i = 0; i < n; ++i) {
+        const char *name = mlt_properties_get_name(src, i);
+        const char *value = mlt_properties_get_value(src, i);
+        if (name && value && std::strncmp(name, "consumer.", 9))
+            mlt_properties_set(dst, name, value);
+    }
+}
+
+static void closePrefetch(void *data)
+{
+    auto prefetch = static_cast<Prefetch *>(data);
+    // A frame can be dropped without its image, so wait for the worker.
+    prefetch->done.acquire();
+    mlt_frame_close(prefetch->worker);
+    delete prefetch;
+}
+
+static int getImage(mlt_frame frame,
+                    uint8_t **image,
+                    mlt_image_format *format,
+                    int *width,
+                    int *height,
+                    int /* writable */)
+{
+    auto prefetch = static_cast<Prefetch *>(mlt_frame_pop_service(frame));
+    prefetch->done.acquire();
+    prefetch->done.release();
+    if (prefetch->error)
+        return prefetch->error;
+
+    // The worker frame keeps owning the image and the alpha.
+    copyResults(MLT_FRAME_PROPERTIES(frame), MLT_FRAME_PROPERTIES(prefetch->worker));
+    mlt_frame_set_image(frame, prefetch->image, 0, nullptr);
+    int alphaSize = 0;
+    if (auto alpha = mlt_frame_get_alpha_size(prefetch->worker, &alphaSize))
+        mlt_frame_set_alpha(frame, alpha, alphaSize, nullptr);
+    *image = prefetch->image;
+    *format = prefetch->format;
+    *width = prefetch->width;
+    *height = prefetch->height;
+    return 0;
+}
+
+static mlt_frame process(mlt_filter filter, mlt_frame frame)
+{
+    // Blanks are not composited.
+    if (mlt_frame_is_test_card(frame))
+        return frame;
+    auto properties = MLT_FILTER_PROPERTIES(filter);
+    auto producer = mlt_frame_get_original_producer(frame);
+    auto prefetch = new Prefetch;
+    prefetch->format = mlt_image_format(mlt_properties_get_int(properties, "_format"));
+    prefetch->width = mlt_properties_get_int(properties, "_width");
+    prefetch->height = mlt_properties_get_int(properties, "_height");
+    prefetch->worker = mlt_frame_init(producer ? MLT_PRODUCER_SERVICE(producer)
+                                               : MLT_FILTER_SERVICE(filter));
+    auto worker = prefetch->worker;
+
+    // Move the image operations of the track to the worker frame and leave
+    // only the wait for its image. The audio stays on the track frame.
+    shareProperties(MLT_FRAME_PROPERTIES(worker), MLT_FRAME_PROPERTIES(frame));
+    worker->convert_image = frame->convert_image;
+    std::swap(frame->stack_image, worker->stack_image);
+    std::swap(frame->stack_service, worker->stack_service);
+    mlt_properties_set_data(MLT_FRAME_PROPERTIES(frame),
+                            kTrackPrefetchProperty,
+                            prefetch,
+                            0,
+                            closePrefetch,
+                            nullptr);
+    mlt_frame_push_service(frame, prefetch);
+    mlt_frame_push_get_image(frame, getImage);
+
+    // The worker holds a reference so that the data it borrows stays.
+    mlt_properties_inc_ref(MLT_FRAME_PROPERTIES(frame));
+    pool().start([=]() {
+        prefetch->error = mlt_frame_get_image(worker,
+                                              &prefetch->image,
+                                              &prefetch->format,
+                                              &prefetch->width,
+                                              &prefetch->height,
+                                              0);
+        prefetch->done.release();
+        mlt_frame_close(frame);
+    });
+    return frame;
+}
+
+void TrackPrefetcher::configure(Mlt::Producer &producer,
+                                mlt_image_format format,
+                                int width,
+                                int height)
+{
+    prefetchFormat = format;
+    prefetchWidth = width;
+    prefetchHeight = height;
+    attach(producer);
+}
+
+void TrackPrefetcher::attach(Mlt::Producer &producer)
+{
+    if (!producer.is_valid() || producer.type() != mlt_service_tractor_type)
+        return;
+    const int threads = Settings.playerTrackThreads();
+    const bool isEnabled = threads > 1 && !Settings.playerGPU();
+    if (isEnabled && pool().maxThreadCount() != threads) {
+        LOG_INFO() << "track rendering threads" << threads;
+        pool().setMaxThreadCount(threads);
+    }
+
+    Mlt::Tractor tractor(producer);
+    for (int i = 0; i < tractor.count(); ++i) {
+        std::unique_ptr<Mlt::Producer> track(tractor.track(i));
+        if (!track || !track->is_valid() || !track->get_int(kVideoTrackProperty))
+            continue;
+        std::unique_ptr<Mlt::Filter> filter;
+        for (int j = 0; j < track->filter_count() && !filter; ++j) {
+            filter.reset(track->filter(j));
+            if (filter && !filter->get_int(kTrackPrefetchProperty))
+                filter.reset();
+        }
+        if (!isEnabled) {
+            if (filter)
+                track->detach(*filter);
+            continue;
+        }
+        if (!filter) {
+            auto mltFilter = mlt_filter_new();
+            if (!mltFilter)
+                continue;
+            mltFilter->process = process;
+            filter.reset(new Mlt::Filter(mltFilter));
+            mlt_filter_close(mltFilter);
+            // The XML consumer and the filter models skip the loader filters.
+            filter->set("_loader", 1);
+            filter->set(kShotcutHiddenProperty, 1);
+            filter->set(kTrackPrefetchProperty, 1);
+            track->attach(*filter);
+            // First, so that the hidden filters stay ahead of the track filters.
+            track->move_filter(track->filter_count() - 1, 0);
+        }
+        filter->set("_format", prefetchFormat.load());
+        filter->set("_width", prefetchWidth.load());
+        filter->set("_height", prefetchHeight.load());
+    }
+}
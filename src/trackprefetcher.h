@@ -0,0 +1,64 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef TRACKPREFETCHER_H
+#define TRACKPREFETCHER_H
+
+#include <MltProperties.h>
+
+namespace Mlt {
+class Producer;
+}
+
+/*!
+  \class TrackPrefetcher
+  \brief Renders the frames of the video tracks of the timeline in parallel.
+
+  \threadsafe
+
+  The tractor pulls the frame of each track in turn and renders its image
+  when the transitions composite it, so all of the tracks of one frame render
+  on one thread. The rendering threads of the consumer only work on whole
+  frames, and in GPU mode there is only one.
+
+  For each video track this attaches a hidden filter that moves the image
+  operations of the track frame onto a frame of its own and renders it on a
+  worker thread as soon as the frame is pulled. The compositing waits for the
+  image of the worker instead of rendering it. The images are rendered in the
+  format and at the size that the compositing asks for when known. Track
+  filters added after the prefetch filter still run while compositing.
+
+  GPU mode is left alone because its images must be rendered on the thread
+  of its OpenGL context.
+*/
+
+class TrackPrefetcher
+{
+public:
+    /*!
+      Sets the format and size of the images for the tracks of \a producer and
+      attaches or removes the filters for the count of threads in Settings.
+    */
+    static void configure(Mlt::Producer &producer, mlt_image_format format, int width, int height);
+    //! Attaches or removes the filters on the tracks of the tractor \a producer.
+    static void attach(Mlt::Producer &producer);
+
+private:
+    TrackPrefetcher() {}
+};
+
+#endif // TRACKPREFETCHER_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2024 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -29,6 +29,202 @@
 
 static const auto kHandleSeconds = 15.0;
 
+//! Returns the hardware H.264 encoder to use for the lossy format or an empty string.
+static QString hardwareCodec()
+{
+    if (!Settings.encodeUseHardware())
+        return QString();
+    // VA-API is left out because it needs the frames uploaded by the filter graph.
+    const auto hwCodecs = Settings.encodeHardware();
+    for (const auto &codec : {"h264_nvenc", "h264_qsv", "h264_amf", "h264_videotoolbox"}) {
+        if (hwCodecs.contains(codec))
+            return codec;
+    }
+    return QString();
+}
+
+//! Returns the codec FFmpeg reports for the video that \a dialog encodes.
+static QString targetVideoCodec(TranscodeDialog &dialog, bool progressive)
+{
+    switch (dialog.format()) {
+    case 1:
+        return (dialog.deinterlace() || progressive) ? "dnxhd" : "prores";
+    case 2:
+        return "utvideo";
+    default:
+        return QString();
+    }
+}
+
+/*!
+  Returns whether the video of a sub-clip can be copied instead of encoded.
+
+  That is when the source already has the intra-only codec of the target
+  and no filter changes the picture. Every frame of those codecs is a
+  keyframe, so the copy is cut exactly at the trim points.
+*/
+static bool canCopyVideo(Mlt::Producer *producer, TranscodeDialog &dialog, bool progressive)
+{
+    if (!dialog.isSubClip() || dialog.deinterlace() || dialog.fpsOverride()
+        || dialog.get709Convert())
+        return false;
+    const auto target = targetVideoCodec(dialog, progressive);
+    if (target.isEmpty())
+        return false;
+    const auto key = QStringLiteral("meta.media.%1.codec.name").arg(producer->get_int("video_index"));
+    return target == QString::fromLatin1(producer->get(key.toLatin1().constData()));
+}
+
+static void appendVideoArgs(Mlt::Producer *producer,
+                            TranscodeDialog &dialog,
+                            bool progressive,
+                            const QString &hwCodec,
+                            QStringList &args)
+{
+    // Set video filters
+    args << "-vf";
+    QString filterString;
+    if (dialog.deinterlace()) {
+        QString deinterlaceFilter = QStringLiteral("bwdif,");
+        filterString = filterString + deinterlaceFilter;
+    }
+
+    QString color_range;
+    if (producer->get("color_range")) {
+        if (producer->get_int("color_range") == 2) {
+            color_range = "full";
+        } else {
+            color_range = "mpeg";
+        }
+    } else if (producer->get("force_full_range")) {
+        if (producer->get_int("force_full_range")) {
+            color_range = "full";
+        } else {
+            color_range = "mpeg";
+        }
+    } else {
+        color_range = producer->get("meta.media.color_range");
+    }
+    if (color_range != "full" && color_range != "mpeg") {
+        color_range = "mpeg";
+    }
+
+    if (dialog.get709Convert()) {
+        QString convertFilter = QStringLiteral(
+            "zscale=t=linear:npl=100,format=gbrpf32le,zscale=p=bt709,tonemap=tonemap=hable:desat=0,"
+            "zscale=t=bt709:m=bt709:r=tv,format=yuv422p,");
+        filterString = filterString + convertFilter;
+    }
+    filterString
+        = filterString
+          + QStringLiteral(
+                "scale=flags=accurate_rnd+full_chroma_inp+full_chroma_int:in_range=%1:out_range=%2")
+                .arg(color_range)
+                .arg(color_range);
+    auto fps = dialog.fpsOverride() ? dialog.fps() : Util::getSuggestedFrameRate(producer);
+    auto fpsStr = QStringLiteral("%1").arg(fps, 0, 'f', 6);
+    int numerator, denominator;
+    Util::normalizeFrameRate(fps, numerator, denominator);
+    if (denominator == 1001) {
+        fpsStr = QStringLiteral("%1/%2").arg(numerator).arg(denominator);
+    }
+    QString minterpFilter
+        = QStringLiteral(",minterpolate='mi_mode=%1:mc_mode=aobmc:me_mode=bidir:vsbmc=1:fps=%2'")
+              .arg(dialog.frc(), fpsStr);
+    filterString = filterString + minterpFilter;
+    args << filterString;
+
+    // Specify color range
+    if (color_range == "full") {
+        args << "-color_range"
+             << "2";
+    } else {
+        args << "-color_range"
+             << "1";
+    }
+
+    if (!dialog.deinterlace() && !progressive) {
+        int tff = producer->get_int("meta.media.top_field_first") || producer->get_int("force_tff");
+        args << "-flags"
+             << "+ildct+ilme"
+             << "-top" << QString::number(tff);
+    }
+
+    switch (dialog.format()) {
+    case 0:
+        if (hwCodec.isEmpty()) {
+            args << "-codec:v"
+                 << "libx264";
+            args << "-preset"
+                 << "medium"
+                 << "-g"
+                 << "1"
+                 << "-crf"
+                 << "15";
+            break;
+        }
+        args << "-codec:v" << hwCodec << "-g"
+             << "1"
+             << "-pix_fmt"
+             << "nv12";
+        if (hwCodec.endsWith("_nvenc")) {
+            args << "-preset"
+                 << "p4"
+                 << "-rc"
+                 << "vbr"
+                 << "-cq"
+                 << "15"
+                 << "-b:v"
+                 << "0";
+        } else if (hwCodec.endsWith("_qsv")) {
+            args << "-global_quality"
+                 << "15";
+        } else if (hwCodec.endsWith("_amf")) {
+            args << "-rc"
+                 << "cqp"
+                 << "-qp_i"
+                 << "15";
+        } else if (hwCodec.endsWith("_videotoolbox")) {
+            args << "-q:v"
+                 << "85";
+        }
+        break;
+    case 1:
+        if (dialog.deinterlace() || progressive) {
+            args << "-codec:v"
+                 << "dnxhd"
+                 << "-profile:v"
+                 << "dnxhr_hq"
+                 << "-pix_fmt"
+                 << "yuv422p";
+        } else { // interlaced
+            args << "-codec:v"
+                 << "prores_ks"
+                 << "-profile:v"
+                 << "standard";
+        }
+        break;
+    case 2:
+        args << "-codec:v"
+             << "utvideo";
+        args << "-pix_fmt"
+             << "yuv422p";
+        break;
+    }
+    if (dialog.get709Convert()) {
+        args << "-colorspace"
+             << "bt709"
+             << "-color_primaries"
+             << "bt709"
+             << "-color_trc"
+             << "bt709";
+    } else if (dialog.format() == 2 && producer->get_int("meta.media.colorspace") == 709) {
+        // Work around a limitation that FFMpeg does not pass colorspace for utvideo
+        args << "-colorspace"
+             << "bt709";
+    }
+}
+
 void Transcoder::setProducers(QList<Mlt::Producer> &producers)
 {
     m_producers = producers;
@@ -217,75 +413,15 @@ void Transcoder::convertProducer(Mlt::Producer *producer, TranscodeDialog &dialo
         args << "-ar" << dialog.sampleRate();
     }
 
-    // Set video filters
-    args << "-vf";
-    QString filterString;
-    if (dialog.deinterlace()) {
-        QString deinterlaceFilter = QStringLiteral("bwdif,");
-        filterString = filterString + deinterlaceFilter;
-    }
-
-    QString color_range;
-    if (producer->get("color_range")) {
-        if (producer->get_int("color_range") == 2) {
-            color_range = "full";
-        } else {
-            color_range = "mpeg";
-        }
-    } else if (producer->get("force_full_range")) {
-        if (producer->get_int("force_full_range")) {
-            color_range = "full";
-        } else {
-            color_range = "mpeg";
-        }
-    } else {
-        color_range = producer->get("meta.media.color_range");
-    }
-    if (color_range != "full" && color_range != "mpeg") {
-        color_range = "mpeg";
-    }
-
-    if (dialog.get709Convert()) {
-        QString convertFilter = QStringLiteral(
-            "zscale=t=linear:npl=100,format=gbrpf32le,zscale=p=bt709,tonemap=tonemap=hable:desat=0,"
-            "zscale=t=bt709:m=bt709:r=tv,format=yuv422p,");
-        filterString = filterString + convertFilter;
-    }
-    filterString
-        = filterString
-          + QStringLiteral(
-                "scale=flags=accurate_rnd+full_chroma_inp+full_chroma_int:in_range=%1:out_range=%2")
-                .arg(color_range)
-                .arg(color_range);
-    auto fps = dialog.fpsOverride() ? dialog.fps() : Util::getSuggestedFrameRate(producer);
-    auto fpsStr = QStringLiteral("%1").arg(fps, 0, 'f', 6);
-    int numerator, denominator;
-    Util::normalizeFrameRate(fps, numerator, denominator);
-    if (denominator == 1001) {
-        fpsStr = QStringLiteral("%1/%2").arg(numerator).arg(denominator);
-    }
-    QString minterpFilter
-        = QStringLiteral(",minterpolate='mi_mode=%1:mc_mode=aobmc:me_mode=bidir:vsbmc=1:fps=%2'")
-              .arg(dialog.frc(), fpsStr);
-    filterString = filterString + minterpFilter;
-    args << filterString;
-
-    // Specify color range
-    if (color_range == "full") {
-        args << "-color_range"
-             << "2";
-    } else {
-        args << "-color_range"
-             << "1";
-    }
-
     int progressive = producer->get_int("meta.media.progressive")
                       || producer->get_int("force_progressive");
-    if (!dialog.deinterlace() && !progressive) {
-        int tff = producer->get_int("meta.media.top_field_first") || producer->get_int("force_tff");
-        args << "-flags"
-             << "+ildct+ilme"
-             << "-top" << QString::number(tff);
+    const auto copyVideo = canCopyVideo(producer, dialog, progressive);
+    const auto hwCodec = dialog.format() == 0 ? hardwareCodec() : QString();
+    if (copyVideo) {
+        args << "-codec:v"
+             << "copy";
+    } else {
+        appendVideoArgs(producer, dialog, progressive, hwCodec, args);
     }
 
     switch (dialog.format()) {
@@ -295,58 +431,21 @@ void Transcoder::convertProducer(Mlt::Producer *producer, TranscodeDialog &dialo
              << "-codec:a"
              << "ac3"
              << "-b:a"
-             << "512k"
-             << "-codec:v"
-             << "libx264";
-        args << "-preset"
-             << "medium"
-             << "-g"
-             << "1"
-             << "-crf"
-             << "15";
+             << "512k";
         break;
     case 1:
         args << "-f"
              << "mov"
              << "-codec:a"
              << "pcm_f32le";
-        if (dialog.deinterlace() || progressive) {
-            args << "-codec:v"
-                 << "dnxhd"
-                 << "-profile:v"
-                 << "dnxhr_hq"
-                 << "-pix_fmt"
-                 << "yuv422p";
-        } else { // interlaced
-            args << "-codec:v"
-                 << "prores_ks"
-                 << "-profile:v"
-                 << "standard";
-        }
         break;
     case 2:
         args << "-f"
              << "matroska"
              << "-codec:a"
-             << "pcm_f32le"
-             << "-codec:v"
-             << "utvideo";
-        args << "-pix_fmt"
-             << "yuv422p";
+             << "pcm_f32le";
         break;
     }
-    if (dialog.get709Convert()) {
-        args << "-colorspace"
-             << "bt709"
-             << "-color_primaries"
-             << "bt709"
-             << "-color_trc"
-             << "bt709";
-    } else if (dialog.format() == 2 && producer->get_int("meta.media.colorspace") == 709) {
-        // Work around a limitation that FFMpeg does not pass colorspace for utvideo
-        args << "-colorspace"
-             << "bt709";
-    }
 
     args << "-y" << filename;
     producer->Mlt::Properties::clear(kOriginalResourceProperty);
@@ -354,6 +453,10 @@ void Transcoder::convertProducer(Mlt::Producer *producer, TranscodeDialog &dialo
     FfmpegJob *job = new FfmpegJob(filename, args, false);
     job->setLabel(tr("Convert %1").arg(Util::baseName(filename)));
     job->setTarget(filename);
+    if (copyVideo)
+        job->setResourceClass(AbstractJob::DiskResource);
+    else if (!hwCodec.isEmpty())
+        job->setResourceClass(AbstractJob::GpuEncodeResource);
     if (dialog.isSubClip()) {
         if (producer->get(kMultitrackItemProperty)) {
             QString s = QString::fromLatin1(producer->get(kMultitrackItemProperty));
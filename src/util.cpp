@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -38,9 +38,11 @@
 #include <QDir>
 #include <QDoubleSpinBox>
 #include <QFileInfo>
+#include <QHash>
 #include <QMap>
 #include <QMediaDevices>
 #include <QMessageBox>
+#include <QMutex>
 #include <QProcess>
 #include <QProcessEnvironment>
 #include <QRegularExpression>
@@ -57,6 +59,8 @@
 
 #ifdef Q_OS_WIN
 #include <windows.h>
+#else
+#include <sys/stat.h>
 #endif
 
 #ifdef Q_OS_MAC
@@ -65,6 +69,7 @@ static const unsigned int kLowMemoryThresholdPercent = 10U;
 static const unsigned int kLowMemoryThresholdKB = 256U * 1024U;
 #endif
 static const qint64 kFreeSpaceThesholdGB = 25LL * 1024 * 1024 * 1024;
+static const char *kFileHashesFileName = "filehashes.txt";
 
 QString Util::baseName(const QString &filePath, bool trimQuery)
 {
@@ -251,23 +256,6 @@ int Util::coerceMultiple(int value, int multiple)
     return (value + multiple - 1) / multiple * multiple;
 }
 
-QList<QUrl> Util::expandDirectories(const QList<QUrl> &urls)
-{
-    QList<QUrl> result;
-    foreach (QUrl url, urls) {
-        QString path = Util::removeFileScheme(url, false);
-        QFileInfo fi(path);
-        if (fi.isDir()) {
-            QDir dir(path);
-            foreach (QFileInfo fi, dir.entryInfoList(QDir::Files | QDir::Readable, QDir::Name))
-                result << fi.filePath();
-        } else {
-            result << url;
-        }
-    }
-    return result;
-}
-
 bool Util::isDecimalPoint(QChar ch)
 {
     // See https://en.wikipedia.org/wiki/Decimal_separator#Unicode_characters
@@ -420,10 +408,112 @@ void Util::applyCustomProperties(Mlt::Producer &destination, Mlt::Producer &sour
     destination.set_in_and_out(in, out);
 }
 
+namespace {
+
+// The file hashes already computed, keyed by the size, modification time,
+// inode, and path of the file, and kept in a file in the app data folder, so
+// that reopening a project does not read its media again to hash them.
+class FileHashCache
+{
+public:
+    static FileHashCache &singleton()
+    {
+        static FileHashCache instance;
+        return instance;
+    }
+
+    static QString key(const QFileInfo &info)
+    {
+        qint64 inode = 0;
+#ifndef Q_OS_WIN
+        struct stat st;
+        if (!::stat(QFile::encodeName(info.absoluteFilePath()).constData(), &st))
+            inode = st.st_ino;
+#endif
+        return QStringLiteral("%1 %2 %3 %4")
+            .arg(info.size())
+            .arg(info.lastModified().toMSecsSinceEpoch())
+            .arg(inode)
+            .arg(info.absoluteFilePath());
+    }
+
+    QString hash(const QString &key)
+    {
+        QMutexLocker locker(&m_mutex);
+        load();
+        return m_hashes.value(key);
+    }
+
+    void insert(const QString &key, const QString &hash)
+    {
+        if (key.contains('\n'))
+            return;
+        QMutexLocker locker(&m_mutex);
+        load();
+        m_hashes.insert(key, hash);
+        if (m_file.isOpen()) {
+            m_file.write(QStringLiteral("%1 %2\n").arg(hash, key).toUtf8());
+            m_file.flush();
+        }
+    }
+
+private:
+    void load()
+    {
+        if (m_isLoaded)
+            return;
+        m_isLoaded = true;
+        const QDir dir(Settings.appDataLocation());
+        m_file.setFileName(dir.filePath(kFileHashesFileName));
+        int lineCount = 0;
+        if (m_file.open(QIODevice::ReadOnly)) {
+            while (!m_file.atEnd()) {
+                const auto line = QString::fromUtf8(m_file.readLine());
+                const auto space = line.indexOf(' ');
+                if (space > 0 && line.endsWith('\n'))
+                    m_hashes.insert(line.mid(space + 1).chopped(1), line.left(space));
+                ++lineCount;
+            }
+            m_file.close();
+        }
+        // Rewrite the file when most of its lines repeat a key.
+        if (lineCount > 2 * m_hashes.size() + 1000) {
+            if (m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+                for (auto it = m_hashes.constBegin(); it != m_hashes.constEnd(); ++it)
+                    m_file.write(QStringLiteral("%1 %2\n").arg(it.value(), it.key()).toUtf8());
+                m_file.close();
+            }
+        }
+        if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append))
+            LOG_WARNING() << "failed to open" << m_file.fileName();
+    }
+
+    QMutex m_mutex;
+    QHash<QString, QString> m_hashes;
+    QFile m_file;
+    bool m_isLoaded{false};
+};
+
+} // namespace
+
+QString Util::fileFingerprint(const QString &path)
+{
+    const QFileInfo info(removeQueryString(path));
+    return info.isFile() ? FileHashCache::key(info) : QString();
+}
+
 QString Util::getFileHash(const QString &path)
 {
+    const QFileInfo info(removeQueryString(path));
+    if (!info.isFile())
+        return QString();
+    const auto key = FileHashCache::key(info);
+    auto hash = FileHashCache::singleton().hash(key);
+    if (!hash.isEmpty())
+        return hash;
+
     // This routine is intentionally copied from Kdenlive.
-    QFile file(removeQueryString(path));
+    QFile file(info.filePath());
     if (file.open(QIODevice::ReadOnly)) {
         QByteArray fileData;
         // 1 MB = 1 second per 450 files (or faster)
@@ -436,9 +526,10 @@ QString Util::getFileHash(const QString &path)
             fileData = file.readAll();
         }
         file.close();
-        return QCryptographicHash::hash(fileData, QCryptographicHash::Md5).toHex();
+        hash = QCryptographicHash::hash(fileData, QCryptographicHash::Md5).toHex();
+        FileHashCache::singleton().insert(key, hash);
     }
-    return QString();
+    return hash;
 }
 
 QString Util::getHash(Mlt::Properties &properties)
@@ -555,6 +646,85 @@ bool Util::isMemoryLow()
 #endif
 }
 
+bool Util::isOnBatteryPower()
+{
+#if defined(Q_OS_WIN)
+    SYSTEM_POWER_STATUS status;
+    return GetSystemPowerStatus(&status) && status.ACLineStatus == 0;
+#elif defined(Q_OS_MAC)
+    QProcess p;
+    p.start("pmset", {"-g", "batt"});
+    p.waitForFinished();
+    return p.readAllStandardOutput().contains("'Battery Power'");
+#elif defined(Q_OS_LINUX)
+    bool isDischarging = false;
+    QDir dir("/sys/class/power_supply");
+    for (const auto &name : dir.entryList(QDir::Dirs | QDir::NoDotAndDotDot)) {
+        QFile type(dir.filePath(name + "/type"));
+        if (!type.open(QIODevice::ReadOnly))
+            continue;
+        const auto supplyType = type.readAll().trimmed();
+        if (supplyType == "Mains" || supplyType == "USB") {
+            QFile online(dir.filePath(name + "/online"));
+            if (online.open(QIODevice::ReadOnly) && online.readAll().trimmed() == "1")
+                return false;
+        } else if (supplyType == "Battery") {
+            QFile status(dir.filePath(name + "/status"));
+            if (status.open(QIODevice::ReadOnly) && status.readAll().trimmed() == "Discharging")
+                isDischarging = true;
+        }
+    }
+    return isDischarging;
+#else
+    return false;
+#endif
+}
+
+bool Util::isThermallyThrottled()
+{
+#if defined(Q_OS_MAC)
+    QProcess p;
+    p.start("pmset", {"-g", "therm"});
+    p.waitForFinished();
+    for (const auto &line : p.readAllStandardOutput().split('\n')) {
+        if (line.contains("CPU_Speed_Limit")) {
+            bool ok = false;
+            const auto limit = line.split('=').last().trimmed().toInt(&ok);
+            return ok && limit < 100;
+        }
+    }
+    return false;
+#elif defined(Q_OS_LINUX)
+    // A zone is hot once it reaches a trip point where the kernel throttles.
+    QDir dir("/sys/class/thermal");
+    for (const auto &name : dir.entryList({"thermal_zone*"}, QDir::Dirs)) {
+        QFile temp(dir.filePath(name + "/temp"));
+        if (!temp.open(QIODevice::ReadOnly))
+            continue;
+        bool ok = false;
+        const auto current = temp.readAll().trimmed().toLongLong(&ok);
+        if (!ok)
+            continue;
+        for (int i = 0;; ++i) {
+            QFile type(dir.filePath(QStringLiteral("%1/trip_point_%2_type").arg(name).arg(i)));
+            if (!type.open(QIODevice::ReadOnly))
+                break;
+            if (type.readAll().trimmed() != "passive")
+                continue;
+            QFile trip(dir.filePath(QStringLiteral("%1/trip_point_%2_temp").arg(name).arg(i)));
+            if (trip.open(QIODevice::ReadOnly)) {
+                const auto limit = trip.readAll().trimmed().toLongLong(&ok);
+                if (ok && limit > 0 && current >= limit)
+                    return true;
+            }
+        }
+    }
+    return false;
+#else
+    return false;
+#endif
+}
+
 QString Util::removeQueryString(const QString &s)
 {
     auto i = s.lastIndexOf("\\?");
@@ -717,6 +887,18 @@ void Util::passProducerProperties(Mlt::Producer *src, Mlt::Producer *dst)
         dst->set(kShotcutProducerProperty, "avformat");
 }
 
+bool Util::isNetworkStorage(const QString &path)
+{
+    if (path.startsWith("//") || path.startsWith("\\\\"))
+        return true;
+    const auto type = QString::fromLatin1(QStorageInfo(path).fileSystemType()).toLower();
+    for (const auto &name : {"nfs", "cifs", "smb", "afp", "sshfs", "webdav", "9p"}) {
+        if (type.contains(QLatin1String(name)))
+            return true;
+    }
+    return false;
+}
+
 bool Util::warnIfLowDiskSpace(const QString &path)
 {
     // Check if the drive this file will be on is getting low on space.
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2014-2025 Meltytech, LLC
+ * Copyright (c) 2014-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -49,7 +49,6 @@ public:
     static QString removeFileScheme(QUrl &url, bool fromPercentEncoding = true);
     static const QStringList sortedFileList(const QList<QUrl> &urls);
     static int coerceMultiple(int value, int multiple = 2);
-    static QList<QUrl> expandDirectories(const QList<QUrl> &urls);
     static bool isDecimalPoint(QChar ch);
     static bool isNumeric(QString &str);
     static bool convertNumericString(QString &str, QChar decimalPoint);
@@ -65,11 +64,16 @@ public:
                                       int in,
                                       int out);
     static QString getFileHash(const QString &path);
+    //! Returns what tells a file from its other versions without reading it, or empty if none.
+    static QString fileFingerprint(const QString &path);
     static QString getHash(Mlt::Properties &properties);
     static bool hasDriveLetter(const QString &path);
     static QColorDialog::ColorDialogOptions getColorDialogOptions();
     static QFileDialog::Options getFileDialogOptions();
     static bool isMemoryLow();
+    static bool isOnBatteryPower();
+    //! Returns whether the system is slowing the CPU to keep it from overheating.
+    static bool isThermallyThrottled();
     static QString removeQueryString(const QString &s);
     static int greatestCommonDivisor(int m, int n);
     static void normalizeFrameRate(double fps, int &numerator, int &denominator);
@@ -81,6 +85,8 @@ public:
     static QString updateCaption(Mlt::Producer *producer);
     static void passProducerProperties(Mlt::Producer *src, Mlt::Producer *dst);
     static bool warnIfLowDiskSpace(const QString &path);
+    //! Returns whether \a path is on a network share, such as SMB or NFS.
+    static bool isNetworkStorage(const QString &path);
     static bool isFpsDifferent(double a, double b);
     static QString getNextFile(const QString &filePath);
     static QString trcString(int trc);
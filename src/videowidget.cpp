@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,22 +18,52 @@
 #include "videowidget.h"
 
 #include "Logger.h"
+#include "ambisonicmonitor.h"
+#include "audiopremix.h"
 #include "dialogs/durationdialog.h"
+#include "filterchainoptimizer.h"
+#include "frametrace.h"
 #include "mainwindow.h"
+#include "memorybudget.h"
 #include "qmltypes/qmlfilter.h"
 #include "qmltypes/qmlutilities.h"
 #include "settings.h"
+#include "trackprefetcher.h"
 
 #include <Mlt.h>
 #include <QOffscreenSurface>
 #include <QOpenGLContext>
 #include <QQuickItem>
 #include <QUrl>
+#include <QtMath>
 #include <QtQml>
 #include <QtWidgets>
 
 using namespace Mlt;
 
+// The value of VideoWidget::m_frameCacheGeneration when a frame was rendered.
+static const char *kFrameCacheGenerationProperty = "_shotcut:frameCacheGeneration";
+// Prefetch only once edits have stopped changing the frames for this long.
+static const int kPrefetchSettleMs = 1000;
+// The number of frames to prefetch for each rendering thread.
+static const int kPrefetchFramesPerThread = 8;
+// The preview scales to lower to, from the highest.
+static const int kAdaptivePreviewScales[] = {720, 540, 360};
+// Playback is slow when this share of the frames is dropped or late.
+static const double kAdaptiveMissedRatio = 0.05;
+static const int kAdaptiveIntervalMs = 1000;
+// The number of slow intervals in a row before lowering the scale.
+static const int kAdaptiveSlowIntervals = 2;
+// A refresh not displayed by then no longer holds back the next one.
+static const int kRefreshInFlightMs = 1000;
+// How often at most to log the dropped frames
+static const int kDroppedFrameLogIntervalMs = 5000;
+// The largest audio device buffer to ask for, in samples
+static const int kMaxAudioBufferSamples = 8192;
+// The range of the field of view of the 360 viewport in degrees.
+static const float kMinViewportFov = 30.0f;
+static const float kMaxViewportFov = 150.0f;
+
 VideoWidget::VideoWidget(QObject *parent)
     : QQuickWidget(QmlUtilities::sharedEngine(), (QWidget *) parent)
     , Controller()
@@ -45,8 +75,17 @@ VideoWidget::VideoWidget(QObject *parent)
     , m_offset(QPoint(0, 0))
     , m_snapToGrid(true)
     , m_scrubAudio(false)
+    , m_isRefreshPending(false)
+    , m_refreshStart(-1)
     , m_maxTextureSize(4096)
     , m_hideVui(false)
+    , m_frameCache(qMax(0, Settings.playerFrameCacheSize()) * 1024)
+    , m_frameCacheGeneration(0)
+    , m_cachedPosition(-1)
+    , m_adaptedPreviewScale(0)
+    , m_slowIntervals(0)
+    , m_adaptivePresented(0)
+    , m_adaptiveMissed(0)
 {
     LOG_DEBUG() << "begin";
     setAttribute(Qt::WA_AcceptTouchEvents);
@@ -57,7 +96,6 @@ VideoWidget::VideoWidget(QObject *parent)
     engine()->addImportPath(importPath.path());
     QmlUtilities::setCommonProperties(rootContext());
     rootContext()->setContextProperty("video", this);
-    m_refreshTimer.setInterval(10);
     m_refreshTimer.setSingleShot(true);
 
     if (Settings.playerGPU())
@@ -72,6 +110,23 @@ VideoWidget::VideoWidget(QObject *parent)
             &VideoWidget::setBlankScene,
             Qt::QueuedConnection);
     connect(&m_refreshTimer, &QTimer::timeout, this, &VideoWidget::onRefreshTimeout);
+    m_prefetchTimer.setInterval(250);
+    m_prefetchTimer.setSingleShot(true);
+    connect(&m_prefetchTimer, &QTimer::timeout, this, &VideoWidget::onPrefetchTimeout);
+    connect(&m_prefetcher,
+            &FramePrefetcher::framePrefetched,
+            this,
+            &VideoWidget::onFramePrefetched,
+            Qt::QueuedConnection);
+    m_frameCacheAge.start();
+    // The frame cache is only used on this thread.
+    m_memoryBudgetId = MEMORY.add(
+        "player frames",
+        MemoryBudget::FramePriority,
+        [this]() { return qint64(m_frameCache.totalCost()) * 1024; },
+        [this](qint64 bytes) { return MemoryBudget::trim(m_frameCache, bytes); });
+    m_adaptiveScaleTimer.setInterval(kAdaptiveIntervalMs);
+    connect(&m_adaptiveScaleTimer, &QTimer::timeout, this, &VideoWidget::onAdaptiveScaleTimeout);
     connect(this, &VideoWidget::rectChanged, this, &VideoWidget::zoomChanged);
     LOG_DEBUG() << "end";
 }
@@ -79,6 +134,9 @@ VideoWidget::VideoWidget(QObject *parent)
 VideoWidget::~VideoWidget()
 {
     LOG_DEBUG() << "begin";
+    MEMORY.remove(m_memoryBudgetId);
+    m_prefetcher.stop();
+    AudioPremix::singleton().stop();
     stop();
     if (m_frameRenderer && m_frameRenderer->isRunning()) {
         m_frameRenderer->quit();
@@ -91,7 +149,9 @@ VideoWidget::~VideoWidget()
 void VideoWidget::initialize()
 {
     LOG_DEBUG() << "begin";
-    m_frameRenderer = new FrameRenderer();
+    m_frameRenderer = new FrameRenderer(Settings.playerFrameQueueDepth());
+    if (screen())
+        m_frameRenderer->setRefreshRate(screen()->refreshRate());
     connect(m_frameRenderer,
             &FrameRenderer::frameDisplayed,
             this,
@@ -151,6 +211,17 @@ void VideoWidget::resizeEvent(QResizeEvent *event)
 
 void VideoWidget::onRefreshTimeout()
 {
+    // Only one refresh is rendered at a time. The edits made meanwhile are
+    // rendered together by the next one once this one is displayed.
+    if (m_refreshInFlight.isValid() && m_refreshInFlight.elapsed() < kRefreshInFlightMs) {
+        m_isRefreshPending = true;
+        m_refreshTimer.start(kRefreshInFlightMs - m_refreshInFlight.elapsed());
+        return;
+    }
+    m_isRefreshPending = false;
+    m_refreshTimer.stop();
+    m_refreshInFlight.start();
+    m_refreshStart = FrameTrace::now();
     Controller::refreshConsumer(m_scrubAudio);
     m_scrubAudio = false;
 }
@@ -160,6 +231,11 @@ void VideoWidget::mousePressEvent(QMouseEvent *event)
     QQuickWidget::mousePressEvent(event);
     if (event->isAccepted())
         return;
+    if (event->button() == Qt::LeftButton && viewport360().isEnabled) {
+        // Dragging turns the view instead of dragging the clip.
+        m_viewportDragPosition = event->pos();
+        return;
+    }
     if (event->button() == Qt::LeftButton)
         m_dragStart = event->pos();
     else if (event->button() == Qt::MiddleButton)
@@ -178,6 +254,17 @@ void VideoWidget::mouseMoveEvent(QMouseEvent *event)
         m_mousePosition = event->pos();
         return;
     }
+    if ((event->buttons() & Qt::LeftButton) && viewport360().isEnabled) {
+        auto viewport = viewport360();
+        const QPoint delta = event->pos() - m_viewportDragPosition;
+        m_viewportDragPosition = event->pos();
+        // Follow the pointer across the field of view.
+        const float degreesPerPixel = viewport.fov / float(qMax(1.0, m_rect.height()));
+        viewport.yaw = std::remainder(viewport.yaw - delta.x() * degreesPerPixel, 360.0f);
+        viewport.pitch = qBound(-90.0f, viewport.pitch + delta.y() * degreesPerPixel, 90.0f);
+        setViewport360(viewport);
+        return;
+    }
     if (event->modifiers() == (Qt::ShiftModifier | Qt::AltModifier) && m_producer) {
         emit seekTo(m_producer->get_length() * event->position().x() / width());
         return;
@@ -210,6 +297,8 @@ void VideoWidget::mouseMoveEvent(QMouseEvent *event)
 
     QDrag *drag = new QDrag(this);
     QMimeData *mimeData = new QMimeData;
+    // Set before serializing so that the XML has the same UUID.
+    mimeData->setData(Mlt::PlayerMimeType, MLT.ensureHasUuid(*m_producer).toByteArray());
     mimeData->setData(Mlt::XmlMimeType, MLT.XML().toUtf8());
     drag->setMimeData(mimeData);
     mimeData->setText(QString::number(MLT.producer()->get_playtime()));
@@ -223,6 +312,21 @@ void VideoWidget::mouseMoveEvent(QMouseEvent *event)
     drag->exec(Qt::CopyAction);
 }
 
+void VideoWidget::wheelEvent(QWheelEvent *event)
+{
+    auto viewport = viewport360();
+    if (!viewport.isEnabled) {
+        QQuickWidget::wheelEvent(event);
+        return;
+    }
+    // Zoom the field of view, 15 degrees per step of the wheel.
+    viewport.fov = qBound(kMinViewportFov,
+                          viewport.fov - event->angleDelta().y() / 8.0f,
+                          kMaxViewportFov);
+    setViewport360(viewport);
+    event->accept();
+}
+
 void VideoWidget::keyPressEvent(QKeyEvent *event)
 {
     QQuickWidget::keyPressEvent(event);
@@ -241,6 +345,11 @@ bool VideoWidget::event(QEvent *event)
 
 int VideoWidget::setProducer(Mlt::Producer *producer, bool isMulti)
 {
+    // Do not keep the media of the previous producer open.
+    m_prefetcher.stop();
+    AudioPremix::singleton().stop();
+    invalidateFrameCache();
+    m_cachedPosition.storeRelaxed(-1);
     int error = Controller::setProducer(producer, isMulti);
 
     if (!error) {
@@ -369,10 +478,23 @@ int VideoWidget::reconfigure(bool isMulti)
         const int processingMode = property("processing_mode").toInt();
         const bool isDeckLinkHLG = serviceName.startsWith("decklink")
                                    && property("decklinkGamma").toInt() == 1;
+        m_isEightBitChain = false;
         switch (processingMode) {
         case ShotcutSettings::Native10Cpu:
         case ShotcutSettings::Linear10Cpu:
-            m_consumer->set("mlt_image_format", "rgba64");
+            // A clip whose last filters work in 8-bit has no precision to keep.
+            if (!serviceName.startsWith("decklink") && isClip()
+                && FilterChainOptimizer::isEightBitOutput(*m_producer)) {
+                m_isEightBitChain = true;
+                m_consumer->set("mlt_image_format", "yuv420p");
+                break;
+            }
+            // Keep 10-bit video in its native planes for a display that converts
+            // it, which is a third of the size of rgba64 and skips the conversion.
+            m_consumer->set("mlt_image_format",
+                            !serviceName.startsWith("decklink") && canDisplayYuv420p10()
+                                ? "yuv420p10"
+                                : "rgba64");
             break;
         case ShotcutSettings::Linear10GpuCpu:
             m_consumer->set("mlt_image_format", isDeckLinkHLG ? "yuv444p10" : "rgba64");
@@ -382,6 +504,16 @@ int VideoWidget::reconfigure(bool isMulti)
                             serviceName.startsWith("decklink") ? "yuv422" : "yuv420p");
             break;
         }
+        // The compositing transitions work in RGBA of the depth of the chain.
+        const QString imageFormat = m_consumer->get("mlt_image_format");
+        TrackPrefetcher::configure(*m_producer,
+                                   imageFormat.contains("10") || imageFormat == "rgba64"
+                                       ? mlt_image_rgba64
+                                       : mlt_image_rgba,
+                                   previewProfile().width(),
+                                   previewProfile().height());
+        AudioPremix::attach(*m_producer);
+        configureAmbisonicMonitor();
         m_consumer->set("channels", property("audio_channels").toInt());
         if (property("audio_channels").toInt() == 4) {
             m_consumer->set("channel_layout", "quad");
@@ -417,6 +549,18 @@ int VideoWidget::reconfigure(bool isMulti)
         } else {
             m_consumer->clear("mlt_color_trc");
         }
+        // The audio consumers take their device buffer in samples, which SDL
+        // wants to be a power of two. Zero keeps the default of the consumer.
+        int audioBuffer = 0;
+        if (Settings.playerAudioLatencyMs() > 0) {
+            const int frequency = m_consumer->get_int("frequency") > 0
+                                      ? m_consumer->get_int("frequency")
+                                      : 48000;
+            const int samples = frequency * Settings.playerAudioLatencyMs() / 1000;
+            audioBuffer = 64;
+            while (audioBuffer < samples && audioBuffer < kMaxAudioBufferSamples)
+                audioBuffer *= 2;
+        }
         if (isMulti) {
             m_consumer->set("terminate_on_pause", 0);
             m_consumer->set("0", serviceName.toLatin1().constData());
@@ -431,6 +575,8 @@ int VideoWidget::reconfigure(bool isMulti)
             if (property("keyer").isValid())
                 m_consumer->set("0.keyer", property("keyer").toInt());
             m_consumer->set("0.video_delay", Settings.playerVideoDelayMs());
+            if (audioBuffer > 0)
+                m_consumer->set("0.audio_buffer", audioBuffer);
         } else {
             if (!profile().progressive())
                 m_consumer->set("progressive", property("progressive").toBool());
@@ -443,6 +589,8 @@ int VideoWidget::reconfigure(bool isMulti)
             if (property("keyer").isValid())
                 m_consumer->set("keyer", property("keyer").toInt());
             m_consumer->set("video_delay", Settings.playerVideoDelayMs());
+            if (audioBuffer > 0)
+                m_consumer->set("audio_buffer", audioBuffer);
         }
         if (m_glslManager) {
             if (!m_threadCreateEvent)
@@ -473,10 +621,277 @@ int VideoWidget::reconfigure(bool isMulti)
 }
 
 void VideoWidget::refreshConsumer(bool scrubAudio)
+{
+    // Seeking refreshes through Controller directly, so this is an edit or a
+    // setting that changes the image.
+    invalidateFrameCache();
+    scheduleRefresh(scrubAudio);
+}
+
+void VideoWidget::scheduleRefresh(bool scrubAudio)
 {
     scrubAudio |= isPaused() ? scrubAudio : Settings.playerScrubAudio();
     m_scrubAudio |= scrubAudio;
-    m_refreshTimer.start();
+    // Coalesce the edits of one display frame, such as while dragging a
+    // slider, into one refresh instead of postponing it until they stop.
+    if (!m_refreshTimer.isActive() && !m_isRefreshPending) {
+        const qreal refreshRate = screen() ? screen()->refreshRate() : 0.0;
+        m_refreshTimer.setInterval(refreshRate > 0.0 ? qCeil(1000.0 / refreshRate) : 16);
+        m_refreshTimer.start();
+    }
+}
+
+void VideoWidget::refreshTrack(int changes, const std::function<void(Mlt::Producer &)> &edit)
+{
+    // The clones that are still current move to the new generation with the
+    // edit, so the next prefetch does not serialize the whole timeline.
+    const int previous = m_frameCacheGeneration.loadRelaxed();
+    const int generation = m_frameCacheGeneration.fetchAndAddRelaxed(1) + 1;
+    m_prefetcher.editProducer(edit, previous, generation);
+    AudioPremix::singleton().editProducer(edit, previous, generation, changes & TrackAudioChange);
+    if (changes & TrackVideoChange) {
+        m_frameCache.clear();
+        m_frameCacheAge.start();
+        // Mute alone does not change the image, which keeps playing from the
+        // frames the consumer already has.
+        scheduleRefresh(false);
+    }
+}
+
+void VideoWidget::invalidateFrameCache()
+{
+    const int generation = m_frameCacheGeneration.fetchAndAddRelaxed(1) + 1;
+    m_frameCache.clear();
+    m_prefetcher.cancel();
+    AudioPremix::singleton().invalidate(generation);
+    m_frameCacheAge.start();
+}
+
+QString VideoWidget::frameCacheKey(int position) const
+{
+    // A producer without a UUID, such as a clip in the source player, is
+    // identified by its MLT object because the cache is cleared when it is
+    // replaced.
+    QString producer;
+    if (m_producer && m_producer->is_valid()) {
+        QUuid uuid = MLT.uuid(*m_producer);
+        producer = uuid.isNull() ? QString::number(quintptr(m_producer->get_producer()), 16)
+                                 : uuid.toString();
+    }
+    return QStringLiteral("%1:%2:%3x%4")
+        .arg(producer)
+        .arg(position)
+        .arg(previewProfile().width())
+        .arg(previewProfile().height());
+}
+
+bool VideoWidget::showCachedFrame(int position)
+{
+    if (m_frameCache.maxCost() <= 0 || !m_producer || !isPaused() || Settings.playerJACK()
+        || !m_consumer || !m_consumer->is_valid() || m_consumer->is_stopped() || !m_frameRenderer)
+        return false;
+    SharedFrame *frame = m_frameCache.object(frameCacheKey(position));
+    if (!frame)
+        return false;
+
+    // Frames of earlier seeks that are still being rendered must not
+    // replace this one.
+    m_cachedPosition.storeRelaxed(position);
+    m_producer->seek(position);
+    m_consumer->purge();
+    QMetaObject::invokeMethod(m_frameRenderer,
+                              "showCachedFrame",
+                              Qt::QueuedConnection,
+                              Q_ARG(SharedFrame, *frame));
+    return true;
+}
+
+void VideoWidget::cacheFrame(const QString &key, const SharedFrame &frame)
+{
+    if (!m_frameCache.contains(key)) {
+        const int width = frame.get_image_width();
+        const int height = frame.get_image_height();
+        const int kilobytes = mlt_image_format_size(frame.get_image_format(), width, height, nullptr)
+                              / 1024;
+        m_frameCache.insert(key, new SharedFrame(frame), qMax(1, kilobytes));
+    }
+}
+
+void VideoWidget::onPrefetchTimeout()
+{
+    if (!m_producer || !m_producer->is_valid() || !m_consumer || !m_consumer->is_valid())
+        return;
+    const double speed = m_producer->get_speed();
+    // The consumer prefills forward playback itself.
+    const bool isFramePrefetched = m_frameCache.maxCost() > 0 && !m_glslManager
+                                   && (speed <= 0.0 || isPaused());
+    const bool isAudioPremixed = isAudioPremixable() && (speed != 1.0 || isPaused());
+    if (!isFramePrefetched && !isAudioPremixed)
+        return;
+    if (m_frameCacheAge.elapsed() < kPrefetchSettleMs) {
+        m_prefetchTimer.start();
+        return;
+    }
+
+    const int generation = m_frameCacheGeneration.loadRelaxed();
+    if (isAudioPremixed) {
+        auto &premix = AudioPremix::singleton();
+        if (premix.generation() != generation) {
+            auto clone = new Mlt::Producer(profile(), "xml-string", XML().toUtf8().constData());
+            if (clone->is_valid()) {
+                const int frequency = m_consumer->get_int("frequency") > 0
+                                          ? m_consumer->get_int("frequency")
+                                          : 48000;
+                premix.setProducer(clone,
+                                   generation,
+                                   frequency,
+                                   property("audio_channels").toInt(),
+                                   profile().fps());
+            } else {
+                delete clone;
+            }
+        }
+        premix.request(m_producer->position(), speed);
+    }
+    if (!isFramePrefetched)
+        return;
+
+    const char *formatName = m_consumer->get("mlt_image_format");
+    const auto format = formatName ? mlt_image_format_id(formatName) : mlt_image_yuv420p;
+    const int width = previewProfile().width();
+    const int height = previewProfile().height();
+    if (m_prefetcher.generation() != generation) {
+        // Render on a clone because the consumer owns the producer.
+        auto clone = new Mlt::Producer(profile(), "xml-string", XML().toUtf8().constData());
+        if (!clone->is_valid()) {
+            delete clone;
+            return;
+        }
+        Mlt::Properties consumerProperties;
+        if (!profile().progressive())
+            consumerProperties.set("consumer.progressive", property("progressive").toBool());
+        consumerProperties.set("consumer.rescale",
+                               property("rescale").toString().toLatin1().constData());
+        consumerProperties.set("consumer.deinterlacer",
+                               property("deinterlacer").toString().toLatin1().constData());
+        m_prefetcher.setProducer(clone, generation, format, width, height, consumerProperties);
+    }
+
+    // Use half of the cache for the window and more rendering threads for a
+    // longer one, favoring the direction of play.
+    const int frameKilobytes = qMax(1, mlt_image_format_size(format, width, height, nullptr) / 1024);
+    const int window = qMin(m_frameCache.maxCost() / frameKilobytes / 2,
+                            kPrefetchFramesPerThread * qMax(1, qAbs(MLT.realTime())));
+    const int behind = (speed < 0.0) ? window * 3 / 4 : window / 2;
+    m_prefetcher.request(m_producer->position(), behind, window - behind);
+}
+
+VideoWidget::Viewport360 VideoWidget::viewport360() const
+{
+    QMutexLocker locker(&m_viewportMutex);
+    return m_viewport360;
+}
+
+void VideoWidget::setViewport360Enabled(bool isEnabled)
+{
+    auto viewport = viewport360();
+    viewport.isEnabled = isEnabled;
+    setViewport360(viewport);
+}
+
+void VideoWidget::setViewport360(const Viewport360 &viewport)
+{
+    {
+        QMutexLocker locker(&m_viewportMutex);
+        m_viewport360 = viewport;
+    }
+    configureAmbisonicMonitor();
+    quickWindow()->update();
+}
+
+void VideoWidget::configureAmbisonicMonitor()
+{
+    // Ambisonic audio is heard from the direction of the view.
+    const auto viewport = viewport360();
+    if (m_producer && m_producer->is_valid())
+        AmbisonicMonitor::configure(*m_producer,
+                                    viewport.isEnabled && property("audio_channels").toInt() == 4,
+                                    viewport.yaw);
+}
+
+bool VideoWidget::isAudioPremixable() const
+{
+    // Only a tractor mixes tracks, and JACK pulls the audio at its own pace.
+    return m_producer && m_producer->is_valid() && m_producer->type() == mlt_service_tractor_type
+           && !Settings.playerJACK();
+}
+
+void VideoWidget::startAdaptivePreviewScale()
+{
+    if (!Settings.playerPreviewScaleAdaptive()
+        || property("mlt_service").toString().startsWith("decklink")) {
+        m_adaptiveScaleTimer.stop();
+        return;
+    }
+    m_slowIntervals = 0;
+    m_adaptivePresented = presentedFrames();
+    m_adaptiveMissed = droppedFrames() + lateFrames();
+    m_adaptiveScaleTimer.start();
+}
+
+void VideoWidget::restorePreviewScale()
+{
+    m_adaptiveScaleTimer.stop();
+    if (m_adaptedPreviewScale) {
+        LOG_INFO() << "restoring the preview scale from" << m_adaptedPreviewScale;
+        m_adaptedPreviewScale = 0;
+        setPreviewScale(Settings.playerPreviewScale());
+        // Show the paused frame at the full scale.
+        refreshConsumer();
+        emit previewScaleAdapted(0);
+    }
+}
+
+void VideoWidget::onAdaptiveScaleTimeout()
+{
+    if (isPaused()) {
+        m_adaptiveScaleTimer.stop();
+        return;
+    }
+    const int presented = presentedFrames();
+    const int missed = droppedFrames() + lateFrames();
+    const int presentedDelta = presented - m_adaptivePresented;
+    const int missedDelta = missed - m_adaptiveMissed;
+    m_adaptivePresented = presented;
+    m_adaptiveMissed = missed;
+    if (presentedDelta + missedDelta <= 0)
+        return;
+    if (missedDelta > kAdaptiveMissedRatio * (presentedDelta + missedDelta))
+        ++m_slowIntervals;
+    else
+        m_slowIntervals = 0;
+    if (m_slowIntervals < kAdaptiveSlowIntervals)
+        return;
+
+    // Changing the size of the consumer takes effect with the next frame
+    // without restarting it.
+    m_slowIntervals = 0;
+    const int height = previewProfile().height();
+    for (const int scale : kAdaptivePreviewScales) {
+        if (scale < height && scale < profile().height()) {
+            LOG_INFO() << "playback is slow; lowering the preview scale to" << scale;
+            m_adaptedPreviewScale = scale;
+            setPreviewScale(scale);
+            emit previewScaleAdapted(scale);
+            return;
+        }
+    }
+}
+
+void VideoWidget::onFramePrefetched(const SharedFrame &frame, int position, int generation)
+{
+    if (generation == m_frameCacheGeneration.loadRelaxed())
+        cacheFrame(frameCacheKey(position), frame);
 }
 
 QPoint VideoWidget::offset() const
@@ -497,8 +912,15 @@ QImage VideoWidget::image() const
         if (image) {
             int width = frame.get_image_width();
             int height = frame.get_image_height();
-            QImage temp(image, width, height, QImage::Format_RGBA8888);
-            return temp.copy();
+            // Share the frame's buffer instead of copying it.
+            return QImage(
+                image,
+                width,
+                height,
+                width * 4,
+                QImage::Format_RGBA8888,
+                [](void *frame) { delete static_cast<SharedFrame *>(frame); },
+                new SharedFrame(frame));
         }
     }
     return QImage();
@@ -523,6 +945,21 @@ void VideoWidget::requestImage() const
     m_frameRenderer->requestImage();
 }
 
+int VideoWidget::presentedFrames() const
+{
+    return m_frameRenderer ? m_frameRenderer->presentedFrames() : 0;
+}
+
+int VideoWidget::droppedFrames() const
+{
+    return m_frameRenderer ? m_frameRenderer->droppedFrames() : 0;
+}
+
+int VideoWidget::lateFrames() const
+{
+    return m_frameRenderer ? m_frameRenderer->lateFrames() : 0;
+}
+
 void VideoWidget::toggleVuiDisplay()
 {
     m_hideVui = !m_hideVui;
@@ -531,9 +968,25 @@ void VideoWidget::toggleVuiDisplay()
 
 void VideoWidget::onFrameDisplayed(const SharedFrame &frame)
 {
+    if (m_refreshInFlight.isValid()) {
+        FrameTrace::complete("VideoWidget::refresh", m_refreshStart, frame.get_position());
+        m_refreshInFlight.invalidate();
+        if (m_isRefreshPending)
+            onRefreshTimeout();
+    }
     m_mutex.lock();
     m_sharedFrame = frame;
     m_mutex.unlock();
+    if (m_frameCache.maxCost() > 0 && isPaused()
+        && frame.get_int(kFrameCacheGenerationProperty) == m_frameCacheGeneration.loadRelaxed()) {
+        cacheFrame(frameCacheKey(frame.get_position()), frame);
+    }
+    if (m_producer && !m_prefetchTimer.isActive()) {
+        const double speed = m_producer->get_speed();
+        if ((m_frameCache.maxCost() > 0 && !m_glslManager && speed <= 0.0)
+            || (isAudioPremixable() && speed != 1.0))
+            m_prefetchTimer.start();
+    }
     bool isVui = frame.get_int(kShotcutVuiMetaProperty) && !m_hideVui;
     if (!isVui && source() != QmlUtilities::blankVui()) {
         m_savedQmlSource = source();
@@ -598,17 +1051,47 @@ void VideoWidget::setSnapToGrid(bool snap)
 void VideoWidget::on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data data)
 {
     auto frame = Mlt::EventData(data).to_frame();
-    if (frame.is_valid() && frame.get_int("rendered")) {
-        int timeout = (widget->consumer()->get_int("real_time") > 0) ? 0 : 1000;
-        if (widget->m_frameRenderer
-            && widget->m_frameRenderer->semaphore()->tryAcquire(1, timeout)) {
-            QMetaObject::invokeMethod(widget->m_frameRenderer,
+    FrameTrace::Scope trace("on_frame_show", frame.is_valid() ? frame.get_position() : -1);
+    FrameRenderer *renderer = widget->m_frameRenderer;
+    if (renderer && frame.is_valid() && frame.get_int("rendered")) {
+        const int position = frame.get_position();
+        const int cachedPosition = widget->m_cachedPosition.loadRelaxed();
+        if (cachedPosition >= 0 && position != cachedPosition) {
+            // A frame from the cache superseded this one.
+            renderer->countDroppedFrame();
+            return;
+        }
+        // Frames rendered before the edit changed must not be cached.
+        frame.set(kFrameCacheGenerationProperty, widget->m_frameCacheGeneration.loadRelaxed());
+        // While playing, a repeated position shows nothing new, so it is the
+        // first to go when the pipeline is busy. When paused, it may show a
+        // changed filter.
+        if (position == renderer->lastQueuedPosition() && frame.get_double("_speed") != 0.0
+            && renderer->semaphore()->available() < renderer->queueDepth()) {
+            renderer->countDroppedFrame();
+            return;
+        }
+        bool isQueued = renderer->semaphore()->tryAcquire(1, 0);
+        if (!isQueued && widget->consumer()->get_int("real_time") <= 0) {
+            isQueued = renderer->semaphore()->tryAcquire(1, 1000);
+            if (isQueued)
+                renderer->countLateFrame();
+        }
+        if (isQueued) {
+            renderer->setLastQueuedPosition(position);
+            QMetaObject::invokeMethod(renderer,
                                       "showFrame",
                                       Qt::QueuedConnection,
                                       Q_ARG(Mlt::Frame, frame));
-        } else if (!Settings.playerRealtime()) {
-            LOG_WARNING() << "VideoWidget dropped frame" << frame.get_position();
+        } else {
+            renderer->countDroppedFrame();
+            if (!Settings.playerRealtime())
+                LOG_WARNING_THROTTLED(kDroppedFrameLogIntervalMs)
+                    << "VideoWidget dropped frame" << position;
         }
+    } else if (renderer && frame.is_valid()) {
+        // The consumer skipped rendering it to keep up with real time.
+        renderer->countDroppedFrame();
     }
 }
 
@@ -645,21 +1128,84 @@ void RenderThread::run()
     m_context->doneCurrent();
 }
 
-FrameRenderer::FrameRenderer()
+FrameRenderer::FrameRenderer(int queueDepth)
     : QThread(nullptr)
-    , m_semaphore(3)
+    , m_queueDepth(qBound(1, queueDepth, 8))
+    , m_semaphore(m_queueDepth)
     , m_imageRequested(false)
+    , m_frameInterval(0)
+    , m_lastQueuedPosition(-1)
+    , m_presentedFrames(0)
+    , m_droppedFrames(0)
+    , m_lateFrames(0)
+    , m_presentTimer(this)
 {
     setObjectName("FrameRenderer");
+    m_presentTimer.setSingleShot(true);
+    m_presentTimer.setTimerType(Qt::PreciseTimer);
+    connect(&m_presentTimer, &QTimer::timeout, this, &FrameRenderer::presentFrame);
     moveToThread(this);
     start();
 }
 
 FrameRenderer::~FrameRenderer() {}
 
+void FrameRenderer::setRefreshRate(qreal refreshRate)
+{
+    // Allow some jitter so that frames at the refresh rate are not held.
+    const int interval = refreshRate > 0.0 ? qRound(0.9 * 1000000.0 / refreshRate) : 0;
+    m_frameInterval.storeRelaxed(interval);
+    LOG_INFO() << "display refresh rate" << refreshRate << "frame queue depth" << m_queueDepth;
+}
+
 void FrameRenderer::showFrame(Mlt::Frame frame)
 {
-    m_displayFrame = SharedFrame(frame);
+    FrameTrace::Scope trace("FrameRenderer::showFrame", frame.get_position());
+    if (m_pendingFrame.is_valid()) {
+        // A newer frame arrived before the held one could be shown.
+        m_droppedFrames.fetchAndAddRelaxed(1);
+        m_semaphore.release();
+    }
+    m_pendingFrame = SharedFrame(frame);
+    if (m_presentTimer.isActive())
+        return;
+    const qint64 interval = m_frameInterval.loadRelaxed();
+    const qint64 elapsed = m_sincePresented.isValid() ? m_sincePresented.nsecsElapsed() / 1000
+                                                      : interval;
+    if (elapsed >= interval)
+        presentFrame();
+    else
+        m_presentTimer.start(int((interval - elapsed + 999) / 1000));
+}
+
+void FrameRenderer::showCachedFrame(const SharedFrame &frame)
+{
+    // It replaces a frame that is held for the next refresh.
+    if (m_pendingFrame.is_valid()) {
+        m_droppedFrames.fetchAndAddRelaxed(1);
+        m_pendingFrame = SharedFrame();
+        m_semaphore.release();
+    }
+    m_displayFrame = frame;
+    m_sincePresented.start();
+    m_presentedFrames.fetchAndAddRelaxed(1);
+    emit frameDisplayed(m_displayFrame);
+
+    if (m_imageRequested) {
+        m_imageRequested = false;
+        emit imageReady();
+    }
+}
+
+void FrameRenderer::presentFrame()
+{
+    if (!m_pendingFrame.is_valid())
+        return;
+    FrameTrace::Scope trace("FrameRenderer::presentFrame", m_pendingFrame.get_position());
+    m_displayFrame = m_pendingFrame;
+    m_pendingFrame = SharedFrame();
+    m_sincePresented.start();
+    m_presentedFrames.fetchAndAddRelaxed(1);
     emit frameDisplayed(m_displayFrame);
 
     if (m_imageRequested) {
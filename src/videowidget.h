@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2011-2025 Meltytech, LLC
+ * Copyright (c) 2011-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,10 +18,14 @@
 #ifndef VIDEOWIDGET_H
 #define VIDEOWIDGET_H
 
+#include "frameprefetcher.h"
 #include "mltcontroller.h"
 #include "settings.h"
 #include "sharedframe.h"
 
+#include <QAtomicInt>
+#include <QCache>
+#include <QElapsedTimer>
 #include <QMutex>
 #include <QQuickWidget>
 #include <QRectF>
@@ -63,22 +67,38 @@ public:
 
     void play(double speed = 1.0) override
     {
+        m_cachedPosition.storeRelaxed(-1);
         Controller::play(speed);
-        if (speed == 0)
+        if (speed == 0) {
+            restorePreviewScale();
             emit paused();
-        else
+        } else {
+            startAdaptivePreviewScale();
             emit playing();
+        }
     }
     void seek(int position) override
     {
-        Controller::seek(position);
+        if (!showCachedFrame(position)) {
+            m_cachedPosition.storeRelaxed(-1);
+            Controller::seek(position);
+        }
         if (Settings.playerPauseAfterSeek())
             emit paused();
     }
     void refreshConsumer(bool scrubAudio = false) override;
+    /*!
+      Applies \a edit to the clones of the prefetcher and the audio premix
+      instead of cloning the producer again, and forgets only the frames or
+      the audio that \a changes.
+    */
+    void refreshTrack(int changes, const std::function<void(Mlt::Producer &)> &edit) override;
+    //! Forgets the frames kept for scrubbing because the edit changed.
+    void invalidateFrameCache();
     void pause(int position = -1) override
     {
         Controller::pause();
+        restorePreviewScale();
         emit paused();
     }
     int displayWidth() const override { return m_rect.width(); }
@@ -95,6 +115,25 @@ public:
     bool snapToGrid() const { return m_snapToGrid; }
     int maxTextureSize() const { return m_maxTextureSize; }
     void toggleVuiDisplay();
+    //! Returns the number of frames shown since the consumer started.
+    int presentedFrames() const;
+    //! Returns the number of frames that were never shown.
+    int droppedFrames() const;
+    //! Returns the number of frames that waited for the display pipeline.
+    int lateFrames() const;
+    //! Returns the preview scale chosen because playback was slow, or 0.
+    int adaptedPreviewScale() const { return m_adaptedPreviewScale; }
+
+    //! The direction and field of view of the 360 viewport in degrees.
+    struct Viewport360
+    {
+        bool isEnabled{false};
+        float yaw{0.0f};
+        float pitch{0.0f};
+        float fov{90.0f};
+    };
+    //! Returns the view that the backends reproject the equirectangular frame to.
+    Viewport360 viewport360() const;
 
 public slots:
     void setGrid(int grid);
@@ -104,6 +143,7 @@ public slots:
     void setBlankScene();
     void setCurrentFilter(QmlFilter *filter, QmlMetadata *meta);
     void setSnapToGrid(bool snap);
+    void setViewport360Enabled(bool isEnabled);
     virtual void initialize();
     virtual void beforeRendering(){};
     virtual void renderVideo();
@@ -124,6 +164,7 @@ signals:
     void imageReady();
     void snapToGridChanged();
     void toggleZoom(bool);
+    void previewScaleAdapted(int scale);
 
 private:
     QRectF m_rect;
@@ -144,22 +185,62 @@ private:
     bool m_snapToGrid;
     QTimer m_refreshTimer;
     bool m_scrubAudio;
+    // Since the last refresh was requested until its frame is displayed.
+    QElapsedTimer m_refreshInFlight;
+    bool m_isRefreshPending;
+    qint64 m_refreshStart;
     QPoint m_mousePosition;
     std::unique_ptr<RenderThread> m_renderThread;
+    // Recently displayed frames while paused for scrubbing without rendering.
+    QCache<QString, SharedFrame> m_frameCache;
+    QAtomicInt m_frameCacheGeneration;
+    int m_memoryBudgetId;
+    // The position of a frame shown from the cache, or -1.
+    QAtomicInt m_cachedPosition;
+    // Renders the frames around the playhead while paused or in reverse.
+    FramePrefetcher m_prefetcher;
+    QTimer m_prefetchTimer;
+    // Since the frame cache was last invalidated.
+    QElapsedTimer m_frameCacheAge;
+    // Lowers the preview scale while playback cannot keep up.
+    QTimer m_adaptiveScaleTimer;
+    int m_adaptedPreviewScale;
+    int m_slowIntervals;
+    int m_adaptivePresented;
+    int m_adaptiveMissed;
+    // Read by the render thread.
+    mutable QMutex m_viewportMutex;
+    Viewport360 m_viewport360;
+    QPoint m_viewportDragPosition;
 
     static void on_frame_show(mlt_consumer, VideoWidget *widget, mlt_event_data);
+    QString frameCacheKey(int position) const;
+    bool showCachedFrame(int position);
+    void cacheFrame(const QString &key, const SharedFrame &frame);
+    bool isAudioPremixable() const;
+    void scheduleRefresh(bool scrubAudio);
+    void startAdaptivePreviewScale();
+    void restorePreviewScale();
+    void setViewport360(const Viewport360 &viewport);
+    void configureAmbisonicMonitor();
 
 private slots:
     void resizeVideo(int width, int height);
     void onRefreshTimeout();
+    void onPrefetchTimeout();
+    void onAdaptiveScaleTimeout();
+    void onFramePrefetched(const SharedFrame &frame, int position, int generation);
 
 protected:
     void resizeEvent(QResizeEvent *event) override;
     void mousePressEvent(QMouseEvent *) override;
     void mouseMoveEvent(QMouseEvent *) override;
+    void wheelEvent(QWheelEvent *event) override;
     void keyPressEvent(QKeyEvent *event) override;
     bool event(QEvent *event) override;
     void createShader();
+    //! Returns whether the display uploads the 10-bit planes of yuv420p10 as is.
+    virtual bool canDisplayYuv420p10() const { return false; }
 
     int m_maxTextureSize;
     SharedFrame m_sharedFrame;
@@ -183,27 +264,69 @@ private:
     std::unique_ptr<QOffscreenSurface> m_surface;
 };
 
+/*!
+  \class FrameRenderer
+  \brief Passes rendered frames from the consumer to the display.
+
+  The consumer may have up to queueDepth() frames on their way to the display
+  before it has to wait for a slot in semaphore(), or drop the frame in real
+  time mode.
+
+  Frames are shown no faster than the display refreshes. A frame that arrives
+  sooner is held until the next refresh, and if a newer frame arrives in the
+  meantime the held one is dropped, since it could never have been seen.
+*/
+
 class FrameRenderer : public QThread
 {
     Q_OBJECT
 public:
-    FrameRenderer();
+    explicit FrameRenderer(int queueDepth = 3);
     ~FrameRenderer();
     QSemaphore *semaphore() { return &m_semaphore; }
+    int queueDepth() const { return m_queueDepth; }
     SharedFrame getDisplayFrame();
     Q_INVOKABLE void showFrame(Mlt::Frame frame);
+    //! Shows a frame that was shown before without using a slot in semaphore().
+    Q_INVOKABLE void showCachedFrame(const SharedFrame &frame);
     void requestImage();
     QImage image() const { return m_image; }
+    //! Sets the display refresh rate in Hz to pace frames to, or 0 for none.
+    void setRefreshRate(qreal refreshRate);
+
+    // These are called from the consumer thread.
+    int lastQueuedPosition() const { return m_lastQueuedPosition.loadRelaxed(); }
+    void setLastQueuedPosition(int position) { m_lastQueuedPosition.storeRelaxed(position); }
+    void countDroppedFrame() { m_droppedFrames.fetchAndAddRelaxed(1); }
+    void countLateFrame() { m_lateFrames.fetchAndAddRelaxed(1); }
+
+    int presentedFrames() const { return m_presentedFrames.loadRelaxed(); }
+    int droppedFrames() const { return m_droppedFrames.loadRelaxed(); }
+    int lateFrames() const { return m_lateFrames.loadRelaxed(); }
 
 signals:
     void frameDisplayed(const SharedFrame &frame);
     void imageReady();
 
+private slots:
+    void presentFrame();
+
 private:
+    const int m_queueDepth;
     QSemaphore m_semaphore;
     SharedFrame m_displayFrame;
     bool m_imageRequested;
     QImage m_image;
+    QAtomicInt m_frameInterval; // microseconds
+    QAtomicInt m_lastQueuedPosition;
+    QAtomicInt m_presentedFrames;
+    QAtomicInt m_droppedFrames;
+    QAtomicInt m_lateFrames;
+
+    // Members only accessed by the renderer thread.
+    SharedFrame m_pendingFrame;
+    QTimer m_presentTimer;
+    QElapsedTimer m_sincePresented;
 };
 
 } // namespace Mlt
@@ -0,0 +1,270 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "warmupscheduler.h"
+
+#include "Logger.h"
+#include "database.h"
+#include "executors.h"
+#include "mltcontroller.h"
+#include "models/audiolevelstask.h"
+#include "models/multitrackmodel.h"
+#include "models/playlistmodel.h"
+#include "performancecounters.h"
+#include "qmltypes/thumbnailprovider.h"
+#include "settings.h"
+#include "thumbnaildecoderpool.h"
+#include "util.h"
+
+#include <QCoreApplication>
+#include <QEvent>
+
+#include <algorithm>
+
+// The time without input or playback before the warm-up continues.
+static const int kIdleDelayMs = 3000;
+static const int kStepDelayMs = 50;
+
+WarmupScheduler::WarmupScheduler(QObject *parent)
+    : QObject(parent)
+    , m_model(nullptr)
+    // The profile of the thumbnail keys in ThumbnailProvider.
+    , m_profile("atsc_720p_60")
+    , m_position(0)
+    , m_isDirty(false)
+    , m_isBusy(false)
+{
+    m_idleTimer.setSingleShot(true);
+    m_idleTimer.setInterval(kIdleDelayMs);
+    connect(&m_idleTimer, &QTimer::timeout, this, &WarmupScheduler::step);
+    m_stepTimer.setSingleShot(true);
+    m_stepTimer.setInterval(kStepDelayMs);
+    connect(&m_stepTimer, &QTimer::timeout, this, &WarmupScheduler::step);
+    connect(&Settings,
+            &ShotcutSettings::timelineShowThumbnailsChanged,
+            this,
+            &WarmupScheduler::schedule);
+    connect(&Settings,
+            &ShotcutSettings::timelineThumbnailStripChanged,
+            this,
+            &WarmupScheduler::schedule);
+    connect(&Settings,
+            &ShotcutSettings::timelineShowWaveformsChanged,
+            this,
+            &WarmupScheduler::schedule);
+    QCoreApplication::instance()->installEventFilter(this);
+}
+
+WarmupScheduler &WarmupScheduler::singleton()
+{
+    static WarmupScheduler instance;
+    return instance;
+}
+
+void WarmupScheduler::setModel(MultitrackModel *model)
+{
+    m_model = model;
+    reset();
+}
+
+void WarmupScheduler::reset()
+{
+    m_queue.clear();
+    m_warmed.clear();
+    schedule();
+}
+
+void WarmupScheduler::setPosition(int position)
+{
+    if (position == m_position)
+        return;
+    m_position = position;
+    schedule();
+}
+
+void WarmupScheduler::schedule()
+{
+    m_isDirty = true;
+    m_stepTimer.stop();
+    m_idleTimer.start();
+}
+
+void WarmupScheduler::pause()
+{
+    m_stepTimer.stop();
+    m_idleTimer.stop();
+}
+
+bool WarmupScheduler::eventFilter(QObject *watched, QEvent *event)
+{
+    switch (event->type()) {
+    case QEvent::KeyPress:
+    case QEvent::MouseButtonPress:
+    case QEvent::TouchBegin:
+    case QEvent::Wheel:
+        if (m_isDirty || !m_queue.isEmpty()) {
+            m_stepTimer.stop();
+            m_idleTimer.start();
+        }
+        break;
+    default:
+        break;
+    }
+    return QObject::eventFilter(watched, event);
+}
+
+bool WarmupScheduler::isIdle() const
+{
+    return m_model && m_model->tractor() && MLT.isPaused() && !m_idleTimer.isActive();
+}
+
+// Lists the clips with a cache miss by the distance from the playhead.
+void WarmupScheduler::rebuild()
+{
+    m_queue.clear();
+    if (!m_model || !m_model->tractor())
+        return;
+    const bool isThumbnails = Settings.timelineShowThumbnails();
+    // A strip starts with the thumbnail of the in point, but its count follows the zoom.
+    const bool isStrip = Settings.timelineThumbnailStrip();
+    const bool isWaveforms = Settings.timelineShowWaveforms();
+    Mlt::Properties properties;
+    properties.set("_profile", m_profile.get_profile(), 0);
+
+    for (int trackIndex = 0; trackIndex < m_model->rowCount(); ++trackIndex) {
+        const auto track = m_model->index(trackIndex);
+        const bool isAudio = m_model->data(track, MultitrackModel::IsAudioRole).toBool();
+        for (int clipIndex = 0; clipIndex < m_model->rowCount(track); ++clipIndex) {
+            const auto index = m_model->index(clipIndex, 0, track);
+            if (m_model->data(index, MultitrackModel::IsBlankRole).toBool()
+                || m_model->data(index, MultitrackModel::IsTransitionRole).toBool())
+                continue;
+            const int start = m_model->data(index, MultitrackModel::StartRole).toInt();
+            const int duration = m_model->data(index, MultitrackModel::DurationRole).toInt();
+            Clip clip;
+            clip.trackIndex = trackIndex;
+            clip.clipIndex = clipIndex;
+            clip.distance = qMax(0, qMax(start - m_position, m_position - (start + duration)));
+            clip.needsLevels = isWaveforms
+                               && m_model->data(index, MultitrackModel::AudioLevelsRole).isNull();
+            if (isThumbnails && !isAudio) {
+                // These match the image URLs of Clip.qml.
+                clip.service = m_model->data(index, MultitrackModel::ServiceRole).toString();
+                clip.resource = Util::removeQueryString(
+                    m_model->data(index, MultitrackModel::ResourceRole).toString());
+                const auto hash = m_model->data(index, MultitrackModel::FileHashRole).toString();
+                QList<int> frames{m_model->data(index, MultitrackModel::InPointRole).toInt()};
+                if (!isStrip)
+                    frames << m_model->data(index, MultitrackModel::OutPointRole).toInt();
+                for (auto frame : frames) {
+                    frame = qRound(frame / MLT.profile().fps() * m_profile.fps());
+                    const auto key = ThumbnailProvider::cacheKey(properties,
+                                                                 clip.service,
+                                                                 clip.resource,
+                                                                 hash,
+                                                                 frame);
+                    if (!m_warmed.contains(key) && !clip.keys.contains(key)) {
+                        clip.keys << key;
+                        clip.frames << frame;
+                    }
+                }
+            }
+            if (clip.needsLevels || !clip.keys.isEmpty())
+                m_queue << clip;
+        }
+    }
+    std::stable_sort(m_queue.begin(), m_queue.end(), [](const Clip &a, const Clip &b) {
+        return a.distance < b.distance;
+    });
+}
+
+void WarmupScheduler::step()
+{
+    if (!isIdle())
+        return;
+    if (m_isDirty) {
+        m_isDirty = false;
+        rebuild();
+        if (!m_queue.isEmpty())
+            LOG_DEBUG() << "warming up" << m_queue.size() << "clips from" << m_position;
+    }
+    if (m_queue.isEmpty() || m_isBusy)
+        return;
+
+    auto &clip = m_queue.first();
+    // The levels that are being made, such as those of the project load, are
+    // checked again after the next edit or seek.
+    if (clip.needsLevels && AudioLevelsTask::pendingCount() == 0)
+        requestLevels(clip);
+    clip.needsLevels = false;
+    if (!clip.keys.isEmpty()) {
+        const auto service = clip.service;
+        const auto resource = clip.resource;
+        const auto keys = clip.keys;
+        const auto frames = clip.frames;
+        // Use only a free thread to not delay the thumbnails that are in view.
+        const bool isStarted = Executors::tryStart(Executors::ThumbnailExecutor, [=]() {
+            for (int i = 0; i < keys.size(); ++i) {
+                if (!DB.getThumbnail(keys[i]).isNull())
+                    continue;
+                auto image = ThumbnailDecoderPool::singleton()
+                                 .image(service,
+                                        resource,
+                                        frames[i],
+                                        PlaylistModel::THUMBNAIL_WIDTH * 2,
+                                        PlaylistModel::THUMBNAIL_HEIGHT * 2,
+                                        ThumbnailDecoderPool::DefaultSeek);
+                PerformanceCounters::add(PerformanceCounters::ThumbnailsGenerated);
+                if (!image.isNull())
+                    DB.putThumbnail(keys[i], image);
+            }
+            QMetaObject::invokeMethod(
+                this, [=]() { onThumbnailsDone(keys); }, Qt::QueuedConnection);
+        });
+        if (!isStarted) {
+            m_stepTimer.start();
+            return;
+        }
+        m_isBusy = true;
+    }
+    m_queue.removeFirst();
+    if (m_queue.isEmpty())
+        LOG_DEBUG() << "warmed up the timeline";
+    else if (!m_isBusy)
+        m_stepTimer.start();
+}
+
+void WarmupScheduler::requestLevels(const Clip &clip)
+{
+    auto info = m_model->getClipInfo(clip.trackIndex, clip.clipIndex);
+    if (!info || !info->producer || !info->cut || info->cut->get_int("audio_index") < 0)
+        return;
+    Mlt::Producer producer(info->producer);
+    if (!AudioLevelsTask::levels(producer).isEmpty())
+        return;
+    const auto index = m_model->index(clip.clipIndex, 0, m_model->index(clip.trackIndex));
+    AudioLevelsTask::start(producer, m_model, index);
+}
+
+void WarmupScheduler::onThumbnailsDone(const QStringList &keys)
+{
+    for (const auto &key : keys)
+        m_warmed << key;
+    m_isBusy = false;
+    if (!m_queue.isEmpty() && !m_idleTimer.isActive())
+        m_stepTimer.start();
+}
@@ -0,0 +1,98 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WARMUPSCHEDULER_H
+#define WARMUPSCHEDULER_H
+
+#include <MltProfile.h>
+#include <QList>
+#include <QObject>
+#include <QSet>
+#include <QStringList>
+#include <QTimer>
+
+class MultitrackModel;
+
+/*!
+  \class WarmupScheduler
+  \brief Fills the thumbnail and waveform caches of the timeline while the user is idle.
+
+  The timeline otherwise asks for the thumbnails and audio levels of a clip
+  only when it scrolls into view, so the first pass through a new project
+  stutters while the caches fill. Once the project is loaded and the player
+  is paused with no input for a moment, this walks the clips outward from the
+  playhead and makes what is missing one clip at a time: the thumbnails on the
+  thumbnail pool only when one of its threads is free, and the audio levels on
+  the analysis pool only when no other levels are being made. Any input or
+  playback pauses it until the user is idle again.
+*/
+
+class WarmupScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    static WarmupScheduler &singleton();
+
+    void setModel(MultitrackModel *model);
+    //! Returns the count of clips that are left to check.
+    int pendingCount() const { return m_queue.size(); }
+
+public slots:
+    //! Starts over with a new project.
+    void reset();
+    void setPosition(int position);
+    //! Checks the clips again once the user is idle, such as after an edit.
+    void schedule();
+    //! Stops until the user is idle again, such as while playing.
+    void pause();
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    struct Clip
+    {
+        int trackIndex;
+        int clipIndex;
+        int distance;
+        QString service;
+        QString resource;
+        QStringList keys;
+        QList<int> frames;
+        bool needsLevels;
+    };
+
+    explicit WarmupScheduler(QObject *parent = nullptr);
+    bool isIdle() const;
+    void rebuild();
+    void step();
+    void requestLevels(const Clip &clip);
+    void onThumbnailsDone(const QStringList &keys);
+
+    MultitrackModel *m_model;
+    Mlt::Profile m_profile;
+    QTimer m_idleTimer;
+    QTimer m_stepTimer;
+    QList<Clip> m_queue;
+    // The thumbnails that are known to be in the database.
+    QSet<QString> m_warmed;
+    int m_position;
+    bool m_isDirty;
+    bool m_isBusy;
+};
+
+#endif // WARMUPSCHEDULER_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,6 +22,7 @@
 #include "dialogs/filedatedialog.h"
 #include "dialogs/listselectiondialog.h"
 #include "dialogs/longuitask.h"
+#include "executors.h"
 #include "jobqueue.h"
 #include "jobs/bitrateviewerjob.h"
 #include "jobs/ffmpegjob.h"
@@ -186,7 +187,7 @@ void AvformatProducerWidget::onProducerChanged(Mlt::Producer *producer)
                     this,
                     &AvformatProducerWidget::reloadProducerValues,
                     Qt::QueuedConnection);
-            QThreadPool::globalInstance()->start(task, 10);
+            Executors::start(Executors::AnalysisExecutor, task, 10);
         }
     }
 }
@@ -1113,6 +1114,7 @@ void AvformatProducerWidget::on_reverseButton_clicked()
                                            m_producer->get_int("meta.media.frame_rate_den"));
             meltJob->setLabel(tr("Reverse %1").arg(Util::baseName(resource)));
             meltJob->setTarget(filename);
+            meltJob->addDependency(ffmpegJob);
 
             if (m_producer->get(kMultitrackItemProperty)) {
                 QString s = QString::fromLatin1(m_producer->get(kMultitrackItemProperty));
@@ -1388,16 +1390,9 @@ void AvformatProducerWidget::on_actionMakeProxy_triggered()
 
 void AvformatProducerWidget::on_actionDeleteProxy_triggered()
 {
-    // Delete the file if it exists
+    // Delete the files of every tier and those being made
     QString hash = Util::getHash(*producer());
-    QString fileName = hash + ProxyManager::videoFilenameExtension();
-    QDir dir = ProxyManager::dir();
-    LOG_DEBUG() << "removing" << dir.filePath(fileName);
-    dir.remove(dir.filePath(fileName));
-
-    // Delete the pending file if it exists));
-    fileName = hash + ProxyManager::pendingVideoExtension();
-    dir.remove(dir.filePath(fileName));
+    ProxyManager::removeFiles(hash, false);
 
     // Replace with original
     if (producer()->get_int(kIsProxyProperty) && producer()->get(kOriginalResourceProperty)) {
@@ -1582,7 +1577,7 @@ void AvformatProducerWidget::on_actionBitrateViewer_triggered()
     args << "-v"
          << "quiet";
     args << "-print_format"
-         << "json=compact=1";
+         << "compact=print_section=0";
     if (m_producer->get_int("video_index") >= 0)
         args << "-select_streams"
              << QString::fromLatin1("V:%1").arg(m_producer->get_int(kVideoIndexProperty));
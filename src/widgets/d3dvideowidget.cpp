@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2025 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,9 +18,14 @@
 #include "d3dvideowidget.h"
 
 #include "Logger.h"
+#include "frametrace.h"
 
+#include <QtMath>
 #include <d3dcompiler.h>
 
+// Maps samples of 10 bits in the 16-bit textures onto the 8-bit video range.
+static const float kSampleScale10Bit = 65535.0f / 1020.0f;
+
 D3DVideoWidget::D3DVideoWidget(QObject *parent)
     : Mlt::VideoWidget{parent}
 {
@@ -30,10 +35,7 @@ D3DVideoWidget::D3DVideoWidget(QObject *parent)
 
 D3DVideoWidget::~D3DVideoWidget()
 {
-    for (int i = 0; i < 3; i++) {
-        if (m_texture[i])
-            m_texture[i]->Release();
-    }
+    releaseTextures();
     if (m_vs)
         m_vs->Release();
     if (m_ps)
@@ -135,6 +137,7 @@ void D3DVideoWidget::initialize()
 
 void D3DVideoWidget::beforeRendering()
 {
+    FrameTrace::Scope trace("D3DVideoWidget::beforeRendering");
     quickWindow()->beginExternalCommands();
     m_context->ClearState();
 
@@ -182,7 +185,7 @@ void D3DVideoWidget::beforeRendering()
     }
     m_context->UpdateSubresource(m_vbuf, 0, nullptr, vertexData, 0, 0);
 
-    // (Re)create the textures
+    // Update the textures, which are only made again for another size or format
     m_mutex.lock();
     if (!m_sharedFrame.is_valid()) {
         m_mutex.unlock();
@@ -190,19 +193,34 @@ void D3DVideoWidget::beforeRendering()
         Mlt::VideoWidget::beforeRendering();
         return;
     }
-    int iwidth = m_sharedFrame.get_image_width();
-    int iheight = m_sharedFrame.get_image_height();
-    const uint8_t *image = m_sharedFrame.get_image(mlt_image_yuv420p);
-    for (int i = 0; i < 3; i++) {
-        if (m_texture[i])
-            m_texture[i]->Release();
+    // 10-bit video is uploaded as is and converted by the shader.
+    const bool is16Bit = m_sharedFrame.get_image_format() == mlt_image_yuv420p10;
+    const auto view = m_sharedFrame.get_image_view(is16Bit ? mlt_image_yuv420p10
+                                                           : mlt_image_yuv420p);
+    if (view.planeCount == 3) {
+        for (int i = 0; i < 3; i++) {
+            const int divisor = i ? 2 : 1;
+            if (initTexture(i, view.width / divisor, view.height / divisor, is16Bit)) {
+                updateTexture(i, view.planes[i], view.strides[i]);
+            } else {
+                releaseTextures();
+                break;
+            }
+        }
+    } else {
+        releaseTextures();
     }
-    m_texture[0] = initTexture(image, iwidth, iheight);
-    m_texture[1] = initTexture(image + iwidth * iheight, iwidth / 2, iheight / 2);
-    m_texture[2] = initTexture(image + iwidth * iheight + iwidth / 2 * iheight / 2,
-                               iwidth / 2,
-                               iheight / 2);
+    m_constants.sampleScale = is16Bit ? kSampleScale10Bit : 1.0f;
+    m_constants.transfer = m_sharedFrame.get_int("color_trc");
     m_mutex.unlock();
+    // Only the viewport of a 360 video is sampled from the whole frame.
+    const auto viewport = viewport360();
+    const float tanHalfFov = qTan(qDegreesToRadians(viewport.fov) / 2.0f);
+    m_constants.viewport = viewport.isEnabled ? 1 : 0;
+    m_constants.viewDirection[0] = qDegreesToRadians(viewport.yaw);
+    m_constants.viewDirection[1] = qDegreesToRadians(viewport.pitch);
+    m_constants.viewSize[0] = tanHalfFov * float(rect().width() / qMax(1.0, rect().height()));
+    m_constants.viewSize[1] = tanHalfFov;
 
     // Update the constants
     D3D11_MAPPED_SUBRESOURCE mp;
@@ -224,6 +242,7 @@ void D3DVideoWidget::beforeRendering()
 
 void D3DVideoWidget::renderVideo()
 {
+    FrameTrace::Scope trace("D3DVideoWidget::renderVideo");
     if (!m_texture[0]) {
         Mlt::VideoWidget::renderVideo();
         return;
@@ -280,6 +299,11 @@ void D3DVideoWidget::prepareShader(Stage stage)
                  "SamplerState yuvSampler;"
                  "cbuffer buf {"
                  "    int colorspace;"
+                 "    float sampleScale;"
+                 "    int transfer;"
+                 "    int viewport;"
+                 "    float2 viewDirection;"
+                 "    float2 viewSize;"
                  "};"
                  "struct PSInput {"
                  "  float2 coords : TEXCOORD0;"
@@ -287,11 +311,53 @@ void D3DVideoWidget::prepareShader(Stage stage)
                  "struct PSOutput {"
                  "  float4 color : SV_Target0;"
                  "};"
+                 // ITU-R BT.2100 HLG inverse OETF and OOTF for a 1000 nit display
+                 "float3 hlgToLinear(float3 e) {"
+                 "  float3 lo = e * e / 3.0f;"
+                 "  float3 hi = (exp((e - 0.55991073f) / 0.17883277f) + 0.28466892f) / 12.0f;"
+                 "  float3 scene = lerp(lo, hi, step(0.5f, e));"
+                 "  float y = dot(scene, float3(0.2627f, 0.678f, 0.0593f));"
+                 "  return scene * pow(max(y, 0.000001f), 0.2f) * 1000.0f;"
+                 "}"
+                 // SMPTE ST 2084 (PQ) EOTF
+                 "float3 pqToLinear(float3 e) {"
+                 "  float3 p = pow(e, 1.0f / 78.84375f);"
+                 "  float3 l = max(p - 0.8359375f, 0.0f) / (18.8515625f - 18.6875f * p);"
+                 "  return pow(l, 1.0f / 0.1593017578125f) * 10000.0f;"
+                 "}"
+                 // Tone maps to an SDR BT.709 display with reference white at 203 nits.
+                 "float3 toSdr(float3 e, int trc) {"
+                 "  e = saturate(e);"
+                 "  float3 l = (trc == 18 ? hlgToLinear(e) : pqToLinear(e)) / 203.0f;"
+                 "  float y = dot(l, float3(0.2627f, 0.678f, 0.0593f));"
+                 "  float peak = 1000.0f / 203.0f;"
+                 "  float mapped = y * (1.0f + y / (peak * peak)) / (1.0f + y);"
+                 "  l *= mapped / max(y, 0.000001f);"
+                 "  l = mul(float3x3("
+                 "      1.6605f, -0.5876f, -0.0728f,"
+                 "     -0.1246f,  1.1329f, -0.0083f,"
+                 "     -0.0182f, -0.1006f,  1.1187f), l);"
+                 "  return pow(saturate(l), 1.0f / 2.4f);"
+                 "}"
+                 // Maps a point of the 360 viewport to the equirectangular frame.
+                 "float2 equirectangular(float2 c) {"
+                 "  float3 ray = normalize(float3((2.0f * c.x - 1.0f) * viewSize.x,"
+                 "                                (1.0f - 2.0f * c.y) * viewSize.y, 1.0f));"
+                 "  float cp = cos(viewDirection.y);"
+                 "  float sp = sin(viewDirection.y);"
+                 "  ray = float3(ray.x, ray.y * cp + ray.z * sp, ray.z * cp - ray.y * sp);"
+                 "  float cy = cos(viewDirection.x);"
+                 "  float sy = sin(viewDirection.x);"
+                 "  ray = float3(ray.x * cy + ray.z * sy, ray.y, ray.z * cy - ray.x * sy);"
+                 "  return float2(0.5f + atan2(ray.x, ray.z) / 6.2831853f,"
+                 "                0.5f - asin(clamp(ray.y, -1.0f, 1.0f)) / 3.1415927f);"
+                 "}"
                  "PSOutput main(PSInput input) {"
+                 "  float2 uv = viewport != 0 ? equirectangular(input.coords) : input.coords;"
                  "  float3 yuv;"
-                 "  yuv.x = yTex.Sample(yuvSampler, input.coords).r -  16.0f/255.0f;"
-                 "  yuv.y = uTex.Sample(yuvSampler, input.coords).r - 128.0f/255.0f;"
-                 "  yuv.z = vTex.Sample(yuvSampler, input.coords).r - 128.0f/255.0f;"
+                 "  yuv.x = yTex.Sample(yuvSampler, uv).r * sampleScale -  16.0f/255.0f;"
+                 "  yuv.y = uTex.Sample(yuvSampler, uv).r * sampleScale - 128.0f/255.0f;"
+                 "  yuv.z = vTex.Sample(yuvSampler, uv).r * sampleScale - 128.0f/255.0f;"
                  "  float3x3 coefficients;"
                  "  if (colorspace == 601) {"
                  "    coefficients = float3x3("
@@ -309,8 +375,11 @@ void D3DVideoWidget::prepareShader(Stage stage)
                  "      1.1643f, -0.213f, -0.533f,"
                  "      1.1643f,  2.112f,  0.0f);"
                  "  }"
+                 "  float3 rgb = mul(coefficients, yuv);"
+                 "  if (transfer == 16 || transfer == 18)" // PQ or HLG
+                 "    rgb = toSdr(rgb, transfer);"
                  "  PSOutput output;"
-                 "  output.color = float4(mul(coefficients, yuv), 1.0f);"
+                 "  output.color = float4(rgb, 1.0f);"
                  "  return output;"
                  "}";
         m_fragEntryPoint = QByteArrayLiteral("main");
@@ -366,29 +435,38 @@ QByteArray D3DVideoWidget::compileShader(Stage stage,
     return result;
 }
 
-ID3D11ShaderResourceView *D3DVideoWidget::initTexture(const void *p, int width, int height)
+bool D3DVideoWidget::initTexture(int plane, int width, int height, bool is16Bit)
 {
-    ID3D11ShaderResourceView *result;
+    if (m_planes[plane] && m_planeWidth[plane] == width && m_planeHeight[plane] == height
+        && m_is16Bit[plane] == is16Bit)
+        return true;
+    if (m_texture[plane])
+        m_texture[plane]->Release();
+    if (m_planes[plane])
+        m_planes[plane]->Release();
+    m_texture[plane] = nullptr;
+    m_planes[plane] = nullptr;
+
     D3D11_TEXTURE2D_DESC desc;
     desc.Width = width;
     desc.Height = height;
     desc.MipLevels = 1;
     desc.ArraySize = 1;
-    desc.Format = DXGI_FORMAT_R8_UNORM;
+    desc.Format = is16Bit ? DXGI_FORMAT_R16_UNORM : DXGI_FORMAT_R8_UNORM;
     desc.SampleDesc.Count = 1;
     desc.SampleDesc.Quality = 0;
-    desc.Usage = D3D11_USAGE_DEFAULT;
+    // Written by the CPU each frame and read once by the GPU
+    desc.Usage = D3D11_USAGE_DYNAMIC;
     desc.BindFlags = D3D11_BIND_SHADER_RESOURCE;
-    desc.CPUAccessFlags = 0;
+    desc.CPUAccessFlags = D3D11_CPU_ACCESS_WRITE;
     desc.MiscFlags = 0;
 
-    D3D11_SUBRESOURCE_DATA subresourceData;
-    subresourceData.pSysMem = p;
-    subresourceData.SysMemPitch = width;
-    subresourceData.SysMemSlicePitch = 0;
-
-    ID3D11Texture2D *texture;
-    m_device->CreateTexture2D(&desc, &subresourceData, &texture);
+    HRESULT hr = m_device->CreateTexture2D(&desc, nullptr, &m_planes[plane]);
+    if (FAILED(hr)) {
+        LOG_ERROR() << "failed to create a texture" << width << "x" << height << hr;
+        m_planes[plane] = nullptr;
+        return false;
+    }
 
     D3D11_SHADER_RESOURCE_VIEW_DESC srvDesc;
     srvDesc.Format = desc.Format;
@@ -396,8 +474,51 @@ ID3D11ShaderResourceView *D3DVideoWidget::initTexture(const void *p, int width,
     srvDesc.Texture2D.MipLevels = 1;
     srvDesc.Texture2D.MostDetailedMip = 0;
 
-    m_device->CreateShaderResourceView(texture, &srvDesc, &result);
-    texture->Release();
+    hr = m_device->CreateShaderResourceView(m_planes[plane], &srvDesc, &m_texture[plane]);
+    if (FAILED(hr)) {
+        LOG_ERROR() << "failed to create a shader resource view" << hr;
+        m_planes[plane]->Release();
+        m_planes[plane] = nullptr;
+        m_texture[plane] = nullptr;
+        return false;
+    }
+    m_planeWidth[plane] = width;
+    m_planeHeight[plane] = height;
+    m_is16Bit[plane] = is16Bit;
+    return true;
+}
+
+void D3DVideoWidget::updateTexture(int plane, const void *p, int pitch)
+{
+    D3D11_MAPPED_SUBRESOURCE mapped;
+    // Discarding gives a fresh region, so the GPU is not waited on.
+    HRESULT hr = m_context->Map(m_planes[plane], 0, D3D11_MAP_WRITE_DISCARD, 0, &mapped);
+    if (FAILED(hr)) {
+        LOG_WARNING() << "failed to map a texture" << hr;
+        return;
+    }
+    const int rowSize = m_planeWidth[plane] * (m_is16Bit[plane] ? 2 : 1);
+    auto src = static_cast<const uint8_t *>(p);
+    auto dst = static_cast<uint8_t *>(mapped.pData);
+    if (int(mapped.RowPitch) == pitch && pitch == rowSize) {
+        ::memcpy(dst, src, size_t(rowSize) * m_planeHeight[plane]);
+    } else {
+        for (int y = 0; y < m_planeHeight[plane]; ++y)
+            ::memcpy(dst + size_t(y) * mapped.RowPitch, src + size_t(y) * pitch, rowSize);
+    }
+    m_context->Unmap(m_planes[plane], 0);
+}
 
-    return result;
+void D3DVideoWidget::releaseTextures()
+{
+    for (int i = 0; i < 3; i++) {
+        if (m_texture[i])
+            m_texture[i]->Release();
+        if (m_planes[i])
+            m_planes[i]->Release();
+        m_texture[i] = nullptr;
+        m_planes[i] = nullptr;
+        m_planeWidth[i] = 0;
+        m_planeHeight[i] = 0;
+    }
 }
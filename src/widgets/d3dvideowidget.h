@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -35,11 +35,17 @@ public slots:
     virtual void beforeRendering();
     virtual void renderVideo();
 
+protected:
+    bool canDisplayYuv420p10() const override { return true; }
+
 private:
     enum Stage { VertexStage, FragmentStage };
     void prepareShader(Stage stage);
     QByteArray compileShader(Stage stage, const QByteArray &source, const QByteArray &entryPoint);
-    ID3D11ShaderResourceView *initTexture(const void *p, int width, int height);
+    //! Makes a dynamic texture for \a plane unless it has the size and format.
+    bool initTexture(int plane, int width, int height, bool is16Bit);
+    void updateTexture(int plane, const void *p, int pitch);
+    void releaseTextures();
 
     ID3D11Device *m_device = nullptr;
     ID3D11DeviceContext *m_context = nullptr;
@@ -57,10 +63,20 @@ private:
     ID3D11RasterizerState *m_rastState = nullptr;
     ID3D11DepthStencilState *m_dsState = nullptr;
     ID3D11ShaderResourceView *m_texture[3] = {nullptr, nullptr, nullptr};
+    // The textures are kept while the size and format of the frames stay.
+    ID3D11Texture2D *m_planes[3] = {nullptr, nullptr, nullptr};
+    int m_planeWidth[3] = {0, 0, 0};
+    int m_planeHeight[3] = {0, 0, 0};
+    bool m_is16Bit[3] = {false, false, false};
 
     struct ConstantBuffer
     {
         int32_t colorspace;
+        float sampleScale;
+        int32_t transfer; // mlt_color_trc
+        int32_t viewport; // whether to reproject to the 360 viewport
+        float viewDirection[2]; // yaw and pitch in radians
+        float viewSize[2]; // the tangents of half of the field of view
     };
 
     ConstantBuffer m_constants;
@@ -522,19 +522,23 @@ void GlaxnimateIpcServer::onReadyRead()
             mlt_image_format format = mlt_image_rgb;
             const uchar *image = frame->get_image(format, width, height);
             if (image) {
-                QImage temp(width, height, QImage::Format_RGB888);
-                for (int i = 0; i < height; i++) {
-                    ::memcpy(temp.scanLine(i), &image[i * 3 * width], temp.bytesPerLine());
-                }
+                bool isCopied = false;
                 if (MLT.profile().sar() - 1.0 > 0.0001) {
                     // Use QImage to convert to square pixels
-                    width = qRound(width * MLT.profile().sar());
-                    temp = temp.scaled(width,
-                                       height,
-                                       Qt::IgnoreAspectRatio,
-                                       Qt::SmoothTransformation);
+                    QImage temp(image, width, height, 3 * width, QImage::Format_RGB888);
+                    isCopied = copyToShared(temp.scaled(qRound(width * MLT.profile().sar()),
+                                                        height,
+                                                        Qt::IgnoreAspectRatio,
+                                                        Qt::SmoothTransformation));
+                } else {
+                    // Copy straight from the MLT image into the shared memory.
+                    isCopied = copyToShared(image,
+                                            width,
+                                            height,
+                                            3 * width,
+                                            QImage::Format_RGB888);
                 }
-                if (copyToShared(temp)) {
+                if (isCopied) {
                     parent->m_frameNum = frameNum;
                 }
             }
@@ -561,11 +565,7 @@ void GlaxnimateIpcServer::onFrameDisplayed(const SharedFrame &frame)
     if (image) {
         auto width = frame.get_image_width();
         auto height = frame.get_image_height();
-        QImage temp(width, height, QImage::Format_RGB888);
-        for (int i = 0; i < height; i++) {
-            ::memcpy(temp.scanLine(i), &image[i * 3 * width], temp.bytesPerLine());
-        }
-        if (copyToShared(temp) && parent) {
+        if (copyToShared(image, width, height, 3 * width, QImage::Format_RGB888) && parent) {
             parent->m_frameNum = frame.get_position();
         }
     }
@@ -727,19 +727,35 @@ void GlaxnimateIpcServer::launch(const Mlt::Producer &producer,
 }
 
 bool GlaxnimateIpcServer::copyToShared(const QImage &image)
+{
+    return copyToShared(image.constBits(),
+                        image.width(),
+                        image.height(),
+                        image.bytesPerLine(),
+                        image.format());
+}
+
+bool GlaxnimateIpcServer::copyToShared(
+    const uchar *bits, int width, int height, int bytesPerLine, QImage::Format format)
 {
     if (!m_sharedMemory) {
         return false;
     }
-    qint32 sizeInBytes = image.sizeInBytes() + 4 * sizeof(qint32);
+    static const qint32 kHeaderSize = 4 * sizeof(qint32);
+    const qint64 imageSize = qint64(bytesPerLine) * height;
+    const qint64 sizeInBytes = imageSize + kHeaderSize;
     if (sizeInBytes > m_sharedMemory->size()) {
         if (m_sharedMemory->isAttached()) {
             m_sharedMemory->lock();
             m_sharedMemory->detach();
             m_sharedMemory->unlock();
         }
-        // over-allocate to avoid recreating
-        if (!m_sharedMemory->create(sizeInBytes)) {
+        // over-allocate for a full size RGBA frame to avoid recreating when the
+        // preview scale changes
+        const qint64 fullSize = qint64(qRound(MLT.profile().width() * MLT.profile().sar()))
+                                    * MLT.profile().height() * 4
+                                + kHeaderSize;
+        if (!m_sharedMemory->create(qMax(sizeInBytes, fullSize))) {
             LOG_WARNING() << m_sharedMemory->errorString();
             return false;
         }
@@ -749,27 +765,29 @@ bool GlaxnimateIpcServer::copyToShared(const QImage &image)
 
         uchar *to = (uchar *) m_sharedMemory->data();
         // Write the width of the image and move the pointer forward
-        qint32 width = image.width();
-        ::memcpy(to, &width, sizeof(width));
-        to += sizeof(width);
+        qint32 value = width;
+        ::memcpy(to, &value, sizeof(value));
+        to += sizeof(value);
 
         // Write the height of the image and move the pointer forward
-        qint32 height = image.height();
-        ::memcpy(to, &height, sizeof(height));
-        to += sizeof(height);
+        value = height;
+        ::memcpy(to, &value, sizeof(value));
+        to += sizeof(value);
 
         // Write the image format of the image and move the pointer forward
-        qint32 imageFormat = image.format();
-        ::memcpy(to, &imageFormat, sizeof(imageFormat));
-        to += sizeof(imageFormat);
+        value = format;
+        ::memcpy(to, &value, sizeof(value));
+        to += sizeof(value);
 
         // Write the bytes per line of the image and move the pointer forward
-        qint32 bytesPerLine = image.bytesPerLine();
-        ::memcpy(to, &bytesPerLine, sizeof(bytesPerLine));
-        to += sizeof(bytesPerLine);
+        value = bytesPerLine;
+        ::memcpy(to, &value, sizeof(value));
+        to += sizeof(value);
 
-        // Write the raw data of the image and move the pointer forward
-        ::memcpy(to, image.constBits(), image.sizeInBytes());
+        // Write the raw data of the image
+        if (bits && imageSize > 0) {
+            ::memcpy(to, bits, imageSize);
+        }
 
         m_sharedMemory->unlock();
         if (m_stream && m_socket) {
@@ -67,6 +67,8 @@ private slots:
 private:
     int toMltFps(float frame) const;
     bool copyToShared(const QImage &image);
+    bool copyToShared(
+        const uchar *bits, int width, int height, int bytesPerLine, QImage::Format format);
     SharedFrame m_sharedFrame;
 };
 
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2025 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -450,16 +450,9 @@ void ImageProducerWidget::on_actionMakeProxy_triggered()
 
 void ImageProducerWidget::on_actionDeleteProxy_triggered()
 {
-    // Delete the file if it exists
+    // Delete the files of every tier and those being made
     QString hash = Util::getHash(*producer());
-    QString fileName = hash + ProxyManager::imageFilenameExtension();
-    QDir dir = ProxyManager::dir();
-    LOG_DEBUG() << "removing" << dir.filePath(fileName);
-    dir.remove(dir.filePath(fileName));
-
-    // Delete the pending file if it exists));
-    fileName = hash + ProxyManager::pendingImageExtension();
-    dir.remove(dir.filePath(fileName));
+    ProxyManager::removeFiles(hash, true);
 
     // Replace with original
     if (producer()->get_int(kIsProxyProperty) && producer()->get(kOriginalResourceProperty)) {
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -33,6 +33,9 @@ public slots:
     virtual void initialize();
     virtual void renderVideo();
 
+protected:
+    bool canDisplayYuv420p10() const override { return true; }
+
 private:
     std::unique_ptr<MetalVideoRenderer> m_renderer;
 };
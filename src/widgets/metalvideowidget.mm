@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2023-2025 Meltytech, LLC
+ * Copyright (c) 2023-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,9 +18,24 @@
 #include "metalvideowidget.h"
 
 #include "Logger.h"
+#include "frametrace.h"
 
 #include <Metal/Metal.h>
+#include <QtMath>
 
+// Maps samples of 10 bits in the 16-bit textures onto the 8-bit video range.
+static const float kSampleScale10Bit = 65535.0f / 1020.0f;
+
+// Matches the buf struct of the fragment shader.
+struct MetalVideoUniforms
+{
+    int colorspace;
+    float sampleScale;
+    int transfer; // mlt_color_trc
+    int viewport; // whether to reproject to the 360 viewport
+    float viewDirection[2]; // yaw and pitch in radians
+    float viewSize[2]; // the tangents of half of the field of view
+};
 
 class MetalVideoRenderer : public QObject
 {
@@ -30,7 +45,8 @@ public:
     {
         for (int i = 0; i < 3; ++i) {
             m_ubuf[i] = nil;
-            m_texture[i] = nil;
+            for (int j = 0; j < 3; ++j)
+                m_texture[i][j] = nil;
         }
         m_vbuf = nil;
         m_vs.first = nil;
@@ -44,7 +60,8 @@ public:
         LOG_DEBUG() << "cleanup";
 
         for (int i = 0; i < 3; i++) {
-            [m_texture[i] release];
+            for (int j = 0; j < 3; j++)
+                [m_texture[i][j] release];
             [m_ubuf[i] release];
         }
         [m_vbuf release];
@@ -75,7 +92,7 @@ public:
         m_vbuf = [m_device newBufferWithLength: 16*sizeof(float) options: MTLResourceStorageModeShared];
 
         for (int i = 0; i < m_window->graphicsStateInfo().framesInFlight && i < 3; ++i)
-            m_ubuf[i] = [m_device newBufferWithLength: sizeof(int) options: MTLResourceStorageModeShared];
+            m_ubuf[i] = [m_device newBufferWithLength: sizeof(MetalVideoUniforms) options: MTLResourceStorageModeShared];
 
         MTLVertexDescriptor *inputLayout = [MTLVertexDescriptor vertexDescriptor];
         inputLayout.attributes[0].format = MTLVertexFormatFloat4;
@@ -110,7 +127,8 @@ public:
     }
 
     void render(const QSize& viewportSize, const QRectF& videoRect, const double devicePixelRatio,
-                const double zoom, const QPoint& offset, const SharedFrame& sharedFrame)
+                const double zoom, const QPoint& offset, const SharedFrame& sharedFrame,
+                const Mlt::VideoWidget::Viewport360& viewport)
     {
         const QQuickWindow::GraphicsStateInfo &stateInfo(m_window->graphicsStateInfo());
 
@@ -154,9 +172,21 @@ public:
         void *p = [m_vbuf contents];
         memcpy(p, vertexData, sizeof(vertexData));
 
+        // 10-bit video is uploaded as is and converted by the shader.
+        const bool is16Bit = sharedFrame.get_image_format() == mlt_image_yuv420p10;
         p = [m_ubuf[stateInfo.currentFrameSlot] contents];
-        int colorspace = MLT.profile().colorspace();
-        memcpy(p, &colorspace, sizeof(colorspace));
+        MetalVideoUniforms uniforms;
+        uniforms.colorspace = MLT.profile().colorspace();
+        uniforms.sampleScale = is16Bit ? kSampleScale10Bit : 1.0f;
+        uniforms.transfer = sharedFrame.get_int("color_trc");
+        // Only the viewport of a 360 video is sampled from the whole frame.
+        const float tanHalfFov = qTan(qDegreesToRadians(viewport.fov) / 2.0f);
+        uniforms.viewport = viewport.isEnabled ? 1 : 0;
+        uniforms.viewDirection[0] = qDegreesToRadians(viewport.yaw);
+        uniforms.viewDirection[1] = qDegreesToRadians(viewport.pitch);
+        uniforms.viewSize[0] = tanHalfFov * float(videoRect.width() / qMax(1.0, videoRect.height()));
+        uniforms.viewSize[1] = tanHalfFov;
+        memcpy(p, &uniforms, sizeof(uniforms));
 
         MTLViewport vp;
         vp.originX = 0;
@@ -167,22 +197,27 @@ public:
         vp.zfar = 1;
         [encoder setViewport: vp];
 
-        // (Re)create the textures
-        int iwidth = sharedFrame.get_image_width();
-        int iheight = sharedFrame.get_image_height();
-        const uint8_t *image = sharedFrame.get_image(mlt_image_yuv420p);
+        // Update the textures of this frame slot, which the GPU is done with. They
+        // are only made again for another size or format.
+        const auto view = sharedFrame.get_image_view(is16Bit ? mlt_image_yuv420p10
+                                                             : mlt_image_yuv420p);
+        const int slot = qBound(0, stateInfo.currentFrameSlot, 2);
+        id<MTLTexture> *textures = m_texture[slot];
+        if (view.planeCount != 3) {
+            m_window->endExternalCommands();
+            return;
+        }
         for (int i = 0; i < 3; i++) {
-            [m_texture[i] release];
+            const int divisor = i ? 2 : 1;
+            textures[i] = initTexture(textures[i], view.width / divisor, view.height / divisor,
+                                      is16Bit);
+            updateTexture(textures[i], view.planes[i], view.strides[i]);
         }
-        m_texture[0] = initTexture(image, iwidth, iheight);
-        m_texture[1] = initTexture(image + iwidth * iheight, iwidth / 2, iheight / 2);
-        m_texture[2] = initTexture(image + iwidth * iheight + iwidth / 2 * iheight / 2, iwidth / 2,
-                                   iheight / 2);
         // Set the texture object.  The AAPLTextureIndexBaseColor enum value corresponds
         ///  to the 'colorMap' argument in the 'samplingShader' function because its
         //   texture attribute qualifier also uses AAPLTextureIndexBaseColor for its index.
         for (NSUInteger i = 0; i < 3; i++) {
-            [encoder setFragmentTexture:m_texture[i] atIndex:i];
+            [encoder setFragmentTexture:textures[i] atIndex:i];
         }
 
 
@@ -194,25 +229,36 @@ public:
         m_window->endExternalCommands();
     }
 
-    id<MTLTexture> initTexture(const void *p, NSUInteger width, NSUInteger height)
+    // Returns \a texture if it has the size and format, or else a new one in its place.
+    id<MTLTexture> initTexture(id<MTLTexture> texture, NSUInteger width, NSUInteger height,
+                               bool is16Bit)
     {
-        MTLTextureDescriptor *textureDescriptor = [[MTLTextureDescriptor alloc] init];
+        // Unsigned normalized value (i.e. 0 maps to 0.0 and 255 or 65535 maps to 1.0)
+        const auto pixelFormat = is16Bit ? MTLPixelFormatR16Unorm : MTLPixelFormatR8Unorm;
+        if (texture && texture.width == width && texture.height == height
+            && texture.pixelFormat == pixelFormat)
+            return texture;
+        [texture release];
 
-        // 8-bit unsigned normalized value (i.e. 0 maps to 0.0 and 255 maps to 1.0)
-        textureDescriptor.pixelFormat = MTLPixelFormatR8Unorm;
+        MTLTextureDescriptor *textureDescriptor = [[MTLTextureDescriptor alloc] init];
+        textureDescriptor.pixelFormat = pixelFormat;
         textureDescriptor.width = width;
         textureDescriptor.height = height;
-        id<MTLTexture> texture = [m_device newTextureWithDescriptor:textureDescriptor];
+        textureDescriptor.usage = MTLTextureUsageShaderRead;
+        texture = [m_device newTextureWithDescriptor:textureDescriptor];
         [textureDescriptor release];
+        return texture;
+    }
 
+    void updateTexture(id<MTLTexture> texture, const void *p, NSUInteger bytesPerRow)
+    {
         MTLRegion region = {
             { 0, 0, 0 },  // MTLOrigin
-            {width, height, 1} // MTLSize
+            {texture.width, texture.height, 1} // MTLSize
         };
 
         // Copy the bytes from the data object into the texture
-        [texture replaceRegion:region mipmapLevel:0 withBytes:p bytesPerRow:width];
-        return texture;
+        [texture replaceRegion:region mipmapLevel:0 withBytes:p bytesPerRow:bytesPerRow];
     }
 
 private:
@@ -232,7 +278,8 @@ private:
     FuncAndLib m_vs;
     FuncAndLib m_fs;
     id<MTLRenderPipelineState> m_pipeline;
-    id<MTLTexture> m_texture[3];
+    // The plane textures of each frame in flight
+    id<MTLTexture> m_texture[3][3];
 
     void prepareShader(Stage stage)
     {
@@ -261,7 +308,53 @@ private:
                     "using namespace metal;"
                     "struct buf {"
                     "    int colorspace;"
+                    "    float sampleScale;"
+                    "    int transfer;"
+                    "    int viewport;"
+                    "    float2 viewDirection;"
+                    "    float2 viewSize;"
                     "};"
+                    // Maps a point of the 360 viewport to the equirectangular frame.
+                    "float2 equirectangular(float2 c, constant buf& ubuf) {"
+                    "    float3 ray = normalize(float3((2.0f * c.x - 1.0f) * ubuf.viewSize.x,"
+                    "                                  (1.0f - 2.0f * c.y) * ubuf.viewSize.y, 1.0f));"
+                    "    float cp = cos(ubuf.viewDirection.y);"
+                    "    float sp = sin(ubuf.viewDirection.y);"
+                    "    ray = float3(ray.x, ray.y * cp + ray.z * sp, ray.z * cp - ray.y * sp);"
+                    "    float cy = cos(ubuf.viewDirection.x);"
+                    "    float sy = sin(ubuf.viewDirection.x);"
+                    "    ray = float3(ray.x * cy + ray.z * sy, ray.y, ray.z * cy - ray.x * sy);"
+                    "    return float2(0.5f + atan2(ray.x, ray.z) / 6.2831853f,"
+                    "                  0.5f - asin(clamp(ray.y, -1.0f, 1.0f)) / 3.1415927f);"
+                    "}"
+                    // ITU-R BT.2100 HLG inverse OETF and OOTF for a 1000 nit display
+                    "float3 hlgToLinear(float3 e) {"
+                    "    float3 lo = e * e / 3.0f;"
+                    "    float3 hi = (exp((e - 0.55991073f) / 0.17883277f) + 0.28466892f) / 12.0f;"
+                    "    float3 scene = mix(lo, hi, step(0.5f, e));"
+                    "    float y = dot(scene, float3(0.2627f, 0.678f, 0.0593f));"
+                    "    return scene * pow(max(y, 0.000001f), 0.2f) * 1000.0f;"
+                    "}"
+                    // SMPTE ST 2084 (PQ) EOTF
+                    "float3 pqToLinear(float3 e) {"
+                    "    float3 p = pow(e, float3(1.0f / 78.84375f));"
+                    "    float3 l = max(p - 0.8359375f, 0.0f) / (18.8515625f - 18.6875f * p);"
+                    "    return pow(l, float3(1.0f / 0.1593017578125f)) * 10000.0f;"
+                    "}"
+                    // Tone maps to an SDR BT.709 display with reference white at 203 nits.
+                    "float3 toSdr(float3 e, int trc) {"
+                    "    e = saturate(e);"
+                    "    float3 l = (trc == 18 ? hlgToLinear(e) : pqToLinear(e)) / 203.0f;"
+                    "    float y = dot(l, float3(0.2627f, 0.678f, 0.0593f));"
+                    "    float peak = 1000.0f / 203.0f;"
+                    "    float mapped = y * (1.0f + y / (peak * peak)) / (1.0f + y);"
+                    "    l *= mapped / max(y, 0.000001f);"
+                    "    l = float3x3("
+                    "        {1.6605f, -0.1246f, -0.0182f},"
+                    "        {-0.5876f, 1.1329f, -0.1006f},"
+                    "        {-0.0728f, -0.0083f, 1.1187f}) * l;"
+                    "    return pow(saturate(l), float3(1.0f / 2.4f));"
+                    "}"
                     "struct main0_out {"
                     "    float4 fragColor [[color(0)]];"
                     "};"
@@ -275,10 +368,11 @@ private:
                     "      ) {"
                     "    main0_out out = {};"
                     "    constexpr sampler yuvSampler (mag_filter::linear, min_filter::linear);"
+                    "    float2 uv = ubuf.viewport != 0 ? equirectangular(in.coords, ubuf) : in.coords;"
                     "    float3 yuv;"
-                    "    yuv.x = yTex.sample(yuvSampler, in.coords).r -  16.0f/255.0f;"
-                    "    yuv.y = uTex.sample(yuvSampler, in.coords).r - 128.0f/255.0f;"
-                    "    yuv.z = vTex.sample(yuvSampler, in.coords).r - 128.0f/255.0f;"
+                    "    yuv.x = yTex.sample(yuvSampler, uv).r * ubuf.sampleScale -  16.0f/255.0f;"
+                    "    yuv.y = uTex.sample(yuvSampler, uv).r * ubuf.sampleScale - 128.0f/255.0f;"
+                    "    yuv.z = vTex.sample(yuvSampler, uv).r * ubuf.sampleScale - 128.0f/255.0f;"
                     "    float3x3 coefficients;"
                     "    if (ubuf.colorspace == 601) {"
                     "      coefficients = float3x3("
@@ -296,7 +390,10 @@ private:
                     "        {0.0f,   -0.213f,  2.112f},"
                     "        {1.793f, -0.533f,  0.0f});"
                     "    }"
-                    "    out.fragColor = float4(coefficients * yuv, 1.0f);"
+                    "    float3 rgb = coefficients * yuv;"
+                    "    if (ubuf.transfer == 16 || ubuf.transfer == 18)" // PQ or HLG
+                    "      rgb = toSdr(rgb, ubuf.transfer);"
+                    "    out.fragColor = float4(rgb, 1.0f);"
                     "    return out;"
                     "}";
             m_fragEntryPoint = QByteArrayLiteral("main0");
@@ -348,9 +445,16 @@ void MetalVideoWidget::initialize()
 
 void MetalVideoWidget::renderVideo()
 {
+    FrameTrace::Scope trace("MetalVideoWidget::renderVideo");
     m_mutex.lock();
     if (m_sharedFrame.is_valid()) {
-        m_renderer->render(size(), rect(), devicePixelRatio(), zoom(), offset(), m_sharedFrame);
+        m_renderer->render(size(),
+                           rect(),
+                           devicePixelRatio(),
+                           zoom(),
+                           offset(),
+                           m_sharedFrame,
+                           viewport360());
     }
     m_mutex.unlock();
     Mlt::VideoWidget::renderVideo();
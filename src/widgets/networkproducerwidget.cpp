@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2012-2018 Meltytech, LLC
+ * Copyright (c) 2012-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,8 +19,58 @@
 #include "ui_networkproducerwidget.h"
 
 #include "mltcontroller.h"
+#include "shotcut_mlt_properties.h"
 #include "util.h"
 
+#include <QUrl>
+#include <QUrlQuery>
+
+static const char *kLiveProperty = "shotcut:live";
+static const char *kLiveBufferProperty = "shotcut:liveBuffer";
+static const char *kReconnectProperty = "reconnect";
+static const int kDefaultBufferMs = 500;
+
+// FFmpeg reads these protocol options from the query of the URL. The times are in microseconds.
+static bool isLiveScheme(const QString &scheme)
+{
+    return scheme == "srt" || scheme == "udp" || scheme == "rtp" || scheme == "tcp";
+}
+
+static QString liveUrl(const QString &resource, int bufferMs)
+{
+    QUrl url(resource);
+    const auto scheme = url.scheme().toLower();
+    if (!isLiveScheme(scheme))
+        return resource;
+    QUrlQuery query(url);
+    const auto micros = QString::number(qint64(bufferMs) * 1000);
+    if (scheme == "srt") {
+        query.removeAllQueryItems("latency");
+        query.addQueryItem("latency", micros);
+    } else if (scheme == "udp" || scheme == "rtp") {
+        query.removeAllQueryItems("overrun_nonfatal");
+        query.addQueryItem("overrun_nonfatal", "1");
+    }
+    // A read that stalls this long fails, so that the producer can reconnect.
+    query.removeAllQueryItems("timeout");
+    query.addQueryItem("timeout", QString::number(qint64(bufferMs) * 1000 * 4));
+    url.setQuery(query);
+    return url.toString();
+}
+
+// Removes the options that liveUrl() added, so that they are not edited in the URL.
+static QString plainUrl(const QString &resource)
+{
+    QUrl url(resource);
+    if (!isLiveScheme(url.scheme().toLower()))
+        return resource;
+    QUrlQuery query(url);
+    for (const auto &key : {"latency", "overrun_nonfatal", "timeout"})
+        query.removeAllQueryItems(key);
+    url.setQuery(query.isEmpty() ? QString() : query.query());
+    return url.toString();
+}
+
 NetworkProducerWidget::NetworkProducerWidget(QWidget *parent)
     : QWidget(parent)
     , ui(new Ui::NetworkProducerWidget)
@@ -28,6 +78,10 @@ NetworkProducerWidget::NetworkProducerWidget(QWidget *parent)
     ui->setupUi(this);
     Util::setColorsToHighlight(ui->label_2);
     ui->applyButton->hide();
+    connect(ui->liveCheckBox, &QCheckBox::toggled, ui->bufferSpinBox, &QWidget::setEnabled);
+    connect(ui->liveCheckBox, &QCheckBox::toggled, ui->reconnectCheckBox, &QWidget::setEnabled);
+    ui->bufferSpinBox->setEnabled(false);
+    ui->reconnectCheckBox->setEnabled(false);
     ui->preset->saveDefaultPreset(getPreset());
     ui->preset->loadPresets();
 }
@@ -39,7 +93,19 @@ NetworkProducerWidget::~NetworkProducerWidget()
 
 Mlt::Producer *NetworkProducerWidget::newProducer(Mlt::Profile &profile)
 {
-    Mlt::Producer *p = new Mlt::Producer(profile, ui->urlLineEdit->text().toUtf8().constData());
+    const auto live = ui->liveCheckBox->isChecked();
+    auto resource = ui->urlLineEdit->text();
+    if (live)
+        resource = liveUrl(resource, ui->bufferSpinBox->value());
+    Mlt::Producer *p = new Mlt::Producer(profile, resource.toUtf8().constData());
+    if (p->is_valid() && live) {
+        p->set(kLiveProperty, 1);
+        p->set(kLiveBufferProperty, ui->bufferSpinBox->value());
+        // The avformat producer reopens a stream that is not seekable after a read error.
+        p->set(kReconnectProperty, ui->reconnectCheckBox->isChecked());
+        // Capturing in a separate job keeps stalls of the network out of the player.
+        p->set(kBackgroundCaptureProperty, 1);
+    }
     return p;
 }
 
@@ -47,14 +113,27 @@ Mlt::Properties NetworkProducerWidget::getPreset() const
 {
     Mlt::Properties p;
     p.set("resource", ui->urlLineEdit->text().toUtf8().constData());
+    p.set(kLiveProperty, ui->liveCheckBox->isChecked());
+    p.set(kLiveBufferProperty, ui->bufferSpinBox->value());
+    p.set(kReconnectProperty, ui->reconnectCheckBox->isChecked());
     return p;
 }
 
 void NetworkProducerWidget::loadPreset(Mlt::Properties &p)
 {
     const char *resource = p.get("resource");
-    if (qstrcmp(resource, "<tractor>") && qstrcmp(resource, "<playlist>"))
-        ui->urlLineEdit->setText(resource);
+    if (qstrcmp(resource, "<tractor>") && qstrcmp(resource, "<playlist>")) {
+        const auto live = p.get_int(kLiveProperty) != 0;
+        ui->urlLineEdit->setText(live ? plainUrl(QString::fromUtf8(resource))
+                                      : QString::fromUtf8(resource));
+        ui->liveCheckBox->setChecked(live);
+        if (p.property_exists(kLiveBufferProperty))
+            ui->bufferSpinBox->setValue(p.get_int(kLiveBufferProperty));
+        else
+            ui->bufferSpinBox->setValue(kDefaultBufferMs);
+        ui->reconnectCheckBox->setChecked(!p.property_exists(kReconnectProperty)
+                                          || p.get_int(kReconnectProperty));
+    }
 }
 
 void NetworkProducerWidget::on_preset_selected(void *p)
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2025 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -27,11 +27,14 @@
 #include "util.h"
 
 #include <QActionGroup>
+#include <QCursor>
 #include <QDir>
 #include <QFileDialog>
 #include <QFileInfo>
+#include <QHelpEvent>
 #include <QListWidgetItem>
 #include <QMessageBox>
+#include <QToolTip>
 
 NewProjectFolder::NewProjectFolder(QWidget *parent)
     : QWidget(parent)
@@ -46,6 +49,15 @@ NewProjectFolder::NewProjectFolder(QWidget *parent)
     connect(m_profileGroup, SIGNAL(triggered(QAction *)), SLOT(onProfileTriggered(QAction *)));
     ui->label->setToolTip(ui->projectsFolderButton->toolTip());
     ui->label_2->setToolTip(ui->projectNameLineEdit->toolTip());
+    ui->recentListView->viewport()->installEventFilter(this);
+    connect(&RECENT_FILES,
+            &RecentFileCache::stateChanged,
+            this,
+            &NewProjectFolder::onStateChanged);
+    connect(&RECENT_FILES,
+            &RecentFileCache::previewChanged,
+            this,
+            &NewProjectFolder::onPreviewChanged);
 }
 
 NewProjectFolder::~NewProjectFolder()
@@ -119,11 +131,55 @@ void NewProjectFolder::updateRecentProjects()
         if (!s.isEmpty()) {
             QStandardItem *item = new QStandardItem(Util::baseName(s));
             item->setToolTip(QDir::toNativeSeparators(s));
+            setItemState(item, RECENT_FILES.state(s));
             m_model.appendRow(item);
         }
     }
 }
 
+bool NewProjectFolder::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->recentListView->viewport() && event->type() == QEvent::ToolTip) {
+        auto helpEvent = static_cast<QHelpEvent *>(event);
+        auto index = ui->recentListView->indexAt(helpEvent->pos());
+        if (index.isValid()) {
+            m_toolTipPath = QDir::fromNativeSeparators(index.data(Qt::ToolTipRole).toString());
+            QToolTip::showText(helpEvent->globalPos(),
+                               RECENT_FILES.toolTip(m_toolTipPath),
+                               ui->recentListView->viewport(),
+                               ui->recentListView->visualRect(index));
+            return true;
+        }
+    }
+    return QWidget::eventFilter(watched, event);
+}
+
+void NewProjectFolder::setItemState(QStandardItem *item, RecentFileCache::State state)
+{
+    if (state == RecentFileCache::Missing || state == RecentFileCache::Unreachable)
+        item->setForeground(palette().brush(QPalette::Disabled, QPalette::Text));
+    else
+        item->setData(QVariant(), Qt::ForegroundRole);
+}
+
+void NewProjectFolder::onStateChanged(const QString &path, RecentFileCache::State state)
+{
+    const auto toolTip = QDir::toNativeSeparators(path);
+    for (int row = 0; row < m_model.rowCount(); ++row) {
+        auto item = m_model.item(row);
+        if (item->toolTip() == toolTip)
+            setItemState(item, state);
+    }
+}
+
+void NewProjectFolder::onPreviewChanged(const QString &path)
+{
+    if (path == m_toolTipPath && QToolTip::isVisible())
+        QToolTip::showText(QCursor::pos(),
+                           RECENT_FILES.toolTip(path),
+                           ui->recentListView->viewport());
+}
+
 void NewProjectFolder::on_projectsFolderButton_clicked()
 {
     QString dirName = QFileDialog::getExistingDirectory(this,
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2018-2024 Meltytech, LLC
+ * Copyright (c) 2018-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,8 @@
 #ifndef NEWPROJECTFOLDER_H
 #define NEWPROJECTFOLDER_H
 
+#include "recentfilecache.h"
+
 #include <QMenu>
 #include <QModelIndex>
 #include <QStandardItemModel>
@@ -43,6 +45,7 @@ protected:
     void showEvent(QShowEvent *);
     void hideEvent(QHideEvent *);
     bool event(QEvent *event);
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 public slots:
     void updateRecentProjects();
@@ -73,8 +76,13 @@ private slots:
 
     void on_actionRecentRemove_triggered();
 
+    void onStateChanged(const QString &path, RecentFileCache::State state);
+
+    void onPreviewChanged(const QString &path);
+
 private:
     void setColors();
+    void setItemState(QStandardItem *item, RecentFileCache::State state);
     void setProjectFolderButtonText(const QString &text);
 
     Ui::NewProjectFolder *ui;
@@ -84,6 +92,7 @@ private:
     QString m_profile;
     QStandardItemModel m_model;
     QString m_projectName;
+    QString m_toolTipPath;
     bool m_isOpening;
 };
 
@@ -1,378 +1,591 @@
-/*
- * Copyright (c) 2011-2025 Meltytech, LLC
- *
- * Some GL shader based on BSD licensed code from Peter Bengtsson:
- * http://www.fourcc.org/source/YUV420P-OpenGL-GLSLang.c
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#include "openglvideowidget.h"
-
-#include "Logger.h"
-
-#include <utility>
-#include <QOpenGLFunctions_1_1>
-#include <QOpenGLFunctions_3_2_Core>
-#include <QOpenGLVersionFunctionsFactory>
-
-#ifdef QT_NO_DEBUG
-#define check_error(fn) \
-    {}
-#else
-#define check_error(fn) \
-    { \
-        int err = fn->glGetError(); \
-        if (err != GL_NO_ERROR) { \
-            LOG_ERROR() << "GL error" << Qt::hex << err << Qt::dec << "at" << __FILE__ << ":" \
-                        << __LINE__; \
-        } \
-    }
-#endif
-
-OpenGLVideoWidget::OpenGLVideoWidget(QObject *parent)
-    : VideoWidget{parent}
-    , m_quickContext(nullptr)
-    , m_isThreadedOpenGL(false)
-{
-    m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
-    m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
-}
-
-OpenGLVideoWidget::~OpenGLVideoWidget()
-{
-    LOG_DEBUG() << "begin";
-    if (m_renderTexture[0] && m_displayTexture[0] && m_context) {
-        m_context->makeCurrent(&m_offscreenSurface);
-        m_context->functions()->glDeleteTextures(3, m_renderTexture);
-        if (m_displayTexture[0] && m_displayTexture[1] && m_displayTexture[2])
-            m_context->functions()->glDeleteTextures(3, m_displayTexture);
-        m_context->doneCurrent();
-    }
-}
-
-void OpenGLVideoWidget::initialize()
-{
-    LOG_DEBUG() << "begin";
-    auto context = static_cast<QOpenGLContext *>(
-        quickWindow()->rendererInterface()->getResource(quickWindow(),
-                                                        QSGRendererInterface::OpenGLContextResource));
-    m_quickContext = context;
-
-    if (!m_offscreenSurface.isValid()) {
-        m_offscreenSurface.setFormat(context->format());
-        m_offscreenSurface.create();
-    }
-    Q_ASSERT(m_offscreenSurface.isValid());
-
-    initializeOpenGLFunctions();
-    LOG_INFO() << "OpenGL vendor" << QString::fromUtf8((const char *) glGetString(GL_VENDOR));
-    LOG_INFO() << "OpenGL renderer" << QString::fromUtf8((const char *) glGetString(GL_RENDERER));
-    LOG_INFO() << "OpenGL threaded?" << context->supportsThreadedOpenGL();
-    LOG_INFO() << "OpenGL ES?" << context->isOpenGLES();
-    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
-    LOG_INFO() << "OpenGL maximum texture size =" << m_maxTextureSize;
-    GLint dims[2];
-    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, &dims[0]);
-    LOG_INFO() << "OpenGL maximum viewport size =" << dims[0] << "x" << dims[1];
-
-    createShader();
-
-    LOG_DEBUG() << "end";
-    Mlt::VideoWidget::initialize();
-}
-
-void OpenGLVideoWidget::createShader()
-{
-    m_shader.reset(new QOpenGLShaderProgram);
-    m_shader->addShaderFromSourceCode(QOpenGLShader::Vertex,
-                                      "uniform highp mat4 projection;"
-                                      "uniform highp mat4 modelView;"
-                                      "attribute highp vec4 vertex;"
-                                      "attribute highp vec2 texCoord;"
-                                      "varying highp vec2 coordinates;"
-                                      "void main(void) {"
-                                      "  gl_Position = projection * modelView * vertex;"
-                                      "  coordinates = texCoord;"
-                                      "}");
-    m_shader
-        ->addShaderFromSourceCode(QOpenGLShader::Fragment,
-                                  "uniform sampler2D Ytex, Utex, Vtex;"
-                                  "uniform lowp int colorspace;"
-                                  "varying highp vec2 coordinates;"
-                                  "void main(void) {"
-                                  "  mediump vec3 texel;"
-                                  "  texel.r = texture2D(Ytex, coordinates).r -  16.0/255.0;" // Y
-                                  "  texel.g = texture2D(Utex, coordinates).r - 128.0/255.0;" // U
-                                  "  texel.b = texture2D(Vtex, coordinates).r - 128.0/255.0;" // V
-                                  "  mediump mat3 coefficients;"
-                                  "  if (colorspace == 601) {"
-                                  "    coefficients = mat3("
-                                  "      1.1643,  1.1643,  1.1643,"    // column 1
-                                  "      0.0,    -0.39173, 2.017,"     // column 2
-                                  "      1.5958, -0.8129,  0.0);"      // column 3
-                                  "  } else if (colorspace == 2020) {" // ITU-R BT.2020
-                                  "    coefficients = mat3("
-                                  "      1.1643, 1.1643, 1.1643," // column 1
-                                  "      0.0,   -0.1873, 2.1418," // column 2
-                                  "      1.7167, -0.6504, 0.0);"  // column 3
-                                  "  } else {"                    // ITU-R 709
-                                  "    coefficients = mat3("
-                                  "      1.1643, 1.1643, 1.1643," // column 1
-                                  "      0.0,   -0.213,  2.112,"  // column 2
-                                  "      1.793, -0.533,  0.0);"   // column 3
-                                  "  }"
-                                  "  gl_FragColor = vec4(coefficients * texel, 1.0);"
-                                  "}");
-    m_shader->link();
-    m_textureLocation[0] = m_shader->uniformLocation("Ytex");
-    m_textureLocation[1] = m_shader->uniformLocation("Utex");
-    m_textureLocation[2] = m_shader->uniformLocation("Vtex");
-    m_colorspaceLocation = m_shader->uniformLocation("colorspace");
-    m_projectionLocation = m_shader->uniformLocation("projection");
-    m_modelViewLocation = m_shader->uniformLocation("modelView");
-    m_vertexLocation = m_shader->attributeLocation("vertex");
-    m_texCoordLocation = m_shader->attributeLocation("texCoord");
-}
-
-static void uploadTextures(QOpenGLContext *context, const SharedFrame &frame, GLuint texture[])
-{
-    int width = frame.get_image_width();
-    int height = frame.get_image_height();
-    const uint8_t *image = frame.get_image(mlt_image_yuv420p);
-    QOpenGLFunctions *f = context->functions();
-
-    // The planes of pixel data may not be a multiple of the default 4 bytes.
-    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
-
-    // Upload each plane of YUV to a texture.
-    if (texture[0])
-        f->glDeleteTextures(3, texture);
-    check_error(f);
-    f->glGenTextures(3, texture);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[0]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D,
-                    0,
-                    GL_LUMINANCE,
-                    width,
-                    height,
-                    0,
-                    GL_LUMINANCE,
-                    GL_UNSIGNED_BYTE,
-                    image);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[1]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D,
-                    0,
-                    GL_LUMINANCE,
-                    width / 2,
-                    height / 2,
-                    0,
-                    GL_LUMINANCE,
-                    GL_UNSIGNED_BYTE,
-                    image + width * height);
-    check_error(f);
-
-    f->glBindTexture(GL_TEXTURE_2D, texture[2]);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
-    check_error(f);
-    f->glTexImage2D(GL_TEXTURE_2D,
-                    0,
-                    GL_LUMINANCE,
-                    width / 2,
-                    height / 2,
-                    0,
-                    GL_LUMINANCE,
-                    GL_UNSIGNED_BYTE,
-                    image + width * height + width / 2 * height / 2);
-    check_error(f);
-}
-
-void OpenGLVideoWidget::renderVideo()
-{
-    auto context = static_cast<QOpenGLContext *>(
-        quickWindow()->rendererInterface()->getResource(quickWindow(),
-                                                        QSGRendererInterface::OpenGLContextResource));
-    if (!m_quickContext) {
-        LOG_ERROR() << "No quickContext";
-        return;
-    }
-    if (!context->isValid()) {
-        LOG_ERROR() << "No QSGRendererInterface::OpenGLContextResource";
-        return;
-    }
-
-#ifndef QT_NO_DEBUG
-    QOpenGLFunctions *f = context->functions();
-#endif
-    float width = this->width() * devicePixelRatioF();
-    float height = this->height() * devicePixelRatioF();
-
-    glDisable(GL_BLEND);
-    glDisable(GL_DEPTH_TEST);
-    glDepthMask(GL_FALSE);
-    glViewport(0, 0, width, height);
-    check_error(f);
-
-    if (!m_isThreadedOpenGL) {
-        m_mutex.lock();
-        if (!m_sharedFrame.is_valid()) {
-            m_mutex.unlock();
-            return;
-        }
-        uploadTextures(context, m_sharedFrame, m_displayTexture);
-        m_mutex.unlock();
-    }
-
-    if (!m_displayTexture[0]) {
-        return;
-    }
-
-    quickWindow()->beginExternalCommands();
-
-    // Bind textures.
-    for (int i = 0; i < 3; ++i) {
-        if (m_displayTexture[i]) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            glBindTexture(GL_TEXTURE_2D, m_displayTexture[i]);
-            check_error(f);
-        }
-    }
-
-    // Init shader program.
-    m_shader->bind();
-    m_shader->setUniformValue(m_textureLocation[0], 0);
-    m_shader->setUniformValue(m_textureLocation[1], 1);
-    m_shader->setUniformValue(m_textureLocation[2], 2);
-    m_shader->setUniformValue(m_colorspaceLocation, MLT.profile().colorspace());
-    check_error(f);
-
-    // Setup an orthographic projection.
-    QMatrix4x4 projection;
-    projection.scale(2.0f / width, 2.0f / height);
-    m_shader->setUniformValue(m_projectionLocation, projection);
-    check_error(f);
-
-    // Set model view.
-    QMatrix4x4 modelView;
-    if (rect().width() > 0.0 && zoom() > 0.0) {
-        if (offset().x() || offset().y())
-            modelView.translate(-offset().x() * devicePixelRatioF(),
-                                offset().y() * devicePixelRatioF());
-        modelView.scale(zoom(), zoom());
-    }
-    m_shader->setUniformValue(m_modelViewLocation, modelView);
-    check_error(f);
-
-    // Provide vertices of triangle strip.
-    QVector<QVector2D> vertices;
-    width = rect().width() * devicePixelRatioF();
-    height = rect().height() * devicePixelRatioF();
-    vertices << QVector2D(-width / 2.0f, -height / 2.0f);
-    vertices << QVector2D(-width / 2.0f, height / 2.0f);
-    vertices << QVector2D(width / 2.0f, -height / 2.0f);
-    vertices << QVector2D(width / 2.0f, height / 2.0f);
-    m_shader->enableAttributeArray(m_vertexLocation);
-    check_error(f);
-    m_shader->setAttributeArray(m_vertexLocation, vertices.constData());
-    check_error(f);
-
-    // Provide texture coordinates.
-    QVector<QVector2D> texCoord;
-    texCoord << QVector2D(0.0f, 1.0f);
-    texCoord << QVector2D(0.0f, 0.0f);
-    texCoord << QVector2D(1.0f, 1.0f);
-    texCoord << QVector2D(1.0f, 0.0f);
-    m_shader->enableAttributeArray(m_texCoordLocation);
-    check_error(f);
-    m_shader->setAttributeArray(m_texCoordLocation, texCoord.constData());
-    check_error(f);
-
-    // Render
-    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices.size());
-    check_error(f);
-
-    // Cleanup
-    m_shader->disableAttributeArray(m_vertexLocation);
-    m_shader->disableAttributeArray(m_texCoordLocation);
-    m_shader->release();
-    for (int i = 0; i < 3; ++i) {
-        if (m_displayTexture[i]) {
-            glActiveTexture(GL_TEXTURE0 + i);
-            glBindTexture(GL_TEXTURE_2D, 0);
-            check_error(f);
-        }
-    }
-    glActiveTexture(GL_TEXTURE0);
-    check_error(f);
-
-    quickWindow()->endExternalCommands();
-    Mlt::VideoWidget::renderVideo();
-}
-
-void OpenGLVideoWidget::onFrameDisplayed(const SharedFrame &frame)
-{
-    if (m_isThreadedOpenGL && !m_context) {
-        m_context.reset(new QOpenGLContext);
-        if (m_context) {
-            m_context->setFormat(m_quickContext->format());
-            m_context->setShareContext(m_quickContext);
-            m_context->create();
-        }
-    }
-    if (m_context && m_context->isValid()) {
-        // Using threaded OpenGL to upload textures.
-        QOpenGLFunctions *f = m_context->functions();
-        m_context->makeCurrent(&m_offscreenSurface);
-        uploadTextures(m_context.get(), frame, m_renderTexture);
-        f->glBindTexture(GL_TEXTURE_2D, 0);
-        check_error(f);
-        f->glFinish();
-        m_context->doneCurrent();
-
-        m_mutex.lock();
-        for (int i = 0; i < 3; ++i)
-            std::swap(m_renderTexture[i], m_displayTexture[i]);
-        m_mutex.unlock();
-    }
-    Mlt::VideoWidget::onFrameDisplayed(frame);
-}
+/*
+ * Copyright (c) 2011-2026 Meltytech, LLC
+ *
+ * Some GL shader based on BSD licensed code from Peter Bengtsson:
+ * http://www.fourcc.org/source/YUV420P-OpenGL-GLSLang.c
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "openglvideowidget.h"
+
+#include "Logger.h"
+#include "frametrace.h"
+
+#include <cstring>
+#include <utility>
+#include <QOpenGLFunctions_1_1>
+#include <QOpenGLFunctions_3_2_Core>
+#include <QOpenGLVersionFunctionsFactory>
+#include <QtMath>
+
+#ifdef QT_NO_DEBUG
+#define check_error(fn) \
+    {}
+#else
+#define check_error(fn) \
+    { \
+        int err = fn->glGetError(); \
+        if (err != GL_NO_ERROR) { \
+            LOG_ERROR() << "GL error" << Qt::hex << err << Qt::dec << "at" << __FILE__ << ":" \
+                        << __LINE__; \
+        } \
+    }
+#endif
+
+#ifndef GL_LUMINANCE16
+#define GL_LUMINANCE16 0x8042
+#endif
+
+// Maps samples of 10 bits in the 16-bit textures onto the 8-bit video range.
+static const float kSampleScale10Bit = 65535.0f / 1020.0f;
+
+OpenGLVideoWidget::OpenGLVideoWidget(QObject *parent)
+    : VideoWidget{parent}
+    , m_quickContext(nullptr)
+    , m_isThreadedOpenGL(false)
+    , m_canUpload16Bit(false)
+    , m_pixelBufferIndex(0)
+    , m_canStreamUpload(false)
+    , m_canFence(false)
+    , m_displayFence(nullptr)
+    , m_renderFence(nullptr)
+{
+    m_renderTexture[0] = m_renderTexture[1] = m_renderTexture[2] = 0;
+    m_displayTexture[0] = m_displayTexture[1] = m_displayTexture[2] = 0;
+    for (int i = 0; i < kPixelBufferCount; ++i)
+        m_pixelBuffers[i] = 0;
+}
+
+OpenGLVideoWidget::~OpenGLVideoWidget()
+{
+    LOG_DEBUG() << "begin";
+    if (m_renderTexture[0] && m_displayTexture[0] && m_context) {
+        m_context->makeCurrent(&m_offscreenSurface);
+        m_context->functions()->glDeleteTextures(3, m_renderTexture);
+        if (m_displayTexture[0] && m_displayTexture[1] && m_displayTexture[2])
+            m_context->functions()->glDeleteTextures(3, m_displayTexture);
+        if (m_pixelBuffers[0])
+            m_context->functions()->glDeleteBuffers(kPixelBufferCount, m_pixelBuffers);
+        if (m_displayFence)
+            m_context->extraFunctions()->glDeleteSync(m_displayFence);
+        if (m_renderFence)
+            m_context->extraFunctions()->glDeleteSync(m_renderFence);
+        m_gpuScopes.reset();
+        m_context->doneCurrent();
+    }
+}
+
+void OpenGLVideoWidget::initialize()
+{
+    LOG_DEBUG() << "begin";
+    auto context = static_cast<QOpenGLContext *>(
+        quickWindow()->rendererInterface()->getResource(quickWindow(),
+                                                        QSGRendererInterface::OpenGLContextResource));
+    m_quickContext = context;
+
+    if (!m_offscreenSurface.isValid()) {
+        m_offscreenSurface.setFormat(context->format());
+        m_offscreenSurface.create();
+    }
+    Q_ASSERT(m_offscreenSurface.isValid());
+
+    initializeOpenGLFunctions();
+    LOG_INFO() << "OpenGL vendor" << QString::fromUtf8((const char *) glGetString(GL_VENDOR));
+    LOG_INFO() << "OpenGL renderer" << QString::fromUtf8((const char *) glGetString(GL_RENDERER));
+    LOG_INFO() << "OpenGL threaded?" << context->supportsThreadedOpenGL();
+    LOG_INFO() << "OpenGL ES?" << context->isOpenGLES();
+    glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
+    LOG_INFO() << "OpenGL maximum texture size =" << m_maxTextureSize;
+    GLint dims[2];
+    glGetIntegerv(GL_MAX_VIEWPORT_DIMS, &dims[0]);
+    LOG_INFO() << "OpenGL maximum viewport size =" << dims[0] << "x" << dims[1];
+    m_canUpload16Bit = !context->isOpenGLES();
+
+    createShader();
+
+    LOG_DEBUG() << "end";
+    Mlt::VideoWidget::initialize();
+}
+
+void OpenGLVideoWidget::createShader()
+{
+    m_shader.reset(new QOpenGLShaderProgram);
+    m_shader->addShaderFromSourceCode(QOpenGLShader::Vertex,
+                                      "uniform highp mat4 projection;"
+                                      "uniform highp mat4 modelView;"
+                                      "attribute highp vec4 vertex;"
+                                      "attribute highp vec2 texCoord;"
+                                      "varying highp vec2 coordinates;"
+                                      "void main(void) {"
+                                      "  gl_Position = projection * modelView * vertex;"
+                                      "  coordinates = texCoord;"
+                                      "}");
+    m_shader
+        ->addShaderFromSourceCode(QOpenGLShader::Fragment,
+                                  "uniform sampler2D Ytex, Utex, Vtex;"
+                                  "uniform lowp int colorspace;"
+                                  "uniform mediump float sampleScale;"
+                                  "uniform lowp int transfer;"
+                                  "uniform lowp int viewport;"
+                                  "uniform highp vec2 viewDirection;"
+                                  "uniform highp vec2 viewSize;"
+                                  "varying highp vec2 coordinates;"
+                                  // ITU-R BT.2100 HLG inverse OETF and OOTF for a 1000 nit display
+                                  "mediump vec3 hlgToLinear(mediump vec3 e) {"
+                                  "  mediump vec3 lo = e * e / 3.0;"
+                                  "  mediump vec3 hi = (exp((e - 0.55991073) / 0.17883277) + 0.28466892) / 12.0;"
+                                  "  mediump vec3 scene = mix(lo, hi, step(0.5, e));"
+                                  "  mediump float y = dot(scene, vec3(0.2627, 0.678, 0.0593));"
+                                  "  return scene * pow(max(y, 0.000001), 0.2) * 1000.0;"
+                                  "}"
+                                  // SMPTE ST 2084 (PQ) EOTF
+                                  "mediump vec3 pqToLinear(mediump vec3 e) {"
+                                  "  mediump vec3 p = pow(e, vec3(1.0 / 78.84375));"
+                                  "  mediump vec3 l = max(p - 0.8359375, 0.0) / (18.8515625 - 18.6875 * p);"
+                                  "  return pow(l, vec3(1.0 / 0.1593017578125)) * 10000.0;"
+                                  "}"
+                                  // Tone maps to an SDR BT.709 display with reference white at 203 nits.
+                                  "mediump vec3 toSdr(mediump vec3 e, lowp int trc) {"
+                                  "  e = clamp(e, 0.0, 1.0);"
+                                  "  mediump vec3 l = (trc == 18 ? hlgToLinear(e) : pqToLinear(e)) / 203.0;"
+                                  "  mediump float y = dot(l, vec3(0.2627, 0.678, 0.0593));"
+                                  "  mediump float peak = 1000.0 / 203.0;"
+                                  "  mediump float mapped = y * (1.0 + y / (peak * peak)) / (1.0 + y);"
+                                  "  l *= mapped / max(y, 0.000001);"
+                                  "  l = mat3(1.6605, -0.1246, -0.0182,"    // column 1
+                                  "           -0.5876, 1.1329, -0.1006,"    // column 2
+                                  "           -0.0728, -0.0083, 1.1187) * l;" // column 3
+                                  "  return pow(clamp(l, 0.0, 1.0), vec3(1.0 / 2.4));"
+                                  "}"
+                                  // Maps a point of the 360 viewport to the equirectangular frame.
+                                  "highp vec2 equirectangular(highp vec2 c) {"
+                                  "  highp vec3 ray = normalize(vec3((2.0 * c.x - 1.0) * viewSize.x,"
+                                  "                                  (1.0 - 2.0 * c.y) * viewSize.y, 1.0));"
+                                  "  highp float cp = cos(viewDirection.y);"
+                                  "  highp float sp = sin(viewDirection.y);"
+                                  "  ray = vec3(ray.x, ray.y * cp + ray.z * sp, ray.z * cp - ray.y * sp);"
+                                  "  highp float cy = cos(viewDirection.x);"
+                                  "  highp float sy = sin(viewDirection.x);"
+                                  "  ray = vec3(ray.x * cy + ray.z * sy, ray.y, ray.z * cy - ray.x * sy);"
+                                  "  return vec2(0.5 + atan(ray.x, ray.z) / 6.2831853,"
+                                  "              0.5 - asin(clamp(ray.y, -1.0, 1.0)) / 3.1415927);"
+                                  "}"
+                                  "void main(void) {"
+                                  "  highp vec2 uv = viewport != 0 ? equirectangular(coordinates) : coordinates;"
+                                  "  mediump vec3 texel;"
+                                  "  texel.r = texture2D(Ytex, uv).r * sampleScale -  16.0/255.0;" // Y
+                                  "  texel.g = texture2D(Utex, uv).r * sampleScale - 128.0/255.0;" // U
+                                  "  texel.b = texture2D(Vtex, uv).r * sampleScale - 128.0/255.0;" // V
+                                  "  mediump mat3 coefficients;"
+                                  "  if (colorspace == 601) {"
+                                  "    coefficients = mat3("
+                                  "      1.1643,  1.1643,  1.1643,"    // column 1
+                                  "      0.0,    -0.39173, 2.017,"     // column 2
+                                  "      1.5958, -0.8129,  0.0);"      // column 3
+                                  "  } else if (colorspace == 2020) {" // ITU-R BT.2020
+                                  "    coefficients = mat3("
+                                  "      1.1643, 1.1643, 1.1643," // column 1
+                                  "      0.0,   -0.1873, 2.1418," // column 2
+                                  "      1.7167, -0.6504, 0.0);"  // column 3
+                                  "  } else {"                    // ITU-R 709
+                                  "    coefficients = mat3("
+                                  "      1.1643, 1.1643, 1.1643," // column 1
+                                  "      0.0,   -0.213,  2.112,"  // column 2
+                                  "      1.793, -0.533,  0.0);"   // column 3
+                                  "  }"
+                                  "  mediump vec3 rgb = coefficients * texel;"
+                                  "  if (transfer == 16 || transfer == 18)" // PQ or HLG
+                                  "    rgb = toSdr(rgb, transfer);"
+                                  "  gl_FragColor = vec4(rgb, 1.0);"
+                                  "}");
+    m_shader->link();
+    m_textureLocation[0] = m_shader->uniformLocation("Ytex");
+    m_textureLocation[1] = m_shader->uniformLocation("Utex");
+    m_textureLocation[2] = m_shader->uniformLocation("Vtex");
+    m_colorspaceLocation = m_shader->uniformLocation("colorspace");
+    m_sampleScaleLocation = m_shader->uniformLocation("sampleScale");
+    m_transferLocation = m_shader->uniformLocation("transfer");
+    m_viewportLocation = m_shader->uniformLocation("viewport");
+    m_viewDirectionLocation = m_shader->uniformLocation("viewDirection");
+    m_viewSizeLocation = m_shader->uniformLocation("viewSize");
+    m_projectionLocation = m_shader->uniformLocation("projection");
+    m_modelViewLocation = m_shader->uniformLocation("modelView");
+    m_vertexLocation = m_shader->attributeLocation("vertex");
+    m_texCoordLocation = m_shader->attributeLocation("texCoord");
+}
+
+static void allocateTexture(
+    QOpenGLFunctions *f, GLuint texture, int width, int height, bool is16Bit)
+{
+    f->glBindTexture(GL_TEXTURE_2D, texture);
+    check_error(f);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    check_error(f);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    check_error(f);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    check_error(f);
+    f->glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    check_error(f);
+    f->glTexImage2D(GL_TEXTURE_2D,
+                    0,
+                    is16Bit ? GL_LUMINANCE16 : GL_LUMINANCE,
+                    width,
+                    height,
+                    0,
+                    GL_LUMINANCE,
+                    is16Bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
+                    nullptr);
+    check_error(f);
+}
+
+/*
+ * Uploads the YUV 4:2:0 image of frame into the three textures. They are only
+ * allocated when their format does not match, otherwise their contents are
+ * replaced. With a pixel buffer, the image is copied into it and the textures
+ * are updated from it, which the driver may do after this returns. An image of
+ * 10 bits is uploaded as is into 16-bit textures when can16Bit is true, and the
+ * shader converts it.
+ */
+static void uploadTextures(QOpenGLContext *context,
+                           const SharedFrame &frame,
+                           GLuint texture[],
+                           OpenGLVideoWidget::TextureFormat &textureFormat,
+                           bool can16Bit,
+                           GLuint pixelBuffer = 0)
+{
+    int width = frame.get_image_width();
+    int height = frame.get_image_height();
+    const bool is16Bit = can16Bit && frame.get_image_format() == mlt_image_yuv420p10;
+    const SharedFrame::ImageView view = frame.get_image_view(is16Bit ? mlt_image_yuv420p10
+                                                                     : mlt_image_yuv420p);
+    const uint8_t *image = view.planes[0];
+    QOpenGLFunctions *f = context->functions();
+    const int widths[3] = {width, width / 2, width / 2};
+    const int heights[3] = {height, height / 2, height / 2};
+    size_t offsets[3] = {0, 0, 0};
+    size_t bytes = 0;
+    if (view.planeCount == 3) {
+        // The planes are contiguous in a single buffer owned by the frame.
+        for (int i = 0; i < 3; ++i)
+            offsets[i] = view.planes[i] - image;
+        bytes = offsets[2] + size_t(view.strides[2]) * heights[2];
+    } else {
+        image = nullptr;
+    }
+
+    // The planes of pixel data may not be a multiple of the default 4 bytes.
+    f->glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+
+    // Allocate a texture for each plane of YUV once per resolution and depth.
+    if (!texture[0] || textureFormat.size != QSize(width, height)
+        || textureFormat.is16Bit != is16Bit) {
+        if (texture[0])
+            f->glDeleteTextures(3, texture);
+        check_error(f);
+        f->glGenTextures(3, texture);
+        check_error(f);
+        for (int i = 0; i < 3; ++i)
+            allocateTexture(f, texture[i], widths[i], heights[i], is16Bit);
+        textureFormat.size = QSize(width, height);
+        textureFormat.is16Bit = is16Bit;
+    }
+    textureFormat.transfer = frame.get_int("color_trc");
+    if (!image)
+        return;
+
+    bool isBuffered = false;
+    if (pixelBuffer) {
+        QOpenGLExtraFunctions *ef = context->extraFunctions();
+        ef->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, pixelBuffer);
+        // Orphan the previous contents so that mapping does not wait for them.
+        ef->glBufferData(GL_PIXEL_UNPACK_BUFFER, bytes, nullptr, GL_STREAM_DRAW);
+        void *mapped = ef->glMapBufferRange(GL_PIXEL_UNPACK_BUFFER,
+                                            0,
+                                            bytes,
+                                            GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_BUFFER_BIT);
+        if (mapped) {
+            ::memcpy(mapped, image, bytes);
+            isBuffered = ef->glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+        if (!isBuffered)
+            ef->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+        check_error(f);
+    }
+
+    for (int i = 0; i < 3; ++i) {
+        // From a pixel buffer, the pointer is an offset into the buffer.
+        const void *pixels = isBuffered ? reinterpret_cast<const void *>(offsets[i])
+                                        : image + offsets[i];
+        f->glBindTexture(GL_TEXTURE_2D, texture[i]);
+        check_error(f);
+        f->glTexSubImage2D(GL_TEXTURE_2D,
+                           0,
+                           0,
+                           0,
+                           widths[i],
+                           heights[i],
+                           GL_LUMINANCE,
+                           is16Bit ? GL_UNSIGNED_SHORT : GL_UNSIGNED_BYTE,
+                           pixels);
+        check_error(f);
+    }
+    if (isBuffered)
+        context->extraFunctions()->glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+}
+
+void OpenGLVideoWidget::renderVideo()
+{
+    FrameTrace::Scope trace("OpenGLVideoWidget::renderVideo");
+    auto context = static_cast<QOpenGLContext *>(
+        quickWindow()->rendererInterface()->getResource(quickWindow(),
+                                                        QSGRendererInterface::OpenGLContextResource));
+    if (!m_quickContext) {
+        LOG_ERROR() << "No quickContext";
+        return;
+    }
+    if (!context->isValid()) {
+        LOG_ERROR() << "No QSGRendererInterface::OpenGLContextResource";
+        return;
+    }
+
+#ifndef QT_NO_DEBUG
+    QOpenGLFunctions *f = context->functions();
+#endif
+    float width = this->width() * devicePixelRatioF();
+    float height = this->height() * devicePixelRatioF();
+
+    glDisable(GL_BLEND);
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glViewport(0, 0, width, height);
+    check_error(f);
+
+    if (!m_isThreadedOpenGL) {
+        m_mutex.lock();
+        if (!m_sharedFrame.is_valid()) {
+            m_mutex.unlock();
+            return;
+        }
+        uploadTextures(context,
+                       m_sharedFrame,
+                       m_displayTexture,
+                       m_displayTextureFormat,
+                       m_canUpload16Bit);
+        m_mutex.unlock();
+    } else {
+        // Wait on the GPU, not here, for the upload in the other context.
+        m_mutex.lock();
+        GLsync fence = std::exchange(m_displayFence, nullptr);
+        m_mutex.unlock();
+        if (fence) {
+            context->extraFunctions()->glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+            context->extraFunctions()->glDeleteSync(fence);
+        }
+    }
+
+    if (!m_displayTexture[0]) {
+        return;
+    }
+
+    quickWindow()->beginExternalCommands();
+
+    // Bind textures.
+    for (int i = 0; i < 3; ++i) {
+        if (m_displayTexture[i]) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, m_displayTexture[i]);
+            check_error(f);
+        }
+    }
+
+    // Init shader program.
+    m_shader->bind();
+    m_shader->setUniformValue(m_textureLocation[0], 0);
+    m_shader->setUniformValue(m_textureLocation[1], 1);
+    m_shader->setUniformValue(m_textureLocation[2], 2);
+    m_shader->setUniformValue(m_colorspaceLocation, MLT.profile().colorspace());
+    m_shader->setUniformValue(m_sampleScaleLocation,
+                              m_displayTextureFormat.is16Bit ? kSampleScale10Bit : 1.0f);
+    m_shader->setUniformValue(m_transferLocation, m_displayTextureFormat.transfer);
+    // Only the viewport of a 360 video is sampled from the whole frame.
+    const auto viewport = viewport360();
+    const float tanHalfFov = qTan(qDegreesToRadians(viewport.fov) / 2.0f);
+    m_shader->setUniformValue(m_viewportLocation, viewport.isEnabled ? 1 : 0);
+    m_shader->setUniformValue(m_viewDirectionLocation,
+                              qDegreesToRadians(viewport.yaw),
+                              qDegreesToRadians(viewport.pitch));
+    m_shader->setUniformValue(m_viewSizeLocation,
+                              tanHalfFov * float(rect().width() / qMax(1.0, rect().height())),
+                              tanHalfFov);
+    check_error(f);
+
+    // Setup an orthographic projection.
+    QMatrix4x4 projection;
+    projection.scale(2.0f / width, 2.0f / height);
+    m_shader->setUniformValue(m_projectionLocation, projection);
+    check_error(f);
+
+    // Set model view.
+    QMatrix4x4 modelView;
+    if (rect().width() > 0.0 && zoom() > 0.0) {
+        if (offset().x() || offset().y())
+            modelView.translate(-offset().x() * devicePixelRatioF(),
+                                offset().y() * devicePixelRatioF());
+        modelView.scale(zoom(), zoom());
+    }
+    m_shader->setUniformValue(m_modelViewLocation, modelView);
+    check_error(f);
+
+    // Provide vertices of triangle strip.
+    QVector<QVector2D> vertices;
+    width = rect().width() * devicePixelRatioF();
+    height = rect().height() * devicePixelRatioF();
+    vertices << QVector2D(-width / 2.0f, -height / 2.0f);
+    vertices << QVector2D(-width / 2.0f, height / 2.0f);
+    vertices << QVector2D(width / 2.0f, -height / 2.0f);
+    vertices << QVector2D(width / 2.0f, height / 2.0f);
+    m_shader->enableAttributeArray(m_vertexLocation);
+    check_error(f);
+    m_shader->setAttributeArray(m_vertexLocation, vertices.constData());
+    check_error(f);
+
+    // Provide texture coordinates.
+    QVector<QVector2D> texCoord;
+    texCoord << QVector2D(0.0f, 1.0f);
+    texCoord << QVector2D(0.0f, 0.0f);
+    texCoord << QVector2D(1.0f, 1.0f);
+    texCoord << QVector2D(1.0f, 0.0f);
+    m_shader->enableAttributeArray(m_texCoordLocation);
+    check_error(f);
+    m_shader->setAttributeArray(m_texCoordLocation, texCoord.constData());
+    check_error(f);
+
+    // Render
+    glDrawArrays(GL_TRIANGLE_STRIP, 0, vertices.size());
+    check_error(f);
+
+    if (m_isThreadedOpenGL && m_canFence) {
+        // The upload context must not replace these textures before this is done.
+        GLsync fence = context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+        m_mutex.lock();
+        std::swap(fence, m_renderFence);
+        m_mutex.unlock();
+        if (fence)
+            context->extraFunctions()->glDeleteSync(fence);
+    }
+
+    // Cleanup
+    m_shader->disableAttributeArray(m_vertexLocation);
+    m_shader->disableAttributeArray(m_texCoordLocation);
+    m_shader->release();
+    for (int i = 0; i < 3; ++i) {
+        if (m_displayTexture[i]) {
+            glActiveTexture(GL_TEXTURE0 + i);
+            glBindTexture(GL_TEXTURE_2D, 0);
+            check_error(f);
+        }
+    }
+    glActiveTexture(GL_TEXTURE0);
+    check_error(f);
+
+    quickWindow()->endExternalCommands();
+    Mlt::VideoWidget::renderVideo();
+}
+
+void OpenGLVideoWidget::onFrameDisplayed(const SharedFrame &frame)
+{
+    FrameTrace::Scope trace("OpenGLVideoWidget::onFrameDisplayed", frame.get_position());
+    if (m_isThreadedOpenGL && !m_context) {
+        m_context.reset(new QOpenGLContext);
+        if (m_context) {
+            m_context->setFormat(m_quickContext->format());
+            m_context->setShareContext(m_quickContext);
+            m_context->create();
+            // Mapping buffer ranges needs OpenGL (ES) 3.0 and sync objects 3.2 or ES 3.0.
+            const QSurfaceFormat format = m_context->format();
+            const auto version = qMakePair(format.majorVersion(), format.minorVersion());
+            m_canStreamUpload = version >= qMakePair(3, 0);
+            m_canFence = m_context->isOpenGLES() ? version >= qMakePair(3, 0)
+                                                 : version >= qMakePair(3, 2);
+            LOG_INFO() << "OpenGL streaming upload?" << m_canStreamUpload << "fences?"
+                       << m_canFence;
+        }
+    }
+    if (m_context && m_context->isValid()) {
+        // Using threaded OpenGL to upload textures.
+        QOpenGLFunctions *f = m_context->functions();
+        m_context->makeCurrent(&m_offscreenSurface);
+        GLuint pixelBuffer = 0;
+        if (m_canStreamUpload) {
+            if (!m_pixelBuffers[0])
+                f->glGenBuffers(kPixelBufferCount, m_pixelBuffers);
+            pixelBuffer = m_pixelBuffers[m_pixelBufferIndex];
+            m_pixelBufferIndex = (m_pixelBufferIndex + 1) % kPixelBufferCount;
+        }
+        if (m_canFence) {
+            // The render textures were displayed before the last swap.
+            m_mutex.lock();
+            GLsync fence = std::exchange(m_renderFence, nullptr);
+            m_mutex.unlock();
+            if (fence) {
+                m_context->extraFunctions()->glWaitSync(fence, 0, GL_TIMEOUT_IGNORED);
+                m_context->extraFunctions()->glDeleteSync(fence);
+            }
+        } else {
+            // Without fences, new textures are the only way to not replace
+            // those the render thread may still be drawing.
+            m_renderTextureFormat.size = QSize();
+        }
+        uploadTextures(m_context.get(),
+                       frame,
+                       m_renderTexture,
+                       m_renderTextureFormat,
+                       m_canUpload16Bit,
+                       pixelBuffer);
+        // This runs before the frame is passed on to the scopes, which analyze
+        // 8-bit textures only and otherwise use the CPU.
+        if (GpuScopes::isEnabled() && GpuScopes::requested() && !m_renderTextureFormat.is16Bit) {
+            if (!m_gpuScopes)
+                m_gpuScopes.reset(new GpuScopes);
+            m_gpuScopes->analyze(m_context.get(),
+                                 frame,
+                                 m_renderTexture,
+                                 MLT.profile().colorspace());
+        }
+        f->glBindTexture(GL_TEXTURE_2D, 0);
+        check_error(f);
+        GLsync fence = nullptr;
+        if (m_canFence) {
+            // Let the upload continue while the next frame is decoded.
+            fence = m_context->extraFunctions()->glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+            f->glFlush();
+        } else {
+            f->glFinish();
+        }
+
+        m_mutex.lock();
+        for (int i = 0; i < 3; ++i)
+            std::swap(m_renderTexture[i], m_displayTexture[i]);
+        std::swap(m_renderTextureFormat, m_displayTextureFormat);
+        std::swap(fence, m_displayFence);
+        m_mutex.unlock();
+        // A frame that was never displayed.
+        if (fence)
+            m_context->extraFunctions()->glDeleteSync(fence);
+        m_context->doneCurrent();
+    }
+    Mlt::VideoWidget::onFrameDisplayed(frame);
+}
@@ -1,60 +1,95 @@
-/*
- * Copyright (c) 2023 Meltytech, LLC
- *
- * This program is free software: you can redistribute it and/or modify
- * it under the terms of the GNU General Public License as published by
- * the Free Software Foundation, either version 3 of the License, or
- * (at your option) any later version.
- *
- * This program is distributed in the hope that it will be useful,
- * but WITHOUT ANY WARRANTY; without even the implied warranty of
- * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
- * GNU General Public License for more details.
- *
- * You should have received a copy of the GNU General Public License
- * along with this program.  If not, see <http://www.gnu.org/licenses/>.
- */
-
-#ifndef OPENGLVIDEOWIDGET_H
-#define OPENGLVIDEOWIDGET_H
-
-#include "videowidget.h"
-
-#include <QOffscreenSurface>
-#include <QOpenGLContext>
-#include <QOpenGLFramebufferObject>
-#include <QOpenGLFunctions>
-#include <QOpenGLShaderProgram>
-
-class OpenGLVideoWidget : public Mlt::VideoWidget, protected QOpenGLFunctions
-{
-    Q_OBJECT
-
-public:
-    explicit OpenGLVideoWidget(QObject *parent = nullptr);
-    virtual ~OpenGLVideoWidget();
-
-public slots:
-    virtual void initialize();
-    virtual void renderVideo();
-    virtual void onFrameDisplayed(const SharedFrame &frame);
-
-private:
-    void createShader();
-
-    QOffscreenSurface m_offscreenSurface;
-    std::unique_ptr<QOpenGLShaderProgram> m_shader;
-    GLint m_projectionLocation;
-    GLint m_modelViewLocation;
-    GLint m_vertexLocation;
-    GLint m_texCoordLocation;
-    GLint m_colorspaceLocation;
-    GLint m_textureLocation[3];
-    QOpenGLContext *m_quickContext;
-    std::unique_ptr<QOpenGLContext> m_context;
-    GLuint m_renderTexture[3];
-    GLuint m_displayTexture[3];
-    bool m_isThreadedOpenGL;
-};
-
-#endif // OPENGLVIDEOWIDGET_H
+/*
+ * Copyright (c) 2023-2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef OPENGLVIDEOWIDGET_H
+#define OPENGLVIDEOWIDGET_H
+
+#include "videowidget.h"
+#include "widgets/scopes/gpuscopes.h"
+
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QSize>
+
+class OpenGLVideoWidget : public Mlt::VideoWidget, protected QOpenGLFunctions
+{
+    Q_OBJECT
+
+public:
+    explicit OpenGLVideoWidget(QObject *parent = nullptr);
+    virtual ~OpenGLVideoWidget();
+
+    //! Describes the frame the textures were allocated and uploaded for.
+    struct TextureFormat
+    {
+        QSize size;
+        bool is16Bit = false;
+        int transfer = 0; ///< The mlt_color_trc of the frame
+    };
+
+public slots:
+    virtual void initialize();
+    virtual void renderVideo();
+    virtual void onFrameDisplayed(const SharedFrame &frame);
+
+protected:
+    bool canDisplayYuv420p10() const override { return m_canUpload16Bit; }
+
+private:
+    void createShader();
+
+    QOffscreenSurface m_offscreenSurface;
+    std::unique_ptr<QOpenGLShaderProgram> m_shader;
+    GLint m_projectionLocation;
+    GLint m_modelViewLocation;
+    GLint m_vertexLocation;
+    GLint m_texCoordLocation;
+    GLint m_colorspaceLocation;
+    GLint m_sampleScaleLocation;
+    GLint m_transferLocation;
+    GLint m_viewportLocation;
+    GLint m_viewDirectionLocation;
+    GLint m_viewSizeLocation;
+    GLint m_textureLocation[3];
+    QOpenGLContext *m_quickContext;
+    std::unique_ptr<QOpenGLContext> m_context;
+    GLuint m_renderTexture[3];
+    GLuint m_displayTexture[3];
+    TextureFormat m_renderTextureFormat;
+    TextureFormat m_displayTextureFormat;
+    std::unique_ptr<GpuScopes> m_gpuScopes;
+    bool m_isThreadedOpenGL;
+    // Whether textures can have 16 bits per sample, which OpenGL ES 2 lacks.
+    bool m_canUpload16Bit;
+
+    // Members for streaming uploads in the threaded OpenGL context.
+    static const int kPixelBufferCount = 3;
+    GLuint m_pixelBuffers[kPixelBufferCount];
+    int m_pixelBufferIndex;
+    bool m_canStreamUpload;
+    bool m_canFence;
+    // Signaled when the upload of the display textures is complete.
+    GLsync m_displayFence;
+    // Signaled when the last render with the display textures is complete.
+    GLsync m_renderFence;
+};
+
+#endif // OPENGLVIDEOWIDGET_H
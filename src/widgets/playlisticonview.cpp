@@ -18,6 +18,7 @@
 #include "playlisticonview.h"
 
 #include "Logger.h"
+#include "filmstrip.h"
 #include "models/playlistmodel.h"
 #include "settings.h"
 
@@ -41,7 +42,12 @@ PlaylistIconView::PlaylistIconView(QWidget *parent)
     verticalScrollBar()->setSingleStep(100);
     verticalScrollBar()->setPageStep(400);
     setContextMenuPolicy(Qt::CustomContextMenu);
+    setMouseTracking(true);
     connect(&Settings, SIGNAL(playlistThumbnailsChanged()), SLOT(updateSizes()));
+    connect(&Filmstrip::singleton(), &Filmstrip::ready, this, [this]() {
+        if (m_hoverIndex.isValid())
+            viewport()->update();
+    });
 }
 
 QRect PlaylistIconView::_visualRect(const QModelIndex &index) const
@@ -210,6 +216,12 @@ void PlaylistIconView::paintEvent(QPaintEvent *)
                                      PlaylistModel::THUMBNAIL_HEIGHT * kFilesSizeFactor,
                                      Qt::KeepAspectRatio,
                                      Qt::SmoothTransformation);
+            } else if (idx == m_hoverIndex && !thumb.isNull()) {
+                const auto frame = hoverFrame(idx);
+                if (!frame.isNull())
+                    thumb = frame.scaled(thumb.size(),
+                                         Qt::KeepAspectRatio,
+                                         Qt::SmoothTransformation);
             }
 
             QRect imageBoundingRect = itemRect;
@@ -289,6 +301,52 @@ void PlaylistIconView::mouseReleaseEvent(QMouseEvent *event)
     QAbstractItemView::mouseReleaseEvent(event);
 }
 
+void PlaylistIconView::mouseMoveEvent(QMouseEvent *event)
+{
+    // Skim through the clip under the mouse in the playlist.
+    QModelIndex index;
+    if (event->buttons() == Qt::NoButton && m_iconRole == Qt::DecorationRole) {
+        const auto point = event->position().toPoint();
+        index = indexAt(point);
+        if (index.isValid()) {
+            const int col = index.row() % m_itemsPerRow;
+            m_hoverRatio = qBound(0.0,
+                                  double(point.x() - col * m_gridSize.width())
+                                      / m_gridSize.width(),
+                                  1.0);
+        }
+    }
+    if (index.isValid() || m_hoverIndex.isValid()) {
+        m_hoverIndex = index;
+        viewport()->update();
+    }
+    QAbstractItemView::mouseMoveEvent(event);
+}
+
+void PlaylistIconView::leaveEvent(QEvent *event)
+{
+    if (m_hoverIndex.isValid()) {
+        m_hoverIndex = QPersistentModelIndex();
+        viewport()->update();
+    }
+    QAbstractItemView::leaveEvent(event);
+}
+
+// Returns the frame of the filmstrip of the clip at where the mouse is across it.
+QImage PlaylistIconView::hoverFrame(const QModelIndex &index) const
+{
+    auto proxyModel = static_cast<QSortFilterProxyModel *>(model());
+    auto playlistModel = qobject_cast<PlaylistModel *>(proxyModel->sourceModel());
+    if (!playlistModel || !playlistModel->playlist())
+        return QImage();
+    QScopedPointer<Mlt::ClipInfo> info(
+        playlistModel->playlist()->clip_info(proxyModel->mapToSource(index).row()));
+    if (!info || !info->producer || !info->producer->is_valid())
+        return QImage();
+    const int position = info->frame_in + qRound(m_hoverRatio * qMax(0, info->frame_count - 1));
+    return Filmstrip::singleton().frame(*info->producer, position);
+}
+
 void PlaylistIconView::dragMoveEvent(QDragMoveEvent *e)
 {
     m_draggingOverPos = e->position().toPoint();
@@ -43,6 +43,8 @@ public:
 
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
     void mouseReleaseEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
+    void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
+    void leaveEvent(QEvent *event) Q_DECL_OVERRIDE;
     void dragMoveEvent(QDragMoveEvent *e) Q_DECL_OVERRIDE;
     void dragLeaveEvent(QDragLeaveEvent *e) Q_DECL_OVERRIDE;
     void dropEvent(QDropEvent *e) Q_DECL_OVERRIDE;
@@ -70,6 +72,7 @@ private:
                                                       const QRect &rect,
                                                       const QModelIndex &index) const;
     QRect _visualRect(const QModelIndex &index) const;
+    QImage hoverFrame(const QModelIndex &index) const;
 
     QSize m_gridSize;
     QPoint m_draggingOverPos;
@@ -78,6 +81,8 @@ private:
     bool m_isRangeSelect{false};
     QModelIndex m_pendingSelect;
     int m_iconRole;
+    QPersistentModelIndex m_hoverIndex;
+    double m_hoverRatio{0.0};
 };
 
 #endif
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2023 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -80,7 +80,7 @@ ProducerPreviewWidget::~ProducerPreviewWidget()
     stop();
 }
 
-void ProducerPreviewWidget::start(const Mlt::Producer &producer)
+void ProducerPreviewWidget::start(const Mlt::Producer &producer, int position)
 {
     if (Settings.playerGPU())
         return;
@@ -91,11 +91,12 @@ void ProducerPreviewWidget::start(const Mlt::Producer &producer)
         // Set up the preview display and timer
         m_scrubber->setFramerate(MLT.profile().fps());
         m_scrubber->setScale(m_producer.get_length());
+        m_scrubber->setPreviewProducer(&m_producer);
         // Display preview at half frame rate.
         int milliseconds = 2 * 1000.0 / MLT.profile().fps();
         m_timerId = startTimer(milliseconds);
         // Set up the producer frame generator
-        m_seekTo = 0;
+        m_seekTo = qBound(0, position, qMax(0, m_producer.get_length() - 1));
         m_generateFrames = true;
         m_future = QtConcurrent::run(&ProducerPreviewWidget::frameGeneratorThread, this);
     }
@@ -115,6 +116,7 @@ void ProducerPreviewWidget::ProducerPreviewWidget::stop(bool releaseProducer)
     if (releaseProducer) {
         m_producer = Mlt::Producer();
         m_scrubber->setScale(0);
+        m_scrubber->setPreviewProducer(nullptr);
     }
     while (m_queue.count() > 0) {
         m_queue.pop();
@@ -124,6 +126,11 @@ void ProducerPreviewWidget::ProducerPreviewWidget::stop(bool releaseProducer)
     m_posLabel->setText("");
 }
 
+int ProducerPreviewWidget::position() const
+{
+    return m_scrubber->position();
+}
+
 void ProducerPreviewWidget::showText(QString text)
 {
     m_imageLabel->setText(text);
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -36,8 +36,10 @@ public:
     explicit ProducerPreviewWidget(double dar, int width = 320);
     virtual ~ProducerPreviewWidget();
 
-    void start(const Mlt::Producer &producer);
+    void start(const Mlt::Producer &producer, int position = 0);
     void stop(bool releaseProducer = true);
+    //! Returns the position of the frame shown last.
+    int position() const;
     void showText(QString text);
     void setLooping(bool enabled);
 
@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quickviewhost.h"
+
+#include "Logger.h"
+
+#include <QCoreApplication>
+#include <QDropEvent>
+#include <QQuickView>
+#include <QVBoxLayout>
+
+namespace {
+
+class QuickView : public QQuickView
+{
+public:
+    explicit QuickView(QQmlEngine *engine)
+        : QQuickView(engine, nullptr)
+    {}
+
+    void setReceiver(QWidget *receiver) { m_receiver = receiver; }
+
+protected:
+    bool event(QEvent *event) override
+    {
+        const bool result = QQuickView::event(event);
+        if (!m_receiver)
+            return result;
+        switch (event->type()) {
+        case QEvent::KeyPress:
+        case QEvent::KeyRelease:
+            // The application propagates the key to the parents of the container.
+            if (!event->isAccepted())
+                QCoreApplication::sendEvent(m_receiver, event);
+            break;
+        case QEvent::DragEnter:
+            m_isDragForwarded = !event->isAccepted()
+                                && forwardDrop(static_cast<QDropEvent *>(event));
+            break;
+        case QEvent::DragMove:
+        case QEvent::Drop:
+            if (m_isDragForwarded && !event->isAccepted())
+                forwardDrop(static_cast<QDropEvent *>(event));
+            if (event->type() == QEvent::Drop)
+                m_isDragForwarded = false;
+            break;
+        case QEvent::DragLeave:
+            if (m_isDragForwarded) {
+                QPointF position;
+                if (auto target = dropTarget(position))
+                    QCoreApplication::sendEvent(target, event);
+            }
+            m_isDragForwarded = false;
+            break;
+        default:
+            break;
+        }
+        return result;
+    }
+
+private:
+    // Returns the first widget from the container up that accepts drops and maps
+    // \a position to it.
+    QWidget *dropTarget(QPointF &position)
+    {
+        auto widget = m_receiver;
+        while (widget && !widget->acceptDrops()) {
+            position = widget->mapToParent(position);
+            widget = widget->parentWidget();
+        }
+        return widget;
+    }
+
+    bool forwardDrop(QDropEvent *event)
+    {
+        QPointF position = event->position();
+        auto target = dropTarget(position);
+        if (!target)
+            return false;
+        if (event->type() == QEvent::Drop) {
+            QDropEvent drop(position,
+                            event->possibleActions(),
+                            event->mimeData(),
+                            event->buttons(),
+                            event->modifiers());
+            QCoreApplication::sendEvent(target, &drop);
+            event->setDropAction(drop.dropAction());
+            event->setAccepted(drop.isAccepted());
+        } else if (event->type() == QEvent::DragEnter) {
+            QDragEnterEvent enter(position.toPoint(),
+                                  event->possibleActions(),
+                                  event->mimeData(),
+                                  event->buttons(),
+                                  event->modifiers());
+            QCoreApplication::sendEvent(target, &enter);
+            event->setDropAction(enter.dropAction());
+            event->setAccepted(enter.isAccepted());
+        } else {
+            QDragMoveEvent move(position.toPoint(),
+                                event->possibleActions(),
+                                event->mimeData(),
+                                event->buttons(),
+                                event->modifiers());
+            QCoreApplication::sendEvent(target, &move);
+            event->setDropAction(move.dropAction());
+            event->setAccepted(move.isAccepted());
+        }
+        return event->isAccepted();
+    }
+
+    QWidget *m_receiver{nullptr};
+    bool m_isDragForwarded{false};
+};
+
+} // namespace
+
+QuickViewHost::QuickViewHost(QQmlEngine *engine, bool isWindowed, QWidget *parent)
+    : QWidget(parent)
+    , m_quickWidget(nullptr)
+    , m_quickView(nullptr)
+{
+    if (isWindowed) {
+        LOG_DEBUG() << "hosting a QML view in a window";
+        auto view = new QuickView(engine);
+        m_quickView = view;
+        // The container takes the ownership of the window.
+        m_widget = QWidget::createWindowContainer(view, this);
+        view->setReceiver(m_widget);
+        connect(m_quickView, &QQuickView::statusChanged, this, [this](QQuickView::Status status) {
+            emit statusChanged(QQuickWidget::Status(status));
+        });
+    } else {
+        m_quickWidget = new QQuickWidget(engine, this);
+        m_widget = m_quickWidget;
+        connect(m_quickWidget, &QQuickWidget::statusChanged, this, &QuickViewHost::statusChanged);
+    }
+    auto layout = new QVBoxLayout(this);
+    layout->setContentsMargins(0, 0, 0, 0);
+    layout->addWidget(m_widget);
+    setFocusProxy(m_widget);
+}
+
+QQuickWindow *QuickViewHost::quickWindow() const
+{
+    return m_quickView ? m_quickView : m_quickWidget->quickWindow();
+}
+
+QQmlEngine *QuickViewHost::engine() const
+{
+    return m_quickView ? m_quickView->engine() : m_quickWidget->engine();
+}
+
+QQmlContext *QuickViewHost::rootContext() const
+{
+    return m_quickView ? m_quickView->rootContext() : m_quickWidget->rootContext();
+}
+
+QQuickItem *QuickViewHost::rootObject() const
+{
+    return m_quickView ? m_quickView->rootObject() : m_quickWidget->rootObject();
+}
+
+QUrl QuickViewHost::source() const
+{
+    return m_quickView ? m_quickView->source() : m_quickWidget->source();
+}
+
+void QuickViewHost::setSource(const QUrl &url)
+{
+    if (m_quickView)
+        m_quickView->setSource(url);
+    else
+        m_quickWidget->setSource(url);
+}
+
+QQuickWidget::Status QuickViewHost::status() const
+{
+    // The enums of QQuickView and QQuickWidget have the same values.
+    return m_quickView ? QQuickWidget::Status(m_quickView->status()) : m_quickWidget->status();
+}
+
+void QuickViewHost::setResizeMode(QQuickWidget::ResizeMode mode)
+{
+    if (m_quickView)
+        m_quickView->setResizeMode(QQuickView::ResizeMode(mode));
+    else
+        m_quickWidget->setResizeMode(mode);
+}
+
+void QuickViewHost::setClearColor(const QColor &color)
+{
+    if (m_quickView)
+        m_quickView->setColor(color);
+    else
+        m_quickWidget->setClearColor(color);
+}
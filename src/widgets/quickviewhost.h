@@ -0,0 +1,68 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef QUICKVIEWHOST_H
+#define QUICKVIEWHOST_H
+
+#include <QQuickWidget>
+#include <QWidget>
+
+class QQuickView;
+
+/*!
+  \class QuickViewHost
+  \brief Shows a QML view in a QQuickWidget or in a window of its own.
+
+  A QQuickWidget renders its scene graph on the GUI thread into an offscreen
+  buffer that is then composited with the other widgets. When \a isWindowed,
+  the view is a QQuickView embedded with QWidget::createWindowContainer()
+  instead, so that the threaded render loop can draw it while the GUI thread
+  handles input. The keys and drags that the QML does not take are given to
+  the parent widgets as a QQuickWidget would.
+
+  The methods mirror those of QQuickWidget that the docks use.
+*/
+
+class QuickViewHost : public QWidget
+{
+    Q_OBJECT
+
+public:
+    QuickViewHost(QQmlEngine *engine, bool isWindowed, QWidget *parent = nullptr);
+
+    //! Returns the widget that takes the focus, touches and mouse.
+    QWidget *widget() const { return m_widget; }
+    QQuickWindow *quickWindow() const;
+    QQmlEngine *engine() const;
+    QQmlContext *rootContext() const;
+    QQuickItem *rootObject() const;
+    QUrl source() const;
+    void setSource(const QUrl &url);
+    QQuickWidget::Status status() const;
+    void setResizeMode(QQuickWidget::ResizeMode mode);
+    void setClearColor(const QColor &color);
+
+signals:
+    void statusChanged(QQuickWidget::Status status);
+
+private:
+    QQuickWidget *m_quickWidget;
+    QQuickView *m_quickView;
+    QWidget *m_widget;
+};
+
+#endif // QUICKVIEWHOST_H
@@ -58,6 +58,7 @@ private slots:
 private:
     // Functions run in scope thread.
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
+    bool needsEveryFrame() const Q_DECL_OVERRIDE { return true; }
 
     // Members accessed by scope thread.
     Mlt::Filter *m_loudnessFilter;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2022 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -28,6 +28,7 @@
 
 AudioPeakMeterScopeWidget::AudioPeakMeterScopeWidget()
     : ScopeWidget("AudioPeakMeter")
+    , m_position(0)
     , m_audioMeter(0)
     , m_orientation((Qt::Orientation) -1)
     , m_channels(Settings.playerAudioChannels())
@@ -49,40 +50,40 @@ AudioPeakMeterScopeWidget::AudioPeakMeterScopeWidget()
 void AudioPeakMeterScopeWidget::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
     SharedFrame sFrame;
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            int channels = sFrame.get_audio_channels();
-            int samples = sFrame.get_audio_samples();
-            QVector<double> levels;
-            const int16_t *audio = sFrame.get_audio();
-            for (int c = 0; c < channels; c++) {
-                int16_t peak = 0;
-                const int16_t *p = audio + c;
-                for (int s = 0; s < samples; s++) {
-                    int16_t sample = abs(*p);
-                    if (sample > peak)
-                        peak = sample;
-                    p += channels;
-                }
-                if (peak == 0) {
-                    levels << -100.0;
-                } else {
-                    levels << 20
-                                  * log10((double) peak
-                                          / (double) std::numeric_limits<int16_t>::max());
-                }
-            }
-            QMetaObject::invokeMethod(m_audioMeter,
-                                      "showAudio",
-                                      Qt::QueuedConnection,
-                                      Q_ARG(const QVector<double> &, levels));
-            if (m_channels != channels) {
-                m_channels = channels;
-                QMetaObject::invokeMethod(this, "reconfigureMeter", Qt::QueuedConnection);
-            }
+    if (!takeFrame(sFrame))
+        return;
+
+    // Read every sample since the last refresh so that no peak is missed,
+    // even when refreshes fall behind the frames.
+    AudioTap &tap = AudioTap::singleton();
+    const AudioTap::Window window = tap.since(m_position, AudioTap::kCapacity / 4);
+    if (window.frames <= 0)
+        return;
+    int channels = qMin(window.channels, int(AudioTap::kMaxChannels));
+    float peaks[AudioTap::kMaxChannels];
+    AudioTap::peaks(window, peaks);
+    QVector<double> levels;
+    for (int c = 0; c < channels; c++) {
+        if (peaks[c] == 0.0f) {
+            levels << -100.0;
+        } else {
+            levels << 20 * log10((double) peaks[c]);
         }
     }
+    if (!tap.isValid(window)) {
+        // It was overwritten while reading; start again from the latest.
+        m_position = 0;
+        return;
+    }
+    m_position = window.end();
+    QMetaObject::invokeMethod(m_audioMeter,
+                              "showAudio",
+                              Qt::QueuedConnection,
+                              Q_ARG(const QVector<double> &, levels));
+    if (m_channels != channels) {
+        m_channels = channels;
+        QMetaObject::invokeMethod(this, "reconfigureMeter", Qt::QueuedConnection);
+    }
 }
 
 QString AudioPeakMeterScopeWidget::getTitle()
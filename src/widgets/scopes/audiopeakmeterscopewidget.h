@@ -18,6 +18,7 @@
 #ifndef AUDIOPEAKMETERSCOPEWIDGET_H
 #define AUDIOPEAKMETERSCOPEWIDGET_H
 
+#include "audiotap.h"
 #include "scopewidget.h"
 
 #include <QImage>
@@ -39,6 +40,9 @@ private:
     // Functions run in scope thread.
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
 
+    // Members accessed by scope thread.
+    qint64 m_position;
+
     // Members accessed by GUI thread.
     AudioMeterWidget *m_audioMeter;
     Qt::Orientation m_orientation;
@@ -0,0 +1,254 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audiospectrogramscopewidget.h"
+
+#include "Logger.h"
+#include "audiotap.h"
+
+#include <QPainter>
+#include <QtMath>
+
+#include <cmath>
+
+static const int kWindowSize = 2048;
+static const int kColumnsPerSecond = 50;
+static const double kMinFrequency = 20.0;
+static const double kMaxFrequency = 20000.0;
+static const double kMinDb = -100.0;
+static const QColor TEXT_COLOR = {255, 255, 255, 127};
+
+// Maps 256 levels from silence to full scale onto black, blue, magenta,
+// orange and yellowish white.
+static const QVector<QRgb> &levelColors()
+{
+    static const QVector<QRgb> colors = [] {
+        static const QColor stops[] = {{0, 0, 0},
+                                       {20, 20, 120},
+                                       {150, 30, 150},
+                                       {240, 120, 30},
+                                       {255, 255, 200}};
+        static const int segments = sizeof(stops) / sizeof(stops[0]) - 1;
+        QVector<QRgb> result(256);
+        for (int i = 0; i < result.size(); ++i) {
+            const double position = double(i) * segments / (result.size() - 1);
+            const int s = qMin(int(position), segments - 1);
+            const double t = position - s;
+            const QColor &a = stops[s];
+            const QColor &b = stops[s + 1];
+            result[i] = qRgb(qRound(a.red() + t * (b.red() - a.red())),
+                             qRound(a.green() + t * (b.green() - a.green())),
+                             qRound(a.blue() + t * (b.blue() - a.blue())));
+        }
+        return result;
+    }();
+    return colors;
+}
+
+// Returns the y of a frequency in a widget that is height tall.
+static qreal frequencyToY(double frequency, int height)
+{
+    return height * (1.0 - std::log(frequency / kMinFrequency)
+                               / std::log(kMaxFrequency / kMinFrequency));
+}
+
+AudioSpectrogramScopeWidget::AudioSpectrogramScopeWidget()
+    : ScopeWidget("AudioSpectrogram")
+    , m_position(0)
+    , m_plan(FftPlanCache::realToComplex(kWindowSize))
+    , m_fftInput(fftw_alloc_real(kWindowSize))
+    , m_fftOutput(fftw_alloc_complex(kWindowSize / 2 + 1))
+    , m_hann(kWindowSize)
+    , m_rowsFrequency(0)
+    , m_mutex()
+    , m_column(0)
+{
+    LOG_DEBUG() << "begin";
+    for (int i = 0; i < kWindowSize; ++i)
+        m_hann[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / (kWindowSize - 1)));
+    setMinimumSize(100, 100);
+    LOG_DEBUG() << "end";
+}
+
+AudioSpectrogramScopeWidget::~AudioSpectrogramScopeWidget()
+{
+    fftw_free(m_fftInput);
+    fftw_free(m_fftOutput);
+}
+
+void AudioSpectrogramScopeWidget::refreshScope(const QSize &size, bool full)
+{
+    Q_UNUSED(full)
+    const int width = size.width();
+    const int height = size.height();
+    if (width <= 0 || height <= 0)
+        return;
+
+    m_mutex.lock();
+    if (m_ring.size() != size) {
+        m_ring = QImage(size, QImage::Format_RGB32);
+        m_ring.fill(levelColors().first());
+        m_column = 0;
+    }
+    m_mutex.unlock();
+
+    SharedFrame sFrame;
+    if (!takeFrame(sFrame) || !m_plan)
+        return;
+
+    // Every hop of the audio since the last refresh becomes one column.
+    AudioTap &tap = AudioTap::singleton();
+    const AudioTap::Window window = tap.since(m_position, AudioTap::kCapacity / 4);
+    if (window.frames < kWindowSize)
+        return;
+    const int hop = qMax(1, window.frequency / kColumnsPerSecond);
+    int columns = (window.frames - kWindowSize) / hop + 1;
+    int offset = 0;
+    if (columns > width) {
+        // Skip the columns that would scroll out before they are shown.
+        offset = (columns - width) * hop;
+        columns = width;
+    }
+
+    updateRows(height, window.frequency);
+    m_columnBuffer.resize(columns * height);
+    for (int c = 0; c < columns; ++c) {
+        computeColumn(window.samples + qint64(offset + c * hop) * window.channels,
+                      window.channels,
+                      m_columnBuffer.data() + c * height);
+    }
+    if (!tap.isValid(window)) {
+        // It was overwritten while reading; start again from the latest.
+        m_position = 0;
+        return;
+    }
+    m_position = window.start + offset + qint64(columns) * hop;
+
+    QMutexLocker locker(&m_mutex);
+    for (int c = 0; c < columns; ++c) {
+        const QRgb *column = m_columnBuffer.constData() + c * height;
+        for (int y = 0; y < height; ++y)
+            reinterpret_cast<QRgb *>(m_ring.scanLine(y))[m_column] = column[y];
+        m_column = (m_column + 1) % width;
+    }
+}
+
+void AudioSpectrogramScopeWidget::computeColumn(const float *samples, int channels, QRgb *column)
+{
+    for (int i = 0; i < kWindowSize; ++i) {
+        const float *frame = samples + i * channels;
+        double sum = 0.0;
+        for (int c = 0; c < channels; ++c)
+            sum += frame[c];
+        m_fftInput[i] = sum / channels * m_hann[i];
+    }
+    fftw_execute_dft_r2c(m_plan.data(), m_fftInput, m_fftOutput);
+
+    // 2 for the one-sided spectrum and 2 for the gain of the Hann window.
+    const double scale = 4.0 / kWindowSize;
+    const QVector<QRgb> &colors = levelColors();
+    for (int y = 0; y < m_rowFirstBin.size(); ++y) {
+        const int first = m_rowFirstBin[y];
+        if (first < 0) {
+            column[y] = colors.first();
+            continue;
+        }
+        // Rows that span several bins show the loudest one.
+        double power = 0.0;
+        for (int b = first; b <= m_rowLastBin[y]; ++b) {
+            const double re = m_fftOutput[b][0];
+            const double im = m_fftOutput[b][1];
+            power = qMax(power, re * re + im * im);
+        }
+        const double db = 10.0 * std::log10(power * scale * scale + 1e-20);
+        const int level = int((db - kMinDb) * (colors.size() - 1) / -kMinDb);
+        column[y] = colors[qBound(0, level, int(colors.size()) - 1)];
+    }
+}
+
+void AudioSpectrogramScopeWidget::updateRows(int height, int frequency)
+{
+    if (m_rowFirstBin.size() == height && m_rowsFrequency == frequency)
+        return;
+    m_rowFirstBin.resize(height);
+    m_rowLastBin.resize(height);
+    m_rowsFrequency = frequency;
+    const double binWidth = double(frequency) / kWindowSize;
+    const double ratio = kMaxFrequency / kMinFrequency;
+    const int lastBin = kWindowSize / 2;
+    for (int y = 0; y < height; ++y) {
+        const double high = kMinFrequency * std::pow(ratio, 1.0 - double(y) / height);
+        const double low = kMinFrequency * std::pow(ratio, 1.0 - double(y + 1) / height);
+        const int first = qRound(low / binWidth);
+        const int last = qMax(first, qRound(high / binWidth) - 1);
+        // Frequencies above Nyquist stay black.
+        m_rowFirstBin[y] = first > lastBin ? -1 : first;
+        m_rowLastBin[y] = qMin(last, lastBin);
+    }
+}
+
+void AudioSpectrogramScopeWidget::paintEvent(QPaintEvent *)
+{
+    if (!isVisible())
+        return;
+
+    QPainter p(this);
+    m_mutex.lock();
+    if (m_ring.isNull()) {
+        p.fillRect(rect(), levelColors().first());
+    } else {
+        // The oldest column is at m_column, so it goes on the left.
+        const int w = m_ring.width();
+        const int h = m_ring.height();
+        const int older = w - m_column;
+        p.drawImage(QRect(0, 0, older, h), m_ring, QRect(m_column, 0, older, h));
+        if (m_column > 0)
+            p.drawImage(QRect(older, 0, m_column, h), m_ring, QRect(0, 0, m_column, h));
+    }
+    m_mutex.unlock();
+    p.drawPixmap(0, 0, graticule());
+    p.end();
+}
+
+void AudioSpectrogramScopeWidget::drawGraticule(QPainter &p)
+{
+    QFont font = QWidget::font();
+    int fontSize = font.pointSize() - (font.pointSize() > 10 ? 2 : (font.pointSize() > 8 ? 1 : 0));
+    font.setPointSize(fontSize);
+    QPen pen;
+    pen.setColor(TEXT_COLOR);
+    pen.setWidth(qRound(devicePixelRatioF()));
+    p.setPen(pen);
+    p.setFont(font);
+
+    const int textpad = 3;
+    const struct
+    {
+        double frequency;
+        QString label;
+    } lines[] = {{100.0, tr("100 Hz")}, {1000.0, tr("1 kHz")}, {10000.0, tr("10 kHz")}};
+    for (const auto &line : lines) {
+        const qreal y = frequencyToY(line.frequency, height());
+        p.drawLine(QPointF(0, y), QPointF(width(), y));
+        p.drawText(textpad, y - textpad, line.label);
+    }
+}
+
+QString AudioSpectrogramScopeWidget::getTitle()
+{
+    return tr("Audio Spectrogram");
+}
@@ -0,0 +1,80 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOSPECTROGRAMSCOPEWIDGET_H
+#define AUDIOSPECTROGRAMSCOPEWIDGET_H
+
+#include "fftplancache.h"
+#include "scopewidget.h"
+
+#include <QImage>
+#include <QMutex>
+#include <QVector>
+
+/*!
+  \class AudioSpectrogramScopeWidget
+  \brief Shows the recent audio as a scrolling image of frequency over time.
+
+  The refresh thread reads every sample from the AudioTap and runs a short
+  time Fourier transform with a Hann window, one column per hop. Frequencies
+  are on a logarithmic scale from 20 Hz to 20 kHz, and the level of each
+  pixel is colored from -100 to 0 dBFS.
+
+  The columns are written into a ring image where only the oldest column is
+  replaced, so a refresh costs the new columns instead of redrawing the whole
+  image. paintEvent() shows the ring as two blits, oldest part first.
+*/
+
+class AudioSpectrogramScopeWidget Q_DECL_FINAL : public ScopeWidget
+{
+    Q_OBJECT
+
+public:
+    explicit AudioSpectrogramScopeWidget();
+    ~AudioSpectrogramScopeWidget();
+    QString getTitle() Q_DECL_OVERRIDE;
+
+private:
+    // Functions run in scope thread.
+    void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
+    void computeColumn(const float *samples, int channels, QRgb *column);
+    void updateRows(int height, int frequency);
+
+    // Functions run in GUI thread.
+    void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
+    void drawGraticule(QPainter &p) Q_DECL_OVERRIDE;
+
+    // Members accessed only in scope thread (no thread protection).
+    qint64 m_position;
+    FftPlanCache::Plan m_plan;
+    double *m_fftInput;
+    fftw_complex *m_fftOutput;
+    QVector<double> m_hann;
+    // The first and last bin of each row from the top.
+    QVector<int> m_rowFirstBin;
+    QVector<int> m_rowLastBin;
+    int m_rowsFrequency;
+    QVector<QRgb> m_columnBuffer;
+
+    // Members accessed in multiple threads (mutex protected).
+    QMutex m_mutex;
+    QImage m_ring;
+    // The column that is written next, which is also the oldest one.
+    int m_column;
+};
+
+#endif // AUDIOSPECTROGRAMSCOPEWIDGET_H
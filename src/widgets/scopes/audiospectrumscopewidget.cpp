@@ -19,9 +19,9 @@
 #include "audiospectrumscopewidget.h"
 
 #include "Logger.h"
+#include "audiotap.h"
 #include "widgets/audiometerwidget.h"
 
-#include <MltProfile.h>
 #include <QPainter>
 #include <QVBoxLayout>
 #include <QtAlgorithms>
@@ -93,6 +93,7 @@ static const int AUDIBLE_BAND_COUNT = LAST_AUDIBLE_BAND_INDEX - FIRST_AUDIBLE_BA
 
 AudioSpectrumScopeWidget::AudioSpectrumScopeWidget()
     : ScopeWidget("AudioSpectrum")
+    , m_spectrumEnd(-1)
     , m_audioMeter(0)
 {
     LOG_DEBUG() << "begin";
@@ -100,11 +101,6 @@ AudioSpectrumScopeWidget::AudioSpectrumScopeWidget()
     // Setup this widget
     qRegisterMetaType<QVector<double>>("QVector<double>");
 
-    // Create the FFT filter
-    Mlt::Profile profile;
-    m_filter = new Mlt::Filter(profile, "fft");
-    m_filter->set("window_size", WINDOW_SIZE);
-
     // Add the audio signal widget
     QVBoxLayout *vlayout = new QVBoxLayout(this);
     vlayout->setContentsMargins(4, 4, 4, 4);
@@ -131,17 +127,14 @@ AudioSpectrumScopeWidget::AudioSpectrumScopeWidget()
     LOG_DEBUG() << "end";
 }
 
-AudioSpectrumScopeWidget::~AudioSpectrumScopeWidget()
-{
-    delete m_filter;
-}
+AudioSpectrumScopeWidget::~AudioSpectrumScopeWidget() {}
 
-void AudioSpectrumScopeWidget::processSpectrum()
+void AudioSpectrumScopeWidget::processSpectrum(const AudioTap::Spectrum &spectrum)
 {
     QVector<double> bands(AUDIBLE_BAND_COUNT);
-    float *bins = (float *) m_filter->get_data("bins");
-    int bin_count = m_filter->get_int("bin_count");
-    double bin_width = m_filter->get_double("bin_width");
+    const float *bins = spectrum.magnitudes.constData();
+    int bin_count = spectrum.magnitudes.size();
+    double bin_width = spectrum.binWidth;
 
     int band = 0;
     bool firstBandFound = false;
@@ -190,25 +183,15 @@ void AudioSpectrumScopeWidget::processSpectrum()
 
 void AudioSpectrumScopeWidget::refreshScope(const QSize & /*size*/, bool /*full*/)
 {
-    bool refresh = false;
     SharedFrame sFrame;
-
-    while (m_queue.count() > 0) {
-        sFrame = m_queue.pop();
-        if (sFrame.is_valid() && sFrame.get_audio_samples() > 0) {
-            mlt_audio_format format = mlt_audio_s16;
-            int channels = sFrame.get_audio_channels();
-            int frequency = sFrame.get_audio_frequency();
-            int samples = sFrame.get_audio_samples();
-            Mlt::Frame mFrame = sFrame.clone(true, false, false);
-            m_filter->process(mFrame);
-            mFrame.get_audio(format, frequency, channels, samples);
-            refresh = true;
-        }
-    }
-
-    if (refresh) {
-        processSpectrum();
+    if (!takeFrame(sFrame))
+        return;
+
+    // The spectrum of the latest audio is shared with other spectral scopes.
+    const AudioTap::Spectrum spectrum = AudioTap::singleton().spectrum(WINDOW_SIZE);
+    if (spectrum.end != m_spectrumEnd && !spectrum.magnitudes.isEmpty()) {
+        m_spectrumEnd = spectrum.end;
+        processSpectrum(spectrum);
     }
 }
 
@@ -19,10 +19,9 @@
 #ifndef AUDIOSPECTRUMSCOPEWIDGET_H
 #define AUDIOSPECTRUMSCOPEWIDGET_H
 
+#include "audiotap.h"
 #include "scopewidget.h"
 
-#include <MltFilter.h>
-
 class AudioMeterWidget;
 
 class AudioSpectrumScopeWidget Q_DECL_FINAL : public ScopeWidget
@@ -37,10 +36,10 @@ public:
 private:
     // Functions run in scope thread.
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
-    void processSpectrum();
+    void processSpectrum(const AudioTap::Spectrum &spectrum);
 
     // Members accessed by scope thread.
-    Mlt::Filter *m_filter;
+    qint64 m_spectrumEnd;
 
     // Members accessed only in the GUI thread
     AudioMeterWidget *m_audioMeter;
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2024 Meltytech, LLC
+ * Copyright (c) 2024-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,6 +18,7 @@
 #include "audiosurroundscopewidget.h"
 
 #include "Logger.h"
+#include "audiotap.h"
 #include "settings.h"
 #include "widgets/iecscale.h"
 
@@ -86,30 +87,25 @@ void AudioSurroundScopeWidget::refreshScope(const QSize &size, bool full)
         p.end();
     }
 
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
 
     if (m_frame.is_valid() && m_frame.get_audio_samples() > 0) {
         // Calculate the peak level for each channel
-        int channels = m_frame.get_audio_channels();
-        int samples = m_frame.get_audio_samples();
+        // The tap has the same audio as floats, so this shares the peak meter's code.
+        AudioTap &tap = AudioTap::singleton();
+        const AudioTap::Window window = tap.latest(m_frame.get_audio_samples());
+        int channels = qMin(window.channels, int(AudioTap::kMaxChannels));
+        float peaks[AudioTap::kMaxChannels];
+        AudioTap::peaks(window, peaks);
+        if (!tap.isValid(window))
+            channels = 0;
         QVector<double> levels;
-        const int16_t *audio = m_frame.get_audio();
         for (int c = 0; c < channels; c++) {
-            int16_t peak = 0;
-            const int16_t *p = audio + c;
-            for (int s = 0; s < samples; s++) {
-                int16_t sample = abs(*p);
-                if (sample > peak)
-                    peak = sample;
-                p += channels;
-            }
             double levelDb = 0.0;
-            if (peak == 0) {
+            if (peaks[c] == 0.0f) {
                 levelDb = -100.0;
             } else {
-                levelDb = 20 * log10((double) peak / (double) std::numeric_limits<int16_t>::max());
+                levelDb = 20 * log10((double) peaks[c]);
             }
             levels << IEC_ScaleMax(levelDb, 0);
         }
@@ -0,0 +1,197 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audiotap.h"
+
+#include <QMutexLocker>
+#include <QtMath>
+
+#include <algorithm>
+#include <cmath>
+
+AudioTap &AudioTap::singleton()
+{
+    static AudioTap instance;
+    return instance;
+}
+
+AudioTap::AudioTap()
+    : m_samples(2 * kCapacity * kMaxChannels, 0.0f)
+    , m_generation(0)
+    , m_channels(0)
+    , m_frequency(0)
+    , m_written(0)
+    , m_writing(0)
+    , m_fftSize(0)
+    , m_fftInput(nullptr)
+    , m_fftOutput(nullptr)
+{
+    m_buffer = m_samples.data();
+}
+
+AudioTap::~AudioTap()
+{
+    fftw_free(m_fftInput);
+    fftw_free(m_fftOutput);
+}
+
+void AudioTap::write(const SharedFrame &frame)
+{
+    const int channels = frame.get_audio_channels();
+    const int frequency = frame.get_audio_frequency();
+    const int samples = frame.get_audio_samples();
+    if (channels <= 0 || channels > kMaxChannels || frequency <= 0 || samples <= 0
+        || samples > kCapacity)
+        return;
+    const int16_t *audio = frame.get_audio();
+    if (!audio)
+        return;
+
+    if (channels != m_channels.loadRelaxed() || frequency != m_frequency.loadRelaxed()) {
+        // Readers ignore the ring while the generation is odd.
+        m_generation.fetchAndAddOrdered(1);
+        m_channels.storeRelaxed(channels);
+        m_frequency.storeRelaxed(frequency);
+        m_written.store(0, std::memory_order_relaxed);
+        m_writing.store(0, std::memory_order_relaxed);
+        m_generation.fetchAndAddOrdered(1);
+    }
+
+    const qint64 start = m_written.load(std::memory_order_relaxed);
+    m_writing.store(start + samples, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    const int mirror = kCapacity * channels;
+    for (int i = 0; i < samples; ++i) {
+        float *dst = m_buffer + ((start + i) % kCapacity) * channels;
+        const int16_t *src = audio + i * channels;
+        for (int c = 0; c < channels; ++c) {
+            const float value = src[c] / 32768.0f;
+            dst[c] = value;
+            dst[c + mirror] = value;
+        }
+    }
+    m_written.store(start + samples, std::memory_order_release);
+}
+
+AudioTap::Window AudioTap::latest(int frames) const
+{
+    return window(0, frames);
+}
+
+AudioTap::Window AudioTap::since(qint64 position, int maxFrames) const
+{
+    return window(position, maxFrames);
+}
+
+AudioTap::Window AudioTap::window(qint64 position, int maxFrames) const
+{
+    Window result;
+    const int generation = m_generation.loadAcquire();
+    if (generation & 1)
+        return result;
+    const int channels = m_channels.loadRelaxed();
+    const int frequency = m_frequency.loadRelaxed();
+    const qint64 end = m_written.load(std::memory_order_acquire);
+    if (m_generation.loadAcquire() != generation || channels <= 0)
+        return result;
+
+    const qint64 first = qMax<qint64>(0, end - qBound(0, maxFrames, kCapacity));
+    // A position past the end is from before the ring started over.
+    result.start = position > end ? first : qMax(first, position);
+    result.frames = end - result.start;
+    result.channels = channels;
+    result.frequency = frequency;
+    result.generation = generation;
+    result.samples = m_buffer + (result.start % kCapacity) * channels;
+    return result;
+}
+
+bool AudioTap::isValid(const Window &window) const
+{
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return m_generation.loadRelaxed() == window.generation
+           && m_writing.load(std::memory_order_relaxed) - kCapacity <= window.start;
+}
+
+void AudioTap::peaks(const Window &window, float peaks[kMaxChannels])
+{
+    std::fill(peaks, peaks + kMaxChannels, 0.0f);
+    const int channels = qBound(0, window.channels, int(kMaxChannels));
+    if (!window.samples || channels == 0)
+        return;
+    // Walk the samples in memory order with a running maximum per channel,
+    // which the compiler can vectorize, instead of striding once per channel.
+    float running[kMaxChannels] = {};
+    const float *p = window.samples;
+    for (int s = 0; s < window.frames; ++s, p += window.channels) {
+        for (int c = 0; c < channels; ++c)
+            running[c] = std::max(running[c], std::fabs(p[c]));
+    }
+    std::copy(running, running + channels, peaks);
+}
+
+AudioTap::Spectrum AudioTap::spectrum(int windowSize)
+{
+    QMutexLocker locker(&m_spectrumMutex);
+    const Window window = latest(windowSize);
+    if (window.frames <= 0 || windowSize < 2)
+        return Spectrum();
+    if (m_spectrum.end == window.end() && m_spectrum.generation == window.generation
+        && m_spectrum.magnitudes.size() == windowSize / 2 + 1)
+        return m_spectrum;
+
+    if (m_fftSize != windowSize) {
+        fftw_free(m_fftInput);
+        fftw_free(m_fftOutput);
+        m_fftInput = fftw_alloc_real(windowSize);
+        m_fftOutput = fftw_alloc_complex(windowSize / 2 + 1);
+        m_fftPlan = FftPlanCache::realToComplex(windowSize);
+        m_fftSize = windowSize;
+        m_hann.resize(windowSize);
+        for (int i = 0; i < windowSize; ++i)
+            m_hann[i] = 0.5 * (1.0 - std::cos(2.0 * M_PI * i / (windowSize - 1)));
+    }
+
+    // Mix down to mono. Before the start of the audio it is silent.
+    const int silent = windowSize - window.frames;
+    std::fill(m_fftInput, m_fftInput + silent, 0.0);
+    for (int i = 0; i < window.frames; ++i) {
+        const float *samples = window.samples + i * window.channels;
+        double sum = 0.0;
+        for (int c = 0; c < window.channels; ++c)
+            sum += samples[c];
+        m_fftInput[silent + i] = sum / window.channels * m_hann[silent + i];
+    }
+    if (!isValid(window) || !m_fftPlan)
+        return m_spectrum;
+    fftw_execute_dft_r2c(m_fftPlan.data(), m_fftInput, m_fftOutput);
+
+    // 2 for the one-sided spectrum and 2 for the gain of the Hann window.
+    const double scale = 4.0 / windowSize;
+    Spectrum result;
+    result.magnitudes.resize(windowSize / 2 + 1);
+    for (int i = 0; i < result.magnitudes.size(); ++i) {
+        const double re = m_fftOutput[i][0];
+        const double im = m_fftOutput[i][1];
+        result.magnitudes[i] = std::sqrt(re * re + im * im) * scale;
+    }
+    result.binWidth = double(window.frequency) / windowSize;
+    result.end = window.end();
+    result.generation = window.generation;
+    m_spectrum = result;
+    return result;
+}
@@ -0,0 +1,136 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef AUDIOTAP_H
+#define AUDIOTAP_H
+
+#include "fftplancache.h"
+#include "sharedframe.h"
+
+#include <QAtomicInt>
+#include <QMutex>
+#include <QVector>
+
+#include <atomic>
+
+/*!
+  \class AudioTap
+  \brief The AudioTap keeps the recent audio of the displayed frames for the
+  audio scopes.
+
+  \threadsafe
+
+  The ScopeController writes the audio of every displayed frame once as
+  interleaved floats into a ring buffer. Audio scopes read windows of it
+  directly from their refresh threads without taking a lock or copying.
+
+  Every sample is stored twice, one ring length apart, so that any window up
+  to kCapacity frames is contiguous in memory. A window can be overwritten
+  while a slow reader is still using it, so a reader must check isValid()
+  after reading and discard the results if it returns false. When the number
+  of channels or the sample rate changes, the ring starts over and the
+  windows read before are no longer valid.
+
+  The magnitude spectrum of the latest audio is computed at most once per
+  displayed frame for each window size and shared by all of the scopes that
+  ask for it.
+*/
+
+class AudioTap
+{
+public:
+    //! The number of frames of audio that are kept.
+    static const int kCapacity = 1 << 16;
+    static const int kMaxChannels = 8;
+
+    struct Window
+    {
+        const float *samples = nullptr; ///< Interleaved and contiguous
+        int frames = 0;
+        int channels = 0;
+        int frequency = 0;
+        qint64 start = 0; ///< The position of the first frame
+        int generation = 0;
+
+        qint64 end() const { return start + frames; }
+    };
+
+    struct Spectrum
+    {
+        //! Magnitudes where a full scale sine reads 1.0
+        QVector<float> magnitudes;
+        double binWidth = 0.0;
+        qint64 end = -1;
+        int generation = 0;
+    };
+
+    static AudioTap &singleton();
+
+    //! Appends the audio of \a frame. Only one thread may call this.
+    void write(const SharedFrame &frame);
+
+    //! Returns up to \a frames of the most recent audio.
+    Window latest(int frames) const;
+
+    /*!
+      Returns the audio written since \a position, but not more than the
+      latest \a maxFrames. Pass the end() of the previous window to read
+      every sample once. A \a position that is not in the ring, for example
+      after it started over, returns the latest \a maxFrames.
+    */
+    Window since(qint64 position, int maxFrames) const;
+
+    //! Returns false if \a window may have been overwritten since it was read.
+    bool isValid(const Window &window) const;
+
+    //! Sets \a peaks to the largest absolute sample of each channel in \a window.
+    static void peaks(const Window &window, float peaks[kMaxChannels]);
+
+    /*!
+      Returns the magnitude spectrum of the latest \a windowSize frames mixed
+      to mono with a Hann window. The result is shared by all callers until
+      more audio is written.
+    */
+    Spectrum spectrum(int windowSize);
+
+private:
+    AudioTap();
+    ~AudioTap();
+    Q_DISABLE_COPY(AudioTap)
+
+    Window window(qint64 position, int maxFrames) const;
+
+    QVector<float> m_samples;
+    float *m_buffer;
+    // Odd while the format changes.
+    QAtomicInt m_generation;
+    QAtomicInt m_channels;
+    QAtomicInt m_frequency;
+    // The end of the frames that are complete and of those being written.
+    std::atomic<qint64> m_written;
+    std::atomic<qint64> m_writing;
+
+    QMutex m_spectrumMutex;
+    Spectrum m_spectrum;
+    int m_fftSize;
+    QVector<double> m_hann;
+    double *m_fftInput;
+    fftw_complex *m_fftOutput;
+    FftPlanCache::Plan m_fftPlan;
+};
+
+#endif // AUDIOTAP_H
@@ -130,9 +130,7 @@ void AudioVectorScopeWidget::refreshScope(const QSize &size, bool full)
 {
     Q_UNUSED(full)
 
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
 
     qreal side = qMin(size.width(), size.height());
 
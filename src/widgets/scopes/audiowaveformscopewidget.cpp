@@ -75,9 +75,7 @@ void AudioWaveformScopeWidget::refreshScope(const QSize &size, bool full)
 {
     m_mutex.lock();
     QSize prevSize = m_displayWave.size();
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
     m_mutex.unlock();
 
     // Check if a full refresh should be forced.
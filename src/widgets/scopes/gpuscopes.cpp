@@ -0,0 +1,340 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "gpuscopes.h"
+
+#include "Logger.h"
+
+#include <QAtomicInt>
+#include <QOpenGLContext>
+#include <QOpenGLFramebufferObject>
+#include <QOpenGLFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+
+#ifndef GL_RED
+#define GL_RED 0x1903
+#endif
+#ifndef GL_R32F
+#define GL_R32F 0x822E
+#endif
+
+// The same step as WaveformTable so that both paths saturate alike.
+static const int kIntensityStep = 0x0f;
+
+static QAtomicInt g_isEnabled(0);
+static QAtomicInt g_requested(0);
+
+// Every vertex is one pixel of a plane; there are no vertex attributes.
+static const char *kWaveformVertexShader
+    = "#version 130\n"
+      "uniform sampler2D plane;"
+      "uniform int width;"
+      "void main(void) {"
+      "  ivec2 pixel = ivec2(gl_VertexID % width, gl_VertexID / width);"
+      "  float level = floor(texelFetch(plane, pixel, 0).r * 255.0 + 0.5);"
+      "  gl_Position = vec4((float(pixel.x) + 0.5) / float(width) * 2.0 - 1.0,"
+      "                     (level + 0.5) / 128.0 - 1.0, 0.0, 1.0);"
+      "}";
+
+static const char *kVectorscopeVertexShader
+    = "#version 130\n"
+      "uniform sampler2D Utex, Vtex;"
+      "uniform int width;"
+      "void main(void) {"
+      "  ivec2 pixel = ivec2(gl_VertexID % width, gl_VertexID / width);"
+      "  float u = floor(texelFetch(Utex, pixel, 0).r * 255.0 + 0.5);"
+      "  float v = floor(texelFetch(Vtex, pixel, 0).r * 255.0 + 0.5);"
+      "  gl_Position = vec4((u + 0.5) / 128.0 - 1.0, (v + 0.5) / 128.0 - 1.0, 0.0, 1.0);"
+      "}";
+
+// Rows 0 to 3 of the target are the Y, R, G and B bins. The conversion is the
+// same as the video widget uses to display the frame.
+static const char *kHistogramVertexShader
+    = "#version 130\n"
+      "uniform sampler2D Ytex, Utex, Vtex;"
+      "uniform int width;"
+      "uniform int pixels;"
+      "uniform int colorspace;"
+      "void main(void) {"
+      "  int row = gl_VertexID / pixels;"
+      "  int i = gl_VertexID % pixels;"
+      "  ivec2 pixel = ivec2(i % width, i / width);"
+      "  float value = texelFetch(Ytex, pixel, 0).r;"
+      "  if (row > 0) {"
+      "    vec3 texel;"
+      "    texel.r = value - 16.0/255.0;"
+      "    texel.g = texelFetch(Utex, pixel / 2, 0).r - 128.0/255.0;"
+      "    texel.b = texelFetch(Vtex, pixel / 2, 0).r - 128.0/255.0;"
+      "    mat3 coefficients;"
+      "    if (colorspace == 601) {"
+      "      coefficients = mat3(1.1643, 1.1643, 1.1643,"
+      "                          0.0, -0.39173, 2.017,"
+      "                          1.5958, -0.8129, 0.0);"
+      "    } else if (colorspace == 2020) {"
+      "      coefficients = mat3(1.1643, 1.1643, 1.1643,"
+      "                          0.0, -0.1873, 2.1418,"
+      "                          1.7167, -0.6504, 0.0);"
+      "    } else {"
+      "      coefficients = mat3(1.1643, 1.1643, 1.1643,"
+      "                          0.0, -0.213, 2.112,"
+      "                          1.793, -0.533, 0.0);"
+      "    }"
+      "    value = clamp(coefficients * texel, 0.0, 1.0)[row - 1];"
+      "  }"
+      "  float bin = floor(value * 255.0 + 0.5);"
+      "  gl_Position = vec4((bin + 0.5) / 128.0 - 1.0, (float(row) + 0.5) / 2.0 - 1.0, 0.0, 1.0);"
+      "}";
+
+static const char *kFragmentShader = "#version 130\n"
+                                     "uniform float intensity;"
+                                     "void main(void) {"
+                                     "  gl_FragColor = vec4(intensity, intensity, intensity, 0.0);"
+                                     "}";
+
+static QOpenGLShaderProgram *createShader(const char *vertex)
+{
+    auto shader = new QOpenGLShaderProgram;
+    if (!shader->addShaderFromSourceCode(QOpenGLShader::Vertex, vertex)
+        || !shader->addShaderFromSourceCode(QOpenGLShader::Fragment, kFragmentShader)
+        || !shader->link()) {
+        LOG_WARNING() << "failed to build a GPU scope shader" << shader->log();
+        delete shader;
+        return nullptr;
+    }
+    return shader;
+}
+
+const char *GpuScopes::analysisName(Analysis analysis)
+{
+    switch (analysis) {
+    case LumaWaveform:
+        return "gpuscopes.waveform";
+    case Vectorscope:
+        return "gpuscopes.vectorscope";
+    case Histogram:
+        return "gpuscopes.histogram";
+    }
+    return "";
+}
+
+bool GpuScopes::hasAnalyses(const SharedFrame &frame, int analyses)
+{
+    if (!analyses)
+        return false;
+    for (auto analysis : {LumaWaveform, Vectorscope, Histogram}) {
+        if ((analyses & analysis) && !frame.get_analysis(analysisName(analysis)).isValid())
+            return false;
+    }
+    return true;
+}
+
+void GpuScopes::setEnabled(bool enabled)
+{
+    g_isEnabled.storeRelaxed(enabled);
+}
+
+bool GpuScopes::isEnabled()
+{
+    return g_isEnabled.loadRelaxed();
+}
+
+void GpuScopes::setRequested(int analyses)
+{
+    g_requested.storeRelaxed(analyses);
+}
+
+int GpuScopes::requested()
+{
+    return g_requested.loadRelaxed();
+}
+
+GpuScopes::GpuScopes()
+    : m_isInitialized(false)
+    , m_isSupported(false)
+    , m_maxTextureSize(0)
+{}
+
+GpuScopes::~GpuScopes() {}
+
+void GpuScopes::analyze(QOpenGLContext *context,
+                        const SharedFrame &frame,
+                        const GLuint textures[3],
+                        int colorspace)
+{
+    const int analyses = isEnabled() ? requested() : 0;
+    if (!analyses || !textures[0] || !frame.is_valid())
+        return;
+    if (!m_isInitialized)
+        m_isSupported = initialize(context);
+    const int width = frame.get_image_width();
+    const int height = frame.get_image_height();
+    if (!m_isSupported || width < 2 || height < 2 || width > m_maxTextureSize)
+        return;
+
+    QOpenGLFunctions *f = context->functions();
+    m_vao->bind();
+    f->glDisable(GL_DEPTH_TEST);
+    f->glEnable(GL_BLEND);
+    f->glBlendFunc(GL_ONE, GL_ONE);
+    if (analyses & LumaWaveform) {
+        const QImage image = renderWaveform(context, textures, width, height);
+        if (!image.isNull())
+            frame.set_analysis(analysisName(LumaWaveform), image);
+    }
+    if (analyses & Vectorscope) {
+        const QImage image = renderVectorscope(context, textures, width / 2, height / 2);
+        if (!image.isNull())
+            frame.set_analysis(analysisName(Vectorscope), image);
+    }
+    if (analyses & Histogram) {
+        const auto bins = renderHistogram(context, textures, width, height, colorspace);
+        if (!bins.isEmpty())
+            frame.set_analysis(analysisName(Histogram), QVariant::fromValue(bins));
+    }
+    f->glDisable(GL_BLEND);
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    m_vao->release();
+}
+
+bool GpuScopes::initialize(QOpenGLContext *context)
+{
+    m_isInitialized = true;
+    if (context->isOpenGLES() || context->format().version() < qMakePair(3, 0)) {
+        LOG_INFO() << "GPU scopes need OpenGL 3.0";
+        return false;
+    }
+    context->functions()->glGetIntegerv(GL_MAX_TEXTURE_SIZE, &m_maxTextureSize);
+    // A core profile cannot draw without a vertex array object.
+    m_vao.reset(new QOpenGLVertexArrayObject);
+    m_vao->create();
+    m_waveformShader.reset(createShader(kWaveformVertexShader));
+    m_vectorscopeShader.reset(createShader(kVectorscopeVertexShader));
+    m_histogramShader.reset(createShader(kHistogramVertexShader));
+    return m_waveformShader && m_vectorscopeShader && m_histogramShader;
+}
+
+QOpenGLFramebufferObject *GpuScopes::target(std::unique_ptr<QOpenGLFramebufferObject> &target,
+                                            int width,
+                                            int height,
+                                            GLenum internalFormat)
+{
+    if (!target || target->size() != QSize(width, height)) {
+        target.reset(new QOpenGLFramebufferObject(width,
+                                                  height,
+                                                  QOpenGLFramebufferObject::NoAttachment,
+                                                  GL_TEXTURE_2D,
+                                                  internalFormat));
+    }
+    return target->isValid() ? target.get() : nullptr;
+}
+
+QImage GpuScopes::renderWaveform(QOpenGLContext *context,
+                                 const GLuint textures[3],
+                                 int width,
+                                 int height)
+{
+    QOpenGLFramebufferObject *fbo = target(m_waveformTarget, width, 256, GL_RGBA8);
+    if (!fbo)
+        return QImage();
+    QOpenGLFunctions *f = context->functions();
+    fbo->bind();
+    f->glViewport(0, 0, width, 256);
+    f->glClearColor(0.0, 0.0, 0.0, 1.0);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+    f->glActiveTexture(GL_TEXTURE0);
+    f->glBindTexture(GL_TEXTURE_2D, textures[0]);
+    m_waveformShader->bind();
+    m_waveformShader->setUniformValue("plane", 0);
+    m_waveformShader->setUniformValue("width", width);
+    m_waveformShader->setUniformValue("intensity", GLfloat(kIntensityStep / 255.0));
+    f->glDrawArrays(GL_POINTS, 0, width * height);
+    m_waveformShader->release();
+    fbo->release();
+    // Level 255 is at the top, the same as WaveformTable::render().
+    return fbo->toImage(true).convertToFormat(QImage::Format_RGBX8888);
+}
+
+QImage GpuScopes::renderVectorscope(QOpenGLContext *context,
+                                    const GLuint textures[3],
+                                    int width,
+                                    int height)
+{
+    QOpenGLFramebufferObject *fbo = target(m_vectorscopeTarget, 256, 256, GL_RGBA8);
+    if (!fbo)
+        return QImage();
+    QOpenGLFunctions *f = context->functions();
+    fbo->bind();
+    f->glViewport(0, 0, 256, 256);
+    f->glClearColor(0.0, 0.0, 0.0, 1.0);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+    f->glActiveTexture(GL_TEXTURE0);
+    f->glBindTexture(GL_TEXTURE_2D, textures[1]);
+    f->glActiveTexture(GL_TEXTURE1);
+    f->glBindTexture(GL_TEXTURE_2D, textures[2]);
+    m_vectorscopeShader->bind();
+    m_vectorscopeShader->setUniformValue("Utex", 0);
+    m_vectorscopeShader->setUniformValue("Vtex", 1);
+    m_vectorscopeShader->setUniformValue("width", width);
+    m_vectorscopeShader->setUniformValue("intensity", GLfloat(kIntensityStep / 255.0));
+    f->glDrawArrays(GL_POINTS, 0, width * height);
+    m_vectorscopeShader->release();
+    f->glBindTexture(GL_TEXTURE_2D, 0);
+    f->glActiveTexture(GL_TEXTURE0);
+    fbo->release();
+    return fbo->toImage(true).convertToFormat(QImage::Format_RGBX8888);
+}
+
+QVector<unsigned int> GpuScopes::renderHistogram(
+    QOpenGLContext *context, const GLuint textures[3], int width, int height, int colorspace)
+{
+    QOpenGLFramebufferObject *fbo = target(m_histogramTarget, 256, 4, GL_R32F);
+    if (!fbo)
+        return QVector<unsigned int>();
+    QOpenGLFunctions *f = context->functions();
+    fbo->bind();
+    f->glViewport(0, 0, 256, 4);
+    f->glClearColor(0.0, 0.0, 0.0, 0.0);
+    f->glClear(GL_COLOR_BUFFER_BIT);
+    for (int i = 0; i < 3; ++i) {
+        f->glActiveTexture(GL_TEXTURE0 + i);
+        f->glBindTexture(GL_TEXTURE_2D, textures[i]);
+    }
+    m_histogramShader->bind();
+    m_histogramShader->setUniformValue("Ytex", 0);
+    m_histogramShader->setUniformValue("Utex", 1);
+    m_histogramShader->setUniformValue("Vtex", 2);
+    m_histogramShader->setUniformValue("width", width);
+    m_histogramShader->setUniformValue("pixels", width * height);
+    m_histogramShader->setUniformValue("colorspace", colorspace);
+    m_histogramShader->setUniformValue("intensity", GLfloat(1.0));
+    f->glDrawArrays(GL_POINTS, 0, 4 * width * height);
+    m_histogramShader->release();
+
+    QVector<GLfloat> counts(4 * 256);
+    f->glReadPixels(0, 0, 256, 4, GL_RED, GL_FLOAT, counts.data());
+    for (int i = 2; i >= 0; --i) {
+        f->glActiveTexture(GL_TEXTURE0 + i);
+        f->glBindTexture(GL_TEXTURE_2D, 0);
+    }
+    fbo->release();
+
+    QVector<unsigned int> bins(counts.size());
+    for (int i = 0; i < counts.size(); ++i)
+        bins[i] = qRound(counts[i]);
+    return bins;
+}
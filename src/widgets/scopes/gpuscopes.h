@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef GPUSCOPES_H
+#define GPUSCOPES_H
+
+#include "sharedframe.h"
+
+#include <QImage>
+#include <QVector>
+#include <qopengl.h>
+
+#include <memory>
+
+class QOpenGLContext;
+class QOpenGLFramebufferObject;
+class QOpenGLShaderProgram;
+class QOpenGLVertexArrayObject;
+
+/*!
+  \class GpuScopes
+  \brief Renders video scopes from the YUV textures of the video widget.
+
+  The OpenGL video widget already uploads every displayed frame as Y, U and V
+  textures. GpuScopes draws one point per pixel of those textures with additive
+  blending into small offscreen targets, so only the scope results are read
+  back instead of the scopes walking the whole frame on the CPU. The results
+  are attached to the frame with SharedFrame::set_analysis() before it reaches
+  the scopes, and a scope uses its CPU path whenever a result is missing.
+
+  The luma waveform and the vectorscope saturate at the same intensity step as
+  WaveformTable, so they look the same as the CPU scopes. The histogram is
+  rendered into a floating point target to keep exact counts.
+
+  This needs desktop OpenGL 3.0 for texel fetches in the vertex shader and is
+  only used with threaded OpenGL, where the textures are uploaded before the
+  frame is passed on to the scopes.
+*/
+
+class GpuScopes
+{
+public:
+    enum Analysis {
+        LumaWaveform = 1, ///< A QImage that is the frame width by 256 levels
+        Vectorscope = 2,  ///< A 256x256 QImage with U as the column and V as the level
+        Histogram = 4     ///< A QVector<unsigned int> of Y, R, G and B bins, 256 each
+    };
+
+    static const char *analysisName(Analysis analysis);
+    /// Returns whether every analysis in \a analyses is attached to \a frame.
+    static bool hasAnalyses(const SharedFrame &frame, int analyses);
+
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    /// Sets the analyses that the active scopes can use.
+    static void setRequested(int analyses);
+    static int requested();
+
+    GpuScopes();
+    ~GpuScopes();
+
+    /*!
+      Renders the requested analyses of \a frame from its Y, U and V
+      \a textures and attaches them to \a frame. \a context must be current.
+    */
+    void analyze(QOpenGLContext *context,
+                 const SharedFrame &frame,
+                 const GLuint textures[3],
+                 int colorspace);
+
+private:
+    bool initialize(QOpenGLContext *context);
+    QOpenGLFramebufferObject *target(std::unique_ptr<QOpenGLFramebufferObject> &target,
+                                     int width,
+                                     int height,
+                                     GLenum internalFormat);
+    QImage renderWaveform(QOpenGLContext *context, const GLuint textures[3], int width, int height);
+    QImage renderVectorscope(QOpenGLContext *context,
+                             const GLuint textures[3],
+                             int width,
+                             int height);
+    QVector<unsigned int> renderHistogram(QOpenGLContext *context,
+                                          const GLuint textures[3],
+                                          int width,
+                                          int height,
+                                          int colorspace);
+
+    bool m_isInitialized;
+    bool m_isSupported;
+    GLint m_maxTextureSize;
+    std::unique_ptr<QOpenGLVertexArrayObject> m_vao;
+    std::unique_ptr<QOpenGLShaderProgram> m_waveformShader;
+    std::unique_ptr<QOpenGLShaderProgram> m_vectorscopeShader;
+    std::unique_ptr<QOpenGLShaderProgram> m_histogramShader;
+    std::unique_ptr<QOpenGLFramebufferObject> m_waveformTarget;
+    std::unique_ptr<QOpenGLFramebufferObject> m_vectorscopeTarget;
+    std::unique_ptr<QOpenGLFramebufferObject> m_histogramTarget;
+};
+
+#endif // GPUSCOPES_H
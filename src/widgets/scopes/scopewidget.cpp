@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2022 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,14 +18,72 @@
 #include "scopewidget.h"
 
 #include "Logger.h"
+#include "executors.h"
+#include "mltcontroller.h"
+#include "settings.h"
 
+#include <QElapsedTimer>
+#include <QLabel>
+#include <QPainter>
+#include <QVarLengthArray>
 #include <QtConcurrent/QtConcurrent>
 
+#include <algorithm>
+
+// Stripes smaller than this cost more to schedule and reduce than they save.
+static const int kMinStripeRows = 64;
+// Automatic scope resolution aims for refreshes between these times.
+static const qint64 kAutoSlowMs = 20;
+static const qint64 kAutoFastMs = 5;
+static const int kMaxDecimation = 4;
+// The statistics overlay is updated at most this often.
+static const qint64 kStatisticsIntervalMs = 500;
+
+static QAtomicInt g_resolution(ShotcutSettings::ScopeResolutionFull);
+static QAtomicInt g_statisticsVisible(0);
+
+// Averages blocks of factor x factor pixels with interleaved components.
+static void boxFilter(const uint8_t *src,
+                      int srcStride,
+                      int components,
+                      int factor,
+                      uint8_t *dst,
+                      int width,
+                      int height)
+{
+    const int area = factor * factor;
+    const int rowSize = width * components;
+    QVarLengthArray<int, 4096> sums(rowSize);
+    for (int y = 0; y < height; ++y) {
+        std::fill(sums.begin(), sums.end(), 0);
+        for (int k = 0; k < factor; ++k) {
+            const uint8_t *s = src + (size_t(y) * factor + k) * srcStride;
+            for (int x = 0; x < width; ++x) {
+                for (int i = 0; i < factor; ++i) {
+                    for (int c = 0; c < components; ++c)
+                        sums[x * components + c] += s[(x * factor + i) * components + c];
+                }
+            }
+        }
+        uint8_t *d = dst + size_t(y) * rowSize;
+        for (int i = 0; i < rowSize; ++i)
+            d[i] = (sums[i] + area / 2) / area;
+    }
+}
+
 ScopeWidget::ScopeWidget(const QString &name)
     : QWidget()
     , m_queue(3, DataQueue<SharedFrame>::OverflowModeDiscardOldest)
     , m_future()
-    , m_refreshPending(false)
+    , m_refreshPending(0)
+    , m_latency(0)
+    , m_refreshes(0)
+    , m_refreshTime(0)
+    , m_maxRefreshTime(0)
+    , m_graticuleColorspace(0)
+    , m_statisticsLabel(nullptr)
+    , m_takenReceived(-1)
+    , m_autoDecimation(1)
     , m_mutex()
     , m_forceRefresh(false)
     , m_size(0, 0)
@@ -37,18 +95,77 @@ ScopeWidget::ScopeWidget(const QString &name)
 
 ScopeWidget::~ScopeWidget() {}
 
+void ScopeWidget::setResolution(int resolution)
+{
+    g_resolution.storeRelaxed(resolution);
+}
+
+void ScopeWidget::setStatisticsVisible(bool visible)
+{
+    g_statisticsVisible.storeRelaxed(visible);
+}
+
+ScopeWidget::Statistics ScopeWidget::statistics() const
+{
+    Statistics result;
+    result.refreshes = m_refreshes.loadRelaxed();
+    result.averageRefreshUs = m_refreshTime.loadRelaxed();
+    result.maxRefreshUs = m_maxRefreshTime.loadRelaxed();
+    if (needsEveryFrame())
+        result.queueDepth = m_queue.count();
+    else
+        result.queueDepth = m_mailbox.isEmpty() ? 0 : 1;
+    result.droppedFrames = droppedFrames();
+    result.latencyMs = refreshLatency();
+    return result;
+}
+
+QThreadPool &ScopeWidget::stripePool()
+{
+    // A pool apart from the interactive one, which runs refreshScope() itself.
+    static QThreadPool *pool = nullptr;
+    static QMutex mutex;
+    QMutexLocker locker(&mutex);
+    if (!pool) {
+        pool = new QThreadPool;
+        pool->setMaxThreadCount(qMax(1, QThread::idealThreadCount() - 1));
+    }
+    return *pool;
+}
+
+int ScopeWidget::stripeCount(int rows)
+{
+    // The calling thread does one stripe.
+    return qBound(1, rows / kMinStripeRows, stripePool().maxThreadCount() + 1);
+}
+
 void ScopeWidget::onNewFrame(const SharedFrame &frame)
 {
-    m_queue.push(frame);
+    if (needsEveryFrame())
+        m_queue.push(frame);
+    else
+        m_mailbox.put({frame, QElapsedTimer::msecsSinceReference()});
     requestRefresh();
 }
 
+bool ScopeWidget::takeFrame(SharedFrame &frame)
+{
+    ReceivedFrame received;
+    if (!m_mailbox.take(received))
+        return false;
+    frame = received.frame;
+    m_takenReceived = received.received;
+    return true;
+}
+
 void ScopeWidget::requestRefresh()
 {
     if (m_future.isFinished()) {
-        m_future = QtConcurrent::run(&ScopeWidget::refreshInThread, this);
+        m_future = Executors::run(Executors::InteractiveExecutor,
+                                  &ScopeWidget::refreshInThread,
+                                  this);
     } else {
-        m_refreshPending = true;
+        m_refreshPending.storeRelease(1);
     }
 }
 
@@ -64,8 +181,33 @@ void ScopeWidget::refreshInThread()
     m_forceRefresh = false;
     m_mutex.unlock();
 
-    m_refreshPending = false;
+    m_refreshPending.storeRelease(0);
+    m_refreshSize = size;
+    QElapsedTimer timer;
+    timer.start();
     refreshScope(size, full);
+    const int refreshTime = timer.nsecsElapsed() / 1000;
+    const int averageTime = m_refreshTime.loadRelaxed();
+    m_refreshTime.storeRelaxed(averageTime ? (7 * averageTime + refreshTime) / 8 : refreshTime);
+    if (refreshTime > m_maxRefreshTime.loadRelaxed())
+        m_maxRefreshTime.storeRelaxed(refreshTime);
+    m_refreshes.fetchAndAddRelaxed(1);
+
+    if (m_takenReceived >= 0) {
+        // A moving average over about the last eight frames.
+        const int latency = QElapsedTimer::msecsSinceReference() - m_takenReceived;
+        const int average = m_latency.loadRelaxed();
+        m_latency.storeRelaxed(average ? (7 * average + latency) / 8 : latency);
+        m_takenReceived = -1;
+    }
+
+    // Adjust the automatic resolution to keep up with playback.
+    const auto elapsed = refreshTime / 1000;
+    const int decimation = m_autoDecimation.loadRelaxed();
+    if (elapsed > kAutoSlowMs && decimation < kMaxDecimation)
+        m_autoDecimation.storeRelaxed(decimation * 2);
+    else if (elapsed < kAutoFastMs && decimation > 1)
+        m_autoDecimation.storeRelaxed(decimation / 2);
     // Tell the GUI thread that the refresh is complete.
     QMetaObject::invokeMethod(this, "onRefreshThreadComplete", Qt::QueuedConnection);
 }
@@ -73,11 +215,66 @@ void ScopeWidget::refreshInThread()
 void ScopeWidget::onRefreshThreadComplete()
 {
     update();
-    if (m_refreshPending) {
+    updateStatisticsOverlay();
+    if (m_refreshPending.loadAcquire()) {
         requestRefresh();
     }
 }
 
+void ScopeWidget::updateStatisticsOverlay()
+{
+    if (!g_statisticsVisible.loadRelaxed()) {
+        if (m_statisticsLabel)
+            m_statisticsLabel->hide();
+        return;
+    }
+    if (m_statisticsLabel && m_statisticsLabel->isVisible() && m_statisticsTimer.isValid()
+        && m_statisticsTimer.elapsed() < kStatisticsIntervalMs)
+        return;
+    m_statisticsTimer.start();
+    if (!m_statisticsLabel) {
+        // A child widget so that it is drawn over any scope without its help.
+        m_statisticsLabel = new QLabel(this);
+        m_statisticsLabel->setAttribute(Qt::WA_TransparentForMouseEvents);
+        m_statisticsLabel->setStyleSheet(
+            "QLabel { background-color: rgba(0, 0, 0, 160); color: white; padding: 2px; }");
+        m_statisticsLabel->move(4, 4);
+    }
+    const Statistics stats = statistics();
+    m_statisticsLabel->setText(tr("Refresh: %1 ms (max %2 ms)\nQueue: %3  Dropped: %4\nLatency: %5 ms")
+                                   .arg(stats.averageRefreshUs / 1000.0, 0, 'f', 2)
+                                   .arg(stats.maxRefreshUs / 1000.0, 0, 'f', 2)
+                                   .arg(stats.queueDepth)
+                                   .arg(stats.droppedFrames)
+                                   .arg(stats.latencyMs));
+    m_statisticsLabel->adjustSize();
+    m_statisticsLabel->raise();
+    m_statisticsLabel->show();
+}
+
+const QPixmap &ScopeWidget::graticule()
+{
+    const qreal ratio = devicePixelRatioF();
+    const QSize pixels = size() * ratio;
+    const int colorspace = MLT.profile().colorspace();
+    if (m_graticule.size() != pixels || m_graticule.devicePixelRatio() != ratio
+        || m_graticuleColorspace != colorspace) {
+        m_graticule = QPixmap(pixels);
+        m_graticule.setDevicePixelRatio(ratio);
+        m_graticule.fill(Qt::transparent);
+        m_graticuleColorspace = colorspace;
+        QPainter p(&m_graticule);
+        p.setRenderHint(QPainter::Antialiasing, true);
+        drawGraticule(p);
+    }
+    return m_graticule;
+}
+
+void ScopeWidget::invalidateGraticule()
+{
+    m_graticule = QPixmap();
+}
+
 void ScopeWidget::resizeEvent(QResizeEvent *)
 {
     m_mutex.lock();
@@ -90,6 +287,8 @@ void ScopeWidget::resizeEvent(QResizeEvent *)
 
 void ScopeWidget::changeEvent(QEvent *)
 {
+    // The font, style or palette of the graticule may have changed.
+    invalidateGraticule();
     m_mutex.lock();
     m_forceRefresh = true;
     m_mutex.unlock();
@@ -97,3 +296,56 @@ void ScopeWidget::changeEvent(QEvent *)
         requestRefresh();
     }
 }
+
+const uint8_t *ScopeWidget::scopeImage(const SharedFrame &frame,
+                                       mlt_image_format format,
+                                       int &width,
+                                       int &height)
+{
+    const uint8_t *image = frame.get_image(format);
+    int factor = g_resolution.loadRelaxed();
+    if (factor == ShotcutSettings::ScopeResolutionAuto) {
+        // Do not go below the resolution of the scope itself.
+        factor = m_autoDecimation.loadRelaxed();
+        while (factor > 1 && width / factor < m_refreshSize.width())
+            factor /= 2;
+    }
+    if (factor <= 1 || !image || width < 2 * factor || height < 2 * factor)
+        return image;
+
+    // Keep the size even for the subsampled chroma of 4:2:0.
+    const int decimatedWidth = (width / factor) & ~1;
+    const int decimatedHeight = (height / factor) & ~1;
+    QByteArray &buffer = m_scopeImages[format];
+    if (format == mlt_image_yuv420p) {
+        const int lumaSize = decimatedWidth * decimatedHeight;
+        const int chromaSize = lumaSize / 4;
+        buffer.resize(lumaSize + 2 * chromaSize);
+        auto dst = reinterpret_cast<uint8_t *>(buffer.data());
+        const uint8_t *u = image + width * height;
+        const uint8_t *v = u + width * height / 4;
+        boxFilter(image, width, 1, factor, dst, decimatedWidth, decimatedHeight);
+        boxFilter(u, width / 2, 1, factor, dst + lumaSize, decimatedWidth / 2, decimatedHeight / 2);
+        boxFilter(v,
+                  width / 2,
+                  1,
+                  factor,
+                  dst + lumaSize + chromaSize,
+                  decimatedWidth / 2,
+                  decimatedHeight / 2);
+    } else if (format == mlt_image_rgb) {
+        buffer.resize(decimatedWidth * decimatedHeight * 3);
+        boxFilter(image,
+                  width * 3,
+                  3,
+                  factor,
+                  reinterpret_cast<uint8_t *>(buffer.data()),
+                  decimatedWidth,
+                  decimatedHeight);
+    } else {
+        return image;
+    }
+    width = decimatedWidth;
+    height = decimatedHeight;
+    return reinterpret_cast<const uint8_t *>(buffer.constData());
+}
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2015-2023 Meltytech, LLC
+ * Copyright (c) 2015-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -22,11 +22,25 @@
 #include "dataqueue.h"
 #include "sharedframe.h"
 
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QElapsedTimer>
 #include <QFuture>
+#include <QHash>
+#include <QList>
 #include <QMutex>
+#include <QPixmap>
 #include <QString>
 #include <QThread>
+#include <QThreadPool>
+#include <QVector>
 #include <QWidget>
+#include <QtConcurrent/QtConcurrentRun>
+
+#include <functional>
+
+class QLabel;
+class QPainter;
 
 /*!
   \class ScopeWidget
@@ -38,8 +52,16 @@
   is the ability to trigger the "heavy lifting" to be done in a worker thread.
 
   Frames are received by the onNewFrame() slot. The ScopeWidget automatically
-  places new frames in the DataQueue (m_queue). Subclasses shall implement the
-  refreshScope() function and can check for new frames in m_queue.
+  places new frames in a DataMailbox that keeps only the latest frame, and
+  refreshScope() gets it with takeFrame(). A scope that must see every frame,
+  such as one that accumulates audio, reimplements needsEveryFrame() and then
+  finds its frames in the DataQueue (m_queue) instead. The number of frames a
+  scope skipped and how long frames waited until its refresh finished are
+  available from droppedFrames() and refreshLatency().
+
+  ScopeWidget also times every refreshScope() call. statistics() returns the
+  timing together with the queue depth and dropped frames, and
+  setStatisticsVisible() shows them in an overlay on every scope.
 
   refreshScope() is run from a separate thread. Therefore, any members that are
   accessed by both the worker thread (refreshScope) and the GUI thread
@@ -52,6 +74,20 @@
 
   Subclasses shall also implement getTitle() so that the application can display
   an appropriate title for the scope.
+
+  Video scopes should read images with scopeImage(), which may return a copy
+  of the frame that is decimated with a box filter according to the scope
+  resolution setting. In automatic mode, the decimation follows the size of the
+  scope and how long its refresh takes.
+
+  Static parts of a scope, such as scale lines, labels and backgrounds, are
+  drawn by drawGraticule() into a pixmap that graticule() keeps until the
+  size, device pixel ratio or profile colorspace changes. paintEvent() then
+  only composites it with the data, so repaints do not rasterize it again.
+
+  Scopes that accumulate statistics over every pixel may split that work with
+  accumulateStripes(), which runs a kernel for horizontal stripes of the frame
+  in parallel, each into a private partial result, and then reduces them.
 */
 
 class ScopeWidget : public QWidget
@@ -82,6 +118,48 @@ public:
     */
     virtual void setOrientation(Qt::Orientation){};
 
+    /*!
+      Returns the image formats that refreshScope() reads from each frame.
+      Scopes that return any formats receive frames only after the
+      ScopeController has converted them, once for all scopes.
+      This virtual function may be reimplemented by subclasses.
+    */
+    virtual QList<mlt_image_format> imageFormats() const { return QList<mlt_image_format>(); }
+
+    /*!
+      Returns the GpuScopes::Analysis flags that refreshScope() uses instead
+      of reading the image when they are attached to the frame.
+      This virtual function may be reimplemented by subclasses.
+    */
+    virtual int gpuAnalyses() const { return 0; }
+
+    /*!
+      Sets the resolution of all video scopes as a decimation factor or
+      ShotcutSettings::ScopeResolutionAuto.
+    */
+    static void setResolution(int resolution);
+
+    //! Returns the number of frames replaced by newer ones before a refresh.
+    int droppedFrames() const { return m_mailbox.dropped(); }
+
+    //! Returns the average time in milliseconds from receiving a frame to
+    //! finishing the refresh that showed it.
+    int refreshLatency() const { return m_latency.loadRelaxed(); }
+
+    struct Statistics
+    {
+        int refreshes = 0;
+        int averageRefreshUs = 0; ///< A moving average of the wall time of refreshScope()
+        int maxRefreshUs = 0;
+        int queueDepth = 0; ///< Frames waiting for the next refresh
+        int droppedFrames = 0;
+        int latencyMs = 0;
+    };
+    //! Returns the cost of this scope since it was created.
+    Statistics statistics() const;
+    //! Shows or hides the statistics overlay of all scopes.
+    static void setStatisticsVisible(bool visible);
+
 public slots:
     //! Provides a new frame to the scope. Should be called by the application.
     virtual void onNewFrame(const SharedFrame &frame) Q_DECL_FINAL;
@@ -108,10 +186,88 @@ protected:
     virtual void refreshScope(const QSize &size, bool full) = 0;
 
     /*!
-      Stores frames received by onNewFrame().
+      Returns true if refreshScope() reads every frame from m_queue instead of
+      only the latest from takeFrame().
+      This virtual function may be reimplemented by subclasses.
+    */
+    virtual bool needsEveryFrame() const { return false; }
 
-      Subclasses should check this queue for new frames in the refreshScope()
-      implementation.
+    /*!
+      Takes the latest frame received into \a frame and returns true, or
+      returns false if there is no new frame. This must only be called from
+      refreshScope().
+    */
+    bool takeFrame(SharedFrame &frame);
+
+    /*!
+      Returns the graticule for the current size, device pixel ratio and
+      profile colorspace, calling drawGraticule() only if one of those changed
+      or invalidateGraticule() was called. This must only be called from the
+      GUI thread.
+    */
+    const QPixmap &graticule();
+
+    //! Makes the next call to graticule() draw it again.
+    void invalidateGraticule();
+
+    /*!
+      Draws the static parts of the scope with \a p into a transparent pixmap
+      the size of the widget.
+      This virtual function may be reimplemented by subclasses.
+    */
+    virtual void drawGraticule(QPainter &p) { Q_UNUSED(p) }
+
+    /*!
+      Returns the image of \a frame in \a format, which is an 8-bit RGB or
+      YUV 4:2:0 format, at the resolution chosen for this scope.
+
+      \a width and \a height must be the size of the frame and are changed to
+      the size of the returned image. The image remains valid until the next
+      call for the same format. This must only be called from refreshScope().
+    */
+    const uint8_t *scopeImage(const SharedFrame &frame,
+                              mlt_image_format format,
+                              int &width,
+                              int &height);
+
+    /*!
+      Runs \a kernel for horizontal stripes covering \a rows rows and returns
+      the combined result.
+
+      Each stripe starts from a copy of \a initial and \a kernel accumulates
+      rows [from, to) into it. The stripes run concurrently on a pool shared by
+      all scopes and the calling thread, so \a kernel must only write to the
+      partial it is given. The partials are then combined in stripe order with
+      \a reduce.
+    */
+    template<typename Partial>
+    static Partial accumulateStripes(int rows,
+                                     const Partial &initial,
+                                     const std::function<void(int, int, Partial &)> &kernel,
+                                     const std::function<void(Partial &, const Partial &)> &reduce)
+    {
+        const int stripes = stripeCount(rows);
+        QVector<Partial> partials(stripes, initial);
+        Partial *data = partials.data();
+        QList<QFuture<void>> futures;
+        for (int i = 1; i < stripes; ++i) {
+            futures << QtConcurrent::run(&stripePool(), [&, data, i]() {
+                kernel(rows * i / stripes, rows * (i + 1) / stripes, data[i]);
+            });
+        }
+        kernel(0, rows / stripes, data[0]);
+        for (auto &future : futures)
+            future.waitForFinished();
+        for (int i = 1; i < stripes; ++i)
+            reduce(data[0], data[i]);
+        return data[0];
+    }
+
+    /*!
+      Stores frames received by onNewFrame() when needsEveryFrame() is true.
+
+      Such subclasses should check this queue for new frames in the
+      refreshScope() implementation.
     */
     DataQueue<SharedFrame> m_queue;
 
@@ -119,10 +275,37 @@ protected:
     void changeEvent(QEvent *) Q_DECL_OVERRIDE;
 
 private:
+    struct ReceivedFrame
+    {
+        SharedFrame frame;
+        qint64 received;
+    };
+
+    static QThreadPool &stripePool();
+    static int stripeCount(int rows);
+
     Q_INVOKABLE virtual void onRefreshThreadComplete() Q_DECL_FINAL;
     virtual void refreshInThread() Q_DECL_FINAL;
+    void updateStatisticsOverlay();
     QFuture<void> m_future;
-    bool m_refreshPending;
+    QAtomicInt m_refreshPending;
+    DataMailbox<ReceivedFrame> m_mailbox;
+    QAtomicInt m_latency;
+    QAtomicInt m_refreshes;
+    QAtomicInt m_refreshTime;
+    QAtomicInt m_maxRefreshTime;
+
+    // Members only accessed by the GUI thread.
+    QPixmap m_graticule;
+    int m_graticuleColorspace;
+    QLabel *m_statisticsLabel;
+    QElapsedTimer m_statisticsTimer;
+
+    // Members only accessed by the refresh thread.
+    QSize m_refreshSize;
+    qint64 m_takenReceived;
+    QHash<int, QByteArray> m_scopeImages;
+    QAtomicInt m_autoDecimation;
 
     // Members accessed in multiple threads (mutex protected).
     QMutex m_mutex;
@@ -46,30 +46,49 @@ void VideoHistogramScopeWidget::refreshScope(const QSize &size, bool full)
     Q_UNUSED(size)
     Q_UNUSED(full)
 
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
-
-    QVector<unsigned int> yBins(256, 0);
-    QVector<unsigned int> rBins(256, 0);
-    QVector<unsigned int> gBins(256, 0);
-    QVector<unsigned int> bBins(256, 0);
-
-    if (m_frame.is_valid() && m_frame.get_image_width() && m_frame.get_image_height()) {
-        const uint8_t *pYUV = m_frame.get_image(mlt_image_yuv420p);
-        const uint8_t *pRGB = m_frame.get_image(mlt_image_rgb);
-        size_t count = m_frame.get_image_width() * m_frame.get_image_height();
-        unsigned int *pYbin = yBins.data();
-        unsigned int *pRbin = rBins.data();
-        unsigned int *pGbin = gBins.data();
-        unsigned int *pBbin = bBins.data();
-        while (count--) {
-            pYbin[*pYUV++]++;
-            pRbin[*pRGB++]++;
-            pGbin[*pRGB++]++;
-            pBbin[*pRGB++]++;
-        }
+    takeFrame(m_frame);
+
+    // Y, R, G and B bins one after the other.
+    QVector<unsigned int> bins(4 * 256, 0);
+
+    const QVariant gpuBins = m_frame.get_analysis(GpuScopes::analysisName(GpuScopes::Histogram));
+    if (gpuBins.isValid()) {
+        bins = gpuBins.value<QVector<unsigned int>>();
+    } else if (m_frame.is_valid() && m_frame.get_image_width() && m_frame.get_image_height()) {
+        // Both images are decimated to the same size.
+        int width = m_frame.get_image_width();
+        int height = m_frame.get_image_height();
+        const uint8_t *yuv = scopeImage(m_frame, mlt_image_yuv420p, width, height);
+        int rgbWidth = m_frame.get_image_width();
+        int rgbHeight = m_frame.get_image_height();
+        const uint8_t *rgb = scopeImage(m_frame, mlt_image_rgb, rgbWidth, rgbHeight);
+        bins = accumulateStripes<QVector<unsigned int>>(
+            height,
+            bins,
+            [=](int from, int to, QVector<unsigned int> &partial) {
+                size_t count = size_t(to - from) * width;
+                const uint8_t *pYUV = yuv + size_t(from) * width;
+                const uint8_t *pRGB = rgb + size_t(from) * width * 3;
+                unsigned int *pYbin = partial.data();
+                unsigned int *pRbin = pYbin + 256;
+                unsigned int *pGbin = pRbin + 256;
+                unsigned int *pBbin = pGbin + 256;
+                while (count--) {
+                    pYbin[*pYUV++]++;
+                    pRbin[*pRGB++]++;
+                    pGbin[*pRGB++]++;
+                    pBbin[*pRGB++]++;
+                }
+            },
+            [](QVector<unsigned int> &result, const QVector<unsigned int> &partial) {
+                for (int i = 0; i < result.size(); i++)
+                    result[i] += partial[i];
+            });
     }
+    QVector<unsigned int> yBins = bins.mid(0, 256);
+    QVector<unsigned int> rBins = bins.mid(256, 256);
+    QVector<unsigned int> gBins = bins.mid(512, 256);
+    QVector<unsigned int> bBins = bins.mid(768, 256);
 
     m_mutex.lock();
     m_yBins.swap(yBins);
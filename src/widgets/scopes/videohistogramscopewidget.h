@@ -18,6 +18,7 @@
 #ifndef VIDEOHISTOGRAMSCOPEWIDGET_H
 #define VIDEOHISTOGRAMSCOPEWIDGET_H
 
+#include "gpuscopes.h"
 #include "scopewidget.h"
 
 #include <QMutex>
@@ -30,6 +31,11 @@ class VideoHistogramScopeWidget Q_DECL_FINAL : public ScopeWidget
 public:
     explicit VideoHistogramScopeWidget();
     QString getTitle() Q_DECL_OVERRIDE;
+    QList<mlt_image_format> imageFormats() const Q_DECL_OVERRIDE
+    {
+        return {mlt_image_yuv420p, mlt_image_rgb};
+    }
+    int gpuAnalyses() const Q_DECL_OVERRIDE { return GpuScopes::Histogram; }
 
 private:
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
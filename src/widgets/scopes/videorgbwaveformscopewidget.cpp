@@ -40,50 +40,38 @@ void VideoRgbWaveformScopeWidget::refreshScope(const QSize &size, bool full)
     Q_UNUSED(size)
     Q_UNUSED(full)
 
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
 
     int width = m_frame.get_image_width();
     int height = m_frame.get_image_height();
 
     if (m_frame.is_valid() && width && height) {
+        // This may be a decimated copy, in which case width and height change.
+        const uint8_t *src = scopeImage(m_frame, mlt_image_rgb, width, height);
         if (m_renderImg.width() != width) {
             m_renderImg = QImage(width, 256, QImage::QImage::Format_RGBX8888);
         }
-
         QColor bgColor(0, 0, 0, 0xff);
         m_renderImg.fill(bgColor);
 
-        const uint8_t *src = m_frame.get_image(mlt_image_rgb);
-        uint8_t *dst = m_renderImg.scanLine(0);
-
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                uint8_t ry = 255 - src[0];
-                size_t rIndex = (ry * width + x) * 4;
-                if (dst[rIndex] < 0xff) {
-                    dst[rIndex] += 0x0f;
-                }
-
-                uint8_t gy = 255 - src[1];
-                size_t gIndex = (gy * width + x) * 4 + 1;
-                if (dst[gIndex] < 0xff) {
-                    dst[gIndex] += 0x0f;
-                }
-
-                uint8_t by = 255 - src[2];
-                size_t bIndex = (by * width + x) * 4 + 2;
-                if (dst[bIndex] < 0xff) {
-                    dst[bIndex] += 0x0f;
+        QVector<WaveformTable> tables(3);
+        for (int c = 0; c < 3; c++)
+            tables[c].reset(width);
+        tables = accumulateStripes<QVector<WaveformTable>>(
+            height,
+            tables,
+            [=](int from, int to, QVector<WaveformTable> &partial) {
+                for (int y = from; y < to; y++) {
+                    for (int c = 0; c < 3; c++)
+                        partial[c].addRow(src + y * width * 3 + c, width, 3);
                 }
-                src += 3;
-            }
-        }
-
-        QImage scaledImage = m_renderImg
-                                 .scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
-                                 .convertToFormat(QImage::Format_RGB32);
+            },
+            [](QVector<WaveformTable> &result, const QVector<WaveformTable> &partial) {
+                for (int c = 0; c < 3; c++)
+                    result[c].add(partial[c]);
+            });
+        for (int c = 0; c < 3; c++)
+            tables[c].render(m_renderImg, c);
 
         m_mutex.lock();
         m_displayImg.swap(m_renderImg);
@@ -98,16 +86,6 @@ void VideoRgbWaveformScopeWidget::paintEvent(QPaintEvent *)
 
     // Create the painter
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
-    QFont font = QWidget::font();
-    int fontSize = font.pointSize() - (font.pointSize() > 10 ? 2 : (font.pointSize() > 8 ? 1 : 0));
-    font.setPointSize(fontSize);
-    QFontMetrics fm(font);
-    QPen pen;
-    pen.setColor(TEXT_COLOR);
-    pen.setWidth(qRound(devicePixelRatioF()));
-    p.setPen(pen);
-    p.setFont(font);
 
     // draw the waveform data
     m_mutex.lock();
@@ -118,7 +96,21 @@ void VideoRgbWaveformScopeWidget::paintEvent(QPaintEvent *)
     }
     m_mutex.unlock();
 
-    // Draw the graticule
+    p.drawPixmap(0, 0, graticule());
+}
+
+void VideoRgbWaveformScopeWidget::drawGraticule(QPainter &p)
+{
+    QFont font = QWidget::font();
+    int fontSize = font.pointSize() - (font.pointSize() > 10 ? 2 : (font.pointSize() > 8 ? 1 : 0));
+    font.setPointSize(fontSize);
+    QFontMetrics fm(font);
+    QPen pen;
+    pen.setColor(TEXT_COLOR);
+    pen.setWidth(qRound(devicePixelRatioF()));
+    p.setPen(pen);
+    p.setFont(font);
+
     int textpad = 3;
     int textheight = fm.tightBoundingRect("0").height();
     qreal y = 0;
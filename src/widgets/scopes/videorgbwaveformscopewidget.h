@@ -19,6 +19,7 @@
 #define VIDEORGBWAVEFORMSCOPEWIDGET_H
 
 #include "scopewidget.h"
+#include "waveformtable.h"
 
 #include <QImage>
 #include <QMutex>
@@ -30,10 +31,15 @@ class VideoRgbWaveformScopeWidget Q_DECL_FINAL : public ScopeWidget
 public:
     explicit VideoRgbWaveformScopeWidget();
     QString getTitle() Q_DECL_OVERRIDE;
+    QList<mlt_image_format> imageFormats() const Q_DECL_OVERRIDE
+    {
+        return {mlt_image_rgb};
+    }
 
 private:
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
+    void drawGraticule(QPainter &p) Q_DECL_OVERRIDE;
     void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
 
     SharedFrame m_frame;
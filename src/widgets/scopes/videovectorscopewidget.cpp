@@ -34,7 +34,6 @@ VideoVectorScopeWidget::VideoVectorScopeWidget()
     , m_renderImg()
     , m_mutex()
     , m_displayImg()
-    , m_profileChanged(false)
 {
     LOG_DEBUG() << "begin";
     setMouseTracking(true);
@@ -60,92 +59,52 @@ void VideoVectorScopeWidget::refreshScope(const QSize &size, bool full)
     qreal side = qMin(size.width(), size.height());
     QSize squareSize = QSize(side, side);
 
-    if (m_graticuleImg.size() != size || m_profileChanged) {
-        m_graticuleImg = QImage(squareSize, QImage::Format_RGB32);
-        m_graticuleImg.fill(0);
-        QPainter p(&m_graticuleImg);
-        p.setRenderHint(QPainter::Antialiasing, true);
-
-        // Convert the coordinate system to match the U/V coordinate system
-        // 256x256 going up from the bottom
-        p.translate(0, side);
-        p.scale(side / 256.0, -1.0 * side / 256.0);
-
-        m_mutex.lock();
-
-        drawGraticuleLines(p, devicePixelRatioF());
-
-        drawGraticuleMark(p, m_points[BLUE_100], Qt::blue, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[CYAN_100], Qt::cyan, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[GREEN_100], Qt::green, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[YELLOW_100], Qt::yellow, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[RED_100], Qt::red, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[MAGENTA_100], Qt::magenta, devicePixelRatioF() * 2, 8);
-        drawGraticuleMark(p, m_points[BLUE_75], Qt::blue, devicePixelRatioF(), 5);
-        drawGraticuleMark(p, m_points[CYAN_75], Qt::cyan, devicePixelRatioF(), 5);
-        drawGraticuleMark(p, m_points[GREEN_75], Qt::green, devicePixelRatioF(), 5);
-        drawGraticuleMark(p, m_points[YELLOW_75], Qt::yellow, devicePixelRatioF(), 5);
-        drawGraticuleMark(p, m_points[RED_75], Qt::red, devicePixelRatioF(), 5);
-        drawGraticuleMark(p, m_points[MAGENTA_75], Qt::magenta, devicePixelRatioF(), 5);
-
-        drawSkinToneLine(p, devicePixelRatioF());
-
-        m_profileChanged = false;
-        p.end();
-
-        m_mutex.unlock();
-    }
-
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
 
     int width = m_frame.get_image_width();
     int height = m_frame.get_image_height();
 
-    if (m_frame.is_valid() && width && height) {
+    const QVariant gpuImage = m_frame.get_analysis(
+        GpuScopes::analysisName(GpuScopes::Vectorscope));
+    if (m_frame.is_valid() && width && height && gpuImage.isValid()) {
+        m_renderImg = gpuImage.value<QImage>();
+    } else if (m_frame.is_valid() && width && height) {
+        // This may be a decimated copy, in which case width and height change.
+        const uint8_t *src = scopeImage(m_frame, mlt_image_yuv420p, width, height);
         if (m_renderImg.width() != 256) {
             m_renderImg = QImage(256, 256, QImage::Format_RGBX8888);
         }
         m_renderImg.fill(0);
 
-        const uint8_t *src = m_frame.get_image(mlt_image_yuv420p);
         const uint8_t *uSrc = src + (width * height);
         const uint8_t *vSrc = uSrc + (width * height / 4);
-        uint8_t *dst = m_renderImg.scanLine(0);
         int cHeight = height / 2;
         int cWidth = width / 2;
 
-        for (int y = 0; y < cHeight; y++) {
-            for (int x = 0; x < cWidth; x++) {
-                uint8_t dx = *uSrc;
-                uint8_t dy = 255 - *vSrc;
-                size_t dIndex = (dy * 256 + dx) * 4;
-                if (dst[dIndex] < 0xff) {
-                    dst[dIndex] += 0x0f;
-                    dst[dIndex + 1] += 0x0f;
-                    dst[dIndex + 2] += 0x0f;
-                }
-                uSrc++;
-                vSrc++;
-            }
-        }
-
-        QImage newDisplayImage = m_graticuleImg.copy();
-        QPainter p(&newDisplayImage);
-        // Use "plus" composition so that light points will stand out on top of a graticule line.
-        p.setCompositionMode(QPainter::CompositionMode_Plus);
-        p.setRenderHint(QPainter::SmoothPixmapTransform, true);
-        p.setRenderHint(QPainter::Antialiasing, true);
-        p.drawImage(newDisplayImage.rect(), m_renderImg, m_renderImg.rect());
-        p.end();
+        // U is the column and V is the level.
+        WaveformTable table;
+        table.reset(256);
+        table = accumulateStripes<WaveformTable>(
+            cHeight,
+            table,
+            [=](int from, int to, WaveformTable &partial) {
+                for (int y = from; y < to; y++)
+                    partial.addPoints(uSrc + y * cWidth, vSrc + y * cWidth, cWidth);
+            },
+            [](WaveformTable &result, const WaveformTable &partial) { result.add(partial); });
+        table.render(m_renderImg, -1);
+    }
 
+    if (m_frame.is_valid() && width && height) {
+        QImage newDisplayImage = m_renderImg.scaled(squareSize,
+                                                    Qt::IgnoreAspectRatio,
+                                                    Qt::SmoothTransformation);
         m_mutex.lock();
         m_displayImg.swap(newDisplayImage);
         m_mutex.unlock();
     } else {
         m_mutex.lock();
-        m_displayImg = m_graticuleImg.copy();
+        m_displayImg = QImage();
         m_mutex.unlock();
     }
 }
@@ -216,19 +175,52 @@ void VideoVectorScopeWidget::paintEvent(QPaintEvent *)
 
     // Create the painter
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
     p.setRenderHint(QPainter::SmoothPixmapTransform, true);
+    p.fillRect(squareRect, QBrush(Qt::black, Qt::SolidPattern));
+    p.drawPixmap(0, 0, graticule());
 
     // draw the vector image
+    // Use "plus" composition so that light points will stand out on top of a graticule line.
+    p.setCompositionMode(QPainter::CompositionMode_Plus);
     m_mutex.lock();
     if (!m_displayImg.isNull()) {
         p.drawImage(squareRect, m_displayImg, m_displayImg.rect());
-    } else {
-        p.fillRect(squareRect, QBrush(Qt::black, Qt::SolidPattern));
     }
     m_mutex.unlock();
 }
 
+void VideoVectorScopeWidget::drawGraticule(QPainter &p)
+{
+    QRect squareRect = getCenteredSquare();
+    qreal side = squareRect.width();
+
+    // Convert the coordinate system to match the U/V coordinate system
+    // 256x256 going up from the bottom
+    p.translate(squareRect.x(), squareRect.y() + side);
+    p.scale(side / 256.0, -1.0 * side / 256.0);
+
+    m_mutex.lock();
+
+    drawGraticuleLines(p, devicePixelRatioF());
+
+    drawGraticuleMark(p, m_points[BLUE_100], Qt::blue, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[CYAN_100], Qt::cyan, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[GREEN_100], Qt::green, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[YELLOW_100], Qt::yellow, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[RED_100], Qt::red, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[MAGENTA_100], Qt::magenta, devicePixelRatioF() * 2, 8);
+    drawGraticuleMark(p, m_points[BLUE_75], Qt::blue, devicePixelRatioF(), 5);
+    drawGraticuleMark(p, m_points[CYAN_75], Qt::cyan, devicePixelRatioF(), 5);
+    drawGraticuleMark(p, m_points[GREEN_75], Qt::green, devicePixelRatioF(), 5);
+    drawGraticuleMark(p, m_points[YELLOW_75], Qt::yellow, devicePixelRatioF(), 5);
+    drawGraticuleMark(p, m_points[RED_75], Qt::red, devicePixelRatioF(), 5);
+    drawGraticuleMark(p, m_points[MAGENTA_75], Qt::magenta, devicePixelRatioF(), 5);
+
+    drawSkinToneLine(p, devicePixelRatioF());
+
+    m_mutex.unlock();
+}
+
 void VideoVectorScopeWidget::mouseMoveEvent(QMouseEvent *event)
 {
     QRectF squareRect = getCenteredSquare();
@@ -293,7 +285,7 @@ void VideoVectorScopeWidget::profileChanged()
         m_points[MAGENTA_100] = QPoint(214, 230);
         break;
     }
-    m_profileChanged = true;
     m_mutex.unlock();
-    requestRefresh();
+    invalidateGraticule();
+    update();
 }
@@ -18,7 +18,9 @@
 #ifndef VIDEOVECTORSCOPEWIDGET_H
 #define VIDEOVECTORSCOPEWIDGET_H
 
+#include "gpuscopes.h"
 #include "scopewidget.h"
+#include "waveformtable.h"
 
 #include <QImage>
 #include <QMutex>
@@ -31,6 +33,11 @@ public:
     explicit VideoVectorScopeWidget();
     virtual ~VideoVectorScopeWidget();
     QString getTitle() Q_DECL_OVERRIDE;
+    QList<mlt_image_format> imageFormats() const Q_DECL_OVERRIDE
+    {
+        return {mlt_image_yuv420p};
+    }
+    int gpuAnalyses() const Q_DECL_OVERRIDE { return GpuScopes::Vectorscope; }
 
 private:
     enum {
@@ -51,12 +58,13 @@ private:
 
     // Called in scope thread
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
+
+    // Called in UI thread
+    void drawGraticule(QPainter &p) Q_DECL_OVERRIDE;
     void drawGraticuleLines(QPainter &p, qreal lineWidth);
     void drawSkinToneLine(QPainter &p, qreal lineWidth);
     void drawGraticuleMark(
         QPainter &p, const QPoint &point, QColor color, qreal lineWidth, qreal LineLength);
-
-    // Called in UI thread
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
     void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
     QRect getCenteredSquare();
@@ -64,13 +72,11 @@ private:
     // Only accessed by the scope thread
     SharedFrame m_frame;
     QImage m_renderImg;
-    QImage m_graticuleImg;
 
     // Variables accessed from multiple threads (mutex protected)
     QMutex m_mutex;
     QImage m_displayImg;
     QPoint m_points[COLOR_POINT_COUNT];
-    bool m_profileChanged;
 
 private slots:
     void profileChanged();
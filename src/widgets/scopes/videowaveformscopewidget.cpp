@@ -44,36 +44,39 @@ void VideoWaveformScopeWidget::refreshScope(const QSize &size, bool full)
     Q_UNUSED(size)
     Q_UNUSED(full)
 
-    while (m_queue.count() > 0) {
-        m_frame = m_queue.pop();
-    }
+    takeFrame(m_frame);
 
     int width = m_frame.get_image_width();
     int height = m_frame.get_image_height();
 
-    if (m_frame.is_valid() && width && height) {
+    const QVariant gpuImage = m_frame.get_analysis(
+        GpuScopes::analysisName(GpuScopes::LumaWaveform));
+    if (m_frame.is_valid() && width && height && gpuImage.isValid()) {
+        m_renderImg = gpuImage.value<QImage>();
+    } else if (m_frame.is_valid() && width && height) {
+        // This may be a decimated copy, in which case width and height change.
+        const uint8_t *src = scopeImage(m_frame, mlt_image_yuv420p, width, height);
         if (m_renderImg.width() != width) {
             m_renderImg = QImage(width, 256, QImage::Format_RGBX8888);
+            QColor bgColor(0, 0, 0, 0xff);
+            m_renderImg.fill(bgColor);
         }
 
-        QColor bgColor(0, 0, 0, 0xff);
-        m_renderImg.fill(bgColor);
-
-        const uint8_t *src = m_frame.get_image(mlt_image_yuv420p);
-        uint8_t *dst = m_renderImg.scanLine(0);
-
-        for (int y = 0; y < height; y++) {
-            for (int x = 0; x < width; x++) {
-                uint8_t dy = 255 - src[0];
-                size_t dIndex = (dy * width + x) * 4;
-                if (dst[dIndex] < 0xff) {
-                    dst[dIndex] += 0x0f;
-                    dst[dIndex + 1] += 0x0f;
-                    dst[dIndex + 2] += 0x0f;
-                }
-                src++;
-            }
-        }
+        WaveformTable table;
+        table.reset(width);
+        table = accumulateStripes<WaveformTable>(
+            height,
+            table,
+            [=](int from, int to, WaveformTable &partial) {
+                for (int y = from; y < to; y++)
+                    partial.addRow(src + y * width, width, 1);
+            },
+            [](WaveformTable &result, const WaveformTable &partial) { result.add(partial); });
+        // Every pixel is written, so the image does not need to be cleared.
+        table.render(m_renderImg, -1);
+    }
+
+    if (m_frame.is_valid() && width && height) {
 
         QImage scaledImage = m_renderImg
                                  .scaled(size, Qt::IgnoreAspectRatio, Qt::SmoothTransformation)
@@ -92,16 +95,6 @@ void VideoWaveformScopeWidget::paintEvent(QPaintEvent *)
 
     // Create the painter
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
-    QFont font = QWidget::font();
-    int fontSize = font.pointSize() - (font.pointSize() > 10 ? 2 : (font.pointSize() > 8 ? 1 : 0));
-    font.setPointSize(fontSize);
-    QFontMetrics fm(font);
-    QPen pen;
-    pen.setColor(TEXT_COLOR);
-    pen.setWidth(qRound(devicePixelRatioF()));
-    p.setPen(pen);
-    p.setFont(font);
 
     // draw the waveform data
     m_mutex.lock();
@@ -112,6 +105,22 @@ void VideoWaveformScopeWidget::paintEvent(QPaintEvent *)
     }
     m_mutex.unlock();
 
+    p.drawPixmap(0, 0, graticule());
+    p.end();
+}
+
+void VideoWaveformScopeWidget::drawGraticule(QPainter &p)
+{
+    QFont font = QWidget::font();
+    int fontSize = font.pointSize() - (font.pointSize() > 10 ? 2 : (font.pointSize() > 8 ? 1 : 0));
+    font.setPointSize(fontSize);
+    QFontMetrics fm(font);
+    QPen pen;
+    pen.setColor(TEXT_COLOR);
+    pen.setWidth(qRound(devicePixelRatioF()));
+    p.setPen(pen);
+    p.setFont(font);
+
     // Add IRE lines
     int textpad = 3;
     // 100
@@ -123,8 +132,6 @@ void VideoWaveformScopeWidget::paintEvent(QPaintEvent *)
     p.drawLine(QPointF(0, ire0y), QPointF(width(), ire0y));
     QRect textRect = fm.tightBoundingRect(tr("0"));
     p.drawText(textpad, ire0y + textRect.height() + textpad, tr("0"));
-
-    p.end();
 }
 
 void VideoWaveformScopeWidget::mouseMoveEvent(QMouseEvent *event)
@@ -18,7 +18,9 @@
 #ifndef VIDEOWAVEFORMSCOPEWIDGET_H
 #define VIDEOWAVEFORMSCOPEWIDGET_H
 
+#include "gpuscopes.h"
 #include "scopewidget.h"
+#include "waveformtable.h"
 
 #include <QImage>
 #include <QMutex>
@@ -30,10 +32,16 @@ class VideoWaveformScopeWidget Q_DECL_FINAL : public ScopeWidget
 public:
     explicit VideoWaveformScopeWidget();
     QString getTitle() Q_DECL_OVERRIDE;
+    QList<mlt_image_format> imageFormats() const Q_DECL_OVERRIDE
+    {
+        return {mlt_image_yuv420p};
+    }
+    int gpuAnalyses() const Q_DECL_OVERRIDE { return GpuScopes::LumaWaveform; }
 
 private:
     void refreshScope(const QSize &size, bool full) Q_DECL_OVERRIDE;
     void paintEvent(QPaintEvent *) Q_DECL_OVERRIDE;
+    void drawGraticule(QPainter &p) Q_DECL_OVERRIDE;
     void mouseMoveEvent(QMouseEvent *event) Q_DECL_OVERRIDE;
 
     SharedFrame m_frame;
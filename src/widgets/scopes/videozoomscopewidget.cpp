@@ -280,9 +280,7 @@ void VideoZoomScopeWidget::refreshScope(const QSize &size, bool full)
 
     SharedFrame frame;
 
-    while (m_queue.count() > 0) {
-        frame = m_queue.pop();
-    }
+    takeFrame(frame);
 
     if (frame.is_valid()) {
         m_zoomWidget->putFrame(frame);
@@ -36,6 +36,10 @@ class VideoZoomScopeWidget Q_DECL_FINAL : public ScopeWidget
 public:
     explicit VideoZoomScopeWidget();
     QString getTitle() Q_DECL_OVERRIDE;
+    QList<mlt_image_format> imageFormats() const Q_DECL_OVERRIDE
+    {
+        return {mlt_image_yuv420p, mlt_image_rgb};
+    }
 
 private slots:
     void onScreenSelectStarted();
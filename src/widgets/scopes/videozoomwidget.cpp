@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2019-2023 Meltytech, LLC
+ * Copyright (c) 2019-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -19,10 +19,15 @@
 
 #include "Logger.h"
 
+#include <QImage>
 #include <QMouseEvent>
 #include <QMutexLocker>
 #include <QPainter>
 #include <QToolTip>
+#include <QVector>
+
+// The pixel grid is drawn only when the pixels are at least this large.
+static const int kGridMinZoom = 8;
 
 const int MIN_ZOOM = 2;
 const int MAX_ZOOM = 20;
@@ -138,38 +143,54 @@ void VideoZoomWidget::paintEvent(QPaintEvent *)
     if (!isVisible())
         return;
 
+    // Paint a reference to the frame so that playback does not wait on the lock.
     QMutexLocker locker(&m_mutex);
-    if (!m_frame.is_valid())
+    SharedFrame frame = m_frame;
+    const QPoint imageOffset = m_imageOffset;
+    const QPoint selectedPixel = m_selectedPixel;
+    locker.unlock();
+    if (!frame.is_valid())
         return;
 
     // Create the painter
     QPainter p(this);
-    p.setRenderHint(QPainter::Antialiasing, true);
 
-    const uint8_t *pImg = m_frame.get_image(mlt_image_rgb);
-    int iWidth = m_frame.get_image_width();
-    int iHeight = m_frame.get_image_height();
-    int wWidth = width() - (width() % m_zoom);
-    int wHeight = height() - (height() % m_zoom);
-    int ix = m_imageOffset.x();
-    int iy = m_imageOffset.y();
-
-    // draw the pixels
-    for (int y = 0; y < wHeight && iy < iHeight; y += m_zoom) {
-        const uint8_t *pPixel = pImg + ((iy * iWidth) + ix) * 3;
-        for (int x = 0; x < wWidth; x += m_zoom) {
-            p.fillRect(x, y, m_zoom, m_zoom, QColor(pPixel[0], pPixel[1], pPixel[2], 255));
-            pPixel += 3;
+    const uint8_t *pImg = frame.get_image(mlt_image_rgb);
+    int iWidth = frame.get_image_width();
+    int iHeight = frame.get_image_height();
+    int ix = imageOffset.x();
+    int iy = imageOffset.y();
+    const int columns = qMin(width() / m_zoom, iWidth - ix);
+    const int rows = qMin(height() / m_zoom, iHeight - iy);
+
+    // Draw the visible source pixels in one scaled, unfiltered blit.
+    if (columns > 0 && rows > 0) {
+        const QImage visible(pImg + ((iy * iWidth) + ix) * 3,
+                             columns,
+                             rows,
+                             iWidth * 3,
+                             QImage::Format_RGB888);
+        p.setRenderHint(QPainter::SmoothPixmapTransform, false);
+        p.drawImage(QRect(0, 0, columns * m_zoom, rows * m_zoom), visible);
+
+        if (m_zoom >= kGridMinZoom) {
+            QVector<QLine> lines;
+            lines.reserve(columns + rows + 2);
+            for (int x = 0; x <= columns; ++x)
+                lines << QLine(x * m_zoom, 0, x * m_zoom, rows * m_zoom);
+            for (int y = 0; y <= rows; ++y)
+                lines << QLine(0, y * m_zoom, columns * m_zoom, y * m_zoom);
+            p.setPen(QColor(128, 128, 128, 64));
+            p.drawLines(lines);
         }
-        iy++;
     }
 
     // Outline the selected pixel
-    if (m_selectedPixel.x() >= 0 && m_selectedPixel.y() >= 0 && m_selectedPixel.x() < iWidth
-        && m_selectedPixel.y() < iHeight) {
-        const uint8_t *pPixel = pImg + ((m_selectedPixel.y() * iWidth) + m_selectedPixel.x()) * 3;
-        int posX = (m_selectedPixel.x() - m_imageOffset.x()) * m_zoom;
-        int posY = (m_selectedPixel.y() - m_imageOffset.y()) * m_zoom;
+    if (selectedPixel.x() >= 0 && selectedPixel.y() >= 0 && selectedPixel.x() < iWidth
+        && selectedPixel.y() < iHeight) {
+        const uint8_t *pPixel = pImg + ((selectedPixel.y() * iWidth) + selectedPixel.x()) * 3;
+        int posX = (selectedPixel.x() - imageOffset.x()) * m_zoom;
+        int posY = (selectedPixel.y() - imageOffset.y()) * m_zoom;
         QColor pixelcolor(pPixel[0], pPixel[1], pPixel[2]);
         p.setPen(getHighContrastColor(pixelcolor));
         p.drawRect(posX, posY, m_zoom, m_zoom);
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "waveformtable.h"
+
+// Each sample brightens its pixel by this much until it saturates.
+static const int kIntensityStep = 0x0f;
+
+WaveformTable::WaveformTable()
+    : m_columns(0)
+{}
+
+void WaveformTable::reset(int columns)
+{
+    m_columns = columns;
+    m_counts.fill(0, 256 * columns);
+}
+
+void WaveformTable::addRow(const uint8_t *samples, int count, int stride, int column)
+{
+    quint16 *counts = m_counts.data() + column;
+    const int columns = m_columns;
+    for (int x = 0; x < count; ++x) {
+        counts[(255 - samples[0]) * columns + x]++;
+        samples += stride;
+    }
+}
+
+void WaveformTable::addPoints(const uint8_t *columns, const uint8_t *levels, int count)
+{
+    quint16 *counts = m_counts.data();
+    const int n = m_columns;
+    for (int i = 0; i < count; ++i)
+        counts[(255 - levels[i]) * n + columns[i]]++;
+}
+
+void WaveformTable::add(const WaveformTable &other)
+{
+    Q_ASSERT(other.m_counts.size() == m_counts.size());
+    quint16 *counts = m_counts.data();
+    const quint16 *otherCounts = other.m_counts.constData();
+    const int n = m_counts.size();
+    for (int i = 0; i < n; ++i)
+        counts[i] += otherCounts[i];
+}
+
+void WaveformTable::render(QImage &image, int channel) const
+{
+    Q_ASSERT(image.width() == m_columns && image.height() == 256);
+    const quint16 *counts = m_counts.constData();
+    for (int y = 0; y < 256; ++y) {
+        uint8_t *dst = image.scanLine(y);
+        // A plain loop over contiguous counts, which compilers vectorize.
+        if (channel < 0) {
+            for (int x = 0; x < m_columns; ++x) {
+                const uint8_t v = qMin(255, counts[x] * kIntensityStep);
+                dst[4 * x] = v;
+                dst[4 * x + 1] = v;
+                dst[4 * x + 2] = v;
+            }
+        } else {
+            for (int x = 0; x < m_columns; ++x)
+                dst[4 * x + channel] = qMin(255, counts[x] * kIntensityStep);
+        }
+        counts += m_columns;
+    }
+}
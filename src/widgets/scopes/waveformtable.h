@@ -0,0 +1,66 @@
+/*
+ * Copyright (c) 2026 Meltytech, LLC
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WAVEFORMTABLE_H
+#define WAVEFORMTABLE_H
+
+#include <QImage>
+#include <QVector>
+
+#include <stdint.h>
+
+/*!
+  \class WaveformTable
+  \brief The WaveformTable counts 8-bit sample levels per column for waveform scopes.
+
+  The waveform scopes used to increment display pixels directly with a
+  saturation test per sample. WaveformTable instead keeps a compact 16-bit
+  count for every column and level, which is updated without branches, and
+  renders the whole table into the display image in one contiguous pass.
+
+  Rows of the table are stored top to bottom as they are displayed: row 0
+  holds level 255.
+*/
+
+class WaveformTable
+{
+public:
+    WaveformTable();
+
+    /// Resizes the table to \a columns and clears all counts.
+    void reset(int columns);
+    int columns() const { return m_columns; }
+
+    /// Counts \a count samples that are \a stride bytes apart into the
+    /// columns starting at \a column.
+    void addRow(const uint8_t *samples, int count, int stride, int column = 0);
+    /// Counts \a count points, each with a column and level taken from
+    /// \a columns and \a levels, as used for a vectorscope.
+    void addPoints(const uint8_t *columns, const uint8_t *levels, int count);
+    /// Adds the counts of \a other, which must have the same number of columns.
+    void add(const WaveformTable &other);
+
+    /// Writes the counts into channel \a channel of an RGBX8888 \a image
+    /// that is columns() wide and 256 high. A \a channel of -1 writes gray.
+    void render(QImage &image, int channel) const;
+
+private:
+    int m_columns;
+    QVector<quint16> m_counts;
+};
+
+#endif // WAVEFORMTABLE_H
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2025 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -46,11 +46,47 @@ static const int minTransitionFrames = 2;
 static const int randomIndex = 0;
 static const int cutIndex = 1;
 static const int dissolveIndex = 2;
+// The preview has the clip at its position and this many clips on each side.
+static const int kPreviewClipRadius = 3;
+
+static double sourceDar(Mlt::Producer &producer)
+{
+    double sourceW = producer.get_double("meta.media.width");
+    double sourceH = producer.get_double("meta.media.height");
+    double sourceAr = producer.get_double("meta.media.aspect_ratio");
+    if (!sourceAr) {
+        sourceAr = producer.get_double("aspect_ratio");
+    }
+    if (sourceW && sourceH && sourceAr) {
+        return sourceW * sourceAr / sourceH;
+    }
+    return 0.0;
+}
+
+static Mlt::Filter *findFilter(Mlt::Producer *producer, const QStringList &names)
+{
+    for (int i = 0; i < producer->filter_count(); i++) {
+        std::unique_ptr<Mlt::Filter> filter(producer->filter(i));
+        if (filter && filter->is_valid()
+            && names.contains(QString::fromUtf8(filter->get(kShotcutFilterProperty)))) {
+            return filter.release();
+        }
+    }
+    return nullptr;
+}
+
+static bool isSameDuration(double a, double b)
+{
+    return qFuzzyCompare(1.0 + a, 1.0 + b);
+}
 
 SlideshowGeneratorWidget::SlideshowGeneratorWidget(Mlt::Playlist *clips, QWidget *parent)
     : QWidget(parent)
     , m_clips(clips)
     , m_refreshPreview(false)
+    , m_isBuildingPreview(false)
+    , m_previewPosition(0)
+    , m_previewStartPosition(0)
 {
     QGridLayout *grid = new QGridLayout();
     setLayout(grid);
@@ -198,40 +234,85 @@ Mlt::Playlist *SlideshowGeneratorWidget::getSlideshow()
     config = m_config;
     m_mutex.unlock();
 
+    Mlt::Playlist *slideshow = buildSlideshow(config, 0, m_clips->count() - 1);
+
+    Settings.setSlideshowImageDuration(config.imageDuration);
+    Settings.setSlideshowAudioVideoDuration(config.audioVideoDuration);
+    Settings.setSlideshowAspectConversion(config.aspectConversion);
+    Settings.setSlideshowZoomPercent(config.zoomPercent);
+    Settings.setSlideshowTransitionDuration(config.transitionDuration);
+    Settings.setSlideshowTransitionStyle(config.transitionStyle);
+    Settings.setSlideshowTransitionSoftness(config.transitionSoftness);
+
+    return slideshow;
+}
+
+QList<SlideshowGeneratorWidget::SourceClip> SlideshowGeneratorWidget::sourceClips()
+{
+    QMutexLocker locker(&m_sourceMutex);
+    if (m_sourceClips.isEmpty()) {
+        Mlt::ClipInfo info;
+        for (int i = 0; i < m_clips->count(); i++) {
+            Mlt::ClipInfo *c = m_clips->clip_info(i, &info);
+            if (c && c->producer && c->producer->is_valid()) {
+                SourceClip clip;
+                clip.xml = MLT.XML(c->producer);
+                clip.in = c->frame_in;
+                clip.out = c->frame_out;
+                clip.isAudioVideo
+                    = QString::fromLatin1(c->producer->get("mlt_service")).startsWith("avformat");
+                Mlt::Producer producer(MLT.profile(), "xml-string", clip.xml.toUtf8().constData());
+                if (!producer.property_exists("meta.media.width")) {
+                    delete producer.get_frame(); // makes avformat producer set meta.media.width and .height
+                }
+                clip.dar = sourceDar(producer);
+                m_sourceClips << clip;
+            }
+        }
+    }
+    return m_sourceClips;
+}
+
+Mlt::Playlist *SlideshowGeneratorWidget::buildSlideshow(const SlideshowConfig &config,
+                                                        int first,
+                                                        int last,
+                                                        Preview *preview)
+{
+    const auto clips = sourceClips();
     int framesPerClip = qRound(config.imageDuration * MLT.profile().fps());
-    int count = m_clips->count();
     Mlt::Playlist *slideshow = new Mlt::Playlist(MLT.profile());
     Mlt::ClipInfo info;
+    QList<double> dars;
 
     // Copy clips
-    for (int i = 0; i < count; i++) {
-        Mlt::ClipInfo *c = m_clips->clip_info(i, &info);
-        if (c && c->producer && c->producer->is_valid()) {
-            auto isAudioVideo
-                = QString::fromLatin1(c->producer->get("mlt_service")).startsWith("avformat");
-            auto maxFrames = qRound(
-                MLT.profile().fps()
-                * (isAudioVideo ? config.audioVideoDuration : config.imageDuration));
-            int out = c->frame_in + maxFrames - 1;
-            if (isAudioVideo)
-                out = qMin(c->frame_out, out);
-            Mlt::Producer producer(MLT.profile(),
-                                   "xml-string",
-                                   MLT.XML(c->producer).toUtf8().constData());
-            slideshow->append(producer, c->frame_in, out);
-        }
+    for (int i = qMax(0, first); i <= last && i < clips.size(); i++) {
+        const auto &clip = clips[i];
+        auto maxFrames = qRound(MLT.profile().fps()
+                                * (clip.isAudioVideo ? config.audioVideoDuration
+                                                     : config.imageDuration));
+        int out = clip.in + maxFrames - 1;
+        if (clip.isAudioVideo)
+            out = qMin(clip.out, out);
+        Mlt::Producer producer(MLT.profile(), "xml-string", clip.xml.toUtf8().constData());
+        slideshow->append(producer, clip.in, out);
+        dars << clip.dar;
     }
+    int count = slideshow->count();
 
     // Add filters
     for (int i = 0; i < count; i++) {
         Mlt::ClipInfo *c = slideshow->clip_info(i, &info);
+        Mlt::Producer producer;
+        int endPosition = 0;
         if (c && c->producer) {
-            if (!c->producer->property_exists("meta.media.width")) {
-                delete c->producer
-                    ->get_frame(); // makes avformat producer set meta.media.width and .height
-            }
-            attachAffineFilter(config, c->producer, c->frame_count - 1);
-            attachBlurFilter(config, c->producer);
+            producer = Mlt::Producer(c->producer);
+            endPosition = c->frame_count - 1;
+            updateAffineFilter(config, &producer, dars[i], endPosition);
+            updateBlurFilter(config, &producer, dars[i]);
+        }
+        if (preview) {
+            preview->producers << producer;
+            preview->endPositions << endPosition;
         }
     }
 
@@ -272,29 +353,36 @@ Mlt::Playlist *SlideshowGeneratorWidget::getSlideshow()
             Mlt::Transition luma(MLT.profile(), Settings.playerGPU() ? "movit.luma_mix" : "luma");
             applyLumaTransitionProperties(&luma, config);
             slideshow->mix_add(i + 1, &luma);
+            if (preview)
+                preview->lumas << luma;
 
             count++;
             i++;
         }
     }
 
-    Settings.setSlideshowImageDuration(m_config.imageDuration);
-    Settings.setSlideshowAudioVideoDuration(m_config.audioVideoDuration);
-    Settings.setSlideshowAspectConversion(m_config.aspectConversion);
-    Settings.setSlideshowZoomPercent(m_config.zoomPercent);
-    Settings.setSlideshowTransitionDuration(m_config.transitionDuration);
-    Settings.setSlideshowTransitionStyle(m_config.transitionStyle);
-    Settings.setSlideshowTransitionSoftness(m_config.transitionSoftness);
-
+    if (preview) {
+        // Remember where each clip is between the mixes.
+        for (int i = 0; i < slideshow->count(); i++) {
+            QScopedPointer<Mlt::Producer> clip(slideshow->get_clip(i));
+            if (clip && !clip->parent().get(kShotcutTransitionProperty))
+                preview->entries << i;
+        }
+    }
     return slideshow;
 }
 
-void SlideshowGeneratorWidget::attachAffineFilter(SlideshowConfig &config,
+void SlideshowGeneratorWidget::updateAffineFilter(const SlideshowConfig &config,
                                                   Mlt::Producer *producer,
+                                                  double sourceDar,
                                                   int endPosition)
 {
+    std::unique_ptr<Mlt::Filter> filter(
+        findFilter(producer, {"affineSizePosition", "movitSizePosition"}));
     if (config.zoomPercent == 0 && config.aspectConversion != ASPECT_CONVERSION_CROP_CENTER
         && config.aspectConversion != ASPECT_CONVERSION_CROP_PAN) {
+        if (filter)
+            producer->detach(*filter);
         return;
     }
 
@@ -312,18 +400,13 @@ void SlideshowGeneratorWidget::attachAffineFilter(SlideshowConfig &config,
     endRect.o = 1;
 
     double destDar = MLT.profile().dar();
-    double sourceW = producer->get_double("meta.media.width");
-    double sourceH = producer->get_double("meta.media.height");
-    double sourceAr = producer->get_double("meta.media.aspect_ratio");
-    if (!sourceAr) {
-        sourceAr = producer->get_double("aspect_ratio");
-    }
-    double sourceDar = destDar;
-    if (sourceW && sourceH && sourceAr) {
-        sourceDar = sourceW * sourceAr / sourceH;
+    if (!sourceDar) {
+        sourceDar = destDar;
     }
     if (sourceDar == destDar && config.zoomPercent == 0) {
         // Aspect ratios match and no zoom. No need for affine.
+        if (filter)
+            producer->detach(*filter);
         return;
     }
 
@@ -393,34 +476,43 @@ void SlideshowGeneratorWidget::attachAffineFilter(SlideshowConfig &config,
         beginRect.h = beginRect.h + (beginScale * beginRect.h);
     }
 
-    Mlt::Filter filter(MLT.profile(), Settings.playerGPU() ? "movit.rect" : "affine");
+    if (!filter) {
+        filter.reset(new Mlt::Filter(MLT.profile(), Settings.playerGPU() ? "movit.rect" : "affine"));
+        producer->attach(*filter);
+    }
     if (Settings.playerGPU()) {
-        filter.anim_set("rect", beginRect, 0);
-        filter.anim_set("rect", endRect, endPosition);
-        filter.set("fill", 1);
-        filter.set("distort", 0);
-        filter.set("valign", "middle");
-        filter.set("halign", "center");
-        filter.set(kShotcutFilterProperty, "movitSizePosition");
+        filter->clear("rect");
+        filter->anim_set("rect", beginRect, 0);
+        filter->anim_set("rect", endRect, endPosition);
+        filter->set("fill", 1);
+        filter->set("distort", 0);
+        filter->set("valign", "middle");
+        filter->set("halign", "center");
+        filter->set(kShotcutFilterProperty, "movitSizePosition");
     } else {
-        filter.anim_set("transition.rect", beginRect, 0);
-        filter.anim_set("transition.rect", endRect, endPosition);
-        filter.set("transition.fill", 1);
-        filter.set("transition.distort", 0);
-        filter.set("transition.valign", "middle");
-        filter.set("transition.halign", "center");
-        filter.set("transition.threads", 0);
-        filter.set("background", "color:#000000");
-        filter.set(kShotcutFilterProperty, "affineSizePosition");
-    }
-    filter.set(kShotcutAnimInProperty, producer->frames_to_time(endPosition + 1, mlt_time_clock));
-    filter.set(kShotcutAnimOutProperty, producer->frames_to_time(0, mlt_time_clock));
-    producer->attach(filter);
+        filter->clear("transition.rect");
+        filter->anim_set("transition.rect", beginRect, 0);
+        filter->anim_set("transition.rect", endRect, endPosition);
+        filter->set("transition.fill", 1);
+        filter->set("transition.distort", 0);
+        filter->set("transition.valign", "middle");
+        filter->set("transition.halign", "center");
+        filter->set("transition.threads", 0);
+        filter->set("background", "color:#000000");
+        filter->set(kShotcutFilterProperty, "affineSizePosition");
+    }
+    filter->set(kShotcutAnimInProperty, producer->frames_to_time(endPosition + 1, mlt_time_clock));
+    filter->set(kShotcutAnimOutProperty, producer->frames_to_time(0, mlt_time_clock));
 }
 
-void SlideshowGeneratorWidget::attachBlurFilter(SlideshowConfig &config, Mlt::Producer *producer)
+void SlideshowGeneratorWidget::updateBlurFilter(const SlideshowConfig &config,
+                                                Mlt::Producer *producer,
+                                                double sourceDar)
 {
+    std::unique_ptr<Mlt::Filter> filter(findFilter(producer, {"blur_pad"}));
     if (config.aspectConversion != ASPECT_CONVERSION_PAD_BLUR) {
+        if (filter)
+            producer->detach(*filter);
         return;
     }
     mlt_rect rect;
@@ -431,18 +523,13 @@ void SlideshowGeneratorWidget::attachBlurFilter(SlideshowConfig &config, Mlt::Pr
     rect.o = 1;
 
     double destDar = MLT.profile().dar();
-    double sourceW = producer->get_double("meta.media.width");
-    double sourceH = producer->get_double("meta.media.height");
-    double sourceAr = producer->get_double("meta.media.aspect_ratio");
-    if (!sourceAr) {
-        sourceAr = producer->get_double("aspect_ratio");
-    }
-    double sourceDar = destDar;
-    if (sourceW && sourceH && sourceAr) {
-        sourceDar = sourceW * sourceAr / sourceH;
+    if (!sourceDar) {
+        sourceDar = destDar;
     }
     if (sourceDar == destDar) {
         // Aspect ratios match. No need for pad.
+        if (filter)
+            producer->detach(*filter);
         return;
     }
 
@@ -456,15 +543,17 @@ void SlideshowGeneratorWidget::attachBlurFilter(SlideshowConfig &config, Mlt::Pr
         rect.x = ((double) MLT.profile().width() - rect.w) / 2.0;
     }
 
-    Mlt::Filter filter(MLT.profile(), "pillar_echo");
-    filter.set("rect", rect);
-    filter.set("blur", 4);
-    filter.set(kShotcutFilterProperty, "blur_pad");
-    producer->attach(filter);
+    if (!filter) {
+        filter.reset(new Mlt::Filter(MLT.profile(), "pillar_echo"));
+        producer->attach(*filter);
+    }
+    filter->set("rect", rect);
+    filter->set("blur", 4);
+    filter->set(kShotcutFilterProperty, "blur_pad");
 }
 
 void SlideshowGeneratorWidget::applyLumaTransitionProperties(Mlt::Transition *luma,
-                                                             SlideshowConfig &config)
+                                                             const SlideshowConfig &config)
 {
     int index = config.transitionStyle;
 
@@ -517,11 +606,13 @@ void SlideshowGeneratorWidget::on_parameterChanged()
         m_softnessSpinner->setEnabled(true);
     }
 
+    const int position = m_preview->position();
     m_preview->stop();
     m_preview->showText(Settings.playerGPU() ? tr("Preview is not available with GPU Effects")
                                              : tr("Generating Preview..."));
     m_mutex.lock();
     m_refreshPreview = true;
+    m_previewPosition = position;
     m_config.imageDuration = m_imageDurationSpinner->value();
     m_config.audioVideoDuration = m_audioVideoDurationSpinner->value();
     m_config.aspectConversion = m_aspectConversionCombo->currentIndex();
@@ -541,24 +632,96 @@ void SlideshowGeneratorWidget::generatePreviewSlideshow()
     m_mutex.lock();
     while (m_refreshPreview) {
         m_refreshPreview = false;
+        m_isBuildingPreview = true;
+        SlideshowConfig config = m_config;
+        int position = m_previewPosition;
 
         m_mutex.unlock();
-        Mlt::Producer newProducer = getSlideshow();
+        position = updatePreview(config, position);
         m_mutex.lock();
 
-        if (!m_refreshPreview) {
-            m_previewProducer = newProducer;
+        m_isBuildingPreview = false;
+        if (!m_refreshPreview && m_previewSlideshow.playlist) {
+            m_previewProducer = *m_previewSlideshow.playlist;
+            m_previewStartPosition = position;
             QMetaObject::invokeMethod(this, "startPreview", Qt::QueuedConnection);
         }
     }
     m_mutex.unlock();
 }
 
+int SlideshowGeneratorWidget::updatePreview(const SlideshowConfig &config, int position)
+{
+    auto &preview = m_previewSlideshow;
+    const auto clips = sourceClips();
+
+    // Find the clip at the position of the preview and how far into it that is.
+    int clip = 0;
+    int offset = 0;
+    if (preview.playlist && !preview.entries.isEmpty()) {
+        const int entry = preview.playlist->get_clip_index_at(position);
+        clip = preview.entries.size() - 1;
+        for (int i = 0; i < preview.entries.size(); i++) {
+            // A mix belongs to the clip after it.
+            if (preview.entries[i] >= entry) {
+                clip = i;
+                break;
+            }
+        }
+        offset = qMax(0, position - preview.playlist->clip_start(preview.entries[clip]));
+        clip += preview.first;
+    }
+    const int first = qBound(0,
+                             clip - kPreviewClipRadius,
+                             qMax(0, clips.size() - 2 * kPreviewClipRadius - 1));
+    const int last = qMin(int(clips.size()) - 1, first + 2 * kPreviewClipRadius);
+
+    if (preview.playlist && first == preview.first
+        && isSameDuration(config.imageDuration, preview.config.imageDuration)
+        && isSameDuration(config.audioVideoDuration, preview.config.audioVideoDuration)
+        && isSameDuration(config.transitionDuration, preview.config.transitionDuration)) {
+        // Same clips and mixes: update only what changed on the filters and transitions.
+        if (config.aspectConversion != preview.config.aspectConversion
+            || config.zoomPercent != preview.config.zoomPercent) {
+            for (int i = 0; i < preview.producers.size(); i++) {
+                auto &producer = preview.producers[i];
+                if (!producer.is_valid())
+                    continue;
+                const double dar = clips.value(first + i).dar;
+                updateAffineFilter(config, &producer, dar, preview.endPositions[i]);
+                updateBlurFilter(config, &producer, dar);
+            }
+        }
+        if (config.transitionStyle != preview.config.transitionStyle
+            || config.transitionSoftness != preview.config.transitionSoftness) {
+            for (auto &luma : preview.lumas)
+                applyLumaTransitionProperties(&luma, config);
+        }
+        preview.config = config;
+        return position;
+    }
+
+    Preview next;
+    next.playlist.reset(buildSlideshow(config, first, last, &next));
+    next.config = config;
+    next.first = first;
+    int start = 0;
+    const int index = clip - first;
+    if (index >= 0 && index < next.entries.size()) {
+        const int entry = next.entries[index];
+        start = next.playlist->clip_start(entry)
+                + qMin(offset, qMax(0, next.playlist->clip_length(entry) - 1));
+    }
+    preview = std::move(next);
+    return start;
+}
+
 void SlideshowGeneratorWidget::startPreview()
 {
     m_mutex.lock();
-    if (m_previewProducer.is_valid()) {
-        m_preview->start(m_previewProducer);
+    // Another change is on its way, and the preview thread may be updating the playlist.
+    if (m_previewProducer.is_valid() && !m_refreshPreview && !m_isBuildingPreview) {
+        m_preview->start(m_previewProducer, m_previewStartPosition);
     }
     m_previewProducer = Mlt::Producer();
     m_mutex.unlock();
@@ -1,5 +1,5 @@
 /*
- * Copyright (c) 2020-2025 Meltytech, LLC
+ * Copyright (c) 2020-2026 Meltytech, LLC
  *
  * This program is free software: you can redistribute it and/or modify
  * it under the terms of the GNU General Public License as published by
@@ -18,19 +18,22 @@
 #ifndef SLIDESHOWGENERATORWIDGET_H
 #define SLIDESHOWGENERATORWIDGET_H
 
+#include <MltPlaylist.h>
 #include <MltProducer.h>
+#include <MltTransition.h>
 #include <QFuture>
+#include <QList>
 #include <QMutex>
 #include <QWidget>
 
+#include <memory>
+
 class QComboBox;
 class QDoubleSpinBox;
 class QSlider;
 class QSpinBox;
 namespace Mlt {
 class Filter;
-class Playlist;
-class Transition;
 } // namespace Mlt
 class ProducerPreviewWidget;
 
@@ -59,10 +62,42 @@ private:
         int transitionSoftness;
     };
 
-    void attachAffineFilter(SlideshowConfig &config, Mlt::Producer *producer, int endPosition);
-    void attachBlurFilter(SlideshowConfig &config, Mlt::Producer *producer);
-    void applyLumaTransitionProperties(Mlt::Transition *luma, SlideshowConfig &config);
+    //! What is needed of a clip to build it into a slideshow, read only once.
+    struct SourceClip
+    {
+        QString xml;
+        int in;
+        int out;
+        bool isAudioVideo;
+        double dar; ///< 0 when it is not known
+    };
+
+    //! The parts of a preview slideshow that a parameter change updates in place.
+    struct Preview
+    {
+        std::unique_ptr<Mlt::Playlist> playlist;
+        SlideshowConfig config;
+        int first = 0;
+        QList<int> entries; ///< The playlist entry of each clip
+        QList<Mlt::Producer> producers;
+        QList<int> endPositions;
+        QList<Mlt::Transition> lumas;
+    };
+
+    QList<SourceClip> sourceClips();
+    Mlt::Playlist *buildSlideshow(const SlideshowConfig &config,
+                                  int first,
+                                  int last,
+                                  Preview *preview = nullptr);
+    void updateAffineFilter(const SlideshowConfig &config,
+                            Mlt::Producer *producer,
+                            double sourceDar,
+                            int endPosition);
+    void updateBlurFilter(const SlideshowConfig &config, Mlt::Producer *producer, double sourceDar);
+    void applyLumaTransitionProperties(Mlt::Transition *luma, const SlideshowConfig &config);
     void generatePreviewSlideshow();
+    //! Updates the preview slideshow and returns the position from which to play it.
+    int updatePreview(const SlideshowConfig &config, int position);
     Q_INVOKABLE void startPreview();
 
     QDoubleSpinBox *m_imageDurationSpinner;
@@ -75,12 +110,21 @@ private:
     ProducerPreviewWidget *m_preview;
     Mlt::Playlist *m_clips;
 
+    QMutex m_sourceMutex;
+    QList<SourceClip> m_sourceClips;
+
     // Mutext Protected Members
     QFuture<void> m_future;
     QMutex m_mutex;
     bool m_refreshPreview;
+    bool m_isBuildingPreview;
     SlideshowConfig m_config;
+    int m_previewPosition;
     Mlt::Producer m_previewProducer;
+    int m_previewStartPosition;
+
+    // Used only by the preview thread
+    Preview m_previewSlideshow;
 };
 
 #endif // SLIDESHOWGENERATORWIDGET_H
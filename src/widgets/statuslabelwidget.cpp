@@ -118,6 +118,9 @@ void StatusLabelWidget::showText(const QString &text,
                 m_fadeIn->start();
                 if (timeoutSeconds > 0)
                     m_timer.start(timeoutSeconds * 1000);
+            } else if (timeoutSeconds > 0 && m_timer.isActive()) {
+                // Keep showing a message that is being updated, such as a progress.
+                m_timer.start(timeoutSeconds * 1000);
             }
         }
     } else { // DirectX